@@ -10,7 +10,9 @@
  */
 
 #include <algorithm>
+#include <cmath>
 #include <map>
+#include <unordered_set>
 #include <vector>
 
 #include "animation.h"
@@ -26,6 +28,18 @@ using std::string;
 using std::vector;
 
 
+namespace SPRITE_ATLAS {
+
+//Transparent space around each sprite in a page, so that sprites don't
+//bleed into one another when scaled.
+const int PADDING = 2;
+
+//Maximum width and height of each page.
+const int PAGE_SIZE = 4096;
+
+}
+
+
 /**
  * @brief Constructs a new animation object.
  *
@@ -56,7 +70,8 @@ Animation::Animation(const Animation &a2) :
     name(a2.name),
     frames(a2.frames),
     loop_frame(a2.loop_frame),
-    hit_rate(a2.hit_rate) {
+    hit_rate(a2.hit_rate),
+    shared_clock_duration(a2.shared_clock_duration) {
 }
 
 
@@ -72,12 +87,34 @@ Animation &Animation::operator=(const Animation &a2) {
         frames = a2.frames;
         loop_frame = a2.loop_frame;
         hit_rate = a2.hit_rate;
+        shared_clock_duration = a2.shared_clock_duration;
     }
     
     return *this;
 }
 
 
+/**
+ * @brief Works out whether the animation's loop can follow a shared clock,
+ * and if so, how long it lasts. It can if nothing in the loop sends
+ * signals or plays sounds, and no frame in it lasts forever, since
+ * then nothing depends on exactly when each of its frames begins.
+ */
+void Animation::calculate_shared_clock_duration() {
+    shared_clock_duration = 0.0f;
+    if(loop_frame >= frames.size()) return;
+    
+    float duration = 0.0f;
+    for(size_t f = loop_frame; f < frames.size(); f++) {
+        const Frame &frame = frames[f];
+        if(frame.duration <= 0.0f) return;
+        if(frame.signal != INVALID || !frame.sound.empty()) return;
+        duration += frame.duration;
+    }
+    shared_clock_duration = duration;
+}
+
+
 /**
  * @brief Deletes one of the animation's frames.
  *
@@ -204,17 +241,20 @@ AnimationDatabase::AnimationDatabase(
     sprites(s),
     body_parts(b) {
     
+    refresh_name_idxs();
 }
 
 
 /**
  * @brief Calculates the maximum distance that any of its hitbox can reach,
- * and stores it in the hitbox_span variable.
+ * and stores it in the hitbox_span variable. This also calculates
+ * each sprite's hitbox bounds.
  */
 void AnimationDatabase::calculate_hitbox_span() {
     hitbox_span = 0.0f;
     for(size_t s = 0; s < sprites.size(); s++) {
         Sprite* s_ptr = sprites[s];
+        s_ptr->calculate_hitbox_bounds();
         for(size_t h = 0; h < s_ptr->hitboxes.size(); h++) {
             Hitbox* h_ptr = &s_ptr->hitboxes[h];
             
@@ -226,6 +266,19 @@ void AnimationDatabase::calculate_hitbox_span() {
 }
 
 
+/**
+ * @brief Calculates the maximum distance from the center that any of its
+ * sprites' bitmaps can reach, and stores it in the sprite_span variable.
+ */
+void AnimationDatabase::calculate_sprite_span() {
+    sprite_span = 0.0f;
+    for(size_t s = 0; s < sprites.size(); s++) {
+        Point size = sprites[s]->bmp_size;
+        sprite_span = std::max(sprite_span, std::max(size.x, size.y) / 2.0f);
+    }
+}
+
+
 /**
  * @brief Enemies and such have a regular list of animations.
  * The only way to change these animations is through the script.
@@ -291,6 +344,7 @@ void AnimationDatabase::destroy() {
     animations.clear();
     sprites.clear();
     body_parts.clear();
+    refresh_name_idxs();
 }
 
 
@@ -313,6 +367,7 @@ void AnimationDatabase::delete_sprite(size_t idx) {
     }
     
     sprites.erase(sprites.begin() + idx);
+    refresh_name_idxs();
     
     for(size_t a = 0; a < animations.size(); a++) {
         Animation* a_ptr = animations[a];
@@ -354,10 +409,9 @@ void AnimationDatabase::fill_sound_idx_caches(MobType* mt_ptr) {
  * @return The index, or INVALID if not found.
  */
 size_t AnimationDatabase::find_animation(const string &name) const {
-    for(size_t a = 0; a < animations.size(); a++) {
-        if(animations[a]->name == name) return a;
-    }
-    return INVALID;
+    auto it = animation_idxs.find(name);
+    if(it == animation_idxs.end()) return INVALID;
+    return it->second;
 }
 
 
@@ -368,10 +422,9 @@ size_t AnimationDatabase::find_animation(const string &name) const {
  * @return The index, or INVALID if not found.
  */
 size_t AnimationDatabase::find_body_part(const string &name) const {
-    for(size_t b = 0; b < body_parts.size(); b++) {
-        if(body_parts[b]->name == name) return b;
-    }
-    return INVALID;
+    auto it = body_part_idxs.find(name);
+    if(it == body_part_idxs.end()) return INVALID;
+    return it->second;
 }
 
 
@@ -382,10 +435,9 @@ size_t AnimationDatabase::find_body_part(const string &name) const {
  * @return The index, or INVALID if not found.
  */
 size_t AnimationDatabase::find_sprite(const string &name) const {
-    for(size_t s = 0; s < sprites.size(); s++) {
-        if(sprites[s]->name == name) return s;
-    }
-    return INVALID;
+    auto it = sprite_idxs.find(name);
+    if(it == sprite_idxs.end()) return INVALID;
+    return it->second;
 }
 
 
@@ -411,12 +463,59 @@ void AnimationDatabase::fix_body_part_pointers() {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the database takes up, in bytes.
+ * The sprites' bitmaps aren't included, since they belong to the
+ * bitmap manager.
+ *
+ * @return The size.
+ */
+size_t AnimationDatabase::get_memory_usage() const {
+    size_t size =
+        sizeof(AnimationDatabase) +
+        get_vector_memory_usage(animations) +
+        get_vector_memory_usage(sprites) +
+        get_vector_memory_usage(body_parts) +
+        get_vector_memory_usage(pre_named_conversions) +
+        (animation_idxs.size() + sprite_idxs.size() + body_part_idxs.size()) *
+        (sizeof(string) + sizeof(size_t) + sizeof(void*));
+    for(size_t a = 0; a < animations.size(); a++) {
+        const Animation* a_ptr = animations[a];
+        size +=
+            sizeof(Animation) +
+            a_ptr->name.capacity() +
+            get_vector_memory_usage(a_ptr->frames);
+        for(size_t f = 0; f < a_ptr->frames.size(); f++) {
+            size +=
+                a_ptr->frames[f].sprite_name.capacity() +
+                a_ptr->frames[f].sound.capacity();
+        }
+    }
+    for(size_t s = 0; s < sprites.size(); s++) {
+        const Sprite* s_ptr = sprites[s];
+        size +=
+            sizeof(Sprite) +
+            s_ptr->name.capacity() +
+            s_ptr->bmp_name.capacity() +
+            get_vector_memory_usage(s_ptr->hitboxes);
+    }
+    for(size_t b = 0; b < body_parts.size(); b++) {
+        size += sizeof(BodyPart) + body_parts[b]->name.capacity();
+    }
+    return size;
+}
+
+
 /**
  * @brief Loads animation database data from a data node.
  *
  * @param node Data node to load from.
+ * @param load_bitmaps If false, the sprites' bitmaps aren't loaded.
+ * They can be loaded later with load_sprite_bitmaps.
  */
-void AnimationDatabase::load_from_data_node(DataNode* node) {
+void AnimationDatabase::load_from_data_node(
+    DataNode* node, bool load_bitmaps
+) {
     //Content metadata.
     load_metadata_from_data_node(node);
     
@@ -541,10 +640,12 @@ void AnimationDatabase::load_from_data_node(DataNode* node) {
                 )
             );
         new_s->bmp_name = sprite_node->getChildByName("file")->value;
-        new_s->set_bitmap(
-            new_s->bmp_name, new_s->bmp_pos, new_s->bmp_size,
-            sprite_node->getChildByName("file")
-        );
+        if(load_bitmaps) {
+            new_s->set_bitmap(
+                new_s->bmp_name, new_s->bmp_pos, new_s->bmp_size,
+                sprite_node->getChildByName("file")
+            );
+        }
         new_s->top_visible =
             s2b(
                 sprite_node->getChildByName("top_visible")->value
@@ -559,6 +660,9 @@ void AnimationDatabase::load_from_data_node(DataNode* node) {
             );
     }
     
+    //Frames look up their sprites by name.
+    refresh_name_idxs();
+    
     //Animations.
     DataNode* anims_node = node->getChildByName("animations");
     size_t n_anims = anims_node->getNrOfChildren();
@@ -605,8 +709,52 @@ void AnimationDatabase::load_from_data_node(DataNode* node) {
     }
     
     //Finish up.
+    refresh_name_idxs();
     fix_body_part_pointers();
     calculate_hitbox_span();
+    calculate_sprite_span();
+    for(size_t a = 0; a < animations.size(); a++) {
+        animations[a]->calculate_shared_clock_duration();
+    }
+    sprite_bitmaps_loaded = load_bitmaps;
+}
+
+
+/**
+ * @brief Loads the bitmaps of all sprites, if they weren't loaded
+ * along with the rest of the database.
+ */
+void AnimationDatabase::load_sprite_bitmaps() {
+    if(sprite_bitmaps_loaded) return;
+    sprite_bitmaps_loaded = true;
+    
+    for(size_t s = 0; s < sprites.size(); s++) {
+        Sprite* s_ptr = sprites[s];
+        if(s_ptr->bitmap) continue;
+        s_ptr->set_bitmap(s_ptr->bmp_name, s_ptr->bmp_pos, s_ptr->bmp_size);
+    }
+}
+
+
+/**
+ * @brief Rebuilds the caches that find animations, sprites, and body parts
+ * by name. This must be called whenever any of those lists change,
+ * or any of their names change.
+ * If there are duplicate names, the first one is the one that gets found.
+ */
+void AnimationDatabase::refresh_name_idxs() {
+    animation_idxs.clear();
+    for(size_t a = 0; a < animations.size(); a++) {
+        animation_idxs.emplace(animations[a]->name, a);
+    }
+    sprite_idxs.clear();
+    for(size_t s = 0; s < sprites.size(); s++) {
+        sprite_idxs.emplace(sprites[s]->name, s);
+    }
+    body_part_idxs.clear();
+    for(size_t b = 0; b < body_parts.size(); b++) {
+        body_part_idxs.emplace(body_parts[b]->name, b);
+    }
 }
 
 
@@ -774,6 +922,7 @@ void AnimationDatabase::sort_alphabetically() {
         return s1->name < s2->name;
     }
     );
+    refresh_name_idxs();
     
     for(size_t a = 0; a < animations.size(); a++) {
         Animation* a_ptr = animations[a];
@@ -831,6 +980,33 @@ AnimationInstance &AnimationInstance::operator=(
 }
 
 
+/**
+ * @brief Works out which frame of its loop the animation is on, and how far
+ * into it, according to the shared clock it's following.
+ *
+ * @param out_frame_idx The frame index is returned here.
+ * @param out_frame_time The time passed on that frame is returned here.
+ */
+void AnimationInstance::get_shared_clock_frame(
+    size_t* out_frame_idx, float* out_frame_time
+) const {
+    float duration = cur_anim->shared_clock_duration;
+    float loop_time = fmod(*shared_clock + shared_clock_offset, duration);
+    if(loop_time < 0.0f) loop_time += duration;
+    
+    size_t f = cur_anim->loop_frame;
+    while(
+        f + 1 < cur_anim->frames.size() &&
+        loop_time >= cur_anim->frames[f].duration
+    ) {
+        loop_time -= cur_anim->frames[f].duration;
+        f++;
+    }
+    *out_frame_idx = f;
+    *out_frame_time = loop_time;
+}
+
+
 /**
  * @brief Returns the sprite of the current frame of animation.
  *
@@ -852,7 +1028,11 @@ void AnimationInstance::get_sprite_data(
         return;
     }
     
-    Frame* cur_frame_ptr = &cur_anim->frames[cur_frame_idx];
+    size_t frame_idx = cur_frame_idx;
+    float frame_time = cur_frame_time;
+    if(shared_clock) get_shared_clock_frame(&frame_idx, &frame_time);
+    
+    Frame* cur_frame_ptr = &cur_anim->frames[frame_idx];
     //First, the basics -- the current sprite.
     if(out_cur_sprite_ptr) {
         *out_cur_sprite_ptr = cur_frame_ptr->sprite_ptr;
@@ -870,6 +1050,12 @@ void AnimationInstance::get_sprite_data(
     
     //Get the next sprite.
     size_t next_frame_idx = get_next_frame_idx();
+    if(shared_clock) {
+        next_frame_idx =
+            frame_idx + 1 < cur_anim->frames.size() ?
+            frame_idx + 1 :
+            cur_anim->loop_frame;
+    }
     Frame* next_frame_ptr = &cur_anim->frames[next_frame_idx];
     
     if(out_next_sprite_ptr) *out_next_sprite_ptr = next_frame_ptr->sprite_ptr;
@@ -880,7 +1066,7 @@ void AnimationInstance::get_sprite_data(
             *out_interpolation_factor = 0.0f;
         } else {
             *out_interpolation_factor =
-                cur_frame_time /
+                frame_time /
                 cur_frame_ptr->duration;
         }
     }
@@ -956,6 +1142,7 @@ void AnimationInstance::clear() {
     anim_db = nullptr;
     cur_frame_time = 0;
     cur_frame_idx = INVALID;
+    shared_clock = nullptr;
 }
 
 
@@ -972,6 +1159,7 @@ bool AnimationInstance::tick(
     vector<size_t>* sounds
 ) {
     if(!cur_anim) return false;
+    if(shared_clock) stop_following_shared_clock();
     size_t n_frames = cur_anim->frames.size();
     if(n_frames == 0) return false;
     Frame* cur_frame = &cur_anim->frames[cur_frame_idx];
@@ -1004,6 +1192,46 @@ bool AnimationInstance::tick(
 }
 
 
+/**
+ * @brief Makes the animation follow a shared clock instead of being ticked,
+ * continuing from where it is now. This can only happen if the animation
+ * can follow one, and is already in its loop.
+ *
+ * @param clock The clock, in seconds. It must outlive the following.
+ * @return Whether it can follow it.
+ */
+bool AnimationInstance::start_following_shared_clock(const float* clock) {
+    if(!valid_frame() || cur_anim->shared_clock_duration == 0.0f) {
+        return false;
+    }
+    if(cur_frame_idx < cur_anim->loop_frame) {
+        //Still in the part before the loop.
+        return false;
+    }
+    
+    float loop_time = cur_frame_time;
+    for(size_t f = cur_anim->loop_frame; f < cur_frame_idx; f++) {
+        loop_time += cur_anim->frames[f].duration;
+    }
+    shared_clock = clock;
+    shared_clock_offset = loop_time - *clock;
+    return true;
+}
+
+
+/**
+ * @brief Makes the animation stop following a shared clock, if it was,
+ * so it can be ticked again from the frame the clock was on.
+ */
+void AnimationInstance::stop_following_shared_clock() {
+    if(!shared_clock) return;
+    if(valid_frame()) {
+        get_shared_clock_frame(&cur_frame_idx, &cur_frame_time);
+    }
+    shared_clock = nullptr;
+}
+
+
 /**
  * @brief Sets the animation state to the beginning.
  * It's called automatically when the animation is first set.
@@ -1011,6 +1239,7 @@ bool AnimationInstance::tick(
 void AnimationInstance::to_start() {
     cur_frame_time = 0;
     cur_frame_idx = 0;
+    shared_clock = nullptr;
 }
 
 
@@ -1119,7 +1348,8 @@ Sprite::Sprite(const Sprite &s2) :
     top_angle(s2.top_angle),
     top_visible(s2.top_visible),
     bitmap(nullptr),
-    hitboxes(s2.hitboxes) {
+    hitboxes(s2.hitboxes),
+    hitbox_bounds(s2.hitbox_bounds) {
     
     set_bitmap(bmp_name, bmp_pos, bmp_size);
 }
@@ -1133,6 +1363,66 @@ Sprite::~Sprite() {
 }
 
 
+/**
+ * @brief Calculates the cylinder that encloses all of the enabled hitboxes,
+ * and stores it in the hitbox_bounds variable. This way, checks against
+ * the hitboxes can be skipped entirely if they can't reach the cylinder.
+ * If any enabled hitbox has a height of 0, meaning it reaches any Z,
+ * then so does the cylinder.
+ */
+void Sprite::calculate_hitbox_bounds() {
+    hitbox_bounds = Hitbox();
+    hitbox_bounds.type = HITBOX_TYPE_DISABLED;
+    
+    Point bounds_tl;
+    Point bounds_br;
+    float bounds_z_min = 0.0f;
+    float bounds_z_max = 0.0f;
+    bool any_infinite_height = false;
+    bool any_enabled = false;
+    
+    for(size_t h = 0; h < hitboxes.size(); h++) {
+        const Hitbox* h_ptr = &hitboxes[h];
+        if(h_ptr->type == HITBOX_TYPE_DISABLED) continue;
+        
+        Point h_tl = h_ptr->pos - h_ptr->radius;
+        Point h_br = h_ptr->pos + h_ptr->radius;
+        if(!any_enabled) {
+            bounds_tl = h_tl;
+            bounds_br = h_br;
+            bounds_z_min = h_ptr->z;
+            bounds_z_max = h_ptr->z + h_ptr->height;
+            any_enabled = true;
+        } else {
+            update_min_max_coords(bounds_tl, bounds_br, h_tl);
+            update_min_max_coords(bounds_tl, bounds_br, h_br);
+            bounds_z_min = std::min(bounds_z_min, h_ptr->z);
+            bounds_z_max = std::max(bounds_z_max, h_ptr->z + h_ptr->height);
+        }
+        if(h_ptr->height == 0.0f) any_infinite_height = true;
+    }
+    
+    if(!any_enabled) return;
+    
+    hitbox_bounds.type = HITBOX_TYPE_NORMAL;
+    hitbox_bounds.pos = (bounds_tl + bounds_br) / 2.0f;
+    hitbox_bounds.radius = 0.0f;
+    for(size_t h = 0; h < hitboxes.size(); h++) {
+        const Hitbox* h_ptr = &hitboxes[h];
+        if(h_ptr->type == HITBOX_TYPE_DISABLED) continue;
+        hitbox_bounds.radius =
+            std::max(
+                hitbox_bounds.radius,
+                Distance(hitbox_bounds.pos, h_ptr->pos).to_float() +
+                h_ptr->radius
+            );
+    }
+    hitbox_bounds.z = bounds_z_min;
+    hitbox_bounds.height =
+        any_infinite_height ? 0.0f : bounds_z_max - bounds_z_min;
+}
+
+
 /**
  * @brief Creates the hitboxes, based on the body parts.
  *
@@ -1154,6 +1444,7 @@ void Sprite::create_hitboxes(
             )
         );
     }
+    calculate_hitbox_bounds();
 }
 
 
@@ -1179,6 +1470,7 @@ Sprite &Sprite::operator=(const Sprite &s2) {
         top_visible = s2.top_visible;
         bitmap = nullptr;
         hitboxes = s2.hitboxes;
+        hitbox_bounds = s2.hitbox_bounds;
         set_bitmap(s2.bmp_name, bmp_pos, bmp_size);
     }
     
@@ -1243,6 +1535,174 @@ void Sprite::set_bitmap(
 }
 
 
+/**
+ * @brief Builds the atlas, packing all sprites of the given animation
+ * databases into pages. Whatever was in the atlas before is cleared first.
+ * Sprites that don't fit in a page are left alone.
+ *
+ * @param dbs Animation databases whose sprites to pack.
+ */
+void SpriteAtlas::build(const vector<AnimationDatabase*> &dbs) {
+    clear();
+    
+    //Gather the sprites.
+    vector<Sprite*> sprites;
+    unordered_set<AnimationDatabase*> dbs_done;
+    for(size_t d = 0; d < dbs.size(); d++) {
+        if(!dbs[d]) continue;
+        if(!dbs_done.insert(dbs[d]).second) continue;
+        for(size_t s = 0; s < dbs[d]->sprites.size(); s++) {
+            Sprite* s_ptr = dbs[d]->sprites[s];
+            if(!s_ptr->bitmap) continue;
+            if((int) s_ptr->bmp_size.x <= 0) continue;
+            if((int) s_ptr->bmp_size.y <= 0) continue;
+            sprites.push_back(s_ptr);
+        }
+    }
+    if(sprites.empty()) return;
+    
+    int page_size = SPRITE_ATLAS::PAGE_SIZE;
+    if(game.display) {
+        int max_size =
+            al_get_display_option(game.display, ALLEGRO_MAX_BITMAP_SIZE);
+        if(max_size > 0) page_size = std::min(page_size, max_size);
+    }
+    
+    //Tallest first, so that the shelves are filled more evenly.
+    std::stable_sort(
+        sprites.begin(), sprites.end(),
+    [] (const Sprite * s1, const Sprite * s2) {
+        return (int) s1->bmp_size.y > (int) s2->bmp_size.y;
+    }
+    );
+    
+    //Lay them out in shelves, each one as tall as its tallest sprite.
+    vector<size_t> sprite_pages(sprites.size(), INVALID);
+    vector<std::pair<int, int> > sprite_coords(sprites.size());
+    vector<int> page_heights;
+    int shelf_x = 0;
+    int shelf_y = 0;
+    int shelf_h = 0;
+    for(size_t s = 0; s < sprites.size(); s++) {
+        int w = (int) sprites[s]->bmp_size.x + SPRITE_ATLAS::PADDING * 2;
+        int h = (int) sprites[s]->bmp_size.y + SPRITE_ATLAS::PADDING * 2;
+        if(w > page_size || h > page_size) continue;
+        
+        if(!page_heights.empty() && shelf_x + w > page_size) {
+            //Next shelf.
+            shelf_x = 0;
+            shelf_y += shelf_h;
+            shelf_h = 0;
+        }
+        if(page_heights.empty() || shelf_y + h > page_size) {
+            //Next page.
+            page_heights.push_back(0);
+            shelf_x = 0;
+            shelf_y = 0;
+            shelf_h = 0;
+        }
+        
+        sprite_pages[s] = page_heights.size() - 1;
+        sprite_coords[s].first = shelf_x + SPRITE_ATLAS::PADDING;
+        sprite_coords[s].second = shelf_y + SPRITE_ATLAS::PADDING;
+        shelf_x += w;
+        shelf_h = std::max(shelf_h, h);
+        page_heights.back() = std::max(page_heights.back(), shelf_y + h);
+    }
+    
+    //Create the pages and copy the sprites over.
+    ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+    ALLEGRO_TRANSFORM old_transform;
+    if(old_target) {
+        al_copy_transform(&old_transform, al_get_current_transform());
+    }
+    int old_op, old_src, old_dst, old_aop, old_asrc, old_adst;
+    al_get_separate_blender(
+        &old_op, &old_src, &old_dst, &old_aop, &old_asrc, &old_adst
+    );
+    
+    for(size_t p = 0; p < page_heights.size(); p++) {
+        ALLEGRO_BITMAP* page = al_create_bitmap(page_size, page_heights[p]);
+        pages.push_back(page);
+        if(!page) continue;
+        
+        al_set_target_bitmap(page);
+        al_use_transform(&game.identity_transform);
+        al_clear_to_color(COLOR_EMPTY);
+        al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+        for(size_t s = 0; s < sprites.size(); s++) {
+            if(sprite_pages[s] != p) continue;
+            al_draw_bitmap(
+                sprites[s]->bitmap,
+                sprite_coords[s].first, sprite_coords[s].second, 0
+            );
+        }
+    }
+    
+    al_set_separate_blender(
+        old_op, old_src, old_dst, old_aop, old_asrc, old_adst
+    );
+    if(old_target) {
+        al_set_target_bitmap(old_target);
+        al_use_transform(&old_transform);
+    }
+    
+    //Point the sprites to their place in the pages.
+    for(size_t s = 0; s < sprites.size(); s++) {
+        if(sprite_pages[s] == INVALID) continue;
+        ALLEGRO_BITMAP* page = pages[sprite_pages[s]];
+        if(!page) continue;
+        ALLEGRO_BITMAP* new_bmp =
+            al_create_sub_bitmap(
+                page, sprite_coords[s].first, sprite_coords[s].second,
+                sprites[s]->bmp_size.x, sprites[s]->bmp_size.y
+            );
+        if(!new_bmp) continue;
+        original_bitmaps.push_back(
+            std::make_pair(sprites[s], sprites[s]->bitmap)
+        );
+        sprites[s]->bitmap = new_bmp;
+    }
+}
+
+
+/**
+ * @brief Clears the atlas, giving each packed sprite its original
+ * bitmap back, and destroying the pages.
+ */
+void SpriteAtlas::clear() {
+    for(size_t s = 0; s < original_bitmaps.size(); s++) {
+        Sprite* s_ptr = original_bitmaps[s].first;
+        al_destroy_bitmap(s_ptr->bitmap);
+        s_ptr->bitmap = original_bitmaps[s].second;
+    }
+    original_bitmaps.clear();
+    
+    for(size_t p = 0; p < pages.size(); p++) {
+        if(pages[p]) al_destroy_bitmap(pages[p]);
+    }
+    pages.clear();
+}
+
+
+/**
+ * @brief Returns roughly how much memory the atlas takes up, in bytes,
+ * counting the pages' pixels.
+ *
+ * @return The size.
+ */
+size_t SpriteAtlas::get_memory_usage() const {
+    size_t size = get_vector_memory_usage(original_bitmaps);
+    for(size_t p = 0; p < pages.size(); p++) {
+        if(!pages[p]) continue;
+        size +=
+            (size_t) al_get_bitmap_width(pages[p]) *
+            (size_t) al_get_bitmap_height(pages[p]) * 4;
+    }
+    return size;
+}
+
+
 /**
  * @brief Returns the final transformation data for a "basic" sprite effect.
  * i.e. the translation, angle, scale, and tint. This makes use of
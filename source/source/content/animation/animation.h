@@ -12,6 +12,7 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
 
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_image.h>
@@ -32,6 +33,12 @@ class AnimationDatabase;
 class MobType;
 
 
+namespace SPRITE_ATLAS {
+extern const int PADDING;
+extern const int PAGE_SIZE;
+}
+
+
 /*
  * Animations work as follows:
  * An animation is a set of frames.
@@ -117,6 +124,10 @@ public:
     //List of hitboxes on this frame.
     vector<Hitbox> hitboxes;
     
+    //Cylinder that encloses all of the enabled hitboxes. Its type is
+    //HITBOX_TYPE_DISABLED if there are none. Cache for performance.
+    Hitbox hitbox_bounds;
+    
     
     //--- Function declarations ---
     
@@ -131,6 +142,7 @@ public:
     Sprite(const Sprite &s2);
     ~Sprite();
     Sprite &operator=(const Sprite &s2);
+    void calculate_hitbox_bounds();
     void create_hitboxes(
         AnimationDatabase* const adb,
         float height = 0, float radius = 0
@@ -214,6 +226,10 @@ public:
     //100 means it cannot miss and/or is a normal animation.
     unsigned char hit_rate = 100;
     
+    //If its loop can follow a shared clock, this is how long the loop
+    //lasts for. 0 if it can't. See calculate_shared_clock_duration.
+    float shared_clock_duration = 0.0f;
+    
     
     //--- Function declarations ---
     
@@ -224,6 +240,7 @@ public:
     );
     Animation(const Animation &a2);
     Animation &operator=(const Animation &a2);
+    void calculate_shared_clock_duration();
     void delete_frame(size_t idx);
     float get_duration();
     float get_loop_duration();
@@ -261,6 +278,13 @@ public:
     //Maximum span of the hitboxes. Cache for performance.
     float hitbox_span = 0.0f;
     
+    //Maximum distance from the center that any sprite's bitmap reaches,
+    //horizontally or vertically. Cache for performance.
+    float sprite_span = 0.0f;
+    
+    //Are the sprites' bitmaps loaded?
+    bool sprite_bitmaps_loaded = true;
+    
     
     //--- Function declarations ---
     
@@ -273,6 +297,7 @@ public:
     size_t find_sprite(const string &name) const;
     size_t find_body_part(const string &name) const;
     void calculate_hitbox_span();
+    void calculate_sprite_span();
     void create_conversions(
         const vector<std::pair<size_t, string> > &conversions,
         const DataNode* file
@@ -280,11 +305,27 @@ public:
     void delete_sprite(size_t idx);
     void fill_sound_idx_caches(MobType* mt_ptr);
     void fix_body_part_pointers();
-    void load_from_data_node(DataNode* node);
+    size_t get_memory_usage() const;
+    void load_from_data_node(DataNode* node, bool load_bitmaps = true);
+    void load_sprite_bitmaps();
+    void refresh_name_idxs();
     void save_to_data_node(DataNode* node, bool save_top_data);
     void sort_alphabetically();
     void destroy();
     
+    private:
+    
+    //--- Members ---
+    
+    //Index of each animation, by name. Cache for performance.
+    std::unordered_map<string, size_t> animation_idxs;
+    
+    //Index of each sprite, by name. Cache for performance.
+    std::unordered_map<string, size_t> sprite_idxs;
+    
+    //Index of each body part, by name. Cache for performance.
+    std::unordered_map<string, size_t> body_part_idxs;
+    
 };
 
 
@@ -309,6 +350,15 @@ public:
     //Index of the current frame of animation, or INVALID for none.
     size_t cur_frame_idx = INVALID;
     
+    //If not nullptr, the animation isn't ticked, and the current frame
+    //is instead worked out from this clock, in seconds, whenever
+    //it's needed. The frame index and time above are then stale.
+    const float* shared_clock = nullptr;
+    
+    //When following a shared clock, add this to its time to get the
+    //time in the animation's loop.
+    float shared_clock_offset = 0.0f;
+    
     
     //--- Function declarations ---
     
@@ -330,6 +380,43 @@ public:
     ) const;
     size_t get_next_frame_idx(bool* out_reached_end = nullptr) const;
     void init_to_first_anim(AnimationDatabase* db);
+    bool start_following_shared_clock(const float* clock);
+    void stop_following_shared_clock();
+    
+    private:
+    
+    //--- Function declarations ---
+    
+    void get_shared_clock_frame(
+        size_t* out_frame_idx, float* out_frame_time
+    ) const;
+    
+};
+
+
+/**
+ * @brief Packs the sprites of some animation databases together into
+ * a few big bitmaps, called pages. While the atlas is built, each packed
+ * sprite's bitmap is a sub-bitmap of a page instead of its spritesheet,
+ * so drawing sprites from different spritesheets one after the other
+ * doesn't need to switch textures.
+ */
+struct SpriteAtlas {
+
+    //--- Members ---
+    
+    //Pages with the packed sprites.
+    vector<ALLEGRO_BITMAP*> pages;
+    
+    //Each packed sprite, and the bitmap it had before packing.
+    vector<std::pair<Sprite*, ALLEGRO_BITMAP*> > original_bitmaps;
+    
+    
+    //--- Function declarations ---
+    
+    void build(const vector<AnimationDatabase*> &dbs);
+    void clear();
+    size_t get_memory_usage() const;
     
 };
 
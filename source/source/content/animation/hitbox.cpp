@@ -88,3 +88,19 @@ Point Hitbox::get_cur_pos(
             mob_pos.y + (pos.x * mob_angle_sin + pos.y * mob_angle_cos)
         );
 }
+
+
+/**
+ * @brief Returns whether this hitbox touches another. A hitbox with a height
+ * of 0 touches others at any Z.
+ *
+ * @param h2 The other hitbox.
+ * @return Whether they touch.
+ */
+bool WorldHitbox::touches(const WorldHitbox &h2) const {
+    if(height != 0.0f && h2.height != 0.0f) {
+        if(h2.z > z + height) return false;
+        if(h2.z + h2.height < z) return false;
+    }
+    return Distance(pos, h2.pos) < radius + h2.radius;
+}
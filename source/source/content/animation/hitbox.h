@@ -135,3 +135,31 @@ public:
     ) const;
     
 };
+
+
+/**
+ * @brief A hitbox's data, in world coordinates, for a given mob position,
+ * Z, and angle.
+ */
+struct WorldHitbox {
+
+    //--- Members ---
+    
+    //Center of the hitbox.
+    Point pos;
+    
+    //Bottom of the hitbox.
+    float z = 0.0f;
+    
+    //Total hitbox height.
+    float height = 0.0f;
+    
+    //Hitbox radius.
+    float radius = 0.0f;
+    
+    
+    //--- Function declarations ---
+    
+    bool touches(const WorldHitbox &h2) const;
+    
+};
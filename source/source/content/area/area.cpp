@@ -9,6 +9,9 @@
  */
 
 #include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <unordered_map>
 #include <vector>
 
 #include "area.h"
@@ -20,11 +23,23 @@
 
 
 using std::size_t;
+using std::unordered_map;
 using std::vector;
 
 
 namespace AREA {
 
+//A blockmap block's edges are never split into more height buckets
+//than this.
+const size_t BLOCKMAP_MAX_Z_BUCKETS = 16;
+
+//A blockmap block's edges are only split into height buckets if it has
+//at least this many edges.
+const size_t BLOCKMAP_Z_BUCKET_MIN_EDGES = 16;
+
+//Height of the band of Z that each blockmap height bucket covers.
+const float BLOCKMAP_Z_BUCKET_SIZE = 128.0f;
+
 //Default day time speed, in game-minutes per real-minutes.
 const float DEF_DAY_TIME_SPEED = 120;
 
@@ -34,9 +49,35 @@ const size_t DEF_DAY_TIME_START = 7 * 60;
 //Default difficulty.
 const unsigned char DEF_DIFFICULTY = 0;
 
+//Magic number at the start of geometry cache files.
+const string GEOMETRY_CACHE_MAGIC_NUMBER = "PAGC";
+
+//Version of the geometry cache file format. Files in other versions
+//are ignored.
+const unsigned char GEOMETRY_CACHE_VERSION = 1;
+
+//Maximum number of area thumbnails loaded on demand that can be kept
+//in memory at once.
+const size_t MAX_ON_DEMAND_THUMBNAILS = 8;
+
+//When building the blockmap in parallel, don't give any job fewer than
+//this many columns. Each job goes through every edge and triangle,
+//so jobs that are too small waste more than they save.
+const size_t MIN_BLOCKMAP_JOB_SIZE = 8;
+
+//When triangulating sectors in parallel, don't give any job fewer than
+//this many sectors.
+const size_t MIN_TRIANGULATION_JOB_SIZE = 4;
+
 }
 
 
+//Indexes of the edges of a blockmap block that passed a query's check.
+//Each thread has its own, so blockmap queries can run on several threads
+//at once, and it doesn't need to be reallocated for every query.
+static thread_local vector<size_t> near_edge_idxs;
+
+
 /**
  * @brief Checks to see if all indexes match their pointers,
  * for the various edges, vertexes, etc.
@@ -127,6 +168,7 @@ void Area::clear() {
     if(thumbnail) {
         thumbnail = nullptr;
     }
+    thumbnail_path.clear();
     
     reset_metadata();
     manifest = nullptr;
@@ -182,33 +224,38 @@ void Area::cleanup(bool* out_deleted_sectors) {
 
 /**
  * @brief Clones this area data into another Area object.
+ * The vertexes and edges the other area already had are reused, so
+ * cloning into the same object over and over barely allocates anything.
  *
  * @param other The area data object to clone to.
  */
 void Area::clone(Area &other) {
+    vector<Vertex*> spare_vertexes;
+    vector<Edge*> spare_edges;
+    spare_vertexes.swap(other.vertexes);
+    spare_edges.swap(other.edges);
     other.clear();
     
-    if(!other.bg_bmp_name.empty() && other.bg_bmp) {
-        game.content.bitmaps.list.free(other.bg_bmp_name);
-    }
-    other.bg_bmp_name = bg_bmp_name;
-    if(other.bg_bmp_name.empty()) {
-        other.bg_bmp = nullptr;
-    } else {
-        other.bg_bmp = game.content.bitmaps.list.get(bg_bmp_name, nullptr, false);
-    }
-    other.bg_bmp_zoom = bg_bmp_zoom;
-    other.bg_color = bg_color;
-    other.bg_dist = bg_dist;
+    clone_properties(other);
     other.bmap = bmap;
     
     other.vertexes.reserve(vertexes.size());
     for(size_t v = 0; v < vertexes.size(); v++) {
-        other.vertexes.push_back(new Vertex());
+        other.vertexes.push_back(
+            v < spare_vertexes.size() ? spare_vertexes[v] : new Vertex()
+        );
+    }
+    for(size_t v = vertexes.size(); v < spare_vertexes.size(); v++) {
+        delete spare_vertexes[v];
     }
     other.edges.reserve(edges.size());
     for(size_t e = 0; e < edges.size(); e++) {
-        other.edges.push_back(new Edge());
+        other.edges.push_back(
+            e < spare_edges.size() ? spare_edges[e] : new Edge()
+        );
+    }
+    for(size_t e = edges.size(); e < spare_edges.size(); e++) {
+        delete spare_edges[e];
     }
     other.sectors.reserve(sectors.size());
     for(size_t s = 0; s < sectors.size(); s++) {
@@ -227,27 +274,22 @@ void Area::clone(Area &other) {
         other.tree_shadows.push_back(new TreeShadow());
     }
     
+    //Copy everything over, and then point the copies at the other
+    //area's objects, using the indexes.
     for(size_t v = 0; v < vertexes.size(); v++) {
-        Vertex* v_ptr = vertexes[v];
         Vertex* ov_ptr = other.vertexes[v];
-        ov_ptr->x = v_ptr->x;
-        ov_ptr->y = v_ptr->y;
-        ov_ptr->edges.reserve(v_ptr->edges.size());
-        ov_ptr->edge_idxs.reserve(v_ptr->edge_idxs.size());
-        for(size_t e = 0; e < v_ptr->edges.size(); e++) {
-            size_t nr = v_ptr->edge_idxs[e];
-            ov_ptr->edges.push_back(other.edges[nr]);
-            ov_ptr->edge_idxs.push_back(nr);
+        *ov_ptr = *vertexes[v];
+        for(size_t e = 0; e < ov_ptr->edges.size(); e++) {
+            ov_ptr->edges[e] = other.edges[ov_ptr->edge_idxs[e]];
         }
     }
     
     for(size_t e = 0; e < edges.size(); e++) {
         Edge* e_ptr = edges[e];
         Edge* oe_ptr = other.edges[e];
+        *oe_ptr = *e_ptr;
         oe_ptr->vertexes[0] = other.vertexes[e_ptr->vertex_idxs[0]];
         oe_ptr->vertexes[1] = other.vertexes[e_ptr->vertex_idxs[1]];
-        oe_ptr->vertex_idxs[0] = e_ptr->vertex_idxs[0];
-        oe_ptr->vertex_idxs[1] = e_ptr->vertex_idxs[1];
         if(e_ptr->sector_idxs[0] == INVALID) {
             oe_ptr->sectors[0] = nullptr;
         } else {
@@ -258,9 +300,13 @@ void Area::clone(Area &other) {
         } else {
             oe_ptr->sectors[1] = other.sectors[e_ptr->sector_idxs[1]];
         }
-        oe_ptr->sector_idxs[0] = e_ptr->sector_idxs[0];
-        oe_ptr->sector_idxs[1] = e_ptr->sector_idxs[1];
-        e_ptr->clone(oe_ptr);
+    }
+    
+    //Look vertex indexes up once instead of for every triangle point.
+    unordered_map<const Vertex*, size_t> vertex_idxs;
+    vertex_idxs.reserve(vertexes.size());
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        vertex_idxs[vertexes[v]] = v;
     }
     
     for(size_t s = 0; s < sectors.size(); s++) {
@@ -282,9 +328,9 @@ void Area::clone(Area &other) {
             Triangle* t_ptr = &s_ptr->triangles[t];
             os_ptr->triangles.push_back(
                 Triangle(
-                    other.vertexes[find_vertex_idx(t_ptr->points[0])],
-                    other.vertexes[find_vertex_idx(t_ptr->points[1])],
-                    other.vertexes[find_vertex_idx(t_ptr->points[2])]
+                    other.vertexes[vertex_idxs.at(t_ptr->points[0])],
+                    other.vertexes[vertex_idxs.at(t_ptr->points[1])],
+                    other.vertexes[vertex_idxs.at(t_ptr->points[2])]
                 )
             );
         }
@@ -337,6 +383,41 @@ void Area::clone(Area &other) {
         ot_ptr->bitmap = game.content.bitmaps.list.get(t_ptr->bmp_name, nullptr, false);
     }
     
+    other.problems.non_simples.clear();
+    other.problems.lone_edges.clear();
+    other.problems.lone_edges.reserve(problems.lone_edges.size());
+    for(const auto &s : problems.non_simples) {
+        size_t nr = find_sector_idx(s.first);
+        other.problems.non_simples[other.sectors[nr]] = s.second;
+    }
+    for(const Edge* e : problems.lone_edges) {
+        size_t nr = find_edge_idx(e);
+        other.problems.lone_edges.insert(other.edges[nr]);
+    }
+}
+
+
+/**
+ * @brief Clones this area's properties onto another area. This includes
+ * everything except the geometry, objects, tree shadows, blockmap and
+ * known geometry problems.
+ *
+ * @param other Area to clone the properties to.
+ */
+void Area::clone_properties(Area &other) const {
+    if(!other.bg_bmp_name.empty() && other.bg_bmp) {
+        game.content.bitmaps.list.free(other.bg_bmp_name);
+    }
+    other.bg_bmp_name = bg_bmp_name;
+    if(other.bg_bmp_name.empty()) {
+        other.bg_bmp = nullptr;
+    } else {
+        other.bg_bmp = game.content.bitmaps.list.get(bg_bmp_name, nullptr, false);
+    }
+    other.bg_bmp_zoom = bg_bmp_zoom;
+    other.bg_color = bg_color;
+    other.bg_dist = bg_dist;
+    
     other.manifest = manifest;
     other.type = type;
     other.name = name;
@@ -355,6 +436,7 @@ void Area::clone(Area &other) {
     other.day_time_speed = day_time_speed;
     
     other.thumbnail = thumbnail;
+    other.thumbnail_path = thumbnail_path;
     
     other.mission.goal = mission.goal;
     other.mission.goal_all_mobs = mission.goal_all_mobs;
@@ -386,18 +468,6 @@ void Area::clone(Area &other) {
     other.mission.platinum_req = mission.platinum_req;
     other.mission.maker_record = mission.maker_record;
     other.mission.maker_record_date = mission.maker_record_date;
-    
-    other.problems.non_simples.clear();
-    other.problems.lone_edges.clear();
-    other.problems.lone_edges.reserve(problems.lone_edges.size());
-    for(const auto &s : problems.non_simples) {
-        size_t nr = find_sector_idx(s.first);
-        other.problems.non_simples[other.sectors[nr]] = s.second;
-    }
-    for(const Edge* e : problems.lone_edges) {
-        size_t nr = find_edge_idx(e);
-        other.problems.lone_edges.insert(other.edges[nr]);
-    }
 }
 
 
@@ -483,6 +553,170 @@ void Area::connect_vertex_edges(Vertex* v_ptr) {
 }
 
 
+/**
+ * @brief Fills the lists of edge indexes of some of the blockmap's columns.
+ * Different columns can be filled at the same time, since they don't
+ * share any lists.
+ *
+ * @param col_start First column to fill.
+ * @param col_end Column after the last one to fill.
+ */
+void Area::fill_edge_idxs_blockmap_cols(size_t col_start, size_t col_end) {
+    for(size_t e = 0; e < edges.size(); e++) {
+        Edge* e_ptr = edges[e];
+        Point min_coords = v2p(e_ptr->vertexes[0]);
+        Point max_coords = min_coords;
+        update_min_max_coords(min_coords, max_coords, v2p(e_ptr->vertexes[1]));
+        
+        size_t b_min_x = bmap.get_col(min_coords.x);
+        size_t b_max_x = bmap.get_col(max_coords.x);
+        size_t b_min_y = bmap.get_row(min_coords.y);
+        size_t b_max_y = bmap.get_row(max_coords.y);
+        if(
+            b_min_x == INVALID || b_max_x == INVALID ||
+            b_min_y == INVALID || b_max_y == INVALID
+        ) {
+            continue;
+        }
+        b_min_x = std::max(b_min_x, col_start);
+        b_max_x = std::min(b_max_x, col_end - 1);
+        
+        for(size_t bx = b_min_x; bx <= b_max_x; bx++) {
+            for(size_t by = b_min_y; by <= b_max_y; by++) {
+                Point corner = bmap.get_top_left_corner(bx, by);
+                if(
+                    line_seg_intersects_rectangle(
+                        corner,
+                        corner + GEOMETRY::BLOCKMAP_BLOCK_SIZE,
+                        v2p(e_ptr->vertexes[0]), v2p(e_ptr->vertexes[1])
+                    )
+                ) {
+                    bmap.edge_idxs[bx][by].push_back(e);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Fills the lists of edges and sectors of some of the blockmap's
+ * columns, for a set of edges. Different columns can be filled at the same
+ * time, since they don't share any lists. Each column still gets the edges
+ * in the same order as the list.
+ *
+ * @param edge_list Edges to fill the blockmap with.
+ * @param col_start First column to fill.
+ * @param col_end Column after the last one to fill.
+ */
+void Area::fill_edges_blockmap_cols(
+    const vector<Edge*> &edge_list, size_t col_start, size_t col_end
+) {
+    for(size_t e = 0; e < edge_list.size(); e++) {
+    
+        //Get which blocks this edge belongs to, via bounding-box,
+        //and only then thoroughly test which it is inside of.
+        
+        Edge* e_ptr = edge_list[e];
+        Point min_coords = v2p(e_ptr->vertexes[0]);
+        Point max_coords = min_coords;
+        update_min_max_coords(min_coords, max_coords, v2p(e_ptr->vertexes[1]));
+        
+        size_t b_min_x = bmap.get_col(min_coords.x);
+        size_t b_max_x = bmap.get_col(max_coords.x);
+        size_t b_min_y = bmap.get_row(min_coords.y);
+        size_t b_max_y = bmap.get_row(max_coords.y);
+        if(b_min_x == INVALID || b_max_x == INVALID) continue;
+        b_min_x = std::max(b_min_x, col_start);
+        b_max_x = std::min(b_max_x, col_end - 1);
+        
+        for(size_t bx = b_min_x; bx <= b_max_x; bx++) {
+            for(size_t by = b_min_y; by <= b_max_y; by++) {
+            
+                //Get the block's coordinates.
+                Point corner = bmap.get_top_left_corner(bx, by);
+                
+                //Check if the edge is inside this blockmap.
+                if(
+                    line_seg_intersects_rectangle(
+                        corner,
+                        corner + GEOMETRY::BLOCKMAP_BLOCK_SIZE,
+                        v2p(e_ptr->vertexes[0]), v2p(e_ptr->vertexes[1])
+                    )
+                ) {
+                
+                    //If it is, add it and the sectors to the list.
+                    bool add_edge = true;
+                    if(e_ptr->sectors[0] && e_ptr->sectors[1]) {
+                        //If there's no change in height, why bother?
+                        if(
+                            (e_ptr->sectors[0]->z == e_ptr->sectors[1]->z) &&
+                            e_ptr->sectors[0]->type != SECTOR_TYPE_BLOCKING &&
+                            e_ptr->sectors[1]->type != SECTOR_TYPE_BLOCKING
+                        ) {
+                            add_edge = false;
+                        }
+                    }
+                    
+                    if(add_edge) bmap.edges[bx][by].push_back(e_ptr);
+                    
+                    if(e_ptr->sectors[0] || e_ptr->sectors[1]) {
+                        bmap.add_sector(bx, by, e_ptr->sectors[0]);
+                        bmap.add_sector(bx, by, e_ptr->sectors[1]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Fills the lists of sector triangles of some of the blockmap's
+ * columns. Different columns can be filled at the same time, since they
+ * don't share any lists.
+ *
+ * @param col_start First column to fill.
+ * @param col_end Column after the last one to fill.
+ */
+void Area::fill_triangles_blockmap_cols(size_t col_start, size_t col_end) {
+    for(size_t s = 0; s < sectors.size(); s++) {
+        Sector* s_ptr = sectors[s];
+        for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
+            BlockmapTriangle b_tri;
+            b_tri.sector = s_ptr;
+            for(unsigned char p = 0; p < 3; p++) {
+                b_tri.points[p] = v2p(s_ptr->triangles[t].points[p]);
+            }
+            
+            Point min_coords = b_tri.points[0];
+            Point max_coords = min_coords;
+            update_min_max_coords(min_coords, max_coords, b_tri.points[1]);
+            update_min_max_coords(min_coords, max_coords, b_tri.points[2]);
+            
+            size_t b_min_x = bmap.get_col(min_coords.x);
+            size_t b_max_x = bmap.get_col(max_coords.x);
+            size_t b_min_y = bmap.get_row(min_coords.y);
+            size_t b_max_y = bmap.get_row(max_coords.y);
+            if(
+                b_min_x == INVALID || b_max_x == INVALID ||
+                b_min_y == INVALID || b_max_y == INVALID
+            ) {
+                continue;
+            }
+            b_min_x = std::max(b_min_x, col_start);
+            b_max_x = std::min(b_max_x, col_end - 1);
+            
+            for(size_t bx = b_min_x; bx <= b_max_x; bx++) {
+                for(size_t by = b_min_y; by <= b_max_y; by++) {
+                    bmap.triangles[bx][by].push_back(b_tri);
+                }
+            }
+        }
+    }
+}
+
+
 /**
  * @brief Scans the list of edges and retrieves the index of
  * the specified edge.
@@ -728,14 +962,20 @@ void Area::generate_blockmap() {
         bmap.n_cols, vector<vector<Edge*> >(bmap.n_rows, vector<Edge*>())
     );
     bmap.sectors.assign(
-        bmap.n_cols, vector<unordered_set<Sector*> >(
-            bmap.n_rows, unordered_set<Sector*>()
+        bmap.n_cols, vector<vector<Sector*> >(
+            bmap.n_rows, vector<Sector*>()
         )
     );
     
     
     //Now, add a list of edges to each block.
     generate_edges_blockmap(edges);
+    bmap.update_edge_segs();
+    generate_edge_idxs_blockmap();
+    
+    
+    //And a list of sector triangles.
+    generate_triangles_blockmap();
     
     
     /* If at this point, there's any block that's missing a sector,
@@ -760,102 +1000,194 @@ void Area::generate_blockmap() {
                 bx == 0 || by == 0 ||
                 bx == bmap.n_cols - 1 || by == bmap.n_rows - 1
             ) {
-                bmap.sectors[bx][by].insert(nullptr);
+                bmap.add_sector(bx, by, nullptr);
                 continue;
             }
             
             if(bmap.sectors[bx - 1][by].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx - 1][by].begin());
+                bmap.add_sector(bx, by, bmap.sectors[bx - 1][by][0]);
                 continue;
             }
             if(bmap.sectors[bx + 1][by].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx + 1][by].begin());
+                bmap.add_sector(bx, by, bmap.sectors[bx + 1][by][0]);
                 continue;
             }
             if(bmap.sectors[bx][by - 1].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx][by - 1].begin());
+                bmap.add_sector(bx, by, bmap.sectors[bx][by - 1][0]);
                 continue;
             }
             if(bmap.sectors[bx][by + 1].size() == 1) {
-                bmap.sectors[bx][by].insert(*bmap.sectors[bx][by + 1].begin());
+                bmap.add_sector(bx, by, bmap.sectors[bx][by + 1][0]);
                 continue;
             }
             
+            //This area isn't necessarily the current one,
+            //so get_sector() can't be used.
             Point corner = bmap.get_top_left_corner(bx, by);
             corner += GEOMETRY::BLOCKMAP_BLOCK_SIZE * 0.5;
-            bmap.sectors[bx][by].insert(
-                get_sector(corner, nullptr, false)
-            );
+            Sector* corner_sector = nullptr;
+            for(size_t s = 0; s < sectors.size(); s++) {
+                Sector* s_ptr = sectors[s];
+                if(
+                    corner.x < s_ptr->bbox[0].x ||
+                    corner.x > s_ptr->bbox[1].x ||
+                    corner.y < s_ptr->bbox[0].y ||
+                    corner.y > s_ptr->bbox[1].y
+                ) {
+                    continue;
+                }
+                if(s_ptr->is_point_in_sector(corner)) {
+                    corner_sector = s_ptr;
+                    break;
+                }
+            }
+            bmap.add_sector(bx, by, corner_sector);
         }
     }
 }
 
 
+/**
+ * @brief Generates the blockmap's lists of edge indexes.
+ * This requires the blockmap's size to be set already.
+ */
+void Area::generate_edge_idxs_blockmap() {
+    bmap.edge_idxs.assign(
+        bmap.n_cols, vector<vector<size_t> >(bmap.n_rows, vector<size_t>())
+    );
+    
+    game.jobs.parallel_for(
+        bmap.n_cols, AREA::MIN_BLOCKMAP_JOB_SIZE,
+    [this] (size_t start, size_t end) {
+        fill_edge_idxs_blockmap_cols(start, end);
+    }
+    );
+}
+
+
 /**
  * @brief Generates the blockmap for a set of edges.
  *
  * @param edge_list Edges to generate the blockmap around.
  */
 void Area::generate_edges_blockmap(const vector<Edge*> &edge_list) {
-    for(size_t e = 0; e < edge_list.size(); e++) {
-    
-        //Get which blocks this edge belongs to, via bounding-box,
-        //and only then thoroughly test which it is inside of.
-        
-        Edge* e_ptr = edge_list[e];
-        Point min_coords = v2p(e_ptr->vertexes[0]);
-        Point max_coords = min_coords;
-        update_min_max_coords(min_coords, max_coords, v2p(e_ptr->vertexes[1]));
-        
-        size_t b_min_x = bmap.get_col(min_coords.x);
-        size_t b_max_x = bmap.get_col(max_coords.x);
-        size_t b_min_y = bmap.get_row(min_coords.y);
-        size_t b_max_y = bmap.get_row(max_coords.y);
-        
-        for(size_t bx = b_min_x; bx <= b_max_x; bx++) {
-            for(size_t by = b_min_y; by <= b_max_y; by++) {
-            
-                //Get the block's coordinates.
-                Point corner = bmap.get_top_left_corner(bx, by);
-                
-                //Check if the edge is inside this blockmap.
-                if(
-                    line_seg_intersects_rectangle(
-                        corner,
-                        corner + GEOMETRY::BLOCKMAP_BLOCK_SIZE,
-                        v2p(e_ptr->vertexes[0]), v2p(e_ptr->vertexes[1])
-                    )
-                ) {
-                
-                    //If it is, add it and the sectors to the list.
-                    bool add_edge = true;
-                    if(e_ptr->sectors[0] && e_ptr->sectors[1]) {
-                        //If there's no change in height, why bother?
-                        if(
-                            (e_ptr->sectors[0]->z == e_ptr->sectors[1]->z) &&
-                            e_ptr->sectors[0]->type != SECTOR_TYPE_BLOCKING &&
-                            e_ptr->sectors[1]->type != SECTOR_TYPE_BLOCKING
-                        ) {
-                            add_edge = false;
-                        }
-                    }
-                    
-                    if(add_edge) bmap.edges[bx][by].push_back(e_ptr);
-                    
-                    if(e_ptr->sectors[0] || e_ptr->sectors[1]) {
-                        bmap.sectors[bx][by].insert(e_ptr->sectors[0]);
-                        bmap.sectors[bx][by].insert(e_ptr->sectors[1]);
-                    }
-                }
-            }
-        }
+    game.jobs.parallel_for(
+        bmap.n_cols, AREA::MIN_BLOCKMAP_JOB_SIZE,
+    [this, &edge_list] (size_t start, size_t end) {
+        fill_edges_blockmap_cols(edge_list, start, end);
     }
+    );
 }
 
 
 /**
- * @brief Returns how many path links exist in the area.
- *
+ * @brief Generates the blockmap's lists of sector triangles. The blockmap's
+ * size must already be set, and the sectors must already be triangulated.
+ * A triangle is added to every block its bounding box touches.
+ */
+void Area::generate_triangles_blockmap() {
+    bmap.triangles.assign(
+        bmap.n_cols, vector<vector<BlockmapTriangle> >(
+            bmap.n_rows, vector<BlockmapTriangle>()
+        )
+    );
+    
+    game.jobs.parallel_for(
+        bmap.n_cols, AREA::MIN_BLOCKMAP_JOB_SIZE,
+    [this] (size_t start, size_t end) {
+        fill_triangles_blockmap_cols(start, end);
+    }
+    );
+}
+
+
+/**
+ * @brief Returns a hash of everything the sector triangles and the blockmap
+ * depend on: the vertexes' coordinates, the vertexes and sectors of each edge,
+ * and the sectors' heights and types. This uses the elements' index members,
+ * so those must be up to date. The hash is the same on every run and
+ * platform, so it can be saved to disk.
+ *
+ * @return The hash.
+ */
+uint64_t Area::get_geometry_hash() const {
+    //FNV-1a, over the bytes of each number.
+    uint64_t hash = 14695981039346656037ULL;
+    const auto add_number = [&hash] (uint64_t number) {
+        for(size_t b = 0; b < 8; b++) {
+            hash ^= (number >> (b * 8)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+    };
+    const auto add_float = [&add_number] (float f) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        add_number(bits);
+    };
+    
+    add_number(vertexes.size());
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        add_float(vertexes[v]->x);
+        add_float(vertexes[v]->y);
+    }
+    
+    add_number(edges.size());
+    for(size_t e = 0; e < edges.size(); e++) {
+        const Edge* e_ptr = edges[e];
+        add_number(e_ptr->vertex_idxs[0]);
+        add_number(e_ptr->vertex_idxs[1]);
+        add_number(e_ptr->sector_idxs[0]);
+        add_number(e_ptr->sector_idxs[1]);
+    }
+    
+    add_number(sectors.size());
+    for(size_t s = 0; s < sectors.size(); s++) {
+        add_float(sectors[s]->z);
+        add_number(sectors[s]->type);
+    }
+    
+    return hash;
+}
+
+
+/**
+ * @brief Returns roughly how much memory the area's geometry, objects, and
+ * paths take up, in bytes. The blockmap isn't included, and neither are
+ * bitmaps, since those belong to the bitmap manager.
+ *
+ * @return The size.
+ */
+size_t Area::get_memory_usage() const {
+    size_t size =
+        get_vector_memory_usage(vertexes) +
+        get_vector_memory_usage(edges) +
+        get_vector_memory_usage(sectors) +
+        get_vector_memory_usage(mob_generators) +
+        get_vector_memory_usage(path_stops) +
+        get_vector_memory_usage(tree_shadows) +
+        edges.size() * sizeof(Edge);
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        size += vertexes[v]->get_memory_usage();
+    }
+    for(size_t s = 0; s < sectors.size(); s++) {
+        size += sectors[s]->get_memory_usage();
+    }
+    for(size_t m = 0; m < mob_generators.size(); m++) {
+        size += mob_generators[m]->get_memory_usage();
+    }
+    for(size_t s = 0; s < path_stops.size(); s++) {
+        size += path_stops[s]->get_memory_usage();
+    }
+    for(size_t t = 0; t < tree_shadows.size(); t++) {
+        size += tree_shadows[t]->get_memory_usage();
+    }
+    return size;
+}
+
+
+/**
+ * @brief Returns how many path links exist in the area.
+ *
  * @return The number of path links.
  */
 size_t Area::get_nr_path_links() {
@@ -1045,18 +1377,231 @@ void Area::load_mission_data_from_data_node(DataNode* node) {
 }
 
 
+/**
+ * @brief Loads the sector triangles, bounding boxes, and blockmap from
+ * a geometry cache file, instead of calculating them. The cache is only
+ * used if it was made for this exact geometry. The vertexes, edges, and
+ * sectors must already be loaded, with their pointers fixed.
+ * If anything goes wrong, nothing is changed.
+ *
+ * @param file_path Path to the geometry cache file.
+ * @param level Level to load at. The blockmap and geometry problems are
+ * only loaded at the levels that would normally calculate them.
+ * @return Whether it succeeded.
+ */
+bool Area::load_geometry_cache(
+    const string &file_path, CONTENT_LOAD_LEVEL level
+) {
+    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "rb");
+    if(!file) return false;
+    string data;
+    int64_t file_size = al_fsize(file);
+    if(file_size > 0) {
+        data.resize((size_t) file_size);
+        data.resize(al_fread(file, &data[0], data.size()));
+    }
+    al_fclose(file);
+    
+    const auto read_number =
+    [&data] (size_t &pos, size_t nr_bytes, uint64_t* out_number) {
+        return read_geometry_cache_number(data, pos, nr_bytes, out_number);
+    };
+    const auto read_float = [&data] (size_t &pos, float* out_float) {
+        uint64_t number;
+        if(!read_geometry_cache_number(data, pos, 4, &number)) return false;
+        uint32_t bits = (uint32_t) number;
+        memcpy(out_float, &bits, sizeof(bits));
+        return true;
+    };
+    const auto read_idx =
+    [&data] (size_t &pos, size_t list_size, bool can_be_none, size_t* out_idx) {
+        uint64_t number;
+        if(!read_geometry_cache_number(data, pos, 4, &number)) return false;
+        if(number == UINT32_MAX && can_be_none) {
+            *out_idx = INVALID;
+            return true;
+        }
+        if(number >= list_size) return false;
+        *out_idx = (size_t) number;
+        return true;
+    };
+    
+    //Header.
+    size_t pos = AREA::GEOMETRY_CACHE_MAGIC_NUMBER.size();
+    if(data.compare(0, pos, AREA::GEOMETRY_CACHE_MAGIC_NUMBER) != 0) {
+        return false;
+    }
+    uint64_t version;
+    uint64_t hash;
+    if(!read_number(pos, 1, &version) || !read_number(pos, 8, &hash)) {
+        return false;
+    }
+    if(
+        version != AREA::GEOMETRY_CACHE_VERSION ||
+        hash != get_geometry_hash()
+    ) {
+        return false;
+    }
+    
+    //Sector triangles and bounding boxes.
+    uint64_t nr_sectors;
+    if(!read_number(pos, 4, &nr_sectors)) return false;
+    if(nr_sectors != sectors.size()) return false;
+    vector<vector<Triangle> > new_triangles(sectors.size());
+    vector<Point> new_bboxes(sectors.size() * 2);
+    for(size_t s = 0; s < sectors.size(); s++) {
+        if(
+            !read_float(pos, &new_bboxes[s * 2].x) ||
+            !read_float(pos, &new_bboxes[s * 2].y) ||
+            !read_float(pos, &new_bboxes[s * 2 + 1].x) ||
+            !read_float(pos, &new_bboxes[s * 2 + 1].y)
+        ) {
+            return false;
+        }
+        uint64_t nr_triangles;
+        if(!read_number(pos, 4, &nr_triangles)) return false;
+        if(nr_triangles > (data.size() - pos) / 12) return false;
+        new_triangles[s].reserve((size_t) nr_triangles);
+        for(uint64_t t = 0; t < nr_triangles; t++) {
+            size_t v_idxs[3];
+            for(unsigned char p = 0; p < 3; p++) {
+                if(!read_idx(pos, vertexes.size(), false, &v_idxs[p])) {
+                    return false;
+                }
+            }
+            new_triangles[s].push_back(
+                Triangle(
+                    vertexes[v_idxs[0]], vertexes[v_idxs[1]],
+                    vertexes[v_idxs[2]]
+                )
+            );
+        }
+    }
+    
+    //Geometry problems.
+    GeometryProblems new_problems;
+    uint64_t nr_non_simples;
+    if(!read_number(pos, 4, &nr_non_simples)) return false;
+    for(uint64_t n = 0; n < nr_non_simples; n++) {
+        size_t s_idx;
+        uint64_t error;
+        if(
+            !read_idx(pos, sectors.size(), false, &s_idx) ||
+            !read_number(pos, 1, &error)
+        ) {
+            return false;
+        }
+        if(error > TRIANGULATION_ERROR_NO_EARS) return false;
+        new_problems.non_simples[sectors[s_idx]] =
+            (TRIANGULATION_ERROR) error;
+    }
+    uint64_t nr_lone_edges;
+    if(!read_number(pos, 4, &nr_lone_edges)) return false;
+    for(uint64_t l = 0; l < nr_lone_edges; l++) {
+        size_t e_idx;
+        if(!read_idx(pos, edges.size(), false, &e_idx)) return false;
+        new_problems.lone_edges.insert(edges[e_idx]);
+    }
+    
+    //Blockmap.
+    Point new_bmap_corner;
+    uint64_t new_bmap_n_cols;
+    uint64_t new_bmap_n_rows;
+    if(
+        !read_float(pos, &new_bmap_corner.x) ||
+        !read_float(pos, &new_bmap_corner.y) ||
+        !read_number(pos, 4, &new_bmap_n_cols) ||
+        !read_number(pos, 4, &new_bmap_n_rows)
+    ) {
+        return false;
+    }
+    //Each block takes up at least 8 bytes, so don't trust
+    //sizes that the rest of the file couldn't fit.
+    if(
+        new_bmap_n_rows != 0 &&
+        new_bmap_n_cols > (data.size() - pos) / 8 / new_bmap_n_rows
+    ) {
+        return false;
+    }
+    vector<vector<vector<Edge*> > > new_bmap_edges(
+        (size_t) new_bmap_n_cols,
+        vector<vector<Edge*> >((size_t) new_bmap_n_rows)
+    );
+    vector<vector<vector<Sector*> > > new_bmap_sectors(
+        (size_t) new_bmap_n_cols,
+        vector<vector<Sector*> >((size_t) new_bmap_n_rows)
+    );
+    for(size_t bx = 0; bx < new_bmap_n_cols; bx++) {
+        for(size_t by = 0; by < new_bmap_n_rows; by++) {
+            uint64_t nr_block_edges;
+            if(!read_number(pos, 4, &nr_block_edges)) return false;
+            for(uint64_t e = 0; e < nr_block_edges; e++) {
+                size_t e_idx;
+                if(!read_idx(pos, edges.size(), false, &e_idx)) return false;
+                new_bmap_edges[bx][by].push_back(edges[e_idx]);
+            }
+            uint64_t nr_block_sectors;
+            if(!read_number(pos, 4, &nr_block_sectors)) return false;
+            for(uint64_t s = 0; s < nr_block_sectors; s++) {
+                size_t s_idx;
+                if(!read_idx(pos, sectors.size(), true, &s_idx)) return false;
+                new_bmap_sectors[bx][by].push_back(
+                    s_idx == INVALID ? nullptr : sectors[s_idx]
+                );
+            }
+        }
+    }
+    
+    if(pos != data.size()) return false;
+    
+    //Everything checks out.
+    for(size_t s = 0; s < sectors.size(); s++) {
+        Sector* s_ptr = sectors[s];
+        s_ptr->triangles.swap(new_triangles[s]);
+        s_ptr->bbox[0] = new_bboxes[s * 2];
+        s_ptr->bbox[1] = new_bboxes[s * 2 + 1];
+        s_ptr->invalidate_texture_draw_caches();
+        s_ptr->triangles_geometry_hash = 0;
+    }
+    if(level == CONTENT_LOAD_LEVEL_EDITOR) {
+        problems.non_simples.insert(
+            new_problems.non_simples.begin(), new_problems.non_simples.end()
+        );
+        problems.lone_edges.insert(
+            new_problems.lone_edges.begin(), new_problems.lone_edges.end()
+        );
+    }
+    if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
+        bmap.clear();
+        bmap.top_left_corner = new_bmap_corner;
+        bmap.n_cols = (size_t) new_bmap_n_cols;
+        bmap.n_rows = (size_t) new_bmap_n_rows;
+        bmap.edges.swap(new_bmap_edges);
+        bmap.sectors.swap(new_bmap_sectors);
+        bmap.update_edge_segs();
+        generate_edge_idxs_blockmap();
+        generate_triangles_blockmap();
+    }
+    
+    return true;
+}
+
+
 /**
  * @brief Loads the area's geometry from a data node.
  *
  * @param node Data node to load from.
  * @param level Level to load at.
+ * @param cache_file_path If not empty, the sector triangles and blockmap
+ * are loaded from the geometry cache file in this path, if it matches
+ * the geometry. Otherwise, they're calculated.
  */
 void Area::load_geometry_from_data_node(
-    DataNode* node, CONTENT_LOAD_LEVEL level
+    DataNode* node, CONTENT_LOAD_LEVEL level, const string &cache_file_path
 ) {
     //Vertexes.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Vertexes");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_AREA_VERTEXES);
     }
     
     size_t n_vertexes =
@@ -1082,7 +1627,7 @@ void Area::load_geometry_from_data_node(
     
     //Edges.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Edges");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_AREA_EDGES);
     }
     
     size_t n_edges =
@@ -1145,7 +1690,7 @@ void Area::load_geometry_from_data_node(
     
     //Sectors.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Sectors");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_AREA_SECTORS);
     }
     
     size_t n_sectors =
@@ -1207,8 +1752,7 @@ void Area::load_geometry_from_data_node(
             );
             
         if(!new_sector->fade && !new_sector->is_bottomless_pit) {
-            new_sector->texture_info.bitmap =
-                game.content.bitmaps.list.get(new_sector->texture_info.bmp_name, nullptr);
+            game.sector_textures.request(new_sector);
         }
         
         DataNode* hazards_node = sector_data->getChildByName("hazards");
@@ -1225,6 +1769,7 @@ void Area::load_geometry_from_data_node(
                 new_sector->hazards.push_back(&(game.content.hazards.list[hazard_name]));
             }
         }
+        new_sector->update_path_blocking_hazards();
         new_sector->hazards_str = hazards_node->value;
         new_sector->hazard_floor =
             s2b(
@@ -1242,7 +1787,9 @@ void Area::load_geometry_from_data_node(
     
     //Mobs.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Object generators");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_AREA_OBJECT_GENERATORS
+        );
     }
     
     vector<std::pair<size_t, size_t> > mob_links_buffer;
@@ -1262,6 +1809,7 @@ void Area::load_geometry_from_data_node(
                 mob_node->getChildByName("angle")->getValueOrDefault("0")
             );
         mob_ptr->vars = mob_node->getChildByName("vars")->value;
+        mob_ptr->vars_map = get_var_map(mob_ptr->vars);
         
         string category_name = mob_node->name;
         string type_name;
@@ -1321,7 +1869,7 @@ void Area::load_geometry_from_data_node(
     
     //Paths.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Paths");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_AREA_PATHS);
     }
     
     size_t n_stops =
@@ -1366,7 +1914,9 @@ void Area::load_geometry_from_data_node(
     
     //Tree shadows.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Tree shadows");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_AREA_TREE_SHADOWS
+        );
     }
     
     size_t n_shadows =
@@ -1423,7 +1973,9 @@ void Area::load_geometry_from_data_node(
     
     //Set up stuff.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Area -- Geometry calculations");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_AREA_GEOMETRY_CALCULATIONS
+        );
     }
     
     for(size_t e = 0; e < edges.size(); e++) {
@@ -1466,22 +2018,39 @@ void Area::load_geometry_from_data_node(
     }
     
     
-    //Triangulate everything and save bounding boxes.
-    set<Edge*> lone_edges;
-    for(size_t s = 0; s < sectors.size(); s++) {
-        Sector* s_ptr = sectors[s];
-        s_ptr->triangles.clear();
-        TRIANGULATION_ERROR res =
-            triangulate_sector(s_ptr, &lone_edges, false);
-            
-        if(res != TRIANGULATION_ERROR_NONE && level == CONTENT_LOAD_LEVEL_EDITOR) {
-            problems.non_simples[s_ptr] = res;
-            problems.lone_edges.insert(
-                lone_edges.begin(), lone_edges.end()
-            );
+    if(
+        !cache_file_path.empty() &&
+        load_geometry_cache(cache_file_path, level)
+    ) {
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
+        return;
+    }
+    
+    //Triangulate everything and save bounding boxes. A sector's
+    //triangulation only reads the shared vertexes and edges, and only
+    //writes to the sector itself, so they can all be done at the same time.
+    vector<TRIANGULATION_ERROR> triangulation_results(sectors.size());
+    game.jobs.parallel_for(
+        sectors.size(), AREA::MIN_TRIANGULATION_JOB_SIZE,
+    [this, &triangulation_results] (size_t start, size_t end) {
+        for(size_t s = start; s < end; s++) {
+            Sector* s_ptr = sectors[s];
+            s_ptr->triangles.clear();
+            triangulation_results[s] =
+                triangulate_sector(s_ptr, nullptr, false);
+            s_ptr->calculate_bounding_box();
+        }
+    }
+    );
+    
+    if(level == CONTENT_LOAD_LEVEL_EDITOR) {
+        for(size_t s = 0; s < sectors.size(); s++) {
+            if(triangulation_results[s] != TRIANGULATION_ERROR_NONE) {
+                problems.non_simples[sectors[s]] = triangulation_results[s];
+            }
         }
-        
-        s_ptr->calculate_bounding_box();
     }
     
     if(level >= CONTENT_LOAD_LEVEL_EDITOR) generate_blockmap();
@@ -1551,6 +2120,29 @@ Vertex* Area::new_vertex() {
 }
 
 
+/**
+ * @brief Reads a little-endian unsigned number from the data
+ * of a geometry cache file.
+ *
+ * @param data The geometry cache file's data.
+ * @param pos Position to read from. This is moved forward.
+ * @param nr_bytes How many bytes the number takes up.
+ * @param out_number The number is returned here.
+ * @return Whether it succeeded, i.e. whether there was enough data.
+ */
+bool Area::read_geometry_cache_number(
+    const string &data, size_t &pos, size_t nr_bytes, uint64_t* out_number
+) {
+    if(nr_bytes > data.size() - pos) return false;
+    *out_number = 0;
+    for(size_t b = 0; b < nr_bytes; b++) {
+        *out_number |= (uint64_t) (unsigned char) data[pos + b] << (b * 8);
+    }
+    pos += nr_bytes;
+    return true;
+}
+
+
 /**
  * @brief Removes an edge from the list, and updates all indexes after it.
  *
@@ -1695,28 +2287,128 @@ void Area::remove_vertex(const Vertex* v_ptr) {
 
 
 /**
- * @brief Saves the area's geometry to a data node.
+ * @brief Saves the sector triangles, bounding boxes, and blockmap into
+ * a geometry cache file, so that loading the area later doesn't need to
+ * calculate them. The cache is tied to the current geometry, via its hash,
+ * so the elements' index members must be up to date.
  *
- * @param node Data node to save to.
+ * @param file_path Path to the geometry cache file.
+ * @return Whether it succeeded.
+ */
+bool Area::save_geometry_cache(const string &file_path) const {
+    //Finding each index by going through the lists would be too slow
+    //for the blockmap, which has lots of references.
+    unordered_map<const Vertex*, size_t> vertex_idxs;
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        vertex_idxs[vertexes[v]] = v;
+    }
+    unordered_map<const Edge*, size_t> edge_idxs;
+    for(size_t e = 0; e < edges.size(); e++) {
+        edge_idxs[edges[e]] = e;
+    }
+    unordered_map<const Sector*, size_t> sector_idxs;
+    sector_idxs[nullptr] = UINT32_MAX;
+    for(size_t s = 0; s < sectors.size(); s++) {
+        sector_idxs[sectors[s]] = s;
+    }
+    
+    string data = AREA::GEOMETRY_CACHE_MAGIC_NUMBER;
+    const auto write_float = [&data] (float f) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        write_geometry_cache_number(data, bits, 4);
+    };
+    
+    //Header.
+    write_geometry_cache_number(data, AREA::GEOMETRY_CACHE_VERSION, 1);
+    write_geometry_cache_number(data, get_geometry_hash(), 8);
+    
+    //Sector triangles and bounding boxes.
+    write_geometry_cache_number(data, sectors.size(), 4);
+    for(size_t s = 0; s < sectors.size(); s++) {
+        const Sector* s_ptr = sectors[s];
+        write_float(s_ptr->bbox[0].x);
+        write_float(s_ptr->bbox[0].y);
+        write_float(s_ptr->bbox[1].x);
+        write_float(s_ptr->bbox[1].y);
+        write_geometry_cache_number(data, s_ptr->triangles.size(), 4);
+        for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
+            for(unsigned char p = 0; p < 3; p++) {
+                auto v_it = vertex_idxs.find(s_ptr->triangles[t].points[p]);
+                if(v_it == vertex_idxs.end()) return false;
+                write_geometry_cache_number(data, v_it->second, 4);
+            }
+        }
+    }
+    
+    //Geometry problems.
+    write_geometry_cache_number(data, problems.non_simples.size(), 4);
+    for(auto &n : problems.non_simples) {
+        write_geometry_cache_number(data, sector_idxs.at(n.first), 4);
+        write_geometry_cache_number(data, n.second, 1);
+    }
+    write_geometry_cache_number(data, problems.lone_edges.size(), 4);
+    for(auto &l : problems.lone_edges) {
+        write_geometry_cache_number(data, edge_idxs.at(l), 4);
+    }
+    
+    //Blockmap.
+    write_float(bmap.top_left_corner.x);
+    write_float(bmap.top_left_corner.y);
+    write_geometry_cache_number(data, bmap.n_cols, 4);
+    write_geometry_cache_number(data, bmap.n_rows, 4);
+    for(size_t bx = 0; bx < bmap.n_cols; bx++) {
+        for(size_t by = 0; by < bmap.n_rows; by++) {
+            const vector<Edge*> &block_edges = bmap.edges[bx][by];
+            write_geometry_cache_number(data, block_edges.size(), 4);
+            for(size_t e = 0; e < block_edges.size(); e++) {
+                write_geometry_cache_number(
+                    data, edge_idxs.at(block_edges[e]), 4
+                );
+            }
+            const vector<Sector*> &block_sectors = bmap.sectors[bx][by];
+            write_geometry_cache_number(data, block_sectors.size(), 4);
+            for(auto &s : block_sectors) {
+                write_geometry_cache_number(data, sector_idxs.at(s), 4);
+            }
+        }
+    }
+    
+    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "wb");
+    if(!file) return false;
+    size_t written = al_fwrite(file, data.c_str(), data.size());
+    al_fclose(file);
+    return written == data.size();
+}
+
+
+/**
+ * @brief Saves the area's geometry with a data node writer.
+ * Big areas have a lot of geometry, so this writes the text directly,
+ * instead of building a tree of data nodes first.
+ *
+ * @param writer Data node writer to write with.
  */
-void Area::save_geometry_to_data_node(DataNode* node) {
+void Area::save_geometry(DataNodeWriter &writer) {
+    GetterWriter gw(&writer);
+    
     //Vertexes.
-    DataNode* vertexes_node = node->addNew("vertexes");
+    writer.beginNode("vertexes");
     for(size_t v = 0; v < vertexes.size(); v++) {
     
         //Vertex.
         Vertex* v_ptr = vertexes[v];
-        vertexes_node->addNew("v", p2s(v2p(v_ptr)));
+        writer.addValue("v", p2s(v2p(v_ptr)));
     }
+    writer.endNode();
     
     //Edges.
-    DataNode* edges_node = node->addNew("edges");
+    writer.beginNode("edges");
     for(size_t e = 0; e < edges.size(); e++) {
     
         //Edge.
         Edge* e_ptr = edges[e];
-        DataNode* edge_node = edges_node->addNew("e");
-        GetterWriter egw(edge_node);
+        writer.beginNode("e");
         
         string s_str;
         for(size_t s = 0; s < 2; s++) {
@@ -1728,74 +2420,75 @@ void Area::save_geometry_to_data_node(DataNode* node) {
         string v_str =
             i2s(e_ptr->vertex_idxs[0]) + " " + i2s(e_ptr->vertex_idxs[1]);
             
-        egw.get("s", s_str);
-        egw.get("v", v_str);
+        gw.get("s", s_str);
+        gw.get("v", v_str);
         
         if(e_ptr->wall_shadow_length != LARGE_FLOAT) {
-            egw.get("shadow_length", e_ptr->wall_shadow_length);
+            gw.get("shadow_length", e_ptr->wall_shadow_length);
         }
         
         if(e_ptr->wall_shadow_color != GEOMETRY::SHADOW_DEF_COLOR) {
-            egw.get("shadow_color", e_ptr->wall_shadow_color);
+            gw.get("shadow_color", e_ptr->wall_shadow_color);
         }
         
         if(e_ptr->ledge_smoothing_length != 0.0f) {
-            egw.get("smoothing_length", e_ptr->ledge_smoothing_length);
+            gw.get("smoothing_length", e_ptr->ledge_smoothing_length);
         }
         
         if(e_ptr->ledge_smoothing_color != GEOMETRY::SMOOTHING_DEF_COLOR) {
-            egw.get("smoothing_color", e_ptr->ledge_smoothing_color);
+            gw.get("smoothing_color", e_ptr->ledge_smoothing_color);
         }
+        writer.endNode();
     }
+    writer.endNode();
     
     //Sectors.
-    DataNode* sectors_node = node->addNew("sectors");
+    writer.beginNode("sectors");
     for(size_t s = 0; s < sectors.size(); s++) {
     
         //Sector.
         Sector* s_ptr = sectors[s];
-        DataNode* sector_node = sectors_node->addNew("s");
-        GetterWriter sgw(sector_node);
+        writer.beginNode("s");
         
         if(s_ptr->type != SECTOR_TYPE_NORMAL) {
-            sgw.get("type", game.sector_types.get_name(s_ptr->type));
+            gw.get("type", game.sector_types.get_name(s_ptr->type));
         }
         if(s_ptr->is_bottomless_pit) {
-            sgw.get("is_bottomless_pit", true);
+            gw.get("is_bottomless_pit", true);
         }
-        sgw.get("z", s_ptr->z);
+        gw.get("z", s_ptr->z);
         if(s_ptr->brightness != GEOMETRY::DEF_SECTOR_BRIGHTNESS) {
-            sgw.get("brightness", s_ptr->brightness);
+            gw.get("brightness", s_ptr->brightness);
         }
         if(!s_ptr->tag.empty()) {
-            sgw.get("tag", s_ptr->tag);
+            gw.get("tag", s_ptr->tag);
         }
         if(s_ptr->fade) {
-            sgw.get("fade", s_ptr->fade);
+            gw.get("fade", s_ptr->fade);
         }
         if(!s_ptr->hazards_str.empty()) {
-            sgw.get("hazards", s_ptr->hazards_str);
-            sgw.get("hazards_floor", s_ptr->hazard_floor);
+            gw.get("hazards", s_ptr->hazards_str);
+            gw.get("hazards_floor", s_ptr->hazard_floor);
         }
         
         if(!s_ptr->texture_info.bmp_name.empty()) {
-            sgw.get("texture", s_ptr->texture_info.bmp_name);
+            gw.get("texture", s_ptr->texture_info.bmp_name);
         }
         
         if(s_ptr->texture_info.rot != 0) {
-            sgw.get("texture_rotate", s_ptr->texture_info.rot);
+            gw.get("texture_rotate", s_ptr->texture_info.rot);
         }
         if(
             s_ptr->texture_info.scale.x != 1 ||
             s_ptr->texture_info.scale.y != 1
         ) {
-            sgw.get("texture_scale", s_ptr->texture_info.scale);
+            gw.get("texture_scale", s_ptr->texture_info.scale);
         }
         if(
             s_ptr->texture_info.translation.x != 0 ||
             s_ptr->texture_info.translation.y != 0
         ) {
-            sgw.get("texture_trans", s_ptr->texture_info.translation);
+            gw.get("texture_trans", s_ptr->texture_info.translation);
         }
         if(
             s_ptr->texture_info.tint.r != 1.0 ||
@@ -1803,13 +2496,15 @@ void Area::save_geometry_to_data_node(DataNode* node) {
             s_ptr->texture_info.tint.b != 1.0 ||
             s_ptr->texture_info.tint.a != 1.0
         ) {
-            sgw.get("texture_tint", s_ptr->texture_info.tint);
+            gw.get("texture_tint", s_ptr->texture_info.tint);
         }
         
+        writer.endNode();
     }
+    writer.endNode();
     
     //Mobs.
-    DataNode* mobs_node = node->addNew("mobs");
+    writer.beginNode("mobs");
     for(size_t m = 0; m < mob_generators.size(); m++) {
     
         //Mob.
@@ -1818,18 +2513,17 @@ void Area::save_geometry_to_data_node(DataNode* node) {
         if(m_ptr->type && m_ptr->type->category) {
             cat_name = m_ptr->type->category->internal_name;
         }
-        DataNode* mob_node = mobs_node->addNew(cat_name);
-        GetterWriter mgw(mob_node);
+        writer.beginNode(cat_name);
         
         if(m_ptr->type) {
-            mgw.get("type", m_ptr->type->manifest->internal_name);
+            gw.get("type", m_ptr->type->manifest->internal_name);
         }
-        mgw.get("p", m_ptr->pos);
+        gw.get("p", m_ptr->pos);
         if(m_ptr->angle != 0) {
-            mgw.get("angle", m_ptr->angle);
+            gw.get("angle", m_ptr->angle);
         }
         if(!m_ptr->vars.empty()) {
-            mgw.get("vars", m_ptr->vars);
+            gw.get("vars", m_ptr->vars);
         }
         
         string links_str;
@@ -1839,67 +2533,72 @@ void Area::save_geometry_to_data_node(DataNode* node) {
         }
         
         if(!links_str.empty()) {
-            mgw.get("links", links_str);
+            gw.get("links", links_str);
         }
         
         if(m_ptr->stored_inside != INVALID) {
-            mgw.get("stored_inside", m_ptr->stored_inside);
+            gw.get("stored_inside", m_ptr->stored_inside);
         }
+        writer.endNode();
     }
+    writer.endNode();
     
     //Path stops.
-    DataNode* path_stops_node = node->addNew("path_stops");
+    writer.beginNode("path_stops");
     for(size_t s = 0; s < path_stops.size(); s++) {
     
         //Path stop.
         PathStop* s_ptr = path_stops[s];
-        DataNode* path_stop_node = path_stops_node->addNew("s");
-        GetterWriter sgw(path_stop_node);
+        writer.beginNode("s");
         
-        sgw.get("pos", s_ptr->pos);
+        gw.get("pos", s_ptr->pos);
         if(s_ptr->radius != PATHS::MIN_STOP_RADIUS) {
-            sgw.get("radius", s_ptr->radius);
+            gw.get("radius", s_ptr->radius);
         }
         if(s_ptr->flags != 0) {
-            sgw.get("flags", s_ptr->flags);
+            gw.get("flags", s_ptr->flags);
         }
         if(!s_ptr->label.empty()) {
-            sgw.get("label", s_ptr->label);
+            gw.get("label", s_ptr->label);
         }
         
-        DataNode* links_node = path_stop_node->addNew("links");
+        writer.beginNode("links");
         for(size_t l = 0; l < s_ptr->links.size(); l++) {
             PathLink* l_ptr = s_ptr->links[l];
             string link_data = i2s(l_ptr->end_idx);
             if(l_ptr->type != PATH_LINK_TYPE_NORMAL) {
                 link_data += " " + i2s(l_ptr->type);
             }
-            links_node->addNew("l", link_data);
+            writer.addValue("l", link_data);
         }
+        writer.endNode();
         
+        writer.endNode();
     }
+    writer.endNode();
     
     //Tree shadows.
-    DataNode* shadows_node = node->addNew("tree_shadows");
+    writer.beginNode("tree_shadows");
     for(size_t s = 0; s < tree_shadows.size(); s++) {
     
         //Tree shadow.
         TreeShadow* s_ptr = tree_shadows[s];
-        DataNode* shadow_node = shadows_node->addNew("shadow");
-        GetterWriter sgw(shadow_node);
+        writer.beginNode("shadow");
         
-        sgw.get("pos", s_ptr->center);
-        sgw.get("size", s_ptr->size);
-        sgw.get("file", s_ptr->bmp_name);
-        sgw.get("sway", s_ptr->sway);
+        gw.get("pos", s_ptr->center);
+        gw.get("size", s_ptr->size);
+        gw.get("file", s_ptr->bmp_name);
+        gw.get("sway", s_ptr->sway);
         if(s_ptr->angle != 0) {
-            sgw.get("angle", s_ptr->angle);
+            gw.get("angle", s_ptr->angle);
         }
         if(s_ptr->alpha != 255) {
-            sgw.get("alpha", s_ptr->alpha);
+            gw.get("alpha", s_ptr->alpha);
         }
         
+        writer.endNode();
     }
+    writer.endNode();
 }
 
 
@@ -2085,18 +2784,127 @@ void Area::save_thumbnail(bool to_backup) {
 }
 
 
+/**
+ * @brief Adds the edges of a block that passed the last check to a list.
+ * Edges that were already added by another block get added again, so
+ * the list must go through finish_edge_query() at the end.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @param out_edges List to add to.
+ */
+void Blockmap::add_near_edges(
+    size_t col, size_t row, vector<Edge*> &out_edges
+) const {
+    const vector<Edge*> &block_edges = edges[col][row];
+    for(size_t i = 0; i < near_edge_idxs.size(); i++) {
+        out_edges.push_back(block_edges[near_edge_idxs[i]]);
+    }
+}
+
+
+/**
+ * @brief Adds a sector to a block's list of sectors, if it isn't there yet.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ * @param s_ptr Sector to add. Can be nullptr.
+ */
+void Blockmap::add_sector(size_t col, size_t row, Sector* s_ptr) {
+    vector<Sector*> &block_sectors = sectors[col][row];
+    if(is_in_container(block_sectors, s_ptr)) return;
+    block_sectors.push_back(s_ptr);
+}
+
+
+/**
+ * @brief Splits a block's edges into height buckets, if it has enough edges
+ * over a wide enough range of heights for it to be worth it.
+ * The block's edge coordinates and wall heights must already be filled.
+ *
+ * @param col Column of the block.
+ * @param row Row of the block.
+ */
+void Blockmap::build_z_buckets(size_t col, size_t row) {
+    const vector<Edge*> &block_edges = edges[col][row];
+    const BlockmapEdgeWalls &walls = edge_walls[col][row];
+    BlockmapZBuckets &buckets = z_buckets[col][row];
+    if(block_edges.size() < AREA::BLOCKMAP_Z_BUCKET_MIN_EDGES) return;
+    
+    //Find the range of heights. Edges on the limits of the area, or next
+    //to blocking sectors, reach infinitely far, so those ends don't count.
+    float min_z = FLT_MAX;
+    float max_z = -FLT_MAX;
+    for(size_t e = 0; e < block_edges.size(); e++) {
+        if(walls.min_zs[e] > walls.max_zs[e]) continue;
+        if(walls.min_zs[e] != -FLT_MAX) {
+            min_z = std::min(min_z, walls.min_zs[e]);
+        }
+        if(walls.max_zs[e] != FLT_MAX) {
+            max_z = std::max(max_z, walls.max_zs[e]);
+        }
+    }
+    if(min_z >= max_z) return;
+    
+    size_t n_buckets =
+        std::min(
+            (size_t) ceil((max_z - min_z) / AREA::BLOCKMAP_Z_BUCKET_SIZE),
+            AREA::BLOCKMAP_MAX_Z_BUCKETS
+        );
+    if(n_buckets < 2) return;
+    
+    //Fill the buckets.
+    buckets.start_z = min_z;
+    buckets.edge_idxs.assign(n_buckets, vector<size_t>());
+    buckets.edge_segs.assign(n_buckets, LineSegBatch());
+    for(size_t e = 0; e < block_edges.size(); e++) {
+        if(walls.min_zs[e] > walls.max_zs[e]) continue;
+        size_t first_bucket = buckets.get_bucket(walls.min_zs[e]);
+        size_t last_bucket = buckets.get_bucket(walls.max_zs[e]);
+        for(size_t b = first_bucket; b <= last_bucket; b++) {
+            buckets.edge_idxs[b].push_back(e);
+            buckets.edge_segs[b].add(
+                v2p(block_edges[e]->vertexes[0]),
+                v2p(block_edges[e]->vertexes[1])
+            );
+        }
+    }
+}
+
+
 /**
  * @brief Clears the info of the blockmap.
  */
 void Blockmap::clear() {
     top_left_corner = Point();
     edges.clear();
+    edge_segs.clear();
+    edge_walls.clear();
+    z_buckets.clear();
+    edge_idxs.clear();
     sectors.clear();
+    triangles.clear();
     n_cols = 0;
     n_rows = 0;
 }
 
 
+/**
+ * @brief Finishes a query's list of edges, by sorting it and removing
+ * the edges that were added by more than one block. Sorting keeps the same
+ * order a set would have, so the results of any logic that depends on
+ * the order of the edges stay consistent.
+ *
+ * @param out_edges The list of edges.
+ */
+void Blockmap::finish_edge_query(vector<Edge*> &out_edges) {
+    std::sort(out_edges.begin(), out_edges.end());
+    out_edges.erase(
+        std::unique(out_edges.begin(), out_edges.end()), out_edges.end()
+    );
+}
+
+
 /**
  * @brief Returns the block column in which an X coordinate is contained.
  *
@@ -2111,19 +2919,116 @@ size_t Blockmap::get_col(float x) const {
 }
 
 
+/**
+ * @brief Obtains a list of the indexes of all edges in the blocks that
+ * the specified rectangular region touches. Unlike get_edges_in_region,
+ * the region can go beyond the blockmap's limits, and edges without
+ * a change of height are included too.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param out_edge_idxs Vector to fill the edge indexes into.
+ * It gets cleared first. The indexes are sorted, with no repeats.
+ */
+void Blockmap::get_edge_idxs_in_region(
+    const Point &tl, const Point &br, vector<size_t> &out_edge_idxs
+) const {
+    out_edge_idxs.clear();
+    if(edge_idxs.empty() || n_cols == 0 || n_rows == 0) return;
+    
+    Point rel_tl = (tl - top_left_corner) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    Point rel_br = (br - top_left_corner) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    if(rel_br.x < 0.0f || rel_br.y < 0.0f) return;
+    if(rel_tl.x >= n_cols || rel_tl.y >= n_rows) return;
+    
+    size_t bx1 = rel_tl.x <= 0.0f ? 0 : (size_t) rel_tl.x;
+    size_t by1 = rel_tl.y <= 0.0f ? 0 : (size_t) rel_tl.y;
+    size_t bx2 = rel_br.x >= n_cols ? n_cols - 1 : (size_t) rel_br.x;
+    size_t by2 = rel_br.y >= n_rows ? n_rows - 1 : (size_t) rel_br.y;
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            out_edge_idxs.insert(
+                out_edge_idxs.end(),
+                edge_idxs[bx][by].begin(), edge_idxs[bx][by].end()
+            );
+        }
+    }
+    
+    std::sort(out_edge_idxs.begin(), out_edge_idxs.end());
+    out_edge_idxs.erase(
+        std::unique(out_edge_idxs.begin(), out_edge_idxs.end()),
+        out_edge_idxs.end()
+    );
+}
+
+
 /**
  * @brief Obtains a list of edges that are within the specified
- * rectangular region.
+ * rectangular region. No memory is allocated as long as the vector
+ * already has enough capacity, so callers can reuse the same vector
+ * from query to query.
  *
  * @param tl Top-left coordinates of the region.
  * @param br Bottom-right coordinates of the region.
- * @param out_edges Set to fill the edges into.
+ * @param out_edges Vector to fill the edges into. It gets cleared first.
+ * The edges are sorted by their address, with no repeats.
  * @return Whether it succeeded.
  */
 bool Blockmap::get_edges_in_region(
-    const Point &tl, const Point &br, set<Edge*> &out_edges
+    const Point &tl, const Point &br, vector<Edge*> &out_edges
 ) const {
+    out_edges.clear();
+    
+    size_t bx1 = get_col(tl.x);
+    size_t bx2 = get_col(br.x);
+    size_t by1 = get_row(tl.y);
+    size_t by2 = get_row(br.y);
+    
+    if(
+        bx1 == INVALID || bx2 == INVALID ||
+        by1 == INVALID || by2 == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            out_edges.insert(
+                out_edges.end(), edges[bx][by].begin(), edges[bx][by].end()
+            );
+        }
+    }
+    
+    finish_edge_query(out_edges);
+    
+    return true;
+}
 
+
+/**
+ * @brief Obtains a list of edges that are within the specified rectangular
+ * region, and that can work as walls somewhere inside a range of Z.
+ * This is like the other get_edges_in_region, except edges that can't
+ * collide with anything in that range of Z, like the ones on a bridge far
+ * above, are thrown away. In blocks split into height buckets, those aren't
+ * even looked at.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param min_z Lowest Z of the range, like the Z of a mob.
+ * @param max_z Highest Z of the range, like the Z of a mob plus its height.
+ * @param out_edges Vector to fill the edges into. It gets cleared first.
+ * The edges are sorted by their address, with no repeats.
+ * @return Whether it succeeded.
+ */
+bool Blockmap::get_edges_in_region(
+    const Point &tl, const Point &br, float min_z, float max_z,
+    vector<Edge*> &out_edges
+) const {
+    out_edges.clear();
+    
     size_t bx1 = get_col(tl.x);
     size_t bx2 = get_col(br.x);
     size_t by1 = get_row(tl.y);
@@ -2139,19 +3044,209 @@ bool Blockmap::get_edges_in_region(
     
     for(size_t bx = bx1; bx <= bx2; bx++) {
         for(size_t by = by1; by <= by2; by++) {
-        
-            const vector<Edge*> &block_edges = edges[bx][by];
+            const BlockmapEdgeWalls &walls = edge_walls[bx][by];
+            const BlockmapZBuckets &buckets = z_buckets[bx][by];
             
-            for(size_t e = 0; e < block_edges.size(); e++) {
-                out_edges.insert(block_edges[e]);
+            //Gather the candidates.
+            near_edge_idxs.clear();
+            if(buckets.edge_idxs.empty()) {
+                for(size_t e = 0; e < edges[bx][by].size(); e++) {
+                    near_edge_idxs.push_back(e);
+                }
+            } else {
+                size_t first_bucket = buckets.get_bucket(min_z);
+                size_t last_bucket = buckets.get_bucket(max_z);
+                for(size_t b = first_bucket; b <= last_bucket; b++) {
+                    near_edge_idxs.insert(
+                        near_edge_idxs.end(),
+                        buckets.edge_idxs[b].begin(),
+                        buckets.edge_idxs[b].end()
+                    );
+                }
+            }
+            
+            //Keep the ones that can be walls in the range.
+            size_t n_walls = 0;
+            for(size_t i = 0; i < near_edge_idxs.size(); i++) {
+                size_t e = near_edge_idxs[i];
+                if(max_z < walls.min_zs[e] || min_z > walls.max_zs[e]) {
+                    continue;
+                }
+                near_edge_idxs[n_walls] = e;
+                n_walls++;
             }
+            near_edge_idxs.resize(n_walls);
+            add_near_edges(bx, by, out_edges);
+        }
+    }
+    
+    finish_edge_query(out_edges);
+    
+    return true;
+}
+
+
+/**
+ * @brief Obtains a list of edges that could be touching a circle.
+ * This is like get_edges_in_region, except each block's edges are first
+ * checked against the circle all at once, so most of the ones that are
+ * clearly too far away don't make it to the list. The ones that do
+ * still need to be checked with circle_intersects_line_seg().
+ *
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param out_edges The list of edges is returned here.
+ * @return Whether it succeeded.
+ */
+bool Blockmap::get_edges_near_circle(
+    const Point &center, float radius, vector<Edge*> &out_edges
+) const {
+    out_edges.clear();
+    
+    size_t bx1 = get_col(center.x - radius);
+    size_t bx2 = get_col(center.x + radius);
+    size_t by1 = get_row(center.y - radius);
+    size_t by2 = get_row(center.y + radius);
+    
+    if(
+        bx1 == INVALID || bx2 == INVALID ||
+        by1 == INVALID || by2 == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            get_line_segs_near_circle(
+                edge_segs[bx][by], center, radius, near_edge_idxs
+            );
+            add_near_edges(bx, by, out_edges);
+        }
+    }
+    
+    finish_edge_query(out_edges);
+    
+    return true;
+}
+
+
+/**
+ * @brief Obtains a list of edges that could be intersecting a line segment.
+ * This is like get_edges_in_region, except each block's edges are first
+ * checked against the line segment all at once, so most of the ones that
+ * are clearly out of the way don't make it to the list. The ones that do
+ * still need to be checked with line_segs_intersect().
+ *
+ * @param p1 First point of the line segment.
+ * @param p2 Second point of the line segment.
+ * @param out_edges The list of edges is returned here.
+ * @return Whether it succeeded.
+ */
+bool Blockmap::get_edges_near_line_seg(
+    const Point &p1, const Point &p2, vector<Edge*> &out_edges
+) const {
+    out_edges.clear();
+    
+    Point tl = p1;
+    Point br = p1;
+    update_min_max_coords(tl, br, p2);
+    size_t bx1 = get_col(tl.x);
+    size_t bx2 = get_col(br.x);
+    size_t by1 = get_row(tl.y);
+    size_t by2 = get_row(br.y);
+    
+    if(
+        bx1 == INVALID || bx2 == INVALID ||
+        by1 == INVALID || by2 == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            get_line_segs_near_line_seg(
+                edge_segs[bx][by], p1, p2, near_edge_idxs
+            );
+            add_near_edges(bx, by, out_edges);
         }
     }
     
+    finish_edge_query(out_edges);
+    
     return true;
 }
 
 
+/**
+ * @brief Returns roughly how much memory the blockmap takes up, in bytes.
+ *
+ * @return The size.
+ */
+size_t Blockmap::get_memory_usage() const {
+    size_t size = 0;
+    auto add_grid = [&size] (const auto &grid) {
+        size += get_vector_memory_usage(grid);
+        for(size_t c = 0; c < grid.size(); c++) {
+            size += get_vector_memory_usage(grid[c]);
+            for(size_t r = 0; r < grid[c].size(); r++) {
+                size += get_vector_memory_usage(grid[c][r]);
+            }
+        }
+    };
+    add_grid(edges);
+    add_grid(edge_idxs);
+    add_grid(sectors);
+    add_grid(triangles);
+    
+    size += get_vector_memory_usage(edge_segs);
+    for(size_t c = 0; c < edge_segs.size(); c++) {
+        size += get_vector_memory_usage(edge_segs[c]);
+        for(size_t r = 0; r < edge_segs[c].size(); r++) {
+            const LineSegBatch &segs = edge_segs[c][r];
+            size +=
+                get_vector_memory_usage(segs.x1s) +
+                get_vector_memory_usage(segs.y1s) +
+                get_vector_memory_usage(segs.x2s) +
+                get_vector_memory_usage(segs.y2s);
+        }
+    }
+    
+    size += get_vector_memory_usage(edge_walls);
+    for(size_t c = 0; c < edge_walls.size(); c++) {
+        size += get_vector_memory_usage(edge_walls[c]);
+        for(size_t r = 0; r < edge_walls[c].size(); r++) {
+            const BlockmapEdgeWalls &walls = edge_walls[c][r];
+            size +=
+                get_vector_memory_usage(walls.min_zs) +
+                get_vector_memory_usage(walls.max_zs);
+        }
+    }
+    
+    size += get_vector_memory_usage(z_buckets);
+    for(size_t c = 0; c < z_buckets.size(); c++) {
+        size += get_vector_memory_usage(z_buckets[c]);
+        for(size_t r = 0; r < z_buckets[c].size(); r++) {
+            const BlockmapZBuckets &buckets = z_buckets[c][r];
+            size +=
+                get_vector_memory_usage(buckets.edge_idxs) +
+                get_vector_memory_usage(buckets.edge_segs);
+            for(size_t b = 0; b < buckets.edge_idxs.size(); b++) {
+                const LineSegBatch &segs = buckets.edge_segs[b];
+                size +=
+                    get_vector_memory_usage(buckets.edge_idxs[b]) +
+                    get_vector_memory_usage(segs.x1s) +
+                    get_vector_memory_usage(segs.y1s) +
+                    get_vector_memory_usage(segs.x2s) +
+                    get_vector_memory_usage(segs.y2s);
+            }
+        }
+    }
+    return size;
+}
+
+
 /**
  * @brief Returns the block row in which a Y coordinate is contained.
  *
@@ -2166,6 +3261,54 @@ size_t Blockmap::get_row(float y) const {
 }
 
 
+/**
+ * @brief Obtains a list of sectors that are in the blocks that the
+ * specified rectangular region occupies. Sectors further away are
+ * not returned, but sectors that are returned aren't necessarily
+ * inside the region.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param out_sectors The sectors are returned here, with no repeats, and
+ * without the void sector. This vector is cleared beforehand.
+ */
+void Blockmap::get_sectors_in_region(
+    const Point &tl, const Point &br, vector<Sector*> &out_sectors
+) const {
+    out_sectors.clear();
+    if(sectors.empty() || n_cols == 0 || n_rows == 0) return;
+    
+    Point rel_tl = (tl - top_left_corner) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    Point rel_br = (br - top_left_corner) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    if(rel_br.x < 0.0f || rel_br.y < 0.0f) return;
+    if(rel_tl.x >= n_cols || rel_tl.y >= n_rows) return;
+    
+    size_t bx1 = rel_tl.x <= 0.0f ? 0 : (size_t) rel_tl.x;
+    size_t by1 = rel_tl.y <= 0.0f ? 0 : (size_t) rel_tl.y;
+    size_t bx2 = rel_br.x >= n_cols ? n_cols - 1 : (size_t) rel_br.x;
+    size_t by2 = rel_br.y >= n_rows ? n_rows - 1 : (size_t) rel_br.y;
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            out_sectors.insert(
+                out_sectors.end(),
+                sectors[bx][by].begin(), sectors[bx][by].end()
+            );
+        }
+    }
+    
+    //Sectors that span several blocks show up once per block.
+    std::sort(out_sectors.begin(), out_sectors.end());
+    out_sectors.erase(
+        std::unique(out_sectors.begin(), out_sectors.end()),
+        out_sectors.end()
+    );
+    if(!out_sectors.empty() && !out_sectors[0]) {
+        out_sectors.erase(out_sectors.begin());
+    }
+}
+
+
 /**
  * @brief Returns the top-left coordinates for the specified column and row.
  *
@@ -2182,6 +3325,127 @@ Point Blockmap::get_top_left_corner(size_t col, size_t row) const {
 }
 
 
+/**
+ * @brief Obtains a list of edges that could be working as walls for a mob
+ * with a circular body, at a given Z.
+ * This is like get_edges_near_circle, except the edges that can't be walls
+ * at that Z are also thrown away, before anything else is checked about
+ * them. The ones that make it still need to be checked with
+ * circle_intersects_line_seg(), and edges on the limits of the area
+ * still need to be handled.
+ *
+ * @param center Center of the circle.
+ * @param radius Radius of the circle.
+ * @param z Z of the mob.
+ * @param out_edges The list of edges is returned here.
+ * @return Whether it succeeded.
+ */
+bool Blockmap::get_wall_edges_near_circle(
+    const Point &center, float radius, float z, vector<Edge*> &out_edges
+) const {
+    out_edges.clear();
+    
+    size_t bx1 = get_col(center.x - radius);
+    size_t bx2 = get_col(center.x + radius);
+    size_t by1 = get_row(center.y - radius);
+    size_t by2 = get_row(center.y + radius);
+    
+    if(
+        bx1 == INVALID || bx2 == INVALID ||
+        by1 == INVALID || by2 == INVALID
+    ) {
+        //Out of bounds.
+        return false;
+    }
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            const BlockmapEdgeWalls &walls = edge_walls[bx][by];
+            const BlockmapZBuckets &buckets = z_buckets[bx][by];
+            const vector<size_t>* bucket_edge_idxs = nullptr;
+            if(buckets.edge_idxs.empty()) {
+                get_line_segs_near_circle(
+                    edge_segs[bx][by], center, radius, near_edge_idxs
+                );
+            } else {
+                //Only check the edges in this Z's bucket.
+                size_t b = buckets.get_bucket(z);
+                bucket_edge_idxs = &buckets.edge_idxs[b];
+                get_line_segs_near_circle(
+                    buckets.edge_segs[b], center, radius, near_edge_idxs
+                );
+            }
+            size_t n_walls = 0;
+            for(size_t i = 0; i < near_edge_idxs.size(); i++) {
+                size_t e = near_edge_idxs[i];
+                if(bucket_edge_idxs) e = (*bucket_edge_idxs)[e];
+                if(z < walls.min_zs[e] || z > walls.max_zs[e]) continue;
+                near_edge_idxs[n_walls] = e;
+                n_walls++;
+            }
+            near_edge_idxs.resize(n_walls);
+            add_near_edges(bx, by, out_edges);
+        }
+    }
+    
+    finish_edge_query(out_edges);
+    
+    return true;
+}
+
+
+/**
+ * @brief Fills each block's batch of edge coordinates, and the heights at
+ * which its edges can be walls, based on its list of edges. It also splits
+ * the edges of crowded blocks into height buckets.
+ * This must be called whenever the lists or the sectors' heights change.
+ */
+void Blockmap::update_edge_segs() {
+    edge_segs.assign(n_cols, vector<LineSegBatch>(n_rows));
+    edge_walls.assign(n_cols, vector<BlockmapEdgeWalls>(n_rows));
+    z_buckets.assign(n_cols, vector<BlockmapZBuckets>(n_rows));
+    game.jobs.parallel_for(
+        std::min(edges.size(), n_cols), AREA::MIN_BLOCKMAP_JOB_SIZE,
+    [this] (size_t start, size_t end) {
+        for(size_t bx = start; bx < end; bx++) {
+            for(size_t by = 0; by < edges[bx].size() && by < n_rows; by++) {
+                LineSegBatch &segs = edge_segs[bx][by];
+                BlockmapEdgeWalls &walls = edge_walls[bx][by];
+                const vector<Edge*> &block_edges = edges[bx][by];
+                for(size_t e = 0; e < block_edges.size(); e++) {
+                    Edge* e_ptr = block_edges[e];
+                    segs.add(
+                        v2p(e_ptr->vertexes[0]), v2p(e_ptr->vertexes[1])
+                    );
+                    
+                    float min_z;
+                    float max_z;
+                    e_ptr->get_wall_z_range(&min_z, &max_z);
+                    walls.min_zs.push_back(min_z);
+                    walls.max_zs.push_back(max_z);
+                }
+                build_z_buckets(bx, by);
+            }
+        }
+    }
+    );
+}
+
+
+/**
+ * @brief Returns which bucket covers a given Z.
+ *
+ * @param z Z to check.
+ * @return The bucket's index.
+ */
+size_t BlockmapZBuckets::get_bucket(float z) const {
+    float rel_z = (z - start_z) / AREA::BLOCKMAP_Z_BUCKET_SIZE;
+    if(rel_z <= 0.0f) return 0;
+    if(rel_z >= edge_idxs.size() - 1) return edge_idxs.size() - 1;
+    return (size_t) rel_z;
+}
+
+
 /**
  * @brief Constructs a new mob generator object.
  *
@@ -2196,7 +3460,8 @@ MobGen::MobGen(
     type(type),
     pos(pos),
     angle(angle),
-    vars(vars) {
+    vars(vars),
+    vars_map(get_var_map(vars)) {
     
 }
 
@@ -2213,11 +3478,27 @@ void MobGen::clone(MobGen* destination, bool include_position) const {
     if(include_position) destination->pos = pos;
     destination->type = type;
     destination->vars = vars;
+    destination->vars_map = vars_map;
     destination->link_idxs = link_idxs;
     destination->stored_inside = stored_inside;
 }
 
 
+/**
+ * @brief Returns roughly how much memory the mob generator takes up,
+ * in bytes.
+ *
+ * @return The size.
+ */
+size_t MobGen::get_memory_usage() const {
+    return
+        sizeof(MobGen) +
+        vars.capacity() +
+        get_vector_memory_usage(link_idxs) +
+        get_vector_memory_usage(links);
+}
+
+
 /**
  * @brief Constructs a new tree shadow object.
  *
@@ -2251,3 +3532,31 @@ TreeShadow::TreeShadow(
 TreeShadow::~TreeShadow() {
     game.content.bitmaps.list.free(bmp_name);
 }
+
+
+/**
+ * @brief Returns roughly how much memory the tree shadow takes up, in bytes.
+ * Its bitmap isn't included, since it belongs to the bitmap manager.
+ *
+ * @return The size.
+ */
+size_t TreeShadow::get_memory_usage() const {
+    return sizeof(TreeShadow) + bmp_name.capacity();
+}
+
+
+/**
+ * @brief Writes a little-endian unsigned number into the data
+ * of a geometry cache file.
+ *
+ * @param data Data to write to.
+ * @param number Number to write.
+ * @param nr_bytes How many bytes the number takes up.
+ */
+void Area::write_geometry_cache_number(
+    string &data, uint64_t number, size_t nr_bytes
+) {
+    for(size_t b = 0; b < nr_bytes; b++) {
+        data.push_back((char) ((number >> (b * 8)) & 0xff));
+    }
+}
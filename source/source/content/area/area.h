@@ -37,9 +37,91 @@ enum AREA_TYPE {
 
 
 namespace AREA {
+extern const size_t BLOCKMAP_MAX_Z_BUCKETS;
+extern const size_t BLOCKMAP_Z_BUCKET_MIN_EDGES;
+extern const float BLOCKMAP_Z_BUCKET_SIZE;
 extern const float DEF_DAY_TIME_SPEED;
 extern const size_t DEF_DAY_TIME_START;
 extern const unsigned char DEF_DIFFICULTY;
+extern const string GEOMETRY_CACHE_MAGIC_NUMBER;
+extern const unsigned char GEOMETRY_CACHE_VERSION;
+extern const size_t MAX_ON_DEMAND_THUMBNAILS;
+extern const size_t MIN_BLOCKMAP_JOB_SIZE;
+extern const size_t MIN_TRIANGULATION_JOB_SIZE;
+};
+
+
+/**
+ * @brief A sector triangle that overlaps a blockmap block.
+ *
+ * The triangle's coordinates are kept here instead of its vertexes, so that
+ * checking if a point is inside it doesn't need to go through pointers.
+ */
+struct BlockmapTriangle {
+
+    //--- Members ---
+    
+    //Coordinates of the triangle's points.
+    Point points[3];
+    
+    //Sector the triangle belongs to.
+    Sector* sector = nullptr;
+    
+};
+
+
+/**
+ * @brief Info about the heights at which the edges of a blockmap block can
+ * work as walls, in the same order as the block's list of edges.
+ *
+ * An edge can only be a wall for a mob whose Z is inside the edge's range,
+ * so most edges can be thrown away with a quick check. Edges that can never
+ * be walls get an empty range, and edges on the limits of the area get
+ * the whole range, since mobs can never cross them.
+ */
+struct BlockmapEdgeWalls {
+
+    //--- Members ---
+    
+    //Lowest Z at which each edge can be a wall.
+    vector<float> min_zs;
+    
+    //Highest Z at which each edge can be a wall.
+    vector<float> max_zs;
+    
+};
+
+
+/**
+ * @brief The edges of a blockmap block, split into buckets by the heights
+ * at which they can be walls. This is only done for blocks where many edges
+ * of very different heights pile up, like under bridges or along tall
+ * cliffs, so that a query at a given Z only needs to go through the edges
+ * in the right bucket.
+ *
+ * Each bucket covers a band of Z, except the first one, which also covers
+ * everything below it, and the last one, which also covers everything
+ * above it. Edges are in every bucket their range of Z touches, and edges
+ * that can never be walls aren't in any.
+ */
+struct BlockmapZBuckets {
+
+    //--- Members ---
+    
+    //Z at which the first bucket's band starts.
+    float start_z = 0.0f;
+    
+    //For each bucket, the indexes of its edges in the block's list of edges.
+    vector<vector<size_t> > edge_idxs;
+    
+    //For each bucket, the coordinates of its edges, in the same order.
+    vector<LineSegBatch> edge_segs;
+    
+    
+    //--- Function declarations ---
+    
+    size_t get_bucket(float z) const;
+    
 };
 
 
@@ -64,8 +146,27 @@ struct Blockmap {
     //Specifies a list of edges in each block.
     vector<vector<vector<Edge*> > > edges;
     
-    //Specifies a list of sectors in each block.
-    vector<vector<unordered_set<Sector*> > >  sectors;
+    //Coordinates of the edges in each block, in the same order as the
+    //edge lists, so they can be checked many at a time.
+    vector<vector<LineSegBatch> > edge_segs;
+    
+    //Heights at which the edges in each block can be walls, in the same
+    //order as the edge lists.
+    vector<vector<BlockmapEdgeWalls> > edge_walls;
+    
+    //Edges in each block, split by height. Empty for blocks where
+    //that isn't worth it.
+    vector<vector<BlockmapZBuckets> > z_buckets;
+    
+    //Specifies a list of the indexes of all edges in each block, including
+    //the ones that have no change of height. Used for edge offset effects.
+    vector<vector<vector<size_t> > > edge_idxs;
+    
+    //Specifies a list of sectors in each block, with no repeats.
+    vector<vector<vector<Sector*> > > sectors;
+    
+    //Specifies a list of the sector triangles that overlap each block.
+    vector<vector<vector<BlockmapTriangle> > > triangles;
     
     //Number of columns.
     size_t n_cols = 0;
@@ -76,14 +177,47 @@ struct Blockmap {
     
     //--- Function declarations ---
     
+    void add_sector(size_t col, size_t row, Sector* s_ptr);
     size_t get_col(float x) const;
     size_t get_row(float y) const;
+    void get_edge_idxs_in_region(
+        const Point &tl, const Point &br, vector<size_t> &out_edge_idxs
+    ) const;
+    bool get_edges_in_region(
+        const Point &tl, const Point &br, vector<Edge*> &out_edges
+    ) const;
     bool get_edges_in_region(
-        const Point &tl, const Point &br, set<Edge*> &edges
+        const Point &tl, const Point &br, float min_z, float max_z,
+        vector<Edge*> &out_edges
+    ) const;
+    bool get_edges_near_circle(
+        const Point &center, float radius, vector<Edge*> &out_edges
+    ) const;
+    bool get_edges_near_line_seg(
+        const Point &p1, const Point &p2, vector<Edge*> &out_edges
+    ) const;
+    size_t get_memory_usage() const;
+    void get_sectors_in_region(
+        const Point &tl, const Point &br, vector<Sector*> &out_sectors
     ) const;
     Point get_top_left_corner(size_t col, size_t row) const;
+    bool get_wall_edges_near_circle(
+        const Point &center, float radius, float z, vector<Edge*> &out_edges
+    ) const;
+    void update_edge_segs();
     void clear();
     
+    
+private:
+
+    //--- Function declarations ---
+    
+    void add_near_edges(
+        size_t col, size_t row, vector<Edge*> &out_edges
+    ) const;
+    void build_z_buckets(size_t col, size_t row);
+    static void finish_edge_query(vector<Edge*> &out_edges);
+    
 };
 
 
@@ -110,6 +244,9 @@ struct MobGen {
     //Script vars.
     string vars;
     
+    //Script vars, already parsed. Cache for performance.
+    map<string, string> vars_map;
+    
     //Indexes of linked objects.
     vector<size_t> link_idxs;
     
@@ -127,6 +264,7 @@ struct MobGen {
         MobType* type = nullptr, float angle = 0, const string &vars = ""
     );
     void clone(MobGen* destination, bool include_position = true) const;
+    size_t get_memory_usage() const;
     
 };
 
@@ -169,6 +307,7 @@ struct TreeShadow {
         const string &bmp_name = "", const Point &sway = Point(1.0f)
     );
     ~TreeShadow();
+    size_t get_memory_usage() const;
     
 };
 
@@ -228,6 +367,10 @@ struct Area : public Content {
     //Thumbnail, if any.
     std::shared_ptr<ALLEGRO_BITMAP> thumbnail = nullptr;
     
+    //Path to the thumbnail's file, if it's only meant to be loaded
+    //when needed.
+    string thumbnail_path;
+    
     //Area difficulty, if applicable. Goes from 1 to 5.
     unsigned char difficulty = AREA::DEF_DIFFICULTY;
     
@@ -264,6 +407,7 @@ struct Area : public Content {
     void check_stability();
     void cleanup(bool* out_deleted_sectors = nullptr);
     void clone(Area &other);
+    void clone_properties(Area &other) const;
     void connect_edge_to_sector(Edge* e_ptr, Sector* s_ptr, size_t side);
     void connect_edge_to_vertex(Edge* e_ptr, Vertex* v_ptr, size_t endpoint);
     void connect_sector_edges(Sector* s_ptr);
@@ -281,14 +425,22 @@ struct Area : public Content {
     void fix_vertex_idxs(Vertex* v_ptr);
     void fix_vertex_pointers(Vertex* v_ptr);
     void generate_blockmap();
+    void generate_edge_idxs_blockmap();
     void generate_edges_blockmap(const vector<Edge*> &edges);
+    void generate_triangles_blockmap();
+    uint64_t get_geometry_hash() const;
+    size_t get_memory_usage() const;
     size_t get_nr_path_links();
+    bool load_geometry_cache(
+        const string &file_path, CONTENT_LOAD_LEVEL level
+    );
     void load_main_data_from_data_node(
         DataNode* node, CONTENT_LOAD_LEVEL level
     );
     void load_mission_data_from_data_node(DataNode* node);
     void load_geometry_from_data_node(
-        DataNode* node, CONTENT_LOAD_LEVEL level
+        DataNode* node, CONTENT_LOAD_LEVEL level,
+        const string &cache_file_path = ""
     );
     void load_thumbnail(const string &thumbnail_path);
     Edge* new_edge();
@@ -300,10 +452,29 @@ struct Area : public Content {
     void remove_edge(const Edge* e_ptr);
     void remove_sector(size_t s_idx);
     void remove_sector(const Sector* s_ptr);
-    void save_geometry_to_data_node(DataNode* node);
+    bool save_geometry_cache(const string &file_path) const;
+    void save_geometry(DataNodeWriter &writer);
     void save_main_data_to_data_node(DataNode* node);
     void save_mission_data_to_data_node(DataNode* node);
     void save_thumbnail(bool to_backup);
     void clear();
     
+
+private:
+
+    //--- Function declarations ---
+    
+    void fill_edge_idxs_blockmap_cols(size_t col_start, size_t col_end);
+    void fill_edges_blockmap_cols(
+        const vector<Edge*> &edge_list, size_t col_start, size_t col_end
+    );
+    void fill_triangles_blockmap_cols(size_t col_start, size_t col_end);
+    static bool read_geometry_cache_number(
+        const string &data, size_t &pos, size_t nr_bytes,
+        uint64_t* out_number
+    );
+    static void write_geometry_cache_number(
+        string &data, uint64_t number, size_t nr_bytes
+    );
+    
 };
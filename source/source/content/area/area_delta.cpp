@@ -0,0 +1,660 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Area delta class and related functions.
+ */
+
+#include <algorithm>
+
+#include "area_delta.h"
+
+#include "../../core/game.h"
+#include "../../util/allegro_utils.h"
+
+
+/**
+ * @brief Destroys the area delta object.
+ */
+AreaDelta::~AreaDelta() {
+    clear();
+}
+
+
+/**
+ * @brief Applies the delta onto an area that is in the newer state,
+ * turning it back into the older state. The area must be the one the
+ * delta was made with in sync(), and no other deltas can have been applied
+ * or made in the meantime, except ones that were already undone.
+ * Afterwards, the delta is left empty, since its contents go to the area.
+ *
+ * @param a Area to apply to.
+ */
+void AreaDelta::apply(Area* a) {
+    //Vertexes go back in place, so pointers to them stay valid.
+    size_t nr_kept_vertexes = std::min(nr_vertexes, a->vertexes.size());
+    for(size_t v = nr_vertexes; v < a->vertexes.size(); v++) {
+        delete a->vertexes[v];
+    }
+    a->vertexes.resize(nr_vertexes, nullptr);
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        size_t v_idx = vertexes[v].first;
+        Vertex* old_v_ptr = vertexes[v].second;
+        if(v_idx < nr_kept_vertexes) {
+            Vertex* v_ptr = a->vertexes[v_idx];
+            v_ptr->x = old_v_ptr->x;
+            v_ptr->y = old_v_ptr->y;
+            v_ptr->edge_idxs = old_v_ptr->edge_idxs;
+            delete old_v_ptr;
+        } else {
+            a->vertexes[v_idx] = old_v_ptr;
+        }
+    }
+    vertexes.clear();
+    
+    apply_list(a->edges, nr_edges, edges);
+    apply_list(a->sectors, nr_sectors, sectors);
+    apply_list(a->mob_generators, nr_mob_generators, mob_generators);
+    apply_list(a->path_stops, nr_path_stops, path_stops);
+    apply_list(a->tree_shadows, nr_tree_shadows, tree_shadows);
+    fix_pointers(a);
+    
+    a->problems.non_simples.clear();
+    a->problems.lone_edges.clear();
+    for(size_t s = 0; s < non_simples.size(); s++) {
+        a->problems.non_simples[a->sectors[non_simples[s].first]] =
+            non_simples[s].second;
+    }
+    for(size_t e = 0; e < lone_edges.size(); e++) {
+        a->problems.lone_edges.insert(a->edges[lone_edges[e]]);
+    }
+    non_simples.clear();
+    lone_edges.clear();
+    
+    if(properties) {
+        properties->clone_properties(*a);
+        delete properties;
+        properties = nullptr;
+    }
+}
+
+
+/**
+ * @brief Puts the older state's elements back into a list, and deletes
+ * the ones that only exist in the newer state.
+ *
+ * @tparam T Type of element.
+ * @param list List of elements in the area.
+ * @param old_size Number of elements the older state had.
+ * @param records Elements that were different in the older state,
+ * and their index. These go into the list, so this is left empty.
+ */
+template<typename T>
+void AreaDelta::apply_list(
+    vector<T*> &list, size_t old_size,
+    vector<std::pair<size_t, T*> > &records
+) {
+    for(size_t i = old_size; i < list.size(); i++) {
+        delete list[i];
+    }
+    list.resize(old_size, nullptr);
+    for(size_t r = 0; r < records.size(); r++) {
+        size_t idx = records[r].first;
+        if(list[idx]) delete list[idx];
+        list[idx] = records[r].second;
+    }
+    records.clear();
+}
+
+
+/**
+ * @brief Deletes everything stored in the delta.
+ */
+void AreaDelta::clear() {
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        delete vertexes[v].second;
+    }
+    for(size_t e = 0; e < edges.size(); e++) {
+        delete edges[e].second;
+    }
+    for(size_t s = 0; s < sectors.size(); s++) {
+        delete sectors[s].second;
+    }
+    for(size_t m = 0; m < mob_generators.size(); m++) {
+        delete mob_generators[m].second;
+    }
+    for(size_t s = 0; s < path_stops.size(); s++) {
+        delete path_stops[s].second;
+    }
+    for(size_t t = 0; t < tree_shadows.size(); t++) {
+        delete tree_shadows[t].second;
+    }
+    if(properties) {
+        delete properties;
+        properties = nullptr;
+    }
+    
+    vertexes.clear();
+    edges.clear();
+    sectors.clear();
+    mob_generators.clear();
+    path_stops.clear();
+    tree_shadows.clear();
+    non_simples.clear();
+    lone_edges.clear();
+    nr_vertexes = 0;
+    nr_edges = 0;
+    nr_sectors = 0;
+    nr_mob_generators = 0;
+    nr_path_stops = 0;
+    nr_tree_shadows = 0;
+}
+
+
+/**
+ * @brief Returns a new copy of an edge. Its pointers are left for
+ * fix_pointers() to fill in.
+ *
+ * @param e_ptr Edge to copy.
+ * @return The copy.
+ */
+Edge* AreaDelta::copy_edge(const Edge* e_ptr) {
+    Edge* new_edge = new Edge(e_ptr->vertex_idxs[0], e_ptr->vertex_idxs[1]);
+    new_edge->sector_idxs[0] = e_ptr->sector_idxs[0];
+    new_edge->sector_idxs[1] = e_ptr->sector_idxs[1];
+    e_ptr->clone(new_edge);
+    return new_edge;
+}
+
+
+/**
+ * @brief Returns a new copy of a mob generator. Its links are left for
+ * fix_pointers() to fill in.
+ *
+ * @param m_ptr Mob generator to copy.
+ * @return The copy.
+ */
+MobGen* AreaDelta::copy_mob_gen(const MobGen* m_ptr) {
+    MobGen* new_gen = new MobGen();
+    m_ptr->clone(new_gen);
+    return new_gen;
+}
+
+
+/**
+ * @brief Returns a new copy of a path stop, links included. The links'
+ * end pointers are left for fix_pointers() to fill in.
+ *
+ * @param s_ptr Path stop to copy.
+ * @return The copy.
+ */
+PathStop* AreaDelta::copy_path_stop(const PathStop* s_ptr) {
+    PathStop* new_stop = new PathStop(s_ptr->pos);
+    s_ptr->clone(new_stop);
+    new_stop->links.reserve(s_ptr->links.size());
+    for(size_t l = 0; l < s_ptr->links.size(); l++) {
+        PathLink* new_link =
+            new PathLink(new_stop, nullptr, s_ptr->links[l]->end_idx);
+        s_ptr->links[l]->clone(new_link);
+        new_link->distance = s_ptr->links[l]->distance;
+        new_stop->links.push_back(new_link);
+    }
+    return new_stop;
+}
+
+
+/**
+ * @brief Returns a new copy of a sector, triangles included. Its edge
+ * pointers are left for fix_pointers() to fill in.
+ *
+ * @param s_ptr Sector to copy.
+ * @param dest Area the copy is for. Its vertexes must match the ones of
+ * the sector's area already.
+ * @param src_vertex_idxs Index of each vertex in the sector's area.
+ * @return The copy.
+ */
+Sector* AreaDelta::copy_sector(
+    const Sector* s_ptr, const Area* dest,
+    const unordered_map<const Vertex*, size_t> &src_vertex_idxs
+) {
+    Sector* new_sector = new Sector();
+    s_ptr->clone(new_sector);
+    new_sector->texture_info.bmp_name = s_ptr->texture_info.bmp_name;
+    new_sector->texture_info.bitmap =
+        game.content.bitmaps.list.get(
+            s_ptr->texture_info.bmp_name, nullptr, false
+        );
+    new_sector->edge_idxs = s_ptr->edge_idxs;
+    new_sector->triangles.reserve(s_ptr->triangles.size());
+    for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
+        const Triangle* t_ptr = &s_ptr->triangles[t];
+        new_sector->triangles.push_back(
+            Triangle(
+                dest->vertexes[src_vertex_idxs.at(t_ptr->points[0])],
+                dest->vertexes[src_vertex_idxs.at(t_ptr->points[1])],
+                dest->vertexes[src_vertex_idxs.at(t_ptr->points[2])]
+            )
+        );
+    }
+    new_sector->bbox[0] = s_ptr->bbox[0];
+    new_sector->bbox[1] = s_ptr->bbox[1];
+    return new_sector;
+}
+
+
+/**
+ * @brief Returns a new copy of a tree shadow.
+ *
+ * @param t_ptr Tree shadow to copy.
+ * @return The copy.
+ */
+TreeShadow* AreaDelta::copy_tree_shadow(const TreeShadow* t_ptr) {
+    TreeShadow* new_shadow =
+        new TreeShadow(
+        t_ptr->center, t_ptr->size, t_ptr->angle, t_ptr->alpha,
+        t_ptr->bmp_name, t_ptr->sway
+    );
+    new_shadow->bitmap =
+        game.content.bitmaps.list.get(t_ptr->bmp_name, nullptr, false);
+    return new_shadow;
+}
+
+
+/**
+ * @brief Returns whether two edges are the same, index-wise.
+ *
+ * @param e1 First edge.
+ * @param e2 Second edge.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::edges_equal(const Edge* e1, const Edge* e2) {
+    return
+        e1->vertex_idxs[0] == e2->vertex_idxs[0] &&
+        e1->vertex_idxs[1] == e2->vertex_idxs[1] &&
+        e1->sector_idxs[0] == e2->sector_idxs[0] &&
+        e1->sector_idxs[1] == e2->sector_idxs[1] &&
+        e1->wall_shadow_length == e2->wall_shadow_length &&
+        e1->wall_shadow_color == e2->wall_shadow_color &&
+        e1->ledge_smoothing_length == e2->ledge_smoothing_length &&
+        e1->ledge_smoothing_color == e2->ledge_smoothing_color;
+}
+
+
+/**
+ * @brief Makes every pointer in an area's elements match the indexes
+ * they have.
+ *
+ * @param a Area to fix.
+ */
+void AreaDelta::fix_pointers(Area* a) {
+    for(size_t v = 0; v < a->vertexes.size(); v++) {
+        a->fix_vertex_pointers(a->vertexes[v]);
+    }
+    for(size_t e = 0; e < a->edges.size(); e++) {
+        a->fix_edge_pointers(a->edges[e]);
+    }
+    for(size_t s = 0; s < a->sectors.size(); s++) {
+        a->fix_sector_pointers(a->sectors[s]);
+    }
+    for(size_t m = 0; m < a->mob_generators.size(); m++) {
+        MobGen* m_ptr = a->mob_generators[m];
+        m_ptr->links.clear();
+        for(size_t l = 0; l < m_ptr->link_idxs.size(); l++) {
+            m_ptr->links.push_back(a->mob_generators[m_ptr->link_idxs[l]]);
+        }
+    }
+    for(size_t s = 0; s < a->path_stops.size(); s++) {
+        PathStop* s_ptr = a->path_stops[s];
+        a->fix_path_stop_pointers(s_ptr);
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            s_ptr->links[l]->start_ptr = s_ptr;
+        }
+    }
+}
+
+
+/**
+ * @brief Returns roughly how much memory the delta takes up, in bytes.
+ *
+ * @return The size.
+ */
+size_t AreaDelta::get_memory_usage() const {
+    size_t size =
+        sizeof(AreaDelta) +
+        get_vector_memory_usage(vertexes) +
+        get_vector_memory_usage(edges) +
+        get_vector_memory_usage(sectors) +
+        get_vector_memory_usage(mob_generators) +
+        get_vector_memory_usage(path_stops) +
+        get_vector_memory_usage(tree_shadows) +
+        get_vector_memory_usage(non_simples) +
+        get_vector_memory_usage(lone_edges) +
+        edges.size() * sizeof(Edge);
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        size += vertexes[v].second->get_memory_usage();
+    }
+    for(size_t s = 0; s < sectors.size(); s++) {
+        size += sectors[s].second->get_memory_usage();
+    }
+    for(size_t m = 0; m < mob_generators.size(); m++) {
+        size += mob_generators[m].second->get_memory_usage();
+    }
+    for(size_t s = 0; s < path_stops.size(); s++) {
+        size += path_stops[s].second->get_memory_usage();
+    }
+    for(size_t t = 0; t < tree_shadows.size(); t++) {
+        size += tree_shadows[t].second->get_memory_usage();
+    }
+    if(properties) size += sizeof(Area);
+    return size;
+}
+
+
+/**
+ * @brief Returns whether two mob generators are the same, index-wise.
+ *
+ * @param m1 First mob generator.
+ * @param m2 Second mob generator.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::mob_gens_equal(const MobGen* m1, const MobGen* m2) {
+    return
+        m1->type == m2->type &&
+        m1->pos == m2->pos &&
+        m1->angle == m2->angle &&
+        m1->vars == m2->vars &&
+        m1->link_idxs == m2->link_idxs &&
+        m1->stored_inside == m2->stored_inside;
+}
+
+
+/**
+ * @brief Returns whether two path stops are the same, index-wise,
+ * links included.
+ *
+ * @param s1 First path stop.
+ * @param s2 Second path stop.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::path_stops_equal(const PathStop* s1, const PathStop* s2) {
+    if(
+        !(s1->pos == s2->pos) ||
+        s1->radius != s2->radius ||
+        s1->flags != s2->flags ||
+        s1->label != s2->label ||
+        s1->links.size() != s2->links.size()
+    ) {
+        return false;
+    }
+    for(size_t l = 0; l < s1->links.size(); l++) {
+        const PathLink* l1 = s1->links[l];
+        const PathLink* l2 = s2->links[l];
+        if(
+            l1->end_idx != l2->end_idx ||
+            l1->type != l2->type ||
+            l1->distance != l2->distance
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Returns whether two sectors are the same, index-wise,
+ * triangles included.
+ *
+ * @param s1 First sector.
+ * @param s2 Second sector.
+ * @param vertex_idxs1 Index of each vertex in the first sector's area.
+ * @param vertex_idxs2 Index of each vertex in the second sector's area.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::sectors_equal(
+    const Sector* s1, const Sector* s2,
+    const unordered_map<const Vertex*, size_t> &vertex_idxs1,
+    const unordered_map<const Vertex*, size_t> &vertex_idxs2
+) {
+    if(
+        s1->type != s2->type ||
+        s1->is_bottomless_pit != s2->is_bottomless_pit ||
+        s1->z != s2->z ||
+        s1->tag != s2->tag ||
+        s1->brightness != s2->brightness ||
+        !(s1->texture_info.scale == s2->texture_info.scale) ||
+        !(s1->texture_info.translation == s2->texture_info.translation) ||
+        s1->texture_info.rot != s2->texture_info.rot ||
+        !(s1->texture_info.tint == s2->texture_info.tint) ||
+        s1->texture_info.bmp_name != s2->texture_info.bmp_name ||
+        s1->fade != s2->fade ||
+        s1->hazards_str != s2->hazards_str ||
+        s1->hazards != s2->hazards ||
+        s1->hazard_floor != s2->hazard_floor ||
+        s1->edge_idxs != s2->edge_idxs ||
+        !(s1->bbox[0] == s2->bbox[0]) ||
+        !(s1->bbox[1] == s2->bbox[1]) ||
+        s1->triangles.size() != s2->triangles.size()
+    ) {
+        return false;
+    }
+    for(size_t t = 0; t < s1->triangles.size(); t++) {
+        for(size_t p = 0; p < 3; p++) {
+            if(
+                vertex_idxs1.at(s1->triangles[t].points[p]) !=
+                vertex_idxs2.at(s2->triangles[t].points[p])
+            ) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Changes an area so it matches another one.
+ * Only the elements that are different get touched, so this is a lot
+ * cheaper than Area::clone() when the two are similar. The blockmap is
+ * left alone.
+ *
+ * @param dest Area to change.
+ * @param src Area to copy from.
+ * @param out_old If not nullptr, whatever is needed to turn dest back into
+ * its current state is returned here, to use with apply(). Otherwise,
+ * the old elements are simply deleted.
+ */
+void AreaDelta::sync(Area* dest, const Area* src, AreaDelta* out_old) {
+    if(out_old) {
+        out_old->clear();
+        out_old->nr_vertexes = dest->vertexes.size();
+        out_old->nr_edges = dest->edges.size();
+        out_old->nr_sectors = dest->sectors.size();
+        out_old->nr_mob_generators = dest->mob_generators.size();
+        out_old->nr_path_stops = dest->path_stops.size();
+        out_old->nr_tree_shadows = dest->tree_shadows.size();
+        
+        for(const auto &s : dest->problems.non_simples) {
+            out_old->non_simples.push_back(
+                std::make_pair(dest->find_sector_idx(s.first), s.second)
+            );
+        }
+        for(const Edge* e : dest->problems.lone_edges) {
+            out_old->lone_edges.push_back(dest->find_edge_idx(e));
+        }
+        
+        out_old->properties = new Area();
+        dest->clone_properties(*out_old->properties);
+    }
+    
+    //Sector triangles are compared by vertex index, so get those first.
+    unordered_map<const Vertex*, size_t> dest_vertex_idxs;
+    unordered_map<const Vertex*, size_t> src_vertex_idxs;
+    dest_vertex_idxs.reserve(dest->vertexes.size());
+    src_vertex_idxs.reserve(src->vertexes.size());
+    for(size_t v = 0; v < dest->vertexes.size(); v++) {
+        dest_vertex_idxs[dest->vertexes[v]] = v;
+    }
+    for(size_t v = 0; v < src->vertexes.size(); v++) {
+        src_vertex_idxs[src->vertexes[v]] = v;
+    }
+    
+    //Vertexes. These change in place, so the triangles of sectors that
+    //didn't change stay valid.
+    size_t nr_common_vertexes =
+        std::min(dest->vertexes.size(), src->vertexes.size());
+    for(size_t v = 0; v < nr_common_vertexes; v++) {
+        Vertex* v_ptr = dest->vertexes[v];
+        const Vertex* src_v_ptr = src->vertexes[v];
+        if(vertexes_equal(v_ptr, src_v_ptr)) continue;
+        if(out_old) {
+            Vertex* old_v_ptr = new Vertex(v_ptr->x, v_ptr->y);
+            old_v_ptr->edge_idxs = v_ptr->edge_idxs;
+            out_old->vertexes.push_back(std::make_pair(v, old_v_ptr));
+        }
+        v_ptr->x = src_v_ptr->x;
+        v_ptr->y = src_v_ptr->y;
+        v_ptr->edge_idxs = src_v_ptr->edge_idxs;
+    }
+    for(size_t v = src->vertexes.size(); v < dest->vertexes.size(); v++) {
+        if(out_old) {
+            out_old->vertexes.push_back(std::make_pair(v, dest->vertexes[v]));
+        } else {
+            delete dest->vertexes[v];
+        }
+    }
+    dest->vertexes.resize(nr_common_vertexes);
+    for(size_t v = nr_common_vertexes; v < src->vertexes.size(); v++) {
+        Vertex* new_v_ptr =
+            new Vertex(src->vertexes[v]->x, src->vertexes[v]->y);
+        new_v_ptr->edge_idxs = src->vertexes[v]->edge_idxs;
+        dest->vertexes.push_back(new_v_ptr);
+    }
+    
+    //Everything else.
+    sync_list<Edge>(
+        dest->edges, src->edges, edges_equal, copy_edge,
+        out_old ? &out_old->edges : nullptr
+    );
+    sync_list<Sector>(
+        dest->sectors, src->sectors,
+    [&dest_vertex_idxs, &src_vertex_idxs] (const Sector* s1, const Sector* s2) {
+        return sectors_equal(s1, s2, dest_vertex_idxs, src_vertex_idxs);
+    },
+    [dest, &src_vertex_idxs] (const Sector* s_ptr) {
+        return copy_sector(s_ptr, dest, src_vertex_idxs);
+    },
+    out_old ? &out_old->sectors : nullptr
+    );
+    sync_list<MobGen>(
+        dest->mob_generators, src->mob_generators,
+        mob_gens_equal, copy_mob_gen,
+        out_old ? &out_old->mob_generators : nullptr
+    );
+    sync_list<PathStop>(
+        dest->path_stops, src->path_stops,
+        path_stops_equal, copy_path_stop,
+        out_old ? &out_old->path_stops : nullptr
+    );
+    sync_list<TreeShadow>(
+        dest->tree_shadows, src->tree_shadows,
+        tree_shadows_equal, copy_tree_shadow,
+        out_old ? &out_old->tree_shadows : nullptr
+    );
+    fix_pointers(dest);
+    
+    dest->problems.non_simples.clear();
+    dest->problems.lone_edges.clear();
+    for(const auto &s : src->problems.non_simples) {
+        size_t nr = src->find_sector_idx(s.first);
+        dest->problems.non_simples[dest->sectors[nr]] = s.second;
+    }
+    for(const Edge* e : src->problems.lone_edges) {
+        size_t nr = src->find_edge_idx(e);
+        dest->problems.lone_edges.insert(dest->edges[nr]);
+    }
+    
+    src->clone_properties(*dest);
+}
+
+
+/**
+ * @brief Changes a list of elements so it matches another one,
+ * replacing the elements that are different with copies.
+ *
+ * @tparam T Type of element.
+ * @param dest List to change.
+ * @param src List to copy from.
+ * @param equal Function that returns whether two elements are the same.
+ * @param copy Function that returns a new copy of an element.
+ * @param out_records If not nullptr, the elements that were replaced or
+ * removed from dest, and their index, are added here. Otherwise,
+ * they're deleted.
+ */
+template<typename T>
+void AreaDelta::sync_list(
+    vector<T*> &dest, const vector<T*> &src,
+    const std::function<bool(const T*, const T*)> &equal,
+    const std::function<T*(const T*)> &copy,
+    vector<std::pair<size_t, T*> >* out_records
+) {
+    size_t nr_common = std::min(dest.size(), src.size());
+    for(size_t i = 0; i < nr_common; i++) {
+        if(equal(dest[i], src[i])) continue;
+        if(out_records) {
+            out_records->push_back(std::make_pair(i, dest[i]));
+        } else {
+            delete dest[i];
+        }
+        dest[i] = copy(src[i]);
+    }
+    for(size_t i = src.size(); i < dest.size(); i++) {
+        if(out_records) {
+            out_records->push_back(std::make_pair(i, dest[i]));
+        } else {
+            delete dest[i];
+        }
+    }
+    dest.resize(nr_common);
+    for(size_t i = nr_common; i < src.size(); i++) {
+        dest.push_back(copy(src[i]));
+    }
+}
+
+
+/**
+ * @brief Returns whether two tree shadows are the same.
+ *
+ * @param t1 First tree shadow.
+ * @param t2 Second tree shadow.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::tree_shadows_equal(
+    const TreeShadow* t1, const TreeShadow* t2
+) {
+    return
+        t1->bmp_name == t2->bmp_name &&
+        t1->center == t2->center &&
+        t1->size == t2->size &&
+        t1->angle == t2->angle &&
+        t1->alpha == t2->alpha &&
+        t1->sway == t2->sway;
+}
+
+
+/**
+ * @brief Returns whether two vertexes are the same, index-wise.
+ *
+ * @param v1 First vertex.
+ * @param v2 Second vertex.
+ * @return Whether they're the same.
+ */
+bool AreaDelta::vertexes_equal(const Vertex* v1, const Vertex* v2) {
+    return
+        v1->x == v2->x &&
+        v1->y == v2->y &&
+        v1->edge_idxs == v2->edge_idxs;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for the area delta class and related functions.
+ */
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "area.h"
+
+
+using std::size_t;
+using std::unordered_map;
+using std::vector;
+
+
+/**
+ * @brief The differences between two states of an area. This is what's needed
+ * to turn the newer state back into the older one, without having to keep
+ * an entire copy of the older one around. Whatever didn't change between
+ * the two states isn't stored.
+ *
+ * Elements are matched by their index, so two states that only differ in
+ * a few elements (like after most editing operations) make for a tiny delta.
+ * Vertexes are always changed in place, so pointers to them stay valid
+ * when a delta is applied; this is what keeps sector triangles pointing
+ * to the right places.
+ */
+struct AreaDelta {
+
+    //--- Members ---
+    
+    //Number of vertexes the older state had.
+    size_t nr_vertexes = 0;
+    
+    //Number of edges the older state had.
+    size_t nr_edges = 0;
+    
+    //Number of sectors the older state had.
+    size_t nr_sectors = 0;
+    
+    //Number of mob generators the older state had.
+    size_t nr_mob_generators = 0;
+    
+    //Number of path stops the older state had.
+    size_t nr_path_stops = 0;
+    
+    //Number of tree shadows the older state had.
+    size_t nr_tree_shadows = 0;
+    
+    //Vertexes that were different in the older state, and their index.
+    vector<std::pair<size_t, Vertex*> > vertexes;
+    
+    //Edges that were different in the older state, and their index.
+    vector<std::pair<size_t, Edge*> > edges;
+    
+    //Sectors that were different in the older state, and their index.
+    vector<std::pair<size_t, Sector*> > sectors;
+    
+    //Mob generators that were different in the older state, and their index.
+    vector<std::pair<size_t, MobGen*> > mob_generators;
+    
+    //Path stops that were different in the older state, and their index.
+    vector<std::pair<size_t, PathStop*> > path_stops;
+    
+    //Tree shadows that were different in the older state, and their index.
+    vector<std::pair<size_t, TreeShadow*> > tree_shadows;
+    
+    //Area holding the older state's properties, like its name and mission
+    //data. It has no geometry or objects.
+    Area* properties = nullptr;
+    
+    //Index of the older state's non-simple sectors, and why they're broken.
+    vector<std::pair<size_t, TRIANGULATION_ERROR> > non_simples;
+    
+    //Index of the older state's lone edges.
+    vector<size_t> lone_edges;
+    
+    
+    //--- Function declarations ---
+    
+    ~AreaDelta();
+    void apply(Area* a);
+    void clear();
+    size_t get_memory_usage() const;
+    static void sync(Area* dest, const Area* src, AreaDelta* out_old);
+    
+    private:
+    
+    //--- Function declarations ---
+    
+    template<typename T>
+    static void apply_list(
+        vector<T*> &list, size_t old_size,
+        vector<std::pair<size_t, T*> > &records
+    );
+    static Edge* copy_edge(const Edge* e_ptr);
+    static MobGen* copy_mob_gen(const MobGen* m_ptr);
+    static PathStop* copy_path_stop(const PathStop* s_ptr);
+    static Sector* copy_sector(
+        const Sector* s_ptr, const Area* dest,
+        const unordered_map<const Vertex*, size_t> &src_vertex_idxs
+    );
+    static TreeShadow* copy_tree_shadow(const TreeShadow* t_ptr);
+    static bool edges_equal(const Edge* e1, const Edge* e2);
+    static void fix_pointers(Area* a);
+    static bool mob_gens_equal(const MobGen* m1, const MobGen* m2);
+    static bool path_stops_equal(const PathStop* s1, const PathStop* s2);
+    static bool sectors_equal(
+        const Sector* s1, const Sector* s2,
+        const unordered_map<const Vertex*, size_t> &vertex_idxs1,
+        const unordered_map<const Vertex*, size_t> &vertex_idxs2
+    );
+    template<typename T>
+    static void sync_list(
+        vector<T*> &dest, const vector<T*> &src,
+        const std::function<bool(const T*, const T*)> &equal,
+        const std::function<T*(const T*)> &copy,
+        vector<std::pair<size_t, T*> >* out_records
+    );
+    static bool tree_shadows_equal(
+        const TreeShadow* t1, const TreeShadow* t2
+    );
+    static bool vertexes_equal(const Vertex* v1, const Vertex* v2);
+    
+};
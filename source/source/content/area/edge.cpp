@@ -10,6 +10,9 @@
 
 #define _USE_MATH_DEFINES
 
+#include <algorithm>
+#include <cfloat>
+
 #include "edge.h"
 
 #include "../../core/misc_functions.h"
@@ -81,6 +84,51 @@ size_t Edge::get_side_with_sector(const Sector* s_ptr) const {
 }
 
 
+/**
+ * @brief Returns the range of Z at which the edge can work as a wall for
+ * a mob trying to cross it. If the edge can never be a wall, the range is
+ * empty (the minimum is above the maximum). If the edge is on the limits of
+ * the area, the range covers everything.
+ *
+ * @param out_min_z The lowest Z is returned here.
+ * @param out_max_z The highest Z is returned here.
+ */
+void Edge::get_wall_z_range(float* out_min_z, float* out_max_z) const {
+    if(!sectors[0] || !sectors[1]) {
+        //On the edge of out-of-bounds geometry. Always blocks.
+        *out_min_z = -FLT_MAX;
+        *out_max_z = FLT_MAX;
+        return;
+    }
+    
+    bool blocking[2] = {
+        sectors[0]->type == SECTOR_TYPE_BLOCKING,
+        sectors[1]->type == SECTOR_TYPE_BLOCKING
+    };
+    if(
+        (blocking[0] && blocking[1]) ||
+        (!blocking[0] && !blocking[1] && sectors[0]->z == sectors[1]->z)
+    ) {
+        //Blocking on both sides, or no difference in floor height.
+        //Never a wall.
+        *out_min_z = FLT_MAX;
+        *out_max_z = -FLT_MAX;
+        return;
+    }
+    
+    //If both floors are above the mob, the mob is under the ground, and
+    //this edge is likely behind a more logical wall.
+    *out_min_z = std::min(sectors[0]->z, sectors[1]->z);
+    if(blocking[0] || blocking[1]) {
+        //A blocking sector is a wall no matter how high the mob is.
+        *out_max_z = FLT_MAX;
+    } else {
+        //If both floors are below the mob, there's no collision.
+        *out_max_z = std::max(sectors[0]->z, sectors[1]->z);
+    }
+}
+
+
 /**
  * @brief If the specified edge and this one are not neighbors, returns nullptr.
  * Otherwise, returns the vertex that binds them.
@@ -62,6 +62,7 @@ struct Edge {
     Sector* get_other_sector(const Sector* v_ptr) const;
     Vertex* get_other_vertex(const Vertex* v_ptr) const;
     size_t get_side_with_sector(const Sector* s_ptr) const;
+    void get_wall_z_range(float* out_min_z, float* out_max_z) const;
     Vertex* has_neighbor(const Edge* other) const;
     bool is_valid() const;
     size_t remove_from_sectors();
@@ -493,6 +493,36 @@ Triangle::Triangle(Vertex* v1, Vertex* v2, Vertex* v3) {
 }
 
 
+/**
+ * @brief Constructs a new vertex grid object.
+ *
+ * @param all_vertexes Vertexes to place in the grid.
+ * @param size Width and height of each cell.
+ */
+VertexGrid::VertexGrid(const vector<Vertex*> &all_vertexes, float size) :
+    vertexes(all_vertexes),
+    cell_size(size) {
+    
+    if(vertexes.empty()) return;
+    
+    Point min_coords = v2p(vertexes[0]);
+    Point max_coords = min_coords;
+    for(size_t v = 1; v < vertexes.size(); v++) {
+        update_min_max_coords(min_coords, max_coords, v2p(vertexes[v]));
+    }
+    top_left_corner = min_coords;
+    n_cols = floor((max_coords.x - min_coords.x) / cell_size) + 1;
+    n_rows = floor((max_coords.y - min_coords.y) / cell_size) + 1;
+    cells.assign(n_cols * n_rows, vector<size_t>());
+    
+    for(size_t v = 0; v < vertexes.size(); v++) {
+        size_t col = floor((vertexes[v]->x - top_left_corner.x) / cell_size);
+        size_t row = floor((vertexes[v]->y - top_left_corner.y) / cell_size);
+        cells[row * n_cols + col].push_back(v);
+    }
+}
+
+
 /**
  * @brief Returns the next edge the trace algorithm should go to.
  *
@@ -581,39 +611,6 @@ void find_trace_edge(
 }
 
 
-/**
- * @brief Get the convex, concave and ear vertexes.
- *
- * @param vertexes_left List of vertexes left to be processed.
- * @param ears List of ears found.
- * @param convex_vertexes List of convex vertexes found.
- * @param concave_vertexes List of concave vertexes found.
- */
-void get_cce(
-    const vector<Vertex*> &vertexes_left, vector<size_t> &ears,
-    vector<size_t> &convex_vertexes, vector<size_t> &concave_vertexes
-) {
-    ears.clear();
-    convex_vertexes.clear();
-    concave_vertexes.clear();
-    for(size_t v = 0; v < vertexes_left.size(); v++) {
-        bool is_convex = is_vertex_convex(vertexes_left, v);
-        if(is_convex) {
-            convex_vertexes.push_back(v);
-            
-        } else {
-            concave_vertexes.push_back(v);
-        }
-    }
-    
-    for(size_t c = 0; c < convex_vertexes.size(); c++) {
-        if(is_vertex_ear(vertexes_left, concave_vertexes, convex_vertexes[c])) {
-            ears.push_back(convex_vertexes[c]);
-        }
-    }
-}
-
-
 /**
  * @brief Returns all vertexes that are close enough to be merged with
  * the specified point, as well as their distances to said point.
@@ -622,7 +619,8 @@ void get_cce(
  * @param all_vertexes Vector with all of the vertexes in the area.
  * @param merge_radius Minimum radius to merge.
  * This does not take the camera zoom level into account.
- * @return The merge vertexes.
+ * @return The merge vertexes, from closest to farthest. Vertexes at the
+ * same distance are in the same order as in the list.
  */
 vector<std::pair<Distance, Vertex*> > get_merge_vertexes(
     const Point &pos, const vector<Vertex*> &all_vertexes,
@@ -639,10 +637,78 @@ vector<std::pair<Distance, Vertex*> > get_merge_vertexes(
         }
     }
     
+    std::stable_sort(
+        result.begin(), result.end(),
+    [] (
+        const std::pair<Distance, Vertex*> &v1,
+        const std::pair<Distance, Vertex*> &v2
+    ) -> bool {
+        return v1.first < v2.first;
+    }
+    );
     return result;
 }
 
 
+/**
+ * @brief Returns all vertexes that are close enough to be merged with
+ * the specified point, as well as their distances to said point.
+ * This only checks the vertexes in the grid cells near the point, but
+ * the result is the same as checking the grid's whole list of vertexes.
+ *
+ * @param pos Coordinates of the point.
+ * @param grid Grid with the vertexes to check.
+ * @param merge_radius Minimum radius to merge.
+ * This does not take the camera zoom level into account.
+ * @return The merge vertexes, from closest to farthest. Vertexes at the
+ * same distance are in the same order as in the grid's list.
+ */
+vector<std::pair<Distance, Vertex*> > get_merge_vertexes(
+    const Point &pos, const VertexGrid &grid, float merge_radius
+) {
+    vector<std::pair<Distance, Vertex*> > result;
+    if(grid.cells.empty()) return result;
+    
+    float col1 =
+        floor((pos.x - merge_radius - grid.top_left_corner.x) / grid.cell_size);
+    float col2 =
+        floor((pos.x + merge_radius - grid.top_left_corner.x) / grid.cell_size);
+    float row1 =
+        floor((pos.y - merge_radius - grid.top_left_corner.y) / grid.cell_size);
+    float row2 =
+        floor((pos.y + merge_radius - grid.top_left_corner.y) / grid.cell_size);
+    if(
+        col2 < 0 || row2 < 0 ||
+        col1 >= (float) grid.n_cols || row1 >= (float) grid.n_rows
+    ) {
+        return result;
+    }
+    col1 = std::max(col1, 0.0f);
+    col2 = std::min(col2, (float) (grid.n_cols - 1));
+    row1 = std::max(row1, 0.0f);
+    row2 = std::min(row2, (float) (grid.n_rows - 1));
+    
+    //Each vertex is only in one cell, so there are no repeats.
+    vector<size_t> candidates;
+    for(size_t r = (size_t) row1; r <= (size_t) row2; r++) {
+        for(size_t c = (size_t) col1; c <= (size_t) col2; c++) {
+            const vector<size_t> &cell = grid.cells[r * grid.n_cols + c];
+            candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
+    }
+    
+    //Keep the list's order, so that ties are broken like in a full check.
+    std::sort(candidates.begin(), candidates.end());
+    vector<Vertex*> candidate_vertexes;
+    candidate_vertexes.reserve(candidates.size());
+    for(size_t c = 0; c < candidates.size(); c++) {
+        candidate_vertexes.push_back(grid.vertexes[candidates[c]]);
+    }
+    
+    return get_merge_vertexes(pos, candidate_vertexes, merge_radius);
+}
+
+
 /**
  * @brief Returns the polygons of a sector.
  *
@@ -863,38 +929,6 @@ bool is_vertex_convex(const vector<Vertex*> &vec, size_t idx) {
 }
 
 
-/**
- * @brief Returns whether this vertex is an ear or not.
- *
- * @param vec List of all vertexes.
- * @param concaves List of concave vertexes.
- * @param idx Index of the vertex to check.
- * @return Whether it is an ear.
- */
-bool is_vertex_ear(
-    const vector<Vertex*> &vec, const vector<size_t> &concaves, size_t idx
-) {
-    //A vertex is an ear if the triangle of it, the previous, and next vertexes
-    //does not contain any other vertex inside. Also, if it has vertexes inside,
-    //they mandatorily are concave, so only check those.
-    const Vertex* v = vec[idx];
-    const Vertex* pv = get_prev_in_vector(vec, idx);
-    const Vertex* nv = get_next_in_vector(vec, idx);
-    
-    for(size_t c = 0; c < concaves.size(); c++) {
-        const Vertex* v_to_check = vec[concaves[c]];
-        if(v_to_check == v || v_to_check == pv || v_to_check == nv) continue;
-        if(
-            is_point_in_triangle(
-                v2p(v_to_check), v2p(pv), v2p(v), v2p(nv), true
-            )
-        ) return false;
-    }
-    
-    return true;
-}
-
-
 /**
  * @brief Traces edges until it returns to the start, at which point it
  * closes a polygon.
@@ -1064,6 +1098,14 @@ TRIANGULATION_ERROR trace_edges(
  *
  * http://www.geometrictools.com/Documentation/TriangulationByEarClipping.pdf
  *
+ * The vertexes left are kept in a linked list, and after each clip, only
+ * the vertexes whose ear status could have changed are checked again:
+ * the clipped ear's neighbors, and whatever vertexes were being kept from
+ * being an ear by a concave vertex that just turned convex. Concave vertexes
+ * are kept in a grid, so checking if a vertex is an ear only needs to look
+ * at the concave vertexes near it. The ears are clipped in the same order
+ * as if everything were checked again after each clip.
+ *
  * @param poly The polygon to triangulate.
  * @param triangles The final list of triangles is returned here.
  * @return An error code.
@@ -1073,50 +1115,202 @@ TRIANGULATION_ERROR triangulate_polygon(
 ) {
 
     TRIANGULATION_ERROR result = TRIANGULATION_ERROR_NONE;
-    vector<Vertex*> vertexes_left = poly->vertexes;
-    vector<size_t> ears;
-    vector<size_t> convex_vertexes;
-    vector<size_t> concave_vertexes;
+    const vector<Vertex*> &vertexes = poly->vertexes;
+    size_t n_vertexes = vertexes.size();
+    if(n_vertexes < 3) return result;
     
-    if(vertexes_left.size() > 3 && triangles->empty()) {
-        triangles->reserve(vertexes_left.size() - 2);
+    if(n_vertexes > 3 && triangles->empty()) {
+        triangles->reserve(n_vertexes - 2);
     }
     
-    //Begin by making a list of all concave, convex, and ear vertexes.
-    get_cce(vertexes_left, ears, convex_vertexes, concave_vertexes);
+    //Vertexes left, as a circular linked list of indexes.
+    vector<size_t> prev_idxs(n_vertexes);
+    vector<size_t> next_idxs(n_vertexes);
+    for(size_t v = 0; v < n_vertexes; v++) {
+        prev_idxs[v] = (v == 0 ? n_vertexes - 1 : v - 1);
+        next_idxs[v] = (v == n_vertexes - 1 ? 0 : v + 1);
+    }
+    size_t n_vertexes_left = n_vertexes;
+    
+    const auto is_convex = [&] (size_t v) {
+        Point p = v2p(vertexes[v]);
+        float angle_prev = get_angle(p, v2p(vertexes[prev_idxs[v]]));
+        float angle_next = get_angle(p, v2p(vertexes[next_idxs[v]]));
+        return get_angle_cw_diff(angle_prev, angle_next) < TAU / 2;
+    };
+    
+    //Begin by finding out which vertexes are convex and which are concave.
+    vector<bool> concaves(n_vertexes, false);
+    size_t n_concaves = 0;
+    Point min_coords = v2p(vertexes[0]);
+    Point max_coords = min_coords;
+    for(size_t v = 0; v < n_vertexes; v++) {
+        concaves[v] = !is_convex(v);
+        if(concaves[v]) n_concaves++;
+        update_min_max_coords(min_coords, max_coords, v2p(vertexes[v]));
+    }
+    
+    //Place the concave vertexes in a grid. A vertex that stops being concave
+    //stays in its cell, and just gets skipped.
+    size_t grid_size = std::max((size_t) sqrt((double) n_concaves), (size_t) 1);
+    Point grid_cell_size = (max_coords - min_coords) / (float) grid_size;
+    vector<vector<size_t> > grid(grid_size * grid_size);
+    const auto get_grid_coord = [&] (float c, float min_c, float cell_size) {
+        if(cell_size <= 0.0f) return (size_t) 0;
+        float coord = floor((c - min_c) / cell_size);
+        if(coord <= 0.0f) return (size_t) 0;
+        return std::min((size_t) coord, grid_size - 1);
+    };
+    const auto add_to_grid = [&] (size_t v) {
+        Point p = v2p(vertexes[v]);
+        size_t col = get_grid_coord(p.x, min_coords.x, grid_cell_size.x);
+        size_t row = get_grid_coord(p.y, min_coords.y, grid_cell_size.y);
+        grid[row * grid_size + col].push_back(v);
+    };
+    for(size_t v = 0; v < n_vertexes; v++) {
+        if(concaves[v]) add_to_grid(v);
+    }
+    
+    //A vertex is an ear if the triangle of it, the previous, and next vertexes
+    //does not contain any other vertex inside. Also, if it has vertexes inside,
+    //they mandatorily are concave, so only check those.
+    const auto get_ear_blocker = [&] (size_t v) {
+        const Vertex* v_ptr = vertexes[v];
+        const Vertex* pv_ptr = vertexes[prev_idxs[v]];
+        const Vertex* nv_ptr = vertexes[next_idxs[v]];
+        Point p = v2p(v_ptr);
+        Point pp = v2p(pv_ptr);
+        Point np = v2p(nv_ptr);
+        const auto blocks = [&] (size_t c) {
+            if(!concaves[c]) return false;
+            const Vertex* c_ptr = vertexes[c];
+            if(c_ptr == v_ptr || c_ptr == pv_ptr || c_ptr == nv_ptr) {
+                return false;
+            }
+            return is_point_in_triangle(v2p(c_ptr), pp, p, np, true);
+        };
+        
+        if(get_point_sign(np, pp, p) == 0.0f) {
+            //A flat triangle counts as containing every point on its line,
+            //even outside of its bounding box, so check everything.
+            for(size_t c = 0; c < n_vertexes; c++) {
+                if(blocks(c)) return c;
+            }
+            return (size_t) INVALID;
+        }
+        
+        Point tri_min = p;
+        Point tri_max = p;
+        update_min_max_coords(tri_min, tri_max, pp);
+        update_min_max_coords(tri_min, tri_max, np);
+        size_t col1 = get_grid_coord(tri_min.x, min_coords.x, grid_cell_size.x);
+        size_t col2 = get_grid_coord(tri_max.x, min_coords.x, grid_cell_size.x);
+        size_t row1 = get_grid_coord(tri_min.y, min_coords.y, grid_cell_size.y);
+        size_t row2 = get_grid_coord(tri_max.y, min_coords.y, grid_cell_size.y);
+        for(size_t row = row1; row <= row2; row++) {
+            for(size_t col = col1; col <= col2; col++) {
+                const vector<size_t> &cell = grid[row * grid_size + col];
+                for(size_t c = 0; c < cell.size(); c++) {
+                    if(blocks(cell[c])) return cell[c];
+                }
+            }
+        }
+        return (size_t) INVALID;
+    };
+    
+    //Ears, sorted by their index. Vertexes that are convex but aren't ears
+    //are listed under the concave vertex that's stopping them.
+    set<size_t> ears;
+    vector<vector<size_t> > blocked_vertexes(n_vertexes);
+    vector<bool> removed(n_vertexes, false);
+    const auto update_ear = [&] (size_t v) {
+        if(removed[v] || concaves[v]) {
+            ears.erase(v);
+            return;
+        }
+        size_t blocker = get_ear_blocker(v);
+        if(blocker == INVALID) {
+            ears.insert(v);
+        } else {
+            ears.erase(v);
+            blocked_vertexes[blocker].push_back(v);
+        }
+    };
+    for(size_t v = 0; v < n_vertexes; v++) {
+        update_ear(v);
+    }
     
     //We do the triangulation until we're left
     //with three vertexes -- the final triangle.
-    while(vertexes_left.size() > 3) {
+    while(n_vertexes_left > 3) {
     
         if(ears.empty()) {
             //Something went wrong, the polygon mightn't be simple.
             result = TRIANGULATION_ERROR_NO_EARS;
             break;
             
-        } else {
-            //The ear, the previous, and the next vertexes make a triangle.
-            triangles->push_back(
-                Triangle(
-                    vertexes_left[ears[0]],
-                    get_prev_in_vector(vertexes_left, ears[0]),
-                    get_next_in_vector(vertexes_left, ears[0])
-                )
+        }
+        
+        //The ear, the previous, and the next vertexes make a triangle.
+        size_t ear = *ears.begin();
+        size_t neighbors[2] = { prev_idxs[ear], next_idxs[ear] };
+        triangles->push_back(
+            Triangle(
+                vertexes[ear], vertexes[neighbors[0]], vertexes[neighbors[1]]
+            )
+        );
+        
+        //Remove the ear.
+        ears.erase(ear);
+        removed[ear] = true;
+        next_idxs[neighbors[0]] = neighbors[1];
+        prev_idxs[neighbors[1]] = neighbors[0];
+        n_vertexes_left--;
+        
+        //The neighbors have a different shape now, so they may have
+        //stopped or started being concave.
+        vector<size_t> vertexes_to_update;
+        bool new_concaves = false;
+        for(unsigned char n = 0; n < 2; n++) {
+            bool was_concave = concaves[neighbors[n]];
+            concaves[neighbors[n]] = !is_convex(neighbors[n]);
+            if(was_concave && !concaves[neighbors[n]]) {
+                vertexes_to_update.insert(
+                    vertexes_to_update.end(),
+                    blocked_vertexes[neighbors[n]].begin(),
+                    blocked_vertexes[neighbors[n]].end()
+                );
+                blocked_vertexes[neighbors[n]].clear();
+            } else if(!was_concave && concaves[neighbors[n]]) {
+                add_to_grid(neighbors[n]);
+                new_concaves = true;
+            }
+        }
+        if(new_concaves) {
+            //This can only happen if the polygon isn't simple, but a new
+            //concave vertex could be inside any ear.
+            vertexes_to_update.insert(
+                vertexes_to_update.end(), ears.begin(), ears.end()
             );
-            
-            //Remove the ear.
-            vertexes_left.erase(vertexes_left.begin() + ears[0]);
-            
-            //Recalculate the ears, concave, and convex vertexes.
-            get_cce(vertexes_left, ears, convex_vertexes, concave_vertexes);
+        }
+        vertexes_to_update.push_back(neighbors[0]);
+        vertexes_to_update.push_back(neighbors[1]);
+        for(size_t v = 0; v < vertexes_to_update.size(); v++) {
+            update_ear(vertexes_to_update[v]);
         }
     }
     
     //Finally, add the final triangle.
-    if(vertexes_left.size() == 3) {
+    if(n_vertexes_left == 3) {
+        size_t first = 0;
+        while(removed[first]) first++;
+        size_t last[3] = {
+            first, next_idxs[first], next_idxs[next_idxs[first]]
+        };
+        std::sort(last, last + 3);
         triangles->push_back(
             Triangle(
-                vertexes_left[1], vertexes_left[0], vertexes_left[2]
+                vertexes[last[1]], vertexes[last[0]], vertexes[last[2]]
             )
         );
     }
@@ -1142,6 +1336,12 @@ TRIANGULATION_ERROR triangulate_sector(
     //Root of the polygon tree.
     Polygon root;
     
+    //Whatever the outcome, the vertexes the textures were drawn with
+    //are no longer reliable. Whoever asked for the triangulation can
+    //record what geometry it was made with, if they care.
+    s_ptr->invalidate_texture_draw_caches();
+    s_ptr->triangles_geometry_hash = 0;
+    
     //Let's clear any "lone" edges here.
     if(clear_lone_edges) {
         for(size_t e = 0; e < s_ptr->edges.size(); e++) {
@@ -142,20 +142,55 @@ struct GeometryProblems {
 };
 
 
+/**
+ * @brief A grid that knows which vertexes are in each of its cells, so that
+ * finding the vertexes near a point doesn't need to check all of them.
+ * It uses the vertexes' coordinates at the time it was made, so it needs
+ * to be made again if they move.
+ */
+struct VertexGrid {
+
+    //--- Members ---
+    
+    //Vertexes the grid was made with, in their original order.
+    vector<Vertex*> vertexes;
+    
+    //Width and height of each cell.
+    float cell_size = 0.0f;
+    
+    //Top-left corner of the grid.
+    Point top_left_corner;
+    
+    //Number of columns.
+    size_t n_cols = 0;
+    
+    //Number of rows.
+    size_t n_rows = 0;
+    
+    //Indexes of the vertexes in each cell.
+    vector<vector<size_t> > cells;
+    
+    
+    //--- Function declarations ---
+    
+    VertexGrid(const vector<Vertex*> &all_vertexes, float size);
+    
+};
+
+
 void find_trace_edge(
     Vertex* v_ptr, const Vertex* prev_v_ptr, const Sector* s_ptr,
     float prev_e_angle, bool best_is_closest_cw,
     Edge** next_e_ptr, float* next_e_angle, Vertex** next_v_ptr,
     unordered_set<Edge*>* excluded_edges
 );
-void get_cce(
-    const vector<Vertex> &vertexes_left, vector<size_t> &ears,
-    vector<size_t> &convex_vertexes, vector<size_t> &concave_vertexes
-);
 vector<std::pair<Distance, Vertex*> > get_merge_vertexes(
     const Point &p, const vector<Vertex*> &all_vertexes,
     float merge_radius
 );
+vector<std::pair<Distance, Vertex*> > get_merge_vertexes(
+    const Point &p, const VertexGrid &grid, float merge_radius
+);
 TRIANGULATION_ERROR get_polys(
     Sector* s_ptr, vector<Polygon>* outers, vector<vector<Polygon>>* inners
 );
@@ -167,9 +202,6 @@ Vertex* get_rightmost_vertex(const unordered_set<Edge*> &edges);
 Vertex* get_rightmost_vertex(Vertex* v1, Vertex* v2);
 bool is_polygon_clockwise(vector<Vertex*> &vertexes);
 bool is_vertex_convex(const vector<Vertex*> &vec, size_t idx);
-bool is_vertex_ear(
-    const vector<Vertex*> &vec, const vector<size_t> &concaves, size_t idx
-);
 TRIANGULATION_ERROR trace_edges(
     Vertex* start_v_ptr, const Sector* s_ptr, bool going_cw,
     vector<Vertex*>* vertexes,
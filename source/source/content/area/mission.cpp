@@ -53,6 +53,16 @@ int MissionFailKillEnemies::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailKillEnemies::get_dependencies() const {
+    return MISSION_COUNTER_ENEMY_DEATHS;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -198,6 +208,16 @@ int MissionFailLoseLeaders::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailLoseLeaders::get_dependencies() const {
+    return MISSION_COUNTER_LEADERS;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -341,6 +361,16 @@ int MissionFailLosePikmin::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailLosePikmin::get_dependencies() const {
+    return MISSION_COUNTER_PIKMIN_DEATHS;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -482,6 +512,16 @@ int MissionFailPauseMenu::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailPauseMenu::get_dependencies() const {
+    return 0;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -612,6 +652,16 @@ int MissionFailTakeDamage::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailTakeDamage::get_dependencies() const {
+    return MISSION_COUNTER_LEADERS;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -759,6 +809,16 @@ int MissionFailTimeLimit::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailTimeLimit::get_dependencies() const {
+    return MISSION_COUNTER_TIME;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -903,6 +963,16 @@ int MissionFailTooFewPikmin::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailTooFewPikmin::get_dependencies() const {
+    return MISSION_COUNTER_TOTAL_PIKMIN;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -1046,6 +1116,16 @@ int MissionFailTooManyPikmin::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the condition depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionFailTooManyPikmin::get_dependencies() const {
+    return MISSION_COUNTER_TOTAL_PIKMIN;
+}
+
+
 /**
  * @brief Explains why the player lost, with values fed from the mission data.
  *
@@ -1191,6 +1271,16 @@ int MissionGoalBattleEnemies::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalBattleEnemies::get_dependencies() const {
+    return MISSION_COUNTER_REMAINING_MOBS;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -1349,6 +1439,16 @@ int MissionGoalCollectTreasures::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalCollectTreasures::get_dependencies() const {
+    return MISSION_COUNTER_TREASURES;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -1526,6 +1626,16 @@ int MissionGoalEndManually::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalEndManually::get_dependencies() const {
+    return 0;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -1658,6 +1768,16 @@ int MissionGoalGetToExit::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalGetToExit::get_dependencies() const {
+    return MISSION_COUNTER_LEADERS_IN_EXIT;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -1689,14 +1809,7 @@ bool MissionGoalGetToExit::get_end_zoom_data(
     }
     Point avg_pos;
     for(size_t leader_id : gameplay->mission_remaining_mob_ids) {
-        Mob* leader_ptr = nullptr;
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            Mob* m_ptr = game.states.gameplay->mobs.all[m];
-            if(m_ptr->id == leader_id) {
-                leader_ptr = m_ptr;
-                break;
-            }
-        }
+        Mob* leader_ptr = gameplay->mobs.find_by_id(leader_id);
         if(leader_ptr) avg_pos += leader_ptr->pos;
     }
     avg_pos.x /= gameplay->mission_remaining_mob_ids.size();
@@ -1819,6 +1932,16 @@ int MissionGoalGrowPikmin::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalGrowPikmin::get_dependencies() const {
+    return MISSION_COUNTER_TOTAL_PIKMIN;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -1960,6 +2083,16 @@ int MissionGoalTimedSurvival::get_cur_amount(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the goal depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionGoalTimedSurvival::get_dependencies() const {
+    return MISSION_COUNTER_TIME;
+}
+
+
 /**
  * @brief Returns a celebration describing the player's victory,
  * with values fed from the mission data.
@@ -2110,6 +2243,16 @@ bool MissionRecord::is_platinum(const MissionData &mission) {
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionEnemyPoints::get_dependencies() const {
+    return MISSION_COUNTER_ENEMY_POINTS;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
@@ -2150,6 +2293,16 @@ int MissionScoreCriterionEnemyPoints::get_score(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionPikminBorn::get_dependencies() const {
+    return MISSION_COUNTER_PIKMIN_BORN;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
@@ -2190,6 +2343,16 @@ int MissionScoreCriterionPikminBorn::get_score(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionPikminDeath::get_dependencies() const {
+    return MISSION_COUNTER_PIKMIN_DEATHS;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
@@ -2230,6 +2393,16 @@ int MissionScoreCriterionPikminDeath::get_score(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionSecLeft::get_dependencies() const {
+    return MISSION_COUNTER_TIME;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
@@ -2278,6 +2451,16 @@ int MissionScoreCriterionSecLeft::get_score(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionSecPassed::get_dependencies() const {
+    return MISSION_COUNTER_TIME;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
@@ -2317,6 +2500,16 @@ int MissionScoreCriterionSecPassed::get_score(
 }
 
 
+/**
+ * @brief Returns which gameplay counters the criterion depends on.
+ *
+ * @return The counters. Use MISSION_COUNTER.
+ */
+bitmask_16_t MissionScoreCriterionTreasurePoints::get_dependencies() const {
+    return MISSION_COUNTER_TREASURE_POINTS;
+}
+
+
 /**
  * @brief Returns the mission score criterion's point multiplier.
  *
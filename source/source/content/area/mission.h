@@ -149,6 +149,47 @@ enum MISSION_SCORE_CRITERIA {
 };
 
 
+//Flags for the gameplay counters that mission goals, fail conditions,
+//and score criteria depend on. When none of the counters something
+//depends on change, it doesn't need to be checked again.
+enum MISSION_COUNTER {
+
+    //Number of Pikmin born.
+    MISSION_COUNTER_PIKMIN_BORN = 1 << 0,
+    
+    //Number of Pikmin deaths.
+    MISSION_COUNTER_PIKMIN_DEATHS = 1 << 1,
+    
+    //Total number of Pikmin, be it on the field or inside Onions and ships.
+    MISSION_COUNTER_TOTAL_PIKMIN = 1 << 2,
+    
+    //Number of enemy deaths.
+    MISSION_COUNTER_ENEMY_DEATHS = 1 << 3,
+    
+    //Enemy points collected.
+    MISSION_COUNTER_ENEMY_POINTS = 1 << 4,
+    
+    //Treasures collected for the mission goal.
+    MISSION_COUNTER_TREASURES = 1 << 5,
+    
+    //Treasure points collected.
+    MISSION_COUNTER_TREASURE_POINTS = 1 << 6,
+    
+    //Mobs the mission still requires.
+    MISSION_COUNTER_REMAINING_MOBS = 1 << 7,
+    
+    //Leaders lost, or the health of any leader.
+    MISSION_COUNTER_LEADERS = 1 << 8,
+    
+    //Leaders in the mission exit.
+    MISSION_COUNTER_LEADERS_IN_EXIT = 1 << 9,
+    
+    //Whole seconds of gameplay time passed.
+    MISSION_COUNTER_TIME = 1 << 10,
+    
+};
+
+
 /**
  * @brief Info about a given area's mission.
  */
@@ -295,6 +336,7 @@ public:
     virtual ~MissionFail() = default;
     virtual string get_name() const = 0;
     virtual int get_cur_amount(GameplayState* gameplay) const = 0;
+    virtual bitmask_16_t get_dependencies() const = 0;
     virtual int get_req_amount(GameplayState* gameplay) const = 0;
     virtual string get_player_description(MissionData* mission) const = 0;
     virtual string get_status(
@@ -322,6 +364,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -349,6 +392,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -376,6 +420,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -403,6 +448,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -430,6 +476,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -457,6 +504,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -484,6 +532,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -511,6 +560,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -539,6 +589,7 @@ public:
     virtual ~MissionGoal() = default;
     virtual string get_name() const = 0;
     virtual int get_cur_amount(GameplayState* gameplay) const = 0;
+    virtual bitmask_16_t get_dependencies() const = 0;
     virtual int get_req_amount(GameplayState* gameplay) const = 0;
     virtual string get_player_description(MissionData* mission) const = 0;
     virtual string get_status(
@@ -566,6 +617,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -593,6 +645,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -620,6 +673,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -647,6 +701,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -674,6 +729,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -701,6 +757,7 @@ public:
     
     string get_name() const override;
     int get_cur_amount(GameplayState* gameplay) const override;
+    bitmask_16_t get_dependencies() const override;
     int get_req_amount(GameplayState* gameplay) const override;
     string get_player_description(MissionData* mission) const override;
     string get_status(
@@ -727,6 +784,7 @@ public:
     //--- Function declarations ---
     
     virtual ~MissionScoreCriterion() = default;
+    virtual bitmask_16_t get_dependencies() const = 0;
     virtual string get_name() const = 0;
     virtual int get_multiplier(MissionData* mission) const = 0;
     virtual int get_score(
@@ -745,6 +803,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
@@ -763,6 +822,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
@@ -781,6 +841,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
@@ -799,6 +860,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
@@ -817,6 +879,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
@@ -835,6 +898,7 @@ public:
 
     //--- Function declarations ---
     
+    bitmask_16_t get_dependencies() const override;
     string get_name() const override;
     int get_multiplier(MissionData* mission) const override;
     int get_score(
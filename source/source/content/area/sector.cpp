@@ -24,7 +24,10 @@
  */
 Sector::~Sector() {
     for(size_t t = 0; t < 2; t++) {
-        if(texture_info.bitmap && texture_info.bitmap != game.bmp_error) {
+        if(
+            texture_info.bitmap && texture_info.bitmap != game.bmp_error &&
+            texture_info.bitmap != game.sector_textures.get_placeholder()
+        ) {
             game.content.bitmaps.list.free(texture_info.bmp_name);
         }
     }
@@ -85,6 +88,7 @@ void Sector::clone(Sector* destination) const {
     destination->z = z;
     destination->tag = tag;
     destination->hazards = hazards;
+    destination->path_blocking_hazards = path_blocking_hazards;
     destination->hazard_floor = hazard_floor;
     destination->hazards_str = hazards_str;
     destination->brightness = brightness;
@@ -96,6 +100,39 @@ void Sector::clone(Sector* destination) const {
 }
 
 
+/**
+ * @brief Returns a hash of everything the sector's triangulation depends on:
+ * its edges, what's on either side of them, and their vertexes,
+ * coordinates included. If two calls return the same value, then in all
+ * likelihood the sector's edge loops didn't change in between.
+ *
+ * @return The hash.
+ */
+size_t Sector::get_geometry_hash() const {
+    size_t hash = edges.size();
+    const auto mix = [&hash] (size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    };
+    
+    for(size_t e = 0; e < edges.size(); e++) {
+        const Edge* e_ptr = edges[e];
+        mix(std::hash<const void*>()(e_ptr));
+        if(!e_ptr) continue;
+        mix(std::hash<const void*>()(e_ptr->sectors[0]));
+        mix(std::hash<const void*>()(e_ptr->sectors[1]));
+        for(unsigned char v = 0; v < 2; v++) {
+            const Vertex* v_ptr = e_ptr->vertexes[v];
+            mix(std::hash<const void*>()(v_ptr));
+            if(!v_ptr) continue;
+            mix(std::hash<float>()(v_ptr->x));
+            mix(std::hash<float>()(v_ptr->y));
+        }
+    }
+    
+    return hash == 0 ? 1 : hash;
+}
+
+
 /**
  * @brief Fills a vector with neighboring sectors, recursively, but only if they
  * meet certain criteria.
@@ -134,6 +171,46 @@ void Sector::get_neighbor_sectors_conditionally(
 }
 
 
+/**
+ * @brief Returns the liquid in this sector, if any. This comes from the
+ * first of its hazards that has a liquid.
+ *
+ * @return The liquid, or nullptr if none.
+ */
+Liquid* Sector::get_liquid() const {
+    for(size_t h = 0; h < hazards.size(); h++) {
+        if(hazards[h]->associated_liquid) {
+            return hazards[h]->associated_liquid;
+        }
+    }
+    return nullptr;
+}
+
+
+/**
+ * @brief Returns roughly how much memory the sector takes up, in bytes.
+ * Its texture bitmap isn't included, since it belongs to the bitmap manager.
+ *
+ * @return The size.
+ */
+size_t Sector::get_memory_usage() const {
+    size_t size =
+        sizeof(Sector) +
+        tag.capacity() +
+        hazards_str.capacity() +
+        texture_info.bmp_name.capacity() +
+        get_vector_memory_usage(hazards) +
+        get_vector_memory_usage(edge_idxs) +
+        get_vector_memory_usage(edges) +
+        get_vector_memory_usage(triangles);
+    for(size_t c = 0; c < 2; c++) {
+        size += get_vector_memory_usage(texture_draw_caches[c].vertexes);
+    }
+    size += get_vector_memory_usage(fade_vertexes);
+    return size;
+}
+
+
 /**
  * @brief Returns the vertex farthest to the right in a sector.
  *
@@ -157,12 +234,19 @@ Vertex* Sector::get_rightmost_vertex() const {
 
 /**
  * @brief If texture merging is required, this returns what two
- * neighboring sectors will be used for it.
+ * neighboring sectors will be used for it. The result is remembered until
+ * invalidate_texture_merge_sectors() is called.
  *
  * @param s1 Receives the first sector.
  * @param s2 Receives the second sector.
  */
 void Sector::get_texture_merge_sectors(Sector** s1, Sector** s2) const {
+    if(texture_merge_sectors_valid) {
+        *s1 = texture_merge_sectors[0];
+        *s2 = texture_merge_sectors[1];
+        return;
+    }
+    
     //Check all edges to find which two textures need merging.
     Edge* e_ptr = nullptr;
     Sector* neighbor = nullptr;
@@ -216,18 +300,42 @@ void Sector::get_texture_merge_sectors(Sector** s1, Sector** s2) const {
         //0 is always the bottom one. If we're fading into nothingness,
         //we should swap first.
         std::swap(texture_sector[0], texture_sector[1]);
-    } else if(!texture_sector[1]) {
-        //Nothing to draw.
-        return;
-    } else if(texture_sector[1]->is_bottomless_pit) {
+    } else if(
+        texture_sector[1] && texture_sector[1]->is_bottomless_pit
+    ) {
         std::swap(texture_sector[0], texture_sector[1]);
     }
     
+    texture_merge_sectors[0] = texture_sector[0];
+    texture_merge_sectors[1] = texture_sector[1];
+    texture_merge_sectors_valid = true;
+    
     *s1 = texture_sector[0];
     *s2 = texture_sector[1];
 }
 
 
+/**
+ * @brief Marks the cached vertexes used to draw the sector's textures
+ * as outdated. This must be called whenever its geometry changes.
+ */
+void Sector::invalidate_texture_draw_caches() {
+    texture_draw_caches[0].valid = false;
+    texture_draw_caches[1].valid = false;
+    invalidate_texture_merge_sectors();
+}
+
+
+/**
+ * @brief Marks the neighbors whose textures it merges as outdated.
+ * This must be called whenever its geometry changes, or whenever the
+ * neighbors' geometry or properties change.
+ */
+void Sector::invalidate_texture_merge_sectors() {
+    texture_merge_sectors_valid = false;
+}
+
+
 /**
  * @brief Returns whether a sector's vertexes are ordered clockwise or not.
  *
@@ -285,6 +393,72 @@ void Sector::remove_edge(const Edge* e_ptr) {
 }
 
 
+/**
+ * @brief Rebuilds the set of its hazards that block paths, from the
+ * list of hazards.
+ */
+void Sector::update_path_blocking_hazards() {
+    path_blocking_hazards.reset();
+    for(size_t h = 0; h < hazards.size(); h++) {
+        if(!hazards[h]->blocks_paths) continue;
+        if(hazards[h]->idx == INVALID) continue;
+        path_blocking_hazards.set(hazards[h]->idx);
+    }
+}
+
+
+/**
+ * @brief Returns whether the cached vertexes were built for the given
+ * texture sector, as it is right now.
+ *
+ * @param texture_sector Sector whose texture is to be drawn.
+ * Can be nullptr.
+ * @param draw_sector_0 Whether the first texture is drawn, when fading.
+ * @return Whether they match.
+ */
+bool SectorTextureDrawCache::matches(
+    const Sector* texture_sector, bool draw_sector_0
+) const {
+    if(!valid) return false;
+    if(this->texture_sector != texture_sector) return false;
+    if(this->draw_sector_0 != draw_sector_0) return false;
+    if(!texture_sector) return true;
+    
+    const SectorTexture &info = texture_sector->texture_info;
+    return
+        scale == info.scale &&
+        translation == info.translation &&
+        rot == info.rot &&
+        tint == info.tint &&
+        brightness == texture_sector->brightness;
+}
+
+
+/**
+ * @brief Remembers what texture sector the cached vertexes were just
+ * built for, and marks them as valid.
+ *
+ * @param texture_sector Sector whose texture is to be drawn.
+ * Can be nullptr.
+ * @param draw_sector_0 Whether the first texture is drawn, when fading.
+ */
+void SectorTextureDrawCache::remember(
+    const Sector* texture_sector, bool draw_sector_0
+) {
+    valid = true;
+    this->texture_sector = texture_sector;
+    this->draw_sector_0 = draw_sector_0;
+    if(!texture_sector) return;
+    
+    const SectorTexture &info = texture_sector->texture_info;
+    scale = info.scale;
+    translation = info.translation;
+    rot = info.rot;
+    tint = info.tint;
+    brightness = texture_sector->brightness;
+}
+
+
 /**
  * @brief Returns which sector the specified point belongs to.
  *
@@ -302,26 +476,7 @@ Sector* get_sector(
 
     if(use_blockmap) {
     
-        size_t col = game.cur_area_data->bmap.get_col(p.x);
-        size_t row = game.cur_area_data->bmap.get_row(p.y);
-        if(col == INVALID || row == INVALID) return nullptr;
-        
-        unordered_set<Sector*>* sectors =
-            &game.cur_area_data->bmap.sectors[col][row];
-            
-        if(sectors->size() == 1) return *sectors->begin();
-        
-        for(auto &s : (*sectors)) {
-        
-            if(!s) {
-                continue;
-            }
-            if(s->is_point_in_sector(p)) {
-                return s;
-            }
-        }
-        
-        return nullptr;
+        return get_sector_with_hint(p, nullptr);
         
     } else {
     
@@ -348,3 +503,61 @@ Sector* get_sector(
         
     }
 }
+
+
+/**
+ * @brief Returns which sector the specified point belongs to, using the
+ * blockmap. If a triangle is given as a hint and the point is inside it,
+ * that triangle's sector is returned right away. This is meant for things
+ * that look up their sector often, and don't move much each time.
+ *
+ * @param p Coordinates of the point.
+ * @param triangle_hint If not nullptr, this points to the triangle to check
+ * first, which can be nullptr. Afterwards, it's set to the triangle the point
+ * was found in, or nullptr if the block has a single sector and so
+ * didn't need any triangle checks.
+ * @return The sector.
+ */
+Sector* get_sector_with_hint(
+    const Point &p, const BlockmapTriangle** triangle_hint
+) {
+    const auto is_in = [&p] (const BlockmapTriangle * t_ptr) {
+        return
+            is_point_in_triangle(
+                p, t_ptr->points[0], t_ptr->points[1], t_ptr->points[2],
+                false
+            );
+    };
+    
+    if(triangle_hint && *triangle_hint && is_in(*triangle_hint)) {
+        return (*triangle_hint)->sector;
+    }
+    
+    size_t col = game.cur_area_data->bmap.get_col(p.x);
+    size_t row = game.cur_area_data->bmap.get_row(p.y);
+    if(col == INVALID || row == INVALID) {
+        if(triangle_hint) *triangle_hint = nullptr;
+        return nullptr;
+    }
+    
+    const vector<Sector*> &sectors =
+        game.cur_area_data->bmap.sectors[col][row];
+    
+    if(sectors.size() == 1) {
+        if(triangle_hint) *triangle_hint = nullptr;
+        return sectors[0];
+    }
+    
+    //Only the triangles that overlap this block need to be checked.
+    const vector<BlockmapTriangle> &triangles =
+        game.cur_area_data->bmap.triangles[col][row];
+    for(size_t t = 0; t < triangles.size(); t++) {
+        if(is_in(&triangles[t])) {
+            if(triangle_hint) *triangle_hint = &triangles[t];
+            return triangles[t].sector;
+        }
+    }
+    
+    if(triangle_hint) *triangle_hint = nullptr;
+    return nullptr;
+}
@@ -15,7 +15,9 @@
 
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_color.h>
+#include <allegro5/allegro_primitives.h>
 
+#include "../../core/shaders.h"
 #include "../../util/drawing_utils.h"
 #include "../../util/geometry_utils.h"
 #include "../other/hazard.h"
@@ -24,6 +26,8 @@
 
 using std::string;
 
+struct BlockmapTriangle;
+
 
 //Types of sector.
 enum SECTOR_TYPE {
@@ -65,6 +69,50 @@ struct SectorTexture {
 };
 
 
+/**
+ * @brief Vertexes used to draw one of a sector's textures, kept from
+ * frame to frame, along with the information they were built with.
+ */
+struct SectorTextureDrawCache {
+
+    //--- Members ---
+    
+    //Whether the vertexes were built and can be used.
+    bool valid = false;
+    
+    //Sector whose texture the vertexes were built for.
+    const Sector* texture_sector = nullptr;
+    
+    //Whether the first texture was being drawn, when fading.
+    bool draw_sector_0 = true;
+    
+    //Texture scale the vertexes were built with.
+    Point scale;
+    
+    //Texture translation the vertexes were built with.
+    Point translation;
+    
+    //Texture rotation the vertexes were built with.
+    float rot = 0.0f;
+    
+    //Texture tint the vertexes were built with.
+    ALLEGRO_COLOR tint = COLOR_WHITE;
+    
+    //Brightness the vertexes were built with.
+    unsigned char brightness = 0;
+    
+    //Vertexes, in world coordinates, with full opacity.
+    vector<ALLEGRO_VERTEX> vertexes;
+    
+    
+    //--- Function declarations ---
+    
+    bool matches(const Sector* texture_sector, bool draw_sector_0) const;
+    void remember(const Sector* texture_sector, bool draw_sector_0);
+    
+};
+
+
 /**
  * @brief A sector, like the ones in DOOM.
  *
@@ -103,6 +151,10 @@ struct Sector {
     //List of hazards.
     vector<Hazard*> hazards;
     
+    //Set of its hazards that block paths. Update it whenever the list of
+    //hazards changes.
+    hazard_set_t path_blocking_hazards;
+    
     //Is only floor hazardous, or the air as well?
     bool hazard_floor = true;
     
@@ -124,9 +176,28 @@ struct Sector {
     //Triangles it is composed of.
     vector<Triangle> triangles;
     
+    //Geometry hash the triangles were made with, so the area editor can
+    //tell if they need to be made again. 0 if unknown.
+    size_t triangles_geometry_hash = 0;
+    
     //Bounding box.
     Point bbox[2];
     
+    //Vertexes to draw each of its textures with. Cache for performance.
+    SectorTextureDrawCache texture_draw_caches[2];
+    
+    //Vertexes to draw both of its textures with in one go, if it fades.
+    //Which textures they were built for is in texture_draw_caches.
+    //Cache for performance.
+    vector<SectorFadeVertex> fade_vertexes;
+    
+    //Neighbors whose textures it merges, if it fades. Cache for performance.
+    //Use get_texture_merge_sectors to get these.
+    mutable Sector* texture_merge_sectors[2] = { nullptr, nullptr };
+    
+    //Whether texture_merge_sectors is up to date.
+    mutable bool texture_merge_sectors_valid = false;
+    
     
     //--- Function declarations ---
     
@@ -134,11 +205,17 @@ struct Sector {
     void add_edge(Edge* e_ptr, size_t e_idx);
     void calculate_bounding_box();
     void clone(Sector* destination) const;
+    size_t get_geometry_hash() const;
+    Liquid* get_liquid() const;
+    size_t get_memory_usage() const;
     Vertex* get_rightmost_vertex() const;
     void get_texture_merge_sectors(Sector** s1, Sector** s2) const;
+    void invalidate_texture_draw_caches();
+    void invalidate_texture_merge_sectors();
     bool is_clockwise() const;
     bool is_point_in_sector(const Point &p) const;
     void remove_edge(const Edge* e_ptr);
+    void update_path_blocking_hazards();
     void get_neighbor_sectors_conditionally(
         const std::function<bool(Sector* s_ptr)> &condition,
         vector<Sector*> &sector_list
@@ -150,3 +227,6 @@ struct Sector {
 Sector* get_sector(
     const Point &p, size_t* out_sector_idx, bool use_blockmap
 );
+Sector* get_sector_with_hint(
+    const Point &p, const BlockmapTriangle** triangle_hint
+);
@@ -13,6 +13,7 @@
 #include "vertex.h"
 
 #include "edge.h"
+#include "../../util/general_utils.h"
 
 
 /**
@@ -62,6 +63,19 @@ Edge* Vertex::get_edge_by_neighbor(const Vertex* neighbor) const {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the vertex takes up, in bytes.
+ *
+ * @return The size.
+ */
+size_t Vertex::get_memory_usage() const {
+    return
+        sizeof(Vertex) +
+        get_vector_memory_usage(edge_idxs) +
+        get_vector_memory_usage(edges);
+}
+
+
 /**
  * @brief Returns whether or not this vertex has the specified edge in its list.
  *
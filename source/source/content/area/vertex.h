@@ -46,6 +46,7 @@ struct Vertex {
     explicit Vertex(float x = 0.0f, float y = 0.0f);
     void add_edge(Edge* e_ptr, size_t e_idx);
     Edge* get_edge_by_neighbor(const Vertex* neighbor) const;
+    size_t get_memory_usage() const;
     bool has_edge(const Edge* e_ptr) const;
     bool is_2nd_degree_neighbor(
         const Vertex* other_v, Vertex** first_neighbor
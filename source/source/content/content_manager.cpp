@@ -14,6 +14,27 @@
 #include "../core/game.h"
 #include "../core/load.h"
 #include "../util/allegro_utils.h"
+#include "../util/archive_utils.h"
+#include "../util/string_utils.h"
+
+
+/**
+ * @brief Constructs a new content dependent object.
+ *
+ * @param type The type that keeps the pointers.
+ * @param min_level It only keeps the pointers if it's loaded at this level
+ * or higher.
+ * @param uses_insides Whether it also points to things inside of the content,
+ * or keeps information worked out from it.
+ */
+ContentDependent::ContentDependent(
+    CONTENT_TYPE type, CONTENT_LOAD_LEVEL min_level, bool uses_insides
+) :
+    type(type),
+    min_level(min_level),
+    uses_insides(uses_insides) {
+    
+}
 
 
 /**
@@ -26,6 +47,95 @@ ContentManager::ContentManager() {
 }
 
 
+/**
+ * @brief Keeps a data file that was parsed ahead of time somewhere else,
+ * like on a worker thread, so that the next load_data_file() call for it
+ * uses it instead of reading it again.
+ *
+ * @param path Path to the data file.
+ * @param node The data file's root node.
+ */
+void ContentManager::add_prefetched_data_file(
+    const string &path, DataNode &&node
+) {
+    prefetched_data_files[path] = std::move(node);
+}
+
+
+/**
+ * @brief Returns the content types that keep pointers to the content
+ * of a given type. If that content gets reloaded from scratch, these need
+ * to be reloaded too.
+ *
+ * @param type The content type.
+ * @return The dependents.
+ */
+vector<ContentDependent> ContentManager::get_dependents(CONTENT_TYPE type) {
+    switch(type) {
+    case CONTENT_TYPE_GLOBAL_ANIMATION: {
+        return {
+            ContentDependent(
+                CONTENT_TYPE_STATUS_TYPE, CONTENT_LOAD_LEVEL_FULL, true
+            ),
+        };
+        break;
+    } case CONTENT_TYPE_HAZARD: {
+        return {
+            ContentDependent(CONTENT_TYPE_AREA),
+            ContentDependent(CONTENT_TYPE_GLOBAL_ANIMATION),
+            ContentDependent(CONTENT_TYPE_MOB_ANIMATION),
+            ContentDependent(CONTENT_TYPE_MOB_TYPE),
+        };
+        break;
+    } case CONTENT_TYPE_LIQUID: {
+        return {
+            ContentDependent(CONTENT_TYPE_HAZARD),
+        };
+        break;
+    } case CONTENT_TYPE_MOB_ANIMATION: {
+        return {
+            ContentDependent(
+                CONTENT_TYPE_MOB_TYPE, CONTENT_LOAD_LEVEL_FULL, true
+            ),
+        };
+        break;
+    } case CONTENT_TYPE_MOB_TYPE: {
+        return {
+            ContentDependent(CONTENT_TYPE_AREA),
+        };
+        break;
+    } case CONTENT_TYPE_PARTICLE_GEN: {
+        return {
+            ContentDependent(CONTENT_TYPE_SPIKE_DAMAGE_TYPE),
+            ContentDependent(CONTENT_TYPE_STATUS_TYPE),
+        };
+        break;
+    } case CONTENT_TYPE_SPIKE_DAMAGE_TYPE: {
+        return {
+            ContentDependent(CONTENT_TYPE_MOB_TYPE),
+        };
+        break;
+    } case CONTENT_TYPE_STATUS_TYPE: {
+        return {
+            ContentDependent(CONTENT_TYPE_HAZARD),
+            ContentDependent(CONTENT_TYPE_MOB_TYPE),
+            ContentDependent(CONTENT_TYPE_SPIKE_DAMAGE_TYPE),
+            ContentDependent(CONTENT_TYPE_SPRAY_TYPE),
+        };
+        break;
+    } case CONTENT_TYPE_WEATHER_CONDITION: {
+        return {
+            ContentDependent(CONTENT_TYPE_AREA),
+        };
+        break;
+    } default: {
+        break;
+    }
+    }
+    return {};
+}
+
+
 /**
  * @brief Returns the relevant content type manager for a given content type.
  *
@@ -113,15 +223,23 @@ void ContentManager::load_all(const vector<CONTENT_TYPE> &types, CONTENT_LOAD_LE
         );
         mgr_ptr->fill_manifests();
     }
+    folder_index.save();
     
-    //Now load the content.
+    //Now load the content. The data files are read and parsed by the
+    //worker threads first, and then the manager does the rest of the work,
+    //like handling references to other content and creating bitmaps,
+    //on this thread.
     for(size_t t = 0; t < types.size(); t++) {
         ContentTypeManager* mgr_ptr = get_mgr_ptr(types[t]);
         const string &perf_mon_name = mgr_ptr->get_perf_mon_measurement_name();
         if(!perf_mon_name.empty() && game.perf_mon) {
             game.perf_mon->start_measurement(perf_mon_name);
         }
+        vector<string> data_file_paths;
+        mgr_ptr->get_data_file_paths(data_file_paths);
+        prefetch_data_files(data_file_paths);
         mgr_ptr->load_all(level);
+        prefetched_data_files.clear();
         if(!perf_mon_name.empty() && game.perf_mon) {
             game.perf_mon->finish_measurement();
         }
@@ -131,6 +249,50 @@ void ContentManager::load_all(const vector<CONTENT_TYPE> &types, CONTENT_LOAD_LE
 }
 
 
+/**
+ * @brief Reads and parses several data files at the same time, using
+ * the game's worker threads. The results are kept until they're taken
+ * with take_prefetched_data_file().
+ *
+ * @param paths Paths to the data files.
+ */
+void ContentManager::prefetch_data_files(const vector<string> &paths) {
+    vector<DataNode> nodes(paths.size());
+    game.jobs.parallel_for(
+        paths.size(), 1,
+    [&paths, &nodes] (size_t start, size_t end) {
+        for(size_t p = start; p < end; p++) {
+            load_data_file_contents(paths[p], &nodes[p]);
+        }
+    }
+    );
+    
+    for(size_t p = 0; p < paths.size(); p++) {
+        prefetched_data_files[paths[p]] = std::move(nodes[p]);
+    }
+}
+
+
+/**
+ * @brief If a data file was parsed ahead of time, returns it, and forgets
+ * about it. Files that couldn't be opened are returned too, so the caller
+ * can report the error.
+ *
+ * @param path Path to the data file.
+ * @param out_node The data file's root node is returned here.
+ * @return Whether the file had been parsed ahead of time.
+ */
+bool ContentManager::take_prefetched_data_file(
+    const string &path, DataNode* out_node
+) {
+    auto f_it = prefetched_data_files.find(path);
+    if(f_it == prefetched_data_files.end()) return false;
+    *out_node = std::move(f_it->second);
+    prefetched_data_files.erase(f_it);
+    return true;
+}
+
+
 /**
  * @brief Creates a new pack and updates the list of packs.
  *
@@ -215,6 +377,67 @@ bool ContentManager::load_area_as_current(
 }
 
 
+/**
+ * @brief Reloads the content of some types whose data files were added,
+ * changed, or removed since it was loaded. Types that support it only
+ * reload the content that changed, and do so in place, so anything pointing
+ * to it stays valid. Otherwise, all of the type's content is reloaded from
+ * scratch, along with any loaded content that depends on it.
+ *
+ * @param types Types of game content to reload.
+ */
+void ContentManager::reload_changed(const vector<CONTENT_TYPE> &types) {
+    for(size_t t = 0; t < types.size(); t++) {
+        ContentTypeManager* mgr_ptr = get_mgr_ptr(types[t]);
+        engine_assert(
+            load_levels[types[t]] != CONTENT_LOAD_LEVEL_UNLOADED,
+            "Tried to reload content of type " + mgr_ptr->get_name() +
+            " even though it's not loaded!"
+        );
+        
+        bool changed = false;
+        if(mgr_ptr->reload_changed(load_levels[types[t]], changed)) {
+            if(changed) reload_dependents(types[t], true);
+        } else {
+            reload_from_scratch(types[t]);
+        }
+    }
+    folder_index.save();
+}
+
+
+/**
+ * @brief Reloads from scratch the loaded content that depends on the content
+ * of a given type, after that content got reloaded.
+ *
+ * @param type The content type that got reloaded.
+ * @param in_place Whether it got reloaded in place, meaning pointers to
+ * its content are still valid.
+ */
+void ContentManager::reload_dependents(CONTENT_TYPE type, bool in_place) {
+    vector<ContentDependent> dependents = get_dependents(type);
+    for(size_t d = 0; d < dependents.size(); d++) {
+        if(in_place && !dependents[d].uses_insides) continue;
+        if(load_levels[dependents[d].type] < dependents[d].min_level) continue;
+        reload_from_scratch(dependents[d].type);
+    }
+}
+
+
+/**
+ * @brief Unloads and loads again all of the content of a given type,
+ * at the same level, along with any loaded content that depends on it.
+ *
+ * @param type The content type.
+ */
+void ContentManager::reload_from_scratch(CONTENT_TYPE type) {
+    CONTENT_LOAD_LEVEL level = load_levels[type];
+    unload_all(vector<CONTENT_TYPE> { type });
+    load_all(vector<CONTENT_TYPE> { type }, level);
+    reload_dependents(type, false);
+}
+
+
 /**
  * @brief Reloads all packs.
  * This only loads their manifests and metadata, not their content!
@@ -279,6 +502,22 @@ void PackManager::clear_manifests() {
  * @brief Fills in the manifests.
  */
 void PackManager::fill_manifests() {
+    //Archived packs. A pack's folder wins over its archive, if both exist.
+    vector<string> game_data_files =
+        folder_to_vector(FOLDER_PATHS_FROM_ROOT::GAME_DATA, false);
+    string archive_suffix = string(".") + FILE_ARCHIVE_EXTENSION;
+    for(size_t f = 0; f < game_data_files.size(); f++) {
+        if(!str_ends_with(game_data_files[f], archive_suffix)) continue;
+        string mount_path =
+            FOLDER_PATHS_FROM_ROOT::GAME_DATA + "/" +
+            remove_extension(game_data_files[f]);
+        if(folder_exists(mount_path)) continue;
+        mount_file_archive(
+            FOLDER_PATHS_FROM_ROOT::GAME_DATA + "/" + game_data_files[f],
+            mount_path
+        );
+    }
+    
     //Raw manifests.
     vector<string> raw_folders =
         folder_to_vector(FOLDER_PATHS_FROM_ROOT::GAME_DATA, true);
@@ -52,6 +52,37 @@ struct PackManager {
 };
 
 
+/**
+ * @brief Info about a content type that keeps pointers to the content of
+ * another type, and so depends on it.
+ */
+struct ContentDependent {
+
+    //--- Members ---
+    
+    //The type that keeps the pointers.
+    CONTENT_TYPE type = CONTENT_TYPE_AREA;
+    
+    //It only keeps the pointers if it's loaded at this level or higher.
+    CONTENT_LOAD_LEVEL min_level = CONTENT_LOAD_LEVEL_BASIC;
+    
+    //Does it also point to things inside of the content, or keep
+    //information worked out from it? If so, it needs to be reloaded even
+    //if the content only got reloaded in place.
+    bool uses_insides = false;
+    
+    
+    //--- Function declarations ---
+    
+    explicit ContentDependent(
+        CONTENT_TYPE type,
+        CONTENT_LOAD_LEVEL min_level = CONTENT_LOAD_LEVEL_BASIC,
+        bool uses_insides = false
+    );
+    
+};
+
+
 /**
  * @brief Manages everything regarding game content, be it assets, types of
  * mobs, etc.
@@ -114,10 +145,14 @@ struct ContentManager {
     //Packs.
     PackManager packs;
     
+    //Index of what's inside the game data folders.
+    ContentFolderIndex folder_index;
+    
     
     //--- Function declarations ---
     
     ContentManager();
+    void add_prefetched_data_file(const string &path, DataNode &&node);
     bool create_pack(
         const string &internal_name, const string &name,
         const string &description = "", const string &maker = ""
@@ -127,7 +162,9 @@ struct ContentManager {
         CONTENT_LOAD_LEVEL level, bool from_backup
     );
     void load_all(const vector<CONTENT_TYPE> &types, CONTENT_LOAD_LEVEL level);
+    void reload_changed(const vector<CONTENT_TYPE> &types);
     void reload_packs();
+    bool take_prefetched_data_file(const string &path, DataNode* out_node);
     void unload_all(const vector<CONTENT_TYPE> &types);
     void unload_current_area(CONTENT_LOAD_LEVEL level);
     
@@ -137,9 +174,16 @@ struct ContentManager {
     
     CONTENT_LOAD_LEVEL load_levels[N_CONTENT_TYPES];
     
+    //Data files that were parsed ahead of time, but not used yet, by path.
+    map<string, DataNode> prefetched_data_files;
+    
     
     //--- Function declarations ---
     
+    static vector<ContentDependent> get_dependents(CONTENT_TYPE type);
     ContentTypeManager* get_mgr_ptr(CONTENT_TYPE type);
+    void prefetch_data_files(const vector<string> &paths);
+    void reload_dependents(CONTENT_TYPE type, bool in_place);
+    void reload_from_scratch(CONTENT_TYPE type);
     
 };
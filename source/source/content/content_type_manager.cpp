@@ -9,6 +9,8 @@
  */
 
 #include <algorithm>
+#include <cstdlib>
+#include <ctime>
 
 #include "content_type_manager.h"
 
@@ -17,6 +19,7 @@
 #include "../core/init.h"
 #include "../core/load.h"
 #include "../util/allegro_utils.h"
+#include "../util/archive_utils.h"
 #include "../util/string_utils.h"
 
 
@@ -86,6 +89,43 @@ string AreaContentManager::get_perf_mon_measurement_name() const {
 }
 
 
+/**
+ * @brief Returns an area's thumbnail, loading it if it wasn't loaded along
+ * with the area. Only the areas that used theirs most recently keep them
+ * in memory, though whoever holds on to the returned pointer keeps
+ * that one alive.
+ *
+ * @param area_ptr The area.
+ * @return The thumbnail, or nullptr if it has none.
+ */
+std::shared_ptr<ALLEGRO_BITMAP> AreaContentManager::get_thumbnail(
+    Area* area_ptr
+) {
+    if(area_ptr->thumbnail_path.empty()) return area_ptr->thumbnail;
+    
+    auto it =
+        std::find(
+            on_demand_thumbnail_areas.begin(),
+            on_demand_thumbnail_areas.end(),
+            area_ptr
+        );
+    if(it != on_demand_thumbnail_areas.end()) {
+        //Mark it as the most recently used.
+        on_demand_thumbnail_areas.erase(it);
+        on_demand_thumbnail_areas.push_back(area_ptr);
+        return area_ptr->thumbnail;
+    }
+    
+    area_ptr->load_thumbnail(area_ptr->thumbnail_path);
+    on_demand_thumbnail_areas.push_back(area_ptr);
+    if(on_demand_thumbnail_areas.size() > AREA::MAX_ON_DEMAND_THUMBNAILS) {
+        on_demand_thumbnail_areas.front()->thumbnail = nullptr;
+        on_demand_thumbnail_areas.erase(on_demand_thumbnail_areas.begin());
+    }
+    return area_ptr->thumbnail;
+}
+
+
 /**
  * @brief Loads all content in the manifests.
  *
@@ -101,6 +141,26 @@ void AreaContentManager::load_all(CONTENT_LOAD_LEVEL level) {
 }
 
 
+/**
+ * @brief Loads the thumbnails of all areas that didn't load theirs yet,
+ * and keeps them in memory. Useful for when all of them need to be shown
+ * at once.
+ */
+void AreaContentManager::load_all_thumbnails() {
+    on_demand_thumbnail_areas.clear();
+    for(size_t t = 0; t < list.size(); t++) {
+        for(size_t a = 0; a < list[t].size(); a++) {
+            Area* area_ptr = list[t][a];
+            if(area_ptr->thumbnail_path.empty()) continue;
+            if(!area_ptr->thumbnail) {
+                area_ptr->load_thumbnail(area_ptr->thumbnail_path);
+            }
+            area_ptr->thumbnail_path.clear();
+        }
+    }
+}
+
+
 /**
  * @brief Loads an area.
  *
@@ -135,9 +195,16 @@ bool AreaContentManager::load_area(
     DataNode data_file = load_data_file(data_file_path);
     if(!data_file.fileWasOpened) return false;
     
+    //The geometry file can be big, so only parse it if it's needed.
+    //Otherwise, just make sure it's there.
     string geometry_file_path = base_folder_path + "/" + FILE_NAMES::AREA_GEOMETRY;
-    DataNode geometry_file = load_data_file(geometry_file_path);
-    if(!geometry_file.fileWasOpened) return false;
+    DataNode geometry_file;
+    if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
+        geometry_file = load_data_file(geometry_file_path);
+        if(!geometry_file.fileWasOpened) return false;
+    } else {
+        if(!file_exists(geometry_file_path)) return false;
+    }
     
     area_ptr->type = requested_area_type;
     area_ptr->user_data_path = user_data_path;
@@ -152,13 +219,15 @@ bool AreaContentManager::load_area(
     }
     
     //Main data.
-    if(game.perf_mon) game.perf_mon->start_measurement("Area -- Data");
+    if(game.perf_mon) {
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_AREA_DATA);
+    }
     area_ptr->load_main_data_from_data_node(&data_file, level);
     area_ptr->load_mission_data_from_data_node(&data_file);
     if(game.perf_mon) game.perf_mon->finish_measurement();
     
     //Loading screen.
-    if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
+    if(level >= CONTENT_LOAD_LEVEL_EDITOR && !game.headless) {
         if(game.loading_text_bmp) al_destroy_bitmap(game.loading_text_bmp);
         if(game.loading_subtext_bmp) al_destroy_bitmap(game.loading_subtext_bmp);
         game.loading_text_bmp = nullptr;
@@ -175,13 +244,21 @@ bool AreaContentManager::load_area(
         al_flip_display();
     }
     
-    //Thumbnail image.
+    //Thumbnail image. Area lists only show a few of them at a time,
+    //so at the basic level, it's only loaded when it's needed.
     string thumbnail_path = base_folder_path + "/" + FILE_NAMES::AREA_THUMBNAIL;
-    area_ptr->load_thumbnail(thumbnail_path);
+    if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
+        area_ptr->load_thumbnail(thumbnail_path);
+    } else {
+        area_ptr->thumbnail_path = thumbnail_path;
+    }
     
     //Geometry.
     if(level >= CONTENT_LOAD_LEVEL_EDITOR) {
-        area_ptr->load_geometry_from_data_node(&geometry_file, level);
+        area_ptr->load_geometry_from_data_node(
+            &geometry_file, level,
+            base_folder_path + "/" + FILE_NAMES::AREA_GEOMETRY_CACHE
+        );
     }
     
     return true;
@@ -262,6 +339,7 @@ void AreaContentManager::path_to_manifest(
  * @param level Load level. Should match the level used to load the content.
  */
 void AreaContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
+    on_demand_thumbnail_areas.clear();
     for(size_t t = 0; t < list.size(); t++) {
         for(size_t a = 0; a < list[t].size(); a++) {
             delete list[t][a];
@@ -367,6 +445,151 @@ void BitmapContentManager::path_to_manifest(
  * @param level Load level. Should match the level used to load the content.
  */
 void BitmapContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
+    list.clear_cache();
+}
+
+
+/**
+ * @brief Stores the names of all files in a folder into a vector, but also
+ * recursively enters subfolders. Works like the function of the same name
+ * in the Allegro utilities, but only reads folders that changed.
+ *
+ * @param folder_path Path to the folder.
+ * @param folders If true, only read folders. If false, only read files.
+ * @return The vector.
+ */
+vector<string> ContentFolderIndex::folder_to_vector_recursively(
+    const string &folder_path, bool folders
+) {
+    //Archives are already indexed in memory, and have no modification times.
+    if(find_file_archive(folder_path, nullptr)) {
+        return ::folder_to_vector_recursively(folder_path, folders);
+    }
+    
+    vector<string> v;
+    const FolderInfo* info = get_folder_info(folder_path);
+    if(!info) return v;
+    
+    //Copy these, since the recursion can change the map.
+    vector<string> subfolders = info->subfolders;
+    if(!folders) {
+        v.insert(v.end(), info->files.begin(), info->files.end());
+    } else {
+        v.insert(v.end(), subfolders.begin(), subfolders.end());
+    }
+    
+    for(size_t s = 0; s < subfolders.size(); s++) {
+        vector<string> recursive_result =
+            folder_to_vector_recursively(
+                folder_path + "/" + subfolders[s], folders
+            );
+        for(size_t r = 0; r < recursive_result.size(); r++) {
+            v.push_back(subfolders[s] + "/" + recursive_result[r]);
+        }
+    }
+    
+    return v;
+}
+
+
+/**
+ * @brief Returns what's inside of a folder. If the folder changed since
+ * the last time it was read, or was never read, it is read now.
+ *
+ * @param folder_path Path to the folder.
+ * @return The info, or nullptr if the folder doesn't exist.
+ */
+const ContentFolderIndex::FolderInfo* ContentFolderIndex::get_folder_info(
+    const string &folder_path
+) {
+    if(!loaded) load();
+    
+    ALLEGRO_FS_ENTRY* entry = al_create_fs_entry(folder_path.c_str());
+    bool exists = entry && al_fs_entry_exists(entry);
+    int64_t mtime = exists ? (int64_t) al_get_fs_entry_mtime(entry) : 0;
+    if(entry) al_destroy_fs_entry(entry);
+    
+    if(!exists) {
+        if(folders.erase(folder_path) > 0) dirty = true;
+        return nullptr;
+    }
+    
+    auto it = folders.find(folder_path);
+    if(it != folders.end() && it->second.mtime == mtime) {
+        return &it->second;
+    }
+    
+    //New or changed folder. Read it.
+    bool found;
+    FolderInfo info;
+    info.mtime = mtime;
+    info.subfolders = folder_to_vector(folder_path, true, &found);
+    if(!found) {
+        if(folders.erase(folder_path) > 0) dirty = true;
+        return nullptr;
+    }
+    info.files = folder_to_vector(folder_path, false);
+    
+    FolderInfo &result = folders[folder_path];
+    result = info;
+    dirty = true;
+    return &result;
+}
+
+
+/**
+ * @brief Loads the index from the disk, if it's there.
+ */
+void ContentFolderIndex::load() {
+    loaded = true;
+    folders.clear();
+    dirty = false;
+    
+    DataNode file;
+    file.loadFile(FILE_PATHS_FROM_ROOT::CONTENT_FOLDER_INDEX);
+    if(!file.fileWasOpened) return;
+    
+    size_t n_folders = file.getNrOfChildren();
+    for(size_t f = 0; f < n_folders; f++) {
+        DataNode* folder_node = file.getChild(f);
+        FolderInfo &info = folders[folder_node->value];
+        
+        size_t n_items = folder_node->getNrOfChildren();
+        for(size_t i = 0; i < n_items; i++) {
+            DataNode* item_node = folder_node->getChild(i);
+            if(item_node->name == "mtime") {
+                info.mtime = strtoll(item_node->value.c_str(), nullptr, 10);
+            } else if(item_node->name == "subfolder") {
+                info.subfolders.push_back(item_node->value);
+            } else if(item_node->name == "file") {
+                info.files.push_back(item_node->value);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Saves the index to the disk, if anything changed.
+ */
+void ContentFolderIndex::save() {
+    if(!dirty) return;
+    
+    DataNode file("", "");
+    for(const auto &f : folders) {
+        DataNode* folder_node = file.addNew("folder", f.first);
+        folder_node->addNew("mtime", i2s(f.second.mtime));
+        for(size_t s = 0; s < f.second.subfolders.size(); s++) {
+            folder_node->addNew("subfolder", f.second.subfolders[s]);
+        }
+        for(size_t i = 0; i < f.second.files.size(); i++) {
+            folder_node->addNew("file", f.second.files[i]);
+        }
+    }
+    
+    if(file.saveFile(FILE_PATHS_FROM_ROOT::CONTENT_FOLDER_INDEX, true, true)) {
+        dirty = false;
+    }
 }
 
 
@@ -405,7 +628,9 @@ void ContentTypeManager::fill_manifests_map_from_pack(
         "/" + content_rel_path;
         
     vector<string> items =
-        folder_to_vector_recursively(folder_path, folders);
+        game.content.folder_index.folder_to_vector_recursively(
+            folder_path, folders
+        );
         
     for(size_t i = 0; i < items.size(); i++) {
         string internal_name = remove_extension(items[i]);
@@ -414,6 +639,132 @@ void ContentTypeManager::fill_manifests_map_from_pack(
 }
 
 
+/**
+ * @brief Adds the paths of the data files that loading this content will
+ * read, so they can be parsed ahead of time. By default, these are the paths
+ * of the manifests from get_data_manifests().
+ *
+ * @param out_paths The paths are added here.
+ */
+void ContentTypeManager::get_data_file_paths(
+    vector<string> &out_paths
+) const {
+    const map<string, ContentManifest>* manifests = get_data_manifests();
+    if(!manifests) return;
+    for(const auto &m : *manifests) {
+        out_paths.push_back(m.second.path);
+    }
+}
+
+
+/**
+ * @brief Returns the manifests of this content type, if each one is a single
+ * data file, so that get_data_file_paths() can list them. By default, this
+ * is nullptr.
+ *
+ * @return The manifests, or nullptr.
+ */
+const map<string, ContentManifest>*
+ContentTypeManager::get_data_manifests() const {
+    return nullptr;
+}
+
+
+/**
+ * @brief Returns the modification time of a file on the disk.
+ *
+ * @param path Path to the file.
+ * @return The modification time, or 0 if the file doesn't exist.
+ */
+int64_t ContentTypeManager::get_file_mtime(const string &path) {
+    ALLEGRO_FS_ENTRY* entry = al_create_fs_entry(path.c_str());
+    bool exists = entry && al_fs_entry_exists(entry);
+    int64_t mtime = exists ? (int64_t) al_get_fs_entry_mtime(entry) : 0;
+    if(entry) al_destroy_fs_entry(entry);
+    return mtime;
+}
+
+
+/**
+ * @brief Reloads only the content whose data files were added or changed
+ * since it was loaded. The content is reloaded in place, so anything
+ * pointing to it stays valid. By default, content types can't do this.
+ *
+ * @param level Level the content was loaded at.
+ * @param out_changed Set to true if anything got reloaded.
+ * @return Whether it could be done. If not, all of the content of this
+ * type needs to be reloaded from scratch.
+ */
+bool ContentTypeManager::reload_changed(
+    CONTENT_LOAD_LEVEL level, bool &out_changed
+) {
+    return false;
+}
+
+
+/**
+ * @brief Compares a manifests map with a freshly-filled one, and reloads
+ * the content that was added, whose data file changed since it was loaded,
+ * or that is now overridden by another pack. The manifests map is
+ * updated in place.
+ *
+ * @param manifests Manifests map of the loaded content.
+ * @param new_manifests Manifests map, as filled in from the disk now.
+ * @param reload Code that reloads the content of a manifest. If the
+ * content is already loaded, it must be reloaded into the same object.
+ * @param out_changed Set to true if anything got reloaded.
+ * @return Whether it could be done. It can't if any content got removed,
+ * since something could be pointing to it.
+ */
+bool ContentTypeManager::reload_changed_manifests(
+    map<string, ContentManifest> &manifests,
+    const map<string, ContentManifest> &new_manifests,
+    const std::function<void(ContentManifest*)> &reload, bool &out_changed
+) {
+    for(const auto &m : manifests) {
+        if(new_manifests.find(m.first) == new_manifests.end()) return false;
+    }
+    
+    for(const auto &m : new_manifests) {
+        auto it = manifests.find(m.first);
+        if(it == manifests.end()) {
+            //New content.
+            ContentManifest* manifest = &manifests[m.first];
+            *manifest = m.second;
+            reload(manifest);
+            out_changed = true;
+            
+        } else if(
+            it->second.path != m.second.path ||
+            get_file_mtime(m.second.path) != file_mtimes[m.second.path]
+        ) {
+            //Changed content, or content now overridden by another pack.
+            it->second = m.second;
+            reload(&it->second);
+            out_changed = true;
+            
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Takes note of a data file's current modification time, so it's
+ * possible to tell later if it changed.
+ *
+ * @param path Path to the data file.
+ */
+void ContentTypeManager::remember_file_mtime(const string &path) {
+    int64_t mtime = get_file_mtime(path);
+    //The modification time is only precise to the second. If the file was
+    //changed in this same second, it could still change again in it without
+    //anyone noticing, so assume it will.
+    if(mtime >= (int64_t) time(nullptr)) mtime = -1;
+    file_mtimes[path] = mtime;
+}
+
+
 /**
  * @brief Clears the manifests.
  */
@@ -430,6 +781,17 @@ void GlobalAnimContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+GlobalAnimContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -469,11 +831,12 @@ void GlobalAnimContentManager::load_all(CONTENT_LOAD_LEVEL level) {
  * @param level Level to load at.
  */
 void GlobalAnimContentManager::load_animation_db(ContentManifest* manifest, CONTENT_LOAD_LEVEL level) {
-    DataNode file(manifest->path);
+    DataNode file = load_data_file(manifest->path, false);
     AnimationDatabase db;
     db.manifest = manifest;
     db.load_from_data_node(&file);
     list[manifest->internal_name] = db;
+    remember_file_mtime(manifest->path);
 }
 
 
@@ -510,6 +873,34 @@ void GlobalAnimContentManager::path_to_manifest(
 }
 
 
+/**
+ * @brief Reloads only the animation databases that were added or changed
+ * since they were loaded.
+ *
+ * @param level Level the content was loaded at.
+ * @param out_changed Set to true if anything got reloaded.
+ * @return Whether it could be done.
+ */
+bool GlobalAnimContentManager::reload_changed(
+    CONTENT_LOAD_LEVEL level, bool &out_changed
+) {
+    map<string, ContentManifest> new_manifests;
+    fill_manifests_map(
+        new_manifests, FOLDER_PATHS_FROM_PACK::GLOBAL_ANIMATIONS, false
+    );
+    const auto reload =
+    [this, level] (ContentManifest* manifest) {
+        auto it = list.find(manifest->internal_name);
+        if(it != list.end()) it->second.destroy();
+        load_animation_db(manifest, level);
+    };
+    return
+        reload_changed_manifests(
+            manifests, new_manifests, reload, out_changed
+        );
+}
+
+
 /**
  * @brief Unloads all loaded content.
  *
@@ -520,6 +911,7 @@ void GlobalAnimContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
         a.second.destroy();
     }
     list.clear();
+    file_mtimes.clear();
 }
 
 
@@ -539,6 +931,17 @@ void GuiContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+GuiContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -630,6 +1033,17 @@ void HazardContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+HazardContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -659,6 +1073,21 @@ void HazardContentManager::load_all(CONTENT_LOAD_LEVEL level) {
     for(auto &h : manifests) {
         load_hazard(&h.second, level);
     }
+    
+    //Give each hazard its index in hazard sets.
+    size_t next_idx = 0;
+    for(auto &h : list) {
+        if(next_idx == N_MAX_HAZARDS) {
+            game.errors.report(
+                "There are more than " + i2s(N_MAX_HAZARDS) + " hazards! "
+                "Hazard \"" + h.first + "\" and the ones after it "
+                "won't block paths."
+            );
+            break;
+        }
+        h.second.idx = next_idx;
+        next_idx++;
+    }
 }
 
 
@@ -740,6 +1169,17 @@ void LiquidContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+LiquidContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -853,6 +1293,27 @@ void MiscConfigContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Adds the paths of the data files that loading this content will
+ * read.
+ *
+ * @param out_paths The paths are added here.
+ */
+void MiscConfigContentManager::get_data_file_paths(
+    vector<string> &out_paths
+) const {
+    const string names[] = {
+        remove_extension(FILE_NAMES::GAME_CONFIG),
+        remove_extension(FILE_NAMES::SYSTEM_CONTENT_NAMES)
+    };
+    for(const string &n : names) {
+        auto m_it = manifests.find(n);
+        if(m_it == manifests.end()) continue;
+        out_paths.push_back(m_it->second.path);
+    }
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -886,12 +1347,14 @@ void MiscConfigContentManager::load_all(CONTENT_LOAD_LEVEL level) {
         load_data_file(manifests[config_file_internal_name].path);
     game.config.load(&game_config_file);
     
-    al_set_window_title(
-        game.display,
-        game.config.general.name.empty() ?
-        "Pikifen" :
-        game.config.general.name.c_str()
-    );
+    if(game.display) {
+        al_set_window_title(
+            game.display,
+            game.config.general.name.empty() ?
+            "Pikifen" :
+            game.config.general.name.c_str()
+        );
+    }
     
     //System content names.
     string scn_file_internal_name =
@@ -963,17 +1426,22 @@ void MobAnimContentManager::fill_manifests() {
         if(category->folder_name.empty()) return;
         
         for(const auto &p : game.content.packs.manifests_with_base) {
-            fill_cat_manifests_from_pack(category, p);
+            fill_cat_manifests_from_pack(category, p, manifests[c]);
         }
     }
 }
 
 
 /**
- * @brief Fills in the manifests from a specific pack.
+ * @brief Fills in the manifests of a category from a specific pack.
+ *
+ * @param category The category.
+ * @param pack_name Name of the pack folder.
+ * @param cat_manifests Manifests map of the category to fill.
  */
 void MobAnimContentManager::fill_cat_manifests_from_pack(
-    MobCategory* category, const string &pack_name
+    MobCategory* category, const string &pack_name,
+    map<string, ContentManifest> &cat_manifests
 ) {
     const string category_path =
         FOLDER_PATHS_FROM_ROOT::GAME_DATA + "/" +
@@ -983,7 +1451,7 @@ void MobAnimContentManager::fill_cat_manifests_from_pack(
     vector<string> type_folders = folder_to_vector_recursively(category_path, true);
     for(size_t f = 0; f < type_folders.size(); f++) {
         string internal_name = type_folders[f];
-        manifests[category->id][internal_name] =
+        cat_manifests[internal_name] =
             ContentManifest(
                 internal_name,
                 category_path + "/" +
@@ -995,6 +1463,23 @@ void MobAnimContentManager::fill_cat_manifests_from_pack(
 }
 
 
+/**
+ * @brief Adds the paths of the data files that loading this content will
+ * read.
+ *
+ * @param out_paths The paths are added here.
+ */
+void MobAnimContentManager::get_data_file_paths(
+    vector<string> &out_paths
+) const {
+    for(size_t c = 0; c < manifests.size(); c++) {
+        for(const auto &m : manifests[c]) {
+            out_paths.push_back(m.second.path);
+        }
+    }
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -1038,11 +1523,12 @@ void MobAnimContentManager::load_all(CONTENT_LOAD_LEVEL level) {
  * @param category_id Mob category ID.
  */
 void MobAnimContentManager::load_animation_db(ContentManifest* manifest, CONTENT_LOAD_LEVEL level, MOB_CATEGORY category_id) {
-    DataNode file(manifest->path);
+    DataNode file = load_data_file(manifest->path, false);
     AnimationDatabase db;
     db.manifest = manifest;
-    db.load_from_data_node(&file);
+    db.load_from_data_node(&file, !lazy_sprite_bitmaps);
     list[category_id][manifest->internal_name] = db;
+    remember_file_mtime(manifest->path);
 }
 
 
@@ -1105,6 +1591,44 @@ void MobAnimContentManager::path_to_manifest(
 }
 
 
+/**
+ * @brief Reloads only the animation databases that were added or changed
+ * since they were loaded.
+ *
+ * @param level Level the content was loaded at.
+ * @param out_changed Set to true if anything got reloaded.
+ * @return Whether it could be done.
+ */
+bool MobAnimContentManager::reload_changed(
+    CONTENT_LOAD_LEVEL level, bool &out_changed
+) {
+    for(size_t c = 0; c < manifests.size(); c++) {
+        if(c == MOB_CATEGORY_NONE) continue;
+        MobCategory* category = game.mob_categories.get((MOB_CATEGORY) c);
+        if(category->folder_name.empty()) continue;
+        
+        map<string, ContentManifest> new_manifests;
+        for(const auto &p : game.content.packs.manifests_with_base) {
+            fill_cat_manifests_from_pack(category, p, new_manifests);
+        }
+        const auto reload =
+        [this, level, c] (ContentManifest* manifest) {
+            auto it = list[c].find(manifest->internal_name);
+            if(it != list[c].end()) it->second.destroy();
+            load_animation_db(manifest, level, (MOB_CATEGORY) c);
+        };
+        if(
+            !reload_changed_manifests(
+                manifests[c], new_manifests, reload, out_changed
+            )
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 /**
  * @brief Unloads all loaded content.
  *
@@ -1117,6 +1641,7 @@ void MobAnimContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
         }
     }
     list.clear();
+    file_mtimes.clear();
 }
 
 
@@ -1145,6 +1670,23 @@ void MobTypeContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Adds the paths of the data files that loading this content will
+ * read. Only each type's main data file is included.
+ *
+ * @param out_paths The paths are added here.
+ */
+void MobTypeContentManager::get_data_file_paths(
+    vector<string> &out_paths
+) const {
+    for(size_t c = 0; c < manifests.size(); c++) {
+        for(const auto &m : manifests[c]) {
+            out_paths.push_back(m.second.path + "/data.txt");
+        }
+    }
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -1261,6 +1803,9 @@ void MobTypeContentManager::load_all(CONTENT_LOAD_LEVEL level) {
     
     //Create the special mob types.
     create_special_mob_types();
+    
+    //Resolve what types the spawn information blocks refer to.
+    resolve_spawn_types();
 }
 
 
@@ -1275,7 +1820,7 @@ void MobTypeContentManager::load_mob_types_of_category(MobCategory* category, CO
     
     map<string, ContentManifest> &man = manifests[category->id];
     for(auto &t : man) {
-        DataNode file(t.second.path + "/data.txt");
+        DataNode file = load_data_file(t.second.path + "/data.txt", false);
         if(!file.fileWasOpened) continue;
         
         MobType* mt;
@@ -1333,6 +1878,29 @@ void MobTypeContentManager::path_to_manifest(
 }
 
 
+/**
+ * @brief Resolves the mob type of every loaded type's spawn information
+ * blocks, so that spawning doesn't need to look types up by name.
+ */
+void MobTypeContentManager::resolve_spawn_types() {
+    for(size_t c = 0; c < N_MOB_CATEGORIES; c++) {
+        MobCategory* category = game.mob_categories.get((MOB_CATEGORY) c);
+        vector<string> type_names;
+        category->get_type_names(type_names);
+        
+        for(size_t t = 0; t < type_names.size(); t++) {
+            MobType* mt = category->get_type(type_names[t]);
+            for(size_t s = 0; s < mt->spawns.size(); s++) {
+                mt->spawns[s].mob_type =
+                    game.mob_categories.find_mob_type(
+                        mt->spawns[s].mob_type_name
+                    );
+            }
+        }
+    }
+}
+
+
 /**
  * @brief Unloads all loaded content.
  *
@@ -1404,6 +1972,17 @@ void ParticleGenContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+ParticleGenContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -1452,6 +2031,7 @@ void ParticleGenContentManager::load_generator(
     new_pg.manifest = manifest;
     new_pg.load_from_data_node(&file, level);
     list[manifest->internal_name] = new_pg;
+    remember_file_mtime(manifest->path);
 }
 
 
@@ -1488,6 +2068,39 @@ void ParticleGenContentManager::path_to_manifest(
 }
 
 
+/**
+ * @brief Reloads only the particle generators that were added or changed
+ * since they were loaded.
+ *
+ * @param level Level the content was loaded at.
+ * @param out_changed Set to true if anything got reloaded.
+ * @return Whether it could be done.
+ */
+bool ParticleGenContentManager::reload_changed(
+    CONTENT_LOAD_LEVEL level, bool &out_changed
+) {
+    map<string, ContentManifest> new_manifests;
+    fill_manifests_map(
+        new_manifests, FOLDER_PATHS_FROM_PACK::PARTICLE_GENERATORS, false
+    );
+    const auto reload =
+    [this, level] (ContentManifest* manifest) {
+        auto it = list.find(manifest->internal_name);
+        if(it != list.end()) {
+            //If the file can't be loaded now, the generator is left as is,
+            //so make sure it doesn't keep a freed bitmap.
+            game.content.bitmaps.list.free(it->second.base_particle.bitmap);
+            it->second.base_particle.bitmap = nullptr;
+        }
+        load_generator(manifest, level);
+    };
+    return
+        reload_changed_manifests(
+            manifests, new_manifests, reload, out_changed
+        );
+}
+
+
 /**
  * @brief Unloads all loaded content.
  *
@@ -1498,6 +2111,7 @@ void ParticleGenContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
         game.content.bitmaps.list.free(g->second.base_particle.bitmap);
     }
     list.clear();
+    file_mtimes.clear();
 }
 
 
@@ -1597,6 +2211,7 @@ void SoundContentManager::path_to_manifest(
  * @param level Load level. Should match the level used to load the content.
  */
 void SoundContentManager::unload_all(CONTENT_LOAD_LEVEL level) {
+    list.clear_cache();
 }
 
 
@@ -1616,6 +2231,17 @@ void SongContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+SongContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -1827,6 +2453,17 @@ void SpikeDamageTypeContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+SpikeDamageTypeContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -1935,6 +2572,17 @@ void SprayTypeContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+SprayTypeContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -2084,6 +2732,17 @@ void StatusTypeContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+StatusTypeContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
@@ -2228,6 +2887,17 @@ void WeatherConditionContentManager::fill_manifests() {
 }
 
 
+/**
+ * @brief Returns the manifests, since each one is a data file.
+ *
+ * @return The manifests.
+ */
+const map<string, ContentManifest>*
+WeatherConditionContentManager::get_data_manifests() const {
+    return &manifests;
+}
+
+
 /**
  * @brief Returns the content type's name.
  *
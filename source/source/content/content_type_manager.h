@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -27,6 +28,67 @@ using std::string;
 using std::vector;
 
 
+/**
+ * @brief Remembers what's inside the game data folders, so that filling
+ * in the manifests doesn't need to read every folder on the disk every time.
+ * A folder is only read again if its modification time changed.
+ * This is kept on disk between runs.
+ */
+class ContentFolderIndex {
+
+public:
+
+    //--- Function declarations ---
+    
+    vector<string> folder_to_vector_recursively(
+        const string &folder_path, bool folders
+    );
+    void save();
+    
+    
+private:
+
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief What's inside of a folder.
+     */
+    struct FolderInfo {
+    
+        //--- Members ---
+        
+        //Modification time of the folder when it was read.
+        int64_t mtime = 0;
+        
+        //Names of the subfolders, sorted.
+        vector<string> subfolders;
+        
+        //Names of the files, sorted.
+        vector<string> files;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Known folders, by path.
+    map<string, FolderInfo> folders;
+    
+    //Was the index loaded from the disk yet?
+    bool loaded = false;
+    
+    //Did anything change since it was last loaded or saved?
+    bool dirty = false;
+    
+    
+    //--- Function declarations ---
+    
+    const FolderInfo* get_folder_info(const string &folder_path);
+    void load();
+    
+};
+
+
 /**
  * @brief Responsible for loading and storing game content of a given type
  * into memory.
@@ -40,14 +102,24 @@ public:
     virtual ~ContentTypeManager() = default;
     virtual void clear_manifests() = 0;
     virtual void fill_manifests() = 0;
+    virtual void get_data_file_paths(vector<string> &out_paths) const;
+    virtual const map<string, ContentManifest>* get_data_manifests() const;
     virtual string get_name() const = 0;
     virtual string get_perf_mon_measurement_name() const = 0;
     virtual void load_all(CONTENT_LOAD_LEVEL level) = 0;
+    virtual bool reload_changed(CONTENT_LOAD_LEVEL level, bool &out_changed);
     virtual void unload_all(CONTENT_LOAD_LEVEL level) = 0;
     
     
 protected:
 
+    //--- Members ---
+    
+    //Modification time of each data file when its content was loaded,
+    //by path. Only for the types that can reload what changed.
+    map<string, int64_t> file_mtimes;
+    
+    
     //--- Function declarations ---
     void fill_manifests_map(
         map<string, ContentManifest> &manifests, const string &content_path, bool folders
@@ -56,6 +128,13 @@ protected:
         map<string, ContentManifest> &manifests, const string &pack_name,
         const string &content_rel_path, bool folders
     );
+    static int64_t get_file_mtime(const string &path);
+    bool reload_changed_manifests(
+        map<string, ContentManifest> &manifests,
+        const map<string, ContentManifest> &new_manifests,
+        const std::function<void(ContentManifest*)> &reload, bool &out_changed
+    );
+    void remember_file_mtime(const string &path);
     
 };
 
@@ -83,8 +162,10 @@ public:
     void fill_manifests() override;
     ContentManifest* find_manifest(const string &area_name, const string &pack, AREA_TYPE type);
     string get_name() const override;
+    std::shared_ptr<ALLEGRO_BITMAP> get_thumbnail(Area* area_ptr);
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
+    void load_all_thumbnails();
     bool load_area(
         Area* area_ptr, const string &requested_area_path,
         ContentManifest* manif_ptr,
@@ -102,6 +183,13 @@ public:
     
 private:
 
+    //--- Members ---
+    
+    //Areas with a thumbnail that was loaded on demand,
+    //from least to most recently used.
+    vector<Area*> on_demand_thumbnail_areas;
+    
+    
     //--- Function declarations ---
     
     void load_area_into_vector(
@@ -169,6 +257,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -176,6 +265,7 @@ public:
     void path_to_manifest(
         const string &path, ContentManifest* out_manifest = nullptr
     ) const;
+    bool reload_changed(CONTENT_LOAD_LEVEL level, bool &out_changed) override;
     void unload_all(CONTENT_LOAD_LEVEL level) override;
     
     
@@ -208,6 +298,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -241,6 +332,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -280,6 +372,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -316,6 +409,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    void get_data_file_paths(vector<string> &out_paths) const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -345,11 +439,16 @@ public:
     //Manifests, by category.
     vector<map<string, ContentManifest> > manifests;
     
+    //If true, the databases are loaded without their sprites' bitmaps,
+    //which then only get loaded when a database is actually needed.
+    bool lazy_sprite_bitmaps = false;
+    
     
     //--- Function declarations ---
     
     void clear_manifests() override;
     void fill_manifests() override;
+    void get_data_file_paths(vector<string> &out_paths) const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -361,6 +460,7 @@ public:
         const string &path, ContentManifest* out_manifest = nullptr,
         string* out_category = nullptr, string* out_type = nullptr
     ) const;
+    bool reload_changed(CONTENT_LOAD_LEVEL level, bool &out_changed) override;
     void unload_all(CONTENT_LOAD_LEVEL level) override;
     
     
@@ -368,7 +468,8 @@ private:
 
     //--- Function declarations ---
     void fill_cat_manifests_from_pack(
-        MobCategory* category, const string &pack_name
+        MobCategory* category, const string &pack_name,
+        map<string, ContentManifest> &cat_manifests
     );
     void load_animation_db(ContentManifest* manifest, CONTENT_LOAD_LEVEL level, MOB_CATEGORY category_id);
     
@@ -396,6 +497,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    void get_data_file_paths(vector<string> &out_paths) const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -413,6 +515,7 @@ private:
 
     //--- Function declarations ---
     void load_mob_types_of_category(MobCategory* category, CONTENT_LOAD_LEVEL level);
+    void resolve_spawn_types();
     void unload_mob_type(MobType* mt, CONTENT_LOAD_LEVEL level);
     void unload_mob_types_of_category(MobCategory* category, CONTENT_LOAD_LEVEL level);
 };
@@ -439,6 +542,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -446,6 +550,7 @@ public:
     void path_to_manifest(
         const string &path, ContentManifest* out_manifest = nullptr
     ) const;
+    bool reload_changed(CONTENT_LOAD_LEVEL level, bool &out_changed) override;
     void unload_all(CONTENT_LOAD_LEVEL level) override;
     
     
@@ -478,6 +583,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -589,6 +695,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -628,6 +735,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -667,6 +775,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -706,6 +815,7 @@ public:
     
     void clear_manifests() override;
     void fill_manifests() override;
+    const map<string, ContentManifest>* get_data_manifests() const override;
     string get_name() const override;
     string get_perf_mon_measurement_name() const override;
     void load_all(CONTENT_LOAD_LEVEL level) override;
@@ -209,7 +209,7 @@ bool Bridge::check_health() {
     for(size_t m = 0; m < new_mobs.size(); m++) {
         Mob* m_ptr = new_mobs[m];
         enable_flag(m_ptr->flags, MOB_FLAG_CAN_MOVE_MIDAIR);
-        m_ptr->links.push_back(this);
+        m_ptr->add_link(this);
     }
     
     //Move the bridge object proper to the farthest point of the bridge.
@@ -242,7 +242,7 @@ void Bridge::draw_component(Mob* m) {
     );
     
     Bridge* bri_ptr = (Bridge*) m->links[0];
-    string side = m->vars["side"];
+    string side = m->get_var("side").get_text();
     ALLEGRO_BITMAP* texture =
         side == "left" ?
         bri_ptr->bri_type->bmp_left_rail_texture :
@@ -251,7 +251,7 @@ void Bridge::draw_component(Mob* m) {
         bri_ptr->bri_type->bmp_main_texture;
     int texture_h = al_get_bitmap_height(texture);
     int texture_v0 = texture_h / 2.0f - m->rectangular_dim.y / 2.0f;
-    float texture_offset = s2f(m->vars["offset"]);
+    float texture_offset = m->get_var("offset").get_float();
     
     ALLEGRO_TRANSFORM angle_transform;
     al_identity_transform(&angle_transform);
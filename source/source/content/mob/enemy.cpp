@@ -127,6 +127,11 @@ void Enemy::finish_dying_class_specifics() {
 void Enemy::start_dying_class_specifics() {
     //Numbers.
     game.states.gameplay->enemy_deaths++;
+    enable_flag(
+        game.states.gameplay->changed_mission_counters,
+        MISSION_COUNTER_ENEMY_DEATHS | MISSION_COUNTER_ENEMY_POINTS |
+        MISSION_COUNTER_REMAINING_MOBS
+    );
     if(!game.cur_area_data->mission.enemy_points_on_collection) {
         game.states.gameplay->enemy_points_collected += ene_type->points;
     }
@@ -361,18 +361,11 @@ void Leader::dismiss() {
             )
         ) {
         
-            bool subgroup_exists = false;
-            
-            for(size_t m = 0; m < n_group_members; m++) {
-                Mob* m_ptr = group->members[m];
-                if(m_ptr->subgroup_type_ptr != cur_type) continue;
-                
-                if(!subgroup_exists) {
-                    subgroups_info.push_back(DismissSubgroup());
-                    subgroup_exists = true;
-                }
-                
-                subgroups_info.back().members.push_back(m_ptr);
+            const vector<Mob*> &type_members =
+                group->get_subgroup_members(cur_type);
+            if(!type_members.empty()) {
+                subgroups_info.push_back(DismissSubgroup());
+                subgroups_info.back().members = type_members;
             }
             
         }
@@ -735,16 +728,15 @@ void Leader::get_group_spot_info(
         following_group->radius +
         radius + game.config.pikmin.standard_radius;
         
-    for(size_t me = 0; me < leader_group_ptr->members.size(); me++) {
-        Mob* member_ptr = leader_group_ptr->members[me];
-        if(member_ptr == this) {
-            break;
-        } else if(member_ptr->subgroup_type_ptr == subgroup_type_ptr) {
-            //If this member is also a leader,
-            //then that means the current leader should stick behind.
-            distance +=
-                member_ptr->radius * 2 + MOB::GROUP_SPOT_INTERVAL;
-        }
+    const vector<Mob*> &same_type_members =
+        leader_group_ptr->get_subgroup_members(subgroup_type_ptr);
+    for(size_t me = 0; me < same_type_members.size(); me++) {
+        Mob* member_ptr = same_type_members[me];
+        if(member_ptr == this) break;
+        //If this member is also a leader,
+        //then that means the current leader should stick behind.
+        distance +=
+            member_ptr->radius * 2 + MOB::GROUP_SPOT_INTERVAL;
     }
     
     *out_spot = following_group->pos;
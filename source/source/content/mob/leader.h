@@ -103,8 +103,8 @@ public:
     //Time until the next arrow in the list of swarm arrows appears.
     Timer swarm_next_arrow_timer = Timer(LEADER::SWARM_ARROW_INTERVAL);
     
-    //List of swarm mode arrows.
-    vector<float> swarm_arrows;
+    //Distance of each swarm mode arrow, from oldest to newest.
+    RingBuffer<float> swarm_arrows;
     
     //Time left before the leader can throw again.
     float throw_cooldown = 0.0f;
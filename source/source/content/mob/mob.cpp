@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <tuple>
 
 #include "mob.h"
 
@@ -51,6 +52,12 @@ const float CARRY_SWAY_X_TRANSLATION_AMOUNT = 2.0f;
 const float CARRY_SWAY_Y_TRANSLATION_AMOUNT =
     CARRY_SWAY_X_TRANSLATION_AMOUNT / 2.0f;
     
+//A clear line check's result is reused for at most this long, in seconds.
+const float CLEAR_LINE_CACHE_DURATION = 0.1f;
+
+//A clear line check's result is reused until either mob moves this much.
+const float CLEAR_LINE_CACHE_MOVE_THRESHOLD = 2.0f;
+
 //How much to change the scale by during a damage squash and stretch animation.
 const float DAMAGE_SQUASH_AMOUNT = 0.04f;
 
@@ -95,6 +102,10 @@ const float GROUP_SPOT_INTERVAL = 5.0f;
 //Group spots can randomly deviate in X or Y up to this much.
 const float GROUP_SPOT_MAX_DEVIATION = MOB::GROUP_SPOT_INTERVAL * 0.60f;
 
+//Every frame a group is shuffling, check these many of its spots to see
+//if their members should swap spots with others.
+const size_t GROUP_SPOT_REFINE_CHECKS = 8;
+
 //When using the height effect, scale the mob by this factor.
 const float HEIGHT_EFFECT_FACTOR = 0.002;
 
@@ -104,6 +115,9 @@ const float KNOCKBACK_H_POWER = 64.0f;
 //Base vertical speed at which mobs move due to attacks with knockback.
 const float KNOCKBACK_V_POWER = 800.0f;
 
+//Minimum number of mobs for each job when advancing animations in parallel.
+const size_t MIN_ANIM_TICK_JOB_SIZE = 64;
+
 //Maximum speed multiplier for animations whose speed depend on the mob's.
 const float MOB_SPEED_ANIM_MAX_MULT = 3.0f;
 
@@ -116,6 +130,9 @@ const float OPPONENT_HIT_REGISTER_TIMEOUT = 0.5f;
 //Wait these many seconds before allowing another Pikmin to be called out.
 const float PIKMIN_NEST_CALL_INTERVAL = 0.01f;
 
+//How many mobs of the same class each block of mob memory holds.
+const size_t POOL_BLOCK_SIZE = 64;
+
 //A little extra push amount when mobs intersect. Can't be throttled.
 const float PUSH_EXTRA_AMOUNT = 50.0f;
 
@@ -178,7 +195,7 @@ Mob::Mob(const Point &pos, MobType* type, float angle) :
     
     game.states.gameplay->next_mob_id++;
     
-    Sector* sec = get_sector(pos, nullptr, true);
+    Sector* sec = get_sector_with_hint(pos, &center_triangle);
     if(sec) {
         z = sec->z;
     } else {
@@ -186,6 +203,8 @@ Mob::Mob(const Point &pos, MobType* type, float angle) :
     }
     ground_sector = sec;
     center_sector = sec;
+    prev_step_pos = pos;
+    prev_step_z = z;
     
     team = type->starting_team;
     
@@ -210,13 +229,53 @@ Mob::~Mob() {
     if(carry_info) delete carry_info;
     if(delivery_info) delete delivery_info;
     if(track_info) delete track_info;
-    if(health_wheel) delete health_wheel;
-    if(fraction) delete fraction;
+    if(health_wheel) {
+        game.states.gameplay->in_world_hud_pool.release_health_wheel(
+            health_wheel
+        );
+    }
+    if(fraction) {
+        game.states.gameplay->in_world_hud_pool.release_fraction(fraction);
+    }
     if(group) delete group;
     if(parent) delete parent;
 }
 
 
+/**
+ * @brief Reserves memory for a new mob. Mobs of the same class come from
+ * the same memory pool, so mobs created around the same time are next to
+ * each other in memory, and creating and deleting mobs is cheap.
+ *
+ * @param size Size of the mob's class.
+ * @return The memory.
+ */
+void* Mob::operator new(size_t size) {
+    return get_mem_pool(size)->alloc();
+}
+
+
+/**
+ * @brief Gives the memory of a deleted mob back to its memory pool.
+ *
+ * @param ptr Memory of the mob.
+ * @param size Size of the mob's class.
+ */
+void Mob::operator delete(void* ptr, size_t size) {
+    get_mem_pool(size)->free(ptr);
+}
+
+
+/**
+ * @brief Links this mob to another.
+ *
+ * @param m Mob to link to. Can be nullptr.
+ */
+void Mob::add_link(Mob* m) {
+    links.push_back(m);
+    if(m) m->linked_by.push_back(this);
+}
+
 
 /**
  * @brief Adds a mob to this mob's group.
@@ -229,11 +288,7 @@ void Mob::add_to_group(Mob* new_member) {
     if(!group) return;
     
     new_member->following_group = this;
-    group->members.push_back(new_member);
-    
-    //Find a spot.
-    group->init_spots(new_member);
-    new_member->group_spot_idx = group->spots.size() - 1;
+    group->add_member(new_member);
     
     if(!group->cur_standby_type) {
         if(
@@ -249,10 +304,49 @@ void Mob::add_to_group(Mob* new_member) {
         //If this is the first member, update the anchor position.
         group->anchor = pos;
         group->anchor_angle = TAU / 2.0f;
+        group->spot_positions_valid = false;
     }
 }
 
 
+/**
+ * @brief Works out ahead of time where the mob's animation will be after
+ * this frame of logic, and the events this causes, and keeps it all for
+ * later. This works on a copy of the animation, so the mob itself is left
+ * as it is, and several mobs can do this at the same time from different
+ * threads. When the tick gets to the animation, it only uses the result if
+ * nothing changed in the meantime, including the speed multiplier, which
+ * can change as the mob moves. Otherwise, it advances the animation by
+ * itself, as usual.
+ *
+ * @param delta_t How long the frame's tick is, in seconds.
+ */
+void Mob::advance_animation(float delta_t) {
+    AnimTickResult &result = anim_tick_result;
+    result.pending = false;
+    if(to_delete || anim.shared_clock) return;
+    
+    AnimationInstance ahead(anim.anim_db);
+    ahead.cur_anim = anim.cur_anim;
+    ahead.cur_frame_idx = anim.cur_frame_idx;
+    ahead.cur_frame_time = anim.cur_frame_time;
+    
+    result.anim = anim.cur_anim;
+    result.start_frame_idx = anim.cur_frame_idx;
+    result.start_frame_time = anim.cur_frame_time;
+    result.speed_mult = get_anim_speed_mult();
+    result.signals.clear();
+    result.sounds.clear();
+    result.finished =
+        ahead.tick(
+            delta_t * result.speed_mult, &result.signals, &result.sounds
+        );
+    result.frame_idx = ahead.cur_frame_idx;
+    result.frame_time = ahead.cur_frame_time;
+    result.pending = true;
+}
+
+
 /**
  * @brief Applies the damage caused by an attack from another mob to this one.
  *
@@ -331,16 +425,15 @@ void Mob::apply_status_effect(
     }
     
     //Let's start by sending the status to the child mobs.
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m2_ptr = game.states.gameplay->mobs.all[m];
-        if(m2_ptr->parent && m2_ptr->parent->m == this) {
-            m2_ptr->apply_status_effect(s, true, from_hazard);
-        }
+    for(size_t c = 0; c < child_mobs.size(); c++) {
+        child_mobs[c]->apply_status_effect(s, true, from_hazard);
     }
     
     //Get the vulnerabilities to this status.
+    float vuln_mult = 1.0f;
     auto vuln_it = type->status_vulnerabilities.find(s);
     if(vuln_it != type->status_vulnerabilities.end()) {
+        vuln_mult = vuln_it->second.effect_mult;
         if(vuln_it->second.status_to_apply) {
             //It must instead receive this status.
             apply_status_effect(
@@ -374,9 +467,12 @@ void Mob::apply_status_effect(
     }
     
     //This status is not already inflicted. Let's do so.
-    Status new_status(s);
+    //The vulnerability is resolved now, so ticking the status later
+    //doesn't need to look it up again.
+    Status new_status(s, vuln_mult);
     new_status.from_hazard = from_hazard;
     this->statuses.push_back(new_status);
+    update_status_anim_speed_mult();
     handle_status_effect_gain(s);
     
     if(!s->animation_change.empty()) {
@@ -415,7 +511,8 @@ void Mob::arachnorb_foot_move_logic() {
         return;
     }
     
-    float feet_normal_distance = s2f(parent->m->vars["feet_normal_distance"]);
+    float feet_normal_distance =
+        parent->m->get_var("feet_normal_distance").get_float();
     if(feet_normal_distance == 0) {
         feet_normal_distance = 175;
     }
@@ -428,8 +525,8 @@ void Mob::arachnorb_foot_move_logic() {
             )->pos
         );
         
-    Point final_pos = s2p(parent->m->vars["_destination_pos"]);
-    float final_angle = s2f(parent->m->vars["_destination_angle"]);
+    Point final_pos = s2p(parent->m->get_var("_destination_pos").get_text());
+    float final_angle = parent->m->get_var("_destination_angle").get_float();
     
     Point offset = Point(feet_normal_distance, 0);
     offset = rotate_point(offset, default_angle);
@@ -498,9 +595,9 @@ void Mob::arachnorb_head_turn_logic() {
 void Mob::arachnorb_plan_logic(
     MOB_ACTION_ARACHNORB_PLAN_LOGIC_TYPE goal
 ) {
-    float max_step_distance = s2f(vars["max_step_distance"]);
-    float max_turn_angle = deg_to_rad(s2f(vars["max_turn_angle"]));
-    float min_turn_angle = deg_to_rad(s2f(vars["min_turn_angle"]));
+    float max_step_distance = get_var("max_step_distance").get_float();
+    float max_turn_angle = deg_to_rad(get_var("max_turn_angle").get_float());
+    float min_turn_angle = deg_to_rad(get_var("min_turn_angle").get_float());
     if(max_step_distance == 0) {
         max_step_distance = 100;
     }
@@ -552,8 +649,8 @@ void Mob::arachnorb_plan_logic(
     
     destination_pos += offset;
     
-    vars["_destination_pos"] = p2s(destination_pos);
-    vars["_destination_angle"] = f2s(destination_angle);
+    get_var("_destination_pos").set_text(p2s(destination_pos));
+    get_var("_destination_angle").set_float(destination_angle);
 }
 
 
@@ -563,6 +660,9 @@ void Mob::arachnorb_plan_logic(
  * @param destination Where to carry it.
  */
 void Mob::become_carriable(const CARRY_DESTINATION destination) {
+    if(!carry_info) {
+        game.states.gameplay->mobs.carriables.push_back(this);
+    }
     carry_info = new CarryInfo(this, destination);
 }
 
@@ -585,6 +685,7 @@ void Mob::become_uncarriable() {
     
     delete carry_info;
     carry_info = nullptr;
+    remove_first_in_vector(this, game.states.gameplay->mobs.carriables);
 }
 
 
@@ -697,7 +798,7 @@ bool Mob::calculate_carrying_destination(
         for(size_t l = 0; l < links.size(); l++) {
             if(!links[l]) continue;
             string type_name =
-                links[l]->vars["carry_destination_type"];
+                links[l]->get_var("carry_destination_type").get_text();
             MobType* pik_type =
                 game.mob_categories.get(MOB_CATEGORY_PIKMIN)->
                 get_type(type_name);
@@ -911,10 +1012,7 @@ bool Mob::calculate_damage(
     }
     for(size_t s = 0; s < victim->statuses.size(); s++) {
         float vuln_mult = victim->statuses[s].type->defense_multiplier - 1.0f;
-        auto vuln_it = type->status_vulnerabilities.find(statuses[s].type);
-        if(vuln_it != type->status_vulnerabilities.end()) {
-            vuln_mult *= vuln_it->second.effect_mult;
-        }
+        vuln_mult *= victim->statuses[s].vuln_mult;
         defense_multiplier *= (vuln_mult + 1.0f);
     }
     
@@ -959,6 +1057,35 @@ void Mob::calculate_knockback(
 }
 
 
+/**
+ * @brief Checks if the mob's animation can follow the area's shared
+ * animation clock instead of being ticked. This is the case for plain
+ * loops, like idling, when nothing in the mob is waiting for the
+ * animation to end or to send a signal, and nothing is changing
+ * its speed.
+ *
+ * @return Whether it can.
+ */
+bool Mob::can_follow_shared_anim_clock() const {
+    if(!anim.cur_anim || anim.cur_anim->shared_clock_duration == 0.0f) {
+        return false;
+    }
+    if(status_anim_speed_mult != 1.0f || mob_speed_anim_baseline != 0.0f) {
+        return false;
+    }
+    if(
+        fsm.cur_state &&
+        (
+            fsm.get_event(MOB_EV_ANIMATION_END) ||
+            fsm.get_event(MOB_EV_FRAME_SIGNAL)
+        )
+    ) {
+        return false;
+    }
+    return true;
+}
+
+
 /**
  * @brief Does this mob want to attack mob v? Teams and other factors are
  * used to decide this.
@@ -1151,6 +1278,89 @@ void Mob::chase(
 }
 
 
+/**
+ * @brief Checks whether or not this mob has a clear line towards another mob,
+ * without using the cache. See has_clear_line().
+ *
+ * @param target_mob The mob to check against.
+ * @return Whether it has a clear line.
+ */
+bool Mob::check_clear_line(const Mob* target_mob) const {
+    //First, get a bounding box of the line to check.
+    //This will help with performance later.
+    Point bb_tl = pos;
+    Point bb_br = pos;
+    update_min_max_coords(bb_tl, bb_br, target_mob->pos);
+    
+    const float self_max_z = z + height;
+    const float target_mob_max_z = target_mob->z + target_mob->height;
+    
+    //Check against other mobs. Only the ones touching the bounding box
+    //can be in the way.
+    vector<Mob*> nearby_mobs;
+    game.states.gameplay->get_mobs_in_box(bb_tl, bb_br, nearby_mobs);
+    for(size_t m = 0; m < nearby_mobs.size(); m++) {
+        Mob* m_ptr = nearby_mobs[m];
+        
+        if(!m_ptr->type->pushes) continue;
+        if(m_ptr == this || m_ptr == target_mob) continue;
+        if(has_flag(m_ptr->flags, MOB_FLAG_INTANGIBLE)) continue;
+        
+        const float m_ptr_max_z = m_ptr->z + m_ptr->height;
+        if(m_ptr_max_z < self_max_z || m_ptr_max_z < target_mob_max_z) continue;
+        if(
+            m_ptr->z > z + height &&
+            m_ptr->z > target_mob->z + target_mob->height
+        ) {
+            continue;
+        }
+        if(
+            target_mob->standing_on_mob == m_ptr &&
+            fabs(z - target_mob->z) <= GEOMETRY::STEP_HEIGHT
+        ) {
+            continue;
+        }
+        
+        if(m_ptr->rectangular_dim.x != 0.0f) {
+            if(
+                line_seg_intersects_rotated_rectangle(
+                    pos, target_mob->pos,
+                    m_ptr->pos, m_ptr->rectangular_dim, m_ptr->angle
+                )
+            ) {
+                return false;
+            }
+        } else {
+            if(
+                circle_intersects_line_seg(
+                    m_ptr->pos, m_ptr->radius,
+                    pos, target_mob->pos,
+                    nullptr, nullptr
+                )
+            ) {
+                return false;
+            }
+        }
+    }
+    
+    //Check against walls.
+    //We can ignore walls that are below or within stepping distance of
+    //both mobs, so use the lowest of the two Zs as a cut-off point.
+    if(
+        are_walls_between(
+            pos, target_mob->pos,
+            std::min(z + height, target_mob->z + target_mob->height) +
+            GEOMETRY::STEP_HEIGHT
+        )
+    ) {
+        return false;
+    }
+    
+    //Seems good!
+    return true;
+}
+
+
 /**
  * @brief Makes a mob chomp another mob. Mostly applicable for enemies chomping
  * on Pikmin.
@@ -1188,6 +1398,7 @@ void Mob::chomp(Mob* m, const Hitbox* hitbox_info) {
     
     m->focus_on_mob(this);
     chomping_mobs.push_back(m);
+    m->chomped_by.push_back(this);
 }
 
 
@@ -1368,6 +1579,7 @@ void Mob::delete_old_status_effects() {
             break;
         }
     }
+    update_status_anim_speed_mult();
 }
 
 
@@ -1600,6 +1812,7 @@ void Mob::finish_dying_class_specifics() {
 void Mob::focus_on_mob(Mob* m2) {
     unfocus_from_mob();
     focused_mob = m2;
+    if(m2) m2->focused_by.push_back(this);
 }
 
 
@@ -1630,6 +1843,8 @@ bool Mob::follow_path(
     
     if(path_info) {
         delete path_info;
+    } else {
+        game.states.gameplay->mobs.path_followers.push_back(this);
     }
     
     PathFollowSettings final_settings = settings;
@@ -1667,11 +1882,7 @@ bool Mob::follow_path(
             group->get_group_invulnerabilities(this);
     } else {
         //Use the object's standard invulnerabilities.
-        for(auto &v : type->hazard_vulnerabilities) {
-            if(v.second.effect_mult == 0.0f) {
-                final_settings.invulnerabilities.push_back(v.first);
-            }
-        }
+        final_settings.invulnerabilities = type->hazard_invulnerabilities;
     }
     
     //Establish the mob's path-following information.
@@ -1739,6 +1950,29 @@ bool Mob::follow_path(
 }
 
 
+/**
+ * @brief Returns how much to multiply the speed of the mob's animations by,
+ * based on its statuses and, if applicable, its movement speed.
+ *
+ * @return The multiplier.
+ */
+float Mob::get_anim_speed_mult() const {
+    float mult = status_anim_speed_mult;
+    
+    if(mob_speed_anim_baseline != 0.0f) {
+        float mob_speed_mult = chase_info.cur_speed / mob_speed_anim_baseline;
+        mob_speed_mult =
+            std::clamp(
+                mob_speed_mult,
+                MOB::MOB_SPEED_ANIM_MIN_MULT, MOB::MOB_SPEED_ANIM_MAX_MULT
+            );
+        mult *= mob_speed_mult;
+    }
+    
+    return mult;
+}
+
+
 /**
  * @brief Returns the base speed for this mob.
  * This is overwritten by some child classes.
@@ -2012,6 +2246,28 @@ void Mob::get_hitbox_hold_point(
 }
 
 
+/**
+ * @brief Returns the memory pool for mobs of a class of the given size.
+ * Each class size gets its own pool.
+ *
+ * @param size Size of the mob's class.
+ * @return The pool.
+ */
+BlockPool* Mob::get_mem_pool(size_t size) {
+    static map<size_t, BlockPool> pools;
+    auto it = pools.find(size);
+    if(it == pools.end()) {
+        it =
+            pools.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(size),
+                std::forward_as_tuple(size, MOB::POOL_BLOCK_SIZE)
+            ).first;
+    }
+    return &it->second;
+}
+
+
 /**
  * @brief Returns how many Pikmin are currently latched on to this mob.
  *
@@ -2094,10 +2350,7 @@ float Mob::get_speed_multiplier() const {
     for(size_t s = 0; s < this->statuses.size(); s++) {
         if(!statuses[s].to_delete) {
             float vuln_mult = this->statuses[s].type->speed_multiplier - 1.0f;
-            auto vuln_it = type->status_vulnerabilities.find(statuses[s].type);
-            if(vuln_it != type->status_vulnerabilities.end()) {
-                vuln_mult *= vuln_it->second.effect_mult;
-            }
+            vuln_mult *= statuses[s].vuln_mult;
             move_speed_mult *= (vuln_mult + 1.0f);
         }
     }
@@ -2511,6 +2764,90 @@ ALLEGRO_BITMAP* Mob::get_status_bitmap(float* bmp_scale) const {
 }
 
 
+/**
+ * @brief Returns the world coordinates of the given sprite's hitboxes,
+ * for the mob's current position, Z, and angle. This also updates
+ * world_hitbox_bounds. These are only calculated
+ * again if the sprite or any of those changed since the last call.
+ *
+ * @param s_ptr The mob's current sprite.
+ * @return The world hitboxes, in the same order as the sprite's hitboxes.
+ * This stays valid until the next call with a different sprite.
+ */
+const vector<WorldHitbox> &Mob::get_world_hitboxes(Sprite* s_ptr) {
+    if(!s_ptr) {
+        world_hitboxes.clear();
+        world_hitboxes_sprite = nullptr;
+        return world_hitboxes;
+    }
+    
+    if(
+        s_ptr == world_hitboxes_sprite &&
+        pos == world_hitboxes_pos &&
+        z == world_hitboxes_z &&
+        angle_cos == world_hitboxes_angle_cos &&
+        angle_sin == world_hitboxes_angle_sin &&
+        world_hitboxes.size() == s_ptr->hitboxes.size()
+    ) {
+        return world_hitboxes;
+    }
+    
+    world_hitboxes.resize(s_ptr->hitboxes.size());
+    for(size_t h = 0; h < s_ptr->hitboxes.size(); h++) {
+        const Hitbox* h_ptr = &s_ptr->hitboxes[h];
+        WorldHitbox* w_ptr = &world_hitboxes[h];
+        w_ptr->pos = h_ptr->get_cur_pos(pos, angle_cos, angle_sin);
+        w_ptr->z = z + h_ptr->z;
+        w_ptr->height = h_ptr->height;
+        w_ptr->radius = h_ptr->radius;
+    }
+    
+    const Hitbox* b_ptr = &s_ptr->hitbox_bounds;
+    world_hitbox_bounds.pos = b_ptr->get_cur_pos(pos, angle_cos, angle_sin);
+    world_hitbox_bounds.z = z + b_ptr->z;
+    world_hitbox_bounds.height = b_ptr->height;
+    world_hitbox_bounds.radius = b_ptr->radius;
+    
+    world_hitboxes_sprite = s_ptr;
+    world_hitboxes_pos = pos;
+    world_hitboxes_z = z;
+    world_hitboxes_angle_cos = angle_cos;
+    world_hitboxes_angle_sin = angle_sin;
+    return world_hitboxes;
+}
+
+
+/**
+ * @brief Returns one of the mob's script variables, given its name.
+ * If it doesn't exist yet, it gets created, empty. Names that the mob
+ * type's scripts never mention have no slot, so they're kept apart.
+ *
+ * @param name The variable's name.
+ * @return The variable.
+ */
+ScriptVarValue &Mob::get_var(const string &name) {
+    size_t slot = type->script_vars.find(name);
+    if(slot == INVALID) return extra_vars[name];
+    return get_var_by_slot(slot);
+}
+
+
+/**
+ * @brief Returns one of the mob's script variables, given its slot
+ * in the mob type's script variable table.
+ * If it doesn't exist yet, it gets created, empty.
+ *
+ * @param slot The variable's slot.
+ * @return The variable.
+ */
+ScriptVarValue &Mob::get_var_by_slot(size_t slot) {
+    if(slot >= vars.size()) {
+        vars.resize(std::max(slot + 1, type->script_vars.names.size()));
+    }
+    return vars[slot];
+}
+
+
 /**
  * @brief Handles a status effect being applied.
  *
@@ -2536,92 +2873,68 @@ void Mob::handle_status_effect_loss(StatusType* sta_type) {
 
 
 /**
- * @brief Returns whether or not this mob has a clear line towards another mob.
- * In other words, if a straight line is drawn between both,
- * is this line clear, or is it interrupted by a wall or pushing mob?
+ * @brief Handles the mob being caught by the whistle.
  *
- * @param target_mob The mob to check against.
- * @return Whether it has a clear line.
+ * @param whistler Leader doing the whistling.
  */
-bool Mob::has_clear_line(const Mob* target_mob) const {
-    //First, get a bounding box of the line to check.
-    //This will help with performance later.
-    Point bb_tl = pos;
-    Point bb_br = pos;
-    update_min_max_coords(bb_tl, bb_br, target_mob->pos);
-    
-    const float self_max_z = z + height;
-    const float target_mob_max_z = target_mob->z + target_mob->height;
+void Mob::handle_whistle(Mob* whistler) {
+    fsm.run_event(MOB_EV_WHISTLED, (void*) whistler);
     
-    //Check against other mobs.
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m_ptr = game.states.gameplay->mobs.all[m];
-        
-        if(!m_ptr->type->pushes) continue;
-        if(m_ptr == this || m_ptr == target_mob) continue;
-        if(has_flag(m_ptr->flags, MOB_FLAG_INTANGIBLE)) continue;
-        
-        const float m_ptr_max_z = m_ptr->z + m_ptr->height;
-        if(m_ptr_max_z < self_max_z || m_ptr_max_z < target_mob_max_z) continue;
-        if(
-            m_ptr->z > z + height &&
-            m_ptr->z > target_mob->z + target_mob->height
-        ) {
-            continue;
-        }
-        if(
-            target_mob->standing_on_mob == m_ptr &&
-            fabs(z - target_mob->z) <= GEOMETRY::STEP_HEIGHT
-        ) {
-            continue;
-        }
-        if(
-            !rectangles_intersect(
-                bb_tl, bb_br,
-                m_ptr->pos - m_ptr->physical_span,
-                m_ptr->pos + m_ptr->physical_span
-            )
-        ) {
-            continue;
-        }
-        
-        if(m_ptr->rectangular_dim.x != 0.0f) {
-            if(
-                line_seg_intersects_rotated_rectangle(
-                    pos, target_mob->pos,
-                    m_ptr->pos, m_ptr->rectangular_dim, m_ptr->angle
-                )
-            ) {
-                return false;
-            }
-        } else {
+    bool saved_by_whistle = false;
+    for(size_t s = 0; s < statuses.size(); s++) {
+        if(statuses[s].type->removable_with_whistle) {
+            statuses[s].to_delete = true;
             if(
-                circle_intersects_line_seg(
-                    m_ptr->pos, m_ptr->radius,
-                    pos, target_mob->pos,
-                    nullptr, nullptr
-                )
+                statuses[s].type->health_change < 0.0f ||
+                statuses[s].type->health_change_ratio < 0.0f
             ) {
-                return false;
+                saved_by_whistle = true;
             }
         }
     }
+    delete_old_status_effects();
     
-    //Check against walls.
-    //We can ignore walls that are below or within stepping distance of
-    //both mobs, so use the lowest of the two Zs as a cut-off point.
+    if(saved_by_whistle && type->category->id == MOB_CATEGORY_PIKMIN) {
+        game.statistics.pikmin_saved++;
+    }
+}
+
+
+/**
+ * @brief Returns whether or not this mob has a clear line towards another mob.
+ * In other words, if a straight line is drawn between both,
+ * is this line clear, or is it interrupted by a wall or pushing mob?
+ * If the same mob was checked very recently, and neither moved much since,
+ * the last result is reused.
+ *
+ * @param target_mob The mob to check against.
+ * @return Whether it has a clear line.
+ */
+bool Mob::has_clear_line(const Mob* target_mob) const {
+    ClearLineCache &cache = clear_line_cache;
+    float now = game.states.gameplay->area_time_passed;
     if(
-        are_walls_between(
-            pos, target_mob->pos,
-            std::min(z + height, target_mob->z + target_mob->height) +
-            GEOMETRY::STEP_HEIGHT
-        )
+        cache.target_id == target_mob->id &&
+        now >= cache.time &&
+        now - cache.time <= MOB::CLEAR_LINE_CACHE_DURATION &&
+        Distance(pos, cache.pos) <= MOB::CLEAR_LINE_CACHE_MOVE_THRESHOLD &&
+        Distance(target_mob->pos, cache.target_pos) <=
+        MOB::CLEAR_LINE_CACHE_MOVE_THRESHOLD &&
+        fabs(z - cache.z) <= MOB::CLEAR_LINE_CACHE_MOVE_THRESHOLD &&
+        fabs(target_mob->z - cache.target_z) <=
+        MOB::CLEAR_LINE_CACHE_MOVE_THRESHOLD
     ) {
-        return false;
+        return cache.result;
     }
     
-    //Seems good!
-    return true;
+    cache.target_id = target_mob->id;
+    cache.pos = pos;
+    cache.z = z;
+    cache.target_pos = target_mob->pos;
+    cache.target_z = target_mob->z;
+    cache.time = now;
+    cache.result = check_clear_line(target_mob);
+    return cache.result;
 }
 
 
@@ -2710,6 +3023,35 @@ bool Mob::is_off_camera() const {
 }
 
 
+/**
+ * @brief Returns whether the mob's brain and script should only tick every
+ * few frames, because it's off-camera and far away from every leader.
+ * Mobs that are moving somewhere, focused on something, or dying always
+ * think every frame.
+ *
+ * @return Whether it's throttled.
+ */
+bool Mob::is_logic_throttled() const {
+    if(type->far_logic_distance <= 0.0f) return false;
+    if(
+        chase_info.state == CHASE_STATE_CHASING ||
+        circling_info || focused_mob ||
+        (health <= 0 && max_health != 0)
+    ) {
+        return false;
+    }
+    
+    for(size_t l = 0; l < game.states.gameplay->mobs.leaders.size(); l++) {
+        Leader* l_ptr = game.states.gameplay->mobs.leaders[l];
+        if(Distance(pos, l_ptr->pos) < type->far_logic_distance) {
+            return false;
+        }
+    }
+    
+    return is_off_camera();
+}
+
+
 /**
  * @brief Checks if the given point is on top of the mob.
  *
@@ -2769,15 +3111,7 @@ void Mob::leave_group() {
     
     Mob* group_leader = following_group;
     
-    group_leader->group->members.erase(
-        find(
-            group_leader->group->members.begin(),
-            group_leader->group->members.end(),
-            this
-        )
-    );
-    
-    group_leader->group->init_spots(this);
+    group_leader->group->remove_member(this);
     
     group_leader->group->change_standby_type_if_needed();
     
@@ -2970,6 +3304,7 @@ void Mob::release(Mob* m) {
 void Mob::release_chomped_pikmin() {
     for(size_t p = 0; p < chomping_mobs.size(); p++) {
         if(!chomping_mobs[p]) continue;
+        remove_first_in_vector(this, chomping_mobs[p]->chomped_by);
         release(chomping_mobs[p]);
     }
     chomping_mobs.clear();
@@ -2980,8 +3315,10 @@ void Mob::release_chomped_pikmin() {
  * @brief Releases any mobs stored inside.
  */
 void Mob::release_stored_mobs() {
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m_ptr = game.states.gameplay->mobs.all[m];
+    vector<Mob*> mobs_to_release;
+    mobs_to_release.swap(stored_mobs);
+    for(size_t m = 0; m < mobs_to_release.size(); m++) {
+        Mob* m_ptr = mobs_to_release[m];
         if(m_ptr->stored_inside_another == this) {
             release(m_ptr);
             m_ptr->stored_inside_another = nullptr;
@@ -2996,6 +3333,20 @@ void Mob::release_stored_mobs() {
 }
 
 
+/**
+ * @brief Saves the mob it has focus on in one of its focused mob
+ * memory slots.
+ *
+ * @param slot Memory slot to save in.
+ */
+void Mob::remember_focused_mob(size_t slot) {
+    Mob* &memory = focused_mob_memory[slot];
+    if(memory) remove_first_in_vector(this, memory->remembered_by);
+    memory = focused_mob;
+    if(memory) memory->remembered_by.push_back(this);
+}
+
+
 /**
  * @brief Removes all particle generators with the given ID.
  *
@@ -3017,7 +3368,7 @@ void Mob::remove_particle_generator(const MOB_PARTICLE_GENERATOR_ID id) {
  */
 void Mob::respawn() {
     pos = home;
-    center_sector = get_sector(pos, nullptr, true);
+    center_sector = get_sector_with_hint(pos, &center_triangle);
     ground_sector = center_sector;
     z = center_sector->z + 100;
 }
@@ -3076,6 +3427,7 @@ void Mob::set_animation(
     }
     
     Animation* new_anim = anim.anim_db->animations[final_idx];
+    anim.stop_following_shared_clock();
     anim.cur_anim = new_anim;
     this->mob_speed_anim_baseline = mob_speed_anim_baseline;
     
@@ -3156,7 +3508,18 @@ void Mob::set_health(bool add, bool ratio, float amount) {
     float base_nr = 0;
     if(add) base_nr = health;
     
+    float old_health = health;
     health = std::clamp(base_nr + change, 0.0f, max_health);
+    
+    if(
+        health != old_health &&
+        type->category->id == MOB_CATEGORY_LEADERS
+    ) {
+        enable_flag(
+            game.states.gameplay->changed_mission_counters,
+            MISSION_COUNTER_LEADERS
+        );
+    }
 }
 
 
@@ -3194,6 +3557,21 @@ void Mob::set_rectangular_dim(const Point &rectangular_dim) {
 }
 
 
+/**
+ * @brief Changes the mob's subgroup type, keeping the group it's following
+ * up to date.
+ *
+ * @param new_type The new subgroup type.
+ */
+void Mob::set_subgroup_type(SubgroupType* new_type) {
+    if(new_type == subgroup_type_ptr) return;
+    if(following_group && following_group->group) {
+        following_group->group->change_member_subgroup_type(this, new_type);
+    }
+    subgroup_type_ptr = new_type;
+}
+
+
 /**
  * @brief Changes the timer's time and interval.
  *
@@ -3212,7 +3590,7 @@ void Mob::set_timer(float time) {
  * @param value The variable's new value.
  */
 void Mob::set_var(const string &name, const string &value) {
-    vars[name] = value;
+    get_var(name).set_text(value);
 }
 
 
@@ -3220,14 +3598,14 @@ void Mob::set_var(const string &name, const string &value) {
  * @brief Makes the current mob spawn a new mob, given some spawn information.
  *
  * @param info Structure with information about how to spawn it.
- * @param type_ptr If nullptr, the pointer to the mob type is obtained given its
- * name in the information structure. If not nullptr, uses this instead.
+ * @param type_ptr If nullptr, the pointer to the mob type is obtained from
+ * the information structure. If not nullptr, uses this instead.
  * @return The new mob.
  */
 Mob* Mob::spawn(const MobType::SpawnInfo* info, MobType* type_ptr) {
     //First, find the mob.
     if(!type_ptr) {
-        type_ptr = game.mob_categories.find_mob_type(info->mob_type_name);
+        type_ptr = info->mob_type;
     }
     
     if(!type_ptr) {
@@ -3273,7 +3651,7 @@ Mob* Mob::spawn(const MobType::SpawnInfo* info, MobType* type_ptr) {
             new_xy,
             type_ptr,
             new_angle,
-            info->vars
+            info->vars_map
         );
         
     new_mob->z = new_z;
@@ -3287,10 +3665,10 @@ Mob* Mob::spawn(const MobType::SpawnInfo* info, MobType* type_ptr) {
     }
     
     if(info->link_object_to_spawn) {
-        links.push_back(new_mob);
+        add_link(new_mob);
     }
     if(info->link_spawn_to_object) {
-        new_mob->links.push_back(this);
+        new_mob->add_link(this);
     }
     if(info->momentum != 0) {
         float a = game.rng.f(0, TAU);
@@ -3404,6 +3782,7 @@ void Mob::stop_following_path() {
     
     delete path_info;
     path_info = nullptr;
+    remove_first_in_vector(this, game.states.gameplay->mobs.path_followers);
 }
 
 
@@ -3482,6 +3861,7 @@ void Mob::store_mob_inside(Mob* m) {
         false, HOLD_ROTATION_METHOD_NEVER
     );
     m->stored_inside_another = this;
+    stored_mobs.push_back(m);
 }
 
 
@@ -3536,6 +3916,7 @@ void Mob::swallow_chomped_pikmin(Mob* m_ptr) {
     }
     
     chomping_mobs.erase(chomping_mobs.begin() + idx);
+    remove_first_in_vector(this, m_ptr->chomped_by);
     
 }
 
@@ -3561,63 +3942,75 @@ void Mob::tick(float delta_t) {
     
     if(to_delete) return;
     
-    //Brain.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Brain");
+    //Far away mobs only think every few frames, with all of the time that
+    //passed in the meantime. Physics and animation still run every frame.
+    far_logic_delta_t += delta_t;
+    bool ticks_logic = true;
+    if(is_logic_throttled()) {
+        far_logic_frames++;
+        ticks_logic =
+            (far_logic_frames + id) % type->far_logic_interval == 0;
     }
-    tick_brain(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    float logic_delta_t = far_logic_delta_t;
+    if(ticks_logic) far_logic_delta_t = 0.0f;
+    
+    //Brain.
+    if(ticks_logic) {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_BRAIN,
+            id, &type->name
+        );
+        tick_brain(logic_delta_t);
     }
     if(to_delete) return;
     
     //Physics.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Physics");
-    }
-    tick_physics(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_PHYSICS,
+            id, &type->name
+        );
+        tick_physics(delta_t);
     }
     if(to_delete) return;
     
     //Misc. logic.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Misc. logic");
-    }
-    tick_misc_logic(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_MISC_LOGIC,
+            id, &type->name
+        );
+        tick_misc_logic(delta_t);
     }
     if(to_delete) return;
     
     //Animation.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Animation");
-    }
-    tick_animation(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_ANIMATION,
+            id, &type->name
+        );
+        tick_animation(delta_t);
     }
     if(to_delete) return;
     
     //Script.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Script");
-    }
-    tick_script(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    if(ticks_logic) {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_SCRIPT,
+            id, &type->name
+        );
+        tick_script(logic_delta_t);
     }
     if(to_delete) return;
     
     //Class specifics.
-    if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object -- Misc. specifics");
-    }
-    tick_class_specifics(delta_t);
-    if(game.perf_mon) {
-        game.perf_mon->finish_measurement();
+    {
+        PerformanceMonitorScope perf_mon_scope(
+            game.perf_mon, PERF_MON_MEASUREMENT_OBJECT_MISC_SPECIFICS,
+            id, &type->name
+        );
+        tick_class_specifics(delta_t);
     }
 }
 
@@ -3628,39 +4021,54 @@ void Mob::tick(float delta_t) {
  * @param delta_t How long the frame's tick is, in seconds.
  */
 void Mob::tick_animation(float delta_t) {
-    float mult = 1.0f;
-    for(size_t s = 0; s < this->statuses.size(); s++) {
-        float vuln_mult = this->statuses[s].type->anim_speed_multiplier - 1.0f;
-        auto vuln_it = type->status_vulnerabilities.find(statuses[s].type);
-        if(vuln_it != type->status_vulnerabilities.end()) {
-            vuln_mult *= vuln_it->second.effect_mult;
+    //Plain loops follow the area's clock, so that crowds of idling mobs
+    //don't need to be ticked at all. Drawing works out their frame.
+    if(anim.shared_clock) {
+        if(!can_follow_shared_anim_clock()) {
+            anim.stop_following_shared_clock();
         }
-        mult *= (vuln_mult + 1.0f);
+    } else if(can_follow_shared_anim_clock()) {
+        anim.start_following_shared_clock(
+            &game.states.gameplay->area_time_passed
+        );
     }
     
-    if(mob_speed_anim_baseline != 0.0f) {
-        float mob_speed_mult = chase_info.cur_speed / mob_speed_anim_baseline;
-        mob_speed_mult =
-            std::clamp(
-                mob_speed_mult,
-                MOB::MOB_SPEED_ANIM_MIN_MULT, MOB::MOB_SPEED_ANIM_MAX_MULT
+    AnimTickResult &result = anim_tick_result;
+    if(anim.shared_clock) {
+        result.finished = false;
+        result.signals.clear();
+        result.sounds.clear();
+    } else if(
+        result.pending &&
+        anim.cur_anim == result.anim &&
+        anim.cur_frame_idx == result.start_frame_idx &&
+        anim.cur_frame_time == result.start_frame_time &&
+        get_anim_speed_mult() == result.speed_mult
+    ) {
+        //Advancing it now would give the same result as ahead of time.
+        anim.cur_frame_idx = result.frame_idx;
+        anim.cur_frame_time = result.frame_time;
+    } else {
+        //It wasn't advanced ahead of time, or something changed the
+        //animation or its speed since then, so advance it now.
+        result.signals.clear();
+        result.sounds.clear();
+        result.finished =
+            anim.tick(
+                delta_t * get_anim_speed_mult(),
+                &result.signals, &result.sounds
             );
-        mult *= mob_speed_mult;
     }
+    result.pending = false;
     
-    vector<size_t> frame_signals;
-    vector<size_t> frame_sounds;
-    bool finished_anim =
-        anim.tick(delta_t* mult, &frame_signals, &frame_sounds);
-        
-    if(finished_anim) {
+    if(result.finished) {
         fsm.run_event(MOB_EV_ANIMATION_END);
     }
-    for(size_t s = 0; s < frame_signals.size(); s++) {
-        fsm.run_event(MOB_EV_FRAME_SIGNAL, &frame_signals[s]);
+    for(size_t s = 0; s < result.signals.size(); s++) {
+        fsm.run_event(MOB_EV_FRAME_SIGNAL, &result.signals[s]);
     }
-    for(size_t s = 0; s < frame_sounds.size(); s++) {
-        play_sound(frame_sounds[s]);
+    for(size_t s = 0; s < result.sounds.size(); s++) {
+        play_sound(result.sounds[s]);
     }
     
     for(size_t h = 0; h < hit_opponents.size();) {
@@ -3673,7 +4081,7 @@ void Mob::tick_animation(float delta_t) {
     }
     
     if(parent && parent->limb_anim.anim_db) {
-        parent->limb_anim.tick(delta_t* mult);
+        parent->limb_anim.tick(delta_t * get_anim_speed_mult());
     }
 }
 
@@ -3851,11 +4259,7 @@ void Mob::tick_misc_logic(float delta_t) {
     for(size_t s = 0; s < this->statuses.size(); s++) {
         statuses[s].tick(delta_t);
         
-        float damage_mult = 1.0f;
-        auto vuln_it = type->status_vulnerabilities.find(statuses[s].type);
-        if(vuln_it != type->status_vulnerabilities.end()) {
-            damage_mult = vuln_it->second.effect_mult;
-        }
+        float damage_mult = statuses[s].vuln_mult;
         
         float health_before = health;
         
@@ -3881,7 +4285,10 @@ void Mob::tick_misc_logic(float delta_t) {
             }
         }
     }
-    delete_old_status_effects();
+    if(!statuses.empty()) {
+        //Most mobs have none, and there's nothing to clean up for them.
+        delete_old_status_effects();
+    }
     
     for(size_t g = 0; g < particle_generators.size();) {
         particle_generators[g].tick(
@@ -3911,7 +4318,10 @@ void Mob::tick_misc_logic(float delta_t) {
         health > 0.0f &&
         health < max_health;
     if(!health_wheel && should_show_health) {
-        health_wheel = new InWorldHealthWheel(this);
+        health_wheel =
+            game.states.gameplay->in_world_hud_pool.acquire_health_wheel(
+                this
+            );
     } else if(health_wheel && !should_show_health) {
         health_wheel->start_fading();
     }
@@ -3919,7 +4329,9 @@ void Mob::tick_misc_logic(float delta_t) {
     if(health_wheel) {
         health_wheel->tick(delta_t);
         if(health_wheel->to_delete) {
-            delete health_wheel;
+            game.states.gameplay->in_world_hud_pool.release_health_wheel(
+                health_wheel
+            );
             health_wheel = nullptr;
         }
     }
@@ -3934,7 +4346,8 @@ void Mob::tick_misc_logic(float delta_t) {
         );
         
     if(!fraction && should_show_fraction) {
-        fraction = new InWorldFraction(this);
+        fraction =
+            game.states.gameplay->in_world_hud_pool.acquire_fraction(this);
     } else if(fraction && !should_show_fraction) {
         fraction->start_fading();
     }
@@ -3949,7 +4362,7 @@ void Mob::tick_misc_logic(float delta_t) {
             fraction->set_requirement_number(fraction_req_nr);
         }
         if(fraction->to_delete) {
-            delete fraction;
+            game.states.gameplay->in_world_hud_pool.release_fraction(fraction);
             fraction = nullptr;
         }
     }
@@ -4062,7 +4475,14 @@ void Mob::tick_misc_logic(float delta_t) {
             //reassign the spots so Pikmin don't have to keep their order from
             //before.
             group->reassign_spots();
+            
+        } else if(group->mode == Group::MODE_SHUFFLE) {
+            //Keep untangling the group little by little.
+            group->refine_spots(MOB::GROUP_SPOT_REFINE_CHECKS);
+            
         }
+        
+        group->update_spot_positions();
     }
     
     //Damage squash stuff.
@@ -4089,14 +4509,13 @@ void Mob::tick_misc_logic(float delta_t) {
 void Mob::tick_script(float delta_t) {
     if(!fsm.cur_state) return;
     
-    //Timer events.
-    MobEvent* timer_ev = fsm.get_event(MOB_EV_TIMER);
-    if(script_timer.duration > 0) {
-        if(script_timer.time_left > 0) {
-            script_timer.tick(delta_t);
-            if(script_timer.time_left == 0.0f && timer_ev) {
-                timer_ev->run(this);
-            }
+    //Timer events. The state's event only needs to be looked up
+    //on the frame the timer actually runs out.
+    if(script_timer.duration > 0 && script_timer.time_left > 0) {
+        script_timer.tick(delta_t);
+        if(script_timer.time_left == 0.0f) {
+            MobEvent* timer_ev = fsm.get_event(MOB_EV_TIMER);
+            if(timer_ev) timer_ev->run(this);
         }
     }
     
@@ -4156,36 +4575,6 @@ void Mob::tick_script(float delta_t) {
         set_health(true, false, type->health_regen * delta_t);
     }
     
-    //Check if it got whistled.
-    if(
-        game.states.gameplay->cur_leader_ptr &&
-        game.states.gameplay->whistle.whistling &&
-        Distance(pos, game.states.gameplay->whistle.center) <=
-        game.states.gameplay->whistle.radius
-    ) {
-        fsm.run_event(
-            MOB_EV_WHISTLED, (void*) game.states.gameplay->cur_leader_ptr
-        );
-        
-        bool saved_by_whistle = false;
-        for(size_t s = 0; s < statuses.size(); s++) {
-            if(statuses[s].type->removable_with_whistle) {
-                statuses[s].to_delete = true;
-                if(
-                    statuses[s].type->health_change < 0.0f ||
-                    statuses[s].type->health_change_ratio < 0.0f
-                ) {
-                    saved_by_whistle = true;
-                }
-            }
-        }
-        delete_old_status_effects();
-        
-        if(saved_by_whistle && type->category->id == MOB_CATEGORY_PIKMIN) {
-            game.statistics.pikmin_saved++;
-        }
-    }
-    
     //Following a leader.
     if(following_group) {
         MobEvent* spot_far_ev =  fsm.get_event(MOB_EV_SPOT_IS_FAR);
@@ -4286,10 +4675,27 @@ bool Mob::tick_track_ride() {
  * @brief Makes the mob lose focus on its currently focused mob.
  */
 void Mob::unfocus_from_mob() {
+    if(focused_mob) {
+        remove_first_in_vector(this, focused_mob->focused_by);
+    }
     focused_mob = nullptr;
 }
 
 
+/**
+ * @brief Recalculates how much the status effects multiply the
+ * animation speed by. This needs to be called whenever they change.
+ */
+void Mob::update_status_anim_speed_mult() {
+    status_anim_speed_mult = 1.0f;
+    for(size_t s = 0; s < statuses.size(); s++) {
+        float vuln_mult = statuses[s].type->anim_speed_multiplier - 1.0f;
+        vuln_mult *= statuses[s].vuln_mult;
+        status_anim_speed_mult *= (vuln_mult + 1.0f);
+    }
+}
+
+
 /**
  * @brief Returns the index of an animation, given a base animation index and
  * group index.
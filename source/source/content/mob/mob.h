@@ -47,6 +47,8 @@ extern const float CARRY_SWAY_TIME_MULT;
 extern const float CARRY_SWAY_X_TRANSLATION_AMOUNT;
 extern const float CARRY_SWAY_Y_TRANSLATION_AMOUNT;
 extern const float CARRY_SWAY_ROTATION_AMOUNT;
+extern const float CLEAR_LINE_CACHE_DURATION;
+extern const float CLEAR_LINE_CACHE_MOVE_THRESHOLD;
 extern const float DELIVERY_SUCK_SHAKING_TIME_MULT;
 extern const float DELIVERY_SUCK_SHAKING_MULT;
 extern const float DELIVERY_SUCK_TIME;
@@ -61,13 +63,16 @@ extern const float GRAVITY_ADDER;
 extern const float GROUP_SHUFFLE_DIST;
 extern const float GROUP_SPOT_INTERVAL;
 extern const float GROUP_SPOT_MAX_DEVIATION;
+extern const size_t GROUP_SPOT_REFINE_CHECKS;
 extern const float HEIGHT_EFFECT_FACTOR;
 extern const float KNOCKBACK_H_POWER;
 extern const float KNOCKBACK_V_POWER;
+extern const size_t MIN_ANIM_TICK_JOB_SIZE;
 extern const float MOB_SPEED_ANIM_MAX_MULT;
 extern const float MOB_SPEED_ANIM_MIN_MULT;
 extern const float OPPONENT_HIT_REGISTER_TIMEOUT;
 extern const float PIKMIN_NEST_CALL_INTERVAL;
+extern const size_t POOL_BLOCK_SIZE;
 extern const float PUSH_EXTRA_AMOUNT;
 extern const float PUSH_SOFTLY_AMOUNT;
 extern const float PUSH_THROTTLE_FACTOR;
@@ -114,12 +119,23 @@ public:
     //Current facing angle. 0 = right, PI / 2 = up, etc.
     float angle = 0.0f;
     
+    //Coordinates before the latest gameplay logic step. Drawing goes
+    //smoothly from these to the current ones.
+    Point prev_step_pos;
+    
+    //Z coordinate before the latest gameplay logic step.
+    float prev_step_z = 0.0f;
+    
     //The highest ground below the entire mob.
     Sector* ground_sector = nullptr;
     
     //Sector that the mob's center is on.
     Sector* center_sector = nullptr;
     
+    //Blockmap triangle that the mob's center was last found in, if any.
+    //Checked first when the sector is looked up again. Cache for performance.
+    const BlockmapTriangle* center_triangle = nullptr;
+    
     //Mob this mob is standing on top of, if any.
     Mob* standing_on_mob = nullptr;
     
@@ -190,8 +206,12 @@ public:
     //The script-controlled timer.
     Timer script_timer;
     
-    //Variables.
-    map<string, string> vars;
+    //Variables, indexed by their slot in the type's script variable table.
+    vector<ScriptVarValue> vars;
+    
+    //Variables whose names aren't in the type's table, like ones whose
+    //name a script only works out during gameplay.
+    map<string, ScriptVarValue> extra_vars;
     
     //-Brain and behavior-
     
@@ -245,6 +265,10 @@ public:
     //Status effects currently inflicted on the mob.
     vector<Status> statuses;
     
+    //How much the status effects multiply the animation speed by, with
+    //vulnerabilities already in. Updated whenever the statuses change.
+    float status_anim_speed_mult = 1.0f;
+    
     //Hazard of the sector the mob is currently on.
     Hazard* on_hazard = nullptr;
     
@@ -280,6 +304,29 @@ public:
     //Mob's team (who it can damage).
     MOB_TEAM team = MOB_TEAM_NONE;
     
+    //-Back-references-
+    
+    //Mobs that have it as their focused mob.
+    vector<Mob*> focused_by;
+    
+    //Mobs that have it in their focused mob memory, once per memory slot.
+    vector<Mob*> remembered_by;
+    
+    //Mobs that are linked to it, once per link.
+    vector<Mob*> linked_by;
+    
+    //Mobs that are chomping it, once per chomp.
+    vector<Mob*> chomped_by;
+    
+    //Mobs that are stored inside of it.
+    vector<Mob*> stored_mobs;
+    
+    //Mobs that are standing on top of it.
+    vector<Mob*> riders;
+    
+    //Mobs that are its children, i.e. have it as their parent.
+    vector<Mob*> child_mobs;
+    
     //-Group-
     
     //The current mob is following this mob's group.
@@ -306,6 +353,9 @@ public:
     //mob's speed, using this value as a baseline (1.0x speed).
     float mob_speed_anim_baseline = 0.0f;
     
+    //Animation advanced ahead of time, waiting to be used in the tick.
+    AnimTickResult anim_tick_result;
+    
     //-Aesthetic-
     
     //If not LARGE_FLOAT, compare the Z with this to shrink/grow the sprite.
@@ -346,13 +396,62 @@ public:
     //Whether it's active this frame. Cache for performance.
     bool is_active = false;
     
+    //Whether other mobs can interact with it this frame, even if they've
+    //been around for a while. Cache for performance.
+    bool accepts_interactions = false;
+    
+    //Time that has passed since its brain and script last ticked.
+    //Only builds up while it's far away and thinking at a reduced rate.
+    float far_logic_delta_t = 0.0f;
+    
+    //How many frames it has spent thinking at a reduced rate.
+    size_t far_logic_frames = 0;
+    
+    //Area cells this mob is keeping active, if any: first and last column,
+    //then first and last row, all inclusive. None if the last column comes
+    //before the first. Cache for performance.
+    int active_cells[4] = { 0, -1, 0, -1 };
+    
+    //Edges found when checking movement collisions. This is kept from
+    //frame to frame so no memory needs to be allocated. Cache for performance.
+    vector<Edge*> movement_edges_buffer;
+    
+    //Result of the last clear line check. Cache for performance.
+    mutable ClearLineCache clear_line_cache;
+    
+    //World coordinates of the current sprite's hitboxes, in the same order.
+    //Cache for performance. Use get_world_hitboxes to get these.
+    vector<WorldHitbox> world_hitboxes;
+    
+    //World coordinates of the current sprite's hitbox bounds.
+    //Cache for performance. Updated alongside world_hitboxes.
+    WorldHitbox world_hitbox_bounds;
+    
+    //Sprite that the world hitboxes were last calculated for.
+    Sprite* world_hitboxes_sprite = nullptr;
+    
+    //Position that the world hitboxes were last calculated for.
+    Point world_hitboxes_pos;
+    
+    //Z that the world hitboxes were last calculated for.
+    float world_hitboxes_z = 0.0f;
+    
+    //Angle cosine that the world hitboxes were last calculated for.
+    float world_hitboxes_angle_cos = 0.0f;
+    
+    //Angle sine that the world hitboxes were last calculated for.
+    float world_hitboxes_angle_sin = 0.0f;
+    
     
     //--- Function declarations ---
     
     Mob(const Point &pos, MobType* type, float angle);
     virtual ~Mob();
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
     
     void tick(float delta_t);
+    void advance_animation(float delta_t);
     void draw_limb();
     virtual void draw_mob();
     
@@ -370,8 +469,11 @@ public:
     void set_health(bool add, bool ratio, float amount);
     void set_timer(float time);
     void set_var(const string &name, const string &value);
+    ScriptVarValue &get_var(const string &name);
+    ScriptVarValue &get_var_by_slot(size_t slot);
     void set_radius(float radius);
     void set_rectangular_dim(const Point &rectangular_dim);
+    void set_subgroup_type(SubgroupType* new_type);
     void set_can_block_paths(bool blocks);
     
     void become_carriable(const CARRY_DESTINATION destination);
@@ -380,6 +482,7 @@ public:
     void apply_attack_damage(
         Mob* attacker, Hitbox* attack_h, Hitbox* victim_h, float damage
     );
+    void add_link(Mob* m);
     void add_to_group(Mob* new_member);
     void apply_knockback(float knockback, float knockback_angle);
     bool calculate_carrying_destination(
@@ -415,8 +518,10 @@ public:
     );
     bool is_stored_inside_mob() const;
     bool is_off_camera() const;
+    bool is_logic_throttled() const;
     bool is_point_on(const Point &p) const;
     void focus_on_mob(Mob* m);
+    void remember_focused_mob(size_t slot);
     void unfocus_from_mob();
     void leave_group();
     void hold(
@@ -446,10 +551,12 @@ public:
     void start_dying();
     void finish_dying();
     void respawn();
+    void handle_whistle(Mob* whistler);
     Distance get_distance_between(
         const Mob* m2_ptr, const Distance* regular_distance_cache = nullptr
     ) const;
     Hitbox* get_hitbox(size_t idx) const;
+    const vector<WorldHitbox> &get_world_hitboxes(Sprite* s_ptr);
     Hitbox* get_closest_hitbox(
         const Point &p, size_t h_type = INVALID, Distance* d = nullptr
     ) const;
@@ -484,6 +591,7 @@ public:
         float new_angle, Point* new_pos, bool instantly = false
     );
     Point get_chase_target(float* out_z = nullptr) const;
+    float get_anim_speed_mult() const;
     virtual float get_base_speed() const;
     float get_speed_multiplier() const;
     
@@ -532,6 +640,9 @@ protected:
     
     //--- Function declarations ---
     
+    static BlockPool* get_mem_pool(size_t size);
+    bool can_follow_shared_anim_clock() const;
+    bool check_clear_line(const Mob* target_mob) const;
     PikminType* decide_carry_pikmin_type(
         const unordered_set<PikminType*> &available_types,
         Mob* added, Mob* removed
@@ -547,6 +658,8 @@ protected:
         const Edge* e_ptr, unsigned char wall_sector, float move_angle,
         float* slide_angle
     ) const;
+    float get_wall_sweep_ratio(const Point &new_pos);
+    bool is_resting_on_ground() const;
     void move_to_path_end(float speed, float acceleration);
     void tick_animation(float delta_t);
     void tick_brain(float delta_t);
@@ -565,6 +678,7 @@ protected:
         bool was_teleport = false
     );
     void tick_walkable_riding_physics(float delta_t);
+    void update_status_anim_speed_mult();
     virtual void tick_class_specifics(float delta_t);
     
 };
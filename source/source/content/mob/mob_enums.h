@@ -229,6 +229,30 @@ enum MOB_FLAG {
 };
 
 
+//Kinds of mobs that Pikmin and leaders look for, each with its own index.
+enum MOB_TASK_INDEX {
+
+    //Mobs that can be carried, and have room for more carriers.
+    MOB_TASK_INDEX_CARRIABLES,
+    
+    //Tools.
+    MOB_TASK_INDEX_TOOLS,
+    
+    //Group tasks that aren't done.
+    MOB_TASK_INDEX_GROUP_TASKS,
+    
+    //Mobs that can take part in combat.
+    MOB_TASK_INDEX_ATTACKABLES,
+    
+    //Pikmin sprouts.
+    MOB_TASK_INDEX_SPROUTS,
+    
+    //Total amount of mob task indexes.
+    N_MOB_TASK_INDEXES,
+    
+};
+
+
 //Flags for the types of target a mob can be.
 enum MOB_TARGET_FLAG {
 
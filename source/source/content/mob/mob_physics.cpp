@@ -17,7 +17,7 @@
 #include "../../util/general_utils.h"
 
 
-using std::set;
+using std::vector;
 
 
 /**
@@ -100,6 +100,7 @@ Mob* Mob::get_mob_to_walk_on() const {
  *
  * @param new_pos Position to check.
  * @param intersecting_edges List of edges it is intersecting with.
+ * Any previous contents are discarded.
  * @return H_MOVE_RESULT_OK if everything is okay, H_MOVE_RESULT_FAIL if movement is
  * impossible.
  */
@@ -110,7 +111,8 @@ H_MOVE_RESULT Mob::get_movement_edge_intersections(
     //the edges in the same blocks the mob is on.
     //This way, we won't check for edges that are really far away.
     //Use the bounding box to know which blockmap blocks the mob will be on.
-    set<Edge*> candidate_edges;
+    //The candidates are placed right in the output vector, and the ones that
+    //don't count are removed from it, so no other vector is needed.
     //Use the terrain radius if the mob is moving about and alive.
     //Otherwise if it's a corpse, it can use the regular radius.
     float radius_to_use =
@@ -118,11 +120,11 @@ H_MOVE_RESULT Mob::get_movement_edge_intersections(
         radius :
         type->terrain_radius;
         
+    //The blockmap already throws away the edges that can't be walls at the
+    //mob's Z, using heights worked out when the area got loaded.
     if(
-        !game.cur_area_data->bmap.get_edges_in_region(
-            new_pos - radius_to_use,
-            new_pos + radius_to_use,
-            candidate_edges
+        !game.cur_area_data->bmap.get_wall_edges_near_circle(
+            new_pos, radius_to_use, z, *intersecting_edges
         )
     ) {
         //Somehow out of bounds. No movement.
@@ -130,9 +132,10 @@ H_MOVE_RESULT Mob::get_movement_edge_intersections(
     }
     
     //Go through each edge, and figure out if it is a valid wall for our mob.
-    for(auto &e_ptr : candidate_edges) {
+    size_t n_intersecting_edges = 0;
+    for(size_t e = 0; e < intersecting_edges->size(); e++) {
     
-        bool is_edge_blocking = false;
+        Edge* e_ptr = (*intersecting_edges)[e];
         
         if(
             !circle_intersects_line_seg(
@@ -151,53 +154,13 @@ H_MOVE_RESULT Mob::get_movement_edge_intersections(
             return H_MOVE_RESULT_FAIL;
         }
         
-        for(unsigned char s = 0; s < 2; s++) {
-            if(e_ptr->sectors[s]->type == SECTOR_TYPE_BLOCKING) {
-                is_edge_blocking = true;
-                break;
-            }
-        }
-        
-        if(!is_edge_blocking) {
-            if(e_ptr->sectors[0]->z == e_ptr->sectors[1]->z) {
-                //No difference in floor height = no wall.
-                //Ignore this.
-                continue;
-            }
-            if(
-                e_ptr->sectors[0]->z < z &&
-                e_ptr->sectors[1]->z < z
-            ) {
-                //An edge whose sectors are below the mob?
-                //No collision here.
-                continue;
-            }
-        }
-        
-        if(
-            e_ptr->sectors[0]->z > z &&
-            e_ptr->sectors[1]->z > z
-        ) {
-            //If both floors of this edge are above the mob...
-            //then what does that mean? That the mob is under the ground?
-            //Nonsense! Throw this edge away!
-            //It's a false positive, and it's likely behind a more logical
-            //edge that we actually did collide against.
-            continue;
-        }
-        
-        if(
-            e_ptr->sectors[0]->type == SECTOR_TYPE_BLOCKING &&
-            e_ptr->sectors[1]->type == SECTOR_TYPE_BLOCKING
-        ) {
-            //Same logic as the previous check.
-            continue;
-        }
-        
-        //Add this edge to the list of intersections, then.
-        intersecting_edges->push_back(e_ptr);
+        //Keep this edge in the list of intersections, then.
+        (*intersecting_edges)[n_intersecting_edges] = e_ptr;
+        n_intersecting_edges++;
     }
     
+    intersecting_edges->resize(n_intersecting_edges);
+    
     return H_MOVE_RESULT_OK;
 }
 
@@ -230,7 +193,7 @@ H_MOVE_RESULT Mob::get_physics_horizontal_movement(
         if(has_flag(chase_info.flags, CHASE_FLAG_TELEPORT)) {
         
             Sector* sec =
-                get_sector(final_target_pos, nullptr, true);
+                get_sector_with_hint(final_target_pos, &center_triangle);
                 
             if(!sec) {
                 //No sector, invalid teleport. No move.
@@ -374,6 +337,109 @@ H_MOVE_RESULT Mob::get_wall_slide_angle(
 }
 
 
+/**
+ * @brief Checks if the mob would go right through a wall when moving to a
+ * new spot, without ever touching it at the start or the end. This can only
+ * happen if the mob moves more than its radius in one go, like when it
+ * got thrown or knocked back hard.
+ *
+ * @param new_pos Position to move to.
+ * @return How much of the movement to do, from 0 to 1, so that the mob
+ * ends up inside the first wall in the way, instead of past it. That way,
+ * the usual wall checks can make it slide on it. 1 if there's no such wall.
+ */
+float Mob::get_wall_sweep_ratio(const Point &new_pos) {
+    //Same radius as get_movement_edge_intersections.
+    float radius_to_use =
+        (type->terrain_radius < 0 || health <= 0) ?
+        radius :
+        type->terrain_radius;
+    Distance move_dist(pos, new_pos);
+    if(move_dist <= radius_to_use) return 1.0f;
+    
+    Point tl = pos;
+    Point br = pos;
+    update_min_max_coords(tl, br, new_pos);
+    vector<Edge*> &candidate_edges = movement_edges_buffer;
+    if(
+        !game.cur_area_data->bmap.get_edges_in_region(
+            tl - radius_to_use, br + radius_to_use, z, z + height,
+            candidate_edges
+        )
+    ) {
+        //Out of bounds. The usual checks will take care of it.
+        return 1.0f;
+    }
+    
+    float step_height =
+        has_flag(flags, MOB_FLAG_WAS_THROWN) ? 0.0f : GEOMETRY::STEP_HEIGHT;
+    float best_ratio = 1.0f;
+    
+    for(size_t e = 0; e < candidate_edges.size(); e++) {
+        Edge* e_ptr = candidate_edges[e];
+        
+        bool is_wall = !e_ptr->sectors[0] || !e_ptr->sectors[1];
+        for(unsigned char s = 0; s < 2 && !is_wall; s++) {
+            if(
+                e_ptr->sectors[s]->type == SECTOR_TYPE_BLOCKING ||
+                e_ptr->sectors[s]->z > z + step_height
+            ) {
+                is_wall = true;
+            }
+        }
+        if(!is_wall) continue;
+        
+        Point v1 = v2p(e_ptr->vertexes[0]);
+        Point v2 = v2p(e_ptr->vertexes[1]);
+        float ratio =
+            get_circle_sweep_line_seg_ratio(
+                pos, new_pos, radius_to_use, v1, v2
+            );
+        if(ratio == 0.0f || ratio >= best_ratio) {
+            //Either it's already touching the wall, which the usual checks
+            //take care of, or this isn't the first wall in the way.
+            continue;
+        }
+        if(circle_intersects_line_seg(new_pos, radius_to_use, v1, v2)) {
+            //The usual checks will catch this one at the end spot.
+            continue;
+        }
+        
+        //Go half a radius into the wall, so it's caught by the usual checks.
+        best_ratio =
+            std::min(
+                best_ratio,
+                ratio + radius_to_use / 2.0f / move_dist.to_float()
+            );
+    }
+    
+    return best_ratio;
+}
+
+
+/**
+ * @brief Returns whether the mob is resting on stable ground, such that the
+ * movement physics wouldn't change anything about it if it doesn't get
+ * any horizontal movement. This is the case for treasures waiting to be
+ * carried, sleeping enemies, Pikmin standing around, etc.
+ *
+ * @return Whether it's resting.
+ */
+bool Mob::is_resting_on_ground() const {
+    if(speed_z != 0.0f || z != ground_sector->z) return false;
+    if(gravity_mult < 0.0f) return false;
+    if(standing_on_mob || holder.m || on_hazard) return false;
+    if(chase_info.state == CHASE_STATE_CHASING) return false;
+    
+    //These make the vertical movement logic send events every frame.
+    if(ground_sector->is_bottomless_pit) return false;
+    if(!ground_sector->hazards.empty()) return false;
+    if(fsm.get_event(MOB_EV_LANDED)) return false;
+    
+    return true;
+}
+
+
 /**
  * @brief Ticks physics logic regarding the mob's horizontal movement.
  *
@@ -397,6 +463,10 @@ void Mob::tick_horizontal_movement_physics(
     Point new_pos = pos;
     Point move_speed = attempted_move_speed;
     
+    //If the mob is going fast enough to skip over a wall entirely,
+    //cut the movement short so that it hits the wall instead.
+    move_speed *= get_wall_sweep_ratio(pos + attempted_move_speed * delta_t);
+    
     //Try placing it in the place it should be at, judging
     //from the movement speed.
     while(!finished_moving) {
@@ -414,7 +484,8 @@ void Mob::tick_horizontal_movement_physics(
         float new_z = z;
         
         //Get the sector the mob will be on.
-        Sector* new_center_sector = get_sector(new_pos, nullptr, true);
+        Sector* new_center_sector =
+            get_sector_with_hint(new_pos, &center_triangle);
         Sector* new_ground_sector = new_center_sector;
         Sector* step_sector = new_center_sector;
         
@@ -427,7 +498,7 @@ void Mob::tick_horizontal_movement_physics(
             return;
         }
         //Get all edges it collides against in this new position.
-        vector<Edge*> intersecting_edges;
+        vector<Edge*> &intersecting_edges = movement_edges_buffer;
         if(
             get_movement_edge_intersections(new_pos, &intersecting_edges) ==
             H_MOVE_RESULT_FAIL
@@ -616,6 +687,19 @@ void Mob::tick_physics(float delta_t) {
     H_MOVE_RESULT h_mov_type =
         get_physics_horizontal_movement(delta_t, move_speed_mult, &move_speed);
         
+    //If it's resting on the ground and nothing's moving it, the movement
+    //logic can sleep until it gets speed, a push, or something to stand on.
+    if(
+        h_mov_type == H_MOVE_RESULT_OK &&
+        move_speed.x == 0.0f && move_speed.y == 0.0f &&
+        is_resting_on_ground()
+    ) {
+        if(type->can_walk_on_others) tick_walkable_riding_physics(delta_t);
+        push_amount = 0;
+        if(type->walkable) walkable_moved = Point();
+        return;
+    }
+    
     switch (h_mov_type) {
     case H_MOVE_RESULT_FAIL: {
         return;
@@ -875,9 +959,11 @@ void Mob::tick_walkable_riding_physics(float delta_t) {
     if(new_standing_on_mob != standing_on_mob) {
         if(standing_on_mob) {
             rider_removed_ev_mob = standing_on_mob;
+            remove_first_in_vector(this, standing_on_mob->riders);
         }
         if(new_standing_on_mob) {
             rider_added_ev_mob = new_standing_on_mob;
+            new_standing_on_mob->riders.push_back(this);
         }
     }
     
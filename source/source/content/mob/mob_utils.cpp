@@ -16,7 +16,9 @@
 #include "../../core/misc_functions.h"
 #include "../../core/game.h"
 #include "../../util/general_utils.h"
+#include "../../util/simd_utils.h"
 #include "../../util/string_utils.h"
+#include "../mob_script/leader_fsm.h"
 #include "../other/mob_script_action.h"
 #include "mob.h"
 
@@ -64,6 +66,26 @@ CarryInfo::CarryInfo(
         }
         spot_info.push_back(CarrierSpot(p));
     }
+    cur_n_free_spots = spot_info.size();
+}
+
+
+/**
+ * @brief Makes a Pikmin that had reserved a spot start carrying from it.
+ *
+ * @param spot_idx Index of the spot.
+ * @param pik_ptr The Pikmin.
+ */
+void CarryInfo::add_carrier(size_t spot_idx, Mob* pik_ptr) {
+    CarrierSpot &spot = spot_info[spot_idx];
+    if(spot.state == CARRY_SPOT_STATE_USED) return;
+    if(spot.state == CARRY_SPOT_STATE_FREE) cur_n_free_spots--;
+    
+    spot.pik_ptr = pik_ptr;
+    spot.state = CARRY_SPOT_STATE_USED;
+    cur_carrying_strength += ((Pikmin*) pik_ptr)->pik_type->carry_strength;
+    cur_n_carriers++;
+    update_carrier_stats();
 }
 
 
@@ -74,33 +96,40 @@ CarryInfo::CarryInfo(
  * @return Whether it can fly.
  */
 bool CarryInfo::can_fly() const {
-    for(size_t c = 0; c < spot_info.size(); c++) {
-        Mob* carrier_ptr = spot_info[c].pik_ptr;
-        if(!carrier_ptr) continue;
-        if(!has_flag(spot_info[c].pik_ptr->flags, MOB_FLAG_CAN_MOVE_MIDAIR)) {
-            return false;
-        }
+    return carriers_can_fly;
+}
+
+
+/**
+ * @brief Frees up a spot, be it reserved or used. If a Pikmin was
+ * carrying from it, it stops counting as a carrier.
+ *
+ * @param spot_idx Index of the spot.
+ */
+void CarryInfo::free_spot(size_t spot_idx) {
+    CarrierSpot &spot = spot_info[spot_idx];
+    if(spot.state == CARRY_SPOT_STATE_FREE) return;
+    
+    if(spot.state == CARRY_SPOT_STATE_USED) {
+        cur_carrying_strength -=
+            ((Pikmin*) spot.pik_ptr)->pik_type->carry_strength;
+        cur_n_carriers--;
     }
-    return true;
+    spot.pik_ptr = nullptr;
+    spot.state = CARRY_SPOT_STATE_FREE;
+    cur_n_free_spots++;
+    update_carrier_stats();
 }
 
 
 /**
- * @brief Returns a list of hazards to which all carrier Pikmin
+ * @brief Returns the set of hazards to which all carrier Pikmin
  * are invulnerable.
  *
  * @return The invulnerabilities.
  */
-vector<Hazard*> CarryInfo::get_carrier_invulnerabilities() const {
-    //Get all types to save on the amount of hazard checks.
-    unordered_set<MobType*> carrier_types;
-    for(size_t c = 0; c < spot_info.size(); c++) {
-        Mob* carrier_ptr = spot_info[c].pik_ptr;
-        if(!carrier_ptr) continue;
-        carrier_types.insert(carrier_ptr->type);
-    }
-    
-    return get_mob_type_list_invulnerabilities(carrier_types);
+const hazard_set_t &CarryInfo::get_carrier_invulnerabilities() const {
+    return carrier_invulnerabilities;
 }
 
 
@@ -115,18 +144,8 @@ float CarryInfo::get_speed() const {
         return 0;
     }
     
-    float max_speed = 0;
-    
     //Begin by obtaining the average walking speed of the carriers.
-    for(size_t s = 0; s < spot_info.size(); s++) {
-        const CarrierSpot* s_ptr = &spot_info[s];
-        
-        if(s_ptr->state != CARRY_SPOT_STATE_USED) continue;
-        
-        Pikmin* p_ptr = (Pikmin*) s_ptr->pik_ptr;
-        max_speed += p_ptr->get_base_speed() * p_ptr->get_speed_multiplier();
-    }
-    max_speed /= cur_n_carriers;
+    float max_speed = carrier_speed_sum / cur_n_carriers;
     
     //If the object has all carriers, the Pikmin move as fast
     //as possible, which looks bad, since they're not jogging,
@@ -154,10 +173,7 @@ float CarryInfo::get_speed() const {
  * @return Whether it is empty.
  */
 bool CarryInfo::is_empty() const {
-    for(size_t s = 0; s < spot_info.size(); s++) {
-        if(spot_info[s].state != CARRY_SPOT_STATE_FREE) return false;
-    }
-    return true;
+    return cur_n_free_spots == spot_info.size();
 }
 
 
@@ -167,10 +183,24 @@ bool CarryInfo::is_empty() const {
  * @return Whether it is full.
  */
 bool CarryInfo::is_full() const {
-    for(size_t s = 0; s < spot_info.size(); s++) {
-        if(spot_info[s].state == CARRY_SPOT_STATE_FREE) return false;
-    }
-    return true;
+    return cur_n_free_spots == 0;
+}
+
+
+/**
+ * @brief Reserves a free spot for a Pikmin that is coming to carry.
+ *
+ * @param spot_idx Index of the spot.
+ * @param pik_ptr The Pikmin.
+ */
+void CarryInfo::reserve_spot(size_t spot_idx, Mob* pik_ptr) {
+    CarrierSpot &spot = spot_info[spot_idx];
+    if(spot.state != CARRY_SPOT_STATE_FREE) return;
+    
+    spot.pik_ptr = pik_ptr;
+    spot.state = CARRY_SPOT_STATE_RESERVED;
+    cur_n_free_spots--;
+    update_carrier_stats();
 }
 
 
@@ -196,6 +226,41 @@ void CarryInfo::rotate_points(float angle) {
 }
 
 
+/**
+ * @brief Updates the cached stats that depend on what the carriers are like:
+ * their combined walking speed, whether they can all fly, and what hazards
+ * they are all invulnerable to. Pikmin that only reserved a spot count
+ * for the latter two. This needs to be called whenever a spot changes hands,
+ * or whenever a carrier changes in a way that affects these, like when it
+ * gets a status effect.
+ */
+void CarryInfo::update_carrier_stats() {
+    carrier_speed_sum = 0.0f;
+    carriers_can_fly = true;
+    
+    //Get all types to save on the amount of hazard checks.
+    unordered_set<MobType*> carrier_types;
+    for(size_t s = 0; s < spot_info.size(); s++) {
+        const CarrierSpot* s_ptr = &spot_info[s];
+        if(!s_ptr->pik_ptr) continue;
+        
+        Pikmin* p_ptr = (Pikmin*) s_ptr->pik_ptr;
+        if(!has_flag(p_ptr->flags, MOB_FLAG_CAN_MOVE_MIDAIR)) {
+            carriers_can_fly = false;
+        }
+        carrier_types.insert(p_ptr->type);
+        
+        if(s_ptr->state == CARRY_SPOT_STATE_USED) {
+            carrier_speed_sum +=
+                p_ptr->get_base_speed() * p_ptr->get_speed_multiplier();
+        }
+    }
+    
+    carrier_invulnerabilities =
+        get_mob_type_list_invulnerabilities(carrier_types);
+}
+
+
 /**
  * @brief Constructs a new circling info struct object.
  *
@@ -226,6 +291,55 @@ Group::Group(Mob* leader_ptr) :
 }
 
 
+/**
+ * @brief Adds a mob to the group's list of members, and gives it a spot.
+ *
+ * @param mob_ptr The mob that joined.
+ */
+void Group::add_member(Mob* mob_ptr) {
+    members.push_back(mob_ptr);
+    subgroup_members[mob_ptr->subgroup_type_ptr].push_back(mob_ptr);
+    type_amounts[mob_ptr->type]++;
+    add_spot(mob_ptr);
+}
+
+
+/**
+ * @brief Gives a mob that joined the group the next free spot.
+ * The layout only changes if it needs another wheel of spots.
+ *
+ * @param mob_ptr The mob that joined.
+ */
+void Group::add_spot(Mob* mob_ptr) {
+    size_t spot_idx = spots.size();
+    if(spot_idx >= spot_layout.size()) {
+        init_spot_layout(spot_idx + 1);
+    }
+    spots.push_back(GroupSpot(spot_layout[spot_idx], mob_ptr));
+    mob_ptr->group_spot_idx = spot_idx;
+}
+
+
+/**
+ * @brief Moves a member over to a different subgroup type.
+ * This does not change the member's own subgroup type.
+ *
+ * @param mob_ptr The member.
+ * @param new_type Its new subgroup type.
+ */
+void Group::change_member_subgroup_type(
+    Mob* mob_ptr, SubgroupType* new_type
+) {
+    auto old_it = subgroup_members.find(mob_ptr->subgroup_type_ptr);
+    if(old_it != subgroup_members.end()) {
+        vector<Mob*> &old_list = old_it->second;
+        old_list.erase(std::find(old_list.begin(), old_list.end(), mob_ptr));
+        if(old_list.empty()) subgroup_members.erase(old_it);
+    }
+    subgroup_members[new_type].push_back(mob_ptr);
+}
+
+
 /**
  * @brief Sets the standby group member type to the next available one,
  * or nullptr if none.
@@ -243,17 +357,31 @@ bool Group::change_standby_type(bool move_backwards) {
  * Pikmin of the current one. Or to no type.
  */
 void Group::change_standby_type_if_needed() {
-    for(size_t m = 0; m < members.size(); m++) {
-        if(members[m]->subgroup_type_ptr == cur_standby_type) {
-            //Never mind, there is a member of this subgroup type.
-            return;
-        }
+    if(subgroup_members.find(cur_standby_type) != subgroup_members.end()) {
+        //Never mind, there is a member of this subgroup type.
+        return;
     }
     //No members of the current type? Switch to the next.
     change_standby_type(false);
 }
 
 
+/**
+ * @brief Returns how many members of the given subgroup type exist
+ * in the group.
+ *
+ * @param type Subgroup type to check.
+ * @return The amount.
+ */
+size_t Group::get_amount_by_subgroup_type(
+    const SubgroupType* type
+) const {
+    auto it = subgroup_members.find(type);
+    if(it == subgroup_members.end()) return 0;
+    return it->second.size();
+}
+
+
 /**
  * @brief Returns how many members of the given type exist in the group.
  *
@@ -261,13 +389,9 @@ void Group::change_standby_type_if_needed() {
  * @return The amount.
  */
 size_t Group::get_amount_by_type(const MobType* type) const {
-    size_t amount = 0;
-    for(size_t m = 0; m < members.size(); m++) {
-        if(members[m]->type == type) {
-            amount++;
-        }
-    }
-    return amount;
+    auto it = type_amounts.find(type);
+    if(it == type_amounts.end()) return 0;
+    return it->second;
 }
 
 
@@ -286,13 +410,89 @@ Point Group::get_average_member_pos() const {
 
 
 /**
- * @brief Returns a list of hazards to which all of a leader's group mobs
+ * @brief Returns the spot in use that's closest to the given position,
+ * using the spot grid. Cells are checked in rings around the position's cell,
+ * until no farther ring can have anything closer.
+ *
+ * @param local_pos Position to check, relative to the anchor and without
+ * the group's transformation.
+ * @param free_spot_grid If not nullptr, only spots in this copy of the
+ * spot grid can be returned, and the returned spot gets removed from it.
+ * @return The spot's index, or INVALID if there are none.
+ */
+size_t Group::get_closest_spot(
+    const Point &local_pos, vector<vector<size_t>>* free_spot_grid
+) const {
+    const vector<vector<size_t>> &grid =
+        free_spot_grid ? *free_spot_grid : spot_grid;
+    if(grid.empty()) return INVALID;
+    
+    Point cell_pos = (local_pos - spot_grid_origin) / spot_grid_cell_size;
+    int center_col =
+        std::clamp((int) floor(cell_pos.x), 0, (int) spot_grid_cols - 1);
+    int center_row =
+        std::clamp((int) floor(cell_pos.y), 0, (int) spot_grid_rows - 1);
+    int max_ring = (int) std::max(spot_grid_cols, spot_grid_rows);
+    
+    size_t best_spot = INVALID;
+    size_t best_cell = INVALID;
+    size_t best_cell_slot = INVALID;
+    Distance best_dist;
+    
+    for(int ring = 0; ring <= max_ring; ring++) {
+        if(
+            best_spot != INVALID &&
+            best_dist <= (ring - 1) * spot_grid_cell_size
+        ) {
+            //Everything in this ring and beyond is farther.
+            break;
+        }
+        
+        for(int row = center_row - ring; row <= center_row + ring; row++) {
+            if(row < 0 || row >= (int) spot_grid_rows) continue;
+            bool is_edge_row =
+                row == center_row - ring || row == center_row + ring;
+            int col_step = is_edge_row ? 1 : ring * 2;
+            for(
+                int col = center_col - ring;
+                col <= center_col + ring;
+                col += col_step
+            ) {
+                if(col < 0 || col >= (int) spot_grid_cols) continue;
+                size_t cell_idx = row * spot_grid_cols + col;
+                const vector<size_t> &cell = grid[cell_idx];
+                for(size_t i = 0; i < cell.size(); i++) {
+                    size_t s = cell[i];
+                    if(s >= spots.size()) continue;
+                    Distance d(local_pos, spot_layout[s]);
+                    if(best_spot == INVALID || d < best_dist) {
+                        best_dist = d;
+                        best_spot = s;
+                        best_cell = cell_idx;
+                        best_cell_slot = i;
+                    }
+                }
+            }
+        }
+    }
+    
+    if(free_spot_grid && best_spot != INVALID) {
+        vector<size_t> &cell = (*free_spot_grid)[best_cell];
+        cell[best_cell_slot] = cell.back();
+        cell.pop_back();
+    }
+    return best_spot;
+}
+
+
+/**
+ * @brief Returns the set of hazards to which all of a leader's group mobs
  * are invulnerable.
  *
  * @param include_leader If not nullptr, include the group leader mob.
- * @return The list of invulnerabilities.
+ * @return The invulnerabilities.
  */
-vector<Hazard*> Group::get_group_invulnerabilities(
+hazard_set_t Group::get_group_invulnerabilities(
     Mob* include_leader
 ) const {
     //Get all types to save on the amount of hazard checks.
@@ -309,6 +509,24 @@ vector<Hazard*> Group::get_group_invulnerabilities(
 }
 
 
+/**
+ * @brief Converts a position in the world into a position in the
+ * group's spot layout, which is relative to the anchor and without
+ * the group's transformation.
+ *
+ * @param pos The position.
+ * @param inverse Inverse of the group's transformation.
+ * @return The converted position.
+ */
+Point Group::get_local_pos(
+    const Point &pos, const ALLEGRO_TRANSFORM &inverse
+) const {
+    Point res = pos - anchor;
+    al_transform_coordinates(&inverse, &res.x, &res.y);
+    return res;
+}
+
+
 /**
  * @brief Returns the next available standby group member type, or nullptr if none.
  *
@@ -356,14 +574,11 @@ bool Group::get_next_standby_type(
             !game.config.rules.can_throw_leaders
         ) {
             //If this is a leader, and leaders cannot be thrown, skip.
-        } else {
-            for(size_t m = 0; m < members.size(); m++) {
-                if(members[m]->subgroup_type_ptr == scanning_type) {
-                    final_type = scanning_type;
-                    success = true;
-                    break;
-                }
-            }
+        } else if(
+            subgroup_members.find(scanning_type) != subgroup_members.end()
+        ) {
+            final_type = scanning_type;
+            success = true;
         }
         
         if(move_backwards) {
@@ -399,28 +614,56 @@ Point Group::get_spot_offset(size_t spot_idx) const {
 
 
 /**
- * @brief (Re-)Initializes the group spots. This resizes it to the current
- * number of group members. Any old group members are moved to the appropriate
- * new spot.
+ * @brief Returns a spot's absolute position. This comes from the positions
+ * worked out by update_spot_positions(), if they're still valid.
  *
- * @param affected_mob_ptr If this initialization is because a new mob entered
- * or left the group, this should point to said mob.
+ * @param spot_idx Index of the spot to check.
+ * @return The position.
  */
-void Group::init_spots(Mob* affected_mob_ptr) {
-    if(members.empty()) {
+Point Group::get_spot_pos(size_t spot_idx) const {
+    if(spot_positions_valid && spot_idx < spot_xs.size()) {
+        return Point(spot_xs[spot_idx], spot_ys[spot_idx]);
+    }
+    return anchor + get_spot_offset(spot_idx);
+}
+
+
+/**
+ * @brief Returns the members of the given subgroup type, in the order
+ * they joined.
+ *
+ * @param type Subgroup type to check.
+ * @return The members.
+ */
+const vector<Mob*> &Group::get_subgroup_members(
+    const SubgroupType* type
+) const {
+    static const vector<Mob*> no_members;
+    auto it = subgroup_members.find(type);
+    if(it == subgroup_members.end()) return no_members;
+    return it->second;
+}
+
+
+/**
+ * @brief (Re-)Initializes the layout of spots, with enough wheels of spots
+ * for the given number of spots. The mobs stay in the spots with the same
+ * indexes as before, which now have new positions.
+ *
+ * @param nr_spots How many spots the layout needs to have room for.
+ */
+void Group::init_spot_layout(size_t nr_spots) {
+    spot_positions_valid = false;
+    spot_layout.clear();
+    spot_grid.clear();
+    spot_layout_inner_capacity = 0;
+    if(nr_spots == 0) {
         spots.clear();
         radius = 0;
         return;
     }
     
-    //First, backup the old mob indexes.
-    vector<Mob*> old_mobs;
-    old_mobs.resize(spots.size());
-    for(size_t m = 0; m < spots.size(); m++) {
-        old_mobs[m] = spots[m].mob_ptr;
-    }
-    
-    //Now, rebuild the spots. Let's draw wheels from the center, for now.
+    //Let's draw wheels from the center, for now.
     
     /**
      * @brief Initial spot.
@@ -455,8 +698,10 @@ void Group::init_spots(Mob* affected_mob_ptr) {
     //Center spot first.
     alpha_spots.push_back(AlphaSpot(Point()));
     
-    while(alpha_spots.size() < members.size()) {
-    
+    while(alpha_spots.size() < nr_spots) {
+        
+        spot_layout_inner_capacity = alpha_spots.size();
+        
         //First, calculate how far the center
         //of these spots are from the central spot.
         float dist_from_center =
@@ -516,7 +761,7 @@ void Group::init_spots(Mob* affected_mob_ptr) {
         radius = dist_from_center;
     }
     
-    //Now, given all of these points, create our final spot vector,
+    //Now, given all of these points, create our final spot layout,
     //with the rightmost points coming first.
     
     //Start by sorting the points.
@@ -535,76 +780,177 @@ void Group::init_spots(Mob* affected_mob_ptr) {
     }
     );
     
-    //Finally, create the group spots.
-    spots.clear();
-    spots.resize(members.size(), GroupSpot());
-    for(size_t s = 0; s < members.size(); s++) {
-        spots[s] =
-            GroupSpot(
-                Point(
-                    alpha_spots[s].pos.x - radius,
-                    alpha_spots[s].pos.y
-                ),
-                nullptr
-            );
+    spot_layout.reserve(alpha_spots.size());
+    for(size_t a = 0; a < alpha_spots.size(); a++) {
+        spot_layout.push_back(
+            Point(alpha_spots[a].pos.x - radius, alpha_spots[a].pos.y)
+        );
+    }
+    for(size_t s = 0; s < spots.size(); s++) {
+        spots[s].pos = spot_layout[s];
     }
     
-    //Pass the old mobs over.
-    if(old_mobs.size() < spots.size()) {
-        for(size_t m = 0; m < old_mobs.size(); m++) {
-            spots[m].mob_ptr = old_mobs[m];
-            spots[m].mob_ptr->group_spot_idx = m;
-        }
-        spots[old_mobs.size()].mob_ptr = affected_mob_ptr;
-        affected_mob_ptr->group_spot_idx = old_mobs.size();
-        
-    } else if(old_mobs.size() > spots.size()) {
-        for(size_t m = 0, s = 0; m < old_mobs.size(); m++) {
-            if(old_mobs[m] == affected_mob_ptr) {
-                old_mobs[m]->group_spot_idx = INVALID;
-                continue;
-            }
-            spots[s].mob_ptr = old_mobs[m];
-            spots[s].mob_ptr->group_spot_idx = s;
-            s++;
-        }
-        
-    } else {
-        for(size_t m = 0; m < old_mobs.size(); m++) {
-            spots[m].mob_ptr = old_mobs[m];
-            spots[m].mob_ptr->group_spot_idx = m;
-        }
+    //Bucket the spots into a grid, with about one spot per cell.
+    spot_grid_cell_size =
+        game.config.pikmin.standard_radius * 2.0f + MOB::GROUP_SPOT_INTERVAL;
+    float grid_span =
+        (radius + MOB::GROUP_SPOT_MAX_DEVIATION) * 2.0f;
+    spot_grid_origin =
+        Point(
+            -radius - grid_span / 2.0f,
+            -grid_span / 2.0f
+        );
+    spot_grid_cols = ceil(grid_span / spot_grid_cell_size) + 1;
+    spot_grid_rows = spot_grid_cols;
+    spot_grid.assign(spot_grid_cols * spot_grid_rows, vector<size_t>());
+    for(size_t s = 0; s < spot_layout.size(); s++) {
+        Point cell_pos =
+            (spot_layout[s] - spot_grid_origin) / spot_grid_cell_size;
+        size_t col =
+            std::clamp((int) cell_pos.x, 0, (int) spot_grid_cols - 1);
+        size_t row =
+            std::clamp((int) cell_pos.y, 0, (int) spot_grid_rows - 1);
+        spot_grid[row * spot_grid_cols + col].push_back(s);
     }
 }
 
 
 /**
  * @brief Assigns each mob a new spot, given how close each one of them is to
- * each spot.
+ * each spot. The spots are found with the spot grid, so this takes
+ * roughly linear time.
  */
 void Group::reassign_spots() {
+    ALLEGRO_TRANSFORM inverse = transform;
+    al_invert_transform(&inverse);
+    
+    //Only spots in use can be picked, and each one only once, so work
+    //on a copy of the grid that spots get removed from as they're taken.
+    vector<vector<size_t>> free_spot_grid = spot_grid;
+    for(size_t c = 0; c < free_spot_grid.size(); c++) {
+        vector<size_t> &cell = free_spot_grid[c];
+        for(size_t i = 0; i < cell.size();) {
+            if(cell[i] >= spots.size()) {
+                cell[i] = cell.back();
+                cell.pop_back();
+            } else {
+                i++;
+            }
+        }
+    }
+    
     for(size_t m = 0; m < members.size(); m++) {
-        members[m]->group_spot_idx = INVALID;
+        Mob* m_ptr = members[m];
+        size_t spot_idx =
+            get_closest_spot(
+                get_local_pos(m_ptr->pos, inverse), &free_spot_grid
+            );
+        m_ptr->group_spot_idx = spot_idx;
+        if(spot_idx == INVALID) continue;
+        spots[spot_idx].mob_ptr = m_ptr;
     }
+}
+
+
+/**
+ * @brief Checks some of the spots to see if the mob in each one would be
+ * better off swapping spots with the mob in the spot closest to it.
+ * This untangles the group over several frames, without a full reassignment.
+ * Every call continues from where the last one left off.
+ *
+ * @param nr_checks How many spots to check.
+ */
+void Group::refine_spots(size_t nr_checks) {
+    if(spots.size() < 2) return;
     
-    for(size_t s = 0; s < spots.size(); s++) {
-        Point spot_pos = anchor + get_spot_offset(s);
-        Mob* closest_mob = nullptr;
-        Distance closest_dist;
+    ALLEGRO_TRANSFORM inverse = transform;
+    al_invert_transform(&inverse);
+    
+    nr_checks = std::min(nr_checks, spots.size());
+    for(size_t c = 0; c < nr_checks; c++) {
+        next_spot_to_refine %= spots.size();
+        size_t s1 = next_spot_to_refine;
+        next_spot_to_refine++;
         
-        for(size_t m = 0; m < members.size(); m++) {
-            Mob* m_ptr = members[m];
-            if(m_ptr->group_spot_idx != INVALID) continue;
-            
-            Distance d(m_ptr->pos, spot_pos);
-            
-            if(!closest_mob || d < closest_dist) {
-                closest_mob = m_ptr;
-                closest_dist = d;
+        Mob* mob1_ptr = spots[s1].mob_ptr;
+        size_t s2 = get_closest_spot(get_local_pos(mob1_ptr->pos, inverse));
+        if(s2 == s1) continue;
+        Mob* mob2_ptr = spots[s2].mob_ptr;
+        
+        Point spot1_pos = anchor + get_spot_offset(s1);
+        Point spot2_pos = anchor + get_spot_offset(s2);
+        Distance cur_dist(mob1_ptr->pos, spot1_pos);
+        cur_dist += Distance(mob2_ptr->pos, spot2_pos);
+        Distance swapped_dist(mob1_ptr->pos, spot2_pos);
+        swapped_dist += Distance(mob2_ptr->pos, spot1_pos);
+        if(swapped_dist >= cur_dist) continue;
+        
+        spots[s1].mob_ptr = mob2_ptr;
+        mob2_ptr->group_spot_idx = s1;
+        spots[s2].mob_ptr = mob1_ptr;
+        mob1_ptr->group_spot_idx = s2;
+    }
+}
+
+
+/**
+ * @brief Removes a mob from the group's list of members, and frees its spot.
+ *
+ * @param mob_ptr The mob that left.
+ */
+void Group::remove_member(Mob* mob_ptr) {
+    auto member_it = std::find(members.begin(), members.end(), mob_ptr);
+    if(member_it == members.end()) return;
+    members.erase(member_it);
+    
+    auto subgroup_it = subgroup_members.find(mob_ptr->subgroup_type_ptr);
+    if(subgroup_it != subgroup_members.end()) {
+        vector<Mob*> &list = subgroup_it->second;
+        list.erase(std::find(list.begin(), list.end(), mob_ptr));
+        if(list.empty()) subgroup_members.erase(subgroup_it);
+    }
+    
+    auto type_it = type_amounts.find(mob_ptr->type);
+    if(type_it != type_amounts.end()) {
+        type_it->second--;
+        if(type_it->second == 0) type_amounts.erase(type_it);
+    }
+    
+    remove_spot(mob_ptr);
+}
+
+
+/**
+ * @brief Removes the spot of a mob that left the group. To keep the other
+ * members where they are, the mob in the backmost spot moves over to the
+ * freed spot, and only if the group got small enough to lose a wheel of
+ * spots does the layout change.
+ *
+ * @param mob_ptr The mob that left.
+ */
+void Group::remove_spot(Mob* mob_ptr) {
+    size_t spot_idx = mob_ptr->group_spot_idx;
+    if(spot_idx >= spots.size() || spots[spot_idx].mob_ptr != mob_ptr) {
+        spot_idx = INVALID;
+        for(size_t s = 0; s < spots.size(); s++) {
+            if(spots[s].mob_ptr == mob_ptr) {
+                spot_idx = s;
+                break;
             }
         }
-        
-        if(closest_mob) closest_mob->group_spot_idx = s;
+    }
+    mob_ptr->group_spot_idx = INVALID;
+    if(spot_idx == INVALID) return;
+    
+    size_t last_idx = spots.size() - 1;
+    if(spot_idx != last_idx) {
+        spots[spot_idx].mob_ptr = spots[last_idx].mob_ptr;
+        spots[spot_idx].mob_ptr->group_spot_idx = spot_idx;
+    }
+    spots.pop_back();
+    
+    if(spots.empty() || spots.size() <= spot_layout_inner_capacity) {
+        init_spot_layout(spots.size());
     }
 }
 
@@ -628,12 +974,12 @@ void Group::sort(SubgroupType* leading_type) {
     while(cur_spot != spots.size()) {
         Point spot_pos = anchor + get_spot_offset(cur_spot);
         
-        //Find the member closest to this spot.
+        //Find the member of the current type closest to this spot.
+        const vector<Mob*> &type_members = get_subgroup_members(cur_type);
         Mob* closest_member = nullptr;
         Distance closest_dist;
-        for(size_t m = 0; m < members.size(); m++) {
-            Mob* m_ptr = members[m];
-            if(m_ptr->subgroup_type_ptr != cur_type) continue;
+        for(size_t m = 0; m < type_members.size(); m++) {
+            Mob* m_ptr = type_members[m];
             if(m_ptr->group_spot_idx != INVALID) continue;
             
             Distance d(m_ptr->pos, spot_pos);
@@ -661,6 +1007,50 @@ void Group::sort(SubgroupType* leading_type) {
 }
 
 
+/**
+ * @brief Works out the absolute position of every spot in one go,
+ * four spots at a time, so that members don't have to transform their
+ * own spot every time they check it. This must be called whenever the
+ * anchor or the transformation change.
+ */
+void Group::update_spot_positions() {
+    size_t n_spots = spots.size();
+    spot_xs.resize(n_spots);
+    spot_ys.resize(n_spots);
+    for(size_t s = 0; s < n_spots; s++) {
+        spot_xs[s] = spots[s].pos.x;
+        spot_ys[s] = spots[s].pos.y;
+    }
+    
+    //Same math as al_transform_coordinates(), plus the anchor.
+    size_t simd_end = n_spots - (n_spots % SIMD_FLOAT4_SIZE);
+    const SimdFloat4 m00 = SimdFloat4::set(transform.m[0][0]);
+    const SimdFloat4 m01 = SimdFloat4::set(transform.m[0][1]);
+    const SimdFloat4 m10 = SimdFloat4::set(transform.m[1][0]);
+    const SimdFloat4 m11 = SimdFloat4::set(transform.m[1][1]);
+    const SimdFloat4 m30 = SimdFloat4::set(transform.m[3][0]);
+    const SimdFloat4 m31 = SimdFloat4::set(transform.m[3][1]);
+    const SimdFloat4 anchor_x4 = SimdFloat4::set(anchor.x);
+    const SimdFloat4 anchor_y4 = SimdFloat4::set(anchor.y);
+    
+    for(size_t s = 0; s < simd_end; s += SIMD_FLOAT4_SIZE) {
+        SimdFloat4 x = SimdFloat4::load(&spot_xs[s]);
+        SimdFloat4 y = SimdFloat4::load(&spot_ys[s]);
+        (x * m00 + y * m10 + m30 + anchor_x4).store(&spot_xs[s]);
+        (x * m01 + y * m11 + m31 + anchor_y4).store(&spot_ys[s]);
+    }
+    
+    //Leftovers.
+    for(size_t s = simd_end; s < n_spots; s++) {
+        Point p = anchor + get_spot_offset(s);
+        spot_xs[s] = p.x;
+        spot_ys[s] = p.y;
+    }
+    
+    spot_positions_valid = true;
+}
+
+
 /**
  * @brief Clears the information.
  */
@@ -716,6 +1106,479 @@ Point HoldInfo::get_final_pos(float* out_z) const {
 }
 
 
+/**
+ * @brief Clears the grid, removing all cells and mobs.
+ */
+void MobGrid::clear() {
+    top_left_corner = Point();
+    n_cols = 0;
+    n_rows = 0;
+    cells.clear();
+    mob_ranges.clear();
+    mob_hot_data.clear();
+    sprite_overhang = 0.0f;
+}
+
+
+/**
+ * @brief Creates the grid's cells. Each cell is GEOMETRY::AREA_CELL_SIZE
+ * units wide and tall.
+ *
+ * @param top_left_corner Top-left corner of the grid.
+ * @param n_cols Number of columns.
+ * @param n_rows Number of rows.
+ */
+void MobGrid::create(
+    const Point &top_left_corner, size_t n_cols, size_t n_rows
+) {
+    clear();
+    this->top_left_corner = top_left_corner;
+    this->n_cols = std::max((size_t) 1, n_cols);
+    this->n_rows = std::max((size_t) 1, n_rows);
+    cells.assign(this->n_cols * this->n_rows, vector<size_t>());
+}
+
+
+/**
+ * @brief Returns the range of cells that a given region occupies.
+ * Regions outside of the grid are clamped to the cells on the grid's border.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @return The range.
+ */
+MobGrid::CellRange MobGrid::get_cell_range(
+    const Point &tl, const Point &br
+) const {
+    CellRange range;
+    
+    float max_col = (float) n_cols - 1;
+    float max_row = (float) n_rows - 1;
+    range.from_col =
+        std::clamp(
+            (float) floor((tl.x - top_left_corner.x) / GEOMETRY::AREA_CELL_SIZE),
+            0.0f, max_col
+        );
+    range.to_col =
+        std::clamp(
+            (float) floor((br.x - top_left_corner.x) / GEOMETRY::AREA_CELL_SIZE),
+            0.0f, max_col
+        );
+    range.from_row =
+        std::clamp(
+            (float) floor((tl.y - top_left_corner.y) / GEOMETRY::AREA_CELL_SIZE),
+            0.0f, max_row
+        );
+    range.to_row =
+        std::clamp(
+            (float) floor((br.y - top_left_corner.y) / GEOMETRY::AREA_CELL_SIZE),
+            0.0f, max_row
+        );
+        
+    return range;
+}
+
+
+/**
+ * @brief Returns the indexes of all mobs whose footprint is in the cells
+ * that a region occupies. Mobs further away are not returned, but
+ * mobs that are returned aren't necessarily inside the region.
+ * The indexes are sorted in ascending order, with no duplicates.
+ * This doesn't change the grid, so several threads can query it at once.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param out_idxs The mob indexes are returned here. This vector is cleared
+ * beforehand.
+ */
+void MobGrid::get_mobs_in_region(
+    const Point &tl, const Point &br, vector<size_t> &out_idxs
+) const {
+    out_idxs.clear();
+    if(cells.empty()) return;
+    
+    CellRange range = get_cell_range(tl, br);
+    
+    for(size_t r = range.from_row; r <= range.to_row; r++) {
+        for(size_t c = range.from_col; c <= range.to_col; c++) {
+            const vector<size_t> &cell = cells[r * n_cols + c];
+            out_idxs.insert(out_idxs.end(), cell.begin(), cell.end());
+        }
+    }
+    
+    //Mobs whose footprint spans several cells show up once per cell.
+    std::sort(out_idxs.begin(), out_idxs.end());
+    out_idxs.erase(
+        std::unique(out_idxs.begin(), out_idxs.end()), out_idxs.end()
+    );
+}
+
+
+/**
+ * @brief Returns the hot data of a mob on the grid.
+ *
+ * @param idx Index of the mob, in the list of all mobs.
+ * @return The data.
+ */
+const MobGrid::HotData &MobGrid::get_hot_data(size_t idx) const {
+    return mob_hot_data[idx];
+}
+
+
+/**
+ * @brief Returns how far past its footprint any mob's sprite can reach.
+ * Expanding a region by this amount before querying the grid makes sure
+ * that every mob whose sprite can be seen in the region is found.
+ *
+ * @return The distance.
+ */
+float MobGrid::get_sprite_overhang() const {
+    return sprite_overhang;
+}
+
+
+/**
+ * @brief Returns how many mobs the grid knows about.
+ *
+ * @return The number.
+ */
+size_t MobGrid::get_nr_mobs() const {
+    return mob_ranges.size();
+}
+
+
+/**
+ * @brief Clears the grid's contents and adds the given mobs to it.
+ *
+ * @param mobs List of all mobs. Each mob is identified by its index here.
+ */
+void MobGrid::rebuild(const vector<Mob*> &mobs) {
+    for(size_t c = 0; c < cells.size(); c++) {
+        cells[c].clear();
+    }
+    mob_ranges.clear();
+    mob_hot_data.clear();
+    sprite_overhang = 0.0f;
+    
+    for(size_t m = 0; m < mobs.size(); m++) {
+        update_mob(m, mobs[m]);
+    }
+}
+
+
+/**
+ * @brief Updates the cells a mob is in, based on its current position,
+ * as well as its hot data. If the mob is new to the grid, it gets added.
+ *
+ * The mob's footprint is a square with twice its physical span as the
+ * half-width. This way, a mob only needs to search around itself with
+ * its own interaction span and radius to find every mob that could be
+ * interacting with it, as the distance between two mobs can never be
+ * smaller than the distance between their centers minus the interacting mob's
+ * radius minus the other mob's physical span.
+ *
+ * @param idx Index of the mob, in the list of all mobs.
+ * @param m_ptr The mob.
+ */
+void MobGrid::update_mob(size_t idx, const Mob* m_ptr) {
+    if(cells.empty()) return;
+    
+    if(idx >= mob_ranges.size()) {
+        mob_ranges.resize(idx + 1);
+        mob_hot_data.resize(idx + 1);
+    }
+    
+    HotData &hot = mob_hot_data[idx];
+    hot.pos = m_ptr->pos;
+    hot.radius = m_ptr->radius;
+    hot.physical_span = m_ptr->physical_span;
+    hot.interaction_span = m_ptr->interaction_span;
+    
+    float footprint = m_ptr->physical_span * 2.0f;
+    if(m_ptr->type->anim_db) {
+        sprite_overhang =
+            std::max(
+                sprite_overhang,
+                m_ptr->type->anim_db->sprite_span - footprint
+            );
+    }
+    
+    CellRange new_range =
+        get_cell_range(m_ptr->pos - footprint, m_ptr->pos + footprint);
+    CellRange &old_range = mob_ranges[idx];
+    
+    if(
+        new_range.from_col == old_range.from_col &&
+        new_range.to_col == old_range.to_col &&
+        new_range.from_row == old_range.from_row &&
+        new_range.to_row == old_range.to_row
+    ) {
+        //Still in the same cells. Nothing to do.
+        return;
+    }
+    
+    if(old_range.from_col != INVALID) {
+        for(size_t r = old_range.from_row; r <= old_range.to_row; r++) {
+            for(size_t c = old_range.from_col; c <= old_range.to_col; c++) {
+                vector<size_t> &cell = cells[r * n_cols + c];
+                for(size_t i = 0; i < cell.size(); i++) {
+                    if(cell[i] == idx) {
+                        cell[i] = cell.back();
+                        cell.pop_back();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    
+    for(size_t r = new_range.from_row; r <= new_range.to_row; r++) {
+        for(size_t c = new_range.from_col; c <= new_range.to_col; c++) {
+            cells[r * n_cols + c].push_back(idx);
+        }
+    }
+    
+    old_range = new_range;
+}
+
+
+/**
+ * @brief Returns the mob with the given ID.
+ *
+ * @param id ID of the mob.
+ * @return The mob, or nullptr if there's no mob with that ID.
+ */
+Mob* MobLists::find_by_id(size_t id) const {
+    auto it = by_id.find(id);
+    if(it == by_id.end()) return nullptr;
+    return it->second;
+}
+
+
+/**
+ * @brief Removes the given mobs from all lists, going through each list
+ * only once.
+ *
+ * @param which The mobs to remove.
+ */
+void MobLists::remove(const unordered_set<Mob*> &which) {
+    for(Mob* m_ptr : which) {
+        by_id.erase(m_ptr->id);
+    }
+    remove_items_in_set_from_vector(which, all);
+    remove_items_in_set_from_vector(which, bouncers);
+    remove_items_in_set_from_vector(which, bridges);
+    remove_items_in_set_from_vector(which, carriables);
+    remove_items_in_set_from_vector(which, children);
+    remove_items_in_set_from_vector(which, converters);
+    remove_items_in_set_from_vector(which, decorations);
+    remove_items_in_set_from_vector(which, drops);
+    remove_items_in_set_from_vector(which, enemies);
+    remove_items_in_set_from_vector(which, group_tasks);
+    remove_items_in_set_from_vector(which, interactables);
+    remove_items_in_set_from_vector(which, leaders);
+    remove_items_in_set_from_vector(which, onions);
+    remove_items_in_set_from_vector(which, path_followers);
+    remove_items_in_set_from_vector(which, pellets);
+    remove_items_in_set_from_vector(which, pikmin_list);
+    remove_items_in_set_from_vector(which, piles);
+    remove_items_in_set_from_vector(which, resources);
+    remove_items_in_set_from_vector(which, walkables);
+    remove_items_in_set_from_vector(which, scales);
+    remove_items_in_set_from_vector(which, ships);
+    remove_items_in_set_from_vector(which, tools);
+    remove_items_in_set_from_vector(which, tracks);
+    remove_items_in_set_from_vector(which, treasures);
+}
+
+
+/**
+ * @brief Adds a mob to the index, in the cell its center is currently in.
+ *
+ * @param m_ptr The mob.
+ */
+void MobPointIndex::add_mob(Mob* m_ptr) {
+    if(cells.empty()) return;
+    
+    size_t col =
+        std::clamp(
+            (float) floor(
+                (m_ptr->pos.x - top_left_corner.x) / GEOMETRY::AREA_CELL_SIZE
+            ),
+            0.0f, (float) n_cols - 1
+        );
+    size_t row =
+        std::clamp(
+            (float) floor(
+                (m_ptr->pos.y - top_left_corner.y) / GEOMETRY::AREA_CELL_SIZE
+            ),
+            0.0f, (float) n_rows - 1
+        );
+    size_t cell_idx = row * n_cols + col;
+    
+    if(cells[cell_idx].empty()) used_cells.push_back(cell_idx);
+    cells[cell_idx].push_back(m_ptr);
+    max_physical_span = std::max(max_physical_span, m_ptr->physical_span);
+    nr_mobs++;
+}
+
+
+/**
+ * @brief Removes all mobs from the index, but keeps its cells.
+ * Only the cells that have mobs are visited, so this is cheap to do
+ * every frame.
+ */
+void MobPointIndex::clear() {
+    for(size_t c = 0; c < used_cells.size(); c++) {
+        cells[used_cells[c]].clear();
+    }
+    used_cells.clear();
+    max_physical_span = 0.0f;
+    nr_mobs = 0;
+}
+
+
+/**
+ * @brief Creates the index's cells. Each cell is GEOMETRY::AREA_CELL_SIZE
+ * units wide and tall.
+ *
+ * @param top_left_corner Top-left corner of the grid.
+ * @param n_cols Number of columns.
+ * @param n_rows Number of rows.
+ */
+void MobPointIndex::create(
+    const Point &top_left_corner, size_t n_cols, size_t n_rows
+) {
+    destroy();
+    this->top_left_corner = top_left_corner;
+    this->n_cols = std::max((size_t) 1, n_cols);
+    this->n_rows = std::max((size_t) 1, n_rows);
+    cells.assign(this->n_cols * this->n_rows, vector<Mob*>());
+}
+
+
+/**
+ * @brief Destroys the index, removing all cells and mobs.
+ */
+void MobPointIndex::destroy() {
+    top_left_corner = Point();
+    n_cols = 0;
+    n_rows = 0;
+    cells.clear();
+    used_cells.clear();
+    max_physical_span = 0.0f;
+    nr_mobs = 0;
+}
+
+
+/**
+ * @brief Returns the largest physical span out of all mobs in the index.
+ * Useful to know how much further than a given distance a search needs
+ * to go, to find mobs whose edges are within that distance.
+ *
+ * @return The span.
+ */
+float MobPointIndex::get_max_physical_span() const {
+    return max_physical_span;
+}
+
+
+/**
+ * @brief Returns the mobs closest to a point, from closest to farthest,
+ * going by their centers. Cells are checked in rings around the point's cell,
+ * until no farther ring can have anything closer than what was found.
+ * This doesn't change the index, so several threads can query it at once.
+ *
+ * @param pos Point to check.
+ * @param max_dist Only return mobs whose centers are at most
+ * this far away. LARGE_FLOAT for any.
+ * @param max_results Return at most these many mobs. INVALID for any.
+ * @param out_mobs The mobs are returned here. This vector is cleared
+ * beforehand.
+ * @param filter Only return mobs for which this returns true.
+ * nullptr for any.
+ */
+void MobPointIndex::get_nearest(
+    const Point &pos, float max_dist, size_t max_results,
+    vector<Mob*> &out_mobs, const std::function<bool(Mob*)> &filter
+) const {
+    out_mobs.clear();
+    if(nr_mobs == 0 || max_results == 0) return;
+    
+    int center_col =
+        std::clamp(
+            (int) floor((pos.x - top_left_corner.x) / GEOMETRY::AREA_CELL_SIZE),
+            0, (int) n_cols - 1
+        );
+    int center_row =
+        std::clamp(
+            (int) floor((pos.y - top_left_corner.y) / GEOMETRY::AREA_CELL_SIZE),
+            0, (int) n_rows - 1
+        );
+    int max_ring = (int) std::max(n_cols, n_rows);
+    float max_dist_squared = max_dist * max_dist;
+    
+    //Squared distance to each mob found so far, and the mob.
+    vector<std::pair<float, Mob*> > found;
+    
+    for(int ring = 0; ring <= max_ring; ring++) {
+        //Nothing in this ring or beyond is closer than this.
+        float ring_min_dist = (ring - 1) * GEOMETRY::AREA_CELL_SIZE;
+        if(ring_min_dist > max_dist) break;
+        if(max_results != INVALID && found.size() >= max_results) {
+            std::nth_element(
+                found.begin(), found.begin() + (max_results - 1), found.end()
+            );
+            if(found[max_results - 1].first <= ring_min_dist * ring_min_dist) {
+                break;
+            }
+        }
+        
+        for(int row = center_row - ring; row <= center_row + ring; row++) {
+            if(row < 0 || row >= (int) n_rows) continue;
+            bool is_edge_row =
+                row == center_row - ring || row == center_row + ring;
+            int col_step = is_edge_row ? 1 : ring * 2;
+            for(
+                int col = center_col - ring;
+                col <= center_col + ring;
+                col += col_step
+            ) {
+                if(col < 0 || col >= (int) n_cols) continue;
+                const vector<Mob*> &cell = cells[row * n_cols + col];
+                for(size_t m = 0; m < cell.size(); m++) {
+                    Mob* m_ptr = cell[m];
+                    Point diff = m_ptr->pos - pos;
+                    float d_squared = diff.x * diff.x + diff.y * diff.y;
+                    if(d_squared > max_dist_squared) continue;
+                    if(filter && !filter(m_ptr)) continue;
+                    found.push_back(std::make_pair(d_squared, m_ptr));
+                }
+            }
+        }
+    }
+    
+    std::sort(found.begin(), found.end());
+    if(max_results != INVALID && found.size() > max_results) {
+        found.resize(max_results);
+    }
+    out_mobs.reserve(found.size());
+    for(size_t f = 0; f < found.size(); f++) {
+        out_mobs.push_back(found[f].second);
+    }
+}
+
+
+/**
+ * @brief Returns how many mobs are in the index.
+ *
+ * @return The number.
+ */
+size_t MobPointIndex::get_nr_mobs() const {
+    return nr_mobs;
+}
+
+
 /**
  * @brief Constructs a new parent info struct object.
  *
@@ -824,14 +1687,9 @@ bool PikminNest::call_pikmin(Mob* m_ptr, size_t type_idx) {
         //Decide a leg to come out of.
         size_t leg_idx =
             game.rng.i(0, (int) (nest_type->leg_body_parts.size() / 2) - 1);
-        size_t leg_hole_bp_idx =
-            m_ptr->anim.anim_db->find_body_part(
-                nest_type->leg_body_parts[leg_idx * 2]
-            );
+        size_t leg_hole_bp_idx = nest_type->leg_body_part_idxs[leg_idx * 2];
         size_t leg_foot_bp_idx =
-            m_ptr->anim.anim_db->find_body_part(
-                nest_type->leg_body_parts[leg_idx * 2 + 1]
-            );
+            nest_type->leg_body_part_idxs[leg_idx * 2 + 1];
         Point spawn_coords =
             m_ptr->get_hitbox(leg_hole_bp_idx)->get_cur_pos(
                 m_ptr->pos, m_ptr->angle
@@ -845,7 +1703,7 @@ bool PikminNest::call_pikmin(Mob* m_ptr, size_t type_idx) {
             create_mob(
                 game.mob_categories.get(MOB_CATEGORY_PIKMIN),
                 spawn_coords, nest_type->pik_types[type_idx], spawn_angle,
-                "maturity=" + i2s(cur_m)
+                map<string, string> {{"maturity", i2s(cur_m)}}
             );
             
         //Set its data to start sliding.
@@ -1104,6 +1962,43 @@ Mob* create_mob(
     std::function<void(Mob*)> code_after_creation,
     size_t first_state_override
 ) {
+    map<string, string> vars_map;
+    if(!vars.empty()) vars_map = get_var_map(vars);
+    return
+        create_mob(
+            category, pos, type, angle, vars_map,
+            code_after_creation, first_state_override
+        );
+}
+
+
+/**
+ * @brief Creates a mob, adding it to the corresponding vectors.
+ * This version receives the script variables already parsed, so that
+ * callers that spawn the same thing often don't need to parse
+ * them every time.
+ *
+ * @param category The category the new mob belongs to.
+ * @param pos Initial position.
+ * @param type Type of the new mob.
+ * @param angle Initial facing angle.
+ * @param vars_map Script variables, already parsed.
+ * @param code_after_creation Code to run right after the mob is created,
+ * if any. This is run before any scripting takes place.
+ * @param first_state_override If this is INVALID, use the first state
+ * index defined in the mob's FSM struct, or the standard first state index.
+ * Otherwise, use this.
+ * @return The new mob.
+ */
+Mob* create_mob(
+    MobCategory* category, const Point &pos, MobType* type,
+    float angle, const map<string, string> &vars_map,
+    std::function<void(Mob*)> code_after_creation,
+    size_t first_state_override
+) {
+    //The area may not have needed this type's spritesheets until now.
+    if(type->anim_db) type->anim_db->load_sprite_bitmaps();
+    
     Mob* m_ptr = category->create_mob(pos, type, angle);
     
     if(m_ptr->type->walkable) {
@@ -1118,14 +2013,13 @@ Mob* create_mob(
         type->init_actions[a]->run(m_ptr, nullptr, nullptr);
     }
     
-    if(!vars.empty()) {
-        map<string, string> vars_map = get_var_map(vars);
+    if(!vars_map.empty()) {
         ScriptVarReader svr(vars_map);
         
         m_ptr->read_script_vars(svr);
         
         for(auto &v : vars_map) {
-            m_ptr->vars[v.first] = v.second;
+            m_ptr->set_var(v.first, v.second);
         }
     }
     
@@ -1163,6 +2057,8 @@ Mob* create_mob(
         
         Parent* p_info = new Parent(m_ptr);
         new_mob->parent = p_info;
+        m_ptr->child_mobs.push_back(new_mob);
+        game.states.gameplay->mobs.children.push_back(new_mob);
         p_info->handle_damage = child_info->handle_damage;
         p_info->relay_damage = child_info->relay_damage;
         p_info->handle_events = child_info->handle_events;
@@ -1218,107 +2114,180 @@ Mob* create_mob(
     }
     
     game.states.gameplay->mobs.all.push_back(m_ptr);
+    game.states.gameplay->mobs.by_id[m_ptr->id] = m_ptr;
     return m_ptr;
 }
 
 
 /**
- * @brief Deletes a mob from the relevant vectors.
+ * @brief Deletes a batch of mobs, removing them from the relevant vectors.
  *
- * It's always removed from the vector of mobs, but it's
- * also removed from the vector of Pikmin if it's a Pikmin,
- * leaders if it's a leader, etc.
+ * They're always removed from the vector of mobs, but they're
+ * also removed from the vector of Pikmin if they're Pikmin,
+ * leaders if they're leaders, etc. This is all done in one go at the end,
+ * so deleting many mobs in the same frame doesn't mean going through
+ * the vectors once per mob.
  *
- * @param m_ptr The mob to delete.
- * @param complete_destruction If true, don't bother removing it from groups
+ * Children of these mobs get marked for deletion and are deleted
+ * alongside them.
+ *
+ * @param which The mobs to delete.
+ * @param complete_destruction If true, don't bother removing them from groups
  * and such, since everything is going to be destroyed.
  */
-void delete_mob(Mob* m_ptr, bool complete_destruction) {
-    if(game.maker_tools.info_lock == m_ptr) game.maker_tools.info_lock = nullptr;
+void delete_mobs(const vector<Mob*> &which, bool complete_destruction) {
+    if(which.empty()) return;
     
-    if(!complete_destruction) {
-        m_ptr->leave_group();
+    vector<Mob*> batch = which;
+    for(size_t b = 0; b < batch.size(); b++) {
+        Mob* m_ptr = batch[b];
+        if(game.maker_tools.info_lock == m_ptr) {
+            game.maker_tools.info_lock = nullptr;
+        }
         
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            Mob* m2_ptr = game.states.gameplay->mobs.all[m];
-            if(m2_ptr->focused_mob == m_ptr) {
+        if(!complete_destruction) {
+            m_ptr->leave_group();
+            
+            //Clear the references other mobs have to it. Each mob keeps
+            //track of who refers to it, so there's no need to check every mob.
+            vector<Mob*> focusers = m_ptr->focused_by;
+            for(size_t f = 0; f < focusers.size(); f++) {
+                Mob* m2_ptr = focusers[f];
+                if(m2_ptr->focused_mob != m_ptr) continue;
                 m2_ptr->fsm.run_event(MOB_EV_FOCUSED_MOB_UNAVAILABLE);
                 m2_ptr->fsm.run_event(MOB_EV_FOCUS_OFF_REACH);
                 m2_ptr->fsm.run_event(MOB_EV_FOCUS_DIED);
-                m2_ptr->focused_mob = nullptr;
+                m2_ptr->unfocus_from_mob();
             }
-            if(m2_ptr->parent && m2_ptr->parent->m == m_ptr) {
-                delete m2_ptr->parent;
-                m2_ptr->parent = nullptr;
-                m2_ptr->to_delete = true;
+            
+            for(size_t c = 0; c < m_ptr->child_mobs.size(); c++) {
+                Mob* m2_ptr = m_ptr->child_mobs[c];
+                if(m2_ptr->parent && m2_ptr->parent->m == m_ptr) {
+                    delete m2_ptr->parent;
+                    m2_ptr->parent = nullptr;
+                    if(!m2_ptr->to_delete) {
+                        m2_ptr->to_delete = true;
+                        batch.push_back(m2_ptr);
+                    }
+                }
+            }
+            m_ptr->child_mobs.clear();
+            
+            for(size_t r = 0; r < m_ptr->remembered_by.size(); r++) {
+                Mob* m2_ptr = m_ptr->remembered_by[r];
+                for(auto &f : m2_ptr->focused_mob_memory) {
+                    if(f.second == m_ptr) f.second = nullptr;
+                }
             }
-            for(size_t f = 0; f < m2_ptr->focused_mob_memory.size(); f++) {
-                if(m2_ptr->focused_mob_memory[f] == m_ptr) {
-                    m2_ptr->focused_mob_memory[f] = nullptr;
+            m_ptr->remembered_by.clear();
+            
+            for(size_t c = 0; c < m_ptr->chomped_by.size(); c++) {
+                Mob* m2_ptr = m_ptr->chomped_by[c];
+                for(size_t c2 = 0; c2 < m2_ptr->chomping_mobs.size(); c2++) {
+                    if(m2_ptr->chomping_mobs[c2] == m_ptr) {
+                        m2_ptr->chomping_mobs[c2] = nullptr;
+                    }
                 }
             }
-            for(size_t c = 0; c < m2_ptr->chomping_mobs.size(); c++) {
-                if(m2_ptr->chomping_mobs[c] == m_ptr) {
-                    m2_ptr->chomping_mobs[c] = nullptr;
+            m_ptr->chomped_by.clear();
+            
+            for(size_t l = 0; l < m_ptr->linked_by.size(); l++) {
+                Mob* m2_ptr = m_ptr->linked_by[l];
+                for(size_t l2 = 0; l2 < m2_ptr->links.size(); l2++) {
+                    if(m2_ptr->links[l2] == m_ptr) {
+                        m2_ptr->links[l2] = nullptr;
+                    }
                 }
             }
-            for(size_t l = 0; l < m2_ptr->links.size(); l++) {
-                if(m2_ptr->links[l] == m_ptr) {
-                    m2_ptr->links[l] = nullptr;
+            m_ptr->linked_by.clear();
+            
+            vector<Mob*> stored_mobs = m_ptr->stored_mobs;
+            for(size_t s = 0; s < stored_mobs.size(); s++) {
+                Mob* m2_ptr = stored_mobs[s];
+                if(m2_ptr->stored_inside_another == m_ptr) {
+                    m_ptr->release(m2_ptr);
+                    m2_ptr->stored_inside_another = nullptr;
                 }
             }
-            if(m2_ptr->stored_inside_another == m_ptr) {
-                m_ptr->release(m2_ptr);
-                m2_ptr->stored_inside_another = nullptr;
+            m_ptr->stored_mobs.clear();
+            
+            for(size_t r = 0; r < m_ptr->riders.size(); r++) {
+                m_ptr->riders[r]->standing_on_mob = nullptr;
             }
-            if(m2_ptr->carry_info) {
-                for(
-                    size_t c = 0; c < m2_ptr->carry_info->spot_info.size(); c++
-                ) {
-                    if(m2_ptr->carry_info->spot_info[c].pik_ptr == m_ptr) {
-                        m2_ptr->carry_info->spot_info[c].pik_ptr =
-                            nullptr;
-                        m2_ptr->carry_info->spot_info[c].state =
-                            CARRY_SPOT_STATE_FREE;
-                    }
+            m_ptr->riders.clear();
+            
+            if(m_ptr->holder.m) {
+                m_ptr->holder.m->release(m_ptr);
+            }
+            
+            while(!m_ptr->holding.empty()) {
+                m_ptr->release(m_ptr->holding[0]);
+            }
+            
+            m_ptr->set_can_block_paths(false);
+            
+            m_ptr->fsm.set_state(INVALID);
+            
+            //Now clear the references it has to other mobs, so that they
+            //don't keep track of it any more.
+            m_ptr->unfocus_from_mob();
+            for(auto &f : m_ptr->focused_mob_memory) {
+                if(f.second) {
+                    remove_first_in_vector(m_ptr, f.second->remembered_by);
                 }
             }
+            for(size_t c = 0; c < m_ptr->chomping_mobs.size(); c++) {
+                Mob* m2_ptr = m_ptr->chomping_mobs[c];
+                if(m2_ptr) remove_first_in_vector(m_ptr, m2_ptr->chomped_by);
+            }
+            for(size_t l = 0; l < m_ptr->links.size(); l++) {
+                Mob* m2_ptr = m_ptr->links[l];
+                if(m2_ptr) remove_first_in_vector(m_ptr, m2_ptr->linked_by);
+            }
+            if(m_ptr->stored_inside_another) {
+                remove_first_in_vector(
+                    m_ptr, m_ptr->stored_inside_another->stored_mobs
+                );
+            }
+            if(m_ptr->standing_on_mob) {
+                remove_first_in_vector(m_ptr, m_ptr->standing_on_mob->riders);
+            }
+            if(m_ptr->parent && m_ptr->parent->m) {
+                remove_first_in_vector(m_ptr, m_ptr->parent->m->child_mobs);
+            }
         }
         
-        if(m_ptr->holder.m) {
-            m_ptr->holder.m->release(m_ptr);
-        }
-        
-        while(!m_ptr->holding.empty()) {
-            m_ptr->release(m_ptr->holding[0]);
+        if(m_ptr->type->category->id == MOB_CATEGORY_LEADERS) {
+            leader_fsm::die(m_ptr, nullptr, nullptr);
         }
-        
-        m_ptr->set_can_block_paths(false);
-        
-        m_ptr->fsm.set_state(INVALID);
+        game.audio.handle_mob_deletion(m_ptr);
+        game.states.gameplay->clear_mob_active_cells(m_ptr);
     }
     
-    game.audio.handle_mob_deletion(m_ptr);
+    unordered_set<Mob*> batch_set(batch.begin(), batch.end());
     
-    m_ptr->type->category->erase_mob(m_ptr);
-    game.states.gameplay->mobs.all.erase(
-        find(
-            game.states.gameplay->mobs.all.begin(),
-            game.states.gameplay->mobs.all.end(),
-            m_ptr
-        )
-    );
-    if(m_ptr->type->walkable) {
-        game.states.gameplay->mobs.walkables.erase(
-            find(
-                game.states.gameplay->mobs.walkables.begin(),
-                game.states.gameplay->mobs.walkables.end(),
-                m_ptr
-            )
-        );
+    if(!complete_destruction) {
+        //Free the carrying spots taken by any of these mobs.
+        const vector<Mob*> &carriables = game.states.gameplay->mobs.carriables;
+        for(size_t c = 0; c < carriables.size(); c++) {
+            Mob* m2_ptr = carriables[c];
+            for(size_t s = 0; s < m2_ptr->carry_info->spot_info.size(); s++) {
+                CarrierSpot &spot = m2_ptr->carry_info->spot_info[s];
+                if(
+                    spot.pik_ptr &&
+                    batch_set.find(spot.pik_ptr) != batch_set.end()
+                ) {
+                    m2_ptr->carry_info->free_spot(s);
+                }
+            }
+        }
     }
     
-    delete m_ptr;
+    game.states.gameplay->mobs.remove(batch_set);
+    
+    for(size_t b = 0; b < batch.size(); b++) {
+        delete batch[b];
+    }
 }
 
 
@@ -1337,31 +2306,22 @@ string get_error_message_mob_info(Mob* m) {
 
 
 /**
- * @brief Returns a list of hazards to which all mob types given
+ * @brief Returns the set of hazards to which all mob types given
  * are invulnerable.
  *
  * @param types Mob types to check.
  * @return The invulnerabilities.
  */
-vector<Hazard*> get_mob_type_list_invulnerabilities(
+hazard_set_t get_mob_type_list_invulnerabilities(
     const unordered_set<MobType*> &types
 ) {
-    //Count how many types are invulnerable to each detected hazard.
-    map<Hazard*, size_t> inv_instances;
-    for(auto &t : types) {
-        for(auto &h : t->hazard_vulnerabilities) {
-            if(h.second.effect_mult == 0.0f) {
-                inv_instances[h.first]++;
-            }
-        }
-    }
+    if(types.empty()) return hazard_set_t();
     
-    //Only accept those that ALL types are invulnerable to.
-    vector<Hazard*> invulnerabilities;
-    for(auto &i : inv_instances) {
-        if(i.second == types.size()) {
-            invulnerabilities.push_back(i.first);
-        }
+    //Only keep those that ALL types are invulnerable to.
+    hazard_set_t invulnerabilities;
+    invulnerabilities.set();
+    for(auto &t : types) {
+        invulnerabilities &= t->hazard_invulnerabilities;
     }
     
     return invulnerabilities;
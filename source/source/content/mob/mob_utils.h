@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -41,11 +44,55 @@
 #include "mob_enums.h"
 
 
+using std::map;
 using std::size_t;
+using std::unordered_map;
 using std::vector;
 
 class Mob;
 
+/**
+ * @brief Result of advancing a copy of a mob's animation ahead of the rest
+ * of its tick. The result, and the events that it causes, are only used
+ * later, during the tick, if advancing it then would give the same result.
+ */
+struct AnimTickResult {
+
+    //--- Members ---
+    
+    //Whether there's a result here that wasn't used yet.
+    bool pending = false;
+    
+    //Animation the instance was on.
+    Animation* anim = nullptr;
+    
+    //Frame index the instance was on, before advancing.
+    size_t start_frame_idx = INVALID;
+    
+    //Frame time the instance was on, before advancing.
+    float start_frame_time = 0.0f;
+    
+    //Speed multiplier it was advanced with.
+    float speed_mult = 1.0f;
+    
+    //Frame index the instance was on, after advancing.
+    size_t frame_idx = INVALID;
+    
+    //Frame time the instance was on, after advancing.
+    float frame_time = 0.0f;
+    
+    //Whether the animation reached its end.
+    bool finished = false;
+    
+    //Signals of the frames that were reached.
+    vector<size_t> signals;
+    
+    //Sounds of the frames that were reached.
+    vector<size_t> sounds;
+    
+};
+
+
 /**
  * @brief Info on a carrying spot around a mob's perimeter.
  */
@@ -92,6 +139,18 @@ struct CarryInfo {
     //Number of carriers, including reserves. Cache for performance.
     size_t cur_n_carriers = 0;
     
+    //Number of spots that are neither reserved nor used. Cache for performance.
+    size_t cur_n_free_spots = 0;
+    
+    //Sum of the carriers' walking speeds. Cache for performance.
+    float carrier_speed_sum = 0.0f;
+    
+    //Whether all carriers can fly. Cache for performance.
+    bool carriers_can_fly = true;
+    
+    //Hazards all carriers are invulnerable to. Cache for performance.
+    hazard_set_t carrier_invulnerabilities;
+    
     //Is the object moving at the moment?
     bool is_moving = false;
     
@@ -122,10 +181,14 @@ struct CarryInfo {
     CarryInfo(Mob* m, const CARRY_DESTINATION destination);
     bool is_empty() const;
     bool is_full() const;
-    vector<Hazard*> get_carrier_invulnerabilities() const;
+    const hazard_set_t &get_carrier_invulnerabilities() const;
     bool can_fly() const;
     float get_speed() const;
     void rotate_points(float angle);
+    void reserve_spot(size_t spot_idx, Mob* pik_ptr);
+    void add_carrier(size_t spot_idx, Mob* pik_ptr);
+    void free_spot(size_t spot_idx);
+    void update_carrier_stats();
     
 };
 
@@ -210,6 +273,39 @@ struct CirclingInfo {
 };
 
 
+/**
+ * @brief Info about the last time a mob checked if it had a clear line
+ * towards another mob. The same pairs get checked frame after frame, and
+ * the answer doesn't change while neither of them moves much.
+ */
+struct ClearLineCache {
+
+    //--- Members ---
+    
+    //ID of the mob that was checked against, or INVALID if none.
+    size_t target_id = INVALID;
+    
+    //Position of the checking mob at the time.
+    Point pos;
+    
+    //Z of the checking mob at the time.
+    float z = 0.0f;
+    
+    //Position of the target mob at the time.
+    Point target_pos;
+    
+    //Z of the target mob at the time.
+    float target_z = 0.0f;
+    
+    //Area time at which the check was done.
+    float time = 0.0f;
+    
+    //Whether the line was clear.
+    bool result = false;
+    
+};
+
+
 /**
  * @brief Info on a mob that's being delivered to an Onion, ship, etc.
  */
@@ -289,9 +385,43 @@ struct Group {
     //All group members.
     vector<Mob*> members;
     
-    //Information about each spot.
+    //Members of each subgroup type, in the order they joined. Subgroup types
+    //without any members don't have an entry.
+    unordered_map<const SubgroupType*, vector<Mob*>> subgroup_members;
+    
+    //How many members of each mob type there are.
+    unordered_map<const MobType*, size_t> type_amounts;
+    
+    //Information about each spot, frontmost first. There's one per member.
     vector<GroupSpot> spots;
     
+    //Position of every spot the current wheels of spots have room for,
+    //frontmost first. The first ones are the ones in use.
+    vector<Point> spot_layout;
+    
+    //How many spots the layout would have room for with one less wheel.
+    //If the members fit in that, the layout shrinks.
+    size_t spot_layout_inner_capacity = 0;
+    
+    //Indexes of the spots in the layout, bucketed by position in a grid,
+    //so the spot closest to a point can be found quickly.
+    vector<vector<size_t>> spot_grid;
+    
+    //Top-left corner of the spot grid, relative to the anchor.
+    Point spot_grid_origin;
+    
+    //Width and height of each cell in the spot grid.
+    float spot_grid_cell_size = 1.0f;
+    
+    //Number of columns in the spot grid.
+    size_t spot_grid_cols = 0;
+    
+    //Number of rows in the spot grid.
+    size_t spot_grid_rows = 0;
+    
+    //Index of the next spot to check when refining the spots.
+    size_t next_spot_to_refine = 0;
+    
     //Radius of the group.
     float radius = 0.0f;
     
@@ -301,6 +431,16 @@ struct Group {
     //Angle from the leader to the anchor.
     float anchor_angle = TAU / 2.0f;
     
+    //Absolute X coordinate of each spot. Cache for performance.
+    vector<float> spot_xs;
+    
+    //Absolute Y coordinate of each spot. Cache for performance.
+    vector<float> spot_ys;
+    
+    //Whether spot_xs and spot_ys match the current anchor, transformation,
+    //and spots. Spots added since are not in them yet.
+    bool spot_positions_valid = false;
+    
     //Transformation to apply to the group, like from swarming.
     ALLEGRO_TRANSFORM transform;
     
@@ -314,20 +454,47 @@ struct Group {
     //--- Function declarations ---
     
     explicit Group(Mob* leader_ptr);
-    void init_spots(Mob* affected_mob_ptr = nullptr);
+    void add_member(Mob* mob_ptr);
+    void remove_member(Mob* mob_ptr);
+    void change_member_subgroup_type(
+        Mob* mob_ptr, SubgroupType* new_type
+    );
+    void add_spot(Mob* mob_ptr);
+    void remove_spot(Mob* mob_ptr);
     void sort(SubgroupType* leading_type);
     void change_standby_type_if_needed();
     size_t get_amount_by_type(const MobType* type) const;
+    size_t get_amount_by_subgroup_type(const SubgroupType* type) const;
+    const vector<Mob*> &get_subgroup_members(
+        const SubgroupType* type
+    ) const;
     Point get_average_member_pos() const;
-    vector<Hazard*> get_group_invulnerabilities(
+    hazard_set_t get_group_invulnerabilities(
         Mob* include_leader = nullptr
     ) const;
     bool get_next_standby_type(
         bool move_backwards, SubgroupType** new_type
     );
     Point get_spot_offset(size_t spot_idx) const;
+    Point get_spot_pos(size_t spot_idx) const;
     void reassign_spots();
+    void refine_spots(size_t nr_checks);
     bool change_standby_type(bool move_backwards);
+    void update_spot_positions();
+    
+    private:
+    
+    //--- Function declarations ---
+    
+    size_t get_closest_spot(
+        const Point &local_pos,
+        vector<vector<size_t>>* free_spot_grid = nullptr
+    ) const;
+    Point get_local_pos(
+        const Point &pos, const ALLEGRO_TRANSFORM &inverse
+    ) const;
+    void init_spot_layout(size_t nr_spots);
+    
 };
 
 
@@ -393,6 +560,173 @@ class Treasure;
 class OnionType;
 class ShipType;
 
+/**
+ * @brief Uniform grid that divides the area into cells, and keeps track
+ * of which mobs are in which cells. This way, when a mob needs to know
+ * which other mobs are near it, only the mobs in the nearby cells need to be
+ * checked, instead of every mob in the area.
+ * Mobs are referred to by their index in the list of all mobs, so the grid
+ * must be rebuilt whenever that list gets reordered.
+ */
+struct MobGrid {
+
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Range of cells that a mob's footprint occupies.
+     */
+    struct CellRange {
+    
+        //--- Members ---
+        
+        //Starting column, inclusive.
+        size_t from_col = INVALID;
+        
+        //Ending column, inclusive.
+        size_t to_col = INVALID;
+        
+        //Starting row, inclusive.
+        size_t from_row = INVALID;
+        
+        //Ending row, inclusive.
+        size_t to_row = INVALID;
+        
+    };
+    
+    /**
+     * @brief The data about a mob that interaction checks read the most.
+     * These are kept packed together, per mob index, so that checking
+     * every nearby mob doesn't have to go through each mob's memory.
+     * They are as of the last time the mob was updated on the grid.
+     */
+    struct HotData {
+    
+        //--- Members ---
+        
+        //Coordinates.
+        Point pos;
+        
+        //Radius.
+        float radius = 0.0f;
+        
+        //Physical span.
+        float physical_span = 0.0f;
+        
+        //Interaction span.
+        float interaction_span = 0.0f;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Top-left corner of the grid.
+    Point top_left_corner;
+    
+    //Number of columns.
+    size_t n_cols = 0;
+    
+    //Number of rows.
+    size_t n_rows = 0;
+    
+    
+    //--- Function declarations ---
+    
+    void clear();
+    void create(const Point &top_left_corner, size_t n_cols, size_t n_rows);
+    const HotData &get_hot_data(size_t idx) const;
+    size_t get_nr_mobs() const;
+    void get_mobs_in_region(
+        const Point &tl, const Point &br, vector<size_t> &out_idxs
+    ) const;
+    float get_sprite_overhang() const;
+    void rebuild(const vector<Mob*> &mobs);
+    void update_mob(size_t idx, const Mob* m_ptr);
+    
+    
+private:
+
+    //--- Members ---
+    
+    //Mob indexes in each cell. Cells are ordered by row, then column.
+    vector<vector<size_t> > cells;
+    
+    //Range of cells each mob is in, per mob index.
+    vector<CellRange> mob_ranges;
+    
+    //Hot data of each mob, per mob index.
+    vector<HotData> mob_hot_data;
+    
+    //How far past its footprint a mob's sprite can reach, for the mob
+    //on the grid that reaches the furthest. This can be larger than
+    //the real value if mobs were updated since the last rebuild.
+    float sprite_overhang = 0.0f;
+    
+    
+    //--- Function declarations ---
+    
+    CellRange get_cell_range(const Point &tl, const Point &br) const;
+    
+};
+
+
+/**
+ * @brief Uniform grid that keeps some mobs bucketed by the cell their
+ * center is in, so that the mobs closest to a point can be found without
+ * going through every mob. Unlike the mob grid, this only holds the mobs
+ * it's told about, so it's meant to be filled with the mobs of one
+ * specific kind.
+ * Mobs are referred to by pointer, so the index must be refilled whenever
+ * any of its mobs get deleted.
+ */
+struct MobPointIndex {
+
+    //--- Members ---
+    
+    //Top-left corner of the grid.
+    Point top_left_corner;
+    
+    //Number of columns.
+    size_t n_cols = 0;
+    
+    //Number of rows.
+    size_t n_rows = 0;
+    
+    
+    //--- Function declarations ---
+    
+    void add_mob(Mob* m_ptr);
+    void clear();
+    void create(const Point &top_left_corner, size_t n_cols, size_t n_rows);
+    void destroy();
+    float get_max_physical_span() const;
+    void get_nearest(
+        const Point &pos, float max_dist, size_t max_results,
+        vector<Mob*> &out_mobs,
+        const std::function<bool(Mob*)> &filter = nullptr
+    ) const;
+    size_t get_nr_mobs() const;
+    
+    
+private:
+
+    //--- Members ---
+    
+    //Mobs in each cell. Cells are ordered by row, then column.
+    vector<vector<Mob*> > cells;
+    
+    //Indexes of the cells that have any mob.
+    vector<size_t> used_cells;
+    
+    //Largest physical span out of all mobs in the index.
+    float max_physical_span = 0.0f;
+    
+    //Total number of mobs in the index.
+    size_t nr_mobs = 0;
+    
+};
+
+
 /**
  * @brief Lists of all mobs in the area.
  */
@@ -403,12 +737,21 @@ struct MobLists {
     //All mobs in the area.
     vector<Mob*> all;
     
+    //All mobs in the area, by their ID. Cache for performance.
+    unordered_map<size_t, Mob*> by_id;
+    
     //Bouncers.
     vector<Bouncer*> bouncers;
     
     //Bridges.
     vector<Bridge*> bridges;
     
+    //Mobs that can currently be carried. Cache for performance.
+    vector<Mob*> carriables;
+    
+    //Mobs that were spawned as children of another. Cache for performance.
+    vector<Mob*> children;
+    
     //Converters.
     vector<Converter*> converters;
     
@@ -433,6 +776,10 @@ struct MobLists {
     //Onions.
     vector<Onion*> onions;
     
+    //Mobs that are currently following a path. These are the ones that need
+    //to know when paths change. Cache for performance.
+    vector<Mob*> path_followers;
+    
     //Pellets.
     vector<Pellet*> pellets;
     
@@ -463,6 +810,12 @@ struct MobLists {
     //Treasures.
     vector<Treasure*> treasures;
     
+    
+    //--- Function declarations ---
+    
+    Mob* find_by_id(size_t id) const;
+    void remove(const unordered_set<Mob*> &which);
+    
 };
 
 
@@ -619,6 +972,10 @@ struct Path {
     //Settings about how the path should be followed.
     PathFollowSettings settings;
     
+    //Did the paths change, with the mob still waiting for its turn
+    //to be told about it?
+    bool paths_changed_pending = false;
+    
     
     //--- Function declarations ---
     
@@ -645,6 +1002,9 @@ struct PikminNestType {
     //Body parts that represent legs -- pairs of hole + foot.
     vector<string> leg_body_parts;
     
+    //Index of each leg body part, in the same order. Cache for performance.
+    vector<size_t> leg_body_part_idxs;
+    
     //Speed at which Pikmin enter the nest.
     float pikmin_enter_speed = 0.7f;
     
@@ -747,9 +1107,17 @@ Mob* create_mob(
     std::function<void(Mob*)> code_after_creation = nullptr,
     size_t first_state_override = INVALID
 );
-void delete_mob(Mob* m, bool complete_destruction = false);
+Mob* create_mob(
+    MobCategory* category, const Point &pos, MobType* type,
+    float angle, const map<string, string> &vars_map,
+    std::function<void(Mob*)> code_after_creation = nullptr,
+    size_t first_state_override = INVALID
+);
+void delete_mobs(
+    const vector<Mob*> &which, bool complete_destruction = false
+);
 string get_error_message_mob_info(Mob* m);
-vector<Hazard*> get_mob_type_list_invulnerabilities(
+hazard_set_t get_mob_type_list_invulnerabilities(
     const unordered_set<MobType*> &types
 );
 MobType::SpawnInfo* get_spawn_info_from_child_info(
@@ -152,6 +152,10 @@ void Onion::generate() {
         
         game.statistics.pikmin_births++;
         game.states.gameplay->pikmin_born++;
+        enable_flag(
+            game.states.gameplay->changed_mission_counters,
+            MISSION_COUNTER_PIKMIN_BORN | MISSION_COUNTER_TOTAL_PIKMIN
+        );
         game.states.gameplay->pikmin_born_per_type[
             oni_type->nest->pik_types[t]
         ]++;
@@ -287,9 +287,7 @@ void Pikmin::get_group_spot_info(
         return;
     }
     
-    *out_spot =
-        following_group->group->anchor +
-        following_group->group->get_spot_offset(group_spot_idx);
+    *out_spot = following_group->group->get_spot_pos(group_spot_idx);
     *out_dist = 5.0f;
 }
 
@@ -323,6 +321,7 @@ void Pikmin::handle_status_effect_gain(StatusType* sta_type) {
     increase_maturity(sta_type->maturity_change_amount);
     
     if(carrying_mob) {
+        carrying_mob->carry_info->update_carrier_stats();
         carrying_mob->chase_info.max_speed =
             carrying_mob->carry_info->get_speed();
     }
@@ -394,6 +393,7 @@ void Pikmin::handle_status_effect_loss(StatusType* sta_type) {
     }
     
     if(carrying_mob) {
+        carrying_mob->carry_info->update_carrier_stats();
         carrying_mob->chase_info.max_speed =
             carrying_mob->carry_info->get_speed();
     }
@@ -515,6 +515,10 @@ void Pikmin::read_script_vars(const ScriptVarReader &svr) {
  */
 void Pikmin::start_dying_class_specifics() {
     game.states.gameplay->pikmin_deaths++;
+    enable_flag(
+        game.states.gameplay->changed_mission_counters,
+        MISSION_COUNTER_PIKMIN_DEATHS | MISSION_COUNTER_TOTAL_PIKMIN
+    );
     game.states.gameplay->pikmin_deaths_per_type[pik_type]++;
     game.states.gameplay->last_pikmin_death_pos = pos;
     game.statistics.pikmin_deaths++;
@@ -600,33 +604,21 @@ void Pikmin::tick_class_specifics(float delta_t) {
 Pikmin* get_closest_sprout(
     const Point &pos, Distance* d, bool ignore_reserved
 ) {
-    Distance closest_distance;
-    Pikmin* closest_pikmin = nullptr;
-    
-    size_t n_pikmin = game.states.gameplay->mobs.pikmin_list.size();
-    for(size_t p = 0; p < n_pikmin; p++) {
-        if(
-            game.states.gameplay->mobs.pikmin_list[p]->fsm.cur_state->id !=
-            PIKMIN_STATE_SPROUT
-        ) {
-            continue;
-        }
-        
-        Distance dis(pos, game.states.gameplay->mobs.pikmin_list[p]->pos);
-        if(closest_pikmin == nullptr || dis < closest_distance) {
-        
-            if(
-                !(
-                    ignore_reserved ||
-                    game.states.gameplay->mobs.pikmin_list[p]->pluck_reserved
-                )
-            ) {
-                closest_distance = dis;
-                closest_pikmin = game.states.gameplay->mobs.pikmin_list[p];
-            }
-        }
-    }
+    const auto is_candidate = [ignore_reserved] (Mob * m_ptr) {
+        Pikmin* pik_ptr = (Pikmin*) m_ptr;
+        if(pik_ptr->fsm.cur_state->id != PIKMIN_STATE_SPROUT) return false;
+        return !(ignore_reserved || pik_ptr->pluck_reserved);
+    };
+    
+    vector<Mob*> results;
+    game.states.gameplay->task_indexes[MOB_TASK_INDEX_SPROUTS].get_nearest(
+        pos, LARGE_FLOAT, 1, results, is_candidate
+    );
     
-    if(d) *d = closest_distance;
-    return closest_pikmin;
+    if(results.empty()) {
+        if(d) *d = Distance();
+        return nullptr;
+    }
+    if(d) *d = Distance(pos, results[0]->pos);
+    return (Pikmin*) results[0];
 }
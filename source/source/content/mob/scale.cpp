@@ -39,14 +39,11 @@ float Scale::calculate_cur_weight() const {
     //Start by figuring out which mobs are applying weight.
     set<Mob*> weighing_mobs;
     
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m_ptr = game.states.gameplay->mobs.all[m];
-        
-        if(m_ptr->standing_on_mob == this) {
-            weighing_mobs.insert(m_ptr);
-            for(size_t h = 0; h < m_ptr->holding.size(); h++) {
-                weighing_mobs.insert(m_ptr->holding[h]);
-            }
+    for(size_t r = 0; r < riders.size(); r++) {
+        Mob* m_ptr = riders[r];
+        weighing_mobs.insert(m_ptr);
+        for(size_t h = 0; h < m_ptr->holding.size(); h++) {
+            weighing_mobs.insert(m_ptr->holding[h]);
         }
     }
     
@@ -67,22 +67,6 @@ MobType* BouncerCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a bouncer from the list of bouncers.
- *
- * @param m The mob to erase.
- */
-void BouncerCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.bouncers.erase(
-        find(
-            game.states.gameplay->mobs.bouncers.begin(),
-            game.states.gameplay->mobs.bouncers.end(),
-            (Bouncer*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of bouncer given its internal name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* BridgeCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a bridge from the list of bridges.
- *
- * @param m The mob to erase.
- */
-void BridgeCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.bridges.erase(
-        find(
-            game.states.gameplay->mobs.bridges.begin(),
-            game.states.gameplay->mobs.bridges.end(),
-            (Bridge*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of bridge given its internal name,
  * or nullptr on error.
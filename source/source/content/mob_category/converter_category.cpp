@@ -68,22 +68,6 @@ MobType* ConverterCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a converter from the list of converters.
- *
- * @param m The mob to erase.
- */
-void ConverterCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.converters.erase(
-        find(
-            game.states.gameplay->mobs.converters.begin(),
-            game.states.gameplay->mobs.converters.end(),
-            (Converter*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of converter given its name,
  * or nullptr on error.
@@ -65,14 +65,6 @@ MobType* CustomCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a custom mob from the list of custom mobs.
- *
- * @param m The mob to erase.
- */
-void CustomCategory::erase_mob(Mob* m) { }
-
-
 /**
  * @brief Returns a custom type given its internal name,
  * or nullptr on error.
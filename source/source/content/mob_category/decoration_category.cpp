@@ -67,22 +67,6 @@ MobType* DecorationCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a decoration from the list of decorations.
- *
- * @param m The mob to erase.
- */
-void DecorationCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.decorations.erase(
-        find(
-            game.states.gameplay->mobs.decorations.begin(),
-            game.states.gameplay->mobs.decorations.end(),
-            (Decoration*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of decoration given its internal name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* DropCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a drop from the list of drops.
- *
- * @param m The mob to erase.
- */
-void DropCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.drops.erase(
-        find(
-            game.states.gameplay->mobs.drops.begin(),
-            game.states.gameplay->mobs.drops.end(),
-            (Drop*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of drop given its internal name,
  * or nullptr on error.
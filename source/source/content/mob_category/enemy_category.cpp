@@ -67,22 +67,6 @@ MobType* EnemyCategory::create_type() {
 }
 
 
-/**
- * @brief Clears an enemy from the list of enemies.
- *
- * @param m The mob to erase.
- */
-void EnemyCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.enemies.erase(
-        find(
-            game.states.gameplay->mobs.enemies.begin(),
-            game.states.gameplay->mobs.enemies.end(),
-            (Enemy*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of enemy given its internal name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* GroupTaskCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a group task from the list of group task.
- *
- * @param m The mob to erase.
- */
-void GroupTaskCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.group_tasks.erase(
-        find(
-            game.states.gameplay->mobs.group_tasks.begin(),
-            game.states.gameplay->mobs.group_tasks.end(),
-            (GroupTask*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of group task given its internal name,
  * or nullptr on error.
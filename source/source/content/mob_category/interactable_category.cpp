@@ -67,22 +67,6 @@ MobType* InteractableCategory::create_type() {
 }
 
 
-/**
- * @brief Clears an interactable from the list of interactables.
- *
- * @param m The mob to erase.
- */
-void InteractableCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.interactables.erase(
-        find(
-            game.states.gameplay->mobs.interactables.begin(),
-            game.states.gameplay->mobs.interactables.end(),
-            (Interactable*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of interactable given its name,
  * or nullptr on error.
@@ -13,7 +13,6 @@
 #include "leader_category.h"
 
 #include "../../core/game.h"
-#include "../mob_script/leader_fsm.h"
 #include "../mob/leader.h"
 
 
@@ -69,23 +68,6 @@ MobType* LeaderCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a leader from the list of leaders.
- *
- * @param m The mob to erase.
- */
-void LeaderCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.leaders.erase(
-        find(
-            game.states.gameplay->mobs.leaders.begin(),
-            game.states.gameplay->mobs.leaders.end(),
-            (Leader*) m
-        )
-    );
-    leader_fsm::die((Leader*) m, nullptr, nullptr);
-}
-
-
 /**
  * @brief Returns a type of leader given its name,
  * or nullptr on error.
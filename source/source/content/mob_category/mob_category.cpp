@@ -212,14 +212,6 @@ Mob* NoneCategory::create_mob(
 MobType* NoneCategory::create_type() { return nullptr; }
 
 
-/**
- * @brief Clears a mob from the list.
- *
- * @param m The mob to erase.
- */
-void NoneCategory::erase_mob(Mob* m) { }
-
-
 /**
  * @brief Returns a type of mob given its internal name,
  * or nullptr on error.
@@ -145,7 +145,6 @@ public:
     virtual Mob* create_mob(
         const Point &pos, MobType* type, float angle
     ) = 0;
-    virtual void erase_mob(Mob* m) = 0;
     virtual void clear_types() = 0;
     
 };
@@ -199,7 +198,6 @@ public:
     Mob* create_mob(
         const Point &pos, MobType* type, float angle
     ) override;
-    void erase_mob(Mob* m) override;
     void clear_types() override;
     
 };
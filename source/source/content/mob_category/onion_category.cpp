@@ -67,22 +67,6 @@ MobType* OnionCategory::create_type() {
 }
 
 
-/**
- * @brief Clears an Onion from the list of Onions.
- *
- * @param m The mob to erase.
- */
-void OnionCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.onions.erase(
-        find(
-            game.states.gameplay->mobs.onions.begin(),
-            game.states.gameplay->mobs.onions.end(),
-            (Onion*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of Onion given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* PelletCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a pellet from the list of pellets.
- *
- * @param m The mob to erase.
- */
-void PelletCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.pellets.erase(
-        find(
-            game.states.gameplay->mobs.pellets.begin(),
-            game.states.gameplay->mobs.pellets.end(),
-            (Pellet*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of pellet given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* PikminCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a Pikmin from the list of Pikmin.
- *
- * @param m The mob to erase.
- */
-void PikminCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.pikmin_list.erase(
-        find(
-            game.states.gameplay->mobs.pikmin_list.begin(),
-            game.states.gameplay->mobs.pikmin_list.end(),
-            (Pikmin*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of Pikmin given its name,
  * or nullptr on error.
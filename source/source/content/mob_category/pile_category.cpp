@@ -67,22 +67,6 @@ MobType* PileCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a pile from the list of piles.
- *
- * @param m The mob to erase.
- */
-void PileCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.piles.erase(
-        find(
-            game.states.gameplay->mobs.piles.begin(),
-            game.states.gameplay->mobs.piles.end(),
-            (Pile*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of pile given its name,
  * or nullptr on error.
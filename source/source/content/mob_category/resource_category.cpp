@@ -67,22 +67,6 @@ MobType* ResourceCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a resource from the list of resources.
- *
- * @param m The mob to erase.
- */
-void ResourceCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.resources.erase(
-        find(
-            game.states.gameplay->mobs.resources.begin(),
-            game.states.gameplay->mobs.resources.end(),
-            (Resource*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of resource given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* ScaleCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a scale from the list of scales.
- *
- * @param m The mob to erase.
- */
-void ScaleCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.scales.erase(
-        find(
-            game.states.gameplay->mobs.scales.begin(),
-            game.states.gameplay->mobs.scales.end(),
-            (Scale*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of scale given its name,
  * or nullptr on error.
@@ -67,22 +67,6 @@ MobType* ShipCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a ship from the list of ships.
- *
- * @param m The mob to erase.
- */
-void ShipCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.ships.erase(
-        find(
-            game.states.gameplay->mobs.ships.begin(),
-            game.states.gameplay->mobs.ships.end(),
-            (Ship*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of ship given its name,
  * or nullptr on error.
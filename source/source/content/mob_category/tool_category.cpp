@@ -67,22 +67,6 @@ MobType* ToolCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a tool from the list of tools.
- *
- * @param m The mob to erase.
- */
-void ToolCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.tools.erase(
-        find(
-            game.states.gameplay->mobs.tools.begin(),
-            game.states.gameplay->mobs.tools.end(),
-            (Tool*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of tool given its name,
  * or nullptr on error.
@@ -38,7 +38,6 @@ public:
     Mob* create_mob(
         const Point &pos, MobType* type, float angle
     ) override;
-    void erase_mob(Mob* m) override;
     void clear_types() override;
     
 };
@@ -67,22 +67,6 @@ MobType* TrackCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a track from the list of tracks.
- *
- * @param m The mob to erase.
- */
-void TrackCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.tracks.erase(
-        find(
-            game.states.gameplay->mobs.tracks.begin(),
-            game.states.gameplay->mobs.tracks.end(),
-            (Track*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of track given its name,
  * or nullptr on error.
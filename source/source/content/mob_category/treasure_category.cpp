@@ -67,22 +67,6 @@ MobType* TreasureCategory::create_type() {
 }
 
 
-/**
- * @brief Clears a treasure from the list of treasures.
- *
- * @param m The mob to erase.
- */
-void TreasureCategory::erase_mob(Mob* m) {
-    game.states.gameplay->mobs.treasures.erase(
-        find(
-            game.states.gameplay->mobs.treasures.begin(),
-            game.states.gameplay->mobs.treasures.end(),
-            (Treasure*) m
-        )
-    );
-}
-
-
 /**
  * @brief Returns a type of treasure given its name,
  * or nullptr on error.
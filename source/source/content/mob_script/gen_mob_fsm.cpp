@@ -249,10 +249,7 @@ void gen_mob_fsm::handle_carrier_added(Mob* m, void* info1, void* info2) {
     Mob* prev_destination = m->carry_info->intended_mob;
     
     //Update the numbers and such.
-    m->carry_info->spot_info[pik_ptr->temp_i].pik_ptr = pik_ptr;
-    m->carry_info->spot_info[pik_ptr->temp_i].state = CARRY_SPOT_STATE_USED;
-    m->carry_info->cur_carrying_strength += pik_ptr->pik_type->carry_strength;
-    m->carry_info->cur_n_carriers++;
+    m->carry_info->add_carrier(pik_ptr->temp_i, pik_ptr);
     
     m->chase_info.max_speed = m->carry_info->get_speed();
     m->chase_info.acceleration = MOB::CARRIED_MOB_ACCELERATION;
@@ -289,14 +286,9 @@ void gen_mob_fsm::handle_carrier_added(Mob* m, void* info1, void* info2) {
     
     //Check if the list of invulnerabilities changed.
     if(!must_update && m->path_info) {
-        vector<Hazard*> new_invulnerabilities =
-            m->carry_info->get_carrier_invulnerabilities();
-            
         if(
-            !vectors_contain_same(
-                new_invulnerabilities,
-                m->path_info->settings.invulnerabilities
-            )
+            m->carry_info->get_carrier_invulnerabilities() !=
+            m->path_info->settings.invulnerabilities
         ) {
             must_update = true;
         }
@@ -325,10 +317,7 @@ void gen_mob_fsm::handle_carrier_removed(Mob* m, void* info1, void* info2) {
     Mob* prev_destination = m->carry_info->intended_mob;
     
     //Update the numbers and such.
-    m->carry_info->spot_info[pik_ptr->temp_i].pik_ptr = nullptr;
-    m->carry_info->spot_info[pik_ptr->temp_i].state = CARRY_SPOT_STATE_FREE;
-    m->carry_info->cur_carrying_strength -= pik_ptr->pik_type->carry_strength;
-    m->carry_info->cur_n_carriers--;
+    m->carry_info->free_spot(pik_ptr->temp_i);
     
     m->chase_info.max_speed = m->carry_info->get_speed();
     m->chase_info.acceleration = MOB::CARRIED_MOB_ACCELERATION;
@@ -366,14 +355,9 @@ void gen_mob_fsm::handle_carrier_removed(Mob* m, void* info1, void* info2) {
     
     //Check if the list of invulnerabilities changed.
     if(!must_update && m->path_info) {
-        vector<Hazard*> new_invulnerabilities =
-            m->carry_info->get_carrier_invulnerabilities();
-            
         if(
-            !vectors_contain_same(
-                new_invulnerabilities,
-                m->path_info->settings.invulnerabilities
-            )
+            m->carry_info->get_carrier_invulnerabilities() !=
+            m->path_info->settings.invulnerabilities
         ) {
             must_update = true;
         }
@@ -2542,10 +2542,14 @@ void leader_fsm::spray(Mob* m, void* info1, void* info2) {
         };
         
     } else {
-        for(
-            size_t am = 0; am < game.states.gameplay->mobs.all.size(); am++
-        ) {
-            Mob* am_ptr = game.states.gameplay->mobs.all[am];
+        vector<Mob*> nearby_mobs;
+        game.states.gameplay->get_mobs_in_box(
+            m->pos - spray_type_ref.distance_range,
+            m->pos + spray_type_ref.distance_range,
+            nearby_mobs
+        );
+        for(size_t am = 0; am < nearby_mobs.size(); am++) {
+            Mob* am_ptr = nearby_mobs[am];
             if(am_ptr == m) continue;
             
             if(
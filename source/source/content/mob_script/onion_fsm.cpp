@@ -129,6 +129,10 @@ void onion_fsm::receive_mob(Mob* m, void* info1, void* info2) {
         
         if(game.cur_area_data->mission.enemy_points_on_collection) {
             game.states.gameplay->enemy_points_collected += ((Enemy*) delivery)->ene_type->points;
+            enable_flag(
+                game.states.gameplay->changed_mission_counters,
+                MISSION_COUNTER_ENEMY_POINTS
+            );
         }
         
         break;
@@ -2917,10 +2917,11 @@ void pikmin_fsm::finish_picking_up(Mob* m, void* info1, void* info2) {
         return;
     }
     
-    m->subgroup_type_ptr =
+    m->set_subgroup_type(
         game.states.gameplay->subgroup_types.get_type(
             SUBGROUP_TYPE_CATEGORY_TOOL, m->focused_mob->type
-        );
+        )
+    );
     m->hold(
         m->focused_mob, INVALID, 4, 0, 0.5f,
         true, HOLD_ROTATION_METHOD_FACE_HOLDER
@@ -2954,11 +2955,8 @@ void pikmin_fsm::forget_carriable_object(Mob* m, void* info1, void* info2) {
     Pikmin* pik_ptr = (Pikmin*) m;
     if(!pik_ptr->carrying_mob) return;
     
-    pik_ptr->carrying_mob->carry_info->spot_info[pik_ptr->temp_i].state =
-        CARRY_SPOT_STATE_FREE;
-    pik_ptr->carrying_mob->carry_info->spot_info[pik_ptr->temp_i].pik_ptr =
-        nullptr;
-        
+    pik_ptr->carrying_mob->carry_info->free_spot(pik_ptr->temp_i);
+    
     pik_ptr->carrying_mob = nullptr;
 }
 
@@ -3091,8 +3089,7 @@ void pikmin_fsm::go_to_carriable_object(Mob* m, void* info1, void* info2) {
     
     pik_ptr->focus_on_mob(carriable_mob);
     pik_ptr->temp_i = closest_spot;
-    closest_spot_ptr->state = CARRY_SPOT_STATE_RESERVED;
-    closest_spot_ptr->pik_ptr = pik_ptr;
+    carriable_mob->carry_info->reserve_spot(closest_spot, pik_ptr);
     
     pik_ptr->chase(
         &carriable_mob->pos, &carriable_mob->z,
@@ -3179,9 +3176,7 @@ void pikmin_fsm::go_to_onion(Mob* m, void* info1, void* info2) {
             0, (int) (nest_ptr->nest_type->leg_body_parts.size() / 2) - 1
         );
     size_t leg_foot_bp_idx =
-        nest_ptr->m_ptr->anim.anim_db->find_body_part(
-            nest_ptr->nest_type->leg_body_parts[pik_ptr->temp_i * 2 + 1]
-        );
+        nest_ptr->nest_type->leg_body_part_idxs[pik_ptr->temp_i * 2 + 1];
     Point coords =
         nest_ptr->m_ptr->get_hitbox(
             leg_foot_bp_idx
@@ -3807,10 +3802,11 @@ void pikmin_fsm::release_tool(Mob* m, void* info1, void* info2) {
     too_ptr->pos = m->pos;
     too_ptr->speed = Point();
     too_ptr->push_amount = 0.0f;
-    m->subgroup_type_ptr =
+    m->set_subgroup_type(
         game.states.gameplay->subgroup_types.get_type(
             SUBGROUP_TYPE_CATEGORY_PIKMIN, pik_ptr->pik_type
-        );
+        )
+    );
     if(m->following_group) {
         m->following_group->group->change_standby_type_if_needed();
         game.states.gameplay->update_closest_group_members();
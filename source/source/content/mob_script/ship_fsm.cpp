@@ -63,6 +63,13 @@ void ship_fsm::receive_mob(Mob* m, void* info1, void* info2) {
     Mob* delivery = (Mob*) info1;
     Ship* shi_ptr = (Ship*) m;
     
+    enable_flag(
+        game.states.gameplay->changed_mission_counters,
+        MISSION_COUNTER_ENEMY_POINTS | MISSION_COUNTER_TREASURES |
+        MISSION_COUNTER_TREASURE_POINTS | MISSION_COUNTER_REMAINING_MOBS |
+        MISSION_COUNTER_TOTAL_PIKMIN
+    );
+    
     switch(delivery->type->category->id) {
     case MOB_CATEGORY_ENEMIES: {
         if(game.cur_area_data->mission.enemy_points_on_collection) {
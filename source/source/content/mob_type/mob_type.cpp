@@ -41,6 +41,9 @@ const size_t ANIM_IDLING = 0;
 //The default acceleration of a mob type.
 const float DEF_ACCELERATION = 400.0f;
 
+//The default interval, in frames, between far away logic ticks.
+const size_t DEF_FAR_LOGIC_INTERVAL = 4;
+
 //The default rotation speed of a mob type.
 const float DEF_ROTATION_SPEED = 630.0f;
 
@@ -262,6 +265,8 @@ void MobType::load_from_data_node(
     rs.set("custom_category_name", custom_category_name);
     rs.set("default_vulnerability", default_vulnerability);
     rs.set("description", description);
+    rs.set("far_logic_distance", far_logic_distance);
+    rs.set("far_logic_interval", far_logic_interval);
     rs.set("has_group", has_group);
     rs.set("health_regen", health_regen);
     rs.set("height", height);
@@ -358,6 +363,14 @@ void MobType::load_from_data_node(
         }
     }
     
+    //Invulnerabilities.
+    hazard_invulnerabilities.reset();
+    for(auto &v : hazard_vulnerabilities) {
+        if(v.second.effect_mult != 0.0f) continue;
+        if(v.first->idx == INVALID) continue;
+        hazard_invulnerabilities.set(v.first->idx);
+    }
+    
     //Spike damage.
     auto sd_it = game.content.spike_damage_types.list.find(spike_damage_str);
     if(spike_damage_node) {
@@ -406,6 +419,9 @@ void MobType::load_from_data_node(
         }
     }
     
+    //Far away logic.
+    far_logic_interval = std::max(far_logic_interval, (size_t) 1);
+    
     //Spike damage vulnerabilities.
     DataNode* spike_damage_vuln_node =
         node->getChildByName("spike_damage_vulnerabilities");
@@ -545,6 +561,7 @@ void MobType::load_from_data_node(
             new_spawn.coords_xy = s2p(coords_str, &new_spawn.coords_z);
         }
         new_spawn.angle = deg_to_rad(new_spawn.angle);
+        new_spawn.vars_map = get_var_map(new_spawn.vars);
         
         spawns.push_back(new_spawn);
     }
@@ -664,6 +681,7 @@ void MobType::load_from_data_node(
         sound_rs.set("volume_deviation", new_sound.config.gain_deviation);
         sound_rs.set("speed_deviation", new_sound.config.speed_deviation);
         sound_rs.set("random_delay", new_sound.config.random_delay);
+        sound_rs.set("priority", new_sound.config.priority);
         
         new_sound.sample = game.content.sounds.list.get(file_str, file_node);
         
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <bitset>
 #include <functional>
 #include <map>
 
@@ -39,6 +40,7 @@ typedef vector<std::pair<size_t, string> > anim_conversion_vector;
 namespace MOB_TYPE {
 extern const size_t ANIM_IDLING;
 extern const float DEF_ACCELERATION;
+extern const size_t DEF_FAR_LOGIC_INTERVAL;
 extern const float DEF_ROTATION_SPEED;
 }
 
@@ -94,6 +96,9 @@ public:
         //Name of the mob type to spawn.
         string mob_type_name;
         
+        //Mob type to spawn, resolved from the name once all types load.
+        MobType* mob_type = nullptr;
+        
         //Spawn in coordinates relative to the spawner?
         bool relative = true;
         
@@ -109,6 +114,9 @@ public:
         //Script vars to give the spawned object.
         string vars;
         
+        //Script vars to give the spawned object, already parsed.
+        map<string, string> vars_map;
+        
         //Should the spawner link to the spawned?
         bool link_object_to_spawn = false;
         
@@ -394,6 +402,13 @@ public:
     //Logic for when it's inactive. Use INACTIVE_LOGIC_FLAG.
     bitmask_8_t inactive_logic = 0;
     
+    //If not 0, its brain and script only tick every few frames when it's
+    //off-camera and at least this far away from every leader.
+    float far_logic_distance = 0.0f;
+    
+    //When far away, its brain and script tick once every these many frames.
+    size_t far_logic_interval = MOB_TYPE::DEF_FAR_LOGIC_INTERVAL;
+    
     //Custom behavior callbacks.
     void(*draw_mob_callback)(Mob* m) = nullptr;
     
@@ -402,9 +417,16 @@ public:
     //Actions to run on spawn.
     vector<MobActionCall*> init_actions;
     
+    //Names of the script variables its mobs use, interned into slots.
+    ScriptVarTable script_vars;
+    
     //The states, events and actions. Basically, the FSM.
     vector<MobState*> states;
     
+    //Which events are handled by at least one of the states.
+    //Mobs of this type can be skipped when broadcasting any other event.
+    std::bitset<N_MOB_EVENTS> handled_events;
+    
     //Index of the state a mob starts at.
     size_t first_state_idx = INVALID;
     
@@ -442,6 +464,9 @@ public:
     //For every hazard, multiply its effects by this much.
     map<Hazard*, Vulnerability> hazard_vulnerabilities;
     
+    //Set of hazards it's completely invulnerable to. Cache for performance.
+    hazard_set_t hazard_invulnerabilities;
+    
     //What sort of spike damage it causes, if any.
     SpikeDamageType* spike_damage = nullptr;
     
@@ -90,9 +90,13 @@ void OnionType::load_cat_properties(DataNode* file) {
 void OnionType::load_cat_resources(DataNode* file) {
     //We don't actually need to load any, but we know that if this function
     //is run, then the animations are definitely loaded.
-    //Now's a good time to check the leg body parts.
+    //Now's a good time to check the leg body parts, and to save their
+    //indexes so calling and storing Pikmin doesn't need to look them up.
+    nest->leg_body_part_idxs.clear();
     for(size_t b = 0; b < nest->leg_body_parts.size(); b++) {
-        if(anim_db->find_body_part(nest->leg_body_parts[b]) == INVALID) {
+        size_t bp_idx = anim_db->find_body_part(nest->leg_body_parts[b]);
+        nest->leg_body_part_idxs.push_back(bp_idx);
+        if(bp_idx == INVALID) {
             game.errors.report(
                 "The Onion type \"" + name + "\" specifies a leg body part "
                 "called \"" + nest->leg_body_parts[b] + "\", "
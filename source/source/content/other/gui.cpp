@@ -40,6 +40,10 @@ const float BULLET_PADDING = 6.0f;
 //Radius of the circle that represents the bullet in a bullet point item.
 const float BULLET_RADIUS = 4.0f;
 
+//Padding around an item's draw cache bitmap, for anything that can be
+//drawn a bit outside of the item's box.
+const float DRAW_CACHE_PADDING = 8.0f;
+
 //When an item does a juicy grow, this is the full effect duration.
 const float JUICY_GROW_DURATION = 0.3f;
 
@@ -61,6 +65,11 @@ const float JUICY_GROW_TEXT_MEDIUM_MULT = 0.05f;
 //Standard size of the content inside of a GUI item, in ratio.
 const Point STANDARD_CONTENT_SIZE = Point(0.95f, 0.80f);
 
+//In a virtualized list, rows this far above or below the visible part
+//still exist as items, so directional navigation can reach them.
+//This is a ratio of the list's height.
+const float VIRTUAL_LIST_MARGIN = 1.0f;
+
 }
 
 
@@ -111,7 +120,7 @@ void BulletGuiItem::def_draw_code(
         0.0f, this->color
     );
     float juicy_grow_amount = get_juice_value();
-    draw_text(
+    draw_cached_text(
         this->text, this->font,
         Point(item_x_start + text_x_offset, draw.center.y),
         text_space * GUI::STANDARD_CONTENT_SIZE,
@@ -129,6 +138,17 @@ void BulletGuiItem::def_draw_code(
 }
 
 
+/**
+ * @brief Returns what the bullet item's drawing depends on, for the
+ * draw cache.
+ *
+ * @return The key.
+ */
+string BulletGuiItem::get_draw_cache_key() const {
+    return text;
+}
+
+
 /**
  * @brief Constructs a new button gui item object.
  *
@@ -165,6 +185,17 @@ void ButtonGuiItem::def_draw_code(
 }
 
 
+/**
+ * @brief Returns what the button item's drawing depends on, for the
+ * draw cache.
+ *
+ * @return The key.
+ */
+string ButtonGuiItem::get_draw_cache_key() const {
+    return text;
+}
+
+
 /**
  * @brief Constructs a new check gui item object.
  *
@@ -228,7 +259,7 @@ void CheckGuiItem::def_activate_code() {
  */
 void CheckGuiItem::def_draw_code(const DrawInfo &draw) {
     float juicy_grow_amount = get_juice_value();
-    draw_text(
+    draw_cached_text(
         this->text, this->font,
         Point(draw.center.x - draw.size.x * 0.45, draw.center.y),
         Point(draw.size.x * 0.95, draw.size.y) * GUI::STANDARD_CONTENT_SIZE,
@@ -264,6 +295,17 @@ void CheckGuiItem::def_draw_code(const DrawInfo &draw) {
 }
 
 
+/**
+ * @brief Returns what the check item's drawing depends on, for the
+ * draw cache.
+ *
+ * @return The key.
+ */
+string CheckGuiItem::get_draw_cache_key() const {
+    return b2s(value) + text;
+}
+
+
 /**
  * @brief Constructs a new GUI item object.
  *
@@ -275,6 +317,16 @@ GuiItem::GuiItem(bool selectable) :
 }
 
 
+/**
+ * @brief Destroys the GUI item object.
+ */
+GuiItem::~GuiItem() {
+    if(draw_cache_bmp) {
+        al_destroy_bitmap(draw_cache_bmp);
+    }
+}
+
+
 /**
  * @brief Activates the item.
  *
@@ -341,6 +393,19 @@ float GuiItem::get_child_bottom() {
 }
 
 
+/**
+ * @brief Returns what the item's drawing depends on, besides its size,
+ * selection, and juice animation. If this changes, the draw cache bitmap
+ * gets drawn again.
+ *
+ * @return The key.
+ */
+string GuiItem::get_draw_cache_key() const {
+    if(on_get_draw_cache_key) return on_get_draw_cache_key();
+    return "";
+}
+
+
 /**
  * @brief Returns the value related to the current juice animation.
  *
@@ -444,6 +509,16 @@ Point GuiItem::get_reference_size() {
 }
 
 
+/**
+ * @brief Makes the item's draw cache bitmap be drawn again the next time
+ * the item is drawn. Use this if something the drawing depends on changed,
+ * and it isn't part of the draw cache key.
+ */
+void GuiItem::invalidate_draw_cache() {
+    draw_cache_dirty = true;
+}
+
+
 /**
  * @brief Returns whether the mouse cursor is on top of it.
  *
@@ -635,7 +710,7 @@ void GuiManager::draw() {
             );
         }
         
-        i_ptr->on_draw(draw);
+        draw_item(i_ptr, draw);
         
         if(i_ptr->parent) {
             al_set_clipping_rectangle(ocr_x, ocr_y, ocr_w, ocr_h);
@@ -644,6 +719,79 @@ void GuiManager::draw() {
 }
 
 
+/**
+ * @brief Draws an item. If its drawing is cached, and nothing changed,
+ * this just draws the bitmap it drew to last time.
+ *
+ * @param item Item to draw.
+ * @param draw Information on how to draw it.
+ */
+void GuiManager::draw_item(GuiItem* item, const DrawInfo &draw) {
+    if(
+        !item->cache_drawing ||
+        item->selected || item->juice_type != GuiItem::JUICE_TYPE_NONE
+    ) {
+        //These change every frame, so there's no point in caching them.
+        //Once they stop, the cached bitmap will be out of date.
+        item->on_draw(draw);
+        item->draw_cache_dirty = true;
+        return;
+    }
+    
+    Point bmp_size = draw.size + GUI::DRAW_CACHE_PADDING * 2.0f;
+    int bmp_w = ceil(bmp_size.x);
+    int bmp_h = ceil(bmp_size.y);
+    if(bmp_w <= 0 || bmp_h <= 0) return;
+    
+    string key = item->get_draw_cache_key();
+    if(
+        item->draw_cache_bmp &&
+        (
+            item->draw_cache_size.x != draw.size.x ||
+            item->draw_cache_size.y != draw.size.y
+        )
+    ) {
+        al_destroy_bitmap(item->draw_cache_bmp);
+        item->draw_cache_bmp = nullptr;
+    }
+    
+    if(!item->draw_cache_bmp) {
+        item->draw_cache_bmp = al_create_bitmap(bmp_w, bmp_h);
+        if(!item->draw_cache_bmp) {
+            item->on_draw(draw);
+            return;
+        }
+        item->draw_cache_dirty = true;
+    }
+    
+    if(item->draw_cache_dirty || key != item->draw_cache_key) {
+        ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+        al_set_target_bitmap(item->draw_cache_bmp);
+        ALLEGRO_TRANSFORM identity;
+        al_identity_transform(&identity);
+        al_use_transform(&identity);
+        al_clear_to_color(COLOR_EMPTY);
+        
+        DrawInfo bmp_draw;
+        bmp_draw.center = Point(bmp_w, bmp_h) / 2.0f;
+        bmp_draw.size = draw.size;
+        item->on_draw(bmp_draw);
+        
+        al_set_target_bitmap(old_target);
+        item->draw_cache_size = draw.size;
+        item->draw_cache_key = key;
+        item->draw_cache_dirty = false;
+    }
+    
+    al_draw_bitmap(
+        item->draw_cache_bmp,
+        floor(draw.center.x - bmp_w / 2.0f + 0.5f),
+        floor(draw.center.y - bmp_h / 2.0f + 0.5f),
+        0
+    );
+}
+
+
 /**
  * @brief Returns the currently selected item's tooltip, if any.
  *
@@ -1252,6 +1400,16 @@ ListGuiItem::ListGuiItem() :
 }
 
 
+/**
+ * @brief Destroys the list gui item object.
+ */
+ListGuiItem::~ListGuiItem() {
+    for(size_t i = 0; i < virtual_row_pool.size(); i++) {
+        delete virtual_row_pool[i];
+    }
+}
+
+
 /**
  * @brief Default list GUI item child selected code.
  */
@@ -1400,6 +1558,126 @@ void ListGuiItem::def_tick_code(float delta_t) {
             }
         }
     }
+    
+    update_virtual_rows();
+}
+
+
+/**
+ * @brief Returns the bottommost Y coordinate, in height ratio,
+ * of the item's children items. In a virtualized list, this counts all of
+ * the rows, even the ones that don't exist as items right now.
+ *
+ * @return The Y coordinate.
+ */
+float ListGuiItem::get_child_bottom() {
+    if(!on_create_virtual_row) return GuiItem::get_child_bottom();
+    if(nr_virtual_rows == 0) return 0.0f;
+    return
+        (nr_virtual_rows - 1) * virtual_row_spacing + virtual_row_height;
+}
+
+
+/**
+ * @brief Returns the item currently used by the given virtual row,
+ * if it exists right now.
+ *
+ * @param row_idx Index of the row.
+ * @return The item, or nullptr if that row doesn't have one right now.
+ */
+GuiItem* ListGuiItem::get_virtual_row_item(size_t row_idx) const {
+    auto it = virtual_row_items.find(row_idx);
+    if(it == virtual_row_items.end()) return nullptr;
+    return it->second;
+}
+
+
+/**
+ * @brief Fills all existing virtual rows again, and creates or puts away
+ * row items as needed. Call this after the number of rows or their contents
+ * change.
+ */
+void ListGuiItem::refresh_virtual_rows() {
+    if(!on_create_virtual_row || !manager) return;
+    
+    for(auto it = virtual_row_items.begin(); it != virtual_row_items.end();) {
+        if(it->first >= nr_virtual_rows) {
+            remove_child(it->second);
+            manager->remove_item(it->second);
+            virtual_row_pool.push_back(it->second);
+            it = virtual_row_items.erase(it);
+            continue;
+        }
+        if(on_fill_virtual_row) on_fill_virtual_row(it->second, it->first);
+        it->second->invalidate_draw_cache();
+        ++it;
+    }
+    
+    float max_offset = std::max(0.0f, get_child_bottom() - 1.0f);
+    target_offset = std::clamp(target_offset, 0.0f, max_offset);
+    offset = std::clamp(offset, 0.0f, max_offset);
+    update_virtual_rows();
+}
+
+
+/**
+ * @brief Makes sure the virtual rows in or near the visible part of the
+ * list have items, reusing the items of rows that went out of range.
+ */
+void ListGuiItem::update_virtual_rows() {
+    if(!on_create_virtual_row || !manager) return;
+    if(virtual_row_spacing <= 0.0f) return;
+    
+    const float margin = GUI::VIRTUAL_LIST_MARGIN;
+    size_t first_row =
+        (size_t) std::max(
+            0.0f, floor((offset - margin) / virtual_row_spacing)
+        );
+    size_t end_row =
+        std::min(
+            nr_virtual_rows,
+            (size_t) std::max(
+                0.0f, ceil((offset + 1.0f + margin) / virtual_row_spacing)
+            )
+        );
+        
+    //Put away the items of rows that went out of range. The selected
+    //item stays, so the selection isn't lost.
+    for(auto it = virtual_row_items.begin(); it != virtual_row_items.end();) {
+        if(
+            (it->first >= first_row && it->first < end_row) ||
+            it->second == manager->selected_item
+        ) {
+            ++it;
+            continue;
+        }
+        remove_child(it->second);
+        manager->remove_item(it->second);
+        virtual_row_pool.push_back(it->second);
+        it = virtual_row_items.erase(it);
+    }
+    
+    //Give items to the rows in range that don't have one.
+    for(size_t r = first_row; r < end_row; r++) {
+        if(virtual_row_items.find(r) != virtual_row_items.end()) continue;
+        
+        GuiItem* item = nullptr;
+        if(!virtual_row_pool.empty()) {
+            item = virtual_row_pool.back();
+            virtual_row_pool.pop_back();
+        } else {
+            item = on_create_virtual_row();
+        }
+        add_child(item);
+        manager->add_item(item);
+        
+        item->ratio_center.y =
+            virtual_row_height / 2.0f + r * virtual_row_spacing;
+        item->ratio_size.y = virtual_row_height;
+        if(on_fill_virtual_row) on_fill_virtual_row(item, r);
+        item->invalidate_draw_cache();
+        virtual_row_items[r] = item;
+    }
 }
 
 
@@ -1496,7 +1774,7 @@ void PickerGuiItem::def_draw_code(const DrawInfo &draw) {
         draw.size.x * 0.10 * GUI::STANDARD_CONTENT_SIZE.x,
         draw.size.y * GUI::STANDARD_CONTENT_SIZE.y
     );
-    draw_text(
+    draw_cached_text(
         "<",
         game.sys_content.fnt_standard,
         Point(draw.center.x - draw.size.x * 0.45, draw.center.y),
@@ -1510,7 +1788,7 @@ void PickerGuiItem::def_draw_code(const DrawInfo &draw) {
         arrow_highlight_scale :
         arrow_regular_scale
     );
-    draw_text(
+    draw_cached_text(
         ">",
         game.sys_content.fnt_standard,
         Point(draw.center.x + draw.size.x * 0.45, draw.center.y),
@@ -1528,7 +1806,7 @@ void PickerGuiItem::def_draw_code(const DrawInfo &draw) {
     float juicy_grow_amount = this->get_juice_value();
     
     Point text_box(draw.size.x * 0.80, draw.size.y * GUI::STANDARD_CONTENT_SIZE.y);
-    draw_text(
+    draw_cached_text(
         this->base_text + this->option,
         game.sys_content.fnt_standard,
         Point(draw.center.x - draw.size.x * 0.40, draw.center.y),
@@ -1706,13 +1984,11 @@ void TextGuiItem::def_draw_code(const DrawInfo &draw) {
     
         text_y = draw.center.y - draw.size.y / 2.0f;
         int line_height = al_get_font_line_height(this->font);
-        vector<StringToken> tokens =
-            tokenize_string(this->text);
-        set_string_token_widths(
-            tokens, this->font, game.sys_content.fnt_slim, line_height, false
-        );
-        vector<vector<StringToken> > tokens_per_line =
-            split_long_string_with_tokens(tokens, draw.size.x);
+        const vector<vector<StringToken> > &tokens_per_line =
+            game.text_layout_cache.get_lines(
+                this->text, this->font, game.sys_content.fnt_slim,
+                line_height, false, draw.size.x
+            );
             
         for(size_t l = 0; l < tokens_per_line.size(); l++) {
             draw_string_tokens(
@@ -1730,7 +2006,7 @@ void TextGuiItem::def_draw_code(const DrawInfo &draw) {
         
     } else {
     
-        draw_text(
+        draw_cached_text(
             this->text, this->font, Point(text_x, text_y), draw.size,
             this->color, this->flags, V_ALIGN_MODE_CENTER,
             TEXT_SETTING_FLAG_CANT_GROW,
@@ -1749,6 +2025,17 @@ void TextGuiItem::def_draw_code(const DrawInfo &draw) {
 }
 
 
+/**
+ * @brief Returns what the text item's drawing depends on, for the
+ * draw cache.
+ *
+ * @return The key.
+ */
+string TextGuiItem::get_draw_cache_key() const {
+    return text;
+}
+
+
 /**
  * @brief Constructs a new tooltip gui item object.
  *
@@ -1775,7 +2062,7 @@ void TooltipGuiItem::def_draw_code(const DrawInfo &draw) {
         this->prev_text = cur_text;
     }
     float juicy_grow_amount = get_juice_value();
-    draw_text(
+    draw_cached_text(
         cur_text, game.sys_content.fnt_standard,
         draw.center, draw.size,
         COLOR_WHITE, ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER,
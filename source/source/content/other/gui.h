@@ -37,6 +37,7 @@ extern const float AUTO_REPEAT_MIN_INTERVAL;
 extern const float AUTO_REPEAT_RAMP_TIME;
 extern const float BULLET_PADDING;
 extern const float BULLET_RADIUS;
+extern const float DRAW_CACHE_PADDING;
 extern const float JUICY_GROW_DURATION;
 extern const float JUICY_GROW_ELASTIC_DURATION;
 extern const float JUICY_GROW_ICON_MULT;
@@ -44,6 +45,7 @@ extern const float JUICY_GROW_TEXT_HIGH_MULT;
 extern const float JUICY_GROW_TEXT_LOW_MULT;
 extern const float JUICY_GROW_TEXT_MEDIUM_MULT;
 extern const Point STANDARD_CONTENT_SIZE;
+extern const float VIRTUAL_LIST_MARGIN;
 }
 
 
@@ -183,6 +185,23 @@ public:
     //Timer that controls the current juice animation.
     float juice_timer = 0.0f;
     
+    //Should what it draws be kept in a bitmap, and reused for as long as
+    //it doesn't change? Only use this if its drawing depends on nothing but
+    //its size, selection, juice animation, and draw cache key.
+    bool cache_drawing = false;
+    
+    //Bitmap with what it drew last, if its drawing is cached.
+    ALLEGRO_BITMAP* draw_cache_bmp = nullptr;
+    
+    //Size it had when the draw cache bitmap was drawn.
+    Point draw_cache_size;
+    
+    //Draw cache key it had when the draw cache bitmap was drawn.
+    string draw_cache_key;
+    
+    //Does the draw cache bitmap need to be drawn again?
+    bool draw_cache_dirty = true;
+    
     //What to do when it's time to draw it.
     std::function<void(const DrawInfo &draw)> on_draw = nullptr;
     
@@ -210,21 +229,26 @@ public:
     //What to do when its tooltip needs to be retrieved.
     std::function<string()> on_get_tooltip = nullptr;
     
+    //What to do when its draw cache key needs to be retrieved.
+    std::function<string()> on_get_draw_cache_key = nullptr;
+    
     
     //--- Function declarations ---
     
     explicit GuiItem(bool selectable = false);
-    virtual ~GuiItem() = default;
+    virtual ~GuiItem();
     bool activate(const Point &cursor_pos);
     void add_child(GuiItem* item);
     void delete_all_children();
-    float get_child_bottom();
+    virtual float get_child_bottom();
+    virtual string get_draw_cache_key() const;
     float get_juice_value();
     Point get_reference_center();
     Point get_reference_size();
     bool is_mouse_on(const Point &cursor_pos);
     bool is_responsive();
     bool is_visible();
+    void invalidate_draw_cache();
     void remove_child(GuiItem* item);
     void start_juice_animation(JUICE_TYPE type);
     
@@ -259,6 +283,7 @@ public:
     );
     
     void def_draw_code(const DrawInfo &draw);
+    string get_draw_cache_key() const override;
     
 };
 
@@ -290,6 +315,7 @@ public:
     );
     
     void def_draw_code(const DrawInfo &draw);
+    string get_draw_cache_key() const override;
     
 };
 
@@ -333,6 +359,7 @@ public:
     
     void def_activate_code();
     void def_draw_code(const DrawInfo &draw);
+    string get_draw_cache_key() const override;
     
 };
 
@@ -351,15 +378,54 @@ public:
     //What the offset is supposed to be, after it finishes animating.
     float target_offset = 0.0f;
     
+    //If on_create_virtual_row is set, the list is virtualized, and has this
+    //many rows. Only the rows in or near the visible part exist as
+    //child items, and those get reused for other rows as the list scrolls.
+    size_t nr_virtual_rows = 0;
+    
+    //Height of each virtual row, in height ratio.
+    float virtual_row_height = 0.09f;
     
+    //Distance between the tops of consecutive virtual rows, in height ratio.
+    float virtual_row_spacing = 0.10f;
+    
+    //Creates a new item to use for virtual rows. It only needs to set up
+    //the parts that all rows share, like the X coordinate and width.
+    std::function<GuiItem*()> on_create_virtual_row = nullptr;
+    
+    //Sets up an item with the contents of the given virtual row.
+    std::function<void(GuiItem* item, size_t row_idx)> on_fill_virtual_row =
+        nullptr;
+        
+        
     //--- Function declarations ---
     
     ListGuiItem();
+    ~ListGuiItem();
     
     void def_child_selected_code(const GuiItem* child);
     void def_draw_code(const DrawInfo &draw);
     void def_event_code(const ALLEGRO_EVENT  &ev);
     void def_tick_code(float delta_t);
+    float get_child_bottom() override;
+    GuiItem* get_virtual_row_item(size_t row_idx) const;
+    void refresh_virtual_rows();
+    
+private:
+
+    //--- Members ---
+    
+    //Items of the virtual rows that currently exist, by row index.
+    map<size_t, GuiItem*> virtual_row_items;
+    
+    //Items that aren't used by any virtual row right now, ready for reuse.
+    //They're not children of the list, nor in the GUI manager.
+    vector<GuiItem*> virtual_row_pool;
+    
+    
+    //--- Function declarations ---
+    
+    void update_virtual_rows();
     
 };
 
@@ -477,6 +543,7 @@ public:
     );
     
     void def_draw_code(const DrawInfo &draw);
+    string get_draw_cache_key() const override;
     
 };
 
@@ -619,4 +686,9 @@ private:
     //Are the items currently visible?
     bool visible = true;
     
+    
+    //--- Function declarations ---
+    
+    void draw_item(GuiItem* item, const GuiItem::DrawInfo &draw);
+    
 };
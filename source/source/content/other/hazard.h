@@ -12,12 +12,14 @@
 
 #include <allegro5/allegro.h>
 
+#include <bitset>
 #include <string>
 #include <vector>
 
 #include "../../core/const.h"
 #include "../../lib/data_file/data_file.h"
 #include "../../util/drawing_utils.h"
+#include "../../util/general_utils.h"
 #include "../content.h"
 
 
@@ -25,6 +27,14 @@ using std::string;
 using std::vector;
 
 
+//Maximum number of hazards that can be loaded at once. Path cache keys
+//compare hazard sets as a single 64-bit number, so this can't go past 64.
+constexpr size_t N_MAX_HAZARDS = 64;
+
+//A set of hazards, with each hazard's bit at its index.
+typedef std::bitset<N_MAX_HAZARDS> hazard_set_t;
+
+
 struct Liquid;
 class StatusType;
 
@@ -53,6 +63,10 @@ struct Hazard : public Content {
     //If it's got an associated liquid, this points to it.
     Liquid* associated_liquid = nullptr;
     
+    //Index among all loaded hazards, which is also its bit in hazard sets.
+    //INVALID if it doesn't have one.
+    size_t idx = INVALID;
+    
     
     //--- Function declarations ---
     
@@ -32,7 +32,7 @@
 void EasyFsmCreator::change_state(const string &new_state) {
     cur_event->actions.push_back(new MobActionCall(MOB_ACTION_SET_STATE));
     cur_event->actions.back()->args.push_back(new_state);
-    cur_event->actions.back()->arg_is_var.push_back(false);
+    cur_event->actions.back()->compile_operands();
 }
 
 
@@ -201,14 +201,93 @@ MobEvent::MobEvent(const MOB_EV t, const vector<MobActionCall*> &a) :
 }
 
 
+/**
+ * @brief Finds where each "if", "else" and "goto" action jumps to, so
+ * running the event doesn't need to search for it every time.
+ * This needs to be called whenever the list of actions changes.
+ */
+void MobEvent::resolve_jumps() {
+    jump_idxs.assign(actions.size(), INVALID);
+    
+    for(size_t a = 0; a < actions.size(); a++) {
+        switch(actions[a]->action->type) {
+        case MOB_ACTION_IF:
+        case MOB_ACTION_ELSE: {
+            //An "if" that fails skips to its "else" or "end if", and
+            //an "else" that's reached skips to its "end if".
+            bool stop_at_else = actions[a]->action->type == MOB_ACTION_IF;
+            size_t next_a = a + 1;
+            size_t depth = 0;
+            for(; next_a < actions.size(); next_a++) {
+                MOB_ACTION next_type = actions[next_a]->action->type;
+                if(next_type == MOB_ACTION_IF) {
+                    depth++;
+                } else if(next_type == MOB_ACTION_ELSE && stop_at_else) {
+                    if(depth == 0) break;
+                } else if(next_type == MOB_ACTION_END_IF) {
+                    if(depth == 0) break;
+                    else depth--;
+                }
+            }
+            jump_idxs[a] = next_a;
+            break;
+                
+        } case MOB_ACTION_GOTO: {
+            //Find the label that matches. If there's none, carry on.
+            jump_idxs[a] = a;
+            for(size_t a2 = 0; a2 < actions.size(); a2++) {
+                if(actions[a2]->action->type == MOB_ACTION_LABEL) {
+                    if(actions[a]->args[0] == actions[a2]->args[0]) {
+                        jump_idxs[a] = a2;
+                        break;
+                    }
+                }
+            }
+            break;
+                
+        } default: {
+            break;
+        }
+        }
+    }
+}
+
+
 /**
  * @brief Runs a mob event. Basically runs all actions within.
+ * If the script profiler is on, this also keeps track of how long it took.
  *
  * @param m The mob.
  * @param custom_data_1 Custom argument #1 to pass to the code.
  * @param custom_data_2 Custom argument #2 to pass to the code.
  */
 void MobEvent::run(Mob* m, void* custom_data_1, void* custom_data_2) {
+    if(!game.perf_mon || !game.perf_mon->is_profiling_scripts()) {
+        run_actions(m, custom_data_1, custom_data_2);
+        return;
+    }
+    
+    //The state is fetched before running, since the event can change it.
+    const MobState* state = m->fsm.cur_state;
+    double start = al_get_time();
+    run_actions(m, custom_data_1, custom_data_2);
+    game.perf_mon->add_script_event_cost(
+        &m->type->name, state ? &state->name : nullptr, type,
+        al_get_time() - start
+    );
+}
+
+
+/**
+ * @brief Runs all of the event's actions, following any jumps.
+ *
+ * @param m The mob.
+ * @param custom_data_1 Custom argument #1 to pass to the code.
+ * @param custom_data_2 Custom argument #2 to pass to the code.
+ */
+void MobEvent::run_actions(
+    Mob* m, void* custom_data_1, void* custom_data_2
+) {
     if(m->parent && m->parent->relay_events) {
         m->parent->m->fsm.run_event(type, custom_data_1, custom_data_2);
         if(!m->parent->handle_events) {
@@ -226,58 +305,23 @@ void MobEvent::run(Mob* m, void* custom_data_1, void* custom_data_2) {
             if(!actions[a]->run(m, custom_data_1, custom_data_2)) {
                 //If it returned true, execution continues as normal, but
                 //if it returned false, skip to the "else" or "end if" actions.
-                size_t next_a = a + 1;
-                size_t depth = 0;
-                for(; next_a < actions.size(); next_a++) {
-                    if(
-                        actions[next_a]->action->type == MOB_ACTION_IF
-                    ) {
-                        depth++;
-                    } else if(
-                        actions[next_a]->action->type == MOB_ACTION_ELSE
-                    ) {
-                        if(depth == 0) break;
-                    } else if(
-                        actions[next_a]->action->type == MOB_ACTION_END_IF
-                    ) {
-                        if(depth == 0) break;
-                        else depth--;
-                    }
-                }
-                a = next_a;
-                
+                a = jump_idxs[a];
+                    
             }
-            
+                
             break;
             
         } case MOB_ACTION_ELSE: {
             //If we actually managed to read an "else", that means we were
             //running through the normal execution of a "then" section.
             //Jump to the "end if".
-            size_t next_a = a + 1;
-            size_t depth = 0;
-            for(; next_a < actions.size(); next_a++) {
-                if(actions[next_a]->action->type == MOB_ACTION_IF) {
-                    depth++;
-                } else if(actions[next_a]->action->type == MOB_ACTION_END_IF) {
-                    if(depth == 0) break;
-                    else depth--;
-                }
-            }
-            a = next_a;
-            
+            a = jump_idxs[a];
+                
             break;
             
         } case MOB_ACTION_GOTO: {
-            //Find the label that matches.
-            for(size_t a2 = 0; a2 < actions.size(); a2++) {
-                if(actions[a2]->action->type == MOB_ACTION_LABEL) {
-                    if(actions[a]->args[0] == actions[a2]->args[0]) {
-                        a = a2;
-                        break;
-                    }
-                }
-            }
+            //Jump to the label that matches.
+            a = jump_idxs[a];
             break;
             
         } case MOB_ACTION_END_IF:
@@ -467,6 +511,8 @@ MobEvent* MobState::get_event(const MOB_EV type) const {
 /**
  * @brief Fixes some things in the list of states.
  * For instance, state-switching actions that use a name instead of an index.
+ * This also prepares the events to be run, and notes down which events
+ * the mob type handles.
  *
  * @param states The vector of states.
  * @param starting_state Name of the starting state for the mob.
@@ -474,10 +520,11 @@ MobEvent* MobState::get_event(const MOB_EV type) const {
  * @return The index of the starting state.
  */
 size_t fix_states(
-    vector<MobState*> &states, const string &starting_state, const MobType* mt
+    vector<MobState*> &states, const string &starting_state, MobType* mt
 ) {
     size_t starting_state_idx = INVALID;
-    
+    mt->handled_events.reset();
+
     //Fix actions that change the state that are using a string.
     for(size_t s = 0; s < states.size(); s++) {
         MobState* state = states[s];
@@ -486,7 +533,9 @@ size_t fix_states(
         for(size_t e = 0; e < N_MOB_EVENTS; e++) {
             MobEvent* ev = state->events[e];
             if(!ev) continue;
-            
+        
+            mt->handled_events.set(e);
+        
             for(size_t a = 0; a < ev->actions.size(); a++) {
                 MobActionCall* call = ev->actions[a];
                 
@@ -516,15 +565,236 @@ size_t fix_states(
                     }
                     
                     call->args[0] = i2s(state_idx);
+                    call->compile_operands();
                     
                 }
             }
+        
+            ev->resolve_jumps();
         }
     }
     return starting_state_idx;
 }
 
 
+/**
+ * @brief Returns the name of a script event type, as used in script files.
+ * Events that can only be handled by the engine get a name too.
+ *
+ * @param type Type of event.
+ * @return The name.
+ */
+string get_mob_event_name(const MOB_EV type) {
+    switch(type) {
+    case MOB_EV_UNKNOWN: {
+        return "unknown";
+    }
+    case MOB_EV_ON_ENTER: {
+        return "on_enter";
+    }
+    case MOB_EV_ON_LEAVE: {
+        return "on_leave";
+    }
+    case MOB_EV_ON_TICK: {
+        return "on_tick";
+    }
+    case MOB_EV_ON_READY: {
+        return "on_ready";
+    }
+    case MOB_EV_ANIMATION_END: {
+        return "on_animation_end";
+    }
+    case MOB_EV_BOTTOMLESS_PIT: {
+        return "bottomless_pit";
+    }
+    case MOB_EV_DAMAGE: {
+        return "on_damage";
+    }
+    case MOB_EV_FAR_FROM_HOME: {
+        return "on_far_from_home";
+    }
+    case MOB_EV_FOCUS_DIED: {
+        return "focus_died";
+    }
+    case MOB_EV_FOCUS_OFF_REACH: {
+        return "on_focus_off_reach";
+    }
+    case MOB_EV_FRAME_SIGNAL: {
+        return "on_frame_signal";
+    }
+    case MOB_EV_HELD: {
+        return "on_held";
+    }
+    case MOB_EV_HITBOX_TOUCH_EAT: {
+        return "on_hitbox_touch_eat";
+    }
+    case MOB_EV_INPUT_RECEIVED: {
+        return "on_input_received";
+    }
+    case MOB_EV_ITCH: {
+        return "on_itch";
+    }
+    case MOB_EV_LEFT_HAZARD: {
+        return "on_leave_hazard";
+    }
+    case MOB_EV_OBJECT_IN_REACH: {
+        return "on_object_in_reach";
+    }
+    case MOB_EV_OPPONENT_IN_REACH: {
+        return "on_opponent_in_reach";
+    }
+    case MOB_EV_THROWN_PIKMIN_LANDED: {
+        return "on_pikmin_land";
+    }
+    case MOB_EV_REACHED_DESTINATION: {
+        return "on_reach_destination";
+    }
+    case MOB_EV_RECEIVE_MESSAGE: {
+        return "on_receive_message";
+    }
+    case MOB_EV_RELEASED: {
+        return "on_released";
+    }
+    case MOB_EV_RIDER_ADDED: {
+        return "rider_added";
+    }
+    case MOB_EV_RIDER_REMOVED: {
+        return "rider_removed";
+    }
+    case MOB_EV_SWALLOWED: {
+        return "on_swallowed";
+    }
+    case MOB_EV_TOUCHED_ACTIVE_LEADER: {
+        return "touched_active_leader";
+    }
+    case MOB_EV_TOUCHED_HAZARD: {
+        return "on_touch_hazard";
+    }
+    case MOB_EV_TOUCHED_SPRAY: {
+        return "touched_spray";
+    }
+    case MOB_EV_TOUCHED_OBJECT: {
+        return "on_touch_object";
+    }
+    case MOB_EV_TOUCHED_OPPONENT: {
+        return "on_touch_opponent";
+    }
+    case MOB_EV_TOUCHED_WALL: {
+        return "on_touch_wall";
+    }
+    case MOB_EV_TIMER: {
+        return "on_timer";
+    }
+    case MOB_EV_WEIGHT_ADDED: {
+        return "on_weight_added";
+    }
+    case MOB_EV_WEIGHT_REMOVED: {
+        return "on_weight_removed";
+    }
+    case MOB_EV_PLUCKED: {
+        return "plucked";
+    }
+    case MOB_EV_GRABBED_BY_FRIEND: {
+        return "grabbed_by_friend";
+    }
+    case MOB_EV_DISMISSED: {
+        return "dismissed";
+    }
+    case MOB_EV_THROWN: {
+        return "thrown";
+    }
+    case MOB_EV_LANDED: {
+        return "on_land";
+    }
+    case MOB_EV_RELEASE_ORDER: {
+        return "release_order";
+    }
+    case MOB_EV_WHISTLED: {
+        return "whistled";
+    }
+    case MOB_EV_SPOT_IS_FAR: {
+        return "spot_is_far";
+    }
+    case MOB_EV_SWARM_STARTED: {
+        return "swarm_started";
+    }
+    case MOB_EV_SWARM_ENDED: {
+        return "swarm_ended";
+    }
+    case MOB_EV_GO_TO_ONION: {
+        return "go_to_onion";
+    }
+    case MOB_EV_FINISHED_CARRYING: {
+        return "finished_carrying";
+    }
+    case MOB_EV_NEAR_CARRIABLE_OBJECT: {
+        return "near_carriable_object";
+    }
+    case MOB_EV_NEAR_TOOL: {
+        return "near_tool";
+    }
+    case MOB_EV_NEAR_GROUP_TASK: {
+        return "near_group_task";
+    }
+    case MOB_EV_HITBOX_TOUCH_A_N: {
+        return "on_hitbox_touch_a_n";
+    }
+    case MOB_EV_HITBOX_TOUCH_N_A: {
+        return "hitbox_touch_n_a";
+    }
+    case MOB_EV_HITBOX_TOUCH_N_N: {
+        return "on_hitbox_touch_n_n";
+    }
+    case MOB_EV_PIKMIN_DAMAGE_CONFIRMED: {
+        return "pikmin_damage_confirmed";
+    }
+    case MOB_EV_CARRIER_ADDED: {
+        return "carrier_added";
+    }
+    case MOB_EV_CARRIER_REMOVED: {
+        return "carrier_removed";
+    }
+    case MOB_EV_CARRY_BEGIN_MOVE: {
+        return "carry_begin_move";
+    }
+    case MOB_EV_CARRY_STOP_MOVE: {
+        return "carry_stop_move";
+    }
+    case MOB_EV_CARRY_DELIVERED: {
+        return "carry_delivered";
+    }
+    case MOB_EV_PATH_BLOCKED: {
+        return "path_blocked";
+    }
+    case MOB_EV_PATHS_CHANGED: {
+        return "paths_changed";
+    }
+    case MOB_EV_FOCUSED_MOB_UNAVAILABLE: {
+        return "focused_mob_unavailable";
+    }
+    case MOB_EV_STARTED_RECEIVING_DELIVERY: {
+        return "on_start_receiving_delivery";
+    }
+    case MOB_EV_FINISHED_RECEIVING_DELIVERY: {
+        return "on_finish_receiving_delivery";
+    }
+    case MOB_EV_TOUCHED_DROP: {
+        return "touched_drop";
+    }
+    case MOB_EV_TOUCHED_TRACK: {
+        return "touched_track";
+    }
+    case MOB_EV_TOUCHED_BOUNCER: {
+        return "touched_bouncer";
+    }
+    case MOB_EV_ZERO_HEALTH: {
+        return "zero_health";
+    }
+    }
+    return "unknown";
+}
+
+
 /**
  * @brief Loads the states from the script and global events data nodes.
  *
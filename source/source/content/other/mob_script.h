@@ -329,6 +329,10 @@ public:
     //Actions to run.
     vector<MobActionCall*> actions;
     
+    //For each "if", "else" and "goto" action, the index of the action
+    //to continue from if it jumps. Cache for performance.
+    vector<size_t> jump_idxs;
+    
     
     //--- Function declarations ---
     
@@ -340,6 +344,13 @@ public:
         const vector<MobActionCall*> &a = vector<MobActionCall*>()
     );
     void run(Mob* m, void* custom_data_1 = nullptr, void* custom_data_2 = nullptr);
+    void resolve_jumps();
+    
+private:
+
+    //--- Function declarations ---
+    
+    void run_actions(Mob* m, void* custom_data_1, void* custom_data_2);
     
 };
 
@@ -493,8 +504,9 @@ struct HitboxInteraction {
 
 
 size_t fix_states(
-    vector<MobState*> &states, const string &starting_state, const MobType* mt
+    vector<MobState*> &states, const string &starting_state, MobType* mt
 );
+string get_mob_event_name(const MOB_EV type);
 void load_script(
     MobType* mt, DataNode* script_node, DataNode* global_node,
     vector<MobState*>* out_states
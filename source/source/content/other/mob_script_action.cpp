@@ -10,6 +10,7 @@
  */
 
 #include <algorithm>
+#include <climits>
 
 #include "mob_script_action.h"
 
@@ -58,6 +59,42 @@ MobActionCall::MobActionCall(custom_action_code_t code) :
 }
 
 
+/**
+ * @brief Compiles the arguments into operands, pre-parsing the value
+ * of every constant argument so that running the action doesn't need to.
+ * Every variable name is interned into the mob type's table here, so
+ * that the table doesn't change during gameplay.
+ * This must be called again whenever the arguments change.
+ */
+void MobActionCall::compile_operands() {
+    operands.resize(args.size());
+    for(size_t a = 0; a < args.size(); a++) {
+        MobActionOperand &operand = operands[a];
+        operand.var_slot = INVALID;
+        if(operand.is_var) {
+            if(mt) operand.var_slot = mt->script_vars.intern(args[a]);
+            continue;
+        }
+        if(mt && action && !action->parameters.empty()) {
+            size_t param_idx = std::min(a, action->parameters.size() - 1);
+            if(
+                action->parameters[param_idx].type ==
+                MOB_ACTION_PARAM_VAR_NAME
+            ) {
+                operand.var_slot = mt->script_vars.intern(args[a]);
+            }
+        }
+        double number = s2f(args[a]);
+        operand.f_value = (float) number;
+        operand.has_i_value =
+            number >= INT_MIN && number <= INT_MAX &&
+            number == (double) (int) number;
+        operand.i_value = operand.has_i_value ? (int) number : 0;
+        operand.b_value = s2b(args[a]);
+    }
+}
+
+
 /**
  * @brief Loads a mob action call from a data node.
  *
@@ -161,24 +198,30 @@ bool MobActionCall::load_from_data_node(DataNode* dn, MobType* mt) {
         }
         
         args.push_back(words[w]);
-        arg_is_var.push_back(is_var);
+        MobActionOperand operand;
+        operand.is_var = is_var;
+        operands.push_back(operand);
     }
     
     //If this action needs extra parsing, do it now.
+    bool success = true;
     if(action->extra_load_logic) {
-        bool success = action->extra_load_logic(*this);
+        success = action->extra_load_logic(*this);
         if(!custom_error.empty()) {
             game.errors.report(custom_error, dn);
         }
-        return success;
     }
     
-    return true;
+    //Now that the arguments are final, pre-parse the constant ones.
+    compile_operands();
+    
+    return success;
 }
 
 
 /**
  * @brief Runs an action.
+ * If the script profiler is on, this also keeps track of how long it took.
  *
  * @param m The mob.
  * @param custom_data_1 Custom argument #1 to pass to the code.
@@ -195,18 +238,18 @@ bool MobActionCall::run(
     }
     
     MobActionRunData data(m, this);
-    
-    //Fill the arguments. Fetch values from variables if needed.
-    data.args = args;
-    for(size_t a = 0; a < args.size(); a++) {
-        if(arg_is_var[a]) {
-            data.args[a] = m->vars[args[a]];
-        }
-    }
     data.custom_data_1 = custom_data_1;
     data.custom_data_2 = custom_data_2;
     
-    action->code(data);
+    if(game.perf_mon && game.perf_mon->is_profiling_scripts()) {
+        double start = al_get_time();
+        action->code(data);
+        game.perf_mon->add_script_action_cost(
+            &action->name, al_get_time() - start
+        );
+    } else {
+        action->code(data);
+    }
     return data.return_value;
 }
 
@@ -505,11 +548,13 @@ bool mob_action_loaders::play_sound(MobActionCall &call) {
  * @return Whether it succeeded.
  */
 bool mob_action_loaders::receive_status(MobActionCall &call) {
-    if(game.content.status_types.list.find(call.args[0]) == game.content.status_types.list.end()) {
+    auto s_it = game.content.status_types.list.find(call.args[0]);
+    if(s_it == game.content.status_types.list.end()) {
         call.custom_error =
             "Unknown status effect \"" + call.args[0] + "\"!";
         return false;
     }
+    call.operands[0].ptr_value = s_it->second;
     return true;
 }
 
@@ -521,11 +566,13 @@ bool mob_action_loaders::receive_status(MobActionCall &call) {
  * @return Whether it succeeded.
  */
 bool mob_action_loaders::remove_status(MobActionCall &call) {
-    if(game.content.status_types.list.find(call.args[0]) == game.content.status_types.list.end()) {
+    auto s_it = game.content.status_types.list.find(call.args[0]);
+    if(s_it == game.content.status_types.list.end()) {
         call.custom_error =
             "Unknown status effect \"" + call.args[0] + "\"!";
         return false;
     }
+    call.operands[0].ptr_value = s_it->second;
     return true;
 }
 
@@ -786,13 +833,135 @@ MobActionRunData::MobActionRunData(Mob* m, MobActionCall* call) :
 }
 
 
+/**
+ * @brief Returns the value of one of the arguments, as a string.
+ * If the argument is a variable, this returns the variable's value.
+ *
+ * @param idx Index of the argument.
+ * @return The value.
+ */
+string MobActionRunData::get_arg(size_t idx) const {
+    if(call->operands[idx].is_var) {
+        return get_operand_var(idx).get_text();
+    }
+    return call->args[idx];
+}
+
+
+/**
+ * @brief Returns the value of one of the arguments, as a bool.
+ *
+ * @param idx Index of the argument.
+ * @return The value.
+ */
+bool MobActionRunData::get_arg_bool(size_t idx) const {
+    const MobActionOperand &operand = call->operands[idx];
+    if(operand.is_var) {
+        return get_operand_var(idx).get_bool();
+    }
+    return operand.b_value;
+}
+
+
+/**
+ * @brief Returns the value of one of the arguments, as a float.
+ *
+ * @param idx Index of the argument.
+ * @return The value.
+ */
+float MobActionRunData::get_arg_float(size_t idx) const {
+    const MobActionOperand &operand = call->operands[idx];
+    if(operand.is_var) {
+        return get_operand_var(idx).get_float();
+    }
+    return operand.f_value;
+}
+
+
+/**
+ * @brief Returns the value of one of the arguments, as an int.
+ *
+ * @param idx Index of the argument.
+ * @return The value.
+ */
+int MobActionRunData::get_arg_int(size_t idx) const {
+    const MobActionOperand &operand = call->operands[idx];
+    if(operand.is_var) {
+        return get_operand_var(idx).get_int();
+    }
+    if(!operand.has_i_value) return s2i(call->args[idx]);
+    return operand.i_value;
+}
+
+
+/**
+ * @brief Returns the values of all arguments from a given one onward,
+ * separated by spaces.
+ *
+ * @param idx Index of the first argument.
+ * @return The values.
+ */
+string MobActionRunData::get_arg_tail(size_t idx) const {
+    string result = get_arg(idx);
+    for(size_t a = idx + 1; a < call->args.size(); a++) {
+        result += " " + get_arg(a);
+    }
+    return result;
+}
+
+
+/**
+ * @brief Returns the mob variable named by the value of one of the
+ * arguments, like the destination of a calculation. If the argument is
+ * a variable, the name is that variable's value.
+ *
+ * @param idx Index of the argument.
+ * @return The variable.
+ */
+ScriptVarValue &MobActionRunData::get_arg_var(size_t idx) const {
+    if(call->operands[idx].is_var) {
+        //The name is only known now, so there's no slot to remember.
+        return m->get_var(get_arg(idx));
+    }
+    return get_operand_var(idx);
+}
+
+
+/**
+ * @brief Returns how many arguments the call has.
+ *
+ * @return The amount.
+ */
+size_t MobActionRunData::get_nr_args() const {
+    return call->args.size();
+}
+
+
+/**
+ * @brief Returns the mob variable whose name is the text of one of the
+ * arguments, as written in the script. For variable arguments, this is
+ * the variable the value comes from.
+ *
+ * @param idx Index of the argument.
+ * @return The variable.
+ */
+ScriptVarValue &MobActionRunData::get_operand_var(size_t idx) const {
+    const MobActionOperand &operand = call->operands[idx];
+    if(m->type != call->mt || operand.var_slot == INVALID) {
+        //The slots are only valid for the mob type that owns the call.
+        return m->get_var(call->args[idx]);
+    }
+    return m->get_var_by_slot(operand.var_slot);
+}
+
+
 /**
  * @brief Code for the health addition mob script action.
  *
  * @param data Data about the action call.
  */
 void mob_action_runners::add_health(MobActionRunData &data) {
-    data.m->set_health(true, false, s2f(data.args[0]));
+    data.m->set_health(true, false, data.get_arg_float(0));
 }
 
 
@@ -803,7 +972,7 @@ void mob_action_runners::add_health(MobActionRunData &data) {
  */
 void mob_action_runners::arachnorb_plan_logic(MobActionRunData &data) {
     data.m->arachnorb_plan_logic(
-        (MOB_ACTION_ARACHNORB_PLAN_LOGIC_TYPE) s2i(data.args[0])
+        (MOB_ACTION_ARACHNORB_PLAN_LOGIC_TYPE) data.get_arg_int(0)
     );
 }
 
@@ -814,10 +983,10 @@ void mob_action_runners::arachnorb_plan_logic(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::calculate(MobActionRunData &data) {
-    float lhs = s2f(data.args[1]);
+    float lhs = data.get_arg_float(1);
     MOB_ACTION_CALCULATE_TYPE op =
-        (MOB_ACTION_CALCULATE_TYPE) s2i(data.args[2]);
-    float rhs = s2f(data.args[3]);
+        (MOB_ACTION_CALCULATE_TYPE) data.get_arg_int(2);
+    float rhs = data.get_arg_float(3);
     float result = 0;
     
     switch(op) {
@@ -852,7 +1021,7 @@ void mob_action_runners::calculate(MobActionRunData &data) {
     }
     }
     
-    data.m->vars[data.args[0]] = f2s(result);
+    data.get_arg_var(0).set_float(result);
 }
 
 
@@ -872,7 +1041,7 @@ void mob_action_runners::delete_function(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::drain_liquid(MobActionRunData &data) {
-    Sector* s_ptr = get_sector(data.m->pos, nullptr, true);
+    Sector* s_ptr = data.m->center_sector;
     if(!s_ptr) return;
     
     vector<Sector*> sectors_to_drain;
@@ -893,6 +1062,7 @@ void mob_action_runners::drain_liquid(MobActionRunData &data) {
         sectors_to_drain[s]->draining_liquid = true;
         sectors_to_drain[s]->liquid_drain_left =
             GEOMETRY::LIQUID_DRAIN_DURATION;
+        game.states.gameplay->add_ticking_sector(sectors_to_drain[s]);
     }
 }
 
@@ -914,7 +1084,7 @@ void mob_action_runners::finish_dying(MobActionRunData &data) {
  */
 void mob_action_runners::focus(MobActionRunData &data) {
 
-    MOB_ACTION_MOB_TARGET_TYPE s = (MOB_ACTION_MOB_TARGET_TYPE) s2i(data.args[0]);
+    MOB_ACTION_MOB_TARGET_TYPE s = (MOB_ACTION_MOB_TARGET_TYPE) data.get_arg_int(0);
     Mob* target = get_target_mob(data, s);
     
     if(!target) return;
@@ -930,8 +1100,8 @@ void mob_action_runners::focus(MobActionRunData &data) {
  */
 void mob_action_runners::follow_path_randomly(MobActionRunData &data) {
     string label;
-    if(data.args.size() >= 1) {
-        label = data.args[0];
+    if(data.get_nr_args() >= 1) {
+        label = data.get_arg(0);
     }
     
     //We need to decide what the final stop is going to be.
@@ -992,15 +1162,15 @@ void mob_action_runners::follow_path_randomly(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::follow_path_to_absolute(MobActionRunData &data) {
-    float x = s2f(data.args[0]);
-    float y = s2f(data.args[1]);
+    float x = data.get_arg_float(0);
+    float y = data.get_arg_float(1);
     
     PathFollowSettings settings;
     settings.target_point = Point(x, y);
     enable_flag(settings.flags, PATH_FOLLOW_FLAG_CAN_CONTINUE);
     enable_flag(settings.flags, PATH_FOLLOW_FLAG_SCRIPT_USE);
-    if(data.args.size() >= 3) {
-        settings.label = data.args[2];
+    if(data.get_nr_args() >= 3) {
+        settings.label = data.get_arg(2);
     }
     
     data.m->follow_path(
@@ -1015,13 +1185,13 @@ void mob_action_runners::follow_path_to_absolute(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_angle(MobActionRunData &data) {
-    float center_x = s2f(data.args[1]);
-    float center_y = s2f(data.args[2]);
-    float focus_x = s2f(data.args[3]);
-    float focus_y = s2f(data.args[4]);
+    float center_x = data.get_arg_float(1);
+    float center_y = data.get_arg_float(2);
+    float focus_x = data.get_arg_float(3);
+    float focus_y = data.get_arg_float(4);
     float angle = get_angle(Point(center_x, center_y), Point(focus_x, focus_y));
     angle = rad_to_deg(angle);
-    data.m->vars[data.args[0]] = f2s(angle);
+    data.get_arg_var(0).set_float(angle);
 }
 
 
@@ -1032,17 +1202,18 @@ void mob_action_runners::get_angle(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_area_info(MobActionRunData &data) {
-    string* var = &(data.m->vars[data.args[0]]);
     MOB_ACTION_GET_AREA_INFO_TYPE t =
-        (MOB_ACTION_GET_AREA_INFO_TYPE) s2i(data.args[1]);
-        
+        (MOB_ACTION_GET_AREA_INFO_TYPE) data.get_arg_int(1);
+    //Fetch the variable last, since reading the others can move it.
+    ScriptVarValue* var = &data.get_arg_var(0);
+    
     switch (t) {
     case MOB_ACTION_GET_AREA_INFO_TYPE_DAY_MINUTES: {
-        *var = i2s(game.states.gameplay->day_minutes);
+        var->set_int(game.states.gameplay->day_minutes);
         break;
         
     } case MOB_ACTION_GET_AREA_INFO_TYPE_FIELD_PIKMIN: {
-        *var = i2s(game.states.gameplay->mobs.pikmin_list.size());
+        var->set_int(game.states.gameplay->mobs.pikmin_list.size());
         break;
         
     }
@@ -1071,12 +1242,12 @@ void mob_action_runners::get_chomped(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_coordinates_from_angle(MobActionRunData &data) {
-    float angle = s2f(data.args[2]);
+    float angle = data.get_arg_float(2);
     angle = deg_to_rad(angle);
-    float magnitude = s2f(data.args[3]);
+    float magnitude = data.get_arg_float(3);
     Point p = angle_to_coordinates(angle, magnitude);
-    data.m->vars[data.args[0]] = f2s(p.x);
-    data.m->vars[data.args[1]] = f2s(p.y);
+    data.get_arg_var(0).set_float(p.x);
+    data.get_arg_var(1).set_float(p.y);
 }
 
 
@@ -1086,14 +1257,13 @@ void mob_action_runners::get_coordinates_from_angle(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_distance(MobActionRunData &data) {
-    float center_x = s2f(data.args[1]);
-    float center_y = s2f(data.args[2]);
-    float focus_x = s2f(data.args[3]);
-    float focus_y = s2f(data.args[4]);
-    data.m->vars[data.args[0]] =
-        f2s(
-            Distance(Point(center_x, center_y), Point(focus_x, focus_y)).to_float()
-        );
+    float center_x = data.get_arg_float(1);
+    float center_y = data.get_arg_float(2);
+    float focus_x = data.get_arg_float(3);
+    float focus_y = data.get_arg_float(4);
+    data.get_arg_var(0).set_float(
+        Distance(Point(center_x, center_y), Point(focus_x, focus_y)).to_float()
+    );
 }
 
 
@@ -1103,10 +1273,11 @@ void mob_action_runners::get_distance(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_event_info(MobActionRunData &data) {
-    string* var = &(data.m->vars[data.args[0]]);
     MOB_ACTION_GET_EV_INFO_TYPE t =
-        (MOB_ACTION_GET_EV_INFO_TYPE) s2i(data.args[1]);
-        
+        (MOB_ACTION_GET_EV_INFO_TYPE) data.get_arg_int(1);
+    //Fetch the variable last, since reading the others can move it.
+    ScriptVarValue* var = &data.get_arg_var(0);
+    
     switch (t) {
     case MOB_ACTION_GET_EV_INFO_TYPE_BODY_PART: {
         if(
@@ -1115,25 +1286,27 @@ void mob_action_runners::get_event_info(MobActionRunData &data) {
             data.call->parent_event == MOB_EV_HITBOX_TOUCH_N_N ||
             data.call->parent_event == MOB_EV_DAMAGE
         ) {
-            *var =
+            var->set_text(
                 (
                     (HitboxInteraction*)(data.custom_data_1)
-                )->h1->body_part_name;
+                )->h1->body_part_name
+            );
         } else if(
             data.call->parent_event == MOB_EV_TOUCHED_OBJECT ||
             data.call->parent_event == MOB_EV_TOUCHED_OPPONENT ||
             data.call->parent_event == MOB_EV_THROWN_PIKMIN_LANDED
         ) {
-            *var =
+            var->set_text(
                 data.m->get_closest_hitbox(
                     ((Mob*)(data.custom_data_1))->pos
-                )->body_part_name;
+                )->body_part_name
+            );
         }
         break;
         
     } case MOB_ACTION_GET_EV_INFO_TYPE_FRAME_SIGNAL: {
         if(data.call->parent_event == MOB_EV_FRAME_SIGNAL) {
-            *var = i2s(*((size_t*)(data.custom_data_1)));
+            var->set_int(*((size_t*)(data.custom_data_1)));
         }
         break;
         
@@ -1142,28 +1315,31 @@ void mob_action_runners::get_event_info(MobActionRunData &data) {
             data.call->parent_event == MOB_EV_TOUCHED_HAZARD ||
             data.call->parent_event == MOB_EV_LEFT_HAZARD
         ) {
-            *var = ((Hazard*)data.custom_data_1)->manifest->internal_name;
+            var->set_text(
+                ((Hazard*)data.custom_data_1)->manifest->internal_name
+            );
         }
         break;
         
     } case MOB_ACTION_GET_EV_INFO_TYPE_INPUT_NAME: {
         if(data.call->parent_event == MOB_EV_INPUT_RECEIVED) {
-            *var =
+            var->set_text(
                 game.controls.get_player_action_type_internal_name(
                     ((PlayerAction*) (data.custom_data_1))->actionTypeId
-                );
+                )
+            );
         }
         break;
         
     } case MOB_ACTION_GET_EV_INFO_TYPE_INPUT_VALUE: {
         if(data.call->parent_event == MOB_EV_INPUT_RECEIVED) {
-            *var = f2s(((PlayerAction*) (data.custom_data_1))->value);
+            var->set_float(((PlayerAction*) (data.custom_data_1))->value);
         }
         break;
         
     } case MOB_ACTION_GET_EV_INFO_TYPE_MESSAGE: {
         if(data.call->parent_event == MOB_EV_RECEIVE_MESSAGE) {
-            *var = *((string*)(data.custom_data_1));
+            var->set_text(*((string*)(data.custom_data_1)));
         }
         break;
         
@@ -1174,19 +1350,21 @@ void mob_action_runners::get_event_info(MobActionRunData &data) {
             data.call->parent_event == MOB_EV_HITBOX_TOUCH_N_N ||
             data.call->parent_event == MOB_EV_DAMAGE
         ) {
-            *var =
+            var->set_text(
                 (
                     (HitboxInteraction*)(data.custom_data_1)
-                )->h2->body_part_name;
+                )->h2->body_part_name
+            );
         } else if(
             data.call->parent_event == MOB_EV_TOUCHED_OBJECT ||
             data.call->parent_event == MOB_EV_TOUCHED_OPPONENT ||
             data.call->parent_event == MOB_EV_THROWN_PIKMIN_LANDED
         ) {
-            *var =
+            var->set_text(
                 ((Mob*)(data.custom_data_1))->get_closest_hitbox(
                     data.m->pos
-                )->body_part_name;
+                )->body_part_name
+            );
         }
         break;
         
@@ -1201,10 +1379,10 @@ void mob_action_runners::get_event_info(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_floor_z(MobActionRunData &data) {
-    float x = s2f(data.args[1]);
-    float y = s2f(data.args[2]);
+    float x = data.get_arg_float(1);
+    float y = data.get_arg_float(2);
     Sector* s = get_sector(Point(x, y), nullptr, true);
-    data.m->vars[data.args[0]] = f2s(s ? s->z : 0);
+    data.get_arg_var(0).set_float(s ? s->z : 0);
 }
 
 
@@ -1215,8 +1393,9 @@ void mob_action_runners::get_floor_z(MobActionRunData &data) {
  */
 void mob_action_runners::get_focus_var(MobActionRunData &data) {
     if(!data.m->focused_mob) return;
-    data.m->vars[data.args[0]] =
-        data.m->focused_mob->vars[data.args[1]];
+    ScriptVarValue value = data.m->focused_mob->get_var(data.get_arg(1));
+    value.was_set = true;
+    data.get_arg_var(0) = value;
 }
 
 
@@ -1226,91 +1405,92 @@ void mob_action_runners::get_focus_var(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_mob_info(MobActionRunData &data) {
-    MOB_ACTION_MOB_TARGET_TYPE s = (MOB_ACTION_MOB_TARGET_TYPE) s2i(data.args[1]);
+    MOB_ACTION_MOB_TARGET_TYPE s = (MOB_ACTION_MOB_TARGET_TYPE) data.get_arg_int(1);
     Mob* target = get_target_mob(data, s);
     
     if(!target) return;
     
-    string* var = &(data.m->vars[data.args[0]]);
     MOB_ACTION_GET_MOB_INFO_TYPE t =
-        (MOB_ACTION_GET_MOB_INFO_TYPE) s2i(data.args[2]);
-        
+        (MOB_ACTION_GET_MOB_INFO_TYPE) data.get_arg_int(2);
+    //Fetch the variable last, since reading the others can move it.
+    ScriptVarValue* var = &data.get_arg_var(0);
+    
     switch(t) {
     case MOB_ACTION_GET_MOB_INFO_TYPE_ANGLE: {
-        *var = f2s(rad_to_deg(target->angle));
+        var->set_float(rad_to_deg(target->angle));
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_CHOMPED_PIKMIN: {
-        *var = i2s(target->chomping_mobs.size());
+        var->set_int(target->chomping_mobs.size());
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_FOCUS_DISTANCE: {
         if(target->focused_mob) {
             float d =
                 Distance(target->pos, target->focused_mob->pos).to_float();
-            *var = f2s(d);
+            var->set_float(d);
         }
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_GROUP_TASK_POWER: {
         if(target->type->category->id == MOB_CATEGORY_GROUP_TASKS) {
-            *var = f2s(((GroupTask*)target)->get_power());
+            var->set_float(((GroupTask*)target)->get_power());
         }
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_HEALTH: {
-        *var = i2s(target->health);
+        var->set_int(target->health);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_HEALTH_RATIO: {
         if(target->max_health != 0.0f) {
-            *var = f2s(target->health / target->max_health);
+            var->set_float(target->health / target->max_health);
         } else {
-            *var = 0.0f;
+            var->set_float(0.0f);
         }
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_ID: {
-        *var = i2s(target->id);
+        var->set_int(target->id);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_LATCHED_PIKMIN: {
-        *var = i2s(target->get_latched_pikmin_amount());
+        var->set_int(target->get_latched_pikmin_amount());
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_LATCHED_PIKMIN_WEIGHT: {
-        *var = i2s(target->get_latched_pikmin_weight());
+        var->set_int(target->get_latched_pikmin_weight());
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_MOB_CATEGORY: {
-        *var = target->type->category->internal_name;
+        var->set_text(target->type->category->internal_name);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_MOB_TYPE: {
-        *var = target->type->manifest->internal_name;
+        var->set_text(target->type->manifest->internal_name);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_STATE: {
-        *var = target->fsm.cur_state->name;
+        var->set_text(target->fsm.cur_state->name);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_WEIGHT: {
         if(target->type->category->id == MOB_CATEGORY_SCALES) {
             Scale* s_ptr = (Scale*)(target);
-            *var = i2s(s_ptr->calculate_cur_weight());
+            var->set_int(s_ptr->calculate_cur_weight());
         }
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_X: {
-        *var = f2s(target->pos.x);
+        var->set_float(target->pos.x);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_Y: {
-        *var = f2s(target->pos.y);
+        var->set_float(target->pos.y);
         break;
         
     } case MOB_ACTION_GET_MOB_INFO_TYPE_Z: {
-        *var = f2s(target->z);
+        var->set_float(target->z);
         break;
     }
     }
@@ -1323,8 +1503,8 @@ void mob_action_runners::get_mob_info(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_random_float(MobActionRunData &data) {
-    data.m->vars[data.args[0]] =
-        f2s(game.rng.f(s2f(data.args[1]), s2f(data.args[2])));
+    float result = game.rng.f(data.get_arg_float(1), data.get_arg_float(2));
+    data.get_arg_var(0).set_float(result);
 }
 
 
@@ -1334,8 +1514,8 @@ void mob_action_runners::get_random_float(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::get_random_int(MobActionRunData &data) {
-    data.m->vars[data.args[0]] =
-        i2s(game.rng.i(s2i(data.args[1]), s2i(data.args[2])));
+    int result = game.rng.i(data.get_arg_int(1), data.get_arg_int(2));
+    data.get_arg_var(0).set_int(result);
 }
 
 
@@ -1384,8 +1564,8 @@ void mob_action_runners::hold_focus(MobActionRunData &data) {
     if(data.m->focused_mob) {
         data.m->hold(
             data.m->focused_mob,
-            s2i(data.args[0]), 0.0f, 0.0f, 0.5f,
-            data.args.size() >= 2 ? s2b(data.args[1]) : false,
+            data.get_arg_int(0), 0.0f, 0.0f, 0.5f,
+            data.get_nr_args() >= 2 ? data.get_arg_bool(1) : false,
             HOLD_ROTATION_METHOD_COPY_HOLDER
         );
     }
@@ -1398,42 +1578,48 @@ void mob_action_runners::hold_focus(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::if_function(MobActionRunData &data) {
-    string lhs = data.args[0];
     MOB_ACTION_IF_OP op =
-        (MOB_ACTION_IF_OP) s2i(data.args[1]);
-    string rhs = vector_tail_to_string(data.args, 2);
-    
-    switch(op) {
-    case MOB_ACTION_IF_OP_EQUAL: {
-        if(is_number(lhs) && is_number(rhs)) {
-            data.return_value = (s2f(lhs) == s2f(rhs));
-        } else {
-            data.return_value = (lhs == rhs);
-        }
-        break;
+        (MOB_ACTION_IF_OP) data.get_arg_int(1);
         
-    } case MOB_ACTION_IF_OP_NOT: {
+    if(op == MOB_ACTION_IF_OP_EQUAL || op == MOB_ACTION_IF_OP_NOT) {
+        string lhs = data.get_arg(0);
+        string rhs = data.get_arg_tail(2);
+        bool equal = false;
         if(is_number(lhs) && is_number(rhs)) {
-            data.return_value = (s2f(lhs) != s2f(rhs));
+            equal = (s2f(lhs) == s2f(rhs));
         } else {
-            data.return_value = (lhs != rhs);
+            equal = (lhs == rhs);
         }
-        break;
+        data.return_value = (op == MOB_ACTION_IF_OP_EQUAL) ? equal : !equal;
+        return;
+    }
+    
+    //Numeric comparisons don't need to go through text, unless the
+    //right-hand side is made up of several words.
+    float lhs = data.get_arg_float(0);
+    float rhs =
+        data.get_nr_args() == 3 ?
+        data.get_arg_float(2) :
+        s2f(data.get_arg_tail(2));
         
-    } case MOB_ACTION_IF_OP_LESS: {
-        data.return_value = (s2f(lhs) < s2f(rhs));
+    switch(op) {
+    case MOB_ACTION_IF_OP_LESS: {
+        data.return_value = (lhs < rhs);
         break;
         
     } case MOB_ACTION_IF_OP_MORE: {
-        data.return_value = (s2f(lhs) > s2f(rhs));
+        data.return_value = (lhs > rhs);
         break;
         
     } case MOB_ACTION_IF_OP_LESS_E: {
-        data.return_value = (s2f(lhs) <= s2f(rhs));
+        data.return_value = (lhs <= rhs);
         break;
         
     } case MOB_ACTION_IF_OP_MORE_E: {
-        data.return_value = (s2f(lhs) >= s2f(rhs));
+        data.return_value = (lhs >= rhs);
+        break;
+        
+    } default: {
         break;
         
     }
@@ -1458,7 +1644,7 @@ void mob_action_runners::link_with_focus(MobActionRunData &data) {
         }
     }
     
-    data.m->links.push_back(data.m->focused_mob);
+    data.m->add_link(data.m->focused_mob);
 }
 
 
@@ -1472,7 +1658,7 @@ void mob_action_runners::load_focus_memory(MobActionRunData &data) {
         return;
     }
     
-    data.m->focus_on_mob(data.m->focused_mob_memory[s2i(data.args[0])]);
+    data.m->focus_on_mob(data.m->focused_mob_memory[data.get_arg_int(0)]);
 }
 
 
@@ -1482,9 +1668,9 @@ void mob_action_runners::load_focus_memory(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::move_to_absolute(MobActionRunData &data) {
-    float x = s2f(data.args[0]);
-    float y = s2f(data.args[1]);
-    float z = data.args.size() > 2 ? s2f(data.args[2]) : data.m->z;
+    float x = data.get_arg_float(0);
+    float y = data.get_arg_float(1);
+    float z = data.get_nr_args() > 2 ? data.get_arg_float(2) : data.m->z;
     data.m->chase(Point(x, y), z);
 }
 
@@ -1495,9 +1681,9 @@ void mob_action_runners::move_to_absolute(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::move_to_relative(MobActionRunData &data) {
-    float x = s2f(data.args[0]);
-    float y = s2f(data.args[1]);
-    float z = (data.args.size() > 2 ? s2f(data.args[2]) : 0);
+    float x = data.get_arg_float(0);
+    float y = data.get_arg_float(1);
+    float z = (data.get_nr_args() > 2 ? data.get_arg_float(2) : 0);
     Point p = rotate_point(Point(x, y), data.m->angle);
     data.m->chase(data.m->pos + p, data.m->z + z);
 }
@@ -1509,7 +1695,7 @@ void mob_action_runners::move_to_relative(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::move_to_target(MobActionRunData &data) {
-    MOB_ACTION_MOVE_TYPE t = (MOB_ACTION_MOVE_TYPE) s2i(data.args[0]);
+    MOB_ACTION_MOVE_TYPE t = (MOB_ACTION_MOVE_TYPE) data.get_arg_int(0);
     
     switch(t) {
     case MOB_ACTION_MOVE_TYPE_AWAY_FROM_FOCUS: {
@@ -1585,9 +1771,9 @@ void mob_action_runners::order_release(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::play_sound(MobActionRunData &data) {
-    size_t sound_id = data.m->play_sound(s2i(data.args[0]));
-    if(data.args.size() >= 2) {
-        data.m->set_var(data.args[1], i2s(sound_id));
+    size_t sound_id = data.m->play_sound(data.get_arg_int(0));
+    if(data.get_nr_args() >= 2) {
+        data.m->set_var(data.get_arg(1), i2s(sound_id));
     }
 }
 
@@ -1598,7 +1784,7 @@ void mob_action_runners::play_sound(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::print(MobActionRunData &data) {
-    string text = vector_tail_to_string(data.args, 0);
+    string text = data.get_arg_tail(0);
     print_info(
         "[DEBUG PRINT] " + data.m->type->name + " says:\n" + text,
         10.0f
@@ -1612,7 +1798,8 @@ void mob_action_runners::print(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::receive_status(MobActionRunData &data) {
-    data.m->apply_status_effect(game.content.status_types.list[data.args[0]], false, false);
+    StatusType* s_type = (StatusType*) data.call->operands[0].ptr_value;
+    data.m->apply_status_effect(s_type, false, false);
 }
 
 
@@ -1642,8 +1829,9 @@ void mob_action_runners::release_stored_mobs(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::remove_status(MobActionRunData &data) {
+    StatusType* s_type = (StatusType*) data.call->operands[0].ptr_value;
     for(size_t s = 0; s < data.m->statuses.size(); s++) {
-        if(data.m->statuses[s].type->manifest->internal_name == data.args[0]) {
+        if(data.m->statuses[s].type == s_type) {
             data.m->statuses[s].to_delete = true;
         }
     }
@@ -1660,7 +1848,7 @@ void mob_action_runners::save_focus_memory(MobActionRunData &data) {
         return;
     }
     
-    data.m->focused_mob_memory[s2i(data.args[0])] = data.m->focused_mob;
+    data.m->remember_focused_mob(data.get_arg_int(0));
 }
 
 
@@ -1671,7 +1859,8 @@ void mob_action_runners::save_focus_memory(MobActionRunData &data) {
  */
 void mob_action_runners::send_message_to_focus(MobActionRunData &data) {
     if(!data.m->focused_mob) return;
-    data.m->send_script_message(data.m->focused_mob, data.args[0]);
+    string msg = data.get_arg(0);
+    data.m->send_script_message(data.m->focused_mob, msg);
 }
 
 
@@ -1681,10 +1870,11 @@ void mob_action_runners::send_message_to_focus(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::send_message_to_links(MobActionRunData &data) {
+    string msg = data.get_arg(0);
     for(size_t l = 0; l < data.m->links.size(); l++) {
         if(data.m->links[l] == data.m) continue;
         if(!data.m->links[l]) continue;
-        data.m->send_script_message(data.m->links[l], data.args[0]);
+        data.m->send_script_message(data.m->links[l], msg);
     }
 }
 
@@ -1695,19 +1885,14 @@ void mob_action_runners::send_message_to_links(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::send_message_to_nearby(MobActionRunData &data) {
-    float d = s2f(data.args[0]);
+    float d = data.get_arg_float(0);
+    string msg = data.get_arg(1);
     
-    for(size_t m2 = 0; m2 < game.states.gameplay->mobs.all.size(); m2++) {
-        if(game.states.gameplay->mobs.all[m2] == data.m) {
-            continue;
-        }
-        if(Distance(data.m->pos, game.states.gameplay->mobs.all[m2]->pos) > d) {
-            continue;
-        }
-        
-        data.m->send_script_message(
-            game.states.gameplay->mobs.all[m2], data.args[1]
-        );
+    vector<Mob*> nearby_mobs;
+    game.states.gameplay->get_mobs_in_radius(data.m->pos, d, nearby_mobs);
+    for(size_t m2 = 0; m2 < nearby_mobs.size(); m2++) {
+        if(nearby_mobs[m2] == data.m) continue;
+        data.m->send_script_message(nearby_mobs[m2], msg);
     }
 }
 
@@ -1720,17 +1905,17 @@ void mob_action_runners::send_message_to_nearby(MobActionRunData &data) {
 void mob_action_runners::set_animation(MobActionRunData &data) {
     START_ANIM_OPTION options = START_ANIM_OPTION_NORMAL;
     float mob_speed_baseline = 0.0f;
-    if(data.args.size() > 1) {
-        options = (START_ANIM_OPTION) s2i(data.args[1]);
+    if(data.get_nr_args() > 1) {
+        options = (START_ANIM_OPTION) data.get_arg_int(1);
     }
-    if(data.args.size() > 2) {
-        if(s2b(data.args[2])) {
+    if(data.get_nr_args() > 2) {
+        if(data.get_arg_bool(2)) {
             mob_speed_baseline = data.m->type->move_speed;
         };
     }
     
     data.m->set_animation(
-        s2i(data.args[0]), options, false, mob_speed_baseline
+        data.get_arg_int(0), options, false, mob_speed_baseline
     );
 }
 
@@ -1741,7 +1926,7 @@ void mob_action_runners::set_animation(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_can_block_paths(MobActionRunData &data) {
-    data.m->set_can_block_paths(s2b(data.args[0]));
+    data.m->set_can_block_paths(data.get_arg_bool(0));
 }
 
 
@@ -1751,7 +1936,7 @@ void mob_action_runners::set_can_block_paths(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_far_reach(MobActionRunData &data) {
-    data.m->far_reach = s2i(data.args[0]);
+    data.m->far_reach = data.get_arg_int(0);
     data.m->update_interaction_span();
 }
 
@@ -1762,7 +1947,7 @@ void mob_action_runners::set_far_reach(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_flying(MobActionRunData &data) {
-    if(s2b(data.args[0])) {
+    if(data.get_arg_bool(0)) {
         enable_flag(data.m->flags, MOB_FLAG_CAN_MOVE_MIDAIR);
     } else {
         disable_flag(data.m->flags, MOB_FLAG_CAN_MOVE_MIDAIR);
@@ -1776,7 +1961,7 @@ void mob_action_runners::set_flying(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_gravity(MobActionRunData &data) {
-    data.m->gravity_mult = s2f(data.args[0]);
+    data.m->gravity_mult = data.get_arg_float(0);
 }
 
 
@@ -1786,7 +1971,7 @@ void mob_action_runners::set_gravity(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_health(MobActionRunData &data) {
-    data.m->set_health(false, false, s2f(data.args[0]));
+    data.m->set_health(false, false, data.get_arg_float(0));
 }
 
 
@@ -1796,15 +1981,12 @@ void mob_action_runners::set_health(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_height(MobActionRunData &data) {
-    data.m->height = s2f(data.args[0]);
+    data.m->height = data.get_arg_float(0);
     
     if(data.m->type->walkable) {
         //Update the Z of mobs standing on top of it.
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            Mob* m2_ptr = game.states.gameplay->mobs.all[m];
-            if(m2_ptr->standing_on_mob == data.m) {
-                m2_ptr->z = data.m->z + data.m->height;
-            }
+        for(size_t r = 0; r < data.m->riders.size(); r++) {
+            data.m->riders[r]->z = data.m->z + data.m->height;
         }
     }
 }
@@ -1816,7 +1998,7 @@ void mob_action_runners::set_height(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_hiding(MobActionRunData &data) {
-    if(s2b(data.args[0])) {
+    if(data.get_arg_bool(0)) {
         enable_flag(data.m->flags, MOB_FLAG_HIDDEN);
     } else {
         disable_flag(data.m->flags, MOB_FLAG_HIDDEN);
@@ -1832,8 +2014,8 @@ void mob_action_runners::set_hiding(MobActionRunData &data) {
 void mob_action_runners::set_holdable(MobActionRunData &data) {
     if(typeid(*(data.m)) == typeid(Tool)) {
         unsigned char flags = 0;
-        for(size_t i = 0; i < data.args.size(); i++) {
-            flags |= s2i(data.args[i]);
+        for(size_t i = 0; i < data.get_nr_args(); i++) {
+            flags |= data.get_arg_int(i);
         }
         ((Tool*) (data.m))->holdability_flags = flags;
     }
@@ -1846,7 +2028,7 @@ void mob_action_runners::set_holdable(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_huntable(MobActionRunData &data) {
-    if(s2b(data.args[0])) {
+    if(data.get_arg_bool(0)) {
         disable_flag(data.m->flags, MOB_FLAG_NON_HUNTABLE);
     } else {
         enable_flag(data.m->flags, MOB_FLAG_NON_HUNTABLE);
@@ -1867,7 +2049,7 @@ void mob_action_runners::set_limb_animation(MobActionRunData &data) {
         return;
     }
     
-    size_t a = data.m->parent->limb_anim.anim_db->find_animation(data.args[0]);
+    size_t a = data.m->parent->limb_anim.anim_db->find_animation(data.get_arg(0));
     if(a == INVALID) {
         return;
     }
@@ -1885,7 +2067,7 @@ void mob_action_runners::set_limb_animation(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_near_reach(MobActionRunData &data) {
-    data.m->near_reach = s2i(data.args[0]);
+    data.m->near_reach = data.get_arg_int(0);
     data.m->update_interaction_span();
 }
 
@@ -1896,7 +2078,7 @@ void mob_action_runners::set_near_reach(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_radius(MobActionRunData &data) {
-    data.m->set_radius(s2f(data.args[0]));
+    data.m->set_radius(data.get_arg_float(0));
 }
 
 
@@ -1906,11 +2088,12 @@ void mob_action_runners::set_radius(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_sector_scroll(MobActionRunData &data) {
-    Sector* s_ptr = get_sector(data.m->pos, nullptr, true);
+    Sector* s_ptr = data.m->center_sector;
     if(!s_ptr) return;
     
-    s_ptr->scroll.x = s2f(data.args[0]);
-    s_ptr->scroll.y = s2f(data.args[1]);
+    s_ptr->scroll.x = data.get_arg_float(0);
+    s_ptr->scroll.y = data.get_arg_float(1);
+    game.states.gameplay->add_ticking_sector(s_ptr);
 }
 
 
@@ -1920,7 +2103,7 @@ void mob_action_runners::set_sector_scroll(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_shadow_visibility(MobActionRunData &data) {
-    if(s2b(data.args[0])) {
+    if(data.get_arg_bool(0)) {
         disable_flag(data.m->flags, MOB_FLAG_SHADOW_INVISIBLE);
     } else {
         enable_flag(data.m->flags, MOB_FLAG_SHADOW_INVISIBLE);
@@ -1935,7 +2118,7 @@ void mob_action_runners::set_shadow_visibility(MobActionRunData &data) {
  */
 void mob_action_runners::set_state(MobActionRunData &data) {
     data.m->fsm.set_state(
-        s2i(data.args[0]),
+        data.get_arg_int(0),
         data.custom_data_1,
         data.custom_data_2
     );
@@ -1948,7 +2131,7 @@ void mob_action_runners::set_state(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_tangible(MobActionRunData &data) {
-    if(s2b(data.args[0])) {
+    if(data.get_arg_bool(0)) {
         disable_flag(data.m->flags, MOB_FLAG_INTANGIBLE);
     } else {
         enable_flag(data.m->flags, MOB_FLAG_INTANGIBLE);
@@ -1962,7 +2145,7 @@ void mob_action_runners::set_tangible(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_team(MobActionRunData &data) {
-    data.m->team = (MOB_TEAM) s2i(data.args[0]);
+    data.m->team = (MOB_TEAM) data.get_arg_int(0);
 }
 
 
@@ -1972,7 +2155,7 @@ void mob_action_runners::set_team(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_timer(MobActionRunData &data) {
-    data.m->set_timer(s2f(data.args[0]));
+    data.m->set_timer(data.get_arg_float(0));
 }
 
 
@@ -1982,7 +2165,7 @@ void mob_action_runners::set_timer(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::set_var(MobActionRunData &data) {
-    data.m->set_var(data.args[0], data.args[1]);
+    data.m->set_var(data.get_arg(0), data.get_arg(1));
 }
 
 
@@ -1992,7 +2175,7 @@ void mob_action_runners::set_var(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::show_message_from_var(MobActionRunData &data) {
-    start_gameplay_message(data.m->vars[data.args[0]], nullptr);
+    start_gameplay_message(data.get_arg_var(0).get_text(), nullptr);
 }
 
 
@@ -2002,7 +2185,7 @@ void mob_action_runners::show_message_from_var(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::spawn(MobActionRunData &data) {
-    data.m->spawn(&data.m->type->spawns[s2i(data.args[0])]);
+    data.m->spawn(&data.m->type->spawns[data.get_arg_int(0)]);
 }
 
 
@@ -2018,7 +2201,7 @@ void mob_action_runners::stabilize_z(MobActionRunData &data) {
     
     float best_match_z = data.m->links[0]->z;
     MOB_ACTION_STABILIZE_Z_TYPE t =
-        (MOB_ACTION_STABILIZE_Z_TYPE) s2i(data.args[0]);
+        (MOB_ACTION_STABILIZE_Z_TYPE) data.get_arg_int(0);
         
     for(size_t l = 1; l < data.m->links.size(); l++) {
     
@@ -2042,7 +2225,7 @@ void mob_action_runners::stabilize_z(MobActionRunData &data) {
         
     }
     
-    data.m->z = best_match_z + s2f(data.args[1]);
+    data.m->z = best_match_z + data.get_arg_float(1);
 }
 
 
@@ -2052,10 +2235,10 @@ void mob_action_runners::stabilize_z(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::start_chomping(MobActionRunData &data) {
-    data.m->chomp_max = s2i(data.args[0]);
+    data.m->chomp_max = data.get_arg_int(0);
     data.m->chomp_body_parts.clear();
-    for(size_t p = 1; p < data.args.size(); p++) {
-        data.m->chomp_body_parts.push_back(s2i(data.args[p]));
+    for(size_t p = 1; p < data.get_nr_args(); p++) {
+        data.m->chomp_body_parts.push_back(data.get_arg_int(p));
     }
 }
 
@@ -2089,12 +2272,12 @@ void mob_action_runners::start_particles(MobActionRunData &data) {
     float offset_x = 0;
     float offset_y = 0;
     float offset_z = 0;
-    if(data.args.size() > 1) offset_x = s2f(data.args[1]);
-    if(data.args.size() > 2) offset_y = s2f(data.args[2]);
-    if(data.args.size() > 3) offset_z = s2f(data.args[3]);
+    if(data.get_nr_args() > 1) offset_x = data.get_arg_float(1);
+    if(data.get_nr_args() > 2) offset_y = data.get_arg_float(2);
+    if(data.get_nr_args() > 3) offset_z = data.get_arg_float(3);
     
     ParticleGenerator pg =
-        standard_particle_gen_setup(data.args[0], data.m);
+        standard_particle_gen_setup(data.get_arg(0), data.m);
     pg.follow_pos_offset = Point(offset_x, offset_y);
     pg.follow_z_offset = offset_z;
     pg.id = MOB_PARTICLE_GENERATOR_ID_SCRIPT;
@@ -2151,7 +2334,7 @@ void mob_action_runners::stop_particles(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::stop_sound(MobActionRunData &data) {
-    game.audio.destroy_sound_source(s2i(data.args[0]));
+    game.audio.destroy_sound_source(data.get_arg_int(0));
 }
 
 
@@ -2183,7 +2366,7 @@ void mob_action_runners::store_focus_inside(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::swallow(MobActionRunData &data) {
-    data.m->swallow_chomped_pikmin(s2i(data.args[0]));
+    data.m->swallow_chomped_pikmin(data.get_arg_int(0));
 }
 
 
@@ -2205,8 +2388,8 @@ void mob_action_runners::swallow_all(MobActionRunData &data) {
 void mob_action_runners::teleport_to_absolute(MobActionRunData &data) {
     data.m->stop_chasing();
     data.m->chase(
-        Point(s2f(data.args[0]), s2f(data.args[1])),
-        s2f(data.args[2]),
+        Point(data.get_arg_float(0), data.get_arg_float(1)),
+        data.get_arg_float(2),
         CHASE_FLAG_TELEPORT
     );
 }
@@ -2221,12 +2404,12 @@ void mob_action_runners::teleport_to_relative(MobActionRunData &data) {
     data.m->stop_chasing();
     Point p =
         rotate_point(
-            Point(s2f(data.args[0]), s2f(data.args[1])),
+            Point(data.get_arg_float(0), data.get_arg_float(1)),
             data.m->angle
         );
     data.m->chase(
         data.m->pos + p,
-        data.m->z + s2f(data.args[2]),
+        data.m->z + data.get_arg_float(2),
         CHASE_FLAG_TELEPORT
     );
 }
@@ -2246,7 +2429,7 @@ void mob_action_runners::throw_focus(MobActionRunData &data) {
         data.m->release(data.m->focused_mob);
     }
     
-    float max_height = s2f(data.args[3]);
+    float max_height = data.get_arg_float(3);
     
     if(max_height == 0.0f) {
         //We just want to drop it, not throw it.
@@ -2256,7 +2439,7 @@ void mob_action_runners::throw_focus(MobActionRunData &data) {
     data.m->start_height_effect();
     calculate_throw(
         data.m->focused_mob->pos, data.m->focused_mob->z,
-        Point(s2f(data.args[0]), s2f(data.args[1])), s2f(data.args[2]),
+        Point(data.get_arg_float(0), data.get_arg_float(1)), data.get_arg_float(2),
         max_height, MOB::GRAVITY_ADDER,
         &data.m->focused_mob->speed,
         &data.m->focused_mob->speed_z,
@@ -2271,13 +2454,13 @@ void mob_action_runners::throw_focus(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::turn_to_absolute(MobActionRunData &data) {
-    if(data.args.size() == 1) {
+    if(data.get_nr_args() == 1) {
         //Turn to an absolute angle.
-        data.m->face(deg_to_rad(s2f(data.args[0])), nullptr);
+        data.m->face(deg_to_rad(data.get_arg_float(0)), nullptr);
     } else {
         //Turn to some absolute coordinates.
-        float x = s2f(data.args[0]);
-        float y = s2f(data.args[1]);
+        float x = data.get_arg_float(0);
+        float y = data.get_arg_float(1);
         data.m->face(get_angle(data.m->pos, Point(x, y)), nullptr);
     }
 }
@@ -2289,13 +2472,13 @@ void mob_action_runners::turn_to_absolute(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::turn_to_relative(MobActionRunData &data) {
-    if(data.args.size() == 1) {
+    if(data.get_nr_args() == 1) {
         //Turn to a relative angle.
-        data.m->face(data.m->angle + deg_to_rad(s2f(data.args[0])), nullptr);
+        data.m->face(data.m->angle + deg_to_rad(data.get_arg_float(0)), nullptr);
     } else {
         //Turn to some relative coordinates.
-        float x = s2f(data.args[0]);
-        float y = s2f(data.args[1]);
+        float x = data.get_arg_float(0);
+        float y = data.get_arg_float(1);
         Point p = rotate_point(Point(x, y), data.m->angle);
         data.m->face(get_angle(data.m->pos, data.m->pos + p), nullptr);
     }
@@ -2308,7 +2491,7 @@ void mob_action_runners::turn_to_relative(MobActionRunData &data) {
  * @param data Data about the action call.
  */
 void mob_action_runners::turn_to_target(MobActionRunData &data) {
-    MOB_ACTION_TURN_TYPE t = (MOB_ACTION_TURN_TYPE) s2i(data.args[0]);
+    MOB_ACTION_TURN_TYPE t = (MOB_ACTION_TURN_TYPE) data.get_arg_int(0);
     
     switch(t) {
     case MOB_ACTION_TURN_TYPE_ARACHNORB_HEAD_LOGIC: {
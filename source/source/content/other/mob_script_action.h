@@ -15,6 +15,9 @@
 #include "mob_script.h"
 
 
+struct ScriptVarValue;
+
+
 //Types of script action.
 enum MOB_ACTION {
 
@@ -525,6 +528,9 @@ enum MOB_ACTION_PARAM {
     //STL string that gets turned into an int.
     MOB_ACTION_PARAM_ENUM,
     
+    //STL string with the name of one of the mob's variables.
+    MOB_ACTION_PARAM_VAR_NAME,
+    
 };
 
 
@@ -560,6 +566,41 @@ struct MobActionParam {
 };
 
 
+/**
+ * @brief An argument of a mob action call, compiled when the script
+ * is loaded, so that running the action doesn't need to parse text.
+ */
+struct MobActionOperand {
+
+    //--- Members ---
+    
+    //If true, the value comes from the mob variable named in the call's args.
+    bool is_var = false;
+    
+    //Slot of the mob variable named in the call's args, in the mob type's
+    //script variable table. INVALID if it doesn't name one.
+    size_t var_slot = INVALID;
+    
+    //Pre-parsed value as a float, if it's a constant.
+    float f_value = 0.0f;
+    
+    //Pre-parsed value as an int, if it's a constant. Also used for enums.
+    int i_value = 0;
+    
+    //Whether i_value holds the constant exactly. If the constant isn't a
+    //whole number, or doesn't fit in an int, the text is parsed instead.
+    bool has_i_value = false;
+    
+    //Pre-parsed value as a bool, if it's a constant.
+    bool b_value = false;
+    
+    //Content the constant refers to, if the action's loading code resolved
+    //it (e.g. a status type from its name).
+    void* ptr_value = nullptr;
+    
+};
+
+
 /**
  * @brief Info about how to run a specific instance of a mob action.
  */
@@ -573,9 +614,6 @@ struct MobActionRunData {
     //Action call information.
     MobActionCall* call = nullptr;
     
-    //Arguments used.
-    vector<string> args;
-    
     //Event custom data 1.
     void* custom_data_1 = nullptr;
     
@@ -589,6 +627,14 @@ struct MobActionRunData {
     //--- Function declarations ---
     
     MobActionRunData(Mob* m, MobActionCall* call);
+    string get_arg(size_t idx) const;
+    bool get_arg_bool(size_t idx) const;
+    float get_arg_float(size_t idx) const;
+    int get_arg_int(size_t idx) const;
+    string get_arg_tail(size_t idx) const;
+    ScriptVarValue &get_arg_var(size_t idx) const;
+    size_t get_nr_args() const;
+    ScriptVarValue &get_operand_var(size_t idx) const;
     
 };
 
@@ -651,8 +697,8 @@ struct MobActionCall {
     //Arguments to use.
     vector<string> args;
     
-    //List of which arguments are variable names.
-    vector<bool> arg_is_var;
+    //Compiled version of each argument, in the same order as args.
+    vector<MobActionOperand> operands;
     
     //If something went wrong in parsing it, this describes the error.
     string custom_error;
@@ -670,6 +716,7 @@ struct MobActionCall {
     explicit MobActionCall(custom_action_code_t code);
     bool load_from_data_node(DataNode* dn, MobType* mt);
     bool run(Mob* m, void* custom_data_1, void* custom_data_2);
+    void compile_operands();
     
 };
 
@@ -18,9 +18,21 @@
 #include "../../core/game.h"
 #include "../../util/allegro_utils.h"
 #include "../../util/geometry_utils.h"
+#include "../../util/simd_utils.h"
 #include "../../util/string_utils.h"
 
 
+namespace PARTICLE {
+
+//A circle particle is drawn with this many triangles.
+const unsigned char CIRCLE_SEGMENTS = 16;
+
+//When ticking, don't give worker threads fewer particles than this each.
+const size_t MIN_TICK_JOB_SIZE = 256;
+
+}
+
+
 /**
  * @brief Constructs a new particle object.
  *
@@ -47,91 +59,6 @@ Particle::Particle(
 }
 
 
-/**
- * @brief Draws this particle onto the world.
- */
-void Particle::draw() {
-    float t = 1.0f - time / duration;
-    ALLEGRO_COLOR final_color = color.get(t);
-    float final_size = size.get(t);
-    if(final_size <= 0.0f) return;
-    
-    bool used_custom_blend = false;
-    int old_op = 0, old_source = 0, old_dest = 0;
-    
-    switch(blend_type) {
-    case PARTICLE_BLEND_TYPE_ADDITIVE: {
-        al_get_blender(&old_op, &old_source, &old_dest);
-        al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_ONE);
-        used_custom_blend = true;
-        break;
-    } default: {
-        break;
-    }
-    }
-    
-    if(bitmap) {
-        draw_bitmap(
-            bitmap, pos, Point(final_size, -1),
-            bmp_angle, final_color
-        );
-    } else {
-        al_draw_filled_circle(
-            pos.x, pos.y,
-            final_size * 0.5,
-            final_color
-        );
-    }
-    
-    if(used_custom_blend) {
-        al_set_blender(old_op, old_source, old_dest);
-    }
-}
-
-
-/**
- * @brief Ticks a particle's time by one frame of logic.
- *
- * @param delta_t How long the frame's tick is, in seconds.
- * @return Whether its lifespan is over (meaning it should be deleted).
- */
-void Particle::tick(const float delta_t) {
-    time -= delta_t;
-    
-    if(time <= 0.0f) {
-        time = 0.0f;
-        return;
-    }
-    
-    float t = 1.0f - time / duration;
-    
-    Point total_velocity = linear_speed.get(t);
-    float outwards_angle = get_angle(pos - origin);
-    
-    if(pos == origin) {
-        outwards_angle = game.rng.f(-180, 180);
-    }
-    total_velocity +=
-        angle_to_coordinates(outwards_angle, outwards_speed.get(t));
-        
-    //Add 90 degrees to make the angle tangential.
-    total_velocity +=
-        angle_to_coordinates(outwards_angle + (TAU / 4), orbital_speed.get(t));
-        
-    //Accumulate and apply friction.
-    total_velocity -= total_friction_applied;
-    Point new_friction = total_velocity * (delta_t* friction);
-    total_friction_applied += new_friction;
-    total_velocity -= new_friction;
-    
-    pos += total_velocity * delta_t;
-    
-    if(bmp_angle_type == PARTICLE_ANGLE_TYPE_DIRECTION) {
-        coordinates_to_angle(total_velocity, &bmp_angle, nullptr);
-    }
-}
-
-
 /**
  * @brief Sets the bitmap, according to the given information.
  * This automatically manages bitmap un/loading and such.
@@ -567,10 +494,12 @@ void ParticleGenerator::tick(float delta_t, ParticleManager &manager) {
  * @param max_nr Maximum number of particles it can manage.
  */
 ParticleManager::ParticleManager(size_t max_nr) :
-    max_nr(max_nr) {
+    max_nr(max_nr),
+    budget(max_nr) {
     
     if(max_nr == 0) return;
     particles = new Particle[max_nr];
+    alloc_hot_data();
     clear();
 }
 
@@ -582,7 +511,21 @@ ParticleManager::ParticleManager(size_t max_nr) :
  */
 ParticleManager::ParticleManager(const ParticleManager &pm2) :
     count(pm2.count),
-    max_nr(pm2.max_nr) {
+    max_nr(pm2.max_nr),
+    budget(pm2.budget),
+    nr_added(pm2.nr_added),
+    nr_dropped(pm2.nr_dropped),
+    pos_x(pm2.pos_x),
+    pos_y(pm2.pos_y),
+    pos_z(pm2.pos_z),
+    time(pm2.time),
+    duration(pm2.duration),
+    friction(pm2.friction),
+    friction_applied_x(pm2.friction_applied_x),
+    friction_applied_y(pm2.friction_applied_y),
+    vel_x(pm2.vel_x),
+    vel_y(pm2.vel_y),
+    cull_radius(pm2.cull_radius) {
     
     particles = new Particle[max_nr];
     for(size_t p = 0; p < count; p++) {
@@ -607,7 +550,21 @@ ParticleManager &ParticleManager::operator =(
         }
         this->particles = nullptr;
         max_nr = pm2.max_nr;
+        budget = pm2.budget;
         count = pm2.count;
+        nr_added = pm2.nr_added;
+        nr_dropped = pm2.nr_dropped;
+        pos_x = pm2.pos_x;
+        pos_y = pm2.pos_y;
+        pos_z = pm2.pos_z;
+        time = pm2.time;
+        duration = pm2.duration;
+        friction = pm2.friction;
+        friction_applied_x = pm2.friction_applied_x;
+        friction_applied_y = pm2.friction_applied_y;
+        vel_x = pm2.vel_x;
+        vel_y = pm2.vel_y;
+        cull_radius = pm2.cull_radius;
         if(max_nr == 0) return *this;
         this->particles = new Particle[max_nr];
         for(size_t p = 0; p < count; p++) {
@@ -634,16 +591,19 @@ ParticleManager::~ParticleManager() {
  * @param p Particle to add.
  */
 void ParticleManager::add(const Particle &p) {
-    if(max_nr == 0) return;
+    if(max_nr == 0 || budget == 0) {
+        nr_dropped++;
+        return;
+    }
     
     //The first "count" particles are alive. Add the new one after.
-    //...Unless count already equals the max. That means the list is full.
+    //...Unless count already reached the budget. That means the list is full.
     //Let's try to dump a particle with lower priority.
     //Starting from 0 will (hopefully) give us the oldest one first.
     bool success = true;
-    if(count == max_nr) {
+    if(count >= budget) {
         success = false;
-        for(size_t i = 0; i < max_nr; i++) {
+        for(size_t i = 0; i < count; i++) {
             if(particles[i].priority < p.priority) {
                 remove(i);
                 success = true;
@@ -653,28 +613,228 @@ void ParticleManager::add(const Particle &p) {
     }
     
     //No room for this particle.
-    if(!success)
+    if(!success) {
+        nr_dropped++;
         return;
-        
-    particles[count] = p;
+    }
+    
+    nr_added++;
+    Particle* new_ptr = &particles[count];
+    *new_ptr = p;
+    
+    pos_x[count] = p.pos.x;
+    pos_y[count] = p.pos.y;
+    pos_z[count] = p.z;
+    time[count] = p.time;
+    duration[count] = p.duration;
+    friction[count] = p.friction;
+    friction_applied_x[count] = p.total_friction_applied.x;
+    friction_applied_y[count] = p.total_friction_applied.y;
+    vel_x[count] = 0.0f;
+    vel_y[count] = 0.0f;
+    
+    //Easing methods can make the size overshoot the keyframe values a bit,
+    //and the size is a diameter, so the largest keyframe makes a
+    //comfortable radius.
+    float max_size = 0.0f;
+    for(size_t k = 0; k < new_ptr->size.get_keyframe_count(); k++) {
+        max_size =
+            std::max(max_size, fabs(new_ptr->size.get_keyframe(k).second));
+    }
+    cull_radius[count] = max_size;
+    
     count++;
 }
 
 
+/**
+ * @brief Adds the vertexes needed to draw a particle to the batch's
+ * vertex list. A bitmap particle is a rotated quad, and a bitmap-less one
+ * is a circle, both made up of triangles.
+ *
+ * @param p_ptr Particle to add.
+ */
+void ParticleManager::add_batch_vertexes(Particle* p_ptr) {
+    float t = 1.0f - p_ptr->time / p_ptr->duration;
+    ALLEGRO_COLOR final_color = p_ptr->color.get(t);
+    float final_size = p_ptr->size.get(t);
+    if(final_size <= 0.0f) return;
+    
+    ALLEGRO_VERTEX v;
+    v.z = 0.0f;
+    v.color = final_color;
+    
+    if(p_ptr->bitmap) {
+        //Same proportions as draw_bitmap with a height of -1.
+        Point bmp_size = get_bitmap_dimensions(p_ptr->bitmap);
+        float half_w = final_size / 2.0f;
+        float half_h = final_size * (bmp_size.y / bmp_size.x) / 2.0f;
+        float cos_a = cos(p_ptr->bmp_angle);
+        float sin_a = sin(p_ptr->bmp_angle);
+        const float corners[4][4] = {
+            { -half_w, -half_h, 0.0f, 0.0f },
+            { half_w, -half_h, bmp_size.x, 0.0f },
+            { half_w, half_h, bmp_size.x, bmp_size.y },
+            { -half_w, half_h, 0.0f, bmp_size.y },
+        };
+        //Two triangles: corners 0, 1, 2, and corners 0, 2, 3.
+        const unsigned char order[6] = { 0, 1, 2, 0, 2, 3 };
+        for(unsigned char o = 0; o < 6; o++) {
+            const float* c = corners[order[o]];
+            v.x = p_ptr->pos.x + c[0] * cos_a - c[1] * sin_a;
+            v.y = p_ptr->pos.y + c[0] * sin_a + c[1] * cos_a;
+            v.u = c[2];
+            v.v = c[3];
+            batch_vertexes.push_back(v);
+        }
+        
+    } else {
+        float radius = final_size * 0.5f;
+        v.u = 0.0f;
+        v.v = 0.0f;
+        for(unsigned char s = 0; s < PARTICLE::CIRCLE_SEGMENTS; s++) {
+            float a1 = TAU * s / PARTICLE::CIRCLE_SEGMENTS;
+            float a2 = TAU * (s + 1) / PARTICLE::CIRCLE_SEGMENTS;
+            v.x = p_ptr->pos.x;
+            v.y = p_ptr->pos.y;
+            batch_vertexes.push_back(v);
+            v.x = p_ptr->pos.x + cos(a1) * radius;
+            v.y = p_ptr->pos.y + sin(a1) * radius;
+            batch_vertexes.push_back(v);
+            v.x = p_ptr->pos.x + cos(a2) * radius;
+            v.y = p_ptr->pos.y + sin(a2) * radius;
+            batch_vertexes.push_back(v);
+        }
+        
+    }
+}
+
+
+/**
+ * @brief Allocates the arrays of hot data, with one entry per particle slot.
+ */
+void ParticleManager::alloc_hot_data() {
+    pos_x.assign(max_nr, 0.0f);
+    pos_y.assign(max_nr, 0.0f);
+    pos_z.assign(max_nr, 0.0f);
+    time.assign(max_nr, 0.0f);
+    duration.assign(max_nr, 0.0f);
+    friction.assign(max_nr, 0.0f);
+    friction_applied_x.assign(max_nr, 0.0f);
+    friction_applied_y.assign(max_nr, 0.0f);
+    vel_x.assign(max_nr, 0.0f);
+    vel_y.assign(max_nr, 0.0f);
+    cull_radius.assign(max_nr, 0.0f);
+}
+
+
 /**
  * @brief Clears the list.
  */
 void ParticleManager::clear() {
     for(size_t p = 0; p < max_nr; p++) {
         particles[p].time = 0.0f;
+        time[p] = 0.0f;
     }
     count = 0;
 }
 
 
+/**
+ * @brief Copies one particle slot's hot data onto another slot.
+ *
+ * @param from Index of the slot to copy from.
+ * @param to Index of the slot to copy to.
+ */
+void ParticleManager::copy_hot_data(size_t from, size_t to) {
+    pos_x[to] = pos_x[from];
+    pos_y[to] = pos_y[from];
+    pos_z[to] = pos_z[from];
+    time[to] = time[from];
+    duration[to] = duration[from];
+    friction[to] = friction[from];
+    friction_applied_x[to] = friction_applied_x[from];
+    friction_applied_y[to] = friction_applied_y[from];
+    vel_x[to] = vel_x[from];
+    vel_y[to] = vel_y[from];
+    cull_radius[to] = cull_radius[from];
+}
+
+
+/**
+ * @brief Draws a batch of particles, i.e. particles that come one after the
+ * other in the drawing order with nothing else between them. The particles
+ * are grouped by blend type and bitmap, and each group is drawn with a
+ * single primitive drawing call. Within a group, they keep their Z order.
+ *
+ * @param list List of world components with the particles, sorted by Z.
+ * @param start Index of the first particle component of the batch.
+ * @param end Index after the last particle component of the batch.
+ */
+void ParticleManager::draw_batch(
+    const vector<WorldComponent> &list, size_t start, size_t end
+) {
+    batch_particles.clear();
+    for(size_t c = start; c < end; c++) {
+        batch_particles.push_back(list[c].particle_ptr);
+    }
+    std::stable_sort(
+        batch_particles.begin(), batch_particles.end(),
+    [] (const Particle * p1, const Particle * p2) -> bool {
+        if(p1->blend_type != p2->blend_type) {
+            return p1->blend_type < p2->blend_type;
+        }
+        return p1->bitmap < p2->bitmap;
+    }
+    );
+    
+    int old_op = 0, old_source = 0, old_dest = 0;
+    al_get_blender(&old_op, &old_source, &old_dest);
+    
+    size_t group_start = 0;
+    while(group_start < batch_particles.size()) {
+        const Particle* first_ptr = batch_particles[group_start];
+        size_t group_end = group_start;
+        batch_vertexes.clear();
+        while(
+            group_end < batch_particles.size() &&
+            batch_particles[group_end]->blend_type == first_ptr->blend_type &&
+            batch_particles[group_end]->bitmap == first_ptr->bitmap
+        ) {
+            add_batch_vertexes(batch_particles[group_end]);
+            group_end++;
+        }
+        
+        if(!batch_vertexes.empty()) {
+            switch(first_ptr->blend_type) {
+            case PARTICLE_BLEND_TYPE_ADDITIVE: {
+                al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_ONE);
+                break;
+            } default: {
+                al_set_blender(old_op, old_source, old_dest);
+                break;
+            }
+            }
+            
+            al_draw_prim(
+                batch_vertexes.data(), nullptr, first_ptr->bitmap,
+                0, (int) batch_vertexes.size(), ALLEGRO_PRIM_TRIANGLE_LIST
+            );
+        }
+        
+        group_start = group_end;
+    }
+    
+    al_set_blender(old_op, old_source, old_dest);
+}
+
+
 /**
  * @brief Adds the particle pointers to the provided list of world components,
- * so that the particles can be drawn, after being Z-sorted.
+ * so that the particles can be drawn. The components that get added
+ * are sorted by Z, so the particles don't need to go through the same
+ * sort as the rest of the world components. Particles with the same Z
+ * keep the order they have in the manager.
  *
  * @param list The list to populate.
  * @param cam_tl Only draw particles below and to the right of this coordinate.
@@ -684,15 +844,14 @@ void ParticleManager::fill_component_list(
     vector<WorldComponent> &list,
     const Point &cam_tl, const Point &cam_br
 ) {
+    size_t list_start = list.size();
     for(size_t c = 0; c < count; c++) {
     
-        Particle* p_ptr = &particles[c];
-        float p_size =
-            p_ptr->size.get((p_ptr->duration - p_ptr->time) / p_ptr->duration);
+        Point pos(pos_x[c], pos_y[c]);
         if(
             cam_tl != cam_br &&
             !rectangles_intersect(
-                p_ptr->pos - p_size, p_ptr->pos + p_size,
+                pos - cull_radius[c], pos + cull_radius[c],
                 cam_tl, cam_br
             )
         ) {
@@ -700,11 +859,25 @@ void ParticleManager::fill_component_list(
             continue;
         }
         
+        //Bring the data the drawing logic needs up to date.
+        Particle* p_ptr = &particles[c];
+        p_ptr->pos = pos;
+        p_ptr->time = time[c];
+        p_ptr->total_friction_applied =
+            Point(friction_applied_x[c], friction_applied_y[c]);
+            
         WorldComponent wc;
         wc.particle_ptr = p_ptr;
-        wc.z = p_ptr->z;
+        wc.z = pos_z[c];
         list.push_back(wc);
     }
+    
+    std::stable_sort(
+        list.begin() + list_start, list.end(),
+    [] (const WorldComponent & c1, const WorldComponent & c2) -> bool {
+        return c1.z < c2.z;
+    }
+    );
 }
 
 
@@ -718,6 +891,53 @@ size_t ParticleManager::get_count() const {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the manager's particle slots
+ * take up, in bytes. The particles' bitmaps aren't included, since those
+ * belong to the bitmap manager.
+ *
+ * @return The size.
+ */
+size_t ParticleManager::get_memory_usage() const {
+    return
+        max_nr * sizeof(Particle) +
+        get_vector_memory_usage(pos_x) +
+        get_vector_memory_usage(pos_y) +
+        get_vector_memory_usage(pos_z) +
+        get_vector_memory_usage(time) +
+        get_vector_memory_usage(duration) +
+        get_vector_memory_usage(friction) +
+        get_vector_memory_usage(friction_applied_x) +
+        get_vector_memory_usage(friction_applied_y) +
+        get_vector_memory_usage(vel_x) +
+        get_vector_memory_usage(vel_y) +
+        get_vector_memory_usage(cull_radius) +
+        get_vector_memory_usage(batch_particles) +
+        get_vector_memory_usage(batch_vertexes);
+}
+
+
+/**
+ * @brief Returns how many particles were added so far.
+ *
+ * @return The amount.
+ */
+size_t ParticleManager::get_nr_added() const {
+    return nr_added;
+}
+
+
+/**
+ * @brief Returns how many particles couldn't be added so far,
+ * because there was no room for them.
+ *
+ * @return The amount.
+ */
+size_t ParticleManager::get_nr_dropped() const {
+    return nr_dropped;
+}
+
+
 /**
  * @brief Removes a particle from the list.
  *
@@ -729,6 +949,7 @@ void ParticleManager::remove(size_t pos) {
     //To remove a particle, let's simply move its data to the start of
     //the "dead" particles. A particle is considered dead if its time is 0.
     particles[pos].time = 0.0f;
+    time[pos] = 0.0f;
     
     //Because the first "count" members are alive, we'll swap this dead
     //particle with the last living one. This means this particle
@@ -741,27 +962,158 @@ void ParticleManager::remove(size_t pos) {
     }
     
     //Place the last live particle on this now-unused position.
-    particles[pos] = particles[count - 1];
+    //Swapping is cheaper than copying all of the keyframes.
+    std::swap(particles[pos], particles[count - 1]);
+    copy_hot_data(count - 1, pos);
     //And this new "dead" particle should be marked as such.
     particles[count - 1].time = 0.0f;
+    time[count - 1] = 0.0f;
     
     count--;
 }
 
 
 /**
- * @brief Ticks time of all particles in the list by one frame of logic.
+ * @brief Sets how many particles new ones can bring the count up to.
+ * It can't go over the maximum the manager was created with.
+ *
+ * @param budget The budget.
+ */
+void ParticleManager::set_budget(size_t budget) {
+    this->budget = std::min(budget, max_nr);
+}
+
+
+/**
+ * @brief Ticks all particles. The bulk of the work is split across the
+ * game's job pool, and the dead particles are removed afterwards,
+ * on this thread, so the end result doesn't depend on how the work was split.
  *
  * @param delta_t How long the frame's tick is, in seconds.
  */
 void ParticleManager::tick_all(float delta_t) {
+    //Each particle that needs a random number picks the one at its own
+    //index of this tick's stream, so the results are the same no matter
+    //how the work is split or in what order the threads run.
+    RngStream rng =
+        game.rng.get_stream(
+            RNG_STREAM_PARTICLES, (uint32_t) game.rng.i(0, INT32_MAX)
+        );
+    
+    game.jobs.parallel_for(
+        count, PARTICLE::MIN_TICK_JOB_SIZE,
+    [this, delta_t, &rng] (size_t start, size_t end) {
+        tick_range(start, end, delta_t, rng);
+    }
+    );
+    
+    //Finish up, and remove the dead ones.
     for(size_t c = 0; c < count;) {
-        particles[c].tick(delta_t);
-        if(particles[c].time == 0.0f) {
+        if(time[c] <= 0.0f) {
             remove(c);
-        } else {
-            c++;
+            continue;
+        }
+        if(particles[c].bmp_angle_type == PARTICLE_ANGLE_TYPE_DIRECTION) {
+            coordinates_to_angle(
+                Point(vel_x[c], vel_y[c]), &particles[c].bmp_angle, nullptr
+            );
         }
+        c++;
+    }
+}
+
+
+/**
+ * @brief Ticks a range of particles, without removing the ones that die.
+ * This only touches the given range's data, so several ranges can be ticked
+ * at the same time from different threads.
+ *
+ * @param start Index of the first particle to tick.
+ * @param end Index after the last particle to tick.
+ * @param delta_t How long the frame's tick is, in seconds.
+ * @param rng Random number stream for this tick.
+ */
+void ParticleManager::tick_range(
+    size_t start, size_t end, float delta_t, const RngStream &rng
+) {
+    const SimdFloat4 delta_t4 = SimdFloat4::set(delta_t);
+    size_t simd_end = end - ((end - start) % SIMD_FLOAT4_SIZE);
+    
+    //Pass the time.
+    for(size_t c = start; c < simd_end; c += SIMD_FLOAT4_SIZE) {
+        (SimdFloat4::load(&time[c]) - delta_t4).store(&time[c]);
+    }
+    for(size_t c = simd_end; c < end; c++) {
+        time[c] -= delta_t;
+    }
+    
+    //Figure out each particle's velocity. This depends on the keyframes,
+    //so it has to be done one particle at a time.
+    for(size_t c = start; c < end; c++) {
+        if(time[c] <= 0.0f) {
+            vel_x[c] = 0.0f;
+            vel_y[c] = 0.0f;
+            continue;
+        }
+        
+        Particle* p_ptr = &particles[c];
+        float t = 1.0f - time[c] / duration[c];
+        Point pos(pos_x[c], pos_y[c]);
+        
+        Point total_velocity = p_ptr->linear_speed.get(t);
+        float outwards_angle = get_angle(pos - p_ptr->origin);
+        
+        if(pos == p_ptr->origin) {
+            outwards_angle = rng.f_at((uint32_t) c, -180, 180);
+        }
+        total_velocity +=
+            angle_to_coordinates(outwards_angle, p_ptr->outwards_speed.get(t));
+            
+        //Add 90 degrees to make the angle tangential.
+        total_velocity +=
+            angle_to_coordinates(
+                outwards_angle + (TAU / 4), p_ptr->orbital_speed.get(t)
+            );
+            
+        vel_x[c] = total_velocity.x;
+        vel_y[c] = total_velocity.y;
+    }
+    
+    //Accumulate and apply friction, and move.
+    for(size_t c = start; c < simd_end; c += SIMD_FLOAT4_SIZE) {
+        SimdFloat4 friction_dt =
+            SimdFloat4::load(&friction[c]) * delta_t4;
+            
+        SimdFloat4 applied_x = SimdFloat4::load(&friction_applied_x[c]);
+        SimdFloat4 vx = SimdFloat4::load(&vel_x[c]) - applied_x;
+        SimdFloat4 new_friction_x = vx * friction_dt;
+        (applied_x + new_friction_x).store(&friction_applied_x[c]);
+        vx = vx - new_friction_x;
+        vx.store(&vel_x[c]);
+        (SimdFloat4::load(&pos_x[c]) + vx * delta_t4).store(&pos_x[c]);
+        
+        SimdFloat4 applied_y = SimdFloat4::load(&friction_applied_y[c]);
+        SimdFloat4 vy = SimdFloat4::load(&vel_y[c]) - applied_y;
+        SimdFloat4 new_friction_y = vy * friction_dt;
+        (applied_y + new_friction_y).store(&friction_applied_y[c]);
+        vy = vy - new_friction_y;
+        vy.store(&vel_y[c]);
+        (SimdFloat4::load(&pos_y[c]) + vy * delta_t4).store(&pos_y[c]);
+    }
+    for(size_t c = simd_end; c < end; c++) {
+        float friction_dt = friction[c] * delta_t;
+        
+        float vx = vel_x[c] - friction_applied_x[c];
+        float new_friction_x = vx * friction_dt;
+        friction_applied_x[c] += new_friction_x;
+        vel_x[c] = vx - new_friction_x;
+        pos_x[c] += vel_x[c] * delta_t;
+        
+        float vy = vel_y[c] - friction_applied_y[c];
+        float new_friction_y = vy * friction_dt;
+        friction_applied_y[c] += new_friction_y;
+        vel_y[c] = vy - new_friction_y;
+        pos_y[c] += vel_y[c] * delta_t;
     }
 }
 
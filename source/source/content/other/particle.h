@@ -13,6 +13,7 @@
 #include <vector>
 
 #include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
 
 #include "../../core/const.h"
 #include "../../core/world_component.h"
@@ -26,6 +27,13 @@ using std::vector;
 
 
 class Mob;
+struct RngStream;
+
+
+namespace PARTICLE {
+extern const unsigned char CIRCLE_SEGMENTS;
+extern const size_t MIN_TICK_JOB_SIZE;
+}
 
 
 //Particle priorities.
@@ -240,12 +248,10 @@ struct Particle {
             PARTICLE_PRIORITY_MEDIUM,
         const ALLEGRO_COLOR initial_color = COLOR_WHITE
     );
-    void draw();
     void set_bitmap(
         const string &new_bmp_name,
         DataNode* node = nullptr
     );
-    void tick(float delta_t);
     
 };
 
@@ -265,11 +271,18 @@ struct ParticleManager {
     ~ParticleManager();
     void add(const Particle &p);
     void clear();
+    void draw_batch(
+        const vector<WorldComponent> &list, size_t start, size_t end
+    );
     void fill_component_list(
         vector<WorldComponent> &list,
         const Point &cam_tl = Point(), const Point &cam_br = Point()
     );
     size_t get_count() const;
+    size_t get_memory_usage() const;
+    size_t get_nr_added() const;
+    size_t get_nr_dropped() const;
+    void set_budget(size_t budget);
     void tick_all(float delta_t);
     
     private:
@@ -283,6 +296,8 @@ struct ParticleManager {
     //"dead" particle, to preserve the list's logic.
     //When a particle is added, if the entire list is filled with live ones,
     //delete the one on position 0 (presumably the oldest).
+    //The particles' position, time, and friction applied are kept in the
+    //hot data below instead, and only copied back when they're drawn.
     Particle* particles = nullptr;
     
     //How many particles are alive.
@@ -291,10 +306,73 @@ struct ParticleManager {
     //Maximum number that can be stored.
     size_t max_nr = 0;
     
+    //Maximum number that new particles can bring the count up to. This is
+    //lower than max_nr when the graphics quality is lowered. Particles that
+    //are already alive past this number are left alone to finish.
+    size_t budget = 0;
+    
+    //Total number of particles that were added so far.
+    size_t nr_added = 0;
+    
+    //Total number of particles that couldn't be added so far, because
+    //there was no room for them.
+    size_t nr_dropped = 0;
+    
+    //The data below is the particles' hot data, laid out as a structure
+    //of arrays so several particles can be ticked at once.
+    //Each array has one entry per particle slot.
+    
+    //X coordinate of each particle.
+    vector<float> pos_x;
+    
+    //Y coordinate of each particle.
+    vector<float> pos_y;
+    
+    //Z coordinate of each particle.
+    vector<float> pos_z;
+    
+    //Time left to live of each particle. 0 means it's dead.
+    vector<float> time;
+    
+    //Total lifespan of each particle.
+    vector<float> duration;
+    
+    //Friction of each particle.
+    vector<float> friction;
+    
+    //X of how much each particle has been slowed since being created.
+    vector<float> friction_applied_x;
+    
+    //Y of how much each particle has been slowed since being created.
+    vector<float> friction_applied_y;
+    
+    //Each particle's velocity X in the current tick.
+    vector<float> vel_x;
+    
+    //Each particle's velocity Y in the current tick.
+    vector<float> vel_y;
+    
+    //Largest distance from its center that each particle can be drawn at.
+    //Used to cull without having to check the size keyframes.
+    vector<float> cull_radius;
+    
+    //Particles of the batch being drawn, grouped by blend type and bitmap.
+    //Kept between batches so it doesn't need to be reallocated.
+    vector<Particle*> batch_particles;
+    
+    //Vertexes of the group being drawn. Kept between batches too.
+    vector<ALLEGRO_VERTEX> batch_vertexes;
+    
     
     //--- Function declarations ---
     
+    void add_batch_vertexes(Particle* p_ptr);
+    void alloc_hot_data();
+    void copy_hot_data(size_t from, size_t to);
     void remove(size_t pos);
+    void tick_range(
+        size_t start, size_t end, float delta_t, const RngStream &rng
+    );
     
 };
 
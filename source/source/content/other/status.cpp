@@ -22,9 +22,12 @@
  * @brief Constructs a new status object.
  *
  * @param type Its type.
+ * @param vuln_mult Multiplier of its effects, due to the mob's
+ * vulnerability to it.
  */
-Status::Status(StatusType* type) :
-    type(type) {
+Status::Status(StatusType* type, float vuln_mult) :
+    type(type),
+    vuln_mult(vuln_mult) {
     
     time_left = type->auto_remove_time;
 }
@@ -216,10 +216,14 @@ struct Status {
     //Should this status be deleted from the mob's statuses?
     bool to_delete = false;
     
+    //Multiply the effects by this much, due to the mob's vulnerability
+    //to the status. Cache for performance.
+    float vuln_mult = 1.0f;
+    
     
     //--- Function declarations ---
     
-    explicit Status(StatusType* type);
+    explicit Status(StatusType* type, float vuln_mult = 1.0f);
     void tick(float delta_t);
     
 };
@@ -19,6 +19,14 @@
 #include "../../util/string_utils.h"
 
 
+namespace WEATHER {
+
+//How many minutes there are in a day.
+const int DAY_MINUTES = 24 * 60;
+
+}
+
+
 /**
  * @brief Constructs a new weather object.
  */
@@ -47,21 +55,44 @@ Weather::Weather(
     precipitation_type(pt) {
     
     name = n;
+    bake_tables();
 }
 
 
 /**
- * @brief Returns the blackout effect's strength for the current time.
+ * @brief Fills the tables with the value of each weather property for
+ * each minute of the day, so that getting one is just a matter of
+ * reading the table.
+ */
+void Weather::bake_tables() {
+    blackout_strength_per_minute.clear();
+    daylight_per_minute.clear();
+    fog_color_per_minute.clear();
+    sun_strength_per_minute.clear();
+    
+    for(int m = 0; m <= WEATHER::DAY_MINUTES; m++) {
+        blackout_strength_per_minute.push_back(calculate_blackout_strength(m));
+        daylight_per_minute.push_back(calculate_daylight_color(m));
+        fog_color_per_minute.push_back(calculate_fog_color(m));
+        sun_strength_per_minute.push_back(calculate_sun_strength(m));
+    }
+}
+
+
+/**
+ * @brief Calculates the blackout effect's strength for the given time,
+ * from its table of values.
  *
+ * @param cur_time What time it is, in minutes.
  * @return The blackout strength.
  */
-unsigned char Weather::get_blackout_strength() {
+unsigned char Weather::calculate_blackout_strength(int cur_time) {
     float ratio;
     unsigned char strength1;
     unsigned char strength2;
     bool success =
         get_table_values(
-            blackout_strength, game.states.gameplay->day_minutes,
+            blackout_strength, cur_time,
             &ratio, &strength1, &strength2
         );
         
@@ -74,17 +105,19 @@ unsigned char Weather::get_blackout_strength() {
 
 
 /**
- * @brief Returns the daylight color for the current time.
+ * @brief Calculates the daylight color for the given time,
+ * from its table of values.
  *
+ * @param cur_time What time it is, in minutes.
  * @return The daylight color.
  */
-ALLEGRO_COLOR Weather::get_daylight_color() {
+ALLEGRO_COLOR Weather::calculate_daylight_color(int cur_time) {
     float ratio;
     ALLEGRO_COLOR color1;
     ALLEGRO_COLOR color2;
     bool success =
         get_table_values(
-            daylight, game.states.gameplay->day_minutes,
+            daylight, cur_time,
             &ratio, &color1, &color2
         );
         
@@ -97,17 +130,19 @@ ALLEGRO_COLOR Weather::get_daylight_color() {
 
 
 /**
- * @brief Returns the fog color for the current time.
+ * @brief Calculates the fog color for the given time,
+ * from its table of values.
  *
+ * @param cur_time What time it is, in minutes.
  * @return The fog color.
  */
-ALLEGRO_COLOR Weather::get_fog_color() {
+ALLEGRO_COLOR Weather::calculate_fog_color(int cur_time) {
     float ratio;
     ALLEGRO_COLOR color1;
     ALLEGRO_COLOR color2;
     bool success =
         get_table_values(
-            fog_color, game.states.gameplay->day_minutes,
+            fog_color, cur_time,
             &ratio, &color1, &color2
         );
         
@@ -120,17 +155,19 @@ ALLEGRO_COLOR Weather::get_fog_color() {
 
 
 /**
- * @brief Returns the sun strength for the current time, in the range 0 - 1.
+ * @brief Calculates the sun strength for the given time,
+ * from its table of values, in the range 0 - 1.
  *
+ * @param cur_time What time it is, in minutes.
  * @return The sun strength.
  */
-float Weather::get_sun_strength() {
+float Weather::calculate_sun_strength(int cur_time) {
     float ratio;
     unsigned char strength1;
     unsigned char strength2;
     bool success =
         get_table_values(
-            sun_strength, game.states.gameplay->day_minutes,
+            sun_strength, cur_time,
             &ratio, &strength1, &strength2
         );
         
@@ -144,6 +181,65 @@ float Weather::get_sun_strength() {
 }
 
 
+/**
+ * @brief Returns the blackout effect's strength for the current time.
+ *
+ * @return The blackout strength.
+ */
+unsigned char Weather::get_blackout_strength() {
+    int cur_time = game.states.gameplay->day_minutes;
+    if(
+        cur_time >= 0 &&
+        cur_time < (int) blackout_strength_per_minute.size()
+    ) {
+        return blackout_strength_per_minute[cur_time];
+    }
+    return calculate_blackout_strength(cur_time);
+}
+
+
+/**
+ * @brief Returns the daylight color for the current time.
+ *
+ * @return The daylight color.
+ */
+ALLEGRO_COLOR Weather::get_daylight_color() {
+    int cur_time = game.states.gameplay->day_minutes;
+    if(cur_time >= 0 && cur_time < (int) daylight_per_minute.size()) {
+        return daylight_per_minute[cur_time];
+    }
+    return calculate_daylight_color(cur_time);
+}
+
+
+/**
+ * @brief Returns the fog color for the current time.
+ *
+ * @return The fog color.
+ */
+ALLEGRO_COLOR Weather::get_fog_color() {
+    int cur_time = game.states.gameplay->day_minutes;
+    if(cur_time >= 0 && cur_time < (int) fog_color_per_minute.size()) {
+        return fog_color_per_minute[cur_time];
+    }
+    return calculate_fog_color(cur_time);
+}
+
+
+/**
+ * @brief Returns the sun strength for the current time, in the range 0 - 1.
+ *
+ * @return The sun strength.
+ */
+float Weather::get_sun_strength() {
+    int cur_time = game.states.gameplay->day_minutes;
+    if(cur_time >= 0 && cur_time < (int) sun_strength_per_minute.size()) {
+        return sun_strength_per_minute[cur_time];
+    }
+    return calculate_sun_strength(cur_time);
+}
+
+
 /**
  * @brief Loads weather data from a data node.
  *
@@ -216,4 +312,6 @@ void Weather::load_from_data_node(DataNode* node) {
             )
         );
     }
+    
+    bake_tables();
 }
@@ -24,6 +24,11 @@ using std::string;
 using std::vector;
 
 
+namespace WEATHER {
+extern const int DAY_MINUTES;
+}
+
+
 //Types of precipitation.
 enum PRECIPITATION_TYPE {
 
@@ -95,6 +100,30 @@ public:
     
 private:
 
+    //--- Members ---
+    
+    //Blackout strength for each minute of the day. Cache for performance.
+    vector<unsigned char> blackout_strength_per_minute;
+    
+    //Daylight color for each minute of the day. Cache for performance.
+    vector<ALLEGRO_COLOR> daylight_per_minute;
+    
+    //Fog color for each minute of the day. Cache for performance.
+    vector<ALLEGRO_COLOR> fog_color_per_minute;
+    
+    //Sun strength for each minute of the day. Cache for performance.
+    vector<float> sun_strength_per_minute;
+    
+    
+    //--- Function declarations ---
+    
+    void bake_tables();
+    unsigned char calculate_blackout_strength(int cur_time);
+    ALLEGRO_COLOR calculate_daylight_color(int cur_time);
+    ALLEGRO_COLOR calculate_fog_color(int cur_time);
+    float calculate_sun_strength(int cur_time);
+    
+    
     //--- Function definitions ---
     
     /**
@@ -9,6 +9,12 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "audio.h"
 
@@ -26,9 +32,19 @@ namespace AUDIO {
 //thus perventing a super-loud sound.
 const float DEF_STACK_MIN_POS = 0.1f;
 
+//The sound effect thread ticks sources and playbacks every this many seconds.
+const float EFFECTS_TICK_INTERVAL = 1.0f / 120.0f;
+
+//Maximum number of playbacks that each sound effect mixer can mix at once.
+//Past this, the least important ones become virtual.
+const size_t MAX_VOICES_PER_MIXER = 24;
+
 //Change speed for a mix track's gain, measured in amount per second.
 const float MIX_TRACK_GAIN_SPEED = 1.0f;
 
+//Playbacks whose final gain would be lower than this become virtual.
+const float PLAYBACK_AUDIBLE_MIN_GAIN = 0.01f;
+
 //Change speed for a playback's gain, measured in amount per second.
 const float PLAYBACK_GAIN_SPEED = 3.0f;
 
@@ -52,6 +68,10 @@ const float PLAYBACK_RANGE_FAR_PAN = 300.0f;
 //Change speed of playback gain when stopping, measured in amount per second.
 const float PLAYBACK_STOP_GAIN_SPEED = 8.0f;
 
+//How many of the lower bits of a sound source ID are for its slot's index.
+//The remaining bits are for the slot's generation.
+const size_t SOURCE_ID_INDEX_BITS = 20;
+
 //Change speed for a song's gain, measured in amount per second.
 const float SONG_GAIN_SPEED = 1.0f;
 
@@ -61,6 +81,107 @@ const float SONG_SOFTENED_GAIN = 0.4f;
 }
 
 
+/**
+ * @brief The thread that ticks sound sources and playbacks, and what's
+ * needed to coordinate with it.
+ */
+struct AudioManager::EffectsTickerSyncData {
+
+    //--- Members ---
+    
+    //The thread.
+    std::thread worker;
+    
+    //Controls access to the sound sources, playbacks, and camera. It's
+    //recursive, since the manager's functions call each other.
+    std::recursive_mutex mutex;
+    
+    //Is the thread meant to stop?
+    std::atomic<bool> stopping = false;
+    
+};
+
+
+/**
+ * @brief The worker thread that opens song tracks in the background, and
+ * the tracks it's been asked to open, or has finished opening.
+ */
+struct AudioManager::TrackLoaderSyncData {
+
+    /**
+     * @brief A song track that the worker has to open, or has opened.
+     */
+    struct Job {
+    
+        //--- Members ---
+        
+        //Internal name of the song it's for.
+        string song_name;
+        
+        //Mix track type it's for, or N_MIX_TRACK_TYPES for the main track.
+        MIX_TRACK_TYPE track_type = N_MIX_TRACK_TYPES;
+        
+        //Internal name of the track.
+        string track_name;
+        
+        //Path to its audio file.
+        string path;
+        
+        //Opened stream, or nullptr if it's not open yet, or if it couldn't be.
+        ALLEGRO_AUDIO_STREAM* stream = nullptr;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Worker thread.
+    std::thread worker;
+    
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Signals the worker that there are new jobs, or that it should stop.
+    std::condition_variable work_cond;
+    
+    //Signals the main thread that the worker finished a job.
+    std::condition_variable done_cond;
+    
+    //Tracks waiting to be opened.
+    std::deque<Job> jobs;
+    
+    //Tracks that are open, and waiting for the main thread.
+    std::deque<Job> results;
+    
+    //Is the worker opening a track right now?
+    bool busy = false;
+    
+    //Is the worker meant to stop?
+    bool stopping = false;
+    
+};
+
+
+/**
+ * @brief Constructs a new effects lock object, locking the sound effect
+ * state, if there's a sound effect thread.
+ *
+ * @param manager Audio manager to lock.
+ */
+AudioManager::EffectsLock::EffectsLock(const AudioManager* manager) :
+    sync(manager->effects_ticker) {
+    
+    if(sync) sync->mutex.lock();
+}
+
+
+/**
+ * @brief Destroys the effects lock object, unlocking the sound effect state.
+ */
+AudioManager::EffectsLock::~EffectsLock() {
+    if(sync) sync->mutex.unlock();
+}
+
 
 /**
  * @brief Creates an in-world global sound effect source and returns its ID.
@@ -104,13 +225,15 @@ size_t AudioManager::create_mob_sound_source(
     Mob* m_ptr, bool ambiance,
     const SoundSourceConfig &config
 ) {
+    EffectsLock lock(this);
     size_t source_id =
         create_sound_source(
             sample,
             ambiance ? SOUND_TYPE_AMBIANCE_POS : SOUND_TYPE_GAMEPLAY_POS,
             config, m_ptr->pos
         );
-    mob_sources[source_id] = m_ptr;
+    SoundSource* source_ptr = get_source(source_id);
+    if(source_ptr) source_ptr->mob = m_ptr;
     return source_id;
 }
 
@@ -156,25 +279,36 @@ size_t AudioManager::create_sound_source(
     const Point &pos
 ) {
     if(!sample) return 0;
+    EffectsLock lock(this);
+    
+    size_t idx;
+    if(!free_source_slots.empty()) {
+        idx = free_source_slots.back();
+        free_source_slots.pop_back();
+    } else {
+        idx = source_slots.size();
+        if(idx >> AUDIO::SOURCE_ID_INDEX_BITS) return 0;
+        source_slots.push_back(SourceSlot());
+    }
     
-    size_t id = next_sound_source_id;
+    SourceSlot* slot_ptr = &source_slots[idx];
+    slot_ptr->in_use = true;
+    slot_ptr->source = SoundSource();
+    slot_ptr->source.sample = sample;
+    slot_ptr->source.type = type;
+    slot_ptr->source.config = config;
+    slot_ptr->source.pos = pos;
     
-    sources[id] = SoundSource();
-    sources[id].sample = sample;
-    sources[id].type = type;
-    sources[id].config = config;
-    sources[id].pos = pos;
+    size_t id = (slot_ptr->generation << AUDIO::SOURCE_ID_INDEX_BITS) | idx;
     
     if(!has_flag(config.flags, SOUND_FLAG_DONT_EMIT_ON_CREATION)) {
         schedule_emission(id, true);
-        if(sources[id].emit_time_left <= 0.0f) {
+        if(slot_ptr->source.emit_time_left <= 0.0f) {
             emit(id);
             schedule_emission(id, false);
         }
     }
     
-    next_sound_source_id++; //Hopefully there will be no collisions.
-    
     return id;
 }
 
@@ -196,10 +330,101 @@ size_t AudioManager::create_ui_sound_source(
 }
 
 
+/**
+ * @brief Hands a song track that the worker thread opened to its song.
+ * If it's a mix track, and the song is playing, the track starts playing
+ * in sync with the main track.
+ *
+ * @param song_name Internal name of the song.
+ * @param track_type Mix track type, or N_MIX_TRACK_TYPES for the main track.
+ * @param track_name Internal name of the track.
+ * @param stream Opened stream, or nullptr if it couldn't be opened.
+ */
+void AudioManager::deliver_song_track(
+    const string &song_name, MIX_TRACK_TYPE track_type,
+    const string &track_name, ALLEGRO_AUDIO_STREAM* stream
+) {
+    pending_song_tracks.erase(std::make_pair(song_name, track_type));
+    
+    Song* song_ptr = nullptr;
+    auto song_it = game.content.songs.list.find(song_name);
+    if(song_it != game.content.songs.list.end()) {
+        song_ptr = &song_it->second;
+    }
+    bool is_main = track_type == N_MIX_TRACK_TYPES;
+    if(
+        !song_ptr ||
+        (is_main && song_ptr->main_track) ||
+        (!is_main && song_ptr->mix_tracks.find(track_type) !=
+            song_ptr->mix_tracks.end())
+    ) {
+        //Nobody needs it anymore.
+        if(stream) al_destroy_audio_stream(stream);
+        return;
+    }
+    
+    if(stream) {
+        game.register_audio_stream_source(stream);
+        stream = game.content.song_tracks.list.add(track_name, stream, 1);
+    } else {
+        //Let the manager try again, and report the error properly.
+        stream = game.content.song_tracks.list.get(track_name);
+    }
+    
+    if(is_main) {
+        song_ptr->main_track = stream;
+        if(song_ptr->loop_end == 0.0f && stream) {
+            song_ptr->loop_end = al_get_audio_stream_length_secs(stream);
+        }
+        if(song_ptr->loop_end < song_ptr->loop_start) {
+            song_ptr->loop_start = 0.0f;
+        }
+        return;
+    }
+    
+    song_ptr->mix_tracks[track_type] = stream;
+    if(
+        stream && song_ptr->main_track &&
+        song_ptr->state != SONG_STATE_STOPPED
+    ) {
+        bool loop =
+            al_get_audio_stream_playmode(song_ptr->main_track) ==
+            ALLEGRO_PLAYMODE_LOOP;
+        start_song_track(song_ptr, stream, true, true, loop);
+        al_seek_audio_stream_secs(
+            stream, al_get_audio_stream_position_secs(song_ptr->main_track)
+        );
+    }
+}
+
+
 /**
  * @brief Destroys the audio manager.
  */
 void AudioManager::destroy() {
+    if(effects_ticker) {
+        effects_ticker->stopping = true;
+        effects_ticker->worker.join();
+        delete effects_ticker;
+        effects_ticker = nullptr;
+    }
+    
+    if(track_loader) {
+        {
+            std::unique_lock<std::mutex> lock(track_loader->mutex);
+            track_loader->stopping = true;
+            track_loader->work_cond.notify_all();
+        }
+        track_loader->worker.join();
+        for(size_t r = 0; r < track_loader->results.size(); r++) {
+            TrackLoaderSyncData::Job* job_ptr = &track_loader->results[r];
+            if(job_ptr->stream) al_destroy_audio_stream(job_ptr->stream);
+        }
+        delete track_loader;
+        track_loader = nullptr;
+        pending_song_tracks.clear();
+    }
+    
     al_detach_voice(voice);
     al_destroy_mixer(gameplay_sound_mixer);
     al_destroy_mixer(music_mixer);
@@ -241,6 +466,15 @@ bool AudioManager::destroy_sound_playback(size_t playback_idx) {
         playback_ptr->allegro_sample_instance = nullptr;
     }
     
+    //Destroy the Allegro audio stream.
+    ALLEGRO_AUDIO_STREAM* stream = playback_ptr->allegro_stream;
+    if(stream) {
+        al_set_audio_stream_playing(stream, false);
+        al_detach_audio_stream(stream);
+        al_destroy_audio_stream(stream);
+        playback_ptr->allegro_stream = nullptr;
+    }
+    
     return true;
 }
 
@@ -252,6 +486,7 @@ bool AudioManager::destroy_sound_playback(size_t playback_idx) {
  * @return Whether it succeeded.
  */
 bool AudioManager::destroy_sound_source(size_t source_id) {
+    EffectsLock lock(this);
     SoundSource* source_ptr = get_source(source_id);
     if(!source_ptr) return false;
     
@@ -283,6 +518,8 @@ bool AudioManager::destroy_sound_source(size_t source_id) {
  * @return Whether it succeeded.
  */
 bool AudioManager::emit(size_t source_id) {
+    EffectsLock lock(this);
+    
     //Setup.
     SoundSource* source_ptr = get_source(source_id);
     if(!source_ptr) return false;
@@ -296,16 +533,18 @@ bool AudioManager::emit(size_t source_id) {
         source_ptr->config.stack_min_pos > 0.0f ||
         source_ptr->config.stack_mode == SOUND_STACK_MODE_NEVER
     ) {
-        for(size_t p = 0; p < playbacks.size(); p++) {
+        float sample_freq = (float) al_get_sample_frequency(sample);
+        for(size_t p : sample_playbacks[sample]) {
             SoundPlayback* playback = &playbacks[p];
-            SoundSource* p_source_ptr = get_source(playback->source_id);
-            if(!p_source_ptr || p_source_ptr->sample != sample) continue;
+            if(playback->state == SOUND_PLAYBACK_STATE_DESTROYED) continue;
+            if(
+                !playback->allegro_sample_instance &&
+                !playback->allegro_stream
+            ) {
+                continue;
+            }
             
-            float playback_pos =
-                al_get_sample_instance_position(
-                    playback->allegro_sample_instance
-                ) /
-                (float) al_get_sample_frequency(p_source_ptr->sample);
+            float playback_pos = get_playback_pos(p) / sample_freq;
             lowest_stacking_playback_pos =
                 std::min(lowest_stacking_playback_pos, playback_pos);
         }
@@ -329,12 +568,7 @@ bool AudioManager::emit(size_t source_id) {
     
     //Check if other playbacks exist and if we need to stop them.
     if(source_ptr->config.stack_mode == SOUND_STACK_MODE_OVERRIDE) {
-        for(size_t p = 0; p < playbacks.size(); p++) {
-            SoundPlayback* playback = &playbacks[p];
-            SoundSource* p_source_ptr = get_source(playback->source_id);
-            if(!p_source_ptr || p_source_ptr->sample != sample) {
-                continue;
-            }
+        for(size_t p : sample_playbacks[sample]) {
             stop_sound_playback(p);
         }
     }
@@ -343,13 +577,22 @@ bool AudioManager::emit(size_t source_id) {
     playbacks.push_back(SoundPlayback());
     SoundPlayback* playback_ptr = &playbacks.back();
     playback_ptr->source_id = source_id;
-    playback_ptr->allegro_sample_instance = al_create_sample_instance(sample);
-    if(!playback_ptr->allegro_sample_instance) return false;
+    playback_ptr->sample = sample;
+    playback_ptr->type = source_ptr->type;
+    playback_ptr->priority = source_ptr->config.priority;
+    sample_playbacks[sample].push_back(playbacks.size() - 1);
+    playback_ptr->allegro_stream =
+        game.content.sounds.list.create_compressed_stream(sample);
+    if(!playback_ptr->allegro_stream) {
+        playback_ptr->allegro_sample_instance =
+            al_create_sample_instance(sample);
+        if(!playback_ptr->allegro_sample_instance) return false;
+    }
     
     playback_ptr->base_gain = source_ptr->config.gain;
     if(source_ptr->config.gain_deviation != 0.0f) {
         playback_ptr->base_gain +=
-            game.rng.f(
+            rng.f(
                 -source_ptr->config.gain_deviation,
                 source_ptr->config.gain_deviation
             );
@@ -378,41 +621,88 @@ bool AudioManager::emit(size_t source_id) {
     }
     }
     
-    al_attach_sample_instance_to_mixer(
-        playback_ptr->allegro_sample_instance, mixer
-    );
-    
-    al_set_sample_instance_playmode(
-        playback_ptr->allegro_sample_instance,
+    ALLEGRO_PLAYMODE playmode =
         has_flag(source_ptr->config.flags, SOUND_FLAG_LOOP) ?
         ALLEGRO_PLAYMODE_LOOP :
-        ALLEGRO_PLAYMODE_ONCE
-    );
+        ALLEGRO_PLAYMODE_ONCE;
     float speed = source_ptr->config.speed;
     if(source_ptr->config.speed_deviation != 0.0f) {
         speed +=
-            game.rng.f(
+            rng.f(
                 -source_ptr->config.speed_deviation,
                 source_ptr->config.speed_deviation
             );
     }
     speed = std::max(0.0f, speed);
-    al_set_sample_instance_speed(playback_ptr->allegro_sample_instance, speed);
+    playback_ptr->speed = speed;
+    
+    if(playback_ptr->allegro_stream) {
+        al_attach_audio_stream_to_mixer(playback_ptr->allegro_stream, mixer);
+        al_set_audio_stream_playmode(playback_ptr->allegro_stream, playmode);
+        al_set_audio_stream_speed(playback_ptr->allegro_stream, speed);
+    } else {
+        al_attach_sample_instance_to_mixer(
+            playback_ptr->allegro_sample_instance, mixer
+        );
+        al_set_sample_instance_playmode(
+            playback_ptr->allegro_sample_instance, playmode
+        );
+        al_set_sample_instance_speed(
+            playback_ptr->allegro_sample_instance, speed
+        );
+    }
     update_playback_gain_and_pan(playbacks.size() - 1);
     
-    al_set_sample_instance_position(
-        playback_ptr->allegro_sample_instance,
-        0.0f
-    );
-    al_set_sample_instance_playing(
-        playback_ptr->allegro_sample_instance,
-        true
-    );
+    set_playback_pos(playbacks.size() - 1, 0);
+    set_playback_playing(playbacks.size() - 1, true);
     
     return true;
 }
 
 
+/**
+ * @brief Returns how long a playback's sample is, in sample frames.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @return The length.
+ */
+float AudioManager::get_playback_length(size_t playback_idx) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->allegro_stream) {
+        return
+            (float) al_get_audio_stream_length_secs(
+                playback_ptr->allegro_stream
+            ) *
+            al_get_sample_frequency(playback_ptr->sample);
+    }
+    return (float) al_get_sample_length(playback_ptr->sample);
+}
+
+
+/**
+ * @brief Returns a playback's current position, in sample frames.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @return The position.
+ */
+unsigned int AudioManager::get_playback_pos(size_t playback_idx) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->allegro_stream) {
+        return
+            (unsigned int) (
+                al_get_audio_stream_position_secs(
+                    playback_ptr->allegro_stream
+                ) *
+                al_get_sample_frequency(playback_ptr->sample)
+            );
+    }
+    return
+        al_get_sample_instance_position(
+            playback_ptr->allegro_sample_instance
+        );
+}
+
+
 /**
  * @brief Returns a source's pointer from a source in the list.
  *
@@ -420,9 +710,27 @@ bool AudioManager::emit(size_t source_id) {
  * @return The source, or nullptr if invalid.
  */
 SoundSource* AudioManager::get_source(size_t source_id) {
-    auto source_it = sources.find(source_id);
-    if(source_it == sources.end()) return nullptr;
-    return &source_it->second;
+    size_t idx = source_id & ((1ULL << AUDIO::SOURCE_ID_INDEX_BITS) - 1);
+    size_t generation = source_id >> AUDIO::SOURCE_ID_INDEX_BITS;
+    if(idx >= source_slots.size()) return nullptr;
+    SourceSlot* slot_ptr = &source_slots[idx];
+    if(!slot_ptr->in_use || slot_ptr->generation != generation) return nullptr;
+    return &slot_ptr->source;
+}
+
+
+/**
+ * @brief Returns how many sound playbacks currently exist, for debugging.
+ *
+ * @return The amount.
+ */
+size_t AudioManager::get_nr_playbacks() const {
+    EffectsLock lock(this);
+    size_t nr = 0;
+    for(size_t p = 0; p < playbacks.size(); p++) {
+        if(playbacks[p].state != SOUND_PLAYBACK_STATE_DESTROYED) nr++;
+    }
+    return nr;
 }
 
 
@@ -432,11 +740,10 @@ SoundSource* AudioManager::get_source(size_t source_id) {
  * @param m_ptr Mob that got deleted.
  */
 void AudioManager::handle_mob_deletion(const Mob* m_ptr) {
-    for(auto s = mob_sources.begin(); s != mob_sources.end();) {
-        if(s->second == m_ptr) {
-            s = mob_sources.erase(s);
-        } else {
-            ++s;
+    EffectsLock lock(this);
+    for(size_t s = 0; s < source_slots.size(); s++) {
+        if(source_slots[s].source.mob == m_ptr) {
+            source_slots[s].source.mob = nullptr;
         }
     }
 }
@@ -460,6 +767,8 @@ void AudioManager::handle_stream_finished(ALLEGRO_AUDIO_STREAM* stream) {
  * @brief Handles the gameplay of the game world being paused.
  */
 void AudioManager::handle_world_pause() {
+    EffectsLock lock(this);
+    
     //Pause playbacks.
     for(size_t p = 0; p < playbacks.size(); p++) {
         SoundPlayback* playback_ptr = &playbacks[p];
@@ -497,6 +806,8 @@ void AudioManager::handle_world_pause() {
  * @brief Handles the gameplay of the game world being unpaused.
  */
 void AudioManager::handle_world_unpause() {
+    EffectsLock lock(this);
+    
     //Unpause playbacks.
     for(size_t p = 0; p < playbacks.size(); p++) {
         SoundPlayback* playback_ptr = &playbacks[p];
@@ -514,14 +825,9 @@ void AudioManager::handle_world_unpause() {
             source_ptr->type == SOUND_TYPE_AMBIANCE_POS
         ) {
             playback_ptr->state = SOUND_PLAYBACK_STATE_UNPAUSING;
-            al_set_sample_instance_playing(
-                playback_ptr->allegro_sample_instance,
-                true
-            );
-            al_set_sample_instance_position(
-                playback_ptr->allegro_sample_instance,
-                playback_ptr->pre_pause_pos
-            );
+            if(playback_ptr->is_virtual) continue;
+            set_playback_playing(p, true);
+            set_playback_pos(p, playback_ptr->pre_pause_pos);
         }
     }
     
@@ -538,6 +844,63 @@ void AudioManager::handle_world_unpause() {
 }
 
 
+/**
+ * @brief Rebuilds the list of which playbacks play each sample, since
+ * the playbacks' indexes changed.
+ */
+void AudioManager::index_sample_playbacks() {
+    for(auto &s : sample_playbacks) {
+        s.second.clear();
+    }
+    for(size_t p = 0; p < playbacks.size(); p++) {
+        sample_playbacks[playbacks[p].sample].push_back(p);
+    }
+    for(auto s = sample_playbacks.begin(); s != sample_playbacks.end();) {
+        if(s->second.empty()) {
+            s = sample_playbacks.erase(s);
+        } else {
+            ++s;
+        }
+    }
+}
+
+
+/**
+ * @brief Returns whether a playback loops.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @return Whether it loops.
+ */
+bool AudioManager::is_playback_looping(size_t playback_idx) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    ALLEGRO_PLAYMODE playmode =
+        playback_ptr->allegro_stream ?
+        al_get_audio_stream_playmode(playback_ptr->allegro_stream) :
+        al_get_sample_instance_playmode(
+            playback_ptr->allegro_sample_instance
+        );
+    return playmode == ALLEGRO_PLAYMODE_LOOP;
+}
+
+
+/**
+ * @brief Returns whether a playback is being played by Allegro right now.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @return Whether it's playing.
+ */
+bool AudioManager::is_playback_playing(size_t playback_idx) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->allegro_stream) {
+        return al_get_audio_stream_playing(playback_ptr->allegro_stream);
+    }
+    return
+        al_get_sample_instance_playing(
+            playback_ptr->allegro_sample_instance
+        );
+}
+
+
 /**
  * @brief Initializes the audio manager.
  *
@@ -551,6 +914,8 @@ void AudioManager::init(
     float master_volume, float gameplay_sound_volume, float music_volume,
     float ambiance_sound_volume, float ui_sound_volume
 ) {
+    rng.init();
+    
     //Main voice.
     voice =
         al_create_voice(
@@ -606,6 +971,50 @@ void AudioManager::init(
         mix_statuses.push_back(false);
         mix_volumes.push_back(0.0f);
     }
+    
+    //Song track loader.
+    if(!track_loader) {
+        track_loader = new TrackLoaderSyncData();
+        track_loader->worker =
+            std::thread(&AudioManager::load_song_tracks_work, this);
+    }
+    
+    //Sound effect thread.
+    if(!effects_ticker) {
+        effects_ticker = new EffectsTickerSyncData();
+        effects_ticker->worker =
+            std::thread(&AudioManager::tick_effects_work, this);
+    }
+}
+
+
+/**
+ * @brief Code for the song track loader's worker thread. It opens song
+ * tracks until it's told to stop.
+ */
+void AudioManager::load_song_tracks_work() {
+    set_up_thread();
+    
+    TrackLoaderSyncData* sync = track_loader;
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    while(true) {
+        sync->work_cond.wait(
+            lock, [sync] () { return sync->stopping || !sync->jobs.empty(); }
+        );
+        if(sync->stopping) break;
+        
+        TrackLoaderSyncData::Job job = sync->jobs.front();
+        sync->jobs.pop_front();
+        sync->busy = true;
+        
+        lock.unlock();
+        job.stream = load_audio_stream(job.path, nullptr, false);
+        lock.lock();
+        
+        sync->busy = false;
+        sync->results.push_back(job);
+        sync->done_cond.notify_all();
+    }
 }
 
 
@@ -619,6 +1028,86 @@ void AudioManager::mark_mix_track_status(MIX_TRACK_TYPE track_type) {
 }
 
 
+/**
+ * @brief Makes sure a song's main track is open, opening it right away if
+ * need be. If the worker thread is still opening it, this waits for it.
+ *
+ * @param song_ptr The song.
+ */
+void AudioManager::open_song_main_track(Song* song_ptr) {
+    if(song_ptr->main_track) return;
+    
+    if(
+        pending_song_tracks.find(
+            std::make_pair(song_ptr->manifest->internal_name, N_MIX_TRACK_TYPES)
+        ) != pending_song_tracks.end()
+    ) {
+        update_song_tracks(true);
+        if(song_ptr->main_track) return;
+    }
+    
+    deliver_song_track(
+        song_ptr->manifest->internal_name, N_MIX_TRACK_TYPES,
+        song_ptr->main_track_name, nullptr
+    );
+}
+
+
+/**
+ * @brief Starts opening a song's main track in the background, so it's
+ * ready by the time the song needs to play. Useful for loading screens.
+ *
+ * @param name Name of the song in the list of loaded songs.
+ */
+void AudioManager::prepare_song(const string &name) {
+    auto song_it = game.content.songs.list.find(name);
+    if(song_it == game.content.songs.list.end()) return;
+    Song* song_ptr = &song_it->second;
+    if(song_ptr->main_track) return;
+    
+    request_song_track(name, N_MIX_TRACK_TYPES, song_ptr->main_track_name);
+}
+
+
+/**
+ * @brief Asks the worker thread to open a song track. If there's no worker,
+ * or the track is already loaded, it's handed to the song right away.
+ *
+ * @param song_name Internal name of the song.
+ * @param track_type Mix track type, or N_MIX_TRACK_TYPES for the main track.
+ * @param track_name Internal name of the track.
+ */
+void AudioManager::request_song_track(
+    const string &song_name, MIX_TRACK_TYPE track_type,
+    const string &track_name
+) {
+    std::pair<string, MIX_TRACK_TYPE> key =
+        std::make_pair(song_name, track_type);
+    if(pending_song_tracks.find(key) != pending_song_tracks.end()) return;
+    
+    if(!track_loader || game.content.song_tracks.list.is_loaded(track_name)) {
+        deliver_song_track(song_name, track_type, track_name, nullptr);
+        return;
+    }
+    
+    pending_song_tracks.insert(key);
+    
+    TrackLoaderSyncData::Job new_job;
+    new_job.song_name = song_name;
+    new_job.track_type = track_type;
+    new_job.track_name = track_name;
+    const auto &it = game.content.song_tracks.manifests.find(track_name);
+    new_job.path =
+        it != game.content.song_tracks.manifests.end() ?
+        it->second.path :
+        track_name;
+        
+    std::unique_lock<std::mutex> lock(track_loader->mutex);
+    track_loader->jobs.push_back(new_job);
+    track_loader->work_cond.notify_one();
+}
+
+
 /**
  * @brief Sets a song's position to the beginning.
  *
@@ -631,9 +1120,11 @@ bool AudioManager::rewind_song(const string &name) {
     Song* song_ptr = &song_it->second;
     
     song_ptr->stop_point = 0.0f;
-    al_rewind_audio_stream(song_ptr->main_track);
+    if(song_ptr->main_track) {
+        al_rewind_audio_stream(song_ptr->main_track);
+    }
     for(auto const &m : song_ptr->mix_tracks) {
-        al_rewind_audio_stream(m.second);
+        if(m.second) al_rewind_audio_stream(m.second);
     }
     
     return true;
@@ -649,13 +1140,14 @@ bool AudioManager::rewind_song(const string &name) {
  * @return Whether it succeeded.
  */
 bool AudioManager::schedule_emission(size_t source_id, bool first) {
+    EffectsLock lock(this);
     SoundSource* source_ptr = get_source(source_id);
     if(!source_ptr) return false;
     
     source_ptr->emit_time_left = first ? 0.0f : source_ptr->config.interval;
     if(first || source_ptr->config.interval > 0.0f) {
         source_ptr->emit_time_left +=
-            game.rng.f(0, source_ptr->config.random_delay);
+            rng.f(0, source_ptr->config.random_delay);
     }
     
     return true;
@@ -669,6 +1161,7 @@ bool AudioManager::schedule_emission(size_t source_id, bool first) {
  * @param cam_br Current coordinates of the camera's bottom-right corner.
  */
 void AudioManager::set_camera_pos(const Point &cam_tl, const Point &cam_br) {
+    EffectsLock lock(this);
     this->cam_tl = cam_tl;
     this->cam_br = cam_br;
 }
@@ -743,6 +1236,7 @@ bool AudioManager::set_current_song(
     } case SONG_STATE_STOPPED: {
         //Start it.
         if(song_ptr->state == SONG_STATE_STOPPED) {
+            open_song_main_track(song_ptr);
             start_song_track(
                 song_ptr, song_ptr->main_track, from_start, fade_in, loop
             );
@@ -759,16 +1253,87 @@ bool AudioManager::set_current_song(
 }
 
 
+/**
+ * @brief Makes Allegro play or stop playing a playback.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @param playing Whether it should play.
+ */
+void AudioManager::set_playback_playing(size_t playback_idx, bool playing) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->allegro_stream) {
+        al_set_audio_stream_playing(playback_ptr->allegro_stream, playing);
+    } else {
+        al_set_sample_instance_playing(
+            playback_ptr->allegro_sample_instance, playing
+        );
+    }
+}
+
+
+/**
+ * @brief Sets a playback's current position.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @param pos Position, in sample frames.
+ */
+void AudioManager::set_playback_pos(size_t playback_idx, unsigned int pos) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->allegro_stream) {
+        al_seek_audio_stream_secs(
+            playback_ptr->allegro_stream,
+            pos / (double) al_get_sample_frequency(playback_ptr->sample)
+        );
+    } else {
+        al_set_sample_instance_position(
+            playback_ptr->allegro_sample_instance, pos
+        );
+    }
+}
+
+
+/**
+ * @brief Makes a playback virtual, meaning it stops being mixed but its
+ * position keeps being tracked, or makes it real again, resuming it from
+ * where it would be at.
+ *
+ * @param playback_idx Index of the playback in the list.
+ * @param is_virtual Whether it should be virtual.
+ */
+void AudioManager::set_playback_virtual(size_t playback_idx, bool is_virtual) {
+    SoundPlayback* playback_ptr = &playbacks[playback_idx];
+    if(playback_ptr->is_virtual == is_virtual) return;
+    if(
+        !playback_ptr->allegro_sample_instance &&
+        !playback_ptr->allegro_stream
+    ) {
+        return;
+    }
+    playback_ptr->is_virtual = is_virtual;
+    
+    if(is_virtual) {
+        playback_ptr->virtual_pos = get_playback_pos(playback_idx);
+        set_playback_playing(playback_idx, false);
+    } else {
+        set_playback_pos(
+            playback_idx, (unsigned int) playback_ptr->virtual_pos
+        );
+        set_playback_playing(playback_idx, true);
+    }
+}
+
+
 /**
  * @brief Sets the current position of all songs to be near the loop point.
  * This is helpful for when you want to test said loop point.
  */
 void AudioManager::set_song_pos_near_loop() {
-    for(auto s : game.content.songs.list) {
+    for(auto &s : game.content.songs.list) {
+        if(!s.second.main_track) continue;
         double pos = std::max(0.0, s.second.loop_end - 4.0f);
         al_seek_audio_stream_secs(s.second.main_track, pos);
         for(auto const &m : s.second.mix_tracks) {
-            al_seek_audio_stream_secs(m.second, pos);
+            if(m.second) al_seek_audio_stream_secs(m.second, pos);
         }
     }
 }
@@ -782,6 +1347,7 @@ void AudioManager::set_song_pos_near_loop() {
  * @return Whether it succeeded.
  */
 bool AudioManager::set_sound_source_pos(size_t source_id, const Point &pos) {
+    EffectsLock lock(this);
     SoundSource* source_ptr = get_source(source_id);
     if(!source_ptr) return false;
     
@@ -827,23 +1393,19 @@ void AudioManager::start_song_track(
  * @param filter Sound sample to filter by, or nullptr to stop all playbacks.
  */
 void AudioManager::stop_all_playbacks(const ALLEGRO_SAMPLE* filter) {
-    for(size_t p = 0; p < playbacks.size(); p++) {
-        bool to_stop = false;
-        
-        if(!filter) {
-            to_stop = true;
-        } else {
-            SoundPlayback* playback_ptr = &playbacks[p];
-            SoundSource* source_ptr =
-                get_source(playback_ptr->source_id);
-            if(source_ptr && source_ptr->sample == filter) {
-                to_stop = true;
-            }
-        }
-        
-        if(to_stop) {
+    EffectsLock lock(this);
+    
+    if(!filter) {
+        for(size_t p = 0; p < playbacks.size(); p++) {
             stop_sound_playback(p);
         }
+        return;
+    }
+    
+    auto it = sample_playbacks.find(filter);
+    if(it == sample_playbacks.end()) return;
+    for(size_t p : it->second) {
+        stop_sound_playback(p);
     }
 }
 
@@ -864,136 +1426,36 @@ bool AudioManager::stop_sound_playback(size_t playback_idx) {
 
 
 /**
- * @brief Ticks the audio manager by one frame of logic.
+ * @brief Ticks the audio manager by one frame of logic. Sound sources
+ * and playbacks are ticked by their own thread, so this only feeds it
+ * what belongs to the main thread, and takes care of songs.
  *
  * @param delta_t How long the frame's tick is, in seconds.
  */
 void AudioManager::tick(float delta_t) {
-    //Clear deleted mob sources.
-    for(auto s = mob_sources.begin(); s != mob_sources.end();) {
-        Mob* mob_ptr = s->second;
-        if(!mob_ptr || mob_ptr->to_delete) {
-            s = mob_sources.erase(s);
-        } else {
-            ++s;
-        }
-    }
-    
-    //Update the position of sources tied to mobs.
-    for(auto &s : sources) {
-        if(s.second.destroyed) continue;
-        auto mob_source_it = mob_sources.find(s.first);
-        if(mob_source_it == mob_sources.end()) continue;
-        Mob* mob_ptr = mob_source_it->second;
-        if(!mob_ptr || mob_ptr->to_delete) continue;
-        s.second.pos = mob_ptr->pos;
-    }
-    
-    //Emit playbacks from sources that want to emit.
-    for(auto &s : sources) {
-        if(s.second.destroyed) continue;
-        if(s.second.emit_time_left == 0.0f) continue;
+    {
+        EffectsLock lock(this);
         
-        s.second.emit_time_left -= delta_t;
-        if(s.second.emit_time_left <= 0.0f) {
-            emit(s.first);
-            schedule_emission(s.first, false);
-        }
-    }
-    
-    //Update playbacks.
-    for(size_t p = 0; p < playbacks.size(); p++) {
-        SoundPlayback* playback_ptr = &playbacks[p];
-        if(playback_ptr->state == SOUND_PLAYBACK_STATE_DESTROYED) continue;
-        
-        if(
-            !al_get_sample_instance_playing(
-                playback_ptr->allegro_sample_instance
-            ) &&
-            playback_ptr->state != SOUND_PLAYBACK_STATE_PAUSED
-        ) {
-            //Finished playing entirely.
-            destroy_sound_playback(p);
-            
-        } else {
-            //Update target gain and pan, based on in-world position,
-            //if applicable.
-            update_playback_target_gain_and_pan(p);
-            
-            //Inch the gain and pan to the target values.
-            playback_ptr->gain =
-                inch_towards(
-                    playback_ptr->gain,
-                    playback_ptr->target_gain,
-                    AUDIO::PLAYBACK_GAIN_SPEED * delta_t
-                );
-            playback_ptr->pan =
-                inch_towards(
-                    playback_ptr->pan,
-                    playback_ptr->target_pan,
-                    AUDIO::PLAYBACK_PAN_SPEED * delta_t
-                );
-                
-            //Pausing and unpausing.
-            if(playback_ptr->state == SOUND_PLAYBACK_STATE_PAUSING) {
-                playback_ptr->state_gain_mult -=
-                    AUDIO::PLAYBACK_PAUSE_GAIN_SPEED * delta_t;
-                if(playback_ptr->state_gain_mult <= 0.0f) {
-                    playback_ptr->state_gain_mult = 0.0f;
-                    playback_ptr->state = SOUND_PLAYBACK_STATE_PAUSED;
-                    playback_ptr->pre_pause_pos =
-                        al_get_sample_instance_position(
-                            playback_ptr->allegro_sample_instance
-                        );
-                    al_set_sample_instance_playing(
-                        playback_ptr->allegro_sample_instance,
-                        false
-                    );
-                }
-            } else if(playback_ptr->state == SOUND_PLAYBACK_STATE_UNPAUSING) {
-                playback_ptr->state_gain_mult +=
-                    AUDIO::PLAYBACK_PAUSE_GAIN_SPEED * delta_t;
-                if(playback_ptr->state_gain_mult >= 1.0f) {
-                    playback_ptr->state_gain_mult = 1.0f;
-                    playback_ptr->state = SOUND_PLAYBACK_STATE_PLAYING;
-                }
-            }
+        //Update the position of sources tied to mobs. Mobs belong to
+        //this thread, so the sound effect thread can't look at them.
+        for(size_t s = 0; s < source_slots.size(); s++) {
+            SourceSlot* slot_ptr = &source_slots[s];
+            if(!slot_ptr->in_use) continue;
+            SoundSource* source_ptr = &slot_ptr->source;
+            if(source_ptr->destroyed || !source_ptr->mob) continue;
             
-            //Stopping.
-            if(playback_ptr->state == SOUND_PLAYBACK_STATE_STOPPING) {
-                playback_ptr->state_gain_mult -=
-                    AUDIO::PLAYBACK_STOP_GAIN_SPEED * delta_t;
-                if(playback_ptr->state_gain_mult <= 0.0f) {
-                    destroy_sound_playback(p);
-                }
+            if(source_ptr->mob->to_delete) {
+                source_ptr->mob = nullptr;
+            } else {
+                source_ptr->pos = source_ptr->mob->pos;
             }
-            
-            //Update the final gain and pan values.
-            update_playback_gain_and_pan(p);
-        }
-    }
-    
-    //Delete destroyed playbacks.
-    for(size_t p = 0; p < playbacks.size();) {
-        if(playbacks[p].state == SOUND_PLAYBACK_STATE_DESTROYED) {
-            playbacks.erase(playbacks.begin() + p);
-        } else {
-            p++;
         }
+        
+        if(!effects_ticker) tick_effects(delta_t);
     }
     
-    //Delete destroyed sources.
-    for(auto s = sources.begin(); s != sources.end();) {
-        if(s->second.destroyed) {
-            auto mob_source_it = mob_sources.find(s->first);
-            if(mob_source_it != mob_sources.end()) {
-                mob_sources.erase(mob_source_it);
-            }
-            s = sources.erase(s);
-        } else {
-            ++s;
-        }
-    }
+    //Hand over song tracks that were opened in the background.
+    update_song_tracks(false);
     
     //Update the volume of songs depending on their state.
     for(auto &s : game.content.songs.list) {
@@ -1054,6 +1516,7 @@ void AudioManager::tick(float delta_t) {
                 al_set_audio_stream_playing(song_ptr->main_track, false);
                 al_detach_audio_stream(song_ptr->main_track);
                 for(auto &m : song_ptr->mix_tracks) {
+                    if(!m.second) continue;
                     al_set_audio_stream_playing(m.second, false);
                     al_detach_audio_stream(m.second);
                 }
@@ -1085,7 +1548,18 @@ void AudioManager::tick(float delta_t) {
             }
             
             auto track_it = song_ptr->mix_tracks.find((MIX_TRACK_TYPE) m);
-            if(track_it == song_ptr->mix_tracks.end()) continue;
+            if(track_it == song_ptr->mix_tracks.end()) {
+                //Only open the track once it's needed for the first time.
+                if(!mix_statuses[m]) continue;
+                auto name_it =
+                    song_ptr->mix_track_names.find((MIX_TRACK_TYPE) m);
+                if(name_it == song_ptr->mix_track_names.end()) continue;
+                request_song_track(
+                    s.first, (MIX_TRACK_TYPE) m, name_it->second
+                );
+                continue;
+            }
+            if(!track_it->second) continue;
             
             al_set_audio_stream_gain(
                 track_it->second, mix_volumes[m] * song_ptr->gain
@@ -1101,6 +1575,174 @@ void AudioManager::tick(float delta_t) {
 }
 
 
+/**
+ * @brief Ticks sound sources and playbacks: emits from sources that want to
+ * emit, fades playbacks, and cleans up the ones that are done. This runs on
+ * the sound effect thread, with the lock held.
+ *
+ * @param delta_t How long the tick is, in seconds.
+ */
+void AudioManager::tick_effects(float delta_t) {
+    //Emit playbacks from sources that want to emit.
+    for(size_t s = 0; s < source_slots.size(); s++) {
+        SourceSlot* slot_ptr = &source_slots[s];
+        if(!slot_ptr->in_use) continue;
+        SoundSource* source_ptr = &slot_ptr->source;
+        if(source_ptr->destroyed) continue;
+        
+        if(source_ptr->emit_time_left == 0.0f) continue;
+        
+        source_ptr->emit_time_left -= delta_t;
+        if(source_ptr->emit_time_left <= 0.0f) {
+            size_t id =
+                (slot_ptr->generation << AUDIO::SOURCE_ID_INDEX_BITS) | s;
+            emit(id);
+            schedule_emission(id, false);
+        }
+    }
+    
+    //Update playbacks.
+    for(size_t p = 0; p < playbacks.size(); p++) {
+        SoundPlayback* playback_ptr = &playbacks[p];
+        if(playback_ptr->state == SOUND_PLAYBACK_STATE_DESTROYED) continue;
+        
+        bool finished = false;
+        if(playback_ptr->is_virtual) {
+            //Keep track of where it would be if it were being mixed.
+            if(playback_ptr->state != SOUND_PLAYBACK_STATE_PAUSED) {
+                float length = get_playback_length(p);
+                playback_ptr->virtual_pos +=
+                    delta_t * playback_ptr->speed *
+                    al_get_sample_frequency(playback_ptr->sample);
+                if(playback_ptr->virtual_pos >= length) {
+                    if(is_playback_looping(p) && length > 0.0f) {
+                        playback_ptr->virtual_pos =
+                            fmod(playback_ptr->virtual_pos, length);
+                    } else {
+                        finished = true;
+                    }
+                }
+            }
+        } else {
+            finished =
+                !is_playback_playing(p) &&
+                playback_ptr->state != SOUND_PLAYBACK_STATE_PAUSED;
+        }
+        
+        if(finished) {
+            //Finished playing entirely.
+            destroy_sound_playback(p);
+            
+        } else {
+            //Update target gain and pan, based on in-world position,
+            //if applicable.
+            update_playback_target_gain_and_pan(p);
+            
+            //Inch the gain and pan to the target values.
+            playback_ptr->gain =
+                inch_towards(
+                    playback_ptr->gain,
+                    playback_ptr->target_gain,
+                    AUDIO::PLAYBACK_GAIN_SPEED * delta_t
+                );
+            playback_ptr->pan =
+                inch_towards(
+                    playback_ptr->pan,
+                    playback_ptr->target_pan,
+                    AUDIO::PLAYBACK_PAN_SPEED * delta_t
+                );
+                
+            //Pausing and unpausing.
+            if(playback_ptr->state == SOUND_PLAYBACK_STATE_PAUSING) {
+                playback_ptr->state_gain_mult -=
+                    AUDIO::PLAYBACK_PAUSE_GAIN_SPEED * delta_t;
+                if(playback_ptr->state_gain_mult <= 0.0f) {
+                    playback_ptr->state_gain_mult = 0.0f;
+                    playback_ptr->state = SOUND_PLAYBACK_STATE_PAUSED;
+                    if(!playback_ptr->is_virtual) {
+                        playback_ptr->pre_pause_pos = get_playback_pos(p);
+                        set_playback_playing(p, false);
+                    }
+                }
+            } else if(playback_ptr->state == SOUND_PLAYBACK_STATE_UNPAUSING) {
+                playback_ptr->state_gain_mult +=
+                    AUDIO::PLAYBACK_PAUSE_GAIN_SPEED * delta_t;
+                if(playback_ptr->state_gain_mult >= 1.0f) {
+                    playback_ptr->state_gain_mult = 1.0f;
+                    playback_ptr->state = SOUND_PLAYBACK_STATE_PLAYING;
+                }
+            }
+            
+            //Stopping.
+            if(playback_ptr->state == SOUND_PLAYBACK_STATE_STOPPING) {
+                playback_ptr->state_gain_mult -=
+                    AUDIO::PLAYBACK_STOP_GAIN_SPEED * delta_t;
+                if(playback_ptr->state_gain_mult <= 0.0f) {
+                    destroy_sound_playback(p);
+                }
+            }
+            
+            //Update the final gain and pan values.
+            update_playback_gain_and_pan(p);
+        }
+    }
+    
+    //Decide which playbacks get mixed.
+    update_voices();
+    
+    //Delete destroyed playbacks.
+    bool deleted_playbacks = false;
+    for(size_t p = 0; p < playbacks.size();) {
+        if(playbacks[p].state == SOUND_PLAYBACK_STATE_DESTROYED) {
+            playbacks.erase(playbacks.begin() + p);
+            deleted_playbacks = true;
+        } else {
+            p++;
+        }
+    }
+    if(deleted_playbacks) {
+        index_sample_playbacks();
+    }
+    
+    //Delete destroyed sources.
+    for(size_t s = 0; s < source_slots.size(); s++) {
+        SourceSlot* slot_ptr = &source_slots[s];
+        if(!slot_ptr->in_use || !slot_ptr->source.destroyed) continue;
+        slot_ptr->in_use = false;
+        slot_ptr->source = SoundSource();
+        slot_ptr->generation++;
+        if((slot_ptr->generation << AUDIO::SOURCE_ID_INDEX_BITS) == 0) {
+            //Wrapped around. Generation 0 could make an ID of 0.
+            slot_ptr->generation = 1;
+        }
+        free_source_slots.push_back(s);
+    }
+}
+
+
+/**
+ * @brief Code for the sound effect thread. It ticks sound sources and
+ * playbacks at a steady rate until it's told to stop.
+ */
+void AudioManager::tick_effects_work() {
+    set_up_thread();
+    
+    EffectsTickerSyncData* sync = effects_ticker;
+    double prev_time = al_get_time();
+    while(!sync->stopping) {
+        std::this_thread::sleep_for(
+            std::chrono::duration<double>(AUDIO::EFFECTS_TICK_INTERVAL)
+        );
+        double cur_time = al_get_time();
+        float delta_t = (float) (cur_time - prev_time);
+        prev_time = cur_time;
+        
+        EffectsLock lock(this);
+        tick_effects(delta_t);
+    }
+}
+
+
 /**
  * @brief Instantly updates a playback's current gain and pan, using its member
  * variables. This also clamps the variables if needed.
@@ -1116,17 +1758,24 @@ void AudioManager::update_playback_gain_and_pan(size_t playback_idx) {
     float final_gain = playback_ptr->gain * playback_ptr->state_gain_mult;
     final_gain *= playback_ptr->base_gain;
     final_gain = std::clamp(final_gain, 0.0f, 1.0f);
-    al_set_sample_instance_gain(
-        playback_ptr->allegro_sample_instance,
-        final_gain
-    );
     
     playback_ptr->pan = std::clamp(playback_ptr->pan, -1.0f, 1.0f);
     
-    al_set_sample_instance_pan(
-        playback_ptr->allegro_sample_instance,
-        playback_ptr->pan
-    );
+    if(playback_ptr->allegro_stream) {
+        al_set_audio_stream_gain(playback_ptr->allegro_stream, final_gain);
+        al_set_audio_stream_pan(
+            playback_ptr->allegro_stream, playback_ptr->pan
+        );
+    } else {
+        al_set_sample_instance_gain(
+            playback_ptr->allegro_sample_instance,
+            final_gain
+        );
+        al_set_sample_instance_pan(
+            playback_ptr->allegro_sample_instance,
+            playback_ptr->pan
+        );
+    }
 }
 
 
@@ -1184,6 +1833,97 @@ void AudioManager::update_playback_target_gain_and_pan(size_t playback_idx) {
 }
 
 
+/**
+ * @brief Hands the song tracks that the worker thread finished opening
+ * to their songs.
+ *
+ * @param wait_for_all If true, this waits for the worker to open everything
+ * it was asked to first, regardless of how long it takes.
+ */
+void AudioManager::update_song_tracks(bool wait_for_all) {
+    if(!track_loader) return;
+    
+    std::deque<TrackLoaderSyncData::Job> results;
+    {
+        std::unique_lock<std::mutex> lock(track_loader->mutex);
+        if(wait_for_all) {
+            TrackLoaderSyncData* sync = track_loader;
+            sync->done_cond.wait(
+                lock, [sync] () { return sync->jobs.empty() && !sync->busy; }
+            );
+        }
+        results.swap(track_loader->results);
+    }
+    
+    for(size_t r = 0; r < results.size(); r++) {
+        deliver_song_track(
+            results[r].song_name, results[r].track_type,
+            results[r].track_name, results[r].stream
+        );
+    }
+}
+
+
+/**
+ * @brief Decides which playbacks get mixed and which become virtual.
+ * Playbacks that can't be heard are always virtual. Otherwise, each mixer
+ * only mixes its most important playbacks, up to a limit. Importance comes
+ * from the priority first, and how loud the playback is second.
+ */
+void AudioManager::update_voices() {
+    //Gameplay, ambiance, and UI mixers.
+    vector<std::pair<float, size_t>> candidates[3];
+    
+    for(size_t p = 0; p < playbacks.size(); p++) {
+        SoundPlayback* playback_ptr = &playbacks[p];
+        if(playback_ptr->state == SOUND_PLAYBACK_STATE_DESTROYED) continue;
+        if(playback_ptr->state == SOUND_PLAYBACK_STATE_PAUSED) continue;
+        
+        float audibility =
+            std::max(playback_ptr->gain, playback_ptr->target_gain) *
+            playback_ptr->base_gain;
+        if(audibility < AUDIO::PLAYBACK_AUDIBLE_MIN_GAIN) {
+            set_playback_virtual(p, true);
+            continue;
+        }
+        
+        size_t mixer_idx = 0;
+        switch(playback_ptr->type) {
+        case SOUND_TYPE_GAMEPLAY_GLOBAL:
+        case SOUND_TYPE_GAMEPLAY_POS: {
+            mixer_idx = 0;
+            break;
+        } case SOUND_TYPE_AMBIANCE_GLOBAL:
+        case SOUND_TYPE_AMBIANCE_POS: {
+            mixer_idx = 1;
+            break;
+        } case SOUND_TYPE_UI: {
+            mixer_idx = 2;
+            break;
+        }
+        }
+        
+        candidates[mixer_idx].push_back(
+            std::make_pair(playback_ptr->priority + audibility, p)
+        );
+    }
+    
+    for(size_t m = 0; m < 3; m++) {
+        vector<std::pair<float, size_t>> &list = candidates[m];
+        size_t n_real = std::min(list.size(), AUDIO::MAX_VOICES_PER_MIXER);
+        if(n_real < list.size()) {
+            std::nth_element(
+                list.begin(), list.begin() + n_real, list.end(),
+                std::greater<std::pair<float, size_t>>()
+            );
+        }
+        for(size_t c = 0; c < list.size(); c++) {
+            set_playback_virtual(list[c].second, c >= n_real);
+        }
+    }
+}
+
+
 /**
  * @brief Updates the volumes of all mixers.
  *
@@ -1226,17 +1966,11 @@ void Song::load_from_data_node(DataNode* node) {
     //Standard data.
     ReaderSetter rs(node);
     
-    string main_track_str;
-    DataNode* main_track_node = nullptr;
-    
-    rs.set("main_track", main_track_str, &main_track_node);
+    rs.set("main_track", main_track_name);
     rs.set("loop_start", loop_start);
     rs.set("loop_end", loop_end);
     rs.set("name", name);
     
-    main_track =
-        game.content.song_tracks.list.get(main_track_str, main_track_node);
-        
     DataNode* mix_tracks_node = node->getChildByName("mix_tracks");
     size_t n_mix_tracks = mix_tracks_node->getNrOfChildren();
     
@@ -1255,15 +1989,7 @@ void Song::load_from_data_node(DataNode* node) {
             continue;
         }
         
-        mix_tracks[trigger] =
-            game.content.song_tracks.list.get(mix_track_node->value, mix_track_node);
-    }
-    
-    if(loop_end == 0.0f) {
-        loop_end = al_get_audio_stream_length_secs(main_track);
-    }
-    if(loop_end < loop_start) {
-        loop_start = 0.0f;
+        mix_track_names[trigger] = mix_track_node->value;
     }
 }
 
@@ -1272,8 +1998,12 @@ void Song::load_from_data_node(DataNode* node) {
  * @brief Unloads the song.
  */
 void Song::unload() {
-    game.content.song_tracks.list.free(main_track);
+    if(main_track) {
+        game.content.song_tracks.list.free(main_track);
+        main_track = nullptr;
+    }
     for(auto &t : mix_tracks) {
-        game.content.song_tracks.list.free(t.second);
+        if(t.second) game.content.song_tracks.list.free(t.second);
     }
+    mix_tracks.clear();
 }
@@ -30,7 +30,9 @@
 #pragma once
 
 #include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_audio.h>
@@ -43,7 +45,9 @@
 
 
 using std::map;
+using std::set;
 using std::string;
+using std::unordered_map;
 
 
 class AudioManager;
@@ -52,7 +56,10 @@ class Mob;
 
 namespace AUDIO {
 extern const float DEF_STACK_MIN_POS;
+extern const float EFFECTS_TICK_INTERVAL;
+extern const size_t MAX_VOICES_PER_MIXER;
 extern const float MIX_TRACK_GAIN_SPEED;
+extern const float PLAYBACK_AUDIBLE_MIN_GAIN;
 extern const float PLAYBACK_GAIN_SPEED;
 extern const float PLAYBACK_PAN_SPEED;
 extern const float PLAYBACK_PAUSE_GAIN_SPEED;
@@ -60,6 +67,7 @@ extern const float PLAYBACK_RANGE_CLOSE;
 extern const float PLAYBACK_RANGE_FAR_GAIN;
 extern const float PLAYBACK_RANGE_FAR_PAN;
 extern const float PLAYBACK_STOP_GAIN_SPEED;
+extern const size_t SOURCE_ID_INDEX_BITS;
 extern const float SONG_GAIN_SPEED;
 extern const float SONG_SOFTENED_GAIN;
 }
@@ -216,6 +224,10 @@ struct SoundSourceConfig {
     //Interval between emissions of the sound. 0 means it plays once.
     float interval = 0.0f;
     
+    //Priority. If there are too many playbacks at once, the ones with
+    //lower priority stop being mixed first.
+    int priority = 0;
+    
 };
 
 
@@ -241,6 +253,9 @@ struct SoundSource {
     //Position in the game world, if applicable.
     Point pos;
     
+    //Mob it's tied to, if any. Its position follows the mob's.
+    Mob* mob = nullptr;
+    
     //Time left until the next emission.
     float emit_time_left = 0.0f;
     
@@ -261,9 +276,25 @@ struct SoundPlayback {
     //The source of the sound effect.
     size_t source_id = 0;
     
+    //Allegro sound sample that it plays.
+    ALLEGRO_SAMPLE* sample = nullptr;
+    
+    //Type of sound effect.
+    SOUND_TYPE type = SOUND_TYPE_GAMEPLAY_GLOBAL;
+    
+    //Priority. Copied from the source's configuration.
+    int priority = 0;
+    
+    //Speed at which it plays.
+    float speed = 1.0f;
+    
     //Its Allegro sample instance.
     ALLEGRO_SAMPLE_INSTANCE* allegro_sample_instance = nullptr;
     
+    //Its Allegro audio stream, used instead of a sample instance if the
+    //sample is kept compressed in memory.
+    ALLEGRO_AUDIO_STREAM* allegro_stream = nullptr;
+    
     //State.
     SOUND_PLAYBACK_STATE state = SOUND_PLAYBACK_STATE_PLAYING;
     
@@ -288,6 +319,14 @@ struct SoundPlayback {
     //Position before pausing.
     unsigned int pre_pause_pos = 0;
     
+    //Is it virtual? A virtual playback isn't being mixed, either because
+    //it can't be heard or because there are too many playbacks, but its
+    //position keeps being tracked, so it can resume if need be.
+    bool is_virtual = false;
+    
+    //Position, in sample frames, if it's virtual.
+    float virtual_pos = 0.0f;
+    
 };
 
 
@@ -304,10 +343,19 @@ struct Song : public Content {
 
     //--- Members ---
     
-    //The main track. Other tracks can be mixed on top of this if applicable.
+    //Internal name of the main track.
+    string main_track_name;
+    
+    //Internal names of the other tracks to mix in with the main track.
+    map<MIX_TRACK_TYPE, string> mix_track_names;
+    
+    //The main track, if it's open. Other tracks can be mixed on top of
+    //this if applicable. It only gets opened when the song is prepared
+    //or played.
     ALLEGRO_AUDIO_STREAM* main_track = nullptr;
     
-    //Other tracks to mix in with the main track.
+    //Other tracks to mix in with the main track, the ones that are open.
+    //Each one only gets opened the first time its mix track type is needed.
     map<MIX_TRACK_TYPE, ALLEGRO_AUDIO_STREAM*> mix_tracks;
     
     //Current gain.
@@ -368,6 +416,7 @@ public:
     bool destroy_sound_source(size_t source_id);
     void destroy();
     bool emit(size_t source_id);
+    size_t get_nr_playbacks() const;
     void handle_mob_deletion(const Mob* m_ptr);
     void handle_stream_finished(ALLEGRO_AUDIO_STREAM* stream);
     void handle_world_pause();
@@ -377,6 +426,7 @@ public:
         float ambiance_sound_volume, float ui_sound_volume
     );
     void mark_mix_track_status(MIX_TRACK_TYPE track_type);
+    void prepare_song(const string &name);
     bool rewind_song(const string &name);
     bool schedule_emission(size_t source_id, bool first);
     void set_camera_pos(const Point &cam_tl, const Point &cam_br);
@@ -395,6 +445,54 @@ public:
     
 private:
 
+    //--- Misc. declarations ---
+    
+    struct EffectsTickerSyncData;
+    struct TrackLoaderSyncData;
+    
+    
+    /**
+     * @brief Holds the lock on the sound effect state for as long as
+     * it exists. Without a sound effect thread, it does nothing.
+     */
+    struct EffectsLock {
+    
+        //--- Members ---
+        
+        //Sound effect thread whose lock is being held, if any.
+        EffectsTickerSyncData* sync = nullptr;
+        
+        
+        //--- Function declarations ---
+        
+        explicit EffectsLock(const AudioManager* manager);
+        ~EffectsLock();
+        
+    };
+    
+    
+    /**
+     * @brief A slot in the list of sound sources. Slots get reused
+     * once their source is deleted, so a source's ID is made up of its
+     * slot's index and the slot's generation at the time. This way,
+     * IDs of deleted sources won't match whatever source reuses the slot.
+     */
+    struct SourceSlot {
+    
+        //--- Members ---
+        
+        //The sound source.
+        SoundSource source;
+        
+        //Generation. Increases every time the slot is freed.
+        size_t generation = 1;
+        
+        //Is the slot in use?
+        bool in_use = false;
+        
+    };
+    
+    
     //--- Members ---
     
     //Master mixer.
@@ -415,18 +513,18 @@ private:
     //Allegro voice from which the sound effects play.
     ALLEGRO_VOICE* voice = nullptr;
     
-    //Incremental ID, used for the next source to create.
-    size_t next_sound_source_id = 1;
-    
-    //Mob-specific sound effect sources.
-    map<size_t, Mob*> mob_sources;
+    //All sound effect source slots, used or otherwise.
+    vector<SourceSlot> source_slots;
     
-    //All sound effect sources.
-    map<size_t, SoundSource> sources;
+    //Indexes of source slots that are free to be reused.
+    vector<size_t> free_source_slots;
     
     //All sound effects being played right now.
     vector<SoundPlayback> playbacks;
     
+    //For each sample, the indexes of the playbacks playing it.
+    unordered_map<const ALLEGRO_SAMPLE*, vector<size_t>> sample_playbacks;
+    
     //Status for things that affect mix tracks this frame.
     vector<bool> mix_statuses;
     
@@ -439,6 +537,25 @@ private:
     //Bottom-right camera coordinates.
     Point cam_br;
     
+    //Thread that ticks sound sources and playbacks at a steady rate, so that
+    //they keep going even when a frame takes long, and everything needed
+    //to coordinate with it. Sound sources, playbacks, and the camera are
+    //shared with it, so they must only be touched while holding an
+    //EffectsLock.
+    EffectsTickerSyncData* effects_ticker = nullptr;
+    
+    //Worker thread that opens song tracks in the background, and everything
+    //needed to coordinate with it.
+    TrackLoaderSyncData* track_loader = nullptr;
+    
+    //Song tracks the worker thread was asked to open, and hasn't handed
+    //over yet. The track type is N_MIX_TRACK_TYPES for main tracks.
+    set<std::pair<string, MIX_TRACK_TYPE>> pending_song_tracks;
+    
+    //Random number generator for audio. This is separate from the game's,
+    //so that gameplay plays out the same whether audio works or not.
+    RngManager rng;
+    
     
     //--- Function declarations ---
     
@@ -448,14 +565,36 @@ private:
         const SoundSourceConfig &config,
         const Point &pos
     );
+    void deliver_song_track(
+        const string &song_name, MIX_TRACK_TYPE track_type,
+        const string &track_name, ALLEGRO_AUDIO_STREAM* stream
+    );
     bool destroy_sound_playback(size_t playback_idx);
+    float get_playback_length(size_t playback_idx);
+    unsigned int get_playback_pos(size_t playback_idx);
     SoundSource* get_source(size_t source_id);
+    void index_sample_playbacks();
+    bool is_playback_looping(size_t playback_idx);
+    bool is_playback_playing(size_t playback_idx);
+    void load_song_tracks_work();
+    void open_song_main_track(Song* song_ptr);
+    void request_song_track(
+        const string &song_name, MIX_TRACK_TYPE track_type,
+        const string &track_name
+    );
+    void set_playback_playing(size_t playback_idx, bool playing);
+    void set_playback_pos(size_t playback_idx, unsigned int pos);
+    void set_playback_virtual(size_t playback_idx, bool is_virtual);
     void start_song_track(
         Song* song_ptr, ALLEGRO_AUDIO_STREAM* stream,
         bool from_start, bool fade_in, bool loop
     );
     bool stop_sound_playback(size_t playback_idx);
+    void tick_effects(float delta_t);
+    void tick_effects_work();
     void update_playback_gain_and_pan(size_t playback_idx);
     void update_playback_target_gain_and_pan(size_t playback_idx);
+    void update_song_tracks(bool wait);
+    void update_voices();
     
 };
@@ -0,0 +1,1075 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Headless gameplay logic benchmark, and player input recording functions.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "benchmark.h"
+
+#include "../content/area/geometry.h"
+#include "../content/mob/mob_utils.h"
+#include "../content/other/particle.h"
+#include "../lib/data_file/data_file.h"
+#include "../util/string_utils.h"
+#include "const.h"
+#include "game.h"
+#include "misc_functions.h"
+#include "pathing.h"
+
+
+namespace BENCHMARK {
+
+//Default delta_t to run each benchmark tick with.
+const float DEF_DELTA_T = 1.0f / 60.0f;
+
+//Default number of gameplay logic ticks to run in a benchmark.
+const size_t DEF_NR_TICKS = 3600;
+
+//Width and height of the region where the geometry benchmark places things.
+const float GEOMETRY_AREA_SIZE = 512.0f;
+
+//Number of circles, and of line segments, that the geometry benchmark
+//checks against its list of line segments.
+const size_t GEOMETRY_NR_QUERIES = 100000;
+
+//Number of line segments in the geometry benchmark's list. This is
+//around how many edges a few blockmap blocks have.
+const size_t GEOMETRY_NR_SEGS = 64;
+
+//Number of particles the kernel benchmark ticks.
+const size_t KERNELS_NR_PARTICLES = 5000;
+
+//Number of paths the kernel benchmark calculates.
+const size_t KERNELS_NR_PATHS = 1000;
+
+//Number of sector, edge, and collision queries the kernel benchmark does.
+const size_t KERNELS_NR_QUERIES = 100000;
+
+//How many times the kernel benchmark repeats its heavier kernels, like
+//triangulating all sectors, or loading the geometry file.
+const size_t KERNELS_NR_REPEATS = 20;
+
+//Seed for the random number generator, so every run plays out the same.
+const int RNG_SEED = 1;
+
+//When the leader walks around in a square, this is how long each side takes.
+const float WALK_LEG_DURATION = 2.0f;
+
+}
+
+
+/**
+ * @brief Loads the scenario from a data node.
+ *
+ * @param node The node. Its name is the scenario's name.
+ */
+void BenchmarkScenario::load(DataNode* node) {
+    name = node->name;
+    
+    ReaderSetter rs(node);
+    rs.set("area", area_path);
+    rs.set("ticks", nr_ticks);
+    rs.set("walk", walk);
+    
+    DataNode* spawns_node = node->getChildByName("spawns");
+    size_t n_spawns = spawns_node->getNrOfChildren();
+    for(size_t s = 0; s < n_spawns; s++) {
+        ReaderSetter srs(spawns_node->getChild(s));
+        Spawn spawn;
+        DataNode* pos_node = nullptr;
+        srs.set("type", spawn.type_name);
+        srs.set("amount", spawn.amount);
+        srs.set("pos", spawn.pos, &pos_node);
+        srs.set("radius", spawn.radius);
+        spawn.pos_specified = pos_node != nullptr;
+        spawns.push_back(spawn);
+    }
+    
+    DataNode* kills_node = node->getChildByName("kills");
+    size_t n_kills = kills_node->getNrOfChildren();
+    for(size_t k = 0; k < n_kills; k++) {
+        ReaderSetter krs(kills_node->getChild(k));
+        Kill kill;
+        krs.set("type", kill.type_name);
+        krs.set("tick", kill.tick);
+        kills.push_back(kill);
+    }
+    
+    DataNode* gens_node = node->getChildByName("particle_generators");
+    size_t n_gens = gens_node->getNrOfChildren();
+    for(size_t g = 0; g < n_gens; g++) {
+        ReaderSetter grs(gens_node->getChild(g));
+        ParticleGens gens;
+        grs.set("name", gens.gen_name);
+        grs.set("amount", gens.amount);
+        grs.set("radius", gens.radius);
+        particle_gens.push_back(gens);
+    }
+}
+
+
+/**
+ * @brief Clears all recorded actions.
+ */
+void InputRecording::clear() {
+    actions.clear();
+    area_path.clear();
+    rng_seed = 0;
+    frames.clear();
+    replay_idx = 0;
+}
+
+
+/**
+ * @brief Returns a string representation of a float that can be read back
+ * into that exact same float, unlike f2s().
+ *
+ * @param f Float to convert.
+ * @return The string.
+ */
+string InputRecording::exact_f2s(float f) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%a", f);
+    return buffer;
+}
+
+
+/**
+ * @brief Reads a float written with exact_f2s(). Regular decimal numbers
+ * work too.
+ *
+ * @param s String to convert.
+ * @return The float.
+ */
+float InputRecording::exact_s2f(const string &s) {
+    return strtof(s.c_str(), nullptr);
+}
+
+
+/**
+ * @brief Returns the player actions recorded for the given gameplay logic
+ * frame. Frames must be requested in increasing order.
+ *
+ * @param frame_nr Number of the frame.
+ * @param out_actions The frame's actions are added here.
+ */
+void InputRecording::get_frame_actions(
+    size_t frame_nr, vector<PlayerAction> &out_actions
+) {
+    while(
+        replay_idx < actions.size() &&
+        actions[replay_idx].first < frame_nr
+    ) {
+        replay_idx++;
+    }
+    while(
+        replay_idx < actions.size() &&
+        actions[replay_idx].first == frame_nr
+    ) {
+        out_actions.push_back(actions[replay_idx].second);
+        replay_idx++;
+    }
+}
+
+
+/**
+ * @brief Loads a recording from a file.
+ *
+ * @param file_path Path to the file.
+ * @return Whether it succeeded.
+ */
+bool InputRecording::load(const string &file_path) {
+    clear();
+    
+    DataNode file(file_path);
+    if(!file.fileWasOpened) return false;
+    
+    area_path = file.getChildByName("area")->value;
+    
+    DataNode* actions_node = file.getChildByName("actions");
+    size_t n_actions = actions_node->getNrOfChildren();
+    for(size_t a = 0; a < n_actions; a++) {
+        DataNode* action_node = actions_node->getChild(a);
+        vector<string> parts = split(action_node->value);
+        if(parts.size() < 2) continue;
+        
+        PlayerAction action;
+        action.actionTypeId = s2i(parts[0]);
+        action.value = exact_s2f(parts[1]);
+        if(parts.size() >= 3) action.flags = s2i(parts[2]);
+        actions.push_back(
+            std::make_pair((size_t) s2i(action_node->name), action)
+        );
+    }
+    
+    rng_seed = s2i(file.getChildByName("rng_seed")->value);
+    
+    DataNode* frames_node = file.getChildByName("frames");
+    size_t n_frames = frames_node->getNrOfChildren();
+    frames.reserve(n_frames);
+    for(size_t f = 0; f < n_frames; f++) {
+        vector<string> parts = split(frames_node->getChild(f)->value);
+        if(parts.size() < 5) {
+            frames.clear();
+            break;
+        }
+        
+        InputRecordingFrame frame;
+        frame.delta_t = exact_s2f(parts[0]);
+        frame.cursor_s_pos.x = exact_s2f(parts[1]);
+        frame.cursor_s_pos.y = exact_s2f(parts[2]);
+        frame.cursor_w_pos.x = exact_s2f(parts[3]);
+        frame.cursor_w_pos.y = exact_s2f(parts[4]);
+        frames.push_back(frame);
+    }
+    
+    return true;
+}
+
+
+/**
+ * @brief Records a gameplay logic frame.
+ *
+ * @param frame_nr Number of the frame.
+ * @param delta_t The frame's delta_t, before any maker tool speed changes.
+ * @param cursor_s_pos Mouse cursor position at the start of the frame,
+ * in screen coordinates.
+ * @param cursor_w_pos Mouse cursor position at the start of the frame,
+ * in world coordinates.
+ * @param frame_actions Player actions that happened in that frame.
+ */
+void InputRecording::record(
+    size_t frame_nr, float delta_t, const Point &cursor_s_pos,
+    const Point &cursor_w_pos, const vector<PlayerAction> &frame_actions
+) {
+    if(frame_nr >= frames.size()) frames.resize(frame_nr + 1);
+    frames[frame_nr].delta_t = delta_t;
+    frames[frame_nr].cursor_s_pos = cursor_s_pos;
+    frames[frame_nr].cursor_w_pos = cursor_w_pos;
+    
+    for(size_t a = 0; a < frame_actions.size(); a++) {
+        actions.push_back(std::make_pair(frame_nr, frame_actions[a]));
+    }
+}
+
+
+/**
+ * @brief Saves the recording to a file.
+ *
+ * @param file_path Path to the file.
+ * @return Whether it succeeded.
+ */
+bool InputRecording::save(const string &file_path) const {
+    DataNode file("", "");
+    file.addNew("area", area_path);
+    
+    DataNode* actions_node = file.addNew("actions");
+    for(size_t a = 0; a < actions.size(); a++) {
+        const PlayerAction &action = actions[a].second;
+        actions_node->addNew(
+            i2s(actions[a].first),
+            i2s(action.actionTypeId) + " " +
+            exact_f2s(action.value) + " " +
+            i2s(action.flags)
+        );
+    }
+    
+    file.addNew("rng_seed", i2s(rng_seed));
+    
+    DataNode* frames_node = file.addNew("frames");
+    for(size_t f = 0; f < frames.size(); f++) {
+        const InputRecordingFrame &frame = frames[f];
+        frames_node->addNew(
+            i2s(f),
+            exact_f2s(frame.delta_t) + " " +
+            exact_f2s(frame.cursor_s_pos.x) + " " +
+            exact_f2s(frame.cursor_s_pos.y) + " " +
+            exact_f2s(frame.cursor_w_pos.x) + " " +
+            exact_f2s(frame.cursor_w_pos.y)
+        );
+    }
+    
+    return file.saveFile(file_path, true, true);
+}
+
+
+/**
+ * @brief Returns the player actions that make the leader walk around in a
+ * square, for the given gameplay logic frame. Each side of the square
+ * starts by releasing the previous direction and holding the next one.
+ *
+ * @param frame_nr Number of the frame.
+ * @param out_actions The frame's actions are added here.
+ */
+void LogicBenchmark::get_walk_actions(
+    size_t frame_nr, vector<PlayerAction> &out_actions
+) const {
+    const int directions[] = {
+        PLAYER_ACTION_TYPE_RIGHT, PLAYER_ACTION_TYPE_UP,
+        PLAYER_ACTION_TYPE_LEFT, PLAYER_ACTION_TYPE_DOWN
+    };
+    size_t frames_per_leg =
+        std::max((size_t) (BENCHMARK::WALK_LEG_DURATION / delta_t), (size_t) 1);
+    if(frame_nr % frames_per_leg != 0) return;
+    
+    size_t leg = frame_nr / frames_per_leg;
+    if(leg > 0) {
+        PlayerAction release;
+        release.actionTypeId = directions[(leg - 1) % 4];
+        release.value = 0.0f;
+        out_actions.push_back(release);
+    }
+    PlayerAction press;
+    press.actionTypeId = directions[leg % 4];
+    press.value = 1.0f;
+    out_actions.push_back(press);
+}
+
+
+/**
+ * @brief Reads the benchmark and input recording settings from the
+ * command line arguments. Arguments it doesn't know are just logged and
+ * skipped, since some systems and launchers pass arguments of their own.
+ *
+ * @param argc Command line argument count.
+ * @param argv Command line argument values.
+ */
+void LogicBenchmark::parse_args(int argc, char** argv) {
+    for(int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        bool has_value = a + 1 < argc;
+        
+        if(arg == "--benchmark" && has_value) {
+            enabled = true;
+            area_path = argv[++a];
+        } else if(arg == "--benchmark-geometry") {
+            enabled = true;
+            geometry = true;
+        } else if(arg == "--benchmark-kernels" && has_value) {
+            enabled = true;
+            kernels = true;
+            area_path = argv[++a];
+        } else if(arg == "--benchmark-scenarios") {
+            enabled = true;
+            scenarios_path = FILE_PATHS_FROM_ROOT::BENCHMARK_SCENARIOS;
+            if(has_value && argv[a + 1][0] != '-') {
+                scenarios_path = argv[++a];
+            }
+        } else if(arg == "--benchmark-ticks" && has_value) {
+            nr_ticks = std::max(s2i(argv[++a]), 1);
+            nr_ticks_specified = true;
+        } else if(arg == "--benchmark-delta-t" && has_value) {
+            delta_t = s2f(argv[++a]);
+        } else if(arg == "--benchmark-inputs" && has_value) {
+            enabled = true;
+            inputs_path = argv[++a];
+        } else if(arg == "--benchmark-output" && has_value) {
+            results_path = argv[++a];
+        } else if(arg == "--benchmark-walk") {
+            walk = true;
+        } else if(arg == "--record-inputs" && has_value) {
+            record_inputs_path = argv[++a];
+        } else {
+            fprintf(
+                stderr,
+                "Ignoring unknown or incomplete argument \"%s\".\n",
+                arg.c_str()
+            );
+        }
+    }
+    
+    if(delta_t <= 0.0f) delta_t = BENCHMARK::DEF_DELTA_T;
+    if(results_path.empty()) {
+        results_path = FILE_PATHS_FROM_ROOT::BENCHMARK_RESULTS;
+    }
+}
+
+
+/**
+ * @brief Runs the benchmark and saves its results. The game must have
+ * been started beforehand.
+ *
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int LogicBenchmark::run() {
+    if(geometry) return run_geometry();
+    if(kernels) return run_kernels();
+    if(!scenarios_path.empty()) return run_scenarios();
+    
+    InputRecording inputs;
+    if(!inputs_path.empty()) {
+        if(!inputs.load(inputs_path)) {
+            fprintf(
+                stderr, "Could not open the input recording \"%s\"!\n",
+                inputs_path.c_str()
+            );
+            return -1;
+        }
+        if(area_path.empty()) area_path = inputs.area_path;
+    }
+    if(area_path.empty()) {
+        fprintf(stderr, "No area was specified for the benchmark!\n");
+        return -1;
+    }
+    
+    if(!game.perf_mon) {
+        game.perf_mon = new PerformanceMonitor();
+    }
+    game.perf_mon->set_detailed(true);
+    
+    //If the recording has each frame's info, play it back exactly.
+    bool exact = !inputs.frames.empty();
+    if(exact && !nr_ticks_specified) {
+        nr_ticks = inputs.frames.size();
+    }
+    
+    game.rng.init(exact ? inputs.rng_seed : BENCHMARK::RNG_SEED);
+    game.states.gameplay->path_of_area_to_load = area_path;
+    game.change_state(game.states.gameplay);
+    
+    DataNode results("", "");
+    results.addNew("area", area_path);
+    results.addNew("inputs", inputs_path);
+    results.addNew("walk", b2s(walk && inputs_path.empty()));
+    results.addNew(
+        "delta_t", exact ? "recorded" : std::to_string(delta_t)
+    );
+    size_t nr_ticks_run = 0;
+    double total_time =
+        run_ticks(
+            nr_ticks, inputs, walk && inputs_path.empty(), nullptr,
+            &results, nr_ticks_run
+        );
+    if(game.cur_area_data) {
+        results.addNew("sectors", i2s(game.cur_area_data->sectors.size()));
+        results.addNew("edges", i2s(game.cur_area_data->edges.size()));
+        results.addNew("vertexes", i2s(game.cur_area_data->vertexes.size()));
+    }
+    game.perf_mon->write_results(results.addNew("performance"));
+    
+    if(!results.saveFile(results_path, true, true)) {
+        fprintf(
+            stderr, "Could not save the benchmark results to \"%s\"!\n",
+            results_path.c_str()
+        );
+        return -1;
+    }
+    
+    printf(
+        "Ran %lu ticks in %f seconds. Results saved to \"%s\".\n",
+        (unsigned long) nr_ticks_run, total_time, results_path.c_str()
+    );
+    return 0;
+}
+
+
+/**
+ * @brief Runs the geometry function benchmark and saves its results.
+ * This compares checking circles and line segments against a list of line
+ * segments one by one, against doing so with the batched checks first,
+ * like the blockmap does.
+ *
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int LogicBenchmark::run_geometry() {
+    game.rng.init(BENCHMARK::RNG_SEED);
+    const float size = BENCHMARK::GEOMETRY_AREA_SIZE;
+    
+    LineSegBatch segs;
+    vector<Point> seg_p1s;
+    vector<Point> seg_p2s;
+    for(size_t s = 0; s < BENCHMARK::GEOMETRY_NR_SEGS; s++) {
+        Point p1(game.rng.f(0.0f, size), game.rng.f(0.0f, size));
+        Point offset(
+            game.rng.f(-size / 4.0f, size / 4.0f),
+            game.rng.f(-size / 4.0f, size / 4.0f)
+        );
+        Point p2 = p1 + offset;
+        segs.add(p1, p2);
+        seg_p1s.push_back(p1);
+        seg_p2s.push_back(p2);
+    }
+    
+    vector<Point> query_p1s;
+    vector<Point> query_p2s;
+    vector<float> query_radii;
+    for(size_t q = 0; q < BENCHMARK::GEOMETRY_NR_QUERIES; q++) {
+        Point p1(game.rng.f(0.0f, size), game.rng.f(0.0f, size));
+        query_p1s.push_back(p1);
+        query_p2s.push_back(
+            p1 + Point(game.rng.f(-64.0f, 64.0f), game.rng.f(-64.0f, 64.0f))
+        );
+        query_radii.push_back(game.rng.f(8.0f, 64.0f));
+    }
+    
+    vector<size_t> idxs;
+    size_t circle_scalar_hits = 0;
+    size_t circle_batch_hits = 0;
+    size_t seg_scalar_hits = 0;
+    size_t seg_batch_hits = 0;
+    
+    //Circles, one by one.
+    double start_time = al_get_time();
+    for(size_t q = 0; q < query_p1s.size(); q++) {
+        for(size_t s = 0; s < seg_p1s.size(); s++) {
+            if(
+                circle_intersects_line_seg(
+                    query_p1s[q], query_radii[q], seg_p1s[s], seg_p2s[s]
+                )
+            ) {
+                circle_scalar_hits++;
+            }
+        }
+    }
+    double circle_scalar_time = al_get_time() - start_time;
+    
+    //Circles, batched.
+    start_time = al_get_time();
+    for(size_t q = 0; q < query_p1s.size(); q++) {
+        get_line_segs_near_circle(segs, query_p1s[q], query_radii[q], idxs);
+        for(size_t i = 0; i < idxs.size(); i++) {
+            if(
+                circle_intersects_line_seg(
+                    query_p1s[q], query_radii[q],
+                    seg_p1s[idxs[i]], seg_p2s[idxs[i]]
+                )
+            ) {
+                circle_batch_hits++;
+            }
+        }
+    }
+    double circle_batch_time = al_get_time() - start_time;
+    
+    //Line segments, one by one.
+    start_time = al_get_time();
+    for(size_t q = 0; q < query_p1s.size(); q++) {
+        for(size_t s = 0; s < seg_p1s.size(); s++) {
+            if(
+                line_segs_intersect(
+                    query_p1s[q], query_p2s[q], seg_p1s[s], seg_p2s[s],
+                    (Point*) nullptr
+                )
+            ) {
+                seg_scalar_hits++;
+            }
+        }
+    }
+    double seg_scalar_time = al_get_time() - start_time;
+    
+    //Line segments, batched.
+    start_time = al_get_time();
+    for(size_t q = 0; q < query_p1s.size(); q++) {
+        get_line_segs_near_line_seg(segs, query_p1s[q], query_p2s[q], idxs);
+        for(size_t i = 0; i < idxs.size(); i++) {
+            if(
+                line_segs_intersect(
+                    query_p1s[q], query_p2s[q],
+                    seg_p1s[idxs[i]], seg_p2s[idxs[i]],
+                    (Point*) nullptr
+                )
+            ) {
+                seg_batch_hits++;
+            }
+        }
+    }
+    double seg_batch_time = al_get_time() - start_time;
+    
+    bool results_match =
+        circle_scalar_hits == circle_batch_hits &&
+        seg_scalar_hits == seg_batch_hits;
+        
+    DataNode results("", "");
+    results.addNew("segments", i2s(BENCHMARK::GEOMETRY_NR_SEGS));
+    results.addNew("queries", i2s(BENCHMARK::GEOMETRY_NR_QUERIES));
+    results.addNew("circle_scalar_time", std::to_string(circle_scalar_time));
+    results.addNew("circle_batch_time", std::to_string(circle_batch_time));
+    results.addNew("line_seg_scalar_time", std::to_string(seg_scalar_time));
+    results.addNew("line_seg_batch_time", std::to_string(seg_batch_time));
+    results.addNew("results_match", b2s(results_match));
+    
+    if(!results.saveFile(results_path, true, true)) {
+        fprintf(
+            stderr, "Could not save the benchmark results to \"%s\"!\n",
+            results_path.c_str()
+        );
+        return -1;
+    }
+    
+    printf(
+        "Circles: %f seconds one by one, %f batched.\n"
+        "Line segments: %f seconds one by one, %f batched.\n"
+        "Results saved to \"%s\".\n",
+        circle_scalar_time, circle_batch_time,
+        seg_scalar_time, seg_batch_time, results_path.c_str()
+    );
+    if(!results_match) {
+        fprintf(stderr, "The batched checks gave different results!\n");
+        return -1;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Runs the kernel benchmark and saves its results. This loads an
+ * area and times the engine's main geometry, pathing, grouping, data file,
+ * and particle functions on their own, using the area's data where they
+ * need some. Each kernel's results can be compared between builds.
+ *
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int LogicBenchmark::run_kernels() {
+    game.rng.init(BENCHMARK::RNG_SEED);
+    game.states.gameplay->path_of_area_to_load = area_path;
+    game.change_state(game.states.gameplay);
+    if(!game.states.gameplay->loaded || !game.cur_area_data) {
+        fprintf(stderr, "Could not load the area \"%s\"!\n", area_path.c_str());
+        return -1;
+    }
+    Area* area_ptr = game.cur_area_data;
+    Blockmap &bmap = area_ptr->bmap;
+    Point area_tl = bmap.top_left_corner;
+    Point area_br =
+        area_tl +
+        Point(
+            bmap.n_cols * GEOMETRY::BLOCKMAP_BLOCK_SIZE,
+            bmap.n_rows * GEOMETRY::BLOCKMAP_BLOCK_SIZE
+        );
+    auto get_random_point = [&area_tl, &area_br] () {
+        return
+            Point(
+                game.rng.f(area_tl.x, area_br.x),
+                game.rng.f(area_tl.y, area_br.y)
+            );
+    };
+    
+    DataNode results("", "");
+    results.addNew("area", area_path);
+    DataNode* kernels_node = results.addNew("kernels");
+    auto add_result =
+    [kernels_node] (const string &name, size_t iterations, double time) {
+        DataNode* kernel_node = kernels_node->addNew(name);
+        kernel_node->addNew("iterations", i2s(iterations));
+        kernel_node->addNew("total_time", std::to_string(time));
+        kernel_node->addNew(
+            "average_time",
+            std::to_string(iterations > 0 ? time / iterations : 0.0)
+        );
+        printf(
+            "%s: %lu iterations in %f seconds.\n",
+            name.c_str(), (unsigned long) iterations, time
+        );
+    };
+    
+    //Sectors under points.
+    vector<Point> points;
+    for(size_t q = 0; q < BENCHMARK::KERNELS_NR_QUERIES; q++) {
+        points.push_back(get_random_point());
+    }
+    size_t nr_hits = 0;
+    double start_time = al_get_time();
+    for(size_t q = 0; q < points.size(); q++) {
+        if(get_sector(points[q], nullptr, true)) nr_hits++;
+    }
+    add_result("get_sector", points.size(), al_get_time() - start_time);
+    
+    //Edges in regions.
+    vector<Edge*> edges;
+    start_time = al_get_time();
+    for(size_t q = 0; q < points.size(); q++) {
+        bmap.get_edges_in_region(
+            points[q] - GEOMETRY::BLOCKMAP_BLOCK_SIZE / 2.0f,
+            points[q] + GEOMETRY::BLOCKMAP_BLOCK_SIZE / 2.0f,
+            edges
+        );
+        nr_hits += edges.size();
+    }
+    add_result(
+        "get_edges_in_region", points.size(), al_get_time() - start_time
+    );
+    
+    //Edges in regions, at the height of the floor under each point.
+    vector<float> point_zs;
+    for(size_t q = 0; q < points.size(); q++) {
+        Sector* s_ptr = get_sector(points[q], nullptr, true);
+        point_zs.push_back(s_ptr ? s_ptr->z : 0.0f);
+    }
+    start_time = al_get_time();
+    for(size_t q = 0; q < points.size(); q++) {
+        bmap.get_edges_in_region(
+            points[q] - GEOMETRY::BLOCKMAP_BLOCK_SIZE / 2.0f,
+            points[q] + GEOMETRY::BLOCKMAP_BLOCK_SIZE / 2.0f,
+            point_zs[q], point_zs[q] + GEOMETRY::STEP_HEIGHT,
+            edges
+        );
+        nr_hits += edges.size();
+    }
+    add_result(
+        "get_edges_in_region_z", points.size(), al_get_time() - start_time
+    );
+    
+    //Circles against the edges near them.
+    size_t nr_circle_checks = 0;
+    start_time = al_get_time();
+    for(size_t q = 0; q < points.size(); q++) {
+        bmap.get_edges_in_region(
+            points[q] - 32.0f, points[q] + 32.0f, edges
+        );
+        for(size_t e = 0; e < edges.size(); e++) {
+            if(
+                circle_intersects_line_seg(
+                    points[q], 32.0f,
+                    v2p(edges[e]->vertexes[0]), v2p(edges[e]->vertexes[1])
+                )
+            ) {
+                nr_hits++;
+            }
+            nr_circle_checks++;
+        }
+    }
+    add_result(
+        "circle_intersects_line_seg", nr_circle_checks,
+        al_get_time() - start_time
+    );
+    
+    //Paths between random spots.
+    size_t nr_paths = 0;
+    if(!area_ptr->path_stops.empty()) {
+        PathFollowSettings settings;
+        vector<PathStop*> path;
+        start_time = al_get_time();
+        for(size_t p = 0; p < BENCHMARK::KERNELS_NR_PATHS; p++) {
+            get_path(
+                points[p * 2], points[p * 2 + 1], settings,
+                path, nullptr, nullptr, nullptr
+            );
+            nr_hits += path.size();
+            nr_paths++;
+        }
+        add_result("get_path", nr_paths, al_get_time() - start_time);
+    }
+    
+    //Group spots.
+    Leader* leader_ptr = game.states.gameplay->cur_leader_ptr;
+    if(leader_ptr && !leader_ptr->group->members.empty()) {
+        start_time = al_get_time();
+        for(size_t r = 0; r < BENCHMARK::KERNELS_NR_REPEATS; r++) {
+            leader_ptr->group->reassign_spots();
+        }
+        add_result(
+            "group_reassign_spots", BENCHMARK::KERNELS_NR_REPEATS,
+            al_get_time() - start_time
+        );
+    }
+    
+    //Loading the geometry file.
+    string geometry_path =
+        area_ptr->manifest->path + "/" + FILE_NAMES::AREA_GEOMETRY;
+    start_time = al_get_time();
+    for(size_t r = 0; r < BENCHMARK::KERNELS_NR_REPEATS; r++) {
+        DataNode geometry_file;
+        geometry_file.loadFile(geometry_path);
+        nr_hits += geometry_file.getNrOfChildren();
+    }
+    add_result(
+        "data_node_load_file", BENCHMARK::KERNELS_NR_REPEATS,
+        al_get_time() - start_time
+    );
+    
+    //Ticking particles.
+    ParticleManager particles(BENCHMARK::KERNELS_NR_PARTICLES);
+    for(size_t p = 0; p < BENCHMARK::KERNELS_NR_PARTICLES; p++) {
+        Particle par(get_random_point(), 0.0f, 8.0f, LARGE_FLOAT);
+        par.friction = 0.5f;
+        particles.add(par);
+    }
+    start_time = al_get_time();
+    for(size_t r = 0; r < BENCHMARK::KERNELS_NR_REPEATS; r++) {
+        particles.tick_all(BENCHMARK::DEF_DELTA_T);
+    }
+    add_result(
+        "particle_tick_all", BENCHMARK::KERNELS_NR_REPEATS,
+        al_get_time() - start_time
+    );
+    
+    //Triangulating every sector. This is done last, since it replaces the
+    //sectors' triangles, which the blockmap points to.
+    set<Edge*> lone_edges;
+    start_time = al_get_time();
+    for(size_t r = 0; r < BENCHMARK::KERNELS_NR_REPEATS; r++) {
+        for(size_t s = 0; s < area_ptr->sectors.size(); s++) {
+            triangulate_sector(area_ptr->sectors[s], &lone_edges, false);
+        }
+    }
+    add_result(
+        "triangulate_sector",
+        BENCHMARK::KERNELS_NR_REPEATS * area_ptr->sectors.size(),
+        al_get_time() - start_time
+    );
+    
+    //So the compiler can't skip the work.
+    results.addNew("checksum", i2s(nr_hits));
+    
+    if(!results.saveFile(results_path, true, true)) {
+        fprintf(
+            stderr, "Could not save the benchmark results to \"%s\"!\n",
+            results_path.c_str()
+        );
+        return -1;
+    }
+    
+    printf("Results saved to \"%s\".\n", results_path.c_str());
+    return 0;
+}
+
+
+/**
+ * @brief Runs each of the stress scenarios in the scenarios file, one after
+ * the other, and saves a timing summary of each. The game must have been
+ * started beforehand.
+ *
+ * @return 0 if everything went well, or an error number otherwise.
+ */
+int LogicBenchmark::run_scenarios() {
+    DataNode file(scenarios_path);
+    if(!file.fileWasOpened) {
+        fprintf(
+            stderr, "Could not open the scenarios file \"%s\"!\n",
+            scenarios_path.c_str()
+        );
+        return -1;
+    }
+    
+    if(!game.perf_mon) {
+        game.perf_mon = new PerformanceMonitor();
+    }
+    game.perf_mon->set_detailed(true);
+    
+    DataNode results("", "");
+    results.addNew("scenarios_file", scenarios_path);
+    results.addNew("delta_t", std::to_string(delta_t));
+    DataNode* scenarios_node = results.addNew("scenarios");
+    InputRecording no_inputs;
+    
+    size_t n_scenarios = file.getNrOfChildren();
+    for(size_t s = 0; s < n_scenarios; s++) {
+        BenchmarkScenario scenario;
+        scenario.load(file.getChild(s));
+        DataNode* scenario_node = scenarios_node->addNew(scenario.name);
+        scenario_node->addNew("area", scenario.area_path);
+        scenario_node->addNew("walk", b2s(scenario.walk || walk));
+        
+        game.rng.init(BENCHMARK::RNG_SEED);
+        game.states.gameplay->path_of_area_to_load = scenario.area_path;
+        game.change_state(game.states.gameplay);
+        if(!game.states.gameplay->loaded || !game.cur_area_data) {
+            fprintf(
+                stderr,
+                "Could not load the area \"%s\" of the scenario \"%s\"!\n",
+                scenario.area_path.c_str(), scenario.name.c_str()
+            );
+            scenario_node->addNew("error", "Could not load the area.");
+            continue;
+        }
+        
+        Leader* leader_ptr = game.states.gameplay->cur_leader_ptr;
+        Point leader_pos = leader_ptr ? leader_ptr->pos : Point();
+        auto get_scattered_point =
+        [] (const Point &center, float radius) {
+            return
+                center +
+                angle_to_coordinates(
+                    game.rng.f(0.0f, TAU), game.rng.f(0.0f, radius)
+                );
+        };
+        
+        //Create the extra objects.
+        size_t nr_spawned = 0;
+        for(size_t sp = 0; sp < scenario.spawns.size(); sp++) {
+            const BenchmarkScenario::Spawn &spawn = scenario.spawns[sp];
+            MobType* type =
+                game.mob_categories.find_mob_type(spawn.type_name);
+            if(!type) {
+                fprintf(
+                    stderr,
+                    "Unknown object type \"%s\" in the scenario \"%s\"!\n",
+                    spawn.type_name.c_str(), scenario.name.c_str()
+                );
+                continue;
+            }
+            Point center = spawn.pos_specified ? spawn.pos : leader_pos;
+            for(size_t m = 0; m < spawn.amount; m++) {
+                create_mob(
+                    type->category,
+                    get_scattered_point(center, spawn.radius), type,
+                    game.rng.f(0.0f, TAU), ""
+                );
+                nr_spawned++;
+            }
+        }
+        scenario_node->addNew("spawned_mobs", i2s(nr_spawned));
+        
+        //Find what to kill.
+        vector<std::pair<size_t, MobType*> > kills;
+        for(size_t k = 0; k < scenario.kills.size(); k++) {
+            const BenchmarkScenario::Kill &kill = scenario.kills[k];
+            MobType* type =
+                game.mob_categories.find_mob_type(kill.type_name);
+            if(!type) {
+                fprintf(
+                    stderr,
+                    "Unknown object type \"%s\" in the scenario \"%s\"!\n",
+                    kill.type_name.c_str(), scenario.name.c_str()
+                );
+                continue;
+            }
+            kills.push_back(std::make_pair(kill.tick, type));
+        }
+        
+        //Set up the extra particle generators.
+        vector<ParticleGenerator> gens;
+        for(size_t g = 0; g < scenario.particle_gens.size(); g++) {
+            const BenchmarkScenario::ParticleGens &scen_gens =
+                scenario.particle_gens[g];
+            auto gen_it =
+                game.content.particle_gen.list.find(scen_gens.gen_name);
+            if(gen_it == game.content.particle_gen.list.end()) {
+                fprintf(
+                    stderr,
+                    "Unknown particle generator \"%s\" in the scenario "
+                    "\"%s\"!\n",
+                    scen_gens.gen_name.c_str(), scenario.name.c_str()
+                );
+                continue;
+            }
+            for(size_t c = 0; c < scen_gens.amount; c++) {
+                ParticleGenerator gen = gen_it->second;
+                gen.base_particle.pos =
+                    get_scattered_point(leader_pos, scen_gens.radius);
+                gens.push_back(gen);
+            }
+        }
+        scenario_node->addNew("particle_generators", i2s(gens.size()));
+        
+        auto before_tick = [&kills, &gens] (size_t frame_nr) {
+            for(size_t k = 0; k < kills.size(); k++) {
+                if(kills[k].first != frame_nr) continue;
+                const vector<Mob*> &mobs = game.states.gameplay->mobs.all;
+                for(size_t m = 0; m < mobs.size(); m++) {
+                    if(mobs[m]->type != kills[k].second) continue;
+                    mobs[m]->set_health(false, false, 0.0f);
+                }
+            }
+            for(size_t g = 0; g < gens.size(); g++) {
+                gens[g].tick(game.delta_t, game.states.gameplay->particles);
+            }
+        };
+        
+        size_t max_ticks = nr_ticks_specified ? nr_ticks : scenario.nr_ticks;
+        size_t nr_ticks_run = 0;
+        double total_time =
+            run_ticks(
+                max_ticks, no_inputs, scenario.walk || walk, before_tick,
+                scenario_node, nr_ticks_run
+            );
+        game.perf_mon->write_results(scenario_node->addNew("performance"));
+        
+        printf(
+            "Scenario \"%s\": ran %lu ticks in %f seconds.\n",
+            scenario.name.c_str(), (unsigned long) nr_ticks_run, total_time
+        );
+    }
+    
+    if(!results.saveFile(results_path, true, true)) {
+        fprintf(
+            stderr, "Could not save the benchmark results to \"%s\"!\n",
+            results_path.c_str()
+        );
+        return -1;
+    }
+    
+    printf("Results saved to \"%s\".\n", results_path.c_str());
+    return 0;
+}
+
+
+/**
+ * @brief Runs gameplay logic ticks on the loaded area, until the given
+ * number of ticks is reached or gameplay stops, and adds a timing summary
+ * to the results.
+ *
+ * @param max_ticks Maximum number of ticks to run.
+ * @param inputs Input recording to replay. Can be empty.
+ * @param do_walk Whether the leader should walk around in a square.
+ * @param before_tick If not empty, this is called right before each tick's
+ * logic, with the tick's frame number.
+ * @param results Node to add the timing summary to.
+ * @param out_nr_ticks_run The number of ticks that ran is returned here.
+ * @return How long the ticks took, in seconds.
+ */
+double LogicBenchmark::run_ticks(
+    size_t max_ticks, InputRecording &inputs, bool do_walk,
+    const std::function<void(size_t)> &before_tick, DataNode* results,
+    size_t &out_nr_ticks_run
+) {
+    double start_time = al_get_time();
+    size_t nr_ticks_run = 0;
+    size_t peak_nr_mobs = 0;
+    size_t peak_nr_particles = 0;
+    while(
+        nr_ticks_run < max_ticks &&
+        game.is_game_running &&
+        game.states.gameplay->loaded
+    ) {
+        size_t frame_nr = game.states.gameplay->logic_frame_nr;
+        game.delta_t = delta_t;
+        if(frame_nr < inputs.frames.size()) {
+            const InputRecordingFrame &frame = inputs.frames[frame_nr];
+            game.delta_t = frame.delta_t;
+            game.mouse_cursor.s_pos = frame.cursor_s_pos;
+            game.mouse_cursor.w_pos = frame.cursor_w_pos;
+        }
+        game.time_passed += game.delta_t;
+        game.player_actions.clear();
+        inputs.get_frame_actions(frame_nr, game.player_actions);
+        if(do_walk) {
+            get_walk_actions(frame_nr, game.player_actions);
+        }
+        if(before_tick) before_tick(frame_nr);
+        
+        game.states.gameplay->do_logic();
+        game.jobs.finish_tasks();
+        
+        //This would normally be done at the end of the drawing logic.
+        game.perf_mon->leave_state();
+        nr_ticks_run++;
+        
+        peak_nr_mobs =
+            std::max(peak_nr_mobs, game.states.gameplay->mobs.all.size());
+        peak_nr_particles =
+            std::max(
+                peak_nr_particles,
+                game.states.gameplay->particles.get_count()
+            );
+    }
+    double total_time = al_get_time() - start_time;
+    
+    results->addNew("ticks", i2s(nr_ticks_run));
+    results->addNew("total_time", std::to_string(total_time));
+    results->addNew(
+        "tick_average",
+        std::to_string(nr_ticks_run > 0 ? total_time / nr_ticks_run : 0.0)
+    );
+    results->addNew("peak_mobs", i2s(peak_nr_mobs));
+    results->addNew("peak_particles", i2s(peak_nr_particles));
+    
+    out_nr_ticks_run = nr_ticks_run;
+    return total_time;
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for the headless gameplay logic benchmark, and the
+ * player input recordings it replays.
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../lib/controls_manager/controls_manager.h"
+#include "../lib/data_file/data_file.h"
+#include "../util/geometry_utils.h"
+
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+
+namespace BENCHMARK {
+extern const float DEF_DELTA_T;
+extern const size_t DEF_NR_TICKS;
+extern const float GEOMETRY_AREA_SIZE;
+extern const size_t GEOMETRY_NR_QUERIES;
+extern const size_t GEOMETRY_NR_SEGS;
+extern const size_t KERNELS_NR_PARTICLES;
+extern const size_t KERNELS_NR_PATHS;
+extern const size_t KERNELS_NR_QUERIES;
+extern const size_t KERNELS_NR_REPEATS;
+extern const int RNG_SEED;
+extern const float WALK_LEG_DURATION;
+}
+
+
+/**
+ * @brief Info about one gameplay logic frame of an input recording,
+ * besides the player actions.
+ */
+struct InputRecordingFrame {
+
+    //--- Members ---
+    
+    //The frame's delta_t, before any maker tool speed changes.
+    float delta_t = 0.0f;
+    
+    //Mouse cursor position at the start of the frame, in screen coordinates.
+    Point cursor_s_pos;
+    
+    //Mouse cursor position at the start of the frame, in world coordinates.
+    Point cursor_w_pos;
+    
+};
+
+
+/**
+ * @brief A recording of the player actions that happened during gameplay,
+ * each tagged with the gameplay logic frame it happened in. It also has
+ * the random number generator's state when the area started loading,
+ * and each frame's delta_t and mouse cursor position, so the benchmark can
+ * replay the playthrough exactly as it went. Older recordings only have
+ * the player actions, so those get replayed with a fixed delta_t, and
+ * won't necessarily go the same way the original playthrough did,
+ * but the workload is similar.
+ */
+struct InputRecording {
+    
+    //--- Members ---
+    
+    //Path to the folder of the area that was played.
+    string area_path;
+    
+    //Player actions, along with the frame number they happened in.
+    //These are sorted by frame number.
+    vector<std::pair<size_t, PlayerAction> > actions;
+    
+    //State of the random number generator when the area started loading.
+    int32_t rng_seed = 0;
+    
+    //Info about each frame, by frame number. Empty in older recordings.
+    vector<InputRecordingFrame> frames;
+    
+    
+    //--- Function declarations ---
+    
+    void clear();
+    void get_frame_actions(
+        size_t frame_nr, vector<PlayerAction> &out_actions
+    );
+    bool load(const string &file_path);
+    void record(
+        size_t frame_nr, float delta_t, const Point &cursor_s_pos,
+        const Point &cursor_w_pos, const vector<PlayerAction> &frame_actions
+    );
+    bool save(const string &file_path) const;
+    
+    private:
+    
+    //--- Members ---
+    
+    //Index of the next action to return when replaying.
+    size_t replay_idx = 0;
+    
+    
+    //--- Function declarations ---
+    
+    static string exact_f2s(float f);
+    static float exact_s2f(const string &s);
+    
+};
+
+
+/**
+ * @brief A scripted stress scenario for the benchmark. It loads an area,
+ * and then piles things on top of it, like extra objects, objects that get
+ * killed at a given tick, or extra particle generators. This recreates
+ * heavy situations that are hard to reach by playing normally.
+ */
+struct BenchmarkScenario {
+
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Objects to create when the area starts.
+     */
+    struct Spawn {
+    
+        //--- Members ---
+        
+        //Internal name of the mob type.
+        string type_name;
+        
+        //How many to create.
+        size_t amount = 1;
+        
+        //Center of where to create them.
+        Point pos;
+        
+        //Was the position specified? If not, it's the leader's position.
+        bool pos_specified = false;
+        
+        //They are scattered randomly up to this far from the center.
+        float radius = 0.0f;
+        
+    };
+    
+    /**
+     * @brief Objects to kill at a given tick.
+     */
+    struct Kill {
+    
+        //--- Members ---
+        
+        //Internal name of the mob type. Every mob of this type is killed.
+        string type_name;
+        
+        //Tick to kill them in.
+        size_t tick = 0;
+        
+    };
+    
+    /**
+     * @brief Extra particle generators to run every tick.
+     */
+    struct ParticleGens {
+    
+        //--- Members ---
+        
+        //Internal name of the particle generator.
+        string gen_name;
+        
+        //How many copies to run.
+        size_t amount = 1;
+        
+        //They are scattered randomly up to this far from the leader.
+        float radius = 0.0f;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Name of the scenario.
+    string name;
+    
+    //Path to the folder of the area to load.
+    string area_path;
+    
+    //How many gameplay logic ticks to run.
+    size_t nr_ticks = BENCHMARK::DEF_NR_TICKS;
+    
+    //Should the leader walk around in a square?
+    bool walk = false;
+    
+    //Objects to create when the area starts.
+    vector<Spawn> spawns;
+    
+    //Objects to kill at given ticks.
+    vector<Kill> kills;
+    
+    //Extra particle generators to run every tick.
+    vector<ParticleGens> particle_gens;
+    
+    
+    //--- Function declarations ---
+    
+    void load(DataNode* node);
+    
+};
+
+
+/**
+ * @brief Loads an area and runs its gameplay logic with no display, for a
+ * fixed number of ticks with a fixed delta_t, and then reports how long
+ * each part of the logic took. Useful to catch performance regressions.
+ */
+struct LogicBenchmark {
+    
+    //--- Members ---
+    
+    //Is the benchmark meant to run instead of the game?
+    bool enabled = false;
+    
+    //Should the geometry function benchmark run instead of the
+    //gameplay logic one?
+    bool geometry = false;
+    
+    //Should the kernel benchmark run instead of the gameplay logic one?
+    bool kernels = false;
+    
+    //Path to the stress scenarios file, if the scenarios are meant to run
+    //instead of the gameplay logic benchmark.
+    string scenarios_path;
+    
+    //Path to the folder of the area to load.
+    string area_path;
+    
+    //How many gameplay logic ticks to run.
+    size_t nr_ticks = BENCHMARK::DEF_NR_TICKS;
+    
+    //Was the number of ticks specified? If not, and the input recording
+    //has info about each frame, all of its frames are run.
+    bool nr_ticks_specified = false;
+    
+    //Fixed delta_t to run each tick with, unless the input recording
+    //says what each frame's was.
+    float delta_t = BENCHMARK::DEF_DELTA_T;
+    
+    //Path to the input recording to replay, if any.
+    string inputs_path;
+    
+    //If there's no input recording, should the leader walk around in a
+    //square, so the benchmark covers more than what's near the start?
+    bool walk = false;
+    
+    //Path to the file to write the results to.
+    string results_path;
+    
+    //Path to save a recording of the player's inputs to, during normal
+    //gameplay. Empty if no recording is meant to be made.
+    string record_inputs_path;
+    
+    
+    //--- Function declarations ---
+    
+    void parse_args(int argc, char** argv);
+    int run();
+    int run_geometry();
+    int run_kernels();
+    int run_scenarios();
+    
+    private:
+    
+    //--- Function declarations ---
+    
+    void get_walk_actions(
+        size_t frame_nr, vector<PlayerAction> &out_actions
+    ) const;
+    double run_ticks(
+        size_t max_ticks, InputRecording &inputs, bool do_walk,
+        const std::function<void(size_t)> &before_tick, DataNode* results,
+        size_t &out_nr_ticks_run
+    );
+    
+};
@@ -140,6 +140,12 @@ const string STATUSES = "statuses";
 //Weather definitions.
 const string WEATHER = "weather";
 
+//Compiled data file cache folder.
+const string DATA_FILE_CACHE = "data_file_cache";
+
+//Image thumbnail cache folder.
+const string THUMBNAIL_CACHE = "thumbnail_cache";
+
 }
 
 
@@ -152,18 +158,33 @@ const string AREA_MAIN_DATA = "data.txt";
 //Area geometry file.
 const string AREA_GEOMETRY = "geometry.txt";
 
+//Area geometry cache file, with the triangulation and blockmap.
+const string AREA_GEOMETRY_CACHE = "geometry_cache.bin";
+
 //Area thumbnail file.
 const string AREA_THUMBNAIL = "thumbnail.png";
 
 //Area reference config file.
 const string AREA_REFERENCE_CONFIG = "reference.txt";
 
+//Benchmark results file.
+const string BENCHMARK_RESULTS = "benchmark_results.txt";
+
+//Benchmark stress scenarios file.
+const string BENCHMARK_SCENARIOS = "benchmark_scenarios.txt";
+
+//Content folder index file.
+const string CONTENT_FOLDER_INDEX = "content_folder_index.txt";
+
 //Game configuration file.
 const string GAME_CONFIG = "config.txt";
 
 //Mob type animation file.
 const string MOB_TYPE_ANIMATION = "animations.txt";
 
+//Area performance report file.
+const string AREA_PERF_REPORT = "area_performance_report.txt";
+
 //System content names file.
 const string SYSTEM_CONTENT_NAMES = "system_content_names.txt";
 
@@ -185,6 +206,9 @@ const string PACK_DATA = "data.txt";
 //Performance log file.
 const string PERFORMANCE_LOG = "performance_log.txt";
 
+//Performance monitor samples file.
+const string PERFORMANCE_SAMPLES = "performance_samples.txt";
+
 //Statistics file.
 const string STATISTICS = "statistics.txt";
 
@@ -210,12 +234,37 @@ const string USER_DATA =
 const string AREA_USER_DATA =
     USER_DATA + "/" + FOLDER_NAMES::AREAS;
     
+//Compiled data file cache folder.
+const string DATA_FILE_CACHE =
+    USER_DATA + "/" + FOLDER_NAMES::DATA_FILE_CACHE;
+    
+//Image thumbnail cache folder.
+const string THUMBNAIL_CACHE =
+    USER_DATA + "/" + FOLDER_NAMES::THUMBNAIL_CACHE;
+    
 };
 
 
 //Paths to files from the engine's root folder.
 namespace FILE_PATHS_FROM_ROOT {
 
+//Area performance report.
+const string AREA_PERF_REPORT =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::AREA_PERF_REPORT;
+    
+//Benchmark results.
+const string BENCHMARK_RESULTS =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::BENCHMARK_RESULTS;
+    
+//Benchmark stress scenarios.
+const string BENCHMARK_SCENARIOS =
+    FOLDER_PATHS_FROM_ROOT::BASE_PACK + "/" + FOLDER_NAMES::MISC + "/" +
+    FILE_NAMES::BENCHMARK_SCENARIOS;
+    
+//Content folder index.
+const string CONTENT_FOLDER_INDEX =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::CONTENT_FOLDER_INDEX;
+    
 //Error log.
 const string ERROR_LOG =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::ERROR_LOG;
@@ -232,6 +281,10 @@ const string OPTIONS =
 const string PERFORMANCE_LOG =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::PERFORMANCE_LOG;
     
+//Performance monitor samples.
+const string PERFORMANCE_SAMPLES =
+    FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::PERFORMANCE_SAMPLES;
+    
 //Statistics.
 const string STATISTICS =
     FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + FILE_NAMES::STATISTICS;
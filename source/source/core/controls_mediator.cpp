@@ -52,7 +52,7 @@ void ControlsMediator::add_player_action_type(
     a.autoRepeat = auto_repeat;
     
     player_action_types.push_back(a);
-    mgr.actionTypes[id] = a;
+    mgr.addActionType(a);
 }
 
 
@@ -133,7 +133,7 @@ PlayerInput ControlsMediator::allegro_event_to_input(
  * @return The binds.
  */
 vector<ControlBind> &ControlsMediator::binds() {
-    return mgr.binds;
+    return mgr.getBinds();
 }
 
 
@@ -147,9 +147,10 @@ vector<ControlBind> &ControlsMediator::binds() {
 ControlBind ControlsMediator::find_bind(
     const PLAYER_ACTION_TYPE action_type_id
 ) const {
-    for(size_t b = 0; b < mgr.binds.size(); b++) {
-        if(mgr.binds[b].actionTypeId == action_type_id) {
-            return mgr.binds[b];
+    const vector<ControlBind> &all_binds = mgr.getBinds();
+    for(size_t b = 0; b < all_binds.size(); b++) {
+        if(all_binds[b].actionTypeId == action_type_id) {
+            return all_binds[b];
         }
     }
     return ControlBind();
@@ -374,8 +375,8 @@ vector<PlayerAction> ControlsMediator::new_frame(float delta_t) {
  * Useful for when the game state is changed, or the window is out of focus.
  */
 void ControlsMediator::release_all() {
-    for(auto &a : mgr.actionTypes) {
-        mgr.setValue(a.first, 0.0f);
+    for(const auto &a : player_action_types) {
+        mgr.setValue(a.id, 0.0f);
     }
 }
 
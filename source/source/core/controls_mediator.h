@@ -217,6 +217,9 @@ enum PLAYER_ACTION_TYPE {
     //Path info.
     PLAYER_ACTION_TYPE_MT_PATH_INFO,
     
+    //Performance overlay.
+    PLAYER_ACTION_TYPE_MT_PERF_OVERLAY,
+    
     //Show collision.
     PLAYER_ACTION_TYPE_MT_SHOW_COLLISION,
     
@@ -231,6 +234,9 @@ enum PLAYER_ACTION_TYPE {
     //Auto-start.
     PLAYER_ACTION_TYPE_MT_AUTO_START,
     
+    //Save performance trace.
+    PLAYER_ACTION_TYPE_MT_SAVE_PERF_TRACE,
+    
     //Set song position near loop.
     PLAYER_ACTION_TYPE_MT_SET_SONG_POS_NEAR_LOOP,
     
@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <map>
 #include <typeinfo>
 
 #include "drawing.h"
@@ -59,6 +60,15 @@ const float LIQUID_WOBBLE_DELTA_X = 3.0f;
 //Liquid surfaces wobble using this time scale.
 const float LIQUID_WOBBLE_TIME_SCALE = 2.0f;
 
+//Loading screen progress bar height, in screen ratio.
+const float LOADING_SCREEN_BAR_HEIGHT = 0.01f;
+
+//Loading screen progress bar width, in screen ratio.
+const float LOADING_SCREEN_BAR_WIDTH = 0.40f;
+
+//Loading screen "Loading..." text dots change every this many seconds.
+const float LOADING_SCREEN_DOT_INTERVAL = 0.3f;
+
 //Loading screen subtext padding.
 const int LOADING_SCREEN_PADDING = 64;
 
@@ -71,6 +81,10 @@ const float LOADING_SCREEN_TEXT_HEIGHT = 0.10f;
 //Loading screen text width, in screen ratio.
 const float LOADING_SCREEN_TEXT_WIDTH = 0.70f;
 
+//When working out edge offset effect caches in parallel, don't give any
+//job fewer than this many edges.
+const size_t MIN_OFFSET_EFFECT_CACHE_JOB_SIZE = 64;
+
 //Notification opacity.
 const unsigned char NOTIFICATION_ALPHA = 160;
 
@@ -163,6 +177,9 @@ void draw_bitmap_with_effects(
     );
     
     if(effects.glow_color.a > 0) {
+        //The blender can't change while bitmap drawing is held.
+        bool was_held = al_is_bitmap_drawing_held();
+        if(was_held) al_hold_bitmap_drawing(false);
         int old_op, old_src, old_dst, old_aop, old_asrc, old_adst;
         al_get_separate_blender(
             &old_op, &old_src, &old_dst, &old_aop, &old_asrc, &old_adst
@@ -180,6 +197,7 @@ void draw_bitmap_with_effects(
         al_set_separate_blender(
             old_op, old_src, old_dst, old_aop, old_asrc, old_adst
         );
+        if(was_held) al_hold_bitmap_drawing(true);
     }
 }
 
@@ -225,6 +243,83 @@ void draw_button(
 }
 
 
+/**
+ * @brief Draws text, scaled, but using the game's text bitmap cache.
+ * The result is the same as draw_text's, but text that was drawn recently
+ * doesn't need to be measured or have its glyphs drawn one by one again.
+ * Best for text that doesn't change often.
+ *
+ * @param text Text to draw.
+ * @param font Font to use.
+ * @param where Coordinates to draw it at.
+ * @param box_size Size of the box it must be scaled to.
+ * @param color Tint the text with this color.
+ * @param text_flags Allegro text drawing function flags.
+ * @param v_align Vertical alignment.
+ * @param settings Settings to control how the text can be scaled.
+ * Use TEXT_SETTING_FLAG.
+ * @param further_scale After calculating everything, further scale the
+ * text by this much before drawing.
+ */
+void draw_cached_text(
+    const string &text, const ALLEGRO_FONT* const font,
+    const Point &where, const Point &box_size, const ALLEGRO_COLOR &color,
+    int text_flags, V_ALIGN_MODE v_align, bitmask_8_t settings,
+    const Point &further_scale
+) {
+    //Initial checks.
+    if(text.empty()) return;
+    if(box_size.x == 0 || box_size.y == 0) return;
+    
+    const TextBitmapCache::Text &t_ref = game.text_bitmap_cache.get(font, text);
+    if(!t_ref.bitmap) return;
+    
+    //Figure out the scales.
+    Point text_orig_size(t_ref.bbox_w, t_ref.bbox_h);
+    Point text_final_scale =
+        scale_rectangle_to_box(
+            text_orig_size,
+            box_size,
+            !has_flag(settings, TEXT_SETTING_FLAG_CANT_GROW_X),
+            !has_flag(settings, TEXT_SETTING_FLAG_CANT_GROW_Y),
+            !has_flag(settings, TEXT_SETTING_FLAG_CANT_SHRINK_X),
+            !has_flag(settings, TEXT_SETTING_FLAG_CANT_SHRINK_Y),
+            has_flag(settings, TEXT_SETTING_FLAG_CAN_CHANGE_RATIO)
+        );
+    Point text_final_size = text_orig_size * text_final_scale;
+    
+    //Figure out offsets.
+    float v_align_offset =
+        get_vertical_align_offset(v_align, text_final_size.y);
+    float h_align_offset = 0.0f;
+    if(has_flag(text_flags, ALLEGRO_ALIGN_CENTER)) {
+        h_align_offset = -t_ref.width / 2.0f;
+    } else if(has_flag(text_flags, ALLEGRO_ALIGN_RIGHT)) {
+        h_align_offset = -t_ref.width;
+    }
+    
+    //Create the transformation.
+    ALLEGRO_TRANSFORM text_transform, old_transform;
+    get_text_drawing_transforms(
+        where,
+        text_final_scale * further_scale,
+        has_flag(settings, TEXT_SETTING_COMPENSATE_Y_OFFSET) ?
+        t_ref.bbox_y :
+        0.0f,
+        v_align_offset * further_scale.y,
+        &text_transform, &old_transform
+    );
+    
+    //Draw!
+    al_use_transform(&text_transform); {
+        al_draw_tinted_bitmap(
+            t_ref.bitmap, color,
+            h_align_offset + t_ref.bbox_x, t_ref.bbox_y, 0
+        );
+    }; al_use_transform(&old_transform);
+}
+
+
 /**
  * @brief Draws a fraction, so one number above another, divided by a bar.
  * The top number usually represents the current value of some attribute,
@@ -242,7 +337,7 @@ void draw_fraction(
 ) {
     const float value_nr_y = bottom.y - IN_WORLD_FRACTION::ROW_HEIGHT * 3;
     const float value_nr_scale = value_nr >= requirement_nr ? 1.2f : 1.0f;
-    draw_text(
+    draw_cached_text(
         i2s(value_nr), game.sys_content.fnt_value, Point(bottom.x, value_nr_y),
         Point(LARGE_FLOAT, IN_WORLD_FRACTION::ROW_HEIGHT * scale),
         color, ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_TOP, 0,
@@ -250,7 +345,7 @@ void draw_fraction(
     );
     
     const float bar_y = bottom.y - IN_WORLD_FRACTION::ROW_HEIGHT * 2;
-    draw_text(
+    draw_cached_text(
         "-", game.sys_content.fnt_value, Point(bottom.x, bar_y),
         Point(LARGE_FLOAT, IN_WORLD_FRACTION::ROW_HEIGHT * scale),
         color, ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_TOP, 0
@@ -258,7 +353,7 @@ void draw_fraction(
     
     float req_nr_y = bottom.y - IN_WORLD_FRACTION::ROW_HEIGHT;
     float req_nr_scale = requirement_nr > value_nr ? 1.2f : 1.0f;
-    draw_text(
+    draw_cached_text(
         i2s(requirement_nr), game.sys_content.fnt_value,
         Point(bottom.x, req_nr_y),
         Point(LARGE_FLOAT, IN_WORLD_FRACTION::ROW_HEIGHT * scale),
@@ -308,32 +403,22 @@ void draw_health(
 
 
 /**
- * @brief Draws a liquid sector.
+ * @brief Draws some sectors with a liquid. They all use the same liquid,
+ * and are all drawn at once, so they must be sectors that don't overlap.
  *
- * @param s_ptr Pointer to the sector.
+ * @param sectors Pointers to the sectors.
  * @param l_ptr Pointer to the liquid.
  * @param where X and Y offset.
- * @param scale Scale the sector by this much.
+ * @param scale Scale the sectors by this much.
  * @param time How much time has passed. Used to animate.
  */
 void draw_liquid(
-    Sector* s_ptr, Liquid* l_ptr, const Point &where, float scale,
-    float time
+    const vector<Sector*> &sectors, Liquid* l_ptr, const Point &where,
+    float scale, float time
 ) {
     //Setup.
-    if(!s_ptr) return;
-    if(s_ptr->is_bottomless_pit) return;
+    if(sectors.empty()) return;
     
-    float liquid_opacity_mult = 1.0f;
-    if(s_ptr->draining_liquid) {
-        liquid_opacity_mult =
-            s_ptr->liquid_drain_left / GEOMETRY::LIQUID_DRAIN_DURATION;
-    }
-    float brightness_mult = s_ptr->brightness / 255.0;
-    float sector_scroll[2] = {
-        s_ptr->scroll.x,
-        s_ptr->scroll.y
-    };
     float distortion_amount[2] = {
         l_ptr->distortion_amount.x,
         l_ptr->distortion_amount.y
@@ -414,156 +499,172 @@ void draw_liquid(
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
     */
     
-    //Set up the shader.
-    ALLEGRO_SHADER* liq_shader = game.shaders.get_shader(SHADER_TYPE_LIQUID);
-    al_use_shader(liq_shader);
-    al_set_shader_float("area_time", time * l_ptr->anim_speed);
-    al_set_shader_float("opacity", liquid_opacity_mult);
-    al_set_shader_float("sector_brightness", brightness_mult);
-    al_set_shader_float_vector("sector_scroll", 2, &sector_scroll[0], 1);
-    al_set_shader_float("shine_min_threshold", l_ptr->shine_min_threshold);
-    al_set_shader_float("shine_max_threshold", l_ptr->shine_max_threshold);
-    al_set_shader_float_vector("distortion_amount", 2, &distortion_amount[0], 1);
-    al_set_shader_float_vector("surface_color", 4, &liquid_tint[0], 1);
-    al_set_shader_float_vector("shine_color", 4, &shine_color[0], 1);
+    //Work out the vertexes. Sectors that fade have two layers, one per
+    //texture, and the second must go above the first, so all first layers
+    //get drawn before any second layer. Within a layer, the vertexes are
+    //grouped by texture, since each group is one draw call.
+    map<ALLEGRO_BITMAP*, vector<LiquidVertex> > layer_vertexes[2];
     
-    //Draw the sector liquid now!
-    unsigned char n_textures = 1;
-    Sector* texture_sector[2] = {nullptr, nullptr};
-    if(s_ptr->fade) {
-        s_ptr->get_texture_merge_sectors(
-            &texture_sector[0], &texture_sector[1]
-        );
-        if(!texture_sector[0] && !texture_sector[1]) {
-            //Can't draw this sector's liquid.
-            n_textures = 0;
-        } else {
-            n_textures = 2;
+    for(size_t s = 0; s < sectors.size(); s++) {
+        Sector* s_ptr = sectors[s];
+        if(!s_ptr) continue;
+        if(s_ptr->is_bottomless_pit) continue;
+        
+        float liquid_opacity_mult = 1.0f;
+        if(s_ptr->draining_liquid) {
+            liquid_opacity_mult =
+                s_ptr->liquid_drain_left / GEOMETRY::LIQUID_DRAIN_DURATION;
         }
+        float brightness_mult = s_ptr->brightness / 255.0;
         
-    } else {
-        texture_sector[0] = s_ptr;
+        unsigned char n_textures = 1;
+        Sector* texture_sector[2] = {nullptr, nullptr};
+        if(s_ptr->fade) {
+            s_ptr->get_texture_merge_sectors(
+                &texture_sector[0], &texture_sector[1]
+            );
+            if(!texture_sector[0] && !texture_sector[1]) {
+                //Can't draw this sector's liquid.
+                n_textures = 0;
+            } else {
+                n_textures = 2;
+            }
         
-    }
-    
-    for(unsigned char t = 0; t < n_textures; t++) {
-        bool draw_sector_0 = true;
-        if(!texture_sector[0]) draw_sector_0 = false;
-        else if(texture_sector[0]->is_bottomless_pit) {
-            draw_sector_0 = false;
-        }
+        } else {
+            texture_sector[0] = s_ptr;
         
-        if(n_textures == 2 && !draw_sector_0 && t == 0) {
-            //Allows fading into the void.
-            continue;
         }
+    
+        for(unsigned char t = 0; t < n_textures; t++) {
+            bool draw_sector_0 = true;
+            if(!texture_sector[0]) draw_sector_0 = false;
+            else if(texture_sector[0]->is_bottomless_pit) {
+                draw_sector_0 = false;
+            }
         
-        if(!texture_sector[t] || texture_sector[t]->is_bottomless_pit) {
-            continue;
-        }
-        size_t n_vertexes = s_ptr->triangles.size() * 3;
-        ALLEGRO_VERTEX* av = new ALLEGRO_VERTEX[n_vertexes];
+            if(n_textures == 2 && !draw_sector_0 && t == 0) {
+                //Allows fading into the void.
+                continue;
+            }
         
-        SectorTexture* texture_info_to_use =
-            &texture_sector[t]->texture_info;
+            if(!texture_sector[t] || texture_sector[t]->is_bottomless_pit) {
+                continue;
+            }
+        
+            SectorTexture* texture_info_to_use =
+                &texture_sector[t]->texture_info;
             
-        //Texture transformations.
-        ALLEGRO_TRANSFORM tra;
-        al_build_transform(
-            &tra,
-            -texture_info_to_use->translation.x,
-            -texture_info_to_use->translation.y,
-            1.0f / texture_info_to_use->scale.x,
-            1.0f / texture_info_to_use->scale.y,
-            -texture_info_to_use->rot
-        );
+            size_t n_vertexes = s_ptr->triangles.size() * 3;
+            vector<LiquidVertex> &vertexes =
+                layer_vertexes[t][texture_info_to_use->bitmap];
+            size_t first_vertex = vertexes.size();
+            vertexes.resize(first_vertex + n_vertexes);
+            LiquidVertex* av = &vertexes[first_vertex];
+            
+            //Texture transformations.
+            ALLEGRO_TRANSFORM tra;
+            al_build_transform(
+                &tra,
+                -texture_info_to_use->translation.x,
+                -texture_info_to_use->translation.y,
+                1.0f / texture_info_to_use->scale.x,
+                1.0f / texture_info_to_use->scale.y,
+                -texture_info_to_use->rot
+            );
         
-        float texture_offset[2] = {
-            texture_info_to_use->translation.x,
-            texture_info_to_use->translation.y
-        };
-        float texture_scale[2] = {
-            texture_info_to_use->scale.x,
-            texture_info_to_use->scale.y
-        };
+            float ts_brightness_mult = texture_sector[t]->brightness / 255.0;
         
-        for(size_t v = 0; v < n_vertexes; v++) {
+            for(size_t v = 0; v < n_vertexes; v++) {
         
-            const Triangle* t_ptr = &s_ptr->triangles[floor(v / 3.0)];
-            Vertex* v_ptr = t_ptr->points[v % 3];
-            float vx = v_ptr->x;
-            float vy = v_ptr->y;
+                const Triangle* t_ptr = &s_ptr->triangles[floor(v / 3.0)];
+                Vertex* v_ptr = t_ptr->points[v % 3];
+                float vx = v_ptr->x;
+                float vy = v_ptr->y;
             
-            float alpha_mult = 1;
-            float ts_brightness_mult = texture_sector[t]->brightness / 255.0;
+                float alpha_mult = 1;
             
-            if(t == 1) {
-                if(!draw_sector_0) {
-                    alpha_mult = 0;
-                    for(
-                        size_t e = 0; e < texture_sector[1]->edges.size(); e++
-                    ) {
-                        if(
-                            texture_sector[1]->edges[e]->vertexes[0] == v_ptr ||
-                            texture_sector[1]->edges[e]->vertexes[1] == v_ptr
+                if(t == 1) {
+                    if(!draw_sector_0) {
+                        alpha_mult = 0;
+                        for(
+                            size_t e = 0;
+                            e < texture_sector[1]->edges.size(); e++
                         ) {
-                            alpha_mult = 1;
+                            if(
+                                texture_sector[1]->edges[e]->vertexes[0] ==
+                                v_ptr ||
+                                texture_sector[1]->edges[e]->vertexes[1] ==
+                                v_ptr
+                            ) {
+                                alpha_mult = 1;
+                            }
                         }
-                    }
-                } else {
-                    for(
-                        size_t e = 0; e < texture_sector[0]->edges.size(); e++
-                    ) {
-                        if(
-                            texture_sector[0]->edges[e]->vertexes[0] == v_ptr ||
-                            texture_sector[0]->edges[e]->vertexes[1] == v_ptr
+                    } else {
+                        for(
+                            size_t e = 0;
+                            e < texture_sector[0]->edges.size(); e++
                         ) {
-                            alpha_mult = 0;
+                            if(
+                                texture_sector[0]->edges[e]->vertexes[0] ==
+                                v_ptr ||
+                                texture_sector[0]->edges[e]->vertexes[1] ==
+                                v_ptr
+                            ) {
+                                alpha_mult = 0;
+                            }
                         }
                     }
                 }
-            }
             
-            av[v].x = vx - where.x;
-            av[v].y = vy - where.y;
-            if(texture_sector[t]) al_transform_coordinates(&tra, &vx, &vy);
-            av[v].u = vx;
-            av[v].v = vy;
-            av[v].z = 0;
-            av[v].color =
-                al_map_rgba_f(
-                    texture_sector[t]->texture_info.tint.r * ts_brightness_mult,
-                    texture_sector[t]->texture_info.tint.g * ts_brightness_mult,
-                    texture_sector[t]->texture_info.tint.b * ts_brightness_mult,
-                    texture_sector[t]->texture_info.tint.a * alpha_mult
-                );
-        }
-        
-        for(size_t v = 0; v < n_vertexes; v++) {
-            av[v].x *= scale;
-            av[v].y *= scale;
+                av[v].x = (vx - where.x) * scale;
+                av[v].y = (vy - where.y) * scale;
+                al_transform_coordinates(&tra, &vx, &vy);
+                av[v].u = vx;
+                av[v].v = vy;
+                av[v].color =
+                    al_map_rgba_f(
+                        texture_info_to_use->tint.r * ts_brightness_mult,
+                        texture_info_to_use->tint.g * ts_brightness_mult,
+                        texture_info_to_use->tint.b * ts_brightness_mult,
+                        texture_info_to_use->tint.a * alpha_mult
+                    );
+                av[v].tex_transform[0] = texture_info_to_use->translation.x;
+                av[v].tex_transform[1] = texture_info_to_use->translation.y;
+                av[v].tex_transform[2] = texture_info_to_use->scale.x;
+                av[v].tex_transform[3] = texture_info_to_use->scale.y;
+                av[v].sector_props[0] = texture_info_to_use->rot;
+                av[v].sector_props[1] = brightness_mult;
+                av[v].sector_props[2] = liquid_opacity_mult;
+                av[v].sector_scroll[0] = s_ptr->scroll.x;
+                av[v].sector_scroll[1] = s_ptr->scroll.y;
+            }
         }
+    }
         
-        ALLEGRO_BITMAP* tex =
-            texture_sector[t] ?
-            texture_sector[t]->texture_info.bitmap :
-            texture_sector[t == 0 ? 1 : 0]->texture_info.bitmap;
-            
-        int bmp_size[2] = {
-            al_get_bitmap_width(tex),
-            al_get_bitmap_height(tex)
-        };
-        al_set_shader_float_vector("tex_translation", 2, texture_offset, 1);
-        al_set_shader_float_vector("tex_scale", 2, texture_scale, 1);
-        al_set_shader_float("tex_rotation", texture_info_to_use->rot);
-        al_set_shader_int_vector("bmp_size", 2, &bmp_size[0], 1);
+    //Set up the shader.
+    ALLEGRO_SHADER* liq_shader = game.shaders.get_shader(SHADER_TYPE_LIQUID);
+    al_use_shader(liq_shader);
+    al_set_shader_float("area_time", time * l_ptr->anim_speed);
+    al_set_shader_float("shine_min_threshold", l_ptr->shine_min_threshold);
+    al_set_shader_float("shine_max_threshold", l_ptr->shine_max_threshold);
+    al_set_shader_float_vector("distortion_amount", 2, &distortion_amount[0], 1);
+    al_set_shader_float_vector("surface_color", 4, &liquid_tint[0], 1);
+    al_set_shader_float_vector("shine_color", 4, &shine_color[0], 1);
         
-        al_draw_prim(
-            av, nullptr, tex,
-            0, (int) n_vertexes, ALLEGRO_PRIM_TRIANGLE_LIST
-        );
+    //Draw the liquid now!
+    for(unsigned char t = 0; t < 2; t++) {
+        for(auto &l : layer_vertexes[t]) {
+            int bmp_size[2] = {
+                al_get_bitmap_width(l.first),
+                al_get_bitmap_height(l.first)
+            };
+            al_set_shader_int_vector("bmp_size", 2, &bmp_size[0], 1);
         
-        delete[] av;
+            al_draw_prim(
+                l.second.data(), game.shaders.liquid_vertex_decl, l.first,
+                0, (int) l.second.size(), ALLEGRO_PRIM_TRIANGLE_LIST
+            );
+        }
     }
     
     //Finish up.
@@ -579,9 +680,11 @@ void draw_liquid(
  * @param subtext Subtext to show under the main text, optional.
  * @param opacity 0 to 1. The background blackness lowers in opacity
  * much faster.
+ * @param progress 0 to 1, how far along the loading is. Negative means
+ * no progress bar is shown.
  */
 void draw_loading_screen(
-    const string &text, const string &subtext, float opacity
+    const string &text, const string &subtext, float opacity, float progress
 ) {
     const float text_w = game.win_w * DRAWING::LOADING_SCREEN_TEXT_WIDTH;
     const float text_h = game.win_h * DRAWING::LOADING_SCREEN_TEXT_HEIGHT;
@@ -771,13 +874,35 @@ void draw_loading_screen(
             );
         }
         
+        //The dots cycle, so it's clear the program isn't stuck
+        //when the screen is redrawn while waiting.
+        size_t nr_dots =
+            (size_t) (al_get_time() / DRAWING::LOADING_SCREEN_DOT_INTERVAL) % 4;
         draw_text(
-            "Loading...", game.sys_content.fnt_standard,
+            "Loading" + string(nr_dots, '.'), game.sys_content.fnt_standard,
             Point(game.win_w - 8, game.win_h - 8), text_box,
             al_map_rgb(192, 192, 192), ALLEGRO_ALIGN_RIGHT, V_ALIGN_MODE_BOTTOM
         );
     }
     
+    //Progress bar.
+    if(progress >= 0.0f) {
+        const float bar_w = game.win_w * DRAWING::LOADING_SCREEN_BAR_WIDTH;
+        const float bar_h = game.win_h * DRAWING::LOADING_SCREEN_BAR_HEIGHT;
+        const float bar_x = game.win_w * 0.5f - bar_w * 0.5f;
+        const float bar_y = game.win_h * 0.85f;
+        const unsigned char bar_alpha = 255.0f * opacity;
+        al_draw_filled_rectangle(
+            bar_x, bar_y, bar_x + bar_w, bar_y + bar_h,
+            al_map_rgba(64, 64, 64, bar_alpha)
+        );
+        al_draw_filled_rectangle(
+            bar_x, bar_y,
+            bar_x + bar_w * std::clamp(progress, 0.0f, 1.0f), bar_y + bar_h,
+            change_alpha(COLOR_GOLD, bar_alpha)
+        );
+    }
+    
 }
 
 
@@ -830,42 +955,23 @@ void draw_mob_shadow(
     const Mob* m,
     float delta_z, float shadow_stretch
 ) {
-
-    Point shadow_size = Point(m->radius * 2.2f);
-    if(m->rectangular_dim.x != 0) {
-        shadow_size = m->rectangular_dim * 1.1f;
-    }
-    
     if(shadow_stretch <= 0) return;
     
-    float diameter = shadow_size.x;
-    float shadow_x = 0;
-    float shadow_w =
-        diameter + (diameter * shadow_stretch * MOB::SHADOW_STRETCH_MULT);
-        
-    if(game.states.gameplay->day_minutes < 60 * 12) {
-        //Shadows point to the West.
-        shadow_x = -shadow_w + diameter * 0.5;
-        shadow_x -= shadow_stretch * delta_z * MOB::SHADOW_Y_MULT;
-    } else {
-        //Shadows point to the East.
-        shadow_x = -(diameter * 0.5);
-        shadow_x += shadow_stretch * delta_z * MOB::SHADOW_Y_MULT;
-    }
-    
-    if(m->rectangular_dim.x != 0) {
+    Point center;
+    Point size;
+    if(get_mob_shadow_placement(m, delta_z, shadow_stretch, &center, &size)) {
         draw_bitmap(
             game.sys_content.bmp_shadow_square,
-            Point(m->pos.x + shadow_x + shadow_w / 2, m->pos.y),
-            shadow_size,
+            center,
+            size,
             m->angle,
             map_alpha(255 * (1 - shadow_stretch))
         );
     } else {
         draw_bitmap(
             game.sys_content.bmp_shadow,
-            Point(m->pos.x + shadow_x + shadow_w / 2, m->pos.y),
-            Point(shadow_w, diameter),
+            center,
+            size,
             0,
             map_alpha(255 * (1 - shadow_stretch))
         );
@@ -873,6 +979,72 @@ void draw_mob_shadow(
 }
 
 
+/**
+ * @brief Draws the shadows of several mobs at once. Shadows are all
+ * the same color, so the order they're drawn in doesn't matter,
+ * and this only needs one draw call per shadow bitmap.
+ *
+ * @param shadows Mobs to draw the shadows for, and how many units above
+ * the floor directly below them they are.
+ * @param shadow_stretch How much to stretch the shadows by
+ * (used to simulate sun shadow direction casting).
+ */
+void draw_mob_shadows(
+    const vector<std::pair<const Mob*, float> > &shadows,
+    float shadow_stretch
+) {
+    if(shadow_stretch <= 0) return;
+    
+    ALLEGRO_BITMAP* bitmaps[2] = {
+        game.sys_content.bmp_shadow,
+        game.sys_content.bmp_shadow_square
+    };
+    Point bmp_sizes[2] = {
+        get_bitmap_dimensions(bitmaps[0]),
+        get_bitmap_dimensions(bitmaps[1])
+    };
+    vector<ALLEGRO_VERTEX> vertexes[2];
+    ALLEGRO_COLOR tint = map_alpha(255 * (1 - shadow_stretch));
+    
+    for(size_t s = 0; s < shadows.size(); s++) {
+        const Mob* m_ptr = shadows[s].first;
+        Point center;
+        Point size;
+        unsigned char b =
+            get_mob_shadow_placement(
+                m_ptr, shadows[s].second, shadow_stretch, &center, &size
+            ) ? 1 : 0;
+        float angle = b == 1 ? m_ptr->angle : 0.0f;
+        
+        //Two triangles, made from the corners.
+        const Point corner_mults[6] = {
+            Point(-0.5f, -0.5f), Point(0.5f, -0.5f), Point(0.5f, 0.5f),
+            Point(-0.5f, -0.5f), Point(0.5f, 0.5f), Point(-0.5f, 0.5f)
+        };
+        for(unsigned char v = 0; v < 6; v++) {
+            Point corner =
+                center + rotate_point(size * corner_mults[v], angle);
+            ALLEGRO_VERTEX av;
+            av.x = corner.x;
+            av.y = corner.y;
+            av.z = 0.0f;
+            av.u = (corner_mults[v].x + 0.5f) * bmp_sizes[b].x;
+            av.v = (corner_mults[v].y + 0.5f) * bmp_sizes[b].y;
+            av.color = tint;
+            vertexes[b].push_back(av);
+        }
+    }
+    
+    for(unsigned char b = 0; b < 2; b++) {
+        if(vertexes[b].empty()) continue;
+        al_draw_prim(
+            vertexes[b].data(), nullptr, bitmaps[b],
+            0, (int) vertexes[b].size(), ALLEGRO_PRIM_TRIANGLE_LIST
+        );
+    }
+}
+
+
 /**
  * @brief Draws the mouse cursor.
  *
@@ -1106,60 +1278,191 @@ void draw_player_input_source_icon(
 
 
 /**
- * @brief Draws a sector, but only the texture (no wall shadows).
+ * @brief Draws a fading sector's texture, which is its two neighbors'
+ * textures merged. Both are drawn at once with the sector fade shader.
  *
  * @param s_ptr Pointer to the sector.
  * @param where X and Y offset.
  * @param scale Scale the sector by this much.
  * @param opacity Draw the textures at this opacity, 0 - 1.
  */
-void draw_sector_texture(
+void draw_sector_fade_texture(
     Sector* s_ptr, const Point &where, float scale, float opacity
 ) {
-    if(!s_ptr) return;
-    if(s_ptr->is_bottomless_pit) return;
-    
-    unsigned char n_textures = 1;
     Sector* texture_sector[2] = {nullptr, nullptr};
+    s_ptr->get_texture_merge_sectors(&texture_sector[0], &texture_sector[1]);
+    if(!texture_sector[1] || texture_sector[1]->is_bottomless_pit) {
+        //Can't draw this sector.
+        return;
+    }
     
-    if(s_ptr->fade) {
-        s_ptr->get_texture_merge_sectors(
-            &texture_sector[0], &texture_sector[1]
-        );
-        if(!texture_sector[0] && !texture_sector[1]) {
-            //Can't draw this sector.
-            return;
-        }
-        n_textures = 2;
-        
-    } else {
-        texture_sector[0] = s_ptr;
+    bool draw_sector_0 =
+        texture_sector[0] && !texture_sector[0]->is_bottomless_pit;
         
-    }
+    //If the first texture isn't drawn, the second one stands in for it,
+    //fully transparent. This allows fading into the void.
+    Sector* layer_sector[2] = {
+        draw_sector_0 ? texture_sector[0] : texture_sector[1],
+        texture_sector[1]
+    };
     
-    for(unsigned char t = 0; t < n_textures; t++) {
+    size_t n_vertexes = s_ptr->triangles.size() * 3;
+    SectorTextureDrawCache* caches = s_ptr->texture_draw_caches;
     
-        bool draw_sector_0 = true;
-        if(!texture_sector[0]) draw_sector_0 = false;
-        else if(texture_sector[0]->is_bottomless_pit) {
-            draw_sector_0 = false;
+    //The geometry and the texture information rarely change, so only
+    //work out the vertexes again if something did change.
+    bool cache_valid =
+        s_ptr->fade_vertexes.size() == n_vertexes &&
+        caches[0].matches(texture_sector[0], draw_sector_0) &&
+        caches[1].matches(texture_sector[1], draw_sector_0);
+        
+    if(!cache_valid) {
+        s_ptr->fade_vertexes.resize(n_vertexes);
+        SectorFadeVertex* fv = s_ptr->fade_vertexes.data();
+        
+        //Texture transformations and colors.
+        ALLEGRO_TRANSFORM tra[2];
+        ALLEGRO_COLOR colors[2];
+        for(unsigned char t = 0; t < 2; t++) {
+            const SectorTexture* info = &layer_sector[t]->texture_info;
+            al_build_transform(
+                &tra[t],
+                -info->translation.x, -info->translation.y,
+                1.0f / info->scale.x, 1.0f / info->scale.y,
+                -info->rot
+            );
+            float brightness_mult = layer_sector[t]->brightness / 255.0;
+            colors[t] =
+                al_map_rgba_f(
+                    info->tint.r * brightness_mult,
+                    info->tint.g * brightness_mult,
+                    info->tint.b * brightness_mult,
+                    info->tint.a
+                );
         }
+        if(!draw_sector_0) colors[0].a = 0.0f;
+        
+        Sector* edge_sector =
+            draw_sector_0 ? texture_sector[0] : texture_sector[1];
+            
+        for(size_t v = 0; v < n_vertexes; v++) {
         
-        if(n_textures == 2 && !draw_sector_0 && t == 0) {
-            //Allows fading into the void.
-            continue;
+            const Triangle* t_ptr = &s_ptr->triangles[floor(v / 3.0)];
+            Vertex* v_ptr = t_ptr->points[v % 3];
+            
+            bool on_edge = false;
+            for(size_t e = 0; e < edge_sector->edges.size(); e++) {
+                if(
+                    edge_sector->edges[e]->vertexes[0] == v_ptr ||
+                    edge_sector->edges[e]->vertexes[1] == v_ptr
+                ) {
+                    on_edge = true;
+                    break;
+                }
+            }
+            float alpha_mult = 1;
+            if(!draw_sector_0) {
+                alpha_mult = on_edge ? 1 : 0;
+            } else {
+                alpha_mult = on_edge ? 0 : 1;
+            }
+            
+            fv[v].x = v_ptr->x;
+            fv[v].y = v_ptr->y;
+            
+            float tx = v_ptr->x;
+            float ty = v_ptr->y;
+            al_transform_coordinates(&tra[0], &tx, &ty);
+            fv[v].u = tx;
+            fv[v].v = ty;
+            fv[v].color = colors[0];
+            
+            tx = v_ptr->x;
+            ty = v_ptr->y;
+            al_transform_coordinates(&tra[1], &tx, &ty);
+            fv[v].tex_b[0] = tx;
+            fv[v].tex_b[1] = ty;
+            fv[v].color_b[0] = colors[1].r;
+            fv[v].color_b[1] = colors[1].g;
+            fv[v].color_b[2] = colors[1].b;
+            fv[v].color_b[3] = colors[1].a * alpha_mult;
         }
         
-        if(!texture_sector[t] || texture_sector[t]->is_bottomless_pit) {
-            continue;
+        caches[0].remember(texture_sector[0], draw_sector_0);
+        caches[1].remember(texture_sector[1], draw_sector_0);
+    }
+    
+    //Only the placement and opacity need to be applied every frame,
+    //and only if they're not the defaults.
+    SectorFadeVertex* fv = s_ptr->fade_vertexes.data();
+    if(
+        where.x != 0.0f || where.y != 0.0f ||
+        scale != 1.0f || opacity != 1.0f
+    ) {
+        static vector<SectorFadeVertex> final_vertexes;
+        final_vertexes.assign(
+            s_ptr->fade_vertexes.begin(), s_ptr->fade_vertexes.end()
+        );
+        fv = final_vertexes.data();
+        for(size_t v = 0; v < n_vertexes; v++) {
+            fv[v].x = (fv[v].x - where.x) * scale;
+            fv[v].y = (fv[v].y - where.y) * scale;
+            fv[v].color.a *= opacity;
+            fv[v].color_b[3] *= opacity;
         }
+    }
+    
+    ALLEGRO_BITMAP* bmp_b = texture_sector[1]->texture_info.bitmap;
+    int bmp_b_size[2] = {
+        al_get_bitmap_width(bmp_b),
+        al_get_bitmap_height(bmp_b)
+    };
+    
+    al_use_shader(game.shaders.get_shader(SHADER_TYPE_SECTOR_FADE));
+    al_set_shader_int_vector("bmp_b_size", 2, &bmp_b_size[0], 1);
+    al_set_shader_sampler("tex_b", bmp_b, 1);
+    al_draw_prim(
+        fv, game.shaders.sector_fade_vertex_decl,
+        layer_sector[0]->texture_info.bitmap,
+        0, (int) n_vertexes, ALLEGRO_PRIM_TRIANGLE_LIST
+    );
+    al_use_shader(NULL);
+}
+
+
+/**
+ * @brief Draws a sector, but only the texture (no wall shadows).
+ *
+ * @param s_ptr Pointer to the sector.
+ * @param where X and Y offset.
+ * @param scale Scale the sector by this much.
+ * @param opacity Draw the textures at this opacity, 0 - 1.
+ */
+void draw_sector_texture(
+    Sector* s_ptr, const Point &where, float scale, float opacity
+) {
+    if(!s_ptr) return;
+    if(s_ptr->is_bottomless_pit) return;
+    
+    if(s_ptr->fade) {
+        draw_sector_fade_texture(s_ptr, where, scale, opacity);
+        return;
+    }
+    
+    size_t n_vertexes = s_ptr->triangles.size() * 3;
+    SectorTextureDrawCache* cache = &s_ptr->texture_draw_caches[0];
+    SectorTexture* texture_info_to_use = &s_ptr->texture_info;
+    
+    //The geometry and the texture information rarely change, so only
+    //work out the vertexes again if something did change.
+    bool cache_valid =
+        cache->vertexes.size() == n_vertexes &&
+        cache->matches(s_ptr, true);
         
-        size_t n_vertexes = s_ptr->triangles.size() * 3;
-        ALLEGRO_VERTEX* av = new ALLEGRO_VERTEX[n_vertexes];
+    if(!cache_valid) {
+        cache->vertexes.resize(n_vertexes);
+        ALLEGRO_VERTEX* av = cache->vertexes.data();
         
-        SectorTexture* texture_info_to_use =
-            &texture_sector[t]->texture_info;
-            
         //Texture transformations.
         ALLEGRO_TRANSFORM tra;
         al_build_transform(
@@ -1171,6 +1474,8 @@ void draw_sector_texture(
             -texture_info_to_use->rot
         );
         
+        float brightness_mult = s_ptr->brightness / 255.0;
+        
         for(size_t v = 0; v < n_vertexes; v++) {
         
             const Triangle* t_ptr = &s_ptr->triangles[floor(v / 3.0)];
@@ -1178,79 +1483,64 @@ void draw_sector_texture(
             float vx = v_ptr->x;
             float vy = v_ptr->y;
             
-            float alpha_mult = 1;
-            float brightness_mult = texture_sector[t]->brightness / 255.0;
-            
-            if(t == 1) {
-                if(!draw_sector_0) {
-                    alpha_mult = 0;
-                    for(
-                        size_t e = 0; e < texture_sector[1]->edges.size(); e++
-                    ) {
-                        if(
-                            texture_sector[1]->edges[e]->vertexes[0] == v_ptr ||
-                            texture_sector[1]->edges[e]->vertexes[1] == v_ptr
-                        ) {
-                            alpha_mult = 1;
-                        }
-                    }
-                } else {
-                    for(
-                        size_t e = 0; e < texture_sector[0]->edges.size(); e++
-                    ) {
-                        if(
-                            texture_sector[0]->edges[e]->vertexes[0] == v_ptr ||
-                            texture_sector[0]->edges[e]->vertexes[1] == v_ptr
-                        ) {
-                            alpha_mult = 0;
-                        }
-                    }
-                }
-            }
-            
-            av[v].x = vx - where.x;
-            av[v].y = vy - where.y;
-            if(texture_sector[t]) al_transform_coordinates(&tra, &vx, &vy);
+            av[v].x = vx;
+            av[v].y = vy;
+            al_transform_coordinates(&tra, &vx, &vy);
             av[v].u = vx;
             av[v].v = vy;
             av[v].z = 0;
             av[v].color =
                 al_map_rgba_f(
-                    texture_sector[t]->texture_info.tint.r * brightness_mult,
-                    texture_sector[t]->texture_info.tint.g * brightness_mult,
-                    texture_sector[t]->texture_info.tint.b * brightness_mult,
-                    texture_sector[t]->texture_info.tint.a * alpha_mult *
-                    opacity
+                    texture_info_to_use->tint.r * brightness_mult,
+                    texture_info_to_use->tint.g * brightness_mult,
+                    texture_info_to_use->tint.b * brightness_mult,
+                    texture_info_to_use->tint.a
                 );
         }
         
+        cache->remember(s_ptr, true);
+    }
+    
+    //Only the placement and opacity need to be applied every frame,
+    //and only if they're not the defaults.
+    ALLEGRO_VERTEX* av = cache->vertexes.data();
+    if(
+        where.x != 0.0f || where.y != 0.0f ||
+        scale != 1.0f || opacity != 1.0f
+    ) {
+        static vector<ALLEGRO_VERTEX> final_vertexes;
+        final_vertexes.assign(
+            cache->vertexes.begin(), cache->vertexes.end()
+        );
+        av = final_vertexes.data();
         for(size_t v = 0; v < n_vertexes; v++) {
-            av[v].x *= scale;
-            av[v].y *= scale;
+            av[v].x = (av[v].x - where.x) * scale;
+            av[v].y = (av[v].y - where.y) * scale;
+            av[v].color.a *= opacity;
         }
-        
-        ALLEGRO_BITMAP* tex =
-            texture_sector[t] ?
-            texture_sector[t]->texture_info.bitmap :
-            texture_sector[t == 0 ? 1 : 0]->texture_info.bitmap;
-            
-        al_draw_prim(
-            av, nullptr, tex,
-            0, (int) n_vertexes, ALLEGRO_PRIM_TRIANGLE_LIST
-        );
-        
-        delete[] av;
     }
+    
+    al_draw_prim(
+        av, nullptr, s_ptr->texture_info.bitmap,
+        0, (int) n_vertexes, ALLEGRO_PRIM_TRIANGLE_LIST
+    );
 }
 
 
 /**
- * @brief Draws a status effect's bitmap.
+ * @brief Draws a status effect's bitmap. If the gameplay state is batching
+ * status effect bitmaps, the mob goes into the batch instead, to be drawn
+ * later with draw_status_effect_bmps().
  *
  * @param m Mob that has this status effect.
  * @param effects List of bitmap effects to use.
  */
 void draw_status_effect_bmp(const Mob* m, BitmapEffect &effects) {
+    if(game.states.gameplay->status_overlay_batching) {
+        game.states.gameplay->status_overlay_batch.push_back(m);
+        return;
+    }
+    
     float status_bmp_scale;
     ALLEGRO_BITMAP* status_bmp = m->get_status_bitmap(&status_bmp_scale);
     
@@ -1264,6 +1554,46 @@ void draw_status_effect_bmp(const Mob* m, BitmapEffect &effects) {
 }
 
 
+/**
+ * @brief Draws the status effect bitmaps of several mobs at once.
+ * They're sorted by bitmap, so that with bitmap drawing held, all mobs
+ * with the same status effect bitmap only take one draw call.
+ *
+ * @param mobs Mobs to draw the status effect bitmaps of.
+ */
+void draw_status_effect_bmps(const vector<const Mob*> &mobs) {
+    vector<std::pair<ALLEGRO_BITMAP*, size_t> > overlays;
+    vector<float> scales(mobs.size(), 0.0f);
+    for(size_t m = 0; m < mobs.size(); m++) {
+        ALLEGRO_BITMAP* status_bmp = mobs[m]->get_status_bitmap(&scales[m]);
+        if(status_bmp) overlays.push_back(std::make_pair(status_bmp, m));
+    }
+    if(overlays.empty()) return;
+    
+    std::stable_sort(
+        overlays.begin(), overlays.end(),
+    [] (
+        const std::pair<ALLEGRO_BITMAP*, size_t> &o1,
+        const std::pair<ALLEGRO_BITMAP*, size_t> &o2
+    ) -> bool {
+        return o1.first < o2.first;
+    }
+    );
+    
+    bool was_held = al_is_bitmap_drawing_held();
+    if(!was_held) al_hold_bitmap_drawing(true);
+    for(size_t o = 0; o < overlays.size(); o++) {
+        const Mob* m_ptr = mobs[overlays[o].second];
+        draw_bitmap(
+            overlays[o].first,
+            m_ptr->pos,
+            Point(m_ptr->radius * 2 * scales[overlays[o].second], -1)
+        );
+    }
+    if(!was_held) al_hold_bitmap_drawing(false);
+}
+
+
 /**
  * @brief Draws string tokens.
  *
@@ -1308,7 +1638,7 @@ void draw_string_tokens(
         float token_final_width = tokens[t].width * x_scale;
         switch(tokens[t].type) {
         case STRING_TOKEN_CHAR: {
-            draw_text(
+            draw_cached_text(
                 tokens[t].content, text_font, Point(caret, where.y),
                 Point(LARGE_FLOAT), COLOR_WHITE,
                 ALLEGRO_ALIGN_LEFT, V_ALIGN_MODE_TOP,
@@ -1339,6 +1669,52 @@ void draw_string_tokens(
 }
 
 
+/**
+ * @brief Returns where a mob's shadow should be drawn, and how big.
+ *
+ * @param m mob to get the shadow of.
+ * @param delta_z The mob is these many units above the floor directly below it.
+ * @param shadow_stretch How much to stretch the shadow by
+ * (used to simulate sun shadow direction casting).
+ * @param out_center The center of the shadow is returned here.
+ * @param out_size The width and height of the shadow are returned here.
+ * @return Whether the shadow is rectangular, and should use the
+ * square shadow bitmap, rotated by the mob's angle.
+ */
+bool get_mob_shadow_placement(
+    const Mob* m, float delta_z, float shadow_stretch,
+    Point* out_center, Point* out_size
+) {
+    Point shadow_size = Point(m->radius * 2.2f);
+    if(m->rectangular_dim.x != 0) {
+        shadow_size = m->rectangular_dim * 1.1f;
+    }
+    
+    float diameter = shadow_size.x;
+    float shadow_x = 0;
+    float shadow_w =
+        diameter + (diameter * shadow_stretch * MOB::SHADOW_STRETCH_MULT);
+    
+    if(game.states.gameplay->day_minutes < 60 * 12) {
+        //Shadows point to the West.
+        shadow_x = -shadow_w + diameter * 0.5;
+        shadow_x -= shadow_stretch * delta_z * MOB::SHADOW_Y_MULT;
+    } else {
+        //Shadows point to the East.
+        shadow_x = -(diameter * 0.5);
+        shadow_x += shadow_stretch * delta_z * MOB::SHADOW_Y_MULT;
+    }
+    
+    *out_center = Point(m->pos.x + shadow_x + shadow_w / 2, m->pos.y);
+    if(m->rectangular_dim.x != 0) {
+        *out_size = shadow_size;
+        return true;
+    }
+    *out_size = Point(shadow_w, diameter);
+    return false;
+}
+
+
 /**
  * @brief Returns information about how a control bind icon should be drawn.
  *
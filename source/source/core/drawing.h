@@ -32,10 +32,14 @@ namespace DRAWING {
 extern const float DEF_HEALTH_WHEEL_RADIUS;
 extern const float LIQUID_WOBBLE_DELTA_X;
 extern const float LIQUID_WOBBLE_TIME_SCALE;
+extern const float LOADING_SCREEN_BAR_HEIGHT;
+extern const float LOADING_SCREEN_BAR_WIDTH;
+extern const float LOADING_SCREEN_DOT_INTERVAL;
 extern const int LOADING_SCREEN_PADDING;
 extern const float LOADING_SCREEN_SUBTEXT_SCALE;
 extern const float LOADING_SCREEN_TEXT_HEIGHT;
 extern const float LOADING_SCREEN_TEXT_WIDTH;
+extern const size_t MIN_OFFSET_EFFECT_CACHE_JOB_SIZE;
 extern const unsigned char NOTIFICATION_ALPHA;
 extern const float NOTIFICATION_CONTROL_SIZE;
 extern const float NOTIFICATION_PADDING;
@@ -184,6 +188,14 @@ void draw_button(
     bool selected,
     float juicy_grow_amount = 0.0f
 );
+void draw_cached_text(
+    const string &text, const ALLEGRO_FONT* const font,
+    const Point &where, const Point &box_size,
+    const ALLEGRO_COLOR &color = COLOR_WHITE,
+    int text_flags = ALLEGRO_ALIGN_CENTER,
+    V_ALIGN_MODE v_align = V_ALIGN_MODE_CENTER, bitmask_8_t settings = 0,
+    const Point &further_scale = Point(1.0f)
+);
 void draw_fraction(
     const Point &bottom, size_t value_nr,
     size_t requirement_nr, const ALLEGRO_COLOR &color, float scale
@@ -195,11 +207,12 @@ void draw_health(
     bool just_chart = false
 );
 void draw_liquid(
-    Sector* s_ptr, Liquid* l_ptr, const Point &where, float scale,
-    float time
+    const vector<Sector*> &sectors, Liquid* l_ptr, const Point &where,
+    float scale, float time
 );
 void draw_loading_screen(
-    const string &area_name, const string &subtitle, float opacity
+    const string &area_name, const string &subtitle, float opacity,
+    float progress = -1.0f
 );
 void draw_menu_button_icon(
     MENU_ICON icon, const Point &button_center, const Point &button_size,
@@ -211,23 +224,36 @@ void draw_player_input_source_icon(
     bool condensed, const Point &where, const Point &max_size,
     unsigned char alpha = 228
 );
+void draw_sector_fade_texture(
+    Sector* s_ptr, const Point &where, float scale, float opacity
+);
 void draw_sector_texture(
     Sector* s_ptr, const Point &where, float scale, float opacity
 );
 void draw_sector_edge_offsets(
-    Sector* s_ptr, ALLEGRO_BITMAP* buffer, float opacity
+    Sector* s_ptr, ALLEGRO_BITMAP* buffer, float opacity,
+    float buffer_scale = 1.0f
 );
 void draw_mob_shadow(
     const Mob* m,
     float delta_z, float shadow_stretch
 );
+void draw_mob_shadows(
+    const vector<std::pair<const Mob*, float> > &shadows,
+    float shadow_stretch
+);
 void draw_status_effect_bmp(const Mob* m, BitmapEffect &effects);
+void draw_status_effect_bmps(const vector<const Mob*> &mobs);
 void draw_string_tokens(
     const vector<StringToken> &tokens, const ALLEGRO_FONT* const text_font,
     const ALLEGRO_FONT* const control_font, bool controls_condensed,
     const Point &where, int flags, const Point &max_size,
     const Point &scale = Point(1.0f)
 );
+bool get_mob_shadow_placement(
+    const Mob* m, float delta_z, float shadow_stretch,
+    Point* out_center, Point* out_size
+);
 void get_player_input_icon_info(
     const PlayerInputSource &s, bool condensed,
     PLAYER_INPUT_ICON_SHAPE* shape,
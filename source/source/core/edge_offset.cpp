@@ -13,6 +13,8 @@
  * acute or obtuse angles.
  */
 
+#include <algorithm>
+
 #include <allegro5/allegro_image.h>
 
 #include "../content/area/sector.h"
@@ -189,9 +191,10 @@ void draw_edge_offset_on_buffer(
  * @param s_ptr Sector to draw the effects of.
  * @param buffer Buffer to draw from.
  * @param opacity Draw at this opacity, 0 - 1.
+ * @param buffer_scale Scale of the buffer, compared to the screen.
  */
 void draw_sector_edge_offsets(
-    Sector* s_ptr, ALLEGRO_BITMAP* buffer, float opacity
+    Sector* s_ptr, ALLEGRO_BITMAP* buffer, float opacity, float buffer_scale
 ) {
     if(s_ptr->is_bottomless_pit) return;
     
@@ -209,8 +212,8 @@ void draw_sector_edge_offsets(
         al_transform_coordinates(
             &game.world_to_screen_transform, &vx, &vy
         );
-        av[v].u = vx;
-        av[v].v = vy;
+        av[v].u = vx * buffer_scale;
+        av[v].v = vy * buffer_scale;
         av[v].z = 0;
         av[v].color.r = 1.0f;
         av[v].color.g = 1.0f;
@@ -636,56 +639,73 @@ void get_next_offset_effect_edge(
  * @param caches List of caches to fetch edge info from.
  * @param buffer Buffer to draw to.
  * @param clear_first If true, the bitmap is cleared before any drawing is done.
+ * @param bmap If not nullptr, the edges to draw are found with this blockmap,
+ * which must be up-to-date with the area's geometry. Otherwise, every
+ * sector is checked.
+ * @param buffer_scale Scale of the buffer, compared to the screen.
  */
 void update_offset_effect_buffer(
     const Point &cam_tl, const Point &cam_br,
     const vector<EdgeOffsetCache> &caches, ALLEGRO_BITMAP* buffer,
-    bool clear_first
+    bool clear_first, const Blockmap* bmap, float buffer_scale
 ) {
-    unordered_set<size_t> edges;
+    vector<size_t> edges;
+    
+    if(bmap) {
+        bmap->get_edge_idxs_in_region(cam_tl, cam_br, edges);
     
-    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
-        Sector* s_ptr = game.cur_area_data->sectors[s];
+    } else {
+        for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+            Sector* s_ptr = game.cur_area_data->sectors[s];
         
-        if(
-            !rectangles_intersect(
-                s_ptr->bbox[0], s_ptr->bbox[1],
-                cam_tl, cam_br
-            )
-        ) {
-            //Sector is off-camera.
-            continue;
-        }
+            if(
+                !rectangles_intersect(
+                    s_ptr->bbox[0], s_ptr->bbox[1],
+                    cam_tl, cam_br
+                )
+            ) {
+                //Sector is off-camera.
+                continue;
+            }
         
-        bool fully_on_camera = false;
-        if(
-            s_ptr->bbox[0].x > cam_tl.x &&
-            s_ptr->bbox[1].x < cam_br.x &&
-            s_ptr->bbox[0].y > cam_tl.y &&
-            s_ptr->bbox[1].y < cam_br.y
-        ) {
-            fully_on_camera = true;
-        }
+            bool fully_on_camera = false;
+            if(
+                s_ptr->bbox[0].x > cam_tl.x &&
+                s_ptr->bbox[1].x < cam_br.x &&
+                s_ptr->bbox[0].y > cam_tl.y &&
+                s_ptr->bbox[1].y < cam_br.y
+            ) {
+                fully_on_camera = true;
+            }
         
-        for(size_t e = 0; e < s_ptr->edges.size(); e++) {
-            if(!fully_on_camera) {
-                //If the sector's fully on-camera, it's faster to not bother
-                //with the edge-by-edge check.
-                Point edge_tl = v2p(s_ptr->edges[e]->vertexes[0]);
-                Point edge_br = edge_tl;
-                update_min_max_coords(
-                    edge_tl, edge_br,
-                    v2p(s_ptr->edges[e]->vertexes[1])
-                );
+            for(size_t e = 0; e < s_ptr->edges.size(); e++) {
+                if(!fully_on_camera) {
+                    //If the sector's fully on-camera, it's faster to not
+                    //bother with the edge-by-edge check.
+                    Point edge_tl = v2p(s_ptr->edges[e]->vertexes[0]);
+                    Point edge_br = edge_tl;
+                    update_min_max_coords(
+                        edge_tl, edge_br,
+                        v2p(s_ptr->edges[e]->vertexes[1])
+                    );
                 
-                if(!rectangles_intersect(edge_tl, edge_br, cam_tl, cam_br)) {
-                    //Edge is off-camera.
-                    continue;
+                    if(
+                        !rectangles_intersect(
+                            edge_tl, edge_br, cam_tl, cam_br
+                        )
+                    ) {
+                        //Edge is off-camera.
+                        continue;
+                    }
                 }
-            }
             
-            edges.insert(s_ptr->edge_idxs[e]);
+                edges.push_back(s_ptr->edge_idxs[e]);
+            }
         }
+        
+        //Edges are shared by sectors, so remove the repeats.
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
     }
     
     //Save the current state of some things.
@@ -701,6 +721,10 @@ void update_offset_effect_buffer(
         ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO,
         ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA
     );
+    ALLEGRO_TRANSFORM scale_transform;
+    al_identity_transform(&scale_transform);
+    al_scale_transform(&scale_transform, buffer_scale, buffer_scale);
+    al_use_transform(&scale_transform);
     al_hold_bitmap_drawing(true);
     
     //Draw!
@@ -714,6 +738,7 @@ void update_offset_effect_buffer(
     
     //Return to the old state of things.
     al_hold_bitmap_drawing(false);
+    al_use_transform(&game.identity_transform);
     al_set_separate_blender(
         old_op, old_src, old_dst, old_aop, old_asrc, old_adst
     );
@@ -721,6 +746,85 @@ void update_offset_effect_buffer(
 }
 
 
+/**
+ * @brief Updates the cached information about one edge's offset effect.
+ *
+ * @param cache Cache to update.
+ * @param e_ptr Edge the cache belongs to.
+ * @param checker Pointer to a function that checks if the edge should have the
+ * intended effect or not. It also returns what sector of the edge
+ *  will be affected by the effect, and which won't.
+ * @param length_getter Function that returns the length of the effect.
+ * @param color_getter Function that returns the color of the effect.
+ */
+void update_offset_effect_cache(
+    EdgeOffsetCache &cache, Edge* e_ptr,
+    offset_effect_checker_t checker,
+    offset_effect_length_getter_t length_getter,
+    offset_effect_color_getter_t color_getter
+) {
+    Sector* unaffected_sector = nullptr;
+    Sector* affected_sector = nullptr;
+    
+    if(!checker(e_ptr, &affected_sector, &unaffected_sector)) {
+        //This edge doesn't get the effect.
+        cache.lengths[0] = 0.0f;
+        cache.lengths[1] = 0.0f;
+        return;
+    }
+    
+    //We need to process the two vertexes of the edge in a specific
+    //order, such that if you stand on the first one being processed,
+    //and you face the second one, the affected sector is to the left.
+    
+    Vertex* ends_to_process[2];
+    if(e_ptr->sectors[0] == affected_sector) {
+        ends_to_process[0] = e_ptr->vertexes[0];
+        ends_to_process[1] = e_ptr->vertexes[1];
+        cache.first_end_vertex_idx = 0;
+    } else {
+        ends_to_process[0] = e_ptr->vertexes[1];
+        ends_to_process[1] = e_ptr->vertexes[0];
+        cache.first_end_vertex_idx = 1;
+    }
+    float edge_process_angle =
+        get_angle(v2p(ends_to_process[0]), v2p(ends_to_process[1]));
+        
+    for(unsigned char end = 0; end < 2; end++) {
+        //For each end of the effect...
+        
+        float length = 0.0f;
+        float angle = 0.0f;
+        float elbow_length = 0.0f;
+        float elbow_angle = 0.0f;
+        ALLEGRO_COLOR end_color;
+        
+        //The edge's effect is simply a rectangle, although one or both
+        //of its ends could be angled inward, either to merge with a
+        //neighboring effect or to fit snugly against a different
+        //effect's edge.
+        //In addition, we may also need to draw an "elbow" shape to
+        //connect to a different edge.
+        //Start by getting information on how this effect should behave.
+        //We don't need to worry about why it's drawn the way it is, since
+        //get_edge_offset_edge_info is in charge of that.
+        get_edge_offset_edge_info(
+            e_ptr, ends_to_process[end], end,
+            end == 0 ? edge_process_angle : edge_process_angle + TAU / 2.0f,
+            checker, length_getter, color_getter,
+            &angle, &length, &end_color,
+            &elbow_angle, &elbow_length
+        );
+        
+        cache.lengths[end] = length;
+        cache.angles[end] = normalize_angle(angle);
+        cache.colors[end] = end_color;
+        cache.elbow_angles[end] = normalize_angle(elbow_angle);
+        cache.elbow_lengths[end] = elbow_length;
+    }
+}
+
+
 /**
  * @brief Updates the cached information about all edge offsets.
  *
@@ -739,72 +843,29 @@ void update_offset_effect_caches (
     offset_effect_length_getter_t length_getter,
     offset_effect_color_getter_t color_getter
 ) {
-    unordered_set<size_t> edges_to_update;
+    game.offset_effect_buffers_dirty = true;
+    
+    unordered_set<size_t> edges_to_update_set;
     for(Vertex* v : vertexes_to_update) {
-        edges_to_update.insert(v->edge_idxs.begin(), v->edge_idxs.end());
+        edges_to_update_set.insert(v->edge_idxs.begin(), v->edge_idxs.end());
     }
+    vector<size_t> edges_to_update(
+        edges_to_update_set.begin(), edges_to_update_set.end()
+    );
     
-    for(size_t e : edges_to_update) {
-        Edge* e_ptr = game.cur_area_data->edges[e];
-        
-        Sector* unaffected_sector = nullptr;
-        Sector* affected_sector = nullptr;
-        
-        if(!checker(e_ptr, &affected_sector, &unaffected_sector)) {
-            //This edge doesn't get the effect.
-            caches[e].lengths[0] = 0.0f;
-            caches[e].lengths[1] = 0.0f;
-            continue;
-        }
-        
-        //We need to process the two vertexes of the edge in a specific
-        //order, such that if you stand on the first one being processed,
-        //and you face the second one, the affected sector is to the left.
-        
-        Vertex* ends_to_process[2];
-        if(e_ptr->sectors[0] == affected_sector) {
-            ends_to_process[0] = e_ptr->vertexes[0];
-            ends_to_process[1] = e_ptr->vertexes[1];
-            caches[e].first_end_vertex_idx = 0;
-        } else {
-            ends_to_process[0] = e_ptr->vertexes[1];
-            ends_to_process[1] = e_ptr->vertexes[0];
-            caches[e].first_end_vertex_idx = 1;
-        }
-        float edge_process_angle =
-            get_angle(v2p(ends_to_process[0]), v2p(ends_to_process[1]));
-            
-        for(unsigned char end = 0; end < 2; end++) {
-            //For each end of the effect...
-            
-            float length = 0.0f;
-            float angle = 0.0f;
-            float elbow_length = 0.0f;
-            float elbow_angle = 0.0f;
-            ALLEGRO_COLOR end_color;
-            
-            //The edge's effect is simply a rectangle, although one or both
-            //of its ends could be angled inward, either to merge with a
-            //neighboring effect or to fit snugly against a different
-            //effect's edge.
-            //In addition, we may also need to draw an "elbow" shape to
-            //connect to a different edge.
-            //Start by getting information on how this effect should behave.
-            //We don't need to worry about why it's drawn the way it is, since
-            //get_edge_offset_edge_info is in charge of that.
-            get_edge_offset_edge_info(
-                e_ptr, ends_to_process[end], end,
-                end == 0 ? edge_process_angle : edge_process_angle + TAU / 2.0f,
-                checker, length_getter, color_getter,
-                &angle, &length, &end_color,
-                &elbow_angle, &elbow_length
+    //Each edge's cache only depends on the area's geometry, which isn't
+    //changing, so they can all be worked out at the same time.
+    game.jobs.parallel_for(
+        edges_to_update.size(), DRAWING::MIN_OFFSET_EFFECT_CACHE_JOB_SIZE,
+    [&caches, &edges_to_update, checker, length_getter, color_getter]
+    (size_t start, size_t end) {
+        for(size_t e = start; e < end; e++) {
+            size_t e_idx = edges_to_update[e];
+            update_offset_effect_cache(
+                caches[e_idx], game.cur_area_data->edges[e_idx],
+                checker, length_getter, color_getter
             );
-            
-            caches[e].lengths[end] = length;
-            caches[e].angles[end] = normalize_angle(angle);
-            caches[e].colors[end] = end_color;
-            caches[e].elbow_angles[end] = normalize_angle(elbow_angle);
-            caches[e].elbow_lengths[end] = elbow_length;
         }
     }
+    );
 }
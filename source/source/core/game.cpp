@@ -16,6 +16,7 @@
 
 #include "../lib/imgui/imgui_impl_allegro5.h"
 #include "../util/allegro_utils.h"
+#include "../util/archive_utils.h"
 #include "../util/general_utils.h"
 #include "drawing.h"
 #include "init.h"
@@ -52,6 +53,10 @@ const size_t FRAMERATE_AVG_SAMPLE_SIZE = 30;
 //Only save the latest N FPS samples.
 const size_t FRAMERATE_HISTORY_SIZE = 300;
 
+//After the player does something, keep drawing for at least this long
+//before idling, so hover effects, tooltips, and the like can show up.
+const float IDLE_GRACE_DURATION = 1.0f;
+
 }
 
 
@@ -85,6 +90,32 @@ Game::Game() {
 }
 
 
+/**
+ * @brief Applies the adaptive quality's current level to everything
+ * it affects.
+ */
+void Game::apply_adaptive_quality() {
+    states.gameplay->particles.set_budget(
+        options.advanced.max_particles *
+        adaptive_quality.get_particle_budget_ratio()
+    );
+    
+    float scale = adaptive_quality.get_offset_effect_scale();
+    if(scale != offset_effect_buffers_scale) {
+        int buffer_w = std::max((int) (win_w * scale), 1);
+        int buffer_h = std::max((int) (win_h * scale), 1);
+        al_destroy_bitmap(liquid_limit_effect_buffer);
+        al_destroy_bitmap(wall_offset_effect_buffer);
+        liquid_limit_effect_buffer = al_create_bitmap(buffer_w, buffer_h);
+        wall_offset_effect_buffer = al_create_bitmap(buffer_w, buffer_h);
+        offset_effect_buffers_scale = scale;
+    }
+    
+    //Wall shadows may have been turned on or off, too.
+    offset_effect_buffers_dirty = true;
+}
+
+
 /**
  * @brief Changes to a different game state.
  *
@@ -117,6 +148,32 @@ void Game::change_state(
 }
 
 
+/**
+ * @brief Hands an Allegro event to everything that needs to handle it.
+ * If it came from the player, this also stops any idling.
+ *
+ * @param ev Event to handle.
+ */
+void Game::dispatch_allegro_event(const ALLEGRO_EVENT &ev) {
+    if(
+        ev.type != ALLEGRO_EVENT_TIMER &&
+        ev.type != ALLEGRO_EVENT_AUDIO_STREAM_FINISHED
+    ) {
+        //The player did something, so there's something new to draw.
+        idle_grace_end_time = al_get_time() + GAME::IDLE_GRACE_DURATION;
+        if(idling) {
+            al_resume_timer(main_timer);
+            idling = false;
+            reset_delta_t = true;
+        }
+    }
+    
+    global_handle_allegro_event(ev);
+    cur_state->handle_allegro_event(ev);
+    controls.handle_allegro_event(ev);
+}
+
+
 /**
  * @brief Returns the name of the current state.
  *
@@ -173,6 +230,9 @@ void Game::global_logic() {
     //Audio.
     audio.tick(delta_t);
     
+    //Sector textures that finished loading in the background.
+    sector_textures.update();
+    
     //Dear ImGui.
     ImGui_ImplAllegro5_NewFrame();
     ImGui::NewFrame();
@@ -265,53 +325,108 @@ void Game::main_loop() {
         
         al_wait_for_event(event_queue, &ev);
         
-        global_handle_allegro_event(ev);
-        cur_state->handle_allegro_event(ev);
-        controls.handle_allegro_event(ev);
+        dispatch_allegro_event(ev);
         
         switch(ev.type) {
         case ALLEGRO_EVENT_TIMER: {
-            if(al_is_event_queue_empty(event_queue)) {
+            if(ev.any.source != al_get_timer_event_source(main_timer)) {
+                break;
+            }
             
-                double cur_frame_start_time = al_get_time();
-                if(reset_delta_t) {
-                    //Failsafe.
-                    prev_frame_start_time =
-                        cur_frame_start_time -
-                        1.0f / options.advanced.target_fps;
-                    reset_delta_t = false;
+            //Handle everything else that queued up before the frame starts,
+            //and drop the ticks that came in while the previous frame was
+            //running late. This way there's never more than one frame
+            //waiting to be processed, and a pending input event doesn't
+            //make the frame get skipped.
+            ALLEGRO_EVENT next_ev;
+            while(al_peek_next_event(event_queue, &next_ev)) {
+                if(
+                    next_ev.type == ALLEGRO_EVENT_TIMER &&
+                    next_ev.any.source ==
+                    al_get_timer_event_source(main_timer)
+                ) {
+                    al_drop_next_event(event_queue);
+                    continue;
                 }
+                al_get_next_event(event_queue, &next_ev);
+                dispatch_allegro_event(next_ev);
+            }
+            if(!is_game_running) break;
+            
+            double cur_frame_start_time = al_get_time();
+            if(reset_delta_t) {
+                //Failsafe.
+                prev_frame_start_time =
+                    cur_frame_start_time -
+                    1.0f / options.advanced.target_fps;
+                reset_delta_t = false;
+            }
+            
+            float real_delta_t =
+                cur_frame_start_time - prev_frame_start_time;
+            statistics.runtime += real_delta_t;
+            
+            //Anti speed-burst cap.
+            delta_t = std::min(real_delta_t, 0.2f);
+            
+            time_passed += delta_t;
+            GameState* prev_state = cur_state;
+            
+            player_actions = controls.new_frame(delta_t);
+            global_logic();
+            cur_state->do_logic();
+            
+            //Time spent waiting for the display to flip isn't work,
+            //and with vsync it would always fill up the budget.
+            double flip_dur = 0.0;
+            if(cur_state == prev_state) {
+                //Only draw if we didn't change states in the meantime.
+                cur_state->do_drawing();
+                global_drawing();
+                double flip_start_time = al_get_time();
+                al_flip_display();
+                flip_dur = al_get_time() - flip_start_time;
+            } else {
+                ImGui::EndFrame();
+            }
+            
+            //Background tasks can't carry over to the next frame.
+            jobs.finish_tasks();
+            
+            double cur_frame_end_time = al_get_time();
+            cur_frame_process_time =
+                cur_frame_end_time - cur_frame_start_time;
                 
-                float real_delta_t =
-                    cur_frame_start_time - prev_frame_start_time;
-                statistics.runtime += real_delta_t;
-                
-                //Anti speed-burst cap.
-                delta_t = std::min(real_delta_t, 0.2f);
-                
-                time_passed += delta_t;
-                GameState* prev_state = cur_state;
-                
-                player_actions = controls.new_frame(delta_t);
-                global_logic();
-                cur_state->do_logic();
-                
-                if(cur_state == prev_state) {
-                    //Only draw if we didn't change states in the meantime.
-                    cur_state->do_drawing();
-                    global_drawing();
-                    al_flip_display();
-                } else {
-                    ImGui::EndFrame();
+            prev_frame_start_time = cur_frame_start_time;
+            
+            if(
+                options.advanced.adaptive_quality &&
+                cur_state == states.gameplay
+            ) {
+                if(
+                    adaptive_quality.update(
+                        cur_frame_process_time - flip_dur,
+                        1.0 / options.advanced.target_fps, delta_t
+                    )
+                ) {
+                    apply_adaptive_quality();
                 }
-                
-                double cur_frame_end_time = al_get_time();
-                cur_frame_process_time =
-                    cur_frame_end_time - cur_frame_start_time;
-                    
-                prev_frame_start_time = cur_frame_start_time;
-                
+            } else if(adaptive_quality.get_level() > 0) {
+                adaptive_quality.reset();
+                apply_adaptive_quality();
+            }
+            
+            if(
+                cur_frame_end_time >= idle_grace_end_time &&
+                !show_system_info && !fade_mgr.is_fading() &&
+                cur_state->can_idle()
+            ) {
+                //Nothing's changing on its own, so stop the ticks until
+                //the player does something.
+                al_stop_timer(main_timer);
+                idling = true;
             }
+            
             break;
             
         }
@@ -324,8 +439,16 @@ void Game::main_loop() {
  * @brief Shuts down the program, cleanly freeing everything.
  */
 void Game::shutdown() {
-    if(perf_mon) {
-        perf_mon->save_log();
+    if(perf_mon && !headless) {
+        if(maker_tools.perf_mon_sampling_interval > 0.0f) {
+            perf_mon->save_samples();
+        } else {
+            perf_mon->save_log();
+        }
+    }
+    
+    if(!benchmark.record_inputs_path.empty()) {
+        input_recording.save(benchmark.record_inputs_path);
     }
     
     if(cur_state) {
@@ -349,6 +472,11 @@ void Game::shutdown() {
     states.destroy();
     destroy_misc();
     destroy_event_things(main_timer, event_queue);
+    jobs.stop();
+    file_writer.stop();
+    area_preloader.stop();
+    unmount_file_archives();
+    if(perf_mon) perf_mon->set_sampling_interval(0.0f);
     destroy_allegro();
 }
 
@@ -376,6 +504,8 @@ void Game::register_audio_stream_source(ALLEGRO_AUDIO_STREAM* stream) {
 int Game::start() {
     //Allegro initializations.
     init_allegro();
+    set_thread_setup_func(use_file_archive_interface);
+    set_up_thread();
     
     //Panic check: is there a game_data folder?
     if(folder_to_vector(FOLDER_PATHS_FROM_ROOT::GAME_DATA, true).empty()) {
@@ -399,6 +529,13 @@ int Game::start() {
     init_controls();
     load_options();
     save_options();
+    jobs.start(
+        options.advanced.job_threads > 0 ?
+        options.advanced.job_threads :
+        get_nr_hardware_threads() - 1
+    );
+    file_writer.start();
+    area_preloader.start();
     load_statistics();
     statistics.startups++;
     save_statistics();
@@ -424,12 +561,14 @@ int Game::start() {
     load_misc_graphics();
     load_misc_sounds();
     
-    //Draw the basic loading screen.
-    draw_loading_screen("", "", 1.0);
-    al_flip_display();
-    
-    //Init Dear ImGui.
-    init_dear_imgui();
+    if(!headless) {
+        //Draw the basic loading screen.
+        draw_loading_screen("", "", 1.0);
+        al_flip_display();
+        
+        //Init Dear ImGui.
+        init_dear_imgui();
+    }
     
     //Init and load some engine things.
     init_mob_actions();
@@ -442,10 +581,22 @@ int Game::start() {
     
     if(maker_tools.use_perf_mon) {
         perf_mon = new PerformanceMonitor();
+        perf_mon->set_tracing(
+            maker_tools.perf_mon_trace_size,
+            maker_tools.perf_mon_trace_frame_budget
+        );
+        perf_mon->set_mob_type_costs(maker_tools.perf_mon_mob_type_costs);
+        perf_mon->set_script_costs(maker_tools.perf_mon_script_costs);
+        perf_mon->set_sampling_interval(
+            maker_tools.perf_mon_sampling_interval
+        );
     }
     
     //Auto-start in some state.
-    if(
+    if(headless) {
+        //The benchmark will pick the state itself.
+        
+    } else if(
         maker_tools.enabled &&
         maker_tools.auto_start_state == "play" &&
         !maker_tools.auto_start_option.empty()
@@ -26,7 +26,9 @@
 #include "../game_state/results.h"
 #include "../game_state/title_screen.h"
 #include "../lib/controls_manager/controls_manager.h"
+#include "../util/thread_utils.h"
 #include "audio.h"
+#include "benchmark.h"
 #include "game_config.h"
 #include "misc_structs.h"
 #include "options.h"
@@ -43,6 +45,7 @@ extern const unsigned char CURSOR_TRAIL_SAVE_N_SPOTS;
 extern const float FADE_DURATION;
 extern const size_t FRAMERATE_AVG_SAMPLE_SIZE;
 extern const size_t FRAMERATE_HISTORY_SIZE;
+extern const float IDLE_GRACE_DURATION;
 }
 
 
@@ -95,9 +98,15 @@ public:
 
     //--- Members ---
     
+    //Lowers the graphics quality when frames take too long.
+    AdaptiveQuality adaptive_quality;
+    
     //Audio.
     AudioManager audio;
     
+    //Headless logic benchmark settings.
+    LogicBenchmark benchmark;
+    
     //The error bitmap used to represent bitmaps that were not loaded.
     ALLEGRO_BITMAP* bmp_error = nullptr;
     
@@ -137,24 +146,42 @@ public:
     //Shader manager.
     ShaderManager shaders;
     
+    //Loads sector textures in the background.
+    SectorTextureStreamer sector_textures;
+    
     //Manager for all full-screen fade-ins and fade-outs.
     FadeManager fade_mgr;
     
+    //Writes data files to the disk in the background.
+    BackgroundFileWriter file_writer;
+    
+    //Reads the data files of the area the player will likely enter next.
+    AreaPreloader area_preloader;
+    
     //Duration of the last few frames.
     vector<double> framerate_history;
     
     //Last framerate average started at this point in the history.
     size_t framerate_last_avg_point = 0.0f;
     
+    //Is the game running without a display? Nothing gets drawn if so.
+    bool headless = false;
+    
     //Identity matrix transformation. Cache for convenience.
     ALLEGRO_TRANSFORM identity_transform;
     
     //Default Dear ImGui style.
     ImVec4 imgui_default_style[ImGuiCol_COUNT];
     
+    //Recording of the player's inputs, if they are being recorded.
+    InputRecording input_recording;
+    
     //Set to false to stop program execution next frame.
     bool is_game_running = true;
     
+    //Worker threads that heavy, independent work can be spread across.
+    JobPool jobs;
+    
     //What Allegro joystick maps to what number.
     map<ALLEGRO_JOYSTICK*, int> controller_numbers;
 
@@ -195,6 +222,17 @@ public:
     //Database of all mission score criteria.
     vector<MissionScoreCriterion*> mission_score_criteria;
     
+    //Do the offset effect buffers need to be drawn again, even if the
+    //camera didn't change?
+    bool offset_effect_buffers_dirty = true;
+    
+    //World to screen transformation the offset effect buffers were last
+    //drawn with.
+    ALLEGRO_TRANSFORM offset_effect_buffers_transform;
+    
+    //Size of the offset effect buffers, compared to the window's.
+    float offset_effect_buffers_scale = 1.0f;
+    
     //User options.
     Options options;
     
@@ -238,6 +276,12 @@ public:
     //List of all mob team names, in proper English.
     string team_names[N_MOB_TEAMS];
     
+    //Text drawn onto bitmaps. Cache for performance.
+    TextBitmapCache text_bitmap_cache;
+    
+    //Laid out text, and glyph widths. Cache for performance.
+    TextLayoutCache text_layout_cache;
+    
     //How much time has passed since the program booted.
     float time_passed = 0.0f;
     
@@ -305,9 +349,17 @@ private:
     //Is delta_t meant to be reset for the next frame?
     bool reset_delta_t = true;
     
+    //Is the main timer stopped because the current state is idling?
+    bool idling = false;
+    
+    //The current state can only start idling after this point in time.
+    double idle_grace_end_time = 0.0;
+    
     
     //--- Function declarations ---
     
+    void apply_adaptive_quality();
+    void dispatch_allegro_event(const ALLEGRO_EVENT &ev);
     void global_drawing();
     void global_logic();
     void global_handle_allegro_event(const ALLEGRO_EVENT &ev);
@@ -77,7 +77,7 @@ void destroy_event_things(
 ) {
     al_destroy_event_queue(event_queue);
     al_destroy_timer(main_timer);
-    al_destroy_display(game.display);
+    if(game.display) al_destroy_display(game.display);
 }
 
 
@@ -85,6 +85,7 @@ void destroy_event_things(
  * @brief Destroys miscellaneous things.
  */
 void destroy_misc() {
+    game.sector_textures.stop();
     al_destroy_bitmap(game.bmp_error);
     game.audio.destroy();
     
@@ -585,6 +586,13 @@ void init_controls() {
         "Toggle info about paths the info'd mob is taking.",
         "mt_path_info", "k_34"
     );
+    game.controls.add_player_action_type(
+        PLAYER_ACTION_TYPE_MT_PERF_OVERLAY,
+        PLAYER_ACTION_CAT_GAMEPLAY_MAKER_TOOLS,
+        "Performance overlay",
+        "Toggle an overlay with frame times and other performance info.",
+        "mt_perf_overlay", ""
+    );
     game.controls.add_player_action_type(
         PLAYER_ACTION_TYPE_MT_SHOW_COLLISION,
         PLAYER_ACTION_CAT_GAMEPLAY_MAKER_TOOLS,
@@ -615,6 +623,13 @@ void init_controls() {
         "Make the game auto-start on the current state (and content).",
         "mt_auto_start", "k_56"
     );
+    game.controls.add_player_action_type(
+        PLAYER_ACTION_TYPE_MT_SAVE_PERF_TRACE,
+        PLAYER_ACTION_CAT_GLOBAL_MAKER_TOOLS,
+        "Save performance trace",
+        "Save the performance monitor's latest events, for Perfetto.",
+        "mt_save_perf_trace", ""
+    );
     game.controls.add_player_action_type(
         PLAYER_ACTION_TYPE_MT_SET_SONG_POS_NEAR_LOOP,
         PLAYER_ACTION_CAT_GLOBAL_MAKER_TOOLS,
@@ -808,7 +823,12 @@ void init_error_bitmap() {
             16.0, 16.0, 32.0, 32.0,
             al_map_rgba(255, 0, 255, 192)
         );
-    } al_set_target_backbuffer(game.display);
+    }
+    if(game.display) {
+        al_set_target_backbuffer(game.display);
+    } else {
+        al_set_target_bitmap(nullptr);
+    }
     game.bmp_error = recreate_bitmap(game.bmp_error);
 }
 
@@ -835,50 +855,54 @@ void init_essentials() {
 void init_event_things(
     ALLEGRO_TIMER* &main_timer, ALLEGRO_EVENT_QUEUE* &event_queue
 ) {
-    al_set_new_display_flags(
-        al_get_new_display_flags() |
-        ALLEGRO_OPENGL | ALLEGRO_PROGRAMMABLE_PIPELINE
-    );
-    if(game.options.advanced.window_pos_hack) al_set_new_window_position(64, 64);
-    if(game.win_fullscreen) {
+    if(!game.headless) {
         al_set_new_display_flags(
             al_get_new_display_flags() |
-            (
-                game.options.graphics.true_fullscreen ?
-                ALLEGRO_FULLSCREEN :
-                ALLEGRO_FULLSCREEN_WINDOW
-            )
-        );
-    }
-    game.display = al_create_display(game.win_w, game.win_h);
-    
-    //It's possible that this resolution is not valid for fullscreen.
-    //Detect this and try again in windowed.
-    if(!game.display && game.win_fullscreen) {
-        game.errors.report(
-            "Could not create a fullscreen window with the resolution " +
-            i2s(game.win_w) + "x" + i2s(game.win_h) + ". "
-            "Setting the fullscreen option back to false. "
-            "You can try a different resolution, "
-            "preferably one from the options menu."
-        );
-        game.win_fullscreen = false;
-        game.options.graphics.intended_win_fullscreen = false;
-        save_options();
-        al_set_new_display_flags(
-            al_get_new_display_flags() & ~ALLEGRO_FULLSCREEN
+            ALLEGRO_OPENGL | ALLEGRO_PROGRAMMABLE_PIPELINE
         );
+        if(game.options.advanced.window_pos_hack) {
+            al_set_new_window_position(64, 64);
+        }
+        if(game.win_fullscreen) {
+            al_set_new_display_flags(
+                al_get_new_display_flags() |
+                (
+                    game.options.graphics.true_fullscreen ?
+                    ALLEGRO_FULLSCREEN :
+                    ALLEGRO_FULLSCREEN_WINDOW
+                )
+            );
+        }
         game.display = al_create_display(game.win_w, game.win_h);
+        
+        //It's possible that this resolution is not valid for fullscreen.
+        //Detect this and try again in windowed.
+        if(!game.display && game.win_fullscreen) {
+            game.errors.report(
+                "Could not create a fullscreen window with the resolution " +
+                i2s(game.win_w) + "x" + i2s(game.win_h) + ". "
+                "Setting the fullscreen option back to false. "
+                "You can try a different resolution, "
+                "preferably one from the options menu."
+            );
+            game.win_fullscreen = false;
+            game.options.graphics.intended_win_fullscreen = false;
+            save_options();
+            al_set_new_display_flags(
+                al_get_new_display_flags() & ~ALLEGRO_FULLSCREEN
+            );
+            game.display = al_create_display(game.win_w, game.win_h);
+        }
+        
+        if(!game.display) {
+            report_fatal_error("Could not create a display!");
+        }
+        
+        //For some reason some resolutions aren't properly created
+        //under Windows. This hack fixes it.
+        al_resize_display(game.display, game.win_w, game.win_h);
     }
     
-    if(!game.display) {
-        report_fatal_error("Could not create a display!");
-    }
-    
-    //For some reason some resolutions aren't properly created under Windows.
-    //This hack fixes it.
-    al_resize_display(game.display, game.win_w, game.win_h);
-    
     main_timer = al_create_timer(1.0f / game.options.advanced.target_fps);
     if(!main_timer) {
         report_fatal_error("Could not create the main game timer!");
@@ -891,9 +915,11 @@ void init_event_things(
     al_register_event_source(event_queue, al_get_mouse_event_source());
     al_register_event_source(event_queue, al_get_keyboard_event_source());
     al_register_event_source(event_queue, al_get_joystick_event_source());
-    al_register_event_source(
-        event_queue, al_get_display_event_source(game.display)
-    );
+    if(game.display) {
+        al_register_event_source(
+            event_queue, al_get_display_event_source(game.display)
+        );
+    }
     al_register_event_source(
         event_queue, al_get_timer_event_source(main_timer)
     );
@@ -905,11 +931,19 @@ void init_event_things(
  */
 void init_misc() {
     game.mouse_cursor.init();
-    game.shaders.compile_shaders();
+    if(!game.headless) {
+        game.shaders.compile_shaders();
+    }
     
     al_set_blender(ALLEGRO_ADD, ALLEGRO_ALPHA, ALLEGRO_INVERSE_ALPHA);
-    al_set_window_title(game.display, "Pikifen");
+    if(game.display) {
+        al_set_window_title(game.display, "Pikifen");
+    }
     int new_bitmap_flags = ALLEGRO_NO_PREMULTIPLIED_ALPHA;
+    if(game.headless) {
+        //With no display, bitmaps can only live in memory.
+        enable_flag(new_bitmap_flags, ALLEGRO_MEMORY_BITMAP);
+    }
     if(game.options.advanced.smooth_scaling) {
         enable_flag(new_bitmap_flags, ALLEGRO_MAG_LINEAR);
         enable_flag(new_bitmap_flags, ALLEGRO_MIN_LINEAR);
@@ -918,8 +952,18 @@ void init_misc() {
         enable_flag(new_bitmap_flags, ALLEGRO_MIPMAP);
     }
     al_set_new_bitmap_flags(new_bitmap_flags);
+    if(!game.headless) {
+        game.sector_textures.start();
+    }
     al_reserve_samples(16);
     
+    game.content.bitmaps.list.set_cache_budget(
+        game.options.advanced.bitmap_cache_mb * 1024 * 1024
+    );
+    game.content.sounds.list.set_cache_budget(
+        game.options.advanced.sample_cache_mb * 1024 * 1024
+    );
+    
     al_identity_transform(&game.identity_transform);
     
     game.rng.init();
@@ -1069,7 +1113,7 @@ void init_mob_actions() {
         mob_action_loaders::arachnorb_plan_logic
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("operand", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("operation", MOB_ACTION_PARAM_ENUM, true, false);
     reg_param("operand", MOB_ACTION_PARAM_FLOAT, false, false);
@@ -1141,7 +1185,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("center x", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("center y", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("target x", MOB_ACTION_PARAM_FLOAT, false, false);
@@ -1153,7 +1197,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("info", MOB_ACTION_PARAM_STRING, true, false);
     reg_action(
         MOB_ACTION_GET_AREA_INFO,
@@ -1169,8 +1213,12 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("x destination var name", MOB_ACTION_PARAM_STRING, true, false);
-    reg_param("y destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param(
+        "x destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false
+    );
+    reg_param(
+        "y destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false
+    );
     reg_param("angle", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("distance", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_action(
@@ -1180,7 +1228,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("center x", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("center y", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("target x", MOB_ACTION_PARAM_FLOAT, false, false);
@@ -1192,7 +1240,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("info", MOB_ACTION_PARAM_STRING, true, false);
     reg_action(
         MOB_ACTION_GET_EVENT_INFO,
@@ -1201,7 +1249,7 @@ void init_mob_actions() {
         mob_action_loaders::get_event_info
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("x", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("y", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_action(
@@ -1211,7 +1259,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("focused mob's var name", MOB_ACTION_PARAM_STRING, true, false);
     reg_action(
         MOB_ACTION_GET_FOCUS_VAR,
@@ -1220,7 +1268,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("target", MOB_ACTION_PARAM_STRING, true, false);
     reg_param("info", MOB_ACTION_PARAM_STRING, true, false);
     reg_action(
@@ -1230,7 +1278,7 @@ void init_mob_actions() {
         mob_action_loaders::get_mob_info
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("minimum value", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_param("maximum value", MOB_ACTION_PARAM_FLOAT, false, false);
     reg_action(
@@ -1240,7 +1288,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("minimum value", MOB_ACTION_PARAM_INT, false, false);
     reg_param("maximum value", MOB_ACTION_PARAM_INT, false, false);
     reg_action(
@@ -1337,7 +1385,7 @@ void init_mob_actions() {
     
     reg_param("sound data", MOB_ACTION_PARAM_ENUM, true, false);
     reg_param(
-        "sound ID destination var name", MOB_ACTION_PARAM_STRING, true, true
+        "sound ID destination var name", MOB_ACTION_PARAM_VAR_NAME, true, true
     );
     reg_action(
         MOB_ACTION_PLAY_SOUND,
@@ -1571,7 +1619,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("destination var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("destination var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_param("value", MOB_ACTION_PARAM_STRING, false, false);
     reg_action(
         MOB_ACTION_SET_VAR,
@@ -1580,7 +1628,7 @@ void init_mob_actions() {
         nullptr
     );
     
-    reg_param("var name", MOB_ACTION_PARAM_STRING, true, false);
+    reg_param("var name", MOB_ACTION_PARAM_VAR_NAME, true, false);
     reg_action(
         MOB_ACTION_SHOW_MESSAGE_FROM_VAR,
         "show_message_from_var",
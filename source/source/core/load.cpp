@@ -16,6 +16,7 @@
 
 #include "../content/other/spike_damage.h"
 #include "../util/allegro_utils.h"
+#include "../util/archive_utils.h"
 #include "../util/general_utils.h"
 #include "../util/string_utils.h"
 #include "const.h"
@@ -131,13 +132,19 @@ ALLEGRO_BITMAP* load_bmp(
 
 
 /**
- * @brief Loads a data file from the game's content.
+ * @brief Loads a data file from the game's content. If the content manager
+ * already parsed the file ahead of time, that result is used instead.
  *
  * @param file_path Path to the file, relative to the program root folder.
+ * @param report_errors If true, report an error if the file can't be opened.
+ * @return The data file's root node.
  */
-DataNode load_data_file(const string &file_path) {
-    DataNode n = DataNode(file_path);
-    if(!n.fileWasOpened) {
+DataNode load_data_file(const string &file_path, bool report_errors) {
+    DataNode n;
+    if(!game.content.take_prefetched_data_file(file_path, &n)) {
+        load_data_file_contents(file_path, &n);
+    }
+    if(!n.fileWasOpened && report_errors) {
         game.errors.report(
             "Could not open data file \"" + file_path + "\"!"
         );
@@ -147,6 +154,39 @@ DataNode load_data_file(const string &file_path) {
 }
 
 
+/**
+ * @brief Reads and parses a data file from the game's content.
+ * If the option is enabled, this uses the compiled copy of the file in the
+ * data file cache, or creates one if it's missing or outdated.
+ * Files inside of an archive get their own spot in the cache, named after
+ * the archive and the file's path inside it, so they never share a compiled
+ * copy with a loose file of the same path.
+ * This is safe to call from worker threads.
+ *
+ * @param file_path Path to the file, relative to the program root folder.
+ * @param out_node The file's root node is returned here.
+ */
+void load_data_file_contents(const string &file_path, DataNode* out_node) {
+    if(game.options.advanced.data_file_cache) {
+        string cache_key = file_path;
+        string rel_path;
+        if(find_file_archive(file_path, &rel_path) && !rel_path.empty()) {
+            string std_path = standardize_path(file_path);
+            string mount_path =
+                std_path.substr(0, std_path.size() - rel_path.size() - 1);
+            cache_key =
+                mount_path + "." + FILE_ARCHIVE_EXTENSION + "/" + rel_path;
+        }
+        out_node->loadFileWithCache(
+            file_path,
+            FOLDER_PATHS_FROM_ROOT::DATA_FILE_CACHE + "/" + cache_key + ".bin"
+        );
+    } else {
+        out_node->loadFile(file_path);
+    }
+}
+
+
 /**
  * @brief Loads a font from the disk. If it's a bitmap it'll load it from
  * the bitmap and map the characters according to the ranges provided.
@@ -283,7 +323,9 @@ void load_maker_tools() {
 void load_misc_graphics() {
     //Icon.
     game.sys_content.bmp_icon = game.content.bitmaps.list.get(game.sys_content_names.bmp_icon);
-    al_set_display_icon(game.display, game.sys_content.bmp_icon);
+    if(game.display) {
+        al_set_display_icon(game.display, game.sys_content.bmp_icon);
+    }
     
     //Graphics.
     game.sys_content.bmp_menu_icons =
@@ -550,6 +592,8 @@ void unload_misc_resources() {
     al_destroy_font(game.sys_content.fnt_slim);
     al_destroy_font(game.sys_content.fnt_standard);
     al_destroy_font(game.sys_content.fnt_value);
+    game.text_bitmap_cache.clear();
+    game.text_layout_cache.clear();
     
     //Sounds effects.
     game.content.sounds.list.free(game.sys_content.sound_attack);
@@ -35,7 +35,8 @@ ALLEGRO_BITMAP* load_bmp(
     bool report_error = true, bool error_bmp_on_error = true,
     bool error_bmp_on_empty = true
 );
-DataNode load_data_file(const string &file_path);
+DataNode load_data_file(const string &file_path, bool report_errors = true);
+void load_data_file_contents(const string &file_path, DataNode* out_node);
 void load_maker_tools();
 ALLEGRO_FONT* load_font(
     const string &file_name, int n, const int ranges[], int size
@@ -70,12 +70,13 @@ bool MakerTools::handle_gameplay_player_action(const PlayerAction &action) {
             sanitize_file_name(game.cur_area_data->name) +
             "_" + get_current_time(true) + ".png";
             
-        if(!al_save_bitmap(file_name.c_str(), bmp)) {
+        if(!bmp || !al_save_bitmap(file_name.c_str(), bmp)) {
             game.errors.report(
                 "Could not save the area onto an image,"
                 " with the name \"" + file_name + "\"!"
             );
         }
+        if(bmp) al_destroy_bitmap(bmp);
         
         game.maker_tools.used_helping_tools = true;
         break;
@@ -204,6 +205,11 @@ bool MakerTools::handle_gameplay_player_action(const PlayerAction &action) {
         game.maker_tools.used_helping_tools = true;
         break;
         
+    } case PLAYER_ACTION_TYPE_MT_PERF_OVERLAY: {
+
+        game.maker_tools.perf_overlay = !game.maker_tools.perf_overlay;
+        break;
+        
     } case PLAYER_ACTION_TYPE_MT_SHOW_COLLISION: {
 
         game.maker_tools.collision =
@@ -294,6 +300,24 @@ bool MakerTools::handle_global_player_action(const PlayerAction &action) {
         game.maker_tools.used_helping_tools = true;
         break;
         
+    } case PLAYER_ACTION_TYPE_MT_SAVE_PERF_TRACE: {
+
+        if(!game.perf_mon) {
+            print_info("The performance monitor is disabled.", 2.0f, 2.0f);
+        } else if(game.perf_mon->save_trace()) {
+            print_info(
+                "Saved the performance trace in the user data folder.",
+                2.0f, 2.0f
+            );
+        } else {
+            print_info(
+                "Could not save the performance trace! "
+                "Make sure it is enabled in the maker tools.",
+                2.0f, 2.0f
+            );
+        }
+        break;
+        
     } case PLAYER_ACTION_TYPE_MT_SET_SONG_POS_NEAR_LOOP: {
 
         game.audio.set_song_pos_near_loop();
@@ -383,6 +407,11 @@ void MakerTools::load_from_data_node(DataNode* node) {
         DataNode* perf_mon_node = node->getChildByName("performance_monitor");
         ReaderSetter rs(perf_mon_node);
         rs.set("enabled", use_perf_mon);
+        rs.set("trace_size", perf_mon_trace_size);
+        rs.set("trace_frame_budget", perf_mon_trace_frame_budget);
+        rs.set("mob_type_costs", perf_mon_mob_type_costs);
+        rs.set("script_costs", perf_mon_script_costs);
+        rs.set("sampling_interval", perf_mon_sampling_interval);
     }
 }
 
@@ -473,5 +502,10 @@ void MakerTools::save_to_data_node(DataNode* node) {
         DataNode* perf_mon_node = node->addNew("performance_monitor");
         GetterWriter pgw(perf_mon_node);
         pgw.get("enabled", use_perf_mon);
+        pgw.get("trace_size", perf_mon_trace_size);
+        pgw.get("trace_frame_budget", perf_mon_trace_frame_budget);
+        pgw.get("mob_type_costs", perf_mon_mob_type_costs);
+        pgw.get("script_costs", perf_mon_script_costs);
+        pgw.get("sampling_interval", perf_mon_sampling_interval);
     }
 }
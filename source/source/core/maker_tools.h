@@ -60,6 +60,12 @@ enum MAKER_TOOL_TYPE {
     //Show path info.
     MAKER_TOOL_TYPE_PATH_INFO,
     
+    //Show the performance overlay.
+    MAKER_TOOL_TYPE_PERF_OVERLAY,
+    
+    //Save the performance monitor's trace.
+    MAKER_TOOL_TYPE_SAVE_PERF_TRACE,
+    
     //Set song position near loop.
     MAKER_TOOL_TYPE_SET_SONG_POS_NEAR_LOOP,
     
@@ -160,9 +166,32 @@ struct MakerTools {
     //Show path info?
     bool path_info = false;
     
+    //Show the performance overlay?
+    bool perf_overlay = false;
+    
     //Use the performance monitor?
     bool use_perf_mon = false;
     
+    //How many of the latest events the performance monitor's trace keeps.
+    //0 to disable the trace.
+    size_t perf_mon_trace_size = 0;
+    
+    //If a frame takes longer than this, in seconds, the performance
+    //monitor's trace is saved. 0 to never do this.
+    float perf_mon_trace_frame_budget = 0.0f;
+    
+    //Should the performance monitor keep track of how much each
+    //object type costs?
+    bool perf_mon_mob_type_costs = false;
+    
+    //Should the performance monitor keep track of how much each
+    //script event and action costs?
+    bool perf_mon_script_costs = false;
+    
+    //If not 0, the performance monitor works in sampling mode, and this
+    //is the time between samples, in seconds.
+    float perf_mon_sampling_interval = 0.0f;
+    
     //Has the player made use of any tools that could help them play?
     bool used_helping_tools = false;
     
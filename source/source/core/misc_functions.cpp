@@ -51,15 +51,12 @@ bool are_walls_between(
     const Point &p1, const Point &p2,
     float ignore_walls_below_z, bool* out_impassable_walls
 ) {
-    Point bb_tl = p1;
-    Point bb_br = p1;
-    update_min_max_coords(bb_tl, bb_br, p2);
-    
-    set<Edge*> candidate_edges;
+    //Each thread keeps its own list, so that it doesn't need to be
+    //reallocated for every check.
+    static thread_local vector<Edge*> candidate_edges;
     if(
-        !game.cur_area_data->bmap.get_edges_in_region(
-            bb_tl, bb_br,
-            candidate_edges
+        !game.cur_area_data->bmap.get_edges_near_line_seg(
+            p1, p2, candidate_edges
         )
     ) {
         //Somehow out of bounds.
@@ -116,17 +113,20 @@ bool are_walls_between(
  * @brief Clears the textures of the area's sectors from memory.
  */
 void clear_area_textures() {
+    game.sector_textures.clear();
     if(!game.cur_area_data) return;
     
     for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
         Sector* s_ptr = game.cur_area_data->sectors[s];
         if(
             s_ptr->texture_info.bitmap &&
-            s_ptr->texture_info.bitmap != game.bmp_error
+            s_ptr->texture_info.bitmap != game.bmp_error &&
+            s_ptr->texture_info.bitmap !=
+            game.sector_textures.get_placeholder()
         ) {
             game.content.bitmaps.list.free(s_ptr->texture_info.bmp_name);
-            s_ptr->texture_info.bitmap = nullptr;
         }
+        s_ptr->texture_info.bitmap = nullptr;
     }
 }
 
@@ -172,7 +172,9 @@ void crash(const string &reason, const string &info, int exit_status) {
         i2s(game.states.gameplay->mobs.all.size()) + ". Particle count: " +
         i2s(game.states.gameplay->particles.get_count()) + ".\n" +
         "  Bitmaps loaded: " + i2s(game.content.bitmaps.list.get_list_size()) + " (" +
-        i2s(game.content.bitmaps.list.get_total_uses()) + " total uses).\n" +
+        i2s(game.content.bitmaps.list.get_total_uses()) + " total uses, " +
+        i2s(game.content.bitmaps.list.get_cache_size() / 1024) +
+        " KiB cached).\n" +
         "  Current area: ";
         
     if(game.cur_area_data && !game.cur_area_data->name.empty()) {
@@ -395,25 +397,18 @@ bool does_edge_have_wall_shadow(
  * @return The mob.
  */
 Mob* get_closest_mob_to_cursor(bool must_have_health) {
-    Distance closest_mob_to_cursor_dist;
-    Mob* closest_mob_to_cursor = nullptr;
-    
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m_ptr = game.states.gameplay->mobs.all[m];
-        
+    const auto is_candidate = [must_have_health] (Mob * m_ptr) {
         bool has_health = m_ptr->health > 0.0f && m_ptr->max_health > 0.0f;
-        if(must_have_health && !has_health) continue;
-        if(m_ptr->is_stored_inside_mob()) continue;
-        if(!m_ptr->fsm.cur_state) continue;
-        
-        Distance d = Distance(game.mouse_cursor.w_pos, m_ptr->pos);
-        if(!closest_mob_to_cursor || d < closest_mob_to_cursor_dist) {
-            closest_mob_to_cursor = m_ptr;
-            closest_mob_to_cursor_dist = d;
-        }
-    }
+        if(must_have_health && !has_health) return false;
+        if(m_ptr->is_stored_inside_mob()) return false;
+        if(!m_ptr->fsm.cur_state) return false;
+        return true;
+    };
     
-    return closest_mob_to_cursor;
+    return
+        game.states.gameplay->get_closest_mob(
+            game.mouse_cursor.w_pos, MOB_CATEGORY_NONE, is_candidate
+        );
 }
 
 
@@ -485,6 +480,72 @@ float get_liquid_limit_length(Edge* e_ptr) {
 }
 
 
+/**
+ * @brief Returns an estimate of how much memory each of the engine's
+ * bigger subsystems uses, in bytes. Bitmaps are counted by their size
+ * in pixels, whether they are in video memory or not.
+ *
+ * @param out_usage The name of each subsystem, and how much memory it uses,
+ * are returned here.
+ */
+void get_memory_usage_report(vector<std::pair<string, size_t> > &out_usage) {
+    out_usage.clear();
+    
+    size_t geometry_size = 0;
+    size_t blockmap_size = 0;
+    if(game.cur_area_data) {
+        geometry_size = game.cur_area_data->get_memory_usage();
+        blockmap_size = game.cur_area_data->bmap.get_memory_usage();
+    }
+    out_usage.push_back(std::make_pair("Area geometry", geometry_size));
+    out_usage.push_back(std::make_pair("Blockmap", blockmap_size));
+    
+    size_t anim_dbs_size = 0;
+    for(const auto &db : game.content.global_anim_dbs.list) {
+        anim_dbs_size += db.second.get_memory_usage();
+    }
+    for(size_t c = 0; c < game.content.mob_anim_dbs.list.size(); c++) {
+        for(const auto &db : game.content.mob_anim_dbs.list[c]) {
+            anim_dbs_size += db.second.get_memory_usage();
+        }
+    }
+    out_usage.push_back(std::make_pair("Animation databases", anim_dbs_size));
+    
+    out_usage.push_back(
+        std::make_pair(
+            "Bitmaps", game.content.bitmaps.list.get_total_size()
+        )
+    );
+    out_usage.push_back(
+        std::make_pair(
+            "Sprite atlas",
+            game.states.gameplay->get_sprite_atlas_memory_usage()
+        )
+    );
+    out_usage.push_back(
+        std::make_pair(
+            "Sound samples", game.content.sounds.list.get_total_size()
+        )
+    );
+    out_usage.push_back(
+        std::make_pair(
+            "Particles", game.states.gameplay->particles.get_memory_usage()
+        )
+    );
+    out_usage.push_back(
+        std::make_pair(
+            "Replay", game.states.gameplay->gameplay_replay.get_memory_usage()
+        )
+    );
+    out_usage.push_back(
+        std::make_pair(
+            "Area editor undo history",
+            game.states.area_ed->get_undo_history_memory_usage()
+        )
+    );
+}
+
+
 /**
  * @brief Returns the name of the entry in a player records data file that
  * refers to the given area.
@@ -519,8 +580,12 @@ Mob* get_next_mob_near_cursor(Mob* pivot, bool must_have_health) {
     vector<Mob*> mobs_near_cursor;
     
     //First, get all mobs that are close to the cursor.
-    for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-        Mob* m_ptr = game.states.gameplay->mobs.all[m];
+    vector<Mob*> candidates;
+    game.states.gameplay->get_mobs_in_radius(
+        game.mouse_cursor.w_pos, 8.0f, candidates
+    );
+    for(size_t m = 0; m < candidates.size(); m++) {
+        Mob* m_ptr = candidates[m];
         
         bool has_health = m_ptr->health > 0.0f && m_ptr->max_health > 0.0f;
         if(must_have_health && !has_health) continue;
@@ -1201,61 +1266,35 @@ void save_options() {
  * In other words, dumps a screenshot.
  */
 void save_screenshot() {
-    string base_file_name = "screenshot_" + get_current_time(true);
+    //Screenshots are named after the current time. Instead of checking the
+    //folder for a free name, keep count of the screenshots taken within
+    //the same second, since those are the only ones that can clash.
+    static string prev_base_file_name;
+    static size_t variant_nr = 1;
     
-    //Check if a file with this name already exists.
-    vector<string> files = folder_to_vector(FOLDER_PATHS_FROM_ROOT::USER_DATA, false);
-    size_t variant_nr = 1;
+    string base_file_name = "screenshot_" + get_current_time(true);
     string final_file_name = base_file_name;
-    bool valid_name = false;
-    
-    do {
-    
-        if(
-            find(files.begin(), files.end(), final_file_name + ".png")
-            == files.end()
-        ) {
-            //File name not found.
-            //Go ahead and create a screenshot with this name.
-            valid_name = true;
-        } else {
-            variant_nr++;
-            final_file_name = base_file_name + " " + i2s(variant_nr);
-        }
-        
-    } while(!valid_name);
+    if(base_file_name == prev_base_file_name) {
+        variant_nr++;
+        final_file_name += " " + i2s(variant_nr);
+    } else {
+        prev_base_file_name = base_file_name;
+        variant_nr = 1;
+    }
     
-    //Before saving, let's set every pixel's alpha to 255.
-    //This is because alpha operations on the backbuffer behave weirdly.
-    //On some machines, when saving to a bitmap, it will use those weird
-    //alpha values, which may be harmless on the backbuffer, but not so much
-    //on a saved PNG file.
+    //Copy the backbuffer into a memory bitmap, which is quick, and
+    //leave the slow encoding and writing to the background file writer.
+    int prev_bmp_flags = al_get_new_bitmap_flags();
+    al_set_new_bitmap_flags(ALLEGRO_MEMORY_BITMAP);
     ALLEGRO_BITMAP* screenshot =
         al_clone_bitmap(al_get_backbuffer(game.display));
-    ALLEGRO_LOCKED_REGION* region =
-        al_lock_bitmap(
-            screenshot,
-            ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READWRITE
-        );
-        
-    unsigned char* row = (unsigned char*) region->data;
-    int bmp_w = ceil(al_get_bitmap_width(screenshot));
-    int bmp_h = ceil(al_get_bitmap_height(screenshot));
-    for(int y = 0; y < bmp_h; y++) {
-        for(int x = 0; x < bmp_w; x++) {
-            row[(x) * 4 + 3] = 255;
-        }
-        row += region->pitch;
-    }
+    al_set_new_bitmap_flags(prev_bmp_flags);
+    if(!screenshot) return;
     
-    al_unlock_bitmap(screenshot);
-    
-    al_save_bitmap(
-        (FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + final_file_name + ".png").c_str(),
-        screenshot
+    game.file_writer.write_bitmap(
+        screenshot,
+        FOLDER_PATHS_FROM_ROOT::USER_DATA + "/" + final_file_name + ".png"
     );
-    
-    al_destroy_bitmap(screenshot);
 }
 
 
@@ -1310,7 +1349,9 @@ void set_string_token_widths(
         switch(tokens[t].type) {
         case STRING_TOKEN_CHAR: {
             tokens[t].width =
-                al_get_text_width(text_font, tokens[t].content.c_str());
+                game.text_layout_cache.get_glyph_width(
+                    text_font, tokens[t].content
+                );
             break;
         } case STRING_TOKEN_CONTROL_BIND: {
             tokens[t].content = trim_spaces(tokens[t].content);
@@ -115,6 +115,7 @@ ALLEGRO_COLOR get_ledge_smoothing_color(Edge* e_ptr);
 ALLEGRO_COLOR get_liquid_limit_color(Edge* e_ptr);
 float get_ledge_smoothing_length(Edge* e_ptr);
 float get_liquid_limit_length(Edge* e_ptr);
+void get_memory_usage_report(vector<std::pair<string, size_t> > &out_usage);
 string get_mission_record_entry_name(Area* area_ptr);
 void get_next_edge(
     Vertex* v_ptr, float pivot_angle, bool clockwise,
@@ -221,7 +222,13 @@ string unescape_string(const string &s);
 void update_offset_effect_buffer(
     const Point &cam_tl, const Point &cam_br,
     const vector<EdgeOffsetCache> &caches, ALLEGRO_BITMAP* buffer,
-    bool clear_first
+    bool clear_first, const Blockmap* bmap, float buffer_scale = 1.0f
+);
+void update_offset_effect_cache(
+    EdgeOffsetCache &cache, Edge* e_ptr,
+    offset_effect_checker_t checker,
+    offset_effect_length_getter_t length_getter,
+    offset_effect_color_getter_t color_getter
 );
 void update_offset_effect_caches (
     vector<EdgeOffsetCache> &caches,
@@ -12,12 +12,23 @@
 #undef _CMATH_
 
 #include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
 #include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #include "misc_structs.h"
 
 #include "../util/allegro_utils.h"
+#include "../util/archive_utils.h"
+#include "../util/code_debug.h"
 #include "../util/general_utils.h"
 #include "../util/string_utils.h"
 #include "const.h"
@@ -27,6 +38,59 @@
 #include "misc_functions.h"
 
 
+namespace ADAPTIVE_QUALITY {
+
+//Frames must be over budget for this long before the quality is lowered.
+const float DOWNGRADE_DELAY = 0.5f;
+
+//Frames that take less than this much of the budget have plenty of headroom.
+const float HEADROOM_RATIO = 0.6f;
+
+//Number of quality levels, including full quality.
+const unsigned char N_LEVELS = 4;
+
+//For each level, scale of the offset effect buffers, compared to the window.
+const float OFFSET_EFFECT_SCALES[] = { 1.0f, 1.0f, 0.5f, 0.5f };
+
+//For each level, how much of the maximum number of particles can be alive.
+const float PARTICLE_BUDGET_RATIOS[] = { 1.0f, 0.5f, 0.5f, 0.25f };
+
+//Frames must have plenty of headroom for this long before the quality
+//is raised.
+const float UPGRADE_DELAY = 5.0f;
+
+//Wall shadows are skipped starting at this level.
+const unsigned char WALL_SHADOWS_MIN_LEVEL = 3;
+
+}
+
+
+namespace AREA_PRELOADER {
+
+//An area whose data files add up to more than this many bytes isn't
+//preloaded, so that an area that's just being browsed past can't hold on
+//to too much memory.
+const size_t MAX_TOTAL_FILE_SIZE = 32 * 1024 * 1024;
+
+}
+
+
+namespace BACKGROUND_FILE_WRITER {
+
+//Suffix added to a file's path to get the path of its temporary file.
+const string TEMP_SUFFIX = ".tmp";
+
+}
+
+
+namespace DEBUG_DRAW_BATCH {
+
+//Number of segments that make up a circle.
+const unsigned char CIRCLE_SEGMENTS = 24;
+
+}
+
+
 namespace GAMEPLAY_MSG_BOX {
 
 //How quickly the advance button icon fades, in alpha (0-1) per second.
@@ -70,6 +134,89 @@ const float FADE_SPEED = 4.0f;
 }
 
 
+namespace PERFORMANCE_MONITOR {
+
+//How many histogram buckets cover each doubling of the duration.
+const size_t HISTOGRAM_BUCKETS_PER_DOUBLING = 8;
+
+//Durations in the first histogram bucket are shorter than this, in seconds.
+const double HISTOGRAM_MIN_DURATION = 0.000001;
+
+//Total number of histogram buckets. Enough to go past a minute.
+const size_t HISTOGRAM_NR_BUCKETS = 240;
+
+//How many of the object types that took the longest to write in the results.
+const size_t N_HOTTEST_MOB_TYPES = 10;
+
+//How many of the script events and actions that took the longest to write
+//in the log.
+const size_t N_HOTTEST_SCRIPT_COSTS = 20;
+
+//Percentile of the frame times to write in the results, from 0 to 1.
+const float REPORT_PERCENTILE = 0.99f;
+
+//In sampling mode, measurements nested deeper than this aren't sampled.
+const size_t SAMPLING_MAX_DEPTH = 32;
+
+}
+
+
+namespace SAMPLE_MANAGER {
+
+//Compressed audio files at least this big, in bytes, are kept compressed
+//in memory, and decoded as they play.
+const size_t COMPRESSED_MIN_FILE_SIZE = 256 * 1024;
+
+//Number of buffers in the stream of a sample that's kept compressed.
+const size_t STREAM_BUFFER_COUNT = 4;
+
+//Size of each buffer in the stream of a sample that's kept compressed,
+//in sample frames.
+const unsigned int STREAM_BUFFER_SAMPLES = 2048;
+
+}
+
+
+namespace SECTOR_TEXTURE_STREAMER {
+
+//Textures with a side at least this long use the lower quality tiers,
+//if chosen. Smaller ones don't save enough to be worth it.
+const int LOWER_QUALITY_MIN_SIZE = 256;
+
+//Color of the texture used while a sector's real texture is still loading.
+const unsigned char PLACEHOLDER_COLOR[3] = {128, 128, 128};
+
+//Maximum time to spend turning decoded textures into video bitmaps
+//each frame, in seconds. At least one texture is always handled.
+const double UPLOAD_BUDGET = 0.004;
+
+}
+
+
+namespace TEXT_BITMAP_CACHE {
+
+//Maximum number of text bitmaps to keep.
+const size_t MAX_TEXTS = 256;
+
+}
+
+
+namespace TEXT_LAYOUT_CACHE {
+
+//Maximum number of text layouts to keep.
+const size_t MAX_LAYOUTS = 64;
+
+}
+
+
+namespace THUMBNAIL_LOADER {
+
+//Maximum width or height of a thumbnail.
+const int SIZE = 160;
+
+}
+
+
 namespace WHISTLE {
 
 //R, G, and B components for each dot color.
@@ -127,6 +274,8 @@ const string NAMES[N_MAKER_TOOLS] = {
     "mob_info",
     "new_pikmin",
     "path_info",
+    "perf_overlay",
+    "save_perf_trace",
     "set_song_pos_near_loop",
     "teleport"
 };
@@ -242,6 +391,341 @@ void SystemContentNames::load(DataNode* file) {
 }
 
 
+/**
+ * @brief Returns the current quality level.
+ *
+ * @return The level. 0 is full quality.
+ */
+unsigned char AdaptiveQuality::get_level() const {
+    return level;
+}
+
+
+/**
+ * @brief Returns the scale the offset effect buffers should have,
+ * compared to the window size, at the current level.
+ *
+ * @return The scale.
+ */
+float AdaptiveQuality::get_offset_effect_scale() const {
+    return ADAPTIVE_QUALITY::OFFSET_EFFECT_SCALES[level];
+}
+
+
+/**
+ * @brief Returns how much of the maximum number of particles can be alive
+ * at the current level.
+ *
+ * @return The ratio, from 0 to 1.
+ */
+float AdaptiveQuality::get_particle_budget_ratio() const {
+    return ADAPTIVE_QUALITY::PARTICLE_BUDGET_RATIOS[level];
+}
+
+
+/**
+ * @brief Returns whether wall shadows should be drawn at the current level.
+ *
+ * @return Whether they should.
+ */
+bool AdaptiveQuality::has_wall_shadows() const {
+    return level < ADAPTIVE_QUALITY::WALL_SHADOWS_MIN_LEVEL;
+}
+
+
+/**
+ * @brief Goes back to full quality.
+ */
+void AdaptiveQuality::reset() {
+    level = 0;
+    over_budget_time = 0.0f;
+    headroom_time = 0.0f;
+}
+
+
+/**
+ * @brief Updates the quality level with the latest frame's information.
+ *
+ * @param work_time How long the frame's work took, in seconds,
+ * not counting time spent waiting for the display.
+ * @param budget How long each frame is meant to take at most, in seconds.
+ * @param delta_t How long the frame lasted, in seconds.
+ * @return Whether the level changed.
+ */
+bool AdaptiveQuality::update(double work_time, double budget, float delta_t) {
+    if(work_time > budget) {
+        over_budget_time += delta_t;
+        headroom_time = 0.0f;
+    } else if(work_time < budget * ADAPTIVE_QUALITY::HEADROOM_RATIO) {
+        headroom_time += delta_t;
+        over_budget_time = 0.0f;
+    } else {
+        over_budget_time = 0.0f;
+        headroom_time = 0.0f;
+    }
+    
+    if(
+        over_budget_time >= ADAPTIVE_QUALITY::DOWNGRADE_DELAY &&
+        level + 1 < ADAPTIVE_QUALITY::N_LEVELS
+    ) {
+        level++;
+        over_budget_time = 0.0f;
+        return true;
+    }
+    if(headroom_time >= ADAPTIVE_QUALITY::UPGRADE_DELAY && level > 0) {
+        level--;
+        headroom_time = 0.0f;
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief The area an area preloader has been asked to preload,
+ * and the result.
+ */
+struct AreaPreloader::SyncData {
+
+    //--- Members ---
+    
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Path to the folder of the requested area that the worker hasn't
+    //started on yet, if any.
+    string requested_path;
+    
+    //Path to the folder of the area the worker is reading right now, if any.
+    string busy_path;
+    
+    //Was the area the worker is reading right now cancelled?
+    bool busy_cancelled = false;
+    
+    //Is there a finished result?
+    bool has_result = false;
+    
+    //Path to the folder of the area the result is for.
+    string result_path;
+    
+    //Root nodes of the area's data files, in the same order as
+    //get_file_paths().
+    vector<DataNode> result_nodes;
+    
+    
+    //--- Function declarations ---
+    
+    void clear();
+    
+};
+
+
+/**
+ * @brief Forgets about the request and the result, and makes sure whatever
+ * the worker is reading right now gets thrown away. The mutex must
+ * be locked.
+ */
+void AreaPreloader::SyncData::clear() {
+    requested_path.clear();
+    if(!busy_path.empty()) busy_cancelled = true;
+    has_result = false;
+    result_path.clear();
+    result_nodes.clear();
+}
+
+
+/**
+ * @brief Constructs a new area preloader object.
+ * The worker isn't started.
+ */
+AreaPreloader::AreaPreloader() :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Constructs a new area preloader object by copying another.
+ * Worker threads can't be copied, so the new preloader starts without one.
+ *
+ * @param p2 Preloader to copy from.
+ */
+AreaPreloader::AreaPreloader(const AreaPreloader &p2) :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Copies an area preloader from another one. Worker threads
+ * can't be copied, so this one just keeps its own.
+ *
+ * @param p2 Preloader to copy from.
+ * @return The current object.
+ */
+AreaPreloader &AreaPreloader::operator =(const AreaPreloader &p2) {
+    return *this;
+}
+
+
+/**
+ * @brief Destroys the area preloader object.
+ */
+AreaPreloader::~AreaPreloader() {
+    stop();
+    delete sync;
+}
+
+
+/**
+ * @brief Cancels the preloading, if any, and throws away whatever was
+ * preloaded. This should be done whenever an area's files could have
+ * changed, like when entering the area editor.
+ */
+void AreaPreloader::cancel() {
+    worker.clear();
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->clear();
+}
+
+
+/**
+ * @brief Returns the paths to the data files of an area that get preloaded.
+ *
+ * @param area_path Path to the area's folder.
+ * @return The paths.
+ */
+vector<string> AreaPreloader::get_file_paths(const string &area_path) {
+    return
+    vector<string> {
+        area_path + "/" + FILE_NAMES::AREA_MAIN_DATA,
+        area_path + "/" + FILE_NAMES::AREA_GEOMETRY,
+    };
+}
+
+
+/**
+ * @brief Asks for an area to be preloaded. If it's already preloaded, or
+ * on its way, nothing happens. Otherwise, anything else that was
+ * preloaded is thrown away.
+ *
+ * @param area_path Path to the area's folder.
+ * @param delay Only start after this many seconds, in case the player
+ * changes their mind quickly, like when scrolling through a list.
+ */
+void AreaPreloader::request(const string &area_path, float delay) {
+    if(!worker.is_running() || area_path.empty()) return;
+    
+    {
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        if(sync->has_result && sync->result_path == area_path) return;
+        if(sync->busy_path == area_path && !sync->busy_cancelled) return;
+        if(sync->requested_path == area_path) return;
+        
+        sync->clear();
+        sync->requested_path = area_path;
+    }
+    
+    worker.clear();
+    worker.add([this, area_path] () { read(area_path); }, false, delay);
+}
+
+
+/**
+ * @brief Starts the worker thread. If it was already running,
+ * it is restarted.
+ */
+void AreaPreloader::start() {
+    stop();
+    worker.start();
+}
+
+
+/**
+ * @brief Stops the worker thread, and throws away whatever was preloaded.
+ */
+void AreaPreloader::stop() {
+    worker.stop();
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->clear();
+}
+
+
+/**
+ * @brief Returns the preloaded data files of an area, if it's the one
+ * that was preloaded. If the worker is still reading it, this waits
+ * for it, since that's quicker than starting over. Either way, the
+ * preloader is left empty.
+ *
+ * @param area_path Path to the area's folder.
+ * @param out_nodes The data files' root nodes are returned here, in the
+ * same order as get_file_paths().
+ * @return Whether the area had been preloaded.
+ */
+bool AreaPreloader::take(const string &area_path, vector<DataNode>* out_nodes) {
+    if(!worker.is_running()) return false;
+    
+    bool busy_with_it = false;
+    {
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        busy_with_it =
+            sync->busy_path == area_path && !sync->busy_cancelled;
+    }
+    worker.clear();
+    if(busy_with_it) worker.wait_for_all();
+    
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    bool found = sync->has_result && sync->result_path == area_path;
+    if(found) *out_nodes = std::move(sync->result_nodes);
+    sync->clear();
+    return found;
+}
+
+
+/**
+ * @brief Reads an area's data files. This runs on the worker thread.
+ * If the area isn't the requested one anymore, nothing happens.
+ *
+ * @param area_path Path to the area's folder.
+ */
+void AreaPreloader::read(const string &area_path) {
+    {
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        if(sync->requested_path != area_path) return;
+        sync->requested_path.clear();
+        sync->busy_path = area_path;
+        sync->busy_cancelled = false;
+    }
+    
+    vector<string> file_paths = get_file_paths(area_path);
+    vector<DataNode> nodes(file_paths.size());
+    size_t total_size = 0;
+    bool success = true;
+    for(size_t f = 0; f < file_paths.size() && success; f++) {
+        ALLEGRO_FILE* file = al_fopen(file_paths[f].c_str(), "rb");
+        if(!file) {
+            success = false;
+            break;
+        }
+        total_size += (size_t) std::max((int64_t) 0, al_fsize(file));
+        al_fclose(file);
+    }
+    if(total_size > AREA_PRELOADER::MAX_TOTAL_FILE_SIZE) success = false;
+    for(size_t f = 0; f < file_paths.size() && success; f++) {
+        load_data_file_contents(file_paths[f], &nodes[f]);
+    }
+    
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    if(success && !sync->busy_cancelled) {
+        sync->has_result = true;
+        sync->result_path = area_path;
+        sync->result_nodes = std::move(nodes);
+    }
+    sync->busy_path.clear();
+    sync->busy_cancelled = false;
+}
+
+
 /**
  * @brief Loads an audio stream for the manager.
  *
@@ -310,6 +794,20 @@ void BitmapManager::do_unload(ALLEGRO_BITMAP* asset) {
 }
 
 
+/**
+ * @brief Returns roughly how much memory a bitmap takes up, in bytes.
+ *
+ * @param asset Bitmap to check.
+ * @return The size.
+ */
+size_t BitmapManager::get_asset_size(ALLEGRO_BITMAP* asset) const {
+    if(!asset || asset == game.bmp_error) return 0;
+    return
+        (size_t) al_get_bitmap_width(asset) *
+        (size_t) al_get_bitmap_height(asset) * 4;
+}
+
+
 /**
  * @brief Instantly places the camera at the specified coordinates.
  *
@@ -373,47 +871,202 @@ void Camera::update_box() {
 
 
 /**
- * @brief Emits an error in the gameplay "info" window.
+ * @brief Adds a circle outline to the batch.
  *
- * @param s Full error description.
+ * @param center Center point.
+ * @param radius Radius.
+ * @param color Color.
+ * @param thickness Line thickness. 1 or less for a one pixel thick line.
  */
-void ErrorManager::emit_in_gameplay(const string &s) {
-    string info_str =
-        "\n\n\n"
-        "ERROR: " + s + "\n\n"
-        "(Saved to \"" + FILE_PATHS_FROM_ROOT::ERROR_LOG + "\".)\n\n";
-    print_info(info_str, 30.0f, 3.0f);
+void DebugDrawBatch::add_circle(
+    const Point &center, float radius,
+    const ALLEGRO_COLOR &color, float thickness
+) {
+    Point points[DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS];
+    for(unsigned char s = 0; s < DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS; s++) {
+        float angle = TAU / DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS * s;
+        points[s] = center + angle_to_coordinates(angle, radius);
+    }
+    add_polygon(
+        points, DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS, color, thickness
+    );
 }
 
 
 /**
- * @brief Logs an error to stdout (i.e. the console).
+ * @brief Adds a filled circle to the batch.
  *
- * @param s Full error description.
+ * @param center Center point.
+ * @param radius Radius.
+ * @param color Color.
  */
-void ErrorManager::log_to_console(const string &s) {
-    std::cout << s << std::endl;
+void DebugDrawBatch::add_filled_circle(
+    const Point &center, float radius, const ALLEGRO_COLOR &color
+) {
+    Point prev_point = center + Point(radius, 0.0f);
+    for(unsigned char s = 1; s <= DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS; s++) {
+        float angle = TAU / DEBUG_DRAW_BATCH::CIRCLE_SEGMENTS * s;
+        Point point = center + angle_to_coordinates(angle, radius);
+        add_vertex(triangle_vertexes, center, color);
+        add_vertex(triangle_vertexes, prev_point, color);
+        add_vertex(triangle_vertexes, point, color);
+        prev_point = point;
+    }
 }
 
 
 /**
- * @brief Logs an error to the log file.
+ * @brief Adds a filled axis-aligned rectangle to the batch.
  *
- * @param s Full error description.
+ * @param tl Top-left corner.
+ * @param br Bottom-right corner.
+ * @param color Color.
  */
-void ErrorManager::log_to_file(const string &s) {
-    string prev_error_log;
-    string output = "";
+void DebugDrawBatch::add_filled_rectangle(
+    const Point &tl, const Point &br, const ALLEGRO_COLOR &color
+) {
+    add_vertex(triangle_vertexes, tl, color);
+    add_vertex(triangle_vertexes, Point(br.x, tl.y), color);
+    add_vertex(triangle_vertexes, br, color);
+    add_vertex(triangle_vertexes, tl, color);
+    add_vertex(triangle_vertexes, br, color);
+    add_vertex(triangle_vertexes, Point(tl.x, br.y), color);
+}
+
+
+/**
+ * @brief Adds a line to the batch.
+ *
+ * @param p1 Starting point.
+ * @param p2 Ending point.
+ * @param color Color.
+ * @param thickness Line thickness. 1 or less for a one pixel thick line.
+ */
+void DebugDrawBatch::add_line(
+    const Point &p1, const Point &p2,
+    const ALLEGRO_COLOR &color, float thickness
+) {
+    if(thickness <= 1.0f) {
+        add_vertex(line_vertexes, p1, color);
+        add_vertex(line_vertexes, p2, color);
+        return;
+    }
     
-    //Get the previous contents of the log file, if any.
-    ALLEGRO_FILE* file_i =
-        al_fopen(FILE_PATHS_FROM_ROOT::ERROR_LOG.c_str(), "r");
-    if(file_i) {
-        while(!al_feof(file_i)) {
-            string line;
-            getline(file_i, line);
-            prev_error_log += line + "\n";
-        }
+    //A thick line is a quad along the line.
+    float angle = get_angle(p1, p2);
+    Point offset = angle_to_coordinates(angle + TAU / 4.0f, thickness / 2.0f);
+    add_vertex(triangle_vertexes, p1 + offset, color);
+    add_vertex(triangle_vertexes, p2 + offset, color);
+    add_vertex(triangle_vertexes, p2 - offset, color);
+    add_vertex(triangle_vertexes, p1 + offset, color);
+    add_vertex(triangle_vertexes, p2 - offset, color);
+    add_vertex(triangle_vertexes, p1 - offset, color);
+}
+
+
+/**
+ * @brief Adds a closed polygon outline to the batch.
+ *
+ * @param points The polygon's points, in order.
+ * @param n_points Number of points.
+ * @param color Color.
+ * @param thickness Line thickness. 1 or less for a one pixel thick line.
+ */
+void DebugDrawBatch::add_polygon(
+    const Point* points, size_t n_points,
+    const ALLEGRO_COLOR &color, float thickness
+) {
+    for(size_t p = 0; p < n_points; p++) {
+        add_line(points[p], points[(p + 1) % n_points], color, thickness);
+    }
+}
+
+
+/**
+ * @brief Adds a vertex to a list of vertexes.
+ *
+ * @param vertexes List to add to.
+ * @param p Coordinates of the vertex.
+ * @param color Color of the vertex.
+ */
+void DebugDrawBatch::add_vertex(
+    vector<ALLEGRO_VERTEX> &vertexes, const Point &p,
+    const ALLEGRO_COLOR &color
+) {
+    ALLEGRO_VERTEX v;
+    v.x = p.x;
+    v.y = p.y;
+    v.z = 0.0f;
+    v.u = 0.0f;
+    v.v = 0.0f;
+    v.color = color;
+    vertexes.push_back(v);
+}
+
+
+/**
+ * @brief Draws everything in the batch, and empties it.
+ */
+void DebugDrawBatch::flush() {
+    if(!triangle_vertexes.empty()) {
+        al_draw_prim(
+            triangle_vertexes.data(), nullptr, nullptr,
+            0, (int) triangle_vertexes.size(), ALLEGRO_PRIM_TRIANGLE_LIST
+        );
+        triangle_vertexes.clear();
+    }
+    if(!line_vertexes.empty()) {
+        al_draw_prim(
+            line_vertexes.data(), nullptr, nullptr,
+            0, (int) line_vertexes.size(), ALLEGRO_PRIM_LINE_LIST
+        );
+        line_vertexes.clear();
+    }
+}
+
+
+/**
+ * @brief Emits an error in the gameplay "info" window.
+ *
+ * @param s Full error description.
+ */
+void ErrorManager::emit_in_gameplay(const string &s) {
+    string info_str =
+        "\n\n\n"
+        "ERROR: " + s + "\n\n"
+        "(Saved to \"" + FILE_PATHS_FROM_ROOT::ERROR_LOG + "\".)\n\n";
+    print_info(info_str, 30.0f, 3.0f);
+}
+
+
+/**
+ * @brief Logs an error to stdout (i.e. the console).
+ *
+ * @param s Full error description.
+ */
+void ErrorManager::log_to_console(const string &s) {
+    std::cout << s << std::endl;
+}
+
+
+/**
+ * @brief Logs an error to the log file.
+ *
+ * @param s Full error description.
+ */
+void ErrorManager::log_to_file(const string &s) {
+    string prev_error_log;
+    string output = "";
+    
+    //Get the previous contents of the log file, if any.
+    ALLEGRO_FILE* file_i =
+        al_fopen(FILE_PATHS_FROM_ROOT::ERROR_LOG.c_str(), "r");
+    if(file_i) {
+        while(!al_feof(file_i)) {
+            string line;
+            getline(file_i, line);
+            prev_error_log += line + "\n";
+        }
         prev_error_log.erase(prev_error_log.size() - 1);
         al_fclose(file_i);
     }
@@ -606,6 +1259,37 @@ GetterWriter::GetterWriter(DataNode* dn) :
 }
 
 
+/**
+ * @brief Constructs a new getter-writer object that writes straight
+ * into a data node writer, instead of into a node.
+ *
+ * @param writer Data node writer to write to.
+ */
+GetterWriter::GetterWriter(DataNodeWriter* writer) :
+    writer(writer) {
+    
+}
+
+
+/**
+ * @brief Writes a child with the given value, into the node or
+ * the data node writer.
+ *
+ * @param child_name Name of the child node.
+ * @param value Its value.
+ * @return The new node, or nullptr if it went to a data node writer.
+ */
+DataNode* GetterWriter::add_value(
+    const string &child_name, const string &value
+) {
+    if(writer) {
+        writer->addValue(child_name, value);
+        return nullptr;
+    }
+    return node->addNew(child_name, value);
+}
+
+
 /**
  * @brief Gets a variable's value, and writes it to a child node's value.
  *
@@ -616,7 +1300,7 @@ GetterWriter::GetterWriter(DataNode* dn) :
 void GetterWriter::get(
     const string &child_name, const ALLEGRO_COLOR &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, c2s(var));
+    DataNode* new_node = add_value(child_name, c2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -631,7 +1315,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const string &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, var);
+    DataNode* new_node = add_value(child_name, var);
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -646,7 +1330,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const char* var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, var);
+    DataNode* new_node = add_value(child_name, var);
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -661,7 +1345,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const size_t &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, i2s(var));
+    DataNode* new_node = add_value(child_name, i2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -676,7 +1360,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const int &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, i2s(var));
+    DataNode* new_node = add_value(child_name, i2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -691,7 +1375,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const unsigned int &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, i2s(var));
+    DataNode* new_node = add_value(child_name, i2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -706,7 +1390,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const unsigned char &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, i2s(var));
+    DataNode* new_node = add_value(child_name, i2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -721,7 +1405,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const bool &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, b2s(var));
+    DataNode* new_node = add_value(child_name, b2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -736,7 +1420,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const float &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, f2s(var));
+    DataNode* new_node = add_value(child_name, f2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -751,7 +1435,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const double &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, f2s(var));
+    DataNode* new_node = add_value(child_name, f2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -766,7 +1450,7 @@ void GetterWriter::get(
 void GetterWriter::get(
     const string &child_name, const Point &var, DataNode** out_child_node
 ) {
-    DataNode* new_node = node->addNew(child_name, p2s(var));
+    DataNode* new_node = add_value(child_name, p2s(var));
     if(out_child_node) *out_child_node = new_node;
 }
 
@@ -776,6 +1460,7 @@ void GetterWriter::get(
  * @brief Hides the OS mouse in the game window.
  */
 void MouseCursor::hide() const {
+    if(!game.display) return;
     al_hide_mouse_cursor(game.display);
 }
 
@@ -819,6 +1504,7 @@ void MouseCursor::reset() {
  * @brief Shows the OS mouse in the game window.
  */
 void MouseCursor::show() const {
+    if(!game.display) return;
     al_show_mouse_cursor(game.display);
 }
 
@@ -986,6 +1672,49 @@ void Notification::tick(float delta_t) {
 }
 
 
+/**
+ * @brief The sampling thread of a performance monitor, the stack of
+ * measurements it peeks at, and the samples it took.
+ */
+struct PerformanceMonitor::SamplingData {
+
+    //--- Members ---
+    
+    //Sampling thread.
+    std::thread worker;
+    
+    //Controls access to the stopping flag and to the samples.
+    std::mutex mutex;
+    
+    //Signals the sampling thread that it should stop.
+    std::condition_variable stop_cond;
+    
+    //Is the sampling thread meant to stop?
+    bool stopping = false;
+    
+    //Time between samples.
+    std::chrono::duration<double> interval;
+    
+    //State the main thread is in, or INVALID if none.
+    std::atomic<size_t> state = INVALID;
+    
+    //IDs of the measurements the main thread is currently in, from
+    //outermost to innermost. Only the main thread writes to this, and it
+    //doesn't wait for the sampling thread, so a sample taken in the middle
+    //of a change can be a bit off. That's fine for a statistical profile.
+    std::atomic<size_t> stack[PERFORMANCE_MONITOR::SAMPLING_MAX_DEPTH];
+    
+    //How many measurements the main thread is currently in. This can go
+    //past the stack's size, in which case the deepest ones aren't sampled.
+    std::atomic<size_t> depth = 0;
+    
+    //How many times each stack was sampled. The first number in the stack
+    //is the state, and the rest are measurement IDs.
+    map<vector<size_t>, size_t> samples;
+    
+};
+
+
 /**
  * @brief Constructs a new performance monitor struct object.
  */
@@ -993,13 +1722,144 @@ PerformanceMonitor::PerformanceMonitor() :
     cur_state(PERF_MON_STATE_LOADING),
     paused(false),
     cur_state_start_time(0.0),
-    cur_measurement_start_time(0.0),
     frame_samples(0) {
     
+    measurement_names.insert(
+        measurement_names.end(),
+    {
+        "Area -- Data",
+        "Area -- Vertexes",
+        "Area -- Edges",
+        "Area -- Sectors",
+        "Area -- Object generators",
+        "Area -- Paths",
+        "Area -- Tree shadows",
+        "Area -- Geometry calculations",
+        "Object generation",
+        "Object -- Brain",
+        "Object -- Physics",
+        "Object -- Misc. logic",
+        "Object -- Animation",
+        "Object -- Script",
+        "Object -- Misc. specifics",
+        "Objects -- Animation advancing",
+        "Objects -- Interaction detection",
+        "Objects -- Pushes",
+        "Objects -- Interactions",
+        "Objects -- Touching others",
+        "Objects -- Interaction results",
+        "Logic -- Current leader",
+        "Logic -- Particles",
+        "Logic -- Sector animation",
+        "Drawing -- Background",
+        "Drawing -- World",
+        "Drawing -- In-game text",
+        "Drawing -- precipitation",
+        "Drawing -- Tree shadows",
+        "Drawing -- Lighting",
+        "Drawing -- HUD",
+        "Unloading -- Objects",
+        "Unloading -- Content",
+    }
+    );
+    engine_assert(
+        measurement_names.size() == N_PERF_MON_MEASUREMENTS,
+        i2s(measurement_names.size()) + " measurement names for " +
+        i2s(N_PERF_MON_MEASUREMENTS) + " measurements!"
+    );
+    for(size_t m = 0; m < measurement_names.size(); m++) {
+        measurement_ids[measurement_names[m]] = m;
+    }
+    measurement_depths.assign(measurement_names.size(), INVALID);
+    
     reset();
 }
 
 
+/**
+ * @brief Destroys the performance monitor struct object.
+ */
+PerformanceMonitor::~PerformanceMonitor() {
+    set_sampling_interval(0.0f);
+}
+
+
+/**
+ * @brief Adds an estimate of how much memory each subsystem uses,
+ * keeping the highest one of each.
+ *
+ * @param report Name of each subsystem, and how much memory it uses,
+ * in bytes.
+ */
+void PerformanceMonitor::add_memory_report(
+    const vector<std::pair<string, size_t> > &report
+) {
+    for(size_t r = 0; r < report.size(); r++) {
+        bool found = false;
+        for(size_t p = 0; p < peak_memory_report.size(); p++) {
+            if(peak_memory_report[p].first != report[r].first) continue;
+            peak_memory_report[p].second =
+                std::max(peak_memory_report[p].second, report[r].second);
+            found = true;
+            break;
+        }
+        if(!found) peak_memory_report.push_back(report[r]);
+    }
+}
+
+
+/**
+ * @brief Adds how long a script action took to run, for the script profiler.
+ *
+ * @param action_name Name of the action.
+ * @param dur How long it took, in seconds.
+ */
+void PerformanceMonitor::add_script_action_cost(
+    const string* action_name, double dur
+) {
+    if(paused || !script_costs) return;
+    cur_frame_script_action_costs[get_name_copy(action_name)].add(1, dur);
+}
+
+
+/**
+ * @brief Adds how long a script event took to run, for the script profiler.
+ *
+ * @param mob_type_name Name of the type of object that ran it.
+ * @param state_name Name of the state the object was in, if any.
+ * @param event_type Type of event.
+ * @param dur How long it took, in seconds. This includes any events
+ * that it caused to run in turn.
+ */
+void PerformanceMonitor::add_script_event_cost(
+    const string* mob_type_name, const string* state_name,
+    size_t event_type, double dur
+) {
+    if(paused || !script_costs) return;
+    ScriptEventKey key;
+    key.mob_type_name = get_name_copy(mob_type_name);
+    key.state_name = get_name_copy(state_name);
+    key.event_type = event_type;
+    cur_frame_script_event_costs[key].add(1, dur);
+}
+
+
+/**
+ * @brief Adds an event to the trace's ring buffer, overwriting the oldest
+ * one if it's full.
+ *
+ * @param event Event to add.
+ */
+void PerformanceMonitor::add_trace_event(const TraceEvent &event) {
+    trace_events[trace_next_idx] = event;
+    trace_next_idx++;
+    if(trace_next_idx == trace_events.size()) {
+        trace_next_idx = 0;
+        trace_wrapped = true;
+    }
+}
+
+
 /**
  * @brief Enters the given state of the monitoring process.
  *
@@ -1008,9 +1868,25 @@ PerformanceMonitor::PerformanceMonitor() :
 void PerformanceMonitor::enter_state(const PERF_MON_STATE state) {
     if(paused) return;
     
+    if(sampling) {
+        sampling->state.store(state, std::memory_order_release);
+        return;
+    }
+    
     cur_state = state;
     cur_state_start_time = al_get_time();
     cur_page = Page();
+    cur_frame_mob_type_durs.clear();
+    cur_frame_script_event_costs.clear();
+    cur_frame_script_action_costs.clear();
+    cur_state_start_busy_times.resize(game.jobs.get_nr_workers());
+    for(size_t w = 0; w < cur_state_start_busy_times.size(); w++) {
+        cur_state_start_busy_times[w] = game.jobs.get_busy_time(w);
+    }
+    if(code_debug_alloc_counting) {
+        cur_state_start_alloc_nr = code_debug_alloc_nr.load();
+        cur_state_start_alloc_bytes = code_debug_alloc_bytes.load();
+    }
     
     if(cur_state == PERF_MON_STATE_FRAME) {
         frame_samples++;
@@ -1024,749 +1900,3230 @@ void PerformanceMonitor::enter_state(const PERF_MON_STATE state) {
 void PerformanceMonitor::finish_measurement() {
     if(paused) return;
     
+    if(sampling) {
+        size_t depth = sampling->depth.load(std::memory_order_relaxed);
+        if(depth > 0) {
+            sampling->depth.store(depth - 1, std::memory_order_release);
+        }
+        return;
+    }
+    
     //Check if we were measuring something.
     engine_assert(
-        cur_measurement_start_time != 0.0,
-        cur_page.measurements.empty() ?
-        "(No measurements)" :
-        "Last measurement: " + cur_page.measurements.back().first
+        !measurement_stack.empty(),
+        get_last_measurement_name()
     );
     
-    double dur = al_get_time() - cur_measurement_start_time;
-    bool is_new = true;
-    
-    for(size_t m = 0; m < cur_page.measurements.size(); m++) {
-        if(cur_page.measurements[m].first == cur_measurement_name) {
-            cur_page.measurements[m].second += dur;
-            is_new = false;
-            break;
-        }
-    }
-    if(is_new) {
-        cur_page.measurements.push_back(
-            std::make_pair(cur_measurement_name, dur)
+    TraceEvent &cur = measurement_stack.back();
+    cur.duration = al_get_time() - cur.start;
+    if(code_debug_alloc_counting) {
+        cur_page.add_measurement(
+            cur.measurement_id, cur.duration,
+            (double) (code_debug_alloc_nr.load() - cur.start_alloc_nr),
+            (double) (code_debug_alloc_bytes.load() - cur.start_alloc_bytes)
         );
+    } else {
+        cur_page.add_measurement(cur.measurement_id, cur.duration);
     }
-    
-    cur_measurement_start_time = 0.0;
+    if(
+        cur.mob_type_name &&
+        (detailed || mob_type_costs || !trace_events.empty())
+    ) {
+        //The object type could be gone by the time the results are used.
+        cur.mob_type_name = get_name_copy(cur.mob_type_name);
+    }
+    if(detailed && cur.mob_type_name) {
+        mob_type_durs[cur.mob_type_name] += cur.duration;
+    }
+    if(mob_type_costs && cur.mob_type_name) {
+        vector<double> &type_durs =
+            mob_type_measurement_durs[cur.mob_type_name];
+        if(type_durs.size() <= cur.measurement_id) {
+            type_durs.resize(measurement_names.size(), 0.0);
+        }
+        type_durs[cur.measurement_id] += cur.duration;
+        cur_frame_mob_type_durs[cur.mob_type_name] += cur.duration;
+    }
+    if(!trace_events.empty()) add_trace_event(cur);
+    measurement_stack.pop_back();
 }
 
 
 /**
- * @brief Leaves the current state of the monitoring process.
+ * @brief Returns the object types that took the longest, from a list of
+ * how long each one took.
+ *
+ * @param durs How long each object type took, indexed by the type's name.
+ * @param max Return at most this many.
+ * @return The durations and names of the types, from longest to shortest.
  */
-void PerformanceMonitor::leave_state() {
-    if(paused) return;
-    
-    cur_page.duration = al_get_time() - cur_state_start_time;
-    
-    switch(cur_state) {
-    case PERF_MON_STATE_LOADING: {
-        loading_page = cur_page;
-        break;
-    }
-    case PERF_MON_STATE_FRAME: {
-        if(
-            frame_fastest_page.duration == 0.0 ||
-            cur_page.duration < frame_fastest_page.duration
-        ) {
-            frame_fastest_page = cur_page;
-            
-        } else if(
-            frame_slowest_page.duration == 0.0 ||
-            cur_page.duration > frame_slowest_page.duration
-        ) {
-            frame_slowest_page = cur_page;
-            
-        }
-        
-        if(frame_avg_page.duration == 0.0) {
-            frame_avg_page = cur_page;
-        } else {
-            frame_avg_page.duration += cur_page.duration;
-            for(size_t m = 0; m < cur_page.measurements.size(); m++) {
-                bool is_new = true;
-                for(
-                    size_t m2 = 0;
-                    m2 < frame_avg_page.measurements.size(); m2++
-                ) {
-                    if(
-                        cur_page.measurements[m].first ==
-                        frame_avg_page.measurements[m2].first
-                    ) {
-                        frame_avg_page.measurements[m2].second +=
-                            cur_page.measurements[m].second;
-                        is_new = false;
-                        break;
-                    }
-                }
-                if(is_new) {
-                    frame_avg_page.measurements.push_back(
-                        cur_page.measurements[m]
-                    );
-                }
-            }
-        }
-        break;
-        
+vector<std::pair<double, const string*> >
+PerformanceMonitor::get_hottest_mob_types(
+    const unordered_map<const string*, double> &durs, size_t max
+) {
+    vector<std::pair<double, const string*> > mob_types;
+    mob_types.reserve(durs.size());
+    for(const auto &t : durs) {
+        mob_types.push_back(std::make_pair(t.second, t.first));
     }
+    std::sort(
+        mob_types.begin(), mob_types.end(),
+        [] (const auto &t1, const auto &t2) {
+        return t1.first > t2.first;
     }
+    );
+    if(mob_types.size() > max) mob_types.resize(max);
+    return mob_types;
 }
 
 
 /**
- * @brief Resets all of the performance monitor's information.
+ * @brief Returns the script actions that took the longest, from a list of
+ * how much each one cost.
+ *
+ * @param costs How much each action cost, indexed by the action's name.
+ * @param max Return at most this many.
+ * @param divisor Divide the durations by this much.
+ * @return The durations and descriptions of the actions, from longest
+ * to shortest.
  */
-void PerformanceMonitor::reset() {
-    area_name.clear();
-    cur_state = PERF_MON_STATE_LOADING;
-    paused = false;
-    cur_state_start_time = 0.0;
-    cur_measurement_start_time = 0.0;
-    cur_measurement_name.clear();
-    cur_page = Page();
-    frame_samples = 0;
-    loading_page = Page();
-    frame_avg_page = Page();
-    frame_fastest_page = Page();
-    frame_slowest_page = Page();
+vector<std::pair<double, string> >
+PerformanceMonitor::get_hottest_script_actions(
+    const unordered_map<const string*, ScriptCost> &costs, size_t max,
+    double divisor
+) {
+    vector<std::pair<double, const string*> > durs;
+    durs.reserve(costs.size());
+    for(const auto &a : costs) {
+        durs.push_back(std::make_pair(a.second.duration, a.first));
+    }
+    std::sort(
+        durs.begin(), durs.end(),
+        [] (const auto &a1, const auto &a2) {
+        return a1.first > a2.first;
+    }
+    );
+    if(durs.size() > max) durs.resize(max);
+    
+    vector<std::pair<double, string> > actions;
+    actions.reserve(durs.size());
+    for(size_t a = 0; a < durs.size(); a++) {
+        actions.push_back(
+            std::make_pair(
+                durs[a].first / divisor,
+                *durs[a].second + " (" +
+                i2s(costs.at(durs[a].second).nr_runs) + " runs)"
+            )
+        );
+    }
+    return actions;
 }
 
 
 /**
- * @brief Saves a log file with all known stats, if there is anything to save.
+ * @brief Returns the script events that took the longest, from a list of
+ * how much each one cost.
+ *
+ * @param costs How much each event cost, indexed by object type, state,
+ * and event.
+ * @param max Return at most this many.
+ * @param divisor Divide the durations by this much.
+ * @return The durations and descriptions of the events, from longest
+ * to shortest.
  */
-void PerformanceMonitor::save_log() {
-    if(loading_page.measurements.empty()) {
-        //Nothing to save.
-        return;
+vector<std::pair<double, string> >
+PerformanceMonitor::get_hottest_script_events(
+    const map<ScriptEventKey, ScriptCost> &costs, size_t max,
+    double divisor
+) {
+    vector<std::pair<double, const ScriptEventKey*> > durs;
+    durs.reserve(costs.size());
+    for(const auto &e : costs) {
+        durs.push_back(std::make_pair(e.second.duration, &e.first));
     }
-    
-    //Average out the frames of gameplay.
-    frame_avg_page.duration /= (double) frame_samples;
-    for(size_t m = 0; m < frame_avg_page.measurements.size(); m++) {
-        frame_avg_page.measurements[m].second /= (double) frame_samples;
+    std::sort(
+        durs.begin(), durs.end(),
+        [] (const auto &e1, const auto &e2) {
+        return e1.first > e2.first;
     }
+    );
+    if(durs.size() > max) durs.resize(max);
     
-    //Fill out the string.
-    string s =
-        "\n" +
-        get_current_time(false) +
-        "; Pikifen version " + get_engine_version_string();
-    if(!game.config.general.version.empty()) {
-        s += ", game version " + game.config.general.version;
+    vector<std::pair<double, string> > events;
+    events.reserve(durs.size());
+    for(size_t e = 0; e < durs.size(); e++) {
+        const ScriptEventKey &key = *durs[e].second;
+        events.push_back(
+            std::make_pair(
+                durs[e].first / divisor,
+                *key.mob_type_name + ", " +
+                (key.state_name ? *key.state_name : "no state") + ", " +
+                get_mob_event_name((MOB_EV) key.event_type) + " (" +
+                i2s(costs.at(key).nr_runs) + " runs)"
+            )
+        );
     }
-    
-    s +=
-        "\nData from the latest played area, " + area_name + ", with " +
-        i2s(frame_samples) + " gameplay frames sampled.\n";
-        
-    s += "\nLoading times:\n";
-    loading_page.write(s);
-    
-    s += "\nAverage frame processing times:\n";
-    frame_avg_page.write(s);
-    
-    s += "\nFastest frame processing times:\n";
-    frame_fastest_page.write(s);
-    
-    s += "\nSlowest frame processing times:\n";
-    frame_slowest_page.write(s);
-    
-    //Finally, write the string to a file.
-    string prev_log;
-    ALLEGRO_FILE* file_i =
-        al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_LOG.c_str(), "r");
-    if(file_i) {
-        string line;
-        while(!al_feof(file_i)) {
+    return events;
+}
+
+
+/**
+ * @brief Returns how long the latest frame of gameplay took.
+ *
+ * @return The duration, in seconds.
+ */
+double PerformanceMonitor::get_last_frame_duration() const {
+    return last_frame_page.duration;
+}
+
+
+/**
+ * @brief Returns the object types whose measurements took the longest in
+ * the latest frame of gameplay. Only works if the costs of each object type
+ * are being kept track of.
+ *
+ * @param max Return at most this many.
+ * @return The durations and names of the types, from longest to shortest.
+ */
+vector<std::pair<double, const string*> >
+PerformanceMonitor::get_last_frame_hottest_mob_types(size_t max) const {
+    return get_hottest_mob_types(last_frame_mob_type_durs, max);
+}
+
+
+/**
+ * @brief Returns the script actions that took the longest in the latest
+ * frame of gameplay. Only works if the script profiler is on.
+ *
+ * @param max Return at most this many.
+ * @return The durations and descriptions of the actions, from longest
+ * to shortest.
+ */
+vector<std::pair<double, string> >
+PerformanceMonitor::get_last_frame_hottest_script_actions(size_t max) const {
+    return
+        get_hottest_script_actions(
+            last_frame_script_action_costs, max, 1.0
+        );
+}
+
+
+/**
+ * @brief Returns the script events that took the longest in the latest
+ * frame of gameplay. Only works if the script profiler is on.
+ *
+ * @param max Return at most this many.
+ * @return The durations and descriptions of the events, from longest
+ * to shortest.
+ */
+vector<std::pair<double, string> >
+PerformanceMonitor::get_last_frame_hottest_script_events(size_t max) const {
+    return
+        get_hottest_script_events(
+            last_frame_script_event_costs, max, 1.0
+        );
+}
+
+
+/**
+ * @brief Returns how long a measurement took in the latest frame of gameplay.
+ *
+ * @param id ID of the measurement.
+ * @return The duration, in seconds, or 0 if it wasn't taken.
+ */
+double PerformanceMonitor::get_last_frame_measurement_dur(size_t id) const {
+    if(id >= last_frame_page.measurement_durs.size()) return 0.0;
+    return last_frame_page.measurement_durs[id];
+}
+
+
+/**
+ * @brief Returns how many heap allocations a measurement made in the latest
+ * frame of gameplay. Only works if allocations are being counted.
+ *
+ * @param id ID of the measurement.
+ * @return The amount.
+ */
+double PerformanceMonitor::get_last_frame_measurement_nr_allocs(
+    size_t id
+) const {
+    if(id >= last_frame_page.measurement_nr_allocs.size()) return 0.0;
+    return last_frame_page.measurement_nr_allocs[id];
+}
+
+
+/**
+ * @brief Returns how many heap allocations the latest frame of gameplay
+ * made. Only works if allocations are being counted.
+ *
+ * @return The amount.
+ */
+double PerformanceMonitor::get_last_frame_nr_allocs() const {
+    return last_frame_page.nr_allocs;
+}
+
+
+/**
+ * @brief Returns a description of the latest measurement taken,
+ * for error reporting purposes.
+ *
+ * @return The description.
+ */
+string PerformanceMonitor::get_last_measurement_name() const {
+    if(cur_page.measurement_order.empty()) {
+        return "(No measurements)";
+    }
+    return
+        "Last measurement: " +
+        measurement_names[cur_page.measurement_order.back()];
+}
+
+
+/**
+ * @brief Returns how deeply nested a measurement is.
+ *
+ * @param id ID of the measurement.
+ * @return The depth, 0 being the outermost.
+ */
+size_t PerformanceMonitor::get_measurement_depth(size_t id) const {
+    if(id >= measurement_depths.size()) return 0;
+    return measurement_depths[id];
+}
+
+
+/**
+ * @brief Returns the name of a measurement.
+ *
+ * @param id ID of the measurement.
+ * @return The name, or an empty string if the ID is invalid.
+ */
+string PerformanceMonitor::get_measurement_name(size_t id) const {
+    if(id >= measurement_names.size()) return "";
+    return measurement_names[id];
+}
+
+
+/**
+ * @brief Returns how many measurements are registered.
+ *
+ * @return The amount.
+ */
+size_t PerformanceMonitor::get_nr_measurements() const {
+    return measurement_names.size();
+}
+
+
+/**
+ * @brief Returns whether the script profiler is on, meaning the script
+ * events and actions should report how long they take.
+ *
+ * @return Whether it's on.
+ */
+bool PerformanceMonitor::is_profiling_scripts() const {
+    return script_costs && !sampling && !paused;
+}
+
+
+/**
+ * @brief Returns the monitor's own copy of a name, creating it if needed.
+ * Equal names always get the same copy.
+ *
+ * @param name The name. nullptr if none.
+ * @return The copy, or nullptr if there was no name.
+ */
+const string* PerformanceMonitor::get_name_copy(const string* name) {
+    if(!name) return nullptr;
+    auto it = name_copies.find(*name);
+    if(it == name_copies.end()) it = name_copies.insert(*name).first;
+    return &(*it);
+}
+
+
+/**
+ * @brief Returns the value at the given percentile of a list.
+ *
+ * @param values The values. It's a copy, since it gets partially sorted.
+ * @param percentile Percentile to get, from 0 to 1.
+ * @return The value, or 0 if the list is empty.
+ */
+double PerformanceMonitor::get_percentile(
+    vector<double> values, float percentile
+) {
+    if(values.empty()) return 0.0;
+    size_t idx =
+        std::min(
+            (size_t) (percentile * values.size()), values.size() - 1
+        );
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+
+/**
+ * @brief Leaves the current state of the monitoring process.
+ */
+void PerformanceMonitor::leave_state() {
+    if(paused) return;
+    
+    if(sampling) {
+        sampling->state.store(INVALID, std::memory_order_release);
+        return;
+    }
+    
+    cur_page.duration = al_get_time() - cur_state_start_time;
+    if(code_debug_alloc_counting) {
+        cur_page.nr_allocs =
+            (double) (code_debug_alloc_nr.load() - cur_state_start_alloc_nr);
+        cur_page.alloc_bytes =
+            (double) (
+                code_debug_alloc_bytes.load() - cur_state_start_alloc_bytes
+            );
+    }
+    cur_page.worker_busy_durs.resize(cur_state_start_busy_times.size());
+    for(size_t w = 0; w < cur_state_start_busy_times.size(); w++) {
+        cur_page.worker_busy_durs[w] =
+            game.jobs.get_busy_time(w) - cur_state_start_busy_times[w];
+    }
+    
+    switch(cur_state) {
+    case PERF_MON_STATE_LOADING: {
+        loading_page = cur_page;
+        break;
+    }
+    case PERF_MON_STATE_FRAME: {
+        if(
+            frame_fastest_page.duration == 0.0 ||
+            cur_page.duration < frame_fastest_page.duration
+        ) {
+            frame_fastest_page = cur_page;
+            
+        } else if(
+            frame_slowest_page.duration == 0.0 ||
+            cur_page.duration > frame_slowest_page.duration
+        ) {
+            frame_slowest_page = cur_page;
+            
+        }
+        
+        frame_avg_page.add_page(cur_page);
+        last_frame_page = cur_page;
+        
+        frame_histogram.add(cur_page.duration);
+        measurement_histograms.resize(measurement_names.size());
+        for(size_t m = 0; m < cur_page.measurement_order.size(); m++) {
+            size_t id = cur_page.measurement_order[m];
+            measurement_histograms[id].add(cur_page.measurement_durs[id]);
+        }
+        if(cur_page.duration > 1.0 / game.options.advanced.target_fps) {
+            frames_over_budget++;
+        }
+        last_frame_mob_type_durs.swap(cur_frame_mob_type_durs);
+        for(const auto &e : cur_frame_script_event_costs) {
+            script_event_costs[e.first].add(
+                e.second.nr_runs, e.second.duration
+            );
+        }
+        for(const auto &a : cur_frame_script_action_costs) {
+            script_action_costs[a.first].add(
+                a.second.nr_runs, a.second.duration
+            );
+        }
+        last_frame_script_event_costs.swap(cur_frame_script_event_costs);
+        last_frame_script_action_costs.swap(cur_frame_script_action_costs);
+        
+        if(detailed) {
+            frame_durs.push_back(cur_page.duration);
+            frame_measurement_durs.resize(measurement_names.size());
+            for(size_t m = 0; m < frame_measurement_durs.size(); m++) {
+                frame_measurement_durs[m].push_back(
+                    m < cur_page.measurement_durs.size() ?
+                    cur_page.measurement_durs[m] :
+                    0.0
+                );
+            }
+        }
+        
+        if(!trace_events.empty()) {
+            TraceEvent frame_event;
+            frame_event.start = cur_state_start_time;
+            frame_event.duration = cur_page.duration;
+            add_trace_event(frame_event);
+            
+            if(
+                trace_frame_budget > 0.0 &&
+                cur_page.duration > trace_frame_budget &&
+                cur_page.duration > trace_slowest_saved_frame
+            ) {
+                //Only save if this is the worst one yet, so stutters
+                //don't fill the disk with traces.
+                trace_slowest_saved_frame = cur_page.duration;
+                save_trace();
+            }
+        }
+        break;
+        
+    }
+    case PERF_MON_STATE_UNLOADING: {
+        unloading_page = cur_page;
+        break;
+    }
+    }
+}
+
+
+/**
+ * @brief Registers a measurement that isn't known at compile time.
+ * If a measurement with this name already exists, its ID is returned instead.
+ *
+ * @param name Name of the measurement.
+ * @return The measurement's ID.
+ */
+size_t PerformanceMonitor::register_measurement(const string &name) {
+    auto it = measurement_ids.find(name);
+    if(it != measurement_ids.end()) return it->second;
+    
+    size_t id = measurement_names.size();
+    measurement_names.push_back(name);
+    measurement_depths.push_back(INVALID);
+    measurement_ids[name] = id;
+    return id;
+}
+
+
+/**
+ * @brief Resets all of the performance monitor's information.
+ * Registered measurements are kept.
+ */
+void PerformanceMonitor::reset() {
+    area_name.clear();
+    cur_state = PERF_MON_STATE_LOADING;
+    paused = false;
+    cur_state_start_time = 0.0;
+    cur_state_start_busy_times.clear();
+    measurement_stack.clear();
+    measurement_depths.assign(measurement_names.size(), INVALID);
+    trace_next_idx = 0;
+    trace_wrapped = false;
+    trace_slowest_saved_frame = 0.0;
+    cur_page = Page();
+    last_frame_page = Page();
+    frame_samples = 0;
+    loading_page = Page();
+    frame_avg_page = Page();
+    frame_fastest_page = Page();
+    frame_slowest_page = Page();
+    unloading_page = Page();
+    frame_durs.clear();
+    frame_measurement_durs.clear();
+    mob_type_durs.clear();
+    mob_type_measurement_durs.clear();
+    frame_histogram = Histogram();
+    measurement_histograms.clear();
+    frames_over_budget = 0;
+    cur_frame_mob_type_durs.clear();
+    last_frame_mob_type_durs.clear();
+    script_event_costs.clear();
+    cur_frame_script_event_costs.clear();
+    last_frame_script_event_costs.clear();
+    script_action_costs.clear();
+    cur_frame_script_action_costs.clear();
+    last_frame_script_action_costs.clear();
+    peak_memory_report.clear();
+    if(sampling) {
+        sampling->state.store(INVALID, std::memory_order_release);
+        sampling->depth.store(0, std::memory_order_release);
+    }
+}
+
+
+/**
+ * @brief Saves a log file with all known stats, if there is anything to save.
+ */
+void PerformanceMonitor::save_log() {
+    if(loading_page.measurement_order.empty()) {
+        //Nothing to save.
+        return;
+    }
+    
+    //Average out the frames of gameplay.
+    frame_avg_page.duration /= (double) frame_samples;
+    for(size_t m = 0; m < frame_avg_page.measurement_durs.size(); m++) {
+        frame_avg_page.measurement_durs[m] /= (double) frame_samples;
+    }
+    for(size_t w = 0; w < frame_avg_page.worker_busy_durs.size(); w++) {
+        frame_avg_page.worker_busy_durs[w] /= (double) frame_samples;
+    }
+    frame_avg_page.nr_allocs /= (double) frame_samples;
+    frame_avg_page.alloc_bytes /= (double) frame_samples;
+    for(size_t m = 0; m < frame_avg_page.measurement_nr_allocs.size(); m++) {
+        frame_avg_page.measurement_nr_allocs[m] /= (double) frame_samples;
+        frame_avg_page.measurement_alloc_bytes[m] /= (double) frame_samples;
+    }
+    
+    //Fill out the string.
+    string s =
+        "\n" +
+        get_current_time(false) +
+        "; Pikifen version " + get_engine_version_string();
+    if(!game.config.general.version.empty()) {
+        s += ", game version " + game.config.general.version;
+    }
+    
+    s +=
+        "\nData from the latest played area, " + area_name + ", with " +
+        i2s(frame_samples) + " gameplay frames sampled.\n";
+        
+    s += "\nLoading times:\n";
+    loading_page.write(s, this);
+    
+    s += "\nAverage frame processing times:\n";
+    frame_avg_page.write(s, this);
+    
+    s += "\nFastest frame processing times:\n";
+    frame_fastest_page.write(s, this);
+    
+    s += "\nSlowest frame processing times:\n";
+    frame_slowest_page.write(s, this);
+    
+    if(frame_histogram.nr_samples > 0) {
+        s += "\nFrame processing time percentiles:\n";
+        s += "  Frame: " + frame_histogram.get_summary() + "\n";
+        for(size_t m = 0; m < frame_avg_page.measurement_order.size(); m++) {
+            size_t id = frame_avg_page.measurement_order[m];
+            if(id >= measurement_histograms.size()) continue;
+            string indent(measurement_depths[id] * 2, ' ');
+            s +=
+                "  " + indent + measurement_names[id] + ": " +
+                measurement_histograms[id].get_summary() + "\n";
+        }
+        double budget = 1.0 / game.options.advanced.target_fps;
+        s +=
+            "  Frames over the budget of " + std::to_string(budget) +
+            "s: " + i2s(frames_over_budget) + " (" +
+            f2s(frames_over_budget / (float) frame_samples * 100.0f) +
+            "%).\n";
+    }
+    
+    if(!mob_type_measurement_durs.empty()) {
+        s += "\nCostliest object types, per frame, on average:\n";
+        unordered_map<const string*, double> type_totals;
+        for(const auto &t : mob_type_measurement_durs) {
+            double total = 0.0;
+            for(size_t m = 0; m < t.second.size(); m++) {
+                total += t.second[m];
+            }
+            type_totals[t.first] = total;
+        }
+        vector<std::pair<double, const string*> > mob_types =
+            get_hottest_mob_types(
+                type_totals, PERFORMANCE_MONITOR::N_HOTTEST_MOB_TYPES
+            );
+        double divisor = frame_samples > 0 ? (double) frame_samples : 1.0;
+        for(size_t t = 0; t < mob_types.size(); t++) {
+            s +=
+                "  " + i2s(t + 1) + ". " + *mob_types[t].second + ": " +
+                std::to_string(mob_types[t].first / divisor) + "s.\n";
+            const vector<double> &type_durs =
+                mob_type_measurement_durs[mob_types[t].second];
+            for(size_t m = 0; m < type_durs.size(); m++) {
+                if(type_durs[m] <= 0.0) continue;
+                s +=
+                    "    " + measurement_names[m] + ": " +
+                    std::to_string(type_durs[m] / divisor) + "s.\n";
+            }
+        }
+    }
+    
+    if(!script_event_costs.empty()) {
+        s +=
+            "\nCostliest script events, per frame, on average "
+            "(object type, state, event, total runs):\n";
+        double divisor = frame_samples > 0 ? (double) frame_samples : 1.0;
+        vector<std::pair<double, string> > events =
+            get_hottest_script_events(
+                script_event_costs,
+                PERFORMANCE_MONITOR::N_HOTTEST_SCRIPT_COSTS, divisor
+            );
+        for(size_t e = 0; e < events.size(); e++) {
+            s +=
+                "  " + i2s(e + 1) + ". " + events[e].second + ": " +
+                std::to_string(events[e].first) + "s.\n";
+        }
+    }
+    
+    if(!script_action_costs.empty()) {
+        s +=
+            "\nCostliest script actions, per frame, on average "
+            "(action, total runs):\n";
+        double divisor = frame_samples > 0 ? (double) frame_samples : 1.0;
+        vector<std::pair<double, string> > actions =
+            get_hottest_script_actions(
+                script_action_costs,
+                PERFORMANCE_MONITOR::N_HOTTEST_SCRIPT_COSTS, divisor
+            );
+        for(size_t a = 0; a < actions.size(); a++) {
+            s +=
+                "  " + i2s(a + 1) + ". " + actions[a].second + ": " +
+                std::to_string(actions[a].first) + "s.\n";
+        }
+    }
+    
+    if(!peak_memory_report.empty()) {
+        s += "\nPeak memory usage estimates:\n";
+        size_t total = 0;
+        for(size_t r = 0; r < peak_memory_report.size(); r++) {
+            s +=
+                "  " + peak_memory_report[r].first + ": " +
+                i2s(peak_memory_report[r].second / 1024) + " KiB.\n";
+            total += peak_memory_report[r].second;
+        }
+        s += "  Total: " + i2s(total / 1024) + " KiB.\n";
+    }
+    
+    if(!unloading_page.measurement_order.empty()) {
+        s += "\nUnloading times:\n";
+        unloading_page.write(s, this);
+    }
+    
+    //Finally, write the string to a file.
+    string prev_log;
+    ALLEGRO_FILE* file_i =
+        al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_LOG.c_str(), "r");
+    if(file_i) {
+        string line;
+        while(!al_feof(file_i)) {
             getline(file_i, line);
             prev_log += line + "\n";
         }
-        prev_log.erase(prev_log.size() - 1);
-        al_fclose(file_i);
+        prev_log.erase(prev_log.size() - 1);
+        al_fclose(file_i);
+    }
+    
+    ALLEGRO_FILE* file_o =
+        al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_LOG.c_str(), "w");
+    if(file_o) {
+        al_fwrite(file_o, prev_log + s);
+        al_fclose(file_o);
+    }
+}
+
+
+/**
+ * @brief Code for the sampling thread. Every so often, it takes note of
+ * which measurements the main thread is in, until it's told to stop.
+ */
+void PerformanceMonitor::sample_work() {
+    set_up_thread();
+    
+    std::unique_lock<std::mutex> lock(sampling->mutex);
+    vector<size_t> stack;
+    while(true) {
+        sampling->stop_cond.wait_for(
+            lock, sampling->interval,
+            [this] () { return sampling->stopping; }
+        );
+        if(sampling->stopping) break;
+        
+        stack.clear();
+        stack.push_back(sampling->state.load(std::memory_order_acquire));
+        size_t depth =
+            std::min(
+                sampling->depth.load(std::memory_order_acquire),
+                PERFORMANCE_MONITOR::SAMPLING_MAX_DEPTH
+            );
+        for(size_t d = 0; d < depth; d++) {
+            stack.push_back(sampling->stack[d].load(std::memory_order_relaxed));
+        }
+        sampling->samples[stack]++;
+    }
+}
+
+
+/**
+ * @brief Saves the samples taken in sampling mode to the disk, in the
+ * collapsed stack format, i.e. one line per stack, with the names going
+ * from outermost to innermost separated by semicolons, followed by
+ * how many times it was sampled. This can be fed to flame graph tools.
+ *
+ * @return Whether it succeeded.
+ */
+bool PerformanceMonitor::save_samples() {
+    if(!sampling) return false;
+    
+    map<vector<size_t>, size_t> samples;
+    {
+        std::unique_lock<std::mutex> lock(sampling->mutex);
+        samples = sampling->samples;
+    }
+    if(samples.empty()) return false;
+    
+    string s;
+    for(const auto &s_it : samples) {
+        const vector<size_t> &stack = s_it.first;
+        switch(stack[0]) {
+        case PERF_MON_STATE_LOADING: {
+            s += "Loading";
+            break;
+        } case PERF_MON_STATE_FRAME: {
+            s += "Frame";
+            break;
+        } case PERF_MON_STATE_UNLOADING: {
+            s += "Unloading";
+            break;
+        } default: {
+            s += "Other";
+            break;
+        }
+        }
+        for(size_t m = 1; m < stack.size(); m++) {
+            s += ";" + replace_all(measurement_names[stack[m]], ";", ",");
+        }
+        s += " " + i2s(s_it.second) + "\n";
+    }
+    
+    ALLEGRO_FILE* file =
+        al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_SAMPLES.c_str(), "w");
+    if(!file) return false;
+    al_fwrite(file, s);
+    al_fclose(file);
+    return true;
+}
+
+
+/**
+ * @brief Saves the latest trace events onto a file, in the Chrome trace
+ * event format. This can be opened with Perfetto or chrome://tracing.
+ *
+ * @return Whether it succeeded.
+ */
+bool PerformanceMonitor::save_trace() {
+    if(trace_events.empty()) return false;
+    
+    size_t first_idx = trace_wrapped ? trace_next_idx : 0;
+    size_t n_events = trace_wrapped ? trace_events.size() : trace_next_idx;
+    if(n_events == 0) return false;
+    double base_time = trace_events[first_idx].start;
+    
+    auto escape = [] (const string &str) {
+        string result;
+        for(size_t c = 0; c < str.size(); c++) {
+            if(str[c] == '"' || str[c] == '\\') {
+                result.push_back('\\');
+                result.push_back(str[c]);
+            } else if((unsigned char) str[c] < 0x20) {
+                result.push_back(' ');
+            } else {
+                result.push_back(str[c]);
+            }
+        }
+        return result;
+    };
+    
+    string s = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for(size_t e = 0; e < n_events; e++) {
+        const TraceEvent &event =
+            trace_events[(first_idx + e) % trace_events.size()];
+        string name =
+            event.measurement_id == INVALID ?
+            "Frame" :
+            measurement_names[event.measurement_id];
+        if(event.mob_type_name) {
+            name += " (" + *event.mob_type_name + ")";
+        }
+        
+        if(e > 0) s += ",\n";
+        s +=
+            "{\"name\":\"" + escape(name) + "\",\"ph\":\"X\","
+            "\"pid\":1,\"tid\":1,"
+            "\"ts\":" +
+            std::to_string((event.start - base_time) * 1000000.0) + ","
+            "\"dur\":" + std::to_string(event.duration * 1000000.0);
+        if(event.mob_id != INVALID) {
+            s += ",\"args\":{\"mob_id\":" + i2s(event.mob_id);
+            if(event.mob_type_name) {
+                s +=
+                    ",\"mob_type\":\"" +
+                    escape(*event.mob_type_name) + "\"";
+            }
+            s += "}";
+        }
+        s += "}";
+    }
+    s += "\n]}\n";
+    
+    string file_path =
+        FOLDER_PATHS_FROM_ROOT::USER_DATA + "/performance_trace_" +
+        get_current_time(true) + ".json";
+    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "w");
+    if(!file) return false;
+    al_fwrite(file, s);
+    al_fclose(file);
+    return true;
+}
+
+
+/**
+ * @brief Writes all known stats into a data node, in a machine-friendly
+ * format. Unlike save_log, this doesn't change any of the information.
+ *
+ * @param node Node to write to.
+ */
+void PerformanceMonitor::write_results(DataNode* node) const {
+    node->addNew("area", area_name);
+    node->addNew("frame_samples", i2s(frame_samples));
+    
+    loading_page.write_results(node->addNew("loading"), 1.0, this);
+    frame_avg_page.write_results(
+        node->addNew("frame_average"),
+        frame_samples > 0 ? (double) frame_samples : 1.0,
+        this
+    );
+    frame_fastest_page.write_results(
+        node->addNew("frame_fastest"), 1.0, this
+    );
+    frame_slowest_page.write_results(
+        node->addNew("frame_slowest"), 1.0, this
+    );
+    unloading_page.write_results(node->addNew("unloading"), 1.0, this);
+    
+    //Frame time percentiles, from the histograms.
+    DataNode* histograms_node = node->addNew("frame_histograms");
+    histograms_node->addNew("frames_over_budget", i2s(frames_over_budget));
+    frame_histogram.write_results(histograms_node->addNew("frame"));
+    DataNode* measurement_histograms_node =
+        histograms_node->addNew("measurements");
+    for(size_t m = 0; m < measurement_histograms.size(); m++) {
+        if(measurement_histograms[m].nr_samples == 0) continue;
+        measurement_histograms[m].write_results(
+            measurement_histograms_node->addNew(measurement_names[m])
+        );
+    }
+    
+    if(!detailed) return;
+    
+    //Frame times at the percentile, which show stutters that averages hide.
+    DataNode* percentile_node = node->addNew("frame_percentile");
+    percentile_node->addNew(
+        "percentile", f2s(PERFORMANCE_MONITOR::REPORT_PERCENTILE * 100.0f)
+    );
+    percentile_node->addNew(
+        "duration",
+        std::to_string(
+            get_percentile(frame_durs, PERFORMANCE_MONITOR::REPORT_PERCENTILE)
+        )
+    );
+    DataNode* measurements_node = percentile_node->addNew("measurements");
+    for(size_t m = 0; m < frame_measurement_durs.size(); m++) {
+        if(
+            m >= frame_avg_page.measurements_taken.size() ||
+            !frame_avg_page.measurements_taken[m]
+        ) {
+            continue;
+        }
+        measurements_node->addNew(
+            measurement_names[m],
+            std::to_string(
+                get_percentile(
+                    frame_measurement_durs[m],
+                    PERFORMANCE_MONITOR::REPORT_PERCENTILE
+                )
+            )
+        );
+    }
+    
+    //Object types that took the longest, in total.
+    vector<std::pair<double, const string*> > mob_types =
+        get_hottest_mob_types(
+            mob_type_durs, PERFORMANCE_MONITOR::N_HOTTEST_MOB_TYPES
+        );
+    DataNode* mob_types_node = node->addNew("hottest_mob_types");
+    for(size_t t = 0; t < mob_types.size(); t++) {
+        mob_types_node->addNew(
+            *mob_types[t].second, std::to_string(mob_types[t].first)
+        );
+    }
+    
+    //Highest memory usage estimates, in bytes.
+    DataNode* memory_node = node->addNew("peak_memory_usage");
+    for(size_t r = 0; r < peak_memory_report.size(); r++) {
+        memory_node->addNew(
+            peak_memory_report[r].first, i2s(peak_memory_report[r].second)
+        );
+    }
+}
+
+
+/**
+ * @brief Sets the name of the area that was monitored.
+ *
+ * @param name Name of the area.
+ */
+void PerformanceMonitor::set_area_name(const string &name) {
+    area_name = name;
+}
+
+
+/**
+ * @brief Sets whether the monitor keeps detailed information or not.
+ * This is every frame's times, so percentiles can be calculated, and how
+ * long the measurements of each object type took. It takes more memory
+ * the more frames are sampled, so it's only meant for benchmarks.
+ *
+ * @param detailed Whether to keep it.
+ */
+void PerformanceMonitor::set_detailed(bool detailed) {
+    this->detailed = detailed;
+}
+
+
+/**
+ * @brief Sets whether the monitor keeps track of how long each object type
+ * took in each measurement, so makers can find which types are expensive.
+ *
+ * @param mob_type_costs Whether to keep track.
+ */
+void PerformanceMonitor::set_mob_type_costs(bool mob_type_costs) {
+    this->mob_type_costs = mob_type_costs;
+}
+
+
+/**
+ * @brief Sets whether the script profiler is on. If so, it keeps track of
+ * how many times each script event of each state of each object type runs,
+ * how many times each script action runs, and how long they take.
+ *
+ * @param script_costs Whether it's on.
+ */
+void PerformanceMonitor::set_script_costs(bool script_costs) {
+    this->script_costs = script_costs;
+}
+
+
+/**
+ * @brief Sets whether monitoring is currently paused or not.
+ *
+ * @param paused Pause value.
+ */
+void PerformanceMonitor::set_paused(bool paused) {
+    this->paused = paused;
+}
+
+
+/**
+ * @brief Turns sampling mode on or off. While it's on, measurements
+ * aren't timed, and instead, a background thread checks which ones
+ * are ongoing every so often. Any samples taken so far are discarded.
+ * Sampling mode is off by default.
+ *
+ * @param interval Time between samples, in seconds. 0 turns it off.
+ */
+void PerformanceMonitor::set_sampling_interval(float interval) {
+    if(sampling) {
+        {
+            std::unique_lock<std::mutex> lock(sampling->mutex);
+            sampling->stopping = true;
+            sampling->stop_cond.notify_all();
+        }
+        sampling->worker.join();
+        delete sampling;
+        sampling = nullptr;
+    }
+    if(interval <= 0.0f) return;
+    
+    sampling = new SamplingData();
+    sampling->interval = std::chrono::duration<double>(interval);
+    sampling->worker = std::thread(&PerformanceMonitor::sample_work, this);
+}
+
+
+/**
+ * @brief Sets up the trace of timestamped events. Tracing is disabled
+ * by default.
+ *
+ * @param max_events Keep at most these many of the latest events.
+ * 0 disables tracing.
+ * @param frame_budget If a frame takes longer than this, in seconds,
+ * the trace is saved automatically. 0 to never do this.
+ */
+void PerformanceMonitor::set_tracing(size_t max_events, double frame_budget) {
+    trace_events.assign(max_events, TraceEvent());
+    trace_next_idx = 0;
+    trace_wrapped = false;
+    trace_frame_budget = frame_budget;
+    trace_slowest_saved_frame = 0.0;
+}
+
+
+/**
+ * @brief Starts measuring something. If another measurement is ongoing,
+ * this one is nested inside of it.
+ *
+ * @param id ID of the measurement. Use PERF_MON_MEASUREMENT, or an ID
+ * obtained from register_measurement.
+ * @param mob_id ID of the object this measurement refers to, if any.
+ * Only used for the trace.
+ * @param mob_type_name Name of the type of object this measurement refers
+ * to, if any. Only used for the trace.
+ */
+void PerformanceMonitor::start_measurement(
+    size_t id, size_t mob_id, const string* mob_type_name
+) {
+    if(paused) return;
+    
+    if(sampling) {
+        size_t depth = sampling->depth.load(std::memory_order_relaxed);
+        if(depth < PERFORMANCE_MONITOR::SAMPLING_MAX_DEPTH) {
+            sampling->stack[depth].store(id, std::memory_order_relaxed);
+        }
+        sampling->depth.store(depth + 1, std::memory_order_release);
+        return;
+    }
+    
+    if(measurement_depths[id] == INVALID) {
+        measurement_depths[id] = measurement_stack.size();
+    }
+    TraceEvent event;
+    event.measurement_id = id;
+    event.start = al_get_time();
+    event.mob_id = mob_id;
+    event.mob_type_name = mob_type_name;
+    if(code_debug_alloc_counting) {
+        event.start_alloc_nr = code_debug_alloc_nr.load();
+        event.start_alloc_bytes = code_debug_alloc_bytes.load();
+    }
+    measurement_stack.push_back(event);
+}
+
+
+/**
+ * @brief Starts measuring something, registering the measurement
+ * if needed. This is slower than using the measurement's ID directly.
+ *
+ * @param name Name of the measurement.
+ */
+void PerformanceMonitor::start_measurement(const string &name) {
+    if(paused) return;
+    
+    start_measurement(register_measurement(name));
+}
+
+
+/**
+ * @brief Adds a sample to the histogram.
+ *
+ * @param dur Duration of the sample, in seconds.
+ */
+void PerformanceMonitor::Histogram::add(double dur) {
+    if(buckets.empty()) {
+        buckets.assign(PERFORMANCE_MONITOR::HISTOGRAM_NR_BUCKETS, 0);
+    }
+    size_t idx = 0;
+    if(dur > PERFORMANCE_MONITOR::HISTOGRAM_MIN_DURATION) {
+        idx =
+            (size_t) (
+                log2(dur / PERFORMANCE_MONITOR::HISTOGRAM_MIN_DURATION) *
+                PERFORMANCE_MONITOR::HISTOGRAM_BUCKETS_PER_DOUBLING
+            ) + 1;
+        idx = std::min(idx, buckets.size() - 1);
+    }
+    buckets[idx]++;
+    nr_samples++;
+}
+
+
+/**
+ * @brief Returns an estimate of the duration at the given percentile.
+ * Since only the bucket is known, this is the bucket's upper limit.
+ *
+ * @param percentile Percentile to get, from 0 to 1.
+ * @return The duration, in seconds, or 0 if there are no samples.
+ */
+double PerformanceMonitor::Histogram::get_percentile(float percentile) const {
+    if(nr_samples == 0) return 0.0;
+    size_t target = (size_t) ceil(percentile * nr_samples);
+    target = std::max(target, (size_t) 1);
+    size_t so_far = 0;
+    for(size_t b = 0; b < buckets.size(); b++) {
+        so_far += buckets[b];
+        if(so_far >= target) {
+            return
+                PERFORMANCE_MONITOR::HISTOGRAM_MIN_DURATION *
+                pow(
+                    2.0,
+                    b /
+                    (double) PERFORMANCE_MONITOR::HISTOGRAM_BUCKETS_PER_DOUBLING
+                );
+        }
+    }
+    return 0.0;
+}
+
+
+/**
+ * @brief Returns a human-friendly summary of the histogram's percentiles.
+ *
+ * @return The summary.
+ */
+string PerformanceMonitor::Histogram::get_summary() const {
+    return
+        "p50 " + std::to_string(get_percentile(0.5f)) + "s, " +
+        "p90 " + std::to_string(get_percentile(0.9f)) + "s, " +
+        "p99 " + std::to_string(get_percentile(0.99f)) + "s, " +
+        "p99.9 " + std::to_string(get_percentile(0.999f)) + "s.";
+}
+
+
+/**
+ * @brief Writes the histogram's percentiles into a data node, in a
+ * machine-friendly format.
+ *
+ * @param node Node to write to.
+ */
+void PerformanceMonitor::Histogram::write_results(DataNode* node) const {
+    node->addNew("samples", i2s(nr_samples));
+    node->addNew("p50", std::to_string(get_percentile(0.5f)));
+    node->addNew("p90", std::to_string(get_percentile(0.9f)));
+    node->addNew("p99", std::to_string(get_percentile(0.99f)));
+    node->addNew("p99_9", std::to_string(get_percentile(0.999f)));
+}
+
+
+/**
+ * @brief Adds time to one of the page's measurements.
+ *
+ * @param id ID of the measurement.
+ * @param dur How long it took, in seconds.
+ * @param nr_allocs How many heap allocations it made, if they're being counted.
+ * @param alloc_bytes How many bytes it heap-allocated, if they're
+ * being counted.
+ */
+void PerformanceMonitor::Page::add_measurement(
+    size_t id, double dur, double nr_allocs, double alloc_bytes
+) {
+    if(id >= measurement_durs.size()) {
+        measurement_durs.resize(id + 1, 0.0);
+        measurements_taken.resize(id + 1, false);
+        measurement_nr_allocs.resize(id + 1, 0.0);
+        measurement_alloc_bytes.resize(id + 1, 0.0);
+    }
+    if(!measurements_taken[id]) {
+        measurements_taken[id] = true;
+        measurement_order.push_back(id);
+    }
+    measurement_durs[id] += dur;
+    measurement_nr_allocs[id] += nr_allocs;
+    measurement_alloc_bytes[id] += alloc_bytes;
+}
+
+
+/**
+ * @brief Adds the durations of another page to this one's.
+ *
+ * @param other The other page.
+ */
+void PerformanceMonitor::Page::add_page(const Page &other) {
+    duration += other.duration;
+    for(size_t m = 0; m < other.measurement_order.size(); m++) {
+        size_t id = other.measurement_order[m];
+        add_measurement(
+            id, other.measurement_durs[id],
+            other.measurement_nr_allocs[id], other.measurement_alloc_bytes[id]
+        );
+    }
+    nr_allocs += other.nr_allocs;
+    alloc_bytes += other.alloc_bytes;
+    if(worker_busy_durs.size() < other.worker_busy_durs.size()) {
+        worker_busy_durs.resize(other.worker_busy_durs.size(), 0.0);
+    }
+    for(size_t w = 0; w < other.worker_busy_durs.size(); w++) {
+        worker_busy_durs[w] += other.worker_busy_durs[w];
+    }
+}
+
+
+/**
+ * @brief Returns the total measured time, not counting the nested
+ * measurements, since those are already included in their parents.
+ *
+ * @param monitor Monitor the page belongs to.
+ * @return The time.
+ */
+double PerformanceMonitor::Page::get_total_measured_time(
+    const PerformanceMonitor* monitor
+) const {
+    double total_measured_time = 0.0;
+    for(size_t m = 0; m < measurement_order.size(); m++) {
+        size_t id = measurement_order[m];
+        if(monitor->measurement_depths[id] == 0) {
+            total_measured_time += measurement_durs[id];
+        }
+    }
+    return total_measured_time;
+}
+
+
+/**
+ * @brief Writes a page of information to a string.
+ *
+ * @param s String to write to.
+ * @param monitor Monitor the page belongs to.
+ */
+void PerformanceMonitor::Page::write(
+    string &s, const PerformanceMonitor* monitor
+) {
+    //Get the total measured time.
+    double total_measured_time = get_total_measured_time(monitor);
+    
+    //Write each measurement into the string.
+    for(size_t m = 0; m < measurement_order.size(); m++) {
+        size_t id = measurement_order[m];
+        write_measurement(
+            s, monitor->measurement_names[id],
+            monitor->measurement_depths[id],
+            measurement_durs[id],
+            total_measured_time,
+            measurement_nr_allocs[id],
+            measurement_alloc_bytes[id]
+        );
+    }
+    
+    //Write the total.
+    s +=
+        "  TOTAL: " + std::to_string(duration) + "s (" +
+        std::to_string(total_measured_time) + "s measured, " +
+        std::to_string(duration - total_measured_time) + "s not measured).\n";
+    if(code_debug_alloc_counting) {
+        s +=
+            "  TOTAL ALLOCATIONS: " + f2s(nr_allocs) + " (" +
+            f2s(alloc_bytes) + " bytes).\n";
+    }
+    
+    //Write how busy each job worker was.
+    for(size_t w = 0; w < worker_busy_durs.size(); w++) {
+        float perc =
+            duration > 0.0 ? worker_busy_durs[w] / duration * 100.0 : 0.0f;
+        s +=
+            "  Worker " + i2s(w + 1) + ": " +
+            std::to_string(worker_busy_durs[w]) + "s busy (" +
+            f2s(perc) + "%).\n";
+    }
+}
+
+
+/**
+ * @brief Writes a page of information into a data node, in a
+ * machine-friendly format.
+ *
+ * @param node Node to write to.
+ * @param divisor Divide every time by this. Used to write averages.
+ * @param monitor Monitor the page belongs to.
+ */
+void PerformanceMonitor::Page::write_results(
+    DataNode* node, double divisor, const PerformanceMonitor* monitor
+) const {
+    DataNode* measurements_node = node->addNew("measurements");
+    for(size_t m = 0; m < measurement_order.size(); m++) {
+        size_t id = measurement_order[m];
+        measurements_node->addNew(
+            monitor->measurement_names[id],
+            std::to_string(measurement_durs[id] / divisor)
+        );
+    }
+    
+    node->addNew("duration", std::to_string(duration / divisor));
+    node->addNew(
+        "measured",
+        std::to_string(get_total_measured_time(monitor) / divisor)
+    );
+    
+    if(code_debug_alloc_counting) {
+        DataNode* allocs_node = node->addNew("allocations");
+        allocs_node->addNew("total", std::to_string(nr_allocs / divisor));
+        allocs_node->addNew(
+            "total_bytes", std::to_string(alloc_bytes / divisor)
+        );
+        DataNode* measurement_allocs_node =
+            allocs_node->addNew("measurements");
+        for(size_t m = 0; m < measurement_order.size(); m++) {
+            size_t id = measurement_order[m];
+            measurement_allocs_node->addNew(
+                monitor->measurement_names[id],
+                std::to_string(measurement_nr_allocs[id] / divisor)
+            );
+        }
+    }
+    
+    DataNode* workers_node = node->addNew("workers");
+    for(size_t w = 0; w < worker_busy_durs.size(); w++) {
+        workers_node->addNew(
+            i2s(w + 1), std::to_string(worker_busy_durs[w] / divisor)
+        );
+    }
+}
+
+
+/**
+ * @brief Writes a measurement in a human-friendly format onto a string.
+ *
+ * @param str The string to write to.
+ * @param name The name of this measurement.
+ * @param depth How deeply nested the measurement is.
+ * @param dur How long it lasted for, in seconds.
+ * @param total How long the entire procedure lasted for.
+ * @param nr_allocs How many heap allocations it made.
+ * Only written if they're being counted.
+ * @param alloc_bytes How many bytes it heap-allocated.
+ * Only written if they're being counted.
+ */
+void PerformanceMonitor::Page::write_measurement(
+    string &str, const string &name, size_t depth, double dur, float total,
+    double nr_allocs, double alloc_bytes
+) {
+    float perc = dur / total * 100.0;
+    string indent(depth * 2, ' ');
+    str +=
+        "  " + indent + name + "\n" +
+        "    " + indent + box_string(std::to_string(dur), 8, "s") +
+        " (" + f2s(perc) + "%)\n    " + indent;
+    for(unsigned char p = 0; p < 100; p++) {
+        if(p < perc) {
+            str.push_back('#');
+        } else {
+            str.push_back('_');
+        }
+    }
+    str += "\n";
+    if(code_debug_alloc_counting) {
+        str +=
+            "    " + indent + "Allocations: " + f2s(nr_allocs) + " (" +
+            f2s(alloc_bytes) + " bytes)\n";
+    }
+}
+
+
+/**
+ * @brief Adds some runs to the cost.
+ *
+ * @param nr_runs How many runs to add.
+ * @param duration How long they took in total, in seconds.
+ */
+void PerformanceMonitor::ScriptCost::add(size_t nr_runs, double duration) {
+    this->nr_runs += nr_runs;
+    this->duration += duration;
+}
+
+
+/**
+ * @brief Returns whether this key comes before another, so the keys can
+ * be sorted.
+ *
+ * @param k2 Key to compare with.
+ * @return Whether it comes before.
+ */
+bool PerformanceMonitor::ScriptEventKey::operator<(
+    const ScriptEventKey &k2
+) const {
+    if(mob_type_name != k2.mob_type_name) {
+        return mob_type_name < k2.mob_type_name;
+    }
+    if(state_name != k2.state_name) {
+        return state_name < k2.state_name;
+    }
+    return event_type < k2.event_type;
+}
+
+
+/**
+ * @brief Constructs a new performance monitor scope object, and starts
+ * the measurement.
+ *
+ * @param monitor Performance monitor to use, if any.
+ * @param id ID of the measurement.
+ * @param mob_id ID of the object this measurement refers to, if any.
+ * @param mob_type_name Name of the type of object this measurement refers
+ * to, if any.
+ */
+PerformanceMonitorScope::PerformanceMonitorScope(
+    PerformanceMonitor* monitor, size_t id,
+    size_t mob_id, const string* mob_type_name
+) :
+    monitor(monitor) {
+    
+    if(monitor) monitor->start_measurement(id, mob_id, mob_type_name);
+}
+
+
+/**
+ * @brief Destroys the performance monitor scope object, and finishes
+ * the measurement.
+ */
+PerformanceMonitorScope::~PerformanceMonitorScope() {
+    if(monitor) monitor->finish_measurement();
+}
+
+
+/**
+ * @brief Constructs a new reader setter object.
+ *
+ * @param dn Pointer to the base data node.
+ */
+ReaderSetter::ReaderSetter(DataNode* dn) :
+    node(dn) {
+    
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is an Allegro color.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, ALLEGRO_COLOR &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2c(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is a string.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, string &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = n->value;
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is an integer.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, size_t &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2i(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is an integer.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, int &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2i(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is an unsigned integer.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, unsigned int &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2i(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is an unsigned char.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, unsigned char &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2i(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is a boolean.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, bool &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2b(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is a float.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, float &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2f(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is a double.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, double &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2f(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+/**
+ * @brief Reads a child node's value, and uses it to set a variable.
+ * Will not do anything if the child's value is empty.
+ *
+ * @param child_name Name of the child node.
+ * @param var The var to set. This is a point.
+ * @param out_child_node If not nullptr, the node from whence the value came
+ * is placed here. nullptr is placed if the property does not exist or has
+ * no value.
+ */
+void ReaderSetter::set(
+    const string &child_name, Point &var, DataNode** out_child_node
+) {
+    DataNode* n = node->getChildByName(child_name);
+    if(!n->value.empty()) {
+        if(out_child_node) *out_child_node = n;
+        var = s2p(n->value);
+    } else {
+        if(out_child_node) *out_child_node = nullptr;
+    }
+}
+
+
+
+/**
+ * @brief Returns a random float between the provided range, inclusive.
+ *
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+float RngManager::f(float minimum, float maximum) {
+    if(minimum == maximum) return minimum;
+    if(minimum > maximum) std::swap(minimum, maximum);
+    
+    return
+        (float) linear_congruential_generator(&state) /
+        ((float) INT32_MAX / (maximum - minimum)) + minimum;
+}
+
+
+/**
+ * @brief Returns a new random number stream, independent from the main
+ * sequence and from all other streams. Asking for the same subsystem and ID
+ * with the same seed always gives a stream with the same numbers.
+ *
+ * @param subsystem Subsystem the stream is for.
+ * @param id Identifier inside the subsystem, like a mob's ID.
+ * @return The stream.
+ */
+RngStream RngManager::get_stream(RNG_STREAM subsystem, uint32_t id) const {
+    return RngStream(hash_nr2(hash_nr2(seed, subsystem), id));
+}
+
+
+/**
+ * @brief Returns a random integer between the provided range, inclusive.
+ *
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+int32_t RngManager::i(int32_t minimum, int32_t maximum) {
+    if(minimum == maximum) return minimum;
+    if(minimum > maximum) std::swap(minimum, maximum);
+    
+    if(minimum == maximum) return minimum;
+    if(minimum > maximum) std::swap(minimum, maximum);
+    return
+        (
+            (linear_congruential_generator(&state)) %
+            (maximum - minimum + 1)
+        ) + minimum;
+}
+
+
+/**
+ * @brief Initializes the random number generator, using the current time as
+ * the seed.
+ */
+void RngManager::init() {
+    init(time(nullptr));
+}
+
+
+/**
+ * @brief Initializes the random number generator with the given seed.
+ */
+void RngManager::init(int32_t initial_seed) {
+    state = initial_seed;
+    seed = initial_seed;
+}
+
+
+
+/**
+ * @brief Constructs a new random number stream object.
+ *
+ * @param key Key that sets this stream apart from others.
+ */
+RngStream::RngStream(uint32_t key) :
+    key(key) {
+    
+}
+
+
+/**
+ * @brief Returns a random float between the provided range, inclusive,
+ * and advances the stream.
+ *
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+float RngStream::f(float minimum, float maximum) {
+    float result = f_at(counter, minimum, maximum);
+    counter++;
+    return result;
+}
+
+
+/**
+ * @brief Returns the random float at the given index of the stream,
+ * between the provided range, inclusive. This doesn't advance the stream,
+ * so it can be used from several threads at once, with each thread
+ * asking for its own indexes.
+ *
+ * @param idx Index of the number in the stream.
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+float RngStream::f_at(uint32_t idx, float minimum, float maximum) const {
+    if(minimum == maximum) return minimum;
+    if(minimum > maximum) std::swap(minimum, maximum);
+    
+    return
+        (float) counter_based_generator(key, idx) /
+        ((float) INT32_MAX / (maximum - minimum)) + minimum;
+}
+
+
+/**
+ * @brief Returns a random integer between the provided range, inclusive,
+ * and advances the stream.
+ *
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+int32_t RngStream::i(int32_t minimum, int32_t maximum) {
+    int32_t result = i_at(counter, minimum, maximum);
+    counter++;
+    return result;
+}
+
+
+/**
+ * @brief Returns the random integer at the given index of the stream,
+ * between the provided range, inclusive. This doesn't advance the stream.
+ *
+ * @param idx Index of the number in the stream.
+ * @param minimum Minimum value that can be generated, inclusive.
+ * @param maximum Maximum value that can be generated, inclusive.
+ * @return The random number.
+ */
+int32_t RngStream::i_at(
+    uint32_t idx, int32_t minimum, int32_t maximum
+) const {
+    if(minimum == maximum) return minimum;
+    if(minimum > maximum) std::swap(minimum, maximum);
+    
+    return
+        (
+            counter_based_generator(key, idx) %
+            (maximum - minimum + 1)
+        ) + minimum;
+}
+
+
+
+/**
+ * @brief Constructs a new script var reader object.
+ *
+ * @param vars Map of variables to read from.
+ */
+ScriptVarReader::ScriptVarReader(const map<string, string> &vars) :
+    vars(vars) {
+    
+}
+
+
+/**
+ * @brief Assigns an Allegro color to the value of a given variable,
+ * if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, ALLEGRO_COLOR &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2c(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns a string to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, string &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = v->second;
+    return true;
+}
+
+
+/**
+ * @brief Assigns a size_t to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, size_t &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2i(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns an int to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, int &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2i(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns an unsigned char to the value of a given variable,
+ * if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, unsigned char &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2i(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns a bool to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, bool &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2b(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns a float to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, float &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2f(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Assigns a point to the value of a given variable, if it exists.
+ *
+ * @param name Name of the variable to read.
+ * @param dest Destination for the value.
+ * @return Whether it exists.
+ */
+bool ScriptVarReader::get(const string &name, Point &dest) const {
+    auto v = vars.find(name);
+    if(v == vars.end()) {
+        return false;
+    }
+    dest = s2p(v->second);
+    return true;
+}
+
+
+/**
+ * @brief Returns the slot of a given variable name.
+ *
+ * @param name Name of the variable.
+ * @return The slot, or INVALID if it was never interned.
+ */
+size_t ScriptVarTable::find(const string &name) const {
+    auto s = slots.find(name);
+    if(s == slots.end()) return INVALID;
+    return s->second;
+}
+
+
+/**
+ * @brief Returns the slot of a given variable name, creating a new slot
+ * if it doesn't have one yet.
+ *
+ * @param name Name of the variable.
+ * @return The slot.
+ */
+size_t ScriptVarTable::intern(const string &name) {
+    auto s = slots.find(name);
+    if(s != slots.end()) return s->second;
+    size_t slot = names.size();
+    names.push_back(name);
+    slots[name] = slot;
+    return slot;
+}
+
+
+/**
+ * @brief Returns the value as a bool.
+ *
+ * @return The value.
+ */
+bool ScriptVarValue::get_bool() const {
+    if(type == SCRIPT_VAR_TYPE_TEXT) return s2b(text);
+    return (int) number != 0;
+}
+
+
+/**
+ * @brief Returns the value as a float.
+ *
+ * @return The value.
+ */
+float ScriptVarValue::get_float() const {
+    if(type == SCRIPT_VAR_TYPE_TEXT) return s2f(text);
+    return (float) number;
+}
+
+
+/**
+ * @brief Returns the value as an int.
+ *
+ * @return The value.
+ */
+int ScriptVarValue::get_int() const {
+    if(type == SCRIPT_VAR_TYPE_TEXT) return s2i(text);
+    return (int) number;
+}
+
+
+/**
+ * @brief Returns the value as text. Numbers are written the same way
+ * they would be if they had been stored as text.
+ *
+ * @return The value.
+ */
+string ScriptVarValue::get_text() const {
+    switch(type) {
+    case SCRIPT_VAR_TYPE_INT: {
+        return i2s(number);
+    } case SCRIPT_VAR_TYPE_FLOAT: {
+        return f2s(number);
+    } default: {
+        return text;
+    }
+    }
+}
+
+
+/**
+ * @brief Sets the value to a float.
+ *
+ * @param value New value.
+ */
+void ScriptVarValue::set_float(float value) {
+    type = SCRIPT_VAR_TYPE_FLOAT;
+    number = value;
+    text.clear();
+    was_set = true;
+}
+
+
+/**
+ * @brief Sets the value to an int.
+ *
+ * @param value New value.
+ */
+void ScriptVarValue::set_int(long long value) {
+    type = SCRIPT_VAR_TYPE_INT;
+    number = (double) value;
+    text.clear();
+    was_set = true;
+}
+
+
+/**
+ * @brief Sets the value to some text.
+ *
+ * @param value New value.
+ */
+void ScriptVarValue::set_text(const string &value) {
+    type = SCRIPT_VAR_TYPE_TEXT;
+    number = 0.0;
+    text = value;
+    was_set = true;
+}
+
+
+/**
+ * @brief Samples that are kept compressed in memory.
+ */
+struct SampleManager::CompressedSamples {
+
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief The compressed contents of a sample.
+     */
+    struct Entry {
+    
+        //--- Members ---
+        
+        //Contents of the audio file.
+        vector<unsigned char> data;
+        
+        //Extension of the audio file, with the dot, so Allegro knows
+        //how to decode it.
+        string extension;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Compressed contents, by their placeholder sample.
+    map<const ALLEGRO_SAMPLE*, Entry> entries;
+    
+    //Controls access to the entries.
+    mutable std::mutex mutex;
+    
+};
+
+
+/**
+ * @brief Constructs a new sample manager object.
+ */
+SampleManager::SampleManager() :
+    compressed(new CompressedSamples()) {
+    
+}
+
+
+/**
+ * @brief Destroys the sample manager object.
+ */
+SampleManager::~SampleManager() {
+    delete compressed;
+}
+
+
+/**
+ * @brief Creates an audio stream that plays a sample that's kept compressed.
+ * The stream isn't attached to anything. Destroy it when done.
+ * This is safe to call from any thread.
+ *
+ * @param sample The sample's placeholder.
+ * @return The stream, or nullptr if the sample isn't kept compressed,
+ * or if it couldn't be created.
+ */
+ALLEGRO_AUDIO_STREAM* SampleManager::create_compressed_stream(
+    const ALLEGRO_SAMPLE* sample
+) const {
+    std::unique_lock<std::mutex> lock(compressed->mutex);
+    auto it = compressed->entries.find(sample);
+    if(it == compressed->entries.end()) return nullptr;
+    
+    ALLEGRO_FILE* file =
+        open_memory_file(it->second.data.data(), it->second.data.size());
+    if(!file) return nullptr;
+    return
+        al_load_audio_stream_f(
+            file, it->second.extension.c_str(),
+            SAMPLE_MANAGER::STREAM_BUFFER_COUNT,
+            SAMPLE_MANAGER::STREAM_BUFFER_SAMPLES
+        );
+}
+
+
+/**
+ * @brief Loads an audio sample for the manager.
+ *
+ * @param name Name of the audio sample to load.
+ * @param node If not nullptr, blame this data node if the file doesn't exist.
+ * @param report_errors Only issues errors if this is true.
+ * @return The audio sample.
+ */
+ALLEGRO_SAMPLE* SampleManager::do_load(
+    const string &name, DataNode* node, bool report_errors
+) {
+    const auto &it = game.content.sounds.manifests.find(name);
+    string path =
+        it != game.content.sounds.manifests.end() ?
+        it->second.path :
+        name;
+    ALLEGRO_SAMPLE* sample = load_compressed(path);
+    if(sample) return sample;
+    return load_sample(path, node, report_errors);
+}
+
+
+/**
+ * @brief Unloads an audio sample for the manager.
+ *
+ * @param asset Audio sample to unload.
+ */
+void SampleManager::do_unload(ALLEGRO_SAMPLE* asset) {
+    std::unique_lock<std::mutex> lock(compressed->mutex);
+    compressed->entries.erase(asset);
+    lock.unlock();
+    al_destroy_sample(asset);
+}
+
+
+/**
+ * @brief Returns roughly how much memory an audio sample takes up, in bytes.
+ *
+ * @param asset Audio sample to check.
+ * @return The size.
+ */
+size_t SampleManager::get_asset_size(ALLEGRO_SAMPLE* asset) const {
+    if(!asset) return 0;
+    std::unique_lock<std::mutex> lock(compressed->mutex);
+    auto it = compressed->entries.find(asset);
+    if(it != compressed->entries.end()) {
+        return it->second.data.size();
+    }
+    lock.unlock();
+    
+    return
+        (size_t) al_get_sample_length(asset) *
+        al_get_channel_count(al_get_sample_channels(asset)) *
+        al_get_audio_depth_size(al_get_sample_depth(asset));
+}
+
+
+/**
+ * @brief Loads an audio sample such that it's kept compressed in memory,
+ * if it's a compressed audio file that's big enough for it to be worth it.
+ *
+ * @param path Path to the audio file.
+ * @return The placeholder sample, or nullptr if it should be loaded
+ * normally instead.
+ */
+ALLEGRO_SAMPLE* SampleManager::load_compressed(const string &path) {
+    string extension = str_to_lower(path.substr(remove_extension(path).size()));
+    if(extension != ".ogg" && extension != ".opus") return nullptr;
+    
+    //Read the file's contents.
+    ALLEGRO_FILE* file = al_fopen(path.c_str(), "rb");
+    if(!file) return nullptr;
+    int64_t file_size = al_fsize(file);
+    if(
+        file_size < 0 ||
+        (size_t) file_size < SAMPLE_MANAGER::COMPRESSED_MIN_FILE_SIZE
+    ) {
+        al_fclose(file);
+        return nullptr;
+    }
+    CompressedSamples::Entry entry;
+    entry.data.resize((size_t) file_size);
+    entry.extension = extension;
+    size_t amount_read = al_fread(file, entry.data.data(), entry.data.size());
+    al_fclose(file);
+    if(amount_read != entry.data.size()) return nullptr;
+    
+    //Find the audio's format by opening it as a stream.
+    ALLEGRO_FILE* mem_file =
+        open_memory_file(entry.data.data(), entry.data.size());
+    if(!mem_file) return nullptr;
+    ALLEGRO_AUDIO_STREAM* stream =
+        al_load_audio_stream_f(
+            mem_file, extension.c_str(),
+            SAMPLE_MANAGER::STREAM_BUFFER_COUNT,
+            SAMPLE_MANAGER::STREAM_BUFFER_SAMPLES
+        );
+    if(!stream) return nullptr;
+    unsigned int frequency = al_get_audio_stream_frequency(stream);
+    ALLEGRO_AUDIO_DEPTH depth = al_get_audio_stream_depth(stream);
+    ALLEGRO_CHANNEL_CONF channels = al_get_audio_stream_channels(stream);
+    al_destroy_audio_stream(stream);
+    
+    //Create the placeholder. A single frame of silence in the same format.
+    size_t frame_size =
+        al_get_channel_count(channels) * al_get_audio_depth_size(depth);
+    void* buffer = al_calloc(1, frame_size);
+    ALLEGRO_SAMPLE* sample =
+        al_create_sample(buffer, 1, frequency, depth, channels, true);
+    if(!sample) {
+        al_free(buffer);
+        return nullptr;
+    }
+    
+    std::unique_lock<std::mutex> lock(compressed->mutex);
+    compressed->entries[sample] = std::move(entry);
+    return sample;
+}
+
+
+/**
+ * @brief The textures that a sector texture streamer's worker finished
+ * decoding.
+ */
+struct SectorTextureStreamer::SyncData {
+
+    /**
+     * @brief A texture that the worker has decoded.
+     */
+    struct Result {
+        
+        //--- Members ---
+        
+        //Internal name of the texture.
+        string name;
+        
+        //Path to its image file.
+        string path;
+        
+        //Decoded memory bitmap, or nullptr if it couldn't be decoded.
+        ALLEGRO_BITMAP* mem_bmp = nullptr;
+    
+    };
+    
+    
+    //--- Members ---
+    
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Textures that are decoded, and waiting for the main thread.
+    std::deque<Result> results;
+    
+};
+
+
+/**
+ * @brief Constructs a new sector texture streamer object.
+ * The worker isn't started.
+ */
+SectorTextureStreamer::SectorTextureStreamer() :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Constructs a new sector texture streamer object by copying another.
+ * Worker threads can't be copied, so the new streamer starts without one.
+ *
+ * @param s2 Streamer to copy from.
+ */
+SectorTextureStreamer::SectorTextureStreamer(
+    const SectorTextureStreamer &s2
+) :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Copies a sector texture streamer from another one. Worker threads
+ * can't be copied, so this one just keeps its own.
+ *
+ * @param s2 Streamer to copy from.
+ * @return The current object.
+ */
+SectorTextureStreamer &SectorTextureStreamer::operator =(
+    const SectorTextureStreamer &s2
+) {
+    return *this;
+}
+
+
+/**
+ * @brief Destroys the sector texture streamer object.
+ */
+SectorTextureStreamer::~SectorTextureStreamer() {
+    stop();
+    delete sync;
+}
+
+
+/**
+ * @brief Forgets about every texture that was requested. Textures that the
+ * worker is decoding right now are thrown away once they arrive, unless some
+ * sector asked for them again in the meantime.
+ */
+void SectorTextureStreamer::clear() {
+    worker.clear();
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    for(size_t r = 0; r < sync->results.size(); r++) {
+        if(sync->results[r].mem_bmp) {
+            al_destroy_bitmap(sync->results[r].mem_bmp);
+        }
+    }
+    sync->results.clear();
+    pending.clear();
+}
+
+
+/**
+ * @brief Hands a decoded texture to every sector of the current area that's
+ * waiting for it.
+ *
+ * @param name Internal name of the texture.
+ * @param path Path to its image file.
+ * @param mem_bmp Decoded memory bitmap, or nullptr if it couldn't be decoded.
+ * This function takes care of destroying it.
+ */
+void SectorTextureStreamer::deliver(
+    const string &name, const string &path, ALLEGRO_BITMAP* mem_bmp
+) {
+    pending.erase(name);
+    
+    vector<Sector*> waiting;
+    if(game.cur_area_data) {
+        for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+            Sector* s_ptr = game.cur_area_data->sectors[s];
+            if(
+                s_ptr->texture_info.bitmap == placeholder &&
+                s_ptr->texture_info.bmp_name == name
+            ) {
+                waiting.push_back(s_ptr);
+            }
+        }
     }
     
-    ALLEGRO_FILE* file_o =
-        al_fopen(FILE_PATHS_FROM_ROOT::PERFORMANCE_LOG.c_str(), "w");
-    if(file_o) {
-        al_fwrite(file_o, prev_log + s);
-        al_fclose(file_o);
+    ALLEGRO_BITMAP* bmp = nullptr;
+    if(mem_bmp) {
+        if(!waiting.empty()) {
+            bmp = upload(mem_bmp);
+        }
+        al_destroy_bitmap(mem_bmp);
+    }
+    if(waiting.empty()) {
+        if(bmp) al_destroy_bitmap(bmp);
+        return;
+    }
+    
+    if(bmp) {
+        bmp = game.content.bitmaps.list.add(name, bmp, waiting.size());
+    } else {
+        game.errors.report("Could not open image \"" + path + "\"!");
+        bmp = game.bmp_error;
+    }
+    for(size_t s = 0; s < waiting.size(); s++) {
+        waiting[s]->texture_info.bitmap = bmp;
     }
 }
 
 
 /**
- * @brief Sets the name of the area that was monitored.
+ * @brief Returns how many textures are still on their way.
  *
- * @param name Name of the area.
+ * @return The amount.
  */
-void PerformanceMonitor::set_area_name(const string &name) {
-    area_name = name;
+size_t SectorTextureStreamer::get_nr_pending() const {
+    return pending.size();
 }
 
 
 /**
- * @brief Sets whether monitoring is currently paused or not.
+ * @brief Returns the texture that sectors use while their real texture
+ * is on its way.
  *
- * @param paused Pause value.
+ * @return The bitmap.
  */
-void PerformanceMonitor::set_paused(bool paused) {
-    this->paused = paused;
+ALLEGRO_BITMAP* SectorTextureStreamer::get_placeholder() const {
+    return placeholder;
 }
 
 
 /**
- * @brief Starts measuring a certain point in the loading procedure.
+ * @brief Gives a sector its texture, according to its texture's internal
+ * name. If the texture isn't loaded yet, the sector gets the placeholder
+ * texture, and the real one gets decoded in the background.
+ * If the worker isn't running, or the texture is already loaded,
+ * the sector gets it right away.
  *
- * @param name Name of the measurement.
+ * @param s_ptr Sector to give the texture to.
  */
-void PerformanceMonitor::start_measurement(const string &name) {
-    if(paused) return;
+void SectorTextureStreamer::request(Sector* s_ptr) {
+    const string &name = s_ptr->texture_info.bmp_name;
+    if(
+        !worker.is_running() || name.empty() ||
+        game.content.bitmaps.list.is_loaded(name)
+    ) {
+        s_ptr->texture_info.bitmap =
+            game.content.bitmaps.list.get(name, nullptr);
+        return;
+    }
     
-    //Check if we were already measuring something.
-    engine_assert(
-        cur_measurement_start_time == 0.0,
-        cur_page.measurements.empty() ?
-        "(No measurements)" :
-        "Last measurement: " + cur_page.measurements.back().first
+    s_ptr->texture_info.bitmap = placeholder;
+    if(pending.find(name) != pending.end()) return;
+    pending.insert(name);
+    
+    const auto &it = game.content.bitmaps.manifests.find(name);
+    string path =
+        it != game.content.bitmaps.manifests.end() ?
+        it->second.path :
+        name;
+        
+    worker.add(
+    [this, name, path] () {
+        SyncData::Result result;
+        result.name = name;
+        result.path = path;
+        result.mem_bmp = al_load_bitmap(path.c_str());
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        sync->results.push_back(result);
+    }
+    );
+}
+
+
+/**
+ * @brief Starts the worker thread and creates the placeholder texture.
+ * This must be called after the new bitmap flags are set up, since
+ * the worker uses those, but for memory bitmaps. If the worker
+ * was already running, it is restarted.
+ */
+void SectorTextureStreamer::start() {
+    stop();
+    
+    placeholder = al_create_bitmap(1, 1);
+    ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+    al_set_target_bitmap(placeholder); {
+        al_clear_to_color(
+            al_map_rgb(
+                SECTOR_TEXTURE_STREAMER::PLACEHOLDER_COLOR[0],
+                SECTOR_TEXTURE_STREAMER::PLACEHOLDER_COLOR[1],
+                SECTOR_TEXTURE_STREAMER::PLACEHOLDER_COLOR[2]
+            )
+        );
+    } al_set_target_bitmap(old_target);
+    
+    //Bitmap flags are per thread, so the worker gets its own.
+    int worker_bmp_flags = al_get_new_bitmap_flags();
+    disable_flag(worker_bmp_flags, ALLEGRO_VIDEO_BITMAP);
+    disable_flag(worker_bmp_flags, ALLEGRO_MIPMAP);
+    enable_flag(worker_bmp_flags, ALLEGRO_MEMORY_BITMAP);
+    worker.start(
+    [worker_bmp_flags] () {
+        al_set_new_bitmap_flags(worker_bmp_flags);
+    }
     );
+}
+
+
+/**
+ * @brief Stops the worker thread, forgets about every requested texture,
+ * and destroys the placeholder texture.
+ */
+void SectorTextureStreamer::stop() {
+    worker.stop();
+    clear();
+    if(placeholder) {
+        al_destroy_bitmap(placeholder);
+        placeholder = nullptr;
+    }
+}
+
+
+/**
+ * @brief Hands the textures that finished decoding to the sectors
+ * waiting for them. This is meant to be called once per frame.
+ *
+ * @param budget Stop after spending this many seconds. At least one
+ * texture is always handled, if there are any.
+ */
+void SectorTextureStreamer::update(double budget) {
+    if(!worker.is_running()) return;
     
-    cur_measurement_start_time = al_get_time();
-    cur_measurement_name = name;
+    double start_time = al_get_time();
+    while(true) {
+        SyncData::Result result;
+        {
+            std::unique_lock<std::mutex> lock(sync->mutex);
+            if(sync->results.empty()) break;
+            result = sync->results.front();
+            sync->results.pop_front();
+        }
+        deliver(result.name, result.path, result.mem_bmp);
+        if(al_get_time() - start_time >= budget) break;
+    }
 }
 
 
 /**
- * @brief Writes a page of information to a string.
+ * @brief Uploads a decoded texture to video memory, in the format that
+ * the texture quality option asks for. Mipmaps are generated along with it,
+ * if they're enabled, so zoomed-out cameras sample a smaller level.
  *
- * @param s String to write to.
+ * @param mem_bmp Memory bitmap with the decoded texture.
+ * @return The video bitmap, or nullptr on failure.
  */
-void PerformanceMonitor::Page::write(string &s) {
-    //Get the total measured time.
-    double total_measured_time = 0.0;
-    for(size_t m = 0; m < measurements.size(); m++) {
-        total_measured_time += measurements[m].second;
+ALLEGRO_BITMAP* SectorTextureStreamer::upload(ALLEGRO_BITMAP* mem_bmp) {
+    int format = ALLEGRO_PIXEL_FORMAT_ANY;
+    if(
+        std::max(al_get_bitmap_width(mem_bmp), al_get_bitmap_height(mem_bmp))
+        >= SECTOR_TEXTURE_STREAMER::LOWER_QUALITY_MIN_SIZE
+    ) {
+        switch(game.options.graphics.texture_quality) {
+        case TEXTURE_QUALITY_FULL: {
+            break;
+        } case TEXTURE_QUALITY_COMPRESSED: {
+            format = ALLEGRO_PIXEL_FORMAT_COMPRESSED_RGBA_DXT5;
+            break;
+        } case TEXTURE_QUALITY_16_BIT: {
+            format = ALLEGRO_PIXEL_FORMAT_RGBA_4444;
+            break;
+        } case N_TEXTURE_QUALITIES: {
+            break;
+        }
+        }
     }
     
-    //Write each measurement into the string.
-    for(size_t m = 0; m < measurements.size(); m++) {
-        write_measurement(
-            s, measurements[m].first,
-            measurements[m].second,
-            total_measured_time
-        );
-    }
+    //Cloning with the normal flags uploads it to video memory.
+    int old_format = al_get_new_bitmap_format();
+    al_set_new_bitmap_format(format);
+    ALLEGRO_BITMAP* bmp = al_clone_bitmap(mem_bmp);
+    al_set_new_bitmap_format(old_format);
     
-    //Write the total.
-    s +=
-        "  TOTAL: " + std::to_string(duration) + "s (" +
-        std::to_string(total_measured_time) + "s measured, " +
-        std::to_string(duration - total_measured_time) + "s not measured).\n";
+    if(!bmp && format != ALLEGRO_PIXEL_FORMAT_ANY) {
+        //The graphics backend doesn't support that format.
+        bmp = al_clone_bitmap(mem_bmp);
+    }
+    return bmp;
 }
 
 
 /**
- * @brief Writes a measurement in a human-friendly format onto a string.
- *
- * @param str The string to write to.
- * @param name The name of this measurement.
- * @param dur How long it lasted for, in seconds.
- * @param total How long the entire procedure lasted for.
+ * @brief Waits for the worker to decode everything that was requested,
+ * and then hands all of it to the sectors, regardless of how long it takes.
+ * Useful for when a request must be fully loaded, like
+ * when drawing the area to an image.
  */
-void PerformanceMonitor::Page::write_measurement(
-    string &str, const string &name, double dur, float total
-) {
-    float perc = dur / total * 100.0;
-    str +=
-        "  " + name + "\n" +
-        "    " + box_string(std::to_string(dur), 8, "s") +
-        " (" + f2s(perc) + "%)\n    ";
-    for(unsigned char p = 0; p < 100; p++) {
-        if(p < perc) {
-            str.push_back('#');
-        } else {
-            str.push_back('_');
-        }
-    }
-    str += "\n";
+void SectorTextureStreamer::wait_for_all() {
+    if(!worker.is_running()) return;
+    
+    worker.wait_for_all();
+    update(DBL_MAX);
 }
 
 
 /**
- * @brief Constructs a new reader setter object.
- *
- * @param dn Pointer to the base data node.
+ * @brief The files that a background file writer's worker
+ * couldn't write.
  */
-ReaderSetter::ReaderSetter(DataNode* dn) :
-    node(dn) {
+struct BackgroundFileWriter::SyncData {
+
+    //--- Members ---
     
-}
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Paths of the files that couldn't be written, and that nobody
+    //has been told about yet.
+    std::deque<string> failures;
+    
+};
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
- *
- * @param child_name Name of the child node.
- * @param var The var to set. This is an Allegro color.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @brief Constructs a new background file writer object.
+ * The worker isn't started.
  */
-void ReaderSetter::set(
-    const string &child_name, ALLEGRO_COLOR &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2c(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+BackgroundFileWriter::BackgroundFileWriter() :
+    sync(new SyncData()) {
+
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Constructs a new background file writer object by copying another.
+ * Worker threads can't be copied, so the new writer starts without one.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is a string.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param w2 Writer to copy from.
  */
-void ReaderSetter::set(
-    const string &child_name, string &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = n->value;
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+BackgroundFileWriter::BackgroundFileWriter(
+    const BackgroundFileWriter &w2
+) :
+    sync(new SyncData()) {
+
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Copies a background file writer from another one. Worker threads
+ * can't be copied, so this one just keeps its own.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is an integer.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param w2 Writer to copy from.
+ * @return The current object.
  */
-void ReaderSetter::set(
-    const string &child_name, size_t &var, DataNode** out_child_node
+BackgroundFileWriter &BackgroundFileWriter::operator =(
+    const BackgroundFileWriter &w2
 ) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2i(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+    return *this;
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
- *
- * @param child_name Name of the child node.
- * @param var The var to set. This is an integer.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @brief Destroys the background file writer object.
  */
-void ReaderSetter::set(
-    const string &child_name, int &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2i(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+BackgroundFileWriter::~BackgroundFileWriter() {
+    stop();
+    delete sync;
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Remembers that a file couldn't be written, so that whoever asks
+ * can be told about it.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is an unsigned integer.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param path Path of the file.
  */
-void ReaderSetter::set(
-    const string &child_name, unsigned int &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2i(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+void BackgroundFileWriter::add_failure(const string &path) {
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->failures.push_back(path);
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Returns how many files are still waiting to be written,
+ * including the one being written right now.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is an unsigned char.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @return The amount.
  */
-void ReaderSetter::set(
-    const string &child_name, unsigned char &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2i(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+size_t BackgroundFileWriter::get_nr_pending() const {
+    return worker.get_nr_pending();
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Returns the path of the oldest file that couldn't be written,
+ * and forgets about it.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is a boolean.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param out_path The path is returned here.
+ * @return Whether there was any failure to report.
  */
-void ReaderSetter::set(
-    const string &child_name, bool &var, DataNode** out_child_node
-) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2b(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+bool BackgroundFileWriter::pop_failure(string* out_path) {
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    if(sync->failures.empty()) return false;
+    *out_path = sync->failures.front();
+    sync->failures.pop_front();
+    return true;
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Writes a bitmap to an image file, with every pixel fully opaque,
+ * and destroys the bitmap.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is a float.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param bmp Memory bitmap to write.
+ * @param path Path to write to. The extension decides the image format.
+ * @return Whether it succeeded.
  */
-void ReaderSetter::set(
-    const string &child_name, float &var, DataNode** out_child_node
+bool BackgroundFileWriter::save_bitmap(
+    ALLEGRO_BITMAP* bmp, const string &path
 ) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2f(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
+    //Alpha operations on the backbuffer behave weirdly, and on some
+    //machines those weird alpha values end up in the saved image,
+    //so set every pixel's alpha to 255 first.
+    ALLEGRO_LOCKED_REGION* region =
+        al_lock_bitmap(
+            bmp, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_READWRITE
+        );
+    if(region) {
+        unsigned char* row = (unsigned char*) region->data;
+        int bmp_w = al_get_bitmap_width(bmp);
+        int bmp_h = al_get_bitmap_height(bmp);
+        for(int y = 0; y < bmp_h; y++) {
+            for(int x = 0; x < bmp_w; x++) {
+                row[x * 4 + 3] = 255;
+            }
+            row += region->pitch;
+        }
+        al_unlock_bitmap(bmp);
     }
+    
+    bool success = al_save_bitmap(path.c_str(), bmp);
+    al_destroy_bitmap(bmp);
+    return success;
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Writes a data file to a temporary file, and then moves it
+ * over the real one.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is a double.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param node Data node with the file's contents.
+ * @param path Path to write to.
+ * @return Whether it succeeded.
  */
-void ReaderSetter::set(
-    const string &child_name, double &var, DataNode** out_child_node
+bool BackgroundFileWriter::save_file(
+    const DataNode &node, const string &path
 ) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2f(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+    string temp_path = path + BACKGROUND_FILE_WRITER::TEMP_SUFFIX;
+    return use_temp_file(node.saveFile(temp_path), temp_path, path);
 }
 
 
 /**
- * @brief Reads a child node's value, and uses it to set a variable.
- * Will not do anything if the child's value is empty.
+ * @brief Writes a data file's text to a temporary file, and then moves it
+ * over the real one.
  *
- * @param child_name Name of the child node.
- * @param var The var to set. This is a point.
- * @param out_child_node If not nullptr, the node from whence the value came
- * is placed here. nullptr is placed if the property does not exist or has
- * no value.
+ * @param text Data node writer with the file's text.
+ * @param path Path to write to.
+ * @return Whether it succeeded.
  */
-void ReaderSetter::set(
-    const string &child_name, Point &var, DataNode** out_child_node
+bool BackgroundFileWriter::save_file(
+    const DataNodeWriter &text, const string &path
 ) {
-    DataNode* n = node->getChildByName(child_name);
-    if(!n->value.empty()) {
-        if(out_child_node) *out_child_node = n;
-        var = s2p(n->value);
-    } else {
-        if(out_child_node) *out_child_node = nullptr;
-    }
+    string temp_path = path + BACKGROUND_FILE_WRITER::TEMP_SUFFIX;
+    return use_temp_file(text.saveFile(temp_path), temp_path, path);
 }
 
 
+/**
+ * @brief Starts the worker thread. If it was already running,
+ * it is restarted.
+ */
+void BackgroundFileWriter::start() {
+    stop();
+    worker.start();
+}
+
 
 /**
- * @brief Returns a random float between the provided range, inclusive.
- *
- * @param minimum Minimum value that can be generated, inclusive.
- * @param maximum Maximum value that can be generated, inclusive.
- * @return The random number.
+ * @brief Stops the worker thread. Files that were handed in before this
+ * are still written first.
  */
-float RngManager::f(float minimum, float maximum) {
-    if(minimum == maximum) return minimum;
-    if(minimum > maximum) std::swap(minimum, maximum);
-    
-    return
-        (float) linear_congruential_generator(&state) /
-        ((float) INT32_MAX / (maximum - minimum)) + minimum;
+void BackgroundFileWriter::stop() {
+    worker.wait_for_all();
+    worker.stop();
 }
 
 
 /**
- * @brief Returns a random integer between the provided range, inclusive.
+ * @brief Finishes writing a file through a temporary file. If the temporary
+ * file was written, it is moved over the real one. Otherwise, or if
+ * that fails, the temporary file is deleted.
  *
- * @param minimum Minimum value that can be generated, inclusive.
- * @param maximum Maximum value that can be generated, inclusive.
- * @return The random number.
+ * @param saved Whether the temporary file was written successfully.
+ * @param temp_path Path to the temporary file.
+ * @param path Path to the real file.
+ * @return Whether the real file ended up written.
  */
-int32_t RngManager::i(int32_t minimum, int32_t maximum) {
-    if(minimum == maximum) return minimum;
-    if(minimum > maximum) std::swap(minimum, maximum);
-    
-    if(minimum == maximum) return minimum;
-    if(minimum > maximum) std::swap(minimum, maximum);
-    return
-        (
-            (linear_congruential_generator(&state)) %
-            (maximum - minimum + 1)
-        ) + minimum;
+bool BackgroundFileWriter::use_temp_file(
+    bool saved, const string &temp_path, const string &path
+) {
+    std::error_code error;
+    if(saved) {
+        std::filesystem::rename(temp_path, path, error);
+        if(!error) return true;
+    }
+    std::filesystem::remove(temp_path, error);
+    return false;
 }
 
 
 /**
- * @brief Initializes the random number generator, using the current time as
- * the seed.
+ * @brief Waits for the worker to write every file that was handed in.
+ * Useful for when a file is about to be read back.
  */
-void RngManager::init() {
-    init(time(nullptr));
+void BackgroundFileWriter::wait_for_all() {
+    worker.wait_for_all();
 }
 
 
 /**
- * @brief Initializes the random number generator with the given seed.
+ * @brief Hands a data file over to be written. If the worker isn't
+ * running, it gets written right away.
+ *
+ * @param node Data node with the file's contents. It gets moved out of.
+ * @param path Path to write to.
  */
-void RngManager::init(int32_t initial_seed) {
-    state = initial_seed;
+void BackgroundFileWriter::write(DataNode &&node, const string &path) {
+    if(!worker.is_running()) {
+        if(!save_file(node, path)) add_failure(path);
+        return;
+    }
+    
+    worker.add(
+    [this, node = std::move(node), path] () {
+        if(!save_file(node, path)) add_failure(path);
+    }
+    );
 }
 
 
-
 /**
- * @brief Constructs a new script var reader object.
+ * @brief Hands a data file's text over to be written. If the worker isn't
+ * running, it gets written right away.
  *
- * @param vars Map of variables to read from.
+ * @param text Data node writer with the file's text. It gets moved out of.
+ * @param path Path to write to.
  */
-ScriptVarReader::ScriptVarReader(map<string, string> &vars) :
-    vars(vars) {
+void BackgroundFileWriter::write(DataNodeWriter &&text, const string &path) {
+    if(!worker.is_running()) {
+        if(!save_file(text, path)) add_failure(path);
+        return;
+    }
     
+    worker.add(
+    [this, text = std::move(text), path] () {
+        if(!save_file(text, path)) add_failure(path);
+    }
+    );
 }
 
 
 /**
- * @brief Assigns an Allegro color to the value of a given variable,
- * if it exists.
+ * @brief Hands a bitmap over to be encoded and written as an image file.
+ * The writer takes ownership of it, and destroys it once it's written.
+ * If the worker isn't running, it gets written right away. Failures to
+ * write images aren't reported, since nothing would act on them.
  *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @param bmp Memory bitmap to write. Video bitmaps can't be used from
+ * the worker thread.
+ * @param path Path to write to. The extension decides the image format.
  */
-bool ScriptVarReader::get(const string &name, ALLEGRO_COLOR &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
+void BackgroundFileWriter::write_bitmap(
+    ALLEGRO_BITMAP* bmp, const string &path
+) {
+    if(!worker.is_running()) {
+        save_bitmap(bmp, path);
+        return;
     }
-    dest = s2c(v->second);
-    return true;
+    
+    worker.add([bmp, path] () { save_bitmap(bmp, path); });
 }
 
 
 /**
- * @brief Assigns a string to the value of a given variable, if it exists.
- *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @brief The thumbnails that a thumbnail loader's worker finished making.
  */
-bool ScriptVarReader::get(const string &name, string &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
-    }
-    dest = v->second;
-    return true;
+struct ThumbnailLoader::SyncData {
+
+    /**
+     * @brief A thumbnail that the worker has made.
+     */
+    struct Result {
+        
+        //--- Members ---
+        
+        //Internal name of the image.
+        string name;
+        
+        //Thumbnail memory bitmap, or nullptr if it couldn't be made.
+        ALLEGRO_BITMAP* mem_bmp = nullptr;
+    
+    };
+    
+    
+    //--- Members ---
+    
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Thumbnails that are made, and waiting for the main thread.
+    std::deque<Result> results;
+    
+};
+
+
+/**
+ * @brief Constructs a new thumbnail loader object.
+ * The worker isn't started.
+ */
+ThumbnailLoader::ThumbnailLoader() :
+    sync(new SyncData()) {
+
 }
 
 
 /**
- * @brief Assigns a size_t to the value of a given variable, if it exists.
+ * @brief Constructs a new thumbnail loader object by copying another.
+ * Worker threads can't be copied, so the new loader starts without one.
  *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @param l2 Loader to copy from.
  */
-bool ScriptVarReader::get(const string &name, size_t &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
-    }
-    dest = s2i(v->second);
-    return true;
+ThumbnailLoader::ThumbnailLoader(
+    const ThumbnailLoader &l2
+) :
+    sync(new SyncData()) {
+
 }
 
 
 /**
- * @brief Assigns an int to the value of a given variable, if it exists.
+ * @brief Copies a thumbnail loader from another one. Worker threads
+ * can't be copied, so this one just keeps its own.
  *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @param l2 Loader to copy from.
+ * @return The current object.
  */
-bool ScriptVarReader::get(const string &name, int &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
-    }
-    dest = s2i(v->second);
-    return true;
+ThumbnailLoader &ThumbnailLoader::operator =(
+    const ThumbnailLoader &l2
+) {
+    return *this;
 }
 
 
 /**
- * @brief Assigns an unsigned char to the value of a given variable,
- * if it exists.
- *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @brief Destroys the thumbnail loader object.
  */
-bool ScriptVarReader::get(const string &name, unsigned char &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
+ThumbnailLoader::~ThumbnailLoader() {
+    stop();
+    delete sync;
+}
+
+
+/**
+ * @brief Destroys every thumbnail, and forgets about every one that
+ * was requested.
+ */
+void ThumbnailLoader::clear() {
+    worker.clear();
+    {
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        for(size_t r = 0; r < sync->results.size(); r++) {
+            if(sync->results[r].mem_bmp) {
+                al_destroy_bitmap(sync->results[r].mem_bmp);
+            }
+        }
+        sync->results.clear();
     }
-    dest = s2i(v->second);
-    return true;
+    for(auto &t : thumbnails) {
+        if(t.second) al_destroy_bitmap(t.second);
+    }
+    thumbnails.clear();
+    pending.clear();
 }
 
 
 /**
- * @brief Assigns a bool to the value of a given variable, if it exists.
+ * @brief Returns the thumbnail of an image. If it isn't loaded yet,
+ * it gets made in the background, and this returns nullptr until then.
+ * Because of that, only call this for images that are in view.
  *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @param name Internal name of the image.
+ * @return The thumbnail, or nullptr if it's not ready, or if the image
+ * couldn't be opened.
  */
-bool ScriptVarReader::get(const string &name, bool &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
-    }
-    dest = s2b(v->second);
-    return true;
+ALLEGRO_BITMAP* ThumbnailLoader::get(const string &name) {
+    const auto &t_it = thumbnails.find(name);
+    if(t_it != thumbnails.end()) return t_it->second;
+    if(!worker.is_running() || name.empty()) return nullptr;
+    if(pending.find(name) != pending.end()) return nullptr;
+    pending.insert(name);
+    
+    const auto &m_it = game.content.bitmaps.manifests.find(name);
+    string path =
+        m_it != game.content.bitmaps.manifests.end() ?
+        m_it->second.path :
+        name;
+    string cache_path =
+        FOLDER_PATHS_FROM_ROOT::THUMBNAIL_CACHE + "/" + name + ".png";
+        
+    //The newest requests go first, since those are the ones
+    //that are in view right now.
+    worker.add(
+    [this, name, path, cache_path] () {
+        SyncData::Result result;
+        result.name = name;
+        result.mem_bmp = make_thumbnail(path, cache_path);
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        sync->results.push_back(result);
+    },
+    true
+    );
+    return nullptr;
 }
 
 
 /**
- * @brief Assigns a float to the value of a given variable, if it exists.
+ * @brief Makes the thumbnail of an image. If the thumbnail cache has one
+ * that's newer than the image, that one is used. Otherwise, the full image
+ * is decoded and scaled down, and the result is saved to the cache.
  *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @param path Path to the image file.
+ * @param cache_path Path to the thumbnail's copy in the thumbnail cache.
+ * @return The thumbnail, or nullptr if the image couldn't be opened.
  */
-bool ScriptVarReader::get(const string &name, float &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
+ALLEGRO_BITMAP* ThumbnailLoader::make_thumbnail(
+    const string &path, const string &cache_path
+) {
+    std::error_code error;
+    auto source_time = std::filesystem::last_write_time(path, error);
+    bool has_source_time = !error;
+    auto cache_time = std::filesystem::last_write_time(cache_path, error);
+    if(has_source_time && !error && cache_time >= source_time) {
+        ALLEGRO_BITMAP* cached = al_load_bitmap(cache_path.c_str());
+        if(cached) return cached;
     }
-    dest = s2f(v->second);
-    return true;
+    
+    ALLEGRO_BITMAP* full = al_load_bitmap(path.c_str());
+    if(!full) return nullptr;
+    Point full_size = get_bitmap_dimensions(full);
+    if(
+        full_size.x <= THUMBNAIL_LOADER::SIZE &&
+        full_size.y <= THUMBNAIL_LOADER::SIZE
+    ) {
+        //Already small enough.
+        return full;
+    }
+    
+    Point thumb_size =
+        resize_to_box_keeping_aspect_ratio(
+            full_size, Point(THUMBNAIL_LOADER::SIZE)
+        );
+    ALLEGRO_BITMAP* thumb =
+        al_create_bitmap(
+            std::max(1, (int) thumb_size.x), std::max(1, (int) thumb_size.y)
+        );
+    if(thumb) {
+        ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+        al_set_target_bitmap(thumb); {
+            al_clear_to_color(al_map_rgba(0, 0, 0, 0));
+            al_draw_scaled_bitmap(
+                full, 0, 0, full_size.x, full_size.y,
+                0, 0, al_get_bitmap_width(thumb), al_get_bitmap_height(thumb),
+                0
+            );
+        } al_set_target_bitmap(old_target);
+        
+        std::filesystem::create_directories(
+            std::filesystem::path(cache_path).parent_path(), error
+        );
+        al_save_bitmap(cache_path.c_str(), thumb);
+    }
+    al_destroy_bitmap(full);
+    return thumb;
 }
 
 
 /**
- * @brief Assigns a point to the value of a given variable, if it exists.
- *
- * @param name Name of the variable to read.
- * @param dest Destination for the value.
- * @return Whether it exists.
+ * @brief Starts the worker thread. This must be called after the new bitmap
+ * flags are set up, since the worker uses those, but for memory bitmaps.
+ * If the worker was already running, it is restarted.
  */
-bool ScriptVarReader::get(const string &name, Point &dest) const {
-    auto v = vars.find(name);
-    if(v == vars.end()) {
-        return false;
+void ThumbnailLoader::start() {
+    stop();
+    
+    //Bitmap flags are per thread, so the worker gets its own.
+    int worker_bmp_flags = al_get_new_bitmap_flags();
+    disable_flag(worker_bmp_flags, ALLEGRO_VIDEO_BITMAP);
+    disable_flag(worker_bmp_flags, ALLEGRO_MIPMAP);
+    enable_flag(worker_bmp_flags, ALLEGRO_MEMORY_BITMAP);
+    worker.start(
+    [worker_bmp_flags] () {
+        al_set_new_bitmap_flags(worker_bmp_flags);
     }
-    dest = s2p(v->second);
-    return true;
+    );
 }
 
 
 /**
- * @brief Loads an audio sample for the manager.
- *
- * @param name Name of the audio sample to load.
- * @param node If not nullptr, blame this data node if the file doesn't exist.
- * @param report_errors Only issues errors if this is true.
- * @return The audio sample.
+ * @brief Stops the worker thread, and destroys every thumbnail.
  */
-ALLEGRO_SAMPLE* SampleManager::do_load(
-    const string &name, DataNode* node, bool report_errors
-) {
-    const auto &it = game.content.sounds.manifests.find(name);
-    string path =
-        it != game.content.sounds.manifests.end() ?
-        it->second.path :
-        name;
-    return load_sample(path, node, report_errors);
+void ThumbnailLoader::stop() {
+    worker.stop();
+    clear();
 }
 
 
 /**
- * @brief Unloads an audio sample for the manager.
- *
- * @param asset Audio sample to unload.
+ * @brief Uploads the thumbnails that the worker finished making.
+ * This is meant to be called once per frame.
  */
-void SampleManager::do_unload(ALLEGRO_SAMPLE* asset) {
-    al_destroy_sample(asset);
+void ThumbnailLoader::update() {
+    if(!worker.is_running()) return;
+    
+    while(true) {
+        SyncData::Result result;
+        {
+            std::unique_lock<std::mutex> lock(sync->mutex);
+            if(sync->results.empty()) break;
+            result = sync->results.front();
+            sync->results.pop_front();
+        }
+        
+        ALLEGRO_BITMAP* bmp = nullptr;
+        if(result.mem_bmp) {
+            //Cloning with the normal flags uploads it to video memory.
+            bmp = al_clone_bitmap(result.mem_bmp);
+            al_destroy_bitmap(result.mem_bmp);
+        }
+        pending.erase(result.name);
+        thumbnails[result.name] = bmp;
+    }
 }
 
 
@@ -1875,6 +5232,223 @@ void SubgroupTypeManager::register_type(
 }
 
 
+/**
+ * @brief Forgets everything, and destroys the bitmaps. This must be called
+ * when a font that was used is destroyed, since another font could be
+ * created in its place.
+ */
+void TextBitmapCache::clear() {
+    for(auto &t : texts) {
+        if(t.bitmap) al_destroy_bitmap(t.bitmap);
+    }
+    texts.clear();
+    text_its.clear();
+}
+
+
+/**
+ * @brief Returns a text's bitmap and measurements, drawing and measuring
+ * it only if that wasn't done recently.
+ *
+ * @param font Font to use.
+ * @param text Text to get.
+ * @return The text. It is only guaranteed to stay valid until
+ * the next call.
+ */
+const TextBitmapCache::Text &TextBitmapCache::get(
+    const ALLEGRO_FONT* font, const string &text
+) {
+    string key = i2s((size_t) font) + "|" + text;
+    
+    auto it = text_its.find(key);
+    if(it != text_its.end()) {
+        texts.splice(texts.begin(), texts, it->second);
+        return *it->second;
+    }
+    
+    Text new_text;
+    new_text.key = key;
+    al_get_text_dimensions(
+        font, text.c_str(),
+        &new_text.bbox_x, &new_text.bbox_y,
+        &new_text.bbox_w, &new_text.bbox_h
+    );
+    new_text.width = al_get_text_width(font, text.c_str());
+    
+    if(new_text.bbox_w > 0 && new_text.bbox_h > 0) {
+        new_text.bitmap = al_create_bitmap(new_text.bbox_w, new_text.bbox_h);
+    }
+    if(new_text.bitmap) {
+        //Changing the target bitmap while holding would mess up
+        //the held drawings.
+        bool was_holding = al_is_bitmap_drawing_held();
+        if(was_holding) al_hold_bitmap_drawing(false);
+        
+        ALLEGRO_STATE old_state;
+        al_store_state(
+            &old_state,
+            ALLEGRO_STATE_TARGET_BITMAP | ALLEGRO_STATE_BLENDER
+        );
+        al_set_target_bitmap(new_text.bitmap); {
+            al_clear_to_color(COLOR_EMPTY);
+            //Copy the glyphs' pixels as they are, so the bitmap can later
+            //be drawn exactly like the glyphs would be.
+            al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_INVERSE_ALPHA);
+            al_draw_text(
+                font, COLOR_WHITE,
+                -new_text.bbox_x, -new_text.bbox_y,
+                ALLEGRO_ALIGN_LEFT, text.c_str()
+            );
+        } al_restore_state(&old_state);
+        
+        if(was_holding) al_hold_bitmap_drawing(true);
+    }
+    
+    texts.push_front(new_text);
+    text_its[key] = texts.begin();
+    
+    while(texts.size() > TEXT_BITMAP_CACHE::MAX_TEXTS) {
+        if(texts.back().bitmap) al_destroy_bitmap(texts.back().bitmap);
+        text_its.erase(texts.back().key);
+        texts.pop_back();
+    }
+    
+    return texts.front();
+}
+
+
+/**
+ * @brief Returns whether the control bind tokens of a layout still have
+ * the same width they had when it was laid out.
+ *
+ * @param layout Layout to check.
+ * @param control_font Font for control bind icons.
+ * @param max_control_bitmap_height Maximum height of control bind icons.
+ * 0 for no maximum height.
+ * @param control_condensed Whether control bind player icons are condensed.
+ * @return Whether they're current.
+ */
+bool TextLayoutCache::are_control_widths_current(
+    const Layout &layout,
+    const ALLEGRO_FONT* control_font,
+    float max_control_bitmap_height, bool control_condensed
+) const {
+    for(size_t t = 0; t < layout.control_tokens.size(); t++) {
+        const StringToken &t_ref = layout.control_tokens[t];
+        int width =
+            get_player_input_icon_width(
+                control_font,
+                game.controls.find_bind(t_ref.content).inputSource,
+                control_condensed,
+                max_control_bitmap_height
+            );
+        if(width != t_ref.width) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Forgets everything. This must be called when a font that was used
+ * is destroyed, since another font could be created in its place.
+ */
+void TextLayoutCache::clear() {
+    layouts.clear();
+    layout_its.clear();
+    glyph_widths.clear();
+}
+
+
+/**
+ * @brief Returns the width of a glyph in a font, measuring it only if
+ * it wasn't measured before.
+ *
+ * @param font Font to check.
+ * @param glyph The glyph.
+ * @return The width, in pixels.
+ */
+int TextLayoutCache::get_glyph_width(
+    const ALLEGRO_FONT* font, const string &glyph
+) {
+    std::unordered_map<string, int> &font_widths = glyph_widths[font];
+    auto it = font_widths.find(glyph);
+    if(it != font_widths.end()) return it->second;
+    
+    int width = al_get_text_width(font, glyph.c_str());
+    font_widths[glyph] = width;
+    return width;
+}
+
+
+/**
+ * @brief Returns the lines of string tokens that make up a string, after
+ * the string gets split so that no line goes over the limit,
+ * unless necessary. This is the same as tokenizing the string, setting the
+ * token widths, and splitting it, but the results get reused if the same
+ * text was laid out the same way before.
+ *
+ * @param text Text to lay out.
+ * @param text_font Text font.
+ * @param control_font Font for control bind icons.
+ * @param max_control_bitmap_height Maximum height of control bind icons.
+ * 0 for no maximum height.
+ * @param control_condensed Whether control bind player icons are condensed.
+ * @param max_width Maximum width of each line.
+ * @return The lines. They are only guaranteed to stay valid until
+ * the next call.
+ */
+const vector<vector<StringToken> > &TextLayoutCache::get_lines(
+    const string &text,
+    const ALLEGRO_FONT* text_font, const ALLEGRO_FONT* control_font,
+    float max_control_bitmap_height, bool control_condensed,
+    int max_width
+) {
+    string key =
+        i2s((size_t) text_font) + "|" + i2s((size_t) control_font) + "|" +
+        f2s(max_control_bitmap_height) + "|" + b2s(control_condensed) + "|" +
+        i2s(max_width) + "|" + text;
+    
+    auto it = layout_its.find(key);
+    if(it != layout_its.end()) {
+        if(
+            are_control_widths_current(
+                *it->second, control_font,
+                max_control_bitmap_height, control_condensed
+            )
+        ) {
+            layouts.splice(layouts.begin(), layouts, it->second);
+            return it->second->lines;
+        }
+        layouts.erase(it->second);
+        layout_its.erase(it);
+    }
+    
+    Layout new_layout;
+    new_layout.key = key;
+    vector<StringToken> tokens = tokenize_string(text);
+    set_string_token_widths(
+        tokens, text_font, control_font,
+        max_control_bitmap_height, control_condensed
+    );
+    for(size_t t = 0; t < tokens.size(); t++) {
+        if(tokens[t].type == STRING_TOKEN_CONTROL_BIND) {
+            new_layout.control_tokens.push_back(tokens[t]);
+        }
+    }
+    new_layout.lines = split_long_string_with_tokens(tokens, max_width);
+    
+    layouts.push_front(new_layout);
+    layout_its[key] = layouts.begin();
+    
+    while(layouts.size() > TEXT_LAYOUT_CACHE::MAX_LAYOUTS) {
+        layout_its.erase(layouts.back().key);
+        layouts.pop_back();
+    }
+    
+    return layouts.front().lines;
+}
+
+
 /**
  * @brief Constructs a new whistle struct object.
  */
@@ -1976,14 +5550,14 @@ void Whistle::tick(
         }
     }
     
-    for(size_t r = 0; r < rings.size(); ) {
-        //Erase rings that go beyond the cursor.
+    for(size_t r = 0; r < rings.size(); r++) {
         rings[r] += WHISTLE::RING_SPEED * delta_t;
-        if(leader_to_cursor_dist < rings[r]) {
-            rings.erase(rings.begin() + r);
-            ring_colors.erase(ring_colors.begin() + r);
-        } else {
-            r++;
-        }
+    }
+    
+    //Erase rings that go beyond the cursor. They all move at the same speed,
+    //so the oldest ones are always the farthest.
+    while(!rings.empty() && leader_to_cursor_dist < rings[0]) {
+        rings.pop_front();
+        ring_colors.pop_front();
     }
 }
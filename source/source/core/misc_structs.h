@@ -12,12 +12,16 @@
 #pragma once
 
 #include <functional>
+#include <list>
 #include <map>
+#include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <allegro5/allegro.h>
 #include <allegro5/allegro_audio.h>
 #include <allegro5/allegro_font.h>
+#include <allegro5/allegro_primitives.h>
 
 #include "../content/animation/animation.h"
 #include "../content/mob_category/mob_category.h"
@@ -30,16 +34,46 @@
 #include "../util/general_utils.h"
 #include "../util/geometry_utils.h"
 #include "../util/math_utils.h"
+#include "../util/thread_utils.h"
 #include "controls_mediator.h"
 
 
 class PikminType;
+struct Sector;
 
 using std::map;
+using std::set;
 using std::size_t;
 using std::string;
+using std::unordered_map;
 using std::vector;
 
+namespace ADAPTIVE_QUALITY {
+extern const float DOWNGRADE_DELAY;
+extern const float HEADROOM_RATIO;
+extern const unsigned char N_LEVELS;
+extern const float OFFSET_EFFECT_SCALES[];
+extern const float PARTICLE_BUDGET_RATIOS[];
+extern const float UPGRADE_DELAY;
+extern const unsigned char WALL_SHADOWS_MIN_LEVEL;
+}
+
+
+namespace AREA_PRELOADER {
+extern const size_t MAX_TOTAL_FILE_SIZE;
+}
+
+
+namespace BACKGROUND_FILE_WRITER {
+extern const string TEMP_SUFFIX;
+}
+
+
+namespace DEBUG_DRAW_BATCH {
+extern const unsigned char CIRCLE_SEGMENTS;
+}
+
+
 namespace GAMEPLAY_MSG_BOX {
 extern const float ADVANCE_BUTTON_FADE_SPEED;
 extern const float MARGIN;
@@ -59,6 +93,46 @@ extern const float FADE_SPEED;
 }
 
 
+namespace PERFORMANCE_MONITOR {
+extern const size_t HISTOGRAM_BUCKETS_PER_DOUBLING;
+extern const double HISTOGRAM_MIN_DURATION;
+extern const size_t HISTOGRAM_NR_BUCKETS;
+extern const size_t N_HOTTEST_MOB_TYPES;
+extern const size_t N_HOTTEST_SCRIPT_COSTS;
+extern const float REPORT_PERCENTILE;
+extern const size_t SAMPLING_MAX_DEPTH;
+}
+
+
+namespace SAMPLE_MANAGER {
+extern const size_t COMPRESSED_MIN_FILE_SIZE;
+extern const size_t STREAM_BUFFER_COUNT;
+extern const unsigned int STREAM_BUFFER_SAMPLES;
+}
+
+
+namespace SECTOR_TEXTURE_STREAMER {
+extern const int LOWER_QUALITY_MIN_SIZE;
+extern const unsigned char PLACEHOLDER_COLOR[3];
+extern const double UPLOAD_BUDGET;
+}
+
+
+namespace TEXT_BITMAP_CACHE {
+extern const size_t MAX_TEXTS;
+}
+
+
+namespace TEXT_LAYOUT_CACHE {
+extern const size_t MAX_LAYOUTS;
+}
+
+
+namespace THUMBNAIL_LOADER {
+extern const int SIZE;
+}
+
+
 namespace WHISTLE {
 constexpr unsigned char N_RING_COLORS = 8;
 constexpr unsigned char N_DOT_COLORS = 6;
@@ -72,6 +146,21 @@ extern const float RINGS_INTERVAL;
 }
 
 
+//Types of value a script variable can hold.
+enum SCRIPT_VAR_TYPE {
+
+    //Text.
+    SCRIPT_VAR_TYPE_TEXT,
+    
+    //Integer number.
+    SCRIPT_VAR_TYPE_INT,
+    
+    //Floating point number.
+    SCRIPT_VAR_TYPE_FLOAT,
+    
+};
+
+
 //Types of string token.
 enum STRING_TOKEN {
 
@@ -90,6 +179,15 @@ enum STRING_TOKEN {
 };
 
 
+//Subsystems that get their own random number stream.
+enum RNG_STREAM {
+
+    //Particle ticks.
+    RNG_STREAM_PARTICLES,
+    
+};
+
+
 /**
  * @brief Info about the game camera. Where it is, where it wants
  * to go, etc.
@@ -179,6 +277,136 @@ struct StringToken {
 };
 
 
+/**
+ * @brief Keeps bitmaps with text already drawn on them, so that text that
+ * gets drawn every frame doesn't need to be measured and have each of its
+ * glyphs looked up and drawn every frame. The text is drawn in white, and
+ * the bitmap can then be tinted with any color, and scaled with any
+ * transformation, like the font's own glyphs would.
+ *
+ * The most recently used texts are kept, and the least recently used ones
+ * are forgotten once there are too many.
+ */
+struct TextBitmapCache {
+
+    /**
+     * @brief A string of text that was drawn onto a bitmap.
+     */
+    struct Text {
+    
+        //--- Members ---
+        
+        //Key it's saved under.
+        string key;
+        
+        //Bitmap with the text. nullptr if the text has no visible glyphs.
+        ALLEGRO_BITMAP* bitmap = nullptr;
+        
+        //X offset of the text's bounding box, from the drawing point.
+        int bbox_x = 0;
+        
+        //Y offset of the text's bounding box, from the drawing point.
+        int bbox_y = 0;
+        
+        //Width of the text's bounding box.
+        int bbox_w = 0;
+        
+        //Height of the text's bounding box.
+        int bbox_h = 0;
+        
+        //Width of the text, as far as alignment is concerned.
+        int width = 0;
+        
+    };
+    
+    
+    //--- Function declarations ---
+    
+    void clear();
+    const Text &get(const ALLEGRO_FONT* font, const string &text);
+    
+    private:
+    
+    //--- Members ---
+    
+    //Texts, from the most recently used to the least.
+    std::list<Text> texts;
+    
+    //Where each text is in the list, by key.
+    std::unordered_map<string, std::list<Text>::iterator> text_its;
+    
+};
+
+
+/**
+ * @brief Keeps the results of laying out text with string tokens, so that
+ * text that gets drawn every frame doesn't need to be tokenized, measured,
+ * and split into lines every frame.
+ *
+ * The most recently used layouts are kept, and the least recently used ones
+ * are forgotten once there are too many. The width of each glyph is also
+ * kept, per font.
+ */
+struct TextLayoutCache {
+
+    //--- Function declarations ---
+    
+    void clear();
+    int get_glyph_width(const ALLEGRO_FONT* font, const string &glyph);
+    const vector<vector<StringToken> > &get_lines(
+        const string &text,
+        const ALLEGRO_FONT* text_font, const ALLEGRO_FONT* control_font,
+        float max_control_bitmap_height, bool control_condensed,
+        int max_width
+    );
+    
+    private:
+    
+    /**
+     * @brief A string of text that was laid out.
+     */
+    struct Layout {
+        
+        //--- Members ---
+        
+        //Key it's saved under.
+        string key;
+        
+        //Tokens of each line.
+        vector<vector<StringToken> > lines;
+        
+        //Control bind tokens it has, with the width they had at the time.
+        //If a bind changes, its width can change, and so can the lines.
+        vector<StringToken> control_tokens;
+    
+    };
+    
+    
+    //--- Members ---
+    
+    //Layouts, from the most recently used to the least.
+    std::list<Layout> layouts;
+    
+    //Where each layout is in the list, by key.
+    std::unordered_map<string, std::list<Layout>::iterator> layout_its;
+    
+    //Width of each glyph, per font.
+    std::unordered_map<
+        const ALLEGRO_FONT*, std::unordered_map<string, int>
+    > glyph_widths;
+    
+    
+    //--- Function declarations ---
+    
+    bool are_control_widths_current(
+        const Layout &layout,
+        const ALLEGRO_FONT* control_font,
+        float max_control_bitmap_height, bool control_condensed
+    ) const;
+    
+};
+
+
 /**
  * @brief Info about the operative system's mouse cursor.
  */
@@ -214,6 +442,32 @@ struct MouseCursor {
 
 
 
+/**
+ * @brief A stream of random numbers that is independent from the others.
+ * The numbers come from a counter-based generator, so the stream's
+ * results only depend on its key and how many numbers it gave out,
+ * not on what other streams, or other threads, did in the meantime.
+ */
+struct RngStream {
+    //--- Members ---
+    
+    //Key that sets this stream apart from others.
+    uint32_t key = 0;
+    
+    //Index of the next number in the sequence.
+    uint32_t counter = 0;
+    
+    
+    //--- Function declarations ---
+    
+    explicit RngStream(uint32_t key = 0);
+    int32_t i(int32_t minimum, int32_t maximum);
+    float f(float minimum, float maximum);
+    int32_t i_at(uint32_t idx, int32_t minimum, int32_t maximum) const;
+    float f_at(uint32_t idx, float minimum, float maximum) const;
+};
+
+
 /**
  * @brief Manages random number generation.
  */
@@ -223,6 +477,9 @@ struct RngManager {
     //The current randomness generator's state.
     int32_t state = 0;
     
+    //Seed the generator was initialized with. Streams are keyed from it.
+    int32_t seed = 0;
+    
     
     //--- Function declarations ---
     
@@ -230,6 +487,7 @@ struct RngManager {
     void init(int32_t initial_seed);
     int32_t i(int32_t minimum, int32_t maximum);
     float f(float minimum, float maximum);
+    RngStream get_stream(RNG_STREAM subsystem, uint32_t id = 0) const;
 };
 
 
@@ -246,10 +504,15 @@ struct GetterWriter {
     //Node that this getter-writer pertains to.
     DataNode* node = nullptr;
     
+    //If not nullptr, values get written straight into this instead.
+    DataNodeWriter* writer = nullptr;
+    
     
     //--- Function declarations ---
     
     explicit GetterWriter(DataNode* dn = nullptr);
+    explicit GetterWriter(DataNodeWriter* writer);
+    DataNode* add_value(const string &child_name, const string &value);
     void get(
         const string &child_name, const string &var,
         DataNode** out_child_node = nullptr
@@ -371,12 +634,12 @@ struct ScriptVarReader {
     //--- Members ---
     
     //Reference to the list of script variables it pertains to.
-    map<string, string> &vars;
+    const map<string, string> &vars;
     
     
     //--- Function declarations ---
     
-    explicit ScriptVarReader(map<string, string> &vars);
+    explicit ScriptVarReader(const map<string, string> &vars);
     bool get(const string &name, string &dest) const;
     bool get(const string &name, size_t &dest) const;
     bool get(const string &name, int &dest) const;
@@ -390,6 +653,73 @@ struct ScriptVarReader {
 
 
 
+/**
+ * @brief Table of the names of the script variables used by something,
+ * like a mob type. Each name is interned into a fixed slot, so that
+ * the variables can be stored in a vector instead of a map.
+ * Names are only interned while loading, since the table is shared
+ * by every mob of the type.
+ */
+struct ScriptVarTable {
+
+    //--- Members ---
+    
+    //Name of the variable in each slot.
+    vector<string> names;
+    
+    
+    //--- Function declarations ---
+    
+    size_t find(const string &name) const;
+    size_t intern(const string &name);
+    
+    
+    private:
+    
+    //--- Members ---
+    
+    //Slot of each variable name.
+    map<string, size_t> slots;
+    
+};
+
+
+
+/**
+ * @brief Value of a script variable. Numbers are kept as numbers, so that
+ * scripts doing math don't need to convert back and forth to text.
+ */
+struct ScriptVarValue {
+
+    //--- Members ---
+    
+    //Type of value it holds.
+    SCRIPT_VAR_TYPE type = SCRIPT_VAR_TYPE_TEXT;
+    
+    //Numeric value, if it's a number.
+    double number = 0.0;
+    
+    //Text value, if it's text.
+    string text;
+    
+    //Whether it was ever given a value.
+    bool was_set = false;
+    
+    
+    //--- Function declarations ---
+    
+    bool get_bool() const;
+    float get_float() const;
+    int get_int() const;
+    string get_text() const;
+    void set_float(float value);
+    void set_int(long long value);
+    void set_text(const string &value);
+    
+};
+
+
+
 /**
  * @brief List of content that is needed system-wide.
  */
@@ -977,12 +1307,134 @@ enum PERF_MON_STATE {
     //Measuring gameplay frame performance.
     PERF_MON_STATE_FRAME,
     
+    //Measuring unloading times.
+    PERF_MON_STATE_UNLOADING,
+    
+};
+
+
+//Performance monitor measurements known at compile time.
+//Other measurements can be registered with register_measurement.
+enum PERF_MON_MEASUREMENT {
+
+    //Loading the area's data.
+    PERF_MON_MEASUREMENT_AREA_DATA,
+    
+    //Loading the area's vertexes.
+    PERF_MON_MEASUREMENT_AREA_VERTEXES,
+    
+    //Loading the area's edges.
+    PERF_MON_MEASUREMENT_AREA_EDGES,
+    
+    //Loading the area's sectors.
+    PERF_MON_MEASUREMENT_AREA_SECTORS,
+    
+    //Loading the area's object generators.
+    PERF_MON_MEASUREMENT_AREA_OBJECT_GENERATORS,
+    
+    //Loading the area's paths.
+    PERF_MON_MEASUREMENT_AREA_PATHS,
+    
+    //Loading the area's tree shadows.
+    PERF_MON_MEASUREMENT_AREA_TREE_SHADOWS,
+    
+    //Calculating the area's geometry.
+    PERF_MON_MEASUREMENT_AREA_GEOMETRY_CALCULATIONS,
+    
+    //Generating the area's objects.
+    PERF_MON_MEASUREMENT_OBJECT_GENERATION,
+    
+    //An object's brain logic.
+    PERF_MON_MEASUREMENT_OBJECT_BRAIN,
+    
+    //An object's physics logic.
+    PERF_MON_MEASUREMENT_OBJECT_PHYSICS,
+    
+    //An object's miscellaneous logic.
+    PERF_MON_MEASUREMENT_OBJECT_MISC_LOGIC,
+    
+    //An object's animation logic.
+    PERF_MON_MEASUREMENT_OBJECT_ANIMATION,
+    
+    //An object's script logic.
+    PERF_MON_MEASUREMENT_OBJECT_SCRIPT,
+    
+    //An object's category-specific logic.
+    PERF_MON_MEASUREMENT_OBJECT_MISC_SPECIFICS,
+    
+    //Advancing all objects' animations ahead of their ticks.
+    PERF_MON_MEASUREMENT_OBJECTS_ANIMATION_ADVANCE,
+    
+    //Detecting all objects' interactions with one another.
+    PERF_MON_MEASUREMENT_OBJECTS_INTERACTION_DETECTION,
+    
+    //All objects pushing one another.
+    PERF_MON_MEASUREMENT_OBJECTS_PUSHES,
+    
+    //All of an object's interactions with others, as a whole.
+    PERF_MON_MEASUREMENT_OBJECTS_INTERACTIONS,
+    
+    //Objects touching one another.
+    PERF_MON_MEASUREMENT_OBJECTS_TOUCHING_OTHERS,
+    
+    //Results of the objects' interactions.
+    PERF_MON_MEASUREMENT_OBJECTS_INTERACTION_RESULTS,
+    
+    //Current leader logic.
+    PERF_MON_MEASUREMENT_LOGIC_CURRENT_LEADER,
+    
+    //Particle logic.
+    PERF_MON_MEASUREMENT_LOGIC_PARTICLES,
+    
+    //Sector animation logic.
+    PERF_MON_MEASUREMENT_LOGIC_SECTOR_ANIMATION,
+    
+    //Drawing the background.
+    PERF_MON_MEASUREMENT_DRAWING_BACKGROUND,
+    
+    //Drawing the world.
+    PERF_MON_MEASUREMENT_DRAWING_WORLD,
+    
+    //Drawing the in-game text.
+    PERF_MON_MEASUREMENT_DRAWING_IN_GAME_TEXT,
+    
+    //Drawing the precipitation.
+    PERF_MON_MEASUREMENT_DRAWING_PRECIPITATION,
+    
+    //Drawing the tree shadows.
+    PERF_MON_MEASUREMENT_DRAWING_TREE_SHADOWS,
+    
+    //Drawing the lighting.
+    PERF_MON_MEASUREMENT_DRAWING_LIGHTING,
+    
+    //Drawing the HUD.
+    PERF_MON_MEASUREMENT_DRAWING_HUD,
+    
+    //Unloading the area's objects.
+    PERF_MON_MEASUREMENT_UNLOADING_OBJECTS,
+    
+    //Unloading the game content and assets.
+    PERF_MON_MEASUREMENT_UNLOADING_CONTENT,
+    
+    //Total amount of measurements known at compile time.
+    N_PERF_MON_MEASUREMENTS,
+    
 };
 
 
 /**
  * @brief Info about how long certain things took. Useful for makers
  * to monitor performance with.
+ *
+ * Measurements are identified by their ID, and their times are
+ * accumulated per ID. Measurements can be nested, in which case
+ * the outer measurement's time includes the inner one's.
+ * Optionally, it can also keep a trace of the latest measurements,
+ * which can be saved in the Chrome trace event format.
+ * In sampling mode, measurements aren't timed at all. Instead, they are
+ * only pushed to and popped from a cheap stack, which a background thread
+ * peeks at every so often, building a statistical profile that can be
+ * saved in the collapsed stack format used by flame graph tools.
  */
 struct PerformanceMonitor {
 
@@ -991,54 +1443,234 @@ struct PerformanceMonitor {
     //--- Function declarations ---
     
     PerformanceMonitor();
+    PerformanceMonitor(const PerformanceMonitor &m2) = delete;
+    PerformanceMonitor &operator=(const PerformanceMonitor &m2) = delete;
+    ~PerformanceMonitor();
+    void add_memory_report(const vector<std::pair<string, size_t> > &report);
+    void add_script_action_cost(const string* action_name, double dur);
+    void add_script_event_cost(
+        const string* mob_type_name, const string* state_name,
+        size_t event_type, double dur
+    );
     void set_area_name(const string &name);
+    void set_detailed(bool detailed);
     void set_paused(bool paused);
     void enter_state(const PERF_MON_STATE mode);
     void leave_state();
+    size_t register_measurement(const string &name);
+    void start_measurement(
+        size_t id, size_t mob_id = INVALID,
+        const string* mob_type_name = nullptr
+    );
     void start_measurement(const string &name);
     void finish_measurement();
     void save_log();
+    bool save_samples();
+    bool save_trace();
+    void set_sampling_interval(float interval);
+    void set_tracing(size_t max_events, double frame_budget);
+    void set_mob_type_costs(bool mob_type_costs);
+    void set_script_costs(bool script_costs);
+    void write_results(DataNode* node) const;
     void reset();
+    double get_last_frame_duration() const;
+    vector<std::pair<double, const string*> >
+    get_last_frame_hottest_mob_types(size_t max) const;
+    vector<std::pair<double, string> >
+    get_last_frame_hottest_script_actions(size_t max) const;
+    vector<std::pair<double, string> >
+    get_last_frame_hottest_script_events(size_t max) const;
+    double get_last_frame_measurement_dur(size_t id) const;
+    double get_last_frame_measurement_nr_allocs(size_t id) const;
+    double get_last_frame_nr_allocs() const;
+    size_t get_measurement_depth(size_t id) const;
+    string get_measurement_name(size_t id) const;
+    size_t get_nr_measurements() const;
+    bool is_profiling_scripts() const;
     
     private:
     
     //--- Misc. declarations ---
     
+    struct SamplingData;
+    
     /**
-     * @brief A page in the report.
+     * @brief A timestamped event, for the trace.
      */
-    struct Page {
+    struct TraceEvent {
     
-        public:
+        //--- Members ---
+        
+        //ID of the measurement. INVALID if this is a whole frame.
+        size_t measurement_id = INVALID;
+        
+        //When it began.
+        double start = 0.0;
+        
+        //How long it lasted for.
+        double duration = 0.0;
+        
+        //ID of the object it refers to, if any. INVALID if none.
+        size_t mob_id = INVALID;
+        
+        //Name of the type of object it refers to, if any. Once the
+        //measurement is finished, this points to the monitor's own copy.
+        const string* mob_type_name = nullptr;
+        
+        //How many heap allocations had been made when it began.
+        //Only if they're being counted.
+        size_t start_alloc_nr = 0;
         
+        //How many heap-allocated bytes had been made when it began.
+        //Only if they're being counted.
+        size_t start_alloc_bytes = 0;
+        
+    };
+    
+    /**
+     * @brief How much a part of the object scripts cost, for the
+     * script profiler.
+     */
+    struct ScriptCost {
+    
         //--- Members ---
         
-        //How long it lasted for in total.
-        double duration = 0.0f;
+        //How many times it ran.
+        size_t nr_runs = 0;
         
-        //Measurements took, and how long each one took.
-        vector<std::pair<string, double> > measurements;
+        //How long it took in total, in seconds.
+        double duration = 0.0;
         
         
         //--- Function declarations ---
         
-        void write(string &s);
+        void add(size_t nr_runs, double duration);
+        
+    };
+    
+    /**
+     * @brief Identifies an event of a state of an object type,
+     * for the script profiler.
+     */
+    struct ScriptEventKey {
+    
+        //--- Members ---
+        
+        //Name of the object type. This is the monitor's own copy.
+        const string* mob_type_name = nullptr;
+        
+        //Name of the state the object was in. nullptr if none.
+        //This is the monitor's own copy.
+        const string* state_name = nullptr;
+        
+        //Type of event.
+        size_t event_type = 0;
         
-        private:
         
         //--- Function declarations ---
         
-        void write_measurement(
-            string &str, const string &name,
-            double time, float total
-        );
+        bool operator<(const ScriptEventKey &k2) const;
+        
     };
     
+    /**
+     * @brief A histogram of durations, with buckets that grow
+     * logarithmically, so percentiles can be estimated without keeping
+     * every single sample.
+     */
+    struct Histogram {
     
-    //--- Members ---
+        //--- Members ---
+        
+        //How many samples fell in each bucket.
+        vector<size_t> buckets;
+        
+        //Total number of samples.
+        size_t nr_samples = 0;
+        
+        
+        //--- Function declarations ---
+        
+        void add(double dur);
+        double get_percentile(float percentile) const;
+        string get_summary() const;
+        void write_results(DataNode* node) const;
+        
+    };
     
-    //Name of the area being monitored.
-    string area_name;
+    /**
+     * @brief A page in the report.
+     */
+    struct Page {
+    
+        public:
+        
+        //--- Members ---
+        
+        //How long it lasted for in total.
+        double duration = 0.0f;
+        
+        //How long each measurement took, indexed by measurement ID.
+        vector<double> measurement_durs;
+        
+        //Were the measurements taken? Indexed by measurement ID.
+        vector<bool> measurements_taken;
+        
+        //IDs of the measurements taken, in the order they were first taken.
+        vector<size_t> measurement_order;
+        
+        //How long each job worker thread spent running work,
+        //indexed by worker.
+        vector<double> worker_busy_durs;
+        
+        //How many heap allocations were made in total.
+        //Only if they're being counted.
+        double nr_allocs = 0.0;
+        
+        //How many bytes were heap-allocated in total.
+        //Only if they're being counted.
+        double alloc_bytes = 0.0;
+        
+        //How many heap allocations each measurement made, indexed by
+        //measurement ID. Only if they're being counted.
+        vector<double> measurement_nr_allocs;
+        
+        //How many bytes each measurement heap-allocated, indexed by
+        //measurement ID. Only if they're being counted.
+        vector<double> measurement_alloc_bytes;
+        
+        
+        //--- Function declarations ---
+        
+        void add_measurement(
+            size_t id, double dur,
+            double nr_allocs = 0.0, double alloc_bytes = 0.0
+        );
+        void add_page(const Page &other);
+        void write(string &s, const PerformanceMonitor* monitor);
+        void write_results(
+            DataNode* node, double divisor,
+            const PerformanceMonitor* monitor
+        ) const;
+        
+        private:
+        
+        //--- Function declarations ---
+        
+        double get_total_measured_time(
+            const PerformanceMonitor* monitor
+        ) const;
+        void write_measurement(
+            string &str, const string &name, size_t depth,
+            double time, float total, double nr_allocs, double alloc_bytes
+        );
+    };
+    
+    
+    //--- Members ---
+    
+    //Name of the area being monitored.
+    string area_name;
     
     //Current state.
     PERF_MON_STATE cur_state = PERF_MON_STATE_LOADING;
@@ -1049,15 +1681,37 @@ struct PerformanceMonitor {
     //When the current state began.
     double cur_state_start_time = 0.0f;
     
-    //When the current measurement began.
-    double cur_measurement_start_time = 0.0f;
+    //How long each job worker thread had spent running work when
+    //the current state began, indexed by worker.
+    vector<double> cur_state_start_busy_times;
+    
+    //How many heap allocations had been made when the current state began.
+    //Only if they're being counted.
+    size_t cur_state_start_alloc_nr = 0;
+    
+    //How many heap-allocated bytes had been made when the current state
+    //began. Only if they're being counted.
+    size_t cur_state_start_alloc_bytes = 0;
+    
+    //Measurements currently ongoing, from outermost to innermost.
+    vector<TraceEvent> measurement_stack;
+    
+    //Name of each measurement, indexed by measurement ID.
+    vector<string> measurement_names;
     
-    //Name of the current measurement.
-    string cur_measurement_name;
+    //How deeply nested each measurement was the first time it was taken,
+    //indexed by measurement ID.
+    vector<size_t> measurement_depths;
+    
+    //Measurement IDs, indexed by their name.
+    map<string, size_t> measurement_ids;
     
     //Page of information about the current working info.
     PerformanceMonitor::Page cur_page;
     
+    //Page of information about the latest frame of gameplay.
+    PerformanceMonitor::Page last_frame_page;
+    
     //How many frames of gameplay have been sampled.
     size_t frame_samples = 0;
     
@@ -1073,6 +1727,148 @@ struct PerformanceMonitor {
     //Page of information about the slowest frame.
     PerformanceMonitor::Page frame_slowest_page;
     
+    //Page of information about the unloading process.
+    PerformanceMonitor::Page unloading_page;
+    
+    //Latest trace events, in a ring buffer. Empty if tracing is disabled.
+    vector<TraceEvent> trace_events;
+    
+    //Index in the trace event ring buffer to write the next event to.
+    size_t trace_next_idx = 0;
+    
+    //Has the trace event ring buffer been filled at least once?
+    bool trace_wrapped = false;
+    
+    //If a frame takes longer than this, in seconds, the trace is saved.
+    //0 to never do this.
+    double trace_frame_budget = 0.0;
+    
+    //Duration of the slowest frame that caused the trace to be saved.
+    double trace_slowest_saved_frame = 0.0;
+    
+    //Histogram of how long each frame of gameplay took.
+    Histogram frame_histogram;
+    
+    //Histogram of how long each measurement took in each frame of gameplay,
+    //indexed by measurement ID.
+    vector<Histogram> measurement_histograms;
+    
+    //How many frames of gameplay took longer than the target framerate
+    //allows.
+    size_t frames_over_budget = 0;
+    
+    //Is it keeping detailed information, like every frame's times?
+    bool detailed = false;
+    
+    //How long each frame of gameplay took. Only if detailed.
+    vector<double> frame_durs;
+    
+    //How long each measurement took in each frame of gameplay, indexed by
+    //measurement ID, and then by frame. Only if detailed.
+    vector<vector<double> > frame_measurement_durs;
+    
+    //How long the measurements of each object type took in total,
+    //indexed by the type's name. Only if detailed.
+    unordered_map<const string*, double> mob_type_durs;
+    
+    //Is it keeping track of how much each object type costs in
+    //each measurement?
+    bool mob_type_costs = false;
+    
+    //How long each measurement took in total for each object type,
+    //indexed by the type's name, and then by measurement ID.
+    //Only if mob_type_costs is on.
+    unordered_map<const string*, vector<double> > mob_type_measurement_durs;
+    
+    //How long the measurements of each object type took in the current
+    //frame of gameplay, indexed by the type's name.
+    //Only if mob_type_costs is on.
+    unordered_map<const string*, double> cur_frame_mob_type_durs;
+    
+    //Same as cur_frame_mob_type_durs, but for the latest finished frame.
+    unordered_map<const string*, double> last_frame_mob_type_durs;
+    
+    //Is the script profiler on? If so, it keeps track of how much each
+    //script event and action costs.
+    bool script_costs = false;
+    
+    //How much each script event cost in all frames of gameplay, indexed by
+    //object type, state, and event. Only if script_costs is on.
+    map<ScriptEventKey, ScriptCost> script_event_costs;
+    
+    //Same as script_event_costs, but for the current frame of gameplay.
+    map<ScriptEventKey, ScriptCost> cur_frame_script_event_costs;
+    
+    //Same as cur_frame_script_event_costs, but for the latest finished frame.
+    map<ScriptEventKey, ScriptCost> last_frame_script_event_costs;
+    
+    //How much each script action cost in all frames of gameplay, indexed by
+    //the action's name. Only if script_costs is on.
+    unordered_map<const string*, ScriptCost> script_action_costs;
+    
+    //Same as script_action_costs, but for the current frame of gameplay.
+    unordered_map<const string*, ScriptCost> cur_frame_script_action_costs;
+    
+    //Same as cur_frame_script_action_costs, but for the latest finished
+    //frame.
+    unordered_map<const string*, ScriptCost> last_frame_script_action_costs;
+    
+    //Highest estimate of how much memory each subsystem used, in bytes.
+    vector<std::pair<string, size_t> > peak_memory_report;
+    
+    //Copies of the names of the object types, states, and script actions
+    //that the results refer to. The results outlive the content those come
+    //from, so they point to these instead.
+    set<string> name_copies;
+    
+    //Sampling thread, its scope stack, and its samples. nullptr if
+    //sampling mode is off.
+    SamplingData* sampling = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    void add_trace_event(const TraceEvent &event);
+    static vector<std::pair<double, const string*> > get_hottest_mob_types(
+        const unordered_map<const string*, double> &durs, size_t max
+    );
+    static vector<std::pair<double, string> > get_hottest_script_actions(
+        const unordered_map<const string*, ScriptCost> &costs, size_t max,
+        double divisor
+    );
+    static vector<std::pair<double, string> > get_hottest_script_events(
+        const map<ScriptEventKey, ScriptCost> &costs, size_t max,
+        double divisor
+    );
+    string get_last_measurement_name() const;
+    const string* get_name_copy(const string* name);
+    static double get_percentile(vector<double> values, float percentile);
+    void sample_work();
+    
+};
+
+
+/**
+ * @brief Takes a performance monitor measurement for as long as it exists.
+ * Does nothing if there is no performance monitor.
+ */
+struct PerformanceMonitorScope {
+
+    //--- Function declarations ---
+    
+    PerformanceMonitorScope(
+        PerformanceMonitor* monitor, size_t id,
+        size_t mob_id = INVALID, const string* mob_type_name = nullptr
+    );
+    ~PerformanceMonitorScope();
+    
+    private:
+    
+    //--- Members ---
+    
+    //Performance monitor taking the measurement, if any.
+    PerformanceMonitor* monitor = nullptr;
+    
 };
 
 
@@ -1252,6 +2048,61 @@ struct EdgeOffsetCache {
 };
 
 
+/**
+ * @brief Collects the shapes of debug visualizations over a frame, and then
+ * draws them all with one call per primitive type, instead of one call
+ * per shape. The shapes are drawn with whatever transformation is active
+ * when they're flushed.
+ */
+struct DebugDrawBatch {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    void add_circle(
+        const Point &center, float radius,
+        const ALLEGRO_COLOR &color, float thickness
+    );
+    void add_filled_circle(
+        const Point &center, float radius, const ALLEGRO_COLOR &color
+    );
+    void add_filled_rectangle(
+        const Point &tl, const Point &br, const ALLEGRO_COLOR &color
+    );
+    void add_line(
+        const Point &p1, const Point &p2,
+        const ALLEGRO_COLOR &color, float thickness
+    );
+    void add_polygon(
+        const Point* points, size_t n_points,
+        const ALLEGRO_COLOR &color, float thickness
+    );
+    void flush();
+    
+    private:
+    
+    //--- Members ---
+    
+    //Vertexes of the filled shapes and thick lines, as a triangle list.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<ALLEGRO_VERTEX> triangle_vertexes;
+    
+    //Vertexes of the one pixel thick lines, as a line list.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<ALLEGRO_VERTEX> line_vertexes;
+    
+    
+    //--- Function declarations ---
+    
+    static void add_vertex(
+        vector<ALLEGRO_VERTEX> &vertexes, const Point &p,
+        const ALLEGRO_COLOR &color
+    );
+    
+};
+
+
 /**
  * @brief Info about the current whistle usage.
  */
@@ -1280,14 +2131,14 @@ struct Whistle {
     //Time left until the next ring is spat out.
     Timer next_ring_timer = Timer(WHISTLE::RINGS_INTERVAL);
     
-    //Color index of each ring.
-    vector<unsigned char> ring_colors;
+    //Color index of each ring, from oldest to newest.
+    RingBuffer<unsigned char> ring_colors;
     
     //Color index of the previous ring.
     unsigned char ring_prev_color = 0;
     
-    //Distance of each ring.
-    vector<float> rings;
+    //Distance of each ring, from oldest to newest.
+    RingBuffer<float> rings;
     
     //Is the whistle currently being blown?
     bool whistling = false;
@@ -1363,19 +2214,48 @@ public:
     ) {
         if(name.empty()) return do_load("", node, report_errors);
         
-        if(list.find(name) == list.end()) {
+        auto it = list.find(name);
+        if(it == list.end()) {
             asset_t asset_ptr =
                 do_load(name, node, report_errors);
-            list[name] = AssetUse(asset_ptr);
-            total_uses++;
+            register_asset(name, asset_ptr, 1);
             return asset_ptr;
         } else {
-            list[name].uses++;
+            if(it->second.uses == 0) take_from_cache(it);
+            it->second.uses++;
             total_uses++;
-            return list[name].ptr;
+            return it->second.ptr;
         }
     }
     
+    /**
+     * @brief Adds an asset that was already loaded some other way,
+     * like in another thread, as if it had been obtained with get().
+     * If an asset with that name was loaded in the meantime, the new one
+     * gets unloaded and the existing one is returned instead.
+     *
+     * @param name Name of the asset.
+     * @param asset_ptr The asset.
+     * @param uses How many uses to count for it.
+     * @return The asset in the list.
+     */
+    asset_t add(const string &name, asset_t asset_ptr, size_t uses) {
+        if(uses == 0) {
+            do_unload(asset_ptr);
+            return nullptr;
+        }
+        auto it = list.find(name);
+        if(it != list.end()) {
+            do_unload(asset_ptr);
+            if(it->second.uses == 0) take_from_cache(it);
+            it->second.uses += uses;
+            total_uses += uses;
+            return it->second.ptr;
+        }
+        register_asset(name, asset_ptr, uses);
+        return asset_ptr;
+    }
+    
     /**
      * @brief Frees one use of the asset. If the asset has no more calls,
      * it's automatically cleared.
@@ -1384,11 +2264,9 @@ public:
      */
     void free(const asset_t ptr) {
         if(!ptr) return;
-        auto it = list.begin();
-        for(; it != list.end(); ++it) {
-            if(it->second.ptr == ptr) break;
-        }
-        free(it);
+        auto idx_it = ptr_index.find(ptr);
+        if(idx_it == ptr_index.end()) return;
+        free(list.find(idx_it->second->first));
     }
     
     /**
@@ -1410,9 +2288,46 @@ public:
             do_unload(asset.second.ptr);
         }
         list.clear();
+        ptr_index.clear();
+        cached_assets.clear();
+        cache_size = 0;
         total_uses = 0;
     }
     
+    /**
+     * @brief Unloads all assets that have no uses, but were being kept
+     * in the cache.
+     */
+    void clear_cache() {
+        while(!cached_assets.empty()) {
+            unload(list.find(cached_assets.front()));
+        }
+    }
+    
+    /**
+     * @brief Returns the total size of the assets in the cache, in bytes.
+     * Used for debugging.
+     *
+     * @return The size.
+     */
+    size_t get_cache_size() const {
+        return cache_size;
+    }
+    
+    /**
+     * @brief Returns roughly how much memory all loaded assets take up,
+     * in bytes, including the ones in the cache.
+     *
+     * @return The size.
+     */
+    size_t get_total_size() const {
+        size_t size = 0;
+        for(const auto &asset : list) {
+            size += get_asset_size(asset.second.ptr);
+        }
+        return size;
+    }
+    
     /**
      * @brief Returns the total number of uses. Used for debugging.
      *
@@ -1422,6 +2337,16 @@ public:
         return total_uses;
     }
     
+    /**
+     * @brief Returns whether an asset with the given name is loaded.
+     *
+     * @param name Name of the asset.
+     * @return Whether it is loaded.
+     */
+    bool is_loaded(const string &name) const {
+        return list.find(name) != list.end();
+    }
+    
     /**
      * @brief Returns the size of the list. Used for debugging.
      *
@@ -1431,6 +2356,17 @@ public:
         return list.size();
     }
     
+    /**
+     * @brief Sets how big the cache can get before the
+     * least recently used assets in it get unloaded.
+     *
+     * @param bytes Size, in bytes. 0 disables the cache.
+     */
+    void set_cache_budget(size_t bytes) {
+        cache_budget = bytes;
+        trim_cache();
+    }
+    
 protected:
 
     //--- Misc. declarations ---
@@ -1440,6 +2376,17 @@ protected:
     ) = 0;
     virtual void do_unload(asset_t asset) = 0;
     
+    /**
+     * @brief Returns roughly how much memory an asset takes up, in bytes.
+     * Assets with a size of 0 are never kept in the cache.
+     *
+     * @param asset Asset to check.
+     * @return The size.
+     */
+    virtual size_t get_asset_size(asset_t asset) const {
+        return 0;
+    }
+    
     /**
      * @brief Info about an asset.
      */
@@ -1453,6 +2400,12 @@ protected:
         //How many uses it has.
         size_t uses = 1;
         
+        //Size it takes up in the cache, in bytes, if it's in the cache.
+        size_t cache_size = 0;
+        
+        //Its entry in the list of cached assets, if it's in the cache.
+        std::list<string>::iterator cache_it;
+        
         
         //--- Function declarations ---
         
@@ -1462,29 +2415,114 @@ protected:
     
     //--- Members ---
     
-    //List of loaded assets.
-    map<string, AssetUse> list;
+    //List of loaded assets, indexed by name.
+    unordered_map<string, AssetUse> list;
+    
+    //Entry in the list of each loaded asset, indexed by the asset's pointer.
+    //The entries themselves never move, even when the list grows.
+    //Cache for performance.
+    unordered_map<
+        asset_t, typename unordered_map<string, AssetUse>::value_type*
+    > ptr_index;
     
     //Total sum of uses. Useful for debugging.
     long total_uses = 0;
     
+    //Names of the assets that have no uses but are still loaded, in case
+    //they're needed again soon. From least to most recently used.
+    std::list<string> cached_assets;
+    
+    //Total size of the assets in the cache, in bytes.
+    size_t cache_size = 0;
+    
+    //Maximum total size of the assets in the cache, in bytes.
+    //0 means assets get unloaded as soon as they have no uses.
+    size_t cache_budget = 0;
+    
     
     //--- Function definitions ---
     
     /**
      * @brief Frees one use of the asset. If the asset has no more calls,
-     * it's automatically cleared.
+     * it goes to the cache, or gets unloaded if it doesn't fit there.
      *
      * @param it Iterator of the asset from the list.
      */
-    void free(typename map<string, AssetUse>::iterator it) {
+    void free(typename unordered_map<string, AssetUse>::iterator it) {
         if(it == list.end()) return;
+        if(it->second.uses == 0) return;
         it->second.uses--;
         total_uses--;
-        if(it->second.uses == 0) {
-            do_unload(it->second.ptr);
-            list.erase(it);
+        if(it->second.uses > 0) return;
+        
+        size_t size = cache_budget > 0 ? get_asset_size(it->second.ptr) : 0;
+        if(size == 0 || size > cache_budget) {
+            unload(it);
+            return;
+        }
+        it->second.cache_size = size;
+        it->second.cache_it =
+            cached_assets.insert(cached_assets.end(), it->first);
+        cache_size += size;
+        trim_cache();
+    }
+    
+    /**
+     * @brief Takes an asset out of the cache, because it has uses again.
+     *
+     * @param it Iterator of the asset from the list.
+     */
+    void take_from_cache(
+        typename unordered_map<string, AssetUse>::iterator it
+    ) {
+        cached_assets.erase(it->second.cache_it);
+        cache_size -= it->second.cache_size;
+        it->second.cache_size = 0;
+    }
+    
+    /**
+     * @brief Unloads the least recently used assets in the cache until
+     * the cache fits in its budget.
+     */
+    void trim_cache() {
+        while(!cached_assets.empty() && cache_size > cache_budget) {
+            unload(list.find(cached_assets.front()));
+        }
+    }
+    
+    /**
+     * @brief Unloads an asset, and removes it from the list. If it was
+     * in the cache, it's removed from there too.
+     *
+     * @param it Iterator of the asset from the list.
+     */
+    void unload(typename unordered_map<string, AssetUse>::iterator it) {
+        if(it->second.uses == 0 && it->second.cache_size > 0) {
+            take_from_cache(it);
+        }
+        auto idx_it = ptr_index.find(it->second.ptr);
+        if(idx_it != ptr_index.end() && idx_it->second == &(*it)) {
+            ptr_index.erase(idx_it);
         }
+        do_unload(it->second.ptr);
+        list.erase(it);
+    }
+    
+    /**
+     * @brief Adds a newly loaded asset to the list and to the pointer index.
+     * The same pointer can be under more than one name, like the error
+     * bitmap, in which case the index only knows about the first one.
+     *
+     * @param name Name of the asset.
+     * @param asset_ptr The asset.
+     * @param uses How many uses to count for it.
+     */
+    void register_asset(const string &name, asset_t asset_ptr, size_t uses) {
+        AssetUse new_use(asset_ptr);
+        new_use.uses = uses;
+        auto it = list.insert(std::make_pair(name, new_use)).first;
+        ptr_index.insert(std::make_pair(asset_ptr, &(*it)));
+        total_uses += uses;
     }
     
 };
@@ -1520,15 +2558,34 @@ protected:
         const string &name, DataNode* node, bool report_errors
     ) override;
     void do_unload(ALLEGRO_BITMAP* asset) override;
+    size_t get_asset_size(ALLEGRO_BITMAP* asset) const override;
     
 };
 
 
 /**
  * @brief Sound effect sample manager. See AssetManager.
+ *
+ * Large compressed audio files, like long ambiance loops, aren't decoded
+ * when loaded. Instead, their compressed contents are kept in memory, and
+ * the sample handed out is a silent placeholder with the right format.
+ * The audio manager asks for a stream of these when it plays them, and
+ * the stream decodes the contents bit by bit as it plays.
  */
 class SampleManager : public AssetManager<ALLEGRO_SAMPLE*> {
 
+public:
+
+    //--- Function declarations ---
+    
+    SampleManager();
+    SampleManager(const SampleManager &other) = delete;
+    SampleManager &operator=(const SampleManager &other) = delete;
+    ~SampleManager();
+    ALLEGRO_AUDIO_STREAM* create_compressed_stream(
+        const ALLEGRO_SAMPLE* sample
+    ) const;
+    
 protected:
 
     //--- Function declarations ---
@@ -1537,5 +2594,279 @@ protected:
         const string &name, DataNode* node, bool report_errors
     ) override;
     void do_unload(ALLEGRO_SAMPLE* asset) override;
+    size_t get_asset_size(ALLEGRO_SAMPLE* asset) const override;
+    
+private:
+
+    //--- Misc. declarations ---
+    
+    struct CompressedSamples;
+    
+    
+    //--- Members ---
+    
+    //Samples that are kept compressed, and the lock that protects them,
+    //since the sound effect thread creates streams of them.
+    CompressedSamples* compressed = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    ALLEGRO_SAMPLE* load_compressed(const string &path);
+    
+};
+
+
+/**
+ * @brief Loads the textures of the area's sectors in the background.
+ * A worker thread decodes each image file into a memory bitmap, and then
+ * the main thread turns a few of them into video bitmaps every frame,
+ * so that loading an area or swapping a texture doesn't stall the game.
+ * Until a sector's texture arrives, it uses a placeholder texture.
+ * Textures that arrive are registered in the bitmap manager, so from then
+ * on they're used and freed like any other.
+ */
+struct SectorTextureStreamer {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    SectorTextureStreamer();
+    SectorTextureStreamer(const SectorTextureStreamer &s2);
+    SectorTextureStreamer &operator=(const SectorTextureStreamer &s2);
+    ~SectorTextureStreamer();
+    void clear();
+    size_t get_nr_pending() const;
+    ALLEGRO_BITMAP* get_placeholder() const;
+    void request(Sector* s_ptr);
+    void start();
+    void stop();
+    void update(double budget = SECTOR_TEXTURE_STREAMER::UPLOAD_BUDGET);
+    void wait_for_all();
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //Worker thread that decodes the textures.
+    WorkerThread worker;
+    
+    //Decoded textures waiting for the main thread, and the lock
+    //that protects them.
+    SyncData* sync = nullptr;
+    
+    //Texture used by sectors whose texture hasn't arrived yet.
+    ALLEGRO_BITMAP* placeholder = nullptr;
+    
+    //Internal names of the textures that are being streamed.
+    set<string> pending;
+    
+    
+    //--- Function declarations ---
+    
+    void deliver(
+        const string &name, const string &path, ALLEGRO_BITMAP* mem_bmp
+    );
+    static ALLEGRO_BITMAP* upload(ALLEGRO_BITMAP* mem_bmp);
+    
+};
+
+
+/**
+ * @brief Writes data files to the disk in the background, so that saving
+ * something big doesn't stall the game. Files are written in the order they
+ * were handed in. Each one is first written to a temporary file, which then
+ * replaces the real one, so the real file is never left half-written.
+ */
+struct BackgroundFileWriter {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    BackgroundFileWriter();
+    BackgroundFileWriter(const BackgroundFileWriter &w2);
+    BackgroundFileWriter &operator=(const BackgroundFileWriter &w2);
+    ~BackgroundFileWriter();
+    size_t get_nr_pending() const;
+    bool pop_failure(string* out_path);
+    void start();
+    void stop();
+    void wait_for_all();
+    void write(DataNode &&node, const string &path);
+    void write(DataNodeWriter &&text, const string &path);
+    void write_bitmap(ALLEGRO_BITMAP* bmp, const string &path);
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //Worker thread that writes the files.
+    WorkerThread worker;
+    
+    //Paths of the files that couldn't be written, and the lock
+    //that protects them.
+    SyncData* sync = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    void add_failure(const string &path);
+    static bool save_bitmap(ALLEGRO_BITMAP* bmp, const string &path);
+    static bool save_file(const DataNode &node, const string &path);
+    static bool save_file(const DataNodeWriter &text, const string &path);
+    static bool use_temp_file(
+        bool saved, const string &temp_path, const string &path
+    );
+    
+};
+
+
+/**
+ * @brief Loads small previews of images in the background, for lists that
+ * show many images at once, like the editors' pickers. The first time an
+ * image's thumbnail is made, it is also saved to the disk, so later ones
+ * don't need to decode the full image again, unless the image changed.
+ */
+struct ThumbnailLoader {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    ThumbnailLoader();
+    ThumbnailLoader(const ThumbnailLoader &l2);
+    ThumbnailLoader &operator=(const ThumbnailLoader &l2);
+    ~ThumbnailLoader();
+    void clear();
+    ALLEGRO_BITMAP* get(const string &name);
+    void start();
+    void stop();
+    void update();
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //Worker thread that makes the thumbnails.
+    WorkerThread worker;
+    
+    //Thumbnails waiting for the main thread, and the lock
+    //that protects them.
+    SyncData* sync = nullptr;
+    
+    //Thumbnails that arrived, by the internal name of their image.
+    //nullptr if the image couldn't be opened.
+    map<string, ALLEGRO_BITMAP*> thumbnails;
+    
+    //Internal names of the images whose thumbnails are on their way.
+    set<string> pending;
+    
+    
+    //--- Function declarations ---
+    
+    static ALLEGRO_BITMAP* make_thumbnail(
+        const string &path, const string &cache_path
+    );
+    
+};
+
+
+/**
+ * @brief Reads and parses an area's data files in the background, before
+ * the player has actually picked the area, so entering it is faster if
+ * they do. Only one area is kept at a time; asking for a different one
+ * cancels the previous one. The results are only ever used by the area
+ * they were read for.
+ */
+struct AreaPreloader {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    AreaPreloader();
+    AreaPreloader(const AreaPreloader &p2);
+    AreaPreloader &operator=(const AreaPreloader &p2);
+    ~AreaPreloader();
+    void cancel();
+    static vector<string> get_file_paths(const string &area_path);
+    void request(const string &area_path, float delay);
+    void start();
+    void stop();
+    bool take(const string &area_path, vector<DataNode>* out_nodes);
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //Worker thread that reads the files.
+    WorkerThread worker;
+    
+    //The request and the result, which the worker also uses, and the lock
+    //that protects them.
+    SyncData* sync = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    void read(const string &area_path);
+    
+};
+
+
+/**
+ * @brief Lowers the graphics quality when frames keep taking longer than
+ * the frame budget, and raises it back when there's plenty of headroom.
+ * It waits for a while before going either way, and waits longer before
+ * raising it, so that a single slow frame, or a quality level that is just
+ * barely fast enough, doesn't make it go back and forth.
+ */
+struct AdaptiveQuality {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    unsigned char get_level() const;
+    float get_offset_effect_scale() const;
+    float get_particle_budget_ratio() const;
+    bool has_wall_shadows() const;
+    void reset();
+    bool update(double work_time, double budget, float delta_t);
+    
+    private:
+    
+    //--- Members ---
+    
+    //Current level. 0 is full quality, and each level after lowers it more.
+    unsigned char level = 0;
+    
+    //For how long the frames have been over budget, in a row.
+    float over_budget_time = 0.0f;
+    
+    //For how long the frames have had plenty of headroom, in a row.
+    float headroom_time = 0.0f;
     
 };
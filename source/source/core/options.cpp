@@ -23,12 +23,28 @@ namespace OPTIONS {
 
 namespace ADVANCED_D {
 
+//Default value for whether to lower the graphics quality on slow frames.
+const bool ADAPTIVE_QUALITY = false;
+
+//Default value for whether to bake the floors of static sectors.
+const bool BAKE_STATIC_SECTORS = false;
+
+//Default value for whether to keep compiled copies of data files.
+const bool DATA_FILE_CACHE = true;
+
+//Default value for how many megabytes of unused bitmaps to keep loaded.
+const size_t BITMAP_CACHE_MB = 128;
+
 //Default value for the cursor trail.
 const bool DRAW_CURSOR_TRAIL = true;
 
 //Default value for whether the player is an engine developer.
 const bool ENGINE_DEV = false;
 
+//Default value for how many worker threads to use for background jobs.
+//0 means one less than the hardware can run at the same time.
+const size_t JOB_THREADS = 0;
+
 //Default value for the joystick maximum deadzone.
 const float JOYSTICK_MAX_DEADZONE = 0.9f;
 
@@ -44,6 +60,10 @@ const bool MIPMAPS_ENABLED = true;
 //Default value for whether the mouse moves the cursor, for each player.
 const bool MOUSE_MOVES_CURSOR[MAX_PLAYERS] = {true, false, false, false};
 
+//Default value for how many megabytes of unused audio samples
+//to keep loaded.
+const size_t SAMPLE_CACHE_MB = 32;
+
 //Default value for whether to use smooth scaling.
 const bool SMOOTH_SCALING = true;
 
@@ -172,6 +192,12 @@ const bool USE_CUSTOM_STYLE = false;
 
 namespace GRAPHICS_D {
 
+//Default value for the fraction of the resolution to draw the area at.
+const float RENDER_SCALE = 1.0f;
+
+//Default value for the sector texture quality tier.
+const TEXTURE_QUALITY TEXTURE_QUALITY_TIER = TEXTURE_QUALITY_FULL;
+
 //Default value for whether to use true fullscreen.
 const bool TRUE_FULLSCREEN = false;
 
@@ -235,9 +261,14 @@ void Options::load_from_data_node(DataNode* file) {
     {
         ReaderSetter ars(file->getChildByName("advanced"));
         
+        ars.set("adaptive_quality", advanced.adaptive_quality);
+        ars.set("bake_static_sectors", advanced.bake_static_sectors);
+        ars.set("bitmap_cache_mb", advanced.bitmap_cache_mb);
+        ars.set("data_file_cache", advanced.data_file_cache);
         ars.set("draw_cursor_trail", advanced.draw_cursor_trail);
         ars.set("engine_developer", advanced.engine_dev);
         ars.set("fps", advanced.target_fps);
+        ars.set("job_threads", advanced.job_threads);
         ars.set("joystick_max_deadzone", advanced.joystick_max_deadzone);
         ars.set("joystick_min_deadzone", advanced.joystick_min_deadzone);
         ars.set("max_particles", advanced.max_particles);
@@ -249,6 +280,7 @@ void Options::load_from_data_node(DataNode* file) {
                 advanced.mouse_moves_cursor[p]
             );
         }
+        ars.set("sample_cache_mb", advanced.sample_cache_mb);
         ars.set("smooth_scaling", advanced.smooth_scaling);
         ars.set("window_position_hack", advanced.window_pos_hack);
         
@@ -387,11 +419,20 @@ void Options::load_from_data_node(DataNode* file) {
     {
         ReaderSetter grs(file->getChildByName("graphics"));
         string resolution_str;
+        unsigned char texture_quality_c = graphics.texture_quality;
         
         grs.set("fullscreen", graphics.intended_win_fullscreen);
+        grs.set("render_scale", graphics.render_scale);
         grs.set("resolution", resolution_str);
+        grs.set("texture_quality", texture_quality_c);
         grs.set("true_fullscreen", graphics.true_fullscreen);
         
+        texture_quality_c =
+            std::min(
+                texture_quality_c, (unsigned char) (N_TEXTURE_QUALITIES - 1)
+            );
+        graphics.texture_quality = (TEXTURE_QUALITY) texture_quality_c;
+        
         vector<string> resolution_parts = split(resolution_str);
         if(resolution_parts.size() >= 2) {
             graphics.intended_win_w = std::max(1, s2i(resolution_parts[0]));
@@ -503,9 +544,14 @@ void Options::save_to_data_node(DataNode* file) const {
     {
         GetterWriter agw(file->addNew("advanced"));
         
+        agw.get("adaptive_quality", advanced.adaptive_quality);
+        agw.get("bake_static_sectors", advanced.bake_static_sectors);
+        agw.get("bitmap_cache_mb", advanced.bitmap_cache_mb);
+        agw.get("data_file_cache", advanced.data_file_cache);
         agw.get("draw_cursor_trail", advanced.draw_cursor_trail);
         agw.get("engine_developer", advanced.engine_dev);
         agw.get("fps", advanced.target_fps);
+        agw.get("job_threads", advanced.job_threads);
         agw.get("joystick_max_deadzone", advanced.joystick_max_deadzone);
         agw.get("joystick_min_deadzone", advanced.joystick_min_deadzone);
         agw.get("max_particles", advanced.max_particles);
@@ -517,6 +563,7 @@ void Options::save_to_data_node(DataNode* file) const {
                 advanced.mouse_moves_cursor[p]
             );
         }
+        agw.get("sample_cache_mb", advanced.sample_cache_mb);
         agw.get("smooth_scaling", advanced.smooth_scaling);
         agw.get("window_position_hack", advanced.window_pos_hack);
     }
@@ -605,7 +652,9 @@ void Options::save_to_data_node(DataNode* file) const {
         GetterWriter ggw(file->addNew("graphics"));
         
         ggw.get("fullscreen", graphics.intended_win_fullscreen);
+        ggw.get("render_scale", graphics.render_scale);
         ggw.get("resolution", resolution_str);
+        ggw.get("texture_quality", graphics.texture_quality);
         ggw.get("true_fullscreen", graphics.true_fullscreen);
     }
     
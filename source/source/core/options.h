@@ -43,6 +43,24 @@ enum AUTO_THROW_MODE {
 };
 
 
+//Quality tiers for sector textures in video memory.
+enum TEXTURE_QUALITY {
+
+    //Full quality, 32 bits per pixel.
+    TEXTURE_QUALITY_FULL,
+    
+    //Large textures are GPU-compressed, if the graphics backend allows it.
+    TEXTURE_QUALITY_COMPRESSED,
+    
+    //Large textures use 16 bits per pixel.
+    TEXTURE_QUALITY_16_BIT,
+    
+    //Total amount of texture quality tiers.
+    N_TEXTURE_QUALITIES,
+    
+};
+
+
 //Modes for the pause menu leaving confirmation question.
 enum LEAVING_CONF_MODE {
 
@@ -64,13 +82,19 @@ enum LEAVING_CONF_MODE {
 namespace OPTIONS {
 
 namespace ADVANCED_D {
+extern const bool ADAPTIVE_QUALITY;
+extern const bool BAKE_STATIC_SECTORS;
+extern const size_t BITMAP_CACHE_MB;
+extern const bool DATA_FILE_CACHE;
 extern const bool DRAW_CURSOR_TRAIL;
 extern const bool ENGINE_DEV;
+extern const size_t JOB_THREADS;
 extern const float JOYSTICK_MAX_DEADZONE;
 extern const float JOYSTICK_MIN_DEADZONE;
 extern const size_t MAX_PARTICLES;
 extern const bool MIPMAPS_ENABLED;
 extern const bool MOUSE_MOVES_CURSOR[MAX_PLAYERS];
+extern const size_t SAMPLE_CACHE_MB;
 extern const bool SMOOTH_SCALING;
 extern const unsigned int TARGET_FPS;
 extern const bool WINDOW_POS_HACK;
@@ -121,6 +145,8 @@ extern const bool USE_CUSTOM_STYLE;
 }
 
 namespace GRAPHICS_D {
+extern const float RENDER_SCALE;
+extern const TEXTURE_QUALITY TEXTURE_QUALITY_TIER;
 extern const bool TRUE_FULLSCREEN;
 extern const bool WIN_FULLSCREEN;
 extern const unsigned int WIN_H;
@@ -157,13 +183,32 @@ struct Options {
     
     //Advanced. These typicall don't appear in any options menu.
     struct {
-    
+        
+        //Lower the graphics quality when frames take too long to process,
+        //and raise it back up when they're quick again?
+        bool adaptive_quality = ADVANCED_D::ADAPTIVE_QUALITY;
+        
+        //Bake the floors of sectors that never change into bitmaps,
+        //instead of drawing them every frame?
+        bool bake_static_sectors = ADVANCED_D::BAKE_STATIC_SECTORS;
+        
+        //Megabytes worth of bitmaps to keep loaded after they stop
+        //being used, in case they're needed again. 0 to disable.
+        size_t bitmap_cache_mb = ADVANCED_D::BITMAP_CACHE_MB;
+        
+        //Keep compiled copies of the content's data files, to load faster?
+        bool data_file_cache = ADVANCED_D::DATA_FILE_CACHE;
+        
         //Draw a trail behind the mouse cursor?
         bool draw_cursor_trail = ADVANCED_D::DRAW_CURSOR_TRAIL;
         
         //Is the player a developer of the engine?
         bool engine_dev = ADVANCED_D::ENGINE_DEV;
         
+        //Number of worker threads for background jobs. 0 means one less
+        //than the number of threads the hardware can run at the same time.
+        size_t job_threads = ADVANCED_D::JOB_THREADS;
+        
         //Maximum deadzone for joysticks.
         float joystick_max_deadzone = ADVANCED_D::JOYSTICK_MAX_DEADZONE;
         
@@ -184,6 +229,10 @@ struct Options {
             ADVANCED_D::MOUSE_MOVES_CURSOR[3]
         };
         
+        //Megabytes worth of audio samples to keep loaded after they stop
+        //being used, in case they're needed again. 0 to disable.
+        size_t sample_cache_mb = ADVANCED_D::SAMPLE_CACHE_MB;
+        
         //True to use interpolation when graphics are scaled up/down.
         bool smooth_scaling = ADVANCED_D::SMOOTH_SCALING;
         
@@ -331,6 +380,14 @@ struct Options {
         //Player's intended option for window width, before restarting the game.
         int intended_win_w = GRAPHICS_D::WIN_W;
         
+        //The area gets drawn at this fraction of the window's resolution,
+        //and then scaled up to fit. The HUD is always at full resolution.
+        float render_scale = GRAPHICS_D::RENDER_SCALE;
+        
+        //How to keep sector textures in video memory. The lower tiers
+        //use less memory and bandwidth, and look worse.
+        TEXTURE_QUALITY texture_quality = GRAPHICS_D::TEXTURE_QUALITY_TIER;
+        
         //When using fullscreen, is this true fullscreen, or borderless window?
         bool true_fullscreen = GRAPHICS_D::TRUE_FULLSCREEN;
         
@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <queue>
 
 #include "pathing.h"
 
@@ -29,12 +30,34 @@ namespace PATHS {
 //Default distance at which the mob considers the chase finished.
 const float DEF_CHASE_TARGET_DISTANCE = 3.0f;
 
+//Maximum number of path search results that can be cached at once.
+const size_t MAX_CACHED_PATHS = 512;
+
+//Maximum number of destination trees that can be kept at once.
+const size_t MAX_DESTINATION_TREES = 16;
+
+//Searches to the same destination that are needed before it's worth
+//building a tree of the ways to it from everywhere.
+const size_t MIN_DESTINATION_TREE_SEARCHES = 3;
+
 //Minimum radius of a path stop.
 const float MIN_STOP_RADIUS = 16.0f;
 
+//Number of landmark stops used to estimate distances during path searches.
+const size_t N_LANDMARKS = 8;
+
+//Seconds per frame that can be spent letting mobs re-calculate their paths
+//after the paths changed.
+const double PATH_CHANGE_BUDGET = 0.002;
+
 }
 
 
+//Data used by the path searches of the current thread. Each thread has
+//its own, so that searches can run on several threads at once.
+static thread_local PathSearchScratch search_scratch;
+
+
 /**
  * @brief Constructs a new path link object.
  *
@@ -84,29 +107,574 @@ bool PathLink::is_one_way() const {
 }
 
 
+/**
+ * @brief Constructs a new path cache key object.
+ *
+ * @param start_ptr Start stop.
+ * @param end_ptr End stop.
+ * @param settings Settings about how the path should be followed.
+ */
+PathManager::PathCacheKey::PathCacheKey(
+    PathStop* start_ptr, PathStop* end_ptr,
+    const PathFollowSettings &settings
+) :
+    start_ptr(start_ptr),
+    end_ptr(end_ptr),
+    label(settings.label),
+    invulnerabilities(settings.invulnerabilities) {
+    
+    //Only keep the flags that the A* algorithm cares about.
+    flags =
+        settings.flags & (
+            PATH_FOLLOW_FLAG_IGNORE_OBSTACLES |
+            PATH_FOLLOW_FLAG_SCRIPT_USE |
+            PATH_FOLLOW_FLAG_LIGHT_LOAD |
+            PATH_FOLLOW_FLAG_AIRBORNE
+        );
+}
+
+
+/**
+ * @brief Compares two path cache keys, so they can be sorted in a map.
+ *
+ * @param k2 Key to compare against.
+ * @return Whether this key goes before the other one.
+ */
+bool PathManager::PathCacheKey::operator<(const PathCacheKey &k2) const {
+    if(start_ptr != k2.start_ptr) return start_ptr < k2.start_ptr;
+    if(end_ptr != k2.end_ptr) return end_ptr < k2.end_ptr;
+    if(flags != k2.flags) return flags < k2.flags;
+    if(label != k2.label) return label < k2.label;
+    return invulnerabilities.to_ullong() < k2.invulnerabilities.to_ullong();
+}
+
+
+/**
+ * @brief Calculates the shortest ways from every stop to a destination stop,
+ * by going backward through the links from the destination.
+ *
+ * @param tree Tree to fill.
+ * @param end_node The destination stop.
+ * @param settings Settings about how the path should be followed.
+ */
+void PathManager::build_destination_tree(
+    DestinationTree &tree, PathStop* end_node,
+    const PathFollowSettings &settings
+) {
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    if(incoming_links.size() != stops.size()) return;
+    size_t end_idx = get_stop_idx(end_node);
+    if(end_idx == INVALID) return;
+    
+    tree.next_idxs.assign(stops.size(), INVALID);
+    tree.dists.assign(stops.size(), FLT_MAX);
+    
+    typedef std::pair<float, size_t> queue_entry;
+    std::priority_queue<
+        queue_entry, vector<queue_entry>, std::greater<queue_entry>
+        > queue;
+    tree.dists[end_idx] = 0.0f;
+    queue.push(std::make_pair(0.0f, end_idx));
+    
+    while(!queue.empty()) {
+        queue_entry cur = queue.top();
+        queue.pop();
+        if(cur.first > tree.dists[cur.second]) continue;
+        
+        const auto &in = incoming_links[cur.second];
+        for(size_t i = 0; i < in.size(); i++) {
+            if(!can_traverse_path_link(in[i].second, settings)) continue;
+            float d = cur.first + in[i].second->distance;
+            if(d < tree.dists[in[i].first]) {
+                tree.dists[in[i].first] = d;
+                tree.next_idxs[in[i].first] = cur.second;
+                queue.push(std::make_pair(d, in[i].first));
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Lists the links that go into each stop.
+ */
+void PathManager::build_incoming_links() {
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    incoming_links.assign(stops.size(), {});
+    for(size_t s = 0; s < stops.size(); s++) {
+        for(size_t l = 0; l < stops[s]->links.size(); l++) {
+            PathLink* l_ptr = stops[s]->links[l];
+            if(l_ptr->end_idx >= stops.size()) continue;
+            incoming_links[l_ptr->end_idx].push_back(
+                std::make_pair(s, l_ptr)
+            );
+        }
+    }
+}
+
+
+/**
+ * @brief Picks some stops to be landmarks, and calculates the shortest
+ * distances between them and every other stop. A path search can use these
+ * to estimate the remaining distance much better than a straight line can.
+ * The distances ignore all restrictions, so they can only ever be
+ * shorter than a path that follows them, and don't need to be updated
+ * when obstacles or hazards change.
+ */
+void PathManager::build_landmarks() {
+    landmark_dists_from.clear();
+    landmark_dists_to.clear();
+    
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    if(stops.empty() || incoming_links.size() != stops.size()) return;
+    
+    //Spread the landmarks out, by always picking the stop that's
+    //the farthest away from the ones picked so far.
+    vector<size_t> landmark_idxs;
+    vector<float> closest_landmark_dists(stops.size(), FLT_MAX);
+    size_t next_idx = 0;
+    float farthest_dist = 0.0f;
+    for(size_t s = 0; s < stops.size(); s++) {
+        float d = Distance(stops[0]->pos, stops[s]->pos).to_float();
+        if(d > farthest_dist) {
+            farthest_dist = d;
+            next_idx = s;
+        }
+    }
+    size_t n_landmarks = std::min(PATHS::N_LANDMARKS, stops.size());
+    while(landmark_idxs.size() < n_landmarks) {
+        landmark_idxs.push_back(next_idx);
+        farthest_dist = -1.0f;
+        for(size_t s = 0; s < stops.size(); s++) {
+            closest_landmark_dists[s] =
+                std::min(
+                    closest_landmark_dists[s],
+                    Distance(stops[next_idx]->pos, stops[s]->pos).to_float()
+                );
+        }
+        for(size_t s = 0; s < stops.size(); s++) {
+            if(closest_landmark_dists[s] > farthest_dist) {
+                farthest_dist = closest_landmark_dists[s];
+                next_idx = s;
+            }
+        }
+    }
+    
+    //Dijkstra's algorithm from each landmark, going forward through
+    //the links for the distances from it, and backward for the distances
+    //to it.
+    typedef std::pair<float, size_t> queue_entry;
+    for(size_t lm = 0; lm < landmark_idxs.size(); lm++) {
+        for(unsigned char backward = 0; backward < 2; backward++) {
+            vector<float> dists(stops.size(), FLT_MAX);
+            std::priority_queue<
+                queue_entry, vector<queue_entry>, std::greater<queue_entry>
+                > queue;
+            dists[landmark_idxs[lm]] = 0.0f;
+            queue.push(std::make_pair(0.0f, landmark_idxs[lm]));
+            
+            while(!queue.empty()) {
+                queue_entry cur = queue.top();
+                queue.pop();
+                if(cur.first > dists[cur.second]) continue;
+                
+                if(backward == 0) {
+                    PathStop* s_ptr = stops[cur.second];
+                    for(size_t l = 0; l < s_ptr->links.size(); l++) {
+                        PathLink* l_ptr = s_ptr->links[l];
+                        if(l_ptr->end_idx >= stops.size()) continue;
+                        float d = cur.first + l_ptr->distance;
+                        if(d < dists[l_ptr->end_idx]) {
+                            dists[l_ptr->end_idx] = d;
+                            queue.push(std::make_pair(d, l_ptr->end_idx));
+                        }
+                    }
+                } else {
+                    const auto &in = incoming_links[cur.second];
+                    for(size_t i = 0; i < in.size(); i++) {
+                        float d = cur.first + in[i].second->distance;
+                        if(d < dists[in[i].first]) {
+                            dists[in[i].first] = d;
+                            queue.push(std::make_pair(d, in[i].first));
+                        }
+                    }
+                }
+            }
+            
+            if(backward == 0) {
+                landmark_dists_from.push_back(dists);
+            } else {
+                landmark_dists_to.push_back(dists);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Places each path link in the link blocks that its bounding box
+ * touches.
+ */
+void PathManager::build_link_blocks() {
+    const Blockmap &bmap = game.cur_area_data->bmap;
+    link_blocks.assign(
+        bmap.n_cols, vector<vector<PathLink*> >(bmap.n_rows)
+    );
+    if(bmap.n_cols == 0 || bmap.n_rows == 0) return;
+    
+    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+        PathStop* s_ptr = game.cur_area_data->path_stops[s];
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            PathLink* l_ptr = s_ptr->links[l];
+            const Point &p1 = s_ptr->pos;
+            const Point &p2 = l_ptr->end_ptr->pos;
+            size_t bx1 = get_link_block_col(std::min(p1.x, p2.x));
+            size_t bx2 = get_link_block_col(std::max(p1.x, p2.x));
+            size_t by1 = get_link_block_row(std::min(p1.y, p2.y));
+            size_t by2 = get_link_block_row(std::max(p1.y, p2.y));
+            for(size_t bx = bx1; bx <= bx2; bx++) {
+                for(size_t by = by1; by <= by2; by++) {
+                    link_blocks[bx][by].push_back(l_ptr);
+                }
+            }
+        }
+    }
+}
+
+
 /**
  * @brief Clears all info.
  */
 void PathManager::clear() {
+    path_cache.clear();
+    path_cache_enabled = false;
+    destination_trees.clear();
+    
+    link_blocks.clear();
+    incoming_links.clear();
+    landmark_dists_from.clear();
+    landmark_dists_to.clear();
+    path_changes_pending = false;
+    stop_idxs.clear();
+    
     if(!game.cur_area_data) return;
     
-    obstructions.clear();
+    obstacle_links.clear();
+    pending_obstacles.clear();
     
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
         for(size_t l = 0; l < s_ptr->links.size(); l++) {
-            game.cur_area_data->path_stops[s]->links[l]->blocked_by_obstacle =
-                false;
+            game.cur_area_data->path_stops[s]->links[l]->n_obstacles = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Returns an estimate of the distance of the shortest path between
+ * two stops. This is never more than the real distance.
+ *
+ * @param from_idx Index of the stop to start from.
+ * @param to_idx Index of the stop to end at.
+ * @return The estimate.
+ */
+float PathManager::estimate_dist(size_t from_idx, size_t to_idx) const {
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    float estimate =
+        Distance(stops[from_idx]->pos, stops[to_idx]->pos).to_float();
+        
+    for(size_t lm = 0; lm < landmark_dists_from.size(); lm++) {
+        const vector<float> &from_lm = landmark_dists_from[lm];
+        const vector<float> &to_lm = landmark_dists_to[lm];
+        if(from_lm.size() != stops.size()) return estimate;
+        
+        //Going from the landmark to the end can't be shorter than going
+        //from the landmark to the start, and then to the end.
+        if(from_lm[from_idx] != FLT_MAX && from_lm[to_idx] != FLT_MAX) {
+            estimate =
+                std::max(estimate, from_lm[to_idx] - from_lm[from_idx]);
+        }
+        //Same logic, but for the way from the start to the landmark.
+        if(to_lm[from_idx] != FLT_MAX && to_lm[to_idx] != FLT_MAX) {
+            estimate = std::max(estimate, to_lm[from_idx] - to_lm[to_idx]);
+        }
+    }
+    
+    return estimate;
+}
+
+
+/**
+ * @brief Finds the path links that an obstacle blocks.
+ *
+ * @param m The obstacle mob.
+ * @param out_links The links are returned here.
+ */
+void PathManager::find_obstacle_links(
+    Mob* m, vector<PathLink*> &out_links
+) const {
+    out_links.clear();
+    
+    vector<PathLink*> nearby_links;
+    get_links_in_region(
+        m->pos - m->radius, m->pos + m->radius, nearby_links
+    );
+    
+    for(size_t l = 0; l < nearby_links.size(); l++) {
+        PathLink* l_ptr = nearby_links[l];
+        if(
+            circle_intersects_line_seg(
+                m->pos, m->radius,
+                l_ptr->start_ptr->pos, l_ptr->end_ptr->pos
+            )
+        ) {
+            out_links.push_back(l_ptr);
+        }
+    }
+}
+
+
+/**
+ * @brief Gets the path between two stops from the tree of the ways to the
+ * end stop, if the end stop is searched for often enough to have one.
+ *
+ * @param out_path The stops to visit, in order, are returned here, if any.
+ * @param start_node Start stop.
+ * @param end_node End stop.
+ * @param settings Settings about how the path should be followed.
+ * @param out_result The result of the search is returned here.
+ * @param out_total_dist If not nullptr, the total path distance is
+ * returned here.
+ * @return Whether there was a tree to get the path from.
+ */
+bool PathManager::get_destination_tree_path(
+    vector<PathStop*> &out_path,
+    PathStop* start_node, PathStop* end_node,
+    const PathFollowSettings &settings,
+    PATH_RESULT* out_result, float* out_total_dist
+) {
+    PathCacheKey key(nullptr, end_node, settings);
+    auto it = destination_trees.find(key);
+    if(it == destination_trees.end()) {
+        if(destination_trees.size() >= PATHS::MAX_DESTINATION_TREES) {
+            destination_trees.clear();
+        }
+        it =
+            destination_trees.insert(
+                std::make_pair(key, DestinationTree())
+            ).first;
+    }
+    DestinationTree &tree = it->second;
+    
+    if(tree.next_idxs.empty()) {
+        tree.n_searches++;
+        if(tree.n_searches < PATHS::MIN_DESTINATION_TREE_SEARCHES) {
+            return false;
         }
+        build_destination_tree(tree, end_node, settings);
+        if(tree.next_idxs.empty()) return false;
     }
+    
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    size_t start_idx = get_stop_idx(start_node);
+    if(start_idx == INVALID || tree.next_idxs.size() != stops.size()) {
+        return false;
+    }
+    
+    if(tree.dists[start_idx] == FLT_MAX) {
+        if(!has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+            //Let's try again, this time ignoring obstacles, like A* does.
+            PathFollowSettings new_settings = settings;
+            enable_flag(new_settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES);
+            PATH_RESULT new_result =
+                get_stop_to_stop_path(
+                    out_path, start_node, end_node,
+                    new_settings, out_total_dist
+                );
+            *out_result =
+                new_result == PATH_RESULT_NORMAL_PATH ?
+                PATH_RESULT_PATH_WITH_OBSTACLES :
+                new_result;
+        } else {
+            out_path.clear();
+            if(out_total_dist) *out_total_dist = 0;
+            *out_result = PATH_RESULT_END_STOP_UNREACHABLE;
+        }
+        return true;
+    }
+    
+    out_path.clear();
+    for(size_t s = start_idx; s != INVALID; s = tree.next_idxs[s]) {
+        out_path.push_back(stops[s]);
+    }
+    if(out_total_dist) *out_total_dist = tree.dists[start_idx];
+    *out_result = PATH_RESULT_NORMAL_PATH;
+    return true;
+}
+
+
+/**
+ * @brief Returns the column of the link blocks that a given X
+ * coordinate falls on. Coordinates outside of the blockmap
+ * count as being in the nearest column.
+ *
+ * @param x X coordinate.
+ * @return The column.
+ */
+size_t PathManager::get_link_block_col(float x) const {
+    const Blockmap &bmap = game.cur_area_data->bmap;
+    float col = (x - bmap.top_left_corner.x) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    if(col <= 0.0f) return 0;
+    if(col >= bmap.n_cols) return bmap.n_cols - 1;
+    return (size_t) col;
+}
+
+
+/**
+ * @brief Returns the row of the link blocks that a given Y
+ * coordinate falls on. Coordinates outside of the blockmap
+ * count as being in the nearest row.
+ *
+ * @param y Y coordinate.
+ * @return The row.
+ */
+size_t PathManager::get_link_block_row(float y) const {
+    const Blockmap &bmap = game.cur_area_data->bmap;
+    float row = (y - bmap.top_left_corner.y) / GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    if(row <= 0.0f) return 0;
+    if(row >= bmap.n_rows) return bmap.n_rows - 1;
+    return (size_t) row;
+}
+
+
+/**
+ * @brief Obtains a list of the path links in the blocks that the specified
+ * rectangular region touches.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param out_links Vector to fill the links into. It gets cleared first.
+ * The links are sorted by their address, with no repeats.
+ */
+void PathManager::get_links_in_region(
+    const Point &tl, const Point &br, vector<PathLink*> &out_links
+) const {
+    out_links.clear();
+    if(link_blocks.empty() || link_blocks[0].empty()) return;
+    
+    size_t bx1 = get_link_block_col(tl.x);
+    size_t bx2 = get_link_block_col(br.x);
+    size_t by1 = get_link_block_row(tl.y);
+    size_t by2 = get_link_block_row(br.y);
+    
+    for(size_t bx = bx1; bx <= bx2; bx++) {
+        for(size_t by = by1; by <= by2; by++) {
+            out_links.insert(
+                out_links.end(),
+                link_blocks[bx][by].begin(), link_blocks[bx][by].end()
+            );
+        }
+    }
+    
+    std::sort(out_links.begin(), out_links.end());
+    out_links.erase(
+        std::unique(out_links.begin(), out_links.end()),
+        out_links.end()
+    );
+}
+
+
+/**
+ * @brief Returns the index of a path stop in the area's list of stops.
+ *
+ * @param s_ptr The stop.
+ * @return The index, or INVALID if it's not in the list.
+ */
+size_t PathManager::get_stop_idx(const PathStop* s_ptr) const {
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    auto it = stop_idxs.find(s_ptr);
+    if(
+        it != stop_idxs.end() &&
+        it->second < stops.size() && stops[it->second] == s_ptr
+    ) {
+        return it->second;
+    }
+    
+    //Not known, or out of date. Find it the slow way.
+    size_t idx = std::find(stops.begin(), stops.end(), s_ptr) - stops.begin();
+    return idx < stops.size() ? idx : INVALID;
+}
+
+
+/**
+ * @brief Gets the shortest available path between two path stops.
+ * If the same search was done before, and nothing has changed since then,
+ * the previous result is returned instead of running A* again.
+ *
+ * @param out_path The stops to visit, in order, are returned here.
+ * @param start_node Start node.
+ * @param end_node End node.
+ * @param settings Settings about how the path should be followed.
+ * @param out_total_dist If not nullptr, the total path distance is
+ * returned here.
+ * @return The operation's result.
+ */
+PATH_RESULT PathManager::get_stop_to_stop_path(
+    vector<PathStop*> &out_path,
+    PathStop* start_node, PathStop* end_node,
+    const PathFollowSettings &settings,
+    float* out_total_dist
+) {
+    if(!path_cache_enabled) {
+        return
+            a_star(
+                out_path, start_node, end_node, settings, out_total_dist
+            );
+    }
+    
+    PathCacheKey key(start_node, end_node, settings);
+    auto it = path_cache.find(key);
+    if(it != path_cache.end()) {
+        out_path = it->second.path;
+        if(out_total_dist) *out_total_dist = it->second.total_dist;
+        return it->second.result;
+    }
+    
+    PathCacheEntry entry;
+    if(
+        !get_destination_tree_path(
+            out_path, start_node, end_node, settings,
+            &entry.result, &entry.total_dist
+        )
+    ) {
+        entry.result =
+            a_star(
+                out_path, start_node, end_node, settings, &entry.total_dist
+            );
+    }
+    entry.path = out_path;
+    if(out_total_dist) *out_total_dist = entry.total_dist;
+    
+    if(path_cache.size() >= PATHS::MAX_CACHED_PATHS) {
+        path_cache.clear();
+    }
+    path_cache.insert(std::make_pair(key, entry));
+    
+    return entry.result;
 }
 
 
 /**
  * @brief Handles the area having been loaded. It checks all path stops
- * and saves any sector hazards found.
+ * and saves any sector hazards found, and checks which links the obstacles
+ * placed so far are blocking.
  */
 void PathManager::handle_area_load() {
+    path_cache.clear();
+    destination_trees.clear();
+    path_cache_enabled = true;
+    
     //Go through all path stops and check if they're on hazardous sectors.
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
@@ -114,6 +682,31 @@ void PathManager::handle_area_load() {
         if(s_ptr->sector_ptr->hazards.empty()) continue;
         hazardous_stops.insert(s_ptr);
     }
+    
+    build_link_blocks();
+    
+    //Check all of the obstacles that were created along with the area.
+    //The path cache is empty, and nothing is following a path yet,
+    //so only the links need updating.
+    for(size_t o = 0; o < pending_obstacles.size(); o++) {
+        Mob* m_ptr = pending_obstacles[o];
+        vector<PathLink*> links;
+        find_obstacle_links(m_ptr, links);
+        if(links.empty()) continue;
+        for(size_t l = 0; l < links.size(); l++) {
+            links[l]->n_obstacles++;
+        }
+        obstacle_links[m_ptr] = links;
+    }
+    pending_obstacles.clear();
+    
+    stop_idxs.clear();
+    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+        stop_idxs[game.cur_area_data->path_stops[s]] = s;
+    }
+    
+    build_incoming_links();
+    build_landmarks();
 }
 
 
@@ -124,38 +717,30 @@ void PathManager::handle_area_load() {
  * @param m Pointer to the obstacle mob that got added.
  */
 void PathManager::handle_obstacle_add(Mob* m) {
-    //Add the obstacle to our list, if needed.
-    bool paths_changed = false;
-    
-    //Go through all path links and check if they have obstacles.
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
-        PathStop* s_ptr = game.cur_area_data->path_stops[s];
-        
-        for(size_t l = 0; l < s_ptr->links.size(); l++) {
-            PathLink* l_ptr = game.cur_area_data->path_stops[s]->links[l];
-            
-            if(
-                circle_intersects_line_seg(
-                    m->pos, m->radius,
-                    s_ptr->pos, l_ptr->end_ptr->pos
-                )
-            ) {
-                obstructions[l_ptr].insert(m);
-                l_ptr->blocked_by_obstacle = true;
-                paths_changed = true;
-            }
-        }
+    if(!path_cache_enabled) {
+        //The area is still loading. Leave it for when it's done.
+        pending_obstacles.push_back(m);
+        return;
     }
+    if(obstacle_links.find(m) != obstacle_links.end()) return;
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m2 = 0; m2 < game.states.gameplay->mobs.all.size(); m2++) {
-            Mob* m2_ptr = game.states.gameplay->mobs.all[m2];
-            if(!m2_ptr->path_info) continue;
-            
-            m2_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
+    vector<PathLink*> links;
+    find_obstacle_links(m, links);
+    if(links.empty()) return;
+    
+    for(size_t l = 0; l < links.size(); l++) {
+        PathLink* l_ptr = links[l];
+        if(l_ptr->n_obstacles == 0) {
+            //Paths that used this link are no longer valid.
+            //Other paths can't have gotten any shorter, so
+            //they're still fine.
+            invalidate_cached_paths_with_link(l_ptr);
         }
+        l_ptr->n_obstacles++;
     }
+    obstacle_links[m] = links;
+    
+    notify_path_followers();
 }
 
 
@@ -166,76 +751,378 @@ void PathManager::handle_obstacle_add(Mob* m) {
  * @param m Pointer to the obstacle mob that got cleared.
  */
 void PathManager::handle_obstacle_remove(Mob* m) {
-    //Remove the obstacle from our list, if it's there.
+    //Remove the obstacle from our lists, if it's there.
+    auto pending_it =
+        std::find(pending_obstacles.begin(), pending_obstacles.end(), m);
+    if(pending_it != pending_obstacles.end()) {
+        pending_obstacles.erase(pending_it);
+        return;
+    }
+    
+    auto o = obstacle_links.find(m);
+    if(o == obstacle_links.end()) return;
+    
+    bool paths_changed = false;
+    for(size_t l = 0; l < o->second.size(); l++) {
+        PathLink* l_ptr = o->second[l];
+        l_ptr->n_obstacles--;
+        if(l_ptr->n_obstacles == 0) paths_changed = true;
+    }
+    obstacle_links.erase(o);
+    
+    if(paths_changed) {
+        //A link that opened up could make for a shorter path anywhere.
+        invalidate_obstacle_dependent_cached_paths();
+        
+        notify_path_followers();
+    }
+}
+
+
+/**
+ * @brief Handles some sectors having changed their hazards.
+ * This way, any stop on those sectors can be updated. Only the stops of
+ * the links in the blocks that each sector touches are checked, and all
+ * sectors are handled in one go, so the paths only get invalidated once.
+ *
+ * @param sectors The sectors whose hazards got updated.
+ */
+void PathManager::handle_sector_hazard_changes(
+    const unordered_set<Sector*> &sectors
+) {
+    if(sectors.empty()) return;
+    
     bool paths_changed = false;
+    bool became_hazardless = false;
+    vector<PathLink*> links;
     
-    for(auto o = obstructions.begin(); o != obstructions.end();) {
-        bool to_delete = false;
-        if(o->second.erase(m) > 0) {
-            if(o->second.empty()) {
-                o->first->blocked_by_obstacle = false;
-                to_delete = true;
-                paths_changed = true;
+    for(Sector* s_ptr : sectors) {
+        get_links_in_region(s_ptr->bbox[0], s_ptr->bbox[1], links);
+        for(size_t l = 0; l < links.size(); l++) {
+            PathStop* link_stops[2] = {
+                links[l]->start_ptr, links[l]->end_ptr
+            };
+            for(unsigned char s = 0; s < 2; s++) {
+                if(link_stops[s]->sector_ptr != s_ptr) continue;
+                if(s_ptr->hazards.empty()) {
+                    if(hazardous_stops.erase(link_stops[s]) > 0) {
+                        paths_changed = true;
+                        became_hazardless = true;
+                    }
+                } else {
+                    hazardous_stops.insert(link_stops[s]);
+                    paths_changed = true;
+                }
             }
         }
-        if(to_delete) {
-            o = obstructions.erase(o);
+    }
+    
+    if(became_hazardless) {
+        //A stop that stopped being hazardous could make for a shorter
+        //path anywhere.
+        invalidate_obstacle_dependent_cached_paths();
+        
+        notify_path_followers();
+    } else if(paths_changed) {
+        //Only the mobs going through the sectors can be affected.
+        invalidate_obstacle_dependent_cached_paths();
+        
+        notify_path_followers(&sectors);
+    }
+}
+
+
+/**
+ * @brief Removes from the path cache any path, and any destination tree,
+ * that goes through the specified link. Paths that ignore obstacles
+ * are kept.
+ *
+ * @param l_ptr The link.
+ */
+void PathManager::invalidate_cached_paths_with_link(const PathLink* l_ptr) {
+    for(auto c = path_cache.begin(); c != path_cache.end();) {
+        bool uses_link = false;
+        if(
+            !has_flag(c->first.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
+            c->second.result == PATH_RESULT_NORMAL_PATH
+        ) {
+            const vector<PathStop*> &path = c->second.path;
+            for(size_t s = 0; s + 1 < path.size(); s++) {
+                if(
+                    path[s] == l_ptr->start_ptr &&
+                    path[s + 1] == l_ptr->end_ptr
+                ) {
+                    uses_link = true;
+                    break;
+                }
+            }
+        }
+        
+        if(uses_link) {
+            c = path_cache.erase(c);
         } else {
-            ++o;
+            ++c;
         }
     }
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m2 = 0; m2 < game.states.gameplay->mobs.all.size(); m2++) {
-            Mob* m2_ptr = game.states.gameplay->mobs.all[m2];
-            if(!m2_ptr->path_info) continue;
+    size_t start_idx = get_stop_idx(l_ptr->start_ptr);
+    for(auto t = destination_trees.begin(); t != destination_trees.end();) {
+        bool uses_link =
+            !has_flag(t->first.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
+            start_idx < t->second.next_idxs.size() &&
+            t->second.next_idxs[start_idx] == l_ptr->end_idx;
             
-            m2_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
+        if(uses_link) {
+            t = destination_trees.erase(t);
+        } else {
+            ++t;
         }
     }
 }
 
 
 /**
- * @brief Handles a sector having changed its hazards.
- * This way, any stop on that sector can be updated.
- *
- * @param sector_ptr Pointer to the sector whose hazards got updated.
+ * @brief Removes from the path cache any path, and any destination tree,
+ * whose result can change depending on obstacles and hazards.
+ * Paths that ignore obstacles are kept.
  */
-void PathManager::handle_sector_hazard_change(Sector* sector_ptr) {
-    //Remove relevant stops from our list.
-    bool paths_changed = false;
+void PathManager::invalidate_obstacle_dependent_cached_paths() {
+    for(auto c = path_cache.begin(); c != path_cache.end();) {
+        if(!has_flag(c->first.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+            c = path_cache.erase(c);
+        } else {
+            ++c;
+        }
+    }
     
-    for(auto s = hazardous_stops.begin(); s != hazardous_stops.end();) {
-        bool to_delete = false;
-        if((*s)->sector_ptr == sector_ptr) {
-            paths_changed = true;
-            if(sector_ptr->hazards.empty()) {
-                //We only want to delete it if it became hazardless.
-                to_delete = true;
+    for(auto t = destination_trees.begin(); t != destination_trees.end();) {
+        if(!has_flag(t->first.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES)) {
+            t = destination_trees.erase(t);
+        } else {
+            ++t;
+        }
+    }
+}
+
+
+/**
+ * @brief Marks the mobs that are following a path as needing to know that
+ * the paths changed, so they can re-calculate theirs. They only get told
+ * later, a few per frame, so that a big change doesn't make every mob
+ * re-calculate at once. Until then, they keep following their current path.
+ *
+ * @param sectors If not nullptr, only mobs whose paths have a stop
+ * on one of these sectors are marked.
+ */
+void PathManager::notify_path_followers(
+    const unordered_set<Sector*>* sectors
+) {
+    const vector<Mob*> &followers = game.states.gameplay->mobs.path_followers;
+    for(size_t f = 0; f < followers.size(); f++) {
+        Mob* m_ptr = followers[f];
+        if(!m_ptr->path_info) continue;
+        if(!m_ptr->type->handled_events[MOB_EV_PATHS_CHANGED]) continue;
+        
+        if(sectors) {
+            const vector<PathStop*> &path = m_ptr->path_info->path;
+            bool crosses_sector = false;
+            for(size_t s = 0; s < path.size(); s++) {
+                if(sectors->find(path[s]->sector_ptr) != sectors->end()) {
+                    crosses_sector = true;
+                    break;
+                }
             }
+            if(!crosses_sector) continue;
         }
         
-        if(to_delete) {
-            s = hazardous_stops.erase(s);
-        } else {
-            ++s;
+        m_ptr->path_info->paths_changed_pending = true;
+        path_changes_pending = true;
+    }
+}
+
+
+/**
+ * @brief Tells the mobs that were marked by a change in the paths that
+ * the paths changed, so they can re-calculate theirs.
+ * This is meant to be called once per frame.
+ *
+ * @param budget Stop after spending this many seconds. At least one
+ * mob is always told, if there are any.
+ */
+void PathManager::process_pending_path_changes(double budget) {
+    if(!path_changes_pending) return;
+    
+    double start_time = al_get_time();
+    
+    //Mobs can stop following their path in response, so go through a copy.
+    vector<Mob*> followers = game.states.gameplay->mobs.path_followers;
+    for(size_t f = 0; f < followers.size(); f++) {
+        Mob* m_ptr = followers[f];
+        if(!m_ptr->path_info) continue;
+        if(!m_ptr->path_info->paths_changed_pending) continue;
+        
+        m_ptr->path_info->paths_changed_pending = false;
+        m_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
+        
+        if(al_get_time() - start_time >= budget) {
+            //Whoever's left gets their turn next frame.
+            return;
         }
     }
     
-    if(paths_changed) {
-        //Re-calculate the paths of mobs taking paths.
-        for(size_t m = 0; m < game.states.gameplay->mobs.all.size(); m++) {
-            Mob* m_ptr = game.states.gameplay->mobs.all[m];
-            if(!m_ptr->path_info) continue;
-            
-            m_ptr->fsm.run_event(MOB_EV_PATHS_CHANGED);
+    path_changes_pending = false;
+}
+
+
+/**
+ * @brief Returns a node's data for the current search. If the node
+ * hasn't been touched by the current search yet, its data is reset first.
+ *
+ * @param stop_idx Index of the node's path stop.
+ * @return The data.
+ */
+PathSearchScratch::Node &PathSearchScratch::get_node(size_t stop_idx) {
+    Node &n = nodes[stop_idx];
+    if(n.generation != generation) {
+        n = Node();
+        n.generation = generation;
+    }
+    return n;
+}
+
+
+/**
+ * @brief Returns whether the node at a given position in the open heap
+ * should be visited before the node at another position.
+ *
+ * @param pos1 Position of the first node.
+ * @param pos2 Position of the second node.
+ * @return Whether it's better.
+ */
+bool PathSearchScratch::is_heap_pos_better(size_t pos1, size_t pos2) const {
+    return
+        nodes[open_heap[pos1]].estimated <
+        nodes[open_heap[pos2]].estimated;
+}
+
+
+/**
+ * @brief Returns whether there are no more nodes to visit.
+ *
+ * @return Whether it's empty.
+ */
+bool PathSearchScratch::is_open_empty() const {
+    return open_heap.empty();
+}
+
+
+/**
+ * @brief Removes the node with the lowest estimated distance from the
+ * list of nodes to visit, and returns it.
+ *
+ * @return Index of the node's path stop.
+ */
+size_t PathSearchScratch::pop_open() {
+    size_t stop_idx = open_heap[0];
+    swap_heap_positions(0, open_heap.size() - 1);
+    open_heap.pop_back();
+    nodes[stop_idx].heap_pos = INVALID;
+    if(!open_heap.empty()) sift_down(0);
+    return stop_idx;
+}
+
+
+/**
+ * @brief Adds a node to the list of nodes to visit. If it's already there,
+ * its place in the list is updated to match its new estimated distance.
+ *
+ * @param stop_idx Index of the node's path stop.
+ */
+void PathSearchScratch::push_open(size_t stop_idx) {
+    Node &n = get_node(stop_idx);
+    if(n.heap_pos == INVALID) {
+        open_heap.push_back(stop_idx);
+        n.heap_pos = open_heap.size() - 1;
+    }
+    sift_up(n.heap_pos);
+    sift_down(n.heap_pos);
+}
+
+
+/**
+ * @brief Moves the node at the given heap position down the heap, until
+ * the heap is valid again.
+ *
+ * @param pos Position of the node in the heap.
+ */
+void PathSearchScratch::sift_down(size_t pos) {
+    while(true) {
+        size_t best_pos = pos;
+        size_t left_pos = pos * 2 + 1;
+        size_t right_pos = pos * 2 + 2;
+        if(
+            left_pos < open_heap.size() &&
+            is_heap_pos_better(left_pos, best_pos)
+        ) {
+            best_pos = left_pos;
+        }
+        if(
+            right_pos < open_heap.size() &&
+            is_heap_pos_better(right_pos, best_pos)
+        ) {
+            best_pos = right_pos;
         }
+        if(best_pos == pos) return;
+        swap_heap_positions(pos, best_pos);
+        pos = best_pos;
     }
 }
 
 
+/**
+ * @brief Moves the node at the given heap position up the heap, until
+ * the heap is valid again.
+ *
+ * @param pos Position of the node in the heap.
+ */
+void PathSearchScratch::sift_up(size_t pos) {
+    while(pos > 0) {
+        size_t parent_pos = (pos - 1) / 2;
+        if(!is_heap_pos_better(pos, parent_pos)) return;
+        swap_heap_positions(pos, parent_pos);
+        pos = parent_pos;
+    }
+}
+
+
+/**
+ * @brief Prepares the data for a new search.
+ *
+ * @param n_stops Total number of path stops in the area.
+ */
+void PathSearchScratch::start(size_t n_stops) {
+    if(nodes.size() != n_stops) {
+        nodes.assign(n_stops, Node());
+        generation = 0;
+    }
+    generation++;
+    open_heap.clear();
+}
+
+
+/**
+ * @brief Swaps two nodes in the open heap.
+ *
+ * @param pos1 Position of the first node.
+ * @param pos2 Position of the second node.
+ */
+void PathSearchScratch::swap_heap_positions(size_t pos1, size_t pos2) {
+    std::swap(open_heap[pos1], open_heap[pos2]);
+    nodes[open_heap[pos1]].heap_pos = pos1;
+    nodes[open_heap[pos2]].heap_pos = pos2;
+}
+
+
 /**
  * @brief Constructs a new path stop object.
  *
@@ -353,6 +1240,21 @@ PathLink* PathStop::get_link(const PathStop* other_stop) const {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the stop and its links take up,
+ * in bytes.
+ *
+ * @return The size.
+ */
+size_t PathStop::get_memory_usage() const {
+    return
+        sizeof(PathStop) +
+        label.capacity() +
+        get_vector_memory_usage(links) +
+        links.size() * sizeof(PathLink);
+}
+
+
 /**
  * @brief Removes the specified link.
  * Does nothing if there is no such link.
@@ -469,28 +1371,14 @@ bool can_take_path_stop(
         !has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
         touching_hazard &&
         sector_ptr &&
-        !sector_ptr->hazards.empty()
+        (
+            sector_ptr->path_blocking_hazards &
+            ~settings.invulnerabilities
+        ).any()
     ) {
-        for(size_t sh = 0; sh < sector_ptr->hazards.size(); sh++) {
-            if(!sector_ptr->hazards[sh]->blocks_paths) {
-                //This hazard doesn't cause Pikmin to try and avoid it.
-                continue;
-            }
-            bool invulnerable = false;
-            for(size_t ih = 0; ih < settings.invulnerabilities.size(); ih++) {
-                if(
-                    settings.invulnerabilities[ih] ==
-                    sector_ptr->hazards[sh]
-                ) {
-                    invulnerable = true;
-                    break;
-                }
-            }
-            if(!invulnerable) {
-                if(out_reason) *out_reason = PATH_BLOCK_REASON_HAZARDOUS_STOP;
-                return false;
-            }
-        }
+        //There's a hazard that blocks paths that it's vulnerable to.
+        if(out_reason) *out_reason = PATH_BLOCK_REASON_HAZARDOUS_STOP;
+        return false;
     }
     
     //All good!
@@ -515,7 +1403,7 @@ bool can_traverse_path_link(
     //Check if there's an obstacle in the way.
     if(
         !has_flag(settings.flags, PATH_FOLLOW_FLAG_IGNORE_OBSTACLES) &&
-        link_ptr->blocked_by_obstacle
+        link_ptr->n_obstacles > 0
     ) {
         if(out_reason) *out_reason = PATH_BLOCK_REASON_OBSTACLE;
         return false;
@@ -623,73 +1511,53 @@ PATH_RESULT a_star(
 ) {
     //https://en.wikipedia.org/wiki/A*_search_algorithm
     
-    /**
-     * @brief Represents a node's data in the algorithm.
-     */
-    struct Node {
-        //In the best known path to this node, this is the known
-        //distance from the start node to this one.
-        float since_start = FLT_MAX;
-        
-        //In the best known path to this node, this is the node that
-        //came before this one.
-        PathStop* prev = nullptr;
-        
-        //Estimated distance if the final path takes this node.
-        float estimated = FLT_MAX;
-    };
+    const vector<PathStop*> &stops = game.cur_area_data->path_stops;
+    const PathManager &path_mgr = game.states.gameplay->path_mgr;
+    PathSearchScratch &scratch = search_scratch;
     
-    //All nodes that we want to visit.
-    unordered_set<PathStop*> to_visit;
-    //Data for all the nodes.
-    map<PathStop*, Node> data;
+    size_t start_idx = path_mgr.get_stop_idx(start_node);
+    size_t end_idx = path_mgr.get_stop_idx(end_node);
+    if(start_idx == INVALID || end_idx == INVALID) {
+        out_path.clear();
+        if(out_total_dist) *out_total_dist = 0;
+        return PATH_RESULT_ERROR;
+    }
     
     //Part 1: Initialize the algorithm.
-    to_visit.insert(start_node);
-    data[start_node].since_start = 0.0f;
-    data[start_node].estimated = 0.0f;
+    scratch.start(stops.size());
+    PathSearchScratch::Node &start_data = scratch.get_node(start_idx);
+    start_data.since_start = 0.0f;
+    start_data.estimated = 0.0f;
+    scratch.push_open(start_idx);
     
     //Start iterating.
-    while(!to_visit.empty()) {
+    while(!scratch.is_open_empty()) {
     
         //Part 2: Figure out what node to work on in this iteration.
-        PathStop* cur_node = nullptr;
-        float cur_node_dist = 0.0f;
-        Node cur_node_data;
-        
-        for(auto u = to_visit.begin(); u != to_visit.end(); u++) {
-            Node n = data[*u];
-            float est_dist = n.estimated;
-            
-            if(!cur_node || est_dist < cur_node_dist) {
-                cur_node = *u;
-                cur_node_dist = est_dist;
-                cur_node_data = n;
-            }
-        }
+        //The open list is a heap, so the best node is always at the top.
+        //This also marks the node as visited.
+        size_t cur_idx = scratch.pop_open();
+        PathStop* cur_node = stops[cur_idx];
+        float cur_since_start = scratch.get_node(cur_idx).since_start;
         
         //Part 3: If the node we're processing is the end node, then
         //that's it, best path found!
-        if(cur_node == end_node) {
+        if(cur_idx == end_idx) {
         
             //Construct the path.
-            float td = data[end_node].since_start;
             out_path.clear();
-            out_path.push_back(end_node);
-            PathStop* next = data[end_node].prev;
-            while(next) {
-                out_path.insert(out_path.begin(), next);
-                next = data[next].prev;
+            size_t next_idx = end_idx;
+            while(next_idx != INVALID) {
+                out_path.push_back(stops[next_idx]);
+                next_idx = scratch.get_node(next_idx).prev_idx;
             }
+            std::reverse(out_path.begin(), out_path.end());
             
-            if(out_total_dist) *out_total_dist = td;
+            if(out_total_dist) *out_total_dist = cur_since_start;
             return PATH_RESULT_NORMAL_PATH;
             
         }
         
-        //This node's been visited.
-        to_visit.erase(cur_node);
-        
         //Part 4: Check the neighbors.
         for(size_t l = 0; l < cur_node->links.size(); l++) {
             PathLink* l_ptr = cur_node->links[l];
@@ -700,17 +1568,28 @@ PATH_RESULT a_star(
                 continue;
             }
             
-            float tentative_score =
-                data[cur_node].since_start + l_ptr->distance;
+            size_t neighbor_idx = l_ptr->end_idx;
+            if(
+                neighbor_idx >= stops.size() ||
+                stops[neighbor_idx] != neighbor
+            ) {
+                //The link's index is out of date.
+                neighbor_idx = path_mgr.get_stop_idx(neighbor);
+                if(neighbor_idx == INVALID) continue;
+            }
+            
+            float tentative_score = cur_since_start + l_ptr->distance;
+            PathSearchScratch::Node &neighbor_data =
+                scratch.get_node(neighbor_idx);
                 
-            if(tentative_score < data[neighbor].since_start) {
+            if(tentative_score < neighbor_data.since_start) {
                 //Found a better path from the start to this neighbor.
-                data[neighbor].since_start = tentative_score;
-                data[neighbor].prev = cur_node;
-                data[neighbor].estimated =
+                neighbor_data.since_start = tentative_score;
+                neighbor_data.prev_idx = cur_idx;
+                neighbor_data.estimated =
                     tentative_score +
-                    Distance(neighbor->pos, end_node->pos).to_float();
-                to_visit.insert(neighbor);
+                    path_mgr.estimate_dist(neighbor_idx, end_idx);
+                scratch.push_open(neighbor_idx);
             }
         }
     }
@@ -859,7 +1738,7 @@ PATH_RESULT get_path(
     
     //Calculate the path.
     PATH_RESULT result =
-        a_star(
+        game.states.gameplay->path_mgr.get_stop_to_stop_path(
             full_path,
             closest_to_start, closest_to_end,
             settings, out_total_dist
@@ -10,8 +10,10 @@
 
 #pragma once
 
+#include <cfloat>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -21,6 +23,7 @@
 
 using std::map;
 using std::string;
+using std::unordered_map;
 using std::unordered_set;
 using std::vector;
 
@@ -159,7 +162,12 @@ enum PATH_BLOCK_REASON {
 
 namespace PATHS {
 extern const float DEF_CHASE_TARGET_DISTANCE;
+extern const size_t MAX_CACHED_PATHS;
+extern const size_t MAX_DESTINATION_TREES;
+extern const size_t MIN_DESTINATION_TREE_SEARCHES;
 extern const float MIN_STOP_RADIUS;
+extern const size_t N_LANDMARKS;
+extern const double PATH_CHANGE_BUDGET;
 }
 
 
@@ -184,7 +192,7 @@ struct PathFollowSettings {
     bitmask_8_t flags = 0;
     
     //Invulnerabilities of the mob/carriers.
-    vector<Hazard*> invulnerabilities;
+    hazard_set_t invulnerabilities;
     
     //If not empty, only follow path links with this label.
     string label;
@@ -240,6 +248,7 @@ struct PathStop {
     void clone(PathStop* destination) const;
     void add_link(PathStop* other_stop, bool normal);
     PathLink* get_link(const PathStop* other_stop) const;
+    size_t get_memory_usage() const;
     void remove_link(const PathLink* link_ptr);
     void remove_link(const PathStop* other_stop);
     void calculate_dists();
@@ -271,8 +280,8 @@ struct PathLink {
     //Distance between the two stops.
     float distance = 0.0f;
     
-    //Is the stop currently blocked by an obstacle? Cache for performance.
-    bool blocked_by_obstacle = false;
+    //Number of obstacles currently blocking the link.
+    size_t n_obstacles = 0;
     
     
     //--- Function declarations ---
@@ -285,6 +294,77 @@ struct PathLink {
 };
 
 
+/**
+ * @brief Data used by the A* algorithm while it's searching for a path.
+ * Each thread keeps its own from search to search, so that no memory needs
+ * to be allocated every time a mob wants a path. The per-stop data is only
+ * reset when it's first needed by a search, thanks to a generation counter.
+ */
+struct PathSearchScratch {
+
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Represents a path stop's data in the algorithm.
+     */
+    struct Node {
+    
+        //--- Members ---
+        
+        //Generation of the search this data belongs to.
+        size_t generation = 0;
+        
+        //In the best known path to this node, this is the known
+        //distance from the start node to this one.
+        float since_start = FLT_MAX;
+        
+        //In the best known path to this node, this is the index of the node
+        //that came before this one. INVALID if none.
+        size_t prev_idx = INVALID;
+        
+        //Estimated distance if the final path takes this node.
+        float estimated = FLT_MAX;
+        
+        //Position in the open heap. INVALID if it's not in it.
+        size_t heap_pos = INVALID;
+        
+    };
+    
+    
+    //--- Function declarations ---
+    
+    void start(size_t n_stops);
+    Node &get_node(size_t stop_idx);
+    bool is_open_empty() const;
+    void push_open(size_t stop_idx);
+    size_t pop_open();
+    
+    
+private:
+
+    //--- Members ---
+    
+    //Data for each path stop, in the same order as the area's stops.
+    vector<Node> nodes;
+    
+    //Nodes that we want to visit, as a binary min-heap of stop indexes,
+    //sorted by their estimated distance.
+    vector<size_t> open_heap;
+    
+    //Generation of the current search.
+    size_t generation = 0;
+    
+    
+    //--- Function declarations ---
+    
+    bool is_heap_pos_better(size_t pos1, size_t pos2) const;
+    void sift_down(size_t pos);
+    void sift_up(size_t pos);
+    void swap_heap_positions(size_t pos1, size_t pos2);
+    
+};
+
+
 /**
  * @brief Manages the paths in the area.
  *
@@ -299,23 +379,182 @@ struct PathLink {
  */
 struct PathManager {
 
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Identifies a path search between two stops, for the
+     * purposes of caching its result. This contains everything that
+     * can change the outcome of the A* algorithm.
+     */
+    struct PathCacheKey {
+    
+        //--- Members ---
+        
+        //Start stop.
+        PathStop* start_ptr = nullptr;
+        
+        //End stop.
+        PathStop* end_ptr = nullptr;
+        
+        //Path following flags that affect the search.
+        bitmask_8_t flags = 0;
+        
+        //Label the links must have, if any.
+        string label;
+        
+        //Invulnerabilities of the mob/carriers.
+        hazard_set_t invulnerabilities;
+        
+        
+        //--- Function declarations ---
+        
+        PathCacheKey(
+            PathStop* start_ptr, PathStop* end_ptr,
+            const PathFollowSettings &settings
+        );
+        bool operator<(const PathCacheKey &k2) const;
+        
+    };
+    
+    /**
+     * @brief Result of a path search that got cached.
+     */
+    struct PathCacheEntry {
+    
+        //--- Members ---
+        
+        //Result of the search.
+        PATH_RESULT result = PATH_RESULT_NOT_CALCULATED;
+        
+        //Stops to visit, in order.
+        vector<PathStop*> path;
+        
+        //Total distance of the path, from the first stop to the last.
+        float total_dist = 0.0f;
+        
+    };
+    
+    /**
+     * @brief The shortest ways from every stop to one destination stop.
+     * Useful when many mobs go to the same place, like carriers
+     * delivering to an Onion.
+     */
+    struct DestinationTree {
+    
+        //--- Members ---
+        
+        //Searches to this destination that weren't in the path cache.
+        size_t n_searches = 0;
+        
+        //Index of the next stop to go to, from each stop.
+        //INVALID for the destination, or if there's no way. Empty if
+        //the tree hasn't been built yet.
+        vector<size_t> next_idxs;
+        
+        //Distance to the destination from each stop. FLT_MAX if
+        //there's no way.
+        vector<float> dists;
+        
+    };
+    
+    
     //--- Members ---
     
-    //Known obstructions.
-    map<PathLink*, unordered_set<Mob*> > obstructions;
+    //Known obstacles, and the links each one blocks.
+    map<Mob*, vector<PathLink*> > obstacle_links;
+    
+    //Obstacles placed before the area finished loading. These are only
+    //checked against the links once it does, all in one go.
+    vector<Mob*> pending_obstacles;
     
     //Stops known to have hazards.
     unordered_set<PathStop*> hazardous_stops;
     
+    //Path links that touch each blockmap block, so only the links near
+    //a spot need to be checked. Anything outside of the blockmap
+    //counts as being in the nearest block.
+    vector<vector<vector<PathLink*> > > link_blocks;
+    
+    //Results of previous path searches.
+    map<PathCacheKey, PathCacheEntry> path_cache;
+    
+    //Trees of the ways to destination stops that are often searched for.
+    //The key's start stop is always nullptr.
+    map<PathCacheKey, DestinationTree> destination_trees;
+    
+    //For each stop, the links that go into it, along with the index of
+    //the stop they come from.
+    vector<vector<std::pair<size_t, PathLink*> > > incoming_links;
+    
+    //Can the path cache be used? Only true during gameplay, since
+    //the area can change at any time in the editors.
+    bool path_cache_enabled = false;
+    
+    //Shortest distance from each landmark stop to every stop,
+    //by stop index. FLT_MAX if there's no way.
+    vector<vector<float> > landmark_dists_from;
+    
+    //Shortest distance from every stop, by stop index, to each landmark
+    //stop. FLT_MAX if there's no way.
+    vector<vector<float> > landmark_dists_to;
+    
+    //Are there mobs that still need to be told that the paths changed?
+    bool path_changes_pending = false;
+    
+    //Index of each path stop in the area's list. Only filled in
+    //during gameplay, since the list can change at any time in the editors.
+    unordered_map<const PathStop*, size_t> stop_idxs;
+    
     
     //--- Function declarations ---
     
+    float estimate_dist(size_t from_idx, size_t to_idx) const;
+    size_t get_stop_idx(const PathStop* s_ptr) const;
+    PATH_RESULT get_stop_to_stop_path(
+        vector<PathStop*> &out_path,
+        PathStop* start_node, PathStop* end_node,
+        const PathFollowSettings &settings,
+        float* out_total_dist
+    );
     void handle_area_load();
     void handle_obstacle_add(Mob* m);
     void handle_obstacle_remove(Mob* m);
-    void handle_sector_hazard_change(Sector* sector_ptr);
+    void handle_sector_hazard_changes(const unordered_set<Sector*> &sectors);
+    void process_pending_path_changes(
+        double budget = PATHS::PATH_CHANGE_BUDGET
+    );
     void clear();
     
+    
+private:
+
+    //--- Function declarations ---
+    
+    void build_destination_tree(
+        DestinationTree &tree, PathStop* end_node,
+        const PathFollowSettings &settings
+    );
+    void build_incoming_links();
+    void build_landmarks();
+    void build_link_blocks();
+    void find_obstacle_links(Mob* m, vector<PathLink*> &out_links) const;
+    bool get_destination_tree_path(
+        vector<PathStop*> &out_path,
+        PathStop* start_node, PathStop* end_node,
+        const PathFollowSettings &settings,
+        PATH_RESULT* out_result, float* out_total_dist
+    );
+    size_t get_link_block_col(float x) const;
+    size_t get_link_block_row(float y) const;
+    void get_links_in_region(
+        const Point &tl, const Point &br, vector<PathLink*> &out_links
+    ) const;
+    void invalidate_cached_paths_with_link(const PathLink* l_ptr);
+    void invalidate_obstacle_dependent_cached_paths();
+    void notify_path_followers(
+        const unordered_set<Sector*>* sectors = nullptr
+    );
+    
 };
 
 
@@ -12,12 +12,31 @@
 
 #include "replay.h"
 
+#include "../util/general_utils.h"
+
 
 using std::size_t;
 using std::string;
 using std::vector;
 
 
+namespace REPLAY {
+
+//Magic number at the start of replay files.
+const string FILE_MAGIC_NUMBER = "PRPL";
+
+//Version of the replay file format. Files in other versions can't be read.
+const unsigned char FILE_VERSION = 1;
+
+//Magic number at the very end of replay files that have a keyframe index.
+const string INDEX_MAGIC_NUMBER = "PRIX";
+
+//Every this many states, a keyframe is recorded.
+const size_t KEYFRAME_INTERVAL = 60;
+
+}
+
+
 /**
  * @brief Construct a new replay object.
  */
@@ -27,9 +46,19 @@ Replay::Replay() {
 }
 
 
+/**
+ * @brief Destroys the replay object. If it was recording, the file is
+ * closed without a keyframe index, which means loading it will be slower.
+ */
+Replay::~Replay() {
+    clear();
+}
+
+
 /**
  * @brief Adds a new state to the replay, filling it with data from the supplied
- * mob vectors.
+ * mob vectors, and writes it to the file. Does nothing if the replay
+ * isn't being recorded.
  *
  * @param leader_list List of leaders.
  * @param pikmin_list List of Pikmin.
@@ -48,8 +77,10 @@ void Replay::add_state(
     const vector<Mob*> &obstacle_list,
     size_t cur_leader_idx
 ) {
-    states.push_back(ReplayState());
-    ReplayState* new_state_ptr = &(states[states.size() - 1]);
+    if(!file || !recording) return;
+    
+    ReplayState new_state;
+    ReplayState* new_state_ptr = &new_state;
     
     vector<Mob*> new_state_mobs;
     new_state_mobs.insert(
@@ -147,99 +178,471 @@ void Replay::add_state(
     }
     
     prev_state_mobs = new_state_mobs;
+    
+    write_state(new_state, nr_states % keyframe_interval == 0);
 }
 
 
 /**
- * @brief Clears all data about this replay.
+ * @brief Clears all data about this replay, and closes its file, if any.
  */
 void Replay::clear() {
-    states.clear();
+    if(file) {
+        al_fclose(file);
+        file = nullptr;
+    }
+    recording = false;
+    nr_states = 0;
+    keyframe_interval = REPLAY::KEYFRAME_INTERVAL;
+    keyframe_offsets.clear();
+    next_state_idx = 0;
+    prev_state = ReplayState();
     prev_leader_idx = INVALID;
     prev_state_mobs.clear();
 }
 
 
 /**
- * @brief Finishes the recording of a new replay.
+ * @brief Finishes the recording of a new replay. This writes an index of
+ * the keyframes to the end of the file, and closes it.
  */
 void Replay::finish_recording() {
+    if(file && recording) {
+        al_fputc(file, REPLAY_RECORD_INDEX);
+        for(size_t k = 0; k < keyframe_offsets.size(); k++) {
+            uint64_t offset = keyframe_offsets[k];
+            al_fwrite32be(file, (int32_t) (offset >> 32));
+            al_fwrite32be(file, (int32_t) (offset & 0xffffffff));
+        }
+        al_fwrite32be(file, (int32_t) keyframe_offsets.size());
+        al_fwrite32be(file, (int32_t) nr_states);
+        al_fwrite(
+            file, REPLAY::INDEX_MAGIC_NUMBER.c_str(),
+            REPLAY::INDEX_MAGIC_NUMBER.size()
+        );
+    }
     clear();
 }
 
 
 /**
- * @brief Loads replay data from a file in the disk.
+ * @brief Returns roughly how much memory the replay takes up, in bytes.
+ * Since the states live in the file, this is only the keyframe index
+ * and the previous state.
+ *
+ * @return The size.
+ */
+size_t Replay::get_memory_usage() const {
+    return
+        sizeof(Replay) +
+        get_vector_memory_usage(keyframe_offsets) +
+        get_vector_memory_usage(prev_state.elements) +
+        get_vector_memory_usage(prev_state.events) +
+        get_vector_memory_usage(prev_state_mobs);
+}
+
+
+/**
+ * @brief Returns how many keyframes the replay has.
+ *
+ * @return The amount.
+ */
+size_t Replay::get_nr_keyframes() const {
+    return keyframe_offsets.size();
+}
+
+
+/**
+ * @brief Returns how many states the replay has.
+ *
+ * @return The amount.
+ */
+size_t Replay::get_nr_states() const {
+    return nr_states;
+}
+
+
+/**
+ * @brief Opens a replay file in the disk for playback. Only the keyframe
+ * index is read; states are read as they get played back. If the file
+ * has no index, because the recording didn't finish properly, the file
+ * is scanned to make one.
  *
  * @param file_path Path to the file to load from.
+ * @return Whether it succeeded.
  */
-void Replay::load_from_file(const string &file_path) {
+bool Replay::load_from_file(const string &file_path) {
     clear();
-    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "rb");
+    file = al_fopen(file_path.c_str(), "rb");
+    if(!file) return false;
     
-    size_t n_states = al_fread32be(file);
-    states.reserve(n_states);
+    //Header.
+    string magic(REPLAY::FILE_MAGIC_NUMBER.size(), '\0');
+    al_fread(file, &magic[0], magic.size());
+    int version = al_fgetc(file);
+    uint32_t interval = al_fread32be(file);
+    if(
+        magic != REPLAY::FILE_MAGIC_NUMBER ||
+        version != REPLAY::FILE_VERSION ||
+        interval == 0 || al_feof(file)
+    ) {
+        clear();
+        return false;
+    }
+    keyframe_interval = interval;
+    int64_t states_start = al_ftell(file);
+    int64_t file_size = al_fsize(file);
     
-    for(size_t s = 0; s < n_states; s++) {
-        states.push_back(ReplayState());
-        ReplayState* s_ptr = &states[states.size() - 1];
-        
-        size_t n_elements = al_fread32be(file);
-        s_ptr->elements.reserve(n_elements);
+    //Keyframe index.
+    bool has_index = false;
+    int64_t index_end_size = 8 + (int64_t) REPLAY::INDEX_MAGIC_NUMBER.size();
+    if(file_size >= states_start + 1 + index_end_size) {
+        string index_magic(REPLAY::INDEX_MAGIC_NUMBER.size(), '\0');
+        al_fseek(
+            file, file_size - (int64_t) index_magic.size(), ALLEGRO_SEEK_SET
+        );
+        al_fread(file, &index_magic[0], index_magic.size());
         
-        for(size_t e = 0; e < n_elements; e++) {
-            s_ptr->elements.push_back(
-                ReplayElement(
-                    (REPLAY_ELEMENT) al_fgetc(file),
-                    Point(al_fread32be(file), al_fread32be(file))
-                )
+        if(index_magic == REPLAY::INDEX_MAGIC_NUMBER) {
+            al_fseek(file, file_size - index_end_size, ALLEGRO_SEEK_SET);
+            uint32_t nr_keyframes = al_fread32be(file);
+            uint32_t index_nr_states = al_fread32be(file);
+            int64_t index_start =
+                file_size - index_end_size - (int64_t) nr_keyframes * 8 - 1;
+            if(
+                index_start >= states_start &&
+                al_fseek(file, index_start, ALLEGRO_SEEK_SET) &&
+                al_fgetc(file) == REPLAY_RECORD_INDEX
+            ) {
+                has_index = true;
+                for(uint32_t k = 0; k < nr_keyframes; k++) {
+                    uint32_t offset_high = al_fread32be(file);
+                    uint32_t offset_low = al_fread32be(file);
+                    int64_t offset =
+                        (int64_t) (((uint64_t) offset_high << 32) | offset_low);
+                    if(offset < states_start || offset >= index_start) {
+                        has_index = false;
+                        break;
+                    }
+                    keyframe_offsets.push_back(offset);
+                }
+                nr_states = index_nr_states;
+            }
+        }
+    }
+
+    if(!has_index) {
+        //Go through every state to find the keyframes.
+        keyframe_offsets.clear();
+        nr_states = 0;
+        al_fseek(file, states_start, ALLEGRO_SEEK_SET);
+        ReplayState state;
+        while(true) {
+            int64_t offset = al_ftell(file);
+            int record = al_fgetc(file);
+            if(
+                record != REPLAY_RECORD_KEYFRAME &&
+                record != REPLAY_RECORD_DELTA
+            ) {
+                break;
+            }
+            al_fseek(file, offset, ALLEGRO_SEEK_SET);
+            if(!read_state(&state)) break;
+            if(record == REPLAY_RECORD_KEYFRAME) {
+                keyframe_offsets.push_back(offset);
+            }
+            nr_states++;
+        }
+    }
+    
+    if(!keyframe_offsets.empty()) {
+        seek_to_keyframe(0);
+    }
+    return true;
+}
+
+
+/**
+ * @brief Reads a signed variable-length number from the file,
+ * written with write_signed_varint().
+ *
+ * @param out_number The number is returned here.
+ * @return Whether it succeeded.
+ */
+bool Replay::read_signed_varint(int64_t* out_number) {
+    uint64_t zigzag;
+    if(!read_varint(&zigzag)) return false;
+    *out_number = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+    return true;
+}
+
+
+/**
+ * @brief Reads the next state to be played back, and moves on to the one
+ * after it.
+ *
+ * @param out_state The state is returned here.
+ * @return Whether it succeeded. This is false if there are no more states.
+ */
+bool Replay::read_next_state(ReplayState* out_state) {
+    if(!file || recording || next_state_idx >= nr_states) return false;
+    if(!read_state(out_state)) return false;
+    next_state_idx++;
+    return true;
+}
+
+
+/**
+ * @brief Reads a state record from the current position in the file.
+ * States that aren't keyframes are applied over the previous state read.
+ *
+ * @param out_state The state is returned here.
+ * @return Whether it succeeded.
+ */
+bool Replay::read_state(ReplayState* out_state) {
+    int record = al_fgetc(file);
+    if(record != REPLAY_RECORD_KEYFRAME && record != REPLAY_RECORD_DELTA) {
+        return false;
+    }
+    bool keyframe = record == REPLAY_RECORD_KEYFRAME;
+    
+    //Elements. Every element takes up at least two bytes, so don't trust
+    //amounts that the file couldn't fit.
+    uint64_t nr_elements;
+    if(!read_varint(&nr_elements)) return false;
+    if(nr_elements > (uint64_t) al_fsize(file) / 2) return false;
+    out_state->elements.clear();
+    out_state->elements.reserve((size_t) nr_elements);
+    
+    if(keyframe) {
+        for(size_t e = 0; e < nr_elements; e++) {
+            int type = al_fgetc(file);
+            int64_t x;
+            int64_t y;
+            if(
+                type < 0 || type > REPLAY_ELEMENT_OBSTACLE ||
+                !read_signed_varint(&x) || !read_signed_varint(&y)
+            ) {
+                return false;
+            }
+            out_state->elements.push_back(
+                ReplayElement((REPLAY_ELEMENT) type, Point(x, y))
             );
         }
-        
-        size_t n_events = al_fread32be(file);
-        if(n_events > 0) {
-            s_ptr->events.reserve(n_events);
-            
-            for(size_t e = 0; e < n_events; e++) {
-                s_ptr->events.push_back(
-                    ReplayEvent(
-                        (REPLAY_EVENT) al_fgetc(file),
-                        al_fread32be(file)
-                    )
+    
+    } else {
+        //Start off with the previous state's elements.
+        for(size_t e = 0; e < nr_elements; e++) {
+            if(e < prev_state.elements.size()) {
+                out_state->elements.push_back(prev_state.elements[e]);
+            } else {
+                out_state->elements.push_back(
+                    ReplayElement(REPLAY_ELEMENT_LEADER, Point())
                 );
             }
         }
+        
+        //Elements whose type is different.
+        uint64_t nr_type_changes;
+        if(!read_varint(&nr_type_changes)) return false;
+        for(uint64_t c = 0; c < nr_type_changes; c++) {
+            uint64_t e_idx;
+            if(!read_varint(&e_idx) || e_idx >= nr_elements) return false;
+            int type = al_fgetc(file);
+            if(type < 0 || type > REPLAY_ELEMENT_OBSTACLE) return false;
+            out_state->elements[e_idx].type = (REPLAY_ELEMENT) type;
+        }
+        
+        //How much each element moved.
+        for(size_t e = 0; e < nr_elements; e++) {
+            int64_t dx;
+            int64_t dy;
+            if(!read_signed_varint(&dx) || !read_signed_varint(&dy)) {
+                return false;
+            }
+            out_state->elements[e].pos.x += dx;
+            out_state->elements[e].pos.y += dy;
+        }
+    }
+    
+    //Events.
+    uint64_t nr_events;
+    if(!read_varint(&nr_events)) return false;
+    if(nr_events > (uint64_t) al_fsize(file) / 2) return false;
+    out_state->events.clear();
+    out_state->events.reserve((size_t) nr_events);
+    for(uint64_t e = 0; e < nr_events; e++) {
+        int type = al_fgetc(file);
+        uint64_t data;
+        if(
+            type < 0 || type > REPLAY_EVENT_LEADER_SWITCHED ||
+            !read_varint(&data)
+        ) {
+            return false;
+        }
+        out_state->events.push_back(
+            ReplayEvent((REPLAY_EVENT) type, (size_t) data)
+        );
+    }
+    
+    prev_state = *out_state;
+    return true;
+}
+
+
+/**
+ * @brief Reads an unsigned variable-length number from the file,
+ * written with write_varint().
+ *
+ * @param out_number The number is returned here.
+ * @return Whether it succeeded.
+ */
+bool Replay::read_varint(uint64_t* out_number) {
+    *out_number = 0;
+    for(unsigned char shift = 0; shift < 64; shift += 7) {
+        int byte = al_fgetc(file);
+        if(byte == EOF) return false;
+        *out_number |= (uint64_t) (byte & 0x7f) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief Jumps playback to a keyframe. The next state read will be it.
+ *
+ * @param keyframe_idx Index of the keyframe.
+ * @return Whether it succeeded.
+ */
+bool Replay::seek_to_keyframe(size_t keyframe_idx) {
+    if(!file || recording || keyframe_idx >= keyframe_offsets.size()) {
+        return false;
+    }
+    if(!al_fseek(file, keyframe_offsets[keyframe_idx], ALLEGRO_SEEK_SET)) {
+        return false;
     }
+    next_state_idx = keyframe_idx * keyframe_interval;
+    prev_state = ReplayState();
+    return true;
 }
 
 
 /**
- * @brief Saves replay data to a file in the disk.
+ * @brief Starts recording a new replay. States get written to the file
+ * as they are added, and finish_recording() must be called at the end.
  *
- * @param file_path Path to the file to save to.
+ * @param file_path Path to the file to record to.
+ * @return Whether it succeeded.
  */
-void Replay::save_to_file(const string &file_path) const {
-    ALLEGRO_FILE* file = al_fopen(file_path.c_str(), "wb");
+bool Replay::start_recording(const string &file_path) {
+    clear();
+    file = al_fopen(file_path.c_str(), "wb");
+    if(!file) return false;
+    recording = true;
     
-    al_fwrite32be(file, (int32_t) states.size());
-    for(size_t s = 0; s < states.size(); s++) {
-        const ReplayState* s_ptr = &states[s];
-        
-        al_fwrite32be(file, (int32_t) s_ptr->elements.size());
-        for(size_t e = 0; e < s_ptr->elements.size(); e++) {
-            al_fputc(file, s_ptr->elements[e].type);
-            al_fwrite32be(file, floor(s_ptr->elements[e].pos.x));
-            al_fwrite32be(file, floor(s_ptr->elements[e].pos.y));
+    al_fwrite(
+        file, REPLAY::FILE_MAGIC_NUMBER.c_str(),
+        REPLAY::FILE_MAGIC_NUMBER.size()
+    );
+    al_fputc(file, REPLAY::FILE_VERSION);
+    al_fwrite32be(file, (int32_t) keyframe_interval);
+    return true;
+}
+
+
+/**
+ * @brief Writes a signed variable-length number to the file. Numbers closer
+ * to 0 take up fewer bytes, whether they're positive or negative.
+ *
+ * @param number Number to write.
+ */
+void Replay::write_signed_varint(int64_t number) {
+    write_varint(((uint64_t) number << 1) ^ (uint64_t) (number >> 63));
+}
+
+
+/**
+ * @brief Writes a state record to the file. Positions are saved as
+ * whole units. States that aren't keyframes only save the changes since
+ * the previous state written.
+ *
+ * @param state State to write.
+ * @param keyframe Whether it should be written as a keyframe.
+ */
+void Replay::write_state(const ReplayState &state, bool keyframe) {
+    if(keyframe) {
+        keyframe_offsets.push_back(al_ftell(file));
+    }
+    al_fputc(file, keyframe ? REPLAY_RECORD_KEYFRAME : REPLAY_RECORD_DELTA);
+    
+    //Elements.
+    write_varint(state.elements.size());
+    if(keyframe) {
+        for(size_t e = 0; e < state.elements.size(); e++) {
+            al_fputc(file, state.elements[e].type);
+            write_signed_varint((int64_t) floor(state.elements[e].pos.x));
+            write_signed_varint((int64_t) floor(state.elements[e].pos.y));
+        }
+    
+    } else {
+        //Elements whose type is different.
+        vector<size_t> type_changes;
+        for(size_t e = 0; e < state.elements.size(); e++) {
+            if(
+                e >= prev_state.elements.size() ||
+                prev_state.elements[e].type != state.elements[e].type
+            ) {
+                type_changes.push_back(e);
+            }
+        }
+        write_varint(type_changes.size());
+        for(size_t c = 0; c < type_changes.size(); c++) {
+            write_varint(type_changes[c]);
+            al_fputc(file, state.elements[type_changes[c]].type);
         }
         
-        al_fwrite32be(file, (int32_t) s_ptr->events.size());
-        for(size_t e = 0; e < s_ptr->events.size(); e++) {
-            al_fputc(file, s_ptr->events[e].type);
-            al_fwrite32be(file, (int32_t) s_ptr->events[e].data);
+        //How much each element moved.
+        for(size_t e = 0; e < state.elements.size(); e++) {
+            Point prev_pos;
+            if(e < prev_state.elements.size()) {
+                prev_pos = prev_state.elements[e].pos;
+            }
+            write_signed_varint(
+                (int64_t) floor(state.elements[e].pos.x) -
+                (int64_t) floor(prev_pos.x)
+            );
+            write_signed_varint(
+                (int64_t) floor(state.elements[e].pos.y) -
+                (int64_t) floor(prev_pos.y)
+            );
         }
     }
     
-    al_fclose(file);
+    //Events.
+    write_varint(state.events.size());
+    for(size_t e = 0; e < state.events.size(); e++) {
+        al_fputc(file, state.events[e].type);
+        write_varint(state.events[e].data);
+    }
+    
+    prev_state = state;
+    nr_states++;
+}
+
+
+/**
+ * @brief Writes an unsigned variable-length number to the file. Each byte
+ * holds seven bits of the number, and whether more bytes follow.
+ *
+ * @param number Number to write.
+ */
+void Replay::write_varint(uint64_t number) {
+    while(number >= 0x80) {
+        al_fputc(file, (int) ((number & 0x7f) | 0x80));
+        number >>= 7;
+    }
+    al_fputc(file, (int) number);
 }
 
 
@@ -29,6 +29,29 @@ using std::string;
 using std::vector;
 
 
+namespace REPLAY {
+extern const string FILE_MAGIC_NUMBER;
+extern const unsigned char FILE_VERSION;
+extern const string INDEX_MAGIC_NUMBER;
+extern const size_t KEYFRAME_INTERVAL;
+};
+
+
+//Types of records in a replay file.
+enum REPLAY_RECORD {
+
+    //A state with the full data of every element.
+    REPLAY_RECORD_KEYFRAME,
+    
+    //A state with the changes since the previous state.
+    REPLAY_RECORD_DELTA,
+    
+    //The index of keyframes, at the end of the file.
+    REPLAY_RECORD_INDEX,
+    
+};
+
+
 //Types of elements in a replay.
 enum REPLAY_ELEMENT {
 
@@ -139,23 +162,22 @@ struct ReplayState {
  * minimal and abstract data about what happened, such as what Pikmin
  * have moved where and when, considering the replay is only meant for the
  * player to review their strategy, not to actually watch the action again.
- * This replay is state-based, not delta-based. This means it does not save
- * the changes that have happened every moment, but rather saves the entire
- * relevant data of every moment.
+ *
+ * States are written to the file as they get recorded, and read from it
+ * one at a time as they get played back, so the whole replay never
+ * needs to be in memory. Every few states there's a keyframe, with the
+ * entire relevant data of that moment. The states in between only save
+ * how each element moved since the previous state. Playback can only
+ * jump to keyframes, and go forward from there.
  */
 class Replay {
 
 public:
 
-    //--- Members ---
-    
-    //States.
-    vector<ReplayState> states;
-    
-    
     //--- Function declarations ---
     
     Replay();
+    ~Replay();
     void add_state(
         const vector<Leader*> &leader_list,
         const vector<Pikmin*> &pikmin_list,
@@ -167,17 +189,54 @@ public:
     );
     void clear();
     void finish_recording();
-    void load_from_file(const string &file_path);
-    void save_to_file(const string &file_path) const;
+    size_t get_memory_usage() const;
+    size_t get_nr_keyframes() const;
+    size_t get_nr_states() const;
+    bool load_from_file(const string &file_path);
+    bool read_next_state(ReplayState* out_state);
+    bool seek_to_keyframe(size_t keyframe_idx);
+    bool start_recording(const string &file_path);
     
 private:
 
     //--- Members ---
     
+    //File being recorded to or played back from, if any.
+    ALLEGRO_FILE* file = nullptr;
+    
+    //Is the file being recorded to, as opposed to played back from?
+    bool recording = false;
+    
+    //Number of states in the replay.
+    size_t nr_states = 0;
+    
+    //Every this many states, there's a keyframe.
+    size_t keyframe_interval = REPLAY::KEYFRAME_INTERVAL;
+    
+    //Position in the file of each keyframe.
+    vector<int64_t> keyframe_offsets;
+    
+    //Index of the next state to be played back.
+    size_t next_state_idx = 0;
+    
+    //Previous state written or read. States that aren't keyframes
+    //are based on it.
+    ReplayState prev_state;
+    
     //List of mobs in the previous state.
     vector<Mob*> prev_state_mobs;
     
     //Index of the previous leader.
     size_t prev_leader_idx = INVALID;
     
+    
+    //--- Function declarations ---
+    
+    bool read_signed_varint(int64_t* out_number);
+    bool read_state(ReplayState* out_state);
+    bool read_varint(uint64_t* out_number);
+    void write_signed_varint(int64_t number);
+    void write_state(const ReplayState &state, bool keyframe);
+    void write_varint(uint64_t number);
+    
 };
@@ -8,6 +8,8 @@
  * Shader related functions.
  */
 
+#include <cstddef>
+
 #include "game.h"
 #include "misc_functions.h"
 #include "shaders.h"
@@ -40,10 +42,160 @@ void ShaderManager::compile_shaders() {
     );
     try_attach_shader(
         compiled_shaders[SHADER_TYPE_LIQUID],
-        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::DEFAULT_VERT_SHADER
+        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::LIQUID_VERT_SHADER
     );
     al_build_shader(compiled_shaders[SHADER_TYPE_LIQUID]);
     
+    ALLEGRO_VERTEX_ELEMENT liquid_elements[] = {
+        {
+            ALLEGRO_PRIM_POSITION, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(LiquidVertex, x)
+        },
+        {
+            ALLEGRO_PRIM_TEX_COORD_PIXEL, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(LiquidVertex, u)
+        },
+        {
+            ALLEGRO_PRIM_COLOR_ATTR, 0,
+            offsetof(LiquidVertex, color)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 0, ALLEGRO_PRIM_FLOAT_4,
+            offsetof(LiquidVertex, tex_transform)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 1, ALLEGRO_PRIM_FLOAT_4,
+            offsetof(LiquidVertex, sector_props)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 2, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(LiquidVertex, sector_scroll)
+        },
+        { 0, 0, 0 }
+    };
+    liquid_vertex_decl =
+        al_create_vertex_decl(liquid_elements, sizeof(LiquidVertex));
+        
+    //Lighting.
+    compiled_shaders[SHADER_TYPE_LIGHTING] =
+        al_create_shader(ALLEGRO_SHADER_GLSL);
+        
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_LIGHTING],
+        ALLEGRO_PIXEL_SHADER, SHADER_SOURCE_FILES::LIGHTING_FRAG_SHADER
+    );
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_LIGHTING],
+        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::LIGHTING_VERT_SHADER
+    );
+    al_build_shader(compiled_shaders[SHADER_TYPE_LIGHTING]);
+    
+    //Precipitation.
+    compiled_shaders[SHADER_TYPE_PRECIPITATION] =
+        al_create_shader(ALLEGRO_SHADER_GLSL);
+        
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_PRECIPITATION],
+        ALLEGRO_PIXEL_SHADER, SHADER_SOURCE_FILES::PRECIPITATION_FRAG_SHADER
+    );
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_PRECIPITATION],
+        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::PRECIPITATION_VERT_SHADER
+    );
+    al_build_shader(compiled_shaders[SHADER_TYPE_PRECIPITATION]);
+    
+    ALLEGRO_VERTEX_ELEMENT precipitation_elements[] = {
+        {
+            ALLEGRO_PRIM_POSITION, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(PrecipitationVertex, x)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 0, ALLEGRO_PRIM_FLOAT_1,
+            offsetof(PrecipitationVertex, drop_idx)
+        },
+        { 0, 0, 0 }
+    };
+    precipitation_vertex_decl =
+        al_create_vertex_decl(
+            precipitation_elements, sizeof(PrecipitationVertex)
+        );
+        
+    //Sector fades.
+    compiled_shaders[SHADER_TYPE_SECTOR_FADE] =
+        al_create_shader(ALLEGRO_SHADER_GLSL);
+        
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_SECTOR_FADE],
+        ALLEGRO_PIXEL_SHADER, SHADER_SOURCE_FILES::SECTOR_FADE_FRAG_SHADER
+    );
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_SECTOR_FADE],
+        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::SECTOR_FADE_VERT_SHADER
+    );
+    al_build_shader(compiled_shaders[SHADER_TYPE_SECTOR_FADE]);
+    
+    ALLEGRO_VERTEX_ELEMENT sector_fade_elements[] = {
+        {
+            ALLEGRO_PRIM_POSITION, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(SectorFadeVertex, x)
+        },
+        {
+            ALLEGRO_PRIM_TEX_COORD_PIXEL, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(SectorFadeVertex, u)
+        },
+        {
+            ALLEGRO_PRIM_COLOR_ATTR, 0,
+            offsetof(SectorFadeVertex, color)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 0, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(SectorFadeVertex, tex_b)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 1, ALLEGRO_PRIM_FLOAT_4,
+            offsetof(SectorFadeVertex, color_b)
+        },
+        { 0, 0, 0 }
+    };
+    sector_fade_vertex_decl =
+        al_create_vertex_decl(sector_fade_elements, sizeof(SectorFadeVertex));
+        
+    //Tree shadows.
+    compiled_shaders[SHADER_TYPE_TREE_SHADOW] =
+        al_create_shader(ALLEGRO_SHADER_GLSL);
+        
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_TREE_SHADOW],
+        ALLEGRO_PIXEL_SHADER, SHADER_SOURCE_FILES::TREE_SHADOW_FRAG_SHADER
+    );
+    try_attach_shader(
+        compiled_shaders[SHADER_TYPE_TREE_SHADOW],
+        ALLEGRO_VERTEX_SHADER, SHADER_SOURCE_FILES::TREE_SHADOW_VERT_SHADER
+    );
+    al_build_shader(compiled_shaders[SHADER_TYPE_TREE_SHADOW]);
+    
+    ALLEGRO_VERTEX_ELEMENT tree_shadow_elements[] = {
+        {
+            ALLEGRO_PRIM_POSITION, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(TreeShadowVertex, x)
+        },
+        {
+            ALLEGRO_PRIM_TEX_COORD_PIXEL, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(TreeShadowVertex, u)
+        },
+        {
+            ALLEGRO_PRIM_COLOR_ATTR, 0,
+            offsetof(TreeShadowVertex, color)
+        },
+        {
+            ALLEGRO_PRIM_USER_ATTR + 0, ALLEGRO_PRIM_FLOAT_2,
+            offsetof(TreeShadowVertex, sway)
+        },
+        { 0, 0, 0 }
+    };
+    tree_shadow_vertex_decl =
+        al_create_vertex_decl(tree_shadow_elements, sizeof(TreeShadowVertex));
+        
 }
 
 
@@ -22,7 +22,16 @@ TODO: Add a OpenGL extension library when it'll compile on windows
 
 namespace SHADER_SOURCE_FILES {
 extern const char* DEFAULT_VERT_SHADER;
+extern const char* LIGHTING_FRAG_SHADER;
+extern const char* LIGHTING_VERT_SHADER;
 extern const char* LIQUID_FRAG_SHADER;
+extern const char* LIQUID_VERT_SHADER;
+extern const char* PRECIPITATION_FRAG_SHADER;
+extern const char* PRECIPITATION_VERT_SHADER;
+extern const char* SECTOR_FADE_FRAG_SHADER;
+extern const char* SECTOR_FADE_VERT_SHADER;
+extern const char* TREE_SHADOW_FRAG_SHADER;
+extern const char* TREE_SHADOW_VERT_SHADER;
 };
 
 
@@ -32,12 +41,145 @@ enum SHADER_TYPE {
     //Liquid sectors, like bodies of water.
     SHADER_TYPE_LIQUID,
     
+    //Fog and daylight over the whole screen.
+    SHADER_TYPE_LIGHTING,
+    
+    //Drops of precipitation.
+    SHADER_TYPE_PRECIPITATION,
+    
+    //Sectors that fade between the textures of two neighbors.
+    SHADER_TYPE_SECTOR_FADE,
+    
+    //Swaying tree shadows.
+    SHADER_TYPE_TREE_SHADOW,
+    
     //Total number of shader types.
     N_SHADER_TYPES
     
 };
 
 
+/**
+ * @brief A vertex of a sector drawn with the liquid shader. Besides the
+ * usual, it also has the properties of its sector, so that sectors
+ * with different properties can be drawn together.
+ */
+struct LiquidVertex {
+
+    //--- Members ---
+    
+    //X coordinate.
+    float x = 0.0f;
+    
+    //Y coordinate.
+    float y = 0.0f;
+    
+    //Texture X coordinate, in pixels.
+    float u = 0.0f;
+    
+    //Texture Y coordinate, in pixels.
+    float v = 0.0f;
+    
+    //Color.
+    ALLEGRO_COLOR color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    
+    //Floor texture translation (X and Y), then scale (X and Y).
+    float tex_transform[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+    
+    //Floor texture rotation, sector brightness (0 - 1), and liquid opacity
+    //(0 - 1). The last one is unused.
+    float sector_props[4] = { 0.0f, 1.0f, 1.0f, 0.0f };
+    
+    //How much the sector scrolls by, horizontally and vertically.
+    float sector_scroll[2] = { 0.0f, 0.0f };
+    
+};
+
+
+/**
+ * @brief A vertex of a drop of precipitation. Where the drop is gets
+ * figured out by the precipitation shader, so the vertex only says
+ * which drop it belongs to, and which corner of the drop it is.
+ */
+struct PrecipitationVertex {
+
+    //--- Members ---
+    
+    //X of the corner, from -1 to 1.
+    float x = 0.0f;
+    
+    //Y of the corner, from -1 to 1.
+    float y = 0.0f;
+    
+    //Index of the drop.
+    float drop_idx = 0.0f;
+    
+};
+
+
+/**
+ * @brief A vertex of a fading sector. Besides the usual, which is for the
+ * texture underneath, it also has the texture coordinates and color of the
+ * texture on top, so that the sector fade shader can draw both at once.
+ */
+struct SectorFadeVertex {
+
+    //--- Members ---
+    
+    //X coordinate.
+    float x = 0.0f;
+    
+    //Y coordinate.
+    float y = 0.0f;
+    
+    //Texture X coordinate of the texture underneath, in pixels.
+    float u = 0.0f;
+    
+    //Texture Y coordinate of the texture underneath, in pixels.
+    float v = 0.0f;
+    
+    //Color of the texture underneath.
+    ALLEGRO_COLOR color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    
+    //Texture X and Y coordinates of the texture on top, in pixels.
+    float tex_b[2] = { 0.0f, 0.0f };
+    
+    //Color of the texture on top, as red, green, blue, and alpha.
+    float color_b[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    
+};
+
+
+/**
+ * @brief A vertex of a tree shadow. Besides the usual, it also has how
+ * much its shadow sways, so that the tree shadow shader can make
+ * many shadows sway at once.
+ */
+struct TreeShadowVertex {
+
+    //--- Members ---
+    
+    //X coordinate.
+    float x = 0.0f;
+    
+    //Y coordinate.
+    float y = 0.0f;
+    
+    //Texture X coordinate, in pixels.
+    float u = 0.0f;
+    
+    //Texture Y coordinate, in pixels.
+    float v = 0.0f;
+    
+    //Color.
+    ALLEGRO_COLOR color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    
+    //The shadow's swaying is multiplied by this, horizontally and vertically.
+    float sway[2] = { 1.0f, 1.0f };
+    
+};
+
+
 /**
  * @brief Manages everything regarding shaders.
  */
@@ -48,6 +190,18 @@ struct ShaderManager {
     //Array of compiled shaders,
     ALLEGRO_SHADER* compiled_shaders[N_SHADER_TYPES];
     
+    //Vertex declaration for LiquidVertex.
+    ALLEGRO_VERTEX_DECL* liquid_vertex_decl = nullptr;
+    
+    //Vertex declaration for PrecipitationVertex.
+    ALLEGRO_VERTEX_DECL* precipitation_vertex_decl = nullptr;
+    
+    //Vertex declaration for SectorFadeVertex.
+    ALLEGRO_VERTEX_DECL* sector_fade_vertex_decl = nullptr;
+    
+    //Vertex declaration for TreeShadowVertex.
+    ALLEGRO_VERTEX_DECL* tree_shadow_vertex_decl = nullptr;
+    
     
     //--- Function declarations ---
     
@@ -36,6 +36,128 @@ gl_Position = al_projview_matrix * al_pos;
     )";
 
 
+#pragma endregion
+#pragma region Lighting Vertex Shader
+
+//Vertex shader for the lighting filter. This is drawn without any
+//transformation, so the position is already in screen coordinates.
+const char* LIGHTING_VERT_SHADER = R"(
+
+#version 430
+in vec4 al_pos;
+in vec4 al_color;
+in vec2 al_texcoord;
+uniform mat4 al_projview_matrix;
+out vec2 screen_pos;
+
+void main()
+{
+screen_pos = al_pos.xy;
+gl_Position = al_projview_matrix * al_pos;
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Lighting Fragment Shader
+
+//Fragment shader for the lighting filter. Does the radial fog and the
+//daylight tint in one go, as if they had been drawn one after the other.
+const char* LIGHTING_FRAG_SHADER = R"(
+
+#version 430
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+//Fragment shader input for the screen coordinates.
+in vec2 screen_pos;
+
+//Fragment shader output for the final color of the fragment.
+out vec4 frag_color;
+
+//Center of the fog, in screen coordinates.
+uniform vec2 fog_center;
+
+//Until this many pixels away from the center, the fog is not present.
+uniform float fog_near;
+
+//From this many pixels away from the center on, the fog is fully dense.
+//If this is 0, the fog is fully dense everywhere.
+uniform float fog_far;
+
+//Color of the fog. The alpha is how dense it is.
+uniform vec4 fog_color;
+
+//Color of the daylight. The alpha is how strong it is.
+uniform vec4 daylight_color;
+
+void main()
+{
+    float fog_ratio = 1.0;
+    if(fog_far > 0.0) {
+        float dist = distance(screen_pos, fog_center);
+        fog_ratio = (dist - fog_near) / max(fog_far - fog_near, 0.0001);
+        fog_ratio = clamp(fog_ratio, 0.0, 1.0);
+    }
+    float fog_alpha = fog_color.a * fog_ratio;
+    float daylight_alpha = daylight_color.a;
+
+    //Blend the daylight over the fog, so the result can be blended
+    //over the scene in one step.
+    float final_alpha = 1.0 - (1.0 - fog_alpha) * (1.0 - daylight_alpha);
+    if(final_alpha <= 0.0) discard;
+    vec3 final_rgb =
+        fog_color.rgb * fog_alpha * (1.0 - daylight_alpha) +
+        daylight_color.rgb * daylight_alpha;
+    frag_color = vec4(final_rgb / final_alpha, final_alpha);
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Liquid Vertex Shader
+
+//Vertex shader for sector liquids. Each vertex also carries the properties
+//of its sector, so that many sectors can be drawn in one go.
+const char* LIQUID_VERT_SHADER = R"(
+
+#version 430
+in vec4 al_pos;
+in vec4 al_color;
+in vec2 al_texcoord;
+in vec4 al_user_attr_0;
+in vec4 al_user_attr_1;
+in vec2 al_user_attr_2;
+uniform mat4 al_projview_matrix;
+out vec4 varying_color;
+out vec2 varying_texcoord;
+out vec2 tex_translation;
+out vec2 tex_scale;
+out float tex_rotation;
+out float sector_brightness;
+out float opacity;
+out vec2 sector_scroll;
+
+void main()
+{
+varying_color = al_color;
+varying_texcoord = al_texcoord;
+tex_translation = al_user_attr_0.xy;
+tex_scale = al_user_attr_0.zw;
+tex_rotation = al_user_attr_1.x;
+sector_brightness = al_user_attr_1.y;
+opacity = al_user_attr_1.z;
+sector_scroll = al_user_attr_2;
+gl_Position = al_projview_matrix * al_pos;
+}
+
+    )";
+
+
 #pragma endregion
 #pragma region Liquid Fragment Shader
 
@@ -76,6 +198,31 @@ in vec4 varying_color;
 out vec4 frag_color;
 
 
+/*
+ * ========================
+ * Sector properties
+ * ========================
+ */
+
+//Opacity of the liquid.
+in float opacity;
+
+//Translation of the floor texture underneath the water.
+in vec2 tex_translation;
+
+//Scale of the floor texture underneath the water.
+in vec2 tex_scale;
+
+//Rotation of the floor texture underneath the water.
+in float tex_rotation;
+
+//Brightness of the sector.
+in float sector_brightness;
+
+//How far the sector has scrolled by.
+in vec2 sector_scroll;
+
+
 /*
  * ========================
  * Uniforms
@@ -109,24 +256,6 @@ uniform float shine_min_threshold;
 //Noise values above this will have full shine (0-1).
 uniform float shine_max_threshold;
 
-//Opacity of the liquid.
-uniform float opacity;
-
-//Translation of the floor texture underneath the water.
-uniform vec2 tex_translation;
-
-//Scale of the floor texture underneath the water.
-uniform vec2 tex_scale;
-
-//Rotation of the floor texture underneath the water.
-uniform float tex_rotation;
-
-//Brightness of the sector.
-uniform float sector_brightness;
-
-//How far the sector has scrolled by.
-uniform vec2 sector_scroll;
-
 //The Allegro texture for the floor underneath the water.
 uniform sampler2D al_tex;
 
@@ -450,6 +579,259 @@ void main() {
 
     )";
 
+#pragma endregion
+#pragma region Precipitation Vertex Shader
+
+//Vertex shader for precipitation. Each drop's position is worked out from
+//its index and the time alone, so nothing about the drops needs to be
+//kept between frames. Drops are anchored to the world, but wrap around
+//the view, so every drop is always inside of it.
+const char* PRECIPITATION_VERT_SHADER = R"(
+
+#version 430
+in vec4 al_pos;
+in float al_user_attr_0;
+uniform mat4 al_projview_matrix;
+out vec2 corner;
+
+//Time passed in the area.
+uniform float area_time;
+
+//Random number that makes this area's drops different from others'.
+uniform float seed;
+
+//Top-left corner of the view, in world coordinates.
+uniform vec2 view_tl;
+
+//Size of the view, in world coordinates.
+uniform vec2 view_size;
+
+//Radius of each drop.
+uniform float drop_size;
+
+//How fast the drops fall.
+uniform float fall_speed;
+
+float hash(float n) {
+    return fract(sin(n * 12.9898 + seed * 78.233) * 43758.5453);
+}
+
+void main()
+{
+float idx = al_user_attr_0;
+vec2 wrap_size = view_size + drop_size * 2.0;
+vec2 pos =
+    vec2(hash(idx), hash(idx + 0.5)) * wrap_size * 64.0;
+pos.y += area_time * fall_speed * (0.75 + 0.5 * hash(idx + 0.25));
+vec2 wrap_tl = view_tl - drop_size;
+pos = wrap_tl + mod(pos - wrap_tl, wrap_size);
+corner = al_pos.xy;
+gl_Position =
+    al_projview_matrix * vec4(pos + al_pos.xy * drop_size, 0.0, 1.0);
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Precipitation Fragment Shader
+
+//Fragment shader for precipitation. Draws each drop as a circle.
+const char* PRECIPITATION_FRAG_SHADER = R"(
+
+#version 430
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+//Fragment shader input for the corner coordinates, from -1 to 1.
+in vec2 corner;
+
+//Fragment shader output for the final color of the fragment.
+out vec4 frag_color;
+
+void main()
+{
+    if(dot(corner, corner) > 1.0) discard;
+    frag_color = vec4(1.0, 1.0, 1.0, 1.0);
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Sector Fade Vertex Shader
+
+//Vertex shader for fading sectors. Each vertex has the texture coordinates
+//and color of both textures, so that the whole fade is drawn in one go.
+const char* SECTOR_FADE_VERT_SHADER = R"(
+
+#version 430
+in vec4 al_pos;
+in vec4 al_color;
+in vec2 al_texcoord;
+in vec2 al_user_attr_0;
+in vec4 al_user_attr_1;
+uniform mat4 al_projview_matrix;
+uniform bool al_use_tex_matrix;
+uniform mat4 al_tex_matrix;
+out vec4 varying_color;
+out vec2 varying_texcoord;
+out vec4 varying_color_b;
+out vec2 varying_texcoord_b;
+
+//Size of the texture on top, in pixels.
+uniform ivec2 bmp_b_size;
+
+void main()
+{
+varying_color = al_color;
+if(al_use_tex_matrix) {
+    vec4 uv = al_tex_matrix * vec4(al_texcoord, 0.0, 1.0);
+    varying_texcoord = uv.xy;
+} else {
+    varying_texcoord = al_texcoord;
+}
+varying_color_b = al_user_attr_1;
+varying_texcoord_b =
+    vec2(
+        al_user_attr_0.x / float(bmp_b_size.x),
+        -al_user_attr_0.y / float(bmp_b_size.y)
+    );
+gl_Position = al_projview_matrix * al_pos;
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Sector Fade Fragment Shader
+
+//Fragment shader for fading sectors. Draws the texture on top over the
+//texture underneath, like two separate draws would.
+const char* SECTOR_FADE_FRAG_SHADER = R"(
+
+#version 430
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+//Fragment shader input for the texture underneath's coordinates.
+in vec2 varying_texcoord;
+
+//Fragment shader input for the texture underneath's color.
+in vec4 varying_color;
+
+//Fragment shader input for the texture on top's coordinates.
+in vec2 varying_texcoord_b;
+
+//Fragment shader input for the texture on top's color.
+in vec4 varying_color_b;
+
+//Fragment shader output for the final color of the fragment.
+out vec4 frag_color;
+
+//The texture underneath.
+uniform sampler2D al_tex;
+
+//The texture on top. Only the texture underneath gets set to repeat,
+//so this one is wrapped by hand.
+uniform sampler2D tex_b;
+
+void main()
+{
+    vec4 under = texture(al_tex, varying_texcoord) * varying_color;
+    vec4 over =
+        textureGrad(
+            tex_b, fract(varying_texcoord_b),
+            dFdx(varying_texcoord_b), dFdy(varying_texcoord_b)
+        ) * varying_color_b;
+    float alpha = over.a + under.a * (1.0 - over.a);
+    vec3 rgb =
+        over.rgb * over.a + under.rgb * under.a * (1.0 - over.a);
+    frag_color = vec4(rgb / max(alpha, 0.0001), alpha);
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Tree Shadow Vertex Shader
+
+//Vertex shader for tree shadows. Each vertex also says how much its
+//shadow sways, so that all shadows of the same bitmap can be drawn
+//in one go.
+const char* TREE_SHADOW_VERT_SHADER = R"(
+
+#version 430
+in vec4 al_pos;
+in vec4 al_color;
+in vec2 al_texcoord;
+in vec2 al_user_attr_0;
+uniform mat4 al_projview_matrix;
+uniform bool al_use_tex_matrix;
+uniform mat4 al_tex_matrix;
+out vec4 varying_color;
+out vec2 varying_texcoord;
+
+//How much a shadow with a sway multiplier of 1 is moved by right now.
+uniform vec2 sway_offset;
+
+void main()
+{
+varying_color = al_color;
+if(al_use_tex_matrix) {
+    vec4 uv = al_tex_matrix * vec4(al_texcoord, 0.0, 1.0);
+    varying_texcoord = uv.xy;
+} else {
+    varying_texcoord = al_texcoord;
+}
+vec4 pos = al_pos;
+pos.xy += sway_offset * al_user_attr_0;
+gl_Position = al_projview_matrix * pos;
+}
+
+    )";
+
+
+#pragma endregion
+#pragma region Tree Shadow Fragment Shader
+
+//Fragment shader for tree shadows.
+const char* TREE_SHADOW_FRAG_SHADER = R"(
+
+#version 430
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+//Fragment shader input for texture coordinates.
+in vec2 varying_texcoord;
+
+//Fragment shader input for the tint.
+in vec4 varying_color;
+
+//Fragment shader output for the final color of the fragment.
+out vec4 frag_color;
+
+//The shadow's bitmap.
+uniform sampler2D al_tex;
+
+//Multiply the opacity of every shadow by this much.
+uniform float opacity;
+
+void main()
+{
+    frag_color = texture(al_tex, varying_texcoord) * varying_color;
+    frag_color.a *= opacity;
+}
+
+    )";
+
+
 #pragma endregion
 
 }
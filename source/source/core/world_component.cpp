@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * World component class and related functions.
+ */
+
+#include <cstring>
+
+#include "world_component.h"
+
+#include "../util/math_utils.h"
+
+
+namespace WORLD_COMPONENT {
+
+//Number of bits of the sort key handled by each radix sort pass.
+const unsigned char SORT_RADIX_BITS = 11;
+
+//Number of buckets in each radix sort pass.
+const size_t SORT_RADIX_BUCKETS = 1 << SORT_RADIX_BITS;
+
+//Number of radix sort passes needed to go through a 32-bit key.
+const unsigned char SORT_RADIX_PASSES = 3;
+
+}
+
+
+/**
+ * @brief Sorts a list of world components by Z, from lowest to highest.
+ * The sort is stable, so components with the same Z keep the order
+ * they were added in. This uses a radix sort, since the list can be big and
+ * is sorted every frame.
+ *
+ * @param list List to sort.
+ * @param buffer Buffer to use while sorting. Its contents don't matter.
+ * It's a parameter so that its memory can be reused between calls.
+ */
+void sort_world_components(
+    vector<WorldComponent> &list, vector<WorldComponent> &buffer
+) {
+    if(list.size() < 2) return;
+    buffer.resize(list.size());
+    
+    size_t bucket_starts[WORLD_COMPONENT::SORT_RADIX_BUCKETS];
+    
+    for(
+        unsigned char p = 0; p < WORLD_COMPONENT::SORT_RADIX_PASSES; p++
+    ) {
+        unsigned char shift = p * WORLD_COMPONENT::SORT_RADIX_BITS;
+        
+        //Count how many go in each bucket.
+        memset(bucket_starts, 0, sizeof(bucket_starts));
+        for(size_t c = 0; c < list.size(); c++) {
+            uint32_t digit =
+                (float_to_sortable_uint(list[c].z) >> shift) &
+                (WORLD_COMPONENT::SORT_RADIX_BUCKETS - 1);
+            bucket_starts[digit]++;
+        }
+        
+        //If everything lands in the same bucket, this pass changes nothing.
+        //This is common for the higher bits, since Z values tend to be close.
+        uint32_t first_digit =
+            (float_to_sortable_uint(list[0].z) >> shift) &
+            (WORLD_COMPONENT::SORT_RADIX_BUCKETS - 1);
+        if(bucket_starts[first_digit] == list.size()) continue;
+        
+        //Turn the counts into starting positions.
+        size_t total = 0;
+        for(size_t b = 0; b < WORLD_COMPONENT::SORT_RADIX_BUCKETS; b++) {
+            size_t bucket_size = bucket_starts[b];
+            bucket_starts[b] = total;
+            total += bucket_size;
+        }
+        
+        //Place them.
+        for(size_t c = 0; c < list.size(); c++) {
+            uint32_t digit =
+                (float_to_sortable_uint(list[c].z) >> shift) &
+                (WORLD_COMPONENT::SORT_RADIX_BUCKETS - 1);
+            buffer[bucket_starts[digit]] = list[c];
+            bucket_starts[digit]++;
+        }
+        list.swap(buffer);
+    }
+}
@@ -11,6 +11,10 @@
 #pragma once
 
 #include <cstdio>
+#include <vector>
+
+
+using std::vector;
 
 
 struct Sector;
@@ -18,6 +22,13 @@ class Mob;
 struct Particle;
 
 
+namespace WORLD_COMPONENT {
+extern const unsigned char SORT_RADIX_BITS;
+extern const size_t SORT_RADIX_BUCKETS;
+extern const unsigned char SORT_RADIX_PASSES;
+}
+
+
 /**
  * @brief Something that makes up the interactable game world and can be drawn.
  * This contains information about how it should be drawn.
@@ -46,7 +57,9 @@ public:
     //Its Z coordinate.
     float z = 0.0f;
     
-    //Index in the list of world components. Used for sorting.
-    size_t idx = 0;
-    
 };
+
+
+void sort_world_components(
+    vector<WorldComponent> &list, vector<WorldComponent> &buffer
+);
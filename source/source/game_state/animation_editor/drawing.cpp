@@ -20,6 +20,155 @@
 
 
 
+/**
+ * @brief Adds the vertexes of a hitbox in the sideways view to the list of
+ * hitbox vertexes to draw this frame.
+ *
+ * @param h_ptr Hitbox to add.
+ * @param color Color to use for the hitbox's main shape.
+ * @param outline_color Color to use for the hitbox's outline.
+ * @param outline_thickness Thickness of the hitbox's outline.
+ */
+void AnimationEditor::add_side_view_hitbox_vertexes(
+    Hitbox* h_ptr, const ALLEGRO_COLOR &color,
+    const ALLEGRO_COLOR &outline_color, float outline_thickness
+) {
+    float dummy = 0;
+    float z_to_use = h_ptr->z;
+    float h_to_use = h_ptr->height;
+    
+    if(h_ptr->height == 0) {
+        //Set the coordinates to the screen top and screen bottom. Add some
+        //padding just to make sure.
+        z_to_use = game.win_h + 1;
+        h_to_use = 0 - 1;
+        al_transform_coordinates(
+            &game.screen_to_world_transform, &dummy, &z_to_use
+        );
+        al_transform_coordinates(
+            &game.screen_to_world_transform, &dummy, &h_to_use
+        );
+        //The height is the height from the top of the screen to the bottom.
+        h_to_use = z_to_use - h_to_use;
+        //Z needs to be flipped.
+        z_to_use = -z_to_use;
+    }
+    
+    auto add_rectangle =
+    [this] (float x1, float y1, float x2, float y2, const ALLEGRO_COLOR &c) {
+        ALLEGRO_VERTEX v;
+        v.z = 0.0f;
+        v.u = 0.0f;
+        v.v = 0.0f;
+        v.color = c;
+        const float corners[6][2] = {
+            {x1, y1}, {x2, y1}, {x2, y2}, {x1, y1}, {x2, y2}, {x1, y2}
+        };
+        for(size_t c_idx = 0; c_idx < 6; c_idx++) {
+            v.x = corners[c_idx][0];
+            v.y = corners[c_idx][1];
+            hitbox_vertexes.push_back(v);
+        }
+    };
+    
+    float x1 = h_ptr->pos.x - h_ptr->radius;
+    float x2 = h_ptr->pos.x + h_ptr->radius;
+    float y1 = std::min(-z_to_use, -z_to_use - h_to_use);
+    float y2 = std::max(-z_to_use, -z_to_use - h_to_use);
+    float half_t = outline_thickness / 2.0f;
+    
+    add_rectangle(x1, y1, x2, y2, color);
+    
+    //The outline is centered on the rectangle's edges, so it's made of
+    //four bands around them.
+    add_rectangle(
+        x1 - half_t, y1 - half_t, x2 + half_t, y1 + half_t, outline_color
+    );
+    add_rectangle(
+        x1 - half_t, y2 - half_t, x2 + half_t, y2 + half_t, outline_color
+    );
+    add_rectangle(
+        x1 - half_t, y1 + half_t, x1 + half_t, y2 - half_t, outline_color
+    );
+    add_rectangle(
+        x2 - half_t, y1 + half_t, x2 + half_t, y2 - half_t, outline_color
+    );
+}
+
+
+/**
+ * @brief Adds the vertexes of a hitbox in the standard top-down view to the
+ * list of hitbox vertexes to draw this frame.
+ *
+ * @param h_ptr Hitbox to add.
+ * @param color Color of the hitbox's main shape.
+ * @param outline_color Color of the hitbox's outline.
+ * @param outline_thickness Thickness of the hitbox's outline.
+ */
+void AnimationEditor::add_top_down_view_hitbox_vertexes(
+    Hitbox* h_ptr, const ALLEGRO_COLOR &color,
+    const ALLEGRO_COLOR &outline_color, float outline_thickness
+) {
+    if(h_ptr->radius <= 0) return;
+    
+    ALLEGRO_VERTEX v;
+    v.z = 0.0f;
+    v.u = 0.0f;
+    v.v = 0.0f;
+    
+    float inner_r = std::max(0.0f, h_ptr->radius - outline_thickness / 2.0f);
+    float outer_r = h_ptr->radius + outline_thickness / 2.0f;
+    float step = TAU / ANIM_EDITOR::HITBOX_CIRCLE_SEGMENTS;
+    float step_cos = cos(step);
+    float step_sin = sin(step);
+    
+    //Walk around the circle by rotating a unit vector, instead of
+    //calculating the sine and cosine of every point.
+    float cur_cos = 1.0f;
+    float cur_sin = 0.0f;
+    for(size_t s = 0; s < ANIM_EDITOR::HITBOX_CIRCLE_SEGMENTS; s++) {
+        float next_cos = cur_cos * step_cos - cur_sin * step_sin;
+        float next_sin = cur_sin * step_cos + cur_cos * step_sin;
+        if(s == ANIM_EDITOR::HITBOX_CIRCLE_SEGMENTS - 1) {
+            //Close the circle exactly.
+            next_cos = 1.0f;
+            next_sin = 0.0f;
+        }
+        
+        Point p1(cur_cos, cur_sin);
+        Point p2(next_cos, next_sin);
+        
+        //Main shape.
+        v.color = color;
+        v.x = h_ptr->pos.x;
+        v.y = h_ptr->pos.y;
+        hitbox_vertexes.push_back(v);
+        v.x = h_ptr->pos.x + p1.x * h_ptr->radius;
+        v.y = h_ptr->pos.y + p1.y * h_ptr->radius;
+        hitbox_vertexes.push_back(v);
+        v.x = h_ptr->pos.x + p2.x * h_ptr->radius;
+        v.y = h_ptr->pos.y + p2.y * h_ptr->radius;
+        hitbox_vertexes.push_back(v);
+        
+        //Outline.
+        Point in1 = h_ptr->pos + p1 * inner_r;
+        Point out1 = h_ptr->pos + p1 * outer_r;
+        Point in2 = h_ptr->pos + p2 * inner_r;
+        Point out2 = h_ptr->pos + p2 * outer_r;
+        const Point* corners[6] = { &in1, &out1, &out2, &in1, &out2, &in2 };
+        v.color = outline_color;
+        for(size_t c = 0; c < 6; c++) {
+            v.x = corners[c]->x;
+            v.y = corners[c]->y;
+            hitbox_vertexes.push_back(v);
+        }
+        
+        cur_cos = next_cos;
+        cur_sin = next_sin;
+    }
+}
+
+
 /**
  * @brief Handles the drawing part of the main loop of the animation editor.
  */
@@ -203,6 +352,7 @@ void AnimationEditor::draw_canvas() {
             unsigned char hitbox_outline_alpha =
                 63 + 192 * ((sin(cur_hitbox_alpha) / 2.0) + 0.5);
             size_t n_hitboxes = s->hitboxes.size();
+            hitbox_vertexes.clear();
             
             for(int h = (int) n_hitboxes - 1; h >= 0; --h) {
                 //Iterate the hitboxes in reverse order, since this is
@@ -240,17 +390,26 @@ void AnimationEditor::draw_canvas() {
                 }
                 
                 if(side_view && state == EDITOR_STATE_HITBOXES) {
-                    draw_side_view_hitbox(
+                    add_side_view_hitbox_vertexes(
                         h_ptr, hitbox_color,
                         hitbox_outline_color, hitbox_outline_thickness
                     );
                 } else {
-                    draw_top_down_view_hitbox(
+                    add_top_down_view_hitbox_vertexes(
                         h_ptr, hitbox_color,
                         hitbox_outline_color, hitbox_outline_thickness
                     );
                 }
             }
+            
+            //All hitboxes go in one draw call. Triangles are drawn in the
+            //order they were added, so the priority order is kept.
+            if(!hitbox_vertexes.empty()) {
+                al_draw_prim(
+                    hitbox_vertexes.data(), nullptr, nullptr,
+                    0, (int) hitbox_vertexes.size(), ALLEGRO_PRIM_TRIANGLE_LIST
+                );
+            }
         }
         
         if(state == EDITOR_STATE_SPRITE_TRANSFORM) {
@@ -389,57 +548,6 @@ void AnimationEditor::draw_comparison() {
 }
 
 
-/**
- * @brief Draws a hitbox on the canvas in the sideways view.
- *
- * @param h_ptr Hitbox to draw.
- * @param color Color to use for the hitbox's main shape.
- * @param outline_color Color to use for the hitbox's outline.
- * @param outline_thickness Thickness of the hitbox's outline.
- */
-void AnimationEditor::draw_side_view_hitbox(
-    Hitbox* h_ptr, const ALLEGRO_COLOR &color,
-    const ALLEGRO_COLOR &outline_color, float outline_thickness
-) {
-    float dummy = 0;
-    float z_to_use = h_ptr->z;
-    float h_to_use = h_ptr->height;
-    
-    if(h_ptr->height == 0) {
-        //Set the coordinates to the screen top and screen bottom. Add some
-        //padding just to make sure.
-        z_to_use = game.win_h + 1;
-        h_to_use = 0 - 1;
-        al_transform_coordinates(
-            &game.screen_to_world_transform, &dummy, &z_to_use
-        );
-        al_transform_coordinates(
-            &game.screen_to_world_transform, &dummy, &h_to_use
-        );
-        //The height is the height from the top of the screen to the bottom.
-        h_to_use = z_to_use - h_to_use;
-        //Z needs to be flipped.
-        z_to_use = -z_to_use;
-    }
-    
-    al_draw_filled_rectangle(
-        h_ptr->pos.x - h_ptr->radius,
-        -z_to_use,
-        h_ptr->pos.x + h_ptr->radius,
-        -z_to_use - h_to_use,
-        color
-    );
-    
-    al_draw_rectangle(
-        h_ptr->pos.x - h_ptr->radius,
-        -z_to_use,
-        h_ptr->pos.x + h_ptr->radius,
-        -z_to_use - h_to_use,
-        outline_color, outline_thickness
-    );
-}
-
-
 /**
  * @brief Draws a leader's silhouette on the canvas in the sideways view.
  *
@@ -638,31 +746,6 @@ void AnimationEditor::draw_timeline() {
 }
 
 
-/**
- * @brief Draws a hitbox on the canvas in the standard top-down view.
- *
- * @param h_ptr Hitbox to draw.
- * @param color Color of the hitbox's main shape.
- * @param outline_color Color of the hitbox's outline.
- * @param outline_thickness Thickness of the hitbox's outline.
- */
-void AnimationEditor::draw_top_down_view_hitbox(
-    Hitbox* h_ptr, const ALLEGRO_COLOR &color,
-    const ALLEGRO_COLOR &outline_color, float outline_thickness
-) {
-    if(h_ptr->radius <= 0) return;
-    
-    al_draw_filled_circle(
-        h_ptr->pos.x, h_ptr->pos.y, h_ptr->radius, color
-    );
-    
-    al_draw_circle(
-        h_ptr->pos.x, h_ptr->pos.y,
-        h_ptr->radius, outline_color, outline_thickness
-    );
-}
-
-
 /**
  * @brief Draws a leader silhouette on the canvas in the standard top-down view.
  *
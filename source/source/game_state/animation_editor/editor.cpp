@@ -31,6 +31,9 @@ const float FLOOD_FILL_ALPHA_THRESHOLD = 0.008;
 //Grid interval in the animation editor.
 const float GRID_INTERVAL = 16.0f;
 
+//Number of segments each hitbox's circle is made of, in the top-down view.
+const size_t HITBOX_CIRCLE_SEGMENTS = 64;
+
 //Minimum radius that a hitbox can have.
 const float HITBOX_MIN_RADIUS = 1.0f;
 
@@ -112,6 +115,20 @@ AnimationEditor::AnimationEditor() :
 }
 
 
+/**
+ * @brief Returns whether the animation editor can stop drawing until the
+ * player does something.
+ *
+ * @return Whether it can.
+ */
+bool AnimationEditor::can_idle() const {
+    if(!Editor::can_idle()) return false;
+    if(anim_playing) return false;
+    if(comparison && comparison_blink) return false;
+    return true;
+}
+
+
 /**
  * @brief Centers the camera on the sprite's parent bitmap, so the user
  * can choose what part of the bitmap they want to use for the sprite.
@@ -1028,21 +1045,15 @@ void AnimationEditor::zoom_out_cmd(float input_value) {
 
 
 /**
- * @brief Reloads all loaded animation databases.
+ * @brief Reloads the animation databases that changed on the disk
+ * since they were loaded.
  */
 void AnimationEditor::reload_anim_dbs() {
-    game.content.unload_all(
-    vector<CONTENT_TYPE> {
-        CONTENT_TYPE_GLOBAL_ANIMATION,
-        CONTENT_TYPE_MOB_ANIMATION,
-    }
-    );
-    game.content.load_all(
+    game.content.reload_changed(
     vector<CONTENT_TYPE> {
         CONTENT_TYPE_MOB_ANIMATION,
         CONTENT_TYPE_GLOBAL_ANIMATION,
-    },
-    CONTENT_LOAD_LEVEL_BASIC
+    }
     );
 }
 
@@ -1088,6 +1099,7 @@ void AnimationEditor::rename_animation(
     
     //Rename!
     anim->name = new_name;
+    db.refresh_name_idxs();
     
     changes_mgr.mark_as_changed();
     set_status(
@@ -1194,6 +1206,7 @@ void AnimationEditor::rename_sprite(
     
     //Rename!
     spr->name = new_name;
+    db.refresh_name_idxs();
     for(size_t a = 0; a < db.animations.size(); a++) {
         Animation* a_ptr = db.animations[a];
         for(size_t f = 0; f < a_ptr->frames.size(); f++) {
@@ -1703,6 +1716,9 @@ void AnimationEditor::update_cur_hitbox() {
  * @brief Update every frame's hitbox instances in light of new hitbox info.
  */
 void AnimationEditor::update_hitboxes() {
+    //This is called whenever the body parts change.
+    db.refresh_name_idxs();
+    
     for(size_t s = 0; s < db.sprites.size(); s++) {
     
         Sprite* s_ptr = db.sprites[s];
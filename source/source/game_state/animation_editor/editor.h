@@ -20,6 +20,7 @@
 namespace ANIM_EDITOR {
 extern const float FLOOD_FILL_ALPHA_THRESHOLD;
 extern const float GRID_INTERVAL;
+extern const size_t HITBOX_CIRCLE_SEGMENTS;
 extern const float HITBOX_MIN_RADIUS;
 extern const float KEYBOARD_PAN_AMOUNT;
 extern const size_t TIMELINE_HEADER_HEIGHT;
@@ -53,6 +54,7 @@ public:
     void load() override;
     void unload() override;
     string get_name() const override;
+    bool can_idle() const override;
     string get_name_for_history() const;
     void draw_canvas();
     string get_opened_content_path() const;
@@ -162,6 +164,10 @@ private:
     //Are the hitboxes currently visible?
     bool hitboxes_visible = true;
     
+    //Vertexes of every hitbox shape on the canvas, so they can all be drawn
+    //in one go. Kept around so the memory can be reused every frame.
+    vector<ALLEGRO_VERTEX> hitbox_vertexes;
+    
     //Last file used as for a spritesheet.
     string last_spritesheet_used;
     
@@ -284,18 +290,18 @@ private:
     static void draw_canvas_imgui_callback(
         const ImDrawList* parent_list, const ImDrawCmd* cmd
     );
-    void draw_comparison();
-    void draw_side_view_hitbox(
+    void add_side_view_hitbox_vertexes(
         Hitbox* h_ptr, const ALLEGRO_COLOR &color,
         const ALLEGRO_COLOR &outline_color, float outline_thickness
     );
-    void draw_side_view_leader_silhouette(float x_offset);
-    void draw_side_view_sprite(const Sprite* s);
-    void draw_timeline();
-    void draw_top_down_view_hitbox(
+    void add_top_down_view_hitbox_vertexes(
         Hitbox* h_ptr, const ALLEGRO_COLOR &color,
         const ALLEGRO_COLOR &outline_color, float outline_thickness
     );
+    void draw_comparison();
+    void draw_side_view_leader_silhouette(float x_offset);
+    void draw_side_view_sprite(const Sprite* s);
+    void draw_timeline();
     void draw_top_down_view_leader_silhouette(float x_offset);
     void draw_top_down_view_mob_radius(MobType* mt);
     void draw_top_down_view_sprite(Sprite* s);
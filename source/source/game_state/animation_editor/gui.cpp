@@ -1014,6 +1014,7 @@ void AnimationEditor::process_gui_panel_animation_header() {
             string cur_anim_name = cur_anim_i.cur_anim->name;
             size_t nr = db.find_animation(cur_anim_name);
             db.animations.erase(db.animations.begin() + nr);
+            db.refresh_name_idxs();
             if(db.animations.empty()) {
                 cur_anim_i.clear();
             } else {
@@ -93,6 +93,103 @@ void AreaEditor::draw_arrow(
 }
 
 
+/**
+ * @brief Draws the baked sector textures of the tiles that are in view.
+ * Tiles that weren't baked yet get baked now, at the current zoom level.
+ * Tiles that are out of view get destroyed.
+ *
+ * @param opacity Draw the textures at this opacity, 0 - 1.
+ */
+void AreaEditor::draw_baked_sector_textures(float opacity) {
+    float tile_world_size =
+        AREA_EDITOR::BAKED_SECTOR_TILE_SIZE / game.cam.zoom;
+    int col1 = floor(game.cam.box[0].x / tile_world_size);
+    int col2 = floor(game.cam.box[1].x / tile_world_size);
+    int row1 = floor(game.cam.box[0].y / tile_world_size);
+    int row2 = floor(game.cam.box[1].y / tile_world_size);
+    
+    for(auto t = baked_sector_tiles.begin(); t != baked_sector_tiles.end();) {
+        if(
+            t->first.first < col1 || t->first.first > col2 ||
+            t->first.second < row1 || t->first.second > row2
+        ) {
+            if(t->second) al_destroy_bitmap(t->second);
+            t = baked_sector_tiles.erase(t);
+        } else {
+            ++t;
+        }
+    }
+    
+    for(int row = row1; row <= row2; row++) {
+        for(int col = col1; col <= col2; col++) {
+            Point tile_tl(col * tile_world_size, row * tile_world_size);
+            Point tile_br = tile_tl + tile_world_size;
+            
+            auto t_it = baked_sector_tiles.find(std::make_pair(col, row));
+            if(t_it == baked_sector_tiles.end()) {
+                //Bake it now.
+                ALLEGRO_BITMAP* new_bmp = nullptr;
+                ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+                ALLEGRO_TRANSFORM old_transform;
+                al_copy_transform(&old_transform, al_get_current_transform());
+                ALLEGRO_TRANSFORM tile_transform;
+                al_identity_transform(&tile_transform);
+                al_translate_transform(
+                    &tile_transform, -tile_tl.x, -tile_tl.y
+                );
+                al_scale_transform(
+                    &tile_transform, game.cam.zoom, game.cam.zoom
+                );
+                
+                for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+                    Sector* s_ptr = game.cur_area_data->sectors[s];
+                    if(
+                        !rectangles_intersect(
+                            s_ptr->bbox[0], s_ptr->bbox[1], tile_tl, tile_br
+                        )
+                    ) {
+                        continue;
+                    }
+                    
+                    if(!new_bmp) {
+                        new_bmp =
+                            al_create_bitmap(
+                                AREA_EDITOR::BAKED_SECTOR_TILE_SIZE,
+                                AREA_EDITOR::BAKED_SECTOR_TILE_SIZE
+                            );
+                        if(!new_bmp) break;
+                        al_set_target_bitmap(new_bmp);
+                        al_clear_to_color(COLOR_EMPTY);
+                        al_use_transform(&tile_transform);
+                    }
+                    
+                    draw_sector_texture(s_ptr, Point(), 1.0f, opacity);
+                }
+                
+                if(new_bmp) {
+                    al_set_target_bitmap(old_target);
+                    al_use_transform(&old_transform);
+                }
+                t_it =
+                    baked_sector_tiles.insert(
+                        std::make_pair(std::make_pair(col, row), new_bmp)
+                    ).first;
+            }
+            
+            if(!t_it->second) continue;
+            al_draw_scaled_bitmap(
+                t_it->second,
+                0, 0,
+                AREA_EDITOR::BAKED_SECTOR_TILE_SIZE,
+                AREA_EDITOR::BAKED_SECTOR_TILE_SIZE,
+                tile_tl.x, tile_tl.y, tile_world_size, tile_world_size,
+                0
+            );
+        }
+    }
+}
+
+
 /**
  * @brief Draw the canvas.
  *
@@ -226,21 +323,58 @@ void AreaEditor::draw_canvas() {
             game.cam.box[0], game.cam.box[1],
             game.liquid_limit_effect_caches,
             game.liquid_limit_effect_buffer,
-            true
+            true,
+            nullptr,
+            game.offset_effect_buffers_scale
         );
         update_offset_effect_buffer(
             game.cam.box[0], game.cam.box[1],
             game.wall_smoothing_effect_caches,
             game.wall_offset_effect_buffer,
-            true
+            true,
+            nullptr,
+            game.offset_effect_buffers_scale
         );
         update_offset_effect_buffer(
             game.cam.box[0], game.cam.box[1],
             game.wall_shadow_effect_caches,
             game.wall_offset_effect_buffer,
-            false
+            false,
+            nullptr,
+            game.offset_effect_buffers_scale
         );
+        //The editor's geometry can change without the caches changing,
+        //so make sure gameplay doesn't reuse this drawing.
+        game.offset_effect_buffers_dirty = true;
+    }
+    
+    //Sector textures can be baked into tiles, so panning or hovering doesn't
+    //draw them all again every frame. But only if they look the same from
+    //one frame to the next, and only once the zoom level stops changing.
+    bool bake_textures = false;
+    if(
+        !game.options.advanced.bake_static_sectors ||
+        game.options.area_editor.view_mode != VIEW_MODE_TEXTURES ||
+        preview_mode || wall_shadows_opacity > 0.0f ||
+        moving || cur_transformation_widget.is_moving_handle() ||
+        game.sector_textures.get_nr_pending() > 0
+    ) {
+        if(!baked_sector_tiles.empty()) clear_baked_sector_tiles();
+        baked_sector_tiles_zoom = 0.0f;
+    } else if(
+        game.cam.zoom != baked_sector_tiles_zoom ||
+        textures_opacity != baked_sector_tiles_opacity ||
+        baked_sector_tiles_outdated
+    ) {
+        clear_baked_sector_tiles();
+        baked_sector_tiles_zoom = game.cam.zoom;
+        baked_sector_tiles_opacity = textures_opacity;
+        baked_sector_tiles_outdated = false;
+    } else {
+        bake_textures = true;
+        draw_baked_sector_textures(textures_opacity);
     }
+    
     size_t n_sectors = game.cur_area_data->sectors.size();
     for(size_t s = 0; s < n_sectors; s++) {
         Sector* s_ptr;
@@ -263,28 +397,39 @@ void AreaEditor::draw_canvas() {
             game.options.area_editor.view_mode == VIEW_MODE_TEXTURES ||
             preview_mode
         ) {
+            if(moving) {
+                //Vertexes are moved around without triangulating the
+                //sectors again, so the cached texture vertexes can't be
+                //trusted until the move is over.
+                s_ptr->invalidate_texture_draw_caches();
+            }
+            
             if(preview_mode) {
                 bool has_liquid = false;
                 for(size_t h = 0; h < s_ptr->hazards.size(); h++) {
                     Liquid* l_ptr = s_ptr->hazards[h]->associated_liquid;
                     if(!l_ptr) continue;
-                    draw_liquid(s_ptr, l_ptr, Point(), 1.0f, game.time_passed);
+                    draw_liquid(
+                        {s_ptr}, l_ptr, Point(), 1.0f, game.time_passed
+                    );
                     has_liquid = true;
                     break;
                 }
                 if(!has_liquid) {
                     draw_sector_texture(s_ptr, Point(), 1.0, textures_opacity);
                 }
-            } else {
+            } else if(!bake_textures) {
                 draw_sector_texture(s_ptr, Point(), 1.0, textures_opacity);
             }
             
             if(wall_shadows_opacity > 0.0f) {
                 draw_sector_edge_offsets(
-                    s_ptr, game.liquid_limit_effect_buffer, 1.0f
+                    s_ptr, game.liquid_limit_effect_buffer, 1.0f,
+                    game.offset_effect_buffers_scale
                 );
                 draw_sector_edge_offsets(
-                    s_ptr, game.wall_offset_effect_buffer, wall_shadows_opacity
+                    s_ptr, game.wall_offset_effect_buffer,
+                    wall_shadows_opacity, game.offset_effect_buffers_scale
                 );
             }
             
@@ -310,7 +455,7 @@ void AreaEditor::draw_canvas() {
         ) {
             valid = false;
         }
-        if(s_ptr == problem_sector_ptr) {
+        if(s_ptr == problem.sector_ptr) {
             valid = false;
         }
         
@@ -419,18 +564,18 @@ void AreaEditor::draw_canvas() {
             ) &&
             state == EDITOR_STATE_LAYOUT;
             
-        if(problem_sector_ptr) {
+        if(problem.sector_ptr) {
             if(
-                e_ptr->sectors[0] == problem_sector_ptr ||
-                e_ptr->sectors[1] == problem_sector_ptr
+                e_ptr->sectors[0] == problem.sector_ptr ||
+                e_ptr->sectors[1] == problem.sector_ptr
             ) {
                 valid = false;
             }
             
         }
         if(
-            problem_edge_intersection.e1 == e_ptr ||
-            problem_edge_intersection.e2 == e_ptr
+            problem.edge_intersection.e1 == e_ptr ||
+            problem.edge_intersection.e2 == e_ptr
         ) {
             valid = false;
         }
@@ -596,7 +741,7 @@ void AreaEditor::draw_canvas() {
             bool selected =
                 (selected_vertexes.find(v_ptr) != selected_vertexes.end());
             bool valid =
-                v_ptr != problem_vertex_ptr;
+                v_ptr != problem.vertex_ptr;
             bool highlighted =
                 highlighted_vertex == v_ptr &&
                 (
@@ -703,7 +848,7 @@ void AreaEditor::draw_canvas() {
         
         float radius = get_mob_gen_radius(m_ptr);
         ALLEGRO_COLOR color = al_map_rgb(255, 0, 0);
-        if(m_ptr->type && m_ptr != problem_mob_ptr) {
+        if(m_ptr->type && m_ptr != problem.mob_ptr) {
             color =
                 change_alpha(
                     m_ptr->type->category->editor_color, mob_opacity * 255
@@ -729,10 +874,7 @@ void AreaEditor::draw_canvas() {
                 Point c_pos =
                     m_ptr->pos +
                     rotate_point(spawn_info->coords_xy, m_ptr->angle);
-                MobType* c_type =
-                    game.mob_categories.find_mob_type(
-                        spawn_info->mob_type_name
-                    );
+                MobType* c_type = spawn_info->mob_type;
                 if(!c_type) continue;
                 
                 if(c_type->rectangular_dim.x != 0) {
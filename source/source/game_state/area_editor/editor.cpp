@@ -12,12 +12,14 @@
 
 #include "editor.h"
 
+#include "../../core/benchmark.h"
 #include "../../core/misc_functions.h"
 #include "../../core/game.h"
 #include "../../core/load.h"
 #include "../../lib/imgui/imgui_impl_allegro5.h"
 #include "../../util/allegro_utils.h"
 #include "../../util/general_utils.h"
+#include "../../util/os_utils.h"
 #include "../../util/string_utils.h"
 
 
@@ -30,6 +32,9 @@ using std::vector;
 
 namespace AREA_EDITOR {
 
+//Width and height of each tile of baked sector textures, in pixels.
+const int BAKED_SECTOR_TILE_SIZE = 512;
+
 //Color for blocking sectors in the "show blocking sectors" mode.
 const ALLEGRO_COLOR BLOCKING_COLOR = al_map_rgba(100, 32, 32, 192);
 
@@ -87,6 +92,12 @@ const float PATH_PREVIEW_CHECKPOINT_RADIUS = 8.0f;
 //Only fetch the path these many seconds after the player stops the checkpoints.
 const float PATH_PREVIEW_TIMER_DUR = 0.1f;
 
+//How many seconds of gameplay the performance report simulates.
+const float PERF_REPORT_DURATION = 60.0f;
+
+//Give up waiting for the performance report after these many seconds.
+const float PERF_REPORT_TIMEOUT = 300.0f;
+
 //Scale the letters on the "points" of various features by this much.
 const float POINT_LETTER_TEXT_SCALE = 1.5f;
 
@@ -176,6 +187,7 @@ AreaEditor::AreaEditor() :
     register_cmd(&AreaEditor::new_tree_shadow_cmd, "new_tree_shadow");
     register_cmd(&AreaEditor::paste_properties_cmd, "paste_properties");
     register_cmd(&AreaEditor::paste_texture_cmd, "paste_texture");
+    register_cmd(&AreaEditor::perf_report_cmd, "perf_report");
     register_cmd(&AreaEditor::quick_play_cmd, "quick_play");
     register_cmd(&AreaEditor::quit_cmd, "quit");
     register_cmd(&AreaEditor::redo_cmd, "redo");
@@ -195,6 +207,36 @@ AreaEditor::AreaEditor() :
 }
 
 
+/**
+ * @brief Adds an area state to the front of the undo or redo history.
+ * The state in the front is kept as a full copy, the checkpoint, and the
+ * entry that was in the front before only needs to keep what changed.
+ *
+ * @param history History to add to.
+ * @param checkpoint Checkpoint of that history.
+ * @param state State to add.
+ * @param operation_name Name of the operation.
+ */
+void AreaEditor::add_to_undo_or_redo_history(
+    deque<std::pair<AreaDelta*, string> > &history, Area* &checkpoint,
+    Area* state, const string &operation_name
+) {
+    if(!checkpoint) {
+        checkpoint = new Area();
+        state->clone(*checkpoint);
+    } else {
+        AreaDelta* delta = new AreaDelta();
+        AreaDelta::sync(checkpoint, state, delta);
+        if(history.empty()) {
+            delete delta;
+        } else {
+            history.front().first = delta;
+        }
+    }
+    history.push_front(make_pair((AreaDelta*) nullptr, operation_name));
+}
+
+
 /**
  * @brief Calculates what the day speed should be, taking into account
  * the specified start day time, end day time, and mission duration.
@@ -217,6 +259,37 @@ float AreaEditor::calculate_day_speed(
 }
 
 
+/**
+ * @brief Returns whether the area editor can stop drawing until the player
+ * does something.
+ *
+ * @return Whether it can.
+ */
+bool AreaEditor::can_idle() const {
+    if(!Editor::can_idle()) return false;
+    if(
+        !selected_vertexes.empty() || !selected_edges.empty() ||
+        !selected_sectors.empty() || !selected_mobs.empty() ||
+        !selected_path_stops.empty() || !selected_path_links.empty() ||
+        selected_shadow
+    ) {
+        //The selection effect pulses.
+        return false;
+    }
+    if(
+        new_sector_error_tint_timer.time_left > 0.0f ||
+        path_preview_timer.time_left > 0.0f ||
+        quick_preview_timer.time_left > 0.0f ||
+        undo_save_lock_timer.time_left > 0.0f
+    ) {
+        return false;
+    }
+    if(perf_report_time_left > 0.0f) return false;
+    if(game.file_writer.get_nr_pending() > 0) return false;
+    return true;
+}
+
+
 /**
  * @brief Cancels the circular sector creation operation and returns to normal.
  */
@@ -245,6 +318,10 @@ void AreaEditor::cancel_layout_moving() {
         v->x = pre_move_vertex_coords[v].x;
         v->y = pre_move_vertex_coords[v].y;
     }
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        game.cur_area_data->sectors[s]->invalidate_texture_draw_caches();
+    }
+    picking_index.outdated = true;
     clear_layout_moving();
 }
 
@@ -262,6 +339,17 @@ void AreaEditor::change_state(const EDITOR_STATE new_state) {
 }
 
 
+/**
+ * @brief Destroys all tiles of baked sector textures.
+ */
+void AreaEditor::clear_baked_sector_tiles() {
+    for(auto &t : baked_sector_tiles) {
+        if(t.second) al_destroy_bitmap(t.second);
+    }
+    baked_sector_tiles.clear();
+}
+
+
 /**
  * @brief Clears the data about the circular sector creation.
  */
@@ -282,6 +370,8 @@ void AreaEditor::clear_current_area() {
     clear_layout_drawing();
     clear_layout_moving();
     clear_problems();
+    picking_index.outdated = true;
+    clear_baked_sector_tiles();
     
     clear_area_textures();
     
@@ -347,16 +437,7 @@ void AreaEditor::clear_layout_moving() {
  * @brief Clears the data about the current problems, if any.
  */
 void AreaEditor::clear_problems() {
-    problem_type = EPT_NONE_YET;
-    problem_title.clear();
-    problem_description.clear();
-    problem_edge_intersection.e1 = nullptr;
-    problem_edge_intersection.e2 = nullptr;
-    problem_mob_ptr = nullptr;
-    problem_path_stop_ptr = nullptr;
-    problem_sector_ptr = nullptr;
-    problem_shadow_ptr = nullptr;
-    problem_vertex_ptr = nullptr;
+    problem = ProblemInfo();
 }
 
 
@@ -381,12 +462,9 @@ void AreaEditor::clear_selection() {
 
 
 /**
- * @brief Clears the list of texture suggestions. This frees up the bitmaps.
+ * @brief Clears the list of texture suggestions.
  */
 void AreaEditor::clear_texture_suggestions() {
-    for(size_t s = 0; s < texture_suggestions.size(); s++) {
-        texture_suggestions[s].destroy();
-    }
     texture_suggestions.clear();
 }
 
@@ -399,10 +477,18 @@ void AreaEditor::clear_undo_history() {
         delete undo_history[h].first;
     }
     undo_history.clear();
+    delete undo_checkpoint;
+    undo_checkpoint = nullptr;
     for(size_t h = 0; h < redo_history.size(); h++) {
         delete redo_history[h].first;
     }
     redo_history.clear();
+    delete redo_checkpoint;
+    redo_checkpoint = nullptr;
+    if(!prepared_state_cache_in_use) {
+        delete prepared_state_cache;
+        prepared_state_cache = nullptr;
+    }
 }
 
 
@@ -592,6 +678,7 @@ void AreaEditor::delete_current_area() {
         non_important_files.clear();
         non_important_files.push_back(FILE_NAMES::AREA_MAIN_DATA);
         non_important_files.push_back(FILE_NAMES::AREA_GEOMETRY);
+        non_important_files.push_back(FILE_NAMES::AREA_GEOMETRY_CACHE);
         FS_DELETE_RESULT result =
             wipe_folder(
                 manifest.path,
@@ -688,8 +775,42 @@ void AreaEditor::do_logic() {
         backup_timer.tick(game.delta_t);
     }
     
+    string failed_save_path;
+    if(game.file_writer.pop_failure(&failed_save_path)) {
+        while(game.file_writer.pop_failure(&failed_save_path)) {}
+        set_status(
+            "Could not save the auto-backup to \"" +
+            failed_save_path + "\"!", true
+        );
+    }
+    
+    if(perf_report_time_left > 0.0f) {
+        perf_report_time_left -= game.delta_t;
+        if(file_exists(FILE_PATHS_FROM_ROOT::AREA_PERF_REPORT)) {
+            perf_report_time_left = 0.0f;
+            set_status(
+                "Performance report saved to \"" +
+                FILE_PATHS_FROM_ROOT::AREA_PERF_REPORT + "\"."
+            );
+        } else if(perf_report_time_left <= 0.0f) {
+            perf_report_time_left = 0.0f;
+            set_status("The performance report did not finish!", true);
+        }
+    }
+    
     selection_effect += AREA_EDITOR::SELECTION_EFFECT_SPEED * game.delta_t;
     
+    if(
+        picking_index.changed_this_frame ||
+        moving || cur_transformation_widget.is_moving_handle()
+    ) {
+        //Things may have changed since the picking index got rebuilt,
+        //or since the sector textures got baked.
+        picking_index.outdated = true;
+        picking_index.changed_this_frame = false;
+        baked_sector_tiles_outdated = true;
+    }
+    
     Editor::do_logic_post();
 }
 
@@ -991,12 +1112,15 @@ void AreaEditor::finish_layout_moving() {
     unordered_set<Sector*> merge_affected_sectors;
     
     //Find merge vertexes and edges to split, if any.
+    VertexGrid merge_grid(
+        game.cur_area_data->vertexes, GEOMETRY::BLOCKMAP_BLOCK_SIZE
+    );
     for(auto &v : selected_vertexes) {
         Point p = v2p(v);
         
         vector<std::pair<Distance, Vertex*> > merge_vertexes =
             get_merge_vertexes(
-                p, game.cur_area_data->vertexes,
+                p, merge_grid,
                 AREA_EDITOR::VERTEX_MERGE_RADIUS / game.cam.zoom
             );
             
@@ -1012,13 +1136,6 @@ void AreaEditor::finish_layout_moving() {
             }
         }
         
-        sort(
-            merge_vertexes.begin(), merge_vertexes.end(),
-        [] (std::pair<Distance, Vertex*> v1, std::pair<Distance, Vertex*> v2) -> bool {
-            return v1.first < v2.first;
-        }
-        );
-        
         Vertex* merge_v = nullptr;
         if(!merge_vertexes.empty()) {
             merge_v = merge_vertexes[0].second;
@@ -1113,9 +1230,14 @@ void AreaEditor::finish_layout_moving() {
     
     //Before moving on and making changes, check if the move causes problems.
     //Start by checking all crossing edges, but removing all of the ones that
-    //come from edge splits or vertex merges.
+    //come from edge splits or vertex merges. Only the edges that moved
+    //can have started crossing others.
+    set<Edge*> touched_edges;
+    for(Vertex* v_ptr : selected_vertexes) {
+        touched_edges.insert(v_ptr->edges.begin(), v_ptr->edges.end());
+    }
     vector<EdgeIntersection> intersections =
-        get_intersecting_edges();
+        get_intersecting_edges(&touched_edges);
     for(auto &m : merges) {
         for(size_t e1 = 0; e1 < m.first->edges.size(); e1++) {
             for(size_t e2 = 0; e2 < m.second->edges.size(); e2++) {
@@ -1338,6 +1460,10 @@ void AreaEditor::finish_new_sector_drawing() {
  * @param prepared_state The prepared state to forget.
  */
 void AreaEditor::forget_prepared_state(Area* prepared_state) {
+    if(prepared_state == prepared_state_cache) {
+        prepared_state_cache_in_use = false;
+        return;
+    }
     delete prepared_state;
 }
 
@@ -1524,11 +1650,30 @@ AreaEditor::SECTOR_SPLIT_RESULT AreaEditor::get_sector_split_evaluation() {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the undo history takes up,
+ * in bytes, so the undo limit can be sized with that in mind.
+ *
+ * @return The size.
+ */
+size_t AreaEditor::get_undo_history_memory_usage() const {
+    size_t size = 0;
+    for(size_t h = 0; h < undo_history.size(); h++) {
+        if(undo_history[h].first) {
+            size += undo_history[h].first->get_memory_usage();
+        }
+        size += undo_history[h].second.capacity();
+    }
+    if(undo_checkpoint) size += undo_checkpoint->get_memory_usage();
+    return size;
+}
+
+
 /**
  * @brief Focuses the camera on the problem found, if any.
  */
 void AreaEditor::goto_problem() {
-    switch(problem_type) {
+    switch(problem.type) {
     case EPT_NONE:
     case EPT_NONE_YET: {
         return;
@@ -1536,32 +1681,32 @@ void AreaEditor::goto_problem() {
     } case EPT_INTERSECTING_EDGES: {
 
         if(
-            !problem_edge_intersection.e1 || !problem_edge_intersection.e2
+            !problem.edge_intersection.e1 || !problem.edge_intersection.e2
         ) {
             //Uh, old information. Try searching for problems again.
             find_problems();
             return;
         }
         
-        Point min_coords = v2p(problem_edge_intersection.e1->vertexes[0]);
+        Point min_coords = v2p(problem.edge_intersection.e1->vertexes[0]);
         Point max_coords = min_coords;
         
         update_min_max_coords(
             min_coords, max_coords,
-            v2p(problem_edge_intersection.e1->vertexes[1])
+            v2p(problem.edge_intersection.e1->vertexes[1])
         );
         update_min_max_coords(
             min_coords, max_coords,
-            v2p(problem_edge_intersection.e2->vertexes[0])
+            v2p(problem.edge_intersection.e2->vertexes[0])
         );
         update_min_max_coords(
             min_coords, max_coords,
-            v2p(problem_edge_intersection.e2->vertexes[1])
+            v2p(problem.edge_intersection.e2->vertexes[1])
         );
         
         change_state(EDITOR_STATE_LAYOUT);
-        select_edge(problem_edge_intersection.e1);
-        select_edge(problem_edge_intersection.e2);
+        select_edge(problem.edge_intersection.e1);
+        select_edge(problem.edge_intersection.e2);
         center_camera(min_coords, max_coords);
         
         break;
@@ -1604,22 +1749,22 @@ void AreaEditor::goto_problem() {
         
     } case EPT_OVERLAPPING_VERTEXES: {
 
-        if(!problem_vertex_ptr) {
+        if(!problem.vertex_ptr) {
             //Uh, old information. Try searching for problems again.
             find_problems();
             return;
         }
         
         change_state(EDITOR_STATE_LAYOUT);
-        select_vertex(problem_vertex_ptr);
+        select_vertex(problem.vertex_ptr);
         center_camera(
             Point(
-                problem_vertex_ptr->x - 64,
-                problem_vertex_ptr->y - 64
+                problem.vertex_ptr->x - 64,
+                problem.vertex_ptr->y - 64
             ),
             Point(
-                problem_vertex_ptr->x + 64,
-                problem_vertex_ptr->y + 64
+                problem.vertex_ptr->x + 64,
+                problem.vertex_ptr->y + 64
             )
         );
         
@@ -1627,15 +1772,15 @@ void AreaEditor::goto_problem() {
         
     } case EPT_UNKNOWN_TEXTURE: {
 
-        if(!problem_sector_ptr) {
+        if(!problem.sector_ptr) {
             //Uh, old information. Try searching for problems again.
             find_problems();
             return;
         }
         
         change_state(EDITOR_STATE_LAYOUT);
-        select_sector(problem_sector_ptr);
-        center_camera(problem_sector_ptr->bbox[0], problem_sector_ptr->bbox[1]);
+        select_sector(problem.sector_ptr);
+        center_camera(problem.sector_ptr->bbox[0], problem.sector_ptr->bbox[1]);
         
         break;
         
@@ -1647,15 +1792,15 @@ void AreaEditor::goto_problem() {
     case EPT_SECTORLESS_BRIDGE:
     case EPT_PILE_BRIDGE_PATH: {
 
-        if(!problem_mob_ptr) {
+        if(!problem.mob_ptr) {
             //Uh, old information. Try searching for problems again.
             find_problems();
             return;
         }
         
         change_state(EDITOR_STATE_MOBS);
-        selected_mobs.insert(problem_mob_ptr);
-        center_camera(problem_mob_ptr->pos - 64, problem_mob_ptr->pos + 64);
+        selected_mobs.insert(problem.mob_ptr);
+        center_camera(problem.mob_ptr->pos - 64, problem.mob_ptr->pos + 64);
         
         break;
         
@@ -1664,17 +1809,17 @@ void AreaEditor::goto_problem() {
     case EPT_PATH_STOP_ON_LINK:
     case EPT_PATH_STOP_OOB: {
 
-        if(!problem_path_stop_ptr) {
+        if(!problem.path_stop_ptr) {
             //Uh, old information. Try searching for problems again.
             find_problems();
             return;
         }
         
         change_state(EDITOR_STATE_PATHS);
-        selected_path_stops.insert(problem_path_stop_ptr);
+        selected_path_stops.insert(problem.path_stop_ptr);
         center_camera(
-            problem_path_stop_ptr->pos - 64,
-            problem_path_stop_ptr->pos + 64
+            problem.path_stop_ptr->pos - 64,
+            problem.path_stop_ptr->pos + 64
         );
         
         break;
@@ -1683,12 +1828,12 @@ void AreaEditor::goto_problem() {
 
         Point min_coords, max_coords;
         get_transformed_rectangle_bounding_box(
-            problem_shadow_ptr->center, problem_shadow_ptr->size,
-            problem_shadow_ptr->angle, &min_coords, &max_coords
+            problem.shadow_ptr->center, problem.shadow_ptr->size,
+            problem.shadow_ptr->angle, &min_coords, &max_coords
         );
         
         change_state(EDITOR_STATE_DETAILS);
-        select_tree_shadow(problem_shadow_ptr);
+        select_tree_shadow(problem.shadow_ptr);
         center_camera(min_coords, max_coords);
         
         break;
@@ -1747,6 +1892,9 @@ void AreaEditor::handle_line_error() {
 void AreaEditor::load() {
     Editor::load();
     
+    //Areas are about to get edited, so anything preloaded could go stale.
+    game.area_preloader.cancel();
+    
     //Load necessary game content.
     game.content.reload_packs();
     game.content.load_all(
@@ -1890,6 +2038,8 @@ void AreaEditor::load_area_folder(
  * @brief Loads a backup file.
  */
 void AreaEditor::load_backup() {
+    //Make sure the latest backup is done being written.
+    game.file_writer.wait_for_all();
     load_area_folder(
         manifest.path,
         true, false
@@ -2022,16 +2172,56 @@ void AreaEditor::pick_texture(
 }
 
 
+/**
+ * @brief Removes the front entry from the undo or redo history, turning
+ * the checkpoint into the state of the entry that's now in the front.
+ *
+ * @param history History to remove from.
+ * @param checkpoint Checkpoint of that history.
+ */
+void AreaEditor::pop_from_undo_or_redo_history(
+    deque<std::pair<AreaDelta*, string> > &history, Area* &checkpoint
+) {
+    delete history.front().first;
+    history.pop_front();
+    
+    if(history.empty()) {
+        delete checkpoint;
+        checkpoint = nullptr;
+        return;
+    }
+    
+    history.front().first->apply(checkpoint);
+    delete history.front().first;
+    history.front().first = nullptr;
+}
+
+
 /**
  * @brief Prepares an area state to be delivered to register_change() later,
  * or forgotten altogether with forget_prepared_state().
  *
+ * The same area is reused from one preparation to the next, and only
+ * the elements that changed since the last time get copied over.
+ *
  * @return The prepared state.
  */
 Area* AreaEditor::prepare_state() {
-    Area* new_state = new Area();
-    game.cur_area_data->clone(*new_state);
-    return new_state;
+    if(prepared_state_cache_in_use) {
+        //Some other operation is holding on to the cache. Make a full copy.
+        Area* new_state = new Area();
+        game.cur_area_data->clone(*new_state);
+        return new_state;
+    }
+    
+    if(!prepared_state_cache) {
+        prepared_state_cache = new Area();
+        game.cur_area_data->clone(*prepared_state_cache);
+    } else {
+        AreaDelta::sync(prepared_state_cache, game.cur_area_data, nullptr);
+    }
+    prepared_state_cache_in_use = true;
+    return prepared_state_cache;
 }
 
 
@@ -2383,6 +2573,47 @@ void AreaEditor::paste_texture_cmd(float input_value) {
 }
 
 
+/**
+ * @brief Code to run for the performance report command. This saves the
+ * area, and then runs the logic benchmark on it in a separate process, with
+ * the leader walking around, so the editor stays usable in the meantime.
+ * The report is saved in the user data folder, next to the performance log.
+ *
+ * @param input_value Value of the player input for the command.
+ */
+void AreaEditor::perf_report_cmd(float input_value) {
+    if(input_value < 0.5f) return;
+    
+    if(perf_report_time_left > 0.0f) {
+        set_status("A performance report is already being made!", true);
+        return;
+    }
+    if(!save_area(false)) return;
+    
+    al_remove_filename(FILE_PATHS_FROM_ROOT::AREA_PERF_REPORT.c_str());
+    
+    ALLEGRO_PATH* exe_path = al_get_standard_path(ALLEGRO_EXENAME_PATH);
+    string command =
+        "\"" + string(al_path_cstr(exe_path, ALLEGRO_NATIVE_PATH_SEP)) +
+        "\" --benchmark \"" + manifest.path + "\"" +
+        " --benchmark-ticks " +
+        i2s(AREA_EDITOR::PERF_REPORT_DURATION / BENCHMARK::DEF_DELTA_T) +
+        " --benchmark-walk" +
+        " --benchmark-output \"" +
+        FILE_PATHS_FROM_ROOT::AREA_PERF_REPORT + "\"";
+    al_destroy_path(exe_path);
+    
+    if(!run_in_background(command)) {
+        set_status("Could not start making the performance report!", true);
+        return;
+    }
+    perf_report_time_left = AREA_EDITOR::PERF_REPORT_TIMEOUT;
+    set_status(
+        "Making the performance report. This may take a while..."
+    );
+}
+
+
 /**
  * @brief Code to run for the quick play command.
  *
@@ -2963,19 +3194,15 @@ void AreaEditor::redo() {
         return;
     }
     
-    //Let's first save the state of things right now so we can feed it into
-    //the undo history afterwards.
-    Area* new_state = new Area();
-    game.cur_area_data->clone(*new_state);
+    //Let's first feed the state of things right now into the undo history.
     string operation_name = redo_history.front().second;
+    add_to_undo_or_redo_history(
+        undo_history, undo_checkpoint, game.cur_area_data, operation_name
+    );
     
     //Change the area state.
-    set_state_from_undo_or_redo_history(redo_history.front().first);
-    
-    //Feed the previous state into the undo history.
-    undo_history.push_front(make_pair(new_state, operation_name));
-    delete redo_history.front().first;
-    redo_history.pop_front();
+    set_state_from_undo_or_redo_history(redo_checkpoint);
+    pop_from_undo_or_redo_history(redo_history, redo_checkpoint);
     
     set_status("Redo successful: " + operation_name + ".");
 }
@@ -2998,6 +3225,13 @@ void AreaEditor::register_change(
     const string &operation_name, Area* pre_prepared_state
 ) {
     changes_mgr.mark_as_changed();
+    picking_index.outdated = true;
+    picking_index.changed_this_frame = true;
+    
+    //Any change can affect which neighbors a fading sector merges.
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        game.cur_area_data->sectors[s]->invalidate_texture_merge_sectors();
+    }
     
     if(game.options.area_editor.undo_limit == 0) {
         if(pre_prepared_state) {
@@ -3013,17 +3247,23 @@ void AreaEditor::register_change(
         }
     }
     
-    Area* new_state = pre_prepared_state;
-    if(!pre_prepared_state) {
-        new_state = new Area();
-        game.cur_area_data->clone(*new_state);
+    if(pre_prepared_state) {
+        add_to_undo_or_redo_history(
+            undo_history, undo_checkpoint, pre_prepared_state, operation_name
+        );
+        forget_prepared_state(pre_prepared_state);
+    } else {
+        add_to_undo_or_redo_history(
+            undo_history, undo_checkpoint, game.cur_area_data, operation_name
+        );
     }
-    undo_history.push_front(make_pair(new_state, operation_name));
     
     for(size_t h = 0; h < redo_history.size(); h++) {
         delete redo_history[h].first;
     }
     redo_history.clear();
+    delete redo_checkpoint;
+    redo_checkpoint = nullptr;
     
     undo_save_lock_operation = operation_name;
     undo_save_lock_timer.start();
@@ -3080,7 +3320,7 @@ void AreaEditor::reset_cam_zoom() {
  * @param prepared_state Prepared state to return to.
  */
 void AreaEditor::rollback_to_prepared_state(Area* prepared_state) {
-    prepared_state->clone(*(game.cur_area_data));
+    AreaDelta::sync(game.cur_area_data, prepared_state, nullptr);
 }
 
 
@@ -3101,9 +3341,9 @@ bool AreaEditor::save_area(bool to_backup) {
     }
     
     //Store everything into the relevant data nodes.
-    DataNode geometry_file("", "");
+    DataNodeWriter geometry_file;
     DataNode main_data_file("", "");
-    game.cur_area_data->save_geometry_to_data_node(&geometry_file);
+    game.cur_area_data->save_geometry(geometry_file);
     game.cur_area_data->save_main_data_to_data_node(&main_data_file);
     if(game.cur_area_data->type == AREA_TYPE_MISSION) {
         game.cur_area_data->save_mission_data_to_data_node(&main_data_file);
@@ -3129,8 +3369,19 @@ bool AreaEditor::save_area(bool to_backup) {
     string geometry_file_path =
         base_folder_path + "/" + FILE_NAMES::AREA_GEOMETRY;
         
-    bool geo_save_ok = geometry_file.saveFile(geometry_file_path);
-    bool main_data_save_ok = main_data_file.saveFile(main_data_file_path);
+    bool geo_save_ok = true;
+    bool main_data_save_ok = true;
+    if(to_backup) {
+        //Backups happen every so often while the maker is working, so
+        //write them in the background. Failures are reported in do_logic().
+        game.file_writer.write(std::move(geometry_file), geometry_file_path);
+        game.file_writer.write(
+            std::move(main_data_file), main_data_file_path
+        );
+    } else {
+        geo_save_ok = geometry_file.saveFile(geometry_file_path);
+        main_data_save_ok = main_data_file.saveFile(main_data_file_path);
+    }
     
     if(!geo_save_ok || !main_data_save_ok) {
         show_system_message_box(
@@ -3150,6 +3401,21 @@ bool AreaEditor::save_area(bool to_backup) {
         
     }
     
+    //Save the geometry cache, so that loading the area doesn't need to
+    //triangulate everything again. The geometry is loaded back from what
+    //was just saved, so that the cache matches what a load would get.
+    //If this fails, loads just calculate everything, so it's fine.
+    if(geo_save_ok && !to_backup) {
+        Area cache_area;
+        cache_area.load_geometry_from_data_node(
+            &geometry_file, CONTENT_LOAD_LEVEL_EDITOR
+        );
+        cache_area.save_geometry_cache(
+            base_folder_path + "/" + FILE_NAMES::AREA_GEOMETRY_CACHE
+        );
+        cache_area.clear();
+    }
+    
     //Set up some things post-save.
     backup_timer.start(game.options.area_editor.backup_interval);
     
@@ -3430,7 +3696,8 @@ void AreaEditor::set_selection_status_text() {
  * @param state State to load.
  */
 void AreaEditor::set_state_from_undo_or_redo_history(Area* state) {
-    state->clone(*(game.cur_area_data));
+    //Only the elements that differ get replaced.
+    AreaDelta::sync(game.cur_area_data, state, nullptr);
     
     undo_save_lock_timer.stop();
     undo_save_lock_operation.clear();
@@ -3443,6 +3710,8 @@ void AreaEditor::set_state_from_undo_or_redo_history(Area* state) {
     clear_problems();
     
     update_all_edge_offset_caches();
+    picking_index.outdated = true;
+    baked_sector_tiles_outdated = true;
     
     path_preview.clear(); //Clear so it doesn't reference deleted stops.
     path_preview_timer.start(false);
@@ -3717,19 +3986,15 @@ void AreaEditor::undo() {
         return;
     }
     
-    //Let's first save the state of things right now so we can feed it into
-    //the redo history afterwards.
-    Area* new_state = new Area();
-    game.cur_area_data->clone(*new_state);
+    //Let's first feed the state of things right now into the redo history.
     string operation_name = undo_history.front().second;
+    add_to_undo_or_redo_history(
+        redo_history, redo_checkpoint, game.cur_area_data, operation_name
+    );
     
     //Change the area state.
-    set_state_from_undo_or_redo_history(undo_history.front().first);
-    
-    //Feed the previous state into the redo history.
-    redo_history.push_front(make_pair(new_state, operation_name));
-    delete undo_history.front().first;
-    undo_history.pop_front();
+    set_state_from_undo_or_redo_history(undo_checkpoint);
+    pop_from_undo_or_redo_history(undo_history, undo_checkpoint);
     
     set_status("Undo successful: " + operation_name + ".");
 }
@@ -3910,6 +4175,59 @@ void AreaEditor::update_reference() {
 }
 
 
+/**
+ * @brief Updates the edge offset caches of the edges around the
+ * specified sectors. This is a lot cheaper than updating all of them, but
+ * it's only fit for when the area's edges are the same as the last time
+ * all caches were updated, like when only a sector's height changed.
+ *
+ * @param sectors Sectors whose edges need updating.
+ */
+void AreaEditor::update_sector_edge_offset_caches(
+    const set<Sector*> &sectors
+) {
+    size_t nr_edges = game.cur_area_data->edges.size();
+    if(
+        game.wall_smoothing_effect_caches.size() != nr_edges ||
+        game.wall_shadow_effect_caches.size() != nr_edges ||
+        game.liquid_limit_effect_caches.size() != nr_edges
+    ) {
+        update_all_edge_offset_caches();
+        return;
+    }
+    
+    unordered_set<Vertex*> sector_vertexes;
+    for(const Sector* s_ptr : sectors) {
+        for(size_t e = 0; e < s_ptr->edges.size(); e++) {
+            sector_vertexes.insert(s_ptr->edges[e]->vertexes[0]);
+            sector_vertexes.insert(s_ptr->edges[e]->vertexes[1]);
+        }
+    }
+    
+    update_offset_effect_caches(
+        game.wall_smoothing_effect_caches,
+        sector_vertexes,
+        does_edge_have_ledge_smoothing,
+        get_ledge_smoothing_length,
+        get_ledge_smoothing_color
+    );
+    update_offset_effect_caches(
+        game.wall_shadow_effect_caches,
+        sector_vertexes,
+        does_edge_have_wall_shadow,
+        get_wall_shadow_length,
+        get_wall_shadow_color
+    );
+    update_offset_effect_caches(
+        game.liquid_limit_effect_caches,
+        sector_vertexes,
+        does_edge_have_liquid_limit,
+        get_liquid_limit_length,
+        get_liquid_limit_color
+    );
+}
+
+
 /**
  * @brief Updates a sector's texture.
  *
@@ -3919,9 +4237,11 @@ void AreaEditor::update_reference() {
 void AreaEditor::update_sector_texture(
     Sector* s_ptr, const string &internal_name
 ) {
-    game.content.bitmaps.list.free(s_ptr->texture_info.bmp_name);
+    if(s_ptr->texture_info.bitmap != game.sector_textures.get_placeholder()) {
+        game.content.bitmaps.list.free(s_ptr->texture_info.bmp_name);
+    }
     s_ptr->texture_info.bmp_name = internal_name;
-    s_ptr->texture_info.bitmap = game.content.bitmaps.list.get(internal_name);
+    game.sector_textures.request(s_ptr);
 }
 
 
@@ -3959,7 +4279,6 @@ void AreaEditor::update_texture_suggestions(const string &n) {
     }
     
     if(texture_suggestions.size() > AREA_EDITOR::MAX_TEXTURE_SUGGESTIONS) {
-        texture_suggestions[texture_suggestions.size() - 1].destroy();
         texture_suggestions.erase(
             texture_suggestions.begin() + texture_suggestions.size() - 1
         );
@@ -3973,8 +4292,13 @@ void AreaEditor::update_texture_suggestions(const string &n) {
  */
 void AreaEditor::update_undo_history() {
     while(undo_history.size() > game.options.area_editor.undo_limit) {
+        delete undo_history.back().first;
         undo_history.pop_back();
     };
+    if(undo_history.empty() && undo_checkpoint) {
+        delete undo_checkpoint;
+        undo_checkpoint = nullptr;
+    }
 }
 
 
@@ -4019,12 +4343,6 @@ AreaEditor::LayoutDrawingNode::LayoutDrawingNode(
             AREA_EDITOR::VERTEX_MERGE_RADIUS / game.cam.zoom
         );
     if(!merge_vertexes.empty()) {
-        sort(
-            merge_vertexes.begin(), merge_vertexes.end(),
-        [] (std::pair<Distance, Vertex*> v1, std::pair<Distance, Vertex*> v2) -> bool {
-            return v1.first < v2.first;
-        }
-        );
         on_vertex = merge_vertexes[0].second;
         on_vertex_idx = game.cur_area_data->find_vertex_idx(on_vertex);
     }
@@ -4060,6 +4378,183 @@ AreaEditor::LayoutDrawingNode::LayoutDrawingNode() {
 }
 
 
+/**
+ * @brief Rebuilds the index from scratch, using the current area's contents.
+ *
+ * @param ae_ptr Pointer to the area editor instance in charge.
+ */
+void AreaEditor::PickingIndex::build(const AreaEditor* ae_ptr) {
+    Area* area = game.cur_area_data;
+    
+    //Gather everything's bounding box first, to know how big the grid is.
+    //They're in the order vertexes, edges, mobs, stops, and then links.
+    vector<std::pair<Point, Point> > boxes;
+    for(size_t v = 0; v < area->vertexes.size(); v++) {
+        Point v_pos = v2p(area->vertexes[v]);
+        boxes.push_back(std::make_pair(v_pos, v_pos));
+    }
+    for(size_t e = 0; e < area->edges.size(); e++) {
+        Edge* e_ptr = area->edges[e];
+        Point e_min, e_max;
+        if(e_ptr->is_valid()) {
+            e_min = v2p(e_ptr->vertexes[0]);
+            e_max = e_min;
+            update_min_max_coords(e_min, e_max, v2p(e_ptr->vertexes[1]));
+        }
+        boxes.push_back(std::make_pair(e_min, e_max));
+    }
+    for(size_t m = 0; m < area->mob_generators.size(); m++) {
+        MobGen* m_ptr = area->mob_generators[m];
+        float radius = ae_ptr->get_mob_gen_radius(m_ptr);
+        boxes.push_back(
+            std::make_pair(m_ptr->pos - radius, m_ptr->pos + radius)
+        );
+    }
+    for(size_t s = 0; s < area->path_stops.size(); s++) {
+        PathStop* s_ptr = area->path_stops[s];
+        boxes.push_back(
+            std::make_pair(
+                s_ptr->pos - s_ptr->radius, s_ptr->pos + s_ptr->radius
+            )
+        );
+    }
+    for(size_t s = 0; s < area->path_stops.size(); s++) {
+        PathStop* s_ptr = area->path_stops[s];
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            Point l_min = s_ptr->pos;
+            Point l_max = l_min;
+            update_min_max_coords(l_min, l_max, s_ptr->links[l]->end_ptr->pos);
+            boxes.push_back(std::make_pair(l_min, l_max));
+        }
+    }
+    
+    n_things[0] = area->vertexes.size();
+    n_things[1] = area->edges.size();
+    n_things[2] = area->mob_generators.size();
+    n_things[3] = area->path_stops.size();
+    outdated = false;
+    
+    //Set up the grid.
+    n_cols = 0;
+    n_rows = 0;
+    vertexes.clear();
+    edges.clear();
+    mobs.clear();
+    stops.clear();
+    links.clear();
+    if(boxes.empty()) return;
+    
+    Point min_coords = boxes[0].first;
+    Point max_coords = boxes[0].second;
+    for(size_t b = 0; b < boxes.size(); b++) {
+        update_min_max_coords(min_coords, max_coords, boxes[b].first);
+        update_min_max_coords(min_coords, max_coords, boxes[b].second);
+    }
+    const float cell_size = GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    top_left_corner = min_coords;
+    n_cols = floor((max_coords.x - min_coords.x) / cell_size) + 1;
+    n_rows = floor((max_coords.y - min_coords.y) / cell_size) + 1;
+    vertexes.assign(n_cols * n_rows, vector<size_t>());
+    edges.assign(n_cols * n_rows, vector<size_t>());
+    mobs.assign(n_cols * n_rows, vector<size_t>());
+    stops.assign(n_cols * n_rows, vector<size_t>());
+    links.assign(n_cols * n_rows, vector<std::pair<size_t, size_t> >());
+    
+    //Place everything in the cells its bounding box touches.
+    size_t b = 0;
+    const auto add_to_cells =
+    [this, &boxes, &b] (auto &cells, const auto &entry) {
+        size_t col1, col2, row1, row2;
+        get_cells(
+            boxes[b].first, boxes[b].second, &col1, &col2, &row1, &row2
+        );
+        for(size_t r = row1; r <= row2; r++) {
+            for(size_t c = col1; c <= col2; c++) {
+                cells[r * n_cols + c].push_back(entry);
+            }
+        }
+        b++;
+    };
+    
+    for(size_t v = 0; v < area->vertexes.size(); v++) {
+        add_to_cells(vertexes, v);
+    }
+    for(size_t e = 0; e < area->edges.size(); e++) {
+        if(!area->edges[e]->is_valid()) {
+            b++;
+            continue;
+        }
+        add_to_cells(edges, e);
+    }
+    for(size_t m = 0; m < area->mob_generators.size(); m++) {
+        add_to_cells(mobs, m);
+    }
+    for(size_t s = 0; s < area->path_stops.size(); s++) {
+        add_to_cells(stops, s);
+    }
+    for(size_t s = 0; s < area->path_stops.size(); s++) {
+        PathStop* s_ptr = area->path_stops[s];
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            add_to_cells(links, std::make_pair(s, l));
+        }
+    }
+}
+
+
+/**
+ * @brief Returns the range of cells that a rectangle touches.
+ *
+ * @param tl Top-left corner of the rectangle.
+ * @param br Bottom-right corner of the rectangle.
+ * @param out_col1 The first column is returned here.
+ * @param out_col2 The last column is returned here.
+ * @param out_row1 The first row is returned here.
+ * @param out_row2 The last row is returned here.
+ * @return Whether the rectangle touches the grid at all.
+ */
+bool AreaEditor::PickingIndex::get_cells(
+    const Point &tl, const Point &br,
+    size_t* out_col1, size_t* out_col2,
+    size_t* out_row1, size_t* out_row2
+) const {
+    if(n_cols == 0 || n_rows == 0) return false;
+    
+    const float cell_size = GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    float col1 = floor((tl.x - top_left_corner.x) / cell_size);
+    float col2 = floor((br.x - top_left_corner.x) / cell_size);
+    float row1 = floor((tl.y - top_left_corner.y) / cell_size);
+    float row2 = floor((br.y - top_left_corner.y) / cell_size);
+    if(
+        col2 < 0 || row2 < 0 ||
+        col1 >= (float) n_cols || row1 >= (float) n_rows
+    ) {
+        return false;
+    }
+    
+    *out_col1 = (size_t) std::max(col1, 0.0f);
+    *out_col2 = (size_t) std::min(col2, (float) (n_cols - 1));
+    *out_row1 = (size_t) std::max(row1, 0.0f);
+    *out_row2 = (size_t) std::min(row2, (float) (n_rows - 1));
+    return true;
+}
+
+
+/**
+ * @brief Returns whether the index needs to be rebuilt before it can be used.
+ *
+ * @return Whether it's outdated.
+ */
+bool AreaEditor::PickingIndex::is_outdated() const {
+    if(outdated) return true;
+    Area* area = game.cur_area_data;
+    return
+        n_things[0] != area->vertexes.size() ||
+        n_things[1] != area->edges.size() ||
+        n_things[2] != area->mob_generators.size() ||
+        n_things[3] != area->path_stops.size();
+}
+
+
 /**
  * @brief Constructs a new texture suggestion object.
  *
@@ -4068,16 +4563,6 @@ AreaEditor::LayoutDrawingNode::LayoutDrawingNode() {
 AreaEditor::TextureSuggestion::TextureSuggestion(
     const string &n
 ) :
-    bmp(nullptr),
     name(n) {
     
-    bmp = game.content.bitmaps.list.get(name, nullptr, false);
-}
-
-
-/**
- * @brief Destroys a texture suggestion.
- */
-void AreaEditor::TextureSuggestion::destroy() {
-    game.content.bitmaps.list.free(name);
 }
@@ -15,6 +15,7 @@
 #include "../editor.h"
 
 #include "../../content/area/area.h"
+#include "../../content/area/area_delta.h"
 #include "../../lib/imgui/imgui_impl_allegro5.h"
 #include "../../util/general_utils.h"
 
@@ -25,6 +26,7 @@ using std::string;
 
 
 namespace AREA_EDITOR {
+extern const int BAKED_SECTOR_TILE_SIZE;
 extern const ALLEGRO_COLOR BLOCKING_COLOR;
 extern const float COMFY_DIST;
 extern const float CROSS_SECTION_POINT_RADIUS;
@@ -45,6 +47,8 @@ extern const ALLEGRO_COLOR NON_BLOCKING_COLOR;
 extern const float PATH_LINK_THICKNESS;
 extern const float PATH_PREVIEW_CHECKPOINT_RADIUS;
 extern const float PATH_PREVIEW_TIMER_DUR;
+extern const float PERF_REPORT_DURATION;
+extern const float PERF_REPORT_TIMEOUT;
 extern const float POINT_LETTER_TEXT_SCALE;
 extern const float REFERENCE_MIN_SIZE;
 extern const float QUICK_PREVIEW_DURATION;
@@ -134,8 +138,10 @@ public:
     void load() override;
     void unload() override;
     string get_name() const override;
+    bool can_idle() const override;
     void draw_canvas();
     string get_opened_content_path() const;
+    size_t get_undo_history_memory_usage() const;
     
 private:
 
@@ -146,9 +152,6 @@ private:
     
         //--- Members ---
         
-        //Bitmap of the texture.
-        ALLEGRO_BITMAP* bmp = nullptr;
-        
         //Internal name of the texture.
         string name;
         
@@ -156,7 +159,6 @@ private:
         //--- Function declarations ---
         
         explicit TextureSuggestion(const string &n);
-        void destroy();
         
     };
     
@@ -234,6 +236,104 @@ private:
         
     };
     
+    /**
+     * @brief A grid that knows which vertexes, edges, objects, path stops,
+     * and path links are in each of its cells, so that finding what's under
+     * the cursor doesn't need to check every single thing in the area.
+     * It saves indexes instead of pointers, so an outdated index can only
+     * ever cause a miss, never a dangling pointer.
+     */
+    struct PickingIndex {
+    
+        //--- Members ---
+        
+        //Does it need to be rebuilt before the next query?
+        bool outdated = true;
+        
+        //Was the area changed this frame? Changes can happen after the
+        //change is registered, so the index must be rebuilt again later.
+        bool changed_this_frame = false;
+        
+        //Top-left corner of the grid.
+        Point top_left_corner;
+        
+        //Number of columns.
+        size_t n_cols = 0;
+        
+        //Number of rows.
+        size_t n_rows = 0;
+        
+        //Indexes of the vertexes in each cell.
+        vector<vector<size_t> > vertexes;
+        
+        //Indexes of the edges in each cell.
+        vector<vector<size_t> > edges;
+        
+        //Indexes of the mob generators in each cell.
+        vector<vector<size_t> > mobs;
+        
+        //Indexes of the path stops in each cell.
+        vector<vector<size_t> > stops;
+        
+        //Path links in each cell, as their stop index and link index.
+        vector<vector<std::pair<size_t, size_t> > > links;
+        
+        //Number of vertexes, edges, mobs, and stops at the time of the build.
+        size_t n_things[4] = { 0, 0, 0, 0 };
+        
+        
+        //--- Function declarations ---
+        
+        void build(const AreaEditor* ae_ptr);
+        bool get_cells(
+            const Point &tl, const Point &br,
+            size_t* out_col1, size_t* out_col2,
+            size_t* out_row1, size_t* out_row2
+        ) const;
+        bool is_outdated() const;
+        
+        
+        //--- Function definitions ---
+        
+        /**
+         * @brief Returns the first thing in some cells that passes a check.
+         * Cells only have some of the area's things, and in no particular
+         * order, but the one returned is still the one that comes first in
+         * the area's list, so it's the same one a check of every single
+         * thing would return.
+         *
+         * @tparam t Type of the cells' entries. Entries are compared with <.
+         * @param cells Cells of the kind of thing to check.
+         * @param col1 First column to check.
+         * @param col2 Last column to check.
+         * @param row1 First row to check.
+         * @param row2 Last row to check.
+         * @param none Value to return if nothing passes. It must compare
+         * as greater than every entry.
+         * @param check Returns whether an entry passes.
+         * @return The entry, or none.
+         */
+        template<typename t>
+        t get_first_hit(
+            const vector<vector<t> > &cells,
+            size_t col1, size_t col2, size_t row1, size_t row2,
+            const t &none, const std::function<bool(const t &)> &check
+        ) const {
+            t best = none;
+            for(size_t r = row1; r <= row2; r++) {
+                for(size_t c = col1; c <= col2; c++) {
+                    const vector<t> &cell = cells[r * n_cols + c];
+                    for(size_t i = 0; i < cell.size(); i++) {
+                        if(!(cell[i] < best)) continue;
+                        if(check(cell[i])) best = cell[i];
+                    }
+                }
+            }
+            return best;
+        }
+        
+    };
+    
     //Possible results after a line drawing operation.
     enum DRAWING_LINE_RESULT {
     
@@ -345,6 +445,62 @@ private:
         
     };
     
+    //Parts of the area that the problem checks read from.
+    enum PROBLEM_DATA {
+    
+        //Vertexes, edges, and sectors.
+        PROBLEM_DATA_LAYOUT,
+        
+        //Object generators.
+        PROBLEM_DATA_MOBS,
+        
+        //Path stops and links.
+        PROBLEM_DATA_PATHS,
+        
+        //Tree shadows.
+        PROBLEM_DATA_SHADOWS,
+        
+        //Total amount of problem data parts.
+        N_PROBLEM_DATA,
+        
+    };
+    
+    /**
+     * @brief Info about a problem found in the area.
+     */
+    struct ProblemInfo {
+    
+        //--- Members ---
+        
+        //Type of problem. EPT_NONE_YET if the check didn't run.
+        EPT type = EPT_NONE_YET;
+        
+        //Title of the problem.
+        string title;
+        
+        //Description of the problem.
+        string description;
+        
+        //Information about the problematic intersecting edges, if any.
+        EdgeIntersection edge_intersection = EdgeIntersection(nullptr, nullptr);
+        
+        //Pointer to the problematic mob, if any.
+        MobGen* mob_ptr = nullptr;
+        
+        //Pointer to the problematic path stop, if any.
+        PathStop* path_stop_ptr = nullptr;
+        
+        //Pointer to the problematic sector, if any.
+        Sector* sector_ptr = nullptr;
+        
+        //Pointer to the problematic tree shadow, if any.
+        TreeShadow* shadow_ptr = nullptr;
+        
+        //Pointer to the problematic vertex, if any.
+        Vertex* vertex_ptr = nullptr;
+        
+    };
+    
     //Editor states.
     enum EDITOR_STATE {
     
@@ -469,6 +625,19 @@ private:
     
     //--- Members ---
     
+    //Tiles with the baked sector textures, as they look at a certain zoom
+    //level. The key is the column and row. nullptr if the tile is empty.
+    map<std::pair<int, int>, ALLEGRO_BITMAP*> baked_sector_tiles;
+    
+    //Sector texture opacity the baked sector tiles were made with.
+    float baked_sector_tiles_opacity = 0.0f;
+    
+    //Were the sectors changed since the tiles were baked?
+    bool baked_sector_tiles_outdated = true;
+    
+    //Camera zoom level the baked sector tiles were made for.
+    float baked_sector_tiles_zoom = 0.0f;
+    
     //Time left until a backup is generated.
     Timer backup_timer;
     
@@ -655,6 +824,14 @@ private:
     //Only calculate the preview path when this time is up.
     Timer path_preview_timer;
     
+    //How much longer to wait for the performance report to be saved.
+    //0 if none is being made.
+    float perf_report_time_left = 0.0f;
+    
+    //Spatial index used to find what's under the cursor. It gets rebuilt
+    //by the const "under point" functions, hence it being mutable.
+    mutable PickingIndex picking_index;
+    
     //Area data before vertex movement.
     Area* pre_move_area_data = nullptr;
     
@@ -667,38 +844,28 @@ private:
     //Position of the selected vertexes before movement.
     map<Vertex*, Point> pre_move_vertex_coords;
     
+    //Area state handed out by prepare_state(). It's kept between operations
+    //and only brought up to date with what changed since, instead of
+    //being copied from scratch every time.
+    Area* prepared_state_cache = nullptr;
+    
+    //Is the prepared state cache currently handed out?
+    bool prepared_state_cache_in_use = false;
+    
     //Is preview mode on?
     bool preview_mode = false;
     
     //Name of the area song we're previewing, if any.
     string preview_song;
     
-    //Description of the current problem found.
-    string problem_description;
-    
-    //Information about the problematic intersecting edges, if any.
-    EdgeIntersection problem_edge_intersection = EdgeIntersection(nullptr, nullptr);
-    
-    //Pointer to the problematic mob, if any.
-    MobGen* problem_mob_ptr = nullptr;
-    
-    //Pointer to the problematic path stop, if any.
-    PathStop* problem_path_stop_ptr = nullptr;
-    
-    //Type of the current problem found in the review panel.
-    EPT problem_type = EPT_NONE_YET;
+    //Current problem found in the review panel.
+    ProblemInfo problem;
     
-    //Pointer to the problematic sector, if any.
-    Sector* problem_sector_ptr = nullptr;
+    //Result of each problem check the last time it ran, in check order.
+    vector<ProblemInfo> problem_check_results;
     
-    //Pointer to the problematic tree shadow, if any.
-    TreeShadow* problem_shadow_ptr = nullptr;
-    
-    //Title of the current problem found.
-    string problem_title;
-    
-    //Pointer to the problematic vertex, if any.
-    Vertex* problem_vertex_ptr = nullptr;
+    //Fingerprint of each part of the area the last time problems were found.
+    uint64_t problem_data_fingerprints[N_PROBLEM_DATA] = { 0, 0, 0, 0 };
     
     //Sector heights when the quick height set mode was entered.
     map<Sector*, float> quick_height_set_start_heights;
@@ -709,8 +876,13 @@ private:
     //Time left in the quick preview mode, including fade out.
     Timer quick_preview_timer = Timer(AREA_EDITOR::QUICK_PREVIEW_DURATION);
     
-    //Redo history, with the state of the area at each point. Front = latest.
-    deque<std::pair<Area*, string> > redo_history;
+    //Full copy of the area state at the front of the redo history, if any.
+    Area* redo_checkpoint = nullptr;
+    
+    //Redo history, with the name of each operation. Front = latest.
+    //The front's state is redo_checkpoint. Every other entry has what
+    //changed between its state and the state in front of it.
+    deque<std::pair<AreaDelta*, string> > redo_history;
     
     //Opacity of the reference image.
     unsigned char reference_alpha = 255;
@@ -832,8 +1004,13 @@ private:
     //Was the area's thumbnail changed in any way since the last backup save?
     bool thumbnail_backup_needs_saving = false;
     
-    //Undo history, with the state of the area at each point. Front = latest.
-    deque<std::pair<Area*, string> > undo_history;
+    //Full copy of the area state at the front of the undo history, if any.
+    Area* undo_checkpoint = nullptr;
+    
+    //Undo history, with the name of each operation. Front = latest.
+    //The front's state is undo_checkpoint. Every other entry has what
+    //changed between its state and the state in front of it.
+    deque<std::pair<AreaDelta*, string> > undo_history;
     
     //Name of the undo operation responsible for the lock.
     string undo_save_lock_operation;
@@ -869,6 +1046,10 @@ private:
     
     //--- Function declarations ---
     
+    void add_to_undo_or_redo_history(
+        deque<std::pair<AreaDelta*, string> > &history, Area* &checkpoint,
+        Area* state, const string &operation_name
+    );
     bool are_nodes_traversable(
         const LayoutDrawingNode &n1,
         const LayoutDrawingNode &n2
@@ -883,6 +1064,7 @@ private:
     float calculate_preview_path();
     void change_state(const EDITOR_STATE new_state);
     void check_drawing_line(const Point &pos);
+    void clear_baked_sector_tiles();
     void clear_circle_sector();
     void clear_current_area();
     void clear_layout_drawing();
@@ -913,27 +1095,27 @@ private:
     );
     string find_good_first_texture();
     void find_problems();
-    void find_problems_bridge_path();
-    void find_problems_intersecting_edge();
-    void find_problems_lone_edge();
-    void find_problems_lone_path_stop();
-    void find_problems_missing_leader();
-    void find_problems_missing_texture();
-    void find_problems_mob_inside_walls();
-    void find_problems_mob_links_to_self();
-    void find_problems_mob_stored_in_loop();
-    void find_problems_no_goal_mob();
-    void find_problems_no_score_criteria();
-    void find_problems_non_simple_sector();
-    void find_problems_oob_mob();
-    void find_problems_oob_path_stop();
-    void find_problems_overlapping_vertex();
-    void find_problems_path_stop_on_link();
-    void find_problems_path_stops_intersecting();
-    void find_problems_pikmin_over_limit();
-    void find_problems_typeless_mob();
-    void find_problems_unknown_texture();
-    void find_problems_unknown_tree_shadow();
+    void find_problems_bridge_path(ProblemInfo &out) const;
+    void find_problems_intersecting_edge(ProblemInfo &out) const;
+    void find_problems_lone_edge(ProblemInfo &out) const;
+    void find_problems_lone_path_stop(ProblemInfo &out) const;
+    void find_problems_missing_leader(ProblemInfo &out) const;
+    void find_problems_missing_texture(ProblemInfo &out) const;
+    void find_problems_mob_inside_walls(ProblemInfo &out) const;
+    void find_problems_mob_links_to_self(ProblemInfo &out) const;
+    void find_problems_mob_stored_in_loop(ProblemInfo &out) const;
+    void find_problems_no_goal_mob(ProblemInfo &out) const;
+    void find_problems_no_score_criteria(ProblemInfo &out) const;
+    void find_problems_non_simple_sector(ProblemInfo &out) const;
+    void find_problems_oob_mob(ProblemInfo &out) const;
+    void find_problems_oob_path_stop(ProblemInfo &out) const;
+    void find_problems_overlapping_vertex(ProblemInfo &out) const;
+    void find_problems_path_stop_on_link(ProblemInfo &out) const;
+    void find_problems_path_stops_intersecting(ProblemInfo &out) const;
+    void find_problems_pikmin_over_limit(ProblemInfo &out) const;
+    void find_problems_typeless_mob(ProblemInfo &out) const;
+    void find_problems_unknown_texture(ProblemInfo &out) const;
+    void find_problems_unknown_tree_shadow(ProblemInfo &out) const;
     void finish_circle_sector();
     void finish_layout_moving();
     void finish_new_sector_drawing();
@@ -967,7 +1149,9 @@ private:
     string get_folder_tooltip(
         const string &path, const string &user_data_path
     ) const;
-    vector<EdgeIntersection> get_intersecting_edges() const;
+    vector<EdgeIntersection> get_intersecting_edges(
+        const set<Edge*>* only_edges = nullptr
+    ) const;
     size_t get_mission_required_mob_count() const;
     float get_mob_gen_radius(MobGen* m) const;
     bool get_mob_link_under_point(
@@ -982,6 +1166,9 @@ private:
         const Point &p, PathLink** link1, PathLink** link2
     ) const;
     PathStop* get_path_stop_under_point(const Point &p) const;
+    void get_problem_data_fingerprints(
+        uint64_t out_fingerprints[N_PROBLEM_DATA]
+    ) const;
     float get_quick_height_set_offset() const;
     SECTOR_SPLIT_RESULT get_sector_split_evaluation();
     Sector* get_sector_under_point(const Point &p) const;
@@ -1009,6 +1196,9 @@ private:
     void paste_path_link_properties();
     void paste_sector_properties();
     void paste_sector_texture();
+    void pop_from_undo_or_redo_history(
+        deque<std::pair<AreaDelta*, string> > &history, Area* &checkpoint
+    );
     Area* prepare_state();
     void recreate_drawing_nodes();
     void redo();
@@ -1060,6 +1250,7 @@ private:
     );
     void update_reference();
     void update_layout_drawing_status_text();
+    void update_sector_edge_offset_caches(const set<Sector*> &sectors);
     void update_sector_texture(Sector* s_ptr, const string &internal_name);
     void update_texture_suggestions(const string &n);
     void update_undo_history();
@@ -1069,6 +1260,7 @@ private:
         float start_offset, float end_offset,
         float thickness, const ALLEGRO_COLOR &color
     );
+    void draw_baked_sector_textures(float opacity);
     static void draw_canvas_imgui_callback(
         const ImDrawList* parent_list, const ImDrawCmd* cmd
     );
@@ -1112,6 +1304,7 @@ private:
     void new_tree_shadow_cmd(float input_value);
     void paste_properties_cmd(float input_value);
     void paste_texture_cmd(float input_value);
+    void perf_report_cmd(float input_value);
     void quick_play_cmd(float input_value);
     void quit_cmd(float input_value);
     void redo_cmd(float input_value);
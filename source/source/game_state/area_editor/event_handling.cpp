@@ -1865,7 +1865,7 @@ void AreaEditor::handle_mouse_update(const ALLEGRO_EVENT &ev) {
         for(auto &s : selected_sectors) {
             s->z = quick_height_set_start_heights[s] + offset;
         }
-        update_all_edge_offset_caches();
+        update_sector_edge_offset_caches(selected_sectors);
     }
 }
 
@@ -10,6 +10,8 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 
 #include "editor.h"
 
@@ -671,87 +673,158 @@ string AreaEditor::find_good_first_texture() {
 /**
  * @brief Tries to find problems with the area.
  * When it's done, sets the appropriate problem-related variables.
+ *
+ * The checks run on the job pool at the same time, and the problem that's
+ * reported is the one from the check with the highest priority. Once a check
+ * finds a problem, the lower priority checks that haven't started yet are
+ * skipped. A check's result is also kept for next time, until one of the
+ * parts of the area it reads from changes.
  */
 void AreaEditor::find_problems() {
-    //First, clear any problem info.
-    clear_problems();
-    
-    //Now, check for each of the clauses.
-    find_problems_intersecting_edge();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_overlapping_vertex();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_non_simple_sector();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_lone_edge();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_missing_leader();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_typeless_mob();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_oob_mob();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_mob_inside_walls();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_mob_links_to_self();
-    if(problem_type != EPT_NONE_YET) return;
+    /**
+     * @brief One of the checks, in the list of checks.
+     */
+    struct ProblemCheck {
     
-    find_problems_mob_stored_in_loop();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_pikmin_over_limit();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_bridge_path();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_oob_path_stop();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_lone_path_stop();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_path_stop_on_link();
-    if(problem_type != EPT_NONE_YET) return;
-    
-    find_problems_missing_texture();
-    if(problem_type != EPT_NONE_YET) return;
+        //--- Members ---
+        
+        //Function that runs the check.
+        void (AreaEditor::*func)(ProblemInfo &out) const;
+        
+        //Bitmask of the PROBLEM_DATA parts it reads from.
+        //0 means it reads from other things too, so it always runs.
+        unsigned char data;
+        
+        //Can it run on a worker thread?
+        bool thread_safe;
+        
+    };
+    
+    const unsigned char layout = 1 << PROBLEM_DATA_LAYOUT;
+    const unsigned char mobs = 1 << PROBLEM_DATA_MOBS;
+    const unsigned char paths = 1 << PROBLEM_DATA_PATHS;
+    const unsigned char shadows = 1 << PROBLEM_DATA_SHADOWS;
+    
+    //All checks, from highest to lowest priority.
+    const vector<ProblemCheck> checks = {
+        { &AreaEditor::find_problems_intersecting_edge, layout, true },
+        { &AreaEditor::find_problems_overlapping_vertex, layout, true },
+        { &AreaEditor::find_problems_non_simple_sector, layout, true },
+        { &AreaEditor::find_problems_lone_edge, layout, true },
+        { &AreaEditor::find_problems_missing_leader, mobs, true },
+        { &AreaEditor::find_problems_typeless_mob, mobs, true },
+        { &AreaEditor::find_problems_oob_mob, mobs | layout, true },
+        { &AreaEditor::find_problems_mob_inside_walls, mobs | layout, true },
+        { &AreaEditor::find_problems_mob_links_to_self, mobs, true },
+        { &AreaEditor::find_problems_mob_stored_in_loop, mobs, true },
+        { &AreaEditor::find_problems_pikmin_over_limit, 0, true },
+        //Path calculations use the path manager's caches, so this one
+        //can't run on a worker thread.
+        { &AreaEditor::find_problems_bridge_path, 0, false },
+        { &AreaEditor::find_problems_oob_path_stop, paths | layout, true },
+        { &AreaEditor::find_problems_lone_path_stop, paths, true },
+        { &AreaEditor::find_problems_path_stop_on_link, paths, true },
+        { &AreaEditor::find_problems_missing_texture, layout, true },
+        { &AreaEditor::find_problems_unknown_texture, 0, true },
+        { &AreaEditor::find_problems_path_stops_intersecting, paths, true },
+        { &AreaEditor::find_problems_unknown_tree_shadow, shadows, true },
+        { &AreaEditor::find_problems_no_goal_mob, 0, true },
+        { &AreaEditor::find_problems_no_score_criteria, 0, true },
+    };
     
-    find_problems_unknown_texture();
-    if(problem_type != EPT_NONE_YET) return;
+    //First, clear any problem info.
+    clear_problems();
     
-    find_problems_path_stops_intersecting();
-    if(problem_type != EPT_NONE_YET) return;
+    //Forget the results of the checks whose data changed since last time.
+    uint64_t fingerprints[N_PROBLEM_DATA];
+    get_problem_data_fingerprints(fingerprints);
+    unsigned char changed_data = 0;
+    for(size_t d = 0; d < N_PROBLEM_DATA; d++) {
+        if(fingerprints[d] != problem_data_fingerprints[d]) {
+            changed_data |= 1 << d;
+            problem_data_fingerprints[d] = fingerprints[d];
+        }
+    }
+    problem_check_results.resize(checks.size());
+    for(size_t c = 0; c < checks.size(); c++) {
+        if(checks[c].data == 0 || (checks[c].data & changed_data) != 0) {
+            problem_check_results[c] = ProblemInfo();
+        }
+    }
     
-    find_problems_unknown_tree_shadow();
-    if(problem_type != EPT_NONE_YET) return;
+    //Only the checks before the first problem already known need to run.
+    size_t first_problem_idx = checks.size();
+    for(size_t c = 0; c < checks.size(); c++) {
+        EPT type = problem_check_results[c].type;
+        if(type != EPT_NONE_YET && type != EPT_NONE) {
+            first_problem_idx = c;
+            break;
+        }
+    }
+    vector<size_t> parallel_checks;
+    vector<size_t> serial_checks;
+    for(size_t c = 0; c < first_problem_idx; c++) {
+        if(problem_check_results[c].type != EPT_NONE_YET) continue;
+        if(checks[c].thread_safe) {
+            parallel_checks.push_back(c);
+        } else {
+            serial_checks.push_back(c);
+        }
+    }
     
-    find_problems_no_goal_mob();
-    if(problem_type != EPT_NONE_YET) return;
+    //Now, run them. The area is not touched while they do.
+    //A check that gets skipped stays as EPT_NONE_YET, so it runs next time.
+    std::atomic<size_t> first_found_idx(first_problem_idx);
+    const auto run_check = [this, &checks, &first_found_idx] (size_t c) {
+        if(c > first_found_idx.load()) return;
+        ProblemInfo &result = problem_check_results[c];
+        (this->*checks[c].func)(result);
+        if(result.type == EPT_NONE_YET) {
+            result.type = EPT_NONE;
+            return;
+        }
+        size_t cur_first = first_found_idx.load();
+        while(
+            c < cur_first &&
+            !first_found_idx.compare_exchange_weak(cur_first, c)
+        ) {
+        }
+    };
+    game.jobs.parallel_for(
+        parallel_checks.size(), 1,
+    [&parallel_checks, &run_check] (size_t start, size_t end) {
+        for(size_t p = start; p < end; p++) {
+            run_check(parallel_checks[p]);
+        }
+    }
+    );
+    for(size_t s = 0; s < serial_checks.size(); s++) {
+        run_check(serial_checks[s]);
+    }
     
-    find_problems_no_score_criteria();
-    if(problem_type != EPT_NONE_YET) return;
+    //Report the problem with the highest priority.
+    for(size_t c = 0; c < checks.size(); c++) {
+        EPT type = problem_check_results[c].type;
+        if(type != EPT_NONE_YET && type != EPT_NONE) {
+            problem = problem_check_results[c];
+            return;
+        }
+    }
     
     //All good!
-    problem_type = EPT_NONE;
-    problem_title = "None!";
-    problem_description.clear();
+    problem.type = EPT_NONE;
+    problem.title = "None!";
+    problem.description.clear();
 }
 
 
 /**
  * @brief Checks for any pile-to-bridge paths blocked by said bridge in the
  * area, and fills the problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_bridge_path() {
+void AreaEditor::find_problems_bridge_path(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
         if(!m_ptr->type) continue;
@@ -786,11 +859,11 @@ void AreaEditor::find_problems_bridge_path() {
                         path[s]->pos
                     )
                 ) {
-                    problem_mob_ptr = m_ptr->links[l];
-                    problem_type = EPT_PILE_BRIDGE_PATH;
-                    problem_title =
+                    out.mob_ptr = m_ptr->links[l];
+                    out.type = EPT_PILE_BRIDGE_PATH;
+                    out.title =
                         "Bridge is blocking the path to itself!";
-                    problem_description =
+                    out.description =
                         "The path Pikmin must take from a pile to this "
                         "bridge is blocked by the unbuilt bridge object "
                         "itself. Move the path stop to some place a bit "
@@ -806,8 +879,10 @@ void AreaEditor::find_problems_bridge_path() {
 /**
  * @brief Checks for any intersecting edges in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_intersecting_edge() {
+void AreaEditor::find_problems_intersecting_edge(ProblemInfo &out) const {
     vector<EdgeIntersection> intersections = get_intersecting_edges();
     if(!intersections.empty()) {
         float r;
@@ -826,10 +901,10 @@ void AreaEditor::find_problems_intersecting_edge() {
             v2p(ei_ptr->e1->vertexes[0]), v2p(ei_ptr->e1->vertexes[1])
         );
         
-        problem_edge_intersection = *intersections.begin();
-        problem_type = EPT_INTERSECTING_EDGES;
-        problem_title = "Two edges cross each other!";
-        problem_description =
+        out.edge_intersection = *intersections.begin();
+        out.type = EPT_INTERSECTING_EDGES;
+        out.title = "Two edges cross each other!";
+        out.description =
             "They cross at (" +
             f2s(
                 floor(ei_ptr->e1->vertexes[0]->x + cos(a) * r *
@@ -845,12 +920,14 @@ void AreaEditor::find_problems_intersecting_edge() {
 /**
  * @brief Checks for any lone edges in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_lone_edge() {
+void AreaEditor::find_problems_lone_edge(ProblemInfo &out) const {
     if(!game.cur_area_data->problems.lone_edges.empty()) {
-        problem_type = EPT_LONE_EDGE;
-        problem_title = "Lone edge!";
-        problem_description =
+        out.type = EPT_LONE_EDGE;
+        out.title = "Lone edge!";
+        out.description =
             "Likely leftover of something that went wrong. "
             "You probably want to drag one vertex into the other.";
     }
@@ -860,8 +937,10 @@ void AreaEditor::find_problems_lone_edge() {
 /**
  * @brief Checks for any lone path stops in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_lone_path_stop() {
+void AreaEditor::find_problems_lone_path_stop(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
         bool has_link = false;
@@ -881,10 +960,10 @@ void AreaEditor::find_problems_lone_path_stop() {
         }
         
         if(!has_link) {
-            problem_path_stop_ptr = s_ptr;
-            problem_type = EPT_LONE_PATH_STOP;
-            problem_title = "Lone path stop!";
-            problem_description =
+            out.path_stop_ptr = s_ptr;
+            out.type = EPT_LONE_PATH_STOP;
+            out.title = "Lone path stop!";
+            out.description =
                 "Either connect it to another stop, or delete it.";
             return;
         }
@@ -895,8 +974,10 @@ void AreaEditor::find_problems_lone_path_stop() {
 /**
  * @brief Checks for any missing leaders in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_missing_leader() {
+void AreaEditor::find_problems_missing_leader(ProblemInfo &out) const {
     bool has_leader = false;
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         if(
@@ -909,9 +990,9 @@ void AreaEditor::find_problems_missing_leader() {
         }
     }
     if(!has_leader) {
-        problem_type = EPT_MISSING_LEADER;
-        problem_title = "No leader!";
-        problem_description =
+        out.type = EPT_MISSING_LEADER;
+        out.title = "No leader!";
+        out.description =
             "You need at least one leader to actually play.";
     }
 }
@@ -920,8 +1001,10 @@ void AreaEditor::find_problems_missing_leader() {
 /**
  * @brief Checks for any missing texture in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_missing_texture() {
+void AreaEditor::find_problems_missing_texture(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
         Sector* s_ptr = game.cur_area_data->sectors[s];
         if(s_ptr->edges.empty()) continue;
@@ -930,10 +1013,10 @@ void AreaEditor::find_problems_missing_texture() {
             s_ptr->texture_info.bmp_name.empty() &&
             !s_ptr->is_bottomless_pit && !s_ptr->fade
         ) {
-            problem_sector_ptr = s_ptr;
-            problem_type = EPT_UNKNOWN_TEXTURE;
-            problem_title = "Sector with missing texture!";
-            problem_description =
+            out.sector_ptr = s_ptr;
+            out.type = EPT_UNKNOWN_TEXTURE;
+            out.title = "Sector with missing texture!";
+            out.description =
                 "Give it a valid texture.";
             return;
         }
@@ -944,8 +1027,10 @@ void AreaEditor::find_problems_missing_texture() {
 /**
  * @brief Checks for any mobs are inside walls in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_mob_inside_walls() {
+void AreaEditor::find_problems_mob_inside_walls(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
         if(!m_ptr->type) continue;
@@ -1017,10 +1102,10 @@ void AreaEditor::find_problems_mob_inside_walls() {
                 }
                 
                 if(in_wall) {
-                    problem_mob_ptr = m_ptr;
-                    problem_type = EPT_MOB_IN_WALL;
-                    problem_title = "Mob stuck in wall!";
-                    problem_description =
+                    out.mob_ptr = m_ptr;
+                    out.type = EPT_MOB_IN_WALL;
+                    out.title = "Mob stuck in wall!";
+                    out.description =
                         "This object should not be stuck inside of a wall. "
                         "Move it to somewhere where it has more space.";
                     return;
@@ -1034,16 +1119,18 @@ void AreaEditor::find_problems_mob_inside_walls() {
 /**
  * @brief Checks for any mob that links to itself in the area, and fills
  * the problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_mob_links_to_self() {
+void AreaEditor::find_problems_mob_links_to_self(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
         for(size_t l = 0; l < m_ptr->links.size(); l++) {
             if(m_ptr->links[l] == m_ptr) {
-                problem_mob_ptr = m_ptr;
-                problem_type = EPT_MOB_LINKS_TO_SELF;
-                problem_title = "Mob links to itself!";
-                problem_description =
+                out.mob_ptr = m_ptr;
+                out.type = EPT_MOB_LINKS_TO_SELF;
+                out.title = "Mob links to itself!";
+                out.description =
                     "This object has a link to itself. This will likely "
                     "cause unexpected behaviors, so you should delete "
                     "the link.";
@@ -1057,8 +1144,10 @@ void AreaEditor::find_problems_mob_links_to_self() {
 /**
  * @brief Checks for any mobs stored in other mobs in a loop in the area,
  * and fills the problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_mob_stored_in_loop() {
+void AreaEditor::find_problems_mob_stored_in_loop(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
         if(m_ptr->stored_inside == INVALID) continue;
@@ -1068,10 +1157,10 @@ void AreaEditor::find_problems_mob_stored_in_loop() {
         while(next_idx != INVALID) {
             MobGen* next_ptr = game.cur_area_data->mob_generators[next_idx];
             if(visited_mobs.find(next_ptr) != visited_mobs.end()) {
-                problem_mob_ptr = next_ptr;
-                problem_type = EPT_MOB_STORED_IN_LOOP;
-                problem_title = "Mobs stored in a loop!";
-                problem_description =
+                out.mob_ptr = next_ptr;
+                out.type = EPT_MOB_STORED_IN_LOOP;
+                out.title = "Mobs stored in a loop!";
+                out.description =
                     "This object is stored inside of another object, which "
                     "in turn is inside of another...and eventually, "
                     "one of the objects in this chain is stored inside of the "
@@ -1090,8 +1179,10 @@ void AreaEditor::find_problems_mob_stored_in_loop() {
 /**
  * @brief Checks for any missing mission goal mob in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_no_goal_mob() {
+void AreaEditor::find_problems_no_goal_mob(ProblemInfo &out) const {
     if(
         game.cur_area_data->type == AREA_TYPE_MISSION &&
         (
@@ -1101,9 +1192,9 @@ void AreaEditor::find_problems_no_goal_mob() {
         )
     ) {
         if(get_mission_required_mob_count() == 0) {
-            problem_type = EPT_NO_GOAL_MOBS;
-            problem_title = "No mission goal mobs!";
-            problem_description =
+            out.type = EPT_NO_GOAL_MOBS;
+            out.title = "No mission goal mobs!";
+            out.description =
                 "This mission's goal requires some mobs, yet there are none.";
             return;
         }
@@ -1114,8 +1205,10 @@ void AreaEditor::find_problems_no_goal_mob() {
 /**
  * @brief Checks for any missing mission score criterion in the area, and
  * fills the problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_no_score_criteria() {
+void AreaEditor::find_problems_no_score_criteria(ProblemInfo &out) const {
     if(
         game.cur_area_data->type == AREA_TYPE_MISSION &&
         game.cur_area_data->mission.grading_mode == MISSION_GRADING_MODE_POINTS
@@ -1132,9 +1225,9 @@ void AreaEditor::find_problems_no_score_criteria() {
             }
         }
         if(!has_any_criterion) {
-            problem_type = EPT_NO_SCORE_CRITERIA;
-            problem_title = "No active score criteria!";
-            problem_description =
+            out.type = EPT_NO_SCORE_CRITERIA;
+            out.title = "No active score criteria!";
+            out.description =
                 "In this mission, the player is graded according to their "
                 "score. However, none of the score criteria are active, "
                 "so the player's score will always be 0.";
@@ -1147,32 +1240,34 @@ void AreaEditor::find_problems_no_score_criteria() {
 /**
  * @brief Checks for any non-simple sectors in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_non_simple_sector() {
+void AreaEditor::find_problems_non_simple_sector(ProblemInfo &out) const {
     if(!game.cur_area_data->problems.non_simples.empty()) {
-        problem_type = EPT_BAD_SECTOR;
-        problem_title = "Non-simple sector!";
+        out.type = EPT_BAD_SECTOR;
+        out.title = "Non-simple sector!";
         switch(game.cur_area_data->problems.non_simples.begin()->second) {
         case TRIANGULATION_ERROR_LONE_EDGES: {
-            problem_description =
+            out.description =
                 "It contains lone edges. Try clearing them up.";
             break;
         } case TRIANGULATION_ERROR_NOT_CLOSED: {
-            problem_description =
+            out.description =
                 "It is not closed. Try closing it.";
             break;
         } case TRIANGULATION_ERROR_NO_EARS: {
-            problem_description =
+            out.description =
                 "There's been a triangulation error. Try undoing or "
                 "deleting the sector, and then rebuild it. Make sure there "
                 "are no gaps, and keep it simple.";
             break;
         } case TRIANGULATION_ERROR_INVALID_ARGS: {
-            problem_description =
+            out.description =
                 "An unknown error has occured with the sector.";
             break;
         } case TRIANGULATION_ERROR_NONE: {
-            problem_description.clear();
+            out.description.clear();
             break;
         }
         }
@@ -1183,15 +1278,17 @@ void AreaEditor::find_problems_non_simple_sector() {
 /**
  * @brief Checks for any objects out of bounds in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_oob_mob() {
+void AreaEditor::find_problems_oob_mob(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
         if(!get_sector(m_ptr->pos, nullptr, false)) {
-            problem_mob_ptr = m_ptr;
-            problem_type = EPT_MOB_OOB;
-            problem_title = "Mob out of bounds!";
-            problem_description =
+            out.mob_ptr = m_ptr;
+            out.type = EPT_MOB_OOB;
+            out.title = "Mob out of bounds!";
+            out.description =
                 "Move it to somewhere inside the area's geometry.";
             return;
         }
@@ -1202,15 +1299,17 @@ void AreaEditor::find_problems_oob_mob() {
 /**
  * @brief Checks for any out of bounds path stops in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_oob_path_stop() {
+void AreaEditor::find_problems_oob_path_stop(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
         if(!get_sector(s_ptr->pos, nullptr, false)) {
-            problem_path_stop_ptr = s_ptr;
-            problem_type = EPT_PATH_STOP_OOB;
-            problem_title = "Path stop out of bounds!";
-            problem_description =
+            out.path_stop_ptr = s_ptr;
+            out.type = EPT_PATH_STOP_OOB;
+            out.title = "Path stop out of bounds!";
+            out.description =
                 "Move it to somewhere inside the area's geometry.";
             return;
         }
@@ -1221,8 +1320,10 @@ void AreaEditor::find_problems_oob_path_stop() {
 /**
  * @brief Checks for any overlapping vertexes in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_overlapping_vertex() {
+void AreaEditor::find_problems_overlapping_vertex(ProblemInfo &out) const {
     for(size_t v = 0; v < game.cur_area_data->vertexes.size(); v++) {
         Vertex* v1_ptr = game.cur_area_data->vertexes[v];
         
@@ -1230,13 +1331,13 @@ void AreaEditor::find_problems_overlapping_vertex() {
             Vertex* v2_ptr = game.cur_area_data->vertexes[v2];
             
             if(v1_ptr->x == v2_ptr->x && v1_ptr->y == v2_ptr->y) {
-                problem_vertex_ptr = v1_ptr;
-                problem_type = EPT_OVERLAPPING_VERTEXES;
-                problem_title = "Overlapping vertexes!";
-                problem_description =
+                out.vertex_ptr = v1_ptr;
+                out.type = EPT_OVERLAPPING_VERTEXES;
+                out.title = "Overlapping vertexes!";
+                out.description =
                     "They are very close together at (" +
-                    f2s(problem_vertex_ptr->x) + "," +
-                    f2s(problem_vertex_ptr->y) + "), and should likely "
+                    f2s(out.vertex_ptr->x) + "," +
+                    f2s(out.vertex_ptr->y) + "), and should likely "
                     "be merged together.";
                 return;
             }
@@ -1248,8 +1349,10 @@ void AreaEditor::find_problems_overlapping_vertex() {
 /**
  * @brief Checks for any path stop on top of an unrelated link in the area, and
  * fills the problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_path_stop_on_link() {
+void AreaEditor::find_problems_path_stop_on_link(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
         for(size_t s2 = 0; s2 < game.cur_area_data->path_stops.size(); s2++) {
@@ -1266,10 +1369,10 @@ void AreaEditor::find_problems_path_stop_on_link() {
                         link_start_ptr->pos, link_end_ptr->pos
                     )
                 ) {
-                    problem_path_stop_ptr = s_ptr;
-                    problem_type = EPT_PATH_STOP_ON_LINK;
-                    problem_title = "Path stop on unrelated link!";
-                    problem_description =
+                    out.path_stop_ptr = s_ptr;
+                    out.type = EPT_PATH_STOP_ON_LINK;
+                    out.title = "Path stop on unrelated link!";
+                    out.description =
                         "This path stop is on top of a link that has nothing "
                         "to do with it. If you meant to connect the two, do "
                         "so now. Otherwise, move the path stop a bit away from "
@@ -1285,8 +1388,12 @@ void AreaEditor::find_problems_path_stop_on_link() {
 /**
  * @brief Checks for any path stops intersecting in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_path_stops_intersecting() {
+void AreaEditor::find_problems_path_stops_intersecting(
+    ProblemInfo &out
+) const {
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
         for(size_t s2 = 0; s2 < game.cur_area_data->path_stops.size(); s2++) {
@@ -1294,10 +1401,10 @@ void AreaEditor::find_problems_path_stops_intersecting() {
             if(s2_ptr == s_ptr) continue;
             
             if(Distance(s_ptr->pos, s2_ptr->pos) <= 3.0) {
-                problem_path_stop_ptr = s_ptr;
-                problem_type = EPT_PATH_STOPS_TOGETHER;
-                problem_title = "Two close path stops!";
-                problem_description =
+                out.path_stop_ptr = s_ptr;
+                out.type = EPT_PATH_STOPS_TOGETHER;
+                out.title = "Two close path stops!";
+                out.description =
                     "These two are very close together. Separate them.";
                 return;
             }
@@ -1309,17 +1416,20 @@ void AreaEditor::find_problems_path_stops_intersecting() {
 /**
  * @brief Checks for any Pikmin over the limit in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_pikmin_over_limit() {
+void AreaEditor::find_problems_pikmin_over_limit(ProblemInfo &out) const {
     size_t n_pikmin_mobs = 0;
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         MobGen* m_ptr = game.cur_area_data->mob_generators[m];
+        if(!m_ptr->type) continue;
         if(m_ptr->type->category->id == MOB_CATEGORY_PIKMIN) {
             n_pikmin_mobs++;
             if(n_pikmin_mobs > game.config.rules.max_pikmin_in_field) {
-                problem_type = EPT_PIKMIN_OVER_LIMIT;
-                problem_title = "Over the Pikmin limit!";
-                problem_description =
+                out.type = EPT_PIKMIN_OVER_LIMIT;
+                out.title = "Over the Pikmin limit!";
+                out.description =
                     "There are more Pikmin in the area than the limit allows. "
                     "This means some of them will not appear. Current limit: "
                     + i2s(game.config.rules.max_pikmin_in_field) + ".";
@@ -1333,14 +1443,16 @@ void AreaEditor::find_problems_pikmin_over_limit() {
 /**
  * @brief Checks for any mobs without a type in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_typeless_mob() {
+void AreaEditor::find_problems_typeless_mob(ProblemInfo &out) const {
     for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
         if(!game.cur_area_data->mob_generators[m]->type) {
-            problem_mob_ptr = game.cur_area_data->mob_generators[m];
-            problem_type = EPT_TYPELESS_MOB;
-            problem_title = "Mob with no type!";
-            problem_description =
+            out.mob_ptr = game.cur_area_data->mob_generators[m];
+            out.type = EPT_TYPELESS_MOB;
+            out.title = "Mob with no type!";
+            out.description =
                 "It has an invalid category or type set. "
                 "Give it a proper type or delete it.";
             return;
@@ -1352,8 +1464,10 @@ void AreaEditor::find_problems_typeless_mob() {
 /**
  * @brief Checks for any unknown texture in the area, and fills the problem
  * info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_unknown_texture() {
+void AreaEditor::find_problems_unknown_texture(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
         Sector* s_ptr = game.cur_area_data->sectors[s];
         if(s_ptr->edges.empty()) continue;
@@ -1364,10 +1478,10 @@ void AreaEditor::find_problems_unknown_texture() {
         const auto &texture_it =
             game.content.bitmaps.manifests.find(s_ptr->texture_info.bmp_name);
         if(texture_it == game.content.bitmaps.manifests.end()) {
-            problem_sector_ptr = s_ptr;
-            problem_type = EPT_UNKNOWN_TEXTURE;
-            problem_title = "Sector with unknown texture!";
-            problem_description =
+            out.sector_ptr = s_ptr;
+            out.type = EPT_UNKNOWN_TEXTURE;
+            out.title = "Sector with unknown texture!";
+            out.description =
                 "Texture name: \"" + s_ptr->texture_info.bmp_name + "\".";
             return;
         }
@@ -1378,14 +1492,16 @@ void AreaEditor::find_problems_unknown_texture() {
 /**
  * @brief Checks for any unknown tree shadow texture in the area, and fills the
  * problem info if so.
+ *
+ * @param out If a problem is found, its info is returned here.
  */
-void AreaEditor::find_problems_unknown_tree_shadow() {
+void AreaEditor::find_problems_unknown_tree_shadow(ProblemInfo &out) const {
     for(size_t s = 0; s < game.cur_area_data->tree_shadows.size(); s++) {
         if(game.cur_area_data->tree_shadows[s]->bitmap == game.bmp_error) {
-            problem_shadow_ptr = game.cur_area_data->tree_shadows[s];
-            problem_type = EPT_UNKNOWN_SHADOW;
-            problem_title = "Tree shadow with invalid texture!";
-            problem_description =
+            out.shadow_ptr = game.cur_area_data->tree_shadows[s];
+            out.type = EPT_UNKNOWN_SHADOW;
+            out.title = "Tree shadow with invalid texture!";
+            out.description =
                 "Texture name: \"" +
                 game.cur_area_data->tree_shadows[s]->bmp_name + "\".";
             return;
@@ -1680,57 +1796,130 @@ bool AreaEditor::get_drawing_outer_sector(Sector** result) const {
 Edge* AreaEditor::get_edge_under_point(
     const Point &p, const Edge* after
 ) const {
-    bool found_after = (!after ? true : false);
+    size_t min_idx = 0;
+    if(after) {
+        size_t after_idx = game.cur_area_data->find_edge_idx(after);
+        if(after_idx == INVALID) return nullptr;
+        min_idx = after_idx + 1;
+    }
     
-    for(size_t e = 0; e < game.cur_area_data->edges.size(); e++) {
+    if(picking_index.is_outdated()) picking_index.build(this);
+    const float range = 8 / game.cam.zoom;
+    size_t col1, col2, row1, row2;
+    if(
+        !picking_index.get_cells(
+            p - range, p + range, &col1, &col2, &row1, &row2
+        )
+    ) {
+        return nullptr;
+    }
+    
+    size_t best_idx =
+        picking_index.get_first_hit<size_t>(
+            picking_index.edges, col1, col2, row1, row2, INVALID,
+    [&p, range, min_idx] (const size_t & e) {
+        if(e < min_idx) return false;
+        if(e >= game.cur_area_data->edges.size()) return false;
         Edge* e_ptr = game.cur_area_data->edges[e];
-        if(e_ptr == after) {
-            found_after = true;
-            continue;
-        } else if(!found_after) {
-            continue;
-        }
-        
-        if(!e_ptr->is_valid()) continue;
-        
-        if(
+        if(!e_ptr->is_valid()) return false;
+        return
             circle_intersects_line_seg(
-                p, 8 / game.cam.zoom,
+                p, range,
                 v2p(e_ptr->vertexes[0]), v2p(e_ptr->vertexes[1])
-            )
-        ) {
-            return e_ptr;
-        }
+            );
     }
-    
-    return nullptr;
+        );
+        
+    if(best_idx == INVALID) return nullptr;
+    return game.cur_area_data->edges[best_idx];
 }
 
 
 /**
  * @brief Returns which edges are crossing against other edges, if any.
+ * The results are sorted by the first edge's index, and then the second's.
  *
+ * @param only_edges If not nullptr, only crossings that involve at least
+ * one of these edges are returned.
  * @return The edges.
  */
-vector<EdgeIntersection> AreaEditor::get_intersecting_edges() const {
+vector<EdgeIntersection> AreaEditor::get_intersecting_edges(
+    const set<Edge*>* only_edges
+) const {
     vector<EdgeIntersection> intersections;
+    const vector<Edge*> &edges = game.cur_area_data->edges;
+    if(edges.empty()) return intersections;
+    
+    //Instead of checking every pair of edges, split the area into a grid,
+    //and only check pairs of edges that share a cell. The area's blockmap
+    //can't be used, since it's out of date while editing.
+    Point min_coords = v2p(edges[0]->vertexes[0]);
+    Point max_coords = min_coords;
+    for(size_t e = 0; e < edges.size(); e++) {
+        update_min_max_coords(
+            min_coords, max_coords, v2p(edges[e]->vertexes[0])
+        );
+        update_min_max_coords(
+            min_coords, max_coords, v2p(edges[e]->vertexes[1])
+        );
+    }
+    const float cell_size = GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    size_t n_cols = floor((max_coords.x - min_coords.x) / cell_size) + 1;
+    size_t n_rows = floor((max_coords.y - min_coords.y) / cell_size) + 1;
+    vector<vector<size_t> > cells(n_cols * n_rows);
     
-    for(size_t e1 = 0; e1 < game.cur_area_data->edges.size(); e1++) {
-        Edge* e1_ptr = game.cur_area_data->edges[e1];
-        for(size_t e2 = e1 + 1; e2 < game.cur_area_data->edges.size(); e2++) {
-            Edge* e2_ptr = game.cur_area_data->edges[e2];
-            if(e1_ptr->has_neighbor(e2_ptr)) continue;
-            if(
-                line_segs_intersect(
-                    v2p(e1_ptr->vertexes[0]), v2p(e1_ptr->vertexes[1]),
-                    v2p(e2_ptr->vertexes[0]), v2p(e2_ptr->vertexes[1]),
-                    nullptr, nullptr
-                )
-            ) {
-                intersections.push_back(EdgeIntersection(e1_ptr, e2_ptr));
+    for(size_t e = 0; e < edges.size(); e++) {
+        Point e_min = v2p(edges[e]->vertexes[0]);
+        Point e_max = e_min;
+        update_min_max_coords(e_min, e_max, v2p(edges[e]->vertexes[1]));
+        size_t col1 = floor((e_min.x - min_coords.x) / cell_size);
+        size_t col2 = floor((e_max.x - min_coords.x) / cell_size);
+        size_t row1 = floor((e_min.y - min_coords.y) / cell_size);
+        size_t row2 = floor((e_max.y - min_coords.y) / cell_size);
+        for(size_t c = col1; c <= col2; c++) {
+            for(size_t r = row1; r <= row2; r++) {
+                cells[r * n_cols + c].push_back(e);
+            }
+        }
+    }
+    
+    //The edges were added to each cell in order, so the first edge of each
+    //pair always has the smaller index.
+    vector<std::pair<size_t, size_t> > pairs;
+    for(size_t c = 0; c < cells.size(); c++) {
+        const vector<size_t> &cell = cells[c];
+        for(size_t i1 = 0; i1 < cell.size(); i1++) {
+            bool e1_wanted =
+                !only_edges || only_edges->find(edges[cell[i1]]) !=
+                only_edges->end();
+            for(size_t i2 = i1 + 1; i2 < cell.size(); i2++) {
+                if(
+                    !e1_wanted &&
+                    only_edges->find(edges[cell[i2]]) == only_edges->end()
+                ) {
+                    continue;
+                }
+                pairs.push_back(std::make_pair(cell[i1], cell[i2]));
             }
         }
     }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    
+    for(size_t p = 0; p < pairs.size(); p++) {
+        Edge* e1_ptr = edges[pairs[p].first];
+        Edge* e2_ptr = edges[pairs[p].second];
+        if(e1_ptr->has_neighbor(e2_ptr)) continue;
+        if(
+            line_segs_intersect(
+                v2p(e1_ptr->vertexes[0]), v2p(e1_ptr->vertexes[1]),
+                v2p(e2_ptr->vertexes[0]), v2p(e2_ptr->vertexes[1]),
+                nullptr, nullptr
+            )
+        ) {
+            intersections.push_back(EdgeIntersection(e1_ptr, e2_ptr));
+        }
+    }
     return intersections;
 }
 
@@ -1803,19 +1992,27 @@ bool AreaEditor::get_mob_link_under_point(
 MobGen* AreaEditor::get_mob_under_point(
     const Point &p, size_t* out_idx
 ) const {
-    for(size_t m = 0; m < game.cur_area_data->mob_generators.size(); m++) {
-        MobGen* m_ptr = game.cur_area_data->mob_generators[m];
-        
-        if(
-            Distance(m_ptr->pos, p) <= get_mob_gen_radius(m_ptr)
-        ) {
-            if(out_idx) *out_idx = m;
-            return m_ptr;
-        }
+    if(out_idx) *out_idx = INVALID;
+    
+    if(picking_index.is_outdated()) picking_index.build(this);
+    size_t col1, col2, row1, row2;
+    if(!picking_index.get_cells(p, p, &col1, &col2, &row1, &row2)) {
+        return nullptr;
     }
     
-    if(out_idx) *out_idx = INVALID;
-    return nullptr;
+    size_t best_idx =
+        picking_index.get_first_hit<size_t>(
+            picking_index.mobs, col1, col2, row1, row2, INVALID,
+    [this, &p] (const size_t & m) {
+        if(m >= game.cur_area_data->mob_generators.size()) return false;
+        MobGen* m_ptr = game.cur_area_data->mob_generators[m];
+        return Distance(m_ptr->pos, p) <= get_mob_gen_radius(m_ptr);
+    }
+        );
+        
+    if(best_idx == INVALID) return nullptr;
+    if(out_idx) *out_idx = best_idx;
+    return game.cur_area_data->mob_generators[best_idx];
 }
 
 
@@ -1834,23 +2031,37 @@ MobGen* AreaEditor::get_mob_under_point(
 bool AreaEditor::get_path_link_under_point(
     const Point &p, PathLink** link1, PathLink** link2
 ) const {
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
-        PathStop* s_ptr = game.cur_area_data->path_stops[s];
-        for(size_t l = 0; l < s_ptr->links.size(); l++) {
-            PathStop* s2_ptr = s_ptr->links[l]->end_ptr;
-            if(
-                circle_intersects_line_seg(
-                    p, 8 / game.cam.zoom, s_ptr->pos, s2_ptr->pos
-                )
-            ) {
-                *link1 = s_ptr->links[l];
-                *link2 = s2_ptr->get_link(s_ptr);
-                return true;
-            }
-        }
+    if(picking_index.is_outdated()) picking_index.build(this);
+    const float range = 8 / game.cam.zoom;
+    size_t col1, col2, row1, row2;
+    if(
+        !picking_index.get_cells(
+            p - range, p + range, &col1, &col2, &row1, &row2
+        )
+    ) {
+        return false;
     }
     
-    return false;
+    std::pair<size_t, size_t> best =
+        picking_index.get_first_hit<std::pair<size_t, size_t> >(
+            picking_index.links, col1, col2, row1, row2,
+            std::make_pair(INVALID, INVALID),
+    [&p, range] (const std::pair<size_t, size_t> & link) {
+        if(link.first >= game.cur_area_data->path_stops.size()) return false;
+        PathStop* s_ptr = game.cur_area_data->path_stops[link.first];
+        if(link.second >= s_ptr->links.size()) return false;
+        return
+            circle_intersects_line_seg(
+                p, range, s_ptr->pos, s_ptr->links[link.second]->end_ptr->pos
+            );
+    }
+        );
+        
+    if(best.first == INVALID) return false;
+    PathStop* s_ptr = game.cur_area_data->path_stops[best.first];
+    *link1 = s_ptr->links[best.second];
+    *link2 = (*link1)->end_ptr->get_link(s_ptr);
+    return true;
 }
 
 
@@ -1862,15 +2073,126 @@ bool AreaEditor::get_path_link_under_point(
  * @return The stop.
  */
 PathStop* AreaEditor::get_path_stop_under_point(const Point &p) const {
-    for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
+    if(picking_index.is_outdated()) picking_index.build(this);
+    size_t col1, col2, row1, row2;
+    if(!picking_index.get_cells(p, p, &col1, &col2, &row1, &row2)) {
+        return nullptr;
+    }
+    
+    size_t best_idx =
+        picking_index.get_first_hit<size_t>(
+            picking_index.stops, col1, col2, row1, row2, INVALID,
+    [&p] (const size_t & s) {
+        if(s >= game.cur_area_data->path_stops.size()) return false;
         PathStop* s_ptr = game.cur_area_data->path_stops[s];
+        return Distance(s_ptr->pos, p) <= s_ptr->radius;
+    }
+        );
         
-        if(Distance(s_ptr->pos, p) <= s_ptr->radius) {
-            return s_ptr;
+    if(best_idx == INVALID) return nullptr;
+    return game.cur_area_data->path_stops[best_idx];
+}
+
+
+/**
+ * @brief Returns a fingerprint of each part of the area that the problem
+ * checks read from. If a part's fingerprint is the same as before, then
+ * that part hasn't changed.
+ *
+ * @param out_fingerprints The fingerprints are returned here, one for each
+ * PROBLEM_DATA.
+ */
+void AreaEditor::get_problem_data_fingerprints(
+    uint64_t out_fingerprints[N_PROBLEM_DATA]
+) const {
+    //FNV-1a, a word at a time.
+    const auto mix = [] (uint64_t &h, uint64_t value) {
+        h ^= value;
+        h *= 1099511628211ULL;
+    };
+    const auto mix_float = [&mix] (uint64_t &h, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        mix(h, bits);
+    };
+    const auto mix_ptr = [&mix] (uint64_t &h, const void* ptr) {
+        mix(h, (uint64_t) (uintptr_t) ptr);
+    };
+    const Area* area = game.cur_area_data;
+    
+    uint64_t &layout = out_fingerprints[PROBLEM_DATA_LAYOUT];
+    layout = 14695981039346656037ULL;
+    for(size_t v = 0; v < area->vertexes.size(); v++) {
+        Vertex* v_ptr = area->vertexes[v];
+        mix_ptr(layout, v_ptr);
+        mix_float(layout, v_ptr->x);
+        mix_float(layout, v_ptr->y);
+    }
+    for(size_t e = 0; e < area->edges.size(); e++) {
+        Edge* e_ptr = area->edges[e];
+        mix_ptr(layout, e_ptr);
+        mix_ptr(layout, e_ptr->vertexes[0]);
+        mix_ptr(layout, e_ptr->vertexes[1]);
+        mix_ptr(layout, e_ptr->sectors[0]);
+        mix_ptr(layout, e_ptr->sectors[1]);
+    }
+    for(size_t s = 0; s < area->sectors.size(); s++) {
+        Sector* s_ptr = area->sectors[s];
+        mix_ptr(layout, s_ptr);
+        mix_float(layout, s_ptr->z);
+        mix(layout, s_ptr->type);
+        mix(layout, s_ptr->is_bottomless_pit);
+        mix(layout, s_ptr->fade);
+        mix(layout, s_ptr->edges.size());
+        mix(layout, std::hash<string>()(s_ptr->texture_info.bmp_name));
+    }
+    for(const auto &n : area->problems.non_simples) {
+        mix_ptr(layout, n.first);
+        mix(layout, n.second);
+    }
+    //The lone edges have no set order, so add them up instead.
+    uint64_t lone_edges_sum = 0;
+    for(Edge* e_ptr : area->problems.lone_edges) {
+        lone_edges_sum += std::hash<Edge*>()(e_ptr);
+    }
+    mix(layout, lone_edges_sum);
+    mix(layout, area->problems.lone_edges.size());
+    
+    uint64_t &mobs = out_fingerprints[PROBLEM_DATA_MOBS];
+    mobs = 14695981039346656037ULL;
+    for(size_t m = 0; m < area->mob_generators.size(); m++) {
+        MobGen* m_ptr = area->mob_generators[m];
+        mix_ptr(mobs, m_ptr);
+        mix_float(mobs, m_ptr->pos.x);
+        mix_float(mobs, m_ptr->pos.y);
+        mix_ptr(mobs, m_ptr->type);
+        mix(mobs, m_ptr->stored_inside);
+        mix(mobs, m_ptr->links.size());
+        for(size_t l = 0; l < m_ptr->links.size(); l++) {
+            mix_ptr(mobs, m_ptr->links[l]);
+        }
+    }
+    
+    uint64_t &paths = out_fingerprints[PROBLEM_DATA_PATHS];
+    paths = 14695981039346656037ULL;
+    for(size_t s = 0; s < area->path_stops.size(); s++) {
+        PathStop* s_ptr = area->path_stops[s];
+        mix_ptr(paths, s_ptr);
+        mix_float(paths, s_ptr->pos.x);
+        mix_float(paths, s_ptr->pos.y);
+        mix_float(paths, s_ptr->radius);
+        mix(paths, s_ptr->links.size());
+        for(size_t l = 0; l < s_ptr->links.size(); l++) {
+            mix_ptr(paths, s_ptr->links[l]->end_ptr);
         }
     }
     
-    return nullptr;
+    uint64_t &shadows = out_fingerprints[PROBLEM_DATA_SHADOWS];
+    shadows = 14695981039346656037ULL;
+    for(size_t s = 0; s < area->tree_shadows.size(); s++) {
+        mix_ptr(shadows, area->tree_shadows[s]);
+        mix_ptr(shadows, area->tree_shadows[s]->bitmap);
+    }
 }
 
 
@@ -1894,10 +2216,24 @@ Sector* AreaEditor::get_sector_under_point(const Point &p) const {
  * @return The vertex.
  */
 Vertex* AreaEditor::get_vertex_under_point(const Point &p) const {
-    for(size_t v = 0; v < game.cur_area_data->vertexes.size(); v++) {
+    if(picking_index.is_outdated()) picking_index.build(this);
+    const float range = 8 / game.cam.zoom;
+    size_t col1, col2, row1, row2;
+    if(
+        !picking_index.get_cells(
+            p - range, p + range, &col1, &col2, &row1, &row2
+        )
+    ) {
+        return nullptr;
+    }
+    
+    size_t best_idx =
+        picking_index.get_first_hit<size_t>(
+            picking_index.vertexes, col1, col2, row1, row2, INVALID,
+    [&p] (const size_t & v) {
+        if(v >= game.cur_area_data->vertexes.size()) return false;
         Vertex* v_ptr = game.cur_area_data->vertexes[v];
-        
-        if(
+        return
             rectangles_intersect(
                 p - (4 / game.cam.zoom),
                 p + (4 / game.cam.zoom),
@@ -1909,13 +2245,12 @@ Vertex* AreaEditor::get_vertex_under_point(const Point &p) const {
                     v_ptr->x + (4 / game.cam.zoom),
                     v_ptr->y + (4 / game.cam.zoom)
                 )
-            )
-        ) {
-            return v_ptr;
-        }
+            );
     }
-    
-    return nullptr;
+        );
+        
+    if(best_idx == INVALID) return nullptr;
+    return game.cur_area_data->vertexes[best_idx];
 }
 
 
@@ -2525,15 +2860,6 @@ Point AreaEditor::snap_point(const Point &p, bool ignore_selected) {
             cursor_snap_cache = final_point;
             return final_point;
         } else {
-            sort(
-                snappable_vertexes.begin(), snappable_vertexes.end(),
-                [] (
-                    std::pair<Distance, Vertex*> v1, std::pair<Distance, Vertex*> v2
-            ) -> bool {
-                return v1.first < v2.first;
-            }
-            );
-            
             Point result(
                 snappable_vertexes[0].second->x,
                 snappable_vertexes[0].second->y
@@ -2715,7 +3041,9 @@ PathStop* AreaEditor::split_path_link(
 
 /**
  * @brief Updates the triangles and bounding box of the specified sectors, and
- * reports any errors found.
+ * reports any errors found. Sectors whose edge loops are the same as the
+ * last time they went through here are skipped, since their triangles
+ * and problems would come out the same.
  *
  * @param affected_sectors The list of affected sectors.
  */
@@ -2727,10 +3055,14 @@ void AreaEditor::update_affected_sectors(
     for(Sector* s_ptr : affected_sectors) {
         if(!s_ptr) continue;
         
+        size_t geometry_hash = s_ptr->get_geometry_hash();
+        if(geometry_hash == s_ptr->triangles_geometry_hash) continue;
+        
         set<Edge*> triangulation_lone_edges;
         TRIANGULATION_ERROR triangulation_error =
             triangulate_sector(s_ptr, &triangulation_lone_edges, true);
-            
+        s_ptr->triangles_geometry_hash = geometry_hash;
+        
         if(triangulation_error == TRIANGULATION_ERROR_NONE) {
             auto it = game.cur_area_data->problems.non_simples.find(s_ptr);
             if(it != game.cur_area_data->problems.non_simples.end()) {
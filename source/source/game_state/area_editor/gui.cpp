@@ -27,6 +27,7 @@
  */
 void AreaEditor::open_load_dialog() {
     reload_areas();
+    game.content.areas.load_all_thumbnails();
     
     //Set up the picker's behavior and data.
     vector<PickerItem> areas;
@@ -585,6 +586,18 @@ void AreaEditor::process_gui_menu_bar() {
                 "Ctrl + P"
             );
             
+            //Performance report item.
+            if(ImGui::MenuItem("Make performance report")) {
+                perf_report_cmd(1.0f);
+            }
+            set_tooltip(
+                "Save the area, and then simulate a minute of gameplay on it "
+                "in the background, with the leader walking around. "
+                "A report with frame times, peak object and particle counts, "
+                "and the slowest object types gets saved in the user data "
+                "folder."
+            );
+            
             //Separator item.
             ImGui::Separator();
             
@@ -3971,7 +3984,7 @@ void AreaEditor::process_gui_panel_mob() {
         
         //If the mob type exists, obviously the missing mob type problem is
         //gone, if it was active.
-        if(problem_type == EPT_TYPELESS_MOB) {
+        if(problem.type == EPT_TYPELESS_MOB) {
             clear_problems();
         }
     }
@@ -4883,17 +4896,17 @@ void AreaEditor::process_gui_panel_review() {
         ImGui::Text("Problem found:");
         
         ImGui::Indent();
-        if(problem_type == EPT_NONE_YET) {
+        if(problem.type == EPT_NONE_YET) {
             ImGui::TextDisabled("Haven't searched yet.");
         } else {
-            ImGui::TextWrapped("%s", problem_title.c_str());
+            ImGui::TextWrapped("%s", problem.title.c_str());
         }
         ImGui::Unindent();
         
-        if(!problem_description.empty()) {
+        if(!problem.description.empty()) {
         
             ImGui::Indent();
-            ImGui::TextWrapped("%s", problem_description.c_str());
+            ImGui::TextWrapped("%s", problem.description.c_str());
             ImGui::Unindent();
             
             //Go to problem button.
@@ -5069,14 +5082,14 @@ void AreaEditor::process_gui_panel_sector() {
         if(ImGui::DragFloat("Height", &sector_z)) {
             register_change("sector height change");
             s_ptr->z = sector_z;
-            update_all_edge_offset_caches();
+            update_sector_edge_offset_caches(selected_sectors);
         }
         if(ImGui::BeginPopupContextItem()) {
             //-50 height selectable.
             if(ImGui::Selectable("-50")) {
                 register_change("sector height change");
                 s_ptr->z -= 50.0f;
-                update_all_edge_offset_caches();
+                update_sector_edge_offset_caches(selected_sectors);
                 ImGui::CloseCurrentPopup();
             }
             
@@ -5084,7 +5097,7 @@ void AreaEditor::process_gui_panel_sector() {
             if(ImGui::Selectable("+50")) {
                 register_change("sector height change");
                 s_ptr->z += 50.0f;
-                update_all_edge_offset_caches();
+                update_sector_edge_offset_caches(selected_sectors);
                 ImGui::CloseCurrentPopup();
             }
             
@@ -5092,7 +5105,7 @@ void AreaEditor::process_gui_panel_sector() {
             if(ImGui::Selectable("Set to 0")) {
                 register_change("sector height change");
                 s_ptr->z = 0.0f;
-                update_all_edge_offset_caches();
+                update_sector_edge_offset_caches(selected_sectors);
                 ImGui::CloseCurrentPopup();
             }
             
@@ -5126,6 +5139,7 @@ void AreaEditor::process_gui_panel_sector() {
                         &(game.content.hazards.list[hazard_inames[h]])
                     );
                 }
+                s_ptr->update_path_blocking_hazards();
             }
             set_tooltip("List of hazards this sector has.");
             
@@ -5226,14 +5240,9 @@ void AreaEditor::process_gui_panel_sector() {
                 picker_buttons.push_back(PickerItem("Choose another..."));
                 
                 for(size_t s = 0; s < texture_suggestions.size(); s++) {
-                    picker_buttons.push_back(
-                        PickerItem(
-                            texture_suggestions[s].name,
-                            "", "", nullptr,
-                            "",
-                            texture_suggestions[s].bmp
-                        )
-                    );
+                    PickerItem item(texture_suggestions[s].name);
+                    item.thumbnail = texture_suggestions[s].name;
+                    picker_buttons.push_back(item);
                 }
                 open_picker_dialog(
                     "Pick a texture",
@@ -42,6 +42,10 @@ const int ICON_BMP_PADDING = 1;
 //Every icon in the icon bitmap file has this size.
 const int ICON_BMP_SIZE = 24;
 
+//If the camera is less than these many pixels away from where it's going,
+//it's considered to have stopped, so the editor can idle.
+const float IDLE_CAM_TOLERANCE = 0.5f;
+
 //How much to zoom in/out with the keyboard keys.
 const float KEYBOARD_CAM_ZOOM = 0.25f;
 
@@ -101,6 +105,36 @@ Editor::Editor() :
 }
 
 
+/**
+ * @brief Returns whether the editor can stop drawing until the player
+ * does something. Editors that have their own animations should also
+ * check those.
+ *
+ * @return Whether it can.
+ */
+bool Editor::can_idle() const {
+    if(double_click_time > 0.0f) return false;
+    if(op_error_flash_timer.time_left > 0.0f) return false;
+    float cam_pos_diff =
+        Distance(game.cam.pos, game.cam.target_pos).to_float() *
+        game.cam.zoom;
+    float cam_zoom_diff =
+        fabs(game.cam.target_zoom / game.cam.zoom - 1.0f) * game.win_w;
+    if(
+        cam_pos_diff > EDITOR::IDLE_CAM_TOLERANCE ||
+        cam_zoom_diff > EDITOR::IDLE_CAM_TOLERANCE
+    ) {
+        //Camera's still gliding.
+        return false;
+    }
+    if(ImGui::GetIO().WantTextInput) {
+        //The text cursor blinks.
+        return false;
+    }
+    return true;
+}
+
+
 /**
  * @brief Centers the camera so that these four points are in view.
  * A bit of padding is added, so that, for instance, the top-left
@@ -184,6 +218,8 @@ void Editor::do_logic_pre() {
     
     op_error_flash_timer.tick(game.delta_t);
     
+    thumbnails.update();
+    
     update_transformations();
 }
 
@@ -1480,6 +1516,7 @@ void Editor::load() {
     game.cam.set_pos(Point());
     game.cam.set_zoom(1.0f);
     update_style();
+    thumbnails.start();
     
     game.fade_mgr.start_fade(true, nullptr);
     ImGui::Reset();
@@ -1861,12 +1898,12 @@ void Editor::process_gui_bitmap_dialog() {
             if(folder != bitmap_dialog_recommended_folder) continue;
         }
         
-        bitmap_dialog_picker.items.push_back(
-            PickerItem(
-                b.first,
-                "Pack: " + game.content.packs.list[b.second.pack].name
-            )
+        PickerItem item(
+            b.first,
+            "Pack: " + game.content.packs.list[b.second.pack].name
         );
+        item.thumbnail = b.first;
+        bitmap_dialog_picker.items.push_back(item);
     }
     
     //Update the image if needed.
@@ -2977,6 +3014,7 @@ void Editor::unload() {
     }
     custom_cat_name_idxs.clear();
     custom_cat_types.clear();
+    thumbnails.stop();
     game.mouse_cursor.hide();
 }
 
@@ -3755,19 +3793,39 @@ void Editor::Picker::process() {
                 
                 Point button_size;
                 
-                if(i_ptr->bitmap) {
+                if(i_ptr->bitmap || !i_ptr->thumbnail.empty()) {
                 
                     ImGui::BeginGroup();
                     
-                    //Item image button.
                     button_size = Point(EDITOR::PICKER_IMG_BUTTON_SIZE);
-                    bool button_pressed =
-                        ImGui::ImageButtonOrganized(
-                            widgetId + "Button",
-                            i_ptr->bitmap,
-                            button_size - 4.0f, button_size
-                        );
-                        
+                    ALLEGRO_BITMAP* item_bmp = i_ptr->bitmap;
+                    if(
+                        !item_bmp &&
+                        ImGui::IsRectVisible(
+                            ImVec2(button_size.x, button_size.y)
+                        )
+                    ) {
+                        item_bmp =
+                            editor_ptr->thumbnails.get(i_ptr->thumbnail);
+                    }
+                    
+                    bool button_pressed = false;
+                    if(item_bmp) {
+                        //Item image button.
+                        button_pressed =
+                            ImGui::ImageButtonOrganized(
+                                widgetId + "Button",
+                                item_bmp,
+                                button_size - 4.0f, button_size
+                            );
+                    } else {
+                        //Item image button, while the thumbnail isn't here.
+                        button_pressed =
+                            ImGui::Button(
+                                "...", ImVec2(button_size.x, button_size.y)
+                            );
+                    }
+                    
                     if(button_pressed) {
                         pick_callback(
                             i_ptr->name, i_ptr->top_category, i_ptr->sec_category, i_ptr->info, false
@@ -30,6 +30,7 @@ extern const size_t DEF_MAX_HISTORY_SIZE;
 extern const float DOUBLE_CLICK_TIMEOUT;
 extern const int ICON_BMP_PADDING;
 extern const int ICON_BMP_SIZE;
+extern const float IDLE_CAM_TOLERANCE;
 extern const float KEYBOARD_CAM_ZOOM;
 extern const float MOUSE_COORDS_TEXT_WIDTH;
 extern const float OP_ERROR_CURSOR_SHAKE_SPEED;
@@ -66,6 +67,7 @@ public:
     virtual void update_style();
     void update_transformations() override;
     string get_name() const override = 0;
+    bool can_idle() const override;
     virtual size_t get_history_size() const;
     
 protected:
@@ -361,6 +363,10 @@ protected:
         //Bitmap, if any.
         ALLEGRO_BITMAP* bitmap = nullptr;
         
+        //If there's no bitmap, internal name of an image whose thumbnail
+        //to show instead, if any. It's only loaded once the item is in view.
+        string thumbnail;
+        
         
         //--- Function declarations ---
         
@@ -664,6 +670,9 @@ protected:
     //Current sub-state.
     size_t sub_state = 0;
     
+    //Loads the image thumbnails shown in pickers.
+    ThumbnailLoader thumbnails;
+    
     //Maximum zoom level allowed.
     float zoom_max_level = 0.0f;
     
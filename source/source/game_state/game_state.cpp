@@ -20,6 +20,18 @@
 GameState::GameState() { }
 
 
+/**
+ * @brief Returns whether the state can stop drawing until the player
+ * does something, because nothing on-screen is changing on its own right now.
+ * By default, states are always changing.
+ *
+ * @return Whether it can.
+ */
+bool GameState::can_idle() const {
+    return false;
+}
+
+
 /**
  * @brief Updates any transformations. Unused.
  */
@@ -47,5 +47,6 @@ public:
     virtual void do_drawing() = 0;
     virtual void update_transformations();
     virtual string get_name() const = 0;
+    virtual bool can_idle() const;
     
 };
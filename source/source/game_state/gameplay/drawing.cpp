@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <cstring>
 
 #include "gameplay.h"
 
@@ -19,6 +20,7 @@
 #include "../../core/misc_functions.h"
 #include "../../core/game.h"
 #include "../../util/allegro_utils.h"
+#include "../../util/code_debug.h"
 #include "../../util/general_utils.h"
 #include "../../util/string_utils.h"
 
@@ -26,6 +28,17 @@
 #pragma warning(disable: 4701)
 
 
+/**
+ * @brief Destroys all tiles of baked static sector floors.
+ */
+void GameplayState::clear_baked_sector_tiles() {
+    for(auto &t : baked_sector_tiles) {
+        if(t.second.bitmap) al_destroy_bitmap(t.second.bitmap);
+    }
+    baked_sector_tiles.clear();
+}
+
+
 /**
  * @brief Does the drawing for the main game loop.
  *
@@ -63,11 +76,28 @@ void GameplayState::do_game_drawing(
         );
     }
     
+    //The background and world can be drawn at a lower resolution,
+    //and then get scaled up to fit the window.
+    float render_scale =
+        bmp_output ?
+        1.0f :
+        std::clamp(
+            game.options.graphics.render_scale,
+            GAMEPLAY::MIN_RENDER_SCALE, 1.0f
+        );
+    bool scaled_render = render_scale < 1.0f;
+    if(scaled_render) {
+        update_world_render_bmp(render_scale);
+        al_set_target_bitmap(world_render_bmp);
+    }
+    
     al_clear_to_color(game.cur_area_data->bg_color);
     
     //Layer 1 -- Background.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- Background");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_DRAWING_BACKGROUND
+        );
     }
     draw_background(bmp_output);
     if(game.perf_mon) {
@@ -76,17 +106,38 @@ void GameplayState::do_game_drawing(
     
     //Layer 2 -- World components.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- World");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_DRAWING_WORLD);
     }
     al_use_transform(&game.world_to_screen_transform);
     draw_world_components(bmp_output);
+    if(scaled_render) {
+        al_set_target_backbuffer(game.display);
+        al_use_transform(&game.identity_transform);
+        int old_op, old_src, old_dst, old_aop, old_asrc, old_adst;
+        al_get_separate_blender(
+            &old_op, &old_src, &old_dst, &old_aop, &old_asrc, &old_adst
+        );
+        al_set_blender(ALLEGRO_ADD, ALLEGRO_ONE, ALLEGRO_ZERO);
+        al_draw_scaled_bitmap(
+            world_render_bmp,
+            0, 0,
+            al_get_bitmap_width(world_render_bmp),
+            al_get_bitmap_height(world_render_bmp),
+            0, 0, game.win_w, game.win_h, 0
+        );
+        al_set_separate_blender(
+            old_op, old_src, old_dst, old_aop, old_asrc, old_adst
+        );
+    }
     if(game.perf_mon) {
         game.perf_mon->finish_measurement();
     }
     
     //Layer 3 -- In-game text.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- In-game text");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_DRAWING_IN_GAME_TEXT
+        );
     }
     if(!bmp_output && game.maker_tools.hud) {
         draw_ingame_text();
@@ -97,7 +148,9 @@ void GameplayState::do_game_drawing(
     
     //Layer 4 -- Precipitation.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- precipitation");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_DRAWING_PRECIPITATION
+        );
     }
     if(!bmp_output) {
         draw_precipitation();
@@ -108,10 +161,12 @@ void GameplayState::do_game_drawing(
     
     //Layer 5 -- Tree shadows.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- Tree shadows");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_DRAWING_TREE_SHADOWS
+        );
     }
     if(!(bmp_output && !bmp_settings.shadows)) {
-        draw_tree_shadows();
+        draw_tree_shadows(bmp_output);
     }
     if(game.perf_mon) {
         game.perf_mon->finish_measurement();
@@ -130,7 +185,7 @@ void GameplayState::do_game_drawing(
     
     //Layer 6 -- Lighting filter.
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- Lighting");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_DRAWING_LIGHTING);
     }
     draw_lighting_filter();
     if(game.perf_mon) {
@@ -154,7 +209,7 @@ void GameplayState::do_game_drawing(
     al_use_transform(&game.identity_transform);
     
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Drawing -- HUD");
+        game.perf_mon->start_measurement(PERF_MON_MEASUREMENT_DRAWING_HUD);
     }
     
     if(game.maker_tools.hud) {
@@ -195,6 +250,10 @@ void GameplayState::do_game_drawing(
         
     }
     
+    if(game.maker_tools.perf_overlay) {
+        draw_perf_overlay();
+    }
+    
     draw_debug_tools();
 }
 
@@ -267,6 +326,100 @@ void GameplayState::draw_background(ALLEGRO_BITMAP* bmp_output) {
 }
 
 
+/**
+ * @brief Draws the baked floors of all static sectors at a given Z
+ * that are in view. Tiles that weren't baked yet get baked now, at the
+ * current zoom level.
+ *
+ * @param z Z of the sectors.
+ * @param view_tl Top-left corner of the region of the world in view.
+ * @param view_br Bottom-right corner of the region of the world in view.
+ */
+void GameplayState::draw_baked_sectors(
+    float z, const Point &view_tl, const Point &view_br
+) {
+    float tile_world_size =
+        GAMEPLAY::BAKED_SECTOR_TILE_SIZE / game.cam.zoom;
+    int col1 = floor(view_tl.x / tile_world_size);
+    int col2 = floor(view_br.x / tile_world_size);
+    int row1 = floor(view_tl.y / tile_world_size);
+    int row2 = floor(view_br.y / tile_world_size);
+    
+    for(int row = row1; row <= row2; row++) {
+        for(int col = col1; col <= col2; col++) {
+            Point tile_tl(col * tile_world_size, row * tile_world_size);
+            Point tile_br = tile_tl + tile_world_size;
+            
+            auto t_it = baked_sector_tiles.find(std::make_tuple(z, col, row));
+            if(t_it == baked_sector_tiles.end()) {
+                //Bake it now.
+                BakedSectorTile new_tile;
+                ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+                ALLEGRO_TRANSFORM old_transform;
+                al_copy_transform(&old_transform, al_get_current_transform());
+                ALLEGRO_TRANSFORM tile_transform;
+                al_identity_transform(&tile_transform);
+                al_translate_transform(
+                    &tile_transform, -tile_tl.x, -tile_tl.y
+                );
+                al_scale_transform(
+                    &tile_transform, game.cam.zoom, game.cam.zoom
+                );
+                
+                for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+                    Sector* s_ptr = game.cur_area_data->sectors[s];
+                    if(s_ptr->z != z) continue;
+                    if(bakeable_sectors.find(s_ptr) == bakeable_sectors.end()) {
+                        continue;
+                    }
+                    if(
+                        !rectangles_intersect(
+                            s_ptr->bbox[0], s_ptr->bbox[1], tile_tl, tile_br
+                        )
+                    ) {
+                        continue;
+                    }
+                    
+                    if(!new_tile.bitmap) {
+                        new_tile.bitmap =
+                            al_create_bitmap(
+                                GAMEPLAY::BAKED_SECTOR_TILE_SIZE,
+                                GAMEPLAY::BAKED_SECTOR_TILE_SIZE
+                            );
+                        if(!new_tile.bitmap) break;
+                        al_set_target_bitmap(new_tile.bitmap);
+                        al_clear_to_color(COLOR_EMPTY);
+                        al_use_transform(&tile_transform);
+                    }
+                    
+                    draw_sector_texture(s_ptr, Point(), 1.0f, 1.0f);
+                }
+                
+                if(new_tile.bitmap) {
+                    al_set_target_bitmap(old_target);
+                    al_use_transform(&old_transform);
+                }
+                t_it =
+                    baked_sector_tiles.insert(
+                        std::make_pair(std::make_tuple(z, col, row), new_tile)
+                    ).first;
+            }
+            
+            t_it->second.used = true;
+            if(!t_it->second.bitmap) continue;
+            al_draw_scaled_bitmap(
+                t_it->second.bitmap,
+                0, 0,
+                GAMEPLAY::BAKED_SECTOR_TILE_SIZE,
+                GAMEPLAY::BAKED_SECTOR_TILE_SIZE,
+                tile_tl.x, tile_tl.y, tile_world_size, tile_world_size,
+                0
+            );
+        }
+    }
+}
+
+
 /**
  * @brief Draws the current big message, if any.
  */
@@ -395,8 +548,8 @@ void GameplayState::draw_debug_tools() {
     const float RAW_STICK_VIEWER_SIZE = 100;
     
     point raw_stick_coords;
-    raw_stick_coords.x = game.controls.mgr.rawSticks[0][0][0];
-    raw_stick_coords.y = game.controls.mgr.rawSticks[0][0][1];
+    raw_stick_coords.x = game.controls.mgr.getRawStickAxis(0, 0, 0);
+    raw_stick_coords.y = game.controls.mgr.getRawStickAxis(0, 0, 1);
     float raw_stick_angle;
     float raw_stick_mag;
     coordinates_to_angle(
@@ -634,18 +787,38 @@ void GameplayState::draw_debug_tools() {
  * @brief Draws the in-game text.
  */
 void GameplayState::draw_ingame_text() {
-    //Mob things.
     size_t n_mobs = mobs.all.size();
+    
+    //Health wheels, all in one go.
+    health_wheel_vertexes.clear();
     for(size_t m = 0; m < n_mobs; m++) {
         Mob* mob_ptr = mobs.all[m];
-        
-        //Fractions and health.
         if(mob_ptr->health_wheel) {
-            mob_ptr->health_wheel->draw();
+            mob_ptr->health_wheel->add_vertexes(health_wheel_vertexes);
         }
+    }
+    if(!health_wheel_vertexes.empty()) {
+        al_draw_prim(
+            health_wheel_vertexes.data(), nullptr, nullptr,
+            0, (int) health_wheel_vertexes.size(), ALLEGRO_PRIM_TRIANGLE_LIST
+        );
+    }
+    
+    //Fractions. Their glyphs all come from the same font bitmaps,
+    //so holding lets Allegro draw them together.
+    al_hold_bitmap_drawing(true);
+    for(size_t m = 0; m < n_mobs; m++) {
+        Mob* mob_ptr = mobs.all[m];
         if(mob_ptr->fraction) {
             mob_ptr->fraction->draw();
         }
+    }
+    al_hold_bitmap_drawing(false);
+    
+    //Mob things. The shapes are batched, since with many mobs around,
+    //drawing them one by one would slow down the very thing being debugged.
+    for(size_t m = 0; m < n_mobs; m++) {
+        Mob* mob_ptr = mobs.all[m];
         
         //Maker tool -- draw hitboxes.
         if(game.maker_tools.hitboxes) {
@@ -671,7 +844,7 @@ void GameplayState::draw_ingame_text() {
                     }
                     Point p =
                         mob_ptr->pos + rotate_point(h_ptr->pos, mob_ptr->angle);
-                    al_draw_filled_circle(p.x, p.y, h_ptr->radius, hc);
+                    debug_draw_batch.add_filled_circle(p, h_ptr->radius, hc);
                 }
             }
         }
@@ -687,9 +860,8 @@ void GameplayState::draw_ingame_text() {
                         Point p =
                             mob_ptr->pos +
                             rotate_point(h_ptr->pos, mob_ptr->angle);
-                        al_draw_circle(
-                            p.x, p.y,
-                            h_ptr->radius, COLOR_WHITE, 1
+                        debug_draw_batch.add_circle(
+                            p, h_ptr->radius, COLOR_WHITE, 1
                         );
                     }
                 }
@@ -702,7 +874,7 @@ void GameplayState::draw_ingame_text() {
                     mob_ptr->rectangular_dim.x / 2.0f,
                     mob_ptr->rectangular_dim.y / 2.0f
                 );
-                vector<Point> rect_vertices {
+                Point rect_vertices[] {
                     rotate_point(tl, mob_ptr->angle) +
                     mob_ptr->pos,
                     rotate_point(Point(tl.x, br.y),  mob_ptr->angle) +
@@ -712,22 +884,13 @@ void GameplayState::draw_ingame_text() {
                     rotate_point(Point(br.x, tl.y), mob_ptr->angle) +
                     mob_ptr->pos
                 };
-                float vertices[] {
-                    rect_vertices[0].x,
-                    rect_vertices[0].y,
-                    rect_vertices[1].x,
-                    rect_vertices[1].y,
-                    rect_vertices[2].x,
-                    rect_vertices[2].y,
-                    rect_vertices[3].x,
-                    rect_vertices[3].y
-                };
                 
-                al_draw_polygon(vertices, 4, 0, COLOR_WHITE, 1, 10);
+                debug_draw_batch.add_polygon(
+                    rect_vertices, 4, COLOR_WHITE, 1
+                );
             } else {
-                al_draw_circle(
-                    mob_ptr->pos.x, mob_ptr->pos.y,
-                    mob_ptr->radius, COLOR_WHITE, 1
+                debug_draw_batch.add_circle(
+                    mob_ptr->pos, mob_ptr->radius, COLOR_WHITE, 1
                 );
             }
         }
@@ -749,18 +912,12 @@ void GameplayState::draw_ingame_text() {
         
             //Faint lines for the entire path.
             for(size_t s = 0; s < path->path.size() - 1; s++) {
-                bool is_blocked = false;
                 PathLink* l_ptr = path->path[s]->get_link(path->path[s + 1]);
-                auto l_it = path_mgr.obstructions.find(l_ptr);
-                if(l_it != path_mgr.obstructions.end()) {
-                    is_blocked = !l_it->second.empty();
-                }
+                bool is_blocked = l_ptr && l_ptr->n_obstacles > 0;
                 
-                al_draw_line(
-                    path->path[s]->pos.x,
-                    path->path[s]->pos.y,
-                    path->path[s + 1]->pos.x,
-                    path->path[s + 1]->pos.y,
+                debug_draw_batch.add_line(
+                    path->path[s]->pos,
+                    path->path[s + 1]->pos,
                     is_blocked ?
                     al_map_rgba(200, 0, 0, 150) :
                     al_map_rgba(0, 0, 200, 150),
@@ -769,15 +926,13 @@ void GameplayState::draw_ingame_text() {
             }
             
             //Colored circles for the first and last stops.
-            al_draw_filled_circle(
-                path->path[0]->pos.x,
-                path->path[0]->pos.y,
+            debug_draw_batch.add_filled_circle(
+                path->path[0]->pos,
                 16.0f,
                 al_map_rgba(192, 0, 0, 200)
             );
-            al_draw_filled_circle(
-                path->path.back()->pos.x,
-                path->path.back()->pos.y,
+            debug_draw_batch.add_filled_circle(
+                path->path.back()->pos,
                 16.0f,
                 al_map_rgba(0, 192, 0, 200)
             );
@@ -791,11 +946,9 @@ void GameplayState::draw_ingame_text() {
         ) {
             bool is_blocked = path->block_reason != PATH_BLOCK_REASON_NONE;
             //Line directly to the target.
-            al_draw_line(
-                game.maker_tools.info_lock->pos.x,
-                game.maker_tools.info_lock->pos.y,
-                target_pos.x,
-                target_pos.y,
+            debug_draw_batch.add_line(
+                game.maker_tools.info_lock->pos,
+                target_pos,
                 is_blocked ?
                 al_map_rgba(255, 0, 0, 200) :
                 al_map_rgba(0, 0, 255, 200),
@@ -804,19 +957,16 @@ void GameplayState::draw_ingame_text() {
         } else if(path->cur_path_stop_idx < path->path.size()) {
             bool is_blocked = path->block_reason != PATH_BLOCK_REASON_NONE;
             //Line to the next stop, and circle for the next stop in blue.
-            al_draw_line(
-                game.maker_tools.info_lock->pos.x,
-                game.maker_tools.info_lock->pos.y,
-                path->path[path->cur_path_stop_idx]->pos.x,
-                path->path[path->cur_path_stop_idx]->pos.y,
+            debug_draw_batch.add_line(
+                game.maker_tools.info_lock->pos,
+                path->path[path->cur_path_stop_idx]->pos,
                 is_blocked ?
                 al_map_rgba(255, 0, 0, 200) :
                 al_map_rgba(0, 0, 255, 200),
                 4.0f
             );
-            al_draw_filled_circle(
-                path->path[path->cur_path_stop_idx]->pos.x,
-                path->path[path->cur_path_stop_idx]->pos.y,
+            debug_draw_batch.add_filled_circle(
+                path->path[path->cur_path_stop_idx]->pos,
                 10.0f,
                 is_blocked ?
                 al_map_rgba(192, 0, 0, 200) :
@@ -825,16 +975,13 @@ void GameplayState::draw_ingame_text() {
         }
         
         //Square on the target spot, and target distance.
-        al_draw_filled_rectangle(
-            target_pos.x - 8.0f,
-            target_pos.y - 8.0f,
-            target_pos.x + 8.0f,
-            target_pos.y + 8.0f,
+        debug_draw_batch.add_filled_rectangle(
+            target_pos - 8.0f,
+            target_pos + 8.0f,
             al_map_rgba(0, 192, 0, 200)
         );
-        al_draw_circle(
-            target_pos.x,
-            target_pos.y,
+        debug_draw_batch.add_circle(
+            target_pos,
             path->settings.final_target_distance,
             al_map_rgba(0, 255, 0, 200),
             1.0f
@@ -853,6 +1000,8 @@ void GameplayState::draw_ingame_text() {
         }
     }
     
+    debug_draw_batch.flush();
+    
     notification.draw();
 }
 
@@ -994,17 +1143,10 @@ void GameplayState::draw_leader_cursor(const ALLEGRO_COLOR &color) {
     //Standby type count.
     size_t n_standby_pikmin = 0;
     if(cur_leader_ptr->group->cur_standby_type) {
-        for(
-            size_t m = 0; m < cur_leader_ptr->group->members.size(); m++
-        ) {
-            Mob* m_ptr = cur_leader_ptr->group->members[m];
-            if(
-                m_ptr->subgroup_type_ptr ==
+        n_standby_pikmin =
+            cur_leader_ptr->group->get_amount_by_subgroup_type(
                 cur_leader_ptr->group->cur_standby_type
-            ) {
-                n_standby_pikmin++;
-            }
-        }
+            );
     }
     
     al_use_transform(&game.identity_transform);
@@ -1032,75 +1174,41 @@ void GameplayState::draw_leader_cursor(const ALLEGRO_COLOR &color) {
 void GameplayState::draw_lighting_filter() {
     al_use_transform(&game.identity_transform);
     
-    //Draw the fog effect.
+    //Draw the fog and the daylight, in one full-screen pass.
     ALLEGRO_COLOR fog_c =
         game.cur_area_data->weather_condition.get_fog_color();
-    if(fog_c.a > 0) {
-        //Start by drawing the central fog fade out effect.
-        
-        Point fog_top_left =
-            game.cam.pos -
-            Point(
-                game.cur_area_data->weather_condition.fog_far,
-                game.cur_area_data->weather_condition.fog_far
-            );
-        Point fog_bottom_right =
-            game.cam.pos +
-            Point(
-                game.cur_area_data->weather_condition.fog_far,
-                game.cur_area_data->weather_condition.fog_far
-            );
+    ALLEGRO_COLOR daylight_c =
+        game.cur_area_data->weather_condition.get_daylight_color();
+    if(fog_c.a > 0 || daylight_c.a > 0) {
+        float fog_near = game.cur_area_data->weather_condition.fog_near;
+        float fog_far = game.cur_area_data->weather_condition.fog_far;
+        Point fog_center = game.cam.pos;
+        Point fog_edge = game.cam.pos + Point(fog_far, 0.0f);
         al_transform_coordinates(
             &game.world_to_screen_transform,
-            &fog_top_left.x, &fog_top_left.y
+            &fog_center.x, &fog_center.y
         );
         al_transform_coordinates(
             &game.world_to_screen_transform,
-            &fog_bottom_right.x, &fog_bottom_right.y
-        );
-        
-        if(bmp_fog) {
-            draw_bitmap(
-                bmp_fog,
-                (fog_top_left + fog_bottom_right) / 2,
-                (fog_bottom_right - fog_top_left),
-                0, fog_c
-            );
-        }
-        
-        //Now draw the fully opaque fog around the central fade.
-        //Top-left and top-center.
-        al_draw_filled_rectangle(
-            0, 0,
-            fog_bottom_right.x, fog_top_left.y,
-            fog_c
-        );
-        //Top-right and center-right.
-        al_draw_filled_rectangle(
-            fog_bottom_right.x, 0,
-            game.win_w, fog_bottom_right.y,
-            fog_c
-        );
-        //Bottom-right and bottom-center.
-        al_draw_filled_rectangle(
-            fog_top_left.x, fog_bottom_right.y,
-            game.win_w, game.win_h,
-            fog_c
-        );
-        //Bottom-left and center-left.
-        al_draw_filled_rectangle(
-            0, fog_top_left.y,
-            fog_top_left.x, game.win_h,
-            fog_c
+            &fog_edge.x, &fog_edge.y
         );
-        
-    }
-    
-    //Draw the daylight.
-    ALLEGRO_COLOR daylight_c =
-        game.cur_area_data->weather_condition.get_daylight_color();
-    if(daylight_c.a > 0) {
-        al_draw_filled_rectangle(0, 0, game.win_w, game.win_h, daylight_c);
+        float screen_fog_far = fog_edge.x - fog_center.x;
+        float screen_fog_near =
+            fog_far == 0.0f ? 0.0f : fog_near / fog_far * screen_fog_far;
+        float fog_center_v[2] = { fog_center.x, fog_center.y };
+        float fog_c_v[4] = { fog_c.r, fog_c.g, fog_c.b, fog_c.a };
+        float daylight_c_v[4] = {
+            daylight_c.r, daylight_c.g, daylight_c.b, daylight_c.a
+        };
+        
+        al_use_shader(game.shaders.get_shader(SHADER_TYPE_LIGHTING));
+        al_set_shader_float_vector("fog_center", 2, fog_center_v, 1);
+        al_set_shader_float("fog_near", screen_fog_near);
+        al_set_shader_float("fog_far", screen_fog_far);
+        al_set_shader_float_vector("fog_color", 4, fog_c_v, 1);
+        al_set_shader_float_vector("daylight_color", 4, daylight_c_v, 1);
+        al_draw_filled_rectangle(0, 0, game.win_w, game.win_h, COLOR_WHITE);
+        al_use_shader(NULL);
     }
     
     //Draw the blackout effect.
@@ -1378,21 +1486,287 @@ void GameplayState::draw_pause_menu() {
 
 
 /**
- * @brief Draws the precipitation.
+ * @brief Draws the performance overlay, with a graph of the latest frame
+ * times, their percentiles, how long each system took in the latest frame,
+ * and how many things exist.
+ */
+void GameplayState::draw_perf_overlay() {
+    const float padding = 4.0f;
+    const float line_height = 12.0f;
+    const float graph_height = 60.0f;
+    const float bar_height = 8.0f;
+    const float width = GAMEPLAY::PERF_OVERLAY_GRAPH_SAMPLES + padding * 2.0f;
+    const double budget = 1.0 / game.options.advanced.target_fps;
+    const ALLEGRO_COLOR text_color = al_map_rgb(255, 255, 255);
+    const ALLEGRO_COLOR system_colors[] = {
+        al_map_rgb(224, 96, 96), al_map_rgb(96, 192, 96),
+        al_map_rgb(96, 128, 224), al_map_rgb(224, 192, 64),
+        al_map_rgb(192, 96, 224), al_map_rgb(64, 208, 208),
+    };
+    const size_t nr_system_colors =
+        sizeof(system_colors) / sizeof(system_colors[0]);
+        
+    //Gather the frames inside the time window, for the percentiles.
+    double now = al_get_time();
+    perf_overlay_window_durs.clear();
+    for(size_t f = 0; f < perf_overlay_frame_durs.size(); f++) {
+        if(perf_overlay_frame_times[f] == 0.0) continue;
+        if(
+            now - perf_overlay_frame_times[f] >
+            GAMEPLAY::PERF_OVERLAY_WINDOW
+        ) {
+            continue;
+        }
+        perf_overlay_window_durs.push_back(perf_overlay_frame_durs[f]);
+    }
+    auto get_percentile = [this] (float percentile) {
+        if(perf_overlay_window_durs.empty()) return 0.0;
+        size_t idx =
+            std::min(
+                (size_t) (percentile * perf_overlay_window_durs.size()),
+                perf_overlay_window_durs.size() - 1
+            );
+        std::nth_element(
+            perf_overlay_window_durs.begin(),
+            perf_overlay_window_durs.begin() + idx,
+            perf_overlay_window_durs.end()
+        );
+        return perf_overlay_window_durs[idx];
+    };
+    
+    //Gather the text lines.
+    vector<std::pair<string, ALLEGRO_COLOR> > lines;
+    const int percentiles[] = { 50, 95, 99 };
+    for(size_t p = 0; p < 3; p++) {
+        lines.push_back(
+            std::make_pair(
+                "p" + i2s(percentiles[p]) + ": " +
+                f2s(get_percentile(percentiles[p] / 100.0f) * 1000.0f) +
+                " ms",
+                text_color
+            )
+        );
+    }
+    lines.push_back(
+        std::make_pair(
+            "Mobs: " + i2s(mobs.all.size()) +
+            "  Particles: " + i2s(particles.get_count()) +
+            "  Sounds: " + i2s(game.audio.get_nr_playbacks()),
+            text_color
+        )
+    );
+    if(!memory_report.empty()) {
+        size_t total_memory = 0;
+        for(size_t r = 0; r < memory_report.size(); r++) {
+            total_memory += memory_report[r].second;
+        }
+        lines.push_back(
+            std::make_pair(
+                "Memory (estimate): " + i2s(total_memory / 1024) + " KiB",
+                text_color
+            )
+        );
+        for(size_t r = 0; r < memory_report.size(); r++) {
+            lines.push_back(
+                std::make_pair(
+                    "  " + memory_report[r].first + ": " +
+                    i2s(memory_report[r].second / 1024) + " KiB",
+                    text_color
+                )
+            );
+        }
+    }
+    
+    //Gather the outermost measurements of the latest frame.
+    vector<std::pair<size_t, double> > systems;
+    double frame_dur = 0.0;
+    if(game.perf_mon) {
+        frame_dur = game.perf_mon->get_last_frame_duration();
+        for(size_t m = 0; m < game.perf_mon->get_nr_measurements(); m++) {
+            if(game.perf_mon->get_measurement_depth(m) != 0) continue;
+            double dur = game.perf_mon->get_last_frame_measurement_dur(m);
+            if(dur <= 0.0) continue;
+            systems.push_back(std::make_pair(m, dur));
+        }
+        if(code_debug_alloc_counting) {
+            lines.push_back(
+                std::make_pair(
+                    "Allocations: " +
+                    i2s(game.perf_mon->get_last_frame_nr_allocs()),
+                    text_color
+                )
+            );
+        }
+        for(size_t s = 0; s < systems.size(); s++) {
+            string line =
+                game.perf_mon->get_measurement_name(systems[s].first) +
+                ": " + f2s(systems[s].second * 1000.0f) + " ms";
+            if(code_debug_alloc_counting) {
+                line +=
+                    ", " +
+                    i2s(
+                        game.perf_mon->get_last_frame_measurement_nr_allocs(
+                            systems[s].first
+                        )
+                    ) + " allocs";
+            }
+            lines.push_back(
+                std::make_pair(line, system_colors[s % nr_system_colors])
+            );
+        }
+        vector<std::pair<double, const string*> > mob_types =
+            game.perf_mon->get_last_frame_hottest_mob_types(
+                GAMEPLAY::PERF_OVERLAY_MAX_MOB_TYPES
+            );
+        for(size_t t = 0; t < mob_types.size(); t++) {
+            lines.push_back(
+                std::make_pair(
+                    "#" + i2s(t + 1) + " " + *mob_types[t].second + ": " +
+                    f2s(mob_types[t].first * 1000.0f) + " ms",
+                    text_color
+                )
+            );
+        }
+        if(game.perf_mon->is_profiling_scripts()) {
+            vector<std::pair<double, string> > script_events =
+                game.perf_mon->get_last_frame_hottest_script_events(
+                    GAMEPLAY::PERF_OVERLAY_MAX_SCRIPT_COSTS
+                );
+            for(size_t e = 0; e < script_events.size(); e++) {
+                lines.push_back(
+                    std::make_pair(
+                        "Event: " + script_events[e].second + ": " +
+                        f2s(script_events[e].first * 1000.0f) + " ms",
+                        text_color
+                    )
+                );
+            }
+            vector<std::pair<double, string> > script_actions =
+                game.perf_mon->get_last_frame_hottest_script_actions(
+                    GAMEPLAY::PERF_OVERLAY_MAX_SCRIPT_COSTS
+                );
+            for(size_t a = 0; a < script_actions.size(); a++) {
+                lines.push_back(
+                    std::make_pair(
+                        "Action: " + script_actions[a].second + ": " +
+                        f2s(script_actions[a].first * 1000.0f) + " ms",
+                        text_color
+                    )
+                );
+            }
+        }
+    } else {
+        lines.push_back(
+            std::make_pair(
+                "No perf. monitor, so no system breakdown.",
+                text_color
+            )
+        );
+    }
+    
+    //Background.
+    float total_height =
+        padding * 2.0f + graph_height + padding +
+        (systems.empty() ? 0.0f : bar_height + padding) +
+        lines.size() * line_height;
+    Point tl(8.0f, game.win_h - 8.0f - total_height);
+    al_draw_filled_rectangle(
+        tl.x, tl.y, tl.x + width, tl.y + total_height,
+        al_map_rgba(0, 0, 0, 160)
+    );
+    
+    //Frame time graph. The top of the graph is twice the budget.
+    float graph_bottom = tl.y + padding + graph_height;
+    size_t nr_samples = perf_overlay_frame_durs.size();
+    for(size_t s = 0; s < GAMEPLAY::PERF_OVERLAY_GRAPH_SAMPLES; s++) {
+        size_t idx =
+            (
+                perf_overlay_next_idx + nr_samples -
+                GAMEPLAY::PERF_OVERLAY_GRAPH_SAMPLES + s
+            ) % nr_samples;
+        double dur = perf_overlay_frame_durs[idx];
+        if(dur == 0.0) continue;
+        float h =
+            std::min((float) (dur / (budget * 2.0)), 1.0f) * graph_height;
+        al_draw_line(
+            tl.x + padding + s + 0.5f, graph_bottom,
+            tl.x + padding + s + 0.5f, graph_bottom - h,
+            dur > budget ?
+            al_map_rgb(224, 96, 96) :
+            al_map_rgb(96, 192, 96),
+            1.0f
+        );
+    }
+    al_draw_line(
+        tl.x + padding, graph_bottom - graph_height / 2.0f,
+        tl.x + width - padding, graph_bottom - graph_height / 2.0f,
+        al_map_rgba(255, 255, 255, 96), 1.0f
+    );
+    float cur_y = graph_bottom + padding;
+    
+    //Stacked bar of the systems. Its full width is the budget, or the
+    //frame's duration if that's longer.
+    if(!systems.empty()) {
+        double bar_total = std::max(budget, frame_dur);
+        float bar_x = tl.x + padding;
+        for(size_t s = 0; s < systems.size(); s++) {
+            float w =
+                (float) (systems[s].second / bar_total) *
+                GAMEPLAY::PERF_OVERLAY_GRAPH_SAMPLES;
+            al_draw_filled_rectangle(
+                bar_x, cur_y, bar_x + w, cur_y + bar_height,
+                system_colors[s % nr_system_colors]
+            );
+            bar_x += w;
+        }
+        cur_y += bar_height + padding;
+    }
+    
+    //Text.
+    for(size_t l = 0; l < lines.size(); l++) {
+        draw_text(
+            lines[l].first, game.sys_content.fnt_builtin,
+            Point(tl.x + padding, cur_y + l * line_height),
+            Point(LARGE_FLOAT, line_height), lines[l].second,
+            ALLEGRO_ALIGN_LEFT, V_ALIGN_MODE_TOP
+        );
+    }
+}
+
+
+/**
+ * @brief Draws the precipitation. The drops are all placed by the
+ * precipitation shader, so this is just one draw call.
  */
 void GameplayState::draw_precipitation() {
     if(
-        game.cur_area_data->weather_condition.precipitation_type !=
-        PRECIPITATION_TYPE_NONE
+        game.cur_area_data->weather_condition.precipitation_type ==
+        PRECIPITATION_TYPE_NONE ||
+        !precipitation_vertex_buffer
     ) {
-        size_t n_precipitation_particles = precipitation.size();
-        for(size_t p = 0; p < n_precipitation_particles; p++) {
-            al_draw_filled_circle(
-                precipitation[p].x, precipitation[p].y,
-                3, COLOR_WHITE
-            );
-        }
+        return;
     }
+    
+    float view_tl[2] = { game.cam.box[0].x, game.cam.box[0].y };
+    float view_size[2] = {
+        game.cam.box[1].x - game.cam.box[0].x,
+        game.cam.box[1].y - game.cam.box[0].y
+    };
+    
+    al_use_transform(&game.world_to_screen_transform);
+    al_use_shader(game.shaders.get_shader(SHADER_TYPE_PRECIPITATION));
+    al_set_shader_float("area_time", area_time_passed);
+    al_set_shader_float("seed", precipitation_seed);
+    al_set_shader_float_vector("view_tl", 2, view_tl, 1);
+    al_set_shader_float_vector("view_size", 2, view_size, 1);
+    al_set_shader_float("drop_size", GAMEPLAY::PRECIPITATION_DROP_SIZE);
+    al_set_shader_float("fall_speed", GAMEPLAY::PRECIPITATION_SPEED);
+    al_draw_vertex_buffer(
+        precipitation_vertex_buffer, nullptr,
+        0, (int) GAMEPLAY::PRECIPITATION_NR_DROPS * 6,
+        ALLEGRO_PRIM_TRIANGLE_LIST
+    );
+    al_use_shader(NULL);
 }
 
 
@@ -1505,26 +1879,6 @@ void GameplayState::draw_throw_preview() {
         return;
     }
     
-    //Check which edges exist near the throw.
-    set<Edge*> candidate_edges;
-    
-    game.cur_area_data->bmap.get_edges_in_region(
-        Point(
-            std::min(cur_leader_ptr->pos.x, throw_dest.x),
-            std::min(cur_leader_ptr->pos.y, throw_dest.y)
-        ),
-        Point(
-            std::max(cur_leader_ptr->pos.x, throw_dest.x),
-            std::max(cur_leader_ptr->pos.y, throw_dest.y)
-        ),
-        candidate_edges
-    );
-    
-    float wall_collision_r = 2.0f;
-    bool wall_is_blocking_sector = false;
-    Distance leader_to_dest_dist(
-        cur_leader_ptr->pos, throw_dest
-    );
     float throw_h_angle = 0.0f;
     float throw_v_angle = 0.0f;
     float throw_speed = 0.0f;
@@ -1543,96 +1897,56 @@ void GameplayState::draw_throw_preview() {
             GAMEPLAY::PREVIEW_TEXTURE_SCALE
         );
         
-    //For each edge, check if it crosses the throw line.
-    for(Edge* e : candidate_edges) {
-        if(!e->sectors[0] || !e->sectors[1]) {
-            continue;
-        }
+    //The wall collision only needs to be found again if the throw
+    //changed noticeably, or if the walls could have moved since.
+    ThrowPreviewCollision &col = throw_preview_collision;
+    if(
+        !col.valid ||
+        col.throwee_type != cur_leader_ptr->throwee->type ||
+        fabs(col.leader_z - cur_leader_ptr->z) >
+        GAMEPLAY::PREVIEW_CACHE_TOLERANCE ||
+        Distance(col.leader_pos, cur_leader_ptr->pos) >
+        GAMEPLAY::PREVIEW_CACHE_TOLERANCE ||
+        Distance(col.throw_dest, throw_dest) >
+        GAMEPLAY::PREVIEW_CACHE_TOLERANCE ||
+        area_time_passed - col.calculation_time >
+        GAMEPLAY::PREVIEW_CACHE_MAX_AGE
+    ) {
+        update_throw_preview_collision(throw_v_angle, throw_speed);
+    }
+    float wall_collision_r = col.wall_collision_r;
+    bool wall_is_blocking_sector = col.wall_is_blocking_sector;
+    
+    /*
+     * Time to draw. There are three possible scenarios.
+     * 1. Nothing interrupts the throw, so we can draw directly from
+     *   the leader to the throw destination.
+     * 2. The throwee could never reach because it's too high, so draw the
+     *   line colliding against the edge.
+     * 3. The throwee will collide against a wall, but can theoretically reach
+     *   the target, since it's within the height limit. After the wall
+     *   collision, its trajectory is unpredictable.
+     */
+    
+    if(wall_collision_r > 1.0f) {
+        //No collision. Free throw.
         
-        float r = 0.0f;
-        if(
-            !line_segs_intersect(
+        unsigned char n_vertexes =
+            get_throw_preview_vertexes(
+                vertexes, 0.0f, 1.0f,
                 cur_leader_ptr->pos, throw_dest,
-                v2p(e->vertexes[0]), v2p(e->vertexes[1]),
-                &r, nullptr
-            )
-        ) {
-            //No collision.
-            continue;
-        }
-        
-        //If this is a blocking sector then yeah, collision.
-        if(
-            (
-                e->sectors[0]->type == SECTOR_TYPE_BLOCKING ||
-                e->sectors[1]->type == SECTOR_TYPE_BLOCKING
-            ) &&
-            r < wall_collision_r
-        ) {
-            wall_collision_r = r;
-            wall_is_blocking_sector = true;
-            continue;
-        }
-        
-        //Otherwise, let's check for walls.
-        
-        if(e->sectors[0]->z == e->sectors[1]->z) {
-            //Edges where both sectors have the same height have no wall.
-            continue;
-        }
-        
-        //Calculate the throwee's vertical position at that point.
-        float edge_z = std::max(e->sectors[0]->z, e->sectors[1]->z);
-        float x_at_edge =
-            leader_to_dest_dist.to_float() * r;
-        float y_at_edge =
-            tan(throw_v_angle) * x_at_edge -
-            (
-                -MOB::GRAVITY_ADDER /
-                (
-                    2 * throw_speed * throw_speed *
-                    cos(throw_v_angle) * cos(throw_v_angle)
-                )
-            ) * x_at_edge * x_at_edge;
-        y_at_edge += cur_leader_ptr->z;
-        
-        //If the throwee would hit the wall at these coordinates, collision.
-        if(edge_z >= y_at_edge && r < wall_collision_r) {
-            wall_collision_r = r;
-            wall_is_blocking_sector = false;
-        }
-    }
-    
-    /*
-     * Time to draw. There are three possible scenarios.
-     * 1. Nothing interrupts the throw, so we can draw directly from
-     *   the leader to the throw destination.
-     * 2. The throwee could never reach because it's too high, so draw the
-     *   line colliding against the edge.
-     * 3. The throwee will collide against a wall, but can theoretically reach
-     *   the target, since it's within the height limit. After the wall
-     *   collision, its trajectory is unpredictable.
-     */
-    
-    if(wall_collision_r > 1.0f) {
-        //No collision. Free throw.
-        
-        unsigned char n_vertexes =
-            get_throw_preview_vertexes(
-                vertexes, 0.0f, 1.0f,
-                cur_leader_ptr->pos, throw_dest,
-                change_alpha(
-                    cur_leader_ptr->throwee->type->main_color,
-                    GAMEPLAY::PREVIEW_OPACITY
-                ),
-                texture_offset, GAMEPLAY::PREVIEW_TEXTURE_SCALE, true
-            );
-            
-        for(unsigned char v = 0; v < n_vertexes; v += 4) {
-            al_draw_prim(
-                vertexes, nullptr, game.sys_content.bmp_throw_preview,
-                v, v + 4, ALLEGRO_PRIM_TRIANGLE_FAN
-            );
+                change_alpha(
+                    cur_leader_ptr->throwee->type->main_color,
+                    GAMEPLAY::PREVIEW_OPACITY
+                ),
+                texture_offset, GAMEPLAY::PREVIEW_TEXTURE_SCALE, true
+            );
+            
+        for(unsigned char v = 0; v < n_vertexes; v += 4) {
+            al_draw_prim(
+                vertexes, nullptr, game.sys_content.bmp_throw_preview,
+                v, v + 4, ALLEGRO_PRIM_TRIANGLE_FAN
+            );
         }
         
     } else {
@@ -1734,12 +2048,19 @@ void GameplayState::draw_throw_preview() {
 /**
  * @brief Draws the current area and mobs to a bitmap and returns it.
  *
+ * The bitmap is a memory bitmap, so big images don't need to fit in video
+ * memory. The area is drawn onto a video bitmap, one tile at a time,
+ * and each tile's rows are then copied over.
+ *
  * @param settings What settings to use.
- * @return The bitmap.
+ * @return The bitmap, or nullptr on error.
  */
 ALLEGRO_BITMAP* GameplayState::draw_to_bitmap(
     const MakerTools::AreaImageSettings &settings
 ) {
+    //The image can't have any placeholder textures in it.
+    game.sector_textures.wait_for_all();
+    
     //First, get the full dimensions of the map.
     Point min_coords(FLT_MAX, FLT_MAX);
     Point max_coords(-FLT_MAX, -FLT_MAX);
@@ -1766,52 +2087,141 @@ ALLEGRO_BITMAP* GameplayState::draw_to_bitmap(
         final_bmp_w *= area_w / area_h;
     }
     
-    //Create the bitmap.
-    ALLEGRO_BITMAP* bmp = al_create_bitmap(final_bmp_w, final_bmp_h);
+    //Create the bitmaps.
+    int bmp_w = std::max((int) final_bmp_w, 1);
+    int bmp_h = std::max((int) final_bmp_h, 1);
+    int tile_w = std::min(bmp_w, GAMEPLAY::AREA_IMAGE_TILE_SIZE);
+    int tile_h = std::min(bmp_h, GAMEPLAY::AREA_IMAGE_TILE_SIZE);
     
-    ALLEGRO_TRANSFORM t;
-    al_identity_transform(&t);
-    al_translate_transform(
-        &t,
-        -min_coords.x + settings.padding / 2.0f,
-        -min_coords.y + settings.padding / 2.0f
+    int old_bmp_flags = al_get_new_bitmap_flags();
+    al_set_new_bitmap_flags(
+        (old_bmp_flags & ~ALLEGRO_VIDEO_BITMAP) | ALLEGRO_MEMORY_BITMAP
     );
-    al_scale_transform(&t, scale, scale);
+    ALLEGRO_BITMAP* bmp = al_create_bitmap(bmp_w, bmp_h);
+    al_set_new_bitmap_flags(old_bmp_flags);
+    if(!bmp) return nullptr;
+    
+    ALLEGRO_BITMAP* tile_bmp = al_create_bitmap(tile_w, tile_h);
+    if(!tile_bmp) {
+        al_destroy_bitmap(bmp);
+        return nullptr;
+    }
     
     //Begin drawing!
-    do_game_drawing(bmp, &t);
+    for(int tile_y = 0; tile_y < bmp_h; tile_y += tile_h) {
+        for(int tile_x = 0; tile_x < bmp_w; tile_x += tile_w) {
+    
+            ALLEGRO_TRANSFORM t;
+            al_identity_transform(&t);
+            al_translate_transform(
+                &t,
+                -min_coords.x + settings.padding / 2.0f,
+                -min_coords.y + settings.padding / 2.0f
+            );
+            al_scale_transform(&t, scale, scale);
+            al_translate_transform(&t, -tile_x, -tile_y);
+    
+            do_game_drawing(tile_bmp, &t, settings);
+            
+            //Copy the tile's rows over.
+            int copy_w = std::min(tile_w, bmp_w - tile_x);
+            int copy_h = std::min(tile_h, bmp_h - tile_y);
+            ALLEGRO_LOCKED_REGION* tile_region =
+                al_lock_bitmap(
+                    tile_bmp, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE,
+                    ALLEGRO_LOCK_READONLY
+                );
+            ALLEGRO_LOCKED_REGION* bmp_region =
+                al_lock_bitmap_region(
+                    bmp, tile_x, tile_y, copy_w, copy_h,
+                    ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE,
+                    ALLEGRO_LOCK_WRITEONLY
+                );
+            if(tile_region && bmp_region) {
+                for(int y = 0; y < copy_h; y++) {
+                    memcpy(
+                        (char*) bmp_region->data + y * bmp_region->pitch,
+                        (char*) tile_region->data + y * tile_region->pitch,
+                        copy_w * 4
+                    );
+                }
+            }
+            if(bmp_region) al_unlock_bitmap(bmp);
+            if(tile_region) al_unlock_bitmap(tile_bmp);
+        }
+    }
+    
+    //Clean up.
+    al_destroy_bitmap(tile_bmp);
+    if(bmp_output_liquid_limit_effect_buffer) {
+        al_destroy_bitmap(bmp_output_liquid_limit_effect_buffer);
+        bmp_output_liquid_limit_effect_buffer = nullptr;
+    }
+    if(bmp_output_wall_offset_effect_buffer) {
+        al_destroy_bitmap(bmp_output_wall_offset_effect_buffer);
+        bmp_output_wall_offset_effect_buffer = nullptr;
+    }
     
     return bmp;
 }
 
 
 /**
- * @brief Draws tree shadows.
+ * @brief Draws tree shadows. Shadows that share a bitmap are all drawn
+ * in one go, and the tree shadow shader makes them sway.
+ *
+ * @param bmp_output If not nullptr, the shadows are being drawn onto this,
+ * so every shadow gets drawn, and not just the ones in view.
  */
-void GameplayState::draw_tree_shadows() {
-    for(size_t s = 0; s < game.cur_area_data->tree_shadows.size(); s++) {
-        TreeShadow* s_ptr = game.cur_area_data->tree_shadows[s];
+void GameplayState::draw_tree_shadows(ALLEGRO_BITMAP* bmp_output) {
+    if(tree_shadow_batch_bmps.empty()) return;
+    
+    for(size_t b = 0; b < tree_shadow_batches.size(); b++) {
+        tree_shadow_batches[b].clear();
+    }
+    
+    for(size_t s = 0; s < tree_shadow_bboxes.size(); s++) {
+        if(
+            !bmp_output &&
+            !rectangles_intersect(
+                tree_shadow_bboxes[s].first, tree_shadow_bboxes[s].second,
+                game.cam.box[0], game.cam.box[1]
+            )
+        ) {
+            //Off-camera.
+            continue;
+        }
         
-        unsigned char alpha =
-            (
-                (s_ptr->alpha / 255.0) *
-                game.cur_area_data->weather_condition.get_sun_strength()
-            ) * 255;
-            
-        draw_bitmap(
-            s_ptr->bitmap,
-            Point(
-                s_ptr->center.x + GAMEPLAY::TREE_SHADOW_SWAY_AMOUNT*
-                cos(GAMEPLAY::TREE_SHADOW_SWAY_SPEED * area_time_passed) *
-                s_ptr->sway.x,
-                s_ptr->center.y + GAMEPLAY::TREE_SHADOW_SWAY_AMOUNT*
-                sin(GAMEPLAY::TREE_SHADOW_SWAY_SPEED * area_time_passed) *
-                s_ptr->sway.y
-            ),
-            s_ptr->size,
-            s_ptr->angle, map_alpha(alpha)
+        vector<TreeShadowVertex> &batch =
+            tree_shadow_batches[tree_shadow_batch_idxs[s]];
+        batch.insert(
+            batch.end(),
+            tree_shadow_vertexes.begin() + s * 6,
+            tree_shadow_vertexes.begin() + (s + 1) * 6
         );
     }
+    
+    float sway_offset[2] = {
+        GAMEPLAY::TREE_SHADOW_SWAY_AMOUNT *
+        (float) cos(GAMEPLAY::TREE_SHADOW_SWAY_SPEED * area_time_passed),
+        GAMEPLAY::TREE_SHADOW_SWAY_AMOUNT *
+        (float) sin(GAMEPLAY::TREE_SHADOW_SWAY_SPEED * area_time_passed)
+    };
+    
+    al_use_shader(game.shaders.get_shader(SHADER_TYPE_TREE_SHADOW));
+    al_set_shader_float_vector("sway_offset", 2, sway_offset, 1);
+    al_set_shader_float(
+        "opacity", game.cur_area_data->weather_condition.get_sun_strength()
+    );
+    for(size_t b = 0; b < tree_shadow_batches.size(); b++) {
+        if(tree_shadow_batches[b].empty()) continue;
+        al_draw_prim(
+            tree_shadow_batches[b].data(), game.shaders.tree_shadow_vertex_decl,
+            tree_shadow_batch_bmps[b], 0, (int) tree_shadow_batches[b].size(),
+            ALLEGRO_PRIM_TRIANGLE_LIST
+        );
+    }
+    al_use_shader(NULL);
 }
 
 
@@ -1822,79 +2232,153 @@ void GameplayState::draw_tree_shadows() {
  * @param bmp_output If not nullptr, draw the area onto this.
  */
 void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
-    ALLEGRO_BITMAP* custom_wall_offset_effect_buffer = nullptr;
-    ALLEGRO_BITMAP* custom_liquid_limit_effect_buffer = nullptr;
-    if(!bmp_output) {
+    //Region of the world that can be seen.
+    Point view_tl = game.cam.box[0];
+    Point view_br = game.cam.box[1];
+    
+    //Static sector floors can be baked into tiles, but only once the zoom
+    //level stops changing, or else they'd just be baked again every frame.
+    //The same goes for while textures are still arriving.
+    bool bake_sectors = false;
+    if(
+        !game.options.advanced.bake_static_sectors ||
+        game.sector_textures.get_nr_pending() > 0
+    ) {
+        if(!baked_sector_tiles.empty()) clear_baked_sector_tiles();
+        baked_sector_tiles_zoom = 0.0f;
+    } else if(!bmp_output) {
+        if(
+            game.cam.zoom != baked_sector_tiles_zoom ||
+            game.offset_effect_buffers_dirty
+        ) {
+            //Sectors can stop having liquid, which also changes the effects.
+            clear_baked_sector_tiles();
+            update_bakeable_sectors();
+            baked_sector_tiles_zoom = game.cam.zoom;
+        } else {
+            bake_sectors = true;
+        }
+    }
+    
+    if(
+        !bmp_output &&
+        (
+            game.offset_effect_buffers_dirty ||
+            game.offset_effect_buffers_transform !=
+            game.world_to_screen_transform
+        )
+    ) {
+        //The buffers only need to be drawn again if the effects changed,
+        //or if the camera moved.
         update_offset_effect_buffer(
             game.cam.box[0], game.cam.box[1],
             game.liquid_limit_effect_caches,
             game.liquid_limit_effect_buffer,
-            true
+            true,
+            &game.cur_area_data->bmap,
+            game.offset_effect_buffers_scale
         );
         update_offset_effect_buffer(
             game.cam.box[0], game.cam.box[1],
             game.wall_smoothing_effect_caches,
             game.wall_offset_effect_buffer,
-            true
+            true,
+            &game.cur_area_data->bmap,
+            game.offset_effect_buffers_scale
         );
-        update_offset_effect_buffer(
-            game.cam.box[0], game.cam.box[1],
-            game.wall_shadow_effect_caches,
-            game.wall_offset_effect_buffer,
-            false
+        if(game.adaptive_quality.has_wall_shadows()) {
+            update_offset_effect_buffer(
+                game.cam.box[0], game.cam.box[1],
+                game.wall_shadow_effect_caches,
+                game.wall_offset_effect_buffer,
+                false,
+                &game.cur_area_data->bmap,
+                game.offset_effect_buffers_scale
+            );
+        }
+        game.offset_effect_buffers_transform = game.world_to_screen_transform;
+        game.offset_effect_buffers_dirty = false;
+        
+    } else if(bmp_output) {
+        int bmp_w = al_get_bitmap_width(bmp_output);
+        int bmp_h = al_get_bitmap_height(bmp_output);
+        
+        //The view is whatever part of the world lands on the bitmap.
+        ALLEGRO_TRANSFORM bmp_to_world_transform =
+            game.world_to_screen_transform;
+        al_invert_transform(&bmp_to_world_transform);
+        view_tl = Point(0.0f);
+        view_br = Point(bmp_w, bmp_h);
+        al_transform_coordinates(
+            &bmp_to_world_transform, &view_tl.x, &view_tl.y
+        );
+        al_transform_coordinates(
+            &bmp_to_world_transform, &view_br.x, &view_br.y
         );
         
-    } else {
-        custom_liquid_limit_effect_buffer =
-            al_create_bitmap(
-                al_get_bitmap_width(bmp_output),
-                al_get_bitmap_height(bmp_output)
-            );
-        custom_wall_offset_effect_buffer =
-            al_create_bitmap(
-                al_get_bitmap_width(bmp_output),
-                al_get_bitmap_height(bmp_output)
-            );
+        //Keep the same buffers for as long as the bitmap size is the same.
+        ALLEGRO_BITMAP** buffers[2] = {
+            &bmp_output_liquid_limit_effect_buffer,
+            &bmp_output_wall_offset_effect_buffer
+        };
+        for(unsigned char b = 0; b < 2; b++) {
+            if(
+                *buffers[b] &&
+                (
+                    al_get_bitmap_width(*buffers[b]) != bmp_w ||
+                    al_get_bitmap_height(*buffers[b]) != bmp_h
+                )
+            ) {
+                al_destroy_bitmap(*buffers[b]);
+                *buffers[b] = nullptr;
+            }
+            if(!*buffers[b]) {
+                *buffers[b] = al_create_bitmap(bmp_w, bmp_h);
+            }
+        }
+        
+        //Edges outside of the view can still have effects that reach it,
+        //so draw all of them, or else there'd be seams between tiles.
         update_offset_effect_buffer(
             Point(-FLT_MAX), Point(FLT_MAX),
             game.liquid_limit_effect_caches,
-            custom_liquid_limit_effect_buffer,
-            true
+            bmp_output_liquid_limit_effect_buffer,
+            true,
+            &game.cur_area_data->bmap
         );
         update_offset_effect_buffer(
             Point(-FLT_MAX), Point(FLT_MAX),
             game.wall_smoothing_effect_caches,
-            custom_wall_offset_effect_buffer,
-            true
+            bmp_output_wall_offset_effect_buffer,
+            true,
+            &game.cur_area_data->bmap
         );
         update_offset_effect_buffer(
             Point(-FLT_MAX), Point(FLT_MAX),
             game.wall_shadow_effect_caches,
-            custom_wall_offset_effect_buffer,
-            false
+            bmp_output_wall_offset_effect_buffer,
+            false,
+            &game.cur_area_data->bmap
         );
         
     }
     
-    vector<WorldComponent> components;
-    //Let's reserve some space. We might need more or less,
-    //but this is a nice estimate.
-    components.reserve(
-        game.cur_area_data->sectors.size() + //Sectors.
-        mobs.all.size() + //Mob shadows.
-        mobs.all.size() + //Mobs.
-        particles.get_count() //Particles.
-    );
+    //The lists are kept from frame to frame, so after the first few,
+    //they should already have enough memory for everything.
+    vector<WorldComponent> &components = world_components;
+    components.clear();
     
-    //Sectors.
-    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
-        Sector* s_ptr = game.cur_area_data->sectors[s];
+    //Sectors. Only the ones in the blocks the view touches need checking.
+    game.cur_area_data->bmap.get_sectors_in_region(
+        view_tl, view_br, world_sectors
+    );
+    for(size_t s = 0; s < world_sectors.size(); s++) {
+        Sector* s_ptr = world_sectors[s];
         
         if(
-            !bmp_output &&
             !rectangles_intersect(
                 s_ptr->bbox[0], s_ptr->bbox[1],
-                game.cam.box[0], game.cam.box[1]
+                view_tl, view_br
             )
         ) {
             //Off-camera.
@@ -1907,12 +2391,33 @@ void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
         components.push_back(c);
     }
     
-    //Particles.
-    particles.fill_component_list(components, game.cam.box[0], game.cam.box[1]);
+    //Particles. These go in their own list, already sorted, and get
+    //drawn in batches between the other components.
+    vector<WorldComponent> &particle_components = world_particle_components;
+    particle_components.clear();
+    particles.fill_component_list(
+        particle_components, game.cam.box[0], game.cam.box[1]
+    );
     
-    //Mobs.
-    for(size_t m = 0; m < mobs.all.size(); m++) {
-        Mob* mob_ptr = mobs.all[m];
+    //Mobs. Unless everything's being drawn onto a bitmap, only the ones
+    //the mob grid has near the view need checking. The grid only knows
+    //about their footprint, so the view is grown to fit their sprites.
+    vector<size_t> &mob_idxs = world_mob_idxs;
+    if(bmp_output) {
+        mob_idxs.resize(mobs.all.size());
+        for(size_t m = 0; m < mob_idxs.size(); m++) {
+            mob_idxs[m] = m;
+        }
+    } else {
+        add_new_mobs_to_grid();
+        float overhang = std::max(0.0f, mob_grid.get_sprite_overhang());
+        mob_grid.get_mobs_in_region(
+            view_tl - overhang, view_br + overhang, mob_idxs
+        );
+    }
+    
+    for(size_t i = 0; i < mob_idxs.size(); i++) {
+        Mob* mob_ptr = mobs.all[mob_idxs[i]];
         
         if(!bmp_output && mob_ptr->is_off_camera()) {
             //Off-camera.
@@ -1992,19 +2497,7 @@ void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
     }
     
     //Time to draw!
-    for(size_t c = 0; c < components.size(); c++) {
-        components[c].idx = c;
-    }
-    
-    sort(
-        components.begin(), components.end(),
-    [] (const WorldComponent & c1, const WorldComponent & c2) -> bool {
-        if(c1.z == c2.z) {
-            return c1.idx < c2.idx;
-        }
-        return c1.z < c2.z;
-    }
-    );
+    sort_world_components(components, world_components_sort_buffer);
     
     float mob_shadow_stretch = 0;
     
@@ -2016,27 +2509,116 @@ void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
         mob_shadow_stretch = (day_minutes - 60 * 12) / (60 * 20 - 60 * 12);
     }
     
+    size_t next_particle_idx = 0;
+    bool baked_layer_drawn = false;
+    float baked_layer_z = 0.0f;
+    vector<Liquid*> &drawn_liquids = world_drawn_liquids;
+    drawn_liquids.clear();
+    float drawn_liquids_z = 0.0f;
+    
+    //Status effect bitmaps aren't in the sprite atlas, so drawing them
+    //right after each mob would break up the run of mobs. Instead, they're
+    //gathered and drawn together at the end of the run.
+    status_overlay_batch.clear();
+    status_overlay_batching = true;
+    
     for(size_t c = 0; c < components.size(); c++) {
         WorldComponent* c_ptr = &components[c];
         
+        //Mobs are only bitmaps, so bitmap drawing is held while going
+        //through them. With their sprites in an atlas, that lets a whole run
+        //of mobs be drawn in one go. Everything else needs it released.
+        bool is_mob_bitmap = c_ptr->mob_limb_ptr || c_ptr->mob_ptr;
+        if(!is_mob_bitmap && !status_overlay_batch.empty()) {
+            draw_status_effect_bmps(status_overlay_batch);
+            status_overlay_batch.clear();
+        }
+        if(al_is_bitmap_drawing_held() != is_mob_bitmap) {
+            al_hold_bitmap_drawing(is_mob_bitmap);
+        }
+        
+        //Draw all particles that go before this component in one batch.
+        //Particles used to be added after the sectors and before the mobs,
+        //so on a Z tie, they go after sectors and before anything else.
+        size_t batch_end = next_particle_idx;
+        while(
+            batch_end < particle_components.size() &&
+            (
+                particle_components[batch_end].z < c_ptr->z ||
+                (
+                    particle_components[batch_end].z == c_ptr->z &&
+                    !c_ptr->sector_ptr
+                )
+            )
+        ) {
+            batch_end++;
+        }
+        if(batch_end > next_particle_idx) {
+            if(!status_overlay_batch.empty()) {
+                draw_status_effect_bmps(status_overlay_batch);
+                status_overlay_batch.clear();
+            }
+            al_hold_bitmap_drawing(false);
+            particles.draw_batch(
+                particle_components, next_particle_idx, batch_end
+            );
+            next_particle_idx = batch_end;
+        }
+        
         if(c_ptr->sector_ptr) {
         
-            bool has_liquid = false;
-            for(size_t h = 0; h < c_ptr->sector_ptr->hazards.size(); h++) {
-                if(c_ptr->sector_ptr->hazards[h]->associated_liquid) {
-                    draw_liquid(
-                        c_ptr->sector_ptr,
-                        c_ptr->sector_ptr->hazards[h]->associated_liquid,
-                        Point(),
-                        1.0f,
-                        area_time_passed
+            bool is_baked =
+                bake_sectors &&
+                bakeable_sectors.find(c_ptr->sector_ptr) !=
+                bakeable_sectors.end();
+            if(is_baked) {
+                //Sectors with the same Z never overlap and are drawn one after
+                //the other, so all of their floors can be drawn at once.
+                if(!baked_layer_drawn || baked_layer_z != c_ptr->z) {
+                    draw_baked_sectors(c_ptr->z, view_tl, view_br);
+                    baked_layer_drawn = true;
+                    baked_layer_z = c_ptr->z;
+                }
+            
+            } else {
+                Liquid* l_ptr = c_ptr->sector_ptr->get_liquid();
+                if(l_ptr) {
+                    //Like with baked floors, every sector at this Z that has
+                    //this liquid can be drawn in one batch.
+                    if(drawn_liquids_z != c_ptr->z) {
+                        drawn_liquids.clear();
+                        drawn_liquids_z = c_ptr->z;
+                    }
+                    if(
+                        std::find(
+                            drawn_liquids.begin(), drawn_liquids.end(), l_ptr
+                        ) == drawn_liquids.end()
+                    ) {
+                        liquid_batch_sectors.clear();
+                        for(
+                            size_t c2 = c;
+                            c2 < components.size() &&
+                            components[c2].sector_ptr &&
+                            components[c2].z == c_ptr->z;
+                            c2++
+                        ) {
+                            Sector* s2_ptr = components[c2].sector_ptr;
+                            if(s2_ptr->get_liquid() != l_ptr) continue;
+                            liquid_batch_sectors.push_back(s2_ptr);
+                        }
+                        draw_liquid(
+                            liquid_batch_sectors, l_ptr, Point(), 1.0f,
+                            area_time_passed
+                        );
+                        drawn_liquids.push_back(l_ptr);
+                    }
+                
+                } else {
+                    draw_sector_texture(
+                        c_ptr->sector_ptr, Point(), 1.0f, 1.0f
                     );
-                    has_liquid = true;
-                    break;
                 }
-            }
-            if(!has_liquid) {
-                draw_sector_texture(c_ptr->sector_ptr, Point(), 1.0f, 1.0f);
+            
             }
             float liquid_opacity_mult = 1.0f;
             if(c_ptr->sector_ptr->draining_liquid) {
@@ -2047,31 +2629,50 @@ void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
             draw_sector_edge_offsets(
                 c_ptr->sector_ptr,
                 bmp_output ?
-                custom_liquid_limit_effect_buffer :
+                bmp_output_liquid_limit_effect_buffer :
                 game.liquid_limit_effect_buffer,
-                liquid_opacity_mult
+                liquid_opacity_mult,
+                bmp_output ? 1.0f : game.offset_effect_buffers_scale
             );
             draw_sector_edge_offsets(
                 c_ptr->sector_ptr,
                 bmp_output ?
-                custom_wall_offset_effect_buffer :
+                bmp_output_wall_offset_effect_buffer :
                 game.wall_offset_effect_buffer,
-                1.0f
+                1.0f,
+                bmp_output ? 1.0f : game.offset_effect_buffers_scale
             );
             
         } else if(c_ptr->mob_shadow_ptr) {
         
-            float delta_z = 0;
-            if(!c_ptr->mob_shadow_ptr->standing_on_mob) {
-                delta_z =
-                    c_ptr->mob_shadow_ptr->z -
-                    c_ptr->mob_shadow_ptr->ground_sector->z;
+            //Gather the shadows that come one after the other, without
+            //any particles in between, and draw them all at once.
+            mob_shadow_batch.clear();
+            size_t c2 = c;
+            while(
+                c2 < components.size() &&
+                components[c2].mob_shadow_ptr &&
+                (
+                    c2 == c ||
+                    next_particle_idx == particle_components.size() ||
+                    particle_components[next_particle_idx].z >
+                    components[c2].z
+                )
+            ) {
+                Mob* shadow_mob_ptr = components[c2].mob_shadow_ptr;
+                float delta_z = 0;
+                if(!shadow_mob_ptr->standing_on_mob) {
+                    delta_z =
+                        shadow_mob_ptr->z -
+                        shadow_mob_ptr->ground_sector->z;
+                }
+                mob_shadow_batch.push_back(
+                    std::make_pair(shadow_mob_ptr, delta_z)
+                );
+                c2++;
             }
-            draw_mob_shadow(
-                c_ptr->mob_shadow_ptr,
-                delta_z,
-                mob_shadow_stretch
-            );
+            draw_mob_shadows(mob_shadow_batch, mob_shadow_stretch);
+            c = c2 - 1;
             
         } else if(c_ptr->mob_limb_ptr) {
         
@@ -2084,18 +2685,312 @@ void GameplayState::draw_world_components(ALLEGRO_BITMAP* bmp_output) {
             if(!has_flag(c_ptr->mob_ptr->flags, MOB_FLAG_HIDDEN)) {
                 c_ptr->mob_ptr->draw_mob();
                 if(c_ptr->mob_ptr->type->draw_mob_callback) {
+                    al_hold_bitmap_drawing(false);
                     c_ptr->mob_ptr->type->draw_mob_callback(c_ptr->mob_ptr);
                 }
             }
             
-        } else if(c_ptr->particle_ptr) {
+        }
+    }
+    
+    if(!status_overlay_batch.empty()) {
+        draw_status_effect_bmps(status_overlay_batch);
+        status_overlay_batch.clear();
+    }
+    status_overlay_batching = false;
+    
+    al_hold_bitmap_drawing(false);
+    
+    //Whatever particles are above everything else.
+    if(next_particle_idx < particle_components.size()) {
+        particles.draw_batch(
+            particle_components, next_particle_idx, particle_components.size()
+        );
+    }
+    
+    if(bake_sectors) {
+        //Tiles that aren't in view anymore aren't worth keeping.
+        for(
+            auto t_it = baked_sector_tiles.begin();
+            t_it != baked_sector_tiles.end();
+        ) {
+            if(!t_it->second.used) {
+                if(t_it->second.bitmap) al_destroy_bitmap(t_it->second.bitmap);
+                t_it = baked_sector_tiles.erase(t_it);
+            } else {
+                t_it->second.used = false;
+                ++t_it;
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Updates the list of sectors whose floors can be baked.
+ * Sectors with liquids or that scroll change every frame, and so do
+ * sectors that fade into a scrolling one. Sectors that fade into the void
+ * are also left out, since they're partly see-through.
+ */
+void GameplayState::update_bakeable_sectors() {
+    bakeable_sectors.clear();
+    
+    const auto is_scrolling = [] (const Sector * s_ptr) {
+        return s_ptr && (s_ptr->scroll.x != 0 || s_ptr->scroll.y != 0);
+    };
+    
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        Sector* s_ptr = game.cur_area_data->sectors[s];
         
-            c_ptr->particle_ptr->draw();
-            
+        if(is_scrolling(s_ptr)) continue;
+        if(s_ptr->get_liquid()) continue;
+        
+        if(s_ptr->fade) {
+            Sector* texture_sector[2] = {nullptr, nullptr};
+            s_ptr->get_texture_merge_sectors(
+                &texture_sector[0], &texture_sector[1]
+            );
+            if(
+                is_scrolling(texture_sector[0]) ||
+                is_scrolling(texture_sector[1])
+            ) {
+                continue;
+            }
+            if(!texture_sector[0] || texture_sector[0]->is_bottomless_pit) {
+                //Fading into the void leaves the floor see-through, and
+                //that doesn't survive being drawn onto a bitmap first.
+                continue;
+            }
         }
+        
+        bakeable_sectors.insert(s_ptr);
     }
+}
+
+
+/**
+ * @brief Finds where player 1's throw collides with a wall, if anywhere,
+ * and caches the result for the throw preview.
+ *
+ * @param throw_v_angle Vertical angle of the throw.
+ * @param throw_speed Speed of the throw.
+ */
+void GameplayState::update_throw_preview_collision(
+    float throw_v_angle, float throw_speed
+) {
+    //Check which edges exist near the throw.
+    vector<Edge*> &candidate_edges = throw_preview_edges;
     
-    if(bmp_output) {
-        al_destroy_bitmap(custom_wall_offset_effect_buffer);
+    game.cur_area_data->bmap.get_edges_in_region(
+        Point(
+            std::min(cur_leader_ptr->pos.x, throw_dest.x),
+            std::min(cur_leader_ptr->pos.y, throw_dest.y)
+        ),
+        Point(
+            std::max(cur_leader_ptr->pos.x, throw_dest.x),
+            std::max(cur_leader_ptr->pos.y, throw_dest.y)
+        ),
+        candidate_edges
+    );
+    
+    float wall_collision_r = 2.0f;
+    bool wall_is_blocking_sector = false;
+    Distance leader_to_dest_dist(
+        cur_leader_ptr->pos, throw_dest
+    );
+    
+    //For each edge, check if it crosses the throw line.
+    for(Edge* e : candidate_edges) {
+        if(!e->sectors[0] || !e->sectors[1]) {
+            continue;
+        }
+        
+        float r = 0.0f;
+        if(
+            !line_segs_intersect(
+                cur_leader_ptr->pos, throw_dest,
+                v2p(e->vertexes[0]), v2p(e->vertexes[1]),
+                &r, nullptr
+            )
+        ) {
+            //No collision.
+            continue;
+        }
+        
+        //If this is a blocking sector then yeah, collision.
+        if(
+            (
+                e->sectors[0]->type == SECTOR_TYPE_BLOCKING ||
+                e->sectors[1]->type == SECTOR_TYPE_BLOCKING
+            ) &&
+            r < wall_collision_r
+        ) {
+            wall_collision_r = r;
+            wall_is_blocking_sector = true;
+            continue;
+        }
+        
+        //Otherwise, let's check for walls.
+        
+        if(e->sectors[0]->z == e->sectors[1]->z) {
+            //Edges where both sectors have the same height have no wall.
+            continue;
+        }
+        
+        //Calculate the throwee's vertical position at that point.
+        float edge_z = std::max(e->sectors[0]->z, e->sectors[1]->z);
+        float x_at_edge =
+            leader_to_dest_dist.to_float() * r;
+        float y_at_edge =
+            tan(throw_v_angle) * x_at_edge -
+            (
+                -MOB::GRAVITY_ADDER /
+                (
+                    2 * throw_speed * throw_speed *
+                    cos(throw_v_angle) * cos(throw_v_angle)
+                )
+            ) * x_at_edge * x_at_edge;
+        y_at_edge += cur_leader_ptr->z;
+        
+        //If the throwee would hit the wall at these coordinates, collision.
+        if(edge_z >= y_at_edge && r < wall_collision_r) {
+            wall_collision_r = r;
+            wall_is_blocking_sector = false;
+        }
+    }
+    
+    throw_preview_collision.valid = true;
+    throw_preview_collision.leader_pos = cur_leader_ptr->pos;
+    throw_preview_collision.leader_z = cur_leader_ptr->z;
+    throw_preview_collision.throw_dest = throw_dest;
+    throw_preview_collision.throwee_type = cur_leader_ptr->throwee->type;
+    throw_preview_collision.calculation_time = area_time_passed;
+    throw_preview_collision.wall_collision_r = wall_collision_r;
+    throw_preview_collision.wall_is_blocking_sector = wall_is_blocking_sector;
+}
+
+
+/**
+ * @brief Updates the cached vertexes and bounding boxes of every tree shadow,
+ * and figures out which shadows can be drawn together.
+ * Tree shadows don't change during gameplay, so this only needs to be
+ * done when the area loads.
+ */
+void GameplayState::update_tree_shadow_caches() {
+    size_t n_shadows = game.cur_area_data->tree_shadows.size();
+    tree_shadow_vertexes.clear();
+    tree_shadow_bboxes.clear();
+    tree_shadow_batch_idxs.clear();
+    tree_shadow_batch_bmps.clear();
+    tree_shadow_batches.clear();
+    tree_shadow_vertexes.reserve(n_shadows * 6);
+    tree_shadow_bboxes.reserve(n_shadows);
+    tree_shadow_batch_idxs.reserve(n_shadows);
+    
+    //Corners of a shadow, as a ratio of its size, for its two triangles.
+    const float corners[6][2] = {
+        { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.5f, 0.5f },
+        { -0.5f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f }
+    };
+    
+    for(size_t s = 0; s < n_shadows; s++) {
+        TreeShadow* s_ptr = game.cur_area_data->tree_shadows[s];
+        
+        //Shadows without a bitmap are kept, but never drawn.
+        size_t batch_idx = INVALID;
+        for(size_t b = 0; b < tree_shadow_batch_bmps.size(); b++) {
+            if(tree_shadow_batch_bmps[b] == s_ptr->bitmap) {
+                batch_idx = b;
+                break;
+            }
+        }
+        if(batch_idx == INVALID && s_ptr->bitmap) {
+            batch_idx = tree_shadow_batch_bmps.size();
+            tree_shadow_batch_bmps.push_back(s_ptr->bitmap);
+        }
+        tree_shadow_batch_idxs.push_back(batch_idx);
+        
+        Point bmp_size;
+        if(s_ptr->bitmap) bmp_size = get_bitmap_dimensions(s_ptr->bitmap);
+        ALLEGRO_COLOR color = map_alpha(s_ptr->alpha);
+        Point sway_reach =
+            Point(fabs(s_ptr->sway.x), fabs(s_ptr->sway.y)) *
+            GAMEPLAY::TREE_SHADOW_SWAY_AMOUNT;
+        Point bbox_tl = s_ptr->center;
+        Point bbox_br = s_ptr->center;
+        
+        for(unsigned char c = 0; c < 6; c++) {
+            Point corner =
+                rotate_point(
+                    Point(
+                        corners[c][0] * s_ptr->size.x,
+                        corners[c][1] * s_ptr->size.y
+                    ),
+                    s_ptr->angle
+                ) + s_ptr->center;
+            TreeShadowVertex v;
+            v.x = corner.x;
+            v.y = corner.y;
+            v.u = (corners[c][0] + 0.5f) * bmp_size.x;
+            v.v = (corners[c][1] + 0.5f) * bmp_size.y;
+            v.color = color;
+            v.sway[0] = s_ptr->sway.x;
+            v.sway[1] = s_ptr->sway.y;
+            tree_shadow_vertexes.push_back(v);
+            update_min_max_coords(bbox_tl, bbox_br, corner);
+        }
+        
+        tree_shadow_bboxes.push_back(
+            std::make_pair(bbox_tl - sway_reach, bbox_br + sway_reach)
+        );
+    }
+    
+    //Shadows without a bitmap go in a batch of their own that never
+    //gets drawn.
+    for(size_t s = 0; s < n_shadows; s++) {
+        if(tree_shadow_batch_idxs[s] == INVALID) {
+            tree_shadow_batch_idxs[s] = tree_shadow_batch_bmps.size();
+        }
     }
+    tree_shadow_batches.assign(
+        tree_shadow_batch_bmps.size() + 1, vector<TreeShadowVertex>()
+    );
+}
+
+
+/**
+ * @brief Makes sure the bitmap that the world gets drawn onto when the
+ * render scale is lowered exists and has the right size. Its projection
+ * is set up so that everything can still be drawn in window coordinates.
+ *
+ * @param scale Render scale to use.
+ */
+void GameplayState::update_world_render_bmp(float scale) {
+    int bmp_w = std::max(1, (int) round(game.win_w * scale));
+    int bmp_h = std::max(1, (int) round(game.win_h * scale));
+    
+    if(
+        world_render_bmp &&
+        (
+            al_get_bitmap_width(world_render_bmp) != bmp_w ||
+            al_get_bitmap_height(world_render_bmp) != bmp_h
+        )
+    ) {
+        al_destroy_bitmap(world_render_bmp);
+        world_render_bmp = nullptr;
+    }
+    if(world_render_bmp) return;
+    
+    world_render_bmp = al_create_bitmap(bmp_w, bmp_h);
+    
+    //The projection belongs to the bitmap, so it stays as long as it does.
+    ALLEGRO_BITMAP* old_target = al_get_target_bitmap();
+    al_set_target_bitmap(world_render_bmp);
+    ALLEGRO_TRANSFORM projection;
+    al_identity_transform(&projection);
+    al_orthographic_transform(
+        &projection, 0, 0, -1, game.win_w, game.win_h, 1
+    );
+    al_use_projection_transform(&projection);
+    al_set_target_bitmap(old_target);
 }
@@ -30,12 +30,18 @@
 
 namespace GAMEPLAY {
 
+//Width and height of each tile when drawing the area to an image.
+const int AREA_IMAGE_TILE_SIZE = 1024;
+
 //How long the HUD moves for when the area is entered.
 const float AREA_INTRO_HUD_MOVE_TIME = 3.0f;
 
 //How long it takes for the area name to fade away, in-game.
 const float AREA_TITLE_FADE_DURATION = 1.0f;
 
+//Width and height of each tile of baked static sector floors, in pixels.
+const int BAKED_SECTOR_TILE_SIZE = 512;
+
 //How long the "Go!" big message lasts for.
 const float BIG_MSG_GO_DUR = 1.5f;
 
@@ -75,9 +81,6 @@ const unsigned char COLLISION_OPACITY = 192;
 //If an enemy is this close to the active leader, turn on the song's enemy mix.
 const float ENEMY_MIX_DISTANCE = 150.0f;
 
-//Width and height of the fog bitmap.
-const int FOG_BITMAP_SIZE = 128;
-
 //How long the HUD moves for when a menu is entered.
 const float MENU_ENTRY_HUD_MOVE_TIME = 0.4f;
 
@@ -90,6 +93,62 @@ extern const float LEADER_LAND_PART_MAX_SIZE = 64.0f;
 //When a leader lands, scale the particles by the fall distance and this factor.
 extern const float LEADER_LAND_PART_SIZE_MULT = 0.1f;
 
+//While waiting on a background loading step, redraw the loading screen
+//every this many seconds.
+const float LOADING_SCREEN_REDRAW_INTERVAL = 1.0f / 30.0f;
+
+//Duration of each gameplay logic step. The logic always runs in steps of
+//this size, regardless of the framerate.
+const float LOGIC_STEP_DURATION = 1.0f / 60.0f;
+
+//Maximum number of gameplay logic steps to run in a single frame.
+//If the game is further behind than this, it slows down instead.
+const size_t MAX_LOGIC_STEPS_PER_FRAME = 6;
+
+//How often to update the estimate of how much memory each subsystem uses,
+//in seconds, for the performance monitor and overlay.
+const float MEMORY_REPORT_INTERVAL = 1.0f;
+
+//Minimum number of mobs for each job when detecting interactions
+//in parallel.
+const size_t MIN_INTERACTION_JOB_SIZE = 16;
+
+//The render scale option can't go lower than this.
+const float MIN_RENDER_SCALE = 0.25f;
+
+//How many of the latest frames the performance overlay's graph shows.
+const size_t PERF_OVERLAY_GRAPH_SAMPLES = 360;
+
+//How many of the costliest object types the performance overlay shows.
+const size_t PERF_OVERLAY_MAX_MOB_TYPES = 3;
+
+//How many frames the performance overlay remembers at most.
+const size_t PERF_OVERLAY_MAX_SAMPLES = 1200;
+
+//How many of the costliest script events and actions the performance
+//overlay shows.
+const size_t PERF_OVERLAY_MAX_SCRIPT_COSTS = 3;
+
+//The performance overlay's percentiles cover this many latest seconds.
+const float PERF_OVERLAY_WINDOW = 5.0f;
+
+//Radius of each drop of precipitation.
+const float PRECIPITATION_DROP_SIZE = 3.0f;
+
+//Number of drops of precipitation in view at any given time.
+const size_t PRECIPITATION_NR_DROPS = 256;
+
+//Drops of precipitation fall at around these many units per second.
+const float PRECIPITATION_SPEED = 600.0f;
+
+//The throw preview's wall collision is found again after this long,
+//in case the walls changed.
+const float PREVIEW_CACHE_MAX_AGE = 0.1f;
+
+//The throw preview's wall collision is found again if the leader or
+//the throw destination move more than this away.
+const float PREVIEW_CACHE_TOLERANCE = 1.0f;
+
 //Opacity of the throw preview.
 const unsigned char PREVIEW_OPACITY = 160;
 
@@ -150,11 +209,75 @@ void GameplayState::change_spray_count(
 }
 
 
+/**
+ * @brief Adds mobs that were created since the mob grid was last updated
+ * to the grid.
+ */
+void GameplayState::add_new_mobs_to_grid() {
+    size_t n_mobs = mobs.all.size();
+    for(size_t m = mob_grid.get_nr_mobs(); m < n_mobs; m++) {
+        mob_grid.update_mob(m, mobs.all[m]);
+    }
+}
+
+
+/**
+ * @brief Marks a sector as needing to be ticked every frame, if it isn't
+ * marked yet. It stops being ticked on its own once there's nothing left
+ * for it to do.
+ *
+ * @param s_ptr Sector to mark.
+ */
+void GameplayState::add_ticking_sector(Sector* s_ptr) {
+    if(is_in_container(ticking_sectors, s_ptr)) return;
+    ticking_sectors.push_back(s_ptr);
+}
+
+
+/**
+ * @brief Makes mobs and the camera be in between where they were before and
+ * after the latest logic step, so that they look smooth when the framerate
+ * is higher than the logic's. end_interpolated_drawing() must be called
+ * after drawing, to put everything back.
+ *
+ * @param ratio How far along from the before to the after, [0 - 1].
+ */
+void GameplayState::begin_interpolated_drawing(float ratio) {
+    size_t n_mobs = mobs.all.size();
+    pre_interpolation_mob_coords.resize(n_mobs);
+    for(size_t m = 0; m < n_mobs; m++) {
+        Mob* m_ptr = mobs.all[m];
+        pre_interpolation_mob_coords[m] = std::make_pair(m_ptr->pos, m_ptr->z);
+        m_ptr->pos =
+            m_ptr->prev_step_pos + (m_ptr->pos - m_ptr->prev_step_pos) * ratio;
+        m_ptr->z =
+            m_ptr->prev_step_z + (m_ptr->z - m_ptr->prev_step_z) * ratio;
+    }
+    
+    pre_interpolation_cam_pos = game.cam.pos;
+    pre_interpolation_cam_zoom = game.cam.zoom;
+    game.cam.pos =
+        prev_step_cam_pos + (game.cam.pos - prev_step_cam_pos) * ratio;
+    game.cam.zoom =
+        prev_step_cam_zoom + (game.cam.zoom - prev_step_cam_zoom) * ratio;
+    update_transformations();
+    game.cam.update_box();
+}
+
+
 /**
  * @brief Draws the gameplay.
  */
 void GameplayState::do_drawing() {
+    record_perf_overlay_frame();
+    
+    //The gameplay logic runs in fixed steps, so draw things in between
+    //the latest two, based on how much time passed since the latest.
+    begin_interpolated_drawing(
+        logic_time_left / GAMEPLAY::LOGIC_STEP_DURATION
+    );
     do_game_drawing();
+    end_interpolated_drawing();
     
     if(game.perf_mon) {
         game.perf_mon->leave_state();
@@ -177,6 +300,8 @@ void GameplayState::do_logic() {
         }
     }
     
+    update_memory_report();
+    
     float regular_delta_t = game.delta_t;
     
     if(game.maker_tools.change_speed) {
@@ -187,6 +312,13 @@ void GameplayState::do_logic() {
     }
     
     //Controls.
+    if(!game.benchmark.record_inputs_path.empty()) {
+        game.input_recording.record(
+            logic_frame_nr, regular_delta_t,
+            game.mouse_cursor.s_pos, game.mouse_cursor.w_pos,
+            game.player_actions
+        );
+    }
     for(size_t a = 0; a < game.player_actions.size(); a++) {
         handle_player_action(game.player_actions[a]);
         if(onion_menu) onion_menu->handle_player_action(game.player_actions[a]);
@@ -194,13 +326,77 @@ void GameplayState::do_logic() {
         game.maker_tools.handle_gameplay_player_action(game.player_actions[a]);
     }
     
-    //Game logic.
+    //Game logic. This runs in fixed steps, as many as fit in the time that
+    //passed, so that it plays out the same at any framerate.
+    //The time left over carries on to the next frame.
     if(!paused) {
         game.statistics.gameplay_time += regular_delta_t;
-        do_gameplay_logic(game.delta_t* delta_t_mult);
-        do_aesthetic_logic(game.delta_t* delta_t_mult);
+        float frame_delta_t = game.delta_t;
+        logic_time_left += frame_delta_t;
+        size_t nr_steps = 0;
+        while(logic_time_left >= GAMEPLAY::LOGIC_STEP_DURATION) {
+            if(nr_steps == GAMEPLAY::MAX_LOGIC_STEPS_PER_FRAME) {
+                //Too far behind. Let the game slow down instead of
+                //spending even longer on this frame.
+                logic_time_left = 0.0f;
+                break;
+            }
+            save_prev_step_coords();
+            game.delta_t = GAMEPLAY::LOGIC_STEP_DURATION;
+            do_gameplay_logic(game.delta_t* delta_t_mult);
+            do_aesthetic_logic(game.delta_t* delta_t_mult);
+            logic_time_left -= GAMEPLAY::LOGIC_STEP_DURATION;
+            nr_steps++;
+        }
+        game.delta_t = frame_delta_t;
     }
     do_menu_logic();
+    
+    logic_frame_nr++;
+}
+
+
+/**
+ * @brief Draws the loading screen, with the area's name if it's known
+ * already, and a progress bar, and shows it.
+ *
+ * @param progress 0 to 1, how far along the loading is.
+ */
+void GameplayState::draw_loading_progress(float progress) {
+    if(game.headless) return;
+    
+    string text;
+    string subtext;
+    if(game.cur_area_data) {
+        text = game.cur_area_data->name;
+        subtext =
+            get_subtitle_or_mission_goal(
+                game.cur_area_data->subtitle,
+                game.cur_area_data->type,
+                game.cur_area_data->mission.goal
+            );
+    }
+    draw_loading_screen(text, subtext, 1.0f, progress);
+    al_flip_display();
+}
+
+
+/**
+ * @brief Puts the mobs and the camera back where they really are,
+ * after begin_interpolated_drawing().
+ */
+void GameplayState::end_interpolated_drawing() {
+    size_t n_mobs =
+        std::min(mobs.all.size(), pre_interpolation_mob_coords.size());
+    for(size_t m = 0; m < n_mobs; m++) {
+        mobs.all[m]->pos = pre_interpolation_mob_coords[m].first;
+        mobs.all[m]->z = pre_interpolation_mob_coords[m].second;
+    }
+    
+    game.cam.pos = pre_interpolation_cam_pos;
+    game.cam.zoom = pre_interpolation_cam_zoom;
+    update_transformations();
+    game.cam.update_box();
 }
 
 
@@ -307,83 +503,6 @@ void GameplayState::enter() {
 }
 
 
-/**
- * @brief Generates the bitmap that'll draw the fog fade effect.
- *
- * @param near_radius Until this radius, the fog is not present.
- * @param far_radius From this radius on, the fog is fully dense.
- * @return The bitmap.
- */
-ALLEGRO_BITMAP* GameplayState::generate_fog_bitmap(
-    float near_radius, float far_radius
-) {
-    if(far_radius == 0) return nullptr;
-    
-    ALLEGRO_BITMAP* bmp =
-        al_create_bitmap(GAMEPLAY::FOG_BITMAP_SIZE, GAMEPLAY::FOG_BITMAP_SIZE);
-        
-    ALLEGRO_LOCKED_REGION* region =
-        al_lock_bitmap(
-            bmp, ALLEGRO_PIXEL_FORMAT_ABGR_8888_LE, ALLEGRO_LOCK_WRITEONLY
-        );
-    unsigned char* row = (unsigned char*) region->data;
-    
-    //We need to draw a radial gradient to represent the fog.
-    //Between the center and the "near" radius, the opacity is 0%.
-    //From there to the edge, the opacity fades to 100%.
-    //Because the every quadrant of the image is the same, just mirrored,
-    //we only need to process the pixels on the top-left quadrant and then
-    //apply them to the respective pixels on the other quadrants as well.
-    
-    //This is where the "near" section of the fog is.
-    float near_ratio = near_radius / far_radius;
-    
-#define fill_pixel(x, row) \
-    row[(x) * 4 + 0] = 255; \
-    row[(x) * 4 + 1] = 255; \
-    row[(x) * 4 + 2] = 255; \
-    row[(x) * 4 + 3] = cur_a; \
-    
-    for(int y = 0; y < ceil(GAMEPLAY::FOG_BITMAP_SIZE / 2.0); y++) {
-        for(int x = 0; x < ceil(GAMEPLAY::FOG_BITMAP_SIZE / 2.0); x++) {
-            //First, get how far this pixel is from the center.
-            //Center = 0, radius or beyond = 1.
-            float cur_ratio =
-                Distance(
-                    Point(x, y),
-                    Point(
-                        GAMEPLAY::FOG_BITMAP_SIZE / 2.0,
-                        GAMEPLAY::FOG_BITMAP_SIZE / 2.0
-                    )
-                ).to_float() / (GAMEPLAY::FOG_BITMAP_SIZE / 2.0);
-            cur_ratio = std::min(cur_ratio, 1.0f);
-            //Then, map that ratio to a different ratio that considers
-            //the start of the "near" section as 0.
-            cur_ratio =
-                interpolate_number(cur_ratio, near_ratio, 1.0f, 0.0f, 1.0f);
-            //Finally, clamp the value and get the alpha.
-            cur_ratio = std::clamp(cur_ratio, 0.0f, 1.0f);
-            unsigned char cur_a = 255 * cur_ratio;
-            
-            //Save the memory location of the opposite row's pixels.
-            unsigned char* opposite_row =
-                row + region->pitch * (GAMEPLAY::FOG_BITMAP_SIZE - y - y - 1);
-            fill_pixel(x, row);
-            fill_pixel(GAMEPLAY::FOG_BITMAP_SIZE - x - 1, row);
-            fill_pixel(x, opposite_row);
-            fill_pixel(GAMEPLAY::FOG_BITMAP_SIZE - x - 1, opposite_row);
-        }
-        row += region->pitch;
-    }
-    
-#undef fill_pixel
-    
-    al_unlock_bitmap(bmp);
-    bmp = recreate_bitmap(bmp); //Refresh mipmaps.
-    return bmp;
-}
-
-
 /**
  * @brief Returns how many Pikmin are in the field in the current area.
  * This also checks inside converters.
@@ -422,11 +541,11 @@ size_t GameplayState::get_amount_of_group_pikmin(const PikminType* filter) {
     size_t total = 0;
     
     if(!cur_leader_ptr) return 0;
+    if(filter) return cur_leader_ptr->group->get_amount_by_type(filter);
     
     for(size_t m = 0; m < cur_leader_ptr->group->members.size(); m++) {
         Mob* m_ptr = cur_leader_ptr->group->members[m];
         if(m_ptr->type->category->id != MOB_CATEGORY_PIKMIN) continue;
-        if(filter && m_ptr->type != filter) continue;
         total++;
     }
     
@@ -528,6 +647,76 @@ long GameplayState::get_amount_of_total_pikmin(const PikminType* filter) {
 }
 
 
+/**
+ * @brief Returns the mob closest to a point, out of the ones that match
+ * the given filters. This uses the mob grid, so only the mobs that are near
+ * the point get checked, unless there's nothing near.
+ *
+ * @param pos Point to check.
+ * @param category Only return mobs of this category.
+ * MOB_CATEGORY_NONE for any.
+ * @param filter Only return mobs for which this returns true.
+ * nullptr for any.
+ * @param out_dist If not nullptr, the distance to the mob is returned here.
+ * @return The mob, or nullptr if there is none.
+ */
+Mob* GameplayState::get_closest_mob(
+    const Point &pos, MOB_CATEGORY category,
+    const std::function<bool(Mob*)> &filter, Distance* out_dist
+) {
+    Mob* closest_mob = nullptr;
+    Distance closest_dist;
+    Point grid_br =
+        mob_grid.top_left_corner +
+        Point(mob_grid.n_cols, mob_grid.n_rows) * GEOMETRY::AREA_CELL_SIZE;
+    vector<Mob*> candidates;
+    vector<Point> candidate_positions;
+    vector<float> candidate_dists;
+    
+    //Keep checking bigger and bigger regions until a mob is found
+    //that's closer than anything outside the region could be.
+    for(float half_size = GEOMETRY::AREA_CELL_SIZE; ; half_size *= 2.0f) {
+        Point tl = pos - half_size;
+        Point br = pos + half_size;
+        get_mobs_in_box(tl, br, candidates, category);
+        
+        candidate_positions.resize(candidates.size());
+        for(size_t c = 0; c < candidates.size(); c++) {
+            candidate_positions[c] = candidates[c]->pos;
+        }
+        get_distances_squared(pos, candidate_positions, candidate_dists);
+        
+        closest_mob = nullptr;
+        float closest_dist_squared = 0.0f;
+        for(size_t c = 0; c < candidates.size(); c++) {
+            if(closest_mob && candidate_dists[c] >= closest_dist_squared) {
+                continue;
+            }
+            Mob* c_ptr = candidates[c];
+            if(filter && !filter(c_ptr)) continue;
+            closest_mob = c_ptr;
+            closest_dist_squared = candidate_dists[c];
+        }
+        
+        if(closest_mob) {
+            closest_dist = Distance(pos, closest_mob->pos);
+            if(closest_dist <= half_size) break;
+        }
+        if(
+            tl.x <= mob_grid.top_left_corner.x &&
+            tl.y <= mob_grid.top_left_corner.y &&
+            br.x >= grid_br.x && br.y >= grid_br.y
+        ) {
+            //This covers the whole grid, so there's nothing else to find.
+            break;
+        }
+    }
+    
+    if(out_dist) *out_dist = closest_mob ? closest_dist : Distance();
+    return closest_mob;
+}
+
+
 /**
  * @brief Returns the closest group member of a given standby subgroup.
  * In the case all candidate members are out of reach,
@@ -557,13 +746,11 @@ Mob* GameplayState::get_closest_group_member(
     }
     
     //Fetch the closest, for each maturity.
-    size_t n_members = cur_leader_ptr->group->members.size();
-    for(size_t m = 0; m < n_members; m++) {
+    const vector<Mob*> &type_members =
+        cur_leader_ptr->group->get_subgroup_members(type);
+    for(size_t m = 0; m < type_members.size(); m++) {
     
-        Mob* member_ptr = cur_leader_ptr->group->members[m];
-        if(member_ptr->subgroup_type_ptr != type) {
-            continue;
-        }
+        Mob* member_ptr = type_members[m];
         
         unsigned char maturity = 0;
         if(member_ptr->type->category->id == MOB_CATEGORY_PIKMIN) {
@@ -619,6 +806,89 @@ Mob* GameplayState::get_closest_group_member(
 }
 
 
+/**
+ * @brief Returns all mobs whose physical span touches a given region,
+ * out of the ones that match the given filters. This uses the mob grid,
+ * so only the mobs that are near the region get checked.
+ *
+ * @param tl Top-left coordinates of the region.
+ * @param br Bottom-right coordinates of the region.
+ * @param out_mobs The mobs are returned here, in the same order as
+ * in the list of all mobs. This vector is cleared beforehand.
+ * @param category Only return mobs of this category.
+ * MOB_CATEGORY_NONE for any.
+ * @param team Only return mobs of this team. N_MOB_TEAMS for any.
+ */
+void GameplayState::get_mobs_in_box(
+    const Point &tl, const Point &br, vector<Mob*> &out_mobs,
+    MOB_CATEGORY category, MOB_TEAM team
+) {
+    out_mobs.clear();
+    add_new_mobs_to_grid();
+    
+    vector<size_t> idxs;
+    mob_grid.get_mobs_in_region(tl, br, idxs);
+    for(size_t i = 0; i < idxs.size(); i++) {
+        Mob* m_ptr = mobs.all[idxs[i]];
+        if(
+            category != MOB_CATEGORY_NONE &&
+            m_ptr->type->category->id != category
+        ) {
+            continue;
+        }
+        if(team != N_MOB_TEAMS && m_ptr->team != team) continue;
+        if(
+            !rectangles_intersect(
+                tl, br,
+                m_ptr->pos - m_ptr->physical_span,
+                m_ptr->pos + m_ptr->physical_span
+            )
+        ) {
+            continue;
+        }
+        out_mobs.push_back(m_ptr);
+    }
+}
+
+
+/**
+ * @brief Returns all mobs whose center is within a given distance of a point,
+ * out of the ones that match the given filters. This uses the mob grid,
+ * so only the mobs that are near the point get checked.
+ *
+ * @param center Point to check.
+ * @param radius Maximum distance from the point.
+ * @param out_mobs The mobs are returned here, in the same order as
+ * in the list of all mobs. This vector is cleared beforehand.
+ * @param category Only return mobs of this category.
+ * MOB_CATEGORY_NONE for any.
+ * @param team Only return mobs of this team. N_MOB_TEAMS for any.
+ */
+void GameplayState::get_mobs_in_radius(
+    const Point &center, float radius, vector<Mob*> &out_mobs,
+    MOB_CATEGORY category, MOB_TEAM team
+) {
+    get_mobs_in_box(
+        center - radius, center + radius, out_mobs, category, team
+    );
+    vector<Point> positions(out_mobs.size());
+    for(size_t m = 0; m < out_mobs.size(); m++) {
+        positions[m] = out_mobs[m]->pos;
+    }
+    vector<float> dists_squared;
+    get_distances_squared(center, positions, dists_squared);
+    
+    size_t n_kept = 0;
+    float radius_squared = radius * radius;
+    for(size_t m = 0; m < out_mobs.size(); m++) {
+        if(dists_squared[m] > radius_squared) continue;
+        out_mobs[n_kept] = out_mobs[m];
+        n_kept++;
+    }
+    out_mobs.resize(n_kept);
+}
+
+
 /**
  * @brief Returns the name of this state.
  *
@@ -629,6 +899,17 @@ string GameplayState::get_name() const {
 }
 
 
+/**
+ * @brief Returns roughly how much memory the sprite atlas takes up,
+ * in bytes.
+ *
+ * @return The size.
+ */
+size_t GameplayState::get_sprite_atlas_memory_usage() const {
+    return sprite_atlas.get_memory_usage();
+}
+
+
 /**
  * @brief Handles an Allegro event.
  *
@@ -681,6 +962,7 @@ void GameplayState::leave(const GAMEPLAY_LEAVE_TARGET target) {
     
     switch(target) {
     case GAMEPLAY_LEAVE_TARGET_RETRY: {
+        retrying = true;
         game.change_state(game.states.gameplay);
         break;
     } case GAMEPLAY_LEAVE_TARGET_END: {
@@ -718,14 +1000,59 @@ void GameplayState::load() {
     loading = true;
     game.errors.prepare_area_load();
     went_to_results = false;
+    logic_frame_nr = 0;
     
-    draw_loading_screen("", "", 1.0f);
-    al_flip_display();
+    draw_loading_progress(0.0f);
+    
+    if(!game.benchmark.record_inputs_path.empty()) {
+        game.input_recording.clear();
+        game.input_recording.area_path = path_of_area_to_load;
+        game.input_recording.rng_seed = game.rng.state;
+    }
     
     game.statistics.area_entries++;
     
-    //Game content.
-    load_game_content();
+    //Packs go first, since they decide where the area's files are read from.
+    if(!retrying) game.content.reload_packs();
+    
+    //Parse the area's data files on a worker thread, while this thread
+    //loads the game content. If they were preloaded while the player was
+    //picking the area, that's already done.
+    vector<string> area_file_paths =
+        AreaPreloader::get_file_paths(path_of_area_to_load);
+    vector<DataNode> area_file_nodes(area_file_paths.size());
+    size_t area_files_task_id = 0;
+    bool area_files_preloaded =
+        game.area_preloader.take(path_of_area_to_load, &area_file_nodes);
+    if(!area_files_preloaded) {
+        area_files_task_id =
+            game.jobs.add_task(
+        [&area_file_paths, &area_file_nodes] () {
+            for(size_t f = 0; f < area_file_paths.size(); f++) {
+                load_data_file_contents(
+                    area_file_paths[f], &area_file_nodes[f]
+                );
+            }
+        }
+            );
+    }
+    
+    //Game content. When retrying, it's still in memory from before,
+    //so only the area itself and its objects need to be set up again.
+    if(!retrying) {
+        load_game_content();
+        draw_loading_progress(0.4f);
+    }
+    retrying = false;
+    
+    if(!area_files_preloaded) {
+        wait_for_loading_task(area_files_task_id, 0.4f);
+    }
+    for(size_t f = 0; f < area_file_paths.size(); f++) {
+        game.content.add_prefetched_data_file(
+            area_file_paths[f], std::move(area_file_nodes[f])
+        );
+    }
     
     //Initialize some important things.
     for(size_t s = 0; s < game.content.spray_types.list.size(); s++) {
@@ -759,6 +1086,23 @@ void GameplayState::load() {
     old_mission_fail_2_cur = 0;
     nr_living_leaders = 0;
     leaders_kod = 0;
+    changed_mission_counters = (bitmask_16_t) ~0;
+    mission_goal_dependencies = 0;
+    mission_fail_dependencies = 0;
+    mission_score_dependencies = 0;
+    old_gameplay_seconds = 0;
+    old_nr_pikmin_mobs = 0;
+    mission_goal_cur_amount = 0;
+    mission_goal_req_amount = 0;
+    mission_fail_1_cur_amount = 0;
+    mission_fail_1_req_amount = 0;
+    mission_fail_2_cur_amount = 0;
+    mission_fail_2_req_amount = 0;
+    perf_overlay_frame_durs.assign(GAMEPLAY::PERF_OVERLAY_MAX_SAMPLES, 0.0);
+    perf_overlay_frame_times.assign(GAMEPLAY::PERF_OVERLAY_MAX_SAMPLES, 0.0);
+    perf_overlay_next_idx = 0;
+    perf_overlay_last_frame_time = 0.0;
+    memory_report_time = 0.0;
     
     game.framerate_last_avg_point = 0;
     game.framerate_history.clear();
@@ -804,21 +1148,88 @@ void GameplayState::load() {
         return;
     }
     
+    //In case the area loading didn't end up using them.
+    for(size_t f = 0; f < area_file_paths.size(); f++) {
+        DataNode unused_node;
+        game.content.take_prefetched_data_file(
+            area_file_paths[f], &unused_node
+        );
+    }
+    draw_loading_progress(0.7f);
+    
+    //Open the area's song in the background while the rest loads.
+    game.audio.prepare_song(game.cur_area_data->song_name);
+    
     if(!game.cur_area_data->weather_condition.blackout_strength.empty()) {
         lightmap_bmp = al_create_bitmap(game.win_w, game.win_h);
     }
-    if(!game.cur_area_data->weather_condition.fog_color.empty()) {
-        bmp_fog =
-            generate_fog_bitmap(
-                game.cur_area_data->weather_condition.fog_near,
-                game.cur_area_data->weather_condition.fog_far
+    if(
+        game.cur_area_data->weather_condition.precipitation_type !=
+        PRECIPITATION_TYPE_NONE
+    ) {
+        //Two triangles per drop. They never change.
+        const float corners[6][2] = {
+            { -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f },
+            { -1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f }
+        };
+        vector<PrecipitationVertex> vertexes(
+            GAMEPLAY::PRECIPITATION_NR_DROPS * 6
+        );
+        for(size_t v = 0; v < vertexes.size(); v++) {
+            vertexes[v].x = corners[v % 6][0];
+            vertexes[v].y = corners[v % 6][1];
+            vertexes[v].drop_idx = (float) (v / 6);
+        }
+        precipitation_vertex_buffer =
+            al_create_vertex_buffer(
+                game.shaders.precipitation_vertex_decl, vertexes.data(),
+                (int) vertexes.size(), ALLEGRO_PRIM_BUFFER_STATIC
             );
+        precipitation_seed = game.rng.f(0.0f, 1000.0f);
+    }
+    update_tree_shadow_caches();
+    
+    //Find the sectors that need ticking from the start.
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        Sector* s_ptr = game.cur_area_data->sectors[s];
+        if(s_ptr->scroll.x != 0 || s_ptr->scroll.y != 0) {
+            add_ticking_sector(s_ptr);
+        }
+    }
+    
+    //Initialize the area's cells. This needs to happen before any
+    //mob is created, since mobs can look for other mobs as soon as
+    //they are.
+    float area_width =
+        game.cur_area_data->bmap.n_cols * GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    float area_height =
+        game.cur_area_data->bmap.n_rows * GEOMETRY::BLOCKMAP_BLOCK_SIZE;
+    nr_area_cell_cols =
+        ceil(area_width / GEOMETRY::AREA_CELL_SIZE) + 1;
+    nr_area_cell_rows =
+        ceil(area_height / GEOMETRY::AREA_CELL_SIZE) + 1;
+    
+    area_active_cell_refs.clear();
+    area_active_cell_refs.assign(nr_area_cell_cols * nr_area_cell_rows, 0);
+    mob_grid.create(
+        game.cur_area_data->bmap.top_left_corner,
+        nr_area_cell_cols, nr_area_cell_rows
+    );
+    throw_preview_collision = ThrowPreviewCollision();
+    for(size_t i = 0; i < N_MOB_TASK_INDEXES; i++) {
+        task_indexes[i].create(
+            game.cur_area_data->bmap.top_left_corner,
+            nr_area_cell_cols, nr_area_cell_rows
+        );
     }
     
     //Generate mobs.
+    draw_loading_progress(0.8f);
     next_mob_id = 0;
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Object generation");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_OBJECT_GENERATION
+        );
     }
     
     vector<Mob*> mobs_per_gen;
@@ -841,7 +1252,7 @@ void GameplayState::load() {
             Mob* new_mob =
                 create_mob(
                     m_ptr->type->category, m_ptr->pos, m_ptr->type,
-                    m_ptr->angle, m_ptr->vars
+                    m_ptr->angle, m_ptr->vars_map
                 );
             mobs_per_gen.push_back(new_mob);
         } else {
@@ -862,7 +1273,7 @@ void GameplayState::load() {
         for(size_t l = 0; l < gen_ptr->link_idxs.size(); l++) {
             size_t link_target_gen_idx = gen_ptr->link_idxs[l];
             Mob* link_target_mob_ptr = mobs_per_gen[link_target_gen_idx];
-            mob_ptr->links.push_back(link_target_mob_ptr);
+            mob_ptr->add_link(link_target_mob_ptr);
         }
     }
     
@@ -875,6 +1286,33 @@ void GameplayState::load() {
         holder_mob_ptr->store_mob_inside(holdee_ptr);
     }
     
+    //Load the spritesheets of the mob types that can show up, and pack
+    //them together, so that mobs of different types can be drawn without
+    //switching textures. Any Onion or sprout can make Pikmin, so those
+    //always go in. Any other type gets its spritesheets loaded when
+    //a mob of it is created.
+    vector<AnimationDatabase*> area_anim_dbs;
+    unordered_set<MobType*> area_types;
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        area_types.insert(mobs.all[m]->type);
+    }
+    for(size_t p = 0; p < game.config.pikmin.order.size(); p++) {
+        area_types.insert(game.config.pikmin.order[p]);
+    }
+    for(MobType* t_ptr : area_types) {
+        area_anim_dbs.push_back(t_ptr->anim_db);
+        for(size_t s = 0; s < t_ptr->spawns.size(); s++) {
+            MobType* spawn_type_ptr = t_ptr->spawns[s].mob_type;
+            if(spawn_type_ptr) area_anim_dbs.push_back(spawn_type_ptr->anim_db);
+        }
+    }
+    for(size_t d = 0; d < area_anim_dbs.size(); d++) {
+        if(area_anim_dbs[d]) area_anim_dbs[d]->load_sprite_bitmaps();
+    }
+    if(!game.headless) {
+        sprite_atlas.build(area_anim_dbs);
+    }
+    
     //Save each path stop's sector.
     for(size_t s = 0; s < game.cur_area_data->path_stops.size(); s++) {
         game.cur_area_data->path_stops[s]->sector_ptr =
@@ -923,6 +1361,8 @@ void GameplayState::load() {
         game.cam.set_pos(Point());
     }
     game.cam.set_zoom(game.options.advanced.zoom_mid_level);
+    logic_time_left = 0.0f;
+    save_prev_step_coords();
     
     //Memorize mobs required by the mission.
     if(game.cur_area_data->type == AREA_TYPE_MISSION) {
@@ -949,6 +1389,37 @@ void GameplayState::load() {
         }
         mission_required_mob_amount = mission_remaining_mob_ids.size();
         
+        //Figure out what counters the mission depends on.
+        mission_goal_dependencies =
+            game.mission_goals[game.cur_area_data->mission.goal]->
+            get_dependencies();
+        for(size_t f = 0; f < game.mission_fail_conds.size(); f++) {
+            if(
+                has_flag(
+                    game.cur_area_data->mission.fail_conditions,
+                    get_idx_bitmask(f)
+                )
+            ) {
+                enable_flag(
+                    mission_fail_dependencies,
+                    game.mission_fail_conds[f]->get_dependencies()
+                );
+            }
+        }
+        for(size_t c = 0; c < game.mission_score_criteria.size(); c++) {
+            if(
+                has_flag(
+                    game.cur_area_data->mission.point_hud_data,
+                    get_idx_bitmask(c)
+                )
+            ) {
+                enable_flag(
+                    mission_score_dependencies,
+                    game.mission_score_criteria[c]->get_dependencies()
+                );
+            }
+        }
+        
         if(game.cur_area_data->mission.goal == MISSION_GOAL_COLLECT_TREASURE) {
             //Since the collect treasure goal can accept piles and resources
             //meant to add treasure points, we'll need some special treatment.
@@ -1003,21 +1474,6 @@ void GameplayState::load() {
         enemy_points_total += mobs.enemies[e]->ene_type->points;
     }
     
-    //Initialize the area's active cells.
-    float area_width =
-        game.cur_area_data->bmap.n_cols * GEOMETRY::BLOCKMAP_BLOCK_SIZE;
-    float area_height =
-        game.cur_area_data->bmap.n_rows * GEOMETRY::BLOCKMAP_BLOCK_SIZE;
-    size_t nr_area_cell_cols =
-        ceil(area_width / GEOMETRY::AREA_CELL_SIZE) + 1;
-    size_t nr_area_cell_rows =
-        ceil(area_height / GEOMETRY::AREA_CELL_SIZE) + 1;
-        
-    area_active_cells.clear();
-    area_active_cells.assign(
-        nr_area_cell_cols, vector<bool>(nr_area_cell_rows, false)
-    );
-    
     //Initialize some other things.
     path_mgr.handle_area_load();
     
@@ -1131,7 +1587,6 @@ void GameplayState::load() {
  * @brief Loads all of the game's content.
  */
 void GameplayState::load_game_content() {
-    game.content.reload_packs();
     game.content.load_all(
     vector<CONTENT_TYPE> {
         CONTENT_TYPE_GUI,
@@ -1155,7 +1610,9 @@ void GameplayState::load_game_content() {
     CONTENT_LOAD_LEVEL_BASIC
     );
     
-    //Mob types.
+    //Mob types. Their spritesheets are only loaded once it's known
+    //which types the area uses.
+    game.content.mob_anim_dbs.lazy_sprite_bitmaps = true;
     game.content.load_all(
     vector<CONTENT_TYPE> {
         CONTENT_TYPE_MOB_ANIMATION,
@@ -1163,6 +1620,7 @@ void GameplayState::load_game_content() {
     },
     CONTENT_LOAD_LEVEL_FULL
     );
+    game.content.mob_anim_dbs.lazy_sprite_bitmaps = false;
     
     //Register leader sub-group types.
     for(size_t p = 0; p < game.config.pikmin.order.size(); p++) {
@@ -1188,6 +1646,44 @@ void GameplayState::load_game_content() {
 }
 
 
+/**
+ * @brief Records how long the latest frame took, if the performance
+ * overlay is being shown.
+ */
+void GameplayState::record_perf_overlay_frame() {
+    if(!game.maker_tools.perf_overlay) {
+        perf_overlay_last_frame_time = 0.0;
+        return;
+    }
+    
+    double now = al_get_time();
+    if(perf_overlay_last_frame_time != 0.0) {
+        perf_overlay_frame_durs[perf_overlay_next_idx] =
+            now - perf_overlay_last_frame_time;
+        perf_overlay_frame_times[perf_overlay_next_idx] = now;
+        perf_overlay_next_idx =
+            (perf_overlay_next_idx + 1) % perf_overlay_frame_durs.size();
+    }
+    perf_overlay_last_frame_time = now;
+}
+
+
+/**
+ * @brief Saves the coordinates of every mob and the camera, before a logic
+ * step changes them, so that drawing can go smoothly from these to
+ * the new ones.
+ */
+void GameplayState::save_prev_step_coords() {
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        Mob* m_ptr = mobs.all[m];
+        m_ptr->prev_step_pos = m_ptr->pos;
+        m_ptr->prev_step_z = m_ptr->z;
+    }
+    prev_step_cam_pos = game.cam.pos;
+    prev_step_cam_zoom = game.cam.zoom;
+}
+
+
 /**
  * @brief Starts the fade out to leave the gameplay state.
  *
@@ -1204,6 +1700,11 @@ void GameplayState::start_leaving(const GAMEPLAY_LEAVE_TARGET target) {
 void GameplayState::unload() {
     unloading = true;
     
+    if(game.perf_mon) {
+        game.perf_mon->set_paused(false);
+        game.perf_mon->enter_state(PERF_MON_STATE_UNLOADING);
+    }
+    
     if(hud) {
         hud->gui.destroy();
         delete hud;
@@ -1221,8 +1722,16 @@ void GameplayState::unload() {
     game.cam.set_pos(Point());
     game.cam.set_zoom(1.0f);
     
-    while(!mobs.all.empty()) {
-        delete_mob(*mobs.all.begin(), true);
+    if(game.perf_mon) {
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_UNLOADING_OBJECTS
+        );
+    }
+    
+    delete_mobs(mobs.all, true);
+    
+    if(game.perf_mon) {
+        game.perf_mon->finish_measurement();
     }
     
     if(lightmap_bmp) {
@@ -1230,7 +1739,37 @@ void GameplayState::unload() {
         lightmap_bmp = nullptr;
     }
     
+    if(world_render_bmp) {
+        al_destroy_bitmap(world_render_bmp);
+        world_render_bmp = nullptr;
+    }
+    
+    tree_shadow_vertexes.clear();
+    tree_shadow_bboxes.clear();
+    tree_shadow_batch_idxs.clear();
+    tree_shadow_batch_bmps.clear();
+    tree_shadow_batches.clear();
+    health_wheel_vertexes.clear();
+    in_world_hud_pool.clear();
+    mobs_to_delete.clear();
+    throw_preview_edges.clear();
+    world_drawn_liquids.clear();
+    
+    if(precipitation_vertex_buffer) {
+        al_destroy_vertex_buffer(precipitation_vertex_buffer);
+        precipitation_vertex_buffer = nullptr;
+    }
+    
+    clear_baked_sector_tiles();
+    baked_sector_tiles_zoom = 0.0f;
+    bakeable_sectors.clear();
     mission_remaining_mob_ids.clear();
+    mob_grid.clear();
+    mob_tick_type_ranks.clear();
+    for(size_t i = 0; i < N_MOB_TASK_INDEXES; i++) {
+        task_indexes[i].destroy();
+    }
+    ticking_sectors.clear();
     path_mgr.clear();
     spray_stats.clear();
     particles.clear();
@@ -1238,12 +1777,18 @@ void GameplayState::unload() {
     leader_movement.reset(); //TODO replace with a better solution.
     
     game.sys_content.anim_sparks.clear();
-    unload_game_content();
+    if(game.perf_mon) {
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_UNLOADING_CONTENT
+        );
+    }
+    
+    sprite_atlas.clear();
+    if(!retrying) unload_game_content();
     game.content.unload_current_area(CONTENT_LOAD_LEVEL_FULL);
     
-    if(bmp_fog) {
-        al_destroy_bitmap(bmp_fog);
-        bmp_fog = nullptr;
+    if(game.perf_mon) {
+        game.perf_mon->finish_measurement();
     }
     
     if(msg_box) {
@@ -1260,6 +1805,10 @@ void GameplayState::unload() {
     }
     game.maker_tools.info_print_text.clear();
     
+    if(game.perf_mon) {
+        game.perf_mon->leave_state();
+    }
+    
     unloading = false;
 }
 
@@ -1388,6 +1937,30 @@ void GameplayState::update_closest_group_members() {
 }
 
 
+/**
+ * @brief Updates the estimate of how much memory each subsystem uses,
+ * if the performance monitor or overlay need it, and enough time passed
+ * since the last update.
+ */
+void GameplayState::update_memory_report() {
+    if(!game.perf_mon && !game.maker_tools.perf_overlay) return;
+    
+    double now = al_get_time();
+    if(
+        memory_report_time != 0.0 &&
+        now - memory_report_time < GAMEPLAY::MEMORY_REPORT_INTERVAL
+    ) {
+        return;
+    }
+    memory_report_time = now;
+    
+    get_memory_usage_report(memory_report);
+    if(game.perf_mon) {
+        game.perf_mon->add_memory_report(memory_report);
+    }
+}
+
+
 /**
  * @brief Updates the transformations, with the current camera coordinates,
  * zoom, etc.
@@ -1410,6 +1983,28 @@ void GameplayState::update_transformations() {
 }
 
 
+/**
+ * @brief Waits for a loading step running in the background to finish,
+ * redrawing the loading screen in the meantime, so the window doesn't
+ * freeze while it's not done.
+ *
+ * @param task_id ID of the background task.
+ * @param progress 0 to 1, how far along the loading is.
+ */
+void GameplayState::wait_for_loading_task(size_t task_id, float progress) {
+    if(game.jobs.get_nr_workers() == 0) {
+        //Nobody else can run it, so just do it here.
+        game.jobs.finish_tasks();
+        return;
+    }
+    
+    while(!game.jobs.is_task_done(task_id)) {
+        draw_loading_progress(progress);
+        al_rest(GAMEPLAY::LOADING_SCREEN_REDRAW_INTERVAL);
+    }
+}
+
+
 /**
  * @brief Constructs a new message box info object.
  *
@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <functional>
+#include <tuple>
+
 #include "../../content/area/mission.h"
 #include "../../content/mob/interactable.h"
 #include "../../content/mob/onion.h"
@@ -20,17 +23,21 @@
 #include "../../core/controls_mediator.h"
 #include "../../core/maker_tools.h"
 #include "../../core/replay.h"
+#include "../../core/shaders.h"
 #include "../../util/general_utils.h"
 #include "../game_state.h"
 #include "gameplay_utils.h"
 #include "hud.h"
+#include "in_world_hud.h"
 #include "onion_menu.h"
 #include "pause_menu.h"
 
 
 namespace GAMEPLAY {
+extern const int AREA_IMAGE_TILE_SIZE;
 extern const float AREA_INTRO_HUD_MOVE_TIME;
 extern const float AREA_TITLE_FADE_DURATION;
+extern const int BAKED_SECTOR_TILE_SIZE;
 extern const float BIG_MSG_GO_DUR;
 extern const string BIG_MSG_GO_TEXT;
 extern const float BIG_MSG_MISSION_CLEAR_DUR;
@@ -44,9 +51,24 @@ extern const float CAMERA_BOX_MARGIN;
 extern const float CAMERA_SMOOTHNESS_MULT;
 extern const unsigned char COLLISION_OPACITY;
 extern const float ENEMY_MIX_DISTANCE;
-extern const int FOG_BITMAP_SIZE;
 extern const float LEADER_LAND_PART_MAX_SIZE;
 extern const float LEADER_LAND_PART_SIZE_MULT;
+extern const float LOADING_SCREEN_REDRAW_INTERVAL;
+extern const float LOGIC_STEP_DURATION;
+extern const size_t MAX_LOGIC_STEPS_PER_FRAME;
+extern const float MEMORY_REPORT_INTERVAL;
+extern const size_t MIN_INTERACTION_JOB_SIZE;
+extern const float MIN_RENDER_SCALE;
+extern const size_t PERF_OVERLAY_GRAPH_SAMPLES;
+extern const size_t PERF_OVERLAY_MAX_MOB_TYPES;
+extern const size_t PERF_OVERLAY_MAX_SAMPLES;
+extern const size_t PERF_OVERLAY_MAX_SCRIPT_COSTS;
+extern const float PERF_OVERLAY_WINDOW;
+extern const float PRECIPITATION_DROP_SIZE;
+extern const size_t PRECIPITATION_NR_DROPS;
+extern const float PRECIPITATION_SPEED;
+extern const float PREVIEW_CACHE_MAX_AGE;
+extern const float PREVIEW_CACHE_TOLERANCE;
 extern const unsigned char PREVIEW_OPACITY;
 extern const float PREVIEW_TEXTURE_SCALE;
 extern const float PREVIEW_TEXTURE_TIME_MULT;
@@ -127,9 +149,15 @@ public:
     //Is the player playing after hours?
     bool after_hours = false;
     
-    //Divides the area into cells, and lists whether a given cell is
-    //active for this frame or not.
-    vector<vector<bool> > area_active_cells;
+    //Divides the area into cells, and lists how many Pikmin and leaders
+    //are keeping each one active. Cells are ordered by column, then row.
+    vector<size_t> area_active_cell_refs;
+    
+    //Number of columns in the area's cells.
+    size_t nr_area_cell_cols = 0;
+    
+    //Number of rows in the area's cells.
+    size_t nr_area_cell_rows = 0;
     
     //How many seconds since area load. Doesn't count when things are paused.
     float area_time_passed = 0.0f;
@@ -140,9 +168,6 @@ public:
     //Leaders available to control.
     vector<Leader*> available_leaders;
     
-    //Fog effect buffer.
-    ALLEGRO_BITMAP* bmp_fog = nullptr;
-    
     //Closest to player 1's leader, for the previous, current, next type.
     Mob* closest_group_member[3] = { nullptr, nullptr, nullptr };
     
@@ -173,6 +198,9 @@ public:
     //Information about the in-game HUD.
     Hud* hud = nullptr;
     
+    //Pool of in-world HUD items for mobs to use.
+    InWorldHudItemPool in_world_hud_pool;
+    
     //Position of the last enemy killed. LARGE_FLOAT for none.
     Point last_enemy_killed_pos;
     
@@ -197,9 +225,20 @@ public:
     //Player 1's leader cursor, in world coordinates.
     Point leader_cursor_w;
     
+    //Number of logic frames that ran since the area was loaded.
+    size_t logic_frame_nr = 0;
+    
     //List of all mobs in the area.
     MobLists mobs;
     
+    //Grid with the location of every mob in the area, for faster
+    //proximity checks.
+    MobGrid mob_grid;
+    
+    //Indexes of the kinds of mobs that Pikmin and leaders look for,
+    //so the closest ones can be found quickly. Refilled every frame.
+    MobPointIndex task_indexes[N_MOB_TASK_INDEXES];
+    
     //Information about the message box currently active on player 1, if any.
     GameplayMessageBox* msg_box = nullptr;
     
@@ -218,11 +257,12 @@ public:
     //Path of the folder of the area to be loaded.
     string path_of_area_to_load;
     
-    //All droplets of precipitation.
-    vector<Point> precipitation;
+    //Random number that makes the area's precipitation unique.
+    float precipitation_seed = 0.0f;
     
-    //Time until the next drop of precipitation.
-    Timer precipitation_timer;
+    //Vertexes of every drop of precipitation. The drops are placed
+    //by the precipitation shader.
+    ALLEGRO_VERTEX_BUFFER* precipitation_vertex_buffer = nullptr;
     
     //Spray that player 1 has currently selected.
     size_t selected_spray = 0;
@@ -230,6 +270,14 @@ public:
     //How many of each spray/ingredients player 1 has.
     vector<SprayStats> spray_stats;
     
+    //Mobs whose status effect bitmaps are waiting to be drawn together,
+    //at the end of the run of mobs they're in.
+    vector<const Mob*> status_overlay_batch;
+    
+    //Whether status effect bitmaps are going into the batch right now,
+    //instead of being drawn right away.
+    bool status_overlay_batching = false;
+    
     //All types of subgroups.
     SubgroupTypeManager subgroup_types;
     
@@ -254,6 +302,10 @@ public:
     //Are we currently unloading the gameplay state?
     bool unloading = false;
     
+    //If true, the next unload and load keep the game content in memory,
+    //since the same area is about to be retried.
+    bool retrying = false;
+    
     //Have we went to the results screen yet?
     bool went_to_results = false;
     
@@ -344,6 +396,47 @@ public:
     //Starting number of leader mobs.
     size_t starting_nr_of_leaders = 0;
     
+    //Gameplay counters that mission things depend on that changed since
+    //the mission was last checked. Use MISSION_COUNTER.
+    bitmask_16_t changed_mission_counters = 0;
+    
+    //Counters the mission goal depends on. Use MISSION_COUNTER.
+    bitmask_16_t mission_goal_dependencies = 0;
+    
+    //Counters the mission's enabled fail conditions depend on.
+    //Use MISSION_COUNTER.
+    bitmask_16_t mission_fail_dependencies = 0;
+    
+    //Counters the mission's HUD score criteria depend on.
+    //Use MISSION_COUNTER.
+    bitmask_16_t mission_score_dependencies = 0;
+    
+    //Whole seconds of gameplay time in the previous frame.
+    int old_gameplay_seconds = 0;
+    
+    //Number of Pikmin mobs in the previous frame.
+    size_t old_nr_pikmin_mobs = 0;
+    
+    //Mission goal's current amount. Cache for performance.
+    int mission_goal_cur_amount = 0;
+    
+    //Mission goal's required amount. Cache for performance.
+    int mission_goal_req_amount = 0;
+    
+    //Mission primary fail condition's current amount. Cache for performance.
+    int mission_fail_1_cur_amount = 0;
+    
+    //Mission primary fail condition's required amount. Cache for performance.
+    int mission_fail_1_req_amount = 0;
+    
+    //Mission secondary fail condition's current amount.
+    //Cache for performance.
+    int mission_fail_2_cur_amount = 0;
+    
+    //Mission secondary fail condition's required amount.
+    //Cache for performance.
+    int mission_fail_2_req_amount = 0;
+    
     //Ratio of the mission goal HUD item's indicator.
     float goal_indicator_ratio = 0.0f;
     
@@ -389,12 +482,28 @@ public:
     void enter();
     void leave(const GAMEPLAY_LEAVE_TARGET target);
     void start_leaving(const GAMEPLAY_LEAVE_TARGET target);
+    void add_ticking_sector(Sector* s_ptr);
     void change_spray_count(size_t type_idx, signed int amount);
+    void clear_mob_active_cells(Mob* m_ptr);
     size_t get_amount_of_field_pikmin(const PikminType* filter = nullptr);
     size_t get_amount_of_group_pikmin(const PikminType* filter = nullptr);
     size_t get_amount_of_idle_pikmin(const PikminType* filter = nullptr);
     long get_amount_of_onion_pikmin(const PikminType* filter = nullptr);
     long get_amount_of_total_pikmin(const PikminType* filter = nullptr);
+    Mob* get_closest_mob(
+        const Point &pos, MOB_CATEGORY category,
+        const std::function<bool(Mob*)> &filter, Distance* out_dist = nullptr
+    );
+    void get_mobs_in_box(
+        const Point &tl, const Point &br, vector<Mob*> &out_mobs,
+        MOB_CATEGORY category = MOB_CATEGORY_NONE, MOB_TEAM team = N_MOB_TEAMS
+    );
+    void get_mobs_in_radius(
+        const Point &center, float radius, vector<Mob*> &out_mobs,
+        MOB_CATEGORY category = MOB_CATEGORY_NONE, MOB_TEAM team = N_MOB_TEAMS
+    );
+    size_t get_sprite_atlas_memory_usage() const;
+    bool is_area_cell_active(size_t cell_x, size_t cell_y) const;
     void is_near_enemy_and_boss(bool* near_enemy, bool* near_boss);
     void update_available_leaders();
     void update_closest_group_members();
@@ -410,6 +519,59 @@ private:
 
     //--- Members ---
     
+    //Area cells in the camera's region (plus padding) this frame: first and
+    //last column, then first and last row, all inclusive.
+    int cam_active_cells[4] = { 0, -1, 0, -1 };
+    
+    //Indexes of the mobs that get ticked this frame. The others are asleep.
+    //Cache for performance.
+    vector<size_t> awake_mob_idxs;
+    
+    //Indexes of the awake mobs, in the order they get ticked in. Mobs of
+    //the same category and type are kept together, so that their ticks
+    //run the same code one after the other. Cache for performance.
+    vector<size_t> mob_tick_order;
+    
+    //Sorting key of each awake mob that isn't a child or held, used to work
+    //out the tick order: its group, its type's rank, and its index.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<std::tuple<int, size_t, size_t> > mob_tick_order_keys;
+    
+    //Indexes of the awake mobs that are children or held, which get ticked
+    //last. Cache for performance, so the memory is reused from frame
+    //to frame.
+    vector<size_t> mob_tick_order_followers;
+    
+    //Rank of each mob type in the tick order, by when it first showed up
+    //in the area, so that the order is the same on every run.
+    unordered_map<const MobType*, size_t> mob_tick_type_ranks;
+    
+    //Liquid limit effect buffer used when drawing to a bitmap.
+    //Cache for performance, so it's reused between tiles.
+    ALLEGRO_BITMAP* bmp_output_liquid_limit_effect_buffer = nullptr;
+    
+    //Wall offset effect buffer used when drawing to a bitmap.
+    //Cache for performance, so it's reused between tiles.
+    ALLEGRO_BITMAP* bmp_output_wall_offset_effect_buffer = nullptr;
+    
+    //Tiles with the baked floors of static sectors. The key is the Z of the
+    //sectors, then the tile's column and row. Cache for performance.
+    map<std::tuple<float, int, int>, BakedSectorTile> baked_sector_tiles;
+    
+    //Camera zoom level the baked sector tiles were made for.
+    float baked_sector_tiles_zoom = 0.0f;
+    
+    //Sectors whose floor never changes, and so can be baked.
+    unordered_set<Sector*> bakeable_sectors;
+    
+    //Sectors with the same liquid that get drawn together.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<Sector*> liquid_batch_sectors;
+    
+    //Sectors that need to be ticked every frame, like the ones that are
+    //draining liquid or scrolling. The others don't need to be checked.
+    vector<Sector*> ticking_sectors;
+    
     //Points to an interactable close enough for player 1 to use, if any.
     Interactable* close_to_interactable_to_use = nullptr;
     
@@ -434,9 +596,72 @@ private:
     //Bitmap that lights up the area when in blackout mode.
     ALLEGRO_BITMAP* lightmap_bmp = nullptr;
     
+    //Bitmap the world gets drawn onto when the render scale is lowered.
+    ALLEGRO_BITMAP* world_render_bmp = nullptr;
+    
+    //Vertexes of all in-world health wheels to draw this frame.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<ALLEGRO_VERTEX> health_wheel_vertexes;
+    
+    //Shapes of the maker tools' debug visualizations to draw this frame.
+    DebugDrawBatch debug_draw_batch;
+    
+    //Vertexes of every tree shadow, six per shadow, in the same order as
+    //the area's list, and before any swaying. Cache for performance.
+    vector<TreeShadowVertex> tree_shadow_vertexes;
+    
+    //Bounding box of every tree shadow, counting how far it can sway.
+    //Cache for performance.
+    vector<std::pair<Point, Point> > tree_shadow_bboxes;
+    
+    //Index of the batch each tree shadow goes in. Cache for performance.
+    vector<size_t> tree_shadow_batch_idxs;
+    
+    //Bitmap of each batch of tree shadows. Cache for performance.
+    vector<ALLEGRO_BITMAP*> tree_shadow_batch_bmps;
+    
+    //Vertexes of the tree shadows to draw, per batch. Cache for
+    //performance, so the memory is reused from frame to frame.
+    vector<vector<TreeShadowVertex> > tree_shadow_batches;
+    
+    //How long each of the latest frames took, in seconds, for the
+    //performance overlay. Ring buffer.
+    vector<double> perf_overlay_frame_durs;
+    
+    //When each frame in the performance overlay's ring buffer ended.
+    vector<double> perf_overlay_frame_times;
+    
+    //Index in the performance overlay's ring buffer to write to next.
+    size_t perf_overlay_next_idx = 0;
+    
+    //When the latest frame was drawn, for the performance overlay.
+    //0 if it wasn't being recorded.
+    double perf_overlay_last_frame_time = 0.0;
+    
+    //Frame durations within the performance overlay's time window.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<double> perf_overlay_window_durs;
+    
+    //Latest estimate of how much memory each subsystem uses, in bytes.
+    vector<std::pair<string, size_t> > memory_report;
+    
+    //When the memory usage estimate was last updated. 0 if never.
+    double memory_report_time = 0.0;
+    
     //Movement of player 1's leader.
     MovementInfo leader_movement;
     
+    //Time that passed, but that the gameplay logic hasn't gone through yet,
+    //since it's shorter than a logic step.
+    float logic_time_left = 0.0f;
+    
+    //Interactions detected for each awake mob, in the same order as
+    //the awake mob indexes. Cache for performance.
+    vector<MobInteractionInfo> mob_interaction_infos;
+    
+    //Mobs to delete at the end of the logic step. Cache for performance.
+    vector<Mob*> mobs_to_delete;
+    
     //Information about the current Onion menu, if any.
     OnionMenu* onion_menu = nullptr;
     
@@ -446,6 +671,24 @@ private:
     //Is the gameplay paused?
     bool paused = false;
     
+    //Real camera position, while it's moved in between logic steps
+    //for drawing.
+    Point pre_interpolation_cam_pos;
+    
+    //Real camera zoom, while it's changed in between logic steps
+    //for drawing.
+    float pre_interpolation_cam_zoom = 1.0f;
+    
+    //Real positions and Z of each mob, while they're moved in between
+    //logic steps for drawing.
+    vector<std::pair<Point, float> > pre_interpolation_mob_coords;
+    
+    //Camera position before the latest logic step.
+    Point prev_step_cam_pos;
+    
+    //Camera zoom before the latest logic step.
+    float prev_step_cam_zoom = 1.0f;
+    
     //The first frame shouldn't allow for input just yet, because
     //some things are still being set up within the first logic loop.
     //So forbid input until the second frame.
@@ -454,15 +697,57 @@ private:
     //Timer for the next replay state save.
     Timer replay_timer;
     
+    //Where player 1's throw hits a wall, as of the last time it was
+    //calculated for the throw preview. Cache for performance.
+    ThrowPreviewCollision throw_preview_collision;
+    
+    //Edges near player 1's throw. Cache for performance, so the memory
+    //is reused from frame to frame.
+    vector<Edge*> throw_preview_edges;
+    
     //Is player 1 holding the "swarm to cursor" button?
     bool swarm_cursor = false;
     
+    //Pairs of mobs that can push each other this frame. Cache for
+    //performance, so the memory is reused from frame to frame.
+    vector<MobPushPair> mob_push_pairs;
+    
+    //Mob shadows that get drawn together, and how high up each mob is.
+    //Cache for performance, so the memory is reused from frame to frame.
+    vector<std::pair<const Mob*, float> > mob_shadow_batch;
+    
+    //Sprites of the mob types in the area, packed together.
+    SpriteAtlas sprite_atlas;
+    
     //Reach of player 1's swarm.
     MovementInfo swarm_movement;
     
+    //World components to draw. Cache for performance, so the memory
+    //is reused from frame to frame.
+    vector<WorldComponent> world_components;
+    
+    //Scratch space for sorting the world components. Cache for performance.
+    vector<WorldComponent> world_components_sort_buffer;
+    
+    //Particle world components to draw. Cache for performance.
+    vector<WorldComponent> world_particle_components;
+    
+    //Indexes of the mobs that may need to be drawn. Cache for performance.
+    vector<size_t> world_mob_idxs;
+    
+    //Sectors that may need to be drawn. Cache for performance.
+    vector<Sector*> world_sectors;
+    
+    //Liquids already drawn at the current Z while drawing the world
+    //components. Cache for performance.
+    vector<Liquid*> world_drawn_liquids;
+    
     
     //--- Function declarations ---
     
+    void add_new_mobs_to_grid();
+    void begin_interpolated_drawing(float ratio);
+    void change_area_cell_refs(const int range[4], int amount);
     void do_aesthetic_leader_logic(float delta_t);
     void do_aesthetic_logic(float delta_t);
     void do_game_drawing(
@@ -474,7 +759,20 @@ private:
     void do_gameplay_leader_logic(float delta_t);
     void do_gameplay_logic(float delta_t);
     void do_menu_logic();
+    void detect_mob_interactions(
+        Mob* m_ptr, size_t m, MobInteractionInfo &info,
+        vector<Point> &positions_buffer, vector<float> &dists_squared_buffer,
+        vector<Mob*> &candidates_buffer
+    );
+    void detect_mob_task_interactions(
+        Mob* m_ptr, vector<PendingIntermobEvent> &pending_events,
+        vector<Mob*> &candidates_buffer
+    );
+    void clear_baked_sector_tiles();
     void draw_background(ALLEGRO_BITMAP* bmp_output);
+    void draw_baked_sectors(
+        float z, const Point &view_tl, const Point &view_br
+    );
     void draw_debug_tools();
     void draw_leader_cursor(const ALLEGRO_COLOR &color);
     void draw_ingame_text();
@@ -483,33 +781,44 @@ private:
     void draw_gameplay_message_box();
     void draw_onion_menu();
     void draw_pause_menu();
+    void draw_perf_overlay();
+    void draw_loading_progress(float progress);
     void draw_precipitation();
     void draw_system_stuff();
     void draw_throw_preview();
-    void draw_tree_shadows();
+    void draw_tree_shadows(ALLEGRO_BITMAP* bmp_output);
     void draw_world_components(ALLEGRO_BITMAP* bmp_output);
+    void end_interpolated_drawing();
     void end_mission(bool cleared);
-    ALLEGRO_BITMAP* generate_fog_bitmap(
-        float near_radius, float far_radius
-    );
+    void record_perf_overlay_frame();
+    void update_memory_report();
+    void get_area_cell_range(
+        const Point &top_left, const Point &bottom_right, int out_range[4]
+    ) const;
     Mob* get_closest_group_member(const SubgroupType* type, bool* distant = nullptr);
     void handle_player_action(const PlayerAction &action);
     void init_hud();
     bool is_mission_clear_met();
     bool is_mission_fail_met(MISSION_FAIL_COND* reason);
-    void load_game_content();
-    void mark_area_cells_active(
-        const Point &top_left, const Point &bottom_right
+    bool is_pending_intermob_event_valid(
+        Mob* m_ptr, const PendingIntermobEvent &ev
     );
-    void mark_area_cells_active(
-        int from_x, int to_x, int from_y, int to_y
+    void load_game_content();
+    void process_mob_interactions(
+        Mob* m_ptr, size_t m, MobInteractionInfo &info
     );
-    void process_mob_interactions(Mob* m_ptr, size_t m);
     void process_mob_misc_interactions(
         Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2,
         const Distance &d, const Distance &d_between,
         vector<PendingIntermobEvent> &pending_intermob_events
     );
+    void process_mob_push(
+        Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, const Distance &d,
+        bool both_idle_pikmin, float circle_push_amount,
+        float circle_push_angle
+    );
+    void process_mob_push_pair(const MobPushPair &pair);
+    void process_mob_pushes();
     void process_mob_reaches(
         Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, const Distance &d_between,
         vector<PendingIntermobEvent> &pending_intermob_events
@@ -517,10 +826,20 @@ private:
     void process_mob_touches(
         Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, Distance &d
     );
+    void process_whistle();
+    void save_prev_step_coords();
     bool should_ignore_player_action(const PlayerAction &action);
     void unload_game_content();
     void update_area_active_cells();
+    void update_bakeable_sectors();
+    void update_throw_preview_collision(float throw_v_angle, float throw_speed);
+    void update_mob_active_cells(Mob* m_ptr);
     void update_mob_is_active_flag();
+    void update_mob_tick_order();
+    void update_task_indexes();
+    void update_tree_shadow_caches();
+    void update_world_render_bmp(float scale);
+    void wait_for_loading_task(size_t task_id, float progress);
     
 };
 
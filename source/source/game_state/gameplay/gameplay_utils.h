@@ -19,6 +19,23 @@ class Leader;
 class PikminType;
 
 
+/**
+ * @brief A tile with the baked floors of static sectors, as they'd look
+ * at a certain zoom level.
+ */
+struct BakedSectorTile {
+
+    //--- Members ---
+    
+    //Bitmap with the floors. nullptr if there's nothing to draw in the tile.
+    ALLEGRO_BITMAP* bitmap = nullptr;
+    
+    //Was the tile drawn this frame?
+    bool used = false;
+    
+};
+
+
 /**
  * @brief Info about an event involving two mobs.
  *
@@ -54,3 +71,85 @@ struct PendingIntermobEvent {
     }
     
 };
+
+
+/**
+ * @brief Info about the interactions a mob can have with others this frame,
+ * as found by the detection pass. The detection pass only reads from the
+ * world, so it can run for several mobs at once, and then the results are
+ * acted upon one mob at a time.
+ */
+struct MobInteractionInfo {
+
+    //--- Members ---
+    
+    //FSM state the mob was in when the interactions were detected.
+    MobState* state = nullptr;
+    
+    //Indexes of the mobs close enough to interact with.
+    vector<size_t> nearby_idxs;
+    
+    //Reach and miscellaneous events found, sorted from the closest mob
+    //to the farthest.
+    vector<PendingIntermobEvent> pending_events;
+    
+};
+
+
+/**
+ * @brief A pair of mobs that can push each other this frame.
+ * The mob with the lower index always comes first.
+ */
+struct MobPushPair {
+
+    //--- Members ---
+    
+    //Index of the first mob.
+    size_t m1 = 0;
+    
+    //Index of the second mob.
+    size_t m2 = 0;
+    
+    //Did the first mob find the second nearby? If so, it can be pushed by it.
+    bool m1_has_m2 = false;
+    
+    //Did the second mob find the first nearby? If so, it can be pushed by it.
+    bool m2_has_m1 = false;
+    
+};
+
+
+/**
+ * @brief Info about where a throw collides with a wall, if anywhere,
+ * and what the throw was like when that was found out.
+ */
+struct ThrowPreviewCollision {
+
+    //--- Members ---
+    
+    //Has this been calculated yet?
+    bool valid = false;
+    
+    //Leader's position when this was calculated.
+    Point leader_pos;
+    
+    //Leader's Z when this was calculated.
+    float leader_z = 0.0f;
+    
+    //Throw destination when this was calculated.
+    Point throw_dest;
+    
+    //Type of the mob being thrown when this was calculated.
+    MobType* throwee_type = nullptr;
+    
+    //Area time when this was calculated.
+    float calculation_time = 0.0f;
+    
+    //Ratio of the way to the destination at which the throw collides.
+    //Above 1 if it doesn't.
+    float wall_collision_r = 2.0f;
+    
+    //Is the collision against a blocking sector, as opposed to a wall?
+    bool wall_is_blocking_sector = false;
+    
+};
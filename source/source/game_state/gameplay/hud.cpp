@@ -155,7 +155,7 @@ Hud::Hud() :
             LeaderIconBubble icon;
             DrawInfo final_draw;
             game.states.gameplay->hud->leader_icon_mgr.get_drawing_info(
-                l, &icon, &final_draw
+                l, draw, &icon, &final_draw
             );
             
             if(!icon.bmp) return;
@@ -188,7 +188,7 @@ Hud::Hud() :
             LeaderHealthBubble health;
             DrawInfo final_draw;
             game.states.gameplay->hud->leader_health_mgr.get_drawing_info(
-                l, &health, &final_draw
+                l, draw, &health, &final_draw
             );
             
             if(health.ratio <= 0.0f) return;
@@ -376,6 +376,7 @@ Hud::Hud() :
     [this] (const DrawInfo & draw) {
         draw_bitmap_in_box(bmp_day_bubble, draw.center, draw.size, true);
     };
+    day_bubble->cache_drawing = true;
     gui.add_item(day_bubble, "day_bubble");
     
     
@@ -383,21 +384,38 @@ Hud::Hud() :
     GuiItem* day_nr = new GuiItem();
     day_nr->on_draw =
     [this] (const DrawInfo & draw) {
-        draw_text(
+        draw_cached_text(
             i2s(game.states.gameplay->day),
             game.sys_content.fnt_counter, draw.center,
             Point(draw.size.x * 0.70f, draw.size.y * 0.50f)
         );
     };
+    day_nr->cache_drawing = true;
+    day_nr->on_get_draw_cache_key =
+    [] () {
+        return i2s(game.states.gameplay->day);
+    };
     gui.add_item(day_nr, "day_number");
     
     
+    //What the standby items' drawing depends on, besides their content.
+    const auto standby_items_draw_cache_key =
+    [this] () {
+        return
+            f2s(standby_items_opacity) + " " +
+            b2s(game.states.gameplay->closest_group_member_distant);
+    };
+    
+    
     //Standby group member icon.
     GuiItem* standby_icon = new GuiItem();
     standby_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        game.states.gameplay->hud->draw_standby_icon(BUBBLE_RELATION_CURRENT);
+        game.states.gameplay->hud->draw_standby_icon(
+            BUBBLE_RELATION_CURRENT, draw
+        );
     };
+    standby_icon->on_get_draw_cache_key = standby_items_draw_cache_key;
     gui.add_item(standby_icon, "standby_icon");
     standby_icon_mgr.register_bubble(BUBBLE_RELATION_CURRENT, standby_icon);
     
@@ -406,8 +424,11 @@ Hud::Hud() :
     GuiItem* standby_next_icon = new GuiItem();
     standby_next_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        game.states.gameplay->hud->draw_standby_icon(BUBBLE_RELATION_NEXT);
+        game.states.gameplay->hud->draw_standby_icon(
+            BUBBLE_RELATION_NEXT, draw
+        );
     };
+    standby_next_icon->on_get_draw_cache_key = standby_items_draw_cache_key;
     gui.add_item(standby_next_icon, "standby_next_icon");
     standby_icon_mgr.register_bubble(BUBBLE_RELATION_NEXT, standby_next_icon);
     
@@ -444,8 +465,11 @@ Hud::Hud() :
     GuiItem* standby_prev_icon = new GuiItem();
     standby_prev_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        game.states.gameplay->hud->draw_standby_icon(BUBBLE_RELATION_PREVIOUS);
+        game.states.gameplay->hud->draw_standby_icon(
+            BUBBLE_RELATION_PREVIOUS, draw
+        );
     };
+    standby_prev_icon->on_get_draw_cache_key = standby_items_draw_cache_key;
     gui.add_item(standby_prev_icon, "standby_prev_icon");
     standby_icon_mgr.register_bubble(BUBBLE_RELATION_PREVIOUS, standby_prev_icon);
     
@@ -556,23 +580,23 @@ Hud::Hud() :
             map_alpha(game.states.gameplay->hud->standby_items_opacity * 255)
         );
     };
+    standby_bubble->cache_drawing = true;
+    standby_bubble->on_get_draw_cache_key = standby_items_draw_cache_key;
     gui.add_item(standby_bubble, "standby_bubble");
     
     
     //Standby subgroup member amount.
     standby_amount = new GuiItem();
-    standby_amount->on_draw =
-    [this] (const DrawInfo & draw) {
+    standby_amount->on_tick =
+    [this] (float delta_t) {
         size_t n_standby_pikmin = 0;
         Leader* l_ptr = game.states.gameplay->cur_leader_ptr;
         
         if(l_ptr && l_ptr->group->cur_standby_type) {
-            for(size_t m = 0; m < l_ptr->group->members.size(); m++) {
-                Mob* m_ptr = l_ptr->group->members[m];
-                if(m_ptr->subgroup_type_ptr == l_ptr->group->cur_standby_type) {
-                    n_standby_pikmin++;
-                }
-            }
+            n_standby_pikmin =
+                l_ptr->group->get_amount_by_subgroup_type(
+                    l_ptr->group->cur_standby_type
+                );
         }
         
         if(n_standby_pikmin != standby_count_nr) {
@@ -581,15 +605,22 @@ Hud::Hud() :
             );
             standby_count_nr = n_standby_pikmin;
         }
-        
-        draw_text(
-            i2s(n_standby_pikmin), game.sys_content.fnt_counter,
+    };
+    standby_amount->on_draw =
+    [this] (const DrawInfo & draw) {
+        draw_cached_text(
+            i2s(standby_count_nr), game.sys_content.fnt_counter,
             draw.center, draw.size,
             map_alpha(game.states.gameplay->hud->standby_items_opacity * 255),
             ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
             Point(1.0f + standby_amount->get_juice_value())
         );
     };
+    standby_amount->cache_drawing = true;
+    standby_amount->on_get_draw_cache_key =
+    [this, standby_items_draw_cache_key] () {
+        return i2s(standby_count_nr) + " " + standby_items_draw_cache_key();
+    };
     gui.add_item(standby_amount, "standby_amount");
     
     
@@ -603,13 +634,18 @@ Hud::Hud() :
             draw.center, draw.size
         );
     };
+    group_bubble->cache_drawing = true;
+    group_bubble->on_get_draw_cache_key =
+    [] () {
+        return b2s(game.states.gameplay->cur_leader_ptr != nullptr);
+    };
     gui.add_item(group_bubble, "group_bubble");
     
     
     //Group Pikmin amount.
     group_amount = new GuiItem();
-    group_amount->on_draw =
-    [this] (const DrawInfo & draw) {
+    group_amount->on_tick =
+    [this] (float delta_t) {
         if(!game.states.gameplay->cur_leader_ptr) return;
         size_t cur_amount = game.states.gameplay->get_amount_of_group_pikmin();
         
@@ -619,14 +655,24 @@ Hud::Hud() :
             );
             group_count_nr = cur_amount;
         }
-        
-        draw_text(
-            i2s(cur_amount), game.sys_content.fnt_counter,
+    };
+    group_amount->on_draw =
+    [this] (const DrawInfo & draw) {
+        if(!game.states.gameplay->cur_leader_ptr) return;
+        draw_cached_text(
+            i2s(group_count_nr), game.sys_content.fnt_counter,
             draw.center, Point(draw.size.x * 0.70f, draw.size.y * 0.50f), COLOR_WHITE,
             ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
             Point(1.0f + group_amount->get_juice_value())
         );
     };
+    group_amount->cache_drawing = true;
+    group_amount->on_get_draw_cache_key =
+    [this] () {
+        return
+            b2s(game.states.gameplay->cur_leader_ptr != nullptr) + " " +
+            i2s(group_count_nr);
+    };
     gui.add_item(group_amount, "group_amount");
     
     
@@ -639,13 +685,14 @@ Hud::Hud() :
             draw.center, draw.size
         );
     };
+    field_bubble->cache_drawing = true;
     gui.add_item(field_bubble, "field_bubble");
     
     
     //Field Pikmin amount.
     field_amount = new GuiItem();
-    field_amount->on_draw =
-    [this] (const DrawInfo & draw) {
+    field_amount->on_tick =
+    [this] (float delta_t) {
         size_t cur_amount = game.states.gameplay->get_amount_of_field_pikmin();
         
         if(cur_amount != field_count_nr) {
@@ -654,14 +701,21 @@ Hud::Hud() :
             );
             field_count_nr = cur_amount;
         }
-        
-        draw_text(
-            i2s(cur_amount), game.sys_content.fnt_counter,
+    };
+    field_amount->on_draw =
+    [this] (const DrawInfo & draw) {
+        draw_cached_text(
+            i2s(field_count_nr), game.sys_content.fnt_counter,
             draw.center, Point(draw.size.x * 0.70f, draw.size.y * 0.50f), COLOR_WHITE,
             ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
             Point(1.0f + field_amount->get_juice_value())
         );
     };
+    field_amount->cache_drawing = true;
+    field_amount->on_get_draw_cache_key =
+    [this] () {
+        return i2s(field_count_nr);
+    };
     gui.add_item(field_amount, "field_amount");
     
     
@@ -674,13 +728,14 @@ Hud::Hud() :
             draw.center, draw.size
         );
     };
+    total_bubble->cache_drawing = true;
     gui.add_item(total_bubble, "total_bubble");
     
     
     //Total Pikmin amount.
     total_amount = new GuiItem();
-    total_amount->on_draw =
-    [this] (const DrawInfo & draw) {
+    total_amount->on_tick =
+    [this] (float delta_t) {
         size_t cur_amount = game.states.gameplay->get_amount_of_total_pikmin();
         
         if(cur_amount != total_count_nr) {
@@ -689,14 +744,21 @@ Hud::Hud() :
             );
             total_count_nr = cur_amount;
         }
-        
-        draw_text(
+    };
+    total_amount->on_draw =
+    [this] (const DrawInfo & draw) {
+        draw_cached_text(
             i2s(total_count_nr), game.sys_content.fnt_counter,
             draw.center, Point(draw.size.x * 0.70f, draw.size.y * 0.50f), COLOR_WHITE,
             ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
             Point(1.0f + total_amount->get_juice_value())
         );
     };
+    total_amount->cache_drawing = true;
+    total_amount->on_get_draw_cache_key =
+    [this] () {
+        return i2s(total_count_nr);
+    };
     gui.add_item(total_amount, "total_amount");
     
     
@@ -704,11 +766,13 @@ Hud::Hud() :
     GuiItem* counters_x = new GuiItem();
     counters_x->on_draw =
     [this] (const DrawInfo & draw) {
-        draw_text(
+        draw_cached_text(
             "x", game.sys_content.fnt_counter, draw.center, draw.size,
             map_alpha(game.states.gameplay->hud->standby_items_opacity * 255)
         );
     };
+    counters_x->cache_drawing = true;
+    counters_x->on_get_draw_cache_key = standby_items_draw_cache_key;
     gui.add_item(counters_x, "counters_x");
     
     
@@ -718,10 +782,15 @@ Hud::Hud() :
         counter_slash->on_draw =
         [this] (const DrawInfo & draw) {
             if(!game.states.gameplay->cur_leader_ptr) return;
-            draw_text(
+            draw_cached_text(
                 "/", game.sys_content.fnt_counter, draw.center, draw.size
             );
         };
+        counter_slash->cache_drawing = true;
+        counter_slash->on_get_draw_cache_key =
+        [] () {
+            return b2s(game.states.gameplay->cur_leader_ptr != nullptr);
+        };
         gui.add_item(counter_slash, "counters_slash_" + i2s(s + 1));
     }
     
@@ -730,7 +799,11 @@ Hud::Hud() :
     GuiItem* spray_1_icon = new GuiItem();
     spray_1_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        draw_spray_icon(BUBBLE_RELATION_CURRENT);
+        draw_spray_icon(BUBBLE_RELATION_CURRENT, draw);
+    };
+    spray_1_icon->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
     };
     gui.add_item(spray_1_icon, "spray_1_icon");
     spray_icon_mgr.register_bubble(BUBBLE_RELATION_CURRENT, spray_1_icon);
@@ -750,7 +823,7 @@ Hud::Hud() :
         }
         if(top_spray_idx == INVALID) return;
         
-        draw_text(
+        draw_cached_text(
             "x" +
             i2s(game.states.gameplay->spray_stats[top_spray_idx].nr_sprays),
             game.sys_content.fnt_counter,
@@ -760,6 +833,11 @@ Hud::Hud() :
             Point(1.0f + spray_1_amount->get_juice_value())
         );
     };
+    spray_1_amount->cache_drawing = true;
+    spray_1_amount->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
+    };
     gui.add_item(spray_1_amount, "spray_1_amount");
     
     
@@ -825,6 +903,11 @@ Hud::Hud() :
             map_alpha(game.states.gameplay->hud->spray_items_opacity * 255)
         );
     };
+    spray_2_icon->cache_drawing = true;
+    spray_2_icon->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
+    };
     gui.add_item(spray_2_icon, "spray_2_icon");
     
     
@@ -840,7 +923,7 @@ Hud::Hud() :
         }
         if(bottom_spray_idx == INVALID) return;
         
-        draw_text(
+        draw_cached_text(
             "x" +
             i2s(game.states.gameplay->spray_stats[bottom_spray_idx].nr_sprays),
             game.sys_content.fnt_counter,
@@ -850,6 +933,11 @@ Hud::Hud() :
             Point(1.0f + spray_2_amount->get_juice_value())
         );
     };
+    spray_2_amount->cache_drawing = true;
+    spray_2_amount->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
+    };
     gui.add_item(spray_2_amount, "spray_2_amount");
     
     
@@ -889,7 +977,11 @@ Hud::Hud() :
     GuiItem* prev_spray_icon = new GuiItem();
     prev_spray_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        draw_spray_icon(BUBBLE_RELATION_PREVIOUS);
+        draw_spray_icon(BUBBLE_RELATION_PREVIOUS, draw);
+    };
+    prev_spray_icon->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
     };
     gui.add_item(prev_spray_icon, "spray_prev_icon");
     spray_icon_mgr.register_bubble(BUBBLE_RELATION_PREVIOUS, prev_spray_icon);
@@ -933,7 +1025,11 @@ Hud::Hud() :
     GuiItem* next_spray_icon = new GuiItem();
     next_spray_icon->on_draw =
     [this] (const DrawInfo & draw) {
-        draw_spray_icon(BUBBLE_RELATION_NEXT);
+        draw_spray_icon(BUBBLE_RELATION_NEXT, draw);
+    };
+    next_spray_icon->on_get_draw_cache_key =
+    [this] () {
+        return get_spray_items_draw_cache_key();
     };
     gui.add_item(next_spray_icon, "spray_next_icon");
     spray_icon_mgr.register_bubble(BUBBLE_RELATION_NEXT, next_spray_icon);
@@ -1024,7 +1120,7 @@ Hud::Hud() :
             mission_goal_cur_label->on_draw =
                 [this, goal_cur_label_text]
             (const DrawInfo & draw) {
-                draw_text(
+                draw_cached_text(
                     goal_cur_label_text, game.sys_content.fnt_standard,
                     draw.center, draw.size, al_map_rgba(255, 255, 255, 128)
                 );
@@ -1037,9 +1133,7 @@ Hud::Hud() :
             mission_goal_cur->on_draw =
                 [this, mission_goal_cur]
             (const DrawInfo & draw) {
-                int value =
-                    game.mission_goals[game.cur_area_data->mission.goal]->
-                    get_cur_amount(game.states.gameplay);
+                int value = game.states.gameplay->mission_goal_cur_amount;
                 string text;
                 if(
                     game.cur_area_data->mission.goal ==
@@ -1051,7 +1145,7 @@ Hud::Hud() :
                 }
                 float juicy_grow_amount =
                     mission_goal_cur->get_juice_value();
-                draw_text(
+                draw_cached_text(
                     text, game.sys_content.fnt_counter, draw.center, draw.size,
                     COLOR_WHITE, ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
                     Point(1.0 + juicy_grow_amount)
@@ -1065,7 +1159,7 @@ Hud::Hud() :
             GuiItem* mission_goal_req_label = new GuiItem();
             mission_goal_req_label->on_draw =
             [this] (const DrawInfo & draw) {
-                draw_text(
+                draw_cached_text(
                     "Goal", game.sys_content.fnt_standard, draw.center, draw.size,
                     al_map_rgba(255, 255, 255, 128)
                 );
@@ -1077,9 +1171,7 @@ Hud::Hud() :
             GuiItem* mission_goal_req = new GuiItem();
             mission_goal_req->on_draw =
             [this] (const DrawInfo & draw) {
-                int value =
-                    game.mission_goals[game.cur_area_data->mission.goal]->
-                    get_req_amount(game.states.gameplay);
+                int value = game.states.gameplay->mission_goal_req_amount;
                 string text;
                 if(
                     game.cur_area_data->mission.goal ==
@@ -1089,7 +1181,7 @@ Hud::Hud() :
                 } else {
                     text = i2s(value);
                 }
-                draw_text(
+                draw_cached_text(
                     text, game.sys_content.fnt_counter, draw.center, draw.size
                 );
             };
@@ -1100,7 +1192,7 @@ Hud::Hud() :
             GuiItem* mission_goal_slash = new GuiItem();
             mission_goal_slash->on_draw =
             [this] (const DrawInfo & draw) {
-                draw_text(
+                draw_cached_text(
                     "/", game.sys_content.fnt_counter, draw.center, draw.size
                 );
             };
@@ -1112,7 +1204,7 @@ Hud::Hud() :
             GuiItem* mission_goal_name = new GuiItem();
             mission_goal_name->on_draw =
             [this] (const DrawInfo & draw) {
-                draw_text(
+                draw_cached_text(
                     game.mission_goals[game.cur_area_data->mission.goal]->
                     get_name(), game.sys_content.fnt_standard,
                     draw.center, draw.size, al_map_rgba(255, 255, 255, 128)
@@ -1149,7 +1241,7 @@ Hud::Hud() :
         GuiItem* mission_score_score_label = new GuiItem();
         mission_score_score_label->on_draw =
         [this] (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 "Score:", game.sys_content.fnt_standard,
                 Point(draw.center.x + draw.size.x / 2.0f, draw.center.y), draw.size,
                 al_map_rgba(255, 255, 255, 128), ALLEGRO_ALIGN_RIGHT
@@ -1164,7 +1256,7 @@ Hud::Hud() :
             [this, mission_score_points]
         (const DrawInfo & draw) {
             float juicy_grow_amount = mission_score_points->get_juice_value();
-            draw_text(
+            draw_cached_text(
                 i2s(game.states.gameplay->mission_score),
                 game.sys_content.fnt_counter, draw.center, draw.size, COLOR_WHITE,
                 ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
@@ -1179,7 +1271,7 @@ Hud::Hud() :
         GuiItem* mission_score_points_label = new GuiItem();
         mission_score_points_label->on_draw =
         [this] (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 "pts", game.sys_content.fnt_standard,
                 Point(draw.center.x + draw.size.x / 2.0f, draw.center.y), draw.size,
                 al_map_rgba(255, 255, 255, 128), ALLEGRO_ALIGN_RIGHT
@@ -1518,7 +1610,7 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         GuiItem* mission_fail_cur_label = new GuiItem();
         mission_fail_cur_label->on_draw =
         [this, cond] (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 game.mission_fail_conds[cond]->
                 get_hud_label(game.states.gameplay),
                 game.sys_content.fnt_standard, draw.center, draw.size,
@@ -1536,11 +1628,12 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         //Mission fail condition current.
         GuiItem* mission_fail_cur = new GuiItem();
         mission_fail_cur->on_draw =
-            [this, cond, mission_fail_cur]
+            [this, cond, primary, mission_fail_cur]
         (const DrawInfo & draw) {
             int value =
-                game.mission_fail_conds[cond]->
-                get_cur_amount(game.states.gameplay);
+                primary ?
+                game.states.gameplay->mission_fail_1_cur_amount :
+                game.states.gameplay->mission_fail_2_cur_amount;
             string text;
             if(cond == MISSION_FAIL_COND_TIME_LIMIT) {
                 text = time_to_str2(value, ":", "");
@@ -1548,7 +1641,7 @@ void Hud::create_mission_fail_cond_items(bool primary) {
                 text = i2s(value);
             }
             float juicy_grow_amount = mission_fail_cur->get_juice_value();
-            draw_text(
+            draw_cached_text(
                 text, game.sys_content.fnt_counter, draw.center, draw.size,
                 COLOR_WHITE, ALLEGRO_ALIGN_CENTER, V_ALIGN_MODE_CENTER, 0,
                 Point(1.0 + juicy_grow_amount)
@@ -1572,7 +1665,7 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         mission_fail_req_label->on_draw =
             [this]
         (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 "Fail", game.sys_content.fnt_standard, draw.center, draw.size,
                 al_map_rgba(255, 255, 255, 128)
             );
@@ -1588,17 +1681,18 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         //Mission fail condition requirement.
         GuiItem* mission_fail_req = new GuiItem();
         mission_fail_req->on_draw =
-        [this, cond] (const DrawInfo & draw) {
+        [this, cond, primary] (const DrawInfo & draw) {
             int value =
-                game.mission_fail_conds[cond]->
-                get_req_amount(game.states.gameplay);
+                primary ?
+                game.states.gameplay->mission_fail_1_req_amount :
+                game.states.gameplay->mission_fail_2_req_amount;
             string text;
             if(cond == MISSION_FAIL_COND_TIME_LIMIT) {
                 text = time_to_str2(value, ":", "");
             } else {
                 text = i2s(value);
             }
-            draw_text(
+            draw_cached_text(
                 text, game.sys_content.fnt_counter, draw.center, draw.size
             );
         };
@@ -1614,7 +1708,7 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         GuiItem* mission_fail_slash = new GuiItem();
         mission_fail_slash->on_draw =
         [this] (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 "/", game.sys_content.fnt_counter, draw.center, draw.size
             );
         };
@@ -1631,7 +1725,7 @@ void Hud::create_mission_fail_cond_items(bool primary) {
         GuiItem* mission_fail_name = new GuiItem();
         mission_fail_name->on_draw =
         [this, cond] (const DrawInfo & draw) {
-            draw_text(
+            draw_cached_text(
                 "Fail: " +
                 game.mission_fail_conds[cond]->get_name(),
                 game.sys_content.fnt_standard, draw.center, draw.size,
@@ -1655,19 +1749,20 @@ void Hud::create_mission_fail_cond_items(bool primary) {
  *
  * @param which Which spray icon to draw -- the previous type's,
  * the current type's, or the next type's.
+ * @param draw Drawing information the icon's GUI item was given.
  */
-void Hud::draw_spray_icon(BUBBLE_RELATION which) {
+void Hud::draw_spray_icon(BUBBLE_RELATION which, const DrawInfo &draw) {
     if(!game.states.gameplay->cur_leader_ptr) return;
     
-    DrawInfo draw;
+    DrawInfo final_draw;
     ALLEGRO_BITMAP* icon;
     game.states.gameplay->hud->spray_icon_mgr.get_drawing_info(
-        which, &icon, &draw
+        which, draw, &icon, &final_draw
     );
     
     if(!icon) return;
     draw_bitmap_in_box(
-        icon, draw.center, draw.size, true, 0.0f,
+        icon, final_draw.center, final_draw.size, true, 0.0f,
         map_alpha(game.states.gameplay->hud->spray_items_opacity * 255)
     );
 }
@@ -1678,12 +1773,13 @@ void Hud::draw_spray_icon(BUBBLE_RELATION which) {
  *
  * @param which Which standby icon to draw -- the previous type's,
  * the current type's, or the next type's.
+ * @param draw Drawing information the icon's GUI item was given.
  */
-void Hud::draw_standby_icon(BUBBLE_RELATION which) {
-    DrawInfo draw;
+void Hud::draw_standby_icon(BUBBLE_RELATION which, const DrawInfo &draw) {
+    DrawInfo final_draw;
     ALLEGRO_BITMAP* icon;
     game.states.gameplay->hud->standby_icon_mgr.get_drawing_info(
-        which, &icon, &draw
+        which, draw, &icon, &final_draw
     );
     
     if(!icon) return;
@@ -1691,7 +1787,9 @@ void Hud::draw_standby_icon(BUBBLE_RELATION which) {
     ALLEGRO_COLOR color =
         map_alpha(game.states.gameplay->hud->standby_items_opacity * 255);
         
-    draw_bitmap_in_box(icon, draw.center, draw.size * 0.8, true, 0.0f, color);
+    draw_bitmap_in_box(
+        icon, final_draw.center, final_draw.size * 0.8, true, 0.0f, color
+    );
     
     if(
         game.states.gameplay->closest_group_member_distant &&
@@ -1699,14 +1797,34 @@ void Hud::draw_standby_icon(BUBBLE_RELATION which) {
     ) {
         draw_bitmap_in_box(
             bmp_distant_pikmin_marker,
-            draw.center,
-            draw.size * 0.8,
+            final_draw.center,
+            final_draw.size * 0.8,
             true,
             0.0f, color
         );
     }
     
-    draw_bitmap_in_box(bmp_bubble, draw.center, draw.size, true, 0.0f, color);
+    draw_bitmap_in_box(
+        bmp_bubble, final_draw.center, final_draw.size, true, 0.0f, color
+    );
+}
+
+
+/**
+ * @brief Returns what the spray items' drawing depends on, besides
+ * their size. This is their draw cache key.
+ *
+ * @return The key.
+ */
+string Hud::get_spray_items_draw_cache_key() const {
+    string key =
+        b2s(game.states.gameplay->cur_leader_ptr != nullptr) + " " +
+        f2s(spray_items_opacity) + " " +
+        i2s(game.states.gameplay->selected_spray);
+    for(size_t s = 0; s < game.states.gameplay->spray_stats.size(); s++) {
+        key += " " + i2s(game.states.gameplay->spray_stats[s].nr_sprays);
+    }
+    return key;
 }
 
 
@@ -1906,3 +2024,25 @@ void Hud::tick(float delta_t) {
     //Tick the GUI items proper.
     gui.tick(game.delta_t);
 }
+
+
+/**
+ * @brief Returns whether two leader health bubbles are different.
+ *
+ * @param b2 The other bubble.
+ * @return Whether they are different.
+ */
+bool Hud::LeaderHealthBubble::operator!=(const LeaderHealthBubble &b2) const {
+    return ratio != b2.ratio || caution_timer != b2.caution_timer;
+}
+
+
+/**
+ * @brief Returns whether two leader icon bubbles are different.
+ *
+ * @param b2 The other bubble.
+ * @return Whether they are different.
+ */
+bool Hud::LeaderIconBubble::operator!=(const LeaderIconBubble &b2) const {
+    return bmp != b2.bmp || color != b2.color;
+}
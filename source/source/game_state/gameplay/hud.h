@@ -69,6 +69,11 @@ struct Hud {
         //Leader icon color.
         ALLEGRO_COLOR color = COLOR_EMPTY;
         
+        
+        //--- Function declarations ---
+        
+        bool operator!=(const LeaderIconBubble &b2) const;
+    
     };
     
     /**
@@ -84,6 +89,11 @@ struct Hud {
         //Timer for the low-health caution animation.
         float caution_timer = 0.0f;
         
+        
+        //--- Function declarations ---
+        
+        bool operator!=(const LeaderHealthBubble &b2) const;
+        
     };
     
     
@@ -194,7 +204,8 @@ private:
     //--- Function declarations ---
     
     void create_mission_fail_cond_items(bool primary);
-    void draw_standby_icon(BUBBLE_RELATION which);
-    void draw_spray_icon(BUBBLE_RELATION which);
+    void draw_standby_icon(BUBBLE_RELATION which, const DrawInfo &draw);
+    void draw_spray_icon(BUBBLE_RELATION which, const DrawInfo &draw);
+    string get_spray_items_draw_cache_key() const;
     
 };
@@ -46,8 +46,11 @@ enum HUD_BUBBLE_MOVE_METHOD {
  * of the transition. For thing X, for the first half, it's the old GUI item
  * that is in charge of showing it moving. For the second half, it's the new
  * GUI item.
+ *
+ * While there's no transition going on, the bubbles keep their drawing
+ * cached, and only draw it again when the content they're given changes.
 
- * @tparam t Type of content the bubble holds.
+ * @tparam t Type of content the bubble holds. It must be comparable with !=.
  */
 template<typename t>
 struct HudBubbleManager {
@@ -122,12 +125,15 @@ struct HudBubbleManager {
     * to draw itself.
     *
     * @param id ID of the registered bubble.
+    * @param item_draw Drawing information the bubble's on_draw was called
+    * with. The final position is relative to this one, so that this works
+    * when the bubble is being drawn to its draw cache bitmap too.
     * @param content The content the bubble should use is returned here.
     * A default-constructed object is returned on error.
     * @param draw The final drawing information it should use is returned here.
     */
     void get_drawing_info(
-        size_t id,
+        size_t id, const DrawInfo &item_draw,
         t* content, DrawInfo* draw
     ) {
         float transition_anim_ratio = transition_timer / transition_duration;
@@ -144,6 +150,7 @@ struct HudBubbleManager {
             *content = t();
             return;
         }
+        Point screen_center = draw->center;
         
         typename map<size_t, Bubble>::iterator match_it;
         GuiItem* match_ptr = nullptr;
@@ -286,6 +293,8 @@ struct HudBubbleManager {
         } else {
             *content = it->second.content;
         }
+        
+        draw->center += item_draw.center - screen_center;
     }
     
     
@@ -311,6 +320,11 @@ struct HudBubbleManager {
             transition_timer = std::max(transition_timer, 0.0f);
             transition_is_setup = false;
         }
+        
+        //Mid-transition, the bubbles move every frame.
+        for(auto &b : bubbles) {
+            b.second.bubble->cache_drawing = transition_timer == 0.0f;
+        }
     }
     
     /**
@@ -331,6 +345,9 @@ struct HudBubbleManager {
             transition_timer = transition_duration;
             transition_is_setup = true;
         }
+        if(it->second.content != new_content) {
+            it->second.bubble->invalidate_draw_cache();
+        }
         it->second.ref = new_ref;
         it->second.content = new_content;
     }
@@ -8,6 +8,8 @@
  * In-world HUD class and in-world HUD-related functions.
  */
 
+#include <algorithm>
+
 #include "in_world_hud.h"
 
 #include "../../content/mob/mob.h"
@@ -49,6 +51,9 @@ const float TRANSITION_OUT_DURATION = 0.5f;
 
 namespace IN_WORLD_HEALTH_WHEEL {
 
+//Number of segments that make up the wheel's circles.
+const unsigned char NR_SEGMENTS = 32;
+
 //Standard opacity.
 const float OPACITY = 0.85f;
 
@@ -143,7 +148,7 @@ void InWorldFraction::draw() {
             al_get_font_line_height(game.sys_content.fnt_standard) -
             IN_WORLD_FRACTION::PADDING
         );
-        draw_text(
+        draw_cached_text(
             i2s(value_number), game.sys_content.fnt_standard, pos,
             Point(LARGE_FLOAT, IN_WORLD_FRACTION::ROW_HEIGHT * size_mult),
             final_color
@@ -256,9 +261,12 @@ InWorldHealthWheel::InWorldHealthWheel(Mob* m) :
 
 
 /**
- * @brief Draws an in-world health wheel.
+ * @brief Adds the triangles that make up an in-world health wheel to a list
+ * of vertexes, so that many health wheels can be drawn in one go.
+ *
+ * @param vertexes List to add the vertexes to.
  */
-void InWorldHealthWheel::draw() {
+void InWorldHealthWheel::add_vertexes(vector<ALLEGRO_VERTEX> &vertexes) {
     float alpha_mult = 1.0f;
     float size_mult = 1.0f;
     switch(transition) {
@@ -281,15 +289,79 @@ void InWorldHealthWheel::draw() {
     }
     
     float radius = DRAWING::DEF_HEALTH_WHEEL_RADIUS * size_mult;
-    draw_health(
-        Point(
-            m->pos.x,
-            m->pos.y - m->radius -
-            radius - IN_WORLD_HEALTH_WHEEL::PADDING
-        ),
-        visible_ratio,
-        IN_WORLD_HEALTH_WHEEL::OPACITY * alpha_mult,
-        radius
+    float alpha = IN_WORLD_HEALTH_WHEEL::OPACITY * alpha_mult;
+    Point center(
+        m->pos.x,
+        m->pos.y - m->radius - radius - IN_WORLD_HEALTH_WHEEL::PADDING
+    );
+    
+    ALLEGRO_COLOR back_color = al_map_rgba_f(0.0f, 0.0f, 0.0f, 0.5f * alpha);
+    ALLEGRO_COLOR outline_color = al_map_rgba_f(0.0f, 0.0f, 0.0f, alpha);
+    ALLEGRO_COLOR pie_color;
+    if(visible_ratio >= 0.5f) {
+        pie_color =
+            al_map_rgba_f(1.0f - (visible_ratio - 0.5f) * 2.0f, 1.0f, 0, alpha);
+    } else {
+        pie_color = al_map_rgba_f(1.0f, visible_ratio * 2.0f, 0, alpha);
+    }
+    
+    const auto add_vertex =
+    [&vertexes, &center] (float angle, float dist, const ALLEGRO_COLOR & c) {
+        ALLEGRO_VERTEX v;
+        v.x = center.x + cos(angle) * dist;
+        v.y = center.y + sin(angle) * dist;
+        v.z = 0.0f;
+        v.u = 0.0f;
+        v.v = 0.0f;
+        v.color = c;
+        vertexes.push_back(v);
+    };
+    const float seg_angle = TAU / IN_WORLD_HEALTH_WHEEL::NR_SEGMENTS;
+    
+    //Background.
+    for(unsigned char s = 0; s < IN_WORLD_HEALTH_WHEEL::NR_SEGMENTS; s++) {
+        add_vertex(0.0f, 0.0f, back_color);
+        add_vertex(s * seg_angle, radius, back_color);
+        add_vertex((s + 1) * seg_angle, radius, back_color);
+    }
+    
+    //Pie slice. It starts at the top and goes counterclockwise.
+    float pie_ratio = std::clamp(visible_ratio, 0.0f, 1.0f);
+    size_t nr_pie_segs =
+        ceil(pie_ratio * IN_WORLD_HEALTH_WHEEL::NR_SEGMENTS);
+    for(size_t s = 0; s < nr_pie_segs; s++) {
+        float start_angle =
+            -TAU / 4.0f - pie_ratio * TAU * s / nr_pie_segs;
+        float end_angle =
+            -TAU / 4.0f - pie_ratio * TAU * (s + 1) / nr_pie_segs;
+        add_vertex(0.0f, 0.0f, pie_color);
+        add_vertex(start_angle, radius, pie_color);
+        add_vertex(end_angle, radius, pie_color);
+    }
+    
+    //Outline.
+    for(unsigned char s = 0; s < IN_WORLD_HEALTH_WHEEL::NR_SEGMENTS; s++) {
+        float start_angle = s * seg_angle;
+        float end_angle = (s + 1) * seg_angle;
+        add_vertex(start_angle, radius, outline_color);
+        add_vertex(start_angle, radius + 2.0f, outline_color);
+        add_vertex(end_angle, radius + 2.0f, outline_color);
+        add_vertex(start_angle, radius, outline_color);
+        add_vertex(end_angle, radius + 2.0f, outline_color);
+        add_vertex(end_angle, radius, outline_color);
+    }
+}
+
+
+/**
+ * @brief Draws an in-world health wheel.
+ */
+void InWorldHealthWheel::draw() {
+    vector<ALLEGRO_VERTEX> vertexes;
+    add_vertexes(vertexes);
+    al_draw_prim(
+        vertexes.data(), nullptr, nullptr,
+        0, (int) vertexes.size(), ALLEGRO_PRIM_TRIANGLE_LIST
     );
 }
 
@@ -359,3 +431,82 @@ void InWorldHudItem::tick(float delta_t) {
     }
     }
 }
+
+
+/**
+ * @brief Destroys the in-world HUD item pool object.
+ */
+InWorldHudItemPool::~InWorldHudItemPool() {
+    clear();
+}
+
+
+/**
+ * @brief Returns a fraction for a mob to use, reusing an old one
+ * if possible.
+ *
+ * @param m Mob it belongs to.
+ * @return The fraction.
+ */
+InWorldFraction* InWorldHudItemPool::acquire_fraction(Mob* m) {
+    if(free_fractions.empty()) return new InWorldFraction(m);
+    
+    InWorldFraction* f_ptr = free_fractions.back();
+    free_fractions.pop_back();
+    *f_ptr = InWorldFraction(m);
+    return f_ptr;
+}
+
+
+/**
+ * @brief Returns a health wheel for a mob to use, reusing an old one
+ * if possible.
+ *
+ * @param m Mob it belongs to.
+ * @return The health wheel.
+ */
+InWorldHealthWheel* InWorldHudItemPool::acquire_health_wheel(Mob* m) {
+    if(free_health_wheels.empty()) return new InWorldHealthWheel(m);
+    
+    InWorldHealthWheel* w_ptr = free_health_wheels.back();
+    free_health_wheels.pop_back();
+    *w_ptr = InWorldHealthWheel(m);
+    return w_ptr;
+}
+
+
+/**
+ * @brief Deletes all items that aren't in use.
+ */
+void InWorldHudItemPool::clear() {
+    for(size_t f = 0; f < free_fractions.size(); f++) {
+        delete free_fractions[f];
+    }
+    free_fractions.clear();
+    for(size_t w = 0; w < free_health_wheels.size(); w++) {
+        delete free_health_wheels[w];
+    }
+    free_health_wheels.clear();
+}
+
+
+/**
+ * @brief Returns a fraction that's no longer in use to the pool.
+ *
+ * @param f_ptr The fraction.
+ */
+void InWorldHudItemPool::release_fraction(InWorldFraction* f_ptr) {
+    f_ptr->m = nullptr;
+    free_fractions.push_back(f_ptr);
+}
+
+
+/**
+ * @brief Returns a health wheel that's no longer in use to the pool.
+ *
+ * @param w_ptr The health wheel.
+ */
+void InWorldHudItemPool::release_health_wheel(InWorldHealthWheel* w_ptr) {
+    w_ptr->m = nullptr;
+    free_health_wheels.push_back(w_ptr);
+}
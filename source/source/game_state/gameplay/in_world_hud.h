@@ -11,12 +11,18 @@
 
 #pragma once
 
+#include <vector>
+
 #include <allegro5/allegro.h>
+#include <allegro5/allegro_primitives.h>
 
 #include "../../core/const.h"
 #include "../../util/drawing_utils.h"
 
 
+using std::vector;
+
+
 namespace IN_WORLD_FRACTION {
 extern const float GROW_JUICE_DURATION;
 extern const float GROW_JUICE_AMOUNT;
@@ -30,6 +36,7 @@ extern const float TRANSITION_OUT_DURATION;
 
 
 namespace IN_WORLD_HEALTH_WHEEL {
+extern const unsigned char NR_SEGMENTS;
 extern const float OPACITY;
 extern const float PADDING;
 extern const float SMOOTHNESS_MULT;
@@ -147,8 +154,41 @@ public:
     //--- Function declarations ---
     
     explicit InWorldHealthWheel(Mob* m);
+    void add_vertexes(vector<ALLEGRO_VERTEX> &vertexes);
     void draw() override;
     void start_fading() override;
     void tick(float delta_t) override;
     
 };
+
+
+/**
+ * @brief Keeps in-world HUD items that are no longer in use, so that
+ * when a mob needs a new one, an old one can be reused instead of
+ * allocating a new one. Mobs gain and lose these all the time, like when
+ * Pikmin start and stop carrying something.
+ */
+class InWorldHudItemPool {
+
+public:
+
+    //--- Function declarations ---
+    
+    ~InWorldHudItemPool();
+    InWorldFraction* acquire_fraction(Mob* m);
+    InWorldHealthWheel* acquire_health_wheel(Mob* m);
+    void clear();
+    void release_fraction(InWorldFraction* f_ptr);
+    void release_health_wheel(InWorldHealthWheel* w_ptr);
+    
+private:
+
+    //--- Members ---
+    
+    //Fractions that aren't in use.
+    vector<InWorldFraction*> free_fractions;
+    
+    //Health wheels that aren't in use.
+    vector<InWorldHealthWheel*> free_health_wheels;
+    
+};
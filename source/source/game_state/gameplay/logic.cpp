@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "gameplay.h"
@@ -24,6 +25,287 @@
 #include "../../util/string_utils.h"
 
 
+/**
+ * @brief Changes how many Pikmin and leaders are keeping each area cell
+ * in a range active.
+ *
+ * @param range First and last column, then first and last row, all inclusive.
+ * @param amount Amount to add. Use a negative number to subtract.
+ */
+void GameplayState::change_area_cell_refs(const int range[4], int amount) {
+    for(int x = range[0]; x <= range[1]; x++) {
+        for(int y = range[2]; y <= range[3]; y++) {
+            area_active_cell_refs[x * nr_area_cell_rows + y] += amount;
+        }
+    }
+}
+
+
+/**
+ * @brief Makes a mob stop keeping any area cells active.
+ *
+ * @param m_ptr The mob.
+ */
+void GameplayState::clear_mob_active_cells(Mob* m_ptr) {
+    change_area_cell_refs(m_ptr->active_cells, -1);
+    m_ptr->active_cells[0] = 0;
+    m_ptr->active_cells[1] = -1;
+    m_ptr->active_cells[2] = 0;
+    m_ptr->active_cells[3] = -1;
+}
+
+
+/**
+ * @brief Detects the interactions a mob can have with other mobs,
+ * without acting on them. This finds the mobs close enough to
+ * interact with, and the reach and miscellaneous events that the mob
+ * should receive. It only reads from the world, so several mobs can
+ * go through this at the same time from different threads.
+ *
+ * @param m_ptr Mob to process.
+ * @param m Index of the mob.
+ * @param info The results are returned here.
+ * @param positions_buffer Scratch space for the nearby mobs' positions.
+ * @param dists_squared_buffer Scratch space for the squared distances
+ * to the nearby mobs.
+ * @param candidates_buffer Scratch space for the mobs found in the
+ * task indexes.
+ */
+void GameplayState::detect_mob_interactions(
+    Mob* m_ptr, size_t m, MobInteractionInfo &info,
+    vector<Point> &positions_buffer, vector<float> &dists_squared_buffer,
+    vector<Mob*> &candidates_buffer
+) {
+    info.state = m_ptr->fsm.cur_state;
+    info.nearby_idxs.clear();
+    info.pending_events.clear();
+    if(m_ptr->is_stored_inside_mob()) return;
+    
+    //Only mobs in nearby cells can possibly be interacted with.
+    float search_span = m_ptr->interaction_span + m_ptr->radius;
+    mob_grid.get_mobs_in_region(
+        m_ptr->pos - search_span, m_ptr->pos + search_span,
+        info.nearby_idxs
+    );
+    
+    //Get the distance to all of their centers in one go. This only reads
+    //the grid's packed hot data, so that far away mobs can be skipped
+    //without having to touch the mobs themselves.
+    positions_buffer.resize(info.nearby_idxs.size());
+    for(size_t r = 0; r < info.nearby_idxs.size(); r++) {
+        positions_buffer[r] = mob_grid.get_hot_data(info.nearby_idxs[r]).pos;
+    }
+    get_distances_squared(m_ptr->pos, positions_buffer, dists_squared_buffer);
+    
+    size_t n_nearby = 0;
+    for(size_t r = 0; r < info.nearby_idxs.size(); r++) {
+        size_t m2 = info.nearby_idxs[r];
+        if(m == m2) continue;
+        
+        //The distance between the mobs can't be smaller than the distance
+        //between their centers minus this mob's radius and the other's span,
+        //so check that first, since it doesn't need a square root.
+        float max_center_dist =
+            search_span + mob_grid.get_hot_data(m2).physical_span * 2.0f;
+        if(dists_squared_buffer[r] > max_center_dist * max_center_dist) {
+            continue;
+        }
+        
+        Mob* m2_ptr = mobs.all[m2];
+        if(!m2_ptr->accepts_interactions && m_ptr->time_alive > 0.1f) {
+            continue;
+        }
+        if(m2_ptr->to_delete) continue;
+        if(m2_ptr->is_stored_inside_mob()) continue;
+        
+        Distance d(m_ptr->pos, m2_ptr->pos);
+        Distance d_between = m_ptr->get_distance_between(m2_ptr, &d);
+        
+        if(d_between > m_ptr->interaction_span + m2_ptr->physical_span) {
+            //The other mob is so far away that there is
+            //no interaction possible.
+            continue;
+        }
+        
+        //The list is being compacted in place, and this never overtakes
+        //the entry being checked.
+        info.nearby_idxs[n_nearby] = m2;
+        n_nearby++;
+        
+        if(
+            m2_ptr->health != 0 && m_ptr->near_reach != INVALID &&
+            !m2_ptr->has_invisibility_status
+        ) {
+            process_mob_reaches(
+                m_ptr, m2_ptr, m, m2, d_between, info.pending_events
+            );
+        }
+        
+        process_mob_misc_interactions(
+            m_ptr, m2_ptr, m, m2, d, d_between, info.pending_events
+        );
+    }
+    info.nearby_idxs.resize(n_nearby);
+    
+    detect_mob_task_interactions(
+        m_ptr, info.pending_events, candidates_buffer
+    );
+    
+    //Sort the pending inter-mob events from closest to farthest.
+    sort(
+        info.pending_events.begin(), info.pending_events.end(),
+    [m_ptr] (PendingIntermobEvent e1, PendingIntermobEvent e2) -> bool {
+        return
+        (
+            e1.d.to_float() -
+            (m_ptr->radius + e1.mob_ptr->radius)
+        ) < (
+            e2.d.to_float() -
+            (m_ptr->radius + e2.mob_ptr->radius)
+        );
+    }
+    );
+}
+
+
+/**
+ * @brief Detects the interactions a mob can have with the kinds of mobs
+ * that have a task index: opponents in reach, and carriable objects, tools
+ * and group tasks nearby. Instead of going through every nearby mob,
+ * only the mobs of the right kind that are close enough get checked.
+ * Like detect_mob_interactions, this only reads from the world.
+ *
+ * @param m_ptr Mob to process.
+ * @param pending_events The events found are added here.
+ * @param candidates_buffer Scratch space for the mobs found in the indexes.
+ */
+void GameplayState::detect_mob_task_interactions(
+    Mob* m_ptr, vector<PendingIntermobEvent> &pending_events,
+    vector<Mob*> &candidates_buffer
+) {
+    MobEvent* opir_ev =
+        m_ptr->fsm.get_event(MOB_EV_OPPONENT_IN_REACH);
+    MobEvent* nco_ev =
+        m_ptr->fsm.get_event(MOB_EV_NEAR_CARRIABLE_OBJECT);
+    MobEvent* nto_ev =
+        m_ptr->fsm.get_event(MOB_EV_NEAR_TOOL);
+    MobEvent* ngto_ev =
+        m_ptr->fsm.get_event(MOB_EV_NEAR_GROUP_TASK);
+    
+    //Fills the candidates with the mobs from an index whose edges could
+    //be within the given distance of the mob's edges.
+    const auto get_candidates =
+    [this, m_ptr, &candidates_buffer] (MOB_TASK_INDEX idx, float dist) {
+        const MobPointIndex &index = task_indexes[idx];
+        index.get_nearest(
+            m_ptr->pos,
+            dist + m_ptr->physical_span + index.get_max_physical_span(),
+            INVALID, candidates_buffer
+        );
+    };
+    
+    //Returns whether a candidate can be interacted with at all, and
+    //if so, returns the distance between it and the mob.
+    const auto check_candidate =
+    [m_ptr] (Mob * m2_ptr, Distance * out_d_between) {
+        if(m2_ptr == m_ptr) return false;
+        if(!m2_ptr->accepts_interactions && m_ptr->time_alive > 0.1f) {
+            return false;
+        }
+        if(m2_ptr->to_delete) return false;
+        if(m2_ptr->is_stored_inside_mob()) return false;
+        Distance d(m_ptr->pos, m2_ptr->pos);
+        *out_d_between = m_ptr->get_distance_between(m2_ptr, &d);
+        return
+            *out_d_between <=
+            m_ptr->interaction_span + m2_ptr->physical_span;
+    };
+    
+    //Find opponents in reach.
+    if(opir_ev && m_ptr->near_reach != INVALID) {
+        MobType::Reach* r_ptr = &m_ptr->type->reaches[m_ptr->near_reach];
+        get_candidates(
+            MOB_TASK_INDEX_ATTACKABLES,
+            std::max(r_ptr->radius_1, r_ptr->radius_2)
+        );
+        for(size_t c = 0; c < candidates_buffer.size(); c++) {
+            Mob* m2_ptr = candidates_buffer[c];
+            Distance d_between;
+            if(!check_candidate(m2_ptr, &d_between)) continue;
+            if(m2_ptr->health == 0 || m2_ptr->has_invisibility_status) {
+                continue;
+            }
+            if(!m_ptr->can_hunt(m2_ptr)) continue;
+            float angle_diff =
+                get_angle_smallest_dif(
+                    m_ptr->angle,
+                    get_angle(m_ptr->pos, m2_ptr->pos)
+                );
+            if(is_mob_in_reach(r_ptr, d_between, angle_diff)) {
+                pending_events.push_back(
+                    PendingIntermobEvent(d_between, opir_ev, m2_ptr)
+                );
+            }
+        }
+    }
+    
+    if(!nco_ev && !nto_ev && !ngto_ev) return;
+    float range = task_range(m_ptr);
+    
+    //Find a carriable mob to grab.
+    if(nco_ev) {
+        get_candidates(MOB_TASK_INDEX_CARRIABLES, range);
+        for(size_t c = 0; c < candidates_buffer.size(); c++) {
+            Mob* m2_ptr = candidates_buffer[c];
+            Distance d_between;
+            if(!check_candidate(m2_ptr, &d_between)) continue;
+            if(!m2_ptr->carry_info || m2_ptr->carry_info->is_full()) continue;
+            if(d_between > range) continue;
+            pending_events.push_back(
+                PendingIntermobEvent(d_between, nco_ev, m2_ptr)
+            );
+        }
+    }
+    
+    //Find a tool mob.
+    if(nto_ev) {
+        get_candidates(MOB_TASK_INDEX_TOOLS, range);
+        for(size_t c = 0; c < candidates_buffer.size(); c++) {
+            Tool* too_ptr = (Tool*) candidates_buffer[c];
+            Distance d_between;
+            if(!check_candidate(too_ptr, &d_between)) continue;
+            if(d_between > range) continue;
+            if(too_ptr->reserved && too_ptr->reserved != m_ptr) {
+                //Another Pikmin is already going for it. Ignore it.
+                continue;
+            }
+            pending_events.push_back(
+                PendingIntermobEvent(d_between, nto_ev, too_ptr)
+            );
+        }
+    }
+    
+    //Find a group task mob.
+    if(ngto_ev) {
+        get_candidates(MOB_TASK_INDEX_GROUP_TASKS, range);
+        for(size_t c = 0; c < candidates_buffer.size(); c++) {
+            GroupTask* tas_ptr = (GroupTask*) candidates_buffer[c];
+            Distance d_between;
+            if(!check_candidate(tas_ptr, &d_between)) continue;
+            if(tas_ptr->health <= 0) continue;
+            if(d_between > range) continue;
+            if(!tas_ptr->get_free_spot()) {
+                //There are no free spots here. Ignore it.
+                continue;
+            }
+            pending_events.push_back(
+                PendingIntermobEvent(d_between, ngto_ev, tas_ptr)
+            );
+        }
+    }
+}
+
+
 /**
  * @brief Ticks the logic of aesthetic things regarding the leader.
  * If the game is paused, these can be frozen in place without
@@ -40,22 +322,19 @@ void GameplayState::do_aesthetic_leader_logic(float delta_t) {
     }
     
     Distance leader_to_cursor_dist(cur_leader_ptr->pos, leader_cursor_w);
-    for(size_t a = 0; a < cur_leader_ptr->swarm_arrows.size(); ) {
-        cur_leader_ptr->swarm_arrows[a] +=
-            GAMEPLAY::SWARM_ARROW_SPEED * delta_t;
-            
-        Distance max_dist =
-            (swarm_magnitude > 0) ?
-            Distance(game.config.rules.cursor_max_dist * swarm_magnitude) :
-            leader_to_cursor_dist;
-            
-        if(max_dist < cur_leader_ptr->swarm_arrows[a]) {
-            cur_leader_ptr->swarm_arrows.erase(
-                cur_leader_ptr->swarm_arrows.begin() + a
-            );
-        } else {
-            a++;
-        }
+    RingBuffer<float> &swarm_arrows = cur_leader_ptr->swarm_arrows;
+    for(size_t a = 0; a < swarm_arrows.size(); a++) {
+        swarm_arrows[a] += GAMEPLAY::SWARM_ARROW_SPEED * delta_t;
+    }
+    
+    //The arrows all move at the same speed, so the oldest ones are always
+    //the farthest, and are the ones to go first.
+    Distance max_dist =
+        (swarm_magnitude > 0) ?
+        Distance(game.config.rules.cursor_max_dist * swarm_magnitude) :
+        leader_to_cursor_dist;
+    while(!swarm_arrows.empty() && max_dist < swarm_arrows[0]) {
+        swarm_arrows.pop_front();
     }
     
     //Whistle.
@@ -159,7 +438,9 @@ void GameplayState::do_gameplay_leader_logic(float delta_t) {
     if(!cur_leader_ptr) return;
     
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Logic -- Current leader");
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_LOGIC_CURRENT_LEADER
+        );
     }
     
     if(cur_leader_ptr->to_delete) {
@@ -661,7 +942,9 @@ void GameplayState::do_gameplay_logic(float delta_t) {
         
         //Tick all particles.
         if(game.perf_mon) {
-            game.perf_mon->start_measurement("Logic -- Particles");
+            game.perf_mon->start_measurement(
+                PERF_MON_MEASUREMENT_LOGIC_PARTICLES
+            );
         }
         
         particles.tick_all(delta_t);
@@ -681,11 +964,14 @@ void GameplayState::do_gameplay_logic(float delta_t) {
         *             +--+ *
         ********************/
         if(game.perf_mon) {
-            game.perf_mon->start_measurement("Logic -- Sector animation");
+            game.perf_mon->start_measurement(
+                PERF_MON_MEASUREMENT_LOGIC_SECTOR_ANIMATION
+            );
         }
         
-        for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
-            Sector* s_ptr = game.cur_area_data->sectors[s];
+        unordered_set<Sector*> hazard_changed_sectors;
+        for(size_t s = 0; s < ticking_sectors.size();) {
+            Sector* s_ptr = ticking_sectors[s];
             
             if(s_ptr->draining_liquid) {
             
@@ -696,11 +982,12 @@ void GameplayState::do_gameplay_logic(float delta_t) {
                     for(size_t h = 0; h < s_ptr->hazards.size();) {
                         if(s_ptr->hazards[h]->associated_liquid) {
                             s_ptr->hazards.erase(s_ptr->hazards.begin() + h);
-                            path_mgr.handle_sector_hazard_change(s_ptr);
+                            hazard_changed_sectors.insert(s_ptr);
                         } else {
                             h++;
                         }
                     }
+                    s_ptr->update_path_blocking_hazards();
                     
                     s_ptr->liquid_drain_left = 0;
                     s_ptr->draining_liquid = false;
@@ -720,11 +1007,23 @@ void GameplayState::do_gameplay_logic(float delta_t) {
                 }
             }
             
-            if(s_ptr->scroll.x != 0 || s_ptr->scroll.y != 0) {
+            bool is_scrolling = s_ptr->scroll.x != 0 || s_ptr->scroll.y != 0;
+            if(is_scrolling) {
                 s_ptr->texture_info.translation += s_ptr->scroll * delta_t;
             }
+            
+            if(!s_ptr->draining_liquid && !is_scrolling) {
+                //Nothing left to do here.
+                ticking_sectors.erase(ticking_sectors.begin() + s);
+            } else {
+                s++;
+            }
         }
         
+        //All sectors that drained this frame are handled in one go,
+        //so the paths only get invalidated once.
+        path_mgr.handle_sector_hazard_changes(hazard_changed_sectors);
+        
         if(game.perf_mon) {
             game.perf_mon->finish_measurement();
         }
@@ -756,38 +1055,123 @@ void GameplayState::do_gameplay_logic(float delta_t) {
                 cur_leader_ptr->chase_info.state == CHASE_STATE_CHASING;
         }
         
+        //Let some of the mobs whose paths changed re-calculate them.
+        path_mgr.process_pending_path_changes();
+        
         update_area_active_cells();
         update_mob_is_active_flag();
+        update_mob_tick_order();
+        mob_grid.rebuild(mobs.all);
+        
+        //Advance all awake mobs' animations in one go, split across
+        //the job pool. The events that this causes are only handled
+        //in each mob's tick, in order, so the result doesn't depend on
+        //how the work was split.
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement(
+                PERF_MON_MEASUREMENT_OBJECTS_ANIMATION_ADVANCE
+            );
+        }
+        game.jobs.parallel_for(
+            awake_mob_idxs.size(), MOB::MIN_ANIM_TICK_JOB_SIZE,
+        [this, delta_t] (size_t start, size_t end) {
+            for(size_t a = start; a < end; a++) {
+                mobs.all[awake_mob_idxs[a]]->advance_animation(delta_t);
+            }
+        }
+        );
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
         
         size_t n_mobs = mobs.all.size();
-        for(size_t m = 0; m < n_mobs; m++) {
+        for(size_t o = 0; o < mob_tick_order.size(); o++) {
             //Tick the mob.
+            size_t m = mob_tick_order[o];
             Mob* m_ptr = mobs.all[m];
-            if(
-                !has_flag(
-                    m_ptr->type->inactive_logic,
-                    INACTIVE_LOGIC_FLAG_TICKS
-                ) && !m_ptr->is_active &&
-                m_ptr->time_alive > 0.1f
-            ) {
-                continue;
-            }
-            
             m_ptr->tick(delta_t);
-            if(!m_ptr->is_stored_inside_mob()) {
-                process_mob_interactions(m_ptr, m);
+            mob_grid.update_mob(m, m_ptr);
+        }
+        
+        //Mobs created during the ticks need to be on the grid too.
+        add_new_mobs_to_grid();
+        
+        //Catch the mobs in the whistle's range.
+        if(cur_leader_ptr && whistle.whistling) {
+            process_whistle();
+        }
+        
+        update_task_indexes();
+        
+        //Detect the interactions of all awake mobs in one go, split across
+        //the job pool. This only reads from the world, and each job writes
+        //to its own mobs' info, so the result doesn't depend on how the work
+        //was split.
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement(
+                PERF_MON_MEASUREMENT_OBJECTS_INTERACTION_DETECTION
+            );
+        }
+        mob_interaction_infos.resize(awake_mob_idxs.size());
+        game.jobs.parallel_for(
+            awake_mob_idxs.size(), GAMEPLAY::MIN_INTERACTION_JOB_SIZE,
+        [this] (size_t start, size_t end) {
+            vector<Point> positions_buffer;
+            vector<float> dists_squared_buffer;
+            vector<Mob*> candidates_buffer;
+            for(size_t a = start; a < end; a++) {
+                size_t m = awake_mob_idxs[a];
+                detect_mob_interactions(
+                    mobs.all[m], m, mob_interaction_infos[a],
+                    positions_buffer, dists_squared_buffer, candidates_buffer
+                );
             }
         }
+        );
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
         
-        for(size_t m = 0; m < n_mobs;) {
-            //Mob deletion.
+        //Pushes go first, handled once per pair of mobs.
+        if(game.perf_mon) {
+            game.perf_mon->start_measurement(
+                PERF_MON_MEASUREMENT_OBJECTS_PUSHES
+            );
+        }
+        process_mob_pushes();
+        if(game.perf_mon) {
+            game.perf_mon->finish_measurement();
+        }
+        
+        //Now act on them, one mob at a time, in order.
+        for(size_t a = 0; a < awake_mob_idxs.size(); a++) {
+            size_t m = awake_mob_idxs[a];
             Mob* m_ptr = mobs.all[m];
-            if(m_ptr->to_delete) {
-                delete_mob(m_ptr);
-                n_mobs--;
-                continue;
+            if(m_ptr->is_stored_inside_mob()) continue;
+            if(game.perf_mon) {
+                game.perf_mon->start_measurement(
+                    PERF_MON_MEASUREMENT_OBJECTS_INTERACTIONS,
+                    m_ptr->id, &m_ptr->type->name
+                );
+            }
+            process_mob_interactions(m_ptr, m, mob_interaction_infos[a]);
+            if(game.perf_mon) {
+                game.perf_mon->finish_measurement();
+            }
+        }
+        
+        //Mob deletion. All of this frame's deletions are done in one batch.
+        mobs_to_delete.clear();
+        for(size_t m = 0; m < n_mobs; m++) {
+            if(mobs.all[m]->to_delete) {
+                mobs_to_delete.push_back(mobs.all[m]);
             }
-            m++;
+        }
+        if(!mobs_to_delete.empty()) {
+            delete_mobs(mobs_to_delete);
+            //The mob grid refers to mobs by index, and those changed.
+            mob_grid.rebuild(mobs.all);
+            update_task_indexes();
         }
         
         do_gameplay_leader_logic(delta_t);
@@ -820,46 +1204,12 @@ void GameplayState::do_gameplay_logic(float delta_t) {
         leaders_kod = starting_nr_of_leaders - nr_living_leaders;
         
         
-        /**************************
-        *                    /  / *
-        *   Precipitation     / / *
-        *                   /  /  *
-        **************************/
-        
-        /*
-        if(
-            cur_area_data.weather_condition.precipitation_type !=
-            PRECIPITATION_TYPE_NONE
-        ) {
-            precipitation_timer.tick(delta_t);
-            if(precipitation_timer.ticked) {
-                precipitation_timer = timer(
-                    cur_area_data.weather_condition.
-                    precipitation_frequency.get_random_number()
-                );
-                precipitation_timer.start();
-                precipitation.push_back(point(0.0f));
-            }
-        
-            for(size_t p = 0; p < precipitation.size();) {
-                precipitation[p].y +=
-                    cur_area_data.weather_condition.
-                    precipitation_speed.get_random_number() * delta_t;
-                if(precipitation[p].y > scr_h) {
-                    precipitation.erase(precipitation.begin() + p);
-                } else {
-                    p++;
-                }
-            }
-        }
-        */
-        
-        
         /******************
         *             ___ *
         *   Mission   \ / *
         *              O  *
         *******************/
+        size_t old_leaders_in_mission_exit = cur_leaders_in_mission_exit;
         if(
             game.cur_area_data->type == AREA_TYPE_MISSION &&
             game.cur_area_data->mission.goal == MISSION_GOAL_GET_TO_EXIT
@@ -892,52 +1242,86 @@ void GameplayState::do_gameplay_logic(float delta_t) {
             }
         }
         
-        float real_goal_ratio = 0.0f;
-        int goal_cur_amount =
-            game.mission_goals[game.cur_area_data->mission.goal]->get_cur_amount(
-                this
-            );
-        int goal_req_amount =
-            game.mission_goals[game.cur_area_data->mission.goal]->get_req_amount(
-                this
+        //Counters that don't come from events.
+        int gameplay_seconds = (int) gameplay_time_passed;
+        if(gameplay_seconds != old_gameplay_seconds) {
+            enable_flag(changed_mission_counters, MISSION_COUNTER_TIME);
+            old_gameplay_seconds = gameplay_seconds;
+        }
+        if(nr_living_leaders != old_nr_living_leaders) {
+            enable_flag(changed_mission_counters, MISSION_COUNTER_LEADERS);
+        }
+        if(cur_leaders_in_mission_exit != old_leaders_in_mission_exit) {
+            enable_flag(
+                changed_mission_counters, MISSION_COUNTER_LEADERS_IN_EXIT
             );
-        if(goal_req_amount != 0.0f) {
-            real_goal_ratio = goal_cur_amount / (float) goal_req_amount;
+        }
+        if(mobs.pikmin_list.size() != old_nr_pikmin_mobs) {
+            enable_flag(changed_mission_counters, MISSION_COUNTER_TOTAL_PIKMIN);
+            old_nr_pikmin_mobs = mobs.pikmin_list.size();
+        }
+        
+        //Only ask the goal and fail conditions for their amounts if
+        //something they depend on changed.
+        if(has_flag(changed_mission_counters, mission_goal_dependencies)) {
+            MissionGoal* goal =
+                game.mission_goals[game.cur_area_data->mission.goal];
+            mission_goal_cur_amount = goal->get_cur_amount(this);
+            mission_goal_req_amount = goal->get_req_amount(this);
+        }
+        size_t fail_1_cond = game.cur_area_data->mission.fail_hud_primary_cond;
+        if(
+            fail_1_cond != INVALID &&
+            has_flag(
+                changed_mission_counters,
+                game.mission_fail_conds[fail_1_cond]->get_dependencies()
+            )
+        ) {
+            MissionFail* fail = game.mission_fail_conds[fail_1_cond];
+            mission_fail_1_cur_amount = fail->get_cur_amount(this);
+            mission_fail_1_req_amount = fail->get_req_amount(this);
+        }
+        size_t fail_2_cond =
+            game.cur_area_data->mission.fail_hud_secondary_cond;
+        if(
+            fail_2_cond != INVALID &&
+            has_flag(
+                changed_mission_counters,
+                game.mission_fail_conds[fail_2_cond]->get_dependencies()
+            )
+        ) {
+            MissionFail* fail = game.mission_fail_conds[fail_2_cond];
+            mission_fail_2_cur_amount = fail->get_cur_amount(this);
+            mission_fail_2_req_amount = fail->get_req_amount(this);
+        }
+        
+        float real_goal_ratio = 0.0f;
+        if(mission_goal_req_amount != 0) {
+            real_goal_ratio =
+                mission_goal_cur_amount / (float) mission_goal_req_amount;
         }
         goal_indicator_ratio +=
             (real_goal_ratio - goal_indicator_ratio) *
             (HUD::GOAL_INDICATOR_SMOOTHNESS_MULT * delta_t);
             
-        if(game.cur_area_data->mission.fail_hud_primary_cond != INVALID) {
+        if(fail_1_cond != INVALID) {
             float real_fail_ratio = 0.0f;
-            int fail_cur_amount =
-                game.mission_fail_conds[
-                    game.cur_area_data->mission.fail_hud_primary_cond
-                ]->get_cur_amount(this);
-            int fail_req_amount =
-                game.mission_fail_conds[
-                    game.cur_area_data->mission.fail_hud_primary_cond
-                ]->get_req_amount(this);
-            if(fail_req_amount != 0.0f) {
-                real_fail_ratio = fail_cur_amount / (float) fail_req_amount;
+            if(mission_fail_1_req_amount != 0) {
+                real_fail_ratio =
+                    mission_fail_1_cur_amount /
+                    (float) mission_fail_1_req_amount;
             }
             fail_1_indicator_ratio +=
                 (real_fail_ratio - fail_1_indicator_ratio) *
                 (HUD::GOAL_INDICATOR_SMOOTHNESS_MULT * delta_t);
         }
         
-        if(game.cur_area_data->mission.fail_hud_secondary_cond != INVALID) {
+        if(fail_2_cond != INVALID) {
             float real_fail_ratio = 0.0f;
-            int fail_cur_amount =
-                game.mission_fail_conds[
-                    game.cur_area_data->mission.fail_hud_secondary_cond
-                ]->get_cur_amount(this);
-            int fail_req_amount =
-                game.mission_fail_conds[
-                    game.cur_area_data->mission.fail_hud_secondary_cond
-                ]->get_req_amount(this);
-            if(fail_req_amount != 0.0f) {
-                real_fail_ratio = fail_cur_amount / (float) fail_req_amount;
+            if(mission_fail_2_req_amount != 0) {
+                real_fail_ratio =
+                    mission_fail_2_cur_amount /
+                    (float) mission_fail_2_req_amount;
             }
             fail_2_indicator_ratio +=
                 (real_fail_ratio - fail_2_indicator_ratio) *
@@ -946,9 +1330,19 @@ void GameplayState::do_gameplay_logic(float delta_t) {
         
         if(game.cur_area_data->type == AREA_TYPE_MISSION) {
             if(cur_interlude == INTERLUDE_NONE) {
-                if(is_mission_clear_met()) {
+                if(
+                    has_flag(
+                        changed_mission_counters, mission_goal_dependencies
+                    ) &&
+                    is_mission_clear_met()
+                ) {
                     end_mission(true);
-                } else if(is_mission_fail_met(&mission_fail_reason)) {
+                } else if(
+                    has_flag(
+                        changed_mission_counters, mission_fail_dependencies
+                    ) &&
+                    is_mission_fail_met(&mission_fail_reason)
+                ) {
                     end_mission(false);
                 }
             }
@@ -961,21 +1355,25 @@ void GameplayState::do_gameplay_logic(float delta_t) {
             last_pikmin_death_pos = Point(LARGE_FLOAT);
             last_ship_that_got_treasure_pos = Point(LARGE_FLOAT);
             
-            mission_score = game.cur_area_data->mission.starting_points;
-            for(size_t c = 0; c < game.mission_score_criteria.size(); c++) {
-                if(
-                    !has_flag(
-                        game.cur_area_data->mission.point_hud_data,
-                        get_idx_bitmask(c)
-                    )
+            if(has_flag(changed_mission_counters, mission_score_dependencies)) {
+                mission_score = game.cur_area_data->mission.starting_points;
+                for(
+                    size_t c = 0; c < game.mission_score_criteria.size(); c++
                 ) {
-                    continue;
+                    if(
+                        !has_flag(
+                            game.cur_area_data->mission.point_hud_data,
+                            get_idx_bitmask(c)
+                        )
+                    ) {
+                        continue;
+                    }
+                    MissionScoreCriterion* c_ptr =
+                        game.mission_score_criteria[c];
+                    int c_score =
+                        c_ptr->get_score(this, &game.cur_area_data->mission);
+                    mission_score += c_score;
                 }
-                MissionScoreCriterion* c_ptr =
-                    game.mission_score_criteria[c];
-                int c_score =
-                    c_ptr->get_score(this, &game.cur_area_data->mission);
-                mission_score += c_score;
             }
             if(mission_score != old_mission_score) {
                 mission_score_cur_text->start_juice_animation(
@@ -988,53 +1386,43 @@ void GameplayState::do_gameplay_logic(float delta_t) {
                 (mission_score - score_indicator) *
                 (HUD::SCORE_INDICATOR_SMOOTHNESS_MULT * delta_t);
                 
-            int goal_cur =
-                game.mission_goals[game.cur_area_data->mission.goal]->
-                get_cur_amount(game.states.gameplay);
-            if(goal_cur != old_mission_goal_cur) {
+            if(mission_goal_cur_amount != old_mission_goal_cur) {
                 mission_goal_cur_text->start_juice_animation(
                     GuiItem::JUICE_TYPE_GROW_TEXT_HIGH
                 );
-                old_mission_goal_cur = goal_cur;
+                old_mission_goal_cur = mission_goal_cur_amount;
             }
             
             if(
-                game.cur_area_data->mission.fail_hud_primary_cond !=
-                INVALID
+                fail_1_cond != INVALID &&
+                mission_fail_1_cur_amount != old_mission_fail_1_cur
             ) {
-                size_t cond =
-                    game.cur_area_data->mission.fail_hud_primary_cond;
-                int fail_1_cur =
-                    game.mission_fail_conds[cond]->get_cur_amount(
-                        game.states.gameplay
-                    );
-                if(fail_1_cur != old_mission_fail_1_cur) {
-                    mission_fail_1_cur_text->start_juice_animation(
-                        GuiItem::JUICE_TYPE_GROW_TEXT_HIGH
-                    );
-                    old_mission_fail_1_cur = fail_1_cur;
-                }
+                mission_fail_1_cur_text->start_juice_animation(
+                    GuiItem::JUICE_TYPE_GROW_TEXT_HIGH
+                );
+                old_mission_fail_1_cur = mission_fail_1_cur_amount;
             }
             if(
-                game.cur_area_data->mission.fail_hud_secondary_cond !=
-                INVALID
+                fail_2_cond != INVALID &&
+                mission_fail_2_cur_amount != old_mission_fail_2_cur
             ) {
-                size_t cond =
-                    game.cur_area_data->mission.fail_hud_secondary_cond;
-                int fail_2_cur =
-                    game.mission_fail_conds[cond]->get_cur_amount(
-                        game.states.gameplay
-                    );
-                if(fail_2_cur != old_mission_fail_2_cur) {
-                    mission_fail_2_cur_text->start_juice_animation(
-                        GuiItem::JUICE_TYPE_GROW_TEXT_HIGH
-                    );
-                    old_mission_fail_2_cur = fail_2_cur;
-                }
+                mission_fail_2_cur_text->start_juice_animation(
+                    GuiItem::JUICE_TYPE_GROW_TEXT_HIGH
+                );
+                old_mission_fail_2_cur = mission_fail_2_cur_amount;
             }
             
         }
         
+        //Events that happen during an interlude still need to be checked
+        //once it's over, so they're only forgotten once they were.
+        if(
+            game.cur_area_data->type != AREA_TYPE_MISSION ||
+            cur_interlude == INTERLUDE_NONE
+        ) {
+            changed_mission_counters = 0;
+        }
+        
     } else { //Displaying a gameplay message.
     
         msg_box->tick(delta_t);
@@ -1258,13 +1646,18 @@ void GameplayState::do_menu_logic() {
         string timer_str =
             f2s(game.maker_tools.info_lock->script_timer.time_left);
         string vars_str;
-        if(!game.maker_tools.info_lock->vars.empty()) {
-            for(
-                auto v = game.maker_tools.info_lock->vars.begin();
-                v != game.maker_tools.info_lock->vars.end(); ++v
-            ) {
-                vars_str += v->first + "=" + v->second + "; ";
-            }
+        Mob* lock_ptr = game.maker_tools.info_lock;
+        for(size_t v = 0; v < lock_ptr->vars.size(); v++) {
+            if(!lock_ptr->vars[v].was_set) continue;
+            vars_str +=
+                lock_ptr->type->script_vars.names[v] + "=" +
+                lock_ptr->vars[v].get_text() + "; ";
+        }
+        for(const auto &v : lock_ptr->extra_vars) {
+            if(!v.second.was_set) continue;
+            vars_str += v.first + "=" + v.second.get_text() + "; ";
+        }
+        if(!vars_str.empty()) {
             vars_str.erase(vars_str.size() - 2, 2);
         } else {
             vars_str = "(None)";
@@ -1467,18 +1860,74 @@ void GameplayState::do_menu_logic() {
 
 
 /**
- * @brief Checks if the player is close to any living enemy and also if
- * they are close to any living boss.
+ * @brief Returns the range of area cells in a given region.
+ * The range is adjusted to only include cells that exist, so it can
+ * be empty.
  *
- * @param near_enemy If not nullptr, whether they are close to an enemy is
- * returned here.
- * @param near_boss If not nullptr, whether they are close to a boss is
- * returned here.
+ * @param top_left Top-left coordinates (in world coordinates)
+ * of the region.
+ * @param bottom_right Bottom-right coordinates (in world coordinates)
+ * of the region.
+ * @param out_range The first and last column, then the first and last row,
+ * all inclusive, are returned here.
  */
-void GameplayState::is_near_enemy_and_boss(bool* near_enemy, bool* near_boss) {
-    bool found_enemy = false;
-    bool found_boss = false;
-    for(size_t e = 0; e < game.states.gameplay->mobs.enemies.size(); e++) {
+void GameplayState::get_area_cell_range(
+    const Point &top_left, const Point &bottom_right, int out_range[4]
+) const {
+    int from_x =
+        (top_left.x - game.cur_area_data->bmap.top_left_corner.x) /
+        GEOMETRY::AREA_CELL_SIZE;
+    int to_x =
+        (bottom_right.x - game.cur_area_data->bmap.top_left_corner.x) /
+        GEOMETRY::AREA_CELL_SIZE;
+    int from_y =
+        (top_left.y - game.cur_area_data->bmap.top_left_corner.y) /
+        GEOMETRY::AREA_CELL_SIZE;
+    int to_y =
+        (bottom_right.y - game.cur_area_data->bmap.top_left_corner.y) /
+        GEOMETRY::AREA_CELL_SIZE;
+    
+    out_range[0] = std::max(0, from_x);
+    out_range[1] = std::min(to_x, (int) nr_area_cell_cols - 1);
+    out_range[2] = std::max(0, from_y);
+    out_range[3] = std::min(to_y, (int) nr_area_cell_rows - 1);
+}
+
+
+/**
+ * @brief Returns whether an area cell is active for this frame.
+ * This is the case if there's a Pikmin or leader nearby, or if it's
+ * in the camera's region.
+ *
+ * @param cell_x Column index of the cell.
+ * @param cell_y Row index of the cell.
+ * @return Whether it's active.
+ */
+bool GameplayState::is_area_cell_active(size_t cell_x, size_t cell_y) const {
+    if(area_active_cell_refs[cell_x * nr_area_cell_rows + cell_y] > 0) {
+        return true;
+    }
+    return
+        (int) cell_x >= cam_active_cells[0] &&
+        (int) cell_x <= cam_active_cells[1] &&
+        (int) cell_y >= cam_active_cells[2] &&
+        (int) cell_y <= cam_active_cells[3];
+}
+
+
+/**
+ * @brief Checks if the player is close to any living enemy and also if
+ * they are close to any living boss.
+ *
+ * @param near_enemy If not nullptr, whether they are close to an enemy is
+ * returned here.
+ * @param near_boss If not nullptr, whether they are close to a boss is
+ * returned here.
+ */
+void GameplayState::is_near_enemy_and_boss(bool* near_enemy, bool* near_boss) {
+    bool found_enemy = false;
+    bool found_boss = false;
+    for(size_t e = 0; e < game.states.gameplay->mobs.enemies.size(); e++) {
         Enemy* e_ptr = game.states.gameplay->mobs.enemies[e];
         if(e_ptr->health <= 0.0f) continue;
         
@@ -1514,6 +1963,7 @@ bool GameplayState::is_mission_clear_met() {
 
 /**
  * @brief Checks if a mission fail condition has been met.
+ * Only the conditions whose counters changed get checked.
  *
  * @param reason The reason gets returned here, if any.
  * @return Whether a failure condition is met.
@@ -1526,6 +1976,15 @@ bool GameplayState::is_mission_fail_met(MISSION_FAIL_COND* reason) {
                 get_idx_bitmask(f)
             )
         ) {
+            if(
+                !has_flag(
+                    changed_mission_counters,
+                    game.mission_fail_conds[f]->get_dependencies()
+                )
+            ) {
+                //Nothing it depends on changed, so it can't be met now.
+                continue;
+            }
             if(game.mission_fail_conds[f]->is_met(this)) {
                 *reason = (MISSION_FAIL_COND) f;
                 return true;
@@ -1537,162 +1996,103 @@ bool GameplayState::is_mission_fail_met(MISSION_FAIL_COND* reason) {
 
 
 /**
- * @brief Marks all area cells in a given region as active.
- *
- * @param top_left Top-left coordinates (in world coordinates)
- * of the region.
- * @param bottom_right Bottom-right coordinates (in world coordinates)
- * of the region.
- */
-void GameplayState::mark_area_cells_active(
-    const Point &top_left, const Point &bottom_right
-) {
-    int from_x =
-        (top_left.x - game.cur_area_data->bmap.top_left_corner.x) /
-        GEOMETRY::AREA_CELL_SIZE;
-    int to_x =
-        (bottom_right.x - game.cur_area_data->bmap.top_left_corner.x) /
-        GEOMETRY::AREA_CELL_SIZE;
-    int from_y =
-        (top_left.y - game.cur_area_data->bmap.top_left_corner.y) /
-        GEOMETRY::AREA_CELL_SIZE;
-    int to_y =
-        (bottom_right.y - game.cur_area_data->bmap.top_left_corner.y) /
-        GEOMETRY::AREA_CELL_SIZE;
-        
-    mark_area_cells_active(from_x, to_x, from_y, to_y);
-}
-
-
-/**
- * @brief Marks all area cells in a given region as active.
- * All coordinates provided are automatically adjusted if out-of-bounds.
+ * @brief Checks if an inter-mob event that the detection pass found can
+ * still run. Mobs that acted before this one could have changed its target,
+ * like by taking the last free spot of a carriable object, or by reserving
+ * a tool, so the checks that decided on the event are done again.
  *
- * @param from_x Starting column index of the cells, inclusive.
- * @param to_x Ending column index of the cells, inclusive.
- * @param from_y Starting row index of the cells, inclusive.
- * @param to_y Ending row index of the cells, inclusive.
+ * @param m_ptr Mob that would receive the event.
+ * @param ev The event.
+ * @return Whether it can still run.
  */
-void GameplayState::mark_area_cells_active(
-    int from_x, int to_x, int from_y, int to_y
+bool GameplayState::is_pending_intermob_event_valid(
+    Mob* m_ptr, const PendingIntermobEvent &ev
 ) {
-    from_x = std::max(0, from_x);
-    to_x = std::min(to_x, (int) area_active_cells.size() - 1);
-    from_y = std::max(0, from_y);
-    to_y = std::min(to_y, (int) area_active_cells[0].size() - 1);
-    
-    for(int x = from_x; x <= to_x; x++) {
-        for(int y = from_y; y <= to_y; y++) {
-            area_active_cells[x][y] = true;
-        }
+    Mob* m2_ptr = ev.mob_ptr;
+    if(m2_ptr->to_delete) return false;
+    if(m2_ptr->is_stored_inside_mob()) return false;
+    
+    switch(ev.event_ptr->type) {
+    case MOB_EV_OBJECT_IN_REACH:
+    case MOB_EV_OPPONENT_IN_REACH: {
+        return m2_ptr->health != 0 && !m2_ptr->has_invisibility_status;
+    } case MOB_EV_NEAR_CARRIABLE_OBJECT: {
+        return m2_ptr->carry_info && !m2_ptr->carry_info->is_full();
+    } case MOB_EV_NEAR_TOOL: {
+        Tool* too_ptr = (Tool*) m2_ptr;
+        return !too_ptr->reserved || too_ptr->reserved == m_ptr;
+    } case MOB_EV_NEAR_GROUP_TASK: {
+        GroupTask* tas_ptr = (GroupTask*) m2_ptr;
+        return tas_ptr->health > 0 && tas_ptr->get_free_spot();
+    } case MOB_EV_TOUCHED_ACTIVE_LEADER: {
+        return
+            m2_ptr == cur_leader_ptr &&
+            m2_ptr->fsm.cur_state->id == LEADER_STATE_ACTIVE;
+    } default: {
+        return true;
+    }
     }
 }
 
 
 /**
- * @brief Handles the logic required to tick a specific mob and its interactions
- * with other mobs.
+ * @brief Handles the interactions a mob has with other mobs, based on what
+ * the detection pass found. Things could have changed since then, so
+ * this checks the mobs again before making them touch, and before running
+ * each pending event. The events only run if the mob is still in the
+ * same state.
  *
  * @param m_ptr Mob to process.
  * @param m Index of the mob.
+ * @param info Interactions detected for the mob.
  */
-void GameplayState::process_mob_interactions(Mob* m_ptr, size_t m) {
-    vector<PendingIntermobEvent> pending_intermob_events;
-    MobState* state_before = m_ptr->fsm.cur_state;
+void GameplayState::process_mob_interactions(
+    Mob* m_ptr, size_t m, MobInteractionInfo &info
+) {
+    if(game.perf_mon) {
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_OBJECTS_TOUCHING_OTHERS
+        );
+    }
     
-    size_t n_mobs = mobs.all.size();
-    for(size_t m2 = 0; m2 < n_mobs; m2++) {
-        if(m == m2) continue;
-        
+    for(size_t n = 0; n < info.nearby_idxs.size(); n++) {
+        size_t m2 = info.nearby_idxs[n];
         Mob* m2_ptr = mobs.all[m2];
-        if(
-            !has_flag(
-                m2_ptr->type->inactive_logic,
-                INACTIVE_LOGIC_FLAG_INTERACTIONS
-            ) && !m2_ptr->is_active &&
-            m_ptr->time_alive > 0.1f
-        ) {
+        if(!m2_ptr->accepts_interactions && m_ptr->time_alive > 0.1f) {
             continue;
         }
         if(m2_ptr->to_delete) continue;
         if(m2_ptr->is_stored_inside_mob()) continue;
         
         Distance d(m_ptr->pos, m2_ptr->pos);
-        Distance d_between = m_ptr->get_distance_between(m2_ptr, &d);
-        
-        if(d_between > m_ptr->interaction_span + m2_ptr->physical_span) {
-            //The other mob is so far away that there is
-            //no interaction possible.
-            continue;
-        }
-        
-        if(game.perf_mon) {
-            game.perf_mon->start_measurement("Objects -- Touching others");
-        }
-        
         if(d <= m_ptr->physical_span + m2_ptr->physical_span) {
             //Only check if their radii or hitboxes
             //can (theoretically) reach each other.
             process_mob_touches(m_ptr, m2_ptr, m, m2, d);
-            
-        }
-        
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
-            game.perf_mon->start_measurement("Objects -- Reaches");
-        }
-        
-        if(
-            m2_ptr->health != 0 && m_ptr->near_reach != INVALID &&
-            !m2_ptr->has_invisibility_status
-        ) {
-            process_mob_reaches(
-                m_ptr, m2_ptr, m, m2, d_between, pending_intermob_events
-            );
-        }
-        
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
-            game.perf_mon->start_measurement("Objects -- Misc. interactions");
-        }
-        
-        process_mob_misc_interactions(
-            m_ptr, m2_ptr, m, m2, d, d_between, pending_intermob_events
-        );
-        
-        if(game.perf_mon) {
-            game.perf_mon->finish_measurement();
         }
     }
     
     if(game.perf_mon) {
-        game.perf_mon->start_measurement("Objects -- Interaction results");
-    }
-    
-    //Check the pending inter-mob events.
-    sort(
-        pending_intermob_events.begin(), pending_intermob_events.end(),
-    [m_ptr] (PendingIntermobEvent e1, PendingIntermobEvent e2) -> bool {
-        return
-        (
-            e1.d.to_float() -
-            (m_ptr->radius + e1.mob_ptr->radius)
-        ) < (
-            e2.d.to_float() -
-            (m_ptr->radius + e2.mob_ptr->radius)
+        game.perf_mon->finish_measurement();
+        game.perf_mon->start_measurement(
+            PERF_MON_MEASUREMENT_OBJECTS_INTERACTION_RESULTS
         );
     }
-    );
     
-    for(size_t e = 0; e < pending_intermob_events.size(); e++) {
-        if(m_ptr->fsm.cur_state != state_before) {
+    //Check the pending inter-mob events.
+    for(size_t e = 0; e < info.pending_events.size(); e++) {
+        if(m_ptr->fsm.cur_state != info.state) {
             //We can't go on, since the new state might not even have the
             //event, and the reaches could've also changed.
             break;
         }
-        if(!pending_intermob_events[e].event_ptr) continue;
-        pending_intermob_events[e].event_ptr->run(
-            m_ptr, (void*) pending_intermob_events[e].mob_ptr
+        if(!info.pending_events[e].event_ptr) continue;
+        if(!is_pending_intermob_event_valid(m_ptr, info.pending_events[e])) {
+            //Another mob got to it first.
+            continue;
+        }
+        info.pending_events[e].event_ptr->run(
+            m_ptr, (void*) info.pending_events[e].mob_ptr
         );
         
     }
@@ -1705,7 +2105,8 @@ void GameplayState::process_mob_interactions(Mob* m_ptr, size_t m) {
 
 /**
  * @brief Handles the logic between m_ptr and m2_ptr regarding
- * miscellaneous things.
+ * miscellaneous things. Interactions with the kinds of mobs that
+ * have a task index are handled in detect_mob_task_interactions instead.
  *
  * @param m_ptr Mob that's being processed.
  * @param m2_ptr Check against this mob.
@@ -1720,62 +2121,6 @@ void GameplayState::process_mob_misc_interactions(
     const Distance &d, const Distance &d_between,
     vector<PendingIntermobEvent> &pending_intermob_events
 ) {
-    //Find a carriable mob to grab.
-    MobEvent* nco_event =
-        m_ptr->fsm.get_event(MOB_EV_NEAR_CARRIABLE_OBJECT);
-    if(
-        nco_event &&
-        m2_ptr->carry_info &&
-        !m2_ptr->carry_info->is_full()
-    ) {
-        if(d_between <= task_range(m_ptr)) {
-            pending_intermob_events.push_back(
-                PendingIntermobEvent(d_between, nco_event, m2_ptr)
-            );
-        }
-    }
-    
-    //Find a tool mob.
-    MobEvent* nto_event =
-        m_ptr->fsm.get_event(MOB_EV_NEAR_TOOL);
-    if(
-        nto_event &&
-        typeid(*m2_ptr) == typeid(Tool)
-    ) {
-        if(d_between <= task_range(m_ptr)) {
-            Tool* too_ptr = (Tool*) m2_ptr;
-            if(too_ptr->reserved && too_ptr->reserved != m_ptr) {
-                //Another Pikmin is already going for it. Ignore it.
-            } else {
-                pending_intermob_events.push_back(
-                    PendingIntermobEvent(d_between, nto_event, m2_ptr)
-                );
-            }
-        }
-    }
-    
-    //Find a group task mob.
-    MobEvent* ngto_event =
-        m_ptr->fsm.get_event(MOB_EV_NEAR_GROUP_TASK);
-    if(
-        ngto_event &&
-        m2_ptr->health > 0 &&
-        typeid(*m2_ptr) == typeid(GroupTask)
-    ) {
-        if(d_between <= task_range(m_ptr)) {
-            GroupTask* tas_ptr = (GroupTask*) m2_ptr;
-            GroupTask::GroupTaskSpot* free_spot = tas_ptr->get_free_spot();
-            if(!free_spot) {
-                //There are no free spots here. Ignore it.
-            } else {
-                pending_intermob_events.push_back(
-                    PendingIntermobEvent(d_between, ngto_event, m2_ptr)
-                );
-            }
-        }
-        
-    }
-    
     //"Bumped" by the active leader being nearby.
     MobEvent* touch_le_ev =
         m_ptr->fsm.get_event(MOB_EV_TOUCHED_ACTIVE_LEADER);
@@ -1796,78 +2141,29 @@ void GameplayState::process_mob_misc_interactions(
 
 
 /**
- * @brief Handles the logic between m_ptr and m2_ptr regarding everything
- * involving one being in the other's reach.
+ * @brief Handles the logic of m_ptr being pushed by m2_ptr.
  *
- * @param m_ptr Mob that's being processed.
- * @param m2_ptr Check against this mob.
- * @param m Index of the mob being processed.
- * @param m2 Index of the mob to check against.
- * @param d_between Distance between the two.
- * @param pending_intermob_events Vector of events to be processed.
- */
-void GameplayState::process_mob_reaches(
-    Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, const Distance &d_between,
-    vector<PendingIntermobEvent> &pending_intermob_events
-) {
-    //Check reaches.
-    MobEvent* obir_ev =
-        m_ptr->fsm.get_event(MOB_EV_OBJECT_IN_REACH);
-    MobEvent* opir_ev =
-        m_ptr->fsm.get_event(MOB_EV_OPPONENT_IN_REACH);
-        
-    if(!obir_ev && !opir_ev) return;
-    
-    MobType::Reach* r_ptr = &m_ptr->type->reaches[m_ptr->near_reach];
-    float angle_diff =
-        get_angle_smallest_dif(
-            m_ptr->angle,
-            get_angle(m_ptr->pos, m2_ptr->pos)
-        );
-        
-    if(is_mob_in_reach(r_ptr, d_between, angle_diff)) {
-        if(obir_ev) {
-            pending_intermob_events.push_back(
-                PendingIntermobEvent(
-                    d_between, obir_ev, m2_ptr
-                )
-            );
-        }
-        if(opir_ev && m_ptr->can_hunt(m2_ptr)) {
-            pending_intermob_events.push_back(
-                PendingIntermobEvent(
-                    d_between, opir_ev, m2_ptr
-                )
-            );
-        }
-    }
-}
-
-
-/**
- * @brief Handles the logic between m_ptr and m2_ptr regarding everything
- * involving one touching the other.
- *
- * @param m_ptr Mob that's being processed.
- * @param m2_ptr Check against this mob.
- * @param m Index of the mob being processed.
- * @param m2 Index of the mob to check against.
+ * @param m_ptr Mob that can be pushed.
+ * @param m2_ptr Mob that can push it.
+ * @param m Index of the mob that can be pushed.
+ * @param m2 Index of the mob that can push it.
  * @param d Distance between the two.
+ * @param both_idle_pikmin Whether both mobs are idle Pikmin.
+ * @param circle_push_amount If both mobs are circles and they touch,
+ * this is how far apart they need to go.
+ * @param circle_push_angle If both mobs are circles and they touch,
+ * this is the angle at which m_ptr needs to go.
  */
-void GameplayState::process_mob_touches(
-    Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, Distance &d
+void GameplayState::process_mob_push(
+    Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, const Distance &d,
+    bool both_idle_pikmin, float circle_push_amount, float circle_push_angle
 ) {
-    //Check if mob 1 should be pushed by mob 2.
-    bool both_idle_pikmin =
-        m_ptr->type->category->id == MOB_CATEGORY_PIKMIN &&
-        m2_ptr->type->category->id == MOB_CATEGORY_PIKMIN &&
-        (
-            ((Pikmin*) m_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING ||
-            ((Pikmin*) m_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING_H
-        ) && (
-            ((Pikmin*) m2_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING ||
-            ((Pikmin*) m2_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING_H
-        );
+    if(!m2_ptr->accepts_interactions && m_ptr->time_alive > 0.1f) {
+        return;
+    }
+    if(m2_ptr->to_delete) return;
+    if(m2_ptr->is_stored_inside_mob()) return;
+    
     bool ok_to_push = true;
     if(
         has_flag(m_ptr->flags, MOB_FLAG_INTANGIBLE) ||
@@ -1910,24 +2206,13 @@ void GameplayState::process_mob_touches(
             
             Sprite* s2_ptr;
             m2_ptr->get_sprite_data(&s2_ptr, nullptr, nullptr);
-            
-            for(size_t h = 0; h < s2_ptr->hitboxes.size(); h++) {
+            const vector<WorldHitbox> &w2_hitboxes =
+                m2_ptr->get_world_hitboxes(s2_ptr);
+                
+            for(size_t h = 0; h < w2_hitboxes.size(); h++) {
                 Hitbox* h_ptr = &s2_ptr->hitboxes[h];
                 if(h_ptr->type == HITBOX_TYPE_DISABLED) continue;
-                Point h_pos(
-                    m2_ptr->pos.x + (
-                        h_ptr->pos.x * m2_ptr->angle_cos -
-                        h_ptr->pos.y * m2_ptr->angle_sin
-                    ),
-                    m2_ptr->pos.y + (
-                        h_ptr->pos.x * m2_ptr->angle_sin +
-                        h_ptr->pos.y * m2_ptr->angle_cos
-                    )
-                );
-                //It's more optimized to get the hitbox position here
-                //instead of calling hitbox::get_cur_pos because
-                //we already know the sine and cosine, so they don't
-                //need to be re-calculated.
+                const Point &h_pos = w2_hitboxes[h].pos;
                 
                 Distance hd(m_ptr->pos, h_pos);
                 if(hd < m_ptr->radius + h_ptr->radius) {
@@ -1976,17 +2261,12 @@ void GameplayState::process_mob_touches(
                         m2_ptr->angle, &temp_push_amount, &temp_push_angle
                     );
             } else {
-                //Circle vs circle.
+                //Circle vs circle. This was already calculated for the pair.
                 xy_collision =
                     d <= (m_ptr->radius + m2_ptr->radius);
                 if(xy_collision) {
-                    //Only bother calculating if there's a collision.
-                    temp_push_amount =
-                        fabs(
-                            d.to_float() - m_ptr->radius -
-                            m2_ptr->radius
-                        );
-                    temp_push_angle = get_angle(m2_ptr->pos, m_ptr->pos);
+                    temp_push_amount = circle_push_amount;
+                    temp_push_angle = circle_push_angle;
                 }
             }
             
@@ -2035,8 +2315,167 @@ void GameplayState::process_mob_touches(
             m_ptr->push_angle = push_angle;
         }
     }
+}
+
+
+/**
+ * @brief Handles the pushing between two mobs that found each other
+ * this frame. Whatever the two pushes have in common is only
+ * calculated once.
+ *
+ * @param pair The pair of mobs.
+ */
+void GameplayState::process_mob_push_pair(const MobPushPair &pair) {
+    Mob* m1_ptr = mobs.all[pair.m1];
+    Mob* m2_ptr = mobs.all[pair.m2];
+    
+    Distance d(m1_ptr->pos, m2_ptr->pos);
+    if(d > m1_ptr->physical_span + m2_ptr->physical_span) {
+        //Their radii or hitboxes can't (theoretically) reach each other.
+        return;
+    }
+    
+    bool both_idle_pikmin =
+        m1_ptr->type->category->id == MOB_CATEGORY_PIKMIN &&
+        m2_ptr->type->category->id == MOB_CATEGORY_PIKMIN &&
+        (
+            ((Pikmin*) m1_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING ||
+            ((Pikmin*) m1_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING_H
+        ) && (
+            ((Pikmin*) m2_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING ||
+            ((Pikmin*) m2_ptr)->fsm.cur_state->id == PIKMIN_STATE_IDLING_H
+        );
+        
+    //For two circles, both pushes have the same amount, and
+    //opposite angles.
+    float circle_push_amount = 0.0f;
+    float circle_push_angle = 0.0f;
+    if(
+        m1_ptr->rectangular_dim.x == 0 &&
+        m2_ptr->rectangular_dim.x == 0 &&
+        d <= (m1_ptr->radius + m2_ptr->radius)
+    ) {
+        circle_push_amount =
+            fabs(d.to_float() - m1_ptr->radius - m2_ptr->radius);
+        circle_push_angle = get_angle(m2_ptr->pos, m1_ptr->pos);
+    }
+    
+    if(pair.m1_has_m2) {
+        process_mob_push(
+            m1_ptr, m2_ptr, pair.m1, pair.m2, d, both_idle_pikmin,
+            circle_push_amount, circle_push_angle
+        );
+    }
+    if(pair.m2_has_m1) {
+        process_mob_push(
+            m2_ptr, m1_ptr, pair.m2, pair.m1, d, both_idle_pikmin,
+            circle_push_amount, circle_push_angle + TAU / 2.0f
+        );
+    }
+}
+
+
+/**
+ * @brief Handles the pushing between all awake mobs and the mobs near
+ * them. Each pair of mobs is only handled once, even if both found
+ * each other, instead of once from each side.
+ */
+void GameplayState::process_mob_pushes() {
+    mob_push_pairs.clear();
+    for(size_t a = 0; a < awake_mob_idxs.size(); a++) {
+        size_t m = awake_mob_idxs[a];
+        const vector<size_t> &nearby_idxs =
+            mob_interaction_infos[a].nearby_idxs;
+        for(size_t n = 0; n < nearby_idxs.size(); n++) {
+            size_t m2 = nearby_idxs[n];
+            MobPushPair pair;
+            pair.m1 = std::min(m, m2);
+            pair.m2 = std::max(m, m2);
+            pair.m1_has_m2 = m < m2;
+            pair.m2_has_m1 = m > m2;
+            mob_push_pairs.push_back(pair);
+        }
+    }
     
+    std::sort(
+        mob_push_pairs.begin(), mob_push_pairs.end(),
+    [] (const MobPushPair &p1, const MobPushPair &p2) -> bool {
+        if(p1.m1 != p2.m1) return p1.m1 < p2.m1;
+        return p1.m2 < p2.m2;
+    }
+    );
     
+    for(size_t p = 0; p < mob_push_pairs.size(); p++) {
+        MobPushPair pair = mob_push_pairs[p];
+        
+        //If the other mob found this one too, that comes right after.
+        while(
+            p + 1 < mob_push_pairs.size() &&
+            mob_push_pairs[p + 1].m1 == pair.m1 &&
+            mob_push_pairs[p + 1].m2 == pair.m2
+        ) {
+            p++;
+            pair.m1_has_m2 |= mob_push_pairs[p].m1_has_m2;
+            pair.m2_has_m1 |= mob_push_pairs[p].m2_has_m1;
+        }
+        
+        process_mob_push_pair(pair);
+    }
+}
+
+
+/**
+ * @brief Handles the logic between m_ptr and m2_ptr regarding everything
+ * involving one being in the other's reach.
+ *
+ * @param m_ptr Mob that's being processed.
+ * @param m2_ptr Check against this mob.
+ * @param m Index of the mob being processed.
+ * @param m2 Index of the mob to check against.
+ * @param d_between Distance between the two.
+ * @param pending_intermob_events Vector of events to be processed.
+ */
+void GameplayState::process_mob_reaches(
+    Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, const Distance &d_between,
+    vector<PendingIntermobEvent> &pending_intermob_events
+) {
+    //Check reaches. Opponents in reach are found through the task indexes,
+    //in detect_mob_task_interactions.
+    MobEvent* obir_ev =
+        m_ptr->fsm.get_event(MOB_EV_OBJECT_IN_REACH);
+    
+    if(!obir_ev) return;
+    
+    MobType::Reach* r_ptr = &m_ptr->type->reaches[m_ptr->near_reach];
+    float angle_diff =
+        get_angle_smallest_dif(
+            m_ptr->angle,
+            get_angle(m_ptr->pos, m2_ptr->pos)
+        );
+        
+    if(is_mob_in_reach(r_ptr, d_between, angle_diff)) {
+        pending_intermob_events.push_back(
+            PendingIntermobEvent(
+                d_between, obir_ev, m2_ptr
+            )
+        );
+    }
+}
+
+
+/**
+ * @brief Handles the logic between m_ptr and m2_ptr regarding everything
+ * involving one touching the other.
+ *
+ * @param m_ptr Mob that's being processed.
+ * @param m2_ptr Check against this mob.
+ * @param m Index of the mob being processed.
+ * @param m2 Index of the mob to check against.
+ * @param d Distance between the two.
+ */
+void GameplayState::process_mob_touches(
+    Mob* m_ptr, Mob* m2_ptr, size_t m, size_t m2, Distance &d
+) {
     //Check touches. This does not use hitboxes,
     //only the object radii (or rectangular width/height).
     MobEvent* touch_op_ev =
@@ -2138,26 +2577,45 @@ void GameplayState::process_mob_touches(
         bool reported_eat_ev = false;
         bool reported_haz_ev = false;
         
-        for(size_t h1 = 0; h1 < s1_ptr->hitboxes.size(); h1++) {
+        //Get the real hitbox locations.
+        const vector<WorldHitbox> &w1_hitboxes =
+            m_ptr->get_world_hitboxes(s1_ptr);
+        const vector<WorldHitbox> &w2_hitboxes =
+            m2_ptr->get_world_hitboxes(s2_ptr);
+            
+        //Mobs held by a hitbox are touching it no matter what, so only
+        //use the bounds to skip work if that's not the case.
+        bool holding_each_other =
+            m_ptr->holder.m == m2_ptr || m2_ptr->holder.m == m_ptr;
+        bool bounds_touch =
+            s1_ptr->hitbox_bounds.type != HITBOX_TYPE_DISABLED &&
+            s2_ptr->hitbox_bounds.type != HITBOX_TYPE_DISABLED &&
+            m_ptr->world_hitbox_bounds.touches(m2_ptr->world_hitbox_bounds);
+            
+        for(
+            size_t h1 = 0;
+            h1 < s1_ptr->hitboxes.size() &&
+            (bounds_touch || holding_each_other);
+            h1++
+        ) {
         
             Hitbox* h1_ptr = &s1_ptr->hitboxes[h1];
             if(h1_ptr->type == HITBOX_TYPE_DISABLED) continue;
+            const WorldHitbox* w1_ptr = &w1_hitboxes[h1];
+            
+            //If this hitbox can't reach any of the other mob's hitboxes,
+            //there's no need to check them one by one.
+            if(
+                !holding_each_other &&
+                !w1_ptr->touches(m2_ptr->world_hitbox_bounds)
+            ) {
+                continue;
+            }
             
             for(size_t h2 = 0; h2 < s2_ptr->hitboxes.size(); h2++) {
                 Hitbox* h2_ptr = &s2_ptr->hitboxes[h2];
                 if(h2_ptr->type == HITBOX_TYPE_DISABLED) continue;
-                
-                //Get the real hitbox locations.
-                Point m1_h_pos =
-                    h1_ptr->get_cur_pos(
-                        m_ptr->pos, m_ptr->angle_cos, m_ptr->angle_sin
-                    );
-                Point m2_h_pos =
-                    h2_ptr->get_cur_pos(
-                        m2_ptr->pos, m2_ptr->angle_cos, m2_ptr->angle_sin
-                    );
-                float m1_h_z = m_ptr->z + h1_ptr->z;
-                float m2_h_z = m2_ptr->z + h2_ptr->z;
+                const WorldHitbox* w2_ptr = &w2_hitboxes[h2];
                 
                 bool collided = false;
                 
@@ -2174,25 +2632,8 @@ void GameplayState::process_mob_touches(
                     collided = true;
                 }
                 
-                if(!collided) {
-                    bool z_collision;
-                    if(h1_ptr->height == 0 || h2_ptr->height == 0) {
-                        z_collision = true;
-                    } else {
-                        z_collision =
-                            !(
-                                (m2_h_z > m1_h_z + h1_ptr->height) ||
-                                (m2_h_z + h2_ptr->height < m1_h_z)
-                            );
-                    }
-                    
-                    if(
-                        z_collision &&
-                        Distance(m1_h_pos, m2_h_pos) <
-                        (h1_ptr->radius + h2_ptr->radius)
-                    ) {
-                        collided = true;
-                    }
+                if(!collided && w1_ptr->touches(*w2_ptr)) {
+                    collided = true;
                 }
                 
                 if(!collided) continue;
@@ -2369,43 +2810,92 @@ void GameplayState::process_mob_touches(
 
 
 /**
- * @brief Updates the grid that represents which area cells are active
- * for this frame.
+ * @brief Makes the whistle catch the awake mobs within its range.
+ * Only the mobs near the whistle, according to the mob grid, get checked.
  */
-void GameplayState::update_area_active_cells() {
-    //Initialize the grid to false.
-    for(size_t x = 0; x < area_active_cells.size(); x++) {
-        for(size_t y = 0; y < area_active_cells[x].size(); y++) {
-            area_active_cells[x][y] = false;
+void GameplayState::process_whistle() {
+    vector<size_t> idxs;
+    mob_grid.get_mobs_in_region(
+        whistle.center - whistle.radius, whistle.center + whistle.radius, idxs
+    );
+    
+    for(size_t i = 0; i < idxs.size(); i++) {
+        //Only mobs that got to tick this frame can be whistled, like
+        //it'd happen during their tick.
+        if(
+            !std::binary_search(
+                awake_mob_idxs.begin(), awake_mob_idxs.end(), idxs[i]
+            )
+        ) {
+            continue;
         }
+        
+        Mob* m_ptr = mobs.all[idxs[i]];
+        if(m_ptr->to_delete || !m_ptr->fsm.cur_state) continue;
+        if(Distance(m_ptr->pos, whistle.center) > whistle.radius) continue;
+        
+        m_ptr->handle_whistle(cur_leader_ptr);
     }
-    
-    //Mark the 3x3 region around Pikmin and leaders as active.
+}
+
+
+/**
+ * @brief Updates which area cells are active for this frame.
+ * Pikmin and leaders keep the cells around them active, and only need to
+ * update the cells' counts when they go to a different cell, so the grid
+ * doesn't need to be reset every frame.
+ */
+void GameplayState::update_area_active_cells() {
+    //Keep the 3x3 region around Pikmin and leaders active.
     for(size_t p = 0; p < mobs.pikmin_list.size(); p++) {
-        mark_area_cells_active(
-            mobs.pikmin_list[p]->pos - GEOMETRY::AREA_CELL_SIZE,
-            mobs.pikmin_list[p]->pos + GEOMETRY::AREA_CELL_SIZE
-        );
+        update_mob_active_cells(mobs.pikmin_list[p]);
     }
     
     for(size_t l = 0; l < mobs.leaders.size(); l++) {
-        mark_area_cells_active(
-            mobs.leaders[l]->pos - GEOMETRY::AREA_CELL_SIZE,
-            mobs.leaders[l]->pos + GEOMETRY::AREA_CELL_SIZE
-        );
+        update_mob_active_cells(mobs.leaders[l]);
     }
     
-    //Mark the region in-camera (plus padding) as active.
-    mark_area_cells_active(game.cam.box[0], game.cam.box[1]);
+    //The region in-camera (plus padding) is also active.
+    get_area_cell_range(game.cam.box[0], game.cam.box[1], cam_active_cells);
 }
 
 
 /**
- * @brief Updates the "is_active" member variable of all mobs for this frame.
+ * @brief Updates which area cells a mob is keeping active, which are the cells
+ * in the 3x3 region around it.
+ *
+ * @param m_ptr The mob.
  */
-void GameplayState::update_mob_is_active_flag() {
-    unordered_set<Mob*> child_mobs;
+void GameplayState::update_mob_active_cells(Mob* m_ptr) {
+    int new_cells[4];
+    get_area_cell_range(
+        m_ptr->pos - GEOMETRY::AREA_CELL_SIZE,
+        m_ptr->pos + GEOMETRY::AREA_CELL_SIZE,
+        new_cells
+    );
+    if(
+        new_cells[0] == m_ptr->active_cells[0] &&
+        new_cells[1] == m_ptr->active_cells[1] &&
+        new_cells[2] == m_ptr->active_cells[2] &&
+        new_cells[3] == m_ptr->active_cells[3]
+    ) {
+        return;
+    }
     
+    change_area_cell_refs(m_ptr->active_cells, -1);
+    change_area_cell_refs(new_cells, 1);
+    for(unsigned char c = 0; c < 4; c++) {
+        m_ptr->active_cells[c] = new_cells[c];
+    }
+}
+
+
+/**
+ * @brief Updates the "is_active" member variable of all mobs for this frame,
+ * and with it, which mobs are awake. Mobs that are asleep don't get ticked,
+ * so the main logic loop doesn't even need to look at them.
+ */
+void GameplayState::update_mob_is_active_flag() {
     for(size_t m = 0; m < mobs.all.size(); m++) {
         Mob* m_ptr = mobs.all[m];
         
@@ -2415,29 +2905,127 @@ void GameplayState::update_mob_is_active_flag() {
         int cell_y =
             (m_ptr->pos.y - game.cur_area_data->bmap.top_left_corner.y) /
             GEOMETRY::AREA_CELL_SIZE;
-        if(
-            cell_x < 0 ||
-            cell_x >= (int) game.states.gameplay->area_active_cells.size()
-        ) {
+        if(cell_x < 0 || cell_x >= (int) nr_area_cell_cols) {
             m_ptr->is_active = false;
-        } else if(
-            cell_y < 0 ||
-            cell_y >= (int) game.states.gameplay->area_active_cells[0].size()
-        ) {
+        } else if(cell_y < 0 || cell_y >= (int) nr_area_cell_rows) {
             m_ptr->is_active = false;
         } else {
-            m_ptr->is_active =
-                game.states.gameplay->area_active_cells[cell_x][cell_y];
+            m_ptr->is_active = is_area_cell_active(cell_x, cell_y);
         }
+    }
+
+    for(size_t c = 0; c < mobs.children.size(); c++) {
+        Mob* c_ptr = mobs.children[c];
+        if(!c_ptr->parent || !c_ptr->parent->m) continue;
+        if(c_ptr->is_active) c_ptr->parent->m->is_active = true;
+    }
+    
+    for(size_t c = 0; c < mobs.children.size(); c++) {
+        Mob* c_ptr = mobs.children[c];
+        if(!c_ptr->parent || !c_ptr->parent->m) continue;
+        if(c_ptr->parent->m->is_active) c_ptr->is_active = true;
+    }
+    
+    awake_mob_idxs.clear();
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        Mob* m_ptr = mobs.all[m];
+        m_ptr->accepts_interactions =
+            m_ptr->is_active ||
+            has_flag(
+                m_ptr->type->inactive_logic, INACTIVE_LOGIC_FLAG_INTERACTIONS
+            );
         
-        if(m_ptr->parent && m_ptr->parent->m) child_mobs.insert(m_ptr);
+        //Mobs that were just created always get to tick for a bit,
+        //so they can set themselves up.
+        if(
+            m_ptr->is_active ||
+            has_flag(m_ptr->type->inactive_logic, INACTIVE_LOGIC_FLAG_TICKS) ||
+            m_ptr->time_alive <= 0.1f
+        ) {
+            awake_mob_idxs.push_back(m);
+        }
+    }
+}
+
+
+/**
+ * @brief Works out the order in which the awake mobs get ticked this frame.
+ * Leaders go first, in their usual order, since the Pikmin and other mobs
+ * that follow them go after where they are this frame. The rest are
+ * grouped by category, and then by type, in the order each type first
+ * showed up in the area, so that the order is the same on every run.
+ * Children and held mobs go last, in their usual order, so that they're
+ * always ticked after the mob they follow.
+ */
+void GameplayState::update_mob_tick_order() {
+    mob_tick_order_keys.clear();
+    mob_tick_order_followers.clear();
+    
+    for(size_t a = 0; a < awake_mob_idxs.size(); a++) {
+        size_t m = awake_mob_idxs[a];
+        Mob* m_ptr = mobs.all[m];
+        if(m_ptr->parent || m_ptr->holder.m) {
+            mob_tick_order_followers.push_back(m);
+            continue;
+        }
+        if(m_ptr->type->category->id == MOB_CATEGORY_LEADERS) {
+            //Before every category, and in their usual order.
+            mob_tick_order_keys.push_back(std::make_tuple(-1, 0, m));
+            continue;
+        }
+        size_t type_rank =
+            mob_tick_type_ranks.insert(
+                std::make_pair(m_ptr->type, mob_tick_type_ranks.size())
+            ).first->second;
+        mob_tick_order_keys.push_back(
+            std::make_tuple((int) m_ptr->type->category->id, type_rank, m)
+        );
     }
+    std::sort(mob_tick_order_keys.begin(), mob_tick_order_keys.end());
     
-    for(const auto &m : child_mobs) {
-        if(m->is_active) m->parent->m->is_active = true;
+    mob_tick_order.clear();
+    for(size_t k = 0; k < mob_tick_order_keys.size(); k++) {
+        mob_tick_order.push_back(std::get<2>(mob_tick_order_keys[k]));
+    }
+    mob_tick_order.insert(
+        mob_tick_order.end(),
+        mob_tick_order_followers.begin(), mob_tick_order_followers.end()
+    );
+}
+
+
+/**
+ * @brief Refills the task indexes with the mobs that can currently
+ * be found through them.
+ */
+void GameplayState::update_task_indexes() {
+    for(size_t i = 0; i < N_MOB_TASK_INDEXES; i++) {
+        task_indexes[i].clear();
     }
     
-    for(auto &m : child_mobs) {
-        if(m->parent->m->is_active) m->is_active = true;
+    for(size_t m = 0; m < mobs.all.size(); m++) {
+        Mob* m_ptr = mobs.all[m];
+        if(m_ptr->to_delete) continue;
+        if(m_ptr->is_stored_inside_mob()) continue;
+        
+        if(m_ptr->carry_info && !m_ptr->carry_info->is_full()) {
+            task_indexes[MOB_TASK_INDEX_CARRIABLES].add_mob(m_ptr);
+        }
+        if(typeid(*m_ptr) == typeid(Tool)) {
+            task_indexes[MOB_TASK_INDEX_TOOLS].add_mob(m_ptr);
+        }
+        if(m_ptr->health > 0 && typeid(*m_ptr) == typeid(GroupTask)) {
+            task_indexes[MOB_TASK_INDEX_GROUP_TASKS].add_mob(m_ptr);
+        }
+        if(m_ptr->type->target_type != MOB_TARGET_FLAG_NONE) {
+            task_indexes[MOB_TASK_INDEX_ATTACKABLES].add_mob(m_ptr);
+        }
+        if(
+            m_ptr->type->category->id == MOB_CATEGORY_PIKMIN &&
+            m_ptr->fsm.cur_state &&
+            m_ptr->fsm.cur_state->id == PIKMIN_STATE_SPROUT
+        ) {
+            task_indexes[MOB_TASK_INDEX_SPROUTS].add_mob(m_ptr);
+        }
     }
 }
@@ -141,6 +141,8 @@ PauseMenu::PauseMenu(bool start_on_radar) {
     radar_min_coords = radar_min_coords - 16.0f;
     radar_max_coords = radar_max_coords + 16.0f;
     
+    build_radar_geometry();
+    
     radar_selected_leader = game.states.gameplay->cur_leader_ptr;
     
     if(radar_selected_leader) {
@@ -162,6 +164,11 @@ PauseMenu::PauseMenu(bool start_on_radar) {
  * @brief Destroys the pause menu struct object.
  */
 PauseMenu::~PauseMenu() {
+    if(go_here_task_id != 0) {
+        //The background search writes to this menu, so let it finish.
+        game.jobs.finish_tasks();
+    }
+    
     gui.destroy();
     radar_gui.destroy();
     status_gui.destroy();
@@ -198,6 +205,11 @@ PauseMenu::~PauseMenu() {
     bmp_radar_onion_bulb = nullptr;
     bmp_radar_ship = nullptr;
     bmp_radar_path = nullptr;
+    
+    if(radar_sector_vertex_buffer) {
+        al_destroy_vertex_buffer(radar_sector_vertex_buffer);
+        radar_sector_vertex_buffer = nullptr;
+    }
 }
 
 
@@ -495,12 +507,127 @@ void PauseMenu::add_pikmin_status_line(
 }
 
 
+/**
+ * @brief Builds the vertexes of the quads that make up the radar edges,
+ * for the current radar zoom level.
+ */
+void PauseMenu::build_radar_edge_vertexes() {
+    float half_thickness = 1.5f / radar_cam.zoom / 2.0f;
+    radar_edge_vertexes.clear();
+    radar_edge_vertexes.reserve(radar_edge_points.size() * 3);
+    
+    for(size_t p = 0; p + 1 < radar_edge_points.size(); p += 2) {
+        const Point &start = radar_edge_points[p];
+        const Point &end = radar_edge_points[p + 1];
+        Point dir = normalize_vector(end - start);
+        Point offset(-dir.y * half_thickness, dir.x * half_thickness);
+        const Point corners[6] = {
+            start + offset, start - offset, end + offset,
+            end + offset, start - offset, end - offset
+        };
+        for(size_t c = 0; c < 6; c++) {
+            ALLEGRO_VERTEX av;
+            av.x = corners[c].x;
+            av.y = corners[c].y;
+            av.z = 0;
+            av.u = 0;
+            av.v = 0;
+            av.color = game.config.aesthetic_radar.edge_color;
+            radar_edge_vertexes.push_back(av);
+        }
+    }
+    
+    radar_edge_vertexes_zoom = radar_cam.zoom;
+}
+
+
+/**
+ * @brief Builds the radar's sector and edge geometry. This only needs to
+ * happen once, since panning and zooming are handled by the radar's
+ * transformation.
+ */
+void PauseMenu::build_radar_geometry() {
+    //Sectors.
+    radar_sector_vertexes.clear();
+    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
+        Sector* s_ptr = game.cur_area_data->sectors[s];
+        
+        if(s_ptr->type == SECTOR_TYPE_BLOCKING) continue;
+        ALLEGRO_COLOR color =
+            interpolate_color(
+                s_ptr->z, lowest_sector_z, highest_sector_z,
+                game.config.aesthetic_radar.lowest_color,
+                game.config.aesthetic_radar.highest_color
+            );
+            
+        for(size_t h = 0; h < s_ptr->hazards.size(); h++) {
+            if(!s_ptr->hazards[h]->associated_liquid) continue;
+            color =
+                interpolate_color(
+                    0.80f, 0.0f, 1.0f,
+                    color, s_ptr->hazards[h]->associated_liquid->radar_color
+                );
+        }
+        
+        for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
+            for(size_t v = 0; v < 3; v++) {
+                ALLEGRO_VERTEX av;
+                av.u = 0;
+                av.v = 0;
+                av.x = s_ptr->triangles[t].points[v]->x;
+                av.y = s_ptr->triangles[t].points[v]->y;
+                av.z = 0;
+                av.color = color;
+                radar_sector_vertexes.push_back(av);
+            }
+        }
+    }
+    
+    if(!radar_sector_vertexes.empty()) {
+        radar_sector_vertex_buffer =
+            al_create_vertex_buffer(
+                nullptr, radar_sector_vertexes.data(),
+                (int) radar_sector_vertexes.size(),
+                ALLEGRO_PRIM_BUFFER_STATIC
+            );
+    }
+    
+    //Edges.
+    radar_edge_points.clear();
+    for(size_t e = 0; e < game.cur_area_data->edges.size(); e++) {
+        Edge* e_ptr = game.cur_area_data->edges[e];
+        
+        if(!e_ptr->sectors[0] || !e_ptr->sectors[1]) {
+            //The other side is already the void, so no need for an edge.
+            continue;
+        }
+        
+        if(
+            fabs(e_ptr->sectors[0]->z - e_ptr->sectors[1]->z) <=
+            GEOMETRY::STEP_HEIGHT
+        ) {
+            //Step.
+            continue;
+        }
+        
+        radar_edge_points.push_back(v2p(e_ptr->vertexes[0]));
+        radar_edge_points.push_back(v2p(e_ptr->vertexes[1]));
+    }
+    radar_edge_vertexes_zoom = 0.0f;
+}
+
+
 /**
  * @brief Calculates the Go Here path from the selected leader to the radar
  * cursor, if applicable, and stores the results in go_here_path and
- * go_here_path_result.
+ * go_here_path_result. The search itself runs in the background, unless
+ * told to wait, and nothing is done if nothing changed since the
+ * latest calculation.
+ *
+ * @param wait If true, the results are ready when this returns.
+ * If false, they may only be ready in a later frame.
  */
-void PauseMenu::calculate_go_here_path() {
+void PauseMenu::calculate_go_here_path(bool wait) {
     radar_cursor_leader = nullptr;
     for(size_t l = 0; l < game.states.gameplay->mobs.leaders.size(); l++) {
         Leader* l_ptr = game.states.gameplay->mobs.leaders[l];
@@ -513,6 +640,13 @@ void PauseMenu::calculate_go_here_path() {
         }
     }
     
+    if(go_here_task_id != 0) {
+        //Only one search at a time, since they share the path manager.
+        if(!wait) return;
+        game.jobs.finish_tasks();
+        check_go_here_task();
+    }
+    
     if(
         !radar_selected_leader ||
         radar_cursor_leader ||
@@ -520,12 +654,14 @@ void PauseMenu::calculate_go_here_path() {
     ) {
         go_here_path.clear();
         go_here_path_result = PATH_RESULT_ERROR;
+        go_here_calc_leader = nullptr;
         return;
     }
     
     if(!radar_selected_leader->fsm.get_event(LEADER_EV_GO_HERE)) {
         go_here_path.clear();
         go_here_path_result = PATH_RESULT_ERROR;
+        go_here_calc_leader = nullptr;
         return;
     }
     
@@ -534,8 +670,20 @@ void PauseMenu::calculate_go_here_path() {
     if(!cursor_sector || cursor_sector->type == SECTOR_TYPE_BLOCKING) {
         go_here_path.clear();
         go_here_path_result = PATH_RESULT_ERROR;
+        go_here_calc_leader = nullptr;
+        return;
+    }
+    
+    if(
+        go_here_calc_leader == radar_selected_leader &&
+        go_here_calc_target == radar_cursor
+    ) {
+        //Nothing changed since the latest calculation. The gameplay is
+        //paused, so the leader and the obstacles haven't either.
         return;
     }
+    go_here_calc_leader = radar_selected_leader;
+    go_here_calc_target = radar_cursor;
     
     PathFollowSettings settings;
     settings.flags =
@@ -545,16 +693,46 @@ void PauseMenu::calculate_go_here_path() {
             radar_selected_leader
         );
         
-    go_here_path_result =
-        get_path(
-            radar_selected_leader->pos,
-            radar_cursor,
-            settings,
-            go_here_path, nullptr, nullptr, nullptr
+    if(wait || game.jobs.get_nr_workers() == 0) {
+        go_here_path_result =
+            get_path(
+                radar_selected_leader->pos,
+                radar_cursor,
+                settings,
+                go_here_path, nullptr, nullptr, nullptr
+            );
+        return;
+    }
+    
+    Point start = radar_selected_leader->pos;
+    Point end = radar_cursor;
+    go_here_task_id =
+        game.jobs.add_task(
+    [this, start, end, settings] () {
+        go_here_task_result =
+            get_path(
+                start, end, settings,
+                go_here_task_path, nullptr, nullptr, nullptr
+            );
+    }
         );
 }
 
 
+/**
+ * @brief Checks if the Go Here path being calculated in the background is
+ * ready, and if so, makes it the current one.
+ */
+void PauseMenu::check_go_here_task() {
+    if(go_here_task_id == 0) return;
+    if(!game.jobs.is_task_done(go_here_task_id)) return;
+    
+    go_here_path.swap(go_here_task_path);
+    go_here_path_result = go_here_task_result;
+    go_here_task_id = 0;
+}
+
+
 /**
  * @brief Either asks the player to confirm if they wish to leave, or leaves
  * outright, based on the player's confirmation question preferences.
@@ -855,69 +1033,30 @@ void PauseMenu::draw_radar(
     //Background fill.
     al_clear_to_color(game.config.aesthetic_radar.background_color);
     
-    //Draw each sector.
-    for(size_t s = 0; s < game.cur_area_data->sectors.size(); s++) {
-        Sector* s_ptr = game.cur_area_data->sectors[s];
-        
-        if(s_ptr->type == SECTOR_TYPE_BLOCKING) continue;
-        ALLEGRO_COLOR color =
-            interpolate_color(
-                s_ptr->z, lowest_sector_z, highest_sector_z,
-                game.config.aesthetic_radar.lowest_color,
-                game.config.aesthetic_radar.highest_color
-            );
-            
-        for(size_t h = 0; h < s_ptr->hazards.size(); h++) {
-            if(!s_ptr->hazards[h]->associated_liquid) continue;
-            color =
-                interpolate_color(
-                    0.80f, 0.0f, 1.0f,
-                    color, s_ptr->hazards[h]->associated_liquid->radar_color
-                );
-        }
-        
-        for(size_t t = 0; t < s_ptr->triangles.size(); t++) {
-            ALLEGRO_VERTEX av[3];
-            for(size_t v = 0; v < 3; v++) {
-                av[v].u = 0;
-                av[v].v = 0;
-                av[v].x = s_ptr->triangles[t].points[v]->x;
-                av[v].y = s_ptr->triangles[t].points[v]->y;
-                av[v].z = 0;
-                av[v].color = color;
-            }
-            
-            al_draw_prim(
-                av, nullptr, nullptr,
-                0, 3, ALLEGRO_PRIM_TRIANGLE_LIST
-            );
-        }
+    //Draw the sectors.
+    if(radar_sector_vertex_buffer) {
+        al_draw_vertex_buffer(
+            radar_sector_vertex_buffer, nullptr,
+            0, (int) radar_sector_vertexes.size(),
+            ALLEGRO_PRIM_TRIANGLE_LIST
+        );
+    } else if(!radar_sector_vertexes.empty()) {
+        al_draw_prim(
+            radar_sector_vertexes.data(), nullptr, nullptr,
+            0, (int) radar_sector_vertexes.size(),
+            ALLEGRO_PRIM_TRIANGLE_LIST
+        );
     }
     
-    //Draw each edge.
-    for(size_t e = 0; e < game.cur_area_data->edges.size(); e++) {
-        Edge* e_ptr = game.cur_area_data->edges[e];
-        
-        if(!e_ptr->sectors[0] || !e_ptr->sectors[1]) {
-            //The other side is already the void, so no need for an edge.
-            continue;
-        }
-        
-        if(
-            fabs(e_ptr->sectors[0]->z - e_ptr->sectors[1]->z) <=
-            GEOMETRY::STEP_HEIGHT
-        ) {
-            //Step.
-            continue;
-        }
-        
-        al_draw_line(
-            e_ptr->vertexes[0]->x,
-            e_ptr->vertexes[0]->y,
-            e_ptr->vertexes[1]->x,
-            e_ptr->vertexes[1]->y,
-            game.config.aesthetic_radar.edge_color,
-            1.5f / radar_cam.zoom
+    //Draw the edges.
+    if(radar_edge_vertexes_zoom != radar_cam.zoom) {
+        build_radar_edge_vertexes();
+    }
+    if(!radar_edge_vertexes.empty()) {
+        al_draw_prim(
+            radar_edge_vertexes.data(), nullptr, nullptr,
+            0, (int) radar_edge_vertexes.size(),
+            ALLEGRO_PRIM_TRIANGLE_LIST
         );
     }
     
@@ -1082,15 +1221,11 @@ void PauseMenu::draw_radar(
     }
     
     //Obstacle icons.
-    unordered_set<Mob*> obstacles;
-    for(const auto &o : game.states.gameplay->path_mgr.obstructions) {
-        obstacles.insert(o.second.begin(), o.second.end());
-    }
-    for(const auto &o : obstacles) {
+    for(const auto &o : game.states.gameplay->path_mgr.obstacle_links) {
         draw_bitmap(
-            bmp_radar_obstacle, o->pos,
+            bmp_radar_obstacle, o.first->pos,
             Point(40.0f / radar_cam.zoom),
-            o->angle
+            o.first->angle
         );
     }
     
@@ -1218,12 +1353,12 @@ void PauseMenu::draw_radar(
     /*
     for(
         size_t cell_x = 0;
-        cell_x < game.states.gameplay->area_active_cells.size();
+        cell_x < game.states.gameplay->nr_area_cell_cols;
         cell_x++
     ) {
         for(
             size_t cell_y = 0;
-            cell_y < game.states.gameplay->area_active_cells[cell_x].size();
+            cell_y < game.states.gameplay->nr_area_cell_rows;
             cell_y++
         ) {
             float start_x =
@@ -1237,7 +1372,7 @@ void PauseMenu::draw_radar(
                 start_y + (1.0f / radar_cam.zoom),
                 start_x + GEOMETRY::AREA_CELL_SIZE - (1.0f / radar_cam.zoom),
                 start_y + GEOMETRY::AREA_CELL_SIZE - (1.0f / radar_cam.zoom),
-                game.states.gameplay->area_active_cells[cell_x][cell_y] ?
+                game.states.gameplay->is_area_cell_active(cell_x, cell_y) ?
                 al_map_rgb(32, 192, 32) :
                 al_map_rgb(192, 32, 32),
                 1.0f / radar_cam.zoom
@@ -2350,12 +2485,11 @@ void PauseMenu::init_radar_page() {
         
         //Draw the text.
         int line_height = al_get_font_line_height(cursor_info_text->font);
-        vector<StringToken> tokens = tokenize_string(cursor_info_text->text);
-        set_string_token_widths(
-            tokens, game.sys_content.fnt_standard, game.sys_content.fnt_slim, line_height, false
-        );
-        vector<vector<StringToken> > tokens_per_line =
-            split_long_string_with_tokens(tokens, draw.size.x);
+        const vector<vector<StringToken> > &tokens_per_line =
+            game.text_layout_cache.get_lines(
+                cursor_info_text->text, game.sys_content.fnt_standard,
+                game.sys_content.fnt_slim, line_height, false, draw.size.x
+            );
         float text_h = tokens_per_line.size() * line_height;
         
         for(size_t l = 0; l < tokens_per_line.size(); l++) {
@@ -2673,7 +2807,7 @@ void PauseMenu::pan_radar(Point amount) {
  * @brief When the player confirms their action in the radar.
  */
 void PauseMenu::radar_confirm() {
-    calculate_go_here_path();
+    calculate_go_here_path(true);
     
     if(radar_cursor_leader) {
         //Select a leader.
@@ -2858,11 +2992,12 @@ void PauseMenu::tick(float delta_t) {
             radar_cursor = radar_cam.pos;
         }
         
+        check_go_here_task();
         go_here_calc_time -= delta_t;
         if(go_here_calc_time <= 0.0f) {
             go_here_calc_time = PAUSE_MENU::GO_HERE_CALC_INTERVAL;
             
-            calculate_go_here_path();
+            calculate_go_here_path(false);
         }
         
     }
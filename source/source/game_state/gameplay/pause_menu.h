@@ -198,6 +198,24 @@ private:
     //Maximum coordinates the radar can pan to.
     Point radar_max_coords;
     
+    //Vertexes of every sector's triangles in the radar, already colored.
+    //The area can't change while paused, so these are only built once.
+    vector<ALLEGRO_VERTEX> radar_sector_vertexes;
+    
+    //Vertex buffer with the radar sector vertexes, if it could be created.
+    ALLEGRO_VERTEX_BUFFER* radar_sector_vertex_buffer = nullptr;
+    
+    //Start and end points of every edge drawn in the radar, one after
+    //the other.
+    vector<Point> radar_edge_points;
+    
+    //Vertexes of the quads that make up the radar edges.
+    vector<ALLEGRO_VERTEX> radar_edge_vertexes;
+    
+    //Radar zoom level the edge vertexes were made for. Edges always have
+    //the same thickness on-screen, so these need remaking if it changes.
+    float radar_edge_vertexes_zoom = 0.0f;
+    
     //Icon for the radar cursor.
     ALLEGRO_BITMAP* bmp_radar_cursor = nullptr;
     
@@ -249,6 +267,22 @@ private:
     //Go Here path result.
     PATH_RESULT go_here_path_result = PATH_RESULT_NOT_CALCULATED;
     
+    //ID of the job calculating a Go Here path in the background.
+    //0 if none. The current path is shown until it's done.
+    size_t go_here_task_id = 0;
+    
+    //Go Here path being calculated in the background.
+    vector<PathStop*> go_here_task_path;
+    
+    //Result of the Go Here path being calculated in the background.
+    PATH_RESULT go_here_task_result = PATH_RESULT_NOT_CALCULATED;
+    
+    //Leader the latest Go Here path was calculated for. nullptr if none.
+    Mob* go_here_calc_leader = nullptr;
+    
+    //Spot the latest Go Here path was calculated towards.
+    Point go_here_calc_target;
+    
     //Pan speed and amount.
     MovementInfo radar_pan;
     
@@ -277,7 +311,10 @@ private:
         const string &lost_text,
         bool is_single, bool is_totals
     );
-    void calculate_go_here_path();
+    void build_radar_edge_vertexes();
+    void build_radar_geometry();
+    void calculate_go_here_path(bool wait);
+    void check_go_here_task();
     void confirm_or_leave();
     ButtonGuiItem* create_page_button(
         PAUSE_MENU_PAGE target_page, bool left, GuiManager* cur_gui
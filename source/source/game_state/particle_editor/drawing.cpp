@@ -15,6 +15,7 @@
 #include "../../content/mob/mob_utils.h"
 #include "../../core/game.h"
 #include "../../util/allegro_utils.h"
+#include "../../util/string_utils.h"
 
 
 /**
@@ -85,29 +86,13 @@ void ParticleEditor::draw_canvas() {
     al_use_transform(&game.world_to_screen_transform);
     
     //Particles.
+    double draw_start = al_get_time();
     vector<WorldComponent> components;
     components.reserve(part_mgr.get_count());
     part_mgr.fill_component_list(components, game.cam.box[0], game.cam.box[1]);
     
-    for(size_t c = 0; c < components.size(); ++c) {
-        components[c].idx = c;
-    }
-    
-    sort(
-        components.begin(), components.end(),
-    [](const WorldComponent & c1, const WorldComponent & c2) -> bool {
-        if(c1.z == c2.z) {
-            return c1.idx < c2.idx;
-        }
-        return c1.z < c2.z;
-    }
-    );
-    for(size_t c = 0; c < components.size(); ++c) {
-        WorldComponent* c_ptr = &components[c];
-        if(c_ptr->particle_ptr) {
-            c_ptr->particle_ptr->draw();
-        }
-    }
+    part_mgr.draw_batch(components, 0, components.size());
+    perf_stats.window_draw_time += al_get_time() - draw_start;
     
     //Grid.
     if(grid_visible) {
@@ -201,7 +186,103 @@ void ParticleEditor::draw_canvas() {
         );
     }
     
+    //Performance overlay.
+    if(perf_stats.visible) {
+        al_use_transform(&game.identity_transform);
+        draw_perf_overlay();
+    }
+    
     //Finish up.
     al_reset_clipping_rectangle();
     al_use_transform(&game.identity_transform);
 }
+
+
+/**
+ * @brief Draws the performance overlay on the top-left corner of the canvas.
+ * The tick and draw times only count the time spent on the CPU.
+ */
+void ParticleEditor::draw_perf_overlay() {
+    const float line_height = 12.0f;
+    const float padding = 4.0f;
+    const ALLEGRO_COLOR normal_color = al_map_rgb(240, 240, 240);
+    const ALLEGRO_COLOR warning_color = al_map_rgb(255, 160, 64);
+    const ALLEGRO_COLOR error_color = al_map_rgb(255, 96, 96);
+    
+    size_t budget = game.options.advanced.max_particles;
+    size_t peak = get_estimated_peak_particles();
+    
+    vector<std::pair<string, ALLEGRO_COLOR> > lines;
+    lines.push_back(
+        std::make_pair(
+            "Particles: " + i2s(part_mgr.get_count()) +
+            " / " + i2s(budget),
+            normal_color
+        )
+    );
+    lines.push_back(
+        std::make_pair(
+            "Emitted/sec: " + f2s(perf_stats.emitted_per_sec),
+            normal_color
+        )
+    );
+    lines.push_back(
+        std::make_pair(
+            "Tick: " + f2s(perf_stats.tick_ms) + " ms",
+            normal_color
+        )
+    );
+    lines.push_back(
+        std::make_pair(
+            "Draw: " + f2s(perf_stats.draw_ms) + " ms",
+            normal_color
+        )
+    );
+    lines.push_back(
+        std::make_pair(
+            "Estimated peak: " + i2s(peak),
+            normal_color
+        )
+    );
+    if(perf_stats.dropped_per_sec > 0.0f) {
+        lines.push_back(
+            std::make_pair(
+                "Dropped/sec: " + f2s(perf_stats.dropped_per_sec),
+                error_color
+            )
+        );
+    }
+    if(peak > budget) {
+        lines.push_back(
+            std::make_pair(
+                "Exceeds the gameplay particle budget!",
+                error_color
+            )
+        );
+    } else if(peak > budget * PARTICLE_EDITOR::PERF_BUDGET_WARNING_RATIO) {
+        lines.push_back(
+            std::make_pair(
+                "Uses a big part of the gameplay particle budget.",
+                warning_color
+            )
+        );
+    }
+    
+    al_draw_filled_rectangle(
+        canvas_tl.x, canvas_tl.y,
+        canvas_tl.x + 300.0f,
+        canvas_tl.y + lines.size() * line_height + padding * 2.0f,
+        al_map_rgba(0, 0, 0, 160)
+    );
+    for(size_t l = 0; l < lines.size(); l++) {
+        draw_text(
+            lines[l].first, game.sys_content.fnt_builtin,
+            Point(
+                canvas_tl.x + padding,
+                canvas_tl.y + padding + l * line_height
+            ),
+            Point(LARGE_FLOAT, line_height), lines[l].second,
+            ALLEGRO_ALIGN_LEFT, V_ALIGN_MODE_TOP
+        );
+    }
+}
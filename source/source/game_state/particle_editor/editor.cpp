@@ -23,6 +23,13 @@ namespace PARTICLE_EDITOR {
 const vector<float> GRID_INTERVALS =
 {4.0f, 8.0f, 16.0f, 32.0f, 64.0f};
 
+//Warn about generators that can use more than this much of the gameplay
+//particle budget on their own.
+const float PERF_BUDGET_WARNING_RATIO = 0.25f;
+
+//How often the performance overlay's numbers are updated, in seconds.
+const float PERF_STATS_INTERVAL = 0.5f;
+
 //Maximum zoom level possible in the editor.
 const float ZOOM_MAX_LEVEL = 64;
 
@@ -79,6 +86,22 @@ ParticleEditor::ParticleEditor() :
 }
 
 
+/**
+ * @brief Returns whether the particle editor can stop drawing until the
+ * player does something.
+ *
+ * @return Whether it can.
+ */
+bool ParticleEditor::can_idle() const {
+    if(!Editor::can_idle()) return false;
+    if(mgr_running && (gen_running || part_mgr.get_count() > 0)) {
+        return false;
+    }
+    if(perf_stats.visible) return false;
+    return true;
+}
+
+
 /**
  * @brief Code to run when the load dialog is closed.
  */
@@ -249,6 +272,10 @@ void ParticleEditor::do_logic() {
     process_gui();
     
     if(mgr_running) {
+        double tick_start = al_get_time();
+        size_t nr_added_before = part_mgr.get_nr_added();
+        size_t nr_dropped_before = part_mgr.get_nr_dropped();
+        
         if(gen_running) {
             loaded_gen.follow_pos_offset =
                 rotate_point(generator_pos_offset, -generator_angle_offset);
@@ -259,7 +286,14 @@ void ParticleEditor::do_logic() {
             }
         }
         part_mgr.tick_all(game.delta_t);
+        
+        perf_stats.window_tick_time += al_get_time() - tick_start;
+        perf_stats.window_emitted +=
+            part_mgr.get_nr_added() - nr_added_before;
+        perf_stats.window_dropped +=
+            part_mgr.get_nr_dropped() - nr_dropped_before;
     }
+    update_perf_stats();
     
     Editor::do_logic_post();
 }
@@ -278,6 +312,31 @@ void ParticleEditor::draw_canvas_imgui_callback(
 }
 
 
+/**
+ * @brief Returns roughly how many particles of the loaded generator can be
+ * alive at the same time, at worst. This assumes the generator
+ * runs non-stop, like it would when attached to a mob.
+ *
+ * @return The amount.
+ */
+size_t ParticleEditor::get_estimated_peak_particles() const {
+    size_t max_number =
+        loaded_gen.emission.number + loaded_gen.emission.number_deviation;
+    if(loaded_gen.emission.interval == 0.0f) return max_number;
+    
+    float max_duration =
+        loaded_gen.base_particle.duration + loaded_gen.duration_deviation;
+    float min_interval =
+        std::max(
+            loaded_gen.emission.interval -
+            loaded_gen.emission.interval_deviation,
+            //Generators can't emit more than once per frame.
+            1.0f / std::max(game.options.advanced.target_fps, 1)
+        );
+    return max_number * (size_t) ceil(max_duration / min_interval);
+}
+
+
 /**
  * @brief Returns some tooltip text that represents a particle generator
  * file's manifest.
@@ -450,20 +509,15 @@ void ParticleEditor::pick_part_gen_file(
 
 
 /**
- * @brief Reloads all loaded particle generators.
+ * @brief Reloads the particle generators that changed on the disk
+ * since they were loaded.
  */
 void ParticleEditor::reload_part_gens() {
-    game.content.unload_all(
+    game.content.reload_changed(
     vector<CONTENT_TYPE> {
         CONTENT_TYPE_PARTICLE_GEN,
     }
     );
-    game.content.load_all(
-    vector<CONTENT_TYPE> {
-        CONTENT_TYPE_PARTICLE_GEN,
-    },
-    CONTENT_LOAD_LEVEL_BASIC
-    );
 }
 
 
@@ -816,3 +870,32 @@ void ParticleEditor::unload() {
     }
     );
 }
+
+
+/**
+ * @brief Updates the numbers shown in the performance overlay, once enough
+ * time has passed since the last update.
+ */
+void ParticleEditor::update_perf_stats() {
+    perf_stats.window_duration += game.delta_t;
+    perf_stats.window_frames++;
+    if(perf_stats.window_duration < PARTICLE_EDITOR::PERF_STATS_INTERVAL) {
+        return;
+    }
+    
+    perf_stats.emitted_per_sec =
+        perf_stats.window_emitted / perf_stats.window_duration;
+    perf_stats.dropped_per_sec =
+        perf_stats.window_dropped / perf_stats.window_duration;
+    perf_stats.tick_ms =
+        perf_stats.window_tick_time * 1000.0 / perf_stats.window_frames;
+    perf_stats.draw_ms =
+        perf_stats.window_draw_time * 1000.0 / perf_stats.window_frames;
+        
+    perf_stats.window_duration = 0.0f;
+    perf_stats.window_frames = 0;
+    perf_stats.window_emitted = 0;
+    perf_stats.window_dropped = 0;
+    perf_stats.window_tick_time = 0.0;
+    perf_stats.window_draw_time = 0.0;
+}
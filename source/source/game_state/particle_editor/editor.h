@@ -17,6 +17,8 @@
 
 namespace PARTICLE_EDITOR {
 extern const vector<float> GRID_INTERVALS;
+extern const float PERF_BUDGET_WARNING_RATIO;
+extern const float PERF_STATS_INTERVAL;
 extern const float ZOOM_MAX_LEVEL;
 extern const float ZOOM_MIN_LEVEL;
 }
@@ -43,6 +45,7 @@ public:
     void load() override;
     void unload() override;
     string get_name() const override;
+    bool can_idle() const override;
     void draw_canvas();
     string get_opened_content_path() const;
     
@@ -132,6 +135,47 @@ private:
         
     } new_dialog;
     
+    struct {
+    
+        //Is the performance overlay visible?
+        bool visible = false;
+        
+        //How long the current sample window has lasted, in seconds.
+        float window_duration = 0.0f;
+        
+        //Frames in the current sample window.
+        size_t window_frames = 0;
+        
+        //Particles emitted in the current sample window.
+        size_t window_emitted = 0;
+        
+        //Particles that had no room, in the current sample window.
+        size_t window_dropped = 0;
+        
+        //Time spent ticking the particles in the current sample window,
+        //in seconds.
+        double window_tick_time = 0.0;
+        
+        //Time spent drawing the particles in the current sample window,
+        //in seconds.
+        double window_draw_time = 0.0;
+        
+        //Particles emitted per second, in the last sample window.
+        float emitted_per_sec = 0.0f;
+        
+        //Particles that had no room per second, in the last sample window.
+        float dropped_per_sec = 0.0f;
+        
+        //Average time spent ticking per frame, in the last sample window,
+        //in milliseconds.
+        float tick_ms = 0.0f;
+        
+        //Average time spent drawing per frame, in the last sample window,
+        //in milliseconds.
+        float draw_ms = 0.0f;
+        
+    } perf_stats;
+    
     
     //--- Function declarations ---
     
@@ -139,6 +183,7 @@ private:
     void close_options_dialog();
     void create_part_gen(const string &part_gen_path);
     void delete_current_part_gen();
+    size_t get_estimated_peak_particles() const;
     string get_file_tooltip(const string &path) const;
     void load_part_gen_file(
         const string &path, const bool should_update_history
@@ -157,6 +202,8 @@ private:
     static void draw_canvas_imgui_callback(
         const ImDrawList* parent_list, const ImDrawCmd* cmd
     );
+    void draw_perf_overlay();
+    void update_perf_stats();
     void grid_interval_decrease_cmd(float input_value);
     void grid_interval_increase_cmd(float input_value);
     void grid_toggle_cmd(float input_value);
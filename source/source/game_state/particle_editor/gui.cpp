@@ -723,6 +723,16 @@ void ParticleEditor::process_gui_panel_generator() {
     set_tooltip(
         "Delete all existing particles.", "D"
     );
+    
+    //Performance overlay checkbox.
+    ImGui::Checkbox("Performance overlay", &perf_stats.visible);
+    set_tooltip(
+        "Show how much the particle system costs, on the canvas.\n"
+        "The estimated peak is how many particles of this generator\n"
+        "can be alive at once, if it keeps emitting. That's compared\n"
+        "against the particle limit in the game's options, which is\n"
+        "shared by everything in the area."
+    );
     ImGui::Unindent();
     
     //Particle generator text.
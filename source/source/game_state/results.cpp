@@ -800,6 +800,12 @@ void Results::load() {
     game.fade_mgr.start_fade(true, nullptr);
     gui.set_selected_item(gui.back_item, true);
     gui_time_spent = 0.0f;
+    
+    //Retrying is the only choice here that goes straight into an area,
+    //so get a head start on it.
+    game.area_preloader.request(
+        game.states.gameplay->path_of_area_to_load, 0.0f
+    );
 }
 
 
@@ -809,6 +815,7 @@ void Results::load() {
  */
 void Results::retry_area() {
     game.fade_mgr.start_fade(false, [] () {
+        game.states.gameplay->retrying = true;
         game.unload_loaded_state(game.states.gameplay);
         game.change_state(game.states.gameplay);
     });
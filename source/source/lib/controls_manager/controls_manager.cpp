@@ -15,53 +15,119 @@
 #include "../analog_stick_cleaner/analog_stick_cleaner.h"
 
 
+/**
+ * @brief Registers a player action type. If one with the same ID already
+ * exists, it gets replaced.
+ *
+ * @param actionType The action type.
+ */
+void ControlsManager::addActionType(const PlayerActionType &actionType) {
+    if(actionType.id < 0) return;
+    if((size_t) actionType.id >= actionTypes.size()) {
+        actionTypes.resize(actionType.id + 1);
+    }
+    actionTypes[actionType.id] = actionType;
+    getActionTypeStatus(actionType.id);
+}
+
+
 /**
  * @brief When a game controller stick input is received, it should be checked
  * with the state of that entire stick to see if it needs to be normalized,
  * deadzones should be applied, etc.
- * The final cleaned stick positions can be found in the cleanSticks variable.
+ * The final cleaned stick positions can be found in the sticks variable.
  *
  * @param input Input to clean.
  */
 void ControlsManager::cleanStick(const PlayerInput &input) {
-    rawSticks[input.source.deviceNr][input.source.stickNr][input.source.axisNr] =
-        input.source.type == INPUT_SOURCE_TYPE_CONTROLLER_AXIS_POS ?
-        input.value :
-        -input.value;
-        
+    int deviceNr = std::max(input.source.deviceNr, 0);
+    int stickNr = std::max(input.source.stickNr, 0);
+    if((size_t) deviceNr >= sticks.size()) {
+        sticks.resize(deviceNr + 1);
+    }
+    if((size_t) stickNr >= sticks[deviceNr].size()) {
+        sticks[deviceNr].resize(stickNr + 1);
+    }
+    StickStatus &stick = sticks[deviceNr][stickNr];
+    
+    if(input.source.axisNr == 0 || input.source.axisNr == 1) {
+        stick.raw[input.source.axisNr] =
+            input.source.type == INPUT_SOURCE_TYPE_CONTROLLER_AXIS_POS ?
+            input.value :
+            -input.value;
+    }
+    
     float coords[2];
-    coords[0] = rawSticks[input.source.deviceNr][input.source.stickNr][0];
-    coords[1] = rawSticks[input.source.deviceNr][input.source.stickNr][1];
+    coords[0] = stick.raw[0];
+    coords[1] = stick.raw[1];
     
     AnalogStickCleaner::Settings cleanupSettings;
     cleanupSettings.deadzones.radial.inner = options.stickMinDeadzone;
     cleanupSettings.deadzones.radial.outer = options.stickMaxDeadzone;
     AnalogStickCleaner::clean(coords, cleanupSettings);
     
-    cleanSticks[input.source.deviceNr][input.source.stickNr][0] = coords[0];
-    cleanSticks[input.source.deviceNr][input.source.stickNr][1] = coords[1];
+    stick.clean[0] = coords[0];
+    stick.clean[1] = coords[1];
 }
 
 
 /**
- * @brief Returns a list of action types that get triggered by the given input.
+ * @brief Returns the status of a player action type, creating it if needed.
  *
- * @param input The input.
- * @return The action types.
+ * @param playerActionTypeId ID of the player action type.
+ * @return The status.
  */
-vector<int> ControlsManager::getActionTypesFromInput(
-    const PlayerInput &input
+ControlsManager::ActionTypeStatus &ControlsManager::getActionTypeStatus(
+    int playerActionTypeId
 ) {
-    vector<int> actionTypes;
-    
-    for(size_t b = 0; b < binds.size(); b++) {
-        const ControlBind &bind = binds[b];
-        if(bind.inputSource == input.source) {
-            actionTypes.push_back(bind.actionTypeId);
-        }
+    if((size_t) playerActionTypeId >= actionTypeStatuses.size()) {
+        actionTypeStatuses.resize(playerActionTypeId + 1);
     }
-    
-    return actionTypes;
+    return actionTypeStatuses[playerActionTypeId];
+}
+
+
+/**
+ * @brief Returns the list of control binds. Because the list can be changed
+ * through this, the manager will update its bind lookup before it next
+ * needs it.
+ *
+ * @return The binds.
+ */
+vector<ControlBind> &ControlsManager::getBinds() {
+    bindIdxsDirty = true;
+    return binds;
+}
+
+
+/**
+ * @brief Returns the list of control binds.
+ *
+ * @return The binds.
+ */
+const vector<ControlBind> &ControlsManager::getBinds() const {
+    return binds;
+}
+
+
+/**
+ * @brief Returns the raw position of a game controller stick's axis,
+ * as last received from the hardware.
+ *
+ * @param deviceNr Number of the game controller.
+ * @param stickNr Number of the stick.
+ * @param axisNr Number of the axis. 0 for X, 1 for Y.
+ * @return The position, or 0 if nothing is known about that axis.
+ */
+float ControlsManager::getRawStickAxis(
+    int deviceNr, int stickNr, int axisNr
+) const {
+    if(deviceNr < 0 || (size_t) deviceNr >= sticks.size()) return 0.0f;
+    if(stickNr < 0 || (size_t) stickNr >= sticks[deviceNr].size()) {
+        return 0.0f;
+    }
+    if(axisNr < 0 || axisNr > 1) return 0.0f;
+    return sticks[deviceNr][stickNr].raw[axisNr];
 }
 
 
@@ -78,20 +144,30 @@ vector<int> ControlsManager::getActionTypesFromInput(
 void ControlsManager::handleCleanInput(
     const PlayerInput &input, bool addDirectly
 ) {
+    if(bindIdxsDirty) rebuildBindIdxs();
+    
     //Find what game action types are bound to this input.
-    vector<int> actionTypes = getActionTypesFromInput(input);
+    auto it = bindIdxsBySource.find(input.source.pack());
+    if(it == bindIdxsBySource.end()) return;
     
-    for(size_t a = 0; a < actionTypes.size(); a++) {
+    for(size_t b = 0; b < it->second.size(); b++) {
+        const ControlBind &bind = binds[it->second[b]];
+        if(!(bind.inputSource == input.source)) {
+            //Two different sources that pack into the same key.
+            continue;
+        }
+        if(bind.actionTypeId < 0) continue;
+        
         if(addDirectly) {
             //Add it to the action queue directly.
             PlayerAction newAction;
-            newAction.actionTypeId = actionTypes[a];
+            newAction.actionTypeId = bind.actionTypeId;
             newAction.value = input.value;
             actionQueue.push_back(newAction);
         } else {
             //Update each game action type's current input state,
             //so we can report them later.
-            actionTypeStatuses[actionTypes[a]].value = input.value;
+            getActionTypeStatus(bind.actionTypeId).value = input.value;
         }
     }
 }
@@ -104,9 +180,13 @@ void ControlsManager::handleCleanInput(
  * @return The value, or 0 on failure.
  */
 float ControlsManager::getValue(int playerActionTypeId) const {
-    auto it = actionTypeStatuses.find(playerActionTypeId);
-    if(it == actionTypeStatuses.end()) return 0.0f;
-    return it->second.value;
+    if(
+        playerActionTypeId < 0 ||
+        (size_t) playerActionTypeId >= actionTypeStatuses.size()
+    ) {
+        return 0.0f;
+    }
+    return actionTypeStatuses[playerActionTypeId].value;
 }
 
 
@@ -130,7 +210,10 @@ void ControlsManager::handleInput(
         //Game controller stick inputs need to be cleaned up first,
         //by implementing deadzone logic.
         cleanStick(input);
-        
+        const StickStatus &stick =
+            sticks[std::max(input.source.deviceNr, 0)]
+            [std::max(input.source.stickNr, 0)];
+            
         //We have to process both axes, so send two clean inputs.
         //But we also need to process imaginary tilts in the opposite direction.
         //If a player goes from walking left to walking right very quickly
@@ -140,28 +223,28 @@ void ControlsManager::handleInput(
         xPosInput.source.type = INPUT_SOURCE_TYPE_CONTROLLER_AXIS_POS;
         xPosInput.source.axisNr = 0;
         xPosInput.value =
-            std::max(0.0f, cleanSticks[input.source.deviceNr][input.source.stickNr][0]);
+            std::max(0.0f, stick.clean[0]);
         handleCleanInput(xPosInput, false);
         
         PlayerInput xNegInput = input;
         xNegInput.source.type = INPUT_SOURCE_TYPE_CONTROLLER_AXIS_NEG;
         xNegInput.source.axisNr = 0;
         xNegInput.value =
-            std::max(0.0f, -cleanSticks[input.source.deviceNr][input.source.stickNr][0]);
+            std::max(0.0f, -stick.clean[0]);
         handleCleanInput(xNegInput, false);
         
         PlayerInput yPosInput = input;
         yPosInput.source.type = INPUT_SOURCE_TYPE_CONTROLLER_AXIS_POS;
         yPosInput.source.axisNr = 1;
         yPosInput.value =
-            std::max(0.0f, cleanSticks[input.source.deviceNr][input.source.stickNr][1]);
+            std::max(0.0f, stick.clean[1]);
         handleCleanInput(yPosInput, false);
         
         PlayerInput yNegInput = input;
         yNegInput.source.type = INPUT_SOURCE_TYPE_CONTROLLER_AXIS_NEG;
         yNegInput.source.axisNr = 1;
         yNegInput.value =
-            std::max(0.0f, -cleanSticks[input.source.deviceNr][input.source.stickNr][1]);
+            std::max(0.0f, -stick.clean[1]);
         handleCleanInput(yNegInput, false);
         
     } else if(
@@ -196,18 +279,19 @@ void ControlsManager::handleInput(
  * @return The actions.
  */
 vector<PlayerAction> ControlsManager::newFrame(float delta_t) {
-    for(auto &a : actionTypeStatuses) {
-        if(a.second.oldValue != a.second.value) {
+    for(size_t a = 0; a < actionTypeStatuses.size(); a++) {
+        ActionTypeStatus &status = actionTypeStatuses[a];
+        if(status.oldValue != status.value) {
             PlayerAction newAction;
-            newAction.actionTypeId = a.first;
-            newAction.value = a.second.value;
+            newAction.actionTypeId = (int) a;
+            newAction.value = status.value;
             actionQueue.push_back(newAction);
         }
     }
     
-    for(auto &a : actionTypeStatuses) {
-        processStateTimers(a, delta_t);
-        processAutoRepeats(a, delta_t);
+    for(size_t a = 0; a < actionTypeStatuses.size(); a++) {
+        processStateTimers(actionTypeStatuses[a], delta_t);
+        processAutoRepeats((int) a, actionTypeStatuses[a], delta_t);
     }
     
     vector<PlayerAction> result;
@@ -216,8 +300,8 @@ vector<PlayerAction> ControlsManager::newFrame(float delta_t) {
     }
     
     //Prepare things for the next frame.
-    for(auto &a : actionTypeStatuses) {
-        a.second.oldValue = a.second.value;
+    for(size_t a = 0; a < actionTypeStatuses.size(); a++) {
+        actionTypeStatuses[a].oldValue = actionTypeStatuses[a].value;
     }
     actionQueue.clear();
     
@@ -228,41 +312,43 @@ vector<PlayerAction> ControlsManager::newFrame(float delta_t) {
 /**
  * @brief Processes logic for auto-repeating player actions.
  *
- * @param it Iterator of the map of action type statuses.
+ * @param actionTypeId ID of the action type.
+ * @param status The action type's status.
  * @param delta_t How much time has passed since the last frame.
  */
 void ControlsManager::processAutoRepeats(
-    std::pair<const int, ActionTypeStatus> &it, float delta_t
+    int actionTypeId, ActionTypeStatus &status, float delta_t
 ) {
-    float actionTypeAutoRepeat = actionTypes[it.first].autoRepeat;
+    if((size_t) actionTypeId >= actionTypes.size()) return;
+    float actionTypeAutoRepeat = actionTypes[actionTypeId].autoRepeat;
     if(actionTypeAutoRepeat == 0.0f) return;
     float autoRepeatFactor =
-        (it.second.value - actionTypeAutoRepeat) /
+        (status.value - actionTypeAutoRepeat) /
         (1.0f - actionTypeAutoRepeat);
     if(autoRepeatFactor <= 0.0f) return;
-    if(it.second.value == 0.0f) return;
-    if(it.second.stateDuration == 0.0f) return;
-    float oldDuration = it.second.stateDuration - delta_t;
-    if(oldDuration >= it.second.nextAutoRepeatActivation) return;
+    if(status.value == 0.0f) return;
+    if(status.stateDuration == 0.0f) return;
+    float oldDuration = status.stateDuration - delta_t;
+    if(oldDuration >= status.nextAutoRepeatActivation) return;
     
-    while(it.second.stateDuration >= it.second.nextAutoRepeatActivation) {
+    while(status.stateDuration >= status.nextAutoRepeatActivation) {
         //Auto-repeat!
         PlayerAction newAction;
-        newAction.actionTypeId = it.first;
-        newAction.value = it.second.value;
+        newAction.actionTypeId = actionTypeId;
+        newAction.value = status.value;
         newAction.flags |= PLAYER_ACTION_FLAG_REPEAT;
         actionQueue.push_back(newAction);
         
         //Set the next activation.
         float currentFrequency =
             options.autoRepeatMaxInterval +
-            (it.second.stateDuration / options.autoRepeatRampTime) *
+            (status.stateDuration / options.autoRepeatRampTime) *
             (options.autoRepeatMinInterval - options.autoRepeatMaxInterval);
         currentFrequency =
             std::max(options.autoRepeatMinInterval, currentFrequency);
         currentFrequency =
             std::min(currentFrequency, options.autoRepeatMaxInterval);
-        it.second.nextAutoRepeatActivation += currentFrequency;
+        status.nextAutoRepeatActivation += currentFrequency;
     }
 }
 
@@ -298,22 +384,34 @@ bool ControlsManager::processInputIgnoring(
 /**
  * @brief Processes the timers for action type states in a frame.
  *
- * @param it Iterator of the map of action type statuses.
+ * @param status The action type's status.
  * @param delta_t How much time has passed since the last frame.
  */
 void ControlsManager::processStateTimers(
-    std::pair<const int, ActionTypeStatus> &it, float delta_t
+    ActionTypeStatus &status, float delta_t
 ) {
-    bool is_active = it.second.value != 0.0f;
-    bool was_active = it.second.oldValue != 0.0f;
+    bool is_active = status.value != 0.0f;
+    bool was_active = status.oldValue != 0.0f;
     if(is_active != was_active) {
         //State changed. Reset the timer.
-        it.second.stateDuration = 0.0f;
-        it.second.nextAutoRepeatActivation = options.autoRepeatMaxInterval;
+        status.stateDuration = 0.0f;
+        status.nextAutoRepeatActivation = options.autoRepeatMaxInterval;
     } else {
         //Same state, increase the timer.
-        it.second.stateDuration += delta_t;
+        status.stateDuration += delta_t;
+    }
+}
+
+
+/**
+ * @brief Rebuilds the lookup of what binds use each input source.
+ */
+void ControlsManager::rebuildBindIdxs() {
+    bindIdxsBySource.clear();
+    for(size_t b = 0; b < binds.size(); b++) {
+        bindIdxsBySource[binds[b].inputSource.pack()].push_back(b);
     }
+    bindIdxsDirty = false;
 }
 
 
@@ -326,7 +424,8 @@ void ControlsManager::processStateTimers(
 void ControlsManager::setValue(int playerActionTypeId, float value) {
     value = std::min(value, 1.0f);
     value = std::max(0.0f, value);
-    actionTypeStatuses[playerActionTypeId].value = value;
+    if(playerActionTypeId < 0) return;
+    getActionTypeStatus(playerActionTypeId).value = value;
 }
 
 
@@ -363,3 +462,21 @@ bool PlayerInputSource::operator==(const PlayerInputSource &s2) const {
         stickNr == s2.stickNr &&
         axisNr == s2.axisNr;
 }
+
+
+/**
+ * @brief Packs the input source's information into a single number,
+ * so it can be used as a key in hash tables. Different sources can
+ * end up with the same number if their numbers are too big, so users
+ * must still compare the sources themselves.
+ *
+ * @return The packed number.
+ */
+uint64_t PlayerInputSource::pack() const {
+    return
+        ((uint64_t) (type & 0xFF) << 56) |
+        ((uint64_t) (deviceNr & 0xFF) << 48) |
+        ((uint64_t) (stickNr & 0xFF) << 40) |
+        ((uint64_t) (axisNr & 0xFF) << 32) |
+        (uint64_t) (uint32_t) buttonNr;
+}
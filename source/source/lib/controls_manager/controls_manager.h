@@ -13,11 +13,13 @@
 #include <map>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 using std::map;
 using std::string;
 using std::tuple;
+using std::unordered_map;
 using std::vector;
 
 
@@ -98,6 +100,7 @@ struct PlayerInputSource {
     //--- Function declarations ---
     
     bool operator==(const PlayerInputSource &s2) const;
+    uint64_t pack() const;
     
 };
 
@@ -244,17 +247,26 @@ struct ControlsManager {
         
     };
     
+    /**
+     * @brief Information about a game controller stick's current state.
+     */
+    struct StickStatus {
+    
+        //--- Members ---
+        
+        //Raw position, as received from the hardware. X and Y.
+        float raw[2] = { 0.0f, 0.0f };
+        
+        //Clean position, after normalization and deadzones. X and Y.
+        float clean[2] = { 0.0f, 0.0f };
+        
+    };
+    
     
 public:
 
     //--- Members ---
     
-    //Map of all registered player action types.
-    map<int, PlayerActionType> actionTypes;
-    
-    //Control binds.
-    vector<ControlBind> binds;
-    
     //Are we ignoring player actions right now?
     bool ignoringActions = false;
     
@@ -264,6 +276,10 @@ public:
     
     //--- Function declarations ---
     
+    void addActionType(const PlayerActionType &actionType);
+    vector<ControlBind> &getBinds();
+    const vector<ControlBind> &getBinds() const;
+    float getRawStickAxis(int deviceNr, int stickNr, int axisNr) const;
     float getValue(int playerActionTypeId) const;
     void handleInput(const PlayerInput &input);
     void startIgnoringInputSource(const PlayerInputSource &inputSource);
@@ -275,17 +291,28 @@ private:
 
     //--- Members ---
     
-    //Status of each player action type.
-    map<int, ActionTypeStatus> actionTypeStatuses;
+    //All registered player action types, indexed by ID.
+    vector<PlayerActionType> actionTypes;
+    
+    //Status of each player action type, indexed by ID.
+    vector<ActionTypeStatus> actionTypeStatuses;
+    
+    //Control binds.
+    vector<ControlBind> binds;
+    
+    //Indexes of the binds that use each input source, keyed by the
+    //packed input source. Rebuilt whenever the binds may have changed.
+    unordered_map<uint64_t, vector<size_t> > bindIdxsBySource;
+    
+    //Do the bind indexes need to be rebuilt before they're used?
+    bool bindIdxsDirty = true;
     
     //Queue of actions the game needs to handle this frame.
     vector<PlayerAction> actionQueue;
     
-    //Raw state of each game controller stick.
-    map<int, map<int, map<int, float> > > rawSticks;
-    
-    //Clean state of each game controller stick.
-    map<int, map<int, map<int, float> > > cleanSticks;
+    //State of each game controller stick, indexed by device number,
+    //and then by stick number.
+    vector<vector<StickStatus> > sticks;
     
     //Input sources currently being ignored.
     vector<PlayerInputSource> ignoredInputSources;
@@ -294,15 +321,12 @@ private:
     //--- Function declarations ---
     
     void cleanStick(const PlayerInput &input);
-    vector<int> getActionTypesFromInput(
-        const PlayerInput &input
-    );
+    ActionTypeStatus &getActionTypeStatus(int playerActionTypeId);
     void handleCleanInput(const PlayerInput &input, bool addDirectly);
     void processAutoRepeats(
-        std::pair<const int, ActionTypeStatus> &it, float delta_t
+        int actionTypeId, ActionTypeStatus &status, float delta_t
     );
     bool processInputIgnoring(const PlayerInput &input);
-    void processStateTimers(
-        std::pair<const int, ActionTypeStatus> &it, float delta_t
-    );
+    void processStateTimers(ActionTypeStatus &status, float delta_t);
+    void rebuildBindIdxs();
 };
@@ -8,7 +8,9 @@
  */
 
 #undef _CMATH_
+#include <cstdint>
 #include <fstream>
+#include <unordered_map>
 
 #include <allegro5/allegro.h>
 
@@ -22,12 +24,27 @@ using std::vector;
 
 namespace DATA_FILE {
 
+//Flag for compiled data files, meaning only the root's children have values.
+const unsigned char COMPILED_FLAG_NAMES_ONLY_AFTER_ROOT = 1 << 1;
+
+//Flag for compiled data files, meaning the values were trimmed.
+const unsigned char COMPILED_FLAG_TRIM_VALUES = 1 << 0;
+
+//Compiled data files start with these bytes.
+const string COMPILED_MAGIC_NUMBER = "PDNC";
+
+//Version of the compiled data file format. Bump this whenever it changes.
+const unsigned char COMPILED_VERSION = 2;
+
 //When encrypting, this is the lowest ASCII value that can be affected.
 const unsigned char ENCRYPTION_MIN_VALUE = 32; //Space character.
 
 //When encrypting, rotate the character values forward by this amount.
 const unsigned char ENCRYPTION_ROT_AMOUNT = 111;
 
+//When loading a text file, read this many bytes at a time.
+const size_t LOAD_CHUNK_SIZE = 64 * 1024;
+
 //If a file starts with these bytes, then it's UTF-8.
 const string UTF8_MAGIC_NUMBER = "\xEF\xBB\xBF";
 
@@ -64,6 +81,26 @@ DataNode::DataNode(const DataNode &dn2) :
 }
 
 
+/**
+ * @brief Constructs a new data node object by taking over the data and
+ * the children of another node. The other node is left empty.
+ *
+ * @param dn2 The node to take the data from.
+ */
+DataNode::DataNode(DataNode &&dn2) noexcept :
+    name(std::move(dn2.name)),
+    value(std::move(dn2.value)),
+    fileWasOpened(dn2.fileWasOpened),
+    filePath(std::move(dn2.filePath)),
+    lineNr(dn2.lineNr),
+    children(std::move(dn2.children)),
+    dummyChildren(std::move(dn2.dummyChildren)) {
+    
+    dn2.children.clear();
+    dn2.dummyChildren.clear();
+}
+
+
 /**
  * @brief Constructs a new data node object from a file, given the file name.
  *
@@ -124,6 +161,28 @@ DataNode* DataNode::addNew(const string& name, const string& value) {
 }
 
 
+/**
+ * @brief Assigns part of a string to another string, without the spaces
+ * and tabs at the start and end of that part.
+ *
+ * @param out String to assign to.
+ * @param s String with the part.
+ * @param start Start of the part.
+ * @param end End of the part (exclusive).
+ */
+void DataNode::assignTrimmed(
+    string &out, const string &s, size_t start, size_t end
+) {
+    while(start < end && (s[start] == ' ' || s[start] == '\t')) {
+        start++;
+    }
+    while(end > start && (s[end - 1] == ' ' || s[end - 1] == '\t')) {
+        end--;
+    }
+    out.assign(s, start, end - start);
+}
+
+
 /**
  * @brief Clears the data inside a node.
  */
@@ -162,6 +221,29 @@ DataNode* DataNode::createDummy() {
 }
 
 
+/**
+ * @brief "Decrypts" a whole buffer for loading an encrypted data file.
+ * This gives the same results as calling decryptChar() on every character,
+ * but goes through a lookup table that is only built once.
+ *
+ * @param data Buffer to decrypt in-place.
+ * @param size Size of the buffer.
+ */
+void DataNode::decryptBuffer(char* data, size_t size) {
+    static const vector<unsigned char> table = [] () {
+        vector<unsigned char> result(256);
+        for(size_t c = 0; c < 256; c++) {
+            result[c] = decryptChar((unsigned char) c);
+        }
+        return result;
+    }();
+    
+    for(size_t c = 0; c < size; c++) {
+        data[c] = (char) table[(unsigned char) data[c]];
+    }
+}
+
+
 /**
  * @brief "Decrypts" a character for loading an encrypted data file.
  *
@@ -223,68 +305,6 @@ void DataNode::encryptString(string &s) {
 }
 
 
-/**
- * @brief Like an std::getline(), but for ALLEGRO_FILE*.
- *
- * @param file Allegro file handle.
- * @param line String to save the line into.
- * @param encrypted If true, the document is encrypted and needs decrypting.
- */
-void DataNode::getline(
-    ALLEGRO_FILE* file, string &line, bool encrypted
-) {
-    line.clear();
-    if(!file) {
-        return;
-    }
-    
-    size_t bytesRead;
-    char* cPtr = new char;
-    
-    bytesRead = al_fread(file, cPtr, 1);
-    while(bytesRead > 0) {
-        unsigned char c = *((unsigned char*) cPtr);
-        
-        if(encrypted) {
-            c = decryptChar(c);
-        }
-        
-        if(c == '\r') {
-            //Let's check if the next character is a \n. If so, they should
-            //both be consumed by al_fread().
-            bytesRead = al_fread(file, cPtr, 1);
-            unsigned char peekC = *((unsigned char*) cPtr);
-            if(encrypted) {
-                peekC = decryptChar(peekC);
-            }
-            if(bytesRead > 0) {
-                if(peekC == '\n') {
-                    //Yep. Done.
-                    break;
-                } else {
-                    //Oops, we're reading an entirely new line. Let's go back.
-                    al_fseek(file, -1, ALLEGRO_SEEK_CUR);
-                    break;
-                }
-            }
-            
-        } else if(c == '\n') {
-            //Standard line break.
-            break;
-            
-        } else {
-            //Line content.
-            line.push_back(c);
-            
-        }
-        
-        bytesRead = al_fread(file, cPtr, 1);
-    }
-    
-    delete cPtr;
-}
-
-
 /**
  * @brief Returns a child node given its number on the list
  * (direct children only).
@@ -327,6 +347,43 @@ DataNode* DataNode::getChildByName(
 }
 
 
+/**
+ * @brief Obtains the size of a file and a hash of its contents (FNV-1a).
+ * The file is read with the current Allegro file interface, so this also
+ * works for files inside of archives.
+ *
+ * @param filePath Path to the file.
+ * @param outSize The size is returned here.
+ * @param outHash The hash is returned here.
+ * @return Whether the file could be read.
+ */
+bool DataNode::getFileHash(
+    const string &filePath, uint64_t* outSize, uint64_t* outHash
+) {
+    ALLEGRO_FILE* file = al_fopen(filePath.c_str(), "rb");
+    if(!file) return false;
+    
+    uint64_t size = 0;
+    uint64_t hash = 14695981039346656037ULL;
+    vector<unsigned char> chunk(DATA_FILE::LOAD_CHUNK_SIZE);
+    while(true) {
+        size_t chunkSize = al_fread(file, chunk.data(), chunk.size());
+        if(chunkSize == 0) break;
+        for(size_t c = 0; c < chunkSize; c++) {
+            hash ^= chunk[c];
+            hash *= 1099511628211ULL;
+        }
+        size += chunkSize;
+    }
+    bool ok = !al_ferror(file);
+    al_fclose(file);
+    
+    *outSize = size;
+    *outHash = hash;
+    return ok;
+}
+
+
 /**
  * @brief Returns the number of children nodes (direct children only).
  *
@@ -366,6 +423,99 @@ string DataNode::getValueOrDefault(const string &def) const {
 }
 
 
+/**
+ * @brief Loads data from a compiled data file, which is a binary copy of
+ * the tree that was obtained from a text file. This is much faster than
+ * parsing the text file again. If the compiled file is missing, broken,
+ * or out of date compared to the text file, nothing is loaded.
+ *
+ * @param compiledFilePath Path to the compiled file.
+ * @param sourceFilePath Path to the text file it was compiled from.
+ * @param trimValues Whether the text file is meant to be loaded with
+ * its values trimmed. See loadFile().
+ * @param namesOnlyAfterRoot Whether the text file is meant to be loaded
+ * with names only after the root. See loadFile().
+ * @return Whether it succeeded.
+ */
+bool DataNode::loadCompiledFile(
+    const string &compiledFilePath, const string &sourceFilePath,
+    bool trimValues, bool namesOnlyAfterRoot
+) {
+    clear();
+    
+    uint64_t sourceSize = 0;
+    uint64_t sourceHash = 0;
+    if(!getFileHash(sourceFilePath, &sourceSize, &sourceHash)) {
+        return false;
+    }
+    
+    //Read the whole thing at once.
+    ALLEGRO_FILE* file = al_fopen(compiledFilePath.c_str(), "rb");
+    if(!file) return false;
+    int64_t fileSize = al_fsize(file);
+    string data;
+    if(fileSize > 0) {
+        data.resize((size_t) fileSize);
+        data.resize(al_fread(file, &data[0], data.size()));
+    }
+    al_fclose(file);
+    
+    //Check the header.
+    size_t pos = DATA_FILE::COMPILED_MAGIC_NUMBER.size();
+    if(
+        data.size() < pos ||
+        data.compare(0, pos, DATA_FILE::COMPILED_MAGIC_NUMBER) != 0
+    ) {
+        return false;
+    }
+    
+    unsigned char flags =
+        (trimValues ? DATA_FILE::COMPILED_FLAG_TRIM_VALUES : 0) |
+        (
+            namesOnlyAfterRoot ?
+            DATA_FILE::COMPILED_FLAG_NAMES_ONLY_AFTER_ROOT : 0
+        );
+    uint64_t version, fileFlags, fileSourceSize, fileSourceHash;
+    if(
+        !readCompiledNumber(data, pos, 1, &version) ||
+        !readCompiledNumber(data, pos, 1, &fileFlags) ||
+        !readCompiledNumber(data, pos, 8, &fileSourceSize) ||
+        !readCompiledNumber(data, pos, 8, &fileSourceHash)
+    ) {
+        return false;
+    }
+    if(
+        version != DATA_FILE::COMPILED_VERSION ||
+        fileFlags != flags ||
+        fileSourceSize != sourceSize ||
+        fileSourceHash != sourceHash
+    ) {
+        return false;
+    }
+    
+    //String table.
+    uint64_t nrStrings;
+    if(!readCompiledNumber(data, pos, 4, &nrStrings)) return false;
+    vector<string> strings;
+    for(uint64_t s = 0; s < nrStrings; s++) {
+        uint64_t length;
+        if(!readCompiledNumber(data, pos, 4, &length)) return false;
+        if(length > data.size() - pos) return false;
+        strings.push_back(data.substr(pos, (size_t) length));
+        pos += (size_t) length;
+    }
+    
+    //The nodes.
+    fileWasOpened = true;
+    filePath = sourceFilePath;
+    if(!readCompiledNode(data, pos, strings) || pos != data.size()) {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+
 /**
  * @brief Loads data from a file.
  *
@@ -382,140 +532,124 @@ void DataNode::loadFile(
     const string &filePath, bool trimValues,
     bool namesOnlyAfterRoot, bool encrypted
 ) {
-    vector<string> lines;
-    
+    children.clear();
     fileWasOpened = false;
     this->filePath = filePath;
     
     ALLEGRO_FILE* file = al_fopen(filePath.c_str(), "r");
-    if(file) {
-        bool isFirstLine = true;
-        fileWasOpened = true;
-        string line;
-        while(!al_feof(file)) {
-            getline(file, line, encrypted);
+    if(!file) return;
+    fileWasOpened = true;
+    
+    //The file is read in chunks, and each line is parsed as soon as
+    //it's complete, so the whole file never needs to be in memory.
+    vector<DataNode*> openNodes;
+    openNodes.push_back(this);
+    vector<char> chunk(DATA_FILE::LOAD_CHUNK_SIZE);
+    string line;
+    size_t curLineNr = 1;
+    bool isFirstChunk = true;
+    bool lastWasCR = false;
+    bool done = false;
+    
+    while(!done) {
+        size_t chunkSize = al_fread(file, chunk.data(), chunk.size());
+        if(chunkSize == 0) break;
+        if(encrypted) decryptBuffer(chunk.data(), chunkSize);
+        
+        size_t c = 0;
+        if(isFirstChunk && !encrypted) {
+            //Let's just check if it starts with the UTF-8 Magic Number.
+            if(
+                chunkSize >= DATA_FILE::UTF8_MAGIC_NUMBER.size() &&
+                DATA_FILE::UTF8_MAGIC_NUMBER.compare(
+                    0, DATA_FILE::UTF8_MAGIC_NUMBER.size(),
+                    chunk.data(), DATA_FILE::UTF8_MAGIC_NUMBER.size()
+                ) == 0
+            ) {
+                c = DATA_FILE::UTF8_MAGIC_NUMBER.size();
+            }
+        }
+        isFirstChunk = false;
+        
+        for(; c < chunkSize && !done; c++) {
+            unsigned char ch = (unsigned char) chunk[c];
             
-            if(isFirstLine && !encrypted) {
-                //Let's just check if it starts with the UTF-8 Magic Number.
-                if(
-                    line.size() >= 3 &&
-                    line.substr(0, 3) == DATA_FILE::UTF8_MAGIC_NUMBER
-                ) {
-                    line = line.erase(0, 3);
-                }
+            if(ch == '\n' && lastWasCR) {
+                //The second half of a \r\n line break.
+                lastWasCR = false;
+                continue;
+            }
+            lastWasCR = (ch == '\r');
+            
+            if(ch == '\r' || ch == '\n') {
+                done =
+                    !parseLine(
+                        line, curLineNr, openNodes,
+                        trimValues, namesOnlyAfterRoot
+                    );
+                line.clear();
+                curLineNr++;
+            } else {
+                line.push_back(ch);
             }
-            lines.push_back(line);
-            isFirstLine = false;
         }
-        al_fclose(file);
     }
     
-    loadNode(lines, trimValues, 0, 0, namesOnlyAfterRoot);
+    if(!done) {
+        parseLine(
+            line, curLineNr, openNodes, trimValues, namesOnlyAfterRoot
+        );
+    }
+    
+    al_fclose(file);
 }
 
 
 /**
- * @brief Loads data from a list of text lines.
+ * @brief Loads data from a text file, but if there's an up-to-date compiled
+ * copy of it, loads that instead, since it's faster. If not, the text
+ * file is parsed, and a compiled copy is saved for next time.
+ * Encrypted files aren't supported, since their compiled copy
+ * could be read by anyone.
  *
- * @param lines Text lines that make up the node.
+ * @param filePath Path to the text file.
+ * @param compiledFilePath Path to the compiled copy.
  * @param trimValues If true, spaces before and after the value will
  * be trimmed off.
- * @param startLine This node starts at this line of the document.
- * @param depth Depth of this node. 0 means root.
  * @param namesOnlyAfterRoot If true, any nodes that are not in the
  * root node (i.e. they are children of some node inside the file)
  * will only have a name and no value; the entire contents of their
  * line will be their name.
- * @return Returns the number of the line this node ended on,
- * judging by startLine. This is used for the recursion.
  */
-size_t DataNode::loadNode(
-    const vector<string> &lines, bool trimValues,
-    size_t startLine, size_t depth,
-    bool namesOnlyAfterRoot
+void DataNode::loadFileWithCache(
+    const string &filePath, const string &compiledFilePath,
+    bool trimValues, bool namesOnlyAfterRoot
 ) {
-    children.clear();
+    if(
+        loadCompiledFile(
+            compiledFilePath, filePath, trimValues, namesOnlyAfterRoot
+        )
+    ) {
+        return;
+    }
     
-    if(startLine >= lines.size()) return startLine;
+    //Get the hash before reading, so that if the file changes while
+    //it's being read, the compiled copy is considered outdated next time.
+    uint64_t sourceSize = 0;
+    uint64_t sourceHash = 0;
+    bool hasHash = getFileHash(filePath, &sourceSize, &sourceHash);
     
-    bool returningFromSubNode = false;
+    loadFile(filePath, trimValues, namesOnlyAfterRoot);
     
-    for(size_t l = startLine; l < lines.size(); l++) {
-        string line = lines[l];
-        
-        line = trimSpaces(line, true); //Removes the leftmost spaces.
-        
-        if(line.empty()) continue;
-        
-        if(line.size() >= 2) {
-            if(line[0] == '/' && line[1] == '/') {
-                //A comment; ignore this line.
-                continue;
-            }
-        }
-        
-        //Sub-node end.
-        size_t pos = line.find('}');
-        if(pos != string::npos) {
-            if(returningFromSubNode) {
-                //The sub-node just ended.
-                //Let's leave what's after the bracket, and let the rest
-                //of the code make use of it.
-                returningFromSubNode = false;
-                line = line.substr(pos + 1, line.size() - (pos + 1));
-                line = trimSpaces(line, true);
-                if(line.empty()) continue;
-            } else {
-                return l;
-            }
-        }
-        
-        //Sub-node start.
-        pos = line.find('{');
-        if(pos != string::npos) {
-        
-            DataNode* newChild = new DataNode();
-            newChild->name = trimSpaces(line.substr(0, pos));
-            newChild->value.clear();
-            newChild->fileWasOpened = fileWasOpened;
-            newChild->filePath = filePath;
-            newChild->lineNr = l + 1;
-            l =
-                newChild->loadNode(
-                    lines, trimValues, l + 1, depth + 1, namesOnlyAfterRoot
-                );
-            l--; //So the block-ending line gets re-examined.
-            children.push_back(newChild);
-            
-            returningFromSubNode = true;
-            continue;
-        }
-        
-        //Option=value.
-        pos = line.find('=');
-        string n, v;
-        if(
-            (!namesOnlyAfterRoot || depth == 0) &&
-            pos != string::npos && pos > 0 && line.size() > 2
-        ) {
-            n = line.substr(0, pos);
-            v = line.substr(pos + 1, line.size() - (pos + 1));
-        } else {
-            n = line;
-        }
-        if(trimValues) v = trimSpaces(v);
-        
-        DataNode* newChild = new DataNode();
-        newChild->name = trimSpaces(n);
-        newChild->value = v;
-        newChild->fileWasOpened = fileWasOpened;
-        newChild->filePath = filePath;
-        newChild->lineNr = l + 1;
-        children.push_back(newChild);
-        
+    if(fileWasOpened && hasHash) {
+        unsigned char flags =
+            (trimValues ? DATA_FILE::COMPILED_FLAG_TRIM_VALUES : 0) |
+            (
+                namesOnlyAfterRoot ?
+                DATA_FILE::COMPILED_FLAG_NAMES_ONLY_AFTER_ROOT : 0
+            );
+        writeCompiledFile(compiledFilePath, flags, sourceSize, sourceHash);
     }
-    
-    return lines.size() - 1;
 }
 
 
@@ -547,6 +681,180 @@ DataNode &DataNode::operator=(const DataNode &dn2) {
 }
 
 
+/**
+ * @brief Takes over the data and the children of another node, destroying
+ * the current ones. The other node is left empty.
+ *
+ * @param dn2 The node to take the data from.
+ * @return The current object.
+ */
+DataNode &DataNode::operator=(DataNode &&dn2) noexcept {
+    if(this != &dn2) {
+        clear();
+        
+        name = std::move(dn2.name);
+        value = std::move(dn2.value);
+        fileWasOpened = dn2.fileWasOpened;
+        filePath = std::move(dn2.filePath);
+        lineNr = dn2.lineNr;
+        children = std::move(dn2.children);
+        dummyChildren = std::move(dn2.dummyChildren);
+        dn2.children.clear();
+        dn2.dummyChildren.clear();
+    }
+    
+    return *this;
+}
+
+
+/**
+ * @brief Parses a line of a text file, adding nodes to the tree as needed.
+ * Empty lines and comments are ignored, a line with "{" opens a block,
+ * a line with "}" closes one, and any other line is an option,
+ * like "name = value".
+ *
+ * @param line The line's text.
+ * @param lineNr Number of the line in the file.
+ * @param openNodes Nodes whose blocks are still open, from the root
+ * to the innermost one. This gets updated as blocks start and end.
+ * @param trimValues If true, spaces before and after the value will
+ * be trimmed off.
+ * @param namesOnlyAfterRoot If true, any nodes that are not in the
+ * root node will only have a name and no value.
+ * @return Whether the rest of the file should still be parsed. This is false
+ * if the line closes a block that was never opened.
+ */
+bool DataNode::parseLine(
+    const string &line, size_t lineNr, vector<DataNode*> &openNodes,
+    bool trimValues, bool namesOnlyAfterRoot
+) {
+    //Skip the leftmost spaces.
+    size_t start = 0;
+    size_t end = line.size();
+    while(start < end && (line[start] == ' ' || line[start] == '\t')) {
+        start++;
+    }
+    
+    if(start == end) return true;
+    
+    if(end - start >= 2 && line[start] == '/' && line[start + 1] == '/') {
+        //A comment; ignore this line.
+        return true;
+    }
+    
+    //Sub-node end.
+    size_t pos = line.find('}', start);
+    if(pos != string::npos) {
+        if(openNodes.size() == 1) return false;
+        
+        //Let's leave what's after the bracket, and let the rest
+        //of the code make use of it.
+        openNodes.pop_back();
+        start = pos + 1;
+        while(start < end && (line[start] == ' ' || line[start] == '\t')) {
+            start++;
+        }
+        if(start == end) return true;
+    }
+    
+    DataNode* parent = openNodes.back();
+    DataNode* newChild = new DataNode();
+    newChild->fileWasOpened = parent->fileWasOpened;
+    newChild->filePath = parent->filePath;
+    newChild->lineNr = lineNr;
+    parent->children.push_back(newChild);
+    
+    //Sub-node start.
+    pos = line.find('{', start);
+    if(pos != string::npos) {
+        assignTrimmed(newChild->name, line, start, pos);
+        openNodes.push_back(newChild);
+        return true;
+    }
+    
+    //Option=value.
+    pos = line.find('=', start);
+    if(
+        (!namesOnlyAfterRoot || openNodes.size() == 1) &&
+        pos != string::npos && pos > start && end - start > 2
+    ) {
+        assignTrimmed(newChild->name, line, start, pos);
+        if(trimValues) {
+            assignTrimmed(newChild->value, line, pos + 1, end);
+        } else {
+            newChild->value.assign(line, pos + 1, end - (pos + 1));
+        }
+    } else {
+        assignTrimmed(newChild->name, line, start, end);
+    }
+    
+    return true;
+}
+
+
+/**
+ * @brief Reads a node, and all of its children, from the data
+ * of a compiled file.
+ *
+ * @param data The compiled file's data.
+ * @param pos Position to read from. This is moved forward.
+ * @param strings The compiled file's string table.
+ * @return Whether it succeeded.
+ */
+bool DataNode::readCompiledNode(
+    const string &data, size_t &pos, const vector<string> &strings
+) {
+    uint64_t nameIdx, valueIdx, line, nrChildren;
+    if(
+        !readCompiledNumber(data, pos, 4, &nameIdx) ||
+        !readCompiledNumber(data, pos, 4, &valueIdx) ||
+        !readCompiledNumber(data, pos, 4, &line) ||
+        !readCompiledNumber(data, pos, 4, &nrChildren)
+    ) {
+        return false;
+    }
+    if(nameIdx >= strings.size() || valueIdx >= strings.size()) {
+        return false;
+    }
+    
+    name = strings[nameIdx];
+    value = strings[valueIdx];
+    lineNr = (size_t) line;
+    
+    for(uint64_t c = 0; c < nrChildren; c++) {
+        DataNode* newChild = new DataNode();
+        newChild->fileWasOpened = fileWasOpened;
+        newChild->filePath = filePath;
+        children.push_back(newChild);
+        if(!newChild->readCompiledNode(data, pos, strings)) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Reads a little-endian unsigned number from the data
+ * of a compiled file.
+ *
+ * @param data The compiled file's data.
+ * @param pos Position to read from. This is moved forward.
+ * @param nrBytes How many bytes the number takes up.
+ * @param outNumber The number is returned here.
+ * @return Whether it succeeded, i.e. whether there was enough data.
+ */
+bool DataNode::readCompiledNumber(
+    const string &data, size_t &pos, size_t nrBytes, uint64_t* outNumber
+) {
+    if(nrBytes > data.size() - pos) return false;
+    *outNumber = 0;
+    for(size_t b = 0; b < nrBytes; b++) {
+        *outNumber |= (uint64_t) (unsigned char) data[pos + b] << (b * 8);
+    }
+    pos += nrBytes;
+    return true;
+}
+
+
 /**
  * @brief Removes and destroys a child from the list.
  *
@@ -565,6 +873,39 @@ bool DataNode::remove(DataNode* nodeToRemove) {
 }
 
 
+/**
+ * @brief Saves the node into a compiled data file, which can later be read
+ * with loadCompiledFile() a lot faster than the text file. The compiled
+ * file will only be considered valid as long as the text file doesn't change.
+ *
+ * @param compiledFilePath Path to the compiled file to save to.
+ * @param sourceFilePath Path to the text file this node was loaded from.
+ * @param trimValues Whether the text file was loaded with its
+ * values trimmed.
+ * @param namesOnlyAfterRoot Whether the text file was loaded with
+ * names only after the root.
+ * @return Whether it succeeded.
+ */
+bool DataNode::saveCompiledFile(
+    const string &compiledFilePath, const string &sourceFilePath,
+    bool trimValues, bool namesOnlyAfterRoot
+) const {
+    uint64_t sourceSize = 0;
+    uint64_t sourceHash = 0;
+    if(!getFileHash(sourceFilePath, &sourceSize, &sourceHash)) {
+        return false;
+    }
+    unsigned char flags =
+        (trimValues ? DATA_FILE::COMPILED_FLAG_TRIM_VALUES : 0) |
+        (
+            namesOnlyAfterRoot ?
+            DATA_FILE::COMPILED_FLAG_NAMES_ONLY_AFTER_ROOT : 0
+        );
+    return
+        writeCompiledFile(compiledFilePath, flags, sourceSize, sourceHash);
+}
+
+
 /**
  * @brief Saves a node into a new text file. Line numbers are ignored.
  * If you don't provide a file name, it'll use the node's file name.
@@ -662,35 +1003,209 @@ void DataNode::saveNode(
 
 
 /**
- * @brief Removes all trailing and preceding spaces.
- * This means space and tab characters before and after the 'middle' characters.
+ * @brief Writes the node into a compiled data file.
+ * The file starts with a header, followed by a table with every
+ * unique string, followed by every node in depth-first order, each
+ * with the index of its name and value in the table, its line number,
+ * and its number of children.
  *
- * @param s The original string.
- * @param leftOnly If true, only trim the spaces at the left.
- * @return The trimmed string.
+ * @param compiledFilePath Path to the compiled file to save to.
+ * @param flags Flags about how the text file was loaded.
+ * @param sourceSize Size of the text file.
+ * @param sourceHash Hash of the text file's contents.
+ * @return Whether it succeeded.
  */
-string DataNode::trimSpaces(const string &s, bool leftOnly) {
-    string orig = s;
-    //Spaces before.
-    if(orig.size()) {
-        while(orig[0] == ' ' || orig[0] == '\t') {
-            orig.erase(0, 1);
-            if(orig.empty()) break;
+bool DataNode::writeCompiledFile(
+    const string &compiledFilePath, unsigned char flags,
+    uint64_t sourceSize, uint64_t sourceHash
+) const {
+    std::unordered_map<string, uint32_t> stringIdxs;
+    vector<const string*> strings;
+    string nodeData;
+    writeCompiledNode(nodeData, stringIdxs, strings);
+    
+    string data = DATA_FILE::COMPILED_MAGIC_NUMBER;
+    writeCompiledNumber(data, DATA_FILE::COMPILED_VERSION, 1);
+    writeCompiledNumber(data, flags, 1);
+    writeCompiledNumber(data, sourceSize, 8);
+    writeCompiledNumber(data, sourceHash, 8);
+    writeCompiledNumber(data, strings.size(), 4);
+    for(size_t s = 0; s < strings.size(); s++) {
+        writeCompiledNumber(data, strings[s]->size(), 4);
+        data += *strings[s];
+    }
+    data += nodeData;
+    
+    //Create any missing folders.
+    size_t nextSlashPos = compiledFilePath.find('/', 0);
+    while(nextSlashPos != string::npos) {
+        string pathSoFar = compiledFilePath.substr(0, nextSlashPos);
+        if(!al_make_directory(pathSoFar.c_str())) {
+            return false;
         }
+        nextSlashPos = compiledFilePath.find('/', nextSlashPos + 1);
     }
     
-    if(!leftOnly) {
-        //Spaces after.
-        if(orig.size()) {
-            while(
-                orig[orig.size() - 1] == ' ' ||
-                orig[orig.size() - 1] == '\t'
-            ) {
-                orig.erase(orig.size() - 1, 1);
-                if(orig.empty()) break;
-            }
+    ALLEGRO_FILE* file = al_fopen(compiledFilePath.c_str(), "wb");
+    if(!file) return false;
+    size_t written = al_fwrite(file, data.c_str(), data.size());
+    al_fclose(file);
+    return written == data.size();
+}
+
+
+/**
+ * @brief Writes a node, and all of its children, into the node data
+ * of a compiled file.
+ *
+ * @param nodeData Node data to write to.
+ * @param stringIdxs Index of each string in the string table, by string.
+ * New strings are added here.
+ * @param strings String table. New strings are added here.
+ */
+void DataNode::writeCompiledNode(
+    string &nodeData, std::unordered_map<string, uint32_t> &stringIdxs,
+    vector<const string*> &strings
+) const {
+    const string* nodeStrings[2] = { &name, &value };
+    for(size_t s = 0; s < 2; s++) {
+        auto it =
+            stringIdxs.emplace(*nodeStrings[s], (uint32_t) strings.size());
+        if(it.second) strings.push_back(nodeStrings[s]);
+        writeCompiledNumber(nodeData, it.first->second, 4);
+    }
+    writeCompiledNumber(nodeData, lineNr, 4);
+    writeCompiledNumber(nodeData, children.size(), 4);
+    
+    for(size_t c = 0; c < children.size(); c++) {
+        children[c]->writeCompiledNode(nodeData, stringIdxs, strings);
+    }
+}
+
+
+/**
+ * @brief Writes a little-endian unsigned number into the data
+ * of a compiled file.
+ *
+ * @param data Data to write to.
+ * @param number Number to write.
+ * @param nrBytes How many bytes the number takes up.
+ */
+void DataNode::writeCompiledNumber(
+    string &data, uint64_t number, size_t nrBytes
+) {
+    for(size_t b = 0; b < nrBytes; b++) {
+        data.push_back((char) ((number >> (b * 8)) & 0xFF));
+    }
+}
+
+
+/**
+ * @brief Constructs a new data node writer object.
+ *
+ * @param includeEmptyValues If true, even nodes with an empty value
+ * will be saved.
+ */
+DataNodeWriter::DataNodeWriter(bool includeEmptyValues) :
+    includeEmptyValues(includeEmptyValues) {
+    
+}
+
+
+/**
+ * @brief Writes a node with a value, inside the current node.
+ *
+ * @param name Name of the node.
+ * @param value Its value.
+ */
+void DataNodeWriter::addValue(const string &name, const string &value) {
+    openParentBlock();
+    text.append(openNodesHaveChildren.size(), '\t');
+    text += name;
+    if(!value.empty() || includeEmptyValues) {
+        text += '=';
+        text += value;
+    }
+    text += '\n';
+}
+
+
+/**
+ * @brief Begins a node that can have children, inside the current node.
+ * Every node that gets begun needs to be ended with endNode().
+ *
+ * @param name Name of the node.
+ */
+void DataNodeWriter::beginNode(const string &name) {
+    openParentBlock();
+    text.append(openNodesHaveChildren.size(), '\t');
+    text += name;
+    openNodesHaveChildren.push_back(false);
+}
+
+
+/**
+ * @brief Ends the node that was begun last.
+ */
+void DataNodeWriter::endNode() {
+    if(openNodesHaveChildren.empty()) return;
+    
+    bool hadChildren = openNodesHaveChildren.back();
+    openNodesHaveChildren.pop_back();
+    if(hadChildren) {
+        text.append(openNodesHaveChildren.size(), '\t');
+        text += '}';
+    } else if(includeEmptyValues) {
+        text += '=';
+    }
+    text += '\n';
+}
+
+
+/**
+ * @brief Returns the text written so far.
+ *
+ * @return The text.
+ */
+const string &DataNodeWriter::getText() const {
+    return text;
+}
+
+
+/**
+ * @brief If the current node's block isn't open yet, because this is
+ * its first child, opens it.
+ */
+void DataNodeWriter::openParentBlock() {
+    if(openNodesHaveChildren.empty()) return;
+    if(openNodesHaveChildren.back()) return;
+    text += "{\n";
+    openNodesHaveChildren.back() = true;
+}
+
+
+/**
+ * @brief Saves the text written so far into a text file,
+ * in one go.
+ *
+ * @param destinationFilePath Path to the file to save to.
+ * @return Whether it succeded.
+ */
+bool DataNodeWriter::saveFile(const string &destinationFilePath) const {
+    //Create any missing folders.
+    size_t nextSlashPos = destinationFilePath.find('/', 0);
+    while(nextSlashPos != string::npos) {
+        string pathSoFar = destinationFilePath.substr(0, nextSlashPos);
+        if(!al_make_directory(pathSoFar.c_str())) {
+            return false;
         }
+        nextSlashPos = destinationFilePath.find('/', nextSlashPos + 1);
     }
     
-    return orig;
+    //Save the file.
+    ALLEGRO_FILE* file = al_fopen(destinationFilePath.c_str(), "w");
+    if(!file) return false;
+    size_t written = al_fwrite(file, text.c_str(), text.size());
+    al_fclose(file);
+    return written == text.size();
 }
@@ -43,7 +43,9 @@
 
 #include <allegro5/allegro.h>
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -52,8 +54,13 @@ using std::vector;
 
 
 namespace DATA_FILE {
+extern const unsigned char COMPILED_FLAG_NAMES_ONLY_AFTER_ROOT;
+extern const unsigned char COMPILED_FLAG_TRIM_VALUES;
+extern const string COMPILED_MAGIC_NUMBER;
+extern const unsigned char COMPILED_VERSION;
 extern const unsigned char ENCRYPTION_MIN_VALUE;
 extern const unsigned char ENCRYPTION_ROT_AMOUNT;
+extern const size_t LOAD_CHUNK_SIZE;
 extern const string UTF8_MAGIC_NUMBER;
 }
 
@@ -91,7 +98,9 @@ public:
     explicit DataNode(const string &file_path);
     DataNode(const string &name, const string &value);
     DataNode(const DataNode &dn2);
+    DataNode(DataNode &&dn2) noexcept;
     DataNode &operator=(const DataNode &dn2);
+    DataNode &operator=(DataNode &&dn2) noexcept;
     ~DataNode();
     void clear();
     string getValueOrDefault(const string &def) const;
@@ -104,17 +113,24 @@ public:
     size_t add(DataNode* new_node);
     DataNode* addNew(const string& name, const string& value = "");
     bool remove(DataNode* node_to_remove);
+    bool loadCompiledFile(
+        const string &compiledFilePath, const string &sourceFilePath,
+        bool trimValues = true, bool namesOnlyAfterRoot = false
+    );
     void loadFile(
         const string &file_path,
         bool trim_values = true,
         bool namesOnlyAfterRoot = false,
         bool encrypted = false
     );
-    size_t loadNode(
-        const vector<string> &lines, bool trim_values,
-        size_t start_line = 0, size_t depth = 0,
-        bool namesOnlyAfterRoot = false
+    void loadFileWithCache(
+        const string &filePath, const string &compiledFilePath,
+        bool trimValues = true, bool namesOnlyAfterRoot = false
     );
+    bool saveCompiledFile(
+        const string &compiledFilePath, const string &sourceFilePath,
+        bool trimValues = true, bool namesOnlyAfterRoot = false
+    ) const;
     bool saveFile(
         string destination_file_path = "", bool childrenOnly = true,
         bool include_empty_values = false,
@@ -139,13 +155,79 @@ private:
     
     //--- Function declarations ---
     
+    static void assignTrimmed(
+        string &out, const string &s, size_t start, size_t end
+    );
     DataNode* createDummy();
+    static void decryptBuffer(char* data, size_t size);
     static unsigned char decryptChar(unsigned char c);
     static unsigned char encryptChar(unsigned char c);
     static void encryptString(string &s);
-    static void getline(
-        ALLEGRO_FILE* file, string &line, bool encrypted = false
+    static bool getFileHash(
+        const string &filePath, uint64_t* outSize, uint64_t* outHash
+    );
+    static bool parseLine(
+        const string &line, size_t lineNr, vector<DataNode*> &openNodes,
+        bool trimValues, bool namesOnlyAfterRoot
+    );
+    bool readCompiledNode(
+        const string &data, size_t &pos, const vector<string> &strings
+    );
+    static bool readCompiledNumber(
+        const string &data, size_t &pos, size_t nrBytes, uint64_t* outNumber
+    );
+    bool writeCompiledFile(
+        const string &compiledFilePath, unsigned char flags,
+        uint64_t sourceSize, uint64_t sourceHash
+    ) const;
+    void writeCompiledNode(
+        string &nodeData, std::unordered_map<string, uint32_t> &stringIdxs,
+        vector<const string*> &strings
+    ) const;
+    static void writeCompiledNumber(
+        string &data, uint64_t number, size_t nrBytes
     );
-    static string trimSpaces(const string &s, bool leftOnly = false);
+    
+};
+
+
+/**
+ * @brief Writes data file text one node at a time, straight into a buffer,
+ * without building a tree of data nodes first. The text comes out exactly
+ * the same as saving an equivalent tree with DataNode::saveFile() would
+ * give, with only the root's children being saved.
+ */
+class DataNodeWriter {
+
+public:
+
+    //--- Function declarations ---
+    
+    explicit DataNodeWriter(bool includeEmptyValues = false);
+    void addValue(const string &name, const string &value);
+    void beginNode(const string &name);
+    void endNode();
+    const string &getText() const;
+    bool saveFile(const string &destinationFilePath) const;
+    
+private:
+
+    //--- Members ---
+    
+    //Text written so far.
+    string text;
+    
+    //For each node that was begun but not ended yet, from outermost to
+    //innermost, whether it has children so far. Its block only gets
+    //opened once the first child comes in.
+    vector<bool> openNodesHaveChildren;
+    
+    //If true, even nodes with an empty value get "=" written.
+    bool includeEmptyValues = false;
+    
+    
+    //--- Function declarations ---
+    
+    void openParentBlock();
     
 };
@@ -8,25 +8,53 @@
  * Program start and main loop.
  */
 
+#include <cstdio>
+
 #include "core/game.h"
+#include "util/archive_utils.h"
+#include "util/general_utils.h"
 
 
 /**
  * @brief Main function. It calls the game class's functions to initialize
- * and run the game.
+ * and run the game, or run the logic benchmark, if requested. It can also
+ * just write a pack's folder into an archive.
  *
- * @param argc Command line argument count. Unused.
- * @param argv Command line argument values. Unused.
+ * @param argc Command line argument count.
+ * @param argv Command line argument values.
  * @return 0 if everything went well, or an error number otherwise.
  */
 int main(int argc, char** argv) {
     game = Game();
     
+    if(argc == 3 && string(argv[1]) == "--write-pack-archive") {
+        string folder_path = standardize_path(argv[2]);
+        string archive_path =
+            folder_path + "." + FILE_ARCHIVE_EXTENSION;
+        if(!al_init() || !write_file_archive(folder_path, archive_path)) {
+            fprintf(
+                stderr, "Could not write the archive \"%s\".\n",
+                archive_path.c_str()
+            );
+            return 1;
+        }
+        return 0;
+    }
+    
+    game.benchmark.parse_args(argc, argv);
+    game.headless = game.benchmark.enabled;
+    
     int game_start_result = game.start();
     if(game_start_result != 0) {
         return game_start_result;
     }
     
+    if(game.benchmark.enabled) {
+        int benchmark_result = game.benchmark.run();
+        game.shutdown();
+        return benchmark_result;
+    }
+    
     game.main_loop();
     
     game.shutdown();
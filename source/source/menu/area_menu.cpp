@@ -35,6 +35,9 @@ const string INFO_GUI_FILE_NAME = "area_menu_info";
 //How long to animate the page swapping for.
 const float PAGE_SWAP_DURATION = 0.5f;
 
+//Once an area has been selected for this long, start preloading it.
+const float PRELOAD_DELAY = 0.5f;
+
 //Path to the mission specs GUI information file.
 const string SPECS_GUI_FILE_NAME = "area_menu_specs";
 
@@ -151,6 +154,9 @@ void AreaMenu::change_info(size_t area_idx) {
     
     //Fill in the area's info.
     Area* area_ptr = game.content.areas.list[area_type][area_idx];
+    game.area_preloader.request(
+        area_ptr->manifest->path, AREA_MENU::PRELOAD_DELAY
+    );
     info_name_text->text = area_ptr->name;
     subtitle_text->text =
         get_subtitle_or_mission_goal(
@@ -190,7 +196,7 @@ void AreaMenu::change_info(size_t area_idx) {
         (area_ptr->maker.empty() ? "" : "Maker: " + area_ptr->maker);
     version_text->text =
         (area_ptr->version.empty() ? "" : "Version: " + area_ptr->version);
-    cur_thumb = area_ptr->thumbnail.get();
+    cur_thumb = game.content.areas.get_thumbnail(area_ptr);
     if(area_type == AREA_TYPE_MISSION) {
         int score = area_records[area_idx].score;
         bool record_exists = !area_records[area_idx].date.empty();
@@ -412,7 +418,9 @@ void AreaMenu::init_gui_info_page() {
                 (draw.center.y - draw.size.y / 2.0f) + final_size.y / 2.0f
             );
             if(cur_thumb) {
-                draw_bitmap(cur_thumb, final_center, final_size - 4.0f);
+                draw_bitmap(
+                    cur_thumb.get(), final_center, final_size - 4.0f
+                );
             }
             draw_textured_box(
                 final_center, final_size, game.sys_content.bmp_frame_box,
@@ -600,6 +608,7 @@ void AreaMenu::init_gui_main() {
             [this, a] () { change_info(a); };
             area_button->on_get_tooltip =
             [area_ptr] () { return "Play " + area_ptr->name + "."; };
+            area_button->cache_drawing = true;
             list_box->add_child(area_button);
             gui.add_item(area_button);
             area_buttons.push_back(area_button);
@@ -25,6 +25,7 @@ namespace AREA_MENU {
 extern const string GUI_FILE_NAME;
 extern const string INFO_GUI_FILE_NAME;
 extern const float PAGE_SWAP_DURATION;
+extern const float PRELOAD_DELAY;
 extern const string SPECS_GUI_FILE_NAME;
 }
 
@@ -85,7 +86,7 @@ private:
     TextGuiItem* subtitle_text = nullptr;
     
     //Thumbnail of the currently selected area.
-    ALLEGRO_BITMAP* cur_thumb = nullptr;
+    std::shared_ptr<ALLEGRO_BITMAP> cur_thumb = nullptr;
     
     //Description text item.
     TextGuiItem* description_text = nullptr;
@@ -40,17 +40,14 @@ void HelpMenu::draw_tidbit(
     const ALLEGRO_FONT* const font, const Point &where,
     const Point &max_size, const string &text
 ) {
-    //Get the tokens that make up the tidbit.
-    vector<StringToken> tokens = tokenize_string(text);
-    if(tokens.empty()) return;
-    
     int line_height = al_get_font_line_height(font);
     
-    set_string_token_widths(tokens, font, game.sys_content.fnt_slim, line_height, true);
-    
-    //Split long lines.
-    vector<vector<StringToken> > tokens_per_line =
-        split_long_string_with_tokens(tokens, max_size.x);
+    //Get the tokens that make up the tidbit, split into lines.
+    const vector<vector<StringToken> > &tokens_per_line =
+        game.text_layout_cache.get_lines(
+            text, font, game.sys_content.fnt_slim, line_height, true,
+            max_size.x
+        );
         
     if(tokens_per_line.empty()) return;
     
@@ -247,6 +244,13 @@ void HelpMenu::init_gui_main(DataNode* gui_file) {
     
     //Tidbit list box.
     tidbit_list = new ListGuiItem();
+    tidbit_list->on_create_virtual_row = [] () {
+        BulletGuiItem* tidbit_bullet =
+            new BulletGuiItem("", game.sys_content.fnt_standard);
+        tidbit_bullet->ratio_center.x = 0.50f;
+        tidbit_bullet->ratio_size.x = 1.0f;
+        return tidbit_bullet;
+    };
     gui.add_item(tidbit_list, "list");
     
     //Tidbit list scrollbar.
@@ -319,28 +323,28 @@ void HelpMenu::populate_tidbits(const HELP_CATEGORY category) {
     }
     }
     
-    tidbit_list->delete_all_children();
-    
-    for(size_t t = 0; t < category_tidbits.size(); t++) {
-        Tidbit* t_ptr = &category_tidbits[t];
-        BulletGuiItem* tidbit_bullet =
-            new BulletGuiItem(
-            t_ptr->name,
-            game.sys_content.fnt_standard
-        );
-        tidbit_bullet->ratio_center = Point(0.50f, 0.045f + t * 0.10f);
-        tidbit_bullet->ratio_size = Point(1.0f, 0.09f);
-        tidbit_bullet->on_get_tooltip = [this, t_ptr] () {
+    //Only the rows in view get a GUI item, so long categories stay cheap.
+    tidbit_list->on_fill_virtual_row =
+    [this, &category_tidbits] (GuiItem * item, size_t row_idx) {
+        Tidbit* t_ptr = &category_tidbits[row_idx];
+        BulletGuiItem* tidbit_bullet = (BulletGuiItem*) item;
+        tidbit_bullet->text = t_ptr->name;
+        tidbit_bullet->on_get_tooltip = [t_ptr] () {
             return t_ptr->description;
         };
         tidbit_bullet->on_selected = [this, t_ptr] () {
             cur_tidbit = t_ptr;
         };
+    };
+    tidbit_list->nr_virtual_rows = category_tidbits.size();
+    tidbit_list->refresh_virtual_rows();
+    
+    for(size_t t = 0; t < category_tidbits.size(); t++) {
+        GuiItem* tidbit_bullet = tidbit_list->get_virtual_row_item(t);
+        if(!tidbit_bullet) continue;
         tidbit_bullet->start_juice_animation(
             GuiItem::JUICE_TYPE_GROW_TEXT_MEDIUM
         );
-        tidbit_list->add_child(tidbit_bullet);
-        gui.add_item(tidbit_bullet);
     }
     
     category_text->start_juice_animation(
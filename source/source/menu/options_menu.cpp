@@ -572,6 +572,7 @@ void OptionsMenu::init_gui_graphics_page() {
     graphics_gui.register_coords("header",          50, 10,   50,  6);
     graphics_gui.register_coords("fullscreen",      50, 25,   70, 10);
     graphics_gui.register_coords("resolution",      50, 42.5, 70, 10);
+    graphics_gui.register_coords("render_scale",    50, 60,   70, 10);
     graphics_gui.register_coords("tooltip",         50, 96,   96,  4);
     graphics_gui.register_coords("restart_warning", 50, 85,   70,  6);
     graphics_gui.read_coords(
@@ -659,6 +660,23 @@ void OptionsMenu::init_gui_graphics_page() {
     resolution_picker->init();
     graphics_gui.add_item(resolution_picker, "resolution");
     
+    //Render scale picker.
+    render_scale_picker =
+        new OptionsMenuPickerGuiItem<float>(
+        "Render scale: ",
+        &game.options.graphics.render_scale,
+        OPTIONS::GRAPHICS_D::RENDER_SCALE,
+    {0.5f, 0.75f, 1.0f},
+    {"50%", "75%", "100%"},
+    "Draw the area at a lower resolution, for slower graphics cards. "
+    "The HUD stays sharp."
+    );
+    render_scale_picker->value_to_string = [] (float v) {
+        return f2s(v * 100.0f) + "%";
+    };
+    render_scale_picker->init();
+    graphics_gui.add_item(render_scale_picker, "render_scale");
+    
     //Warning text.
     warning_text =
         new TextGuiItem(
@@ -1200,6 +1218,7 @@ void OptionsMenu::populate_binds() {
                 );
             section_text->ratio_size =
                 Point(0.50f, OPTIONS_MENU::BIND_BUTTON_HEIGHT);
+            section_text->cache_drawing = true;
             binds_list_box->add_child(section_text);
             binds_gui.add_item(section_text);
             
@@ -1222,12 +1241,14 @@ void OptionsMenu::populate_binds() {
             Point(0.34f, OPTIONS_MENU::BIND_BUTTON_HEIGHT);
         name_bullet->on_get_tooltip =
         [action_type] () { return action_type.description; };
+        name_bullet->cache_drawing = true;
         binds_list_box->add_child(name_bullet);
         binds_gui.add_item(name_bullet);
         
         //More button.
         ButtonGuiItem* more_button =
             new ButtonGuiItem("...", game.sys_content.fnt_standard);
+        more_button->cache_drawing = true;
         more_button->on_activate =
         [this, action_type] (const Point &) {
             if(showing_binds_more && action_type.id == cur_action_type) {
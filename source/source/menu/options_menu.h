@@ -257,6 +257,9 @@ private:
     //Resolution picker widget.
     OptionsMenuPickerGuiItem<std::pair<int, int> >* resolution_picker = nullptr;
     
+    //Render scale picker widget.
+    OptionsMenuPickerGuiItem<float>* render_scale_picker = nullptr;
+    
     //Cursor speed picker widget.
     OptionsMenuPickerGuiItem<float>* cursor_speed_picker = nullptr;
     
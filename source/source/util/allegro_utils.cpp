@@ -18,6 +18,7 @@
 #include "allegro_utils.h"
 
 #include "../core/misc_functions.h"
+#include "archive_utils.h"
 #include "general_utils.h"
 #include "math_utils.h"
 #include "string_utils.h"
@@ -53,6 +54,35 @@ bool operator!=(const ALLEGRO_COLOR &c1, const ALLEGRO_COLOR &c2) {
 }
 
 
+/**
+ * @brief Checks if two transformations are the same.
+ *
+ * @param t1 First transformation.
+ * @param t2 Second transformation.
+ * @return Whether they are the same.
+ */
+bool operator==(const ALLEGRO_TRANSFORM &t1, const ALLEGRO_TRANSFORM &t2) {
+    for(unsigned char r = 0; r < 4; r++) {
+        for(unsigned char c = 0; c < 4; c++) {
+            if(t1.m[r][c] != t2.m[r][c]) return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Checks if two transformations are different.
+ *
+ * @param t1 First transformation.
+ * @param t2 Second transformation.
+ * @return Whether they are different.
+ */
+bool operator!=(const ALLEGRO_TRANSFORM &t1, const ALLEGRO_TRANSFORM &t2) {
+    return !operator==(t1, t2);
+}
+
+
 /**
  * @brief Calls al_fwrite, but with an std::string instead of a c-string.
  *
@@ -150,6 +180,13 @@ FS_DELETE_RESULT delete_file(const string &file_path) {
  * @return Whether it exists.
  */
 bool file_exists(const string &path) {
+    string rel_path;
+    const FileArchive* archive = find_file_archive(path, &rel_path);
+    if(archive) {
+        const unsigned char* data;
+        size_t size;
+        return archive->get_file(rel_path, &data, &size);
+    }
     return al_filename_exists(path.c_str());
 }
 
@@ -161,6 +198,13 @@ bool file_exists(const string &path) {
  * @return Whether it exists.
  */
 bool folder_exists(const string &path) {
+    string rel_path;
+    const FileArchive* archive = find_file_archive(path, &rel_path);
+    if(archive) {
+        vector<string> names;
+        return archive->get_folder(rel_path, true, &names);
+    }
+    
     bool result = true;
     ALLEGRO_FS_ENTRY* fs_entry = al_create_fs_entry(path.c_str());
     if(!fs_entry || !al_open_directory(fs_entry)) {
@@ -194,6 +238,15 @@ vector<string> folder_to_vector(
     //Normalize the folder's path.
     folder_path = standardize_path(folder_path);
     
+    //Read it from a mounted archive, if it's inside one.
+    string rel_path;
+    const FileArchive* archive = find_file_archive(folder_path, &rel_path);
+    if(archive) {
+        bool found = archive->get_folder(rel_path, folders, &v);
+        if(out_folder_found) *out_folder_found = found;
+        return v;
+    }
+    
     ALLEGRO_FS_ENTRY* folder =
         al_create_fs_entry(folder_path.c_str());
     if(!folder || !al_open_directory(folder)) {
@@ -226,6 +279,16 @@ vector<string> folder_to_vector(
     al_close_directory(folder);
     al_destroy_fs_entry(folder);
     
+    //Mounted archives look like subfolders.
+    if(folders) {
+        vector<string> mount_names = get_file_archive_mount_names(folder_path);
+        for(size_t m = 0; m < mount_names.size(); m++) {
+            if(std::find(v.begin(), v.end(), mount_names[m]) == v.end()) {
+                v.push_back(mount_names[m]);
+            }
+        }
+    }
+    
     
     sort(v.begin(), v.end(), [] (const string  &s1, const string  &s2) -> bool {
         return str_to_lower(s1) < str_to_lower(s2);
@@ -65,6 +65,8 @@ enum FS_DELETE_RESULT {
 
 bool operator==(const ALLEGRO_COLOR &c1, const ALLEGRO_COLOR &c2);
 bool operator!=(const ALLEGRO_COLOR &c1, const ALLEGRO_COLOR &c2);
+bool operator==(const ALLEGRO_TRANSFORM &t1, const ALLEGRO_TRANSFORM &t2);
+bool operator!=(const ALLEGRO_TRANSFORM &t1, const ALLEGRO_TRANSFORM &t2);
 void al_fwrite(ALLEGRO_FILE* f, const string &s);
 string c2s(const ALLEGRO_COLOR &c);
 ALLEGRO_COLOR change_alpha(const ALLEGRO_COLOR &c, unsigned char a);
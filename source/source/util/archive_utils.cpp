@@ -0,0 +1,791 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Single-file archives of folders, and the Allegro file interface that
+ * reads from them.
+ * These don't contain logic specific to the Pikifen project.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include <allegro5/allegro.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif //#if defined(_WIN32)
+
+#include "archive_utils.h"
+
+#include "allegro_utils.h"
+#include "general_utils.h"
+#include "string_utils.h"
+
+
+namespace {
+
+/**
+ * @brief An open file, as handed to Allegro by the archive file interface.
+ * It either reads from an archive, or passes everything on to a file
+ * on the disk.
+ */
+struct ArchiveFileHandle {
+
+    //--- Members ---
+    
+    //Contents of the file in the archive, or nullptr if it's on the disk.
+    const unsigned char* data = nullptr;
+    
+    //Size of the file in the archive.
+    size_t size = 0;
+    
+    //Current reading position in the file in the archive.
+    size_t pos = 0;
+    
+    //Whether a read went past the end of the file in the archive.
+    bool eof = false;
+    
+    //File on the disk, if it's not in an archive.
+    ALLEGRO_FILE* disk_file = nullptr;
+    
+};
+
+
+//Archives currently mounted, and the folder paths they're mounted on.
+vector<std::pair<string, FileArchive*> > archive_mounts;
+
+//Controls access to the list of mounts, since background threads look
+//things up in it while packs can get mounted.
+std::mutex archive_mounts_mutex;
+
+//File interface for files that aren't in any archive.
+const ALLEGRO_FILE_INTERFACE* disk_file_interface = nullptr;
+
+
+/**
+ * @brief Reads a little-endian 32-bit number from the archive's index.
+ *
+ * @param data Data to read from.
+ * @param data_size Size of the data.
+ * @param pos Position to read at. This is moved past the number.
+ * @param out_value The number is returned here.
+ * @return Whether there were enough bytes left.
+ */
+bool read_archive_u32(
+    const unsigned char* data, size_t data_size, size_t &pos,
+    uint32_t* out_value
+) {
+    if(data_size - pos < 4) return false;
+    *out_value =
+        (uint32_t) data[pos] |
+        ((uint32_t) data[pos + 1] << 8) |
+        ((uint32_t) data[pos + 2] << 16) |
+        ((uint32_t) data[pos + 3] << 24);
+    pos += 4;
+    return true;
+}
+
+
+/**
+ * @brief Reads a little-endian 64-bit number from the archive's index.
+ *
+ * @param data Data to read from.
+ * @param data_size Size of the data.
+ * @param pos Position to read at. This is moved past the number.
+ * @param out_value The number is returned here.
+ * @return Whether there were enough bytes left.
+ */
+bool read_archive_u64(
+    const unsigned char* data, size_t data_size, size_t &pos,
+    uint64_t* out_value
+) {
+    uint32_t low;
+    uint32_t high;
+    if(!read_archive_u32(data, data_size, pos, &low)) return false;
+    if(!read_archive_u32(data, data_size, pos, &high)) return false;
+    *out_value = (uint64_t) low | ((uint64_t) high << 32);
+    return true;
+}
+
+
+/**
+ * @brief Opens a file, for Allegro. If it's inside a mounted archive,
+ * it's read from there, otherwise it's opened from the disk.
+ *
+ * @param path Path to the file.
+ * @param mode Allegro file mode.
+ * @return The handle, or nullptr on failure.
+ */
+void* archive_fopen(const char* path, const char* mode) {
+    string rel_path;
+    const FileArchive* archive = find_file_archive(path, &rel_path);
+    bool read_only =
+        !strchr(mode, 'w') && !strchr(mode, 'a') && !strchr(mode, '+');
+    
+    if(archive && read_only) {
+        const unsigned char* data;
+        size_t size;
+        if(!archive->get_file(rel_path, &data, &size)) return nullptr;
+        ArchiveFileHandle* handle = new ArchiveFileHandle();
+        handle->data = data;
+        handle->size = size;
+        return handle;
+    }
+    
+    ALLEGRO_FILE* disk_file =
+        al_fopen_interface(disk_file_interface, path, mode);
+    if(!disk_file) return nullptr;
+    ArchiveFileHandle* handle = new ArchiveFileHandle();
+    handle->disk_file = disk_file;
+    return handle;
+}
+
+
+/**
+ * @brief Closes a file, for Allegro.
+ *
+ * @param f File to close.
+ * @return Whether it succeeded.
+ */
+bool archive_fclose(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    bool result = true;
+    if(handle->disk_file) result = al_fclose(handle->disk_file);
+    delete handle;
+    return result;
+}
+
+
+/**
+ * @brief Reads from a file, for Allegro.
+ *
+ * @param f File to read from.
+ * @param ptr Buffer to read into.
+ * @param size How many bytes to read.
+ * @return How many bytes were read.
+ */
+size_t archive_fread(ALLEGRO_FILE* f, void* ptr, size_t size) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_fread(handle->disk_file, ptr, size);
+    
+    size_t amount = std::min(size, handle->size - handle->pos);
+    memcpy(ptr, handle->data + handle->pos, amount);
+    handle->pos += amount;
+    if(amount < size) handle->eof = true;
+    return amount;
+}
+
+
+/**
+ * @brief Writes to a file, for Allegro. Files in archives can't be
+ * written to.
+ *
+ * @param f File to write to.
+ * @param ptr Buffer to write from.
+ * @param size How many bytes to write.
+ * @return How many bytes were written.
+ */
+size_t archive_fwrite(ALLEGRO_FILE* f, const void* ptr, size_t size) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_fwrite(handle->disk_file, ptr, size);
+    return 0;
+}
+
+
+/**
+ * @brief Flushes a file, for Allegro.
+ *
+ * @param f File to flush.
+ * @return Whether it succeeded.
+ */
+bool archive_fflush(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_fflush(handle->disk_file);
+    return true;
+}
+
+
+/**
+ * @brief Returns the reading position in a file, for Allegro.
+ *
+ * @param f File to check.
+ * @return The position.
+ */
+int64_t archive_ftell(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_ftell(handle->disk_file);
+    return (int64_t) handle->pos;
+}
+
+
+/**
+ * @brief Changes the reading position in a file, for Allegro.
+ *
+ * @param f File to change.
+ * @param offset Offset to move by.
+ * @param whence What the offset is relative to.
+ * @return Whether it succeeded.
+ */
+bool archive_fseek(ALLEGRO_FILE* f, int64_t offset, int whence) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_fseek(handle->disk_file, offset, whence);
+    
+    int64_t new_pos = offset;
+    switch(whence) {
+    case ALLEGRO_SEEK_CUR: {
+        new_pos += (int64_t) handle->pos;
+        break;
+    } case ALLEGRO_SEEK_END: {
+        new_pos += (int64_t) handle->size;
+        break;
+    } default: {
+        break;
+    }
+    }
+    
+    if(new_pos < 0 || new_pos > (int64_t) handle->size) return false;
+    handle->pos = (size_t) new_pos;
+    handle->eof = false;
+    return true;
+}
+
+
+/**
+ * @brief Returns whether a read went past the end of a file, for Allegro.
+ *
+ * @param f File to check.
+ * @return Whether it did.
+ */
+bool archive_feof(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_feof(handle->disk_file);
+    return handle->eof;
+}
+
+
+/**
+ * @brief Returns a file's error indicator, for Allegro.
+ *
+ * @param f File to check.
+ * @return The error indicator.
+ */
+int archive_ferror(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_ferror(handle->disk_file);
+    return 0;
+}
+
+
+/**
+ * @brief Returns a file's error message, for Allegro.
+ *
+ * @param f File to check.
+ * @return The error message.
+ */
+const char* archive_ferrmsg(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_ferrmsg(handle->disk_file);
+    return "";
+}
+
+
+/**
+ * @brief Clears a file's error and end of file indicators, for Allegro.
+ *
+ * @param f File to change.
+ */
+void archive_fclearerr(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) {
+        al_fclearerr(handle->disk_file);
+        return;
+    }
+    handle->eof = false;
+}
+
+
+/**
+ * @brief Puts a character back into a file, for Allegro.
+ *
+ * @param f File to change.
+ * @param c The character.
+ * @return The character.
+ */
+int archive_fungetc(ALLEGRO_FILE* f, int c) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return al_fungetc(handle->disk_file, c);
+    if(handle->pos > 0) handle->pos--;
+    handle->eof = false;
+    return c;
+}
+
+
+/**
+ * @brief Returns the size of a file, for Allegro.
+ *
+ * @param f File to check.
+ * @return The size.
+ */
+off_t archive_fsize(ALLEGRO_FILE* f) {
+    ArchiveFileHandle* handle = (ArchiveFileHandle*) al_get_file_userdata(f);
+    if(handle->disk_file) return (off_t) al_fsize(handle->disk_file);
+    return (off_t) handle->size;
+}
+
+
+//File interface that reads files in archives, and passes everything
+//else on to the disk.
+ALLEGRO_FILE_INTERFACE archive_file_interface = {
+    archive_fopen,
+    archive_fclose,
+    archive_fread,
+    archive_fwrite,
+    archive_fflush,
+    archive_ftell,
+    archive_fseek,
+    archive_feof,
+    archive_ferror,
+    archive_ferrmsg,
+    archive_fclearerr,
+    archive_fungetc,
+    archive_fsize
+};
+
+}
+
+
+/**
+ * @brief Destroys the file archive object.
+ */
+FileArchive::~FileArchive() {
+    close();
+}
+
+
+/**
+ * @brief Closes the archive, if it's open.
+ */
+void FileArchive::close() {
+#if defined(_WIN32)
+    if(data) UnmapViewOfFile(data);
+    if(os_mapping != -1) CloseHandle((HANDLE) os_mapping);
+    if(os_file != -1) CloseHandle((HANDLE) os_file);
+#else
+    if(data) munmap((void*) data, data_size);
+    if(os_file != -1) ::close((int) os_file);
+#endif //#if defined(_WIN32)
+    data = nullptr;
+    data_size = 0;
+    os_file = -1;
+    os_mapping = -1;
+    files.clear();
+    folders.clear();
+}
+
+
+/**
+ * @brief Returns the contents of a file in the archive.
+ *
+ * @param rel_path Path to the file, relative to the archive's root.
+ * @param out_data The start of the file's contents is returned here.
+ * They stay valid while the archive is open.
+ * @param out_size The size of the file is returned here.
+ * @return Whether the file exists.
+ */
+bool FileArchive::get_file(
+    const string &rel_path, const unsigned char** out_data,
+    size_t* out_size
+) const {
+    auto it = files.find(rel_path);
+    if(it == files.end()) return false;
+    *out_data = data + it->second.offset;
+    *out_size = it->second.size;
+    return true;
+}
+
+
+/**
+ * @brief Returns the names of what's inside a folder in the archive,
+ * like folder_to_vector() does for folders on the disk.
+ *
+ * @param rel_path Path to the folder, relative to the archive's root.
+ * The root is "".
+ * @param folders If true, only return folders. If false, only return files.
+ * @param out_names The names are returned here.
+ * @return Whether the folder exists.
+ */
+bool FileArchive::get_folder(
+    const string &rel_path, bool folders, vector<string>* out_names
+) const {
+    auto it = this->folders.find(rel_path);
+    if(it == this->folders.end()) return false;
+    *out_names = folders ? it->second.subfolders : it->second.files;
+    return true;
+}
+
+
+/**
+ * @brief Opens an archive file, by mapping it into memory, and
+ * reads its index.
+ *
+ * @param path Path to the archive file.
+ * @return Whether it succeeded.
+ */
+bool FileArchive::open(const string &path) {
+    close();
+
+#if defined(_WIN32)
+    HANDLE file =
+        CreateFileA(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+    if(file == INVALID_HANDLE_VALUE) return false;
+    os_file = (intptr_t) file;
+    
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping) {
+        close();
+        return false;
+    }
+    os_mapping = (intptr_t) mapping;
+    
+    data =
+        (const unsigned char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!data) {
+        close();
+        return false;
+    }
+    data_size = (size_t) size.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd == -1) return false;
+    os_file = fd;
+    
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close();
+        return false;
+    }
+    
+    void* mapping =
+        mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data = (const unsigned char*) mapping;
+    data_size = (size_t) st.st_size;
+#endif //#if defined(_WIN32)
+
+    if(!read_index()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Reads the archive's index, and works out what's in each folder.
+ *
+ * @return Whether the index is valid.
+ */
+bool FileArchive::read_index() {
+    size_t pos = 0;
+    size_t magic_size = strlen(FILE_ARCHIVE_MAGIC);
+    if(data_size < magic_size) return false;
+    if(memcmp(data, FILE_ARCHIVE_MAGIC, magic_size) != 0) return false;
+    pos += magic_size;
+    
+    uint32_t version;
+    uint32_t n_files;
+    if(!read_archive_u32(data, data_size, pos, &version)) return false;
+    if(version != FILE_ARCHIVE_VERSION) return false;
+    if(!read_archive_u32(data, data_size, pos, &n_files)) return false;
+    
+    folders[""] = FolderEntry();
+    for(uint32_t f = 0; f < n_files; f++) {
+        uint32_t path_size;
+        uint64_t offset;
+        uint64_t size;
+        if(!read_archive_u32(data, data_size, pos, &path_size)) return false;
+        if(data_size - pos < path_size) return false;
+        string rel_path((const char*) data + pos, path_size);
+        pos += path_size;
+        if(!read_archive_u64(data, data_size, pos, &offset)) return false;
+        if(!read_archive_u64(data, data_size, pos, &size)) return false;
+        if(offset > data_size || size > data_size - offset) return false;
+        
+        FileEntry &entry = files[rel_path];
+        entry.offset = (size_t) offset;
+        entry.size = (size_t) size;
+        
+        //Register the file in its folder, and every folder on the way.
+        size_t slash_pos = rel_path.find_last_of('/');
+        string folder_path =
+            slash_pos == string::npos ? "" : rel_path.substr(0, slash_pos);
+        folders[folder_path].files.push_back(
+            rel_path.substr(slash_pos == string::npos ? 0 : slash_pos + 1)
+        );
+        while(!folder_path.empty()) {
+            slash_pos = folder_path.find_last_of('/');
+            string parent_path =
+                slash_pos == string::npos ?
+                "" : folder_path.substr(0, slash_pos);
+            string folder_name =
+                folder_path.substr(
+                    slash_pos == string::npos ? 0 : slash_pos + 1
+                );
+            bool parent_known = folders.find(parent_path) != folders.end();
+            vector<string> &siblings = folders[parent_path].subfolders;
+            if(
+                std::find(siblings.begin(), siblings.end(), folder_name) ==
+                siblings.end()
+            ) {
+                siblings.push_back(folder_name);
+            }
+            if(parent_known) break;
+            folder_path = parent_path;
+        }
+    }
+    
+    //Same order as folder_to_vector().
+    const auto name_less = [] (const string & s1, const string & s2) {
+        return str_to_lower(s1) < str_to_lower(s2);
+    };
+    for(auto &f : folders) {
+        vector<string> &subfolders = f.second.subfolders;
+        vector<string> &files = f.second.files;
+        std::sort(subfolders.begin(), subfolders.end(), name_less);
+        std::sort(files.begin(), files.end(), name_less);
+    }
+    
+    return true;
+}
+
+
+/**
+ * @brief Returns the mounted archive that a path is inside of, if any.
+ *
+ * @param path Path to check.
+ * @param out_rel_path If not nullptr, the path relative to the archive's
+ * root is returned here.
+ * @return The archive, or nullptr if the path isn't inside of any.
+ */
+const FileArchive* find_file_archive(
+    const string &path, string* out_rel_path
+) {
+    if(path.empty()) return nullptr;
+    std::lock_guard<std::mutex> lock(archive_mounts_mutex);
+    if(archive_mounts.empty()) return nullptr;
+    string std_path = standardize_path(path);
+    for(size_t m = 0; m < archive_mounts.size(); m++) {
+        const string &mount_path = archive_mounts[m].first;
+        if(std_path == mount_path) {
+            if(out_rel_path) out_rel_path->clear();
+            return archive_mounts[m].second;
+        }
+        if(
+            std_path.size() > mount_path.size() &&
+            std_path[mount_path.size()] == '/' &&
+            std_path.compare(0, mount_path.size(), mount_path) == 0
+        ) {
+            if(out_rel_path) {
+                *out_rel_path = std_path.substr(mount_path.size() + 1);
+            }
+            return archive_mounts[m].second;
+        }
+    }
+    return nullptr;
+}
+
+
+/**
+ * @brief Returns the names of the archives that are mounted right inside
+ * a given folder, as if they were subfolders of it.
+ *
+ * @param folder_path Path to the folder.
+ * @return The names.
+ */
+vector<string> get_file_archive_mount_names(const string &folder_path) {
+    vector<string> names;
+    if(folder_path.empty()) return names;
+    std::lock_guard<std::mutex> lock(archive_mounts_mutex);
+    if(archive_mounts.empty()) return names;
+    string std_path = standardize_path(folder_path);
+    for(size_t m = 0; m < archive_mounts.size(); m++) {
+        const string &mount_path = archive_mounts[m].first;
+        size_t slash_pos = mount_path.find_last_of('/');
+        if(slash_pos == string::npos) continue;
+        if(mount_path.compare(0, slash_pos, std_path) != 0) continue;
+        if(slash_pos != std_path.size()) continue;
+        names.push_back(mount_path.substr(slash_pos + 1));
+    }
+    return names;
+}
+
+
+/**
+ * @brief Opens an archive, and makes its contents look like they're in a
+ * given folder, for the archive file interface and folder_to_vector().
+ * The archive stays open until unmount_file_archives() is called.
+ * This is safe to call while other threads are reading files.
+ *
+ * @param archive_path Path to the archive file.
+ * @param mount_path Path to the folder where its contents should be.
+ * @return Whether it succeeded.
+ */
+bool mount_file_archive(const string &archive_path, const string &mount_path) {
+    FileArchive* archive = new FileArchive();
+    if(!archive->open(archive_path)) {
+        delete archive;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(archive_mounts_mutex);
+    archive_mounts.push_back(
+        std::make_pair(standardize_path(mount_path), archive)
+    );
+    return true;
+}
+
+
+/**
+ * @brief Opens a block of memory as a read-only Allegro file. The memory
+ * must stay alive for as long as the file is open.
+ *
+ * @param data Start of the memory.
+ * @param size Size of the memory.
+ * @return The file, or nullptr on failure.
+ */
+ALLEGRO_FILE* open_memory_file(const unsigned char* data, size_t size) {
+    ArchiveFileHandle* handle = new ArchiveFileHandle();
+    handle->data = data;
+    handle->size = size;
+    ALLEGRO_FILE* file = al_create_file_handle(&archive_file_interface, handle);
+    if(!file) delete handle;
+    return file;
+}
+
+
+/**
+ * @brief Closes all mounted archives. Any files still open from them
+ * can't be read anymore.
+ */
+void unmount_file_archives() {
+    std::lock_guard<std::mutex> lock(archive_mounts_mutex);
+    for(size_t m = 0; m < archive_mounts.size(); m++) {
+        delete archive_mounts[m].second;
+    }
+    archive_mounts.clear();
+}
+
+
+/**
+ * @brief Makes the current thread open its files with the archive
+ * file interface, so that files inside mounted archives can be opened
+ * with al_fopen() and anything built on it, like bitmap loading.
+ * Allegro keeps the file interface per thread, so every thread that reads
+ * files needs to call this.
+ */
+void use_file_archive_interface() {
+    const ALLEGRO_FILE_INTERFACE* cur_interface = al_get_new_file_interface();
+    if(cur_interface == &archive_file_interface) return;
+    if(!disk_file_interface) disk_file_interface = cur_interface;
+    al_set_new_file_interface(&archive_file_interface);
+}
+
+
+/**
+ * @brief Writes a folder, and everything inside of it, into an
+ * archive file.
+ *
+ * @param folder_path Path to the folder.
+ * @param archive_path Path to the archive file to write.
+ * @return Whether it succeeded.
+ */
+bool write_file_archive(const string &folder_path, const string &archive_path) {
+    bool found;
+    vector<string> rel_paths =
+        folder_to_vector_recursively(folder_path, false, &found);
+    if(!found) return false;
+    
+    //Get the sizes first, since the index goes before the contents.
+    vector<uint64_t> sizes(rel_paths.size(), 0);
+    uint64_t index_size = strlen(FILE_ARCHIVE_MAGIC) + 4 + 4;
+    for(size_t f = 0; f < rel_paths.size(); f++) {
+        ALLEGRO_FILE* file =
+            al_fopen((folder_path + "/" + rel_paths[f]).c_str(), "rb");
+        if(!file) return false;
+        sizes[f] = (uint64_t) al_fsize(file);
+        al_fclose(file);
+        index_size += 4 + rel_paths[f].size() + 8 + 8;
+    }
+    
+    ALLEGRO_FILE* archive = al_fopen(archive_path.c_str(), "wb");
+    if(!archive) return false;
+    
+    //Index.
+    al_fwrite(archive, FILE_ARCHIVE_MAGIC, strlen(FILE_ARCHIVE_MAGIC));
+    al_fwrite32le(archive, (int32_t) FILE_ARCHIVE_VERSION);
+    al_fwrite32le(archive, (int32_t) rel_paths.size());
+    uint64_t offset = index_size;
+    for(size_t f = 0; f < rel_paths.size(); f++) {
+        al_fwrite32le(archive, (int32_t) rel_paths[f].size());
+        al_fwrite(archive, rel_paths[f].c_str(), rel_paths[f].size());
+        al_fwrite32le(archive, (int32_t) (offset & 0xFFFFFFFF));
+        al_fwrite32le(archive, (int32_t) (offset >> 32));
+        al_fwrite32le(archive, (int32_t) (sizes[f] & 0xFFFFFFFF));
+        al_fwrite32le(archive, (int32_t) (sizes[f] >> 32));
+        offset += sizes[f];
+    }
+    
+    //Contents.
+    bool success = true;
+    vector<unsigned char> buffer(64 * 1024);
+    for(size_t f = 0; f < rel_paths.size() && success; f++) {
+        ALLEGRO_FILE* file =
+            al_fopen((folder_path + "/" + rel_paths[f]).c_str(), "rb");
+        if(!file) {
+            success = false;
+            break;
+        }
+        uint64_t left = sizes[f];
+        while(left > 0) {
+            size_t amount =
+                al_fread(
+                    file, buffer.data(),
+                    (size_t) std::min<uint64_t>(left, buffer.size())
+                );
+            if(amount == 0) {
+                success = false;
+                break;
+            }
+            al_fwrite(archive, buffer.data(), amount);
+            left -= amount;
+        }
+        al_fclose(file);
+    }
+    
+    if(!al_fclose(archive)) success = false;
+    return success;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for single-file archives of folders, and the Allegro file
+ * interface that reads from them.
+ * These don't contain logic specific to the Pikifen project.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <allegro5/allegro.h>
+
+using std::map;
+using std::size_t;
+using std::string;
+using std::vector;
+
+
+//Extension of archive files, without the dot.
+constexpr const char* FILE_ARCHIVE_EXTENSION = "pack";
+
+//The first bytes of every archive file.
+constexpr const char* FILE_ARCHIVE_MAGIC = "PKFA";
+
+//Version of the archive file format.
+constexpr uint32_t FILE_ARCHIVE_VERSION = 1;
+
+
+/**
+ * @brief A single file that holds a whole folder tree. It starts with an
+ * index of every file's path, position, and size, followed by the files'
+ * contents, back to back. The archive is memory-mapped, so opening it only
+ * reads the index, and the files are read straight from the mapping.
+ */
+class FileArchive {
+
+public:
+    
+    //--- Function declarations ---
+    
+    ~FileArchive();
+    void close();
+    bool get_file(
+        const string &rel_path, const unsigned char** out_data,
+        size_t* out_size
+    ) const;
+    bool get_folder(
+        const string &rel_path, bool folders, vector<string>* out_names
+    ) const;
+    bool open(const string &path);
+
+
+private:
+    
+    //--- Misc. declarations ---
+    
+    /**
+     * @brief Where a file is inside the archive.
+     */
+    struct FileEntry {
+
+        //--- Members ---
+        
+        //Position of its contents, from the start of the archive.
+        size_t offset = 0;
+        
+        //Size of its contents.
+        size_t size = 0;
+        
+    };
+    
+    /**
+     * @brief What's inside a folder in the archive.
+     */
+    struct FolderEntry {
+
+        //--- Members ---
+        
+        //Names of the subfolders, sorted.
+        vector<string> subfolders;
+        
+        //Names of the files, sorted.
+        vector<string> files;
+        
+    };
+    
+    
+    //--- Members ---
+    
+    //Start of the mapped archive.
+    const unsigned char* data = nullptr;
+    
+    //Size of the mapped archive.
+    size_t data_size = 0;
+    
+    //Operative system handle of the archive file.
+    intptr_t os_file = -1;
+    
+    //Operative system handle of the mapping, where needed.
+    intptr_t os_mapping = -1;
+    
+    //Files, by path relative to the archive's root.
+    map<string, FileEntry> files;
+    
+    //Folders, by path relative to the archive's root. The root is "".
+    map<string, FolderEntry> folders;
+    
+    
+    //--- Function declarations ---
+    
+    bool read_index();
+    
+};
+
+
+const FileArchive* find_file_archive(
+    const string &path, string* out_rel_path
+);
+vector<string> get_file_archive_mount_names(const string &folder_path);
+bool mount_file_archive(const string &archive_path, const string &mount_path);
+ALLEGRO_FILE* open_memory_file(const unsigned char* data, size_t size);
+void unmount_file_archives();
+void use_file_archive_interface();
+bool write_file_archive(const string &folder_path, const string &archive_path);
@@ -8,6 +8,9 @@
  * Code debugging tools. See the header file for more information.
  */
 
+#include <cstdlib>
+#include <new>
+
 #include <allegro5/allegro.h>
 
 #include "code_debug.h"
@@ -92,6 +95,102 @@ void* operator new[](size_t size, char* file, int line) {
 #endif //ifndef CODE_DEBUG_NEW
 
 
+std::atomic<size_t> code_debug_alloc_nr(0);
+std::atomic<size_t> code_debug_alloc_bytes(0);
+
+
+#ifdef CODE_DEBUG_ALLOC_COUNT
+
+const bool code_debug_alloc_counting = true;
+
+
+/**
+ * @brief Counts an allocation, and then allocates the memory.
+ *
+ * @param size Size of memory to allocate.
+ * @return The allocated memory.
+ */
+static void* code_debug_counted_alloc(size_t size) {
+    code_debug_alloc_nr.fetch_add(1, std::memory_order_relaxed);
+    code_debug_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if(!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+
+/**
+ * @brief Replaces the global operator new, to count allocations.
+ *
+ * @param size Size of memory to allocate.
+ * @return The allocated memory.
+ */
+void* operator new(size_t size) {
+    return code_debug_counted_alloc(size);
+}
+
+
+/**
+ * @brief Replaces the global operator new[], to count allocations.
+ *
+ * @param size Size of memory to allocate.
+ * @return The allocated memory.
+ */
+void* operator new[](size_t size) {
+    return code_debug_counted_alloc(size);
+}
+
+
+/**
+ * @brief Replaces the global operator delete, to match operator new.
+ *
+ * @param ptr Pointer to memory to deallocate.
+ */
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+
+/**
+ * @brief Replaces the global operator delete[], to match operator new[].
+ *
+ * @param ptr Pointer to memory to deallocate.
+ */
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+
+/**
+ * @brief Replaces the global sized operator delete, to match operator new.
+ *
+ * @param ptr Pointer to memory to deallocate.
+ * @param size Size of the memory.
+ */
+void operator delete(void* ptr, size_t size) noexcept {
+    free(ptr);
+}
+
+
+/**
+ * @brief Replaces the global sized operator delete[],
+ * to match operator new[].
+ *
+ * @param ptr Pointer to memory to deallocate.
+ * @param size Size of the memory.
+ */
+void operator delete[](void* ptr, size_t size) noexcept {
+    free(ptr);
+}
+
+
+#else
+
+const bool code_debug_alloc_counting = false;
+
+#endif //ifdef CODE_DEBUG_ALLOC_COUNT
+
+
 
 /**
  * @brief Starts a time measurement for benchmarking.
@@ -10,6 +10,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+
+
 /**
  * @brief Memory allocation and memory leak debug.
  *
@@ -67,6 +71,33 @@ void operator delete[](void* ptr, size_t size) noexcept;
 #endif //ifdef CODE_DEBUG_NEW
 
 
+/**
+ * @brief Heap allocation counting.
+ *
+ * To activate, define CODE_DEBUG_ALLOC_COUNT for the whole project,
+ * like by adding -DCODE_DEBUG_ALLOC_COUNT to the makefile's CXXFLAGS.
+ * With this on, the global operator new and delete are replaced, so every
+ * heap allocation in the program gets counted, including the ones done
+ * by standard containers and strings. The performance monitor then
+ * reports how many allocations each of its measurements made, as does
+ * the performance overlay maker tool, so per-frame allocations can be
+ * driven down to zero.
+ * The counters are global, so allocations that other threads make during
+ * a measurement count towards it too.
+ * This can't be used together with CODE_DEBUG_NEW.
+ */
+#if defined(CODE_DEBUG_ALLOC_COUNT) && defined(CODE_DEBUG_NEW)
+#error "CODE_DEBUG_ALLOC_COUNT and CODE_DEBUG_NEW can't be used together."
+#endif
+
+//Are heap allocations being counted?
+extern const bool code_debug_alloc_counting;
+//Number of heap allocations so far. Only if code_debug_alloc_counting.
+extern std::atomic<size_t> code_debug_alloc_nr;
+//Number of heap-allocated bytes so far. Only if code_debug_alloc_counting.
+extern std::atomic<size_t> code_debug_alloc_bytes;
+
+
 //Timestamp for the start of the current benchmark measurement.
 extern double code_debug_benchmark_measure_start;
 //Sum of the durations of all code benchmarking iterations.
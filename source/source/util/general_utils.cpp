@@ -85,6 +85,72 @@ size_t AutoRepeater::tick(float delta_t) {
 }
 
 
+/**
+ * @brief Constructs a new block pool object.
+ *
+ * @param obj_size Size of each object, in bytes.
+ * @param objs_per_block How many objects fit in each block.
+ */
+BlockPool::BlockPool(size_t obj_size, size_t objs_per_block) :
+    objs_per_block(std::max((size_t) 1, objs_per_block)) {
+    
+    //Every object must be able to hold the free list pointer, and be aligned
+    //like anything else that comes out of the standard allocator.
+    const size_t align = alignof(std::max_align_t);
+    obj_size = std::max(obj_size, sizeof(void*));
+    this->obj_size = (obj_size + align - 1) / align * align;
+    last_block_used = this->objs_per_block;
+}
+
+
+/**
+ * @brief Destroys the block pool object, giving all of its memory back.
+ * Any objects still in it must have been destroyed already.
+ */
+BlockPool::~BlockPool() {
+    for(size_t b = 0; b < blocks.size(); b++) {
+        ::operator delete(blocks[b]);
+    }
+}
+
+
+/**
+ * @brief Returns memory for a new object.
+ *
+ * @return The memory.
+ */
+void* BlockPool::alloc() {
+    if(free_list) {
+        void* ptr = free_list;
+        free_list = *(void**) ptr;
+        return ptr;
+    }
+    
+    if(last_block_used == objs_per_block) {
+        blocks.push_back(
+            (unsigned char*) ::operator new(obj_size * objs_per_block)
+        );
+        last_block_used = 0;
+    }
+    void* ptr = blocks.back() + last_block_used * obj_size;
+    last_block_used++;
+    return ptr;
+}
+
+
+/**
+ * @brief Gives back the memory of an object that was destroyed,
+ * so it can be reused.
+ *
+ * @param ptr Memory of the object.
+ */
+void BlockPool::free(void* ptr) {
+    if(!ptr) return;
+    *(void**) ptr = free_list;
+    free_list = ptr;
+}
+
+
 /**
  * @brief Clears all items.
  */
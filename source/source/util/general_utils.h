@@ -123,6 +123,47 @@ struct AutoRepeater {
 };
 
 
+/**
+ * @brief Hands out memory for objects of one fixed size. Memory is reserved
+ * in big blocks, and objects are given out one after the other inside them,
+ * so objects created around the same time end up next to each other.
+ * Freed memory is reused for the next objects. Blocks are only given back
+ * to the system when the pool is destroyed.
+ */
+struct BlockPool {
+
+    //--- Function declarations ---
+    
+    BlockPool(size_t obj_size, size_t objs_per_block);
+    BlockPool(const BlockPool &p2) = delete;
+    BlockPool &operator=(const BlockPool &p2) = delete;
+    ~BlockPool();
+    void* alloc();
+    void free(void* ptr);
+    
+    private:
+    
+    //--- Members ---
+    
+    //Size of each object, in bytes.
+    size_t obj_size = 0;
+    
+    //How many objects fit in each block.
+    size_t objs_per_block = 0;
+    
+    //All blocks.
+    vector<unsigned char*> blocks;
+    
+    //How many objects of the last block have been given out at least once.
+    size_t last_block_used = 0;
+    
+    //First object in the list of freed objects, if any. Each freed object
+    //holds a pointer to the next one.
+    void* free_list = nullptr;
+    
+};
+
+
 /**
  * @brief Just a list of different elements in an enum and what their names are.
  */
@@ -464,6 +505,115 @@ struct MovementInfo {
 };
 
 
+/**
+ * @brief A first-in, first-out list, kept in a circular buffer.
+ * Removing the oldest item only moves the head forward, instead of shifting
+ * every other item. The buffer only grows when it's full, and never shrinks,
+ * so lists that are filled and emptied every frame don't reallocate.
+ */
+template<typename t>
+struct RingBuffer {
+
+    public:
+    
+    //--- Function definitions ---
+    
+    /**
+     * @brief Returns an item, counting from the oldest one.
+     *
+     * @param idx Index of the item. 0 is the oldest.
+     * @return The item.
+     */
+    t &operator[](size_t idx) {
+        return items[(head + idx) % items.size()];
+    }
+    
+    
+    /**
+     * @brief Returns an item, counting from the oldest one.
+     *
+     * @param idx Index of the item. 0 is the oldest.
+     * @return The item.
+     */
+    const t &operator[](size_t idx) const {
+        return items[(head + idx) % items.size()];
+    }
+    
+    
+    /**
+     * @brief Removes all items.
+     */
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+    
+    
+    /**
+     * @brief Returns whether there are no items.
+     *
+     * @return Whether it's empty.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+    
+    
+    /**
+     * @brief Removes the oldest item. There must be one.
+     */
+    void pop_front() {
+        head = (head + 1) % items.size();
+        count--;
+    }
+    
+    
+    /**
+     * @brief Adds an item after the newest one.
+     *
+     * @param item Item to add.
+     */
+    void push_back(const t &item) {
+        if(count == items.size()) {
+            //Full. Unwrap the items into a buffer twice as big.
+            vector<t> new_items(std::max((size_t) 8, items.size() * 2));
+            for(size_t i = 0; i < count; i++) {
+                new_items[i] = (*this)[i];
+            }
+            items.swap(new_items);
+            head = 0;
+        }
+        items[(head + count) % items.size()] = item;
+        count++;
+    }
+    
+    
+    /**
+     * @brief Returns how many items there are.
+     *
+     * @return The amount.
+     */
+    size_t size() const {
+        return count;
+    }
+    
+    
+    private:
+    
+    //--- Members ---
+    
+    //Buffer with the items. Its size is the capacity.
+    vector<t> items;
+    
+    //Index of the oldest item in the buffer.
+    size_t head = 0;
+    
+    //How many items there are.
+    size_t count = 0;
+    
+};
+
+
 /**
  * @brief A timer. You can set it to start at a pre-determined time,
  * to tick, etc.
@@ -533,6 +683,20 @@ string standardize_path(const string &path);
 string vector_tail_to_string(const vector<string> &v, size_t pos);
 
 
+/**
+ * @brief Returns how much memory a vector's contents take up, in bytes.
+ * This counts its whole capacity, not just the items in use.
+ *
+ * @tparam t Type of the vector's contents.
+ * @param v The vector.
+ * @return The size.
+ */
+template<typename t>
+size_t get_vector_memory_usage(const vector<t> &v) {
+    return v.capacity() * sizeof(t);
+}
+
+
 /**
  * @brief Shorthand for figuring out if a given item is in a container.
  *
@@ -596,6 +760,46 @@ vector<t> remove_all_in_vector(
 }
 
 
+/**
+ * @brief Removes the first instance of a given item inside of a vector,
+ * if it's there.
+ *
+ * @tparam t Type of the vector's contents.
+ * @param item Item to compare with.
+ * @param vec Vector to change.
+ * @return Whether it was found and removed.
+ */
+template<typename t>
+bool remove_first_in_vector(const t &item, vector<t> &vec) {
+    auto it = std::find(vec.begin(), vec.end(), item);
+    if(it == vec.end()) return false;
+    vec.erase(it);
+    return true;
+}
+
+
+/**
+ * @brief Removes all items of a vector that are inside of a given set,
+ * in one pass. The order of the remaining items is kept.
+ *
+ * @tparam t Type of the vector's contents.
+ * @tparam s Type of the set.
+ * @param items Set of items to remove.
+ * @param vec Vector to change.
+ */
+template<typename t, typename s>
+void remove_items_in_set_from_vector(const s &items, vector<t> &vec) {
+    if(items.empty()) return;
+    size_t new_size = 0;
+    for(size_t i = 0; i < vec.size(); i++) {
+        if(items.find(vec[i]) != items.end()) continue;
+        if(new_size != i) vec[new_size] = vec[i];
+        new_size++;
+    }
+    vec.erase(vec.begin() + new_size, vec.end());
+}
+
+
 /**
  * @brief Sorts a vector, using the preference list to figure out which
  * elements go before which. Elements not in the preference list will go
@@ -17,6 +17,7 @@
 
 #include "geometry_utils.h"
 #include "math_utils.h"
+#include "simd_utils.h"
 #include "string_utils.h"
 
 using std::vector;
@@ -71,6 +72,8 @@ Distance &Distance::operator =(float d) {
  * @return Whether it is smaller.
  */
 bool Distance::operator<(float d2) const {
+    if(has_normal_distance) return normal_distance < d2;
+    if(d2 <= 0.0f) return false;
     return distance_squared < (d2 * d2);
 }
 
@@ -82,6 +85,8 @@ bool Distance::operator<(float d2) const {
  * @return Whether it is larger.
  */
 bool Distance::operator>(float d2) const {
+    if(has_normal_distance) return normal_distance > d2;
+    if(d2 < 0.0f) return true;
     return distance_squared > (d2 * d2);
 }
 
@@ -93,6 +98,8 @@ bool Distance::operator>(float d2) const {
  * @return Whether it is the same.
  */
 bool Distance::operator==(float d2) const {
+    if(has_normal_distance) return normal_distance == d2;
+    if(d2 < 0.0f) return false;
     return distance_squared == (d2 * d2);
 }
 
@@ -269,6 +276,41 @@ float Distance::to_float() {
 }
 
 
+/**
+ * @brief Adds a line segment to the end of the list.
+ *
+ * @param p1 First point of the segment.
+ * @param p2 Second point of the segment.
+ */
+void LineSegBatch::add(const Point &p1, const Point &p2) {
+    x1s.push_back(p1.x);
+    y1s.push_back(p1.y);
+    x2s.push_back(p2.x);
+    y2s.push_back(p2.y);
+}
+
+
+/**
+ * @brief Removes all line segments.
+ */
+void LineSegBatch::clear() {
+    x1s.clear();
+    y1s.clear();
+    x2s.clear();
+    y2s.clear();
+}
+
+
+/**
+ * @brief Returns how many line segments there are.
+ *
+ * @return The amount.
+ */
+size_t LineSegBatch::size() const {
+    return x1s.size();
+}
+
+
 /**
  * @brief Constructs a new point object, given its coordinates.
  *
@@ -1004,6 +1046,75 @@ float get_angle_smallest_dif(float a1, float a2) {
 }
 
 
+/**
+ * @brief Returns how far along its movement a moving circle first touches
+ * a line segment. This works no matter how far it moves, so it catches
+ * the cases where the circle would've gone past the segment entirely.
+ *
+ * @param start Starting coordinates of the circle's center.
+ * @param end Final coordinates of the circle's center.
+ * @param radius Radius of the circle.
+ * @param l1 First point of the line segment.
+ * @param l2 Second point of the line segment.
+ * @return The ratio, from 0 (at the start) to 1 (at the end),
+ * or FLT_MAX if they never touch. If the circle is already touching the
+ * segment at the start, this is 0.
+ */
+float get_circle_sweep_line_seg_ratio(
+    const Point &start, const Point &end, float radius,
+    const Point &l1, const Point &l2
+) {
+    Point move = end - start;
+    Point seg = l2 - l1;
+    float seg_len_sq = seg.x * seg.x + seg.y * seg.y;
+    float best = FLT_MAX;
+    
+    //Already touching?
+    float start_seg_r =
+        seg_len_sq > 0.0f ?
+        std::clamp(dot_product(start - l1, seg) / seg_len_sq, 0.0f, 1.0f) :
+        0.0f;
+    if(Distance(start, l1 + seg * start_seg_r) <= radius) return 0.0f;
+    
+    //Touching one of the sides, i.e. the circle's center being
+    //radius away from the segment's line, somewhere along the segment.
+    if(seg_len_sq > 0.0f) {
+        float seg_len = (float) sqrt(seg_len_sq);
+        Point normal(-seg.y / seg_len, seg.x / seg_len);
+        float start_dist = dot_product(start - l1, normal);
+        float move_dist = dot_product(move, normal);
+        if(move_dist != 0.0f) {
+            for(int side = -1; side <= 1; side += 2) {
+                float r = (side * radius - start_dist) / move_dist;
+                if(r < 0.0f || r > 1.0f) continue;
+                Point p = start + move * r;
+                float seg_r = dot_product(p - l1, seg) / seg_len_sq;
+                if(seg_r < 0.0f || seg_r > 1.0f) continue;
+                best = std::min(best, r);
+            }
+        }
+    }
+    
+    //Touching one of the ends.
+    float a = dot_product(move, move);
+    if(a > 0.0f) {
+        const Point* ends[2] = { &l1, &l2 };
+        for(unsigned char e = 0; e < 2; e++) {
+            Point f = start - *ends[e];
+            float b = 2.0f * dot_product(f, move);
+            float c = dot_product(f, f) - radius * radius;
+            float disc = b * b - 4.0f * a * c;
+            if(disc < 0.0f) continue;
+            float r = (-b - (float) sqrt(disc)) / (2.0f * a);
+            if(r < 0.0f || r > 1.0f) continue;
+            best = std::min(best, r);
+        }
+    }
+    
+    return best;
+}
+
+
 /**
  * @brief Returns the closest point in a line segment to a given point.
  *
@@ -1108,6 +1219,227 @@ Point get_closest_point_in_rotated_rectangle(
 }
 
 
+/**
+ * @brief Calculates the squared distance between a point and each point
+ * in a list, in one go. This is meant for when there are many points to check,
+ * since a simple loop like this one is something the compiler can turn into
+ * vector instructions, and the squared distances can be compared against
+ * squared thresholds without ever needing sqrt().
+ *
+ * @param center Point to check the distances from.
+ * @param points Points to check the distances to.
+ * @param out_dists_squared The squared distances are returned here,
+ * in the same order as the points. This vector is resized to match.
+ */
+void get_distances_squared(
+    const Point &center, const vector<Point> &points,
+    vector<float> &out_dists_squared
+) {
+    size_t n_points = points.size();
+    out_dists_squared.resize(n_points);
+    const Point* points_ptr = points.data();
+    float* dists_ptr = out_dists_squared.data();
+    for(size_t p = 0; p < n_points; p++) {
+        float dx = points_ptr[p].x - center.x;
+        float dy = points_ptr[p].y - center.y;
+        dists_ptr[p] = dx * dx + dy * dy;
+    }
+}
+
+
+/**
+ * @brief Finds which line segments in a batch could be touching a circle,
+ * checking four of them at a time. This only rules out the segments that
+ * are clearly too far, with a bit of leeway for rounding, so the ones
+ * returned still need to be checked with circle_intersects_line_seg(),
+ * but all of the ones it would accept are returned.
+ *
+ * @param segs Line segments to check.
+ * @param circle Coordinates of the circle's center.
+ * @param radius Radius of the circle.
+ * @param out_idxs The indexes of the segments that could be touching are
+ * returned here, in order. Any previous contents are discarded.
+ */
+void get_line_segs_near_circle(
+    const LineSegBatch &segs, const Point &circle, float radius,
+    vector<size_t> &out_idxs
+) {
+    out_idxs.clear();
+    size_t n_segs = segs.size();
+    size_t simd_end = n_segs - (n_segs % SIMD_FLOAT4_SIZE);
+    
+    //The leeway is one unit, which is nothing compared to anything
+    //that'd be in the game world.
+    float max_dist = radius + 1.0f;
+    
+    const SimdFloat4 cx4 = SimdFloat4::set(circle.x);
+    const SimdFloat4 cy4 = SimdFloat4::set(circle.y);
+    const SimdFloat4 max_dist_sq4 = SimdFloat4::set(max_dist * max_dist);
+    const SimdFloat4 zero4 = SimdFloat4::set(0.0f);
+    const SimdFloat4 one4 = SimdFloat4::set(1.0f);
+    const SimdFloat4 min_len_sq4 = SimdFloat4::set(FLT_MIN);
+    
+    for(size_t s = 0; s < simd_end; s += SIMD_FLOAT4_SIZE) {
+        SimdFloat4 x1 = SimdFloat4::load(&segs.x1s[s]);
+        SimdFloat4 y1 = SimdFloat4::load(&segs.y1s[s]);
+        SimdFloat4 vx = SimdFloat4::load(&segs.x2s[s]) - x1;
+        SimdFloat4 vy = SimdFloat4::load(&segs.y2s[s]) - y1;
+        SimdFloat4 px = cx4 - x1;
+        SimdFloat4 py = cy4 - y1;
+        
+        //Ratio of the closest point in the segment to the center.
+        SimdFloat4 len_sq = SimdFloat4::max(vx * vx + vy * vy, min_len_sq4);
+        SimdFloat4 r = (px * vx + py * vy) / len_sq;
+        r = SimdFloat4::min(SimdFloat4::max(r, zero4), one4);
+        
+        SimdFloat4 dx = px - vx * r;
+        SimdFloat4 dy = py - vy * r;
+        int mask = (dx * dx + dy * dy <= max_dist_sq4).get_mask();
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            if(mask & (1 << i)) out_idxs.push_back(s + i);
+        }
+    }
+    
+    //Leftovers.
+    for(size_t s = simd_end; s < n_segs; s++) {
+        float vx = segs.x2s[s] - segs.x1s[s];
+        float vy = segs.y2s[s] - segs.y1s[s];
+        float px = circle.x - segs.x1s[s];
+        float py = circle.y - segs.y1s[s];
+        float len_sq = std::max(vx * vx + vy * vy, FLT_MIN);
+        float r = std::clamp((px * vx + py * vy) / len_sq, 0.0f, 1.0f);
+        float dx = px - vx * r;
+        float dy = py - vy * r;
+        if(dx * dx + dy * dy <= max_dist * max_dist) out_idxs.push_back(s);
+    }
+}
+
+
+/**
+ * @brief Finds which line segments in a batch could be intersecting
+ * another line segment, checking four of them at a time. This only rules out
+ * the segments that are clearly out of the way, with a bit of leeway
+ * for rounding, so the ones returned still need to be checked with
+ * line_segs_intersect(), but all of the ones it would accept are returned.
+ *
+ * @param segs Line segments to check.
+ * @param p1 First point of the other line segment.
+ * @param p2 Second point of the other line segment.
+ * @param out_idxs The indexes of the segments that could be intersecting are
+ * returned here, in order. Any previous contents are discarded.
+ */
+void get_line_segs_near_line_seg(
+    const LineSegBatch &segs, const Point &p1, const Point &p2,
+    vector<size_t> &out_idxs
+) {
+    out_idxs.clear();
+    size_t n_segs = segs.size();
+    size_t simd_end = n_segs - (n_segs % SIMD_FLOAT4_SIZE);
+    
+    //Same leeway as get_line_segs_near_circle(). For the side checks,
+    //it gets scaled by the line's length, like the cross products are.
+    const float leeway = 1.0f;
+    Point min_coords = p1;
+    Point max_coords = p1;
+    update_min_max_coords(min_coords, max_coords, p2);
+    min_coords -= leeway;
+    max_coords += leeway;
+    float vx = p2.x - p1.x;
+    float vy = p2.y - p1.y;
+    float side_leeway = (fabs(vx) + fabs(vy)) * leeway;
+    
+    const SimdFloat4 p1x4 = SimdFloat4::set(p1.x);
+    const SimdFloat4 p1y4 = SimdFloat4::set(p1.y);
+    const SimdFloat4 p2x4 = SimdFloat4::set(p2.x);
+    const SimdFloat4 p2y4 = SimdFloat4::set(p2.y);
+    const SimdFloat4 vx4 = SimdFloat4::set(vx);
+    const SimdFloat4 vy4 = SimdFloat4::set(vy);
+    const SimdFloat4 min_x4 = SimdFloat4::set(min_coords.x);
+    const SimdFloat4 min_y4 = SimdFloat4::set(min_coords.y);
+    const SimdFloat4 max_x4 = SimdFloat4::set(max_coords.x);
+    const SimdFloat4 max_y4 = SimdFloat4::set(max_coords.y);
+    const SimdFloat4 side_leeway4 = SimdFloat4::set(side_leeway);
+    const SimdFloat4 neg_side_leeway4 = SimdFloat4::set(-side_leeway);
+    const SimdFloat4 zero4 = SimdFloat4::set(0.0f);
+    const SimdFloat4 leeway4 = SimdFloat4::set(leeway);
+    
+    for(size_t s = 0; s < simd_end; s += SIMD_FLOAT4_SIZE) {
+        SimdFloat4 x1 = SimdFloat4::load(&segs.x1s[s]);
+        SimdFloat4 y1 = SimdFloat4::load(&segs.y1s[s]);
+        SimdFloat4 x2 = SimdFloat4::load(&segs.x2s[s]);
+        SimdFloat4 y2 = SimdFloat4::load(&segs.y2s[s]);
+        
+        //Bounding boxes that don't overlap.
+        SimdFloat4 out =
+            (SimdFloat4::min(x1, x2) > max_x4) |
+            (min_x4 > SimdFloat4::max(x1, x2)) |
+            (SimdFloat4::min(y1, y2) > max_y4) |
+            (min_y4 > SimdFloat4::max(y1, y2));
+            
+        //Both of the segment's points on the same side of the line.
+        SimdFloat4 c1 = vx4 * (y1 - p1y4) - vy4 * (x1 - p1x4);
+        SimdFloat4 c2 = vx4 * (y2 - p1y4) - vy4 * (x2 - p1x4);
+        out =
+            out |
+            ((c1 > side_leeway4) & (c2 > side_leeway4)) |
+            ((neg_side_leeway4 > c1) & (neg_side_leeway4 > c2));
+            
+        //Both of the line's points on the same side of the segment.
+        SimdFloat4 sx = x2 - x1;
+        SimdFloat4 sy = y2 - y1;
+        SimdFloat4 seg_side_leeway =
+            (
+                SimdFloat4::max(sx, zero4 - sx) +
+                SimdFloat4::max(sy, zero4 - sy)
+            ) * leeway4;
+        SimdFloat4 neg_seg_side_leeway = zero4 - seg_side_leeway;
+        SimdFloat4 c3 = sx * (p1y4 - y1) - sy * (p1x4 - x1);
+        SimdFloat4 c4 = sx * (p2y4 - y1) - sy * (p2x4 - x1);
+        out =
+            out |
+            ((c3 > seg_side_leeway) & (c4 > seg_side_leeway)) |
+            ((neg_seg_side_leeway > c3) & (neg_seg_side_leeway > c4));
+            
+        int mask = out.get_mask();
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            if(!(mask & (1 << i))) out_idxs.push_back(s + i);
+        }
+    }
+    
+    //Leftovers.
+    for(size_t s = simd_end; s < n_segs; s++) {
+        float x1 = segs.x1s[s];
+        float y1 = segs.y1s[s];
+        float x2 = segs.x2s[s];
+        float y2 = segs.y2s[s];
+        
+        if(
+            std::min(x1, x2) > max_coords.x ||
+            min_coords.x > std::max(x1, x2) ||
+            std::min(y1, y2) > max_coords.y ||
+            min_coords.y > std::max(y1, y2)
+        ) {
+            continue;
+        }
+        
+        float c1 = vx * (y1 - p1.y) - vy * (x1 - p1.x);
+        float c2 = vx * (y2 - p1.y) - vy * (x2 - p1.x);
+        if(c1 > side_leeway && c2 > side_leeway) continue;
+        if(c1 < -side_leeway && c2 < -side_leeway) continue;
+        
+        float sx = x2 - x1;
+        float sy = y2 - y1;
+        float seg_side_leeway = (fabs(sx) + fabs(sy)) * leeway;
+        float c3 = sx * (p1.y - y1) - sy * (p1.x - x1);
+        float c4 = sx * (p2.y - y1) - sy * (p2.x - x1);
+        if(c3 > seg_side_leeway && c4 > seg_side_leeway) continue;
+        if(c3 < -seg_side_leeway && c4 < -seg_side_leeway) continue;
+        
+        out_idxs.push_back(s);
+    }
+}
+
+
 /**
  * @brief Given two line segments that share a point, and have some thickness,
  * this returns the location of the inner point and outer point of their
@@ -94,6 +94,9 @@ const Point operator/(float n, const Point &p);
  * not the sqrt()'d number is in cache is around twice as fast as keeping
  * only the squared and sqrt()'d numbers, and setting the sqrt()'d number
  * to LARGE_FLOAT if it is uncached.
+ * Comparisons never need sqrt() either. If the normal distance is known,
+ * it gets compared directly, which also keeps negative distances working
+ * (like the distance between two mobs that overlap).
  */
 struct Distance {
 
@@ -138,6 +141,37 @@ struct Distance {
 };
 
 
+/**
+ * @brief A list of line segments, with each coordinate kept in its own
+ * array, so that many segments can be checked at once with
+ * vector instructions.
+ */
+struct LineSegBatch {
+
+    //--- Members ---
+    
+    //X coordinate of each segment's first point.
+    vector<float> x1s;
+    
+    //Y coordinate of each segment's first point.
+    vector<float> y1s;
+    
+    //X coordinate of each segment's second point.
+    vector<float> x2s;
+    
+    //Y coordinate of each segment's second point.
+    vector<float> y2s;
+    
+    
+    //--- Function declarations ---
+    
+    void add(const Point &p1, const Point &p2);
+    void clear();
+    size_t size() const;
+    
+};
+
+
 
 Point angle_to_coordinates(
     float angle, float magnitude
@@ -178,6 +212,10 @@ float get_angle(const Point &focus);
 float get_angle(const Point &center, const Point &focus);
 float get_angle_cw_diff(float a1, float a2);
 float get_angle_smallest_dif(float a1, float a2);
+float get_circle_sweep_line_seg_ratio(
+    const Point &start, const Point &end, float radius,
+    const Point &l1, const Point &l2
+);
 Point get_closest_point_in_line_seg(
     const Point &l1, const Point &l2, const Point &p,
     float* out_segment_ratio = nullptr
@@ -187,6 +225,18 @@ Point get_closest_point_in_rotated_rectangle(
     const Point &rect_center, const Point &rect_dim, float rect_angle,
     bool* out_is_inside
 );
+void get_distances_squared(
+    const Point &center, const vector<Point> &points,
+    vector<float> &out_dists_squared
+);
+void get_line_segs_near_circle(
+    const LineSegBatch &segs, const Point &circle, float radius,
+    vector<size_t> &out_idxs
+);
+void get_line_segs_near_line_seg(
+    const LineSegBatch &segs, const Point &p1, const Point &p2,
+    vector<size_t> &out_idxs
+);
 void get_miter_points(
     const Point &a, const Point &b, const Point &c, float thickness,
     Point* miter_point_1, Point* miter_point_2, float max_miter_length = 0.0f
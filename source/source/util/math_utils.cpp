@@ -11,10 +11,27 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "math_utils.h"
 
 
+/**
+ * @brief Generates a random number from a key and a counter, without any
+ * state. The same key and counter always give the same number, and any
+ * number in a key's sequence can be obtained without going through the
+ * ones before it, so this is safe to use from several threads at once.
+ * The result is in the same range as linear_congruential_generator()'s.
+ *
+ * @param key Key of the sequence.
+ * @param counter Index of the number in the sequence.
+ * @return The generated number.
+ */
+int32_t counter_based_generator(uint32_t key, uint32_t counter) {
+    return (int32_t) (hash_nr(hash_nr(counter) ^ key) & 0x7fffffff);
+}
+
+
 /**
  * @brief Eases a number [0, 1] in accordance to a non-linear
  * interpolation method.
@@ -103,6 +120,24 @@ float ease(const EASING_METHOD method, float n) {
 }
 
 
+/**
+ * @brief Returns an unsigned integer that sorts the same way the given float
+ * does, when compared with the integers of other floats. Useful for
+ * radix sorting floats. Doesn't handle NaN.
+ *
+ * @param f Float to convert.
+ * @return The integer.
+ */
+uint32_t float_to_sortable_uint(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    //Negative numbers need every bit flipped, so they're in reverse order.
+    //Positive numbers only need the sign bit flipped, to go above those.
+    uint32_t mask = (bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    return bits ^ mask;
+}
+
+
 /**
  * @brief Given an input, it returns a 32-bit unsigned integer hash of
  * that input.
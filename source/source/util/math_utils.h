@@ -67,7 +67,9 @@ enum EASING_METHOD {
 //Returns the sign (1 or -1) of a number.
 #define sign(n) (((n) >= 0) ? 1 : -1)
 
+int32_t counter_based_generator(uint32_t key, uint32_t counter);
 float ease(const EASING_METHOD method, float n);
+uint32_t float_to_sortable_uint(float f);
 uint32_t hash_nr(unsigned int input);
 uint32_t hash_nr2(unsigned int input1, unsigned int input2);
 float inch_towards(float start, float target, float max_step);
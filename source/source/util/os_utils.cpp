@@ -92,6 +92,23 @@ bool open_web_browser(const string &url) {
 }
 
 
+/**
+ * @brief Runs a command in the operative system's shell, without waiting
+ * for it to finish.
+ *
+ * @param command Command to run.
+ * @return Whether it could be started.
+ */
+bool run_in_background(const string &command) {
+#ifdef _WIN32
+    string full_command = "start \"\" /b " + command;
+#else
+    string full_command = command + " &";
+#endif
+    return std::system(full_command.c_str()) == 0;
+}
+
+
 #if defined(_WIN32)
 /**
  * @brief An implementation of strsignal from POSIX.
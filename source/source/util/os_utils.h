@@ -19,6 +19,7 @@ using std::string;
 string get_current_time(bool file_name_friendly);
 bool open_file_explorer(const std::string &path);
 bool open_web_browser(const std::string &url);
+bool run_in_background(const std::string &command);
 
 #if defined(_WIN32)
 string strsignal(int signum);
@@ -0,0 +1,359 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for a small abstraction over SIMD instructions.
+ * These don't contain logic specific to the Pikifen project.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SIMD_USE_NEON
+#include <arm_neon.h>
+#endif
+
+
+//How many floats a SimdFloat4 holds.
+constexpr size_t SIMD_FLOAT4_SIZE = 4;
+
+
+/**
+ * @brief Four floats that get operated on at the same time, using SSE2
+ * or NEON where available, and plain floats otherwise.
+ */
+struct SimdFloat4 {
+
+    //--- Members ---
+    
+#if defined(SIMD_USE_SSE2)
+    //Raw vector.
+    __m128 v;
+#elif defined(SIMD_USE_NEON)
+    //Raw vector.
+    float32x4_t v;
+#else
+    //Raw values.
+    float v[SIMD_FLOAT4_SIZE];
+#endif
+    
+    
+    //--- Function definitions ---
+    
+    /**
+     * @brief Returns a bitmask with one bit per float, set if that float
+     * is a "true" result of a comparison, like the ones from operator<=.
+     * The first float is the least significant bit.
+     *
+     * @return The bitmask.
+     */
+    int get_mask() const {
+#if defined(SIMD_USE_SSE2)
+        return _mm_movemask_ps(v);
+#elif defined(SIMD_USE_NEON)
+        uint32x4_t u = vreinterpretq_u32_f32(v);
+        return
+            (int) (vgetq_lane_u32(u, 0) >> 31) |
+            (int) ((vgetq_lane_u32(u, 1) >> 31) << 1) |
+            (int) ((vgetq_lane_u32(u, 2) >> 31) << 2) |
+            (int) ((vgetq_lane_u32(u, 3) >> 31) << 3);
+#else
+        int mask = 0;
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            if(v[i] != 0.0f) mask |= 1 << i;
+        }
+        return mask;
+#endif
+    }
+    
+    
+    /**
+     * @brief Loads four consecutive floats. They don't need to be aligned.
+     *
+     * @param src Pointer to the first float.
+     * @return The vector.
+     */
+    static SimdFloat4 load(const float* src) {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_loadu_ps(src);
+#elif defined(SIMD_USE_NEON)
+        r.v = vld1q_f32(src);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = src[i];
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Returns the larger of each pair of floats.
+     *
+     * @param a First vector.
+     * @param b Second vector.
+     * @return The vector.
+     */
+    static SimdFloat4 max(const SimdFloat4 &a, const SimdFloat4 &b) {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_max_ps(a.v, b.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vmaxq_f32(a.v, b.v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        }
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Returns the smaller of each pair of floats.
+     *
+     * @param a First vector.
+     * @param b Second vector.
+     * @return The vector.
+     */
+    static SimdFloat4 min(const SimdFloat4 &a, const SimdFloat4 &b) {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_min_ps(a.v, b.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vminq_f32(a.v, b.v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        }
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Returns a vector with all four floats set to the same value.
+     *
+     * @param f The value.
+     * @return The vector.
+     */
+    static SimdFloat4 set(float f) {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_set1_ps(f);
+#elif defined(SIMD_USE_NEON)
+        r.v = vdupq_n_f32(f);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = f;
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Stores the four floats onto consecutive positions.
+     * They don't need to be aligned.
+     *
+     * @param dst Pointer to the first float.
+     */
+    void store(float* dst) const {
+#if defined(SIMD_USE_SSE2)
+        _mm_storeu_ps(dst, v);
+#elif defined(SIMD_USE_NEON)
+        vst1q_f32(dst, v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) dst[i] = v[i];
+#endif
+    }
+    
+    
+    /**
+     * @brief Adds two vectors.
+     *
+     * @param o The other vector.
+     * @return The result.
+     */
+    SimdFloat4 operator+(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_add_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vaddq_f32(v, o.v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = v[i] + o.v[i];
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Subtracts two vectors.
+     *
+     * @param o The other vector.
+     * @return The result.
+     */
+    SimdFloat4 operator-(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_sub_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vsubq_f32(v, o.v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = v[i] - o.v[i];
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Multiplies two vectors, element by element.
+     *
+     * @param o The other vector.
+     * @return The result.
+     */
+    SimdFloat4 operator*(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_mul_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vmulq_f32(v, o.v);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = v[i] * o.v[i];
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Divides two vectors, element by element.
+     *
+     * @param o The other vector.
+     * @return The result.
+     */
+    SimdFloat4 operator/(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_div_ps(v, o.v);
+#elif defined(SIMD_USE_NEON) && defined(__aarch64__)
+        r.v = vdivq_f32(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        //32-bit NEON has no division.
+        float a[SIMD_FLOAT4_SIZE];
+        float b[SIMD_FLOAT4_SIZE];
+        vst1q_f32(a, v);
+        vst1q_f32(b, o.v);
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) a[i] /= b[i];
+        r.v = vld1q_f32(a);
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) r.v[i] = v[i] / o.v[i];
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Compares two vectors, element by element. The result can be
+     * combined with other comparisons, and read with get_mask().
+     *
+     * @param o The other vector.
+     * @return The comparison results.
+     */
+    SimdFloat4 operator<=(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_cmple_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vreinterpretq_f32_u32(vcleq_f32(v, o.v));
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = v[i] <= o.v[i] ? 1.0f : 0.0f;
+        }
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Compares two vectors, element by element. The result can be
+     * combined with other comparisons, and read with get_mask().
+     *
+     * @param o The other vector.
+     * @return The comparison results.
+     */
+    SimdFloat4 operator>(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_cmpgt_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v = vreinterpretq_f32_u32(vcgtq_f32(v, o.v));
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = v[i] > o.v[i] ? 1.0f : 0.0f;
+        }
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Combines two sets of comparison results, keeping the ones
+     * that are true in both.
+     *
+     * @param o The other comparison results.
+     * @return The combined results.
+     */
+    SimdFloat4 operator&(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_and_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v =
+            vreinterpretq_f32_u32(
+                vandq_u32(
+                    vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(o.v)
+                )
+            );
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = (v[i] != 0.0f && o.v[i] != 0.0f) ? 1.0f : 0.0f;
+        }
+#endif
+        return r;
+    }
+    
+    
+    /**
+     * @brief Combines two sets of comparison results, keeping the ones
+     * that are true in either.
+     *
+     * @param o The other comparison results.
+     * @return The combined results.
+     */
+    SimdFloat4 operator|(const SimdFloat4 &o) const {
+        SimdFloat4 r;
+#if defined(SIMD_USE_SSE2)
+        r.v = _mm_or_ps(v, o.v);
+#elif defined(SIMD_USE_NEON)
+        r.v =
+            vreinterpretq_f32_u32(
+                vorrq_u32(
+                    vreinterpretq_u32_f32(v), vreinterpretq_u32_f32(o.v)
+                )
+            );
+#else
+        for(size_t i = 0; i < SIMD_FLOAT4_SIZE; i++) {
+            r.v[i] = (v[i] != 0.0f || o.v[i] != 0.0f) ? 1.0f : 0.0f;
+        }
+#endif
+        return r;
+    }
+    
+};
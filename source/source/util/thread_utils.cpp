@@ -0,0 +1,851 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Multithreading-related utility classes and functions.
+ * These don't contain logic specific to the Pikifen project.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "thread_utils.h"
+
+
+//Job pool the current thread is a worker of, if any.
+static thread_local const JobPool* cur_thread_pool = nullptr;
+
+//Index of the current thread's queue, if it's a worker of cur_thread_pool.
+static thread_local size_t cur_thread_queue_idx = 0;
+
+//Function that every thread runs before doing anything else.
+//See set_up_thread().
+static std::function<void()> thread_setup_func;
+
+
+/**
+ * @brief A piece of work in a job pool's queue.
+ */
+struct JobPoolWork {
+
+    //--- Members ---
+    
+    //Function to run.
+    std::function<void()> func;
+    
+    //If not nullptr, this gets decreased once the work is done.
+    std::atomic<size_t>* counter = nullptr;
+    
+    //ID of the task this belongs to, if it was added as a task. 0 if not.
+    size_t task_id = 0;
+    
+};
+
+
+/**
+ * @brief A queue of work in a job pool, belonging to one thread.
+ */
+struct JobPoolQueue {
+
+    //--- Members ---
+    
+    //Controls access to the members below.
+    std::mutex mutex;
+    
+    //Work waiting to be picked up. The owner takes from the back,
+    //and other threads steal from the front.
+    std::deque<JobPoolWork> work;
+    
+    //How long the owner spent running work, in seconds.
+    double busy_time = 0.0;
+    
+};
+
+
+/**
+ * @brief A task in a job pool that isn't done yet.
+ */
+struct JobPoolTask {
+
+    //--- Members ---
+    
+    //Function to run. Empty once it has been queued.
+    std::function<void()> func;
+    
+    //How many of its dependencies aren't done yet.
+    size_t nr_deps_left = 0;
+    
+    //IDs of the tasks that depend on this one.
+    std::vector<size_t> dependents;
+    
+    //Is it done?
+    bool done = false;
+    
+};
+
+
+/**
+ * @brief Worker threads of a job pool, and the data they share.
+ */
+struct JobPool::SyncData {
+
+    //--- Members ---
+    
+    //Worker threads.
+    std::vector<std::thread> workers;
+    
+    //Queues of work. One per worker, plus one at the end for threads
+    //that aren't workers.
+    std::deque<JobPoolQueue> queues;
+    
+    //How much work is in the queues, in total.
+    std::atomic<size_t> nr_queued{0};
+    
+    //Controls sleeping and waking up. Never lock another mutex while
+    //holding this one.
+    std::mutex wake_mutex;
+    
+    //Signals waiting threads that there's new work, that some work they
+    //could be waiting on is done, or that the workers should stop.
+    std::condition_variable wake_cond;
+    
+    //Are the workers meant to stop?
+    bool stopping = false;
+    
+    //Controls access to the task data below.
+    std::mutex tasks_mutex;
+    
+    //Tasks added since the last time they were all finished, by ID.
+    std::unordered_map<size_t, JobPoolTask> tasks;
+    
+    //ID to give to the next task.
+    size_t next_task_id = 1;
+    
+    //How many tasks aren't done yet.
+    std::atomic<size_t> nr_unfinished_tasks{0};
+    
+    
+    //--- Function declarations ---
+    
+    void finish_task(size_t task_id, size_t queue_idx);
+    void help_until(size_t queue_idx, const std::function<bool()> &is_done);
+    bool pop(size_t queue_idx, JobPoolWork* out_work);
+    void push(size_t queue_idx, JobPoolWork &&work);
+    void run(size_t queue_idx, JobPoolWork &work);
+    void wake_all();
+    
+};
+
+
+/**
+ * @brief Marks a task as done, and queues the tasks that were only
+ * waiting on it.
+ *
+ * @param task_id ID of the task.
+ * @param queue_idx Index of the queue to put the newly-ready tasks in.
+ */
+void JobPool::SyncData::finish_task(size_t task_id, size_t queue_idx) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        JobPoolTask &task = tasks[task_id];
+        task.done = true;
+        for(size_t d = 0; d < task.dependents.size(); d++) {
+            JobPoolTask &dependent = tasks[task.dependents[d]];
+            dependent.nr_deps_left--;
+            if(dependent.nr_deps_left == 0) {
+                JobPoolWork work;
+                work.func = std::move(dependent.func);
+                work.task_id = task.dependents[d];
+                push(queue_idx, std::move(work));
+            }
+        }
+    }
+    
+    if(nr_unfinished_tasks.fetch_sub(1) == 1) {
+        wake_all();
+    }
+}
+
+
+/**
+ * @brief Runs work from the queues until the given condition is met,
+ * sleeping whenever there's nothing to run.
+ *
+ * @param queue_idx Index of the calling thread's queue.
+ * @param is_done Function that returns whether the wait is over.
+ * This gets called while the wake mutex is held.
+ */
+void JobPool::SyncData::help_until(
+    size_t queue_idx, const std::function<bool()> &is_done
+) {
+    while(!is_done()) {
+        JobPoolWork work;
+        if(pop(queue_idx, &work)) {
+            run(queue_idx, work);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        wake_cond.wait(
+            lock,
+        [this, &is_done] () {
+            return is_done() || nr_queued > 0;
+        }
+        );
+    }
+}
+
+
+/**
+ * @brief Takes some work out of the queues. The thread's own queue
+ * is checked first, newest work first. If it's empty, the oldest work
+ * is stolen from another queue.
+ *
+ * @param queue_idx Index of the calling thread's queue.
+ * @param out_work The work is returned here.
+ * @return Whether there was any work.
+ */
+bool JobPool::SyncData::pop(size_t queue_idx, JobPoolWork* out_work) {
+    if(nr_queued == 0) return false;
+    
+    {
+        JobPoolQueue &own = queues[queue_idx];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.work.empty()) {
+            *out_work = std::move(own.work.back());
+            own.work.pop_back();
+            nr_queued--;
+            return true;
+        }
+    }
+    
+    for(size_t q = 1; q < queues.size(); q++) {
+        JobPoolQueue &victim = queues[(queue_idx + q) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.work.empty()) {
+            *out_work = std::move(victim.work.front());
+            victim.work.pop_front();
+            nr_queued--;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+
+/**
+ * @brief Adds some work to a queue, and wakes up the sleeping threads.
+ *
+ * @param queue_idx Index of the queue.
+ * @param work The work.
+ */
+void JobPool::SyncData::push(size_t queue_idx, JobPoolWork &&work) {
+    {
+        JobPoolQueue &queue = queues[queue_idx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        //Count it before it can be taken, so the count never goes below 0.
+        nr_queued++;
+        queue.work.push_back(std::move(work));
+    }
+    wake_all();
+}
+
+
+/**
+ * @brief Runs some work, and keeps track of how long it took.
+ *
+ * @param queue_idx Index of the calling thread's queue.
+ * @param work The work.
+ */
+void JobPool::SyncData::run(size_t queue_idx, JobPoolWork &work) {
+    auto start = std::chrono::steady_clock::now();
+    work.func();
+    std::chrono::duration<double> dur =
+        std::chrono::steady_clock::now() - start;
+    
+    {
+        JobPoolQueue &queue = queues[queue_idx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.busy_time += dur.count();
+    }
+    
+    if(work.counter && work.counter->fetch_sub(1) == 1) {
+        wake_all();
+    }
+    if(work.task_id != 0) {
+        finish_task(work.task_id, queue_idx);
+    }
+}
+
+
+/**
+ * @brief Wakes up every thread that's waiting for something.
+ */
+void JobPool::SyncData::wake_all() {
+    {
+        //Locking makes sure no thread is between checking its condition
+        //and going to sleep, otherwise it would miss this.
+        std::lock_guard<std::mutex> lock(wake_mutex);
+    }
+    wake_cond.notify_all();
+}
+
+
+/**
+ * @brief Constructs a new job pool object. No workers are started.
+ */
+JobPool::JobPool() :
+    sync(new SyncData()) {
+    
+    sync->queues.emplace_back();
+}
+
+
+/**
+ * @brief Constructs a new job pool object by copying another. Worker threads
+ * can't be copied, so the new pool starts without any.
+ *
+ * @param jp2 Job pool to copy from.
+ */
+JobPool::JobPool(const JobPool &jp2) :
+    sync(new SyncData()) {
+    
+    sync->queues.emplace_back();
+}
+
+
+/**
+ * @brief Copies a job pool from another one. Worker threads can't be copied,
+ * so this one just keeps its own.
+ *
+ * @param jp2 Job pool to copy from.
+ * @return The current object.
+ */
+JobPool &JobPool::operator =(const JobPool &jp2) {
+    return *this;
+}
+
+
+/**
+ * @brief Destroys the job pool object.
+ */
+JobPool::~JobPool() {
+    stop();
+    delete sync;
+}
+
+
+/**
+ * @brief Adds a task, which runs in the background as soon as all
+ * of the tasks it depends on are done.
+ *
+ * @param task Function to run.
+ * @param dependencies IDs of the tasks that must be done before this one
+ * can start. Tasks from before the last call to finish_tasks() are
+ * always done.
+ * @return The task's ID.
+ */
+size_t JobPool::add_task(
+    const std::function<void()> &task,
+    const std::vector<size_t> &dependencies
+) {
+    std::lock_guard<std::mutex> lock(sync->tasks_mutex);
+    size_t id = sync->next_task_id;
+    sync->next_task_id++;
+    JobPoolTask &new_task = sync->tasks[id];
+    new_task.func = task;
+    
+    for(size_t d = 0; d < dependencies.size(); d++) {
+        auto dep_it = sync->tasks.find(dependencies[d]);
+        if(dep_it == sync->tasks.end() || dep_it->second.done) continue;
+        dep_it->second.dependents.push_back(id);
+        new_task.nr_deps_left++;
+    }
+    
+    sync->nr_unfinished_tasks++;
+    if(new_task.nr_deps_left == 0) {
+        JobPoolWork work;
+        work.func = std::move(new_task.func);
+        work.task_id = id;
+        sync->push(get_cur_queue_idx(), std::move(work));
+    }
+    return id;
+}
+
+
+/**
+ * @brief Waits until every task is done, helping out in the meantime.
+ * This is the barrier that's meant to be called at the end of every frame.
+ */
+void JobPool::finish_tasks() {
+    sync->help_until(
+        get_cur_queue_idx(),
+    [this] () {
+        return sync->nr_unfinished_tasks == 0;
+    }
+    );
+    
+    std::lock_guard<std::mutex> lock(sync->tasks_mutex);
+    sync->tasks.clear();
+}
+
+
+/**
+ * @brief Returns how long a worker thread has spent running work since
+ * the workers were started.
+ *
+ * @param worker_idx Index of the worker.
+ * @return The time, in seconds.
+ */
+double JobPool::get_busy_time(size_t worker_idx) const {
+    if(worker_idx >= sync->workers.size()) return 0.0;
+    JobPoolQueue &queue = sync->queues[worker_idx];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    return queue.busy_time;
+}
+
+
+/**
+ * @brief Returns the index of the calling thread's queue.
+ *
+ * @return The index.
+ */
+size_t JobPool::get_cur_queue_idx() const {
+    if(cur_thread_pool == this) return cur_thread_queue_idx;
+    return sync->queues.size() - 1;
+}
+
+
+/**
+ * @brief Returns how many worker threads are running, not counting
+ * the threads that hand out work.
+ *
+ * @return The amount.
+ */
+size_t JobPool::get_nr_workers() const {
+    return sync->workers.size();
+}
+
+
+/**
+ * @brief Returns whether a task is done. This doesn't wait for it, so it
+ * can be used to check on a task every frame. Tasks that were already
+ * cleared by finishing all tasks count as done.
+ *
+ * @param task_id ID of the task, as returned when it was added.
+ * @return Whether it's done.
+ */
+bool JobPool::is_task_done(size_t task_id) const {
+    std::lock_guard<std::mutex> lock(sync->tasks_mutex);
+    auto it = sync->tasks.find(task_id);
+    return it == sync->tasks.end() || it->second.done;
+}
+
+
+/**
+ * @brief Runs a job, splitting its items into ranges that are handled by
+ * the workers and the calling thread at the same time. Returns once
+ * everything is done. If there are no workers, or too few items to be
+ * worth it, the calling thread runs the whole job by itself.
+ *
+ * There are a few ranges for each thread, so that if some ranges take
+ * longer than others, the threads that finish early can steal the rest.
+ *
+ * @param nr_items Total number of items.
+ * @param min_range_size Don't split the items into ranges smaller than this.
+ * @param job Function that handles the items from start (inclusive)
+ * to end (exclusive).
+ */
+void JobPool::parallel_for(
+    size_t nr_items, size_t min_range_size,
+    const std::function<void(size_t start, size_t end)> &job
+) {
+    if(nr_items == 0) return;
+    min_range_size = std::max(min_range_size, (size_t) 1);
+    
+    const size_t RANGES_PER_THREAD = 4;
+    size_t nr_threads = sync->workers.size() + 1;
+    size_t wanted_ranges =
+        std::min(
+            nr_threads * RANGES_PER_THREAD,
+            (nr_items + min_range_size - 1) / min_range_size
+        );
+    if(sync->workers.empty() || wanted_ranges <= 1) {
+        job(0, nr_items);
+        return;
+    }
+    
+    size_t range_size = (nr_items + wanted_ranges - 1) / wanted_ranges;
+    size_t nr_ranges = (nr_items + range_size - 1) / range_size;
+    std::atomic<size_t> nr_ranges_left{nr_ranges};
+    
+    //Deal the ranges out to every queue, so the workers can start
+    //right away without having to steal.
+    size_t queue_idx = get_cur_queue_idx();
+    for(size_t r = 0; r < nr_ranges; r++) {
+        size_t start = r * range_size;
+        size_t end = std::min(start + range_size, nr_items);
+        JobPoolWork work;
+        work.func = [&job, start, end] () { job(start, end); };
+        work.counter = &nr_ranges_left;
+        sync->push((queue_idx + r) % sync->queues.size(), std::move(work));
+    }
+    
+    sync->help_until(
+        queue_idx,
+    [&nr_ranges_left] () {
+        return nr_ranges_left == 0;
+    }
+    );
+}
+
+
+/**
+ * @brief Starts the worker threads. If they were already running,
+ * they are restarted.
+ *
+ * @param nr_workers How many worker threads to start.
+ * 0 means all work will run on the threads that hand it out.
+ */
+void JobPool::start(size_t nr_workers) {
+    stop();
+    sync->stopping = false;
+    sync->queues.clear();
+    for(size_t q = 0; q < nr_workers + 1; q++) {
+        sync->queues.emplace_back();
+    }
+    for(size_t w = 0; w < nr_workers; w++) {
+        sync->workers.push_back(std::thread(&JobPool::work, this, w));
+    }
+}
+
+
+/**
+ * @brief Finishes any remaining tasks, and stops and joins
+ * the worker threads.
+ */
+void JobPool::stop() {
+    finish_tasks();
+    if(sync->workers.empty()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(sync->wake_mutex);
+        sync->stopping = true;
+    }
+    sync->wake_cond.notify_all();
+    for(size_t w = 0; w < sync->workers.size(); w++) {
+        sync->workers[w].join();
+    }
+    sync->workers.clear();
+}
+
+
+/**
+ * @brief Main loop of each worker thread. Runs work from the queues,
+ * and sleeps while there's none, until it's told to stop.
+ *
+ * @param worker_idx Index of the worker, which is also the index
+ * of its queue.
+ */
+void JobPool::work(size_t worker_idx) {
+    set_up_thread();
+    cur_thread_pool = this;
+    cur_thread_queue_idx = worker_idx;
+    
+    while(true) {
+        JobPoolWork work;
+        if(sync->pop(worker_idx, &work)) {
+            sync->run(worker_idx, work);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(sync->wake_mutex);
+        sync->wake_cond.wait(
+            lock,
+        [this] () {
+            return sync->stopping || sync->nr_queued > 0;
+        }
+        );
+        if(sync->stopping) return;
+    }
+}
+
+
+/**
+ * @brief A job in a worker thread's queue.
+ */
+struct WorkerThreadJob {
+
+    //--- Members ---
+    
+    //Function to run.
+    std::function<void()> func;
+    
+    //It only starts once this time is reached.
+    std::chrono::steady_clock::time_point start_time;
+    
+};
+
+
+/**
+ * @brief The thread of a worker thread object, and the jobs it has to run.
+ */
+struct WorkerThread::SyncData {
+
+    //--- Members ---
+    
+    //The thread.
+    std::thread thread;
+    
+    //Function it runs once it starts, before any job.
+    std::function<void()> setup;
+    
+    //Controls access to everything below.
+    std::mutex mutex;
+    
+    //Signals the thread that there are new jobs, or that it should stop.
+    std::condition_variable work_cond;
+    
+    //Signals waiting threads that a job finished, or that jobs were cleared.
+    std::condition_variable done_cond;
+    
+    //Jobs waiting to run.
+    std::deque<WorkerThreadJob> jobs;
+    
+    //Is it running a job right now?
+    bool busy = false;
+    
+    //Is it meant to stop?
+    bool stopping = false;
+    
+};
+
+
+/**
+ * @brief Constructs a new worker thread object. The thread isn't started.
+ */
+WorkerThread::WorkerThread() :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Constructs a new worker thread object by copying another.
+ * Threads can't be copied, so the new object starts without one.
+ *
+ * @param w2 Worker thread to copy from.
+ */
+WorkerThread::WorkerThread(const WorkerThread &w2) :
+    sync(new SyncData()) {
+
+}
+
+
+/**
+ * @brief Copies a worker thread from another one. Threads can't be copied,
+ * so this one just keeps its own.
+ *
+ * @param w2 Worker thread to copy from.
+ * @return The current object.
+ */
+WorkerThread &WorkerThread::operator =(const WorkerThread &w2) {
+    return *this;
+}
+
+
+/**
+ * @brief Destroys the worker thread object.
+ */
+WorkerThread::~WorkerThread() {
+    stop();
+    delete sync;
+}
+
+
+/**
+ * @brief Adds a job to the queue. Jobs that are added while the thread
+ * isn't running wait until it starts.
+ *
+ * @param job Function to run.
+ * @param urgent If true, it goes to the front of the queue,
+ * instead of the back.
+ * @param delay Only start it after this many seconds. Jobs still run in
+ * order, so the ones behind it wait too.
+ */
+void WorkerThread::add(std::function<void()> job, bool urgent, double delay) {
+    WorkerThreadJob new_job;
+    new_job.func = std::move(job);
+    new_job.start_time =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(delay)
+        );
+        
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    if(urgent) {
+        sync->jobs.push_front(std::move(new_job));
+    } else {
+        sync->jobs.push_back(std::move(new_job));
+    }
+    sync->work_cond.notify_one();
+}
+
+
+/**
+ * @brief Throws away every job that hasn't started yet.
+ * The one that's running, if any, still finishes.
+ */
+void WorkerThread::clear() {
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->jobs.clear();
+    sync->done_cond.notify_all();
+}
+
+
+/**
+ * @brief Returns how many jobs haven't finished yet,
+ * including the one that's running right now.
+ *
+ * @return The amount.
+ */
+size_t WorkerThread::get_nr_pending() const {
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    return sync->jobs.size() + (sync->busy ? 1 : 0);
+}
+
+
+/**
+ * @brief Returns whether the thread is running.
+ *
+ * @return Whether it's running.
+ */
+bool WorkerThread::is_running() const {
+    return sync->thread.joinable();
+}
+
+
+/**
+ * @brief Starts the thread. If it was already running, it is restarted.
+ *
+ * @param setup If not empty, the thread runs this once it starts,
+ * before any job. Useful for per-thread library settings.
+ */
+void WorkerThread::start(const std::function<void()> &setup) {
+    stop();
+    sync->setup = setup;
+    sync->stopping = false;
+    sync->thread = std::thread(&WorkerThread::work, this);
+}
+
+
+/**
+ * @brief Stops and joins the thread. Jobs that haven't started yet are
+ * thrown away, so call wait_for_all() first if they matter.
+ */
+void WorkerThread::stop() {
+    if(!sync->thread.joinable()) return;
+    
+    {
+        std::unique_lock<std::mutex> lock(sync->mutex);
+        sync->stopping = true;
+        sync->work_cond.notify_all();
+    }
+    sync->thread.join();
+    
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->jobs.clear();
+}
+
+
+/**
+ * @brief Waits for every job in the queue to finish.
+ * If the thread isn't running, this returns right away.
+ */
+void WorkerThread::wait_for_all() {
+    if(!sync->thread.joinable()) return;
+    
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    sync->done_cond.wait(
+        lock, [this] () { return sync->jobs.empty() && !sync->busy; }
+    );
+}
+
+
+/**
+ * @brief Main loop of the thread. Runs jobs, and sleeps while there's none
+ * that can start, until it's told to stop.
+ */
+void WorkerThread::work() {
+    set_up_thread();
+    if(sync->setup) sync->setup();
+    
+    std::unique_lock<std::mutex> lock(sync->mutex);
+    while(true) {
+        sync->work_cond.wait(
+            lock, [this] () { return sync->stopping || !sync->jobs.empty(); }
+        );
+        if(sync->stopping) break;
+        
+        auto start_time = sync->jobs.front().start_time;
+        if(start_time > std::chrono::steady_clock::now()) {
+            //Check again once it's time, or if something changes before.
+            sync->work_cond.wait_until(lock, start_time);
+            continue;
+        }
+        
+        std::function<void()> job = std::move(sync->jobs.front().func);
+        sync->jobs.pop_front();
+        sync->busy = true;
+        
+        lock.unlock();
+        job();
+        lock.lock();
+        
+        sync->busy = false;
+        sync->done_cond.notify_all();
+    }
+}
+
+
+/**
+ * @brief Returns how many threads the hardware can run at the same time.
+ *
+ * @return The amount, or 1 if it can't be known.
+ */
+size_t get_nr_hardware_threads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+
+/**
+ * @brief Sets the function that every thread runs before doing anything
+ * else, when it calls set_up_thread(). This must be called before any
+ * other thread is started.
+ *
+ * @param func The function.
+ */
+void set_thread_setup_func(const std::function<void()> &func) {
+    thread_setup_func = func;
+}
+
+
+/**
+ * @brief Prepares the current thread, by running the function given to
+ * set_thread_setup_func(), if any. Some libraries keep settings per thread,
+ * so every thread should call this before doing anything else.
+ * The job pool's workers and worker threads already do.
+ */
+void set_up_thread() {
+    if(thread_setup_func) thread_setup_func();
+}
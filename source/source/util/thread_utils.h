@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Andre 'Espyo' Silva 2013.
+ * The following source file belongs to the open-source project Pikifen.
+ * Please read the included README and LICENSE files for more information.
+ * Pikmin is copyright (c) Nintendo.
+ *
+ * === FILE DESCRIPTION ===
+ * Header for multithreading-related utility classes and functions.
+ * These don't contain logic specific to the Pikifen project.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+using std::size_t;
+
+
+/**
+ * @brief A pool of worker threads that work can be handed to.
+ *
+ * Work comes in two forms. A parallel-for splits a range of items into
+ * smaller ranges that run at the same time, with the calling thread helping
+ * out, and only returns when all of them are done. A task is a single
+ * function that runs in the background, once all of the tasks it depends
+ * on are done. Tasks are only guaranteed to be done after finish_tasks()
+ * is called, which is meant to be done at the end of every frame.
+ *
+ * Each worker has its own queue of work. Workers take the newest work
+ * from their own queue, and when that's empty, they steal the oldest work
+ * from the other queues, so nobody stays idle while there's work left.
+ * Threads that aren't workers share one extra queue.
+ */
+struct JobPool {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    JobPool();
+    JobPool(const JobPool &jp2);
+    JobPool &operator=(const JobPool &jp2);
+    ~JobPool();
+    size_t add_task(
+        const std::function<void()> &task,
+        const std::vector<size_t> &dependencies = std::vector<size_t>()
+    );
+    void finish_tasks();
+    double get_busy_time(size_t worker_idx) const;
+    size_t get_nr_workers() const;
+    bool is_task_done(size_t task_id) const;
+    void parallel_for(
+        size_t nr_items, size_t min_range_size,
+        const std::function<void(size_t start, size_t end)> &job
+    );
+    void start(size_t nr_workers);
+    void stop();
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //Worker threads and everything needed to coordinate them.
+    SyncData* sync = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    size_t get_cur_queue_idx() const;
+    void work(size_t worker_idx);
+    
+};
+
+
+/**
+ * @brief A single background thread that runs jobs one at a time, in the
+ * order they were added. Urgent jobs skip to the front of the line, and
+ * jobs can be told to wait a while before they start. Whatever the jobs
+ * produce is up to them to hand back.
+ */
+struct WorkerThread {
+
+    public:
+    
+    //--- Function declarations ---
+    
+    WorkerThread();
+    WorkerThread(const WorkerThread &w2);
+    WorkerThread &operator=(const WorkerThread &w2);
+    ~WorkerThread();
+    void add(
+        std::function<void()> job, bool urgent = false, double delay = 0.0
+    );
+    void clear();
+    size_t get_nr_pending() const;
+    bool is_running() const;
+    void start(const std::function<void()> &setup = nullptr);
+    void stop();
+    void wait_for_all();
+    
+    private:
+    
+    //--- Misc. declarations ---
+    
+    struct SyncData;
+    
+    
+    //--- Members ---
+    
+    //The thread, its jobs, and everything needed to talk to it.
+    SyncData* sync = nullptr;
+    
+    
+    //--- Function declarations ---
+    
+    void work();
+    
+};
+
+
+size_t get_nr_hardware_threads();
+void set_thread_setup_func(const std::function<void()> &func);
+void set_up_thread();